@@ -37,17 +37,23 @@
 
 #include "src/settings/SettingsManager.h"
 #include "src/window/MainWindow.h"
+#include "src/window/scene/ShotList.h"
 #include "src/window/util/file-operations.h"
 #include <QApplication>
+#include <QCommandLineOption>
+#include <QCommandLineParser>
 #include <QCoreApplication>
 #include <QDebug>
 #include <QDir>
 #include <QFileDialog>
 #include <QMessageBox>
 #include <QSettings>
+#include <QSize>
 #include <QSurfaceFormat>
+#include <algorithm>
 #include <iostream>
 #include <optional>
+#include <parser/trace.h>
 #include <project.h>
 #include <string>
 
@@ -223,6 +229,8 @@ int main(int argc, char *argv[]) {
   format.setVersion(3, 3);
   auto samples = *settings.get<int>(Key::NumberSamples, RetrieveMode::AllowDefault);
   format.setSamples(samples);
+  // Frames are paced by their swaps, see `SceneWidget::scheduleFrame()`
+  format.setSwapInterval(std::max(0, *settings.get<int>(Key::RenderSwapInterval, RetrieveMode::AllowDefault)));
   format.setProfile(QSurfaceFormat::CoreProfile);
 #ifndef NDEBUG
   // Only enable debug logging for debug builds
@@ -234,6 +242,209 @@ int main(int argc, char *argv[]) {
   // on some platforms
   QApplication application(argc, argv);
 
+  QCommandLineParser commandLine;
+  commandLine.addHelpOption();
+  QCommandLineOption memoryReportOption{
+      "memory-report", "Print the memory held by each part of the application every <seconds>.", "seconds"};
+  commandLine.addOption(memoryReportOption);
+  QCommandLineOption traceOption{"trace",
+                                 "Record a timeline of loading & drawing to <file>, in the Chrome trace event format. "
+                                 "May also be set with the NETSIMULYZER_TRACE environment variable.",
+                                 "file"};
+  commandLine.addOption(traceOption);
+  QCommandLineOption serveOption{"serve",
+                                 "Stream the view to a remote client connecting to <address>, "
+                                 "either 'unix:/path/to/socket', or '[tcp:][host:]port'.",
+                                 "address"};
+  commandLine.addOption(serveOption);
+  QCommandLineOption metricsOption{"metrics",
+                                   "Serve the viewer's metrics over HTTP at <address>/metrics, in the Prometheus "
+                                   "text format. <address> is either 'unix:/path/to/socket', or '[tcp:][host:]port'.",
+                                   "address"};
+  commandLine.addOption(metricsOption);
+  QCommandLineOption metricsLogOption{
+      "metrics-log", "Print the viewer's metrics as a line of JSON every <seconds>.", "seconds"};
+  commandLine.addOption(metricsLogOption);
+  QCommandLineOption wallLeadOption{"wall-lead",
+                                    "Lead a video wall, sending each frame to the render nodes listening at "
+                                    "<addresses>, separated by commas. Each is either 'unix:/path/to/socket', "
+                                    "or '[tcp:][host:]port'.",
+                                    "addresses"};
+  commandLine.addOption(wallLeadOption);
+  QCommandLineOption wallNodeOption{"wall-node",
+                                    "Render one tile of a video wall, full screen, following the leader connecting "
+                                    "to <address>. Loads <scenario>, if given.",
+                                    "address"};
+  commandLine.addOption(wallNodeOption);
+  QCommandLineOption wallTileOption{
+      "wall-tile", "The tile of --wall-node to draw, as <columns>x<rows>:<column>,<row>, counted from the top left.",
+      "tile"};
+  commandLine.addOption(wallTileOption);
+  QCommandLineOption captureOption{"capture",
+                                   "Load <scenario> with no window, save an image at each shot in <shots>, then quit. "
+                                   "<shots> is a CSV file with one 'time_ms[,x,y,z,yaw,pitch]' line per shot.",
+                                   "shots"};
+  commandLine.addOption(captureOption);
+  QCommandLineOption captureDirectoryOption{
+      "capture-dir", "Write the images of --capture to <directory>, the current directory by default.", "directory"};
+  commandLine.addOption(captureDirectoryOption);
+  QCommandLineOption captureSizeOption{
+      "capture-size", "The size of the images of --capture, as <width>x<height>, 1920x1080 by default.", "size"};
+  commandLine.addOption(captureSizeOption);
+  QCommandLineOption exportOption{"export",
+                                  "Load <scenario> with no window, export every frame to <directory>, then quit.",
+                                  "directory"};
+  commandLine.addOption(exportOption);
+  QCommandLineOption exportSizeOption{
+      "export-size", "The size of the frames of --export, as <width>x<height>, 1920x1080 by default.", "size"};
+  commandLine.addOption(exportSizeOption);
+  QCommandLineOption exportFramesOption{
+      "export-frames", "Export only <count> frames of --export, starting with frame number <first>.", "first:count"};
+  commandLine.addOption(exportFramesOption);
+  QCommandLineOption exportJobsOption{
+      "export-jobs", "Split --export into <jobs> ranges of frames, each exported by its own process.", "jobs"};
+  commandLine.addOption(exportJobsOption);
+  commandLine.addPositionalArgument("scenario", "The scenario to load, with --capture, --export, or --wall-node.");
+  commandLine.process(application);
+
+  // The option takes priority over the environment
+  auto tracePath = qEnvironmentVariable("NETSIMULYZER_TRACE");
+  if (commandLine.isSet(traceOption))
+    tracePath = commandLine.value(traceOption);
+  if (!tracePath.isEmpty()) {
+    parser::trace::start(tracePath.toStdString());
+    parser::trace::setThreadName("Main");
+  }
+
+  // Reads a <width>x<height> size option into `size`, if it is set
+  const auto readSize = [&commandLine](const QCommandLineOption &option, QSize &size) {
+    if (!commandLine.isSet(option))
+      return true;
+
+    const auto parts = commandLine.value(option).split('x');
+    auto validWidth = false;
+    auto validHeight = false;
+    if (parts.size() == 2)
+      size = {parts[0].toInt(&validWidth), parts[1].toInt(&validHeight)};
+    if (!validWidth || !validHeight || size.isEmpty()) {
+      std::cerr << "--" << option.names().front().toStdString() << " requires a size like 1920x1080\n";
+      return false;
+    }
+    return true;
+  };
+
+  if (commandLine.isSet(captureOption) && commandLine.isSet(exportOption)) {
+    std::cerr << "--capture & --export may not be used together\n";
+    return 1;
+  }
+
+  std::optional<netsimulyzer::ShotList> shots;
+  QSize captureSize{1920, 1080};
+  if (commandLine.isSet(captureOption)) {
+    if (commandLine.positionalArguments().size() != 1) {
+      std::cerr << "--capture requires one scenario file\n";
+      return 1;
+    }
+
+    shots = netsimulyzer::ShotList::read(commandLine.value(captureOption));
+    if (!shots) {
+      std::cerr << "--capture could not read any shots from: " << commandLine.value(captureOption).toStdString()
+                << '\n';
+      return 1;
+    }
+
+    if (!readSize(captureSizeOption, captureSize))
+      return 1;
+  }
+
+  QSize exportSize{1920, 1080};
+  auto exportFirstFrame = 0ULL;
+  std::optional<unsigned long long> exportFrames;
+  auto exportJobs = 1;
+  if (commandLine.isSet(exportOption)) {
+    if (commandLine.positionalArguments().size() != 1) {
+      std::cerr << "--export requires one scenario file\n";
+      return 1;
+    }
+
+    if (!readSize(exportSizeOption, exportSize))
+      return 1;
+
+    if (commandLine.isSet(exportFramesOption)) {
+      const auto range = commandLine.value(exportFramesOption).split(':');
+      auto validFirst = false;
+      auto validCount = false;
+      if (range.size() == 2) {
+        exportFirstFrame = range[0].toULongLong(&validFirst);
+        exportFrames = range[1].toULongLong(&validCount);
+      }
+      if (!validFirst || !validCount || exportFrames == 0u) {
+        std::cerr << "--export-frames requires a range like 0:100\n";
+        return 1;
+      }
+    }
+
+    if (commandLine.isSet(exportJobsOption)) {
+      auto valid = false;
+      exportJobs = commandLine.value(exportJobsOption).toInt(&valid);
+      if (!valid || exportJobs < 1) {
+        std::cerr << "--export-jobs requires a whole number of jobs greater than 0\n";
+        return 1;
+      }
+      if (exportJobs > 1 && exportFrames) {
+        std::cerr << "--export-jobs & --export-frames may not be used together\n";
+        return 1;
+      }
+    }
+  }
+
+  auto memoryReportInterval = 0;
+  if (commandLine.isSet(memoryReportOption)) {
+    auto valid = false;
+    memoryReportInterval = commandLine.value(memoryReportOption).toInt(&valid);
+    if (!valid || memoryReportInterval < 1) {
+      std::cerr << "--memory-report requires a whole number of seconds greater than 0\n";
+      return 1;
+    }
+  }
+
+  auto metricsLogInterval = 0;
+  if (commandLine.isSet(metricsLogOption)) {
+    auto valid = false;
+    metricsLogInterval = commandLine.value(metricsLogOption).toInt(&valid);
+    if (!valid || metricsLogInterval < 1) {
+      std::cerr << "--metrics-log requires a whole number of seconds greater than 0\n";
+      return 1;
+    }
+  }
+
+  if (commandLine.isSet(wallLeadOption) && commandLine.isSet(wallNodeOption)) {
+    std::cerr << "--wall-lead & --wall-node may not be used together\n";
+    return 1;
+  }
+
+  netsimulyzer::WallTile wallTile;
+  if (commandLine.isSet(wallTileOption)) {
+    const auto parts = commandLine.value(wallTileOption).split(':');
+    const auto grid = parts.front().split('x');
+    const auto position = parts.back().split(',');
+    auto valid = parts.size() == 2 && grid.size() == 2 && position.size() == 2;
+    const auto read = [&valid](const QString &text) {
+      auto parsed = false;
+      const auto value = text.toInt(&parsed);
+      valid = valid && parsed;
+      return value;
+    };
+    if (valid)
+      wallTile = {read(grid[0]), read(grid[1]), read(position[0]), read(position[1])};
+
+    if (!valid || wallTile.columns < 1 || wallTile.rows < 1 || wallTile.column < 0 ||
+        wallTile.column >= wallTile.columns || wallTile.row < 0 || wallTile.row >= wallTile.rows) {
+      std::cerr << "--wall-tile requires <columns>x<rows>:<column>,<row>, with the tile inside the wall\n";
+      return 1;
+    }
+  }
+
   // Make sure the theme stylesheets are loaded
   // before we open anything
   settings.setTheme();
@@ -294,6 +505,54 @@ int main(int argc, char *argv[]) {
     settings.sync();
   }
   netsimulyzer::MainWindow mainWindow;
+  mainWindow.setMemoryReportInterval(memoryReportInterval);
+  mainWindow.setMetricsLogInterval(metricsLogInterval);
+  if (commandLine.isSet(metricsOption)) {
+    if (const auto error = mainWindow.serveMetrics(commandLine.value(metricsOption))) {
+      std::cerr << "--metrics failed: " << error->toStdString() << '\n';
+      return 1;
+    }
+  }
+  if (commandLine.isSet(serveOption)) {
+    if (const auto error = mainWindow.serve(commandLine.value(serveOption))) {
+      std::cerr << "--serve failed: " << error->toStdString() << '\n';
+      return 1;
+    }
+  }
+
+  if (commandLine.isSet(wallLeadOption)) {
+    if (const auto error = mainWindow.leadWall(commandLine.value(wallLeadOption).split(','))) {
+      std::cerr << "--wall-lead failed: " << error->toStdString() << '\n';
+      return 1;
+    }
+  }
+  if (commandLine.isSet(wallNodeOption)) {
+    const auto scenario = commandLine.positionalArguments().value(0);
+    if (const auto error = mainWindow.joinWall(commandLine.value(wallNodeOption), wallTile, scenario)) {
+      std::cerr << "--wall-node failed: " << error->toStdString() << '\n';
+      return 1;
+    }
+    mainWindow.setWindowState(Qt::WindowFullScreen);
+  }
+
+  // Drawn offscreen, though the window must still be "shown" for its OpenGL context
+  if (shots) {
+    mainWindow.setAttribute(Qt::WA_DontShowOnScreen);
+    mainWindow.capture(commandLine.positionalArguments().front(), shots.value(),
+                       commandLine.value(captureDirectoryOption), captureSize);
+  } else if (commandLine.isSet(exportOption)) {
+    mainWindow.setAttribute(Qt::WA_DontShowOnScreen);
+    if (exportJobs > 1)
+      mainWindow.exportInParallel(commandLine.positionalArguments().front(), commandLine.value(exportOption),
+                                  exportSize, exportJobs);
+    else
+      mainWindow.exportFrames(commandLine.positionalArguments().front(), commandLine.value(exportOption), exportSize,
+                              exportFirstFrame, exportFrames);
+  }
   mainWindow.show();
-  return QApplication::exec();
+  const auto result = QApplication::exec();
+
+  // Written on exit, so the trace covers the whole session
+  parser::trace::stop();
+  return result;
 }
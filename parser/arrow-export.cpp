@@ -0,0 +1,736 @@
+/*
+ * NIST-developed software is provided by NIST as a public service. You may use,
+ * copy and distribute copies of the software in any medium, provided that you
+ * keep intact this entire notice. You may improve,modify and create derivative
+ * works of the software or any portion of the software, and you may copy and
+ * distribute such modifications or works. Modified works should carry a notice
+ * stating that you changed the software and should note the date and nature of
+ * any such change. Please explicitly acknowledge the National Institute of
+ * Standards and Technology as the source of the software.
+ *
+ * NIST-developed software is expressly provided "AS IS." NIST MAKES NO
+ * WARRANTY OF ANY KIND, EXPRESS, IMPLIED, IN FACT OR ARISING BY OPERATION OF
+ * LAW, INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTY OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, NON-INFRINGEMENT
+ * AND DATA ACCURACY. NIST NEITHER REPRESENTS NOR WARRANTS THAT THE
+ * OPERATION OF THE SOFTWARE WILL BE UNINTERRUPTED OR ERROR-FREE, OR THAT
+ * ANY DEFECTS WILL BE CORRECTED. NIST DOES NOT WARRANT OR MAKE ANY
+ * REPRESENTATIONS REGARDING THE USE OF THE SOFTWARE OR THE RESULTS THEREOF,
+ * INCLUDING BUT NOT LIMITED TO THE CORRECTNESS, ACCURACY, RELIABILITY,
+ * OR USEFULNESS OF THE SOFTWARE.
+ *
+ * You are solely responsible for determining the appropriateness of using and
+ * distributing the software and you assume all risks associated with its use,
+ * including but not limited to the risks and costs of program errors,
+ * compliance with applicable laws, damage to or loss of data, programs or
+ * equipment, and the unavailability or interruption of operation. This
+ * software is not intended to be used in any situation where a failure could
+ * cause risk of injury or damage to property. The software developed by NIST
+ * employees is not subject to copyright protection within the United States.
+ *
+ * Author: Evan Black <evan.black@nist.gov>
+ */
+
+#include "arrow-export.h"
+#include "task-pool.h"
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <functional>
+#include <iterator>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <variant>
+
+namespace {
+
+/**
+ * Builds a flatbuffer back to front, as the FlatBuffers library does,
+ * so each offset points forward, to an object built before it.
+ * Objects are referred to by their distance from the end of the buffer.
+ *
+ * Only what the Arrow metadata needs: scalars, strings, vectors & tables
+ */
+class FlatBuilder {
+  /**
+   * The buffer, in reverse, so building in front is appending
+   */
+  std::vector<uint8_t> reversed;
+
+  /**
+   * The distance from the end of each field of the open table, by ID
+   */
+  std::vector<std::pair<int, uint32_t>> fields;
+
+  /**
+   * `size()` when the open table was started
+   */
+  uint32_t tableStart{0u};
+
+  void pad(std::size_t bytes) {
+    reversed.insert(reversed.end(), bytes, 0u);
+  }
+
+  /**
+   * Pad so the end of the next `bytes` is aligned to `alignment`
+   */
+  void align(std::size_t bytes, std::size_t alignment) {
+    pad((alignment - (reversed.size() + bytes) % alignment) % alignment);
+  }
+
+  void push(const void *data, std::size_t bytes) {
+    const auto first = static_cast<const uint8_t *>(data);
+    reversed.insert(reversed.end(), std::make_reverse_iterator(first + bytes), std::make_reverse_iterator(first));
+  }
+
+  template <class T>
+  void push(T value) {
+    push(&value, sizeof(T));
+  }
+
+  template <class T>
+  uint32_t scalar(T value) {
+    align(sizeof(T), sizeof(T));
+    push(value);
+    return size();
+  }
+
+public:
+  [[nodiscard]] uint32_t size() const {
+    return static_cast<uint32_t>(reversed.size());
+  }
+
+  uint32_t offset(uint32_t object) {
+    align(4u, 4u);
+    return scalar(size() + 4u - object);
+  }
+
+  uint32_t string(std::string_view value) {
+    align(value.size() + 1u, 4u);
+    pad(1u);
+    push(value.data(), value.size());
+    return scalar(static_cast<uint32_t>(value.size()));
+  }
+
+  uint32_t offsets(const std::vector<uint32_t> &objects) {
+    align(objects.size() * 4u, 4u);
+    for (auto i = objects.size(); i-- > 0u;)
+      offset(objects[i]);
+    return scalar(static_cast<uint32_t>(objects.size()));
+  }
+
+  /**
+   * @param raw
+   * The structs, one after another, including their padding
+   *
+   * @param count
+   * The number of structs in `raw`
+   */
+  uint32_t structs(const std::vector<uint8_t> &raw, std::size_t count) {
+    // Every struct in the Arrow metadata is 8 byte aligned
+    align(raw.size(), 8u);
+    push(raw.data(), raw.size());
+    return scalar(static_cast<uint32_t>(count));
+  }
+
+  void startTable() {
+    fields.clear();
+    tableStart = size();
+  }
+
+  template <class T>
+  void field(int id, T value) {
+    fields.emplace_back(id, scalar(value));
+  }
+
+  void fieldOffset(int id, uint32_t object) {
+    fields.emplace_back(id, offset(object));
+  }
+
+  uint32_t endTable() {
+    const auto table = scalar(int32_t{0});
+
+    auto entries = 0;
+    for (const auto &[id, position] : fields)
+      entries = std::max(entries, id + 1);
+    std::vector<uint16_t> vtable(static_cast<std::size_t>(entries), 0u);
+    for (const auto &[id, position] : fields)
+      vtable[static_cast<std::size_t>(id)] = static_cast<uint16_t>(table - position);
+
+    for (auto i = vtable.size(); i-- > 0u;)
+      push(vtable[i]);
+    push(static_cast<uint16_t>(table - tableStart));
+    push(static_cast<uint16_t>((vtable.size() + 2u) * 2u));
+
+    // The table points back at its vtable, built just in front of it
+    const auto soffset = static_cast<int32_t>(size() - table);
+    std::array<uint8_t, 4> bytes{};
+    std::memcpy(bytes.data(), &soffset, bytes.size());
+    for (auto i = 0u; i < bytes.size(); i++)
+      reversed[table - 1u - i] = bytes[i];
+    return table;
+  }
+
+  /**
+   * @return
+   * The finished buffer, a multiple of 8 bytes, with `root` as its root table
+   */
+  std::vector<uint8_t> finish(uint32_t root) {
+    align(4u, 8u);
+    offset(root);
+    return {reversed.rbegin(), reversed.rend()};
+  }
+};
+
+// From the Arrow 'Schema.fbs' & 'Message.fbs'
+constexpr int16_t metadataV5 = 4;
+constexpr uint8_t headerSchema = 1u;
+constexpr uint8_t headerRecordBatch = 3u;
+
+constexpr uint8_t typeInt = 2u;
+constexpr uint8_t typeFloatingPoint = 3u;
+constexpr uint8_t typeUtf8 = 5u;
+constexpr uint8_t typeBool = 6u;
+constexpr uint8_t typeDuration = 18u;
+
+constexpr int16_t precisionSingle = 1;
+constexpr int16_t precisionDouble = 2;
+constexpr int16_t unitNanosecond = 3;
+
+constexpr char magic[] = "ARROW1";
+
+std::size_t padded(std::size_t bytes) {
+  return (bytes + 7u) & ~std::size_t{7u};
+}
+
+template <class T>
+void appendRaw(std::vector<uint8_t> &out, T value) {
+  const auto first = reinterpret_cast<const uint8_t *>(&value);
+  out.insert(out.end(), first, first + sizeof(T));
+}
+
+uint32_t buildType(FlatBuilder &builder, parser::ArrowWriter::Type type) {
+  using Type = parser::ArrowWriter::Type;
+  builder.startTable();
+  switch (type) {
+  case Type::Int64:
+    builder.field(0, int32_t{64});
+    builder.field(1, uint8_t{1u});
+    break;
+  case Type::UInt32:
+    builder.field(0, int32_t{32});
+    builder.field(1, uint8_t{0u});
+    break;
+  case Type::UInt8:
+    builder.field(0, int32_t{8});
+    builder.field(1, uint8_t{0u});
+    break;
+  case Type::Float32:
+    builder.field(0, precisionSingle);
+    break;
+  case Type::Float64:
+    builder.field(0, precisionDouble);
+    break;
+  case Type::Duration:
+    builder.field(0, unitNanosecond);
+    break;
+  case Type::Bool:
+  case Type::Utf8:
+    break;
+  }
+  return builder.endTable();
+}
+
+uint8_t typeId(parser::ArrowWriter::Type type) {
+  using Type = parser::ArrowWriter::Type;
+  switch (type) {
+  case Type::Int64:
+  case Type::UInt32:
+  case Type::UInt8:
+    return typeInt;
+  case Type::Float32:
+  case Type::Float64:
+    return typeFloatingPoint;
+  case Type::Duration:
+    return typeDuration;
+  case Type::Bool:
+    return typeBool;
+  case Type::Utf8:
+    return typeUtf8;
+  }
+  return 0u;
+}
+
+uint32_t buildSchema(FlatBuilder &builder, const std::vector<parser::ArrowWriter::Field> &fields) {
+  std::vector<uint32_t> fieldTables;
+  fieldTables.reserve(fields.size());
+  for (const auto &field : fields) {
+    const auto type = buildType(builder, field.type);
+    const auto name = builder.string(field.name);
+    // Readers expect the children, even when there are none
+    const auto children = builder.offsets({});
+
+    builder.startTable();
+    builder.fieldOffset(0, name);
+    builder.field(1, static_cast<uint8_t>(field.nullable));
+    builder.field(2, typeId(field.type));
+    builder.fieldOffset(3, type);
+    builder.fieldOffset(5, children);
+    fieldTables.emplace_back(builder.endTable());
+  }
+  const auto fieldVector = builder.offsets(fieldTables);
+
+  builder.startTable();
+  // Little endian
+  builder.field(0, int16_t{0});
+  builder.fieldOffset(1, fieldVector);
+  return builder.endTable();
+}
+
+std::vector<uint8_t> buildMessage(FlatBuilder &builder, uint8_t headerType, uint32_t header, int64_t bodyLength) {
+  builder.startTable();
+  builder.field(0, metadataV5);
+  builder.field(1, headerType);
+  builder.fieldOffset(2, header);
+  builder.field(3, bodyLength);
+  return builder.finish(builder.endTable());
+}
+
+std::size_t fixedWidth(parser::ArrowWriter::Type type) {
+  using Type = parser::ArrowWriter::Type;
+  switch (type) {
+  case Type::Duration:
+  case Type::Int64:
+  case Type::Float64:
+    return 8u;
+  case Type::UInt32:
+  case Type::Float32:
+    return 4u;
+  case Type::UInt8:
+    return 1u;
+  case Type::Bool:
+  case Type::Utf8:
+    break;
+  }
+  return 0u;
+}
+
+} // namespace
+
+namespace parser {
+
+ArrowWriter::ArrowWriter(const std::string &path, std::vector<Field> fields, std::size_t batchRows)
+    : out(path, std::ios::binary | std::ios::trunc),
+      fields(std::move(fields)),
+      columns(this->fields.size()),
+      batchRows(std::max(std::size_t{1u}, batchRows)) {
+  for (std::size_t i = 0u; i < this->fields.size(); i++) {
+    if (this->fields[i].type == Type::Utf8)
+      columns[i].offsets.emplace_back(0);
+  }
+
+  writePadded(magic, sizeof(magic) - 1u);
+
+  FlatBuilder builder;
+  const auto schema = buildSchema(builder, this->fields);
+  writeMessage(buildMessage(builder, headerSchema, schema, 0), {});
+}
+
+void ArrowWriter::writePadded(const void *data, std::size_t bytes) {
+  static constexpr std::array<char, 8> zeros{};
+  out.write(static_cast<const char *>(data), static_cast<std::streamsize>(bytes));
+  out.write(zeros.data(), static_cast<std::streamsize>(padded(bytes) - bytes));
+  written += static_cast<int64_t>(padded(bytes));
+}
+
+ArrowWriter::Block ArrowWriter::writeMessage(const std::vector<uint8_t> &metadata,
+                                             const std::vector<std::vector<uint8_t>> &body) {
+  Block block{written, 0, 0};
+
+  // The continuation marker, then the length of the metadata
+  std::array<int32_t, 2> prefix{-1, static_cast<int32_t>(metadata.size())};
+  writePadded(prefix.data(), sizeof(prefix));
+  writePadded(metadata.data(), metadata.size());
+  block.metadataLength = static_cast<int32_t>(written - block.offset);
+
+  for (const auto &buffer : body)
+    writePadded(buffer.data(), buffer.size());
+  block.bodyLength = written - block.offset - block.metadataLength;
+  return block;
+}
+
+void ArrowWriter::writeBatch() {
+  if (rows == 0u)
+    return;
+
+  // Each column is its validity bitmap, then its values, or its offsets & characters
+  std::vector<std::vector<uint8_t>> body;
+  std::vector<uint8_t> nodes;
+  std::vector<uint8_t> buffers;
+  int64_t bodyOffset = 0;
+  auto addBuffer = [&body, &buffers, &bodyOffset](std::vector<uint8_t> buffer) {
+    appendRaw(buffers, bodyOffset);
+    appendRaw(buffers, static_cast<int64_t>(buffer.size()));
+    bodyOffset += static_cast<int64_t>(padded(buffer.size()));
+    body.emplace_back(std::move(buffer));
+  };
+
+  for (std::size_t i = 0u; i < fields.size(); i++) {
+    auto &column = columns[i];
+    appendRaw(nodes, static_cast<int64_t>(rows));
+    appendRaw(nodes, static_cast<int64_t>(column.nulls));
+
+    // Without nulls, the validity bitmap may be left out
+    addBuffer(column.nulls > 0u ? std::move(column.validity) : std::vector<uint8_t>{});
+    if (fields[i].type == Type::Utf8) {
+      std::vector<uint8_t> offsets(column.offsets.size() * sizeof(int32_t));
+      std::memcpy(offsets.data(), column.offsets.data(), offsets.size());
+      addBuffer(std::move(offsets));
+    }
+    addBuffer(std::move(column.values));
+
+    column = Column{};
+    if (fields[i].type == Type::Utf8)
+      column.offsets.emplace_back(0);
+  }
+
+  FlatBuilder builder;
+  const auto nodeVector = builder.structs(nodes, fields.size());
+  const auto bufferVector = builder.structs(buffers, buffers.size() / 16u);
+  builder.startTable();
+  builder.field(0, static_cast<int64_t>(rows));
+  builder.fieldOffset(1, nodeVector);
+  builder.fieldOffset(2, bufferVector);
+  const auto batch = builder.endTable();
+
+  blocks.emplace_back(writeMessage(buildMessage(builder, headerRecordBatch, batch, bodyOffset), body));
+  rows = 0u;
+}
+
+void ArrowWriter::advance(bool valid) {
+  if (fields[nextColumn].nullable) {
+    auto &validity = columns[nextColumn].validity;
+    if (validity.size() * 8u <= rows)
+      validity.emplace_back(0u);
+    if (valid)
+      validity[rows / 8u] |= static_cast<uint8_t>(1u << (rows % 8u));
+  }
+
+  if (++nextColumn < fields.size())
+    return;
+
+  nextColumn = 0u;
+  total++;
+  if (++rows == batchRows)
+    writeBatch();
+}
+
+void ArrowWriter::addBytes(const void *data, std::size_t bytes) {
+  auto &values = columns[nextColumn].values;
+  const auto first = static_cast<const uint8_t *>(data);
+  values.insert(values.end(), first, first + bytes);
+  advance();
+}
+
+void ArrowWriter::add(long long value) {
+  addBytes(&value, sizeof(value));
+}
+
+void ArrowWriter::add(uint32_t value) {
+  addBytes(&value, sizeof(value));
+}
+
+void ArrowWriter::add(uint8_t value) {
+  addBytes(&value, sizeof(value));
+}
+
+void ArrowWriter::add(float value) {
+  addBytes(&value, sizeof(value));
+}
+
+void ArrowWriter::add(double value) {
+  addBytes(&value, sizeof(value));
+}
+
+void ArrowWriter::add(bool value) {
+  // Booleans are bits, like the validity bitmap
+  auto &values = columns[nextColumn].values;
+  if (values.size() * 8u <= rows)
+    values.emplace_back(0u);
+  if (value)
+    values[rows / 8u] |= static_cast<uint8_t>(1u << (rows % 8u));
+  advance();
+}
+
+void ArrowWriter::add(std::string_view value) {
+  auto &column = columns[nextColumn];
+  column.values.insert(column.values.end(), value.begin(), value.end());
+  column.offsets.emplace_back(static_cast<int32_t>(column.values.size()));
+  advance();
+}
+
+void ArrowWriter::addNull() {
+  auto &column = columns[nextColumn];
+  column.nulls++;
+
+  // A slot is still taken by the value
+  switch (fields[nextColumn].type) {
+  case Type::Utf8:
+    column.offsets.emplace_back(static_cast<int32_t>(column.values.size()));
+    break;
+  case Type::Bool:
+    if (column.values.size() * 8u <= rows)
+      column.values.emplace_back(0u);
+    break;
+  default:
+    column.values.insert(column.values.end(), fixedWidth(fields[nextColumn].type), 0u);
+    break;
+  }
+  advance(false);
+}
+
+bool ArrowWriter::finish() {
+  writeBatch();
+
+  // End of stream
+  std::array<int32_t, 2> end{-1, 0};
+  writePadded(end.data(), sizeof(end));
+
+  std::vector<uint8_t> raw;
+  for (const auto &block : blocks) {
+    appendRaw(raw, block.offset);
+    appendRaw(raw, block.metadataLength);
+    appendRaw(raw, int32_t{0});
+    appendRaw(raw, block.bodyLength);
+  }
+
+  FlatBuilder builder;
+  const auto schema = buildSchema(builder, fields);
+  const auto dictionaries = builder.structs({}, 0u);
+  const auto batches = builder.structs(raw, blocks.size());
+  builder.startTable();
+  builder.field(0, metadataV5);
+  builder.fieldOffset(1, schema);
+  builder.fieldOffset(2, dictionaries);
+  builder.fieldOffset(3, batches);
+  const auto footer = builder.finish(builder.endTable());
+
+  const auto footerLength = static_cast<int32_t>(footer.size());
+  out.write(reinterpret_cast<const char *>(footer.data()), static_cast<std::streamsize>(footer.size()));
+  out.write(reinterpret_cast<const char *>(&footerLength), sizeof(footerLength));
+  out.write(magic, sizeof(magic) - 1u);
+  out.close();
+  return !out.fail();
+}
+
+std::size_t ArrowWriter::size() const {
+  return total;
+}
+
+std::vector<EventExport> exportEvents(const FileParser &fileParser, const std::string &directory,
+                                      std::size_t batchRows, unsigned int threads) {
+  using Type = ArrowWriter::Type;
+  const auto &sceneEvents = fileParser.getSceneEvents();
+  const auto &chartEvents = fileParser.getChartsEvents();
+  const auto &logEvents = fileParser.getLogEvents();
+
+  // Each file takes one kind of event from its list
+  struct Table {
+    const char *name;
+    std::vector<ArrowWriter::Field> fields;
+    std::function<void(ArrowWriter &)> write;
+  };
+
+  const auto position = [](ArrowWriter &writer, uint32_t id, nanoseconds time, const Ns3Coordinate &target) {
+    writer.add(time);
+    writer.add(id);
+    writer.add(target.x);
+    writer.add(target.y);
+    writer.add(target.z);
+  };
+  const auto orientation = [](ArrowWriter &writer, uint32_t id, nanoseconds time,
+                              const std::array<double, 3> &target) {
+    writer.add(time);
+    writer.add(id);
+    writer.add(target[0]);
+    writer.add(target[1]);
+    writer.add(target[2]);
+  };
+  const auto each = [](const auto &events, auto write) {
+    for (const auto &event : events)
+      std::visit(write, event);
+  };
+
+  std::vector<Table> tables;
+  tables.push_back({"node_moves.arrow",
+                    {{"time", Type::Duration},
+                     {"node", Type::UInt32},
+                     {"x", Type::Float32},
+                     {"y", Type::Float32},
+                     {"z", Type::Float32}},
+                    [&](ArrowWriter &writer) {
+                      each(sceneEvents, [&](const auto &e) {
+                        if constexpr (std::is_same_v<std::decay_t<decltype(e)>, MoveEvent>)
+                          position(writer, e.nodeId, e.time, e.targetPosition);
+                      });
+                    }});
+  tables.push_back({"node_orientations.arrow",
+                    {{"time", Type::Duration},
+                     {"node", Type::UInt32},
+                     {"x", Type::Float64},
+                     {"y", Type::Float64},
+                     {"z", Type::Float64}},
+                    [&](ArrowWriter &writer) {
+                      each(sceneEvents, [&](const auto &e) {
+                        if constexpr (std::is_same_v<std::decay_t<decltype(e)>, NodeOrientationChangeEvent>)
+                          orientation(writer, e.nodeId, e.time, e.targetOrientation);
+                      });
+                    }});
+  tables.push_back({"node_colors.arrow",
+                    {{"time", Type::Duration},
+                     {"node", Type::UInt32},
+                     {"highlight", Type::Bool},
+                     {"red", Type::UInt8, true},
+                     {"green", Type::UInt8, true},
+                     {"blue", Type::UInt8, true}},
+                    [&](ArrowWriter &writer) {
+                      each(sceneEvents, [&](const auto &e) {
+                        if constexpr (std::is_same_v<std::decay_t<decltype(e)>, NodeColorChangeEvent>) {
+                          writer.add(e.time);
+                          writer.add(static_cast<uint32_t>(e.nodeId));
+                          writer.add(e.type == NodeColorChangeEvent::ColorType::Highlight);
+                          if (e.targetColor) {
+                            writer.add(e.targetColor->red);
+                            writer.add(e.targetColor->green);
+                            writer.add(e.targetColor->blue);
+                          } else {
+                            writer.addNull();
+                            writer.addNull();
+                            writer.addNull();
+                          }
+                        }
+                      });
+                    }});
+  tables.push_back({"decoration_moves.arrow",
+                    {{"time", Type::Duration},
+                     {"decoration", Type::UInt32},
+                     {"x", Type::Float32},
+                     {"y", Type::Float32},
+                     {"z", Type::Float32}},
+                    [&](ArrowWriter &writer) {
+                      each(sceneEvents, [&](const auto &e) {
+                        if constexpr (std::is_same_v<std::decay_t<decltype(e)>, DecorationMoveEvent>)
+                          position(writer, e.decorationId, e.time, e.targetPosition);
+                      });
+                    }});
+  tables.push_back({"decoration_orientations.arrow",
+                    {{"time", Type::Duration},
+                     {"decoration", Type::UInt32},
+                     {"x", Type::Float64},
+                     {"y", Type::Float64},
+                     {"z", Type::Float64}},
+                    [&](ArrowWriter &writer) {
+                      each(sceneEvents, [&](const auto &e) {
+                        if constexpr (std::is_same_v<std::decay_t<decltype(e)>, DecorationOrientationChangeEvent>)
+                          orientation(writer, e.decorationId, e.time, e.targetOrientation);
+                      });
+                    }});
+  tables.push_back({"transmits.arrow",
+                    {{"time", Type::Duration},
+                     {"node", Type::UInt32},
+                     {"duration", Type::Duration},
+                     {"size", Type::Float64},
+                     {"red", Type::UInt8},
+                     {"green", Type::UInt8},
+                     {"blue", Type::UInt8}},
+                    [&](ArrowWriter &writer) {
+                      each(sceneEvents, [&](const auto &e) {
+                        if constexpr (std::is_same_v<std::decay_t<decltype(e)>, TransmitEvent>) {
+                          writer.add(e.time);
+                          writer.add(e.nodeId);
+                          writer.add(e.duration);
+                          writer.add(e.targetSize);
+                          writer.add(e.color.red);
+                          writer.add(e.color.green);
+                          writer.add(e.color.blue);
+                        }
+                      });
+                    }});
+  tables.push_back({"series_points.arrow",
+                    {{"time", Type::Duration}, {"series", Type::UInt32}, {"x", Type::Float64}, {"y", Type::Float64}},
+                    [&](ArrowWriter &writer) {
+                      const auto point = [&writer](nanoseconds time, uint32_t series, const XYPoint &value) {
+                        writer.add(time);
+                        writer.add(series);
+                        writer.add(value.x);
+                        writer.add(value.y);
+                      };
+                      each(chartEvents, [&](const auto &e) {
+                        using T = std::decay_t<decltype(e)>;
+                        if constexpr (std::is_same_v<T, XYSeriesAddValue>) {
+                          point(e.time, e.seriesId, e.point);
+                        } else if constexpr (std::is_same_v<T, XYSeriesAddValues>) {
+                          for (const auto &value : e.points)
+                            point(e.time, e.seriesId, value);
+                        }
+                      });
+                    }});
+  tables.push_back({"series_clears.arrow",
+                    {{"time", Type::Duration}, {"series", Type::UInt32}},
+                    [&](ArrowWriter &writer) {
+                      each(chartEvents, [&](const auto &e) {
+                        if constexpr (std::is_same_v<std::decay_t<decltype(e)>, XYSeriesClear>) {
+                          writer.add(e.time);
+                          writer.add(e.seriesId);
+                        }
+                      });
+                    }});
+  tables.push_back({"category_points.arrow",
+                    {{"time", Type::Duration},
+                     {"series", Type::UInt32},
+                     {"value", Type::Float64},
+                     {"category", Type::UInt32}},
+                    [&](ArrowWriter &writer) {
+                      each(chartEvents, [&](const auto &e) {
+                        if constexpr (std::is_same_v<std::decay_t<decltype(e)>, CategorySeriesAddValue>) {
+                          writer.add(e.time);
+                          writer.add(e.seriesId);
+                          writer.add(e.value);
+                          writer.add(static_cast<uint32_t>(e.category));
+                        }
+                      });
+                    }});
+  tables.push_back({"log.arrow",
+                    {{"time", Type::Duration}, {"stream", Type::UInt32}, {"message", Type::Utf8}},
+                    [&](ArrowWriter &writer) {
+                      each(logEvents, [&](const StreamAppendEvent &e) {
+                        writer.add(e.time);
+                        writer.add(static_cast<uint32_t>(e.streamId));
+                        writer.add(std::string_view{e.value});
+                      });
+                    }});
+
+  auto prefix = directory;
+  if (!prefix.empty() && prefix.back() != '/' && prefix.back() != '\\')
+    prefix += '/';
+
+  std::vector<EventExport> exports(tables.size());
+  if (threads == 0u)
+    threads = std::max(1u, std::thread::hardware_concurrency());
+
+  // The files are independent, so each is written on its own thread
+  TaskPool::shared().parallelFor(tables.size(), threads, TaskPool::Priority::Normal, [&](std::size_t i) {
+    auto &result = exports[i];
+    result.path = prefix + tables[i].name;
+
+    ArrowWriter writer{result.path, tables[i].fields, batchRows};
+    tables[i].write(writer);
+    result.rows = writer.size();
+    result.written = writer.finish();
+  });
+
+  return exports;
+}
+
+} // namespace parser
@@ -0,0 +1,275 @@
+/*
+ * NIST-developed software is provided by NIST as a public service. You may use,
+ * copy and distribute copies of the software in any medium, provided that you
+ * keep intact this entire notice. You may improve,modify and create derivative
+ * works of the software or any portion of the software, and you may copy and
+ * distribute such modifications or works. Modified works should carry a notice
+ * stating that you changed the software and should note the date and nature of
+ * any such change. Please explicitly acknowledge the National Institute of
+ * Standards and Technology as the source of the software.
+ *
+ * NIST-developed software is expressly provided "AS IS." NIST MAKES NO
+ * WARRANTY OF ANY KIND, EXPRESS, IMPLIED, IN FACT OR ARISING BY OPERATION OF
+ * LAW, INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTY OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, NON-INFRINGEMENT
+ * AND DATA ACCURACY. NIST NEITHER REPRESENTS NOR WARRANTS THAT THE
+ * OPERATION OF THE SOFTWARE WILL BE UNINTERRUPTED OR ERROR-FREE, OR THAT
+ * ANY DEFECTS WILL BE CORRECTED. NIST DOES NOT WARRANT OR MAKE ANY
+ * REPRESENTATIONS REGARDING THE USE OF THE SOFTWARE OR THE RESULTS THEREOF,
+ * INCLUDING BUT NOT LIMITED TO THE CORRECTNESS, ACCURACY, RELIABILITY,
+ * OR USEFULNESS OF THE SOFTWARE.
+ *
+ * You are solely responsible for determining the appropriateness of using and
+ * distributing the software and you assume all risks associated with its use,
+ * including but not limited to the risks and costs of program errors,
+ * compliance with applicable laws, damage to or loss of data, programs or
+ * equipment, and the unavailability or interruption of operation. This
+ * software is not intended to be used in any situation where a failure could
+ * cause risk of injury or damage to property. The software developed by NIST
+ * employees is not subject to copyright protection within the United States.
+ *
+ * Author: Evan Black <evan.black@nist.gov>
+ */
+
+#pragma once
+
+#include "file-parser.h"
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace parser {
+
+/**
+ * Writes a table to an Arrow IPC file (also known as Feather V2), one record batch at a time,
+ * readable with e.g. `pyarrow.feather.read_table()` or `polars.read_ipc()`.
+ *
+ * Rows are added a value at a time, in column order, and buffered in columns
+ * until `batchRows` rows are waiting, which are then written as one record batch.
+ * The metadata is encoded directly, so Arrow itself is not needed.
+ * Batches are uncompressed & little endian
+ */
+class ArrowWriter {
+public:
+  enum class Type {
+    /**
+     * Nanoseconds, as an Arrow duration, for simulation times
+     */
+    Duration,
+    Int64,
+    UInt32,
+    UInt8,
+    Float32,
+    Float64,
+    Bool,
+    Utf8
+  };
+
+  struct Field {
+    std::string name;
+    Type type;
+
+    /**
+     * True if the column may hold nulls, see `addNull()`
+     */
+    bool nullable{false};
+  };
+
+  /**
+   * The location of a record batch in the file, for the footer
+   */
+  struct Block {
+    int64_t offset;
+    int32_t metadataLength;
+    int64_t bodyLength;
+  };
+
+private:
+  struct Column {
+    /**
+     * One bit per row, set for rows with a value. Only kept for nullable fields
+     */
+    std::vector<uint8_t> validity;
+    std::size_t nulls{0u};
+
+    /**
+     * The fixed width values, or the characters of each string
+     */
+    std::vector<uint8_t> values;
+
+    /**
+     * The start of each string in `values`, then the end of the last one. Only for `Type::Utf8`
+     */
+    std::vector<int32_t> offsets;
+  };
+
+  std::ofstream out;
+  std::vector<Field> fields;
+  std::vector<Column> columns;
+  std::vector<Block> blocks;
+
+  /**
+   * The bytes written to `out` so far
+   */
+  int64_t written{0};
+
+  /**
+   * The number of complete rows in `columns`
+   */
+  std::size_t rows{0u};
+
+  /**
+   * The number of complete rows, including those already written
+   */
+  std::size_t total{0u};
+
+  /**
+   * The column the next value goes to
+   */
+  std::size_t nextColumn{0u};
+
+  std::size_t batchRows;
+
+  /**
+   * Write `bytes` from `data` to `out`, followed by zeros up to a multiple of 8 bytes
+   */
+  void writePadded(const void *data, std::size_t bytes);
+
+  /**
+   * Write a message: its metadata, then its body
+   *
+   * @param metadata
+   * The `Message` flatbuffer
+   *
+   * @param body
+   * The buffers of the message, each a multiple of 8 bytes
+   *
+   * @return
+   * Where the message was written
+   */
+  Block writeMessage(const std::vector<uint8_t> &metadata, const std::vector<std::vector<uint8_t>> &body);
+
+  /**
+   * Write the rows in `columns` as a record batch, then clear them
+   */
+  void writeBatch();
+
+  /**
+   * Move on to the next value of the row, or the next row
+   *
+   * @param valid
+   * False if the value just added is a null
+   */
+  void advance(bool valid = true);
+
+  /**
+   * Add a fixed width value to the next column
+   */
+  void addBytes(const void *data, std::size_t bytes);
+
+public:
+  /**
+   * Create the file at `path`, and write the schema
+   *
+   * @param path
+   * The file to write. Any existing file is overwritten
+   *
+   * @param fields
+   * The columns of the table, in order
+   *
+   * @param batchRows
+   * The most rows in each record batch
+   */
+  ArrowWriter(const std::string &path, std::vector<Field> fields, std::size_t batchRows = 65536u);
+
+  ArrowWriter(const ArrowWriter &) = delete;
+  ArrowWriter &operator=(const ArrowWriter &) = delete;
+
+  /**
+   * Add the next value of the current row.
+   * Its type must match the field of its column:
+   * `long long` for `Type::Duration` & `Type::Int64`, then `uint32_t`, `uint8_t`, `float`, `double`, `bool`
+   * & `std::string_view` for `Type::Utf8`
+   */
+  void add(long long value);
+  void add(uint32_t value);
+  void add(uint8_t value);
+  void add(float value);
+  void add(double value);
+  void add(bool value);
+  void add(std::string_view value);
+
+  /**
+   * Add a null as the next value of the current row. The field must be nullable
+   */
+  void addNull();
+
+  /**
+   * Write the remaining rows & the footer, then close the file
+   *
+   * @return
+   * True if every byte was written
+   */
+  bool finish();
+
+  /**
+   * @return
+   * The number of rows added so far
+   */
+  [[nodiscard]] std::size_t size() const;
+};
+
+/**
+ * The Arrow IPC files written by `exportEvents()`, with the number of rows in each
+ */
+struct EventExport {
+  std::string path;
+  std::size_t rows{0u};
+
+  /**
+   * False if the file could not be written in full
+   */
+  bool written{false};
+};
+
+/**
+ * Write the events of a parsed scenario to one Arrow IPC file per kind of event in `directory`,
+ * each on its own thread. Every file has a `time` column, in nanoseconds, and is in time order:
+ *
+ * - `node_moves.arrow`: `node`, `x`, `y`, `z`
+ * - `node_orientations.arrow`: `node`, `x`, `y`, `z`
+ * - `node_colors.arrow`: `node`, `highlight`, `red`, `green`, `blue` (null when the color is unset)
+ * - `decoration_moves.arrow`: `decoration`, `x`, `y`, `z`
+ * - `decoration_orientations.arrow`: `decoration`, `x`, `y`, `z`
+ * - `transmits.arrow`: `node`, `duration`, `size`, `red`, `green`, `blue`
+ * - `series_points.arrow`: `series`, `x`, `y`, one row per point
+ * - `series_clears.arrow`: `series`
+ * - `category_points.arrow`: `series`, `value`, `category`
+ * - `log.arrow`: `stream`, `message`
+ *
+ * The end of each transmission is its `time` & `duration`, so the ends added by the parser are left out.
+ * The names of the Nodes, series & streams are left in the scenario
+ *
+ * @param fileParser
+ * The parser to export the events of. `parse()` should already have been called on it
+ *
+ * @param directory
+ * An existing directory for the files. Existing files are overwritten
+ *
+ * @param batchRows
+ * The most rows in each record batch
+ *
+ * @param threads
+ * The most files written at once, or 0 for one per core
+ *
+ * @return
+ * Every file, in the order above
+ */
+[[nodiscard]] std::vector<EventExport> exportEvents(const FileParser &fileParser, const std::string &directory,
+                                                    std::size_t batchRows = 65536u, unsigned int threads = 0u);
+
+} // namespace parser
@@ -0,0 +1,756 @@
+/*
+ * NIST-developed software is provided by NIST as a public service. You may use,
+ * copy and distribute copies of the software in any medium, provided that you
+ * keep intact this entire notice. You may improve,modify and create derivative
+ * works of the software or any portion of the software, and you may copy and
+ * distribute such modifications or works. Modified works should carry a notice
+ * stating that you changed the software and should note the date and nature of
+ * any such change. Please explicitly acknowledge the National Institute of
+ * Standards and Technology as the source of the software.
+ *
+ * NIST-developed software is expressly provided "AS IS." NIST MAKES NO
+ * WARRANTY OF ANY KIND, EXPRESS, IMPLIED, IN FACT OR ARISING BY OPERATION OF
+ * LAW, INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTY OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, NON-INFRINGEMENT
+ * AND DATA ACCURACY. NIST NEITHER REPRESENTS NOR WARRANTS THAT THE
+ * OPERATION OF THE SOFTWARE WILL BE UNINTERRUPTED OR ERROR-FREE, OR THAT
+ * ANY DEFECTS WILL BE CORRECTED. NIST DOES NOT WARRANT OR MAKE ANY
+ * REPRESENTATIONS REGARDING THE USE OF THE SOFTWARE OR THE RESULTS THEREOF,
+ * INCLUDING BUT NOT LIMITED TO THE CORRECTNESS, ACCURACY, RELIABILITY,
+ * OR USEFULNESS OF THE SOFTWARE.
+ *
+ * You are solely responsible for determining the appropriateness of using and
+ * distributing the software and you assume all risks associated with its use,
+ * including but not limited to the risks and costs of program errors,
+ * compliance with applicable laws, damage to or loss of data, programs or
+ * equipment, and the unavailability or interruption of operation. This
+ * software is not intended to be used in any situation where a failure could
+ * cause risk of injury or damage to property. The software developed by NIST
+ * employees is not subject to copyright protection within the United States.
+ *
+ * Author: Evan Black <evan.black@nist.gov>
+ */
+#include "BinaryReader.h"
+#include <array>
+#include <cstring>
+#include <exception>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace {
+
+using namespace parser;
+using namespace parser::binary;
+
+class MalformedFileException : public std::exception {
+  std::string message;
+
+public:
+  std::size_t offset;
+
+  MalformedFileException(std::string message, std::size_t offset) : message(std::move(message)), offset(offset) {
+  }
+
+  [[nodiscard]] const char *what() const noexcept override {
+    return message.c_str();
+  }
+};
+
+/**
+ * Bounds checked reader over a single section of the mapped file
+ */
+class SectionCursor {
+  const char *begin;
+  const char *position;
+  const char *end;
+
+  /**
+   * Offset of `begin` from the start of the file.
+   * Used for error reporting
+   */
+  std::size_t fileOffset;
+
+public:
+  SectionCursor(const char *begin, std::size_t size, std::size_t fileOffset)
+      : begin(begin), position(begin), end(begin + size), fileOffset(fileOffset) {
+  }
+
+  [[nodiscard]] std::size_t remaining() const {
+    return static_cast<std::size_t>(end - position);
+  }
+
+  [[nodiscard]] std::size_t offset() const {
+    return fileOffset + static_cast<std::size_t>(position - begin);
+  }
+
+  /**
+   * Advance the cursor by `bytes`
+   *
+   * @return
+   * The position of the cursor before advancing
+   */
+  const char *take(std::size_t bytes) {
+    if (remaining() < bytes)
+      throw MalformedFileException{"Section truncated", offset()};
+
+    const auto start = position;
+    position += bytes;
+    return start;
+  }
+
+  template <typename T>
+  T get() {
+    static_assert(std::is_trivially_copyable_v<T>, "Only trivially copyable values may be read directly");
+    T value;
+    std::memcpy(&value, take(sizeof(T)), sizeof(T));
+    return value;
+  }
+
+  bool getBool() {
+    return get<uint8_t>() != 0u;
+  }
+
+  template <typename T>
+  std::optional<T> getOptional() {
+    if (!getBool())
+      return {};
+
+    return get<T>();
+  }
+
+  /**
+   * Read a count of elements, with a sanity check against the remaining size
+   *
+   * @param elementSize
+   * The smallest possible size of each element,
+   * used to reject counts which could not fit in the section
+   */
+  std::size_t getCount(std::size_t elementSize = 1u) {
+    const auto count = get<uint64_t>();
+    if (elementSize > 0u && count > remaining() / elementSize)
+      throw MalformedFileException{"Element count exceeds section size", offset()};
+
+    return static_cast<std::size_t>(count);
+  }
+
+  void align() {
+    const auto relative = static_cast<std::size_t>(position - begin);
+    const auto aligned = (relative + sectionAlignment - 1u) & ~(sectionAlignment - 1u);
+    take(aligned - relative);
+  }
+};
+
+/**
+ * Read one column of an event table into `rows`
+ *
+ * @tparam Column
+ * The type stored in the file for this column
+ *
+ * @param rows
+ * The events which make up the table. Should already be sized to the number of rows
+ *
+ * @param setter
+ * Callable which assigns the value of the column to an event
+ */
+template <typename Column, typename Event, typename Setter>
+void readColumn(SectionCursor &cursor, std::vector<Event> &rows, Setter setter) {
+  cursor.align();
+  if (rows.size() > cursor.remaining() / sizeof(Column))
+    throw MalformedFileException{"Column truncated", cursor.offset()};
+
+  const auto data = cursor.take(rows.size() * sizeof(Column));
+  for (std::size_t i = 0; i < rows.size(); i++) {
+    Column value;
+    std::memcpy(&value, data + i * sizeof(Column), sizeof(Column));
+    setter(rows[i], value);
+  }
+}
+
+/**
+ * Start reading a table, sizing `rows` to the row count of the table
+ */
+template <typename Event>
+void readTableSize(SectionCursor &cursor, std::vector<Event> &rows) {
+  cursor.align();
+  rows.resize(cursor.getCount());
+}
+
+/**
+ * Rebuild the original, ordered, event collection from the kind of each event
+ * and the tables read for each kind
+ *
+ * @param kinds
+ * The kind of each event, in the original order
+ *
+ * @param tables
+ * Tuple of vectors, one for each alternative in `Variant`.
+ * Events are moved out of the tables
+ */
+template <typename Variant, std::size_t... Index, typename Tables>
+void mergeEvents(const char *kinds, std::size_t count, std::size_t kindsOffset, Tables &tables,
+                 std::vector<Variant> &events, std::index_sequence<Index...>) {
+  std::array<std::size_t, sizeof...(Index)> next{};
+  events.reserve(events.size() + count);
+
+  for (std::size_t i = 0; i < count; i++) {
+    const auto kind = static_cast<std::size_t>(static_cast<uint8_t>(kinds[i]));
+
+    // Expands to one check for each alternative in the variant,
+    // only the one matching `kind` does anything
+    const auto matched = ((kind == Index && [&]() {
+                            auto &table = std::get<Index>(tables);
+                            if (next[Index] == table.size())
+                              return false;
+
+                            events.emplace_back(std::move(table[next[Index]++]));
+                            return true;
+                          }()) ||
+                          ...);
+
+    if (!matched)
+      throw MalformedFileException{"Invalid event kind or event table too small", kindsOffset + i};
+  }
+}
+
+ValueAxis readValueAxis(const BinaryReader &reader, SectionCursor &cursor) {
+  ValueAxis axis;
+  axis.name = reader.string(cursor.get<uint32_t>());
+  axis.boundMode = static_cast<ValueAxis::BoundMode>(cursor.get<uint8_t>());
+  axis.scale = static_cast<ValueAxis::Scale>(cursor.get<uint8_t>());
+  axis.min = cursor.get<double>();
+  axis.max = cursor.get<double>();
+  return axis;
+}
+
+void readConfiguration(const BinaryReader &reader, SectionCursor cursor, GlobalConfiguration &config) {
+  config.moduleVersion.major = static_cast<long>(cursor.get<int64_t>());
+  config.moduleVersion.minor = static_cast<long>(cursor.get<int64_t>());
+  config.moduleVersion.patch = static_cast<long>(cursor.get<int64_t>());
+  config.moduleVersion.suffix = reader.string(cursor.get<uint32_t>());
+  config.endTime = cursor.get<int64_t>();
+  config.timeStep = cursor.getOptional<int64_t>();
+
+  if (cursor.getBool())
+    config.granularity = reader.string(cursor.get<uint32_t>());
+
+  config.minLocation = cursor.get<Ns3Coordinate>();
+  config.maxLocation = cursor.get<Ns3Coordinate>();
+}
+
+void readNodes(const BinaryReader &reader, SectionCursor cursor, uint16_t version, std::vector<Node> &nodes) {
+  const auto count = cursor.getCount();
+  nodes.reserve(count);
+
+  for (std::size_t i = 0; i < count; i++) {
+    Node node;
+    node.id = cursor.get<uint32_t>();
+    node.name = reader.string(cursor.get<uint32_t>());
+    node.labelEnabled = cursor.getBool();
+    node.model = reader.string(cursor.get<uint32_t>());
+    node.scale = cursor.get<std::array<float, 3>>();
+    node.keepRatio = cursor.getBool();
+    node.height = cursor.getOptional<float>();
+    node.width = cursor.getOptional<float>();
+    node.depth = cursor.getOptional<float>();
+    node.visible = cursor.getBool();
+    node.position = cursor.get<Ns3Coordinate>();
+    node.offset = cursor.get<Ns3Coordinate>();
+    node.baseColor = cursor.getOptional<Ns3Color3>();
+    node.highlightColor = cursor.getOptional<Ns3Color3>();
+    node.trailEnabled = cursor.getBool();
+    node.trailColor = cursor.get<Ns3Color3>();
+    node.orientation = cursor.get<std::array<double, 3>>();
+
+    // Version 2 and before had no lights
+    if (version >= 3u && cursor.getBool()) {
+      NodeLight light;
+      light.color = cursor.get<Ns3Color3>();
+      light.intensity = cursor.get<float>();
+      light.range = cursor.get<float>();
+      light.offset = cursor.get<Ns3Coordinate>();
+      light.direction = cursor.get<Ns3Coordinate>();
+      light.cone = cursor.get<float>();
+      node.light = light;
+    }
+
+    nodes.emplace_back(std::move(node));
+  }
+}
+
+void readBuildings(SectionCursor cursor, std::vector<Building> &buildings) {
+  const auto count = cursor.getCount();
+  buildings.reserve(count);
+
+  for (std::size_t i = 0; i < count; i++) {
+    Building building;
+    building.id = cursor.get<uint32_t>();
+    building.color = cursor.get<Ns3Color3>();
+    building.visible = cursor.getBool();
+    building.floors = cursor.get<uint16_t>();
+    building.roomsX = cursor.get<uint16_t>();
+    building.roomsY = cursor.get<uint16_t>();
+    building.min = cursor.get<Ns3Coordinate>();
+    building.max = cursor.get<Ns3Coordinate>();
+    buildings.emplace_back(building);
+  }
+}
+
+void readDecorations(const BinaryReader &reader, SectionCursor cursor, std::vector<Decoration> &decorations) {
+  const auto count = cursor.getCount();
+  decorations.reserve(count);
+
+  for (std::size_t i = 0; i < count; i++) {
+    Decoration decoration;
+    decoration.id = cursor.get<uint32_t>();
+    decoration.model = reader.string(cursor.get<uint32_t>());
+    decoration.position = cursor.get<Ns3Coordinate>();
+    decoration.orientation = cursor.get<std::array<double, 3>>();
+    decoration.keepRatio = cursor.getBool();
+    decoration.height = cursor.getOptional<float>();
+    decoration.width = cursor.getOptional<float>();
+    decoration.depth = cursor.getOptional<float>();
+    decoration.scale = cursor.get<std::array<float, 3>>();
+    decorations.emplace_back(std::move(decoration));
+  }
+}
+
+void readAreas(const BinaryReader &reader, SectionCursor cursor, std::vector<Area> &areas) {
+  const auto count = cursor.getCount();
+  areas.reserve(count);
+
+  for (std::size_t i = 0; i < count; i++) {
+    Area area;
+    area.id = cursor.get<uint32_t>();
+    area.name = reader.string(cursor.get<uint32_t>());
+    area.fillColor = cursor.get<Ns3Color3>();
+    area.fillMode = static_cast<Area::DrawMode>(cursor.get<uint8_t>());
+    area.borderColor = cursor.get<Ns3Color3>();
+    area.borderMode = static_cast<Area::DrawMode>(cursor.get<uint8_t>());
+    area.height = cursor.get<float>();
+
+    const auto points = cursor.getCount(sizeof(Ns3Coordinate));
+    area.points.reserve(points);
+    for (std::size_t j = 0; j < points; j++)
+      area.points.emplace_back(cursor.get<Ns3Coordinate>());
+
+    areas.emplace_back(std::move(area));
+  }
+}
+
+void readLinks(SectionCursor cursor, std::vector<WiredLink> &links) {
+  const auto count = cursor.getCount();
+  links.reserve(count);
+
+  for (std::size_t i = 0; i < count; i++) {
+    WiredLink link;
+    const auto nodes = cursor.getCount(sizeof(uint32_t));
+    link.nodes.reserve(nodes);
+    for (std::size_t j = 0; j < nodes; j++)
+      link.nodes.emplace_back(cursor.get<uint32_t>());
+
+    links.emplace_back(std::move(link));
+  }
+}
+
+void readXYSeries(const BinaryReader &reader, SectionCursor cursor, std::vector<XYSeries> &xySeries) {
+  const auto count = cursor.getCount();
+  xySeries.reserve(count);
+
+  for (std::size_t i = 0; i < count; i++) {
+    XYSeries series;
+    series.id = cursor.get<uint32_t>();
+    series.visible = cursor.getBool();
+    series.name = reader.string(cursor.get<uint32_t>());
+    series.legend = reader.string(cursor.get<uint32_t>());
+    series.connection = static_cast<XYSeries::Connection>(cursor.get<uint8_t>());
+    series.labelMode = static_cast<XYSeries::LabelMode>(cursor.get<uint8_t>());
+    series.color = cursor.get<Ns3Color3>();
+    series.xAxis = readValueAxis(reader, cursor);
+    series.yAxis = readValueAxis(reader, cursor);
+    xySeries.emplace_back(std::move(series));
+  }
+}
+
+void readCategoryValueSeries(const BinaryReader &reader, SectionCursor cursor,
+                             std::vector<CategoryValueSeries> &categorySeries) {
+  const auto count = cursor.getCount();
+  categorySeries.reserve(count);
+
+  for (std::size_t i = 0; i < count; i++) {
+    CategoryValueSeries series;
+    series.id = cursor.get<uint32_t>();
+    series.visible = cursor.getBool();
+
+    series.autoUpdate = cursor.getBool();
+    if (series.autoUpdate) {
+      series.autoUpdateInterval = cursor.get<int64_t>();
+      series.autoUpdateIncrement = cursor.get<double>();
+    }
+
+    series.name = reader.string(cursor.get<uint32_t>());
+    series.legend = reader.string(cursor.get<uint32_t>());
+    series.color = cursor.get<Ns3Color3>();
+    series.xAxis = readValueAxis(reader, cursor);
+
+    series.yAxis.name = reader.string(cursor.get<uint32_t>());
+    const auto categories = cursor.getCount(sizeof(uint32_t) * 2u);
+    series.yAxis.values.reserve(categories);
+    for (std::size_t j = 0; j < categories; j++) {
+      CategoryAxis::Category category;
+      category.id = cursor.get<uint32_t>();
+      category.name = reader.string(cursor.get<uint32_t>());
+      series.yAxis.values.emplace_back(std::move(category));
+    }
+
+    categorySeries.emplace_back(std::move(series));
+  }
+}
+
+void readSeriesCollections(const BinaryReader &reader, SectionCursor cursor,
+                           std::vector<SeriesCollection> &collections) {
+  const auto count = cursor.getCount();
+  collections.reserve(count);
+
+  for (std::size_t i = 0; i < count; i++) {
+    SeriesCollection collection;
+    collection.id = cursor.get<uint32_t>();
+    collection.name = reader.string(cursor.get<uint32_t>());
+
+    const auto series = cursor.getCount(sizeof(uint32_t));
+    collection.series.reserve(series);
+    for (std::size_t j = 0; j < series; j++)
+      collection.series.emplace_back(cursor.get<uint32_t>());
+
+    collection.xAxis = readValueAxis(reader, cursor);
+    collection.yAxis = readValueAxis(reader, cursor);
+    collections.emplace_back(std::move(collection));
+  }
+}
+
+void readLogStreams(const BinaryReader &reader, SectionCursor cursor, std::vector<LogStream> &streams) {
+  const auto count = cursor.getCount();
+  streams.reserve(count);
+
+  for (std::size_t i = 0; i < count; i++) {
+    LogStream stream;
+    stream.id = cursor.get<uint32_t>();
+    stream.visible = cursor.getBool();
+    stream.name = reader.string(cursor.get<uint32_t>());
+    stream.color = cursor.getOptional<Ns3Color3>();
+    streams.emplace_back(std::move(stream));
+  }
+}
+
+void readSceneEvents(SectionCursor cursor, uint16_t version, std::vector<SceneEvent> &events) {
+  const auto count = cursor.getCount();
+  const auto kindsOffset = cursor.offset();
+  const auto kinds = cursor.take(count);
+
+  std::tuple<std::vector<MoveEvent>, std::vector<TransmitEvent>, std::vector<TransmitEndEvent>,
+             std::vector<NodeOrientationChangeEvent>, std::vector<NodeColorChangeEvent>,
+             std::vector<DecorationMoveEvent>, std::vector<DecorationOrientationChangeEvent>>
+      tables;
+
+  auto &moves = std::get<std::vector<MoveEvent>>(tables);
+  readTableSize(cursor, moves);
+  readColumn<int64_t>(cursor, moves, [](MoveEvent &e, int64_t value) { e.time = value; });
+  readColumn<uint32_t>(cursor, moves, [](MoveEvent &e, uint32_t value) { e.nodeId = value; });
+  readColumn<Ns3Coordinate>(cursor, moves, [](MoveEvent &e, const Ns3Coordinate &value) { e.targetPosition = value; });
+
+  auto &transmits = std::get<std::vector<TransmitEvent>>(tables);
+  readTableSize(cursor, transmits);
+  readColumn<int64_t>(cursor, transmits, [](TransmitEvent &e, int64_t value) { e.time = value; });
+  readColumn<uint32_t>(cursor, transmits, [](TransmitEvent &e, uint32_t value) { e.nodeId = value; });
+  readColumn<int64_t>(cursor, transmits, [](TransmitEvent &e, int64_t value) { e.duration = value; });
+  readColumn<double>(cursor, transmits, [](TransmitEvent &e, double value) { e.targetSize = value; });
+  readColumn<Ns3Color3>(cursor, transmits, [](TransmitEvent &e, const Ns3Color3 &value) { e.color = value; });
+
+  auto &transmitEnds = std::get<std::vector<TransmitEndEvent>>(tables);
+  readTableSize(cursor, transmitEnds);
+  readColumn<int64_t>(cursor, transmitEnds, [](TransmitEndEvent &e, int64_t value) { e.time = value; });
+  readColumn<uint32_t>(cursor, transmitEnds, [](TransmitEndEvent &e, uint32_t value) { e.nodeId = value; });
+  readColumn<int64_t>(cursor, transmitEnds, [](TransmitEndEvent &e, int64_t value) { e.startTime = value; });
+
+  // Version 1 stored the rest of the start event as well
+  if (version < 2u) {
+    readColumn<uint32_t>(cursor, transmitEnds, [](TransmitEndEvent &, uint32_t) {});
+    readColumn<int64_t>(cursor, transmitEnds, [](TransmitEndEvent &, int64_t) {});
+    readColumn<double>(cursor, transmitEnds, [](TransmitEndEvent &, double) {});
+    readColumn<Ns3Color3>(cursor, transmitEnds, [](TransmitEndEvent &, const Ns3Color3 &) {});
+  }
+
+  auto &nodeOrientations = std::get<std::vector<NodeOrientationChangeEvent>>(tables);
+  readTableSize(cursor, nodeOrientations);
+  readColumn<int64_t>(cursor, nodeOrientations, [](NodeOrientationChangeEvent &e, int64_t value) { e.time = value; });
+  readColumn<uint32_t>(cursor, nodeOrientations,
+                       [](NodeOrientationChangeEvent &e, uint32_t value) { e.nodeId = value; });
+  readColumn<std::array<double, 3>>(
+      cursor, nodeOrientations,
+      [](NodeOrientationChangeEvent &e, const std::array<double, 3> &value) { e.targetOrientation = value; });
+
+  auto &nodeColors = std::get<std::vector<NodeColorChangeEvent>>(tables);
+  readTableSize(cursor, nodeColors);
+  readColumn<int64_t>(cursor, nodeColors, [](NodeColorChangeEvent &e, int64_t value) { e.time = value; });
+  readColumn<uint32_t>(cursor, nodeColors, [](NodeColorChangeEvent &e, uint32_t value) { e.nodeId = value; });
+  readColumn<uint8_t>(cursor, nodeColors, [](NodeColorChangeEvent &e, uint8_t value) {
+    e.type = static_cast<NodeColorChangeEvent::ColorType>(value);
+  });
+  // The color column is only meaningful when the matching flag is set,
+  // mark events with the flag set, then fill in the color
+  readColumn<uint8_t>(cursor, nodeColors, [](NodeColorChangeEvent &e, uint8_t value) {
+    if (value)
+      e.targetColor = Ns3Color3{};
+  });
+  readColumn<Ns3Color3>(cursor, nodeColors, [](NodeColorChangeEvent &e, const Ns3Color3 &value) {
+    if (e.targetColor)
+      e.targetColor = value;
+  });
+
+  auto &decorationMoves = std::get<std::vector<DecorationMoveEvent>>(tables);
+  readTableSize(cursor, decorationMoves);
+  readColumn<int64_t>(cursor, decorationMoves, [](DecorationMoveEvent &e, int64_t value) { e.time = value; });
+  readColumn<uint32_t>(cursor, decorationMoves,
+                       [](DecorationMoveEvent &e, uint32_t value) { e.decorationId = value; });
+  readColumn<Ns3Coordinate>(cursor, decorationMoves,
+                            [](DecorationMoveEvent &e, const Ns3Coordinate &value) { e.targetPosition = value; });
+
+  auto &decorationOrientations = std::get<std::vector<DecorationOrientationChangeEvent>>(tables);
+  readTableSize(cursor, decorationOrientations);
+  readColumn<int64_t>(cursor, decorationOrientations,
+                      [](DecorationOrientationChangeEvent &e, int64_t value) { e.time = value; });
+  readColumn<uint32_t>(cursor, decorationOrientations,
+                       [](DecorationOrientationChangeEvent &e, uint32_t value) { e.decorationId = value; });
+  readColumn<std::array<double, 3>>(
+      cursor, decorationOrientations,
+      [](DecorationOrientationChangeEvent &e, const std::array<double, 3> &value) { e.targetOrientation = value; });
+
+  mergeEvents(kinds, count, kindsOffset, tables, events, std::make_index_sequence<std::variant_size_v<SceneEvent>>{});
+}
+
+void readChartEvents(SectionCursor cursor, std::vector<ChartEvent> &events) {
+  const auto count = cursor.getCount();
+  const auto kindsOffset = cursor.offset();
+  const auto kinds = cursor.take(count);
+
+  std::tuple<std::vector<XYSeriesAddValue>, std::vector<XYSeriesAddValues>, std::vector<XYSeriesClear>,
+             std::vector<CategorySeriesAddValue>>
+      tables;
+
+  auto &addValue = std::get<std::vector<XYSeriesAddValue>>(tables);
+  readTableSize(cursor, addValue);
+  readColumn<int64_t>(cursor, addValue, [](XYSeriesAddValue &e, int64_t value) { e.time = value; });
+  readColumn<uint32_t>(cursor, addValue, [](XYSeriesAddValue &e, uint32_t value) { e.seriesId = value; });
+  readColumn<XYPoint>(cursor, addValue, [](XYSeriesAddValue &e, const XYPoint &value) { e.point = value; });
+
+  auto &addValues = std::get<std::vector<XYSeriesAddValues>>(tables);
+  readTableSize(cursor, addValues);
+  readColumn<int64_t>(cursor, addValues, [](XYSeriesAddValues &e, int64_t value) { e.time = value; });
+  readColumn<uint32_t>(cursor, addValues, [](XYSeriesAddValues &e, uint32_t value) { e.seriesId = value; });
+
+  // Only count the points here, each event takes its run of the shared points column below
+  std::vector<std::size_t> pointCounts;
+  pointCounts.reserve(addValues.size());
+  std::size_t expectedPoints = 0u;
+  readColumn<uint64_t>(cursor, addValues, [&pointCounts, &expectedPoints](XYSeriesAddValues &, uint64_t value) {
+    pointCounts.emplace_back(static_cast<std::size_t>(value));
+    expectedPoints += static_cast<std::size_t>(value);
+  });
+
+  cursor.align();
+  const auto totalPoints = cursor.getCount(sizeof(XYPoint));
+  if (totalPoints != expectedPoints)
+    throw MalformedFileException{"Point count does not match 'xy-series-append-array' events", cursor.offset()};
+
+  // The whole column is one block, shared by every event
+  std::shared_ptr<XYPoint[]> points{new XYPoint[totalPoints]};
+  std::memcpy(points.get(), cursor.take(totalPoints * sizeof(XYPoint)), totalPoints * sizeof(XYPoint));
+
+  std::size_t pointOffset = 0u;
+  for (std::size_t i = 0u; i < addValues.size(); i++) {
+    addValues[i].points = {points, pointOffset, pointCounts[i]};
+    pointOffset += pointCounts[i];
+  }
+
+  auto &clear = std::get<std::vector<XYSeriesClear>>(tables);
+  readTableSize(cursor, clear);
+  readColumn<int64_t>(cursor, clear, [](XYSeriesClear &e, int64_t value) { e.time = value; });
+  readColumn<uint32_t>(cursor, clear, [](XYSeriesClear &e, uint32_t value) { e.seriesId = value; });
+
+  auto &categoryAddValue = std::get<std::vector<CategorySeriesAddValue>>(tables);
+  readTableSize(cursor, categoryAddValue);
+  readColumn<int64_t>(cursor, categoryAddValue, [](CategorySeriesAddValue &e, int64_t value) { e.time = value; });
+  readColumn<uint32_t>(cursor, categoryAddValue,
+                       [](CategorySeriesAddValue &e, uint32_t value) { e.seriesId = value; });
+  readColumn<double>(cursor, categoryAddValue, [](CategorySeriesAddValue &e, double value) { e.value = value; });
+  readColumn<uint32_t>(cursor, categoryAddValue,
+                       [](CategorySeriesAddValue &e, uint32_t value) { e.category = value; });
+
+  mergeEvents(kinds, count, kindsOffset, tables, events, std::make_index_sequence<std::variant_size_v<ChartEvent>>{});
+}
+
+void readLogEvents(const BinaryReader &reader, SectionCursor cursor, std::vector<LogEvent> &events) {
+  const auto count = cursor.getCount();
+  const auto kindsOffset = cursor.offset();
+  const auto kinds = cursor.take(count);
+
+  std::tuple<std::vector<StreamAppendEvent>> tables;
+
+  auto &appends = std::get<std::vector<StreamAppendEvent>>(tables);
+  readTableSize(cursor, appends);
+  readColumn<int64_t>(cursor, appends, [](StreamAppendEvent &e, int64_t value) { e.time = value; });
+  readColumn<uint32_t>(cursor, appends, [](StreamAppendEvent &e, uint32_t value) { e.streamId = value; });
+  readColumn<uint32_t>(cursor, appends,
+                       [&reader](StreamAppendEvent &e, uint32_t value) { e.value = reader.string(value); });
+
+  mergeEvents(kinds, count, kindsOffset, tables, events, std::make_index_sequence<std::variant_size_v<LogEvent>>{});
+}
+
+} // namespace
+
+namespace parser::binary {
+
+BinaryReader::BinaryReader(FileParser &parser) : fileParser(parser) {
+}
+
+bool BinaryReader::isBinary(const char *header, std::size_t size) {
+  return size >= sizeof(magic) && std::memcmp(header, magic, sizeof(magic)) == 0;
+}
+
+std::string_view BinaryReader::string(uint32_t index) const {
+  if (index >= strings.size())
+    throw MalformedFileException{"String index out of range: " + std::to_string(index), 0u};
+
+  return strings[index];
+}
+
+std::optional<ParseError> BinaryReader::read(const char *path) {
+  if (!file.open(path)) {
+    std::cerr << "Failed to map file: " << path << '\n';
+    return {ParseError{"Failed to open file", 0u}};
+  }
+
+  const auto data = file.data();
+  const auto size = file.size();
+
+  try {
+    SectionCursor headerCursor{data, size, 0u};
+    const auto header = headerCursor.get<FileHeader>();
+
+    if (!isBinary(header.magic, sizeof(header.magic)))
+      return {ParseError{"Not a binary scenario file", 0u}};
+
+    if (header.byteOrder != byteOrderMark)
+      return {ParseError{"Binary scenario file written with an unsupported byte order", 4u}};
+
+    if (header.version > formatVersion)
+      return {ParseError{"Binary scenario file version " + std::to_string(header.version) +
+                             " is newer than the supported version " + std::to_string(formatVersion),
+                         4u}};
+
+    if (header.sectionCount > headerCursor.remaining() / sizeof(SectionEntry))
+      return {ParseError{"Section directory truncated", headerCursor.offset()}};
+
+    std::vector<SectionEntry> directory;
+    directory.reserve(header.sectionCount);
+    for (auto i = 0u; i < header.sectionCount; i++) {
+      const auto entry = headerCursor.get<SectionEntry>();
+      if (entry.offset > size || entry.size > size - entry.offset)
+        return {ParseError{"Section extends past the end of the file", headerCursor.offset()}};
+
+      directory.emplace_back(entry);
+    }
+
+    auto findSection = [&directory, data](SectionId id) -> std::optional<SectionCursor> {
+      for (const auto &entry : directory) {
+        if (entry.id == id)
+          return SectionCursor{data + entry.offset, static_cast<std::size_t>(entry.size),
+                               static_cast<std::size_t>(entry.offset)};
+      }
+
+      return {};
+    };
+
+    // Strings first, since every other section refers to them
+    if (auto cursor = findSection(SectionId::Strings)) {
+      const auto count = cursor->getCount(sizeof(uint64_t));
+      std::vector<uint64_t> offsets;
+      offsets.reserve(count + 1u);
+      for (std::size_t i = 0; i <= count; i++)
+        offsets.emplace_back(cursor->get<uint64_t>());
+
+      const auto blobSize = cursor->remaining();
+      const auto blob = cursor->take(blobSize);
+
+      strings.reserve(count);
+      for (std::size_t i = 0; i < count; i++) {
+        if (offsets[i] > offsets[i + 1u] || offsets[i + 1u] > blobSize)
+          throw MalformedFileException{"Invalid string table entry", cursor->offset()};
+
+        strings.emplace_back(blob + offsets[i], static_cast<std::size_t>(offsets[i + 1u] - offsets[i]));
+      }
+    }
+
+    if (auto cursor = findSection(SectionId::Configuration))
+      readConfiguration(*this, *cursor, fileParser.globalConfiguration);
+    else
+      return {ParseError{"Binary scenario file missing configuration", 0u}};
+
+    if (auto cursor = findSection(SectionId::Nodes)) {
+      readNodes(*this, *cursor, header.version, fileParser.nodes);
+      for (const auto &node : fileParser.nodes)
+        fileParser.foundModel(node.model);
+    }
+
+    if (auto cursor = findSection(SectionId::Buildings))
+      readBuildings(*cursor, fileParser.buildings);
+
+    if (auto cursor = findSection(SectionId::Decorations)) {
+      readDecorations(*this, *cursor, fileParser.decorations);
+      for (const auto &decoration : fileParser.decorations)
+        fileParser.foundModel(decoration.model);
+    }
+
+    if (auto cursor = findSection(SectionId::Areas))
+      readAreas(*this, *cursor, fileParser.areas);
+
+    if (auto cursor = findSection(SectionId::Links))
+      readLinks(*cursor, fileParser.wiredLinks);
+
+    if (auto cursor = findSection(SectionId::XYSeries))
+      readXYSeries(*this, *cursor, fileParser.xySeries);
+
+    if (auto cursor = findSection(SectionId::CategoryValueSeries))
+      readCategoryValueSeries(*this, *cursor, fileParser.categoryValueSeries);
+
+    if (auto cursor = findSection(SectionId::SeriesCollections))
+      readSeriesCollections(*this, *cursor, fileParser.seriesCollections);
+
+    if (auto cursor = findSection(SectionId::LogStreams))
+      readLogStreams(*this, *cursor, fileParser.logStreams);
+
+    if (auto cursor = findSection(SectionId::SceneEvents))
+      readSceneEvents(*cursor, header.version, fileParser.sceneEvents);
+
+    if (auto cursor = findSection(SectionId::ChartEvents))
+      readChartEvents(*cursor, fileParser.chartEvents);
+
+    if (auto cursor = findSection(SectionId::LogEvents))
+      readLogEvents(*this, *cursor, fileParser.logEvents);
+  } catch (const MalformedFileException &e) {
+    strings.clear();
+    file = MappedFile{};
+    return {ParseError{e.what(), e.offset}};
+  }
+
+  // Every string has been copied into the models by now,
+  // so the mapping may be released
+  strings.clear();
+  file = MappedFile{};
+  return {};
+}
+
+} // namespace parser::binary
@@ -0,0 +1,113 @@
+/*
+ * NIST-developed software is provided by NIST as a public service. You may use,
+ * copy and distribute copies of the software in any medium, provided that you
+ * keep intact this entire notice. You may improve,modify and create derivative
+ * works of the software or any portion of the software, and you may copy and
+ * distribute such modifications or works. Modified works should carry a notice
+ * stating that you changed the software and should note the date and nature of
+ * any such change. Please explicitly acknowledge the National Institute of
+ * Standards and Technology as the source of the software.
+ *
+ * NIST-developed software is expressly provided "AS IS." NIST MAKES NO
+ * WARRANTY OF ANY KIND, EXPRESS, IMPLIED, IN FACT OR ARISING BY OPERATION OF
+ * LAW, INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTY OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, NON-INFRINGEMENT
+ * AND DATA ACCURACY. NIST NEITHER REPRESENTS NOR WARRANTS THAT THE
+ * OPERATION OF THE SOFTWARE WILL BE UNINTERRUPTED OR ERROR-FREE, OR THAT
+ * ANY DEFECTS WILL BE CORRECTED. NIST DOES NOT WARRANT OR MAKE ANY
+ * REPRESENTATIONS REGARDING THE USE OF THE SOFTWARE OR THE RESULTS THEREOF,
+ * INCLUDING BUT NOT LIMITED TO THE CORRECTNESS, ACCURACY, RELIABILITY,
+ * OR USEFULNESS OF THE SOFTWARE.
+ *
+ * You are solely responsible for determining the appropriateness of using and
+ * distributing the software and you assume all risks associated with its use,
+ * including but not limited to the risks and costs of program errors,
+ * compliance with applicable laws, damage to or loss of data, programs or
+ * equipment, and the unavailability or interruption of operation. This
+ * software is not intended to be used in any situation where a failure could
+ * cause risk of injury or damage to property. The software developed by NIST
+ * employees is not subject to copyright protection within the United States.
+ *
+ * Author: Evan Black <evan.black@nist.gov>
+ */
+#pragma once
+#include "../file-parser.h"
+#include "MappedFile.h"
+#include "binary-format.h"
+#include <cstdint>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+namespace parser::binary {
+
+/**
+ * Fills a `FileParser` from a file in the
+ * binary scenario format described in `binary-format.h`
+ */
+class BinaryReader {
+  /**
+   * The parser to fill with the models & events from the file
+   */
+  FileParser &fileParser;
+
+  /**
+   * The file being read.
+   * Only mapped for the duration of `read()`
+   */
+  MappedFile file;
+
+  /**
+   * View of every string in the `Strings` section.
+   * Points into `file`
+   */
+  std::vector<std::string_view> strings;
+
+public:
+  /**
+   * Setup a reader which fills `parser`
+   *
+   * @param parser
+   * The parser to fill. Should be `reset()` beforehand
+   */
+  explicit BinaryReader(FileParser &parser);
+
+  /**
+   * Checks if the header of a file matches the binary scenario format
+   *
+   * @param header
+   * The first bytes of the file
+   *
+   * @param size
+   * The number of bytes in `header`
+   *
+   * @return
+   * True if `header` starts with the binary scenario magic bytes
+   */
+  [[nodiscard]] static bool isBinary(const char *header, std::size_t size);
+
+  /**
+   * Look up a string from the string table
+   *
+   * @param index
+   * The index of the string, as stored in the file
+   *
+   * @return
+   * A view of the string.
+   * Throws if `index` does not exist in the table
+   */
+  [[nodiscard]] std::string_view string(uint32_t index) const;
+
+  /**
+   * Map `path` & read every section into the parser
+   *
+   * @param path
+   * The path to the binary scenario file
+   *
+   * @return
+   * An error if the file could not be read, an unset optional otherwise
+   */
+  std::optional<ParseError> read(const char *path);
+};
+
+} // namespace parser::binary
@@ -0,0 +1,634 @@
+/*
+ * NIST-developed software is provided by NIST as a public service. You may use,
+ * copy and distribute copies of the software in any medium, provided that you
+ * keep intact this entire notice. You may improve,modify and create derivative
+ * works of the software or any portion of the software, and you may copy and
+ * distribute such modifications or works. Modified works should carry a notice
+ * stating that you changed the software and should note the date and nature of
+ * any such change. Please explicitly acknowledge the National Institute of
+ * Standards and Technology as the source of the software.
+ *
+ * NIST-developed software is expressly provided "AS IS." NIST MAKES NO
+ * WARRANTY OF ANY KIND, EXPRESS, IMPLIED, IN FACT OR ARISING BY OPERATION OF
+ * LAW, INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTY OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, NON-INFRINGEMENT
+ * AND DATA ACCURACY. NIST NEITHER REPRESENTS NOR WARRANTS THAT THE
+ * OPERATION OF THE SOFTWARE WILL BE UNINTERRUPTED OR ERROR-FREE, OR THAT
+ * ANY DEFECTS WILL BE CORRECTED. NIST DOES NOT WARRANT OR MAKE ANY
+ * REPRESENTATIONS REGARDING THE USE OF THE SOFTWARE OR THE RESULTS THEREOF,
+ * INCLUDING BUT NOT LIMITED TO THE CORRECTNESS, ACCURACY, RELIABILITY,
+ * OR USEFULNESS OF THE SOFTWARE.
+ *
+ * You are solely responsible for determining the appropriateness of using and
+ * distributing the software and you assume all risks associated with its use,
+ * including but not limited to the risks and costs of program errors,
+ * compliance with applicable laws, damage to or loss of data, programs or
+ * equipment, and the unavailability or interruption of operation. This
+ * software is not intended to be used in any situation where a failure could
+ * cause risk of injury or damage to property. The software developed by NIST
+ * employees is not subject to copyright protection within the United States.
+ *
+ * Author: Evan Black <evan.black@nist.gov>
+ */
+#include "BinaryWriter.h"
+#include <array>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <tuple>
+#include <type_traits>
+#include <variant>
+
+namespace {
+
+using namespace parser;
+using namespace parser::binary;
+
+// The structs below are written directly into the file,
+// so make sure they have no padding
+static_assert(sizeof(Ns3Coordinate) == 12u, "Ns3Coordinate must be packed into 12 bytes");
+static_assert(sizeof(Ns3Color3) == 3u, "Ns3Color3 must be packed into 3 bytes");
+static_assert(sizeof(XYPoint) == 16u, "XYPoint must be packed into 16 bytes");
+
+// Make sure the kinds in the format header stay in sync with the variants,
+// since we use `index()` to write the kind of each event
+static_assert(std::is_same_v<std::variant_alternative_t<static_cast<std::size_t>(SceneEventKind::Move), SceneEvent>,
+                             MoveEvent>);
+static_assert(
+    std::is_same_v<std::variant_alternative_t<static_cast<std::size_t>(SceneEventKind::Transmit), SceneEvent>,
+                   TransmitEvent>);
+static_assert(
+    std::is_same_v<std::variant_alternative_t<static_cast<std::size_t>(SceneEventKind::TransmitEnd), SceneEvent>,
+                   TransmitEndEvent>);
+static_assert(
+    std::is_same_v<std::variant_alternative_t<static_cast<std::size_t>(SceneEventKind::NodeOrientation), SceneEvent>,
+                   NodeOrientationChangeEvent>);
+static_assert(
+    std::is_same_v<std::variant_alternative_t<static_cast<std::size_t>(SceneEventKind::NodeColor), SceneEvent>,
+                   NodeColorChangeEvent>);
+static_assert(
+    std::is_same_v<std::variant_alternative_t<static_cast<std::size_t>(SceneEventKind::DecorationMove), SceneEvent>,
+                   DecorationMoveEvent>);
+static_assert(std::is_same_v<std::variant_alternative_t<
+                                 static_cast<std::size_t>(SceneEventKind::DecorationOrientation), SceneEvent>,
+                             DecorationOrientationChangeEvent>);
+static_assert(static_cast<std::size_t>(SceneEventKind::Count) == std::variant_size_v<SceneEvent>);
+
+static_assert(
+    std::is_same_v<std::variant_alternative_t<static_cast<std::size_t>(ChartEventKind::XYAddValue), ChartEvent>,
+                   XYSeriesAddValue>);
+static_assert(
+    std::is_same_v<std::variant_alternative_t<static_cast<std::size_t>(ChartEventKind::XYAddValues), ChartEvent>,
+                   XYSeriesAddValues>);
+static_assert(std::is_same_v<std::variant_alternative_t<static_cast<std::size_t>(ChartEventKind::XYClear), ChartEvent>,
+                             XYSeriesClear>);
+static_assert(
+    std::is_same_v<std::variant_alternative_t<static_cast<std::size_t>(ChartEventKind::CategoryAddValue), ChartEvent>,
+                   CategorySeriesAddValue>);
+static_assert(static_cast<std::size_t>(ChartEventKind::Count) == std::variant_size_v<ChartEvent>);
+
+/**
+ * Rows of a single event type, in file order
+ */
+template <typename Event>
+using Rows = std::vector<const Event *>;
+
+/**
+ * Growable buffer holding the contents of a single section
+ */
+class SectionBuffer {
+  std::vector<char> bytes;
+
+public:
+  template <typename T>
+  void put(const T &value) {
+    static_assert(std::is_trivially_copyable_v<T>, "Only trivially copyable values may be written directly");
+    const auto offset = bytes.size();
+    bytes.resize(offset + sizeof(T));
+    std::memcpy(bytes.data() + offset, &value, sizeof(T));
+  }
+
+  void putBool(bool value) {
+    put<uint8_t>(value ? 1u : 0u);
+  }
+
+  template <typename T>
+  void putOptional(const std::optional<T> &value) {
+    putBool(value.has_value());
+    if (value)
+      put<T>(value.value());
+  }
+
+  /**
+   * Write one column of an event table
+   *
+   * @tparam Column
+   * The type stored in the file for this column
+   *
+   * @param rows
+   * The events which make up the table
+   *
+   * @param projection
+   * Callable which retrieves the value for this column from an event
+   */
+  template <typename Column, typename Event, typename Projection>
+  void putColumn(const Rows<Event> &rows, Projection projection) {
+    align();
+    bytes.reserve(bytes.size() + rows.size() * sizeof(Column));
+    for (const auto row : rows)
+      put<Column>(static_cast<Column>(projection(*row)));
+  }
+
+  void align() {
+    bytes.resize((bytes.size() + sectionAlignment - 1u) & ~(sectionAlignment - 1u));
+  }
+
+  [[nodiscard]] const std::vector<char> &data() const {
+    return bytes;
+  }
+};
+
+void putValueAxis(BinaryWriter &writer, SectionBuffer &section, const ValueAxis &axis) {
+  section.put(writer.intern(axis.name));
+  section.put<uint8_t>(static_cast<uint8_t>(axis.boundMode));
+  section.put<uint8_t>(static_cast<uint8_t>(axis.scale));
+  section.put(axis.min);
+  section.put(axis.max);
+}
+
+void putColor(SectionBuffer &section, const Ns3Color3 &color) {
+  section.put(color);
+}
+
+SectionBuffer writeConfiguration(BinaryWriter &writer, const GlobalConfiguration &config) {
+  SectionBuffer section;
+  section.put<int64_t>(config.moduleVersion.major);
+  section.put<int64_t>(config.moduleVersion.minor);
+  section.put<int64_t>(config.moduleVersion.patch);
+  section.put(writer.intern(config.moduleVersion.suffix));
+  section.put<int64_t>(config.endTime);
+  section.putOptional(config.timeStep);
+
+  section.putBool(config.granularity.has_value());
+  if (config.granularity)
+    section.put(writer.intern(config.granularity.value()));
+
+  section.put(config.minLocation);
+  section.put(config.maxLocation);
+  return section;
+}
+
+SectionBuffer writeNodes(BinaryWriter &writer, const std::vector<Node> &nodes) {
+  SectionBuffer section;
+  section.put<uint64_t>(nodes.size());
+
+  for (const auto &node : nodes) {
+    section.put<uint32_t>(node.id);
+    section.put(writer.intern(node.name));
+    section.putBool(node.labelEnabled);
+    section.put(writer.intern(node.model));
+    section.put(node.scale);
+    section.putBool(node.keepRatio);
+    section.putOptional(node.height);
+    section.putOptional(node.width);
+    section.putOptional(node.depth);
+    section.putBool(node.visible);
+    section.put(node.position);
+    section.put(node.offset);
+    section.putOptional(node.baseColor);
+    section.putOptional(node.highlightColor);
+    section.putBool(node.trailEnabled);
+    putColor(section, node.trailColor);
+    section.put(node.orientation);
+
+    // Field by field, so the padding after the color is not written
+    section.putBool(node.light.has_value());
+    if (node.light) {
+      putColor(section, node.light->color);
+      section.put(node.light->intensity);
+      section.put(node.light->range);
+      section.put(node.light->offset);
+      section.put(node.light->direction);
+      section.put(node.light->cone);
+    }
+  }
+
+  return section;
+}
+
+SectionBuffer writeBuildings(const std::vector<Building> &buildings) {
+  SectionBuffer section;
+  section.put<uint64_t>(buildings.size());
+
+  for (const auto &building : buildings) {
+    section.put<uint32_t>(building.id);
+    putColor(section, building.color);
+    section.putBool(building.visible);
+    section.put(building.floors);
+    section.put(building.roomsX);
+    section.put(building.roomsY);
+    section.put(building.min);
+    section.put(building.max);
+  }
+
+  return section;
+}
+
+SectionBuffer writeDecorations(BinaryWriter &writer, const std::vector<Decoration> &decorations) {
+  SectionBuffer section;
+  section.put<uint64_t>(decorations.size());
+
+  for (const auto &decoration : decorations) {
+    section.put<uint32_t>(decoration.id);
+    section.put(writer.intern(decoration.model));
+    section.put(decoration.position);
+    section.put(decoration.orientation);
+    section.putBool(decoration.keepRatio);
+    section.putOptional(decoration.height);
+    section.putOptional(decoration.width);
+    section.putOptional(decoration.depth);
+    section.put(decoration.scale);
+  }
+
+  return section;
+}
+
+SectionBuffer writeAreas(BinaryWriter &writer, const std::vector<Area> &areas) {
+  SectionBuffer section;
+  section.put<uint64_t>(areas.size());
+
+  for (const auto &area : areas) {
+    section.put<uint32_t>(area.id);
+    section.put(writer.intern(area.name));
+    putColor(section, area.fillColor);
+    section.put<uint8_t>(static_cast<uint8_t>(area.fillMode));
+    putColor(section, area.borderColor);
+    section.put<uint8_t>(static_cast<uint8_t>(area.borderMode));
+    section.put(area.height);
+
+    section.put<uint64_t>(area.points.size());
+    for (const auto &point : area.points)
+      section.put(point);
+  }
+
+  return section;
+}
+
+SectionBuffer writeLinks(const std::vector<WiredLink> &links) {
+  SectionBuffer section;
+  section.put<uint64_t>(links.size());
+
+  for (const auto &link : links) {
+    section.put<uint64_t>(link.nodes.size());
+    for (const auto nodeId : link.nodes)
+      section.put<uint32_t>(nodeId);
+  }
+
+  return section;
+}
+
+SectionBuffer writeXYSeries(BinaryWriter &writer, const std::vector<XYSeries> &xySeries) {
+  SectionBuffer section;
+  section.put<uint64_t>(xySeries.size());
+
+  for (const auto &series : xySeries) {
+    section.put<uint32_t>(series.id);
+    section.putBool(series.visible);
+    section.put(writer.intern(series.name));
+    section.put(writer.intern(series.legend));
+    section.put<uint8_t>(static_cast<uint8_t>(series.connection));
+    section.put<uint8_t>(static_cast<uint8_t>(series.labelMode));
+    putColor(section, series.color);
+    putValueAxis(writer, section, series.xAxis);
+    putValueAxis(writer, section, series.yAxis);
+  }
+
+  return section;
+}
+
+SectionBuffer writeCategoryValueSeries(BinaryWriter &writer, const std::vector<CategoryValueSeries> &categorySeries) {
+  SectionBuffer section;
+  section.put<uint64_t>(categorySeries.size());
+
+  for (const auto &series : categorySeries) {
+    section.put<uint32_t>(series.id);
+    section.putBool(series.visible);
+
+    section.putBool(series.autoUpdate);
+    // The interval & increment are only set by the parser
+    // when auto update is enabled
+    if (series.autoUpdate) {
+      section.put<int64_t>(series.autoUpdateInterval);
+      section.put(series.autoUpdateIncrement);
+    }
+
+    section.put(writer.intern(series.name));
+    section.put(writer.intern(series.legend));
+    putColor(section, series.color);
+    putValueAxis(writer, section, series.xAxis);
+
+    section.put(writer.intern(series.yAxis.name));
+    section.put<uint64_t>(series.yAxis.values.size());
+    for (const auto &category : series.yAxis.values) {
+      section.put<uint32_t>(category.id);
+      section.put(writer.intern(category.name));
+    }
+  }
+
+  return section;
+}
+
+SectionBuffer writeSeriesCollections(BinaryWriter &writer, const std::vector<SeriesCollection> &collections) {
+  SectionBuffer section;
+  section.put<uint64_t>(collections.size());
+
+  for (const auto &collection : collections) {
+    section.put<uint32_t>(collection.id);
+    section.put(writer.intern(collection.name));
+
+    section.put<uint64_t>(collection.series.size());
+    for (const auto seriesId : collection.series)
+      section.put<uint32_t>(seriesId);
+
+    putValueAxis(writer, section, collection.xAxis);
+    putValueAxis(writer, section, collection.yAxis);
+  }
+
+  return section;
+}
+
+SectionBuffer writeLogStreams(BinaryWriter &writer, const std::vector<LogStream> &streams) {
+  SectionBuffer section;
+  section.put<uint64_t>(streams.size());
+
+  for (const auto &stream : streams) {
+    section.put<uint32_t>(stream.id);
+    section.putBool(stream.visible);
+    section.put(writer.intern(stream.name));
+    section.putOptional(stream.color);
+  }
+
+  return section;
+}
+
+/**
+ * Write the count & kind of each event in `events`
+ * and split the events into one collection per kind
+ *
+ * @tparam Variant
+ * The event variant type
+ *
+ * @tparam Tables
+ * A tuple of `Rows` collections, one for each alternative in `Variant`
+ */
+template <typename Variant, typename Tables>
+void partitionEvents(SectionBuffer &section, const std::vector<Variant> &events, Tables &tables) {
+  section.put<uint64_t>(events.size());
+
+  for (const auto &event : events) {
+    section.put<uint8_t>(static_cast<uint8_t>(event.index()));
+    std::visit(
+        [&tables](const auto &e) {
+          using T = std::decay_t<decltype(e)>;
+          std::get<Rows<T>>(tables).emplace_back(&e);
+        },
+        event);
+  }
+}
+
+SectionBuffer writeSceneEvents(const std::vector<SceneEvent> &events) {
+  SectionBuffer section;
+  std::tuple<Rows<MoveEvent>, Rows<TransmitEvent>, Rows<TransmitEndEvent>, Rows<NodeOrientationChangeEvent>,
+             Rows<NodeColorChangeEvent>, Rows<DecorationMoveEvent>, Rows<DecorationOrientationChangeEvent>>
+      tables;
+  partitionEvents(section, events, tables);
+
+  const auto &moves = std::get<Rows<MoveEvent>>(tables);
+  section.align();
+  section.put<uint64_t>(moves.size());
+  section.putColumn<int64_t>(moves, [](const MoveEvent &e) { return e.time; });
+  section.putColumn<uint32_t>(moves, [](const MoveEvent &e) { return e.nodeId; });
+  section.putColumn<Ns3Coordinate>(moves, [](const MoveEvent &e) { return e.targetPosition; });
+
+  const auto &transmits = std::get<Rows<TransmitEvent>>(tables);
+  section.align();
+  section.put<uint64_t>(transmits.size());
+  section.putColumn<int64_t>(transmits, [](const TransmitEvent &e) { return e.time; });
+  section.putColumn<uint32_t>(transmits, [](const TransmitEvent &e) { return e.nodeId; });
+  section.putColumn<int64_t>(transmits, [](const TransmitEvent &e) { return e.duration; });
+  section.putColumn<double>(transmits, [](const TransmitEvent &e) { return e.targetSize; });
+  section.putColumn<Ns3Color3>(transmits, [](const TransmitEvent &e) { return e.color; });
+
+  const auto &transmitEnds = std::get<Rows<TransmitEndEvent>>(tables);
+  section.align();
+  section.put<uint64_t>(transmitEnds.size());
+  section.putColumn<int64_t>(transmitEnds, [](const TransmitEndEvent &e) { return e.time; });
+  section.putColumn<uint32_t>(transmitEnds, [](const TransmitEndEvent &e) { return e.nodeId; });
+  section.putColumn<int64_t>(transmitEnds, [](const TransmitEndEvent &e) { return e.startTime; });
+
+  const auto &nodeOrientations = std::get<Rows<NodeOrientationChangeEvent>>(tables);
+  section.align();
+  section.put<uint64_t>(nodeOrientations.size());
+  section.putColumn<int64_t>(nodeOrientations, [](const NodeOrientationChangeEvent &e) { return e.time; });
+  section.putColumn<uint32_t>(nodeOrientations, [](const NodeOrientationChangeEvent &e) { return e.nodeId; });
+  section.putColumn<std::array<double, 3>>(nodeOrientations,
+                                           [](const NodeOrientationChangeEvent &e) { return e.targetOrientation; });
+
+  const auto &nodeColors = std::get<Rows<NodeColorChangeEvent>>(tables);
+  section.align();
+  section.put<uint64_t>(nodeColors.size());
+  section.putColumn<int64_t>(nodeColors, [](const NodeColorChangeEvent &e) { return e.time; });
+  section.putColumn<uint32_t>(nodeColors, [](const NodeColorChangeEvent &e) { return e.nodeId; });
+  section.putColumn<uint8_t>(nodeColors, [](const NodeColorChangeEvent &e) { return static_cast<uint8_t>(e.type); });
+  section.putColumn<uint8_t>(nodeColors, [](const NodeColorChangeEvent &e) { return e.targetColor.has_value(); });
+  section.putColumn<Ns3Color3>(nodeColors,
+                               [](const NodeColorChangeEvent &e) { return e.targetColor.value_or(Ns3Color3{}); });
+
+  const auto &decorationMoves = std::get<Rows<DecorationMoveEvent>>(tables);
+  section.align();
+  section.put<uint64_t>(decorationMoves.size());
+  section.putColumn<int64_t>(decorationMoves, [](const DecorationMoveEvent &e) { return e.time; });
+  section.putColumn<uint32_t>(decorationMoves, [](const DecorationMoveEvent &e) { return e.decorationId; });
+  section.putColumn<Ns3Coordinate>(decorationMoves, [](const DecorationMoveEvent &e) { return e.targetPosition; });
+
+  const auto &decorationOrientations = std::get<Rows<DecorationOrientationChangeEvent>>(tables);
+  section.align();
+  section.put<uint64_t>(decorationOrientations.size());
+  section.putColumn<int64_t>(decorationOrientations,
+                             [](const DecorationOrientationChangeEvent &e) { return e.time; });
+  section.putColumn<uint32_t>(decorationOrientations,
+                              [](const DecorationOrientationChangeEvent &e) { return e.decorationId; });
+  section.putColumn<std::array<double, 3>>(
+      decorationOrientations, [](const DecorationOrientationChangeEvent &e) { return e.targetOrientation; });
+
+  return section;
+}
+
+SectionBuffer writeChartEvents(const std::vector<ChartEvent> &events) {
+  SectionBuffer section;
+  std::tuple<Rows<XYSeriesAddValue>, Rows<XYSeriesAddValues>, Rows<XYSeriesClear>, Rows<CategorySeriesAddValue>>
+      tables;
+  partitionEvents(section, events, tables);
+
+  const auto &addValue = std::get<Rows<XYSeriesAddValue>>(tables);
+  section.align();
+  section.put<uint64_t>(addValue.size());
+  section.putColumn<int64_t>(addValue, [](const XYSeriesAddValue &e) { return e.time; });
+  section.putColumn<uint32_t>(addValue, [](const XYSeriesAddValue &e) { return e.seriesId; });
+  section.putColumn<XYPoint>(addValue, [](const XYSeriesAddValue &e) { return e.point; });
+
+  // Points for every event are stored in a single column,
+  // each event stores how many points it takes from that column
+  const auto &addValues = std::get<Rows<XYSeriesAddValues>>(tables);
+  section.align();
+  section.put<uint64_t>(addValues.size());
+  section.putColumn<int64_t>(addValues, [](const XYSeriesAddValues &e) { return e.time; });
+  section.putColumn<uint32_t>(addValues, [](const XYSeriesAddValues &e) { return e.seriesId; });
+  section.putColumn<uint64_t>(addValues, [](const XYSeriesAddValues &e) { return e.points.size(); });
+
+  uint64_t totalPoints = 0u;
+  for (const auto event : addValues)
+    totalPoints += event->points.size();
+
+  section.align();
+  section.put<uint64_t>(totalPoints);
+  for (const auto event : addValues) {
+    for (const auto &point : event->points)
+      section.put(point);
+  }
+
+  const auto &clear = std::get<Rows<XYSeriesClear>>(tables);
+  section.align();
+  section.put<uint64_t>(clear.size());
+  section.putColumn<int64_t>(clear, [](const XYSeriesClear &e) { return e.time; });
+  section.putColumn<uint32_t>(clear, [](const XYSeriesClear &e) { return e.seriesId; });
+
+  const auto &categoryAddValue = std::get<Rows<CategorySeriesAddValue>>(tables);
+  section.align();
+  section.put<uint64_t>(categoryAddValue.size());
+  section.putColumn<int64_t>(categoryAddValue, [](const CategorySeriesAddValue &e) { return e.time; });
+  section.putColumn<uint32_t>(categoryAddValue, [](const CategorySeriesAddValue &e) { return e.seriesId; });
+  section.putColumn<double>(categoryAddValue, [](const CategorySeriesAddValue &e) { return e.value; });
+  section.putColumn<uint32_t>(categoryAddValue, [](const CategorySeriesAddValue &e) { return e.category; });
+
+  return section;
+}
+
+SectionBuffer writeLogEvents(BinaryWriter &writer, const std::vector<LogEvent> &events) {
+  SectionBuffer section;
+  std::tuple<Rows<StreamAppendEvent>> tables;
+  partitionEvents(section, events, tables);
+
+  const auto &appends = std::get<Rows<StreamAppendEvent>>(tables);
+  section.align();
+  section.put<uint64_t>(appends.size());
+  section.putColumn<int64_t>(appends, [](const StreamAppendEvent &e) { return e.time; });
+  section.putColumn<uint32_t>(appends, [](const StreamAppendEvent &e) { return e.streamId; });
+  section.putColumn<uint32_t>(appends, [&writer](const StreamAppendEvent &e) { return writer.intern(e.value); });
+
+  return section;
+}
+
+} // namespace
+
+namespace parser::binary {
+
+BinaryWriter::BinaryWriter(const FileParser &parser) : fileParser(parser) {
+}
+
+uint32_t BinaryWriter::intern(const std::string &value) {
+  const auto [iterator, inserted] = stringIndices.try_emplace(value, static_cast<uint32_t>(strings.size()));
+  if (inserted)
+    strings.emplace_back(value);
+
+  return iterator->second;
+}
+
+std::optional<ParseError> BinaryWriter::write(const char *path) {
+  std::vector<std::pair<SectionId, SectionBuffer>> sections;
+
+  sections.emplace_back(SectionId::Configuration, writeConfiguration(*this, fileParser.getConfiguration()));
+  sections.emplace_back(SectionId::Nodes, writeNodes(*this, fileParser.getNodes()));
+  sections.emplace_back(SectionId::Buildings, writeBuildings(fileParser.getBuildings()));
+  sections.emplace_back(SectionId::Decorations, writeDecorations(*this, fileParser.getDecorations()));
+  sections.emplace_back(SectionId::Areas, writeAreas(*this, fileParser.getAreas()));
+  sections.emplace_back(SectionId::Links, writeLinks(fileParser.getLinks()));
+  sections.emplace_back(SectionId::XYSeries, writeXYSeries(*this, fileParser.getXYSeries()));
+  sections.emplace_back(SectionId::CategoryValueSeries,
+                        writeCategoryValueSeries(*this, fileParser.getCategoryValueSeries()));
+  sections.emplace_back(SectionId::SeriesCollections, writeSeriesCollections(*this, fileParser.getSeriesCollections()));
+  sections.emplace_back(SectionId::LogStreams, writeLogStreams(*this, fileParser.getLogStreams()));
+  sections.emplace_back(SectionId::SceneEvents, writeSceneEvents(fileParser.getSceneEvents()));
+  sections.emplace_back(SectionId::ChartEvents, writeChartEvents(fileParser.getChartsEvents()));
+  sections.emplace_back(SectionId::LogEvents, writeLogEvents(*this, fileParser.getLogEvents()));
+
+  // Strings go last, since every other section may add to the table.
+  // Layout: count, (count + 1) offsets into the blob, then the blob itself
+  SectionBuffer stringSection;
+  stringSection.put<uint64_t>(strings.size());
+  uint64_t blobOffset = 0u;
+  for (const auto string : strings) {
+    stringSection.put(blobOffset);
+    blobOffset += string.size();
+  }
+  stringSection.put(blobOffset);
+  for (const auto string : strings) {
+    for (const auto character : string)
+      stringSection.put(character);
+  }
+  sections.emplace_back(SectionId::Strings, std::move(stringSection));
+
+  std::vector<SectionEntry> directory;
+  auto offset = static_cast<uint64_t>(sizeof(FileHeader) + sizeof(SectionEntry) * sections.size());
+  for (const auto &[id, section] : sections) {
+    offset = (offset + sectionAlignment - 1u) & ~(sectionAlignment - 1u);
+    directory.emplace_back(SectionEntry{id, 0u, offset, section.data().size()});
+    offset += section.data().size();
+  }
+
+  std::unique_ptr<FILE, decltype(&std::fclose)> file{std::fopen(path, "wb"), std::fclose};
+  if (!file) {
+    std::cerr << "Failed to open file for writing: " << path << '\n';
+    return {ParseError{"Failed to open file for writing", 0u}};
+  }
+
+  FileHeader header{};
+  std::memcpy(header.magic, magic, sizeof(magic));
+  header.version = formatVersion;
+  header.byteOrder = byteOrderMark;
+  header.sectionCount = static_cast<uint32_t>(sections.size());
+
+  std::size_t written = std::fwrite(&header, sizeof(header), 1u, file.get());
+  written += std::fwrite(directory.data(), sizeof(SectionEntry), directory.size(), file.get());
+  auto expected = 1u + directory.size();
+
+  // Track the position ourselves, `ftell()` is limited to 2 GiB on some platforms
+  auto position = static_cast<uint64_t>(sizeof(FileHeader) + sizeof(SectionEntry) * directory.size());
+  for (auto i = 0u; i < sections.size(); i++) {
+    const auto &bytes = sections[i].second.data();
+    static const char padding[sectionAlignment]{};
+
+    const auto paddingSize = directory[i].offset - position;
+    if (paddingSize > 0u) {
+      written += std::fwrite(padding, paddingSize, 1u, file.get());
+      expected++;
+    }
+
+    if (!bytes.empty()) {
+      written += std::fwrite(bytes.data(), bytes.size(), 1u, file.get());
+      expected++;
+    }
+
+    position = directory[i].offset + bytes.size();
+  }
+
+  if (written != expected) {
+    std::cerr << "Failed writing to file: " << path << '\n';
+    return {ParseError{"Failed writing to file", static_cast<std::size_t>(position)}};
+  }
+
+  return {};
+}
+
+} // namespace parser::binary
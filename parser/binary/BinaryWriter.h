@@ -0,0 +1,101 @@
+/*
+ * NIST-developed software is provided by NIST as a public service. You may use,
+ * copy and distribute copies of the software in any medium, provided that you
+ * keep intact this entire notice. You may improve,modify and create derivative
+ * works of the software or any portion of the software, and you may copy and
+ * distribute such modifications or works. Modified works should carry a notice
+ * stating that you changed the software and should note the date and nature of
+ * any such change. Please explicitly acknowledge the National Institute of
+ * Standards and Technology as the source of the software.
+ *
+ * NIST-developed software is expressly provided "AS IS." NIST MAKES NO
+ * WARRANTY OF ANY KIND, EXPRESS, IMPLIED, IN FACT OR ARISING BY OPERATION OF
+ * LAW, INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTY OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, NON-INFRINGEMENT
+ * AND DATA ACCURACY. NIST NEITHER REPRESENTS NOR WARRANTS THAT THE
+ * OPERATION OF THE SOFTWARE WILL BE UNINTERRUPTED OR ERROR-FREE, OR THAT
+ * ANY DEFECTS WILL BE CORRECTED. NIST DOES NOT WARRANT OR MAKE ANY
+ * REPRESENTATIONS REGARDING THE USE OF THE SOFTWARE OR THE RESULTS THEREOF,
+ * INCLUDING BUT NOT LIMITED TO THE CORRECTNESS, ACCURACY, RELIABILITY,
+ * OR USEFULNESS OF THE SOFTWARE.
+ *
+ * You are solely responsible for determining the appropriateness of using and
+ * distributing the software and you assume all risks associated with its use,
+ * including but not limited to the risks and costs of program errors,
+ * compliance with applicable laws, damage to or loss of data, programs or
+ * equipment, and the unavailability or interruption of operation. This
+ * software is not intended to be used in any situation where a failure could
+ * cause risk of injury or damage to property. The software developed by NIST
+ * employees is not subject to copyright protection within the United States.
+ *
+ * Author: Evan Black <evan.black@nist.gov>
+ */
+#pragma once
+#include "../file-parser.h"
+#include "binary-format.h"
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace parser::binary {
+
+/**
+ * Writes the contents of a `FileParser` into the
+ * binary scenario format described in `binary-format.h`
+ */
+class BinaryWriter {
+  /**
+   * The parser to write the models & events from.
+   * `parse()` should already have been called on it
+   */
+  const FileParser &fileParser;
+
+  /**
+   * Every unique string referenced by the file, in the order they were encountered
+   */
+  std::vector<std::string_view> strings;
+
+  /**
+   * Map of string contents to their index in `strings`
+   */
+  std::unordered_map<std::string_view, uint32_t> stringIndices;
+
+public:
+  /**
+   * Setup a writer for the models in `parser`
+   *
+   * @param parser
+   * The parser to write. Must outlive the writer
+   */
+  explicit BinaryWriter(const FileParser &parser);
+
+  /**
+   * Get the index of `value` in the string table,
+   * adding it to the table if it has not been seen before.
+   *
+   * @param value
+   * The string to look up.
+   * Only a view of the string is kept, so it must outlive the writer
+   *
+   * @return
+   * The index of `value` in the string table
+   */
+  uint32_t intern(const std::string &value);
+
+  /**
+   * Write every model & event from the parser to `path`.
+   * Any existing file at `path` is overwritten
+   *
+   * @param path
+   * The path to the file to write
+   *
+   * @return
+   * An error if the file could not be written, an unset optional otherwise
+   */
+  std::optional<ParseError> write(const char *path);
+};
+
+} // namespace parser::binary
@@ -0,0 +1,186 @@
+/*
+ * NIST-developed software is provided by NIST as a public service. You may use,
+ * copy and distribute copies of the software in any medium, provided that you
+ * keep intact this entire notice. You may improve,modify and create derivative
+ * works of the software or any portion of the software, and you may copy and
+ * distribute such modifications or works. Modified works should carry a notice
+ * stating that you changed the software and should note the date and nature of
+ * any such change. Please explicitly acknowledge the National Institute of
+ * Standards and Technology as the source of the software.
+ *
+ * NIST-developed software is expressly provided "AS IS." NIST MAKES NO
+ * WARRANTY OF ANY KIND, EXPRESS, IMPLIED, IN FACT OR ARISING BY OPERATION OF
+ * LAW, INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTY OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, NON-INFRINGEMENT
+ * AND DATA ACCURACY. NIST NEITHER REPRESENTS NOR WARRANTS THAT THE
+ * OPERATION OF THE SOFTWARE WILL BE UNINTERRUPTED OR ERROR-FREE, OR THAT
+ * ANY DEFECTS WILL BE CORRECTED. NIST DOES NOT WARRANT OR MAKE ANY
+ * REPRESENTATIONS REGARDING THE USE OF THE SOFTWARE OR THE RESULTS THEREOF,
+ * INCLUDING BUT NOT LIMITED TO THE CORRECTNESS, ACCURACY, RELIABILITY,
+ * OR USEFULNESS OF THE SOFTWARE.
+ *
+ * You are solely responsible for determining the appropriateness of using and
+ * distributing the software and you assume all risks associated with its use,
+ * including but not limited to the risks and costs of program errors,
+ * compliance with applicable laws, damage to or loss of data, programs or
+ * equipment, and the unavailability or interruption of operation. This
+ * software is not intended to be used in any situation where a failure could
+ * cause risk of injury or damage to property. The software developed by NIST
+ * employees is not subject to copyright protection within the United States.
+ *
+ * Author: Evan Black <evan.black@nist.gov>
+ */
+#include "MappedFile.h"
+#include <utility>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace parser::binary {
+
+MappedFile::MappedFile(MappedFile &&other) noexcept
+    : mappedData(other.mappedData), mappedSize(other.mappedSize), writable(other.writable),
+#ifdef _WIN32
+      fileHandle(other.fileHandle), mappingHandle(other.mappingHandle) {
+  other.fileHandle = nullptr;
+  other.mappingHandle = nullptr;
+#else
+      fileDescriptor(other.fileDescriptor) {
+  other.fileDescriptor = -1;
+#endif
+  other.mappedData = nullptr;
+  other.mappedSize = 0u;
+  other.writable = false;
+}
+
+MappedFile::~MappedFile() {
+  close();
+}
+
+MappedFile &MappedFile::operator=(MappedFile &&other) noexcept {
+  if (this == &other)
+    return *this;
+
+  close();
+  std::swap(mappedData, other.mappedData);
+  std::swap(mappedSize, other.mappedSize);
+  std::swap(writable, other.writable);
+#ifdef _WIN32
+  std::swap(fileHandle, other.fileHandle);
+  std::swap(mappingHandle, other.mappingHandle);
+#else
+  std::swap(fileDescriptor, other.fileDescriptor);
+#endif
+
+  return *this;
+}
+
+bool MappedFile::open(const char *path, bool copyOnWrite) {
+  close();
+
+#ifdef _WIN32
+  fileHandle = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                           FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+  if (fileHandle == INVALID_HANDLE_VALUE) {
+    fileHandle = nullptr;
+    return false;
+  }
+
+  LARGE_INTEGER fileSize;
+  if (!GetFileSizeEx(fileHandle, &fileSize) || fileSize.QuadPart == 0) {
+    close();
+    return false;
+  }
+  mappedSize = static_cast<std::size_t>(fileSize.QuadPart);
+
+  mappingHandle = CreateFileMappingA(fileHandle, nullptr, copyOnWrite ? PAGE_WRITECOPY : PAGE_READONLY, 0, 0, nullptr);
+  if (!mappingHandle) {
+    close();
+    return false;
+  }
+
+  mappedData =
+      static_cast<const char *>(MapViewOfFile(mappingHandle, copyOnWrite ? FILE_MAP_COPY : FILE_MAP_READ, 0, 0, 0));
+  if (!mappedData) {
+    close();
+    return false;
+  }
+#else
+  fileDescriptor = ::open(path, O_RDONLY);
+  if (fileDescriptor == -1)
+    return false;
+
+  struct stat fileStat {};
+  if (fstat(fileDescriptor, &fileStat) == -1 || fileStat.st_size == 0) {
+    close();
+    return false;
+  }
+  mappedSize = static_cast<std::size_t>(fileStat.st_size);
+
+  // Private, so writes are never carried through to the file
+  const auto protection = copyOnWrite ? PROT_READ | PROT_WRITE : PROT_READ;
+  auto mapping = mmap(nullptr, mappedSize, protection, MAP_PRIVATE, fileDescriptor, 0);
+  if (mapping == MAP_FAILED) {
+    close();
+    return false;
+  }
+
+  // The reader walks each section front to back
+  madvise(mapping, mappedSize, MADV_SEQUENTIAL);
+  mappedData = static_cast<const char *>(mapping);
+#endif
+
+  writable = copyOnWrite;
+  return true;
+}
+
+void MappedFile::close() {
+#ifdef _WIN32
+  if (mappedData)
+    UnmapViewOfFile(mappedData);
+
+  if (mappingHandle)
+    CloseHandle(mappingHandle);
+
+  if (fileHandle)
+    CloseHandle(fileHandle);
+
+  mappingHandle = nullptr;
+  fileHandle = nullptr;
+#else
+  if (mappedData)
+    munmap(const_cast<char *>(mappedData), mappedSize);
+
+  if (fileDescriptor != -1)
+    ::close(fileDescriptor);
+
+  fileDescriptor = -1;
+#endif
+
+  mappedData = nullptr;
+  mappedSize = 0u;
+  writable = false;
+}
+
+const char *MappedFile::data() const {
+  return mappedData;
+}
+
+char *MappedFile::writableData() {
+  return writable ? const_cast<char *>(mappedData) : nullptr;
+}
+
+std::size_t MappedFile::size() const {
+  return mappedSize;
+}
+
+} // namespace parser::binary
@@ -0,0 +1,110 @@
+/*
+ * NIST-developed software is provided by NIST as a public service. You may use,
+ * copy and distribute copies of the software in any medium, provided that you
+ * keep intact this entire notice. You may improve,modify and create derivative
+ * works of the software or any portion of the software, and you may copy and
+ * distribute such modifications or works. Modified works should carry a notice
+ * stating that you changed the software and should note the date and nature of
+ * any such change. Please explicitly acknowledge the National Institute of
+ * Standards and Technology as the source of the software.
+ *
+ * NIST-developed software is expressly provided "AS IS." NIST MAKES NO
+ * WARRANTY OF ANY KIND, EXPRESS, IMPLIED, IN FACT OR ARISING BY OPERATION OF
+ * LAW, INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTY OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, NON-INFRINGEMENT
+ * AND DATA ACCURACY. NIST NEITHER REPRESENTS NOR WARRANTS THAT THE
+ * OPERATION OF THE SOFTWARE WILL BE UNINTERRUPTED OR ERROR-FREE, OR THAT
+ * ANY DEFECTS WILL BE CORRECTED. NIST DOES NOT WARRANT OR MAKE ANY
+ * REPRESENTATIONS REGARDING THE USE OF THE SOFTWARE OR THE RESULTS THEREOF,
+ * INCLUDING BUT NOT LIMITED TO THE CORRECTNESS, ACCURACY, RELIABILITY,
+ * OR USEFULNESS OF THE SOFTWARE.
+ *
+ * You are solely responsible for determining the appropriateness of using and
+ * distributing the software and you assume all risks associated with its use,
+ * including but not limited to the risks and costs of program errors,
+ * compliance with applicable laws, damage to or loss of data, programs or
+ * equipment, and the unavailability or interruption of operation. This
+ * software is not intended to be used in any situation where a failure could
+ * cause risk of injury or damage to property. The software developed by NIST
+ * employees is not subject to copyright protection within the United States.
+ *
+ * Author: Evan Black <evan.black@nist.gov>
+ */
+#pragma once
+#include <cstddef>
+
+namespace parser::binary {
+
+/**
+ * View of an entire file mapped into memory, read-only,
+ * or copy-on-write, see `open()`.
+ * Unmaps the file when destroyed.
+ */
+class MappedFile {
+  const char *mappedData = nullptr;
+  std::size_t mappedSize = 0u;
+
+  /**
+   * If the mapping is private & copy-on-write, so `mappedData` may be written to
+   */
+  bool writable = false;
+
+#ifdef _WIN32
+  void *fileHandle = nullptr;
+  void *mappingHandle = nullptr;
+#else
+  int fileDescriptor = -1;
+#endif
+
+  /**
+   * Release the mapping, and any associated handles
+   */
+  void close();
+
+public:
+  MappedFile() = default;
+  MappedFile(const MappedFile &other) = delete;
+  MappedFile(MappedFile &&other) noexcept;
+  ~MappedFile();
+
+  MappedFile &operator=(const MappedFile &other) = delete;
+  MappedFile &operator=(MappedFile &&other) noexcept;
+
+  /**
+   * Map the file at `path` into memory.
+   * Any previously mapped file is released.
+   *
+   * @param path
+   * The path to the file to map
+   *
+   * @param copyOnWrite
+   * Map the file so it may be written to, see `writableData()`.
+   * Only the pages written to are copied, the file itself is never changed
+   *
+   * @return
+   * True if the file was mapped, false otherwise
+   */
+  bool open(const char *path, bool copyOnWrite = false);
+
+  /**
+   * @return
+   * The beginning of the mapped file.
+   * Null if no file is mapped
+   */
+  [[nodiscard]] const char *data() const;
+
+  /**
+   * @return
+   * The beginning of the mapped file, which may be written to.
+   * Null if no file is mapped, or it was not mapped copy-on-write
+   */
+  [[nodiscard]] char *writableData();
+
+  /**
+   * @return
+   * The size of the mapped file in bytes
+   */
+  [[nodiscard]] std::size_t size() const;
+};
+
+} // namespace parser::binary
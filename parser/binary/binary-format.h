@@ -0,0 +1,146 @@
+/*
+ * NIST-developed software is provided by NIST as a public service. You may use,
+ * copy and distribute copies of the software in any medium, provided that you
+ * keep intact this entire notice. You may improve,modify and create derivative
+ * works of the software or any portion of the software, and you may copy and
+ * distribute such modifications or works. Modified works should carry a notice
+ * stating that you changed the software and should note the date and nature of
+ * any such change. Please explicitly acknowledge the National Institute of
+ * Standards and Technology as the source of the software.
+ *
+ * NIST-developed software is expressly provided "AS IS." NIST MAKES NO
+ * WARRANTY OF ANY KIND, EXPRESS, IMPLIED, IN FACT OR ARISING BY OPERATION OF
+ * LAW, INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTY OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, NON-INFRINGEMENT
+ * AND DATA ACCURACY. NIST NEITHER REPRESENTS NOR WARRANTS THAT THE
+ * OPERATION OF THE SOFTWARE WILL BE UNINTERRUPTED OR ERROR-FREE, OR THAT
+ * ANY DEFECTS WILL BE CORRECTED. NIST DOES NOT WARRANT OR MAKE ANY
+ * REPRESENTATIONS REGARDING THE USE OF THE SOFTWARE OR THE RESULTS THEREOF,
+ * INCLUDING BUT NOT LIMITED TO THE CORRECTNESS, ACCURACY, RELIABILITY,
+ * OR USEFULNESS OF THE SOFTWARE.
+ *
+ * You are solely responsible for determining the appropriateness of using and
+ * distributing the software and you assume all risks associated with its use,
+ * including but not limited to the risks and costs of program errors,
+ * compliance with applicable laws, damage to or loss of data, programs or
+ * equipment, and the unavailability or interruption of operation. This
+ * software is not intended to be used in any situation where a failure could
+ * cause risk of injury or damage to property. The software developed by NIST
+ * employees is not subject to copyright protection within the United States.
+ *
+ * Author: Evan Black <evan.black@nist.gov>
+ */
+#pragma once
+#include <cstdint>
+
+/**
+ * Layout of the binary scenario container.
+ *
+ * All values are little-endian. The file begins with a `FileHeader`,
+ * immediately followed by `FileHeader::sectionCount` `SectionEntry` records.
+ * Each entry points to a section somewhere in the file,
+ * the start of every section is aligned to `sectionAlignment` bytes.
+ *
+ * Strings are never stored inline, instead they are
+ * stored as a `uint32_t` index into the `Strings` section.
+ *
+ * Events are stored in columns, grouped by type. Each event section
+ * starts with a `uint64_t` count of events, followed by one `uint8_t` "kind"
+ * per event (in the original file order), and then one table per kind.
+ * Each table starts with a `uint64_t` row count followed by the columns of the table.
+ * Every column is aligned to 8 bytes.
+ */
+namespace parser::binary {
+
+/**
+ * Magic bytes identifying a binary scenario file
+ */
+constexpr char magic[4] = {'N', 'S', 'Z', 'B'};
+
+/**
+ * The version of the format written by `BinaryWriter`.
+ * Files with a newer version will be rejected by the `BinaryReader`.
+ *
+ * Version 2: `TransmitEndEvent` stores only the start time of its transmission
+ * Version 3: Nodes store their optional `NodeLight`
+ */
+constexpr uint16_t formatVersion = 3u;
+
+/**
+ * Written into the header, used to reject files
+ * written on a machine with a different byte order
+ */
+constexpr uint16_t byteOrderMark = 0xFEFFu;
+
+/**
+ * Alignment of each section in the file
+ */
+constexpr uint64_t sectionAlignment = 8u;
+
+/**
+ * Identifiers for each section in the file.
+ * Values are stored in the file, so they must not be changed
+ */
+enum class SectionId : uint32_t {
+  Strings = 1u,
+  Configuration = 2u,
+  Nodes = 3u,
+  Buildings = 4u,
+  Decorations = 5u,
+  Areas = 6u,
+  Links = 7u,
+  XYSeries = 8u,
+  CategoryValueSeries = 9u,
+  SeriesCollections = 10u,
+  LogStreams = 11u,
+  SceneEvents = 12u,
+  ChartEvents = 13u,
+  LogEvents = 14u
+};
+
+/**
+ * The kind of each entry in the `SceneEvents` section.
+ * Matches the order of alternatives in `parser::SceneEvent`
+ */
+enum class SceneEventKind : uint8_t {
+  Move,
+  Transmit,
+  TransmitEnd,
+  NodeOrientation,
+  NodeColor,
+  DecorationMove,
+  DecorationOrientation,
+  Count
+};
+
+/**
+ * The kind of each entry in the `ChartEvents` section.
+ * Matches the order of alternatives in `parser::ChartEvent`
+ */
+enum class ChartEventKind : uint8_t { XYAddValue, XYAddValues, XYClear, CategoryAddValue, Count };
+
+/**
+ * The header at the very beginning of the file
+ */
+struct FileHeader {
+  char magic[4];
+  uint16_t version;
+  uint16_t byteOrder;
+  uint32_t sectionCount;
+  uint32_t reserved;
+};
+
+/**
+ * Entry in the section directory following the `FileHeader`
+ */
+struct SectionEntry {
+  SectionId id;
+  uint32_t reserved;
+  uint64_t offset;
+  uint64_t size;
+};
+
+static_assert(sizeof(FileHeader) == 16u, "FileHeader must be packed into 16 bytes");
+static_assert(sizeof(SectionEntry) == 24u, "SectionEntry must be packed into 24 bytes");
+
+} // namespace parser::binary
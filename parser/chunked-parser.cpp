@@ -0,0 +1,448 @@
+/*
+ * NIST-developed software is provided by NIST as a public service. You may use,
+ * copy and distribute copies of the software in any medium, provided that you
+ * keep intact this entire notice. You may improve,modify and create derivative
+ * works of the software or any portion of the software, and you may copy and
+ * distribute such modifications or works. Modified works should carry a notice
+ * stating that you changed the software and should note the date and nature of
+ * any such change. Please explicitly acknowledge the National Institute of
+ * Standards and Technology as the source of the software.
+ *
+ * NIST-developed software is expressly provided "AS IS." NIST MAKES NO
+ * WARRANTY OF ANY KIND, EXPRESS, IMPLIED, IN FACT OR ARISING BY OPERATION OF
+ * LAW, INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTY OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, NON-INFRINGEMENT
+ * AND DATA ACCURACY. NIST NEITHER REPRESENTS NOR WARRANTS THAT THE
+ * OPERATION OF THE SOFTWARE WILL BE UNINTERRUPTED OR ERROR-FREE, OR THAT
+ * ANY DEFECTS WILL BE CORRECTED. NIST DOES NOT WARRANT OR MAKE ANY
+ * REPRESENTATIONS REGARDING THE USE OF THE SOFTWARE OR THE RESULTS THEREOF,
+ * INCLUDING BUT NOT LIMITED TO THE CORRECTNESS, ACCURACY, RELIABILITY,
+ * OR USEFULNESS OF THE SOFTWARE.
+ *
+ * You are solely responsible for determining the appropriateness of using and
+ * distributing the software and you assume all risks associated with its use,
+ * including but not limited to the risks and costs of program errors,
+ * compliance with applicable laws, damage to or loss of data, programs or
+ * equipment, and the unavailability or interruption of operation. This
+ * software is not intended to be used in any situation where a failure could
+ * cause risk of injury or damage to property. The software developed by NIST
+ * employees is not subject to copyright protection within the United States.
+ *
+ * Author: Evan Black <evan.black@nist.gov>
+ */
+#include "chunked-parser.h"
+#include "event-scanner.h"
+#include "handler/JsonHandler.h"
+#include "handler/parse-error.h"
+#include "section-index.h"
+#include "task-pool.h"
+#include "trace.h"
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <condition_variable>
+#include <iterator>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <variant>
+
+namespace {
+
+/**
+ * RapidJSON input stream reading several ranges of memory
+ * as if they were one continuous document
+ */
+class SpanStream {
+public:
+  using Ch = char;
+
+  struct Span {
+    const char *begin;
+    const char *end;
+
+    /**
+     * Position in the file of `begin`, used for error reporting
+     */
+    std::size_t fileOffset;
+  };
+
+private:
+  std::vector<Span> spans;
+  std::size_t index = 0u;
+  const char *position;
+  std::size_t consumed = 0u;
+
+  /**
+   * Move to the next non-empty span, if we're at the end of the current one
+   */
+  void skipExhausted() {
+    while (position == spans[index].end && index + 1u < spans.size()) {
+      index++;
+      position = spans[index].begin;
+    }
+  }
+
+public:
+  explicit SpanStream(std::vector<Span> spans) : spans(std::move(spans)), position(this->spans.front().begin) {
+    skipExhausted();
+  }
+
+  [[nodiscard]] Ch Peek() const {
+    return position == spans[index].end ? '\0' : *position;
+  }
+
+  Ch Take() {
+    if (position == spans[index].end)
+      return '\0';
+
+    const auto c = *position++;
+    consumed++;
+    skipExhausted();
+    return c;
+  }
+
+  [[nodiscard]] std::size_t Tell() const {
+    return consumed;
+  }
+
+  /**
+   * Convert a position from `Tell()` into a position in the file
+   */
+  [[nodiscard]] std::size_t fileOffset(std::size_t tell) const {
+    for (const auto &span : spans) {
+      const auto length = static_cast<std::size_t>(span.end - span.begin);
+      if (tell < length)
+        return span.fileOffset + tell;
+      tell -= length;
+    }
+
+    return spans.back().fileOffset;
+  }
+
+  // Required by RapidJSON, but only used for in-situ parsing
+  Ch *PutBegin() {
+    assert(false);
+    return nullptr;
+  }
+
+  void Put(Ch) {
+    assert(false);
+  }
+
+  void Flush() {
+    assert(false);
+  }
+
+  std::size_t PutEnd(Ch *) {
+    assert(false);
+    return 0u;
+  }
+};
+
+const char openBracket[] = "[";
+const char closeBracket[] = "]";
+
+} // namespace
+
+namespace parser {
+
+ChunkedParser::ChunkedParser(FileParser &parser, unsigned int threads) : fileParser(parser), threads(threads) {
+  if (this->threads == 0u)
+    this->threads = std::max(1u, std::thread::hardware_concurrency());
+}
+
+bool ChunkedParser::prepare(const char *path) {
+  // Progressive parsers still benefit from splitting the events on a single thread
+  if (threads < 2u && !fileParser.eventsParsed)
+    return false;
+
+  // Each chunk is only written to by the thread parsing it
+  if (!file.open(path, fileParser.fastEvents && fileParser.inSitu) || file.size() < minimumFileSize) {
+    file = binary::MappedFile{};
+    return false;
+  }
+
+  if (!scan() || chunks.size() < 2u) {
+    file = binary::MappedFile{};
+    chunks.clear();
+    return false;
+  }
+
+  return true;
+}
+
+bool ChunkedParser::scan() {
+  const auto index = indexSections(file.data(), file.size());
+  if (!index)
+    return false;
+
+  // The configuration sets the end time outright, rather than keeping the highest time.
+  // So if it comes after the events, the events cannot be merged in afterwards
+  const auto configuration = index->find("configuration");
+  const auto events = index->find("events");
+  if (!configuration || !events || configuration->begin > events->begin || file.data()[events->begin] != '[')
+    return false;
+
+  return scanEvents(events->begin);
+}
+
+bool ChunkedParser::scanEvents(std::size_t arrayBegin) {
+  const auto data = file.data();
+  const auto size = file.size();
+
+  // The 'events' are most of the file, so base the chunk size on the whole thing.
+  // Make several chunks per thread, so a slow chunk does not hold up the rest
+  const auto chunkCount = fileParser.eventsParsed ? progressiveChunks : threads * 4u;
+  const auto targetChunkSize = std::max(minimumChunkSize, size / chunkCount);
+
+  auto chunkBegin = size;
+  std::size_t lastElementEnd = 0u;
+
+  // Relative to the 'events' array, 0 is directly in the array
+  std::size_t depth = 0u;
+
+  for (auto i = nextStructural(data, size, arrayBegin + 1u); i < size; i = nextStructural(data, size, i + 1u)) {
+    switch (data[i]) {
+    case '"':
+      i = skipString(data, size, i + 1u);
+      break;
+    case '{':
+      if (depth == 0u) {
+        if (chunkBegin == size)
+          chunkBegin = i;
+        else if (i - chunkBegin >= targetChunkSize) {
+          // Scanning a large file takes a while on its own.
+          // Falls back to the other parsers, which stop at the first event
+          if (fileParser.cancelled())
+            return false;
+
+          chunks.emplace_back(Range{chunkBegin, lastElementEnd});
+          chunkBegin = i;
+        }
+      }
+      depth++;
+      break;
+    case '[':
+      depth++;
+      break;
+    case '}':
+      depth--;
+      if (depth == 0u)
+        lastElementEnd = i + 1u;
+      break;
+    case ']':
+      if (depth == 0u) {
+        if (chunkBegin != size)
+          chunks.emplace_back(Range{chunkBegin, lastElementEnd});
+
+        eventsArray = {arrayBegin, i + 1u};
+        return true;
+      }
+      depth--;
+      break;
+    default:
+      break;
+    }
+  }
+
+  return false;
+}
+
+void ChunkedParser::merge(FileParser &result, TransmitEndTracker &transmitEnds) {
+  trace::Scope trace{"ChunkedParser::merge", "parse"};
+  auto &config = fileParser.globalConfiguration;
+  const auto &chunkConfig = result.globalConfiguration;
+  config.endTime = std::max(config.endTime, chunkConfig.endTime);
+
+  config.minLocation.x = std::min(config.minLocation.x, chunkConfig.minLocation.x);
+  config.minLocation.y = std::min(config.minLocation.y, chunkConfig.minLocation.y);
+  config.minLocation.z = std::min(config.minLocation.z, chunkConfig.minLocation.z);
+
+  config.maxLocation.x = std::max(config.maxLocation.x, chunkConfig.maxLocation.x);
+  config.maxLocation.y = std::max(config.maxLocation.y, chunkConfig.maxLocation.y);
+  config.maxLocation.z = std::max(config.maxLocation.z, chunkConfig.maxLocation.z);
+
+  for (auto &event : result.sceneEvents) {
+    const auto time = std::visit(
+        [](const auto &e) {
+          return e.time;
+        },
+        event);
+    transmitEnds.endTransmits(time, fileParser.sceneEvents);
+
+    if (const auto transmit = std::get_if<TransmitEvent>(&event))
+      transmitEnds.beginTransmit(*transmit, fileParser.sceneEvents);
+
+    fileParser.sceneEvents.emplace_back(std::move(event));
+  }
+
+  std::move(result.chartEvents.begin(), result.chartEvents.end(), std::back_inserter(fileParser.chartEvents));
+  std::move(result.logEvents.begin(), result.logEvents.end(), std::back_inserter(fileParser.logEvents));
+
+  // Release each chunk as we go, to cap the peak memory use
+  result = FileParser{};
+}
+
+std::optional<ParseError> ChunkedParser::parse() {
+  trace::Scope trace{"ChunkedParser::parse", "parse"};
+  const auto data = file.data();
+  const auto size = file.size();
+  const auto progressive = static_cast<bool>(fileParser.eventsParsed);
+
+  std::vector<FileParser> results(chunks.size());
+  std::vector<std::optional<ParseError>> errors(chunks.size());
+  std::atomic<std::size_t> nextChunk{0u};
+
+  // Chunks are parsed out of order, but merged in order
+  std::vector<bool> parsed(chunks.size(), false);
+  std::mutex parsedMutex;
+  std::condition_variable chunkParsed;
+
+  auto parseChunk = [this, data, &results, &errors, &parsed, &parsedMutex, &chunkParsed](std::size_t i) {
+    trace::Scope chunkTrace{"ChunkedParser::parseChunk", "parse"};
+    const auto &chunk = chunks[i];
+    results[i].filter = fileParser.filter;
+    results[i].cancellation = fileParser.cancellation;
+    JsonHandler handler{results[i], JsonHandler::EventsOnly{}};
+
+    if (fileParser.fastEvents) {
+      const auto writable = file.writableData();
+      auto stream = writable ? RangeStream{writable + chunk.begin, writable + chunk.end}
+                             : RangeStream{data + chunk.begin, data + chunk.end};
+      std::size_t errorOffset = 0u;
+
+      handler.StartArray();
+      if (const auto code = parseEvents(stream, handler, errorOffset); code != rapidjson::kParseErrorNone)
+        errors[i] = ParseError{describeParseError(code, results[i].errorMessage), chunk.begin + errorOffset};
+      else
+        handler.EndArray(0u);
+    } else {
+      SpanStream stream{{{openBracket, openBracket + 1, chunk.begin},
+                         {data + chunk.begin, data + chunk.end, chunk.begin},
+                         {closeBracket, closeBracket + 1, chunk.end}}};
+
+      rapidjson::Reader reader;
+      reader.Parse(stream, handler);
+
+      if (reader.HasParseError())
+        errors[i] = ParseError{describeParseError(reader.GetParseErrorCode(), results[i].errorMessage),
+                               stream.fileOffset(reader.GetErrorOffset())};
+    }
+
+    {
+      std::lock_guard lock{parsedMutex};
+      parsed[i] = true;
+    }
+    chunkParsed.notify_all();
+  };
+
+  auto parseChunks = [this, &parseChunk, &nextChunk]() {
+    for (auto i = nextChunk++; i < chunks.size(); i = nextChunk++)
+      parseChunk(i);
+  };
+
+  // Parse the chunks following `i` while waiting for it,
+  // rather than sitting idle
+  auto waitForChunk = [this, &parseChunk, &nextChunk, &parsed, &parsedMutex, &chunkParsed](std::size_t i) {
+    std::unique_lock lock{parsedMutex};
+    while (!parsed[i]) {
+      lock.unlock();
+      const auto next = nextChunk++;
+      if (next < chunks.size()) {
+        parseChunk(next);
+        lock.lock();
+      } else {
+        lock.lock();
+        chunkParsed.wait(lock, [&parsed, i]() {
+          return parsed[i];
+        });
+      }
+    }
+  };
+
+  // Helpers not started by the time they're waited on run on this thread, and find no chunks left
+  auto joinWorkers = [](std::vector<TaskPool::Handle> &workers) {
+    for (auto &worker : workers)
+      worker.wait();
+    workers.clear();
+  };
+
+  std::vector<TaskPool::Handle> workers;
+  const auto workerCount = std::min(static_cast<std::size_t>(threads), chunks.size()) - 1u;
+  workers.reserve(workerCount);
+  for (std::size_t i = 0u; i < workerCount; i++)
+    workers.emplace_back(TaskPool::shared().submit(parseChunks));
+
+  // Everything other than the events, with an empty 'events' array in their place
+  SpanStream remainder{{{data, data + eventsArray.begin + 1u, 0u},
+                        {data + eventsArray.end - 1u, data + size, eventsArray.end - 1u}}};
+  JsonHandler handler{fileParser};
+  rapidjson::Reader reader;
+  reader.Parse(remainder, handler);
+
+  if (reader.HasParseError()) {
+    // Don't bother with the rest of the chunks
+    nextChunk = chunks.size();
+    joinWorkers(workers);
+
+    return ParseError{describeParseError(reader.GetParseErrorCode(), fileParser.errorMessage),
+                      remainder.fileOffset(reader.GetErrorOffset())};
+  }
+
+  if (progressive) {
+    fileParser.sortSections();
+    if (fileParser.sectionsParsed)
+      fileParser.sectionsParsed();
+  } else {
+    // Help with the chunks once the remainder is done,
+    // then reserve space for every event up front
+    parseChunks();
+    joinWorkers(workers);
+
+    std::size_t sceneEventCount = 0u;
+    std::size_t chartEventCount = 0u;
+    std::size_t logEventCount = 0u;
+    for (const auto &result : results) {
+      sceneEventCount += result.sceneEvents.size();
+      chartEventCount += result.chartEvents.size();
+      logEventCount += result.logEvents.size();
+    }
+
+    fileParser.sceneEvents.reserve(sceneEventCount);
+    fileParser.chartEvents.reserve(chartEventCount);
+    fileParser.logEvents.reserve(logEventCount);
+  }
+
+  // Chunks are in file order, so appending them in order
+  // keeps the order of events with the same time.
+  // `TransmitEndEvent`s need every scene event in order,
+  // so they're inserted here, rather than in each chunk
+  TransmitEndTracker transmitEnds;
+  nanoseconds parsedTime = 0LL;
+  std::optional<ParseError> error;
+
+  for (std::size_t i = 0u; i < chunks.size(); i++) {
+    waitForChunk(i);
+
+    if (errors[i]) {
+      error = errors[i];
+      nextChunk = chunks.size();
+      break;
+    }
+
+    // Chunks start with a blank configuration,
+    // so their end time is the time of their latest event
+    parsedTime = std::max(parsedTime, results[i].globalConfiguration.endTime);
+    merge(results[i], transmitEnds);
+
+    if (progressive)
+      fileParser.deliverEvents(parsedTime, static_cast<double>(chunks[i].end) / static_cast<double>(size));
+  }
+
+  joinWorkers(workers);
+  file = binary::MappedFile{};
+  return error;
+}
+
+} // namespace parser
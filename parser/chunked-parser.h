@@ -0,0 +1,177 @@
+/*
+ * NIST-developed software is provided by NIST as a public service. You may use,
+ * copy and distribute copies of the software in any medium, provided that you
+ * keep intact this entire notice. You may improve,modify and create derivative
+ * works of the software or any portion of the software, and you may copy and
+ * distribute such modifications or works. Modified works should carry a notice
+ * stating that you changed the software and should note the date and nature of
+ * any such change. Please explicitly acknowledge the National Institute of
+ * Standards and Technology as the source of the software.
+ *
+ * NIST-developed software is expressly provided "AS IS." NIST MAKES NO
+ * WARRANTY OF ANY KIND, EXPRESS, IMPLIED, IN FACT OR ARISING BY OPERATION OF
+ * LAW, INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTY OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, NON-INFRINGEMENT
+ * AND DATA ACCURACY. NIST NEITHER REPRESENTS NOR WARRANTS THAT THE
+ * OPERATION OF THE SOFTWARE WILL BE UNINTERRUPTED OR ERROR-FREE, OR THAT
+ * ANY DEFECTS WILL BE CORRECTED. NIST DOES NOT WARRANT OR MAKE ANY
+ * REPRESENTATIONS REGARDING THE USE OF THE SOFTWARE OR THE RESULTS THEREOF,
+ * INCLUDING BUT NOT LIMITED TO THE CORRECTNESS, ACCURACY, RELIABILITY,
+ * OR USEFULNESS OF THE SOFTWARE.
+ *
+ * You are solely responsible for determining the appropriateness of using and
+ * distributing the software and you assume all risks associated with its use,
+ * including but not limited to the risks and costs of program errors,
+ * compliance with applicable laws, damage to or loss of data, programs or
+ * equipment, and the unavailability or interruption of operation. This
+ * software is not intended to be used in any situation where a failure could
+ * cause risk of injury or damage to property. The software developed by NIST
+ * employees is not subject to copyright protection within the United States.
+ *
+ * Author: Evan Black <evan.black@nist.gov>
+ */
+#pragma once
+#include "binary/MappedFile.h"
+#include "file-parser.h"
+#include "handler/TransmitEndTracker.h"
+#include <cstddef>
+#include <optional>
+#include <vector>
+
+namespace parser {
+
+/**
+ * Parses a JSON scenario file with the 'events' section split
+ * into chunks, which are parsed on several threads.
+ *
+ * The remainder of the document is parsed on the calling thread
+ * while the chunks are parsed.
+ * Chunks are merged in file order, so events keep
+ * the same order as a sequential parse, and `TransmitEndEvent`s are
+ * inserted during the merge, so they are not affected by the chunk boundaries.
+ *
+ * When the parser is progressive, the remainder is parsed first,
+ * then each chunk is delivered as soon as it, and every chunk before it, are merged.
+ */
+class ChunkedParser {
+  /**
+   * A range of bytes in the file.
+   * `end` is one past the last byte in the range
+   */
+  struct Range {
+    std::size_t begin;
+    std::size_t end;
+  };
+
+  /**
+   * Files smaller than this are parsed sequentially,
+   * since splitting them would cost more than it saves
+   */
+  static constexpr std::size_t minimumFileSize = 32u * 1024u * 1024u;
+
+  /**
+   * The smallest chunk to split the 'events' section into
+   */
+  static constexpr std::size_t minimumChunkSize = 1024u * 1024u;
+
+  /**
+   * The number of chunks to split the 'events' section into
+   * when parsing progressively, so each delivered batch is fairly small
+   */
+  static constexpr std::size_t progressiveChunks = 256u;
+
+  /**
+   * The parser to emplace the models into
+   */
+  FileParser &fileParser;
+
+  /**
+   * Number of threads used to parse the chunks
+   */
+  unsigned int threads;
+
+  /**
+   * The file being parsed
+   */
+  binary::MappedFile file;
+
+  /**
+   * The 'events' array, including the brackets
+   */
+  Range eventsArray{0u, 0u};
+
+  /**
+   * The ranges of each chunk in the 'events' array.
+   * Each chunk begins at the start of an event object
+   * and ends at the end of an event object
+   */
+  std::vector<Range> chunks;
+
+  /**
+   * Walk the structure of the file, finding the 'events' array
+   * and splitting it into `chunks`
+   *
+   * @return
+   * True if the 'events' array was found, and follows the 'configuration' section
+   */
+  bool scan();
+
+  /**
+   * Split the 'events' array starting at `arrayBegin` into `chunks`
+   *
+   * @param arrayBegin
+   * The position of the '[' which starts the 'events' array
+   *
+   * @return
+   * True if the end of the array was found
+   */
+  bool scanEvents(std::size_t arrayBegin);
+
+  /**
+   * Add the events from `result` to the parser,
+   * inserting the `TransmitEndEvent`s with `transmitEnds`
+   *
+   * @param result
+   * The parsed chunk. Released once merged
+   *
+   * @param transmitEnds
+   * The tracker shared by every chunk, in file order
+   */
+  void merge(FileParser &result, TransmitEndTracker &transmitEnds);
+
+public:
+  /**
+   * Setup a chunked parse of a scenario file
+   *
+   * @param parser
+   * The parser to fill. Should be `reset()` beforehand
+   *
+   * @param threads
+   * The number of threads to use.
+   * 0 uses one thread per hardware thread.
+   * Progressive parsers may use a single thread
+   */
+  ChunkedParser(FileParser &parser, unsigned int threads);
+
+  /**
+   * Map & scan the file at `path`
+   *
+   * @param path
+   * The path to the JSON scenario file
+   *
+   * @return
+   * True if the file should be parsed with `parse()`.
+   * False if the file should be parsed sequentially instead
+   */
+  bool prepare(const char *path);
+
+  /**
+   * Parse the file prepared with `prepare()`
+   *
+   * @return
+   * An error if the file could not be parsed, an unset optional otherwise
+   */
+  std::optional<ParseError> parse();
+};
+
+} // namespace parser
@@ -0,0 +1,285 @@
+/*
+ * NIST-developed software is provided by NIST as a public service. You may use,
+ * copy and distribute copies of the software in any medium, provided that you
+ * keep intact this entire notice. You may improve,modify and create derivative
+ * works of the software or any portion of the software, and you may copy and
+ * distribute such modifications or works. Modified works should carry a notice
+ * stating that you changed the software and should note the date and nature of
+ * any such change. Please explicitly acknowledge the National Institute of
+ * Standards and Technology as the source of the software.
+ *
+ * NIST-developed software is expressly provided "AS IS." NIST MAKES NO
+ * WARRANTY OF ANY KIND, EXPRESS, IMPLIED, IN FACT OR ARISING BY OPERATION OF
+ * LAW, INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTY OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, NON-INFRINGEMENT
+ * AND DATA ACCURACY. NIST NEITHER REPRESENTS NOR WARRANTS THAT THE
+ * OPERATION OF THE SOFTWARE WILL BE UNINTERRUPTED OR ERROR-FREE, OR THAT
+ * ANY DEFECTS WILL BE CORRECTED. NIST DOES NOT WARRANT OR MAKE ANY
+ * REPRESENTATIONS REGARDING THE USE OF THE SOFTWARE OR THE RESULTS THEREOF,
+ * INCLUDING BUT NOT LIMITED TO THE CORRECTNESS, ACCURACY, RELIABILITY,
+ * OR USEFULNESS OF THE SOFTWARE.
+ *
+ * You are solely responsible for determining the appropriateness of using and
+ * distributing the software and you assume all risks associated with its use,
+ * including but not limited to the risks and costs of program errors,
+ * compliance with applicable laws, damage to or loss of data, programs or
+ * equipment, and the unavailability or interruption of operation. This
+ * software is not intended to be used in any situation where a failure could
+ * cause risk of injury or damage to property. The software developed by NIST
+ * employees is not subject to copyright protection within the United States.
+ *
+ * Author: Evan Black <evan.black@nist.gov>
+ */
+
+#include "compressed-stream.h"
+#include <cstring>
+
+#ifdef NETSIMULYZER_ZLIB
+#include <zlib.h>
+#endif
+
+#ifdef NETSIMULYZER_ZSTD
+#include <zstd.h>
+#endif
+
+namespace parser {
+
+Compression detectCompression(const char *header, std::size_t size) {
+  const auto byte = [header](std::size_t index) {
+    return static_cast<unsigned char>(header[index]);
+  };
+
+  if (size >= 2u && byte(0u) == 0x1Fu && byte(1u) == 0x8Bu)
+    return Compression::Gzip;
+
+  // Little endian 0xFD2FB528
+  if (size >= 4u && byte(0u) == 0x28u && byte(1u) == 0xB5u && byte(2u) == 0x2Fu && byte(3u) == 0xFDu)
+    return Compression::Zstd;
+
+  return Compression::None;
+}
+
+bool compressionSupported(Compression compression) {
+  switch (compression) {
+  case Compression::None:
+    return true;
+  case Compression::Gzip:
+#ifdef NETSIMULYZER_ZLIB
+    return true;
+#else
+    return false;
+#endif
+  case Compression::Zstd:
+#ifdef NETSIMULYZER_ZSTD
+    return true;
+#else
+    return false;
+#endif
+  }
+
+  return false;
+}
+
+DecompressingStream::DecompressingStream(FILE *file, Compression compression) : file(file), compression(compression) {
+  for (auto &buffer : ring)
+    buffer.data.resize(bufferSize);
+
+  decoder = std::thread{&DecompressingStream::decode, this};
+  next();
+}
+
+DecompressingStream::~DecompressingStream() {
+  {
+    std::lock_guard lock{mutex};
+    stopping = true;
+  }
+  bufferReleased.notify_all();
+  decoder.join();
+}
+
+void DecompressingStream::next() {
+  std::unique_lock lock{mutex};
+
+  if (holding) {
+    readIndex = (readIndex + 1u) % ring.size();
+    filled--;
+    holding = false;
+    bufferReleased.notify_one();
+  }
+
+  bufferFilled.wait(lock, [this]() {
+    return filled > 0u || finished;
+  });
+
+  // Every buffer was read
+  if (filled == 0u) {
+    current = end = nullptr;
+    return;
+  }
+
+  holding = true;
+  const auto &buffer = ring[readIndex];
+  current = buffer.data.data();
+  end = current + buffer.size;
+}
+
+DecompressingStream::Buffer *DecompressingStream::acquire() {
+  std::unique_lock lock{mutex};
+  bufferReleased.wait(lock, [this]() {
+    return filled < ring.size() || stopping;
+  });
+
+  if (stopping)
+    return nullptr;
+
+  auto &buffer = ring[(readIndex + filled) % ring.size()];
+  buffer.size = 0u;
+  return &buffer;
+}
+
+void DecompressingStream::publish() {
+  {
+    std::lock_guard lock{mutex};
+    filled++;
+  }
+  bufferFilled.notify_one();
+}
+
+void DecompressingStream::decode() {
+  switch (compression) {
+  case Compression::Gzip:
+    decodeGzip();
+    break;
+  case Compression::Zstd:
+    decodeZstd();
+    break;
+  case Compression::None:
+    decodeError = "File is not compressed";
+    break;
+  }
+
+  {
+    std::lock_guard lock{mutex};
+    finished = true;
+  }
+  bufferFilled.notify_all();
+}
+
+void DecompressingStream::decodeGzip() {
+#ifdef NETSIMULYZER_ZLIB
+  z_stream stream{};
+  // 32 for automatic gzip/zlib header detection
+  if (inflateInit2(&stream, 15 + 32) != Z_OK) {
+    decodeError = "Failed to start gzip decoding";
+    return;
+  }
+
+  std::vector<unsigned char> input(bufferSize);
+  auto result = Z_OK;
+  auto inputDone = false;
+  auto buffer = acquire();
+
+  while (buffer) {
+    if (stream.avail_in == 0u && !inputDone) {
+      stream.avail_in = static_cast<uInt>(std::fread(input.data(), 1u, input.size(), file));
+      stream.next_in = input.data();
+      inputDone = stream.avail_in == 0u;
+    }
+
+    stream.next_out = reinterpret_cast<Bytef *>(buffer->data.data() + buffer->size);
+    stream.avail_out = static_cast<uInt>(buffer->data.size() - buffer->size);
+    const auto before = stream.avail_out;
+
+    result = inflate(&stream, Z_NO_FLUSH);
+    buffer->size += before - stream.avail_out;
+
+    // Files may be several gzip members appended together
+    if (result == Z_STREAM_END) {
+      if (stream.avail_in == 0u) {
+        const auto next = std::fgetc(file);
+        if (next == EOF)
+          break;
+        std::ungetc(next, file);
+      }
+      result = inflateReset(&stream);
+    }
+
+    if (result != Z_OK && result != Z_BUF_ERROR) {
+      decodeError = stream.msg ? std::string{"Gzip error: "} + stream.msg : "Corrupt gzip file";
+      break;
+    }
+
+    if (inputDone && stream.avail_in == 0u && before == stream.avail_out) {
+      decodeError = "Unexpected end of gzip file";
+      break;
+    }
+
+    if (buffer->size == buffer->data.size()) {
+      publish();
+      buffer = acquire();
+    }
+  }
+
+  if (buffer && buffer->size > 0u)
+    publish();
+  inflateEnd(&stream);
+#endif
+}
+
+void DecompressingStream::decodeZstd() {
+#ifdef NETSIMULYZER_ZSTD
+  auto context = ZSTD_createDStream();
+  if (!context) {
+    decodeError = "Failed to start zstd decoding";
+    return;
+  }
+
+  std::vector<char> input(ZSTD_DStreamInSize());
+  ZSTD_inBuffer in{input.data(), 0u, 0u};
+  std::size_t lastResult = 0u;
+  // The decoder may still hold output after filling a buffer,
+  // so only read more once it had room left
+  auto drained = true;
+  auto buffer = acquire();
+
+  while (buffer) {
+    if (in.pos == in.size && drained) {
+      in.size = std::fread(input.data(), 1u, input.size(), file);
+      in.pos = 0u;
+
+      if (in.size == 0u) {
+        // A result of 0 means the last frame was complete
+        if (lastResult != 0u)
+          decodeError = "Unexpected end of zstd file";
+        break;
+      }
+    }
+
+    ZSTD_outBuffer out{buffer->data.data(), buffer->data.size(), buffer->size};
+    lastResult = ZSTD_decompressStream(context, &out, &in);
+    buffer->size = out.pos;
+    drained = out.pos < out.size;
+
+    if (ZSTD_isError(lastResult)) {
+      decodeError = std::string{"Zstd error: "} + ZSTD_getErrorName(lastResult);
+      break;
+    }
+
+    if (buffer->size == buffer->data.size()) {
+      publish();
+      buffer = acquire();
+    }
+  }
+
+  if (buffer && buffer->size > 0u)
+    publish();
+  ZSTD_freeDStream(context);
+#endif
+}
+
+std::optional<std::string> DecompressingStream::error() {
+  std::lock_guard lock{mutex};
+  return decodeError;
+}
+
+} // namespace parser
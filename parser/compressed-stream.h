@@ -0,0 +1,233 @@
+/*
+ * NIST-developed software is provided by NIST as a public service. You may use,
+ * copy and distribute copies of the software in any medium, provided that you
+ * keep intact this entire notice. You may improve,modify and create derivative
+ * works of the software or any portion of the software, and you may copy and
+ * distribute such modifications or works. Modified works should carry a notice
+ * stating that you changed the software and should note the date and nature of
+ * any such change. Please explicitly acknowledge the National Institute of
+ * Standards and Technology as the source of the software.
+ *
+ * NIST-developed software is expressly provided "AS IS." NIST MAKES NO
+ * WARRANTY OF ANY KIND, EXPRESS, IMPLIED, IN FACT OR ARISING BY OPERATION OF
+ * LAW, INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTY OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, NON-INFRINGEMENT
+ * AND DATA ACCURACY. NIST NEITHER REPRESENTS NOR WARRANTS THAT THE
+ * OPERATION OF THE SOFTWARE WILL BE UNINTERRUPTED OR ERROR-FREE, OR THAT
+ * ANY DEFECTS WILL BE CORRECTED. NIST DOES NOT WARRANT OR MAKE ANY
+ * REPRESENTATIONS REGARDING THE USE OF THE SOFTWARE OR THE RESULTS THEREOF,
+ * INCLUDING BUT NOT LIMITED TO THE CORRECTNESS, ACCURACY, RELIABILITY,
+ * OR USEFULNESS OF THE SOFTWARE.
+ *
+ * You are solely responsible for determining the appropriateness of using and
+ * distributing the software and you assume all risks associated with its use,
+ * including but not limited to the risks and costs of program errors,
+ * compliance with applicable laws, damage to or loss of data, programs or
+ * equipment, and the unavailability or interruption of operation. This
+ * software is not intended to be used in any situation where a failure could
+ * cause risk of injury or damage to property. The software developed by NIST
+ * employees is not subject to copyright protection within the United States.
+ *
+ * Author: Evan Black <evan.black@nist.gov>
+ */
+
+#pragma once
+#include <array>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdio>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace parser {
+
+/**
+ * Compression formats scenario files may be stored in
+ */
+enum class Compression { None, Gzip, Zstd };
+
+/**
+ * Find the compression of a file from its first bytes
+ *
+ * @param header
+ * The first bytes of the file
+ *
+ * @param size
+ * The number of bytes in `header`, at least 4 to detect every format
+ *
+ * @return
+ * The compression the file uses, or `Compression::None`
+ */
+[[nodiscard]] Compression detectCompression(const char *header, std::size_t size);
+
+/**
+ * @param compression
+ * The format to check
+ *
+ * @return
+ * True if this build may decode `compression`
+ */
+[[nodiscard]] bool compressionSupported(Compression compression);
+
+/**
+ * RapidJSON input stream, which decompresses a file on a separate thread.
+ *
+ * The decoder fills a ring of large buffers ahead of the parser,
+ * so decompression overlaps with parsing
+ */
+class DecompressingStream {
+  struct Buffer {
+    std::vector<char> data;
+    std::size_t size{0u};
+  };
+
+  /**
+   * Size of each buffer in the ring
+   */
+  static constexpr std::size_t bufferSize = 1u << 20u;
+
+  FILE *file;
+  Compression compression;
+
+  std::array<Buffer, 4u> ring;
+
+  /**
+   * Index in `ring` of the buffer being read by the parser
+   */
+  std::size_t readIndex{0u};
+
+  /**
+   * Number of buffers filled by the decoder, but not released by the parser,
+   * including the one being read
+   */
+  std::size_t filled{0u};
+
+  /**
+   * Set by the decoder once it has filled its last buffer
+   */
+  bool finished{false};
+
+  /**
+   * Set when the stream is destroyed, to stop the decoder early
+   */
+  bool stopping{false};
+
+  /**
+   * Set by the decoder if the file could not be decoded
+   */
+  std::optional<std::string> decodeError;
+
+  /**
+   * Guards the members shared with the decoder above
+   */
+  std::mutex mutex;
+  std::condition_variable bufferFilled;
+  std::condition_variable bufferReleased;
+
+  /**
+   * The next character in the current buffer, and the end of it.
+   * Equal once every character has been read
+   */
+  const char *current{nullptr};
+  const char *end{nullptr};
+
+  /**
+   * Characters taken so far
+   */
+  std::size_t count{0u};
+
+  /**
+   * Whether the parser holds a buffer from the ring
+   */
+  bool holding{false};
+
+  std::thread decoder;
+
+  /**
+   * Release the current buffer back to the decoder,
+   * and wait for the next one
+   */
+  void next();
+
+  /**
+   * Run on `decoder`, decompresses the file into the ring
+   */
+  void decode();
+
+  /**
+   * Wait for a free buffer in the ring
+   *
+   * @return
+   * The buffer to fill, or null if the stream is stopping
+   */
+  Buffer *acquire();
+
+  /**
+   * Hand a buffer filled by `acquire()` to the parser
+   */
+  void publish();
+
+  void decodeGzip();
+  void decodeZstd();
+
+public:
+  using Ch = char;
+
+  /**
+   * Start decompressing a file
+   *
+   * @param file
+   * The file to read, positioned at its start.
+   * Must stay open for the life of the stream
+   *
+   * @param compression
+   * The format of the file, must be supported, see `compressionSupported()`
+   */
+  DecompressingStream(FILE *file, Compression compression);
+  DecompressingStream(const DecompressingStream &other) = delete;
+  DecompressingStream &operator=(const DecompressingStream &other) = delete;
+  ~DecompressingStream();
+
+  [[nodiscard]] Ch Peek() const {
+    return current == end ? '\0' : *current;
+  }
+
+  Ch Take() {
+    if (current == end)
+      return '\0';
+
+    const auto c = *current++;
+    count++;
+    if (current == end)
+      next();
+    return c;
+  }
+
+  [[nodiscard]] std::size_t Tell() const {
+    return count;
+  }
+
+  // Not an output stream
+  Ch *PutBegin() {
+    return nullptr;
+  }
+  void Put(Ch) {
+  }
+  void Flush() {
+  }
+  std::size_t PutEnd(Ch *) {
+    return 0u;
+  }
+
+  /**
+   * @return
+   * The reason the file could not be decoded, if it could not.
+   * Only final once the parser has reached the end of the stream
+   */
+  [[nodiscard]] std::optional<std::string> error();
+};
+
+} // namespace parser
@@ -0,0 +1,224 @@
+/*
+ * NIST-developed software is provided by NIST as a public service. You may use,
+ * copy and distribute copies of the software in any medium, provided that you
+ * keep intact this entire notice. You may improve,modify and create derivative
+ * works of the software or any portion of the software, and you may copy and
+ * distribute such modifications or works. Modified works should carry a notice
+ * stating that you changed the software and should note the date and nature of
+ * any such change. Please explicitly acknowledge the National Institute of
+ * Standards and Technology as the source of the software.
+ *
+ * NIST-developed software is expressly provided "AS IS." NIST MAKES NO
+ * WARRANTY OF ANY KIND, EXPRESS, IMPLIED, IN FACT OR ARISING BY OPERATION OF
+ * LAW, INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTY OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, NON-INFRINGEMENT
+ * AND DATA ACCURACY. NIST NEITHER REPRESENTS NOR WARRANTS THAT THE
+ * OPERATION OF THE SOFTWARE WILL BE UNINTERRUPTED OR ERROR-FREE, OR THAT
+ * ANY DEFECTS WILL BE CORRECTED. NIST DOES NOT WARRANT OR MAKE ANY
+ * REPRESENTATIONS REGARDING THE USE OF THE SOFTWARE OR THE RESULTS THEREOF,
+ * INCLUDING BUT NOT LIMITED TO THE CORRECTNESS, ACCURACY, RELIABILITY,
+ * OR USEFULNESS OF THE SOFTWARE.
+ *
+ * You are solely responsible for determining the appropriateness of using and
+ * distributing the software and you assume all risks associated with its use,
+ * including but not limited to the risks and costs of program errors,
+ * compliance with applicable laws, damage to or loss of data, programs or
+ * equipment, and the unavailability or interruption of operation. This
+ * software is not intended to be used in any situation where a failure could
+ * cause risk of injury or damage to property. The software developed by NIST
+ * employees is not subject to copyright protection within the United States.
+ *
+ * Author: Evan Black <evan.black@nist.gov>
+ */
+
+
+#include "entity-streams.h"
+#include <iterator>
+#include <type_traits>
+#include <utility>
+
+namespace parser {
+
+void EntityEventStreams::reset(const std::vector<Node> &nodes, const std::vector<Decoration> &decorations) {
+  clear();
+
+  nodeStreams.reserve(nodes.size());
+  initialPositions.reserve(nodes.size());
+  for (const auto &node : nodes) {
+    if (!nodeSlots.try_emplace(node.id, static_cast<std::uint32_t>(nodeStreams.size())).second)
+      continue;
+    nodeStreams.emplace_back();
+    initialPositions.emplace_back(node.position);
+  }
+
+  decorationStreams.reserve(decorations.size());
+  for (const auto &decoration : decorations) {
+    if (decorationSlots.try_emplace(decoration.id, static_cast<std::uint32_t>(decorationStreams.size())).second)
+      decorationStreams.emplace_back();
+  }
+}
+
+void EntityEventStreams::clear() {
+  nodeSlots.clear();
+  decorationSlots.clear();
+  nodeStreams.clear();
+  decorationStreams.clear();
+  initialPositions.clear();
+  eventSlots.clear();
+  previousEvents.clear();
+  for (auto &column : typeColumns)
+    column.clear();
+}
+
+void EntityEventStreams::add(const SceneEvent &event) {
+  const auto index = static_cast<std::uint32_t>(eventSlots.size());
+
+  // The stream for the event, if its Node/Decoration is known
+  Stream *stream = nullptr;
+
+  const auto eventSlot = std::visit(
+      [this, index, &stream](const auto &e) -> std::uint32_t {
+        using T = std::decay_t<decltype(e)>;
+
+        if constexpr (std::is_same_v<T, DecorationMoveEvent> || std::is_same_v<T, DecorationOrientationChangeEvent>) {
+          const auto found = decorationSlots.find(e.decorationId);
+          if (found == decorationSlots.end())
+            return noSlot;
+          stream = &decorationStreams[found->second];
+          stream->events.emplace_back(index);
+          return found->second;
+        } else {
+          const auto found = nodeSlots.find(e.nodeId);
+          if (found == nodeSlots.end())
+            return noSlot;
+          stream = &nodeStreams[found->second];
+          stream->events.emplace_back(index);
+          if constexpr (std::is_same_v<T, MoveEvent>)
+            stream->moves.emplace_back(index);
+          return found->second;
+        }
+      },
+      event);
+
+  eventSlots.emplace_back(eventSlot);
+  if (stream)
+    previousEvents.emplace_back(std::exchange(stream->lastOfKind[kindOf(event)], index));
+  else
+    previousEvents.emplace_back(noEvent);
+  typeColumns[event.index()].emplace_back(index);
+}
+
+void EntityEventStreams::seek(std::size_t eventCount) {
+  auto seekStream = [eventCount](Stream &stream) {
+    const auto end = std::lower_bound(stream.events.begin(), stream.events.end(), eventCount);
+    stream.cursor = static_cast<std::size_t>(std::distance(stream.events.begin(), end));
+  };
+
+  for (auto &stream : nodeStreams)
+    seekStream(stream);
+
+  for (auto &stream : decorationStreams)
+    seekStream(stream);
+}
+
+std::uint32_t EntityEventStreams::slot(std::size_t eventIndex) const {
+  return eventSlots[eventIndex];
+}
+
+std::uint32_t EntityEventStreams::previousOfKind(std::size_t eventIndex) const {
+  return previousEvents[eventIndex];
+}
+
+std::size_t EntityEventStreams::kindOf(const SceneEvent &event) {
+  return std::visit(
+      [](const auto &e) -> std::size_t {
+        using T = std::decay_t<decltype(e)>;
+
+        if constexpr (std::is_same_v<T, MoveEvent> || std::is_same_v<T, DecorationMoveEvent>)
+          return 0u;
+        else if constexpr (std::is_same_v<T, NodeOrientationChangeEvent> ||
+                           std::is_same_v<T, DecorationOrientationChangeEvent>)
+          return 1u;
+        else if constexpr (std::is_same_v<T, NodeColorChangeEvent>)
+          return e.type == NodeColorChangeEvent::ColorType::Base ? 2u : 3u;
+        else
+          return 4u; // TransmitEvent & TransmitEndEvent
+      },
+      event);
+}
+
+std::size_t EntityEventStreams::memoryUsage() const {
+  auto bytes = (eventSlots.capacity() + previousEvents.capacity()) * sizeof(std::uint32_t) +
+               initialPositions.capacity() * sizeof(Ns3Coordinate);
+
+  for (const auto &column : typeColumns)
+    bytes += column.capacity() * sizeof(std::uint32_t);
+
+  for (const auto *streams : {&nodeStreams, &decorationStreams}) {
+    bytes += streams->capacity() * sizeof(Stream);
+    for (const auto &stream : *streams)
+      bytes += (stream.events.capacity() + stream.moves.capacity()) * sizeof(std::uint32_t);
+  }
+
+  // Roughly one node & a bucket per slot
+  constexpr auto slotBytes = sizeof(std::pair<unsigned int, std::uint32_t>) + 2u * sizeof(void *);
+  bytes += (nodeSlots.size() + decorationSlots.size()) * slotBytes;
+  return bytes;
+}
+
+std::uint32_t EntityEventStreams::nodeSlot(unsigned int id) const {
+  const auto found = nodeSlots.find(id);
+  if (found == nodeSlots.end())
+    return noSlot;
+  return found->second;
+}
+
+std::uint32_t EntityEventStreams::decorationSlot(unsigned int id) const {
+  const auto found = decorationSlots.find(id);
+  if (found == decorationSlots.end())
+    return noSlot;
+  return found->second;
+}
+
+std::size_t EntityEventStreams::nodeCount() const {
+  return nodeStreams.size();
+}
+
+std::size_t EntityEventStreams::decorationCount() const {
+  return decorationStreams.size();
+}
+
+EntityEventStreams::Stream &EntityEventStreams::getNodeStream(std::uint32_t slot) {
+  return nodeStreams[slot];
+}
+
+EntityEventStreams::Waypoints EntityEventStreams::waypoints(std::uint32_t slot) const {
+  const auto &stream = nodeStreams[slot];
+  const auto next = stream.moves.begin() + static_cast<std::ptrdiff_t>(appliedMoves(slot));
+
+  Waypoints result;
+  if (next != stream.moves.end())
+    result.next = *next;
+  if (next != stream.moves.begin())
+    result.previous = *std::prev(next);
+  return result;
+}
+
+std::size_t EntityEventStreams::appliedMoves(std::uint32_t slot) const {
+  const auto &stream = nodeStreams[slot];
+
+  // Every move before the first unapplied event has been applied
+  const auto applied = stream.cursor < stream.events.size() ? stream.events[stream.cursor] : eventSlots.size();
+  return static_cast<std::size_t>(
+      std::distance(stream.moves.begin(), std::lower_bound(stream.moves.begin(), stream.moves.end(), applied)));
+}
+
+const Ns3Coordinate &EntityEventStreams::getInitialPosition(std::uint32_t slot) const {
+  return initialPositions[slot];
+}
+
+EntityEventStreams::Stream &EntityEventStreams::getDecorationStream(std::uint32_t slot) {
+  return decorationStreams[slot];
+}
+
+} // namespace parser
@@ -0,0 +1,531 @@
+/*
+ * NIST-developed software is provided by NIST as a public service. You may use,
+ * copy and distribute copies of the software in any medium, provided that you
+ * keep intact this entire notice. You may improve,modify and create derivative
+ * works of the software or any portion of the software, and you may copy and
+ * distribute such modifications or works. Modified works should carry a notice
+ * stating that you changed the software and should note the date and nature of
+ * any such change. Please explicitly acknowledge the National Institute of
+ * Standards and Technology as the source of the software.
+ *
+ * NIST-developed software is expressly provided "AS IS." NIST MAKES NO
+ * WARRANTY OF ANY KIND, EXPRESS, IMPLIED, IN FACT OR ARISING BY OPERATION OF
+ * LAW, INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTY OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, NON-INFRINGEMENT
+ * AND DATA ACCURACY. NIST NEITHER REPRESENTS NOR WARRANTS THAT THE
+ * OPERATION OF THE SOFTWARE WILL BE UNINTERRUPTED OR ERROR-FREE, OR THAT
+ * ANY DEFECTS WILL BE CORRECTED. NIST DOES NOT WARRANT OR MAKE ANY
+ * REPRESENTATIONS REGARDING THE USE OF THE SOFTWARE OR THE RESULTS THEREOF,
+ * INCLUDING BUT NOT LIMITED TO THE CORRECTNESS, ACCURACY, RELIABILITY,
+ * OR USEFULNESS OF THE SOFTWARE.
+ *
+ * You are solely responsible for determining the appropriateness of using and
+ * distributing the software and you assume all risks associated with its use,
+ * including but not limited to the risks and costs of program errors,
+ * compliance with applicable laws, damage to or loss of data, programs or
+ * equipment, and the unavailability or interruption of operation. This
+ * software is not intended to be used in any situation where a failure could
+ * cause risk of injury or damage to property. The software developed by NIST
+ * employees is not subject to copyright protection within the United States.
+ *
+ * Author: Evan Black <evan.black@nist.gov>
+ */
+
+
+#pragma once
+
+#include "model.h"
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <optional>
+#include <type_traits>
+#include <unordered_map>
+#include <variant>
+#include <vector>
+
+namespace parser {
+
+/**
+ * A run of events from the full event list, by index.
+ * Refers to the events and the index column it was made from, rather than copying either,
+ * so it is only valid until either changes
+ *
+ * @tparam Events
+ * The container of every event, indexable by position
+ */
+template <class Events>
+class EventView {
+public:
+  class iterator {
+    const Events *events{nullptr};
+    const std::uint32_t *index{nullptr};
+
+  public:
+    using iterator_category = std::random_access_iterator_tag;
+    using value_type = typename Events::value_type;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const value_type *;
+    using reference = const value_type &;
+
+    iterator() = default;
+    iterator(const Events *events, const std::uint32_t *index) : events(events), index(index) {
+    }
+
+    reference operator*() const {
+      return (*events)[*index];
+    }
+
+    pointer operator->() const {
+      return &(*events)[*index];
+    }
+
+    iterator &operator++() {
+      ++index;
+      return *this;
+    }
+
+    iterator operator++(int) {
+      auto copy = *this;
+      ++index;
+      return copy;
+    }
+
+    iterator &operator--() {
+      --index;
+      return *this;
+    }
+
+    iterator &operator+=(difference_type n) {
+      index += n;
+      return *this;
+    }
+
+    iterator operator+(difference_type n) const {
+      return {events, index + n};
+    }
+
+    difference_type operator-(const iterator &other) const {
+      return index - other.index;
+    }
+
+    bool operator==(const iterator &other) const {
+      return index == other.index;
+    }
+
+    bool operator!=(const iterator &other) const {
+      return index != other.index;
+    }
+
+    /**
+     * @return
+     * The index of the current event in the full event list
+     */
+    [[nodiscard]] std::uint32_t eventIndex() const {
+      return *index;
+    }
+  };
+
+private:
+  const Events *events{nullptr};
+  const std::uint32_t *first{nullptr};
+  const std::uint32_t *last{nullptr};
+
+public:
+  EventView() = default;
+  EventView(const Events &events, const std::uint32_t *first, const std::uint32_t *last)
+      : events(&events), first(first), last(last) {
+  }
+
+  [[nodiscard]] iterator begin() const {
+    return {events, first};
+  }
+
+  [[nodiscard]] iterator end() const {
+    return {events, last};
+  }
+
+  [[nodiscard]] std::size_t size() const {
+    return static_cast<std::size_t>(last - first);
+  }
+
+  [[nodiscard]] bool empty() const {
+    return first == last;
+  }
+
+  [[nodiscard]] const typename Events::value_type &operator[](std::size_t i) const {
+    return (*events)[first[i]];
+  }
+};
+
+/**
+ * The scene events for each Node & Decoration, in time order,
+ * built as the scene events are added.
+ *
+ * Resolves the Node/Decoration of each event to a dense slot once,
+ * so applying an event does not need a lookup by ID.
+ * A stream may also be searched without touching the other events,
+ * e.g. for the position of one Node at any time
+ */
+class EntityEventStreams {
+public:
+  /**
+   * Slot for events of unknown Nodes/Decorations
+   */
+  static constexpr std::uint32_t noSlot = std::numeric_limits<std::uint32_t>::max();
+
+  /**
+   * Index for the lack of an event, see `previousOfKind()`
+   */
+  static constexpr std::uint32_t noEvent = std::numeric_limits<std::uint32_t>::max();
+
+  struct Stream {
+    /**
+     * Indices in the full event list of the events for this Node/Decoration, in order
+     */
+    std::vector<std::uint32_t> events;
+
+    /**
+     * The number of `events` which have been applied
+     */
+    std::size_t cursor{0u};
+
+    /**
+     * Indices in the full event list of the `MoveEvent`s in `events`,
+     * the waypoints of a Node. Always empty for Decorations
+     */
+    std::vector<std::uint32_t> moves;
+
+    /**
+     * Index in the full event list of the latest event added of each kind, see `kindOf()`
+     */
+    std::array<std::uint32_t, 5u> lastOfKind{noEvent, noEvent, noEvent, noEvent, noEvent};
+  };
+
+  /**
+   * The waypoints around the current position of a Node
+   */
+  struct Waypoints {
+    /**
+     * Index in the full event list of the last applied `MoveEvent`,
+     * unset if the Node is still at its initial position
+     */
+    std::optional<std::uint32_t> previous;
+
+    /**
+     * Index in the full event list of the next `MoveEvent` to apply,
+     * unset if there are no more loaded
+     */
+    std::optional<std::uint32_t> next;
+  };
+
+private:
+  /**
+   * Slot of each Node by ID, the index in `nodeStreams`
+   */
+  std::unordered_map<unsigned int, std::uint32_t> nodeSlots;
+
+  /**
+   * Slot of each Decoration by ID, the index in `decorationStreams`
+   */
+  std::unordered_map<unsigned int, std::uint32_t> decorationSlots;
+
+  std::vector<Stream> nodeStreams;
+  std::vector<Stream> decorationStreams;
+
+  /**
+   * The position of each Node before any events, by slot
+   */
+  std::vector<Ns3Coordinate> initialPositions;
+
+  /**
+   * The slot of the Node/Decoration for every event added, in order
+   */
+  std::vector<std::uint32_t> eventSlots;
+
+  /**
+   * Indices of every event added, including those for unknown Nodes/Decorations,
+   * by the index of its type in `SceneEvent`
+   */
+  std::array<std::vector<std::uint32_t>, std::variant_size_v<SceneEvent>> typeColumns;
+
+  /**
+   * For every event added, the index of the previous event of the same kind
+   * for the same Node/Decoration, or `noEvent` if it is the first
+   */
+  std::vector<std::uint32_t> previousEvents;
+
+  /**
+   * The part of a Node/Decoration an event sets. Events of the same kind replace each other's changes:
+   * a move, an orientation change, a change to each color, and the start/end of a transmission
+   *
+   * @return
+   * The index in `Stream::lastOfKind` for `event`
+   */
+  [[nodiscard]] static std::size_t kindOf(const SceneEvent &event);
+
+  /**
+   * @return
+   * The index of `T` in `SceneEvent`
+   */
+  template <class T, std::size_t I = 0u>
+  static constexpr std::size_t typeIndex() {
+    if constexpr (std::is_same_v<std::variant_alternative_t<I, SceneEvent>, T>)
+      return I;
+    else
+      return typeIndex<T, I + 1u>();
+  }
+
+  /**
+   * Find the events in `column` from `from` to `to`, inclusive
+   *
+   * @param column
+   * Indices in `events`, in time order
+   */
+  template <class Events>
+  [[nodiscard]] static EventView<Events> range(const std::vector<std::uint32_t> &column, nanoseconds from,
+                                               nanoseconds to, const Events &events) {
+    auto time = [&events](std::uint32_t index) {
+      return std::visit(
+          [](const auto &e) {
+            return e.time;
+          },
+          events[index]);
+    };
+
+    const auto first =
+        std::lower_bound(column.begin(), column.end(), from, [&time](std::uint32_t index, nanoseconds value) {
+          return time(index) < value;
+        });
+    const auto last = std::upper_bound(first, column.end(), to, [&time](nanoseconds value, std::uint32_t index) {
+      return value < time(index);
+    });
+
+    return {events, column.data() + std::distance(column.begin(), first),
+            column.data() + std::distance(column.begin(), last)};
+  }
+
+public:
+  /**
+   * Remove every stream, and assign a slot to each of `nodes` & `decorations`.
+   * Only the first Node/Decoration with an ID gets a slot
+   *
+   * @param nodes
+   * The Nodes in the scene
+   *
+   * @param decorations
+   * The Decorations in the scene
+   */
+  void reset(const std::vector<Node> &nodes, const std::vector<Decoration> &decorations);
+
+  /**
+   * Remove every stream & slot
+   */
+  void clear();
+
+  /**
+   * Append the next scene event to the stream for its Node/Decoration.
+   * Should be called with every event, in order
+   *
+   * @param event
+   * The event to add
+   */
+  void add(const SceneEvent &event);
+
+  /**
+   * Set the cursor of every stream to the events before `eventCount`
+   *
+   * @param eventCount
+   * The number of events applied
+   */
+  void seek(std::size_t eventCount);
+
+  /**
+   * @param eventIndex
+   * The index of an added event
+   *
+   * @return
+   * The slot of the Node/Decoration for that event,
+   * or `noSlot` if the Node/Decoration is unknown
+   */
+  [[nodiscard]] std::uint32_t slot(std::size_t eventIndex) const;
+
+  /**
+   * Find the event which set the same part of the same Node/Decoration before an event,
+   * i.e. the value an event replaces. Recorded as each event is added, so this is constant time
+   *
+   * @param eventIndex
+   * The index of an added event
+   *
+   * @return
+   * The index of the previous event of the same kind for the same Node/Decoration,
+   * or `noEvent` if there is none, or the Node/Decoration is unknown
+   */
+  [[nodiscard]] std::uint32_t previousOfKind(std::size_t eventIndex) const;
+
+  /**
+   * @return
+   * The bytes held by the streams & the per event columns
+   */
+  [[nodiscard]] std::size_t memoryUsage() const;
+
+  /**
+   * @return
+   * The slot for the Node with `id`, or `noSlot` if there is none
+   */
+  [[nodiscard]] std::uint32_t nodeSlot(unsigned int id) const;
+
+  /**
+   * @return
+   * The slot for the Decoration with `id`, or `noSlot` if there is none
+   */
+  [[nodiscard]] std::uint32_t decorationSlot(unsigned int id) const;
+
+  [[nodiscard]] std::size_t nodeCount() const;
+  [[nodiscard]] std::size_t decorationCount() const;
+
+  [[nodiscard]] Stream &getNodeStream(std::uint32_t slot);
+
+  /**
+   * Find the moves on either side of a Node's stream cursor
+   *
+   * @param slot
+   * The slot of the Node
+   */
+  [[nodiscard]] Waypoints waypoints(std::uint32_t slot) const;
+
+  /**
+   * @param slot
+   * The slot of the Node
+   *
+   * @return
+   * The number of the Node's `moves` before its stream cursor, which have been applied
+   */
+  [[nodiscard]] std::size_t appliedMoves(std::uint32_t slot) const;
+
+  /**
+   * @param slot
+   * The slot of the Node
+   *
+   * @return
+   * The position of the Node before any events
+   */
+  [[nodiscard]] const Ns3Coordinate &getInitialPosition(std::uint32_t slot) const;
+  [[nodiscard]] Stream &getDecorationStream(std::uint32_t slot);
+
+  /**
+   * Find the position of a Node at `time`, from only its own events
+   *
+   * @param nodeId
+   * The ID of the Node to find
+   *
+   * @param time
+   * The time to find the Node at
+   *
+   * @param events
+   * Every event passed to `add()`, in the same order
+   *
+   * @return
+   * The position after the last `MoveEvent` at, or before, `time`.
+   * Unset for unknown Nodes
+   */
+  template <class Events>
+  [[nodiscard]] std::optional<Ns3Coordinate> getNodePosition(unsigned int nodeId, nanoseconds time,
+                                                             const Events &events) const {
+    const auto nodeSlot = this->nodeSlot(nodeId);
+    if (nodeSlot == noSlot)
+      return {};
+
+    const auto &stream = nodeStreams[nodeSlot].events;
+    auto after = std::upper_bound(stream.begin(), stream.end(), time, [&events](nanoseconds value, std::uint32_t index) {
+      return value < std::visit(
+                         [](const auto &e) {
+                           return e.time;
+                         },
+                         events[index]);
+    });
+
+    while (after != stream.begin()) {
+      --after;
+      if (const auto move = std::get_if<MoveEvent>(&events[*after]))
+        return move->targetPosition;
+    }
+
+    return initialPositions[nodeSlot];
+  }
+
+  /**
+   * Find every event for a Node between two times.
+   * O(log n + k) for the n events of the Node & the k found
+   *
+   * @param nodeId
+   * The ID of the Node
+   *
+   * @param from
+   * The earliest time to include
+   *
+   * @param to
+   * The latest time to include
+   *
+   * @param events
+   * Every event passed to `add()`, in the same order
+   *
+   * @return
+   * The events, in time order. Empty for unknown Nodes
+   */
+  template <class Events>
+  [[nodiscard]] EventView<Events> nodeEvents(unsigned int nodeId, nanoseconds from, nanoseconds to,
+                                             const Events &events) const {
+    const auto nodeSlot = this->nodeSlot(nodeId);
+    if (nodeSlot == noSlot)
+      return {};
+
+    return range(nodeStreams[nodeSlot].events, from, to, events);
+  }
+
+  /**
+   * Find every event for a Decoration between two times.
+   * See `nodeEvents()`
+   */
+  template <class Events>
+  [[nodiscard]] EventView<Events> decorationEvents(unsigned int decorationId, nanoseconds from, nanoseconds to,
+                                                   const Events &events) const {
+    const auto decorationSlot = this->decorationSlot(decorationId);
+    if (decorationSlot == noSlot)
+      return {};
+
+    return range(decorationStreams[decorationSlot].events, from, to, events);
+  }
+
+  /**
+   * Find every event of one type between two times, for any Node/Decoration.
+   * O(log n + k) for the n events of the type & the k found.
+   *
+   * e.g. The transmissions started in a window:
+   * `eventsOfType<TransmitEvent>(from, to, events)`
+   *
+   * @tparam T
+   * One of the `SceneEvent` types
+   *
+   * @param from
+   * The earliest time to include
+   *
+   * @param to
+   * The latest time to include
+   *
+   * @param events
+   * Every event passed to `add()`, in the same order
+   *
+   * @return
+   * The events, in time order
+   */
+  template <class T, class Events>
+  [[nodiscard]] EventView<Events> eventsOfType(nanoseconds from, nanoseconds to, const Events &events) const {
+    return range(typeColumns[typeIndex<T>()], from, to, events);
+  }
+};
+
+} // namespace parser
@@ -0,0 +1,201 @@
+/*
+ * NIST-developed software is provided by NIST as a public service. You may use,
+ * copy and distribute copies of the software in any medium, provided that you
+ * keep intact this entire notice. You may improve,modify and create derivative
+ * works of the software or any portion of the software, and you may copy and
+ * distribute such modifications or works. Modified works should carry a notice
+ * stating that you changed the software and should note the date and nature of
+ * any such change. Please explicitly acknowledge the National Institute of
+ * Standards and Technology as the source of the software.
+ *
+ * NIST-developed software is expressly provided "AS IS." NIST MAKES NO
+ * WARRANTY OF ANY KIND, EXPRESS, IMPLIED, IN FACT OR ARISING BY OPERATION OF
+ * LAW, INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTY OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, NON-INFRINGEMENT
+ * AND DATA ACCURACY. NIST NEITHER REPRESENTS NOR WARRANTS THAT THE
+ * OPERATION OF THE SOFTWARE WILL BE UNINTERRUPTED OR ERROR-FREE, OR THAT
+ * ANY DEFECTS WILL BE CORRECTED. NIST DOES NOT WARRANT OR MAKE ANY
+ * REPRESENTATIONS REGARDING THE USE OF THE SOFTWARE OR THE RESULTS THEREOF,
+ * INCLUDING BUT NOT LIMITED TO THE CORRECTNESS, ACCURACY, RELIABILITY,
+ * OR USEFULNESS OF THE SOFTWARE.
+ *
+ * You are solely responsible for determining the appropriateness of using and
+ * distributing the software and you assume all risks associated with its use,
+ * including but not limited to the risks and costs of program errors,
+ * compliance with applicable laws, damage to or loss of data, programs or
+ * equipment, and the unavailability or interruption of operation. This
+ * software is not intended to be used in any situation where a failure could
+ * cause risk of injury or damage to property. The software developed by NIST
+ * employees is not subject to copyright protection within the United States.
+ *
+ * Author: Evan Black <evan.black@nist.gov>
+ */
+
+#include "event-compactor.h"
+#include <algorithm>
+#include <cmath>
+#include <type_traits>
+#include <utility>
+#include <variant>
+
+namespace parser {
+
+namespace {
+
+struct Waypoint {
+  Ns3Coordinate position;
+  nanoseconds time;
+};
+
+/**
+ * The distance from `point` to where a Node moving from `from` to `to`
+ * would be at the time of `point`
+ */
+double synchronizedDistance(const Waypoint &point, const Waypoint &from, const Waypoint &to) {
+  const auto span = to.time - from.time;
+  const auto ratio =
+      span > 0LL ? static_cast<double>(point.time - from.time) / static_cast<double>(span) : 0.0;
+
+  const auto x = from.position.x + (to.position.x - from.position.x) * ratio - point.position.x;
+  const auto y = from.position.y + (to.position.y - from.position.y) * ratio - point.position.y;
+  const auto z = from.position.z + (to.position.z - from.position.z) * ratio - point.position.z;
+  return std::sqrt(x * x + y * y + z * z);
+}
+
+bool sameColor(const std::optional<Ns3Color3> &left, const std::optional<Ns3Color3> &right) {
+  if (left.has_value() != right.has_value())
+    return false;
+  if (!left)
+    return true;
+
+  return left->red == right->red && left->green == right->green && left->blue == right->blue;
+}
+
+} // namespace
+
+EventCompactor::EventCompactor(double tolerance) : tolerance{tolerance} {
+}
+
+void EventCompactor::reset(const std::vector<Node> &initialNodes) {
+  nodes.clear();
+  removed = 0u;
+
+  for (const auto &node : initialNodes) {
+    NodeState state;
+    state.position = node.position;
+    state.orientation = node.orientation;
+    state.baseColor = node.baseColor;
+    state.highlightColor = node.highlightColor;
+    nodes.try_emplace(node.id, state);
+  }
+}
+
+void EventCompactor::simplify(const std::vector<SceneEvent> &events, const std::vector<std::size_t> &moves,
+                              NodeState &state, std::vector<bool> &keep) const {
+  // The Node's state before the batch anchors the start, so the first move may be dropped too
+  std::vector<Waypoint> points;
+  points.reserve(moves.size() + 1u);
+  points.push_back({state.position, state.time});
+  for (const auto index : moves) {
+    const auto &move = std::get<MoveEvent>(events[index]);
+    points.push_back({move.targetPosition, move.time});
+  }
+
+  // Later batches may continue on from the last move, so it is always kept
+  std::vector<bool> kept(points.size(), false);
+  kept.front() = true;
+  kept.back() = true;
+
+  std::vector<std::pair<std::size_t, std::size_t>> spans{{0u, points.size() - 1u}};
+  while (!spans.empty()) {
+    const auto [first, last] = spans.back();
+    spans.pop_back();
+
+    auto furthest = first;
+    auto furthestDistance = 0.0;
+    for (auto i = first + 1u; i < last; i++) {
+      const auto distance = synchronizedDistance(points[i], points[first], points[last]);
+      if (distance > furthestDistance) {
+        furthest = i;
+        furthestDistance = distance;
+      }
+    }
+
+    if (furthestDistance <= tolerance)
+      continue;
+
+    kept[furthest] = true;
+    if (furthest - first > 1u)
+      spans.emplace_back(first, furthest);
+    if (last - furthest > 1u)
+      spans.emplace_back(furthest, last);
+  }
+
+  for (std::size_t i = 0u; i < moves.size(); i++) {
+    if (!kept[i + 1u])
+      keep[moves[i]] = false;
+  }
+
+  state.position = points.back().position;
+  state.time = points.back().time;
+}
+
+std::size_t EventCompactor::compact(std::vector<SceneEvent> &events) {
+  std::vector<bool> keep(events.size(), true);
+  std::unordered_map<unsigned int, std::vector<std::size_t>> moves;
+
+  for (std::size_t i = 0u; i < events.size(); i++) {
+    std::visit(
+        [this, i, &keep, &moves](const auto &e) {
+          using T = std::decay_t<decltype(e)>;
+
+          if constexpr (std::is_same_v<T, MoveEvent>) {
+            if (nodes.find(e.nodeId) != nodes.end())
+              moves[e.nodeId].emplace_back(i);
+          } else if constexpr (std::is_same_v<T, NodeOrientationChangeEvent>) {
+            const auto node = nodes.find(e.nodeId);
+            if (node == nodes.end())
+              return;
+
+            if (node->second.orientation == e.targetOrientation)
+              keep[i] = false;
+            node->second.orientation = e.targetOrientation;
+          } else if constexpr (std::is_same_v<T, NodeColorChangeEvent>) {
+            const auto node = nodes.find(e.nodeId);
+            if (node == nodes.end())
+              return;
+
+            auto &color = e.type == NodeColorChangeEvent::ColorType::Base ? node->second.baseColor
+                                                                           : node->second.highlightColor;
+            if (sameColor(color, e.targetColor))
+              keep[i] = false;
+            color = e.targetColor;
+          }
+        },
+        events[i]);
+  }
+
+  for (const auto &[id, nodeMoves] : moves)
+    simplify(events, nodeMoves, nodes[id], keep);
+
+  std::size_t next = 0u;
+  for (std::size_t i = 0u; i < events.size(); i++) {
+    if (!keep[i])
+      continue;
+
+    if (next != i)
+      events[next] = std::move(events[i]);
+    next++;
+  }
+
+  const auto batchRemoved = events.size() - next;
+  events.resize(next);
+  removed += batchRemoved;
+  return batchRemoved;
+}
+
+std::size_t EventCompactor::getRemoved() const {
+  return removed;
+}
+
+} // namespace parser
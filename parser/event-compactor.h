@@ -0,0 +1,134 @@
+/*
+ * NIST-developed software is provided by NIST as a public service. You may use,
+ * copy and distribute copies of the software in any medium, provided that you
+ * keep intact this entire notice. You may improve,modify and create derivative
+ * works of the software or any portion of the software, and you may copy and
+ * distribute such modifications or works. Modified works should carry a notice
+ * stating that you changed the software and should note the date and nature of
+ * any such change. Please explicitly acknowledge the National Institute of
+ * Standards and Technology as the source of the software.
+ *
+ * NIST-developed software is expressly provided "AS IS." NIST MAKES NO
+ * WARRANTY OF ANY KIND, EXPRESS, IMPLIED, IN FACT OR ARISING BY OPERATION OF
+ * LAW, INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTY OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, NON-INFRINGEMENT
+ * AND DATA ACCURACY. NIST NEITHER REPRESENTS NOR WARRANTS THAT THE
+ * OPERATION OF THE SOFTWARE WILL BE UNINTERRUPTED OR ERROR-FREE, OR THAT
+ * ANY DEFECTS WILL BE CORRECTED. NIST DOES NOT WARRANT OR MAKE ANY
+ * REPRESENTATIONS REGARDING THE USE OF THE SOFTWARE OR THE RESULTS THEREOF,
+ * INCLUDING BUT NOT LIMITED TO THE CORRECTNESS, ACCURACY, RELIABILITY,
+ * OR USEFULNESS OF THE SOFTWARE.
+ *
+ * You are solely responsible for determining the appropriateness of using and
+ * distributing the software and you assume all risks associated with its use,
+ * including but not limited to the risks and costs of program errors,
+ * compliance with applicable laws, damage to or loss of data, programs or
+ * equipment, and the unavailability or interruption of operation. This
+ * software is not intended to be used in any situation where a failure could
+ * cause risk of injury or damage to property. The software developed by NIST
+ * employees is not subject to copyright protection within the United States.
+ *
+ * Author: Evan Black <evan.black@nist.gov>
+ */
+
+#pragma once
+
+#include "model.h"
+#include <array>
+#include <cstddef>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+namespace parser {
+
+/**
+ * Removes scene events which barely change what is shown, as batches of events are parsed.
+ *
+ * Each Node's moves are simplified Douglas-Peucker style, measuring a dropped move
+ * against where the Node would be along the kept ones at that move's time,
+ * so a Node moving at a steady speed keeps only the moves where it turns or changes speed.
+ * Orientation & color changes to the state a Node is already in are dropped as well.
+ *
+ * State is kept between batches, so the batches must be compacted in time order
+ */
+class EventCompactor {
+  /**
+   * The state of a Node as of the events compacted so far
+   */
+  struct NodeState {
+    /**
+     * The last move kept, or the initial position at time 0
+     */
+    Ns3Coordinate position;
+    nanoseconds time{0LL};
+
+    std::array<double, 3> orientation{0.0};
+    std::optional<Ns3Color3> baseColor;
+    std::optional<Ns3Color3> highlightColor;
+  };
+
+  /**
+   * The furthest a dropped move may be from the simplified path, in ns-3 units
+   */
+  double tolerance;
+
+  std::unordered_map<unsigned int, NodeState> nodes;
+
+  /**
+   * Events removed since the last `reset()`
+   */
+  std::size_t removed{0u};
+
+  /**
+   * Mark the moves of one Node to drop, keeping its last move in the batch
+   *
+   * @param events
+   * The batch of events
+   *
+   * @param moves
+   * The indices in `events` of the Node's moves, in order
+   *
+   * @param state
+   * The Node's state before the batch. Its position is updated to the last move
+   *
+   * @param keep
+   * Set to false for each move dropped, by index in `events`
+   */
+  void simplify(const std::vector<SceneEvent> &events, const std::vector<std::size_t> &moves, NodeState &state,
+                std::vector<bool> &keep) const;
+
+public:
+  /**
+   * @param tolerance
+   * The furthest a dropped move may be from the simplified path, in ns-3 units
+   */
+  explicit EventCompactor(double tolerance);
+
+  /**
+   * Start over with the initial state of a new scenario
+   *
+   * @param initialNodes
+   * The Nodes of the scenario, as defined before any event
+   */
+  void reset(const std::vector<Node> &initialNodes);
+
+  /**
+   * Remove the redundant events from a batch
+   *
+   * @param events
+   * The batch, in time order, after every batch already compacted
+   *
+   * @return
+   * The number of events removed from `events`
+   */
+  std::size_t compact(std::vector<SceneEvent> &events);
+
+  /**
+   * @return
+   * The number of events removed since the last `reset()`
+   */
+  [[nodiscard]] std::size_t getRemoved() const;
+};
+
+} // namespace parser
@@ -0,0 +1,179 @@
+/*
+ * NIST-developed software is provided by NIST as a public service. You may use,
+ * copy and distribute copies of the software in any medium, provided that you
+ * keep intact this entire notice. You may improve,modify and create derivative
+ * works of the software or any portion of the software, and you may copy and
+ * distribute such modifications or works. Modified works should carry a notice
+ * stating that you changed the software and should note the date and nature of
+ * any such change. Please explicitly acknowledge the National Institute of
+ * Standards and Technology as the source of the software.
+ *
+ * NIST-developed software is expressly provided "AS IS." NIST MAKES NO
+ * WARRANTY OF ANY KIND, EXPRESS, IMPLIED, IN FACT OR ARISING BY OPERATION OF
+ * LAW, INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTY OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, NON-INFRINGEMENT
+ * AND DATA ACCURACY. NIST NEITHER REPRESENTS NOR WARRANTS THAT THE
+ * OPERATION OF THE SOFTWARE WILL BE UNINTERRUPTED OR ERROR-FREE, OR THAT
+ * ANY DEFECTS WILL BE CORRECTED. NIST DOES NOT WARRANT OR MAKE ANY
+ * REPRESENTATIONS REGARDING THE USE OF THE SOFTWARE OR THE RESULTS THEREOF,
+ * INCLUDING BUT NOT LIMITED TO THE CORRECTNESS, ACCURACY, RELIABILITY,
+ * OR USEFULNESS OF THE SOFTWARE.
+ *
+ * You are solely responsible for determining the appropriateness of using and
+ * distributing the software and you assume all risks associated with its use,
+ * including but not limited to the risks and costs of program errors,
+ * compliance with applicable laws, damage to or loss of data, programs or
+ * equipment, and the unavailability or interruption of operation. This
+ * software is not intended to be used in any situation where a failure could
+ * cause risk of injury or damage to property. The software developed by NIST
+ * employees is not subject to copyright protection within the United States.
+ *
+ * Author: Evan Black <evan.black@nist.gov>
+ */
+
+#include "event-density.h"
+#include "task-pool.h"
+#include <algorithm>
+#include <type_traits>
+#include <variant>
+
+namespace parser {
+
+namespace {
+
+/**
+ * Events counted by each task, when a batch is counted in parallel
+ */
+constexpr std::size_t chunkSize = 65536u;
+
+template <typename T>
+nanoseconds lastTime(const std::vector<T> &events) {
+  if (events.empty())
+    return 0LL;
+
+  return std::visit(
+      [](const auto &e) {
+        return e.time;
+      },
+      events.back());
+}
+
+/**
+ * @return
+ * The kind events of type `T` are counted as, or `KindCount` if they are not counted
+ */
+template <typename T>
+constexpr std::size_t kindOf() {
+  if constexpr (std::is_same_v<T, MoveEvent> || std::is_same_v<T, DecorationMoveEvent>)
+    return EventDensity::Moves;
+  else if constexpr (std::is_same_v<T, TransmitEvent>)
+    return EventDensity::Transmits;
+  else if constexpr (std::is_same_v<T, XYSeriesAddValue> || std::is_same_v<T, XYSeriesAddValues> ||
+                     std::is_same_v<T, CategorySeriesAddValue>)
+    return EventDensity::SeriesAppends;
+  else if constexpr (std::is_same_v<T, StreamAppendEvent>)
+    return EventDensity::LogLines;
+  else
+    return EventDensity::KindCount;
+}
+
+/**
+ * Count the events in [begin, end) into `buckets`
+ */
+template <typename T>
+void count(const std::vector<T> &events, std::size_t begin, std::size_t end, nanoseconds bucketWidth,
+           std::vector<EventDensity::Counts> &buckets) {
+  for (auto i = begin; i < end; i++) {
+    std::visit(
+        [bucketWidth, &buckets](const auto &e) {
+          constexpr auto kind = kindOf<std::decay_t<decltype(e)>>();
+          if constexpr (kind != EventDensity::KindCount) {
+            // Batches are only sorted within themselves, so keep stragglers in range
+            const auto bucket = std::clamp<nanoseconds>(e.time / bucketWidth, 0LL,
+                                                        static_cast<nanoseconds>(EventDensity::bucketCount - 1u));
+            buckets[static_cast<std::size_t>(bucket)][kind]++;
+          }
+        },
+        events[i]);
+  }
+}
+
+} // namespace
+
+void EventDensity::cover(nanoseconds time) {
+  while (time >= histogram.bucketWidth * static_cast<nanoseconds>(bucketCount)) {
+    auto &buckets = histogram.buckets;
+    for (std::size_t i = 0u; i < bucketCount / 2u; i++) {
+      for (std::size_t kind = 0u; kind < KindCount; kind++)
+        buckets[i][kind] = buckets[2u * i][kind] + buckets[2u * i + 1u][kind];
+    }
+    std::fill(buckets.begin() + bucketCount / 2u, buckets.end(), Counts{});
+    histogram.bucketWidth *= 2LL;
+  }
+}
+
+void EventDensity::add(const EventBatch &batch) {
+  const auto total = batch.sceneEvents.size() + batch.chartEvents.size() + batch.logEvents.size();
+  if (total == 0u)
+    return;
+
+  // Each list is in time order, so the last events are the latest
+  const auto last = std::max({batch.parsedTime, lastTime(batch.sceneEvents), lastTime(batch.chartEvents),
+                              lastTime(batch.logEvents)});
+
+  nanoseconds bucketWidth;
+  {
+    std::lock_guard lock{mutex};
+    cover(last);
+    bucketWidth = histogram.bucketWidth;
+  }
+
+  // Counted without the lock, then merged in at once
+  const auto sceneChunks = (batch.sceneEvents.size() + chunkSize - 1u) / chunkSize;
+  const auto chartChunks = (batch.chartEvents.size() + chunkSize - 1u) / chunkSize;
+  const auto logChunks = (batch.logEvents.size() + chunkSize - 1u) / chunkSize;
+  const auto chunks = sceneChunks + chartChunks + logChunks;
+
+  std::vector<std::vector<Counts>> partial(chunks);
+  auto countChunk = [&](std::size_t chunk) {
+    auto &buckets = partial[chunk];
+    buckets.resize(bucketCount);
+
+    auto countRange = [&buckets, bucketWidth](const auto &events, std::size_t index) {
+      const auto begin = index * chunkSize;
+      count(events, begin, std::min(begin + chunkSize, events.size()), bucketWidth, buckets);
+    };
+
+    if (chunk < sceneChunks)
+      countRange(batch.sceneEvents, chunk);
+    else if (chunk < sceneChunks + chartChunks)
+      countRange(batch.chartEvents, chunk - sceneChunks);
+    else
+      countRange(batch.logEvents, chunk - sceneChunks - chartChunks);
+  };
+
+  if (chunks == 1u)
+    countChunk(0u);
+  else
+    TaskPool::shared().parallelFor(chunks, 0u, TaskPool::Priority::Normal, countChunk);
+
+  std::lock_guard lock{mutex};
+  for (const auto &buckets : partial) {
+    for (std::size_t i = 0u; i < bucketCount; i++) {
+      for (std::size_t kind = 0u; kind < KindCount; kind++)
+        histogram.buckets[i][kind] += buckets[i][kind];
+    }
+  }
+}
+
+EventDensity::Histogram EventDensity::snapshot() const {
+  std::lock_guard lock{mutex};
+  return histogram;
+}
+
+void EventDensity::clear() {
+  std::lock_guard lock{mutex};
+  histogram = Histogram{};
+}
+
+} // namespace parser
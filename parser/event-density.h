@@ -0,0 +1,133 @@
+/*
+ * NIST-developed software is provided by NIST as a public service. You may use,
+ * copy and distribute copies of the software in any medium, provided that you
+ * keep intact this entire notice. You may improve,modify and create derivative
+ * works of the software or any portion of the software, and you may copy and
+ * distribute such modifications or works. Modified works should carry a notice
+ * stating that you changed the software and should note the date and nature of
+ * any such change. Please explicitly acknowledge the National Institute of
+ * Standards and Technology as the source of the software.
+ *
+ * NIST-developed software is expressly provided "AS IS." NIST MAKES NO
+ * WARRANTY OF ANY KIND, EXPRESS, IMPLIED, IN FACT OR ARISING BY OPERATION OF
+ * LAW, INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTY OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, NON-INFRINGEMENT
+ * AND DATA ACCURACY. NIST NEITHER REPRESENTS NOR WARRANTS THAT THE
+ * OPERATION OF THE SOFTWARE WILL BE UNINTERRUPTED OR ERROR-FREE, OR THAT
+ * ANY DEFECTS WILL BE CORRECTED. NIST DOES NOT WARRANT OR MAKE ANY
+ * REPRESENTATIONS REGARDING THE USE OF THE SOFTWARE OR THE RESULTS THEREOF,
+ * INCLUDING BUT NOT LIMITED TO THE CORRECTNESS, ACCURACY, RELIABILITY,
+ * OR USEFULNESS OF THE SOFTWARE.
+ *
+ * You are solely responsible for determining the appropriateness of using and
+ * distributing the software and you assume all risks associated with its use,
+ * including but not limited to the risks and costs of program errors,
+ * compliance with applicable laws, damage to or loss of data, programs or
+ * equipment, and the unavailability or interruption of operation. This
+ * software is not intended to be used in any situation where a failure could
+ * cause risk of injury or damage to property. The software developed by NIST
+ * employees is not subject to copyright protection within the United States.
+ *
+ * Author: Evan Black <evan.black@nist.gov>
+ */
+
+#pragma once
+
+#include "file-parser.h"
+#include "model.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace parser {
+
+/**
+ * How many events of each kind fall in each stretch of the scenario,
+ * for showing where the busy moments are along the timeline.
+ *
+ * The buckets cover the scenario from time 0. Their width starts small,
+ * and doubles, merging neighbouring buckets, whenever an event is past the last one,
+ * so the number of buckets stays the same however long the scenario is.
+ *
+ * Batches may be added on one thread while taking snapshots on another
+ */
+class EventDensity {
+public:
+  /**
+   * The kinds of events counted, each counted on its own
+   */
+  enum Kind : std::size_t {
+    /**
+     * Node & Decoration moves
+     */
+    Moves,
+    Transmits,
+
+    /**
+     * Values added to any series
+     */
+    SeriesAppends,
+    LogLines,
+    KindCount
+  };
+
+  /**
+   * The number of buckets covering the scenario
+   */
+  static constexpr std::size_t bucketCount = 512u;
+
+  using Counts = std::array<std::uint32_t, KindCount>;
+
+  struct Histogram {
+    /**
+     * The length of time covered by each bucket.
+     * Bucket `i` covers [i * bucketWidth, (i + 1) * bucketWidth)
+     */
+    nanoseconds bucketWidth{1'000'000LL};
+
+    /**
+     * The events of each kind in each bucket, always `bucketCount` long
+     */
+    std::vector<Counts> buckets = std::vector<Counts>(bucketCount);
+  };
+
+private:
+  /**
+   * Guards `histogram`, as it is built on the loading thread
+   */
+  mutable std::mutex mutex;
+  Histogram histogram;
+
+  /**
+   * Double the width of the buckets until `time` falls in one
+   *
+   * @param time
+   * The time to cover
+   */
+  void cover(nanoseconds time);
+
+public:
+  /**
+   * Count the events of the next batch.
+   * Large batches are counted in parallel, on the shared `TaskPool`
+   *
+   * @param batch
+   * The batch to count
+   */
+  void add(const EventBatch &batch);
+
+  /**
+   * @return
+   * A copy of the counts so far
+   */
+  [[nodiscard]] Histogram snapshot() const;
+
+  /**
+   * Remove every count, and return to the starting width
+   */
+  void clear();
+};
+
+} // namespace parser
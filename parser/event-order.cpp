@@ -0,0 +1,147 @@
+/*
+ * NIST-developed software is provided by NIST as a public service. You may use,
+ * copy and distribute copies of the software in any medium, provided that you
+ * keep intact this entire notice. You may improve,modify and create derivative
+ * works of the software or any portion of the software, and you may copy and
+ * distribute such modifications or works. Modified works should carry a notice
+ * stating that you changed the software and should note the date and nature of
+ * any such change. Please explicitly acknowledge the National Institute of
+ * Standards and Technology as the source of the software.
+ *
+ * NIST-developed software is expressly provided "AS IS." NIST MAKES NO
+ * WARRANTY OF ANY KIND, EXPRESS, IMPLIED, IN FACT OR ARISING BY OPERATION OF
+ * LAW, INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTY OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, NON-INFRINGEMENT
+ * AND DATA ACCURACY. NIST NEITHER REPRESENTS NOR WARRANTS THAT THE
+ * OPERATION OF THE SOFTWARE WILL BE UNINTERRUPTED OR ERROR-FREE, OR THAT
+ * ANY DEFECTS WILL BE CORRECTED. NIST DOES NOT WARRANT OR MAKE ANY
+ * REPRESENTATIONS REGARDING THE USE OF THE SOFTWARE OR THE RESULTS THEREOF,
+ * INCLUDING BUT NOT LIMITED TO THE CORRECTNESS, ACCURACY, RELIABILITY,
+ * OR USEFULNESS OF THE SOFTWARE.
+ *
+ * You are solely responsible for determining the appropriateness of using and
+ * distributing the software and you assume all risks associated with its use,
+ * including but not limited to the risks and costs of program errors,
+ * compliance with applicable laws, damage to or loss of data, programs or
+ * equipment, and the unavailability or interruption of operation. This
+ * software is not intended to be used in any situation where a failure could
+ * cause risk of injury or damage to property. The software developed by NIST
+ * employees is not subject to copyright protection within the United States.
+ *
+ * Author: Evan Black <evan.black@nist.gov>
+ */
+
+#include "event-order.h"
+#include "task-pool.h"
+#include <algorithm>
+#include <thread>
+#include <variant>
+
+namespace parser {
+
+namespace {
+
+/**
+ * Below this, events are sorted on the calling thread
+ */
+constexpr std::size_t minimumParallel = 1u << 16u;
+
+/**
+ * Fewer events per run than this on average,
+ * and the events are treated as in no particular order
+ */
+constexpr std::size_t minimumRunLength = 64u;
+
+template <typename Event>
+nanoseconds timeOf(const Event &event) {
+  return std::visit(
+      [](const auto &e) {
+        return e.time;
+      },
+      event);
+}
+
+/**
+ * Run `task` for each index in [0, count), spread over at most `threads` threads of the shared pool
+ */
+template <typename Task>
+void forEach(std::size_t count, unsigned int threads, Task task) {
+  if (std::min<std::size_t>(threads, count) < 2u) {
+    for (std::size_t i = 0; i < count; i++)
+      task(i);
+    return;
+  }
+
+  TaskPool::shared().parallelFor(count, threads, TaskPool::Priority::Normal, task);
+}
+
+template <typename Event>
+std::size_t sortEvents(std::vector<Event> &events, unsigned int threads) {
+  // Start of each run of events in order, followed by the end of the last run
+  std::vector<std::size_t> runs{0u};
+  for (std::size_t i = 1u; i < events.size(); i++) {
+    if (timeOf(events[i]) < timeOf(events[i - 1u]))
+      runs.emplace_back(i);
+  }
+
+  const auto unordered = runs.size() - 1u;
+  if (unordered == 0u)
+    return 0u;
+  runs.emplace_back(events.size());
+
+  if (threads == 0u)
+    threads = std::max(1u, std::thread::hardware_concurrency());
+  if (events.size() < minimumParallel)
+    threads = 1u;
+
+  const auto earlier = [](const Event &left, const Event &right) {
+    return timeOf(left) < timeOf(right);
+  };
+
+  // Too short to be worth merging, sort a slice per thread instead
+  if (events.size() / (runs.size() - 1u) < minimumRunLength) {
+    const auto slices = static_cast<std::size_t>(threads);
+    runs.clear();
+    for (std::size_t slice = 0; slice <= slices; slice++)
+      runs.emplace_back(events.size() * slice / slices);
+
+    forEach(slices, threads, [&events, &runs, &earlier](std::size_t slice) {
+      std::stable_sort(events.begin() + runs[slice], events.begin() + runs[slice + 1u], earlier);
+    });
+  }
+
+  // Each round merges neighbouring runs, halving the number of runs.
+  // Only neighbours are merged, so events at the same time keep their order
+  while (runs.size() > 2u) {
+    const auto pairs = (runs.size() - 1u) / 2u;
+    forEach(pairs, threads, [&events, &runs, &earlier](std::size_t pair) {
+      std::inplace_merge(events.begin() + runs[pair * 2u], events.begin() + runs[pair * 2u + 1u],
+                         events.begin() + runs[pair * 2u + 2u], earlier);
+    });
+
+    std::vector<std::size_t> merged;
+    merged.reserve(pairs + 2u);
+    for (std::size_t i = 0; i < runs.size() - 1u; i += 2u)
+      merged.emplace_back(runs[i]);
+    merged.emplace_back(events.size());
+    runs = std::move(merged);
+  }
+
+  return unordered;
+}
+
+} // namespace
+
+std::size_t sortByTime(std::vector<SceneEvent> &events, unsigned int threads) {
+  return sortEvents(events, threads);
+}
+
+std::size_t sortByTime(std::vector<ChartEvent> &events, unsigned int threads) {
+  return sortEvents(events, threads);
+}
+
+std::size_t sortByTime(std::vector<LogEvent> &events, unsigned int threads) {
+  return sortEvents(events, threads);
+}
+
+} // namespace parser
@@ -0,0 +1,107 @@
+/*
+ * NIST-developed software is provided by NIST as a public service. You may use,
+ * copy and distribute copies of the software in any medium, provided that you
+ * keep intact this entire notice. You may improve,modify and create derivative
+ * works of the software or any portion of the software, and you may copy and
+ * distribute such modifications or works. Modified works should carry a notice
+ * stating that you changed the software and should note the date and nature of
+ * any such change. Please explicitly acknowledge the National Institute of
+ * Standards and Technology as the source of the software.
+ *
+ * NIST-developed software is expressly provided "AS IS." NIST MAKES NO
+ * WARRANTY OF ANY KIND, EXPRESS, IMPLIED, IN FACT OR ARISING BY OPERATION OF
+ * LAW, INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTY OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, NON-INFRINGEMENT
+ * AND DATA ACCURACY. NIST NEITHER REPRESENTS NOR WARRANTS THAT THE
+ * OPERATION OF THE SOFTWARE WILL BE UNINTERRUPTED OR ERROR-FREE, OR THAT
+ * ANY DEFECTS WILL BE CORRECTED. NIST DOES NOT WARRANT OR MAKE ANY
+ * REPRESENTATIONS REGARDING THE USE OF THE SOFTWARE OR THE RESULTS THEREOF,
+ * INCLUDING BUT NOT LIMITED TO THE CORRECTNESS, ACCURACY, RELIABILITY,
+ * OR USEFULNESS OF THE SOFTWARE.
+ *
+ * You are solely responsible for determining the appropriateness of using and
+ * distributing the software and you assume all risks associated with its use,
+ * including but not limited to the risks and costs of program errors,
+ * compliance with applicable laws, damage to or loss of data, programs or
+ * equipment, and the unavailability or interruption of operation. This
+ * software is not intended to be used in any situation where a failure could
+ * cause risk of injury or damage to property. The software developed by NIST
+ * employees is not subject to copyright protection within the United States.
+ *
+ * Author: Evan Black <evan.black@nist.gov>
+ */
+
+#include "event-scanner.h"
+#include <rapidjson/reader.h>
+
+namespace parser {
+
+rapidjson::ParseErrorCode parseEvents(RangeStream &stream, JsonHandler &handler, std::size_t &errorOffset) {
+  const auto skipBlank = [&stream]() {
+    while (stream.Peek() == ' ' || stream.Peek() == '\n' || stream.Peek() == '\r' || stream.Peek() == '\t')
+      stream.Take();
+  };
+
+  rapidjson::Reader reader;
+
+  for (auto first = true;; first = false) {
+    skipBlank();
+    if (stream.Peek() == '\0' || stream.Peek() == ']')
+      break;
+
+    if (!first) {
+      if (stream.Peek() != ',') {
+        errorOffset = stream.Tell();
+        return rapidjson::kParseErrorArrayMissCommaOrSquareBracket;
+      }
+      stream.Take();
+      skipBlank();
+    }
+
+    const auto start = stream.current();
+    if (!handler.scanEvent(stream.current(), stream.last())) {
+      errorOffset = stream.Tell();
+      return rapidjson::kParseErrorTermination;
+    }
+
+    if (stream.current() != start)
+      continue;
+
+    if (stream.inSitu())
+      reader.Parse<rapidjson::kParseStopWhenDoneFlag | rapidjson::kParseInsituFlag>(stream, handler);
+    else
+      reader.Parse<rapidjson::kParseStopWhenDoneFlag>(stream, handler);
+    if (reader.HasParseError()) {
+      errorOffset = reader.GetErrorOffset();
+      return reader.GetParseErrorCode();
+    }
+  }
+
+  return rapidjson::kParseErrorNone;
+}
+
+std::optional<ParseError> parseScanned(RangeStream stream, JsonHandler &handler,
+                                       const std::optional<std::string> &handlerMessage) {
+  // Token by token, so the events may be taken over once their array opens
+  rapidjson::Reader reader;
+  reader.IterativeParseInit();
+
+  while (!reader.IterativeParseComplete()) {
+    const auto next = stream.inSitu() ? reader.IterativeParseNext<rapidjson::kParseInsituFlag>(stream, handler)
+                                      : reader.IterativeParseNext<rapidjson::kParseDefaultFlags>(stream, handler);
+    if (!next)
+      return ParseError{describeParseError(reader.GetParseErrorCode(), handlerMessage), reader.GetErrorOffset()};
+
+    // Only just after the opening bracket, since every event is read below.
+    // RapidJSON then continues with the closing bracket, as if the array were empty
+    if (handler.isEventStart()) {
+      std::size_t errorOffset = 0u;
+      if (const auto code = parseEvents(stream, handler, errorOffset); code != rapidjson::kParseErrorNone)
+        return ParseError{describeParseError(code, handlerMessage), errorOffset};
+    }
+  }
+
+  return {};
+}
+
+} // namespace parser
@@ -0,0 +1,174 @@
+/*
+ * NIST-developed software is provided by NIST as a public service. You may use,
+ * copy and distribute copies of the software in any medium, provided that you
+ * keep intact this entire notice. You may improve,modify and create derivative
+ * works of the software or any portion of the software, and you may copy and
+ * distribute such modifications or works. Modified works should carry a notice
+ * stating that you changed the software and should note the date and nature of
+ * any such change. Please explicitly acknowledge the National Institute of
+ * Standards and Technology as the source of the software.
+ *
+ * NIST-developed software is expressly provided "AS IS." NIST MAKES NO
+ * WARRANTY OF ANY KIND, EXPRESS, IMPLIED, IN FACT OR ARISING BY OPERATION OF
+ * LAW, INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTY OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, NON-INFRINGEMENT
+ * AND DATA ACCURACY. NIST NEITHER REPRESENTS NOR WARRANTS THAT THE
+ * OPERATION OF THE SOFTWARE WILL BE UNINTERRUPTED OR ERROR-FREE, OR THAT
+ * ANY DEFECTS WILL BE CORRECTED. NIST DOES NOT WARRANT OR MAKE ANY
+ * REPRESENTATIONS REGARDING THE USE OF THE SOFTWARE OR THE RESULTS THEREOF,
+ * INCLUDING BUT NOT LIMITED TO THE CORRECTNESS, ACCURACY, RELIABILITY,
+ * OR USEFULNESS OF THE SOFTWARE.
+ *
+ * You are solely responsible for determining the appropriateness of using and
+ * distributing the software and you assume all risks associated with its use,
+ * including but not limited to the risks and costs of program errors,
+ * compliance with applicable laws, damage to or loss of data, programs or
+ * equipment, and the unavailability or interruption of operation. This
+ * software is not intended to be used in any situation where a failure could
+ * cause risk of injury or damage to property. The software developed by NIST
+ * employees is not subject to copyright protection within the United States.
+ *
+ * Author: Evan Black <evan.black@nist.gov>
+ */
+
+#pragma once
+#include "handler/JsonHandler.h"
+#include "handler/parse-error.h"
+#include <cassert>
+#include <cstddef>
+#include <optional>
+#include <rapidjson/error/error.h>
+#include <string>
+
+namespace parser {
+
+/**
+ * RapidJSON input stream over one range of memory,
+ * which may be moved past values read without RapidJSON.
+ * Over writable memory, strings may also be decoded in place, see `inSitu()`
+ */
+class RangeStream {
+public:
+  using Ch = char;
+
+private:
+  const char *begin;
+  const char *position;
+  const char *end;
+
+  /**
+   * `begin`, if the range may be written to. Null otherwise
+   */
+  char *writable = nullptr;
+
+  /**
+   * Where the next decoded character is written, while parsing in situ
+   */
+  char *output = nullptr;
+
+public:
+  RangeStream(const char *begin, const char *end) : begin(begin), position(begin), end(end) {
+  }
+
+  /**
+   * A stream RapidJSON may decode strings into, over the characters already read
+   */
+  RangeStream(char *begin, char *end) : begin(begin), position(begin), end(end), writable(begin) {
+  }
+
+  [[nodiscard]] Ch Peek() const {
+    return position == end ? '\0' : *position;
+  }
+
+  Ch Take() {
+    return position == end ? '\0' : *position++;
+  }
+
+  [[nodiscard]] std::size_t Tell() const {
+    return static_cast<std::size_t>(position - begin);
+  }
+
+  /**
+   * @return
+   * The next character to be read
+   */
+  const char *&current() {
+    return position;
+  }
+
+  /**
+   * @return
+   * One past the last character of the stream
+   */
+  [[nodiscard]] const char *last() const {
+    return end;
+  }
+
+  /**
+   * @return
+   * True if the stream may be parsed with `rapidjson::kParseInsituFlag`,
+   * so strings are passed to the handler as views into the range, rather than copies
+   */
+  [[nodiscard]] bool inSitu() const {
+    return writable != nullptr;
+  }
+
+  // Used by RapidJSON for in-situ parsing only.
+  // A decoded string is never longer than its JSON, so it is written over characters already read
+  Ch *PutBegin() {
+    assert(writable);
+    output = writable + (position - begin);
+    return output;
+  }
+
+  void Put(Ch c) {
+    *output++ = c;
+  }
+
+  void Flush() {
+  }
+
+  std::size_t PutEnd(Ch *start) {
+    return static_cast<std::size_t>(output - start);
+  }
+};
+
+/**
+ * Parse the elements of an 'events' array, reading the flat events with `JsonHandler::scanEvent()`,
+ * and passing each of the rest to RapidJSON alone.
+ * Stops at the closing bracket of the array, or the end of the stream
+ *
+ * @param stream
+ * The events, starting after the opening bracket of the array, or at the first event
+ *
+ * @param handler
+ * A handler ready for the first event of the array
+ *
+ * @param [out] errorOffset
+ * The position in `stream` of the error, if any
+ *
+ * @return
+ * The error code, `rapidjson::kParseErrorNone` if every event was parsed
+ */
+rapidjson::ParseErrorCode parseEvents(RangeStream &stream, JsonHandler &handler, std::size_t &errorOffset);
+
+/**
+ * Parse a whole JSON scenario from memory, with the elements of the 'events' section
+ * read by `parseEvents()`, and the rest by RapidJSON
+ *
+ * @param stream
+ * The scenario. When `RangeStream::inSitu()`, its strings are decoded in place
+ *
+ * @param handler
+ * The handler for the whole document
+ *
+ * @param handlerMessage
+ * The message set by `handler` on an error, see `FileParser::errorMessage`
+ *
+ * @return
+ * An error if the scenario could not be parsed, an unset optional otherwise
+ */
+std::optional<ParseError> parseScanned(RangeStream stream, JsonHandler &handler,
+                                       const std::optional<std::string> &handlerMessage);
+
+} // namespace parser
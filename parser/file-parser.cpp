@@ -31,17 +31,50 @@
  * Author: Evan Black <evan.black@nist.gov>
  */
 #include "file-parser.h"
+#include "binary/BinaryReader.h"
+#include "binary/MappedFile.h"
+#include "chunked-parser.h"
+#include "compressed-stream.h"
+#include "event-order.h"
+#include "event-scanner.h"
+#include "follow-parser.h"
+#include "ingest-socket.h"
+#include "parse-cache.h"
+#include "trace.h"
 #include "handler/JsonHandler.h"
+#include "handler/parse-error.h"
 #include <algorithm>
+#include <chrono>
 #include <cstdio>
 #include <iostream>
 #include <memory>
+#include <type_traits>
+#include <utility>
 #include <rapidjson/filereadstream.h>
 #include <rapidjson/reader.h>
 
 namespace parser {
 
+template <class Stream>
+std::optional<ParseError> FileParser::parseJson(Stream &stream) {
+  JsonHandler handler{*this};
+  rapidjson::Reader reader;
+
+  reader.Parse(stream, handler);
+
+  if (reader.HasParseError()) {
+    ParseError error;
+    error.offset = reader.GetErrorOffset();
+    error.message = describeParseError(reader.GetParseErrorCode(), errorMessage);
+
+    return {error};
+  }
+
+  return {};
+}
+
 std::optional<ParseError> FileParser::parse(const char *path) {
+  trace::Scope trace{"FileParser::parse", "parse"};
 
   // RapidJSON prefers FILE*, so this is a safe wrapper for that
   // Add a 'b' in the mode flags to keep Windows from stupid handling of newlines
@@ -52,95 +85,275 @@ std::optional<ParseError> FileParser::parse(const char *path) {
     return {ParseError{"Failed to open file", 0u}};
   }
 
-  // Mostly arbitrary buffer size
-  char buffer[65536];
-  rapidjson::FileReadStream stream{file.get(), buffer, sizeof(buffer)};
+  // Binary scenarios are mapped, rather than streamed through RapidJSON
+  char header[sizeof(binary::magic)];
+  const auto headerSize = std::fread(header, 1u, sizeof(header), file.get());
 
-  JsonHandler handler{*this};
-  rapidjson::Reader reader;
+  // Set if the events have already been passed to `eventsParsed`
+  auto delivered = false;
 
-  reader.Parse(stream, handler);
+  const auto compression = detectCompression(header, headerSize);
+  const auto isBinary = binary::BinaryReader::isBinary(header, headerSize);
 
-  if (reader.HasParseError()) {
-    ParseError error;
-    error.offset = reader.GetErrorOffset();
+  // A snapshot of the whole scenario, see `setCache()`
+  std::optional<std::string> snapshot;
+  auto fromSnapshot = false;
+  if (cache && !isBinary && !filter.active()) {
+    snapshot = cache->snapshotPath(path);
 
-    switch (reader.GetParseErrorCode()) {
-      // Error from the `JsonHandler`
-    case rapidjson::kParseErrorTermination:
-      error.message = errorMessage.value_or("Unknown parsing error");
-      break;
-      // Generic Errors
-    case rapidjson::kParseErrorDocumentEmpty:
-      error.message = "Document empty";
-      break;
-    case rapidjson::kParseErrorDocumentRootNotSingular:
-      error.message = "More than one root element";
-      break;
-    case rapidjson::kParseErrorValueInvalid:
-      error.message = "Invalid value";
-      break;
-    case rapidjson::kParseErrorObjectMissName:
-      error.message = "Object member missing name";
-      break;
-    case rapidjson::kParseErrorObjectMissColon:
-      error.message = "Object property missing colon";
-      break;
-    case rapidjson::kParseErrorObjectMissCommaOrCurlyBracket:
-      error.message = "Missing comma or curly brace after object member";
-      break;
-    case rapidjson::kParseErrorArrayMissCommaOrSquareBracket:
-      error.message = "Missing comma or curly brace after array element";
-      break;
-    case rapidjson::kParseErrorStringUnicodeEscapeInvalidHex:
-      error.message = "Invalid Unicode escape sequence";
-      break;
-    case rapidjson::kParseErrorStringUnicodeSurrogateInvalid:
-      error.message = "Invalid Unicode surrogate pair";
-      break;
-    case rapidjson::kParseErrorStringEscapeInvalid:
-      error.message = "Invalid character escape sequence";
-      break;
-    case rapidjson::kParseErrorStringMissQuotationMark:
-      error.message = "Missing string quotation mark";
-      break;
-    case rapidjson::kParseErrorStringInvalidEncoding:
-      error.message = "Invalid string encoding";
-      break;
-    case rapidjson::kParseErrorNumberTooBig:
-      error.message = "Number too large to be stored in a double";
-      break;
-    case rapidjson::kParseErrorNumberMissFraction:
-      error.message = "Number missing fraction component";
-      break;
-    case rapidjson::kParseErrorNumberMissExponent:
-      error.message = "Number missing exponent component";
-      break;
-    case rapidjson::kParseErrorUnspecificSyntaxError:
-    default:
-      error.message = "Unspecific syntax error";
-      break;
+    if (snapshot && ParseCache::exists(snapshot.value())) {
+      trace::Scope snapshotTrace{"FileParser::readSnapshot", "parse"};
+      if (auto error = binary::BinaryReader{*this}.read(snapshot->c_str())) {
+        std::cerr << "Ignoring unreadable snapshot " << snapshot.value() << ": " << error->message << '\n';
+        reset();
+      } else
+        fromSnapshot = true;
     }
+  }
 
-    return {error};
+  // Delivered events are copied, so the snapshot still has every event
+  snapshotEvents = snapshot && !fromSnapshot && eventsParsed;
+
+  if (fromSnapshot) {
+    file.reset();
+  } else if (isBinary) {
+    trace::Scope binaryTrace{"FileParser::readBinary", "parse"};
+    file.reset();
+    if (auto error = binary::BinaryReader{*this}.read(path))
+      return error;
+  } else if (compression != Compression::None) {
+    if (!compressionSupported(compression))
+      return {ParseError{compression == Compression::Gzip ? "This build cannot read gzip compressed files"
+                                                          : "This build cannot read zstd compressed files",
+                         0u}};
+
+    std::rewind(file.get());
+    trace::Scope compressedTrace{"FileParser::parseCompressed", "parse"};
+
+    // Compressed files cannot be split, so they are always parsed in one pass,
+    // with the decompression on its own thread
+    DecompressingStream stream{file.get(), compression};
+    auto error = parseJson(stream);
+
+    // A decoding error also stops the JSON where the output ended, so report that first
+    if (auto decodeError = stream.error())
+      return {ParseError{*decodeError, stream.Tell()}};
+    if (error)
+      return error;
+  } else {
+    std::rewind(file.get());
+
+    // Large files have their 'events' section split & parsed on several threads
+    ChunkedParser chunkedParser{*this, parseThreads};
+    if (chunkedParser.prepare(path)) {
+      file.reset();
+      if (auto error = chunkedParser.parse())
+        return error;
+
+      // The chunked parser delivers each chunk as it is merged
+      delivered = static_cast<bool>(eventsParsed);
+    } else if (binary::MappedFile mapped; fastEvents && mapped.open(path, inSitu)) {
+      trace::Scope scannedTrace{"FileParser::parseScanned", "parse"};
+      file.reset();
+      JsonHandler handler{*this};
+
+      const auto writable = mapped.writableData();
+      auto stream = writable ? RangeStream{writable, writable + mapped.size()}
+                             : RangeStream{mapped.data(), mapped.data() + mapped.size()};
+      if (auto error = parseScanned(stream, handler, errorMessage))
+        return error;
+    } else {
+      trace::Scope jsonTrace{"FileParser::parseJson", "parse"};
+
+      // Mostly arbitrary buffer size
+      char buffer[65536];
+      rapidjson::FileReadStream stream{file.get(), buffer, sizeof(buffer)};
+
+      if (auto error = parseJson(stream))
+        return error;
+    }
   }
 
-  std::sort(nodes.begin(), nodes.end(), [](const Node &left, const Node &right) {
-    return left.id < right.id;
-  });
+  // Checked once more, since binary scenarios & snapshots are not read by the `JsonHandler`,
+  // and nothing partial should be delivered or cached
+  if (cancelled())
+    return {ParseError{"Loading cancelled", 0u}};
 
-  std::sort(buildings.begin(), buildings.end(), [](const Building &left, const Building &right) {
-    return left.id < right.id;
-  });
+  sortSections();
+  sortEvents();
 
-  std::sort(decorations.begin(), decorations.end(), [](const Decoration &left, const Decoration &right) {
-    return left.id < right.id;
-  });
+  // Before compaction, so the snapshot does not depend on it
+  if (snapshot && !fromSnapshot)
+    writeSnapshot(snapshot.value());
+
+  // Delivered events were compacted as they were delivered
+  if (!eventsParsed)
+    compactEvents();
+
+  if (eventsParsed && !delivered) {
+    if (sectionsParsed)
+      sectionsParsed();
+    deliverEvents(globalConfiguration.endTime, 1.0);
+  }
 
   return {};
 }
 
+std::optional<ParseError> FileParser::parse(const char *path, ParseSink &output) {
+  trace::Scope trace{"FileParser::parseToSink", "parse"};
+  reset();
+
+  sink = &output;
+  auto error = parseToSink(path);
+  sink = nullptr;
+
+  if (!error)
+    output.finish(globalConfiguration);
+  return error;
+}
+
+std::optional<ParseError> FileParser::parseToSink(const char *path) {
+  std::unique_ptr<FILE, decltype(&std::fclose)> file{std::fopen(path, "rb"), std::fclose};
+  if (!file) {
+    std::cerr << "Failed to open file: " << path << '\n';
+    return {ParseError{"Failed to open file", 0u}};
+  }
+
+  char header[sizeof(binary::magic)];
+  const auto headerSize = std::fread(header, 1u, sizeof(header), file.get());
+  const auto compression = detectCompression(header, headerSize);
+
+  if (binary::BinaryReader::isBinary(header, headerSize)) {
+    // Mapped & read whole, then passed on
+    file.reset();
+    if (auto error = binary::BinaryReader{*this}.read(path))
+      return error;
+  } else if (compression != Compression::None) {
+    if (!compressionSupported(compression))
+      return {ParseError{compression == Compression::Gzip ? "This build cannot read gzip compressed files"
+                                                          : "This build cannot read zstd compressed files",
+                         0u}};
+
+    std::rewind(file.get());
+    DecompressingStream stream{file.get(), compression};
+    auto error = parseJson(stream);
+    if (auto decodeError = stream.error())
+      return {ParseError{*decodeError, stream.Tell()}};
+    if (error)
+      return error;
+  } else if (binary::MappedFile mapped; fastEvents && mapped.open(path, false)) {
+    // The scanner only reads the mapped pages, which the OS may drop again once they are passed
+    file.reset();
+    JsonHandler handler{*this};
+    const RangeStream stream{mapped.data(), mapped.data() + mapped.size()};
+    if (auto error = parseScanned(stream, handler, errorMessage))
+      return error;
+  } else {
+    std::rewind(file.get());
+    char buffer[65536];
+    rapidjson::FileReadStream stream{file.get(), buffer, sizeof(buffer)};
+    if (auto error = parseJson(stream))
+      return error;
+  }
+
+  if (cancelled())
+    return {ParseError{"Loading cancelled", 0u}};
+
+  // The rest of a binary scenario, or the events held back by a filter
+  forward();
+  return {};
+}
+
+void FileParser::forward() {
+  // Everything is moved out, then the collections are cleared, so they keep their few elements of capacity
+  const auto pass = [](auto &items, auto add) {
+    for (auto &item : items)
+      add(std::move(item));
+    items.clear();
+  };
+
+  pass(nodes, [this](Node &&value) {
+    sink->addNode(std::move(value));
+  });
+  pass(buildings, [this](Building &&value) {
+    sink->addBuilding(std::move(value));
+  });
+  pass(decorations, [this](Decoration &&value) {
+    sink->addDecoration(std::move(value));
+  });
+  pass(areas, [this](Area &&value) {
+    sink->addArea(std::move(value));
+  });
+  pass(wiredLinks, [this](WiredLink &&value) {
+    sink->addLink(std::move(value));
+  });
+  pass(xySeries, [this](XYSeries &&value) {
+    sink->addXYSeries(std::move(value));
+  });
+  pass(categoryValueSeries, [this](CategoryValueSeries &&value) {
+    sink->addCategoryValueSeries(std::move(value));
+  });
+  pass(seriesCollections, [this](SeriesCollection &&value) {
+    sink->addSeriesCollection(std::move(value));
+  });
+  pass(logStreams, [this](LogStream &&value) {
+    sink->addLogStream(std::move(value));
+  });
+  pass(sceneEvents, [this](SceneEvent &&value) {
+    sink->addSceneEvent(std::move(value));
+  });
+  pass(chartEvents, [this](ChartEvent &&value) {
+    sink->addChartEvent(std::move(value));
+  });
+  pass(logEvents, [this](LogEvent &&value) {
+    sink->addLogEvent(std::move(value));
+  });
+}
+
+std::optional<ParseError> FileParser::follow(const char *path, const std::atomic<bool> &stop) {
+  char header[sizeof(binary::magic)];
+  std::size_t headerSize;
+  {
+    std::unique_ptr<FILE, decltype(&std::fclose)> file{std::fopen(path, "rb"), std::fclose};
+    if (!file) {
+      std::cerr << "Failed to open file: " << path << '\n';
+      return {ParseError{"Failed to open file", 0u}};
+    }
+    headerSize = std::fread(header, 1u, sizeof(header), file.get());
+  }
+
+  // Only plain JSON may be read while it is written
+  if (binary::BinaryReader::isBinary(header, headerSize) ||
+      detectCompression(header, headerSize) != Compression::None)
+    return parse(path);
+
+  return FollowParser{*this}.follow(path, stop);
+}
+
+std::optional<ParseError> FileParser::listen(const char *address, const std::atomic<bool> &stop) {
+  IngestSocket socket;
+  if (auto error = socket.listen(address)) {
+    std::cerr << error.value() << '\n';
+    return {ParseError{error.value(), 0u}};
+  }
+
+  if (!socket.accept(stop))
+    return {ParseError{"Stopped before a simulation connected", 0u}};
+
+  return FollowParser{*this}.ingest(
+      [&socket](char *buffer, std::size_t size) {
+        return socket.read(buffer, size, FollowParser::pollInterval);
+      },
+      stop);
+}
+
 void FileParser::reset() {
+  compactorReady = false;
+  reorderedEvents = 0u;
+  snapshotEvents = false;
+  snapshotSceneEvents = {};
+  snapshotChartEvents = {};
+  snapshotLogEvents = {};
   globalConfiguration = {};
   nodes.clear();
   buildings.clear();
@@ -155,6 +368,141 @@ void FileParser::reset() {
   seriesCollections.clear();
 }
 
+void FileParser::setParseThreads(unsigned int threads) {
+  parseThreads = threads;
+}
+
+void FileParser::setFastEvents(bool enabled) {
+  fastEvents = enabled;
+}
+
+void FileParser::setInSitu(bool enabled) {
+  inSitu = enabled;
+}
+
+void FileParser::setCompaction(std::optional<double> tolerance) {
+  compactor.reset();
+  compactorReady = false;
+  if (tolerance)
+    compactor.emplace(tolerance.value());
+}
+
+void FileParser::setCache(std::optional<std::string> directory) {
+  cache.reset();
+  if (directory)
+    cache.emplace(std::move(directory.value()));
+}
+
+void FileParser::setCancellation(CancellationToken token) {
+  cancellation = std::move(token);
+}
+
+bool FileParser::cancelled() const {
+  return cancellation.cancelled();
+}
+
+void FileParser::writeSnapshot(const std::string &snapshot) {
+  trace::Scope trace{"FileParser::writeSnapshot", "parse"};
+  if (!snapshotEvents) {
+    ParseCache::write(*this, snapshot);
+    return;
+  }
+
+  // Put the delivered events back in front of those still held for the write
+  snapshotSceneEvents.insert(snapshotSceneEvents.end(), sceneEvents.begin(), sceneEvents.end());
+  snapshotChartEvents.insert(snapshotChartEvents.end(), chartEvents.begin(), chartEvents.end());
+  snapshotLogEvents.insert(snapshotLogEvents.end(), logEvents.begin(), logEvents.end());
+  std::swap(sceneEvents, snapshotSceneEvents);
+  std::swap(chartEvents, snapshotChartEvents);
+  std::swap(logEvents, snapshotLogEvents);
+
+  ParseCache::write(*this, snapshot);
+
+  std::swap(sceneEvents, snapshotSceneEvents);
+  std::swap(chartEvents, snapshotChartEvents);
+  std::swap(logEvents, snapshotLogEvents);
+  snapshotSceneEvents = {};
+  snapshotChartEvents = {};
+  snapshotLogEvents = {};
+  snapshotEvents = false;
+}
+
+void FileParser::setFilter(ParseFilter newFilter) {
+  filter = std::move(newFilter);
+}
+
+std::size_t FileParser::getCompactedEvents() const {
+  return compactor ? compactor->getRemoved() : 0u;
+}
+
+std::size_t FileParser::getReorderedEvents() const {
+  return reorderedEvents;
+}
+
+void FileParser::sortEvents() {
+  trace::Scope trace{"FileParser::sortEvents", "parse"};
+  reorderedEvents += sortByTime(sceneEvents, parseThreads);
+  reorderedEvents += sortByTime(chartEvents, parseThreads);
+  reorderedEvents += sortByTime(logEvents, parseThreads);
+}
+
+void FileParser::compactEvents() {
+  trace::Scope trace{"FileParser::compactEvents", "parse"};
+  if (!compactor)
+    return;
+
+  if (!compactorReady) {
+    compactor->reset(nodes);
+    compactorReady = true;
+  }
+  compactor->compact(sceneEvents);
+}
+
+void FileParser::setProgressive(std::function<void()> sectionsParsed,
+                                std::function<void(EventBatch &&)> eventsParsed) {
+  this->sectionsParsed = std::move(sectionsParsed);
+  this->eventsParsed = std::move(eventsParsed);
+}
+
+void FileParser::setModelFound(std::function<void(const std::string &)> modelFound) {
+  this->modelFound = std::move(modelFound);
+}
+
+void FileParser::foundModel(const std::string &path) const {
+  if (modelFound)
+    modelFound(path);
+}
+
+void FileParser::sortSections() {
+  trace::Scope trace{"FileParser::sortSections", "parse"};
+  std::sort(nodes.begin(), nodes.end(), [](const Node &left, const Node &right) {
+    return left.id < right.id;
+  });
+
+  std::sort(buildings.begin(), buildings.end(), [](const Building &left, const Building &right) {
+    return left.id < right.id;
+  });
+
+  std::sort(decorations.begin(), decorations.end(), [](const Decoration &left, const Decoration &right) {
+    return left.id < right.id;
+  });
+}
+
+void FileParser::deliverEvents(nanoseconds parsedTime, double progress) {
+  trace::Scope trace{"FileParser::deliverEvents", "parse"};
+  sortEvents();
+
+  if (snapshotEvents) {
+    snapshotSceneEvents.insert(snapshotSceneEvents.end(), sceneEvents.begin(), sceneEvents.end());
+    snapshotChartEvents.insert(snapshotChartEvents.end(), chartEvents.begin(), chartEvents.end());
+    snapshotLogEvents.insert(snapshotLogEvents.end(), logEvents.begin(), logEvents.end());
+  }
+
+  compactEvents();
+  eventsParsed({takeSceneEvents(), takeChartsEvents(), takeLogEvents(), parsedTime, progress,
+                std::chrono::steady_clock::now()});
+}
+
 const GlobalConfiguration &FileParser::getConfiguration() const {
   return globalConfiguration;
 }
@@ -191,6 +539,18 @@ const std::vector<LogEvent> &FileParser::getLogEvents() const {
   return logEvents;
 }
 
+std::vector<SceneEvent> FileParser::takeSceneEvents() {
+  return std::exchange(sceneEvents, {});
+}
+
+std::vector<ChartEvent> FileParser::takeChartsEvents() {
+  return std::exchange(chartEvents, {});
+}
+
+std::vector<LogEvent> FileParser::takeLogEvents() {
+  return std::exchange(logEvents, {});
+}
+
 const std::vector<XYSeries> &FileParser::getXYSeries() const {
   return xySeries;
 }
@@ -203,8 +563,32 @@ const std::vector<SeriesCollection> &FileParser::getSeriesCollections() const {
   return seriesCollections;
 }
 
+std::shared_ptr<const StaticModels> FileParser::shareStaticModels() const {
+  return std::make_shared<const StaticModels>(
+      StaticModels{nodes, decorations, xySeries, categoryValueSeries, seriesCollections});
+}
+
 const std::vector<LogStream> &FileParser::getLogStreams() const {
   return logStreams;
 }
 
+std::vector<FileParser::MemoryUsage> FileParser::memoryUsage() const {
+  const auto bytes = [](const auto &collection) {
+    return collection.capacity() * sizeof(typename std::decay_t<decltype(collection)>::value_type);
+  };
+
+  return {{"Nodes", bytes(nodes)},
+          {"Buildings", bytes(buildings)},
+          {"Decorations", bytes(decorations)},
+          {"Areas", bytes(areas)},
+          {"Wired links", bytes(wiredLinks)},
+          {"Scene events", bytes(sceneEvents)},
+          {"Chart events", bytes(chartEvents)},
+          {"Log events", bytes(logEvents)},
+          {"Snapshot events",
+           bytes(snapshotSceneEvents) + bytes(snapshotChartEvents) + bytes(snapshotLogEvents)},
+          {"Series", bytes(xySeries) + bytes(categoryValueSeries) + bytes(seriesCollections)},
+          {"Log streams", bytes(logStreams)}};
+}
+
 } // namespace parser
@@ -31,7 +31,17 @@
  * Author: Evan Black <evan.black@nist.gov>
  */
 #pragma once
+#include "event-compactor.h"
 #include "model.h"
+#include "parse-cache.h"
+#include "parse-filter.h"
+#include "parse-sink.h"
+#include "task-pool.h"
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <memory>
 #include <optional>
 #include <stack>
 #include <string>
@@ -42,29 +52,254 @@ class JsonHandler;
 
 namespace parser {
 
+namespace binary {
+class BinaryReader;
+} // namespace binary
+
+class ChunkedParser;
+class FollowParser;
+
 struct ParseError {
   std::string message;
   std::size_t offset;
 };
 
+/**
+ * Events delivered while a file is parsed progressively.
+ * See `FileParser::setProgressive()`
+ */
+struct EventBatch {
+  std::vector<SceneEvent> sceneEvents;
+  std::vector<ChartEvent> chartEvents;
+  std::vector<LogEvent> logEvents;
+
+  /**
+   * The time of the latest event parsed so far.
+   * Later batches only contain events at, or after, this time
+   */
+  nanoseconds parsedTime = 0LL;
+
+  /**
+   * The fraction of the file parsed so far, from 0.0 to 1.0
+   */
+  double progress = 0.0;
+
+  /**
+   * When the batch was handed off by the parser,
+   * to measure how long it waits before it is loaded
+   */
+  std::chrono::steady_clock::time_point delivered{};
+};
+
 class FileParser {
   friend JsonHandler;
+  friend binary::BinaryReader;
+  friend ChunkedParser;
+  friend FollowParser;
 
 public:
   /**
-   * Read the JSON file specified by path,
+   * Read the scenario file specified by path,
    * sets the configuration, nodes, etc.
    *
+   * Files beginning with the binary scenario header (see `binary/binary-format.h`)
+   * are memory mapped and read directly, all others are parsed as JSON.
+   *
    * @param path
-   * The path to the JSON file
+   * The path to the JSON or binary scenario file
    */
   std::optional<ParseError> parse(const char *path);
 
+  /**
+   * Read the scenario file specified by path, passing each model & event to `sink` as soon as it is parsed,
+   * rather than keeping them. The getters are left empty.
+   *
+   * JSON scenarios are parsed in one pass, in the order of the file,
+   * so neither `setParseThreads()`, `setCompaction()`, `setCache()` nor `setProgressive()` apply.
+   * Binary scenarios are read whole, then passed on. `setFilter()` & `setCancellation()` still apply
+   *
+   * @param path
+   * The path to the JSON or binary scenario file
+   *
+   * @param sink
+   * Receives the models & events. Only used until this returns
+   */
+  std::optional<ParseError> parse(const char *path, ParseSink &sink);
+
+  /**
+   * Read a JSON scenario which is still being written, delivering each event as it is appended,
+   * until the document is closed, or `stop` is set. See `FollowParser`.
+   * Binary & compressed scenarios are parsed once, with `parse()`.
+   *
+   * The parser must be progressive, see `setProgressive()`
+   *
+   * @param path
+   * The path to the scenario file
+   *
+   * @param stop
+   * Set from any thread to stop following the file.
+   * The events delivered so far are kept
+   */
+  std::optional<ParseError> follow(const char *path, const std::atomic<bool> &stop);
+
+  /**
+   * Listen for a simulation streaming its JSON scenario, see `IngestSocket`,
+   * and deliver each event as it arrives,
+   * until the document is closed, the connection is, or `stop` is set.
+   *
+   * The parser must be progressive, see `setProgressive()`
+   *
+   * @param address
+   * Where to listen, see `IngestSocket::listen()`
+   *
+   * @param stop
+   * Set from any thread to stop listening.
+   * The events delivered so far are kept
+   */
+  std::optional<ParseError> listen(const char *address, const std::atomic<bool> &stop);
+
   /**
    * Clear stored information from a previous `parse()` call
    */
   void reset();
 
+  /**
+   * Set the number of threads used to parse the 'events' section
+   * of large JSON files.
+   *
+   * @param threads
+   * The number of threads to use.
+   * 0 uses one thread per hardware thread, 1 parses the whole file on the calling thread
+   */
+  void setParseThreads(unsigned int threads);
+
+  /**
+   * Read flat event objects (e.g. 'node-position') from uncompressed JSON files
+   * with a dedicated scanner, rather than RapidJSON.
+   * See `JsonHandler::scanEvent()`. Enabled by default
+   *
+   * @param enabled
+   * True to use the scanner, false to parse every event with RapidJSON
+   */
+  void setFastEvents(bool enabled);
+
+  /**
+   * Map uncompressed JSON files copy-on-write, so RapidJSON decodes their strings in place
+   * (`rapidjson::kParseInsituFlag`), and the handler is passed views into the mapping
+   * instead of copies. Only applies with `setFastEvents()`. Disabled by default.
+   *
+   * The file itself is never changed, but each page RapidJSON reads a string from is copied.
+   * The scanner already passes views of the flat events, so this only pays off
+   * when few events are left to RapidJSON, see `netsimulyzer-parse-bench`
+   *
+   * @param enabled
+   * True to parse in place, false to map the files read-only
+   */
+  void setInSitu(bool enabled);
+
+  /**
+   * Remove the scene events which barely change the scene as they're parsed,
+   * see `EventCompactor`
+   *
+   * @param tolerance
+   * The furthest a removed move may be from the simplified path of its Node, in ns-3 units.
+   * Unset to keep every event
+   */
+  void setCompaction(std::optional<double> tolerance);
+
+  /**
+   * @return
+   * The number of scene events removed by compaction in the last `parse()`
+   */
+  [[nodiscard]] std::size_t getCompactedEvents() const;
+
+  /**
+   * Events are put back in time order after they are parsed, see `sortByTime()`.
+   * The playback of each kind of event stops at the first event in the future,
+   * so out of order events would otherwise be skipped.
+   *
+   * When the parser is progressive, each batch is sorted before it is delivered,
+   * so an event earlier than a batch already delivered remains out of order
+   *
+   * @return
+   * The number of events found out of order in the last `parse()`
+   */
+  [[nodiscard]] std::size_t getReorderedEvents() const;
+
+  /**
+   * Only keep part of the next JSON scenarios parsed, see `ParseFilter`.
+   * Binary scenarios are always read whole
+   *
+   * @param newFilter
+   * What to keep. Default constructed to keep everything
+   */
+  void setFilter(ParseFilter newFilter);
+
+  /**
+   * Keep a binary snapshot of each JSON scenario parsed, see `ParseCache`,
+   * and load the snapshot instead the next time the same scenario is parsed.
+   *
+   * Nothing is cached while a filter is set, see `setFilter()`.
+   * Snapshots are taken before compaction, see `setCompaction()`.
+   * When the parser is progressive, the delivered events are copied until the snapshot is written
+   *
+   * @param directory
+   * Where to keep snapshots, or an empty string to keep each next to its scenario.
+   * Unset to stop caching
+   */
+  void setCache(std::optional<std::string> directory);
+
+  /**
+   * Stop the next scenarios parsed once `token` is cancelled.
+   * Checked before each event is added, so a cancelled parse stops within a few events,
+   * and returns an error, leaving the parser partially filled until `reset()`
+   *
+   * @param token
+   * Cancelled from any thread to stop the parse.
+   * Default constructed to never stop
+   */
+  void setCancellation(CancellationToken token);
+
+  /**
+   * @return
+   * True if the token given to `setCancellation()` has been cancelled
+   */
+  [[nodiscard]] bool cancelled() const;
+
+  /**
+   * Deliver the file in pieces while it is parsed,
+   * rather than all at once after `parse()` returns.
+   *
+   * Large JSON files deliver their events in several batches,
+   * all other files deliver their events in a single batch
+   * once the whole file is parsed.
+   *
+   * Both callbacks are run on the thread calling `parse()`
+   *
+   * @param sectionsParsed
+   * Called once every section other than 'events' is parsed.
+   * The configuration, nodes, etc. may be read during this call,
+   * but the end time and bounds of the configuration
+   * do not account for the events yet.
+   *
+   * @param eventsParsed
+   * Called with each batch of events, in file order.
+   * Delivered events are not kept by the parser
+   */
+  void setProgressive(std::function<void()> sectionsParsed, std::function<void(EventBatch &&)> eventsParsed);
+
+  /**
+   * Report the model of each Node & Decoration as soon as it is parsed,
+   * so the models may be loaded while the rest of the file is parsed.
+   *
+   * Run on the thread calling `parse()`.
+   * The same model may be reported more than once
+   *
+   * @param modelFound
+   * Called with the path of each model, as it appears in the file
+   */
+  void setModelFound(std::function<void(const std::string &)> modelFound);
+
   /**
    * Gets the configuration from the parsed file
    * `parse()` should be called first
@@ -143,6 +378,39 @@ public:
    */
   [[nodiscard]] const std::vector<LogEvent> &getLogEvents() const;
 
+  /**
+   * Moves the collection of events for the Scene out of the parser,
+   * rather than copying them.
+   * `parse()` should be called first.
+   *
+   * The parser no longer holds these events afterwards
+   *
+   * @return The events specified by the parsed file
+   */
+  [[nodiscard]] std::vector<SceneEvent> takeSceneEvents();
+
+  /**
+   * Moves the collection of events for the Charts controller out of the parser,
+   * rather than copying them.
+   * `parse()` should be called first.
+   *
+   * The parser no longer holds these events afterwards
+   *
+   * @return The events specified by the parsed file
+   */
+  [[nodiscard]] std::vector<ChartEvent> takeChartsEvents();
+
+  /**
+   * Moves the collection of events for the Scenario Log controller out of the parser,
+   * rather than copying them.
+   * `parse()` should be called first.
+   *
+   * The parser no longer holds these events afterwards
+   *
+   * @return The events specified by the parsed file
+   */
+  [[nodiscard]] std::vector<LogEvent> takeLogEvents();
+
   /**
    * Gets the collection of XY series from the parsed file
    * `parse()` should be called first
@@ -176,7 +444,174 @@ public:
    */
   [[nodiscard]] const std::vector<LogStream> &getLogStreams() const;
 
+  /**
+   * Copy the Nodes, Decorations, & series into one table,
+   * to be shared by everything reading them, rather than copied by each.
+   * Every section other than 'events' should be parsed first
+   *
+   * @return
+   * The shared table, which is never changed
+   */
+  [[nodiscard]] std::shared_ptr<const StaticModels> shareStaticModels() const;
+
+  /**
+   * The memory held by one collection of the parser
+   */
+  struct MemoryUsage {
+    const char *name;
+    std::size_t bytes;
+  };
+
+  /**
+   * The memory held by each collection, by the capacity of each vector.
+   * Memory owned by the elements themselves (e.g. names) is not counted.
+   * Not safe to call while parsing on another thread
+   *
+   * @return
+   * One entry per collection
+   */
+  [[nodiscard]] std::vector<MemoryUsage> memoryUsage() const;
+
 private:
+  /**
+   * The number of threads used to parse the 'events' section.
+   * See `setParseThreads()`
+   */
+  unsigned int parseThreads = 0u;
+
+  /**
+   * If flat events skip RapidJSON, see `setFastEvents()`
+   */
+  bool fastEvents{true};
+
+  /**
+   * If mapped JSON files are parsed in place, see `setInSitu()`
+   */
+  bool inSitu{false};
+
+  /**
+   * What to keep from JSON scenarios, see `setFilter()`
+   */
+  ParseFilter filter;
+
+  /**
+   * Set when scenarios are cached, see `setCache()`
+   */
+  std::optional<ParseCache> cache;
+
+  /**
+   * Stops parsing once cancelled, see `setCancellation()`
+   */
+  CancellationToken cancellation;
+
+  /**
+   * If delivered events are copied for the snapshot being taken
+   */
+  bool snapshotEvents{false};
+
+  /**
+   * Copies of the events delivered so far, for the snapshot
+   */
+  std::vector<SceneEvent> snapshotSceneEvents;
+  std::vector<ChartEvent> snapshotChartEvents;
+  std::vector<LogEvent> snapshotLogEvents;
+
+  /**
+   * Write the snapshot of the scenario just parsed,
+   * including any events already delivered
+   *
+   * @param snapshot
+   * The path of the snapshot, see `ParseCache::snapshotPath()`
+   */
+  void writeSnapshot(const std::string &snapshot);
+
+  /**
+   * Set when events are compacted, see `setCompaction()`
+   */
+  std::optional<EventCompactor> compactor;
+
+  /**
+   * If `compactor` has the initial state of the Nodes being parsed
+   */
+  bool compactorReady{false};
+
+  /**
+   * See `getReorderedEvents()`
+   */
+  std::size_t reorderedEvents{0u};
+
+  /**
+   * Sort the events parsed since the last delivery by time
+   */
+  void sortEvents();
+
+  /**
+   * Compact the scene events parsed since the last call, if compaction is enabled.
+   * Must be called after the Nodes are sorted, and the events are in time order
+   */
+  void compactEvents();
+
+  /**
+   * Called once every section other than 'events' is parsed.
+   * See `setProgressive()`
+   */
+  std::function<void()> sectionsParsed;
+
+  /**
+   * Called with each batch of parsed events.
+   * Unset unless the file should be delivered progressively.
+   * See `setProgressive()`
+   */
+  std::function<void(EventBatch &&)> eventsParsed;
+
+  /**
+   * See `setModelFound()`
+   */
+  std::function<void(const std::string &)> modelFound;
+
+  /**
+   * Run `modelFound`, if it is set
+   */
+  void foundModel(const std::string &path) const;
+
+  /**
+   * Sort the Nodes, Buildings, and Decorations by ID
+   */
+  void sortSections();
+
+  /**
+   * Move the events parsed so far into a batch,
+   * and pass it to `eventsParsed`
+   *
+   * @param parsedTime
+   * The time of the latest event parsed so far
+   *
+   * @param progress
+   * The fraction of the file parsed so far
+   */
+  void deliverEvents(nanoseconds parsedTime, double progress);
+
+  /**
+   * Set while parsing into a sink, see `parse(const char *, ParseSink &)`
+   */
+  ParseSink *sink{nullptr};
+
+  /**
+   * The body of `parse(const char *, ParseSink &)`, while `sink` is set
+   */
+  std::optional<ParseError> parseToSink(const char *path);
+
+  /**
+   * Pass everything parsed since the last call to `sink`, leaving the collections empty
+   */
+  void forward();
+
+  /**
+   * Parse a whole JSON document from `stream` with a `JsonHandler`
+   */
+  template <class Stream>
+  std::optional<ParseError> parseJson(Stream &stream);
+
   /**
    * Specific error message from the parser
    */
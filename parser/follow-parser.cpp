@@ -0,0 +1,290 @@
+/*
+ * NIST-developed software is provided by NIST as a public service. You may use,
+ * copy and distribute copies of the software in any medium, provided that you
+ * keep intact this entire notice. You may improve,modify and create derivative
+ * works of the software or any portion of the software, and you may copy and
+ * distribute such modifications or works. Modified works should carry a notice
+ * stating that you changed the software and should note the date and nature of
+ * any such change. Please explicitly acknowledge the National Institute of
+ * Standards and Technology as the source of the software.
+ *
+ * NIST-developed software is expressly provided "AS IS." NIST MAKES NO
+ * WARRANTY OF ANY KIND, EXPRESS, IMPLIED, IN FACT OR ARISING BY OPERATION OF
+ * LAW, INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTY OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, NON-INFRINGEMENT
+ * AND DATA ACCURACY. NIST NEITHER REPRESENTS NOR WARRANTS THAT THE
+ * OPERATION OF THE SOFTWARE WILL BE UNINTERRUPTED OR ERROR-FREE, OR THAT
+ * ANY DEFECTS WILL BE CORRECTED. NIST DOES NOT WARRANT OR MAKE ANY
+ * REPRESENTATIONS REGARDING THE USE OF THE SOFTWARE OR THE RESULTS THEREOF,
+ * INCLUDING BUT NOT LIMITED TO THE CORRECTNESS, ACCURACY, RELIABILITY,
+ * OR USEFULNESS OF THE SOFTWARE.
+ *
+ * You are solely responsible for determining the appropriateness of using and
+ * distributing the software and you assume all risks associated with its use,
+ * including but not limited to the risks and costs of program errors,
+ * compliance with applicable laws, damage to or loss of data, programs or
+ * equipment, and the unavailability or interruption of operation. This
+ * software is not intended to be used in any situation where a failure could
+ * cause risk of injury or damage to property. The software developed by NIST
+ * employees is not subject to copyright protection within the United States.
+ *
+ * Author: Evan Black <evan.black@nist.gov>
+ */
+
+#include "follow-parser.h"
+#include "event-scanner.h"
+#include "handler/JsonHandler.h"
+#include "handler/parse-error.h"
+#include <algorithm>
+#include <cstdio>
+#include <memory>
+#include <string_view>
+#include <thread>
+#include <variant>
+
+namespace {
+
+/**
+ * @return
+ * The time of the last event in `events`, or `fallback` if there are none
+ */
+template <class T>
+parser::nanoseconds lastTime(const std::vector<T> &events, parser::nanoseconds fallback) {
+  if (events.empty())
+    return fallback;
+
+  return std::visit(
+      [fallback](const auto &e) {
+        return std::max(fallback, e.time);
+      },
+      events.back());
+}
+
+bool isBlank(char c) {
+  return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+}
+
+} // namespace
+
+namespace parser {
+
+FollowParser::FollowParser(FileParser &parser) : fileParser(parser) {
+}
+
+char FollowParser::at(std::size_t offset) const {
+  return pending[offset - pendingOffset];
+}
+
+void FollowParser::scan() {
+  const auto end = pendingOffset + pending.size();
+
+  for (; scanned < end && phase != Phase::Done; scanned++) {
+    const auto c = at(scanned);
+
+    if (inString) {
+      if (escaped)
+        escaped = false;
+      else if (c == '\\')
+        escaped = true;
+      else if (c == '"') {
+        inString = false;
+        if (depth == 1u)
+          keyEnd = scanned;
+      }
+      continue;
+    }
+
+    switch (c) {
+    case '"':
+      inString = true;
+      if (depth == 1u)
+        keyBegin = scanned + 1u;
+      break;
+    case '[':
+      // '"events" :' directly before, in the root object
+      if (phase == Phase::Head && depth == 1u && keyEnd > keyBegin) {
+        std::string_view key{pending.data() + (keyBegin - pendingOffset), keyEnd - keyBegin};
+        auto between = keyEnd + 1u;
+        while (between < scanned && (isBlank(at(between)) || at(between) == ':'))
+          between++;
+
+        if (key == "events" && between == scanned) {
+          eventsBegin = scanned;
+          eventsParsed = scanned + 1u;
+          phase = Phase::Events;
+        }
+      }
+      depth++;
+      break;
+    case '{':
+      depth++;
+      break;
+    case '}':
+      depth--;
+      if (phase == Phase::Events && depth == 2u)
+        lastEventEnd = scanned + 1u;
+      else if (depth == 0u) {
+        documentEnd = scanned + 1u;
+        phase = Phase::Done;
+      }
+      break;
+    case ']':
+      depth--;
+      if (phase == Phase::Events && depth == 1u) {
+        eventsEnd = scanned;
+        phase = Phase::Tail;
+      }
+      break;
+    default:
+      break;
+    }
+  }
+}
+
+void FollowParser::deliver() {
+  parsedTime = lastTime(fileParser.sceneEvents, parsedTime);
+  parsedTime = lastTime(fileParser.chartEvents, parsedTime);
+  parsedTime = lastTime(fileParser.logEvents, parsedTime);
+
+  if (fileParser.sceneEvents.empty() && fileParser.chartEvents.empty() && fileParser.logEvents.empty())
+    return;
+
+  // Everything written so far is parsed
+  fileParser.deliverEvents(parsedTime, 1.0);
+}
+
+std::optional<ParseError> FollowParser::follow(const char *path, const std::atomic<bool> &stop) {
+  std::unique_ptr<FILE, decltype(&std::fclose)> file{std::fopen(path, "rb"), std::fclose};
+  if (!file)
+    return {ParseError{"Failed to open file", 0u}};
+
+  // A file may always be appended to
+  return ingest(
+      [&file](char *buffer, std::size_t size) -> std::optional<std::size_t> {
+        const auto read = std::fread(buffer, 1u, size, file.get());
+        if (read == 0u) {
+          // Clear the end of file, so the next read sees anything appended
+          std::clearerr(file.get());
+          std::this_thread::sleep_for(pollInterval);
+        }
+        return read;
+      },
+      stop);
+}
+
+std::optional<ParseError> FollowParser::ingest(const Source &source, const std::atomic<bool> &stop) {
+  JsonHandler handler{fileParser};
+  rapidjson::Reader reader;
+  reader.IterativeParseInit();
+
+  // Parse with `reader` from `begin` until `done` is true, or the stream ends
+  const auto parseTokens = [this, &reader, &handler](std::size_t begin, std::size_t end,
+                                                      auto done) -> std::optional<ParseError> {
+    RangeStream stream{pending.data() + (begin - pendingOffset), pending.data() + (end - pendingOffset)};
+    while (!reader.IterativeParseComplete() && !done()) {
+      if (!reader.IterativeParseNext<rapidjson::kParseDefaultFlags>(stream, handler))
+        return ParseError{describeParseError(reader.GetParseErrorCode(), fileParser.errorMessage),
+                          begin + reader.GetErrorOffset()};
+    }
+    return {};
+  };
+
+  // Parse the complete events from `eventsParsed` up to `end`
+  const auto parseAppended = [this, &handler](std::size_t end) -> std::optional<ParseError> {
+    RangeStream stream{pending.data() + (eventsParsed - pendingOffset), pending.data() + (end - pendingOffset)};
+
+    // The comma after the last event parsed
+    if (eventsParsed > eventsBegin + 1u) {
+      while (isBlank(stream.Peek()))
+        stream.Take();
+      if (stream.Peek() == ',')
+        stream.Take();
+    }
+
+    std::size_t errorOffset = 0u;
+    if (const auto code = parseEvents(stream, handler, errorOffset); code != rapidjson::kParseErrorNone)
+      return ParseError{describeParseError(code, fileParser.errorMessage), eventsParsed + errorOffset};
+
+    eventsParsed = end;
+    return {};
+  };
+
+  std::vector<char> buffer(1u << 20u);
+  auto sectionsDelivered = false;
+  auto closed = false;
+
+  while (!stop) {
+    const auto read = source(buffer.data(), buffer.size());
+    if (!read) {
+      closed = true;
+      break;
+    }
+    if (read.value() == 0u)
+      continue;
+
+    pending.append(buffer.data(), read.value());
+    scan();
+
+    if (!sectionsDelivered && phase != Phase::Head) {
+      // A document without 'events' is parsed whole
+      if (eventsBegin == 0u) {
+        if (auto error = parseTokens(pendingOffset, documentEnd, []() {
+              return false;
+            }))
+          return error;
+
+        fileParser.sortSections();
+        if (fileParser.sectionsParsed)
+          fileParser.sectionsParsed();
+        sectionsDelivered = true;
+        break;
+      }
+
+      if (auto error = parseTokens(pendingOffset, eventsBegin + 1u, [&handler]() {
+            return handler.isEventStart();
+          }))
+        return error;
+
+      fileParser.sortSections();
+      if (fileParser.sectionsParsed)
+        fileParser.sectionsParsed();
+      sectionsDelivered = true;
+    }
+
+    if (!sectionsDelivered)
+      continue;
+
+    if (lastEventEnd > eventsParsed) {
+      if (auto error = parseAppended(lastEventEnd))
+        return error;
+      deliver();
+    }
+
+    // The rest of the document, once it is all written
+    if (phase == Phase::Done) {
+      if (auto error = parseAppended(eventsEnd))
+        return error;
+      if (auto error = parseTokens(eventsEnd, documentEnd, []() {
+            return false;
+          }))
+        return error;
+      break;
+    }
+
+    // Only keep what is not parsed yet
+    pending.erase(0u, eventsParsed - pendingOffset);
+    pendingOffset = eventsParsed;
+  }
+
+  if (!sectionsDelivered)
+    return {ParseError{closed ? "The scenario ended before the 'events' section"
+                              : "Stopped before the 'events' section was written",
+                       pendingOffset + pending.size()}};
+
+  // Anything after the last complete event is dropped
+  fileParser.sortSections();
+  deliver();
+  return {};
+}
+
+} // namespace parser
@@ -0,0 +1,195 @@
+/*
+ * NIST-developed software is provided by NIST as a public service. You may use,
+ * copy and distribute copies of the software in any medium, provided that you
+ * keep intact this entire notice. You may improve,modify and create derivative
+ * works of the software or any portion of the software, and you may copy and
+ * distribute such modifications or works. Modified works should carry a notice
+ * stating that you changed the software and should note the date and nature of
+ * any such change. Please explicitly acknowledge the National Institute of
+ * Standards and Technology as the source of the software.
+ *
+ * NIST-developed software is expressly provided "AS IS." NIST MAKES NO
+ * WARRANTY OF ANY KIND, EXPRESS, IMPLIED, IN FACT OR ARISING BY OPERATION OF
+ * LAW, INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTY OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, NON-INFRINGEMENT
+ * AND DATA ACCURACY. NIST NEITHER REPRESENTS NOR WARRANTS THAT THE
+ * OPERATION OF THE SOFTWARE WILL BE UNINTERRUPTED OR ERROR-FREE, OR THAT
+ * ANY DEFECTS WILL BE CORRECTED. NIST DOES NOT WARRANT OR MAKE ANY
+ * REPRESENTATIONS REGARDING THE USE OF THE SOFTWARE OR THE RESULTS THEREOF,
+ * INCLUDING BUT NOT LIMITED TO THE CORRECTNESS, ACCURACY, RELIABILITY,
+ * OR USEFULNESS OF THE SOFTWARE.
+ *
+ * You are solely responsible for determining the appropriateness of using and
+ * distributing the software and you assume all risks associated with its use,
+ * including but not limited to the risks and costs of program errors,
+ * compliance with applicable laws, damage to or loss of data, programs or
+ * equipment, and the unavailability or interruption of operation. This
+ * software is not intended to be used in any situation where a failure could
+ * cause risk of injury or damage to property. The software developed by NIST
+ * employees is not subject to copyright protection within the United States.
+ *
+ * Author: Evan Black <evan.black@nist.gov>
+ */
+
+#pragma once
+#include "file-parser.h"
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <optional>
+#include <string>
+
+namespace parser {
+
+/**
+ * Parses a JSON scenario which is still being written, such as the output of a running simulation,
+ * either to a file, or to a socket, see `ingest()`.
+ *
+ * The sections before 'events' are delivered once they are complete,
+ * then each event appended to the file is parsed as soon as it is complete,
+ * and delivered in batches, while the 'events' array is still open.
+ * Sections after 'events' are only parsed once the document is closed,
+ * and are not delivered.
+ *
+ * The parser must be progressive, see `FileParser::setProgressive()`
+ */
+class FollowParser {
+public:
+  /**
+   * How long a `Source` should wait for more text, before returning what it has
+   */
+  static constexpr std::chrono::milliseconds pollInterval{250};
+
+  /**
+   * Reads the next text of a scenario into `buffer`, waiting at most `pollInterval` for some to arrive.
+   *
+   * Returns the number of bytes read, which may be 0 if nothing arrived in time,
+   * or an unset optional once nothing more will ever arrive
+   */
+  using Source = std::function<std::optional<std::size_t>(char *buffer, std::size_t size)>;
+
+private:
+  /**
+   * Where the parse is in the document
+   */
+  enum class Phase { Head, Events, Tail, Done };
+
+  FileParser &fileParser;
+
+  Phase phase{Phase::Head};
+
+  /**
+   * The text read, but not parsed yet
+   */
+  std::string pending;
+
+  /**
+   * Offset in the file of the start of `pending`.
+   * The offsets below count from the start of the stream for a `Source` other than a file
+   */
+  std::size_t pendingOffset{0u};
+
+  /**
+   * Offset in the file of the first character not checked by `scan()`
+   */
+  std::size_t scanned{0u};
+
+  /**
+   * The state of `scan()`, carried across reads, which may end anywhere
+   */
+  std::size_t depth{0u};
+  bool inString{false};
+  bool escaped{false};
+
+  /**
+   * The last key in the root object, as offsets in the file.
+   * `keyEnd` is the closing quote
+   */
+  std::size_t keyBegin{0u};
+  std::size_t keyEnd{0u};
+
+  /**
+   * Offsets in the file of the opening bracket of the 'events' array,
+   * the end of the last complete event in it, and its closing bracket
+   */
+  std::size_t eventsBegin{0u};
+  std::size_t eventsParsed{0u};
+  std::size_t lastEventEnd{0u};
+  std::size_t eventsEnd{0u};
+
+  /**
+   * One past the closing brace of the document, 0 until it is written
+   */
+  std::size_t documentEnd{0u};
+
+  /**
+   * The time of the latest event parsed
+   */
+  nanoseconds parsedTime{0LL};
+
+  /**
+   * @param offset
+   * An offset in the file, within `pending`
+   *
+   * @return
+   * The character at `offset`
+   */
+  [[nodiscard]] char at(std::size_t offset) const;
+
+  /**
+   * Walk the structure of the text read since the last call,
+   * finding the 'events' array, each complete event, and the end of the document
+   */
+  void scan();
+
+  /**
+   * Note the time of the latest events parsed, then deliver them
+   */
+  void deliver();
+
+public:
+  /**
+   * @param parser
+   * The progressive parser to fill. Should be `reset()` beforehand
+   */
+  explicit FollowParser(FileParser &parser);
+
+  /**
+   * Parse the file at `path`, then keep parsing what is appended to it,
+   * until the document is closed, or `stop` is set
+   *
+   * @param path
+   * The path to the JSON scenario file
+   *
+   * @param stop
+   * Set from any thread to stop following,
+   * keeping what was delivered so far
+   *
+   * @return
+   * An error if the file could not be parsed,
+   * or following stopped before the 'events' section began,
+   * an unset optional otherwise
+   */
+  std::optional<ParseError> follow(const char *path, const std::atomic<bool> &stop);
+
+  /**
+   * Parse a scenario from `source` as it arrives, until the document is closed,
+   * `source` ends, or `stop` is set
+   *
+   * @param source
+   * Where to read the scenario from
+   *
+   * @param stop
+   * Set from any thread to stop reading,
+   * keeping what was delivered so far
+   *
+   * @return
+   * An error if the scenario could not be parsed,
+   * or reading stopped before the 'events' section began,
+   * an unset optional otherwise
+   */
+  std::optional<ParseError> ingest(const Source &source, const std::atomic<bool> &stop);
+};
+
+} // namespace parser
@@ -2,6 +2,7 @@
 
 #include <iostream>
 #include <memory>
+#include <memory_resource>
 #include <string>
 #include <string_view>
 #include <type_traits>
@@ -14,17 +15,33 @@ namespace util::json {
 class JsonValue;
 
 /**
- * Representation of a JSON array
+ * Representation of a JSON array.
+ * Elements are allocated from the resource given on construction
  */
-using JsonArray = std::vector<JsonValue>;
+using JsonArray = std::pmr::vector<JsonValue>;
 
 /**
  * Representation of a JSON object
  */
 class JsonObject {
-  std::unordered_map<std::string, std::shared_ptr<JsonValue>> members;
+  std::pmr::unordered_map<std::string, std::shared_ptr<JsonValue>> members;
 
 public:
+  /**
+   * Constructs an empty object, allocating from the default resource
+   */
+  JsonObject() = default;
+
+  /**
+   * Constructs an empty object, allocating its members from `resource`.
+   * Copies of the object allocate from the default resource instead
+   *
+   * @param resource
+   * The resource to allocate members from. Must outlive the object
+   */
+  explicit JsonObject(std::pmr::memory_resource *resource) : members(resource) {
+  }
+
   /**
    * Get a member of this object
    *
@@ -107,7 +124,21 @@ public:
    * The value of the member
    */
   void insert(const std::string &key, const JsonValue &value) {
-    members[key] = std::make_shared<JsonValue>(value);
+    members[key] = std::allocate_shared<JsonValue>(members.get_allocator(), value);
+  }
+
+  /**
+   * Inserts a new key/value pair into this object, moving `value` in.
+   * Will overwrite a member with the same name
+   *
+   * @param key
+   * The name for the new member
+   *
+   * @param value
+   * The value of the member
+   */
+  void insert(const std::string &key, JsonValue &&value) {
+    members[key] = std::allocate_shared<JsonValue>(members.get_allocator(), std::move(value));
   }
 };
 
@@ -235,6 +266,15 @@ public:
   JsonValue(const std::string &value) : value(value) {
   }
 
+  /**
+   * Constructs a string value
+   *
+   * @param value
+   * The std::string value to move in
+   */
+  JsonValue(std::string &&value) : value(std::move(value)) {
+  }
+
   /**
    * Constructs an object value
    *
@@ -244,6 +284,15 @@ public:
   JsonValue(const JsonObject &object) : value(object) {
   }
 
+  /**
+   * Constructs an object value, keeping the resource of `object`
+   *
+   * @param object
+   * The object to move in
+   */
+  JsonValue(JsonObject &&object) : value(std::move(object)) {
+  }
+
   /**
    * Constructs an array value
    *
@@ -253,6 +302,15 @@ public:
   JsonValue(const JsonArray &array) : value(array) {
   }
 
+  /**
+   * Constructs an array value, keeping the resource of `array`
+   *
+   * @param array
+   * The array to move in
+   */
+  JsonValue(JsonArray &&array) : value(std::move(array)) {
+  }
+
   /**
    * Replaces the current value with `nullptr`
    */
@@ -36,11 +36,16 @@
 #include "iostream"
 #include <algorithm>
 #include <cmath>
+#include <cstdint>
 #include <exception>
+#include <initializer_list>
 #include <sstream>
+#include <string_view>
+#include <variant>
 
 using int_type = util::json::JsonValue::int_type;
 using unsigned_int_type = util::json::JsonValue::unsigned_int_type;
+using Field = parser::RawEvent::Field;
 const long long msToNsFactor = 1'000'000LL;
 
 namespace {
@@ -76,13 +81,160 @@ void requiredFields(const util::json::JsonObject &object, const std::vector<std:
   }
 }
 
-void atLeastOneRequiredFields(const util::json::JsonObject &object, const std::vector<std::string> &fields) {
-  for (const auto &field : fields) {
-    if (object.contains(field))
-      return;
+/**
+ * The key for each `RawEvent::Field`, used for error messages
+ */
+std::string fieldName(Field field) {
+  switch (field) {
+  case Field::Type:
+    return "type";
+  case Field::Milliseconds:
+    return "milliseconds";
+  case Field::Nanoseconds:
+    return "nanoseconds";
+  case Field::Id:
+    return "id";
+  case Field::SeriesId:
+    return "series-id";
+  case Field::StreamId:
+    return "stream-id";
+  case Field::X:
+    return "x";
+  case Field::Y:
+    return "y";
+  case Field::Z:
+    return "z";
+  case Field::Duration:
+    return "duration";
+  case Field::TargetSize:
+    return "target-size";
+  case Field::Color:
+    return "color";
+  case Field::ColorType:
+    return "color-type";
+  case Field::Category:
+    return "category";
+  case Field::Value:
+    return "value";
+  case Field::Data:
+    return "data";
+  case Field::Points:
+    return "points";
+  default:
+    return "unknown";
+  }
+}
+
+/**
+ * FNV-1a hash of a key, usable in `case` labels.
+ *
+ * The dispatchers below switch on this, and a duplicate `case` label fails to compile,
+ * so the hash is checked to be perfect over the known keys at compile time.
+ * Unknown keys may still share a hash with a known one,
+ * so the matched key is compared once to confirm it
+ */
+constexpr std::uint32_t keyHash(std::string_view key) {
+  std::uint32_t hash = 2166136261u;
+  for (const auto c : key) {
+    hash ^= static_cast<unsigned char>(c);
+    hash *= 16777619u;
+  }
+  return hash;
+}
+
+/**
+ * @return
+ * `value` if `key` is `known`, `fallback` otherwise
+ */
+template <class T>
+constexpr T confirmKey(std::string_view key, std::string_view known, T value, T fallback) {
+  return key == known ? value : fallback;
+}
+
+Field fieldFromKey(std::string_view key) {
+  const auto confirm = [key](std::string_view known, Field field) {
+    return confirmKey(key, known, field, Field::Unknown);
+  };
+
+  switch (keyHash(key)) {
+  case keyHash("x"):
+    return confirm("x", Field::X);
+  case keyHash("y"):
+    return confirm("y", Field::Y);
+  case keyHash("z"):
+    return confirm("z", Field::Z);
+  case keyHash("id"):
+    return confirm("id", Field::Id);
+  case keyHash("type"):
+    return confirm("type", Field::Type);
+  case keyHash("nanoseconds"):
+    return confirm("nanoseconds", Field::Nanoseconds);
+  case keyHash("milliseconds"):
+    return confirm("milliseconds", Field::Milliseconds);
+  case keyHash("series-id"):
+    return confirm("series-id", Field::SeriesId);
+  case keyHash("stream-id"):
+    return confirm("stream-id", Field::StreamId);
+  case keyHash("duration"):
+    return confirm("duration", Field::Duration);
+  case keyHash("target-size"):
+    return confirm("target-size", Field::TargetSize);
+  case keyHash("color"):
+    return confirm("color", Field::Color);
+  case keyHash("color-type"):
+    return confirm("color-type", Field::ColorType);
+  case keyHash("category"):
+    return confirm("category", Field::Category);
+  case keyHash("value"):
+    return confirm("value", Field::Value);
+  case keyHash("data"):
+    return confirm("data", Field::Data);
+  case keyHash("points"):
+    return confirm("points", Field::Points);
+  default:
+    return Field::Unknown;
+  }
+}
+
+parser::RawEvent::Type eventTypeFromString(std::string_view type) {
+  using Type = parser::RawEvent::Type;
+  const auto confirm = [type](std::string_view known, Type value) {
+    return confirmKey(type, known, value, Type::Unknown);
+  };
+
+  switch (keyHash(type)) {
+  case keyHash("node-position"):
+    return confirm("node-position", Type::NodePosition);
+  case keyHash("node-orientation"):
+    return confirm("node-orientation", Type::NodeOrientation);
+  case keyHash("node-color"):
+    return confirm("node-color", Type::NodeColor);
+  case keyHash("node-transmit"):
+    return confirm("node-transmit", Type::NodeTransmit);
+  case keyHash("decoration-position"):
+    return confirm("decoration-position", Type::DecorationPosition);
+  case keyHash("decoration-orientation"):
+    return confirm("decoration-orientation", Type::DecorationOrientation);
+  case keyHash("xy-series-append"):
+    return confirm("xy-series-append", Type::XYSeriesAppend);
+  case keyHash("xy-series-append-array"):
+    return confirm("xy-series-append-array", Type::XYSeriesAppendArray);
+  case keyHash("xy-series-clear"):
+    return confirm("xy-series-clear", Type::XYSeriesClear);
+  case keyHash("category-series-append"):
+    return confirm("category-series-append", Type::CategorySeriesAppend);
+  case keyHash("stream-append"):
+    return confirm("stream-append", Type::StreamAppend);
+  default:
+    return Type::Unknown;
   }
+}
 
-  throw MissingRequiredFieldException{fields};
+void requiredFields(const parser::RawEvent &event, std::initializer_list<Field> fields) {
+  for (const auto field : fields) {
+    if (!event.has(field))
+      throw MissingRequiredFieldException{fieldName(field)};
+  }
 }
 
 // Copy of the palette from ns-3
@@ -127,16 +279,147 @@ parser::Ns3Color3 nextTrailColor(std::size_t &nextIndex) {
   return color;
 }
 
-parser::nanoseconds getTimeCompatible(const util::json::JsonObject &object) {
-  atLeastOneRequiredFields(object, {"milliseconds", "nanoseconds"});
-  parser::nanoseconds time;
+parser::nanoseconds getTimeCompatible(const parser::RawEvent &event) {
+  if (event.has(Field::Milliseconds))
+    return event.milliseconds * msToNsFactor;
+
+  if (event.has(Field::Nanoseconds))
+    return event.nanoseconds;
+
+  throw MissingRequiredFieldException{std::vector<std::string>{"milliseconds", "nanoseconds"}};
+}
+
+
+/**
+ * @return
+ * The first position from `position` which is not JSON whitespace, or `end`
+ */
+const char *skipBlank(const char *position, const char *end) {
+  while (position != end && (*position == ' ' || *position == '\n' || *position == '\r' || *position == '\t'))
+    position++;
+  return position;
+}
+
+/**
+ * Read the rest of a string without escapes
+ *
+ * @param position
+ * The position immediately after the opening quote
+ *
+ * @return
+ * The position of the closing quote, or null if the string is unterminated,
+ * or has an escape or control character, which are left for RapidJSON
+ */
+const char *scanPlainString(const char *position, const char *end) {
+  for (; position != end; position++) {
+    const auto c = static_cast<unsigned char>(*position);
+    if (c == '"')
+      return position;
+    if (c == '\\' || c < 0x20u)
+      return nullptr;
+  }
+
+  return nullptr;
+}
+
+/**
+ * Read a JSON number, the same way RapidJSON passes it to the handler
+ *
+ * @param position
+ * The first character of the number
+ *
+ * @param [out] integer
+ * The number, truncated, as RapidJSON's `Double()` callback is passed to `eventNumber()`
+ *
+ * @param [out] real
+ * The number
+ *
+ * @return
+ * One past the last character of the number, or null if it is not a valid number,
+ * or has too many digits, or too large an exponent, to read exactly here
+ */
+const char *scanNumber(const char *position, const char *end, long long &integer, double &real) {
+  // Powers of 10 which are exact as doubles
+  static constexpr double powers[] = {1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+                                      1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+  const auto isDigit = [](char c) {
+    return c >= '0' && c <= '9';
+  };
+
+  const auto negative = position != end && *position == '-';
+  if (negative)
+    position++;
+
+  if (position == end || !isDigit(*position))
+    return nullptr;
+
+  std::uint64_t significand = 0u;
+  auto digits = 0;
+
+  // JSON does not allow leading zeros
+  if (*position == '0') {
+    position++;
+    if (position != end && isDigit(*position))
+      return nullptr;
+  } else {
+    for (; position != end && isDigit(*position); position++, digits++)
+      significand = significand * 10u + static_cast<std::uint64_t>(*position - '0');
+  }
+
+  // The integers RapidJSON passes to `Int64()`, with room to spare
+  if (position == end || (*position != '.' && *position != 'e' && *position != 'E')) {
+    if (digits > 18)
+      return nullptr;
 
-  if (object.contains("milliseconds")) {
-    time = object["milliseconds"].get<int_type>() * msToNsFactor;
-    return time;
+    integer = negative ? -static_cast<long long>(significand) : static_cast<long long>(significand);
+    real = static_cast<double>(integer);
+    return position;
   }
 
-  return object["nanoseconds"].get<int_type>();
+  auto exponent = 0;
+  if (*position == '.') {
+    position++;
+    if (position == end || !isDigit(*position))
+      return nullptr;
+
+    for (; position != end && isDigit(*position); position++) {
+      // Leading zeros of the fraction are not significant
+      if (significand != 0u || *position != '0')
+        digits++;
+      significand = significand * 10u + static_cast<std::uint64_t>(*position - '0');
+      exponent--;
+    }
+  }
+
+  if (position != end && (*position == 'e' || *position == 'E')) {
+    position++;
+    auto negativeExponent = false;
+    if (position != end && (*position == '+' || *position == '-'))
+      negativeExponent = *position++ == '-';
+
+    if (position == end || !isDigit(*position))
+      return nullptr;
+
+    auto written = 0;
+    for (; position != end && isDigit(*position); position++) {
+      written = written * 10 + (*position - '0');
+      if (written > 1000)
+        return nullptr;
+    }
+    exponent += negativeExponent ? -written : written;
+  }
+
+  // Beyond this the significand, or the result, could be rounded twice
+  if (digits > 19 || exponent < -22 || exponent > 22)
+    return nullptr;
+
+  real = static_cast<double>(significand);
+  real = exponent < 0 ? real / powers[-exponent] : real * powers[exponent];
+  if (negative)
+    real = -real;
+
+  integer = static_cast<long long>(real);
+  return position;
 }
 
 } // namespace
@@ -222,6 +505,17 @@ parser::Ns3Color3 colorFromObject(const util::json::JsonObject &object) {
   return color;
 }
 
+parser::Ns3Color3 colorFromEvent(const parser::RawEvent &event) {
+  if (!(event.colorChannels & 1u))
+    throw MissingRequiredFieldException{"red"};
+  if (!(event.colorChannels & 2u))
+    throw MissingRequiredFieldException{"green"};
+  if (!(event.colorChannels & 4u))
+    throw MissingRequiredFieldException{"blue"};
+
+  return event.color;
+}
+
 constexpr JsonHandler::Section JsonHandler::isSection(std::string_view key) {
 
   if (key == "areas")
@@ -246,6 +540,31 @@ constexpr JsonHandler::Section JsonHandler::isSection(std::string_view key) {
     return Section::None;
 }
 
+const char *JsonHandler::traceName(JsonHandler::Section section) {
+  switch (section) {
+  case Section::Areas:
+    return "section/areas";
+  case Section::Buildings:
+    return "section/buildings";
+  case Section::Configuration:
+    return "section/configuration";
+  case Section::Decorations:
+    return "section/decorations";
+  case Section::Events:
+    return "section/events";
+  case Section::Links:
+    return "section/links";
+  case Section::Nodes:
+    return "section/nodes";
+  case Section::Series:
+    return "section/series";
+  case Section::Streams:
+    return "section/streams";
+  default:
+    return "section/unknown";
+  }
+}
+
 void JsonHandler::do_parse(JsonHandler::Section section, const util::json::JsonObject &object) {
   switch (section) {
   case Section::Areas:
@@ -260,33 +579,11 @@ void JsonHandler::do_parse(JsonHandler::Section section, const util::json::JsonO
   case Section::Decorations:
     parseDecoration(object);
     break;
-  case Section::Events: {
-    auto type = object["type"].get<std::string>();
-    if (type == "node-position")
-      parseMoveEvent(object);
-    else if (type == "node-orientation")
-      parseNodeOrientationEvent(object);
-    else if (type == "node-color")
-      parseNodeColorChangeEvent(object);
-    else if (type == "node-transmit")
-      parseTransmitEvent(object);
-    else if (type == "decoration-position")
-      parseDecorationMoveEvent(object);
-    else if (type == "decoration-orientation")
-      parseDecorationOrientationEvent(object);
-    else if (type == "xy-series-append")
-      parseSeriesAppend(object);
-    else if (type == "xy-series-append-array")
-      parseSeriesAppendArray(object);
-    else if (type == "xy-series-clear")
-      parseSeriesClear(object);
-    else if (type == "category-series-append")
-      parseCategorySeriesAppend(object);
-    else if (type == "stream-append")
-      parseStreamAppend(object);
-    else
-      std::cerr << "Unhandled Event type: " << type << '\n';
-  } break;
+  case Section::Events:
+    // Events are read directly into `rawEvent`
+    // and parsed by `parseEvent()`
+    std::cerr << "Event object passed to do_parse\n";
+    break;
   case Section::Links:
     parseP2PLink(object);
     break;
@@ -355,6 +652,8 @@ void JsonHandler::parseNode(const util::json::JsonObject &object) {
   parser::Node node;
 
   node.id = object["id"].get<unsigned int>();
+  if (!fileParser.filter.keepsNode(node.id))
+    return;
   node.name = object["name"].get<std::string>();
 
   // TODO: Compatability with v1.0.0, remove for v1.1.0
@@ -439,8 +738,42 @@ void JsonHandler::parseNode(const util::json::JsonObject &object) {
   else
     node.trailColor = node.baseColor.value_or(node.highlightColor.value_or(nextTrailColor(nextColorIndex)));
 
+  if (object.contains("light")) {
+    const auto &o = object["light"].object();
+    parser::NodeLight light;
+
+    if (o.contains("color"))
+      light.color = colorFromObject(o["color"].object());
+
+    if (o.contains("intensity"))
+      light.intensity = static_cast<float>(o["intensity"].get<double>());
+
+    if (o.contains("range"))
+      light.range = static_cast<float>(o["range"].get<double>());
+
+    if (o.contains("offset")) {
+      requiredFields(o["offset"].object(), {"x", "y", "z"});
+      light.offset.x = o["offset"].object()["x"].get<double>();
+      light.offset.y = o["offset"].object()["y"].get<double>();
+      light.offset.z = o["offset"].object()["z"].get<double>();
+    }
+
+    if (o.contains("direction")) {
+      requiredFields(o["direction"].object(), {"x", "y", "z"});
+      light.direction.x = o["direction"].object()["x"].get<double>();
+      light.direction.y = o["direction"].object()["y"].get<double>();
+      light.direction.z = o["direction"].object()["z"].get<double>();
+    }
+
+    if (o.contains("cone"))
+      light.cone = static_cast<float>(o["cone"].get<double>());
+
+    node.light = light;
+  }
+
   updateLocationBounds(node.position);
 
+  fileParser.foundModel(node.model);
   fileParser.nodes.emplace_back(node);
 }
 
@@ -529,6 +862,7 @@ void JsonHandler::parseDecoration(const util::json::JsonObject &object) {
     decoration.scale.fill(object["scale"].get<float>());
   }
 
+  fileParser.foundModel(decoration.model);
   fileParser.decorations.emplace_back(decoration);
 }
 
@@ -577,200 +911,191 @@ void JsonHandler::parseP2PLink(const util::json::JsonObject &object) {
   }
 
   for (const auto &nodeId : nodes) {
-    link.nodes.emplace_back(nodeId.get<unsigned int>());
+    const auto id = nodeId.get<unsigned int>();
+    if (!fileParser.filter.keepsNode(id))
+      return;
+    link.nodes.emplace_back(id);
   }
 
   fileParser.wiredLinks.emplace_back(link);
 }
 
-void JsonHandler::parseMoveEvent(const util::json::JsonObject &object) {
+void JsonHandler::parseMoveEvent(const parser::RawEvent &event) {
   // TODO: add "time" after 1.1.0
-  requiredFields(object, {"id", "x", "y", "z"});
-  parser::MoveEvent event;
+  requiredFields(event, {Field::Id, Field::X, Field::Y, Field::Z});
+  parser::MoveEvent move;
 
-  event.nodeId = object["id"].get<int>();
-  event.time = getTimeCompatible(object);
-  event.targetPosition.x = object["x"].get<double>();
-  event.targetPosition.y = object["y"].get<double>();
-  event.targetPosition.z = object["z"].get<double>();
+  move.nodeId = static_cast<uint32_t>(event.id);
+  move.time = getTimeCompatible(event);
+  move.targetPosition.x = static_cast<float>(event.x);
+  move.targetPosition.y = static_cast<float>(event.y);
+  move.targetPosition.z = static_cast<float>(event.z);
 
-  updateLocationBounds(event.targetPosition);
+  updateLocationBounds(move.targetPosition);
 
-  updateEndTime(event.time);
-  processEndTransmits(event.time);
-  fileParser.sceneEvents.emplace_back(event);
+  updateEndTime(move.time);
+  processEndTransmits(move.time);
+  fileParser.sceneEvents.emplace_back(move);
 }
 
-void JsonHandler::parseTransmitEvent(const util::json::JsonObject &object) {
+void JsonHandler::parseTransmitEvent(const parser::RawEvent &event) {
   // TODO: add "time" after 1.1.0
-  requiredFields(object, {"id", "duration", "target-size"});
-  parser::TransmitEvent event;
+  requiredFields(event, {Field::Id, Field::Duration, Field::TargetSize, Field::Color});
+  parser::TransmitEvent transmit;
 
-  event.nodeId = object["id"].get<int>();
-  event.time = getTimeCompatible(object);
-  event.duration = object["duration"].get<int_type>();
+  transmit.nodeId = static_cast<uint32_t>(event.id);
+  transmit.time = getTimeCompatible(event);
+  transmit.duration = event.duration;
 
   // TODO: compatibility with v1.0.0, remove for v1.1.0
   // Check to see if this object was specified in milliseconds,
   // or nanoseconds
-  if (object.contains("milliseconds"))
-    event.duration *= msToNsFactor;
+  if (event.has(Field::Milliseconds))
+    transmit.duration *= msToNsFactor;
 
-  event.targetSize = object["target-size"].get<double>();
-  event.color = colorFromObject(object["color"].object());
+  transmit.targetSize = event.targetSize;
+  transmit.color = colorFromEvent(event);
 
-  updateEndTime(event.time);
-  processEndTransmits(event.time);
+  updateEndTime(transmit.time);
+  processEndTransmits(transmit.time);
 
   // End any previous transmits by this Node
   // Even if they're incomplete
-  const auto &transmittingIter = transmittingNodes.find(event.nodeId);
-  if (transmittingIter != transmittingNodes.end() && transmittingIter->second.has_value()) {
-    parser::TransmitEndEvent endEvent;
-    endEvent.time = event.time;
-    endEvent.startEvent = transmittingIter->second.value();
-    fileParser.sceneEvents.emplace_back(endEvent);
-  }
-  transmittingNodes[event.nodeId] = event;
-  fileParser.sceneEvents.emplace_back(event);
+  if (trackTransmits)
+    transmitEnds.beginTransmit(transmit, fileParser.sceneEvents);
+
+  fileParser.sceneEvents.emplace_back(transmit);
 }
 
-void JsonHandler::parseDecorationMoveEvent(const util::json::JsonObject &object) {
+void JsonHandler::parseDecorationMoveEvent(const parser::RawEvent &event) {
   // TODO: "nanoseconds" field checked by `getTimeCompatible`, add here for 1.1.0+
-  requiredFields(object, {"id", "x", "y", "z"});
-  parser::DecorationMoveEvent event;
+  requiredFields(event, {Field::Id, Field::X, Field::Y, Field::Z});
+  parser::DecorationMoveEvent move;
 
-  event.decorationId = object["id"].get<int>();
-  event.time = getTimeCompatible(object);
-  event.targetPosition.x = object["x"].get<double>();
-  event.targetPosition.y = object["y"].get<double>();
-  event.targetPosition.z = object["z"].get<double>();
+  move.decorationId = static_cast<uint32_t>(event.id);
+  move.time = getTimeCompatible(event);
+  move.targetPosition.x = static_cast<float>(event.x);
+  move.targetPosition.y = static_cast<float>(event.y);
+  move.targetPosition.z = static_cast<float>(event.z);
 
-  updateLocationBounds(event.targetPosition);
+  updateLocationBounds(move.targetPosition);
 
-  updateEndTime(event.time);
-  processEndTransmits(event.time);
-  fileParser.sceneEvents.emplace_back(event);
+  updateEndTime(move.time);
+  processEndTransmits(move.time);
+  fileParser.sceneEvents.emplace_back(move);
 }
 
-void JsonHandler::parseNodeOrientationEvent(const util::json::JsonObject &object) {
+void JsonHandler::parseNodeOrientationEvent(const parser::RawEvent &event) {
   // TODO: "nanoseconds" field checked by `getTimeCompatible`, add here for 1.1.0+
-  requiredFields(object, {"id", "x", "y", "z"});
-  parser::NodeOrientationChangeEvent event;
-
-  event.nodeId = object["id"].get<int>();
-  event.time = getTimeCompatible(object);
-  event.targetOrientation[0] = object["x"].get<double>();
-  event.targetOrientation[1] = object["y"].get<double>();
-  event.targetOrientation[2] = object["z"].get<double>();
-
-  updateEndTime(event.time);
-  processEndTransmits(event.time);
-  fileParser.sceneEvents.emplace_back(event);
+  requiredFields(event, {Field::Id, Field::X, Field::Y, Field::Z});
+  parser::NodeOrientationChangeEvent orientation;
+
+  orientation.nodeId = static_cast<uint32_t>(event.id);
+  orientation.time = getTimeCompatible(event);
+  orientation.targetOrientation[0] = event.x;
+  orientation.targetOrientation[1] = event.y;
+  orientation.targetOrientation[2] = event.z;
+
+  updateEndTime(orientation.time);
+  processEndTransmits(orientation.time);
+  fileParser.sceneEvents.emplace_back(orientation);
 }
 
-void JsonHandler::parseDecorationOrientationEvent(const util::json::JsonObject &object) {
+void JsonHandler::parseDecorationOrientationEvent(const parser::RawEvent &event) {
   // TODO: "nanoseconds" field checked by `getTimeCompatible`, add here for 1.1.0+
-  requiredFields(object, {"id", "x", "y", "z"});
-  parser::DecorationOrientationChangeEvent event;
-
-  event.decorationId = object["id"].get<int>();
-  event.time = getTimeCompatible(object);
-  event.targetOrientation[0] = object["x"].get<double>();
-  event.targetOrientation[1] = object["y"].get<double>();
-  event.targetOrientation[2] = object["z"].get<double>();
-
-  updateEndTime(event.time);
-  processEndTransmits(event.time);
-  fileParser.sceneEvents.emplace_back(event);
+  requiredFields(event, {Field::Id, Field::X, Field::Y, Field::Z});
+  parser::DecorationOrientationChangeEvent orientation;
+
+  orientation.decorationId = static_cast<uint32_t>(event.id);
+  orientation.time = getTimeCompatible(event);
+  orientation.targetOrientation[0] = event.x;
+  orientation.targetOrientation[1] = event.y;
+  orientation.targetOrientation[2] = event.z;
+
+  updateEndTime(orientation.time);
+  processEndTransmits(orientation.time);
+  fileParser.sceneEvents.emplace_back(orientation);
 }
 
-void JsonHandler::parseNodeColorChangeEvent(const util::json::JsonObject &object) {
+void JsonHandler::parseNodeColorChangeEvent(const parser::RawEvent &event) {
   // TODO: "nanoseconds" field checked by `getTimeCompatible`, add here for 1.1.0+
-  requiredFields(object, {"id", "color-type"});
-  parser::NodeColorChangeEvent event;
+  requiredFields(event, {Field::Id, Field::ColorType});
+  parser::NodeColorChangeEvent colorChange;
 
-  event.nodeId = object["id"].get<unsigned int>();
-  event.time = getTimeCompatible(object);
+  colorChange.nodeId = static_cast<unsigned int>(event.id);
+  colorChange.time = getTimeCompatible(event);
 
-  auto type = object["color-type"].get<std::string>();
-  if (type == "base")
-    event.type = parser::NodeColorChangeEvent::ColorType::Base;
-  else if (type == "highlight")
-    event.type = parser::NodeColorChangeEvent::ColorType::Highlight;
+  if (event.unknownColorType.empty())
+    colorChange.type = event.colorType;
   else
-    std::cerr << "Error: unhandled 'color-type': \"" << type << "\" in `NodeColorChangeEvent`\n";
+    std::cerr << "Error: unhandled 'color-type': \"" << event.unknownColorType << "\" in `NodeColorChangeEvent`\n";
 
-  if (object.contains("color"))
-    event.targetColor = colorFromObject(object["color"].object());
+  if (event.has(Field::Color))
+    colorChange.targetColor = colorFromEvent(event);
 
-  updateEndTime(event.time);
-  processEndTransmits(event.time);
-  fileParser.sceneEvents.emplace_back(event);
+  updateEndTime(colorChange.time);
+  processEndTransmits(colorChange.time);
+  fileParser.sceneEvents.emplace_back(colorChange);
 }
 
-void JsonHandler::parseSeriesAppend(const util::json::JsonObject &object) {
+void JsonHandler::parseSeriesAppend(const parser::RawEvent &event) {
   // TODO: "nanoseconds" field checked by `getTimeCompatible`, add here for 1.1.0+
-  requiredFields(object, {"series-id", "x", "y"});
-  parser::XYSeriesAddValue event;
+  requiredFields(event, {Field::SeriesId, Field::X, Field::Y});
+  parser::XYSeriesAddValue append;
 
-  event.time = getTimeCompatible(object);
-  event.seriesId = object["series-id"].get<int>();
-  event.point.x = object["x"].get<double>();
-  event.point.y = object["y"].get<double>();
+  append.time = getTimeCompatible(event);
+  append.seriesId = static_cast<uint32_t>(event.seriesId);
+  append.point.x = event.x;
+  append.point.y = event.y;
 
-  updateEndTime(event.time);
-  fileParser.chartEvents.emplace_back(event);
+  updateEndTime(append.time);
+  fileParser.chartEvents.emplace_back(append);
 }
 
-void JsonHandler::parseSeriesAppendArray(const util::json::JsonObject &object) {
+void JsonHandler::parseSeriesAppendArray(parser::RawEvent &event) {
   // TODO: "nanoseconds" field checked by `getTimeCompatible`, add here for 1.1.0+
-  requiredFields(object, {"series-id", "points"});
-  parser::XYSeriesAddValues event;
-
-  event.time = getTimeCompatible(object);
-  event.seriesId = object["series-id"].get<int>();
+  requiredFields(event, {Field::SeriesId, Field::Points});
+  parser::XYSeriesAddValues append;
 
-  auto points = object["points"].array();
+  append.time = getTimeCompatible(event);
+  append.seriesId = static_cast<uint32_t>(event.seriesId);
 
   // Ignore events with empty point arrays
-  if (points.empty()) {
+  if (event.points.empty()) {
     std::cerr << "Ignoring empty `xy-series-append-array` event\n";
     return;
   }
 
-  for (const auto &point : points) {
-    event.points.emplace_back(parser::XYPoint{point.object()["x"].get<double>(), point.object()["y"].get<double>()});
-  }
+  append.points = xyPoints.add(event.points.data(), event.points.size());
 
-  updateEndTime(event.time);
-  fileParser.chartEvents.emplace_back(event);
+  updateEndTime(append.time);
+  fileParser.chartEvents.emplace_back(std::move(append));
 }
 
-void JsonHandler::parseSeriesClear(const util::json::JsonObject &object) {
+void JsonHandler::parseSeriesClear(const parser::RawEvent &event) {
   // TODO: "nanoseconds" field checked by `getTimeCompatible`, add here for 1.1.0+
-  requiredFields(object, {"series-id"});
-  parser::XYSeriesClear event;
+  requiredFields(event, {Field::SeriesId});
+  parser::XYSeriesClear clear;
 
-  event.time = getTimeCompatible(object);
-  event.seriesId = object["series-id"].get<int>();
+  clear.time = getTimeCompatible(event);
+  clear.seriesId = static_cast<uint32_t>(event.seriesId);
 
-  updateEndTime(event.time);
-  fileParser.chartEvents.emplace_back(event);
+  updateEndTime(clear.time);
+  fileParser.chartEvents.emplace_back(clear);
 }
 
-void JsonHandler::parseCategorySeriesAppend(const util::json::JsonObject &object) {
+void JsonHandler::parseCategorySeriesAppend(const parser::RawEvent &event) {
   // TODO: "nanoseconds" field checked by `getTimeCompatible`, add here for 1.1.0+
-  requiredFields(object, {"series-id", "category", "value"});
-  parser::CategorySeriesAddValue event;
+  requiredFields(event, {Field::SeriesId, Field::Category, Field::Value});
+  parser::CategorySeriesAddValue append;
 
-  event.time = getTimeCompatible(object);
-  event.seriesId = object["series-id"].get<int>();
-  event.category = object["category"].get<int>();
-  event.value = object["value"].get<double>();
+  append.time = getTimeCompatible(event);
+  append.seriesId = static_cast<uint32_t>(event.seriesId);
+  append.category = static_cast<unsigned int>(event.category);
+  append.value = event.value;
 
-  updateEndTime(event.time);
-  fileParser.chartEvents.emplace_back(event);
+  updateEndTime(append.time);
+  fileParser.chartEvents.emplace_back(append);
 }
 
 void JsonHandler::parseXYSeries(const util::json::JsonObject &object) {
@@ -778,6 +1103,8 @@ void JsonHandler::parseXYSeries(const util::json::JsonObject &object) {
   parser::XYSeries series;
 
   series.id = object["id"].get<int>();
+  if (!fileParser.filter.keepsSeries(series.id))
+    return;
   series.name = object["name"].get<std::string>();
 
   series.legend = object["legend"].get<std::string>();
@@ -814,6 +1141,8 @@ void JsonHandler::parseCategoryValueSeries(const util::json::JsonObject &object)
   parser::CategoryValueSeries series;
 
   series.id = object["id"].get<int>();
+  if (!fileParser.filter.keepsSeries(series.id))
+    return;
   series.name = object["name"].get<std::string>();
 
   series.legend = object["legend"].get<std::string>();
@@ -845,11 +1174,15 @@ void JsonHandler::parseSeriesCollection(const util::json::JsonObject &object) {
   requiredFields(object, {"id", "name", "child-series", "x-axis", "y-axis"});
   parser::SeriesCollection collection;
   collection.id = object["id"].get<int>();
+  if (!fileParser.filter.keepsSeries(collection.id))
+    return;
   collection.name = object["name"].get<std::string>();
 
   auto childSeries = object["child-series"];
   for (const auto &child : childSeries.array()) {
-    collection.series.emplace_back(child.get<int>());
+    const auto id = child.get<int>();
+    if (fileParser.filter.keepsSeries(id))
+      collection.series.emplace_back(id);
   }
 
   collection.xAxis = valueAxisFromObject(object["x-axis"].object());
@@ -861,6 +1194,8 @@ void JsonHandler::parseLogStream(const util::json::JsonObject &object) {
   requiredFields(object, {"id", "name", "visible"});
   parser::LogStream stream;
   stream.id = object["id"].get<int>();
+  if (!fileParser.filter.keepsStream(stream.id))
+    return;
   stream.name = object["name"].get<std::string>();
 
   if (object.contains("color"))
@@ -871,16 +1206,376 @@ void JsonHandler::parseLogStream(const util::json::JsonObject &object) {
   fileParser.logStreams.emplace_back(stream);
 }
 
-void JsonHandler::parseStreamAppend(const util::json::JsonObject &object) {
+void JsonHandler::parseStreamAppend(parser::RawEvent &event) {
   // TODO: "nanoseconds" field checked by `getTimeCompatible`, add here for 1.1.0+
-  requiredFields(object, {"stream-id", "data"});
-  parser::StreamAppendEvent event;
-  event.time = getTimeCompatible(object);
-  event.streamId = object["stream-id"].get<int>();
-  event.value = object["data"].get<std::string>();
+  requiredFields(event, {Field::StreamId, Field::Data});
+  parser::StreamAppendEvent append;
+  append.time = getTimeCompatible(event);
+  append.streamId = static_cast<unsigned int>(event.streamId);
+  append.value = std::move(event.data);
+
+  updateEndTime(append.time);
+  fileParser.logEvents.emplace_back(std::move(append));
+}
+
+bool JsonHandler::stopIfCancelled() {
+  if (!fileParser.cancelled())
+    return false;
+
+  fileParser.errorMessage = "Loading cancelled";
+  return true;
+}
+
+bool JsonHandler::keepsEvent() const {
+  using Type = parser::RawEvent::Type;
+  const auto &filter = fileParser.filter;
+
+  if (!filter.keepsType(rawEvent.type))
+    return false;
+
+  // Events missing their ID are left for their parse function to report
+  switch (rawEvent.type) {
+  case Type::NodePosition:
+  case Type::NodeOrientation:
+  case Type::NodeColor:
+  case Type::NodeTransmit:
+    return !rawEvent.has(Field::Id) || filter.keepsNode(static_cast<unsigned int>(rawEvent.id));
+  case Type::XYSeriesAppend:
+  case Type::XYSeriesAppendArray:
+  case Type::XYSeriesClear:
+  case Type::CategorySeriesAppend:
+    return !rawEvent.has(Field::SeriesId) || filter.keepsSeries(static_cast<unsigned int>(rawEvent.seriesId));
+  case Type::StreamAppend:
+    return !rawEvent.has(Field::StreamId) || filter.keepsStream(static_cast<unsigned int>(rawEvent.streamId));
+  default:
+    return true;
+  }
+}
+
+void JsonHandler::foldEvent() {
+  using Type = parser::RawEvent::Type;
+  const auto size = fileParser.sceneEvents.size();
+
+  switch (rawEvent.type) {
+  case Type::NodePosition:
+    parseMoveEvent(rawEvent);
+    break;
+  case Type::NodeOrientation:
+    parseNodeOrientationEvent(rawEvent);
+    break;
+  case Type::NodeColor:
+    parseNodeColorChangeEvent(rawEvent);
+    break;
+  case Type::DecorationPosition:
+    parseDecorationMoveEvent(rawEvent);
+    break;
+  case Type::DecorationOrientation:
+    parseDecorationOrientationEvent(rawEvent);
+    break;
+  default:
+    // Transmissions, and every chart & log event, only matter at their own time
+    return;
+  }
+
+  // Nothing is transmitting before the window, so nothing else was emplaced
+  if (fileParser.sceneEvents.size() == size)
+    return;
 
-  updateEndTime(event.time);
-  fileParser.logEvents.emplace_back(event);
+  // The same item & property only keeps its latest change. Base & highlight colors are separate
+  auto key = static_cast<uint64_t>(rawEvent.type) << 40u | static_cast<uint32_t>(rawEvent.id);
+  if (rawEvent.type == Type::NodeColor)
+    key |= static_cast<uint64_t>(rawEvent.colorType) << 32u;
+
+  auto &event = fileParser.sceneEvents.back();
+  if (const auto existing = foldedIndex.find(key); existing != foldedIndex.end())
+    folded[existing->second] = std::move(event);
+  else {
+    foldedIndex.emplace(key, folded.size());
+    folded.emplace_back(std::move(event));
+  }
+  fileParser.sceneEvents.pop_back();
+}
+
+void JsonHandler::flushFolded() {
+  if (folded.empty())
+    return;
+
+  const auto begin = fileParser.filter.begin.value();
+  for (auto &event : folded) {
+    std::visit(
+        [begin](auto &e) {
+          e.time = begin;
+        },
+        event);
+    fileParser.sceneEvents.emplace_back(std::move(event));
+  }
+
+  folded.clear();
+  foldedIndex.clear();
+  updateEndTime(begin);
+}
+
+void JsonHandler::parseEvent() {
+  using Type = parser::RawEvent::Type;
+
+  if (const auto &filter = fileParser.filter; filter.active() && rawEvent.type != Type::Unknown) {
+    if (!keepsEvent())
+      return;
+
+    const auto time = getTimeCompatible(rawEvent);
+    if (filter.end && time > filter.end.value())
+      return;
+    if (filter.begin && time < filter.begin.value()) {
+      foldEvent();
+      return;
+    }
+
+    // The state before the window comes first
+    flushFolded();
+  }
+
+  switch (rawEvent.type) {
+  case Type::NodePosition:
+    parseMoveEvent(rawEvent);
+    break;
+  case Type::NodeOrientation:
+    parseNodeOrientationEvent(rawEvent);
+    break;
+  case Type::NodeColor:
+    parseNodeColorChangeEvent(rawEvent);
+    break;
+  case Type::NodeTransmit:
+    parseTransmitEvent(rawEvent);
+    break;
+  case Type::DecorationPosition:
+    parseDecorationMoveEvent(rawEvent);
+    break;
+  case Type::DecorationOrientation:
+    parseDecorationOrientationEvent(rawEvent);
+    break;
+  case Type::XYSeriesAppend:
+    parseSeriesAppend(rawEvent);
+    break;
+  case Type::XYSeriesAppendArray:
+    parseSeriesAppendArray(rawEvent);
+    break;
+  case Type::XYSeriesClear:
+    parseSeriesClear(rawEvent);
+    break;
+  case Type::CategorySeriesAppend:
+    parseCategorySeriesAppend(rawEvent);
+    break;
+  case Type::StreamAppend:
+    parseStreamAppend(rawEvent);
+    break;
+  case Type::Unknown:
+    if (!rawEvent.has(Field::Type))
+      throw MissingRequiredFieldException{"type"};
+
+    std::cerr << "Unhandled Event type: " << rawEvent.unknownType << '\n';
+    break;
+  }
+}
+
+bool JsonHandler::isEventStart() const {
+  // Events are directly within the 'events' array, so the stack looks like:
+  // ----------------
+  // |    events    |
+  // ----------------
+  // |     root     |
+  // ----------------
+  return eventDepth == 0u && currentSection == Section::Events && jsonStack.size() == 2u &&
+         jsonStack.top().value.isArray();
+}
+
+void JsonHandler::eventNumber(long long integer, double real) {
+  if (eventDepth == 1u) {
+    switch (eventField) {
+    case Field::Milliseconds:
+      rawEvent.milliseconds = integer;
+      break;
+    case Field::Nanoseconds:
+      rawEvent.nanoseconds = integer;
+      break;
+    case Field::Id:
+      rawEvent.id = integer;
+      break;
+    case Field::SeriesId:
+      rawEvent.seriesId = integer;
+      break;
+    case Field::StreamId:
+      rawEvent.streamId = integer;
+      break;
+    case Field::X:
+      rawEvent.x = real;
+      break;
+    case Field::Y:
+      rawEvent.y = real;
+      break;
+    case Field::Z:
+      rawEvent.z = real;
+      break;
+    case Field::Duration:
+      rawEvent.duration = integer;
+      break;
+    case Field::TargetSize:
+      rawEvent.targetSize = real;
+      break;
+    case Field::Category:
+      rawEvent.category = integer;
+      break;
+    case Field::Value:
+      rawEvent.value = real;
+      break;
+    default:
+      break;
+    }
+    return;
+  }
+
+  // An element of 'color'
+  if (eventDepth == 2u && eventField == Field::Color) {
+    switch (eventSubField) {
+    case EventSubField::Red:
+      rawEvent.color.red = static_cast<uint8_t>(integer);
+      rawEvent.colorChannels |= 1u;
+      break;
+    case EventSubField::Green:
+      rawEvent.color.green = static_cast<uint8_t>(integer);
+      rawEvent.colorChannels |= 2u;
+      break;
+    case EventSubField::Blue:
+      rawEvent.color.blue = static_cast<uint8_t>(integer);
+      rawEvent.colorChannels |= 4u;
+      break;
+    default:
+      break;
+    }
+    return;
+  }
+
+  // A member of an object in the 'points' array
+  if (eventDepth == 3u && eventField == Field::Points) {
+    if (eventSubField == EventSubField::X) {
+      eventPoint.x = real;
+      eventPointAxes |= 1u;
+    } else if (eventSubField == EventSubField::Y) {
+      eventPoint.y = real;
+      eventPointAxes |= 2u;
+    }
+  }
+}
+
+void JsonHandler::eventString(std::string_view value) {
+  if (eventDepth != 1u)
+    return;
+
+  switch (eventField) {
+  case Field::Type:
+    rawEvent.type = eventTypeFromString(value);
+    if (rawEvent.type == parser::RawEvent::Type::Unknown)
+      rawEvent.unknownType = value;
+    break;
+  case Field::ColorType:
+    if (value == "base")
+      rawEvent.colorType = parser::NodeColorChangeEvent::ColorType::Base;
+    else if (value == "highlight")
+      rawEvent.colorType = parser::NodeColorChangeEvent::ColorType::Highlight;
+    else
+      rawEvent.unknownColorType = value;
+    break;
+  case Field::Data:
+    rawEvent.data.assign(value.data(), value.size());
+    break;
+  default:
+    break;
+  }
+}
+
+bool JsonHandler::scanEvent(const char *&position, const char *end) {
+  auto current = position;
+  if (current == end || *current != '{')
+    return true;
+
+  rawEvent.reset();
+  eventDepth = 1u;
+  auto read = false;
+
+  current = skipBlank(current + 1, end);
+  if (current != end && *current == '}') {
+    current++;
+    read = true;
+  }
+
+  while (!read) {
+    if (current == end || *current != '"')
+      break;
+
+    const auto keyBegin = current + 1;
+    const auto keyEnd = scanPlainString(keyBegin, end);
+    if (!keyEnd)
+      break;
+
+    eventField = fieldFromKey({keyBegin, static_cast<std::size_t>(keyEnd - keyBegin)});
+    rawEvent.set(eventField);
+
+    current = skipBlank(keyEnd + 1, end);
+    if (current == end || *current != ':')
+      break;
+    current = skipBlank(current + 1, end);
+    if (current == end)
+      break;
+
+    if (*current == '"') {
+      const auto valueBegin = current + 1;
+      const auto valueEnd = scanPlainString(valueBegin, end);
+      if (!valueEnd)
+        break;
+
+      eventString({valueBegin, static_cast<std::size_t>(valueEnd - valueBegin)});
+      current = valueEnd + 1;
+    } else {
+      long long integer;
+      double real;
+      const auto numberEnd = scanNumber(current, end, integer, real);
+      if (!numberEnd)
+        break;
+
+      eventNumber(integer, real);
+      current = numberEnd;
+    }
+
+    current = skipBlank(current, end);
+    if (current != end && *current == ',') {
+      current = skipBlank(current + 1, end);
+      continue;
+    }
+
+    if (current != end && *current == '}') {
+      current++;
+      read = true;
+    }
+    break;
+  }
+
+  eventDepth = 0u;
+
+  // Left for RapidJSON, which starts the event over
+  if (!read)
+    return true;
+
+  if (stopIfCancelled())
+    return false;
+
+  position = current;
+  try {
+    parseEvent();
+  } catch (const MissingRequiredFieldException &e) {
+    fileParser.errorMessage = e.what();
+    return false;
+  }
+  forward();
+  return true;
 }
 
 void JsonHandler::updateLocationBounds(const parser::Ns3Coordinate &coordinate) {
@@ -907,69 +1602,132 @@ void JsonHandler::updateEndTime(parser::nanoseconds time) {
     fileParser.globalConfiguration.endTime = time;
 }
 
+void JsonHandler::forward() {
+  if (fileParser.sink)
+    fileParser.forward();
+}
+
 void JsonHandler::processEndTransmits(parser::nanoseconds time) {
-  for (auto &[nodeId, transmitEvent] : transmittingNodes) {
-    if (!transmitEvent.has_value())
-      return;
+  if (trackTransmits)
+    transmitEnds.endTransmits(time, fileParser.sceneEvents);
+}
 
-    const auto endTransmitTime = transmitEvent.value().time + transmitEvent.value().duration;
-    if (time < endTransmitTime)
-      return;
+JsonHandler::JsonHandler(parser::FileParser &parser) : fileParser(parser) {
+}
 
-    parser::TransmitEndEvent endEvent;
-    endEvent.time = time;
-    endEvent.startEvent = transmitEvent.value();
-    endEvent.nodeId = endEvent.startEvent.nodeId;
-    fileParser.sceneEvents.emplace_back(endEvent);
+std::pmr::memory_resource *JsonHandler::resourceAt(std::size_t depth) {
+  // root -> section -> item
+  return depth > 2u ? &arena : std::pmr::get_default_resource();
+}
 
-    transmitEvent.reset();
-  }
+parser::RawEvent::Type JsonHandler::eventType(std::string_view type) {
+  return eventTypeFromString(type);
 }
 
-JsonHandler::JsonHandler(parser::FileParser &parser) : fileParser(parser) {
+JsonHandler::JsonHandler(parser::FileParser &parser, EventsOnly) : fileParser(parser), trackTransmits(false) {
+  // Pretend we're already inside the 'events' key,
+  // so the array becomes that section
+  jsonStack.push({"root", util::json::JsonObject()});
+  jsonStack.push({"events", {}});
+  currentSection = Section::Events;
 }
 
 bool JsonHandler::Null() {
+  if (eventDepth > 0u)
+    return true;
+
   handle(nullptr);
   return true;
 }
 
 bool JsonHandler::Bool(bool value) {
+  if (eventDepth > 0u)
+    return true;
+
   handle(value);
   return true;
 }
 
 bool JsonHandler::Int(int value) {
+  if (eventDepth > 0u) {
+    eventNumber(value, value);
+    return true;
+  }
+
   handle(value);
   return true;
 }
 
 bool JsonHandler::Uint(unsigned int value) {
+  if (eventDepth > 0u) {
+    eventNumber(value, value);
+    return true;
+  }
+
   handle(value);
   return true;
 }
 
 bool JsonHandler::Int64(std::int64_t value) {
+  if (eventDepth > 0u) {
+    eventNumber(value, static_cast<double>(value));
+    return true;
+  }
+
   handle(value);
   return true;
 }
 
 bool JsonHandler::Uint64(std::uint64_t value) {
+  if (eventDepth > 0u) {
+    eventNumber(static_cast<long long>(value), static_cast<double>(value));
+    return true;
+  }
+
   handle(value);
   return true;
 }
 
 bool JsonHandler::Double(double value) {
+  if (eventDepth > 0u) {
+    eventNumber(static_cast<long long>(value), value);
+    return true;
+  }
+
   handle(value);
   return true;
 }
 
 bool JsonHandler::String(const char *value, rapidjson::SizeType length, bool) {
+  if (eventDepth > 0u) {
+    eventString({value, length});
+    return true;
+  }
+
   handle(std::string(value, length));
   return true;
 }
 
 bool JsonHandler::StartObject() {
+  if (eventDepth > 0u) {
+    eventDepth++;
+
+    // Start of an element in 'points'
+    if (eventDepth == 3u && eventField == Field::Points) {
+      eventPoint = {0.0, 0.0};
+      eventPointAxes = 0u;
+    }
+    return true;
+  }
+
+  // Events skip the JSON stack entirely
+  if (isEventStart()) {
+    rawEvent.reset();
+    eventField = Field::Unknown;
+    eventDepth = 1u;
+    return true;
+  }
+
   // Root object case
   if (jsonStack.empty()) {
     jsonStack.push({"root", util::json::JsonObject()});
@@ -980,21 +1738,55 @@ bool JsonHandler::StartObject() {
 
   // Do not overwrite existing values
   if (top.value.isArray()) {
-    jsonStack.push({"", util::json::JsonObject()});
+    // Start of the next item in a section, the previous one has been parsed,
+    // and nothing refers to its values anymore
+    if (jsonStack.size() == 2u && isSection(top.key) != Section::None)
+      arena.release();
+
+    jsonStack.push({"", util::json::JsonObject{resourceAt(jsonStack.size() + 1u)}});
     return true;
   }
 
-  top.value = util::json::JsonObject();
+  top.value = util::json::JsonObject{resourceAt(jsonStack.size())};
   return true;
 }
 
 bool JsonHandler::EndObject(rapidjson::SizeType) {
+  if (eventDepth > 1u) {
+    // End of an element in 'points'
+    if (eventDepth == 3u && eventField == Field::Points) {
+      if (eventPointAxes != 3u) {
+        fileParser.errorMessage = "Missing required field: " + std::string{(eventPointAxes & 1u) ? "y" : "x"};
+        return false;
+      }
+      rawEvent.points.emplace_back(eventPoint);
+    }
+
+    eventDepth--;
+    return true;
+  }
+
+  if (eventDepth == 1u) {
+    eventDepth = 0u;
+    if (stopIfCancelled())
+      return false;
+
+    try {
+      parseEvent();
+    } catch (const MissingRequiredFieldException &e) {
+      fileParser.errorMessage = e.what();
+      return false;
+    }
+    forward();
+    return true;
+  }
+
   // TODO: Error
   if (jsonStack.empty()) {
     return false;
   }
 
-  auto oldTop = jsonStack.top();
+  auto oldTop = std::move(jsonStack.top());
   jsonStack.pop();
 
   if (jsonStack.empty()) {
@@ -1018,6 +1810,8 @@ bool JsonHandler::EndObject(rapidjson::SizeType) {
         return true;
       } else if (oldTop.key == "configuration") {
         parseConfiguration(oldTop.value.object());
+        if (fileParser.sink)
+          fileParser.sink->configure(fileParser.globalConfiguration);
         return true;
       }
       return false;
@@ -1026,6 +1820,7 @@ bool JsonHandler::EndObject(rapidjson::SizeType) {
     // All other sections have one parse call per item
     if (isSection(jsonStack.top().key) != Section::None) {
       do_parse(currentSection, oldTop.value.object());
+      forward();
       return true;
     }
   } catch (const MissingRequiredFieldException &e) {
@@ -1033,13 +1828,17 @@ bool JsonHandler::EndObject(rapidjson::SizeType) {
     return false;
   }
 
+  // Nothing reads the root object, and unknown sections may refer to `arena`
+  if (jsonStack.size() == 1u)
+    return true;
+
   if (currentTop.value.isArray()) {
-    currentTop.value.array().emplace_back(oldTop.value);
+    currentTop.value.array().emplace_back(std::move(oldTop.value));
     return true;
   }
 
   if (currentTop.value.isObject()) {
-    currentTop.value.object().insert(oldTop.key, oldTop.value);
+    currentTop.value.object().insert(oldTop.key, std::move(oldTop.value));
     return true;
   }
 
@@ -1049,23 +1848,41 @@ bool JsonHandler::EndObject(rapidjson::SizeType) {
 }
 
 bool JsonHandler::StartArray() {
+  if (eventDepth > 0u) {
+    eventDepth++;
+    return true;
+  }
+
   if (jsonStack.empty()) {
     return false;
   }
 
-  jsonStack.top().value = util::json::JsonArray();
+  jsonStack.top().value = util::json::JsonArray(resourceAt(jsonStack.size()));
   return true;
 }
 
 bool JsonHandler::EndArray(rapidjson::SizeType) {
-  auto oldTop = jsonStack.top();
+  if (eventDepth > 0u) {
+    eventDepth--;
+    return true;
+  }
+
+  // A window with no events still starts from the state before it
+  if (isEventStart())
+    flushFolded();
+
+  auto oldTop = std::move(jsonStack.top());
   jsonStack.pop();
 
+  // Nothing reads the root object, and unknown sections may refer to `arena`
+  if (jsonStack.size() == 1u)
+    return true;
+
   auto &currentTop = jsonStack.top();
   if (currentTop.value.isObject())
-    currentTop.value.object().insert(oldTop.key, oldTop.value);
+    currentTop.value.object().insert(oldTop.key, std::move(oldTop.value));
   else if (currentTop.value.isArray())
-    currentTop.value.array().emplace_back(oldTop.value);
+    currentTop.value.array().emplace_back(std::move(oldTop.value));
   else {
     std::cerr << currentTop.key << " is not of a root type\n";
     std::abort();
@@ -1075,6 +1892,41 @@ bool JsonHandler::EndArray(rapidjson::SizeType) {
 }
 
 bool JsonHandler::Key(const char *value, rapidjson::SizeType length, bool) {
+  if (eventDepth == 1u) {
+    eventField = fieldFromKey({value, length});
+    rawEvent.set(eventField);
+    return true;
+  }
+
+  if (eventDepth > 1u) {
+    const std::string_view key{value, length};
+    const auto confirm = [key](std::string_view known, EventSubField field) {
+      return confirmKey(key, known, field, EventSubField::Unknown);
+    };
+
+    switch (keyHash(key)) {
+    case keyHash("x"):
+      eventSubField = confirm("x", EventSubField::X);
+      break;
+    case keyHash("y"):
+      eventSubField = confirm("y", EventSubField::Y);
+      break;
+    case keyHash("red"):
+      eventSubField = confirm("red", EventSubField::Red);
+      break;
+    case keyHash("green"):
+      eventSubField = confirm("green", EventSubField::Green);
+      break;
+    case keyHash("blue"):
+      eventSubField = confirm("blue", EventSubField::Blue);
+      break;
+    default:
+      eventSubField = EventSubField::Unknown;
+      break;
+    }
+    return true;
+  }
+
   jsonStack.push({std::string(value, length)});
 
   // Only Check for sections for keys immediately
@@ -1090,6 +1942,8 @@ bool JsonHandler::Key(const char *value, rapidjson::SizeType length, bool) {
   auto possibleSection = isSection(value);
   if (possibleSection != Section::None) {
     currentSection = possibleSection;
+    sectionTrace.reset();
+    sectionTrace.emplace(traceName(possibleSection), "parse");
   }
   return true;
 }
@@ -33,16 +33,22 @@
 
 #pragma once
 #include "../file-parser.h"
+#include "../trace.h"
 #include "Json.h"
+#include "RawEvent.h"
+#include "TransmitEndTracker.h"
 #include "model.h"
 #include <cassert>
+#include <cstdint>
 #include <fstream>
 #include <iostream>
 #include <memory>
+#include <memory_resource>
 #include <optional>
 #include <rapidjson/reader.h>
 #include <stack>
 #include <string>
+#include <string_view>
 #include <unordered_map>
 #include <vector>
 
@@ -53,7 +59,18 @@ class JsonHandler : public rapidjson::BaseReaderHandler<rapidjson::UTF8<>, JsonH
   enum class Section { None, Areas, Buildings, Configuration, Decorations, Events, Links, Nodes, Series, Streams };
 
   parser::FileParser &fileParser;
-  std::unordered_map<unsigned int, std::optional<parser::TransmitEvent>> transmittingNodes;
+
+  /**
+   * Inserts the `TransmitEndEvent`s for each transmission
+   */
+  parser::TransmitEndTracker transmitEnds;
+
+  /**
+   * Flag indicating `TransmitEndEvent`s should be inserted while parsing.
+   * Unset when only part of the 'events' section is being parsed,
+   * since the tracker must see every scene event in order
+   */
+  bool trackTransmits = true;
 
   // TODO: Compatability with v1.0.0, remove for v1.1.0
   /**
@@ -73,11 +90,22 @@ class JsonHandler : public rapidjson::BaseReaderHandler<rapidjson::UTF8<>, JsonH
    */
   static constexpr Section isSection(std::string_view key);
 
+  /**
+   * The name of `section` in a trace, see `sectionTrace`
+   */
+  static const char *traceName(Section section);
+
   /**
    * The current section we're in the document.
    */
   Section currentSection = Section::None;
 
+  /**
+   * Spans the current section, while tracing.
+   * Each section ends when the next begins, or the handler is destroyed
+   */
+  std::optional<parser::trace::Scope> sectionTrace;
+
   /**
    * A frame for the JSON stack
    */
@@ -86,11 +114,140 @@ class JsonHandler : public rapidjson::BaseReaderHandler<rapidjson::UTF8<>, JsonH
     util::json::JsonValue value;
   };
 
+  /**
+   * Backs the objects & arrays read inside a section item, such as a single Node.
+   * Released at the start of the next item, once the previous one has been parsed,
+   * so the temporaries of each item reuse the same memory.
+   *
+   * Declared before `jsonStack` so it outlives any values left on the stack
+   */
+  std::pmr::monotonic_buffer_resource arena{64u * 1024u};
+
   /**
    * Stack representing a JSON object
    */
   std::stack<JsonFrame> jsonStack;
 
+  /**
+   * Select the resource for a new object or array
+   *
+   * @param depth
+   * The size `jsonStack` will have with the frame holding the new value on top
+   *
+   * @return
+   * `arena` for values inside a section item,
+   * the default resource for the root & the sections themselves,
+   * which outlive a single item
+   */
+  [[nodiscard]] std::pmr::memory_resource *resourceAt(std::size_t depth);
+
+  /**
+   * Keys for values nested within an event object.
+   * 'red', 'green', 'blue' for 'color' and 'x', 'y' for elements of 'points'
+   */
+  enum class EventSubField { Unknown, Red, Green, Blue, X, Y };
+
+  /**
+   * The event currently being read from the 'events' section.
+   * Events are read directly into this, rather than through `jsonStack`
+   */
+  parser::RawEvent rawEvent;
+
+  /**
+   * Holds the points of every 'xy-series-append-array' event,
+   * so `rawEvent` keeps its points for the next event
+   */
+  parser::XYPointArena xyPoints;
+
+  /**
+   * Nesting depth of objects & arrays inside the current event.
+   * 0 when not reading an event, 1 while directly in the event object
+   */
+  unsigned int eventDepth = 0u;
+
+  /**
+   * The last key read directly in the current event object
+   */
+  parser::RawEvent::Field eventField = parser::RawEvent::Field::Unknown;
+
+  /**
+   * The last key read in an object nested within the current event
+   */
+  EventSubField eventSubField = EventSubField::Unknown;
+
+  /**
+   * The element of 'points' currently being read
+   */
+  parser::XYPoint eventPoint{0.0, 0.0};
+
+  /**
+   * Bitmask of the axes provided for `eventPoint`.
+   * x = 1, y = 2
+   */
+  uint8_t eventPointAxes = 0u;
+
+  /**
+   * Store a number read while inside an event
+   *
+   * @param integer
+   * The value, for fields which store integers
+   *
+   * @param real
+   * The value, for fields which store floating point values
+   */
+  void eventNumber(long long integer, double real);
+
+  /**
+   * Store a string read while inside an event
+   *
+   * @param value
+   * The string read by the parser
+   */
+  void eventString(std::string_view value);
+
+  /**
+   * Create the model for `rawEvent` & emplace it,
+   * unless it is filtered out, see `parser::ParseFilter`
+   */
+  void parseEvent();
+
+  /**
+   * The latest scene event for each Node & Decoration property before the filtered window,
+   * in the order they were first changed. See `parser::ParseFilter::begin`
+   */
+  std::vector<parser::SceneEvent> folded;
+
+  /**
+   * Index in `folded` of the event for each item & property, see `foldEvent()`
+   */
+  std::unordered_map<uint64_t, std::size_t> foldedIndex;
+
+  /**
+   * @return
+   * True if `rawEvent` is of a type, and for an item, kept by the filter
+   */
+  [[nodiscard]] bool keepsEvent() const;
+
+  /**
+   * Check the parser's cancellation before an event is added,
+   * see `FileParser::setCancellation()`
+   *
+   * @return
+   * True, with the error message set, if the parse should stop
+   */
+  bool stopIfCancelled();
+
+  /**
+   * Keep `rawEvent` as the latest state of its item before the filtered window,
+   * replacing the previous one, or drop it if it is not part of the state of the scene
+   */
+  void foldEvent();
+
+  /**
+   * Emplace the events in `folded`, at the beginning of the filtered window
+   */
+  void flushFolded();
+
   /**
    * Handle a given single value for a key.
    *
@@ -109,14 +266,14 @@ class JsonHandler : public rapidjson::BaseReaderHandler<rapidjson::UTF8<>, JsonH
     // Special case, array of primitives
     // ex: [1, 2, 3]
     if (jsonStack.top().value.isArray()) {
-      jsonStack.top().value.array().emplace_back(value);
+      jsonStack.top().value.array().emplace_back(std::forward<T>(value));
       return;
     }
 
-    // Copy the old top, since we're about to clear it
+    // Take the old top, since we're about to clear it
     // should contain just a key
     // since `handle()` is for primitives
-    auto oldTop = jsonStack.top();
+    auto oldTop = std::move(jsonStack.top());
 
     if (!oldTop.value.isNull()) {
       std::cerr << oldTop.key << '\n';
@@ -127,7 +284,7 @@ class JsonHandler : public rapidjson::BaseReaderHandler<rapidjson::UTF8<>, JsonH
     auto &currentTop = jsonStack.top();
 
     if (currentTop.value.isObject()) {
-      currentTop.value.object().insert(oldTop.key, value);
+      currentTop.value.object().insert(oldTop.key, util::json::JsonValue{std::forward<T>(value)});
       return;
     }
 
@@ -197,81 +354,83 @@ class JsonHandler : public rapidjson::BaseReaderHandler<rapidjson::UTF8<>, JsonH
   /**
    * Parse and emplace a move event
    *
-   * @param object
-   * The object from the 'events' section with the 'node-position' type
+   * @param event
+   * The fields of an object from the 'events' section with the 'node-position' type
    */
-  void parseMoveEvent(const util::json::JsonObject &object);
+  void parseMoveEvent(const parser::RawEvent &event);
 
   /**
    * Parse and emplace a transmit event
    *
-   * @param object
-   * The object from the 'events' section with the 'node-transmit' type
+   * @param event
+   * The fields of an object from the 'events' section with the 'node-transmit' type
    */
-  void parseTransmitEvent(const util::json::JsonObject &object);
+  void parseTransmitEvent(const parser::RawEvent &event);
 
   /**
    * Parse and emplace a DecorationMoveEvent
    *
-   * @param object
-   * The object from the 'events' section with the 'decoration-position' type
+   * @param event
+   * The fields of an object from the 'events' section with the 'decoration-position' type
    */
-  void parseDecorationMoveEvent(const util::json::JsonObject &object);
+  void parseDecorationMoveEvent(const parser::RawEvent &event);
 
   /**
    * Parse and emplace a NodeOrientationEvent
    *
-   * @param object
-   * The object from the 'events' section with the 'node-orientation' type
+   * @param event
+   * The fields of an object from the 'events' section with the 'node-orientation' type
    */
-  void parseNodeOrientationEvent(const util::json::JsonObject &object);
+  void parseNodeOrientationEvent(const parser::RawEvent &event);
 
   /**
    * Parse and emplace a DecorationOrientationEvent
    *
-   * @param object
-   * The object from the 'events' section with the 'decoration-position' type
+   * @param event
+   * The fields of an object from the 'events' section with the 'decoration-orientation' type
    */
-  void parseDecorationOrientationEvent(const util::json::JsonObject &object);
+  void parseDecorationOrientationEvent(const parser::RawEvent &event);
 
   /**
    * Parse and emplace a NodeColorChange event
    *
-   * @param object
+   * @param event
+   * The fields of an object from the 'events' section with the 'node-color' type
    */
-  void parseNodeColorChangeEvent(const util::json::JsonObject &object);
+  void parseNodeColorChangeEvent(const parser::RawEvent &event);
 
   /**
    * Parse and emplace a series append event
    *
-   * @param object
-   * The object from the 'events' section with the 'xy-series-append' type
+   * @param event
+   * The fields of an object from the 'events' section with the 'xy-series-append' type
    */
-  void parseSeriesAppend(const util::json::JsonObject &object);
+  void parseSeriesAppend(const parser::RawEvent &event);
 
   /**
    * Parse and emplace a series append event with multiple points
    *
-   * @param object
-   * The object from the 'events' section with the 'xy-series-append-array' type
+   * @param event
+   * The fields of an object from the 'events' section with the 'xy-series-append-array' type.
+   * The points are moved out of `event`
    */
-  void parseSeriesAppendArray(const util::json::JsonObject &object);
+  void parseSeriesAppendArray(parser::RawEvent &event);
 
   /**
    * Parse and emplace a series clear event
    *
-   * @param object
-   * The object from the 'events' section with the 'xy-series-clear' type
+   * @param event
+   * The fields of an object from the 'events' section with the 'xy-series-clear' type
    */
-  void parseSeriesClear(const util::json::JsonObject &object);
+  void parseSeriesClear(const parser::RawEvent &event);
 
   /**
    * Parse and emplace a category value append event
    *
-   * @param object
-   * The object from the 'events' section with the 'category-series-append' type
+   * @param event
+   * The fields of an object from the 'events' section with the 'category-series-append' type
    */
-  void parseCategorySeriesAppend(const util::json::JsonObject &object);
+  void parseCategorySeriesAppend(const parser::RawEvent &event);
 
   /**
    * Parse and emplace a linear series
@@ -308,10 +467,11 @@ class JsonHandler : public rapidjson::BaseReaderHandler<rapidjson::UTF8<>, JsonH
   /**
    * Parse and emplace a stream append event
    *
-   * @param object
-   * The object from the 'events' section with the 'stream-append' type
+   * @param event
+   * The fields of an object from the 'events' section with the 'stream-append' type.
+   * The data is moved out of `event`
    */
-  void parseStreamAppend(const util::json::JsonObject &object);
+  void parseStreamAppend(parser::RawEvent &event);
 
   /**
    * Check the min/max bounds against `coordinate` and update accordingly
@@ -335,6 +495,8 @@ class JsonHandler : public rapidjson::BaseReaderHandler<rapidjson::UTF8<>, JsonH
    * and insert `TransmitEndEvent`s for those
    * that are done transmitting before `milliseconds`.
    *
+   * Does nothing if `trackTransmits` is unset.
+   *
    * Potentially modifies `fileParser.sceneEvents`
    *
    * Should be called while processing each scene event,
@@ -345,9 +507,72 @@ class JsonHandler : public rapidjson::BaseReaderHandler<rapidjson::UTF8<>, JsonH
    */
   void processEndTransmits(parser::nanoseconds time);
 
+  /**
+   * Pass the models & events parsed so far on to the sink of `fileParser`, if it has one.
+   * Called after each item, so nothing accumulates while parsing into a sink
+   */
+  void forward();
+
 public:
+  /**
+   * Tag type selecting the constructor for parsing a bare array of events
+   */
+  struct EventsOnly {};
+
   explicit JsonHandler(parser::FileParser &parser);
 
+  /**
+   * Setup a handler which parses a single array of event objects,
+   * as if it were the 'events' section of a full document.
+   *
+   * `TransmitEndEvent`s are not inserted, since the array
+   * may only be part of the 'events' section.
+   *
+   * @param parser
+   * The parser to emplace each event into
+   */
+  JsonHandler(parser::FileParser &parser, EventsOnly);
+
+  /**
+   * @param type
+   * The 'type' of an event, as it appears in the file (e.g. 'node-position')
+   *
+   * @return
+   * The type of event, or `RawEvent::Type::Unknown` if it is not a known type
+   */
+  static parser::RawEvent::Type eventType(std::string_view type);
+
+  /**
+   * Read a flat event object directly from memory, without RapidJSON.
+   *
+   * Only objects whose values are all numbers or strings without escapes
+   * are read, which covers the common events (e.g. 'node-position').
+   * Anything else is left for RapidJSON, which reads the same events the same way.
+   * Must be called between the objects of the 'events' section
+   *
+   * @param position
+   * The position of the opening brace of the object.
+   * Moved past the closing brace if the object was read,
+   * unchanged otherwise
+   *
+   * @param end
+   * One past the last character which may be read
+   *
+   * @return
+   * False if the object was read, but is not a valid event,
+   * or the parse was cancelled, see `FileParser::errorMessage`. True otherwise
+   */
+  bool scanEvent(const char *&position, const char *end);
+
+  /**
+   * Checks if the object about to be started is an event
+   * directly within the 'events' section
+   *
+   * @return
+   * True if the next object should be read as an event
+   */
+  [[nodiscard]] bool isEventStart() const;
+
   // Note: do not make the below functions `virtual`
   // or mark them with `override
 #pragma clang diagnostic push
@@ -0,0 +1,166 @@
+/*
+ * NIST-developed software is provided by NIST as a public service. You may use,
+ * copy and distribute copies of the software in any medium, provided that you
+ * keep intact this entire notice. You may improve,modify and create derivative
+ * works of the software or any portion of the software, and you may copy and
+ * distribute such modifications or works. Modified works should carry a notice
+ * stating that you changed the software and should note the date and nature of
+ * any such change. Please explicitly acknowledge the National Institute of
+ * Standards and Technology as the source of the software.
+ *
+ * NIST-developed software is expressly provided "AS IS." NIST MAKES NO
+ * WARRANTY OF ANY KIND, EXPRESS, IMPLIED, IN FACT OR ARISING BY OPERATION OF
+ * LAW, INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTY OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, NON-INFRINGEMENT
+ * AND DATA ACCURACY. NIST NEITHER REPRESENTS NOR WARRANTS THAT THE
+ * OPERATION OF THE SOFTWARE WILL BE UNINTERRUPTED OR ERROR-FREE, OR THAT
+ * ANY DEFECTS WILL BE CORRECTED. NIST DOES NOT WARRANT OR MAKE ANY
+ * REPRESENTATIONS REGARDING THE USE OF THE SOFTWARE OR THE RESULTS THEREOF,
+ * INCLUDING BUT NOT LIMITED TO THE CORRECTNESS, ACCURACY, RELIABILITY,
+ * OR USEFULNESS OF THE SOFTWARE.
+ *
+ * You are solely responsible for determining the appropriateness of using and
+ * distributing the software and you assume all risks associated with its use,
+ * including but not limited to the risks and costs of program errors,
+ * compliance with applicable laws, damage to or loss of data, programs or
+ * equipment, and the unavailability or interruption of operation. This
+ * software is not intended to be used in any situation where a failure could
+ * cause risk of injury or damage to property. The software developed by NIST
+ * employees is not subject to copyright protection within the United States.
+ *
+ * Author: Evan Black <evan.black@nist.gov>
+ */
+#pragma once
+#include "model.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace parser {
+
+/**
+ * The fields of a single object from the 'events' section,
+ * filled directly from the SAX callbacks, without building a JSON object first.
+ *
+ * One instance is reused for every event, so `reset()`
+ * keeps the capacity of `data` & `points`.
+ */
+struct RawEvent {
+  /**
+   * Every event type from the 'type' field
+   */
+  enum class Type : uint8_t {
+    Unknown,
+    NodePosition,
+    NodeOrientation,
+    NodeColor,
+    NodeTransmit,
+    DecorationPosition,
+    DecorationOrientation,
+    XYSeriesAppend,
+    XYSeriesAppendArray,
+    XYSeriesClear,
+    CategorySeriesAppend,
+    StreamAppend
+  };
+
+  /**
+   * Every field read from an event.
+   * Fields not listed here are ignored
+   */
+  enum class Field : uint8_t {
+    Type,
+    Milliseconds,
+    Nanoseconds,
+    Id,
+    SeriesId,
+    StreamId,
+    X,
+    Y,
+    Z,
+    Duration,
+    TargetSize,
+    Color,
+    ColorType,
+    Category,
+    Value,
+    Data,
+    Points,
+    Unknown
+  };
+
+  /**
+   * Bitmask of the `Field`s present in the object
+   */
+  uint32_t present = 0u;
+
+  Type type = Type::Unknown;
+
+  /**
+   * The unrecognised 'type' value, only set when `type` is `Type::Unknown`
+   */
+  std::string unknownType;
+
+  long long milliseconds = 0LL;
+  long long nanoseconds = 0LL;
+  long long duration = 0LL;
+
+  long long id = 0LL;
+  long long seriesId = 0LL;
+  long long streamId = 0LL;
+  long long category = 0LL;
+
+  double x = 0.0;
+  double y = 0.0;
+  double z = 0.0;
+  double targetSize = 0.0;
+  double value = 0.0;
+
+  Ns3Color3 color;
+
+  /**
+   * Bitmask of which channels were provided for 'color'.
+   * red = 1, green = 2, blue = 4
+   */
+  uint8_t colorChannels = 0u;
+
+  NodeColorChangeEvent::ColorType colorType = NodeColorChangeEvent::ColorType::Base;
+
+  /**
+   * The unrecognised 'color-type', if any
+   */
+  std::string unknownColorType;
+
+  std::string data;
+
+  std::vector<XYPoint> points;
+
+  /**
+   * Prepare for the next event, keeping any allocated capacity
+   */
+  void reset() {
+    present = 0u;
+    type = Type::Unknown;
+    colorChannels = 0u;
+    unknownType.clear();
+    unknownColorType.clear();
+    data.clear();
+    points.clear();
+  }
+
+  /**
+   * Mark `field` as present in the event
+   */
+  void set(Field field) {
+    present |= 1u << static_cast<uint8_t>(field);
+  }
+
+  /**
+   * Check if `field` was present in the event
+   */
+  [[nodiscard]] bool has(Field field) const {
+    return present & (1u << static_cast<uint8_t>(field));
+  }
+};
+
+} // namespace parser
@@ -0,0 +1,123 @@
+/*
+ * NIST-developed software is provided by NIST as a public service. You may use,
+ * copy and distribute copies of the software in any medium, provided that you
+ * keep intact this entire notice. You may improve,modify and create derivative
+ * works of the software or any portion of the software, and you may copy and
+ * distribute such modifications or works. Modified works should carry a notice
+ * stating that you changed the software and should note the date and nature of
+ * any such change. Please explicitly acknowledge the National Institute of
+ * Standards and Technology as the source of the software.
+ *
+ * NIST-developed software is expressly provided "AS IS." NIST MAKES NO
+ * WARRANTY OF ANY KIND, EXPRESS, IMPLIED, IN FACT OR ARISING BY OPERATION OF
+ * LAW, INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTY OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, NON-INFRINGEMENT
+ * AND DATA ACCURACY. NIST NEITHER REPRESENTS NOR WARRANTS THAT THE
+ * OPERATION OF THE SOFTWARE WILL BE UNINTERRUPTED OR ERROR-FREE, OR THAT
+ * ANY DEFECTS WILL BE CORRECTED. NIST DOES NOT WARRANT OR MAKE ANY
+ * REPRESENTATIONS REGARDING THE USE OF THE SOFTWARE OR THE RESULTS THEREOF,
+ * INCLUDING BUT NOT LIMITED TO THE CORRECTNESS, ACCURACY, RELIABILITY,
+ * OR USEFULNESS OF THE SOFTWARE.
+ *
+ * You are solely responsible for determining the appropriateness of using and
+ * distributing the software and you assume all risks associated with its use,
+ * including but not limited to the risks and costs of program errors,
+ * compliance with applicable laws, damage to or loss of data, programs or
+ * equipment, and the unavailability or interruption of operation. This
+ * software is not intended to be used in any situation where a failure could
+ * cause risk of injury or damage to property. The software developed by NIST
+ * employees is not subject to copyright protection within the United States.
+ *
+ * Author: Evan Black <evan.black@nist.gov>
+ */
+#pragma once
+#include "../model.h"
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <queue>
+#include <unordered_map>
+#include <vector>
+
+namespace parser {
+
+/**
+ * Tracks transmitting Nodes while events are read in order,
+ * and inserts the `TransmitEndEvent`s which are not present in the
+ * output file.
+ */
+class TransmitEndTracker {
+  struct Transmission {
+    TransmitEvent event;
+
+    /**
+     * Matches the `Ending` queued for this transmission
+     */
+    std::uint64_t serial{0u};
+  };
+
+  /**
+   * When a transmission is due to end
+   */
+  struct Ending {
+    nanoseconds time{0LL};
+    unsigned int nodeId{0u};
+    std::uint64_t serial{0u};
+
+    bool operator>(const Ending &other) const {
+      return time > other.time;
+    }
+  };
+
+  /**
+   * The last transmission started by each Node.
+   * Unset once that transmission has ended
+   */
+  std::unordered_map<unsigned int, std::optional<Transmission>> transmittingNodes;
+
+  /**
+   * The end of every started transmission, earliest first.
+   * Transmissions ended early by a new one from the same Node are left in,
+   * and skipped once popped, since their serial no longer matches
+   */
+  std::priority_queue<Ending, std::vector<Ending>, std::greater<>> endings;
+
+  /**
+   * Serial of the next transmission started
+   */
+  std::uint64_t nextSerial{0u};
+
+public:
+  /**
+   * Insert `TransmitEndEvent`s for the transmissions
+   * which are done by `time`, each at the time it ended.
+   *
+   * Should be called while processing each scene event,
+   * but before appending the event.
+   *
+   * @param time
+   * The time of the current event being processed.
+   *
+   * @param events
+   * The collection to append any `TransmitEndEvent`s to,
+   * in time order
+   */
+  void endTransmits(nanoseconds time, std::vector<SceneEvent> &events);
+
+  /**
+   * Mark the Node from `event` as transmitting, ending any previous
+   * transmission by that Node, even if it is incomplete.
+   *
+   * Should be called after `endTransmits()`, but before appending `event`
+   *
+   * @param event
+   * The transmission being started
+   *
+   * @param events
+   * The collection to append the `TransmitEndEvent`
+   * for a previous transmission to
+   */
+  void beginTransmit(const TransmitEvent &event, std::vector<SceneEvent> &events);
+};
+
+} // namespace parser
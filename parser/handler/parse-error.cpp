@@ -0,0 +1,79 @@
+/*
+ * NIST-developed software is provided by NIST as a public service. You may use,
+ * copy and distribute copies of the software in any medium, provided that you
+ * keep intact this entire notice. You may improve,modify and create derivative
+ * works of the software or any portion of the software, and you may copy and
+ * distribute such modifications or works. Modified works should carry a notice
+ * stating that you changed the software and should note the date and nature of
+ * any such change. Please explicitly acknowledge the National Institute of
+ * Standards and Technology as the source of the software.
+ *
+ * NIST-developed software is expressly provided "AS IS." NIST MAKES NO
+ * WARRANTY OF ANY KIND, EXPRESS, IMPLIED, IN FACT OR ARISING BY OPERATION OF
+ * LAW, INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTY OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, NON-INFRINGEMENT
+ * AND DATA ACCURACY. NIST NEITHER REPRESENTS NOR WARRANTS THAT THE
+ * OPERATION OF THE SOFTWARE WILL BE UNINTERRUPTED OR ERROR-FREE, OR THAT
+ * ANY DEFECTS WILL BE CORRECTED. NIST DOES NOT WARRANT OR MAKE ANY
+ * REPRESENTATIONS REGARDING THE USE OF THE SOFTWARE OR THE RESULTS THEREOF,
+ * INCLUDING BUT NOT LIMITED TO THE CORRECTNESS, ACCURACY, RELIABILITY,
+ * OR USEFULNESS OF THE SOFTWARE.
+ *
+ * You are solely responsible for determining the appropriateness of using and
+ * distributing the software and you assume all risks associated with its use,
+ * including but not limited to the risks and costs of program errors,
+ * compliance with applicable laws, damage to or loss of data, programs or
+ * equipment, and the unavailability or interruption of operation. This
+ * software is not intended to be used in any situation where a failure could
+ * cause risk of injury or damage to property. The software developed by NIST
+ * employees is not subject to copyright protection within the United States.
+ *
+ * Author: Evan Black <evan.black@nist.gov>
+ */
+#include "parse-error.h"
+
+namespace parser {
+
+std::string describeParseError(rapidjson::ParseErrorCode code, const std::optional<std::string> &handlerMessage) {
+  switch (code) {
+    // Error from the `JsonHandler`
+  case rapidjson::kParseErrorTermination:
+    return handlerMessage.value_or("Unknown parsing error");
+    // Generic Errors
+  case rapidjson::kParseErrorDocumentEmpty:
+    return "Document empty";
+  case rapidjson::kParseErrorDocumentRootNotSingular:
+    return "More than one root element";
+  case rapidjson::kParseErrorValueInvalid:
+    return "Invalid value";
+  case rapidjson::kParseErrorObjectMissName:
+    return "Object member missing name";
+  case rapidjson::kParseErrorObjectMissColon:
+    return "Object property missing colon";
+  case rapidjson::kParseErrorObjectMissCommaOrCurlyBracket:
+    return "Missing comma or curly brace after object member";
+  case rapidjson::kParseErrorArrayMissCommaOrSquareBracket:
+    return "Missing comma or curly brace after array element";
+  case rapidjson::kParseErrorStringUnicodeEscapeInvalidHex:
+    return "Invalid Unicode escape sequence";
+  case rapidjson::kParseErrorStringUnicodeSurrogateInvalid:
+    return "Invalid Unicode surrogate pair";
+  case rapidjson::kParseErrorStringEscapeInvalid:
+    return "Invalid character escape sequence";
+  case rapidjson::kParseErrorStringMissQuotationMark:
+    return "Missing string quotation mark";
+  case rapidjson::kParseErrorStringInvalidEncoding:
+    return "Invalid string encoding";
+  case rapidjson::kParseErrorNumberTooBig:
+    return "Number too large to be stored in a double";
+  case rapidjson::kParseErrorNumberMissFraction:
+    return "Number missing fraction component";
+  case rapidjson::kParseErrorNumberMissExponent:
+    return "Number missing exponent component";
+  case rapidjson::kParseErrorUnspecificSyntaxError:
+  default:
+    return "Unspecific syntax error";
+  }
+}
+
+} // namespace parser
@@ -0,0 +1,341 @@
+/*
+ * NIST-developed software is provided by NIST as a public service. You may use,
+ * copy and distribute copies of the software in any medium, provided that you
+ * keep intact this entire notice. You may improve,modify and create derivative
+ * works of the software or any portion of the software, and you may copy and
+ * distribute such modifications or works. Modified works should carry a notice
+ * stating that you changed the software and should note the date and nature of
+ * any such change. Please explicitly acknowledge the National Institute of
+ * Standards and Technology as the source of the software.
+ *
+ * NIST-developed software is expressly provided "AS IS." NIST MAKES NO
+ * WARRANTY OF ANY KIND, EXPRESS, IMPLIED, IN FACT OR ARISING BY OPERATION OF
+ * LAW, INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTY OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, NON-INFRINGEMENT
+ * AND DATA ACCURACY. NIST NEITHER REPRESENTS NOR WARRANTS THAT THE
+ * OPERATION OF THE SOFTWARE WILL BE UNINTERRUPTED OR ERROR-FREE, OR THAT
+ * ANY DEFECTS WILL BE CORRECTED. NIST DOES NOT WARRANT OR MAKE ANY
+ * REPRESENTATIONS REGARDING THE USE OF THE SOFTWARE OR THE RESULTS THEREOF,
+ * INCLUDING BUT NOT LIMITED TO THE CORRECTNESS, ACCURACY, RELIABILITY,
+ * OR USEFULNESS OF THE SOFTWARE.
+ *
+ * You are solely responsible for determining the appropriateness of using and
+ * distributing the software and you assume all risks associated with its use,
+ * including but not limited to the risks and costs of program errors,
+ * compliance with applicable laws, damage to or loss of data, programs or
+ * equipment, and the unavailability or interruption of operation. This
+ * software is not intended to be used in any situation where a failure could
+ * cause risk of injury or damage to property. The software developed by NIST
+ * employees is not subject to copyright protection within the United States.
+ *
+ * Author: Evan Black <evan.black@nist.gov>
+ */
+
+#include "ingest-socket.h"
+#include <cerrno>
+#include <cstring>
+#include <utility>
+
+#ifndef _WIN32
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+namespace parser {
+
+IngestSocket::~IngestSocket() {
+  close();
+}
+
+#ifdef _WIN32
+
+void IngestSocket::close() {
+}
+
+std::optional<std::string> IngestSocket::listen(const std::string & /* address */) {
+  return "Streaming scenarios is not supported on Windows";
+}
+
+bool IngestSocket::accept(const std::atomic<bool> & /* stop */) {
+  return false;
+}
+
+std::optional<std::string> IngestSocket::connect(const std::string & /* address */) {
+  return "Connecting to another viewer is not supported on Windows";
+}
+
+std::optional<std::size_t> IngestSocket::read(char * /* buffer */, std::size_t /* size */,
+                                              std::chrono::milliseconds /* timeout */) {
+  return {};
+}
+
+bool IngestSocket::write(const char * /* data */, std::size_t /* size */) {
+  return false;
+}
+
+#else
+
+namespace {
+
+/**
+ * The host & port of a TCP address, see `IngestSocket::listen()`
+ */
+std::pair<std::string, std::string> splitTcpAddress(std::string address) {
+  const std::string tcpPrefix{"tcp:"};
+  if (address.compare(0u, tcpPrefix.size(), tcpPrefix) == 0)
+    address.erase(0u, tcpPrefix.size());
+
+  std::string host{"localhost"};
+  auto port = address;
+  if (const auto colon = address.rfind(':'); colon != std::string::npos) {
+    host = address.substr(0u, colon);
+    port = address.substr(colon + 1u);
+  }
+  return {host, port};
+}
+
+/**
+ * Send small writes, such as commands & acknowledgements, at once, rather than waiting to fill a packet.
+ * Fails harmlessly for Unix sockets
+ */
+void disableNagle(int socket) {
+  const int noDelay = 1;
+  ::setsockopt(socket, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+}
+
+} // namespace
+
+void IngestSocket::close() {
+  if (connection != -1)
+    ::close(connection);
+  if (listener != -1)
+    ::close(listener);
+  connection = -1;
+  listener = -1;
+
+  if (!unixPath.empty())
+    ::unlink(unixPath.c_str());
+  unixPath.clear();
+}
+
+std::optional<std::string> IngestSocket::listen(const std::string &address) {
+  close();
+
+  const std::string unixPrefix{"unix:"};
+  if (address.compare(0u, unixPrefix.size(), unixPrefix) == 0) {
+    sockaddr_un local{};
+    local.sun_family = AF_UNIX;
+
+    const auto path = address.substr(unixPrefix.size());
+    if (path.empty() || path.size() >= sizeof(local.sun_path))
+      return "Invalid Unix socket path: " + path;
+    std::memcpy(local.sun_path, path.c_str(), path.size() + 1u);
+
+    listener = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listener == -1)
+      return std::string{"Failed to create socket: "} + std::strerror(errno);
+
+    // Left over from an earlier run
+    ::unlink(path.c_str());
+    if (::bind(listener, reinterpret_cast<sockaddr *>(&local), sizeof(local)) == -1) {
+      const auto error = errno;
+      close();
+      return "Failed to bind " + path + ": " + std::strerror(error);
+    }
+    unixPath = path;
+  } else {
+    const auto [host, port] = splitTcpAddress(address);
+    if (port.empty())
+      return "No port given in: " + address;
+
+    addrinfo hints{};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags = AI_PASSIVE;
+
+    addrinfo *found = nullptr;
+    if (const auto status = ::getaddrinfo(host.empty() ? nullptr : host.c_str(), port.c_str(), &hints, &found);
+        status != 0)
+      return "Failed to resolve " + address + ": " + ::gai_strerror(status);
+
+    std::string error{"No addresses for " + address};
+    for (auto candidate = found; candidate; candidate = candidate->ai_next) {
+      listener = ::socket(candidate->ai_family, candidate->ai_socktype, candidate->ai_protocol);
+      if (listener == -1)
+        continue;
+
+      // Allow listening again right after a previous run
+      const int reuse = 1;
+      ::setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+      if (::bind(listener, candidate->ai_addr, candidate->ai_addrlen) == 0)
+        break;
+
+      error = "Failed to bind " + address + ": " + std::strerror(errno);
+      ::close(listener);
+      listener = -1;
+    }
+    ::freeaddrinfo(found);
+
+    if (listener == -1)
+      return error;
+  }
+
+  if (::listen(listener, 1) == -1) {
+    const auto error = errno;
+    close();
+    return std::string{"Failed to listen: "} + std::strerror(error);
+  }
+
+  return {};
+}
+
+bool IngestSocket::accept(const std::atomic<bool> &stop) {
+  if (listener == -1)
+    return false;
+
+  // Poll, rather than block, so `stop` is seen
+  pollfd waiting{listener, POLLIN, 0};
+  while (!stop) {
+    const auto ready = ::poll(&waiting, 1u, 250);
+    if (ready == -1 && errno != EINTR)
+      return false;
+    if (ready <= 0)
+      continue;
+
+    connection = ::accept(listener, nullptr, nullptr);
+    if (connection == -1)
+      return false;
+
+#ifdef SO_NOSIGPIPE
+    // No `MSG_NOSIGNAL` on macOS, see `write()`
+    const int noSignal = 1;
+    ::setsockopt(connection, SOL_SOCKET, SO_NOSIGPIPE, &noSignal, sizeof(noSignal));
+#endif
+    disableNagle(connection);
+
+    // Nothing else may connect
+    ::close(listener);
+    listener = -1;
+    return true;
+  }
+
+  return false;
+}
+
+std::optional<std::string> IngestSocket::connect(const std::string &address) {
+  close();
+
+  const std::string unixPrefix{"unix:"};
+  if (address.compare(0u, unixPrefix.size(), unixPrefix) == 0) {
+    sockaddr_un remote{};
+    remote.sun_family = AF_UNIX;
+
+    const auto path = address.substr(unixPrefix.size());
+    if (path.empty() || path.size() >= sizeof(remote.sun_path))
+      return "Invalid Unix socket path: " + path;
+    std::memcpy(remote.sun_path, path.c_str(), path.size() + 1u);
+
+    connection = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (connection == -1)
+      return std::string{"Failed to create socket: "} + std::strerror(errno);
+
+    if (::connect(connection, reinterpret_cast<sockaddr *>(&remote), sizeof(remote)) == -1) {
+      const auto error = errno;
+      close();
+      return "Failed to connect to " + path + ": " + std::strerror(error);
+    }
+  } else {
+    const auto [host, port] = splitTcpAddress(address);
+    if (port.empty())
+      return "No port given in: " + address;
+
+    addrinfo hints{};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+
+    addrinfo *found = nullptr;
+    if (const auto status = ::getaddrinfo(host.empty() ? nullptr : host.c_str(), port.c_str(), &hints, &found);
+        status != 0)
+      return "Failed to resolve " + address + ": " + ::gai_strerror(status);
+
+    std::string error{"No addresses for " + address};
+    for (auto candidate = found; candidate; candidate = candidate->ai_next) {
+      connection = ::socket(candidate->ai_family, candidate->ai_socktype, candidate->ai_protocol);
+      if (connection == -1)
+        continue;
+
+      if (::connect(connection, candidate->ai_addr, candidate->ai_addrlen) == 0)
+        break;
+
+      error = "Failed to connect to " + address + ": " + std::strerror(errno);
+      ::close(connection);
+      connection = -1;
+    }
+    ::freeaddrinfo(found);
+
+    if (connection == -1)
+      return error;
+    disableNagle(connection);
+  }
+
+#ifdef SO_NOSIGPIPE
+  const int noSignal = 1;
+  ::setsockopt(connection, SOL_SOCKET, SO_NOSIGPIPE, &noSignal, sizeof(noSignal));
+#endif
+  return {};
+}
+
+std::optional<std::size_t> IngestSocket::read(char *buffer, std::size_t size, std::chrono::milliseconds timeout) {
+  if (connection == -1)
+    return {};
+
+  pollfd waiting{connection, POLLIN, 0};
+  const auto ready = ::poll(&waiting, 1u, static_cast<int>(timeout.count()));
+  if (ready == 0 || (ready == -1 && errno == EINTR))
+    return 0u;
+  if (ready == -1)
+    return {};
+
+  const auto received = ::recv(connection, buffer, size, 0);
+  if (received == -1 && (errno == EINTR || errno == EAGAIN))
+    return 0u;
+  if (received <= 0)
+    return {};
+
+  return static_cast<std::size_t>(received);
+}
+
+bool IngestSocket::write(const char *data, std::size_t size) {
+  if (connection == -1)
+    return false;
+
+#ifdef MSG_NOSIGNAL
+  // A closed peer is reported as an error, rather than with SIGPIPE
+  constexpr int flags = MSG_NOSIGNAL;
+#else
+  constexpr int flags = 0;
+#endif
+
+  while (size > 0u) {
+    const auto sent = ::send(connection, data, size, flags);
+    if (sent == -1 && errno == EINTR)
+      continue;
+    if (sent <= 0)
+      return false;
+
+    data += sent;
+    size -= static_cast<std::size_t>(sent);
+  }
+
+  return true;
+}
+
+#endif
+
+} // namespace parser
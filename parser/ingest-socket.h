@@ -0,0 +1,153 @@
+/*
+ * NIST-developed software is provided by NIST as a public service. You may use,
+ * copy and distribute copies of the software in any medium, provided that you
+ * keep intact this entire notice. You may improve,modify and create derivative
+ * works of the software or any portion of the software, and you may copy and
+ * distribute such modifications or works. Modified works should carry a notice
+ * stating that you changed the software and should note the date and nature of
+ * any such change. Please explicitly acknowledge the National Institute of
+ * Standards and Technology as the source of the software.
+ *
+ * NIST-developed software is expressly provided "AS IS." NIST MAKES NO
+ * WARRANTY OF ANY KIND, EXPRESS, IMPLIED, IN FACT OR ARISING BY OPERATION OF
+ * LAW, INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTY OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, NON-INFRINGEMENT
+ * AND DATA ACCURACY. NIST NEITHER REPRESENTS NOR WARRANTS THAT THE
+ * OPERATION OF THE SOFTWARE WILL BE UNINTERRUPTED OR ERROR-FREE, OR THAT
+ * ANY DEFECTS WILL BE CORRECTED. NIST DOES NOT WARRANT OR MAKE ANY
+ * REPRESENTATIONS REGARDING THE USE OF THE SOFTWARE OR THE RESULTS THEREOF,
+ * INCLUDING BUT NOT LIMITED TO THE CORRECTNESS, ACCURACY, RELIABILITY,
+ * OR USEFULNESS OF THE SOFTWARE.
+ *
+ * You are solely responsible for determining the appropriateness of using and
+ * distributing the software and you assume all risks associated with its use,
+ * including but not limited to the risks and costs of program errors,
+ * compliance with applicable laws, damage to or loss of data, programs or
+ * equipment, and the unavailability or interruption of operation. This
+ * software is not intended to be used in any situation where a failure could
+ * cause risk of injury or damage to property. The software developed by NIST
+ * employees is not subject to copyright protection within the United States.
+ *
+ * Author: Evan Black <evan.black@nist.gov>
+ */
+
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <optional>
+#include <string>
+
+namespace parser {
+
+/**
+ * A listening socket a running simulation streams its scenario to, as JSON,
+ * so the scenario never needs to be written to disk.
+ * Only one connection is accepted.
+ *
+ * The socket is only read as fast as the scenario is parsed,
+ * so a simulation sending faster than it is loaded
+ * is held back by the socket's flow control.
+ *
+ * The render server also serves its one client through it, see `write()`,
+ * and the leader of a video wall reaches each of its render nodes with `connect()`.
+ *
+ * Unavailable on Windows
+ */
+class IngestSocket {
+  int listener = -1;
+  int connection = -1;
+
+  /**
+   * The path of a Unix socket, which is removed once closed.
+   * Empty for TCP
+   */
+  std::string unixPath;
+
+  /**
+   * Close the listener & connection, if open
+   */
+  void close();
+
+public:
+  IngestSocket() = default;
+  IngestSocket(const IngestSocket &other) = delete;
+  ~IngestSocket();
+
+  IngestSocket &operator=(const IngestSocket &other) = delete;
+
+  /**
+   * Start listening for a simulation
+   *
+   * @param address
+   * 'unix:' followed by the path of a Unix socket to create,
+   * or a TCP port, optionally preceded by 'tcp:' and a host to bind to, and a colon
+   * (e.g. 'unix:/tmp/scenario.sock', '9100', or 'tcp:localhost:9100').
+   * TCP without a host only binds to the local machine, and an empty host (e.g. 'tcp::9100') binds every interface
+   *
+   * @return
+   * A description of the error, if the socket could not be opened,
+   * an unset optional otherwise
+   */
+  std::optional<std::string> listen(const std::string &address);
+
+  /**
+   * Wait for a simulation to connect
+   *
+   * @param stop
+   * Set from any thread to stop waiting
+   *
+   * @return
+   * True if a simulation connected, false if `stop` was set, or accepting failed
+   */
+  bool accept(const std::atomic<bool> &stop);
+
+  /**
+   * Connect to a socket listening elsewhere, rather than listening,
+   * replacing any listener or connection
+   *
+   * @param address
+   * The same forms as `listen()`. TCP without a host connects to the local machine
+   *
+   * @return
+   * A description of the error, if the connection could not be made,
+   * an unset optional otherwise
+   */
+  std::optional<std::string> connect(const std::string &address);
+
+  /**
+   * Read what the simulation has sent
+   *
+   * @param buffer
+   * Where to put the bytes read
+   *
+   * @param size
+   * The most bytes to read
+   *
+   * @param timeout
+   * The longest to wait for any bytes
+   *
+   * @return
+   * The number of bytes read, 0 if none arrived before `timeout`,
+   * or an unset optional once the connection is closed
+   */
+  std::optional<std::size_t> read(char *buffer, std::size_t size, std::chrono::milliseconds timeout);
+
+  /**
+   * Send bytes back over the connection.
+   * Blocks until every byte is sent, so a slow peer holds back the caller.
+   * May be called on one thread while another calls `read()`
+   *
+   * @param data
+   * The bytes to send
+   *
+   * @param size
+   * The number of bytes in `data`
+   *
+   * @return
+   * True if every byte was sent, false if the connection is closed
+   */
+  bool write(const char *data, std::size_t size);
+};
+
+} // namespace parser
@@ -0,0 +1,638 @@
+/*
+ * NIST-developed software is provided by NIST as a public service. You may use,
+ * copy and distribute copies of the software in any medium, provided that you
+ * keep intact this entire notice. You may improve,modify and create derivative
+ * works of the software or any portion of the software, and you may copy and
+ * distribute such modifications or works. Modified works should carry a notice
+ * stating that you changed the software and should note the date and nature of
+ * any such change. Please explicitly acknowledge the National Institute of
+ * Standards and Technology as the source of the software.
+ *
+ * NIST-developed software is expressly provided "AS IS." NIST MAKES NO
+ * WARRANTY OF ANY KIND, EXPRESS, IMPLIED, IN FACT OR ARISING BY OPERATION OF
+ * LAW, INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTY OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, NON-INFRINGEMENT
+ * AND DATA ACCURACY. NIST NEITHER REPRESENTS NOR WARRANTS THAT THE
+ * OPERATION OF THE SOFTWARE WILL BE UNINTERRUPTED OR ERROR-FREE, OR THAT
+ * ANY DEFECTS WILL BE CORRECTED. NIST DOES NOT WARRANT OR MAKE ANY
+ * REPRESENTATIONS REGARDING THE USE OF THE SOFTWARE OR THE RESULTS THEREOF,
+ * INCLUDING BUT NOT LIMITED TO THE CORRECTNESS, ACCURACY, RELIABILITY,
+ * OR USEFULNESS OF THE SOFTWARE.
+ *
+ * You are solely responsible for determining the appropriateness of using and
+ * distributing the software and you assume all risks associated with its use,
+ * including but not limited to the risks and costs of program errors,
+ * compliance with applicable laws, damage to or loss of data, programs or
+ * equipment, and the unavailability or interruption of operation. This
+ * software is not intended to be used in any situation where a failure could
+ * cause risk of injury or damage to property. The software developed by NIST
+ * employees is not subject to copyright protection within the United States.
+ *
+ * Author: Evan Black <evan.black@nist.gov>
+ */
+
+#include "json-writer.h"
+#include <climits>
+#include <iostream>
+#include <type_traits>
+#include <variant>
+
+namespace {
+
+using namespace parser;
+
+/**
+ * Output is written to the file in blocks of at least this many bytes
+ */
+constexpr std::size_t flushSize = 1024u * 1024u;
+
+using JsonOut = CheckedJsonWriter;
+
+void writeKey(JsonOut &writer, const char *key) {
+  writer.Key(key);
+}
+
+void writeString(JsonOut &writer, const std::string &value) {
+  writer.String(value.data(), static_cast<rapidjson::SizeType>(value.size()));
+}
+
+void writeColor(JsonOut &writer, const char *key, const Ns3Color3 &color) {
+  writeKey(writer, key);
+  writer.StartObject();
+  writeKey(writer, "red");
+  writer.Uint(color.red);
+  writeKey(writer, "green");
+  writer.Uint(color.green);
+  writeKey(writer, "blue");
+  writer.Uint(color.blue);
+  writer.EndObject();
+}
+
+template <class T>
+void writeXYZ(JsonOut &writer, const char *key, T x, T y, T z) {
+  writeKey(writer, key);
+  writer.StartObject();
+  writeKey(writer, "x");
+  writer.Double(x);
+  writeKey(writer, "y");
+  writer.Double(y);
+  writeKey(writer, "z");
+  writer.Double(z);
+  writer.EndObject();
+}
+
+void writeCoordinate(JsonOut &writer, const char *key, const Ns3Coordinate &coordinate) {
+  writeXYZ(writer, key, coordinate.x, coordinate.y, coordinate.z);
+}
+
+void writeTargetScale(JsonOut &writer, bool keepRatio, const std::optional<float> &height,
+                      const std::optional<float> &width, const std::optional<float> &depth) {
+  writeKey(writer, "target-scale");
+  writer.StartObject();
+  writeKey(writer, "keep-ratio");
+  writer.Bool(keepRatio);
+  if (height) {
+    writeKey(writer, "height");
+    writer.Double(*height);
+  }
+  if (width) {
+    writeKey(writer, "width");
+    writer.Double(*width);
+  }
+  if (depth) {
+    writeKey(writer, "depth");
+    writer.Double(*depth);
+  }
+  writer.EndObject();
+}
+
+void writeValueAxis(JsonOut &writer, const char *key, const ValueAxis &axis) {
+  writeKey(writer, key);
+  writer.StartObject();
+  writeKey(writer, "name");
+  writeString(writer, axis.name);
+  writeKey(writer, "scale");
+  writer.String(axis.scale == ValueAxis::Scale::Linear ? "linear" : "logarithmic");
+  writeKey(writer, "bound-mode");
+  writer.String(axis.boundMode == ValueAxis::BoundMode::Fixed ? "fixed" : "highest value");
+  writeKey(writer, "min");
+  writer.Double(axis.min);
+  writeKey(writer, "max");
+  writer.Double(axis.max);
+  writer.EndObject();
+}
+
+/**
+ * Start an event object with its type & time
+ */
+void startEvent(JsonOut &writer, const char *type, nanoseconds time) {
+  writer.StartObject();
+  writeKey(writer, "type");
+  writer.String(type);
+  writeKey(writer, "nanoseconds");
+  writer.Int64(time);
+}
+
+void writeId(JsonOut &writer, const char *key, unsigned int id) {
+  writeKey(writer, key);
+  writer.Uint(id);
+}
+
+const char *drawModeString(Area::DrawMode mode) {
+  return mode == Area::DrawMode::Solid ? "solid" : "hidden";
+}
+
+template <class Variant>
+nanoseconds timeOf(const Variant &event) {
+  return std::visit(
+      [](const auto &e) {
+        return e.time;
+      },
+      event);
+}
+
+} // namespace
+
+namespace parser {
+
+std::optional<ParseError> JsonWriter::open(const char *path) {
+  file.reset(std::fopen(path, "wb"));
+  if (!file) {
+    std::cerr << "Failed to open file for writing: " << path << '\n';
+    return {ParseError{"Failed to open file for writing", 0u}};
+  }
+
+  return {};
+}
+
+void JsonWriter::flush(std::size_t minimum) {
+  if (buffer.GetSize() < minimum || buffer.GetSize() == 0u)
+    return;
+
+  if (std::fwrite(buffer.GetString(), buffer.GetSize(), 1u, file.get()) != 1u)
+    failed = true;
+  else
+    written += buffer.GetSize();
+
+  buffer.Clear();
+}
+
+void JsonWriter::writeSections(const FileParser &parser) {
+  started = true;
+  writer.StartObject();
+
+  const auto &config = parser.getConfiguration();
+  writeKey(writer, "configuration");
+  writer.StartObject();
+  writeKey(writer, "module-version");
+  writer.StartObject();
+  writeKey(writer, "major");
+  writer.Int64(config.moduleVersion.major);
+  writeKey(writer, "minor");
+  writer.Int64(config.moduleVersion.minor);
+  writeKey(writer, "patch");
+  writer.Int64(config.moduleVersion.patch);
+  if (!config.moduleVersion.suffix.empty()) {
+    writeKey(writer, "suffix");
+    writeString(writer, config.moduleVersion.suffix);
+  }
+  writer.EndObject();
+  writeKey(writer, "max-time");
+  writer.Int64(config.endTime);
+  if (config.timeStep) {
+    writeKey(writer, "time-step");
+    writer.StartObject();
+    writeKey(writer, "increment");
+    writer.Int64(*config.timeStep);
+    // Files without a granularity used millisecond steps
+    writeKey(writer, "granularity");
+    writeString(writer, config.granularity.value_or("milliseconds"));
+    writer.EndObject();
+  }
+  writer.EndObject();
+
+  writeKey(writer, "nodes");
+  writer.StartArray();
+  for (const auto &node : parser.getNodes()) {
+    writer.StartObject();
+    writeId(writer, "id", node.id);
+    writeKey(writer, "name");
+    writeString(writer, node.name);
+    writeKey(writer, "label-enabled");
+    writer.Bool(node.labelEnabled);
+    writeKey(writer, "model");
+    writeString(writer, node.model);
+    writeXYZ(writer, "scale", node.scale[0], node.scale[1], node.scale[2]);
+    writeTargetScale(writer, node.keepRatio, node.height, node.width, node.depth);
+    writeXYZ(writer, "orientation", node.orientation[0], node.orientation[1], node.orientation[2]);
+    writeKey(writer, "visible");
+    writer.Bool(node.visible);
+    writeCoordinate(writer, "position", node.position);
+    writeCoordinate(writer, "offset", node.offset);
+    if (node.baseColor)
+      writeColor(writer, "base-color", *node.baseColor);
+    if (node.highlightColor)
+      writeColor(writer, "highlight-color", *node.highlightColor);
+    writeKey(writer, "trail-enabled");
+    writer.Bool(node.trailEnabled);
+    writeColor(writer, "trail-color", node.trailColor);
+    if (node.light) {
+      const auto &light = *node.light;
+      writeKey(writer, "light");
+      writer.StartObject();
+      writeColor(writer, "color", light.color);
+      writeKey(writer, "intensity");
+      writer.Double(light.intensity);
+      writeKey(writer, "range");
+      writer.Double(light.range);
+      writeCoordinate(writer, "offset", light.offset);
+      writeCoordinate(writer, "direction", light.direction);
+      writeKey(writer, "cone");
+      writer.Double(light.cone);
+      writer.EndObject();
+    }
+    writer.EndObject();
+  }
+  writer.EndArray();
+
+  writeKey(writer, "buildings");
+  writer.StartArray();
+  for (const auto &building : parser.getBuildings()) {
+    writer.StartObject();
+    writeId(writer, "id", building.id);
+    writeColor(writer, "color", building.color);
+    writeKey(writer, "visible");
+    writer.Bool(building.visible);
+    writeKey(writer, "floors");
+    writer.Uint(building.floors);
+    writeKey(writer, "rooms");
+    writer.StartObject();
+    writeKey(writer, "x");
+    writer.Uint(building.roomsX);
+    writeKey(writer, "y");
+    writer.Uint(building.roomsY);
+    writer.EndObject();
+
+    writeKey(writer, "bounds");
+    writer.StartObject();
+    const std::pair<float, float> bounds[]{{building.min.x, building.max.x},
+                                           {building.min.y, building.max.y},
+                                           {building.min.z, building.max.z}};
+    const char *axes[]{"x", "y", "z"};
+    for (auto i = 0u; i < 3u; i++) {
+      writeKey(writer, axes[i]);
+      writer.StartObject();
+      writeKey(writer, "min");
+      writer.Double(bounds[i].first);
+      writeKey(writer, "max");
+      writer.Double(bounds[i].second);
+      writer.EndObject();
+    }
+    writer.EndObject();
+    writer.EndObject();
+  }
+  writer.EndArray();
+
+  writeKey(writer, "decorations");
+  writer.StartArray();
+  for (const auto &decoration : parser.getDecorations()) {
+    writer.StartObject();
+    writeId(writer, "id", decoration.id);
+    writeKey(writer, "model");
+    writeString(writer, decoration.model);
+    writeCoordinate(writer, "position", decoration.position);
+    writeXYZ(writer, "orientation", decoration.orientation[0], decoration.orientation[1],
+             decoration.orientation[2]);
+    writeXYZ(writer, "scale", decoration.scale[0], decoration.scale[1], decoration.scale[2]);
+    writeTargetScale(writer, decoration.keepRatio, decoration.height, decoration.width, decoration.depth);
+    writer.EndObject();
+  }
+  writer.EndArray();
+
+  writeKey(writer, "areas");
+  writer.StartArray();
+  for (const auto &area : parser.getAreas()) {
+    writer.StartObject();
+    writeId(writer, "id", area.id);
+    writeKey(writer, "name");
+    writeString(writer, area.name);
+    writeKey(writer, "height");
+    writer.Double(area.height);
+    writeKey(writer, "points");
+    writer.StartArray();
+    for (const auto &point : area.points) {
+      writer.StartObject();
+      writeKey(writer, "x");
+      writer.Double(point.x);
+      writeKey(writer, "y");
+      writer.Double(point.y);
+      writer.EndObject();
+    }
+    writer.EndArray();
+    writeKey(writer, "fill-mode");
+    writer.String(drawModeString(area.fillMode));
+    writeColor(writer, "fill-color", area.fillColor);
+    writeKey(writer, "border-mode");
+    writer.String(drawModeString(area.borderMode));
+    writeColor(writer, "border-color", area.borderColor);
+    writer.EndObject();
+  }
+  writer.EndArray();
+
+  writeKey(writer, "links");
+  writer.StartArray();
+  for (const auto &link : parser.getLinks()) {
+    writer.StartObject();
+    writeKey(writer, "type");
+    writer.String("point-to-point");
+    writeKey(writer, "node-ids");
+    writer.StartArray();
+    for (const auto id : link.nodes)
+      writer.Uint(id);
+    writer.EndArray();
+    writer.EndObject();
+  }
+  writer.EndArray();
+
+  writeKey(writer, "series");
+  writer.StartArray();
+  for (const auto &series : parser.getXYSeries()) {
+    writer.StartObject();
+    writeKey(writer, "type");
+    writer.String("xy-series");
+    writeId(writer, "id", series.id);
+    writeKey(writer, "name");
+    writeString(writer, series.name);
+    writeKey(writer, "legend");
+    writeString(writer, series.legend);
+    writeKey(writer, "visible");
+    writer.Bool(series.visible);
+    writeColor(writer, "color", series.color);
+    writeKey(writer, "connection");
+    switch (series.connection) {
+    case XYSeries::Connection::None:
+      writer.String("none");
+      break;
+    case XYSeries::Connection::Line:
+      writer.String("line");
+      break;
+    case XYSeries::Connection::Spline:
+      writer.String("spline");
+      break;
+    }
+    writeKey(writer, "labels");
+    writer.String(series.labelMode == XYSeries::LabelMode::Hidden ? "hidden" : "shown");
+    writeValueAxis(writer, "x-axis", series.xAxis);
+    writeValueAxis(writer, "y-axis", series.yAxis);
+    writer.EndObject();
+  }
+
+  for (const auto &series : parser.getCategoryValueSeries()) {
+    writer.StartObject();
+    writeKey(writer, "type");
+    writer.String("category-value-series");
+    writeId(writer, "id", series.id);
+    writeKey(writer, "name");
+    writeString(writer, series.name);
+    writeKey(writer, "legend");
+    writeString(writer, series.legend);
+    writeKey(writer, "visible");
+    writer.Bool(series.visible);
+    writeColor(writer, "color", series.color);
+    writeValueAxis(writer, "x-axis", series.xAxis);
+
+    writeKey(writer, "y-axis");
+    writer.StartObject();
+    writeKey(writer, "name");
+    writeString(writer, series.yAxis.name);
+    writeKey(writer, "values");
+    writer.StartArray();
+    for (const auto &category : series.yAxis.values) {
+      writer.StartObject();
+      writeId(writer, "id", category.id);
+      writeKey(writer, "value");
+      writeString(writer, category.name);
+      writer.EndObject();
+    }
+    writer.EndArray();
+    writer.EndObject();
+
+    writeKey(writer, "auto-update");
+    writer.Bool(series.autoUpdate);
+    if (series.autoUpdate) {
+      writeKey(writer, "auto-update-interval");
+      writer.Int64(series.autoUpdateInterval);
+      writeKey(writer, "auto-update-increment");
+      writer.Double(series.autoUpdateIncrement);
+    }
+    writer.EndObject();
+  }
+
+  for (const auto &collection : parser.getSeriesCollections()) {
+    writer.StartObject();
+    writeKey(writer, "type");
+    writer.String("series-collection");
+    writeId(writer, "id", collection.id);
+    writeKey(writer, "name");
+    writeString(writer, collection.name);
+    writeKey(writer, "child-series");
+    writer.StartArray();
+    for (const auto id : collection.series)
+      writer.Uint(id);
+    writer.EndArray();
+    writeValueAxis(writer, "x-axis", collection.xAxis);
+    writeValueAxis(writer, "y-axis", collection.yAxis);
+    writer.EndObject();
+  }
+  writer.EndArray();
+
+  writeKey(writer, "streams");
+  writer.StartArray();
+  for (const auto &stream : parser.getLogStreams()) {
+    writer.StartObject();
+    writeId(writer, "id", stream.id);
+    writeKey(writer, "name");
+    writeString(writer, stream.name);
+    writeKey(writer, "visible");
+    writer.Bool(stream.visible);
+    if (stream.color)
+      writeColor(writer, "color", *stream.color);
+    writer.EndObject();
+  }
+  writer.EndArray();
+
+  writeKey(writer, "events");
+  writer.StartArray();
+  flush(flushSize);
+}
+
+void JsonWriter::writeEvent(const SceneEvent &event) {
+  std::visit(
+      [this](const auto &e) {
+        using T = std::decay_t<decltype(e)>;
+        if constexpr (std::is_same_v<T, MoveEvent>) {
+          startEvent(writer, "node-position", e.time);
+          writeId(writer, "id", e.nodeId);
+          writeKey(writer, "x");
+          writer.Double(e.targetPosition.x);
+          writeKey(writer, "y");
+          writer.Double(e.targetPosition.y);
+          writeKey(writer, "z");
+          writer.Double(e.targetPosition.z);
+        } else if constexpr (std::is_same_v<T, TransmitEvent>) {
+          startEvent(writer, "node-transmit", e.time);
+          writeId(writer, "id", e.nodeId);
+          writeKey(writer, "duration");
+          writer.Int64(e.duration);
+          writeKey(writer, "target-size");
+          writer.Double(e.targetSize);
+          writeColor(writer, "color", e.color);
+        } else if constexpr (std::is_same_v<T, TransmitEndEvent>) {
+          // Inserted by the parser for each `TransmitEvent`, so never written
+          return;
+        } else if constexpr (std::is_same_v<T, NodeOrientationChangeEvent>) {
+          startEvent(writer, "node-orientation", e.time);
+          writeId(writer, "id", e.nodeId);
+          writeKey(writer, "x");
+          writer.Double(e.targetOrientation[0]);
+          writeKey(writer, "y");
+          writer.Double(e.targetOrientation[1]);
+          writeKey(writer, "z");
+          writer.Double(e.targetOrientation[2]);
+        } else if constexpr (std::is_same_v<T, NodeColorChangeEvent>) {
+          startEvent(writer, "node-color", e.time);
+          writeId(writer, "id", e.nodeId);
+          writeKey(writer, "color-type");
+          writer.String(e.type == NodeColorChangeEvent::ColorType::Base ? "base" : "highlight");
+          if (e.targetColor)
+            writeColor(writer, "color", *e.targetColor);
+        } else if constexpr (std::is_same_v<T, DecorationMoveEvent>) {
+          startEvent(writer, "decoration-position", e.time);
+          writeId(writer, "id", e.decorationId);
+          writeKey(writer, "x");
+          writer.Double(e.targetPosition.x);
+          writeKey(writer, "y");
+          writer.Double(e.targetPosition.y);
+          writeKey(writer, "z");
+          writer.Double(e.targetPosition.z);
+        } else if constexpr (std::is_same_v<T, DecorationOrientationChangeEvent>) {
+          startEvent(writer, "decoration-orientation", e.time);
+          writeId(writer, "id", e.decorationId);
+          writeKey(writer, "x");
+          writer.Double(e.targetOrientation[0]);
+          writeKey(writer, "y");
+          writer.Double(e.targetOrientation[1]);
+          writeKey(writer, "z");
+          writer.Double(e.targetOrientation[2]);
+        }
+        writer.EndObject();
+      },
+      event);
+}
+
+void JsonWriter::writeEvent(const ChartEvent &event) {
+  std::visit(
+      [this](const auto &e) {
+        using T = std::decay_t<decltype(e)>;
+        if constexpr (std::is_same_v<T, XYSeriesAddValue>) {
+          startEvent(writer, "xy-series-append", e.time);
+          writeId(writer, "series-id", e.seriesId);
+          writeKey(writer, "x");
+          writer.Double(e.point.x);
+          writeKey(writer, "y");
+          writer.Double(e.point.y);
+        } else if constexpr (std::is_same_v<T, XYSeriesAddValues>) {
+          startEvent(writer, "xy-series-append-array", e.time);
+          writeId(writer, "series-id", e.seriesId);
+          writeKey(writer, "points");
+          writer.StartArray();
+          for (const auto &point : e.points) {
+            writer.StartObject();
+            writeKey(writer, "x");
+            writer.Double(point.x);
+            writeKey(writer, "y");
+            writer.Double(point.y);
+            writer.EndObject();
+          }
+          writer.EndArray();
+        } else if constexpr (std::is_same_v<T, XYSeriesClear>) {
+          startEvent(writer, "xy-series-clear", e.time);
+          writeId(writer, "series-id", e.seriesId);
+        } else if constexpr (std::is_same_v<T, CategorySeriesAddValue>) {
+          startEvent(writer, "category-series-append", e.time);
+          writeId(writer, "series-id", e.seriesId);
+          writeKey(writer, "category");
+          writer.Uint(e.category);
+          writeKey(writer, "value");
+          writer.Double(e.value);
+        }
+        writer.EndObject();
+      },
+      event);
+}
+
+void JsonWriter::writeEvent(const LogEvent &event) {
+  const auto &e = std::get<StreamAppendEvent>(event);
+  startEvent(writer, "stream-append", e.time);
+  writeId(writer, "stream-id", e.streamId);
+  writeKey(writer, "data");
+  writeString(writer, e.value);
+  writer.EndObject();
+}
+
+void JsonWriter::writeEvents(const std::vector<SceneEvent> &sceneEvents, const std::vector<ChartEvent> &chartEvents,
+                             const std::vector<LogEvent> &logEvents) {
+  // Each list is already in time order,
+  // so merge them to keep the whole 'events' section in order
+  auto scene = sceneEvents.begin();
+  auto chart = chartEvents.begin();
+  auto log = logEvents.begin();
+
+  while (scene != sceneEvents.end() || chart != chartEvents.end() || log != logEvents.end()) {
+    const auto sceneTime = scene != sceneEvents.end() ? timeOf(*scene) : LLONG_MAX;
+    const auto chartTime = chart != chartEvents.end() ? timeOf(*chart) : LLONG_MAX;
+    const auto logTime = log != logEvents.end() ? timeOf(*log) : LLONG_MAX;
+
+    if (scene != sceneEvents.end() && sceneTime <= chartTime && sceneTime <= logTime)
+      writeEvent(*scene++);
+    else if (chart != chartEvents.end() && chartTime <= logTime)
+      writeEvent(*chart++);
+    else
+      writeEvent(*log++);
+
+    flush(flushSize);
+  }
+}
+
+bool CheckedJsonWriter::Double(double value) {
+  const auto accepted = Writer::Double(value);
+  refused = refused || !accepted;
+  return accepted;
+}
+
+bool CheckedJsonWriter::hasRefused() const {
+  return refused;
+}
+
+std::optional<ParseError> JsonWriter::finish() {
+  if (started) {
+    writer.EndArray();
+    writer.EndObject();
+  }
+  flush(0u);
+
+  // Report the failure regardless of whether the file closed cleanly
+  const auto closed = std::fclose(file.release()) == 0;
+  if (writer.hasRefused()) {
+    std::cerr << "Failed writing JSON output: a number was not finite\n";
+    return {ParseError{"A number which is not finite (NaN or infinity) cannot be written to JSON", written}};
+  }
+  if (failed || !closed || (started && !writer.IsComplete())) {
+    std::cerr << "Failed writing JSON output\n";
+    return {ParseError{"Failed writing to file", written}};
+  }
+
+  return {};
+}
+
+} // namespace parser
@@ -0,0 +1,147 @@
+/*
+ * NIST-developed software is provided by NIST as a public service. You may use,
+ * copy and distribute copies of the software in any medium, provided that you
+ * keep intact this entire notice. You may improve,modify and create derivative
+ * works of the software or any portion of the software, and you may copy and
+ * distribute such modifications or works. Modified works should carry a notice
+ * stating that you changed the software and should note the date and nature of
+ * any such change. Please explicitly acknowledge the National Institute of
+ * Standards and Technology as the source of the software.
+ *
+ * NIST-developed software is expressly provided "AS IS." NIST MAKES NO
+ * WARRANTY OF ANY KIND, EXPRESS, IMPLIED, IN FACT OR ARISING BY OPERATION OF
+ * LAW, INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTY OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, NON-INFRINGEMENT
+ * AND DATA ACCURACY. NIST NEITHER REPRESENTS NOR WARRANTS THAT THE
+ * OPERATION OF THE SOFTWARE WILL BE UNINTERRUPTED OR ERROR-FREE, OR THAT
+ * ANY DEFECTS WILL BE CORRECTED. NIST DOES NOT WARRANT OR MAKE ANY
+ * REPRESENTATIONS REGARDING THE USE OF THE SOFTWARE OR THE RESULTS THEREOF,
+ * INCLUDING BUT NOT LIMITED TO THE CORRECTNESS, ACCURACY, RELIABILITY,
+ * OR USEFULNESS OF THE SOFTWARE.
+ *
+ * You are solely responsible for determining the appropriateness of using and
+ * distributing the software and you assume all risks associated with its use,
+ * including but not limited to the risks and costs of program errors,
+ * compliance with applicable laws, damage to or loss of data, programs or
+ * equipment, and the unavailability or interruption of operation. This
+ * software is not intended to be used in any situation where a failure could
+ * cause risk of injury or damage to property. The software developed by NIST
+ * employees is not subject to copyright protection within the United States.
+ *
+ * Author: Evan Black <evan.black@nist.gov>
+ */
+
+#pragma once
+#include "file-parser.h"
+#include "model.h"
+#include <cstdio>
+#include <memory>
+#include <optional>
+#include <rapidjson/stringbuffer.h>
+#include <rapidjson/writer.h>
+#include <vector>
+
+namespace parser {
+
+/**
+ * A JSON writer which remembers refusing a number.
+ * rapidjson writes nothing for NaN or infinity, leaving the document malformed,
+ * so a document with a refused number must not be kept
+ */
+class CheckedJsonWriter : public rapidjson::Writer<rapidjson::StringBuffer> {
+  bool refused = false;
+
+public:
+  using Writer::Writer;
+
+  /**
+   * Hides `rapidjson::Writer::Double()`, which is not virtual,
+   * so only calls through this type are checked
+   */
+  bool Double(double value);
+
+  /**
+   * @return
+   * True if any number was not finite, and so was not written
+   */
+  [[nodiscard]] bool hasRefused() const;
+};
+
+/**
+ * Writes a scenario in the JSON format read by `FileParser`, a part at a time,
+ * so the events may be written as they are parsed, rather than held until the end.
+ *
+ * The sections are written first, then each batch of events,
+ * and `finish()` closes the document.
+ * `TransmitEndEvent`s are not written, since the parser inserts them again
+ */
+class JsonWriter {
+  std::unique_ptr<FILE, decltype(&std::fclose)> file{nullptr, std::fclose};
+
+  /**
+   * Holds the output until it is large enough to write out
+   */
+  rapidjson::StringBuffer buffer;
+
+  CheckedJsonWriter writer{buffer};
+
+  /**
+   * The number of bytes written to `file` so far
+   */
+  std::size_t written = 0u;
+
+  /**
+   * If any write to `file` came up short
+   */
+  bool failed = false;
+
+  /**
+   * Set once `writeSections()` has opened the document
+   */
+  bool started = false;
+
+  /**
+   * Write out `buffer` once it is at least `minimum` bytes
+   */
+  void flush(std::size_t minimum);
+
+  void writeEvent(const SceneEvent &event);
+  void writeEvent(const ChartEvent &event);
+  void writeEvent(const LogEvent &event);
+
+public:
+  /**
+   * Start writing to `path`.
+   * Any existing file at `path` is overwritten
+   *
+   * @return
+   * An error if the file could not be opened, an unset optional otherwise
+   */
+  std::optional<ParseError> open(const char *path);
+
+  /**
+   * Write the configuration & every section other than 'events',
+   * then open the 'events' section. Must be called once, first
+   *
+   * @param parser
+   * The parser to write the sections of, once they have been parsed.
+   * See `FileParser::setProgressive()`
+   */
+  void writeSections(const FileParser &parser);
+
+  /**
+   * Write a batch of events, interleaved by time
+   */
+  void writeEvents(const std::vector<SceneEvent> &sceneEvents, const std::vector<ChartEvent> &chartEvents,
+                   const std::vector<LogEvent> &logEvents);
+
+  /**
+   * Close the document & the file
+   *
+   * @return
+   * An error if any part of the file could not be written, an unset optional otherwise
+   */
+  std::optional<ParseError> finish();
+};
+
+} // namespace parser
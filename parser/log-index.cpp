@@ -0,0 +1,162 @@
+/*
+ * NIST-developed software is provided by NIST as a public service. You may use,
+ * copy and distribute copies of the software in any medium, provided that you
+ * keep intact this entire notice. You may improve,modify and create derivative
+ * works of the software or any portion of the software, and you may copy and
+ * distribute such modifications or works. Modified works should carry a notice
+ * stating that you changed the software and should note the date and nature of
+ * any such change. Please explicitly acknowledge the National Institute of
+ * Standards and Technology as the source of the software.
+ *
+ * NIST-developed software is expressly provided "AS IS." NIST MAKES NO
+ * WARRANTY OF ANY KIND, EXPRESS, IMPLIED, IN FACT OR ARISING BY OPERATION OF
+ * LAW, INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTY OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, NON-INFRINGEMENT
+ * AND DATA ACCURACY. NIST NEITHER REPRESENTS NOR WARRANTS THAT THE
+ * OPERATION OF THE SOFTWARE WILL BE UNINTERRUPTED OR ERROR-FREE, OR THAT
+ * ANY DEFECTS WILL BE CORRECTED. NIST DOES NOT WARRANT OR MAKE ANY
+ * REPRESENTATIONS REGARDING THE USE OF THE SOFTWARE OR THE RESULTS THEREOF,
+ * INCLUDING BUT NOT LIMITED TO THE CORRECTNESS, ACCURACY, RELIABILITY,
+ * OR USEFULNESS OF THE SOFTWARE.
+ *
+ * You are solely responsible for determining the appropriateness of using and
+ * distributing the software and you assume all risks associated with its use,
+ * including but not limited to the risks and costs of program errors,
+ * compliance with applicable laws, damage to or loss of data, programs or
+ * equipment, and the unavailability or interruption of operation. This
+ * software is not intended to be used in any situation where a failure could
+ * cause risk of injury or damage to property. The software developed by NIST
+ * employees is not subject to copyright protection within the United States.
+ *
+ * Author: Evan Black <evan.black@nist.gov>
+ */
+
+#include "log-index.h"
+#include <algorithm>
+#include <mutex>
+#include <utility>
+#include <variant>
+
+namespace parser {
+
+std::vector<std::string> LogIndex::tokenize(std::string_view text) {
+  std::vector<std::string> words;
+  std::string word;
+
+  for (const auto c : text) {
+    const auto value = static_cast<unsigned char>(c);
+
+    // Keep multi-byte UTF-8 characters in words
+    if ((value >= 'a' && value <= 'z') || (value >= '0' && value <= '9') || value >= 0x80u) {
+      word.push_back(c);
+    } else if (value >= 'A' && value <= 'Z') {
+      word.push_back(static_cast<char>(value - 'A' + 'a'));
+    } else if (!word.empty()) {
+      words.emplace_back(std::move(word));
+      word.clear();
+    }
+  }
+
+  if (!word.empty())
+    words.emplace_back(std::move(word));
+
+  return words;
+}
+
+void LogIndex::add(const std::vector<LogEvent> &events) {
+  std::uint32_t first;
+  {
+    std::shared_lock lock{mutex};
+    first = size;
+  }
+
+  // Build the postings of these events alone,
+  // then append them to the index in one go
+  std::unordered_map<std::string, std::vector<std::uint32_t>> batch;
+  for (auto i = 0u; i < events.size(); i++) {
+    const auto number = first + static_cast<std::uint32_t>(i);
+    const auto &value = std::visit(
+        [](const auto &e) -> const std::string & {
+          return e.value;
+        },
+        events[i]);
+
+    for (auto &word : tokenize(value)) {
+      auto &list = batch[std::move(word)];
+      // Only list each event once per word
+      if (list.empty() || list.back() != number)
+        list.emplace_back(number);
+    }
+  }
+
+  std::unique_lock lock{mutex};
+  for (auto &[word, numbers] : batch) {
+    auto &list = postings[word];
+    list.insert(list.end(), numbers.begin(), numbers.end());
+  }
+  size = first + static_cast<std::uint32_t>(events.size());
+}
+
+std::vector<std::uint32_t> LogIndex::find(std::string_view query, std::uint32_t end) const {
+  auto words = tokenize(query);
+  if (words.empty())
+    return {};
+
+  std::sort(words.begin(), words.end());
+  words.erase(std::unique(words.begin(), words.end()), words.end());
+
+  std::shared_lock lock{mutex};
+
+  std::vector<const std::vector<std::uint32_t> *> lists;
+  for (const auto &word : words) {
+    const auto iter = postings.find(word);
+    if (iter == postings.end())
+      return {};
+    lists.emplace_back(&iter->second);
+  }
+
+  // Check the rarest word's events against the others
+  std::sort(lists.begin(), lists.end(), [](const auto left, const auto right) {
+    return left->size() < right->size();
+  });
+
+  const auto &rarest = *lists.front();
+  const auto rarestEnd = std::lower_bound(rarest.begin(), rarest.end(), end);
+
+  // Where to continue searching each of the other lists,
+  // as the candidates are in ascending order
+  std::vector<std::vector<std::uint32_t>::const_iterator> positions;
+  for (auto i = 1u; i < lists.size(); i++)
+    positions.emplace_back(lists[i]->begin());
+
+  std::vector<std::uint32_t> found;
+  for (auto candidate = rarest.begin(); candidate != rarestEnd; candidate++) {
+    auto matches = true;
+    for (auto i = 0u; i < positions.size(); i++) {
+      const auto &list = *lists[i + 1u];
+      positions[i] = std::lower_bound(positions[i], list.end(), *candidate);
+      if (positions[i] == list.end() || *positions[i] != *candidate) {
+        matches = false;
+        break;
+      }
+    }
+
+    if (matches)
+      found.emplace_back(*candidate);
+  }
+
+  return found;
+}
+
+std::uint32_t LogIndex::indexed() const {
+  std::shared_lock lock{mutex};
+  return size;
+}
+
+void LogIndex::clear() {
+  std::unique_lock lock{mutex};
+  postings.clear();
+  size = 0u;
+}
+
+} // namespace parser
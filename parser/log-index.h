@@ -0,0 +1,121 @@
+/*
+ * NIST-developed software is provided by NIST as a public service. You may use,
+ * copy and distribute copies of the software in any medium, provided that you
+ * keep intact this entire notice. You may improve,modify and create derivative
+ * works of the software or any portion of the software, and you may copy and
+ * distribute such modifications or works. Modified works should carry a notice
+ * stating that you changed the software and should note the date and nature of
+ * any such change. Please explicitly acknowledge the National Institute of
+ * Standards and Technology as the source of the software.
+ *
+ * NIST-developed software is expressly provided "AS IS." NIST MAKES NO
+ * WARRANTY OF ANY KIND, EXPRESS, IMPLIED, IN FACT OR ARISING BY OPERATION OF
+ * LAW, INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTY OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, NON-INFRINGEMENT
+ * AND DATA ACCURACY. NIST NEITHER REPRESENTS NOR WARRANTS THAT THE
+ * OPERATION OF THE SOFTWARE WILL BE UNINTERRUPTED OR ERROR-FREE, OR THAT
+ * ANY DEFECTS WILL BE CORRECTED. NIST DOES NOT WARRANT OR MAKE ANY
+ * REPRESENTATIONS REGARDING THE USE OF THE SOFTWARE OR THE RESULTS THEREOF,
+ * INCLUDING BUT NOT LIMITED TO THE CORRECTNESS, ACCURACY, RELIABILITY,
+ * OR USEFULNESS OF THE SOFTWARE.
+ *
+ * You are solely responsible for determining the appropriateness of using and
+ * distributing the software and you assume all risks associated with its use,
+ * including but not limited to the risks and costs of program errors,
+ * compliance with applicable laws, damage to or loss of data, programs or
+ * equipment, and the unavailability or interruption of operation. This
+ * software is not intended to be used in any situation where a failure could
+ * cause risk of injury or damage to property. The software developed by NIST
+ * employees is not subject to copyright protection within the United States.
+ *
+ * Author: Evan Black <evan.black@nist.gov>
+ */
+
+#pragma once
+
+#include "model.h"
+#include <cstdint>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace parser {
+
+/**
+ * An inverted index of the words in every log event, for searching long logs.
+ *
+ * Events are numbered in the order they are added, starting from 0,
+ * so the numbers match the position of each event in the list the events were added to.
+ * Words are runs of letters, digits, and non-ASCII characters, compared without
+ * ASCII case. Each word maps to the ascending numbers of the events containing it.
+ *
+ * Events may be added on one thread while searching on another
+ */
+class LogIndex {
+  /**
+   * Guards `postings` & `size`, as the index is built on the loading thread
+   */
+  mutable std::shared_mutex mutex;
+
+  /**
+   * The numbers of the events containing each word, in ascending order
+   */
+  std::unordered_map<std::string, std::vector<std::uint32_t>> postings;
+
+  /**
+   * The number of events added
+   */
+  std::uint32_t size{0u};
+
+public:
+  /**
+   * Split text into the words the index is built from
+   *
+   * @param text
+   * The text to split
+   *
+   * @return
+   * The lower case words in `text`, in order, with duplicates
+   */
+  [[nodiscard]] static std::vector<std::string> tokenize(std::string_view text);
+
+  /**
+   * Index the next events.
+   * The events are tokenized before the index is locked,
+   * so searches are only blocked while the words are merged in
+   *
+   * @param events
+   * The events following those already added
+   */
+  void add(const std::vector<LogEvent> &events);
+
+  /**
+   * Find the events containing every word in a query
+   *
+   * @param query
+   * The words to search for
+   *
+   * @param end
+   * One past the number of the last event to search
+   *
+   * @return
+   * The numbers of the matching events before `end`, in ascending order.
+   * Empty if the query has no words
+   */
+  [[nodiscard]] std::vector<std::uint32_t> find(std::string_view query, std::uint32_t end) const;
+
+  /**
+   * @return
+   * The number of events added
+   */
+  [[nodiscard]] std::uint32_t indexed() const;
+
+  /**
+   * Remove every event from the index
+   */
+  void clear();
+};
+
+} // namespace parser
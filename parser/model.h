@@ -31,6 +31,8 @@
  * Author: Evan Black <evan.black@nist.gov>
  */
 #pragma once
+#include "interned-string.h"
+#include "xy-points.h"
 #include <array>
 #include <cstdint>
 #include <optional>
@@ -72,11 +74,44 @@ struct GlobalConfiguration {
 
 // ----- Scene Models -----
 
+/**
+ * A light carried by a Node, such as a beacon or a headlight
+ */
+struct NodeLight {
+  Ns3Color3 color{255u, 255u, 255u};
+  float intensity = 1.0f;
+
+  /**
+   * The distance, in meters, at which the light fades to nothing
+   */
+  float range = 10.0f;
+
+  /**
+   * From the position of the Node, turned with the Node
+   */
+  Ns3Coordinate offset;
+
+  /**
+   * The way a spot light points, turned with the Node
+   */
+  Ns3Coordinate direction{0.0f, 0.0f, -1.0f};
+
+  /**
+   * Half the angle of a spot light's cone, in degrees.
+   * 180 or more lights every way
+   */
+  float cone = 180.0f;
+};
+
 struct Node {
   unsigned int id = 0;
   std::string name;
   bool labelEnabled{true};
-  std::string model;
+
+  /**
+   * Path to the model, usually shared by many Nodes
+   */
+  InternedString model;
   std::array<float, 3> scale{1.0f};
   bool keepRatio{true};
   std::optional<float> height;
@@ -90,6 +125,7 @@ struct Node {
   bool trailEnabled{false};
   Ns3Color3 trailColor;
   std::array<double, 3> orientation{0.0};
+  std::optional<NodeLight> light;
 };
 
 struct Building {
@@ -105,7 +141,7 @@ struct Building {
 
 struct Decoration {
   unsigned int id;
-  std::string model;
+  InternedString model;
   Ns3Coordinate position;
   std::array<double, 3> orientation{0.0};
   bool keepRatio{true};
@@ -141,7 +177,10 @@ struct ValueAxis {
   enum class BoundMode { Fixed, HighestValue };
   enum class Scale { Linear, Logarithmic };
 
-  std::string name;
+  /**
+   * Axis names are usually shared by many series, e.g. 'Time (s)'
+   */
+  InternedString name;
   BoundMode boundMode = BoundMode::HighestValue;
   Scale scale = Scale::Linear;
   double min = 0.0;
@@ -154,7 +193,7 @@ struct CategoryAxis {
     std::string name;
   };
 
-  std::string name;
+  InternedString name;
   std::vector<Category> values;
 };
 
@@ -205,6 +244,25 @@ struct LogStream {
   std::optional<Ns3Color3> color;
 };
 
+// ----- Shared Models -----
+
+/**
+ * The descriptions of the Nodes, Decorations, & series of a scenario,
+ * which events never change.
+ *
+ * Held once behind a `std::shared_ptr<const StaticModels>`
+ * and referenced by each consumer, which keeps only what events change
+ * (e.g. the position of a Node) itself.
+ * See `FileParser::shareStaticModels()`
+ */
+struct StaticModels {
+  std::vector<Node> nodes;
+  std::vector<Decoration> decorations;
+  std::vector<XYSeries> xySeries;
+  std::vector<CategoryValueSeries> categoryValueSeries;
+  std::vector<SeriesCollection> seriesCollections;
+};
+
 /**
  * Event that changes the position of the indicated node
  */
@@ -236,11 +294,6 @@ struct TransmitEvent {
    */
   nanoseconds time = 0LL;
 
-  /**
-   * The Node that triggered the event
-   */
-  uint32_t nodeId = 0;
-
   /**
    * How long the transmission sphere should
    * expand
@@ -254,6 +307,12 @@ struct TransmitEvent {
    */
   double targetSize = 2.0;
 
+  /**
+   * The Node that triggered the event.
+   * Placed after the 8 byte members so `color` fills the padding
+   */
+  uint32_t nodeId = 0;
+
   /**
    * The color to use as the base color of
    * the transmission bubble
@@ -278,9 +337,14 @@ struct TransmitEndEvent {
   uint32_t nodeId = 0;
 
   /**
-   * The event that started the transmission
+   * The time of the `TransmitEvent` from `nodeId`
+   * that started the transmission.
+   *
+   * Only the time is kept, rather than a copy of the event,
+   * since this is the largest alternative in `SceneEvent`
+   * otherwise
    */
-  TransmitEvent startEvent;
+  nanoseconds startTime = 0LL;
 };
 
 /**
@@ -381,15 +445,6 @@ struct NodeColorChangeEvent {
   std::optional<Ns3Color3> targetColor;
 };
 
-/**
- * Convenience struct for packaging points.
- * Does not correspond to anything in the ns-3 module
- */
-struct XYPoint {
-  double x;
-  double y;
-};
-
 /**
  * Event that appends a value to an existing series
  */
@@ -428,9 +483,10 @@ struct XYSeriesAddValues {
 
   /**
    * The points to add to the series.
-   * Should be added in order
+   * Should be added in order.
+   * Kept in a block shared with the points of other events
    */
-  std::vector<XYPoint> points;
+  XYPointSpan points;
 };
 
 /**
@@ -0,0 +1,157 @@
+/*
+ * NIST-developed software is provided by NIST as a public service. You may use,
+ * copy and distribute copies of the software in any medium, provided that you
+ * keep intact this entire notice. You may improve,modify and create derivative
+ * works of the software or any portion of the software, and you may copy and
+ * distribute such modifications or works. Modified works should carry a notice
+ * stating that you changed the software and should note the date and nature of
+ * any such change. Please explicitly acknowledge the National Institute of
+ * Standards and Technology as the source of the software.
+ *
+ * NIST-developed software is expressly provided "AS IS." NIST MAKES NO
+ * WARRANTY OF ANY KIND, EXPRESS, IMPLIED, IN FACT OR ARISING BY OPERATION OF
+ * LAW, INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTY OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, NON-INFRINGEMENT
+ * AND DATA ACCURACY. NIST NEITHER REPRESENTS NOR WARRANTS THAT THE
+ * OPERATION OF THE SOFTWARE WILL BE UNINTERRUPTED OR ERROR-FREE, OR THAT
+ * ANY DEFECTS WILL BE CORRECTED. NIST DOES NOT WARRANT OR MAKE ANY
+ * REPRESENTATIONS REGARDING THE USE OF THE SOFTWARE OR THE RESULTS THEREOF,
+ * INCLUDING BUT NOT LIMITED TO THE CORRECTNESS, ACCURACY, RELIABILITY,
+ * OR USEFULNESS OF THE SOFTWARE.
+ *
+ * You are solely responsible for determining the appropriateness of using and
+ * distributing the software and you assume all risks associated with its use,
+ * including but not limited to the risks and costs of program errors,
+ * compliance with applicable laws, damage to or loss of data, programs or
+ * equipment, and the unavailability or interruption of operation. This
+ * software is not intended to be used in any situation where a failure could
+ * cause risk of injury or damage to property. The software developed by NIST
+ * employees is not subject to copyright protection within the United States.
+ *
+ * Author: Evan Black <evan.black@nist.gov>
+ */
+
+#include "packed-events.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <variant>
+
+namespace parser {
+
+namespace {
+
+constexpr auto maxStep = static_cast<float>(std::numeric_limits<uint16_t>::max());
+
+float stepOf(float min, float max) {
+  // A flat axis still needs a step, to divide by
+  return max > min ? (max - min) / maxStep : 1.0f;
+}
+
+/**
+ * @return
+ * The fixed point value for `value` on one axis, false if it is outside the bounds
+ */
+bool quantize(float value, float origin, float step, uint16_t &out) {
+  const auto scaled = std::round((value - origin) / step);
+  if (!(scaled >= 0.0f && scaled <= maxStep))
+    return false;
+
+  out = static_cast<uint16_t>(scaled);
+  return true;
+}
+
+} // namespace
+
+PackedSceneEvents::PackedSceneEvents(const Ns3Coordinate &minLocation, const Ns3Coordinate &maxLocation)
+    : origin(minLocation), step{stepOf(minLocation.x, maxLocation.x), stepOf(minLocation.y, maxLocation.y),
+                                stepOf(minLocation.z, maxLocation.z)} {
+}
+
+uint32_t PackedSceneEvents::addTime(nanoseconds time) {
+  if (!blockTimes.empty() && kinds.size() - blockStarts.back() < blockSize) {
+    const auto offset = time - blockTimes.back();
+    if (offset >= 0 && offset <= std::numeric_limits<uint32_t>::max())
+      return static_cast<uint32_t>(offset);
+  }
+
+  blockStarts.emplace_back(static_cast<uint32_t>(kinds.size()));
+  blockTimes.emplace_back(time);
+  return 0u;
+}
+
+void PackedSceneEvents::push_back(const SceneEvent &event) {
+  const auto time = std::visit(
+      [](const auto &e) {
+        return e.time;
+      },
+      event);
+  timeOffsets.emplace_back(addTime(time));
+
+  if (const auto move = std::get_if<MoveEvent>(&event)) {
+    std::array<uint16_t, 3> position{};
+    if (quantize(move->targetPosition.x, origin.x, step.x, position[0]) &&
+        quantize(move->targetPosition.y, origin.y, step.y, position[1]) &&
+        quantize(move->targetPosition.z, origin.z, step.z, position[2])) {
+      kinds.emplace_back(static_cast<uint8_t>(event.index()));
+      ids.emplace_back(move->nodeId);
+      positions.emplace_back(position);
+      return;
+    }
+  }
+
+  kinds.emplace_back(otherKind);
+  ids.emplace_back(static_cast<uint32_t>(others.size()));
+  positions.emplace_back();
+  others.emplace_back(event);
+}
+
+SceneEvent PackedSceneEvents::operator[](std::size_t index) const {
+  if (kinds[index] == otherKind)
+    return others[ids[index]];
+
+  // Blocks hold at most `blockSize` events, so the block of `index` is no earlier than this
+  const auto earliest = blockStarts.begin() + static_cast<std::ptrdiff_t>(index / blockSize);
+  const auto block = std::upper_bound(earliest, blockStarts.end(), index) - blockStarts.begin() - 1;
+
+  MoveEvent move;
+  move.time = blockTimes[block] + timeOffsets[index];
+  move.nodeId = ids[index];
+
+  const auto &position = positions[index];
+  move.targetPosition = {origin.x + static_cast<float>(position[0]) * step.x,
+                         origin.y + static_cast<float>(position[1]) * step.y,
+                         origin.z + static_cast<float>(position[2]) * step.z};
+  return move;
+}
+
+std::size_t PackedSceneEvents::size() const {
+  return kinds.size();
+}
+
+bool PackedSceneEvents::empty() const {
+  return kinds.empty();
+}
+
+const Ns3Coordinate &PackedSceneEvents::getStep() const {
+  return step;
+}
+
+std::size_t PackedSceneEvents::bytes() const {
+  return blockStarts.capacity() * sizeof(uint32_t) + blockTimes.capacity() * sizeof(nanoseconds) +
+         timeOffsets.capacity() * sizeof(uint32_t) + kinds.capacity() * sizeof(uint8_t) +
+         ids.capacity() * sizeof(uint32_t) + positions.capacity() * sizeof(std::array<uint16_t, 3>) +
+         others.capacity() * sizeof(SceneEvent);
+}
+
+void PackedSceneEvents::shrink() {
+  blockStarts.shrink_to_fit();
+  blockTimes.shrink_to_fit();
+  timeOffsets.shrink_to_fit();
+  kinds.shrink_to_fit();
+  ids.shrink_to_fit();
+  positions.shrink_to_fit();
+  others.shrink_to_fit();
+}
+
+} // namespace parser
@@ -0,0 +1,165 @@
+/*
+ * NIST-developed software is provided by NIST as a public service. You may use,
+ * copy and distribute copies of the software in any medium, provided that you
+ * keep intact this entire notice. You may improve,modify and create derivative
+ * works of the software or any portion of the software, and you may copy and
+ * distribute such modifications or works. Modified works should carry a notice
+ * stating that you changed the software and should note the date and nature of
+ * any such change. Please explicitly acknowledge the National Institute of
+ * Standards and Technology as the source of the software.
+ *
+ * NIST-developed software is expressly provided "AS IS." NIST MAKES NO
+ * WARRANTY OF ANY KIND, EXPRESS, IMPLIED, IN FACT OR ARISING BY OPERATION OF
+ * LAW, INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTY OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, NON-INFRINGEMENT
+ * AND DATA ACCURACY. NIST NEITHER REPRESENTS NOR WARRANTS THAT THE
+ * OPERATION OF THE SOFTWARE WILL BE UNINTERRUPTED OR ERROR-FREE, OR THAT
+ * ANY DEFECTS WILL BE CORRECTED. NIST DOES NOT WARRANT OR MAKE ANY
+ * REPRESENTATIONS REGARDING THE USE OF THE SOFTWARE OR THE RESULTS THEREOF,
+ * INCLUDING BUT NOT LIMITED TO THE CORRECTNESS, ACCURACY, RELIABILITY,
+ * OR USEFULNESS OF THE SOFTWARE.
+ *
+ * You are solely responsible for determining the appropriateness of using and
+ * distributing the software and you assume all risks associated with its use,
+ * including but not limited to the risks and costs of program errors,
+ * compliance with applicable laws, damage to or loss of data, programs or
+ * equipment, and the unavailability or interruption of operation. This
+ * software is not intended to be used in any situation where a failure could
+ * cause risk of injury or damage to property. The software developed by NIST
+ * employees is not subject to copyright protection within the United States.
+ *
+ * Author: Evan Black <evan.black@nist.gov>
+ */
+
+#pragma once
+
+#include "model.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace parser {
+
+/**
+ * Scene events stored in compact columns, decoded one at a time when indexed.
+ *
+ * Each event keeps its time as an offset from the start of its block,
+ * up to 256 events long, along with its type & ID.
+ * Move events, the bulk of most scenarios, also keep their position as 16 bit fixed point
+ * within the bounds given on construction, so each takes 15 bytes rather than `sizeof(SceneEvent)`.
+ * Every other event, and moves outside the bounds, are kept whole alongside.
+ *
+ * Positions are rounded to the nearest step, see `getStep()`, so moves are not exact.
+ * Events are returned by value, rather than by reference
+ */
+class PackedSceneEvents {
+public:
+  using value_type = SceneEvent;
+
+private:
+  /**
+   * Marks an event kept whole in `others`
+   */
+  static constexpr uint8_t otherKind = 0xFFu;
+
+  /**
+   * The most events in a block
+   */
+  static constexpr std::size_t blockSize = 256u;
+
+  Ns3Coordinate origin;
+
+  /**
+   * The size of one fixed point step on each axis, in ns-3 units
+   */
+  Ns3Coordinate step;
+
+  /**
+   * Index of the first event in each block
+   */
+  std::vector<uint32_t> blockStarts;
+
+  /**
+   * Time of the first event in each block
+   */
+  std::vector<nanoseconds> blockTimes;
+
+  /**
+   * Per event: the offset of its time from the start of its block
+   */
+  std::vector<uint32_t> timeOffsets;
+
+  /**
+   * Per event: the index of its type in `SceneEvent`, or `otherKind`
+   */
+  std::vector<uint8_t> kinds;
+
+  /**
+   * Per event: the Node ID of a move, or the index in `others`
+   */
+  std::vector<uint32_t> ids;
+
+  /**
+   * Per event: the fixed point position of a move, unused otherwise
+   */
+  std::vector<std::array<uint16_t, 3>> positions;
+
+  std::vector<SceneEvent> others;
+
+  /**
+   * Add an event to the current block, starting a new one if it is full,
+   * or `time` is too far from its start
+   *
+   * @return
+   * The offset of `time` from the start of its block
+   */
+  uint32_t addTime(nanoseconds time);
+
+public:
+  /**
+   * Start an empty store
+   *
+   * @param minLocation
+   * The lowest coordinate on each axis to store moves at, see `GlobalConfiguration::minLocation`
+   *
+   * @param maxLocation
+   * The highest coordinate on each axis to store moves at, see `GlobalConfiguration::maxLocation`
+   */
+  PackedSceneEvents(const Ns3Coordinate &minLocation, const Ns3Coordinate &maxLocation);
+
+  /**
+   * Append an event. Times should not decrease,
+   * though an event earlier than the one before it is still stored
+   */
+  void push_back(const SceneEvent &event);
+
+  /**
+   * Decode the event at `index`
+   */
+  [[nodiscard]] SceneEvent operator[](std::size_t index) const;
+
+  [[nodiscard]] std::size_t size() const;
+
+  [[nodiscard]] bool empty() const;
+
+  /**
+   * @return
+   * The size of one fixed point step on each axis, in ns-3 units.
+   * Positions of moves are at most half a step away from the original
+   */
+  [[nodiscard]] const Ns3Coordinate &getStep() const;
+
+  /**
+   * @return
+   * The bytes held by the store, including unused capacity
+   */
+  [[nodiscard]] std::size_t bytes() const;
+
+  /**
+   * Release unused capacity, once every event has been added
+   */
+  void shrink();
+};
+
+} // namespace parser
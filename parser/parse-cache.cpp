@@ -0,0 +1,232 @@
+/*
+ * NIST-developed software is provided by NIST as a public service. You may use,
+ * copy and distribute copies of the software in any medium, provided that you
+ * keep intact this entire notice. You may improve,modify and create derivative
+ * works of the software or any portion of the software, and you may copy and
+ * distribute such modifications or works. Modified works should carry a notice
+ * stating that you changed the software and should note the date and nature of
+ * any such change. Please explicitly acknowledge the National Institute of
+ * Standards and Technology as the source of the software.
+ *
+ * NIST-developed software is expressly provided "AS IS." NIST MAKES NO
+ * WARRANTY OF ANY KIND, EXPRESS, IMPLIED, IN FACT OR ARISING BY OPERATION OF
+ * LAW, INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTY OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, NON-INFRINGEMENT
+ * AND DATA ACCURACY. NIST NEITHER REPRESENTS NOR WARRANTS THAT THE
+ * OPERATION OF THE SOFTWARE WILL BE UNINTERRUPTED OR ERROR-FREE, OR THAT
+ * ANY DEFECTS WILL BE CORRECTED. NIST DOES NOT WARRANT OR MAKE ANY
+ * REPRESENTATIONS REGARDING THE USE OF THE SOFTWARE OR THE RESULTS THEREOF,
+ * INCLUDING BUT NOT LIMITED TO THE CORRECTNESS, ACCURACY, RELIABILITY,
+ * OR USEFULNESS OF THE SOFTWARE.
+ *
+ * You are solely responsible for determining the appropriateness of using and
+ * distributing the software and you assume all risks associated with its use,
+ * including but not limited to the risks and costs of program errors,
+ * compliance with applicable laws, damage to or loss of data, programs or
+ * equipment, and the unavailability or interruption of operation. This
+ * software is not intended to be used in any situation where a failure could
+ * cause risk of injury or damage to property. The software developed by NIST
+ * employees is not subject to copyright protection within the United States.
+ *
+ * Author: Evan Black <evan.black@nist.gov>
+ */
+
+#include "parse-cache.h"
+#include "binary/BinaryWriter.h"
+#include "file-parser.h"
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <iostream>
+#include <memory>
+#include <sys/stat.h>
+#include <utility>
+#include <vector>
+
+namespace {
+
+/**
+ * Size of each block hashed from the scenario
+ */
+const std::size_t blockSize = 64u * 1024u;
+
+/**
+ * The number of blocks hashed between the first & last
+ */
+const std::size_t sampledBlocks = 14u;
+
+/**
+ * FNV-1a over `size` bytes of `data`, continuing from `hash`
+ */
+uint64_t fnv1a(uint64_t hash, const unsigned char *data, std::size_t size) {
+  for (std::size_t i = 0u; i < size; i++) {
+    hash ^= data[i];
+    hash *= 0x100000001b3ULL;
+  }
+  return hash;
+}
+
+uint64_t fnv1a(uint64_t hash, uint64_t value) {
+  unsigned char bytes[sizeof(value)];
+  for (auto &byte : bytes) {
+    byte = static_cast<unsigned char>(value & 0xFFu);
+    value >>= 8u;
+  }
+  return fnv1a(hash, bytes, sizeof(bytes));
+}
+
+/**
+ * @return
+ * The size & modification time of the file at `path`, if it exists
+ */
+std::optional<std::pair<uint64_t, int64_t>> fileStatus(const char *path) {
+#ifdef _WIN32
+  struct _stat64 status {};
+  if (_stat64(path, &status) != 0)
+    return {};
+#else
+  struct stat status {};
+  if (stat(path, &status) != 0)
+    return {};
+#endif
+
+  return {{static_cast<uint64_t>(status.st_size), static_cast<int64_t>(status.st_mtime)}};
+}
+
+/**
+ * The extension of every snapshot, see `ParseCache::snapshotPath()`
+ */
+const std::string snapshotExtension{".nszb"};
+
+/**
+ * The hex digits of a snapshot's key
+ */
+const std::size_t keyLength = 16u;
+
+/**
+ * @param name
+ * The name of a file, without its directory
+ *
+ * @param scenario
+ * The name of a scenario, without its directory
+ *
+ * @return
+ * True if `name` is a snapshot of `scenario`, with any key
+ */
+bool isSnapshotOf(const std::string &name, const std::string &scenario) {
+  if (name.size() != scenario.size() + 1u + keyLength + snapshotExtension.size() ||
+      name.compare(0u, scenario.size(), scenario) != 0 || name[scenario.size()] != '.' ||
+      name.compare(name.size() - snapshotExtension.size(), snapshotExtension.size(), snapshotExtension) != 0)
+    return false;
+
+  const auto key = name.substr(scenario.size() + 1u, keyLength);
+  return key.find_first_not_of("0123456789abcdef") == std::string::npos;
+}
+
+/**
+ * Remove the snapshots of the same scenario as `snapshot`, made before it was last changed.
+ * A snapshot which cannot be removed is left
+ */
+void removeOlderSnapshots(const std::string &snapshot) {
+  const std::filesystem::path path{snapshot};
+  const auto name = path.filename().string();
+  if (name.size() < 1u + keyLength + snapshotExtension.size())
+    return;
+  const auto scenario = name.substr(0u, name.size() - 1u - keyLength - snapshotExtension.size());
+
+  std::error_code error;
+  const auto folder = path.has_parent_path() ? path.parent_path() : std::filesystem::path{"."};
+  for (std::filesystem::directory_iterator entry{folder, error}, end; !error && entry != end; entry.increment(error)) {
+    const auto other = entry->path().filename().string();
+    if (other != name && isSnapshotOf(other, scenario)) {
+      std::error_code ignored;
+      std::filesystem::remove(entry->path(), ignored);
+    }
+  }
+}
+
+} // namespace
+
+namespace parser {
+
+ParseCache::ParseCache(std::string directory) : directory(std::move(directory)) {
+}
+
+std::optional<std::string> ParseCache::snapshotPath(const char *path) const {
+  const auto status = fileStatus(path);
+  if (!status)
+    return {};
+  const auto [size, modified] = status.value();
+
+  std::unique_ptr<FILE, decltype(&std::fclose)> file{std::fopen(path, "rb"), std::fclose};
+  if (!file)
+    return {};
+
+  auto hash = fnv1a(0xcbf29ce484222325ULL, size);
+  hash = fnv1a(hash, static_cast<uint64_t>(modified));
+
+  // The first & last blocks, and evenly spaced blocks between,
+  // rather than the whole file, which would take nearly as long as parsing it
+  std::vector<unsigned char> block(blockSize);
+  const auto hashBlock = [&file, &block, &hash](uint64_t offset) {
+#ifdef _WIN32
+    const auto seeked = _fseeki64(file.get(), static_cast<long long>(offset), SEEK_SET);
+#else
+    const auto seeked = fseeko(file.get(), static_cast<off_t>(offset), SEEK_SET);
+#endif
+    if (seeked != 0)
+      return;
+    const auto read = std::fread(block.data(), 1u, block.size(), file.get());
+    hash = fnv1a(hash, block.data(), read);
+  };
+
+  hashBlock(0u);
+  if (size > blockSize) {
+    for (std::size_t i = 1u; i <= sampledBlocks; i++)
+      hashBlock(size / (sampledBlocks + 1u) * i);
+    hashBlock(size - blockSize);
+  }
+
+  std::string name{path};
+  auto folder = std::string{};
+  if (const auto separator = name.find_last_of("/\\"); separator != std::string::npos) {
+    folder = name.substr(0u, separator + 1u);
+    name.erase(0u, separator + 1u);
+  }
+  if (!directory.empty()) {
+    folder = directory;
+    if (folder.back() != '/' && folder.back() != '\\')
+      folder += '/';
+  }
+
+  char key[17];
+  std::snprintf(key, sizeof(key), "%016llx", static_cast<unsigned long long>(hash));
+  return folder + name + '.' + key + snapshotExtension;
+}
+
+bool ParseCache::exists(const std::string &snapshot) {
+  return fileStatus(snapshot.c_str()).has_value();
+}
+
+bool ParseCache::write(const FileParser &parser, const std::string &snapshot) {
+  const auto temporary = snapshot + ".tmp";
+  if (auto error = binary::BinaryWriter{parser}.write(temporary.c_str())) {
+    std::cerr << "Failed to write snapshot " << snapshot << ": " << error->message << '\n';
+    std::remove(temporary.c_str());
+    return false;
+  }
+
+  // Replacing an existing file fails on Windows
+  std::remove(snapshot.c_str());
+  if (std::rename(temporary.c_str(), snapshot.c_str()) != 0) {
+    std::cerr << "Failed to move snapshot into place: " << snapshot << '\n';
+    std::remove(temporary.c_str());
+    return false;
+  }
+
+  // Only ever loaded for the scenario as it was, so they would otherwise pile up as it is regenerated
+  removeOlderSnapshots(snapshot);
+  return true;
+}
+
+} // namespace parser
@@ -0,0 +1,100 @@
+/*
+ * NIST-developed software is provided by NIST as a public service. You may use,
+ * copy and distribute copies of the software in any medium, provided that you
+ * keep intact this entire notice. You may improve,modify and create derivative
+ * works of the software or any portion of the software, and you may copy and
+ * distribute such modifications or works. Modified works should carry a notice
+ * stating that you changed the software and should note the date and nature of
+ * any such change. Please explicitly acknowledge the National Institute of
+ * Standards and Technology as the source of the software.
+ *
+ * NIST-developed software is expressly provided "AS IS." NIST MAKES NO
+ * WARRANTY OF ANY KIND, EXPRESS, IMPLIED, IN FACT OR ARISING BY OPERATION OF
+ * LAW, INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTY OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, NON-INFRINGEMENT
+ * AND DATA ACCURACY. NIST NEITHER REPRESENTS NOR WARRANTS THAT THE
+ * OPERATION OF THE SOFTWARE WILL BE UNINTERRUPTED OR ERROR-FREE, OR THAT
+ * ANY DEFECTS WILL BE CORRECTED. NIST DOES NOT WARRANT OR MAKE ANY
+ * REPRESENTATIONS REGARDING THE USE OF THE SOFTWARE OR THE RESULTS THEREOF,
+ * INCLUDING BUT NOT LIMITED TO THE CORRECTNESS, ACCURACY, RELIABILITY,
+ * OR USEFULNESS OF THE SOFTWARE.
+ *
+ * You are solely responsible for determining the appropriateness of using and
+ * distributing the software and you assume all risks associated with its use,
+ * including but not limited to the risks and costs of program errors,
+ * compliance with applicable laws, damage to or loss of data, programs or
+ * equipment, and the unavailability or interruption of operation. This
+ * software is not intended to be used in any situation where a failure could
+ * cause risk of injury or damage to property. The software developed by NIST
+ * employees is not subject to copyright protection within the United States.
+ *
+ * Author: Evan Black <evan.black@nist.gov>
+ */
+
+#pragma once
+#include <optional>
+#include <string>
+
+namespace parser {
+
+class FileParser;
+
+/**
+ * Finds & writes binary snapshots of parsed JSON scenarios, see `FileParser::setCache()`.
+ *
+ * A snapshot is named for its scenario, along with a key from the size & modification time
+ * of the scenario, and a hash of blocks sampled throughout it, so a changed scenario
+ * is parsed again, rather than loaded from an old snapshot.
+ * Writing a snapshot removes the older snapshots of the same scenario.
+ * In a shared cache directory, scenarios with the same file name are taken for the same scenario
+ */
+class ParseCache {
+  /**
+   * Where snapshots are kept. Empty to keep them next to their scenario
+   */
+  std::string directory;
+
+public:
+  /**
+   * @param directory
+   * Where to keep snapshots. Empty to keep them next to their scenario
+   */
+  explicit ParseCache(std::string directory);
+
+  /**
+   * @param path
+   * The path to a scenario
+   *
+   * @return
+   * The path to the snapshot for the scenario as it is now, which may not exist yet.
+   * Unset if the scenario could not be read
+   */
+  [[nodiscard]] std::optional<std::string> snapshotPath(const char *path) const;
+
+  /**
+   * @param snapshot
+   * The path from `snapshotPath()`
+   *
+   * @return
+   * True if that snapshot was written
+   */
+  [[nodiscard]] static bool exists(const std::string &snapshot);
+
+  /**
+   * Write the models & events of `parser` as the snapshot at `snapshot`.
+   * The snapshot is written under a temporary name, then renamed,
+   * so a partial snapshot is never read. Any older snapshot of the scenario is then removed
+   *
+   * @param parser
+   * The parser holding every model & event of the scenario
+   *
+   * @param snapshot
+   * The path from `snapshotPath()`
+   *
+   * @return
+   * True if the snapshot was written
+   */
+  static bool write(const FileParser &parser, const std::string &snapshot);
+};
+
+} // namespace parser
@@ -0,0 +1,77 @@
+/*
+ * NIST-developed software is provided by NIST as a public service. You may use,
+ * copy and distribute copies of the software in any medium, provided that you
+ * keep intact this entire notice. You may improve,modify and create derivative
+ * works of the software or any portion of the software, and you may copy and
+ * distribute such modifications or works. Modified works should carry a notice
+ * stating that you changed the software and should note the date and nature of
+ * any such change. Please explicitly acknowledge the National Institute of
+ * Standards and Technology as the source of the software.
+ *
+ * NIST-developed software is expressly provided "AS IS." NIST MAKES NO
+ * WARRANTY OF ANY KIND, EXPRESS, IMPLIED, IN FACT OR ARISING BY OPERATION OF
+ * LAW, INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTY OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, NON-INFRINGEMENT
+ * AND DATA ACCURACY. NIST NEITHER REPRESENTS NOR WARRANTS THAT THE
+ * OPERATION OF THE SOFTWARE WILL BE UNINTERRUPTED OR ERROR-FREE, OR THAT
+ * ANY DEFECTS WILL BE CORRECTED. NIST DOES NOT WARRANT OR MAKE ANY
+ * REPRESENTATIONS REGARDING THE USE OF THE SOFTWARE OR THE RESULTS THEREOF,
+ * INCLUDING BUT NOT LIMITED TO THE CORRECTNESS, ACCURACY, RELIABILITY,
+ * OR USEFULNESS OF THE SOFTWARE.
+ *
+ * You are solely responsible for determining the appropriateness of using and
+ * distributing the software and you assume all risks associated with its use,
+ * including but not limited to the risks and costs of program errors,
+ * compliance with applicable laws, damage to or loss of data, programs or
+ * equipment, and the unavailability or interruption of operation. This
+ * software is not intended to be used in any situation where a failure could
+ * cause risk of injury or damage to property. The software developed by NIST
+ * employees is not subject to copyright protection within the United States.
+ *
+ * Author: Evan Black <evan.black@nist.gov>
+ */
+
+#include "parse-filter.h"
+#include "handler/JsonHandler.h"
+#include <algorithm>
+
+namespace {
+
+bool allows(const std::vector<unsigned int> &ids, unsigned int id) {
+  return ids.empty() || std::binary_search(ids.begin(), ids.end(), id);
+}
+
+} // namespace
+
+namespace parser {
+
+bool ParseFilter::drop(std::string_view type) {
+  const auto parsed = JsonHandler::eventType(type);
+  if (parsed == RawEvent::Type::Unknown)
+    return false;
+
+  droppedTypes |= 1u << static_cast<uint8_t>(parsed);
+  return true;
+}
+
+bool ParseFilter::active() const {
+  return begin || end || !nodes.empty() || !series.empty() || !streams.empty() || droppedTypes != 0u;
+}
+
+bool ParseFilter::keepsType(RawEvent::Type type) const {
+  return (droppedTypes & (1u << static_cast<uint8_t>(type))) == 0u;
+}
+
+bool ParseFilter::keepsNode(unsigned int id) const {
+  return allows(nodes, id);
+}
+
+bool ParseFilter::keepsSeries(unsigned int id) const {
+  return allows(series, id);
+}
+
+bool ParseFilter::keepsStream(unsigned int id) const {
+  return allows(streams, id);
+}
+
+} // namespace parser
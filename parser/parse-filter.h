@@ -0,0 +1,134 @@
+/*
+ * NIST-developed software is provided by NIST as a public service. You may use,
+ * copy and distribute copies of the software in any medium, provided that you
+ * keep intact this entire notice. You may improve,modify and create derivative
+ * works of the software or any portion of the software, and you may copy and
+ * distribute such modifications or works. Modified works should carry a notice
+ * stating that you changed the software and should note the date and nature of
+ * any such change. Please explicitly acknowledge the National Institute of
+ * Standards and Technology as the source of the software.
+ *
+ * NIST-developed software is expressly provided "AS IS." NIST MAKES NO
+ * WARRANTY OF ANY KIND, EXPRESS, IMPLIED, IN FACT OR ARISING BY OPERATION OF
+ * LAW, INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTY OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, NON-INFRINGEMENT
+ * AND DATA ACCURACY. NIST NEITHER REPRESENTS NOR WARRANTS THAT THE
+ * OPERATION OF THE SOFTWARE WILL BE UNINTERRUPTED OR ERROR-FREE, OR THAT
+ * ANY DEFECTS WILL BE CORRECTED. NIST DOES NOT WARRANT OR MAKE ANY
+ * REPRESENTATIONS REGARDING THE USE OF THE SOFTWARE OR THE RESULTS THEREOF,
+ * INCLUDING BUT NOT LIMITED TO THE CORRECTNESS, ACCURACY, RELIABILITY,
+ * OR USEFULNESS OF THE SOFTWARE.
+ *
+ * You are solely responsible for determining the appropriateness of using and
+ * distributing the software and you assume all risks associated with its use,
+ * including but not limited to the risks and costs of program errors,
+ * compliance with applicable laws, damage to or loss of data, programs or
+ * equipment, and the unavailability or interruption of operation. This
+ * software is not intended to be used in any situation where a failure could
+ * cause risk of injury or damage to property. The software developed by NIST
+ * employees is not subject to copyright protection within the United States.
+ *
+ * Author: Evan Black <evan.black@nist.gov>
+ */
+
+#pragma once
+#include "handler/RawEvent.h"
+#include "model.h"
+#include <cstdint>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+namespace parser {
+
+/**
+ * Which parts of a JSON scenario to keep, see `FileParser::setFilter()`.
+ *
+ * Events are checked as each one is read, before it is stored,
+ * so the events filtered out are never kept in memory.
+ * A default constructed filter keeps everything
+ */
+struct ParseFilter {
+  /**
+   * The earliest time of the events to keep, if any.
+   *
+   * The position, orientation & color changes of each Node & Decoration before this time
+   * are folded into one event each, at this time, so the scene starts the window
+   * the way it would have been. Every other event before this time is dropped,
+   * including transmissions which last into the window
+   */
+  std::optional<nanoseconds> begin;
+
+  /**
+   * The latest time of the events to keep, if any
+   */
+  std::optional<nanoseconds> end;
+
+  /**
+   * The IDs of the Nodes to keep, with their events, in ascending order.
+   * Empty to keep every Node.
+   * Links to a Node which is not kept are dropped as well
+   */
+  std::vector<unsigned int> nodes;
+
+  /**
+   * The IDs of the series to keep, with their events, in ascending order.
+   * Empty to keep every series.
+   * Collections only keep the series which are kept
+   */
+  std::vector<unsigned int> series;
+
+  /**
+   * The IDs of the log streams to keep, with their events, in ascending order.
+   * Empty to keep every stream
+   */
+  std::vector<unsigned int> streams;
+
+  /**
+   * Bitmask of the `RawEvent::Type`s to drop
+   */
+  uint32_t droppedTypes{0u};
+
+  /**
+   * Drop every event of a type
+   *
+   * @param type
+   * The 'type' of the events to drop, as it appears in the file (e.g. 'node-position')
+   *
+   * @return
+   * False if `type` is not a known event type
+   */
+  bool drop(std::string_view type);
+
+  /**
+   * @return
+   * True if anything is filtered out
+   */
+  [[nodiscard]] bool active() const;
+
+  /**
+   * @return
+   * True if events of `type` are kept
+   */
+  [[nodiscard]] bool keepsType(RawEvent::Type type) const;
+
+  /**
+   * @return
+   * True if the Node with `id` is kept
+   */
+  [[nodiscard]] bool keepsNode(unsigned int id) const;
+
+  /**
+   * @return
+   * True if the series with `id` is kept
+   */
+  [[nodiscard]] bool keepsSeries(unsigned int id) const;
+
+  /**
+   * @return
+   * True if the stream with `id` is kept
+   */
+  [[nodiscard]] bool keepsStream(unsigned int id) const;
+};
+
+} // namespace parser
@@ -0,0 +1,109 @@
+/*
+ * NIST-developed software is provided by NIST as a public service. You may use,
+ * copy and distribute copies of the software in any medium, provided that you
+ * keep intact this entire notice. You may improve,modify and create derivative
+ * works of the software or any portion of the software, and you may copy and
+ * distribute such modifications or works. Modified works should carry a notice
+ * stating that you changed the software and should note the date and nature of
+ * any such change. Please explicitly acknowledge the National Institute of
+ * Standards and Technology as the source of the software.
+ *
+ * NIST-developed software is expressly provided "AS IS." NIST MAKES NO
+ * WARRANTY OF ANY KIND, EXPRESS, IMPLIED, IN FACT OR ARISING BY OPERATION OF
+ * LAW, INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTY OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, NON-INFRINGEMENT
+ * AND DATA ACCURACY. NIST NEITHER REPRESENTS NOR WARRANTS THAT THE
+ * OPERATION OF THE SOFTWARE WILL BE UNINTERRUPTED OR ERROR-FREE, OR THAT
+ * ANY DEFECTS WILL BE CORRECTED. NIST DOES NOT WARRANT OR MAKE ANY
+ * REPRESENTATIONS REGARDING THE USE OF THE SOFTWARE OR THE RESULTS THEREOF,
+ * INCLUDING BUT NOT LIMITED TO THE CORRECTNESS, ACCURACY, RELIABILITY,
+ * OR USEFULNESS OF THE SOFTWARE.
+ *
+ * You are solely responsible for determining the appropriateness of using and
+ * distributing the software and you assume all risks associated with its use,
+ * including but not limited to the risks and costs of program errors,
+ * compliance with applicable laws, damage to or loss of data, programs or
+ * equipment, and the unavailability or interruption of operation. This
+ * software is not intended to be used in any situation where a failure could
+ * cause risk of injury or damage to property. The software developed by NIST
+ * employees is not subject to copyright protection within the United States.
+ *
+ * Author: Evan Black <evan.black@nist.gov>
+ */
+
+#pragma once
+
+#include "model.h"
+
+namespace parser {
+
+/**
+ * Receives each model & event of a scenario as soon as it is parsed,
+ * see `FileParser::parse(const char *, ParseSink &)`.
+ *
+ * Nothing is kept by the parser once it is passed on,
+ * so a sink which only counts or filters runs in constant memory.
+ * Every function does nothing by default, so a sink only overrides what it uses
+ */
+class ParseSink {
+public:
+  virtual ~ParseSink() = default;
+
+  /**
+   * The 'configuration' section, once it is parsed.
+   * The end time & location bounds are only complete in `finish()`
+   */
+  virtual void configure([[maybe_unused]] const GlobalConfiguration &configuration) {
+  }
+
+  virtual void addNode([[maybe_unused]] Node &&node) {
+  }
+
+  virtual void addBuilding([[maybe_unused]] Building &&building) {
+  }
+
+  virtual void addDecoration([[maybe_unused]] Decoration &&decoration) {
+  }
+
+  virtual void addArea([[maybe_unused]] Area &&area) {
+  }
+
+  virtual void addLink([[maybe_unused]] WiredLink &&link) {
+  }
+
+  virtual void addXYSeries([[maybe_unused]] XYSeries &&series) {
+  }
+
+  virtual void addCategoryValueSeries([[maybe_unused]] CategoryValueSeries &&series) {
+  }
+
+  virtual void addSeriesCollection([[maybe_unused]] SeriesCollection &&collection) {
+  }
+
+  virtual void addLogStream([[maybe_unused]] LogStream &&stream) {
+  }
+
+  /**
+   * Events are passed in the order of the file, with each `TransmitEndEvent`
+   * inserted by the parser passed before the first event at or after its time
+   */
+  virtual void addSceneEvent([[maybe_unused]] SceneEvent &&event) {
+  }
+
+  virtual void addChartEvent([[maybe_unused]] ChartEvent &&event) {
+  }
+
+  virtual void addLogEvent([[maybe_unused]] LogEvent &&event) {
+  }
+
+  /**
+   * Every model & event has been passed
+   *
+   * @param configuration
+   * The configuration, with the end time & location bounds of the whole scenario
+   */
+  virtual void finish([[maybe_unused]] const GlobalConfiguration &configuration) {
+  }
+};
+
+} // namespace parser
@@ -0,0 +1,334 @@
+/*
+ * NIST-developed software is provided by NIST as a public service. You may use,
+ * copy and distribute copies of the software in any medium, provided that you
+ * keep intact this entire notice. You may improve,modify and create derivative
+ * works of the software or any portion of the software, and you may copy and
+ * distribute such modifications or works. Modified works should carry a notice
+ * stating that you changed the software and should note the date and nature of
+ * any such change. Please explicitly acknowledge the National Institute of
+ * Standards and Technology as the source of the software.
+ *
+ * NIST-developed software is expressly provided "AS IS." NIST MAKES NO
+ * WARRANTY OF ANY KIND, EXPRESS, IMPLIED, IN FACT OR ARISING BY OPERATION OF
+ * LAW, INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTY OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, NON-INFRINGEMENT
+ * AND DATA ACCURACY. NIST NEITHER REPRESENTS NOR WARRANTS THAT THE
+ * OPERATION OF THE SOFTWARE WILL BE UNINTERRUPTED OR ERROR-FREE, OR THAT
+ * ANY DEFECTS WILL BE CORRECTED. NIST DOES NOT WARRANT OR MAKE ANY
+ * REPRESENTATIONS REGARDING THE USE OF THE SOFTWARE OR THE RESULTS THEREOF,
+ * INCLUDING BUT NOT LIMITED TO THE CORRECTNESS, ACCURACY, RELIABILITY,
+ * OR USEFULNESS OF THE SOFTWARE.
+ *
+ * You are solely responsible for determining the appropriateness of using and
+ * distributing the software and you assume all risks associated with its use,
+ * including but not limited to the risks and costs of program errors,
+ * compliance with applicable laws, damage to or loss of data, programs or
+ * equipment, and the unavailability or interruption of operation. This
+ * software is not intended to be used in any situation where a failure could
+ * cause risk of injury or damage to property. The software developed by NIST
+ * employees is not subject to copyright protection within the United States.
+ *
+ * Author: Evan Black <evan.black@nist.gov>
+ */
+
+#include "scenario-summary.h"
+#include "task-pool.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <rapidjson/ostreamwrapper.h>
+#include <rapidjson/prettywriter.h>
+#include <thread>
+#include <type_traits>
+#include <unordered_map>
+#include <variant>
+
+namespace {
+
+/**
+ * The type names of each alternative of `SceneEvent`, as in the scenario.
+ * Null for those not read from the scenario
+ */
+constexpr std::array<const char *, std::variant_size_v<parser::SceneEvent>> sceneEventTypes{
+    "node-position",       "node-transmit",         nullptr, "node-orientation", "node-color",
+    "decoration-position", "decoration-orientation"};
+
+constexpr std::array<const char *, std::variant_size_v<parser::ChartEvent>> chartEventTypes{
+    "xy-series-append", "xy-series-append-array", "xy-series-clear", "category-series-append"};
+
+constexpr std::array<const char *, std::variant_size_v<parser::LogEvent>> logEventTypes{"stream-append"};
+
+/**
+ * Fewer events than this are reduced on one thread
+ */
+constexpr std::size_t minimumRange = 65'536u;
+
+/**
+ * The motion & traffic of one Node over one range of events
+ */
+struct NodePart {
+  std::size_t moves{0u};
+
+  /**
+   * Between the moves in the range only.
+   * The step onto `first` is added once the position before the range is known
+   */
+  double distance{0.0};
+  parser::Ns3Coordinate first;
+  parser::Ns3Coordinate last;
+  std::size_t transmissions{0u};
+  parser::nanoseconds transmitDuration{0LL};
+};
+
+/**
+ * The reduction of one range of the scene events
+ */
+struct ScenePart {
+  std::array<std::size_t, std::variant_size_v<parser::SceneEvent>> counts{};
+
+  /**
+   * By the slot of the Node, only for those with events in the range
+   */
+  std::unordered_map<std::uint32_t, NodePart> nodes;
+};
+
+double distance(const parser::Ns3Coordinate &a, const parser::Ns3Coordinate &b) {
+  const auto x = static_cast<double>(b.x) - a.x;
+  const auto y = static_cast<double>(b.y) - a.y;
+  const auto z = static_cast<double>(b.z) - a.z;
+  return std::sqrt(x * x + y * y + z * z);
+}
+
+/**
+ * Split `count` events into ranges of at least `minimumRange`, a few per thread,
+ * so uneven ranges still balance
+ */
+std::size_t rangeCount(std::size_t count, unsigned int threads) {
+  return std::clamp<std::size_t>(count / minimumRange, 1u, static_cast<std::size_t>(threads) * 4u);
+}
+
+template <class Variant>
+std::array<std::size_t, std::variant_size_v<Variant>> countTypes(const std::vector<Variant> &events,
+                                                                 unsigned int threads) {
+  using Counts = std::array<std::size_t, std::variant_size_v<Variant>>;
+  const auto ranges = rangeCount(events.size(), threads);
+  std::vector<Counts> parts(ranges, Counts{});
+
+  parser::TaskPool::shared().parallelFor(ranges, threads, parser::TaskPool::Priority::Normal, [&](std::size_t i) {
+    const auto begin = events.size() * i / ranges;
+    const auto end = events.size() * (i + 1u) / ranges;
+    for (auto e = begin; e < end; e++)
+      parts[i][events[e].index()]++;
+  });
+
+  Counts counts{};
+  for (const auto &part : parts) {
+    for (auto type = 0u; type < counts.size(); type++)
+      counts[type] += part[type];
+  }
+  return counts;
+}
+
+template <std::size_t N>
+void addCounts(std::vector<parser::EventCount> &events, const std::array<const char *, N> &types,
+               const std::array<std::size_t, N> &counts) {
+  for (auto type = 0u; type < N; type++) {
+    if (types[type])
+      events.emplace_back(parser::EventCount{types[type], counts[type]});
+  }
+}
+
+void writeDouble(rapidjson::PrettyWriter<rapidjson::OStreamWrapper> &writer, double value) {
+  if (std::isnan(value))
+    writer.Null();
+  else
+    writer.Double(value);
+}
+
+} // namespace
+
+namespace parser {
+
+ScenarioSummary summarize(const FileParser &fileParser, unsigned int threads) {
+  if (threads == 0u)
+    threads = std::max(1u, std::thread::hardware_concurrency());
+
+  ScenarioSummary summary;
+  summary.endTime = fileParser.getConfiguration().endTime;
+  summary.nodes = fileParser.getNodes().size();
+  summary.buildings = fileParser.getBuildings().size();
+  summary.areas = fileParser.getAreas().size();
+  summary.decorations = fileParser.getDecorations().size();
+  summary.links = fileParser.getLinks().size();
+  summary.xySeries = fileParser.getXYSeries().size();
+  summary.categoryValueSeries = fileParser.getCategoryValueSeries().size();
+  summary.logStreams = fileParser.getLogStreams().size();
+
+  const auto &nodes = fileParser.getNodes();
+  std::unordered_map<unsigned int, std::uint32_t> slots;
+  slots.reserve(nodes.size());
+  summary.nodeSummaries.reserve(nodes.size());
+  for (const auto &node : nodes) {
+    // Events go to the first Node with an ID
+    slots.emplace(node.id, static_cast<std::uint32_t>(summary.nodeSummaries.size()));
+    summary.nodeSummaries.emplace_back(NodeSummary{node.id, node.name});
+  }
+
+  const auto &events = fileParser.getSceneEvents();
+  const auto ranges = rangeCount(events.size(), threads);
+  std::vector<ScenePart> parts(ranges);
+
+  TaskPool::shared().parallelFor(ranges, threads, TaskPool::Priority::Normal, [&](std::size_t i) {
+    auto &part = parts[i];
+    const auto begin = events.size() * i / ranges;
+    const auto end = events.size() * (i + 1u) / ranges;
+    for (auto e = begin; e < end; e++) {
+      const auto &event = events[e];
+      part.counts[event.index()]++;
+
+      if (const auto move = std::get_if<MoveEvent>(&event)) {
+        const auto slot = slots.find(move->nodeId);
+        if (slot == slots.end())
+          continue;
+
+        auto &node = part.nodes[slot->second];
+        if (node.moves == 0u)
+          node.first = move->targetPosition;
+        else
+          node.distance += distance(node.last, move->targetPosition);
+        node.last = move->targetPosition;
+        node.moves++;
+      } else if (const auto transmit = std::get_if<TransmitEvent>(&event)) {
+        const auto slot = slots.find(transmit->nodeId);
+        if (slot == slots.end())
+          continue;
+
+        auto &node = part.nodes[slot->second];
+        node.transmissions++;
+        node.transmitDuration += transmit->duration;
+      }
+    }
+  });
+
+  // Combined in order, so each range's first move is measured from where the one before left the Node
+  std::vector<Ns3Coordinate> positions;
+  positions.reserve(nodes.size());
+  for (const auto &node : nodes)
+    positions.emplace_back(node.position);
+
+  std::array<std::size_t, std::variant_size_v<SceneEvent>> sceneCounts{};
+  for (const auto &part : parts) {
+    for (auto type = 0u; type < sceneCounts.size(); type++)
+      sceneCounts[type] += part.counts[type];
+
+    for (const auto &[slot, node] : part.nodes) {
+      auto &total = summary.nodeSummaries[slot];
+      if (node.moves > 0u) {
+        total.distance += distance(positions[slot], node.first) + node.distance;
+        positions[slot] = node.last;
+      }
+      total.moves += node.moves;
+      total.transmissions += node.transmissions;
+      total.transmitDuration += node.transmitDuration;
+    }
+  }
+
+  addCounts(summary.events, sceneEventTypes, sceneCounts);
+  addCounts(summary.events, chartEventTypes, countTypes(fileParser.getChartsEvents(), threads));
+  addCounts(summary.events, logEventTypes, countTypes(fileParser.getLogEvents(), threads));
+
+  const auto series =
+      collectSeries(fileParser.getXYSeries(), fileParser.getCategoryValueSeries(), fileParser.getChartsEvents());
+  summary.series = computeStatistics(series, std::numeric_limits<nanoseconds>::lowest(),
+                                     std::numeric_limits<nanoseconds>::max(), threads);
+
+  return summary;
+}
+
+void writeSummaryJson(std::ostream &out, const ScenarioSummary &summary) {
+  rapidjson::OStreamWrapper stream{out};
+  rapidjson::PrettyWriter<rapidjson::OStreamWrapper> writer{stream};
+
+  writer.StartObject();
+  writer.Key("end-time");
+  writer.Int64(summary.endTime);
+
+  writer.Key("counts");
+  writer.StartObject();
+  const auto writeCount = [&writer](const char *key, std::size_t count) {
+    writer.Key(key);
+    writer.Uint64(count);
+  };
+  writeCount("nodes", summary.nodes);
+  writeCount("buildings", summary.buildings);
+  writeCount("areas", summary.areas);
+  writeCount("decorations", summary.decorations);
+  writeCount("links", summary.links);
+  writeCount("xy-series", summary.xySeries);
+  writeCount("category-value-series", summary.categoryValueSeries);
+  writeCount("log-streams", summary.logStreams);
+  writer.EndObject();
+
+  writer.Key("events");
+  writer.StartObject();
+  for (const auto &[type, count] : summary.events)
+    writeCount(type.c_str(), count);
+  writer.EndObject();
+
+  writer.Key("nodes");
+  writer.StartArray();
+  for (const auto &node : summary.nodeSummaries) {
+    writer.StartObject();
+    writer.Key("id");
+    writer.Uint(node.id);
+    writer.Key("name");
+    writer.String(node.name.c_str(), static_cast<rapidjson::SizeType>(node.name.size()));
+    writer.Key("moves");
+    writer.Uint64(node.moves);
+    writer.Key("distance");
+    writer.Double(node.distance);
+    writer.Key("transmissions");
+    writer.Uint64(node.transmissions);
+    writer.Key("transmit-duration");
+    writer.Int64(node.transmitDuration);
+    writer.EndObject();
+  }
+  writer.EndArray();
+
+  writer.Key("series");
+  writer.StartArray();
+  for (const auto &series : summary.series) {
+    writer.StartObject();
+    writer.Key("id");
+    writer.Uint(series.id);
+    writer.Key("name");
+    writer.String(series.name.c_str(), static_cast<rapidjson::SizeType>(series.name.size()));
+    writer.Key("count");
+    writer.Uint64(series.count);
+    writer.Key("min");
+    writeDouble(writer, series.min);
+    writer.Key("max");
+    writeDouble(writer, series.max);
+    writer.Key("mean");
+    writeDouble(writer, series.mean);
+    writer.EndObject();
+  }
+  writer.EndArray();
+
+  writer.EndObject();
+  out << '\n';
+}
+
+void writeNodeSummaryCsv(std::ostream &out, const ScenarioSummary &summary) {
+  const auto precision = out.precision(std::numeric_limits<double>::digits10);
+  out << "id,name,moves,distance,transmissions,transmit_duration\n";
+  for (const auto &node : summary.nodeSummaries) {
+    out << node.id << ',' << csvField(node.name) << ',' << node.moves << ',' << node.distance << ','
+        << node.transmissions << ',' << node.transmitDuration << '\n';
+  }
+  out.precision(precision);
+}
+
+} // namespace parser
@@ -0,0 +1,144 @@
+/*
+ * NIST-developed software is provided by NIST as a public service. You may use,
+ * copy and distribute copies of the software in any medium, provided that you
+ * keep intact this entire notice. You may improve,modify and create derivative
+ * works of the software or any portion of the software, and you may copy and
+ * distribute such modifications or works. Modified works should carry a notice
+ * stating that you changed the software and should note the date and nature of
+ * any such change. Please explicitly acknowledge the National Institute of
+ * Standards and Technology as the source of the software.
+ *
+ * NIST-developed software is expressly provided "AS IS." NIST MAKES NO
+ * WARRANTY OF ANY KIND, EXPRESS, IMPLIED, IN FACT OR ARISING BY OPERATION OF
+ * LAW, INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTY OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, NON-INFRINGEMENT
+ * AND DATA ACCURACY. NIST NEITHER REPRESENTS NOR WARRANTS THAT THE
+ * OPERATION OF THE SOFTWARE WILL BE UNINTERRUPTED OR ERROR-FREE, OR THAT
+ * ANY DEFECTS WILL BE CORRECTED. NIST DOES NOT WARRANT OR MAKE ANY
+ * REPRESENTATIONS REGARDING THE USE OF THE SOFTWARE OR THE RESULTS THEREOF,
+ * INCLUDING BUT NOT LIMITED TO THE CORRECTNESS, ACCURACY, RELIABILITY,
+ * OR USEFULNESS OF THE SOFTWARE.
+ *
+ * You are solely responsible for determining the appropriateness of using and
+ * distributing the software and you assume all risks associated with its use,
+ * including but not limited to the risks and costs of program errors,
+ * compliance with applicable laws, damage to or loss of data, programs or
+ * equipment, and the unavailability or interruption of operation. This
+ * software is not intended to be used in any situation where a failure could
+ * cause risk of injury or damage to property. The software developed by NIST
+ * employees is not subject to copyright protection within the United States.
+ *
+ * Author: Evan Black <evan.black@nist.gov>
+ */
+
+#pragma once
+
+#include "file-parser.h"
+#include "model.h"
+#include "series-stats.h"
+#include <cstddef>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace parser {
+
+/**
+ * The motion & traffic of one Node over the whole scenario
+ */
+struct NodeSummary {
+  unsigned int id{0u};
+  std::string name;
+  std::size_t moves{0u};
+
+  /**
+   * The straight line distance between each position the Node moved to, in ns-3 units
+   */
+  double distance{0.0};
+  std::size_t transmissions{0u};
+
+  /**
+   * The sum of the durations of every transmission
+   */
+  nanoseconds transmitDuration{0LL};
+};
+
+/**
+ * The number of events of one type, by the type name in the scenario
+ */
+struct EventCount {
+  std::string type;
+  std::size_t count{0u};
+};
+
+/**
+ * Counts & aggregates of a parsed scenario, see `summarize()`
+ */
+struct ScenarioSummary {
+  nanoseconds endTime{0LL};
+  std::size_t nodes{0u};
+  std::size_t buildings{0u};
+  std::size_t areas{0u};
+  std::size_t decorations{0u};
+  std::size_t links{0u};
+  std::size_t xySeries{0u};
+  std::size_t categoryValueSeries{0u};
+  std::size_t logStreams{0u};
+
+  /**
+   * Every event type of the scenario format, including those with no events.
+   * Transmission ends are not counted, as the parser inserts them
+   */
+  std::vector<EventCount> events;
+
+  /**
+   * By the order of the Nodes in the scenario
+   */
+  std::vector<NodeSummary> nodeSummaries;
+
+  /**
+   * Of the whole run of each series
+   */
+  std::vector<SeriesStatistics> series;
+};
+
+/**
+ * Count the models & events of a parsed scenario, and aggregate the motion & traffic of each Node,
+ * & the values of each series. The events are split into ranges reduced on separate threads,
+ * then the partial results are combined in order
+ *
+ * @param fileParser
+ * A parser which has parsed a scenario
+ *
+ * @param threads
+ * The most threads to use, or 0 for one per core
+ *
+ * @return
+ * The summary of the scenario
+ */
+[[nodiscard]] ScenarioSummary summarize(const FileParser &fileParser, unsigned int threads = 0u);
+
+/**
+ * Write the whole summary as one JSON object.
+ * Aggregates of series with no points are written as null
+ *
+ * @param out
+ * Where to write the object
+ *
+ * @param summary
+ * The summary to write
+ */
+void writeSummaryJson(std::ostream &out, const ScenarioSummary &summary);
+
+/**
+ * Write one CSV row per Node, after a header row
+ *
+ * @param out
+ * Where to write the rows
+ *
+ * @param summary
+ * The summary with the Nodes to write
+ */
+void writeNodeSummaryCsv(std::ostream &out, const ScenarioSummary &summary);
+
+} // namespace parser
@@ -0,0 +1,194 @@
+/*
+ * NIST-developed software is provided by NIST as a public service. You may use,
+ * copy and distribute copies of the software in any medium, provided that you
+ * keep intact this entire notice. You may improve,modify and create derivative
+ * works of the software or any portion of the software, and you may copy and
+ * distribute such modifications or works. Modified works should carry a notice
+ * stating that you changed the software and should note the date and nature of
+ * any such change. Please explicitly acknowledge the National Institute of
+ * Standards and Technology as the source of the software.
+ *
+ * NIST-developed software is expressly provided "AS IS." NIST MAKES NO
+ * WARRANTY OF ANY KIND, EXPRESS, IMPLIED, IN FACT OR ARISING BY OPERATION OF
+ * LAW, INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTY OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, NON-INFRINGEMENT
+ * AND DATA ACCURACY. NIST NEITHER REPRESENTS NOR WARRANTS THAT THE
+ * OPERATION OF THE SOFTWARE WILL BE UNINTERRUPTED OR ERROR-FREE, OR THAT
+ * ANY DEFECTS WILL BE CORRECTED. NIST DOES NOT WARRANT OR MAKE ANY
+ * REPRESENTATIONS REGARDING THE USE OF THE SOFTWARE OR THE RESULTS THEREOF,
+ * INCLUDING BUT NOT LIMITED TO THE CORRECTNESS, ACCURACY, RELIABILITY,
+ * OR USEFULNESS OF THE SOFTWARE.
+ *
+ * You are solely responsible for determining the appropriateness of using and
+ * distributing the software and you assume all risks associated with its use,
+ * including but not limited to the risks and costs of program errors,
+ * compliance with applicable laws, damage to or loss of data, programs or
+ * equipment, and the unavailability or interruption of operation. This
+ * software is not intended to be used in any situation where a failure could
+ * cause risk of injury or damage to property. The software developed by NIST
+ * employees is not subject to copyright protection within the United States.
+ *
+ * Author: Evan Black <evan.black@nist.gov>
+ */
+
+#include "scene-hash.h"
+#include <cstring>
+#include <optional>
+#include <string>
+#include <type_traits>
+
+namespace parser {
+
+namespace {
+
+/**
+ * FNV-1a over the fields of the scene, fed one value at a time
+ */
+class SceneHasher {
+  uint64_t hash{0xcbf29ce484222325ULL};
+
+  void bytes(const void *data, std::size_t size) {
+    const auto begin = static_cast<const unsigned char *>(data);
+    for (std::size_t i = 0u; i < size; i++) {
+      hash ^= begin[i];
+      hash *= 0x100000001b3ULL;
+    }
+  }
+
+public:
+  // Arithmetic values & enums are hashed by their bytes, so -0.0 & 0.0 differ,
+  // which is fine for telling apart scenes written by the same simulation
+  template <typename T>
+  std::enable_if_t<std::is_arithmetic_v<T> || std::is_enum_v<T>> add(T value) {
+    unsigned char buffer[sizeof(T)];
+    std::memcpy(buffer, &value, sizeof(T));
+    bytes(buffer, sizeof(T));
+  }
+
+  void add(const std::string &value) {
+    // Keeps "ab" + "c" from matching "a" + "bc"
+    add(value.size());
+    bytes(value.data(), value.size());
+  }
+
+  void add(const Ns3Coordinate &value) {
+    add(value.x);
+    add(value.y);
+    add(value.z);
+  }
+
+  void add(const Ns3Color3 &value) {
+    add(value.red);
+    add(value.green);
+    add(value.blue);
+  }
+
+  void add(const NodeLight &value) {
+    add(value.color);
+    add(value.intensity);
+    add(value.range);
+    add(value.offset);
+    add(value.direction);
+    add(value.cone);
+  }
+
+  template <typename T, std::size_t N>
+  void add(const std::array<T, N> &values) {
+    for (const auto &value : values)
+      add(value);
+  }
+
+  template <typename T>
+  void add(const std::optional<T> &value) {
+    add(value.has_value());
+    if (value)
+      add(value.value());
+  }
+
+  [[nodiscard]] uint64_t value() const {
+    return hash;
+  }
+};
+
+} // namespace
+
+uint64_t hashScene(const FileParser &parser) {
+  SceneHasher hasher;
+
+  const auto &nodes = parser.getNodes();
+  hasher.add(nodes.size());
+  for (const auto &node : nodes) {
+    hasher.add(node.id);
+    hasher.add(node.name);
+    hasher.add(node.labelEnabled);
+    hasher.add(node.model.str());
+    hasher.add(node.scale);
+    hasher.add(node.keepRatio);
+    hasher.add(node.height);
+    hasher.add(node.width);
+    hasher.add(node.depth);
+    hasher.add(node.visible);
+    hasher.add(node.position);
+    hasher.add(node.offset);
+    hasher.add(node.baseColor);
+    hasher.add(node.highlightColor);
+    hasher.add(node.trailEnabled);
+    hasher.add(node.trailColor);
+    hasher.add(node.orientation);
+    hasher.add(node.light);
+  }
+
+  const auto &buildings = parser.getBuildings();
+  hasher.add(buildings.size());
+  for (const auto &building : buildings) {
+    hasher.add(building.id);
+    hasher.add(building.color);
+    hasher.add(building.visible);
+    hasher.add(building.floors);
+    hasher.add(building.roomsX);
+    hasher.add(building.roomsY);
+    hasher.add(building.min);
+    hasher.add(building.max);
+  }
+
+  const auto &areas = parser.getAreas();
+  hasher.add(areas.size());
+  for (const auto &area : areas) {
+    hasher.add(area.id);
+    hasher.add(area.name);
+    hasher.add(area.fillColor);
+    hasher.add(area.fillMode);
+    hasher.add(area.borderColor);
+    hasher.add(area.borderMode);
+    hasher.add(area.height);
+    hasher.add(area.points.size());
+    for (const auto &point : area.points)
+      hasher.add(point);
+  }
+
+  const auto &decorations = parser.getDecorations();
+  hasher.add(decorations.size());
+  for (const auto &decoration : decorations) {
+    hasher.add(decoration.id);
+    hasher.add(decoration.model.str());
+    hasher.add(decoration.position);
+    hasher.add(decoration.orientation);
+    hasher.add(decoration.keepRatio);
+    hasher.add(decoration.height);
+    hasher.add(decoration.width);
+    hasher.add(decoration.depth);
+    hasher.add(decoration.scale);
+  }
+
+  const auto &links = parser.getLinks();
+  hasher.add(links.size());
+  for (const auto &link : links) {
+    hasher.add(link.nodes.size());
+    for (const auto id : link.nodes)
+      hasher.add(id);
+  }
+
+  return hasher.value();
+}
+
+} // namespace parser
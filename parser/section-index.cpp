@@ -0,0 +1,306 @@
+/*
+ * NIST-developed software is provided by NIST as a public service. You may use,
+ * copy and distribute copies of the software in any medium, provided that you
+ * keep intact this entire notice. You may improve,modify and create derivative
+ * works of the software or any portion of the software, and you may copy and
+ * distribute such modifications or works. Modified works should carry a notice
+ * stating that you changed the software and should note the date and nature of
+ * any such change. Please explicitly acknowledge the National Institute of
+ * Standards and Technology as the source of the software.
+ *
+ * NIST-developed software is expressly provided "AS IS." NIST MAKES NO
+ * WARRANTY OF ANY KIND, EXPRESS, IMPLIED, IN FACT OR ARISING BY OPERATION OF
+ * LAW, INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTY OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, NON-INFRINGEMENT
+ * AND DATA ACCURACY. NIST NEITHER REPRESENTS NOR WARRANTS THAT THE
+ * OPERATION OF THE SOFTWARE WILL BE UNINTERRUPTED OR ERROR-FREE, OR THAT
+ * ANY DEFECTS WILL BE CORRECTED. NIST DOES NOT WARRANT OR MAKE ANY
+ * REPRESENTATIONS REGARDING THE USE OF THE SOFTWARE OR THE RESULTS THEREOF,
+ * INCLUDING BUT NOT LIMITED TO THE CORRECTNESS, ACCURACY, RELIABILITY,
+ * OR USEFULNESS OF THE SOFTWARE.
+ *
+ * You are solely responsible for determining the appropriateness of using and
+ * distributing the software and you assume all risks associated with its use,
+ * including but not limited to the risks and costs of program errors,
+ * compliance with applicable laws, damage to or loss of data, programs or
+ * equipment, and the unavailability or interruption of operation. This
+ * software is not intended to be used in any situation where a failure could
+ * cause risk of injury or damage to property. The software developed by NIST
+ * employees is not subject to copyright protection within the United States.
+ *
+ * Author: Evan Black <evan.black@nist.gov>
+ */
+
+#include "section-index.h"
+#include "binary/MappedFile.h"
+#include "file-parser.h"
+#include "handler/JsonHandler.h"
+#include <algorithm>
+#include <cstring>
+#include <rapidjson/reader.h>
+#include <utility>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define NETSIMULYZER_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+/**
+ * The most of the 'events' array walked by `indexSections()`, before the rest is estimated
+ */
+constexpr std::size_t eventSampleSize = 4u * 1024u * 1024u;
+
+bool isWhitespace(char c) {
+  return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+}
+
+/**
+ * Walk the object or array starting at `begin` to its end
+ *
+ * @param begin
+ * The position of the '{' or '[' starting the value
+ *
+ * @param limit
+ * Stop walking at this position
+ *
+ * @param items
+ * Incremented for each object directly in the value
+ *
+ * @return
+ * One past the closing '}' or ']', `size` if the value is unterminated.
+ * Unset if `limit` was reached first
+ */
+std::optional<std::size_t> walk(const char *data, std::size_t size, std::size_t begin, std::size_t limit,
+                                std::size_t &items) {
+  std::size_t depth = 0u;
+
+  for (auto i = begin; i < size; i = parser::nextStructural(data, size, i + 1u)) {
+    if (i >= limit)
+      return {};
+
+    switch (data[i]) {
+    case '"':
+      i = parser::skipString(data, size, i + 1u);
+      break;
+    case '{':
+      if (depth == 1u)
+        items++;
+      depth++;
+      break;
+    case '[':
+      depth++;
+      break;
+    case '}':
+    case ']':
+      depth--;
+      if (depth == 0u)
+        return i + 1u;
+      break;
+    default:
+      break;
+    }
+  }
+
+  return size;
+}
+
+/**
+ * @return
+ * One past the ']' just before the '}' closing the root object, unset if the file does not end that way
+ */
+std::optional<std::size_t> lastArrayEnd(const char *data, std::size_t size) {
+  auto i = size;
+  while (i > 0u && isWhitespace(data[i - 1u]))
+    i--;
+  if (i == 0u || data[i - 1u] != '}')
+    return {};
+
+  i--;
+  while (i > 0u && isWhitespace(data[i - 1u]))
+    i--;
+  if (i == 0u || data[i - 1u] != ']')
+    return {};
+
+  return i;
+}
+
+} // namespace
+
+namespace parser {
+
+const SectionIndex::Section *SectionIndex::find(std::string_view key) const {
+  const auto section = std::find_if(sections.begin(), sections.end(), [key](const Section &s) {
+    return s.key == key;
+  });
+
+  return section == sections.end() ? nullptr : &*section;
+}
+
+std::optional<SectionIndex> indexSections(const char *data, std::size_t size) {
+  SectionIndex index;
+  index.fileSize = size;
+
+  auto i = skipWhitespace(data, size, 0u);
+  if (i >= size || data[i] != '{')
+    return {};
+
+  for (i++;;) {
+    i = skipWhitespace(data, size, i);
+    if (i >= size)
+      return {};
+
+    if (data[i] == '}')
+      break;
+    if (data[i] == ',') {
+      i++;
+      continue;
+    }
+    if (data[i] != '"')
+      return {};
+
+    const auto keyEnd = skipString(data, size, i + 1u);
+    const auto colon = skipWhitespace(data, size, keyEnd + 1u);
+    if (colon >= size || data[colon] != ':')
+      return {};
+
+    SectionIndex::Section section;
+    section.key.assign(data + i + 1u, keyEnd - i - 1u);
+    section.begin = skipWhitespace(data, size, colon + 1u);
+    if (section.begin >= size)
+      return {};
+
+    const auto first = data[section.begin];
+    if (first == '{' || first == '[') {
+      const auto isEvents = section.key == "events" && first == '[';
+      const auto limit = isEvents ? std::min(size, section.begin + eventSampleSize) : size;
+      const auto end = walk(data, size, section.begin, limit, section.items);
+
+      // Too many events to walk, so scale the count from the sample
+      if (!end) {
+        const auto arrayEnd = lastArrayEnd(data, size);
+        if (!arrayEnd || arrayEnd.value() <= limit)
+          return {};
+
+        section.end = arrayEnd.value();
+        index.estimatedEvents =
+            static_cast<std::size_t>(static_cast<double>(section.items) * static_cast<double>(section.end - section.begin) /
+                                     static_cast<double>(limit - section.begin));
+        section.items = 0u;
+        index.sections.emplace_back(std::move(section));
+        break;
+      }
+
+      section.end = end.value();
+      if (isEvents) {
+        index.estimatedEvents = section.items;
+        index.eventsCounted = true;
+      }
+    } else if (first == '"') {
+      section.end = skipString(data, size, section.begin + 1u) + 1u;
+    } else {
+      section.end = section.begin;
+      while (section.end < size && data[section.end] != ',' && data[section.end] != '}' &&
+             !isWhitespace(data[section.end]))
+        section.end++;
+    }
+
+    if (section.end >= size)
+      return {};
+
+    i = section.end;
+    index.sections.emplace_back(std::move(section));
+  }
+
+  // Parsed on its own, as the only section of a document
+  if (const auto section = index.find("configuration"); section && data[section->begin] == '{') {
+    std::string document{"{\"configuration\":"};
+    document.append(data + section->begin, section->end - section->begin);
+    document += '}';
+
+    FileParser configurationParser;
+    JsonHandler handler{configurationParser};
+    rapidjson::Reader reader;
+    rapidjson::StringStream stream{document.c_str()};
+    reader.Parse(stream, handler);
+
+    if (!reader.HasParseError())
+      index.configuration = configurationParser.getConfiguration();
+  }
+
+  return index;
+}
+
+std::optional<SectionIndex> indexSections(const char *path) {
+  binary::MappedFile file;
+  if (!file.open(path))
+    return {};
+
+  return indexSections(file.data(), file.size());
+}
+
+std::size_t skipString(const char *data, std::size_t size, std::size_t i) {
+  const auto begin = i;
+  while (i < size) {
+    const auto quote = static_cast<const char *>(std::memchr(data + i, '"', size - i));
+    if (!quote)
+      return size;
+
+    // Escaped if preceded by an odd number of backslashes
+    const auto position = static_cast<std::size_t>(quote - data);
+    auto backslashes = 0u;
+    for (auto j = position; j > begin && data[j - 1u] == '\\'; j--)
+      backslashes++;
+
+    if (backslashes % 2u == 0u)
+      return position;
+    i = position + 1u;
+  }
+
+  return size;
+}
+
+std::size_t nextStructural(const char *data, std::size_t size, std::size_t i) {
+#ifdef NETSIMULYZER_SSE2
+  // '[' & ']' are '{' & '}' without the 0x20 bit
+  const auto quote = _mm_set1_epi8('"');
+  const auto caseBit = _mm_set1_epi8(0x20);
+  const auto openBrace = _mm_set1_epi8('{');
+  const auto closeBrace = _mm_set1_epi8('}');
+
+  for (; i + 16u <= size; i += 16u) {
+    const auto block = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i));
+    const auto folded = _mm_or_si128(block, caseBit);
+    const auto matches = _mm_or_si128(_mm_cmpeq_epi8(block, quote), _mm_or_si128(_mm_cmpeq_epi8(folded, openBrace),
+                                                                                  _mm_cmpeq_epi8(folded, closeBrace)));
+    // Find which of the 16 below
+    if (_mm_movemask_epi8(matches) != 0)
+      break;
+  }
+#endif
+
+  for (; i < size; i++) {
+    switch (data[i]) {
+    case '"':
+    case '{':
+    case '}':
+    case '[':
+    case ']':
+      return i;
+    default:
+      break;
+    }
+  }
+
+  return size;
+}
+
+std::size_t skipWhitespace(const char *data, std::size_t size, std::size_t i) {
+  while (i < size && isWhitespace(data[i]))
+    i++;
+
+  return i;
+}
+
+} // namespace parser
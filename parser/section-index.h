@@ -0,0 +1,162 @@
+/*
+ * NIST-developed software is provided by NIST as a public service. You may use,
+ * copy and distribute copies of the software in any medium, provided that you
+ * keep intact this entire notice. You may improve,modify and create derivative
+ * works of the software or any portion of the software, and you may copy and
+ * distribute such modifications or works. Modified works should carry a notice
+ * stating that you changed the software and should note the date and nature of
+ * any such change. Please explicitly acknowledge the National Institute of
+ * Standards and Technology as the source of the software.
+ *
+ * NIST-developed software is expressly provided "AS IS." NIST MAKES NO
+ * WARRANTY OF ANY KIND, EXPRESS, IMPLIED, IN FACT OR ARISING BY OPERATION OF
+ * LAW, INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTY OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, NON-INFRINGEMENT
+ * AND DATA ACCURACY. NIST NEITHER REPRESENTS NOR WARRANTS THAT THE
+ * OPERATION OF THE SOFTWARE WILL BE UNINTERRUPTED OR ERROR-FREE, OR THAT
+ * ANY DEFECTS WILL BE CORRECTED. NIST DOES NOT WARRANT OR MAKE ANY
+ * REPRESENTATIONS REGARDING THE USE OF THE SOFTWARE OR THE RESULTS THEREOF,
+ * INCLUDING BUT NOT LIMITED TO THE CORRECTNESS, ACCURACY, RELIABILITY,
+ * OR USEFULNESS OF THE SOFTWARE.
+ *
+ * You are solely responsible for determining the appropriateness of using and
+ * distributing the software and you assume all risks associated with its use,
+ * including but not limited to the risks and costs of program errors,
+ * compliance with applicable laws, damage to or loss of data, programs or
+ * equipment, and the unavailability or interruption of operation. This
+ * software is not intended to be used in any situation where a failure could
+ * cause risk of injury or damage to property. The software developed by NIST
+ * employees is not subject to copyright protection within the United States.
+ *
+ * Author: Evan Black <evan.black@nist.gov>
+ */
+
+#pragma once
+#include "model.h"
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace parser {
+
+/**
+ * Where each top level section of a JSON scenario is, found without parsing it,
+ * along with the configuration, see `indexSections()`
+ */
+struct SectionIndex {
+  struct Section {
+    std::string key;
+
+    /**
+     * The value of the section, from its first byte to one past its last
+     */
+    std::size_t begin{0u};
+    std::size_t end{0u};
+
+    /**
+     * The number of elements directly in the section, if it is an array.
+     * For 'events' this is only set when `SectionIndex::eventsCounted` is
+     */
+    std::size_t items{0u};
+  };
+
+  std::size_t fileSize{0u};
+
+  /**
+   * Unset if the file has no 'configuration' section, or it could not be parsed
+   */
+  std::optional<GlobalConfiguration> configuration;
+
+  /**
+   * Every top level section, in file order
+   */
+  std::vector<Section> sections;
+
+  /**
+   * The number of events, estimated from the size of the first ones
+   * unless `eventsCounted` is set
+   */
+  std::size_t estimatedEvents{0u};
+
+  /**
+   * Set when the whole 'events' array fit in the sample, so `estimatedEvents` is exact.
+   * Otherwise the 'events' array is taken to be the last section,
+   * ending at the last ']' of the file, & sections after it are not found
+   */
+  bool eventsCounted{false};
+
+  /**
+   * @param key
+   * The key of the section in the root object
+   *
+   * @return
+   * The first section with `key`, null if there is none
+   */
+  [[nodiscard]] const Section *find(std::string_view key) const;
+};
+
+/**
+ * Find the top level sections of the JSON scenario in `data`,
+ * walking their structure without building any of their items,
+ * then parse only the 'configuration'.
+ * The 'events' array is sampled rather than walked, see `SectionIndex::eventsCounted`,
+ * so the cost hardly depends on the number of events
+ *
+ * @param data
+ * The whole scenario file
+ *
+ * @param size
+ * The size of `data` in bytes
+ *
+ * @return
+ * Unset if `data` is not a JSON object, or ends before its sections do
+ */
+std::optional<SectionIndex> indexSections(const char *data, std::size_t size);
+
+/**
+ * Map the JSON scenario at `path`, then index it, see the other overload.
+ * Compressed & binary scenarios are not indexed
+ *
+ * @param path
+ * The path to the uncompressed JSON scenario
+ *
+ * @return
+ * Unset if the file could not be mapped, or is not a JSON object
+ */
+std::optional<SectionIndex> indexSections(const char *path);
+
+/**
+ * Find the closing quote of a string
+ *
+ * @param i
+ * The position immediately after the opening quote
+ *
+ * @return
+ * The position of the closing quote, or `size` if the string is unterminated
+ */
+std::size_t skipString(const char *data, std::size_t size, std::size_t i);
+
+/**
+ * Find the next character which may change the structure of the document:
+ * a quote, brace, or bracket. Checks 16 characters at a time where SSE2 is available
+ *
+ * @param i
+ * The position to start from
+ *
+ * @return
+ * The position of that character, or `size` if there are none
+ */
+std::size_t nextStructural(const char *data, std::size_t size, std::size_t i);
+
+/**
+ * @param i
+ * The position to start from
+ *
+ * @return
+ * The position of the first character from `i` which is not JSON whitespace, or `size`
+ */
+std::size_t skipWhitespace(const char *data, std::size_t size, std::size_t i);
+
+} // namespace parser
@@ -0,0 +1,204 @@
+/*
+ * NIST-developed software is provided by NIST as a public service. You may use,
+ * copy and distribute copies of the software in any medium, provided that you
+ * keep intact this entire notice. You may improve,modify and create derivative
+ * works of the software or any portion of the software, and you may copy and
+ * distribute such modifications or works. Modified works should carry a notice
+ * stating that you changed the software and should note the date and nature of
+ * any such change. Please explicitly acknowledge the National Institute of
+ * Standards and Technology as the source of the software.
+ *
+ * NIST-developed software is expressly provided "AS IS." NIST MAKES NO
+ * WARRANTY OF ANY KIND, EXPRESS, IMPLIED, IN FACT OR ARISING BY OPERATION OF
+ * LAW, INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTY OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, NON-INFRINGEMENT
+ * AND DATA ACCURACY. NIST NEITHER REPRESENTS NOR WARRANTS THAT THE
+ * OPERATION OF THE SOFTWARE WILL BE UNINTERRUPTED OR ERROR-FREE, OR THAT
+ * ANY DEFECTS WILL BE CORRECTED. NIST DOES NOT WARRANT OR MAKE ANY
+ * REPRESENTATIONS REGARDING THE USE OF THE SOFTWARE OR THE RESULTS THEREOF,
+ * INCLUDING BUT NOT LIMITED TO THE CORRECTNESS, ACCURACY, RELIABILITY,
+ * OR USEFULNESS OF THE SOFTWARE.
+ *
+ * You are solely responsible for determining the appropriateness of using and
+ * distributing the software and you assume all risks associated with its use,
+ * including but not limited to the risks and costs of program errors,
+ * compliance with applicable laws, damage to or loss of data, programs or
+ * equipment, and the unavailability or interruption of operation. This
+ * software is not intended to be used in any situation where a failure could
+ * cause risk of injury or damage to property. The software developed by NIST
+ * employees is not subject to copyright protection within the United States.
+ *
+ * Author: Evan Black <evan.black@nist.gov>
+ */
+
+#include "series-stats.h"
+#include "task-pool.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <thread>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <variant>
+
+namespace {
+
+/**
+ * @return
+ * The range of indices in `times` from `from` up to & including `to`
+ */
+std::pair<std::size_t, std::size_t> timeRange(const std::vector<parser::nanoseconds> &times, parser::nanoseconds from,
+                                              parser::nanoseconds to) {
+  const auto begin = std::lower_bound(times.begin(), times.end(), from);
+  const auto end = std::upper_bound(begin, times.end(), to);
+  return {static_cast<std::size_t>(begin - times.begin()), static_cast<std::size_t>(end - times.begin())};
+}
+
+parser::SeriesStatistics aggregate(const parser::SeriesColumns &series, parser::nanoseconds from,
+                                   parser::nanoseconds to) {
+  constexpr auto none = std::numeric_limits<double>::quiet_NaN();
+  parser::SeriesStatistics statistics{series.id, series.name, 0u, none, none, none, none, none, none};
+
+  const auto [begin, end] = timeRange(series.times, from, to);
+  if (begin == end)
+    return statistics;
+
+  const auto &column = series.category ? series.x : series.y;
+  std::vector<double> values{column.begin() + begin, column.begin() + end};
+  statistics.count = values.size();
+
+  auto sum = 0.0;
+  statistics.min = values.front();
+  statistics.max = values.front();
+  for (const auto value : values) {
+    sum += value;
+    statistics.min = std::min(statistics.min, value);
+    statistics.max = std::max(statistics.max, value);
+  }
+  statistics.mean = sum / static_cast<double>(values.size());
+
+  // Each percentile is found by selection, in increasing order,
+  // so each selection only looks at the values above the last
+  auto sortedUpTo = values.begin();
+  auto percentile = [&values, &sortedUpTo](double p) {
+    const auto rank = static_cast<std::size_t>(std::ceil(p / 100.0 * static_cast<double>(values.size())));
+    const auto nth = values.begin() + static_cast<std::ptrdiff_t>(std::max<std::size_t>(rank, 1u) - 1u);
+    std::nth_element(sortedUpTo, nth, values.end());
+    sortedUpTo = nth;
+    return *nth;
+  };
+  statistics.p50 = percentile(50.0);
+  statistics.p90 = percentile(90.0);
+  statistics.p99 = percentile(99.0);
+
+  return statistics;
+}
+
+} // namespace
+
+namespace parser {
+
+std::string csvField(const std::string &value) {
+  if (value.find_first_of(",\"\r\n") == std::string::npos)
+    return value;
+
+  std::string quoted{'"'};
+  for (const auto c : value) {
+    if (c == '"')
+      quoted += '"';
+    quoted += c;
+  }
+  quoted += '"';
+  return quoted;
+}
+
+std::vector<SeriesColumns> collectSeries(const std::vector<XYSeries> &xySeries,
+                                         const std::vector<CategoryValueSeries> &categoryValueSeries,
+                                         const std::vector<ChartEvent> &events) {
+  std::vector<SeriesColumns> columns;
+  columns.reserve(xySeries.size() + categoryValueSeries.size());
+  std::unordered_map<unsigned int, std::size_t> index;
+
+  for (const auto &series : xySeries) {
+    index.emplace(series.id, columns.size());
+    columns.emplace_back(SeriesColumns{series.id, series.name, false, {}, {}, {}});
+  }
+  for (const auto &series : categoryValueSeries) {
+    index.emplace(series.id, columns.size());
+    columns.emplace_back(SeriesColumns{series.id, series.name, true, {}, {}, {}});
+  }
+
+  for (const auto &event : events) {
+    std::visit(
+        [&columns, &index](const auto &e) {
+          using T = std::decay_t<decltype(e)>;
+
+          if constexpr (!std::is_same_v<T, XYSeriesClear>) {
+            const auto found = index.find(e.seriesId);
+            if (found == index.end())
+              return;
+
+            auto &series = columns[found->second];
+            auto add = [&series, time = e.time](double x, double y) {
+              series.times.emplace_back(time);
+              series.x.emplace_back(x);
+              series.y.emplace_back(y);
+            };
+
+            if constexpr (std::is_same_v<T, XYSeriesAddValue>) {
+              add(e.point.x, e.point.y);
+            } else if constexpr (std::is_same_v<T, XYSeriesAddValues>) {
+              for (const auto &point : e.points)
+                add(point.x, point.y);
+            } else if constexpr (std::is_same_v<T, CategorySeriesAddValue>) {
+              add(e.value, static_cast<double>(e.category));
+            }
+          }
+        },
+        event);
+  }
+
+  return columns;
+}
+
+std::vector<SeriesStatistics> computeStatistics(const std::vector<SeriesColumns> &series, nanoseconds from,
+                                                nanoseconds to, unsigned int threads) {
+  std::vector<SeriesStatistics> statistics(series.size());
+  if (series.empty())
+    return statistics;
+
+  if (threads == 0u)
+    threads = std::max(1u, std::thread::hardware_concurrency());
+
+  // Series vary wildly in size, so each thread takes the next series as it finishes one
+  TaskPool::shared().parallelFor(series.size(), threads, TaskPool::Priority::Normal, [&](std::size_t i) {
+    statistics[i] = aggregate(series[i], from, to);
+  });
+
+  return statistics;
+}
+
+void writeStatisticsCsv(std::ostream &out, const std::vector<SeriesStatistics> &statistics) {
+  const auto precision = out.precision(std::numeric_limits<double>::digits10);
+  out << "id,name,count,min,max,mean,p50,p90,p99\n";
+  for (const auto &s : statistics) {
+    out << s.id << ',' << csvField(s.name) << ',' << s.count << ',' << s.min << ',' << s.max << ',' << s.mean << ','
+        << s.p50 << ',' << s.p90 << ',' << s.p99 << '\n';
+  }
+  out.precision(precision);
+}
+
+void writePointsCsv(std::ostream &out, const std::vector<SeriesColumns> &series, nanoseconds from, nanoseconds to) {
+  const auto precision = out.precision(std::numeric_limits<double>::digits10);
+  out << "id,name,time,x,y\n";
+  for (const auto &s : series) {
+    const auto name = csvField(s.name);
+    const auto [begin, end] = timeRange(s.times, from, to);
+    for (auto i = begin; i < end; i++)
+      out << s.id << ',' << name << ',' << s.times[i] << ',' << s.x[i] << ',' << s.y[i] << '\n';
+  }
+  out.precision(precision);
+}
+
+} // namespace parser
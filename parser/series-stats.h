@@ -0,0 +1,167 @@
+/*
+ * NIST-developed software is provided by NIST as a public service. You may use,
+ * copy and distribute copies of the software in any medium, provided that you
+ * keep intact this entire notice. You may improve,modify and create derivative
+ * works of the software or any portion of the software, and you may copy and
+ * distribute such modifications or works. Modified works should carry a notice
+ * stating that you changed the software and should note the date and nature of
+ * any such change. Please explicitly acknowledge the National Institute of
+ * Standards and Technology as the source of the software.
+ *
+ * NIST-developed software is expressly provided "AS IS." NIST MAKES NO
+ * WARRANTY OF ANY KIND, EXPRESS, IMPLIED, IN FACT OR ARISING BY OPERATION OF
+ * LAW, INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTY OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, NON-INFRINGEMENT
+ * AND DATA ACCURACY. NIST NEITHER REPRESENTS NOR WARRANTS THAT THE
+ * OPERATION OF THE SOFTWARE WILL BE UNINTERRUPTED OR ERROR-FREE, OR THAT
+ * ANY DEFECTS WILL BE CORRECTED. NIST DOES NOT WARRANT OR MAKE ANY
+ * REPRESENTATIONS REGARDING THE USE OF THE SOFTWARE OR THE RESULTS THEREOF,
+ * INCLUDING BUT NOT LIMITED TO THE CORRECTNESS, ACCURACY, RELIABILITY,
+ * OR USEFULNESS OF THE SOFTWARE.
+ *
+ * You are solely responsible for determining the appropriateness of using and
+ * distributing the software and you assume all risks associated with its use,
+ * including but not limited to the risks and costs of program errors,
+ * compliance with applicable laws, damage to or loss of data, programs or
+ * equipment, and the unavailability or interruption of operation. This
+ * software is not intended to be used in any situation where a failure could
+ * cause risk of injury or damage to property. The software developed by NIST
+ * employees is not subject to copyright protection within the United States.
+ *
+ * Author: Evan Black <evan.black@nist.gov>
+ */
+
+#pragma once
+
+#include "model.h"
+#include <cstddef>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace parser {
+
+/**
+ * Every point of one series, in time ordered columns
+ */
+struct SeriesColumns {
+  unsigned int id{0u};
+  std::string name;
+
+  /**
+   * True for a category value series, where `x` holds the values & `y` the category IDs.
+   * Statistics are of `x` for these, and of `y` otherwise
+   */
+  bool category{false};
+
+  /**
+   * The time each point was added, never decreasing
+   */
+  std::vector<nanoseconds> times;
+  std::vector<double> x;
+  std::vector<double> y;
+};
+
+/**
+ * Aggregates of the values of one series over a range of time.
+ * Every value is NaN if the series has no points in the range
+ */
+struct SeriesStatistics {
+  unsigned int id{0u};
+  std::string name;
+  std::size_t count{0u};
+  double min;
+  double max;
+  double mean;
+
+  /**
+   * Nearest rank percentiles
+   */
+  double p50;
+  double p90;
+  double p99;
+};
+
+/**
+ * Build the columns of every series from the chart events
+ *
+ * @param xySeries
+ * The XY series of the scenario
+ *
+ * @param categoryValueSeries
+ * The category value series of the scenario
+ *
+ * @param events
+ * The chart events of the scenario, in time order.
+ * Clears are ignored, every point added is kept
+ *
+ * @return
+ * The columns of each XY series, then of each category value series
+ */
+[[nodiscard]] std::vector<SeriesColumns> collectSeries(const std::vector<XYSeries> &xySeries,
+                                                       const std::vector<CategoryValueSeries> &categoryValueSeries,
+                                                       const std::vector<ChartEvent> &events);
+
+/**
+ * Compute the aggregates of each series, split across threads by series
+ *
+ * @param series
+ * The series to aggregate
+ *
+ * @param from
+ * The earliest time of the points to include
+ *
+ * @param to
+ * The latest time of the points to include
+ *
+ * @param threads
+ * The most threads to use, or 0 for one per core
+ *
+ * @return
+ * The aggregates, in the same order as `series`
+ */
+[[nodiscard]] std::vector<SeriesStatistics> computeStatistics(const std::vector<SeriesColumns> &series,
+                                                              nanoseconds from, nanoseconds to,
+                                                              unsigned int threads = 0u);
+
+/**
+ * Quote a CSV field, if it has anything which would end it early
+ *
+ * @param value
+ * The field to quote
+ *
+ * @return
+ * `value`, quoted if needed
+ */
+[[nodiscard]] std::string csvField(const std::string &value);
+
+/**
+ * Write one CSV row per series, after a header row
+ *
+ * @param out
+ * Where to write the rows
+ *
+ * @param statistics
+ * The aggregates of each series
+ */
+void writeStatisticsCsv(std::ostream &out, const std::vector<SeriesStatistics> &statistics);
+
+/**
+ * Write one CSV row per point, series by series, after a header row.
+ * Rows are written straight from the columns
+ *
+ * @param out
+ * Where to write the rows
+ *
+ * @param series
+ * The series to write
+ *
+ * @param from
+ * The earliest time of the points to write
+ *
+ * @param to
+ * The latest time of the points to write
+ */
+void writePointsCsv(std::ostream &out, const std::vector<SeriesColumns> &series, nanoseconds from, nanoseconds to);
+
+} // namespace parser
@@ -0,0 +1,164 @@
+/*
+ * NIST-developed software is provided by NIST as a public service. You may use,
+ * copy and distribute copies of the software in any medium, provided that you
+ * keep intact this entire notice. You may improve,modify and create derivative
+ * works of the software or any portion of the software, and you may copy and
+ * distribute such modifications or works. Modified works should carry a notice
+ * stating that you changed the software and should note the date and nature of
+ * any such change. Please explicitly acknowledge the National Institute of
+ * Standards and Technology as the source of the software.
+ *
+ * NIST-developed software is expressly provided "AS IS." NIST MAKES NO
+ * WARRANTY OF ANY KIND, EXPRESS, IMPLIED, IN FACT OR ARISING BY OPERATION OF
+ * LAW, INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTY OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, NON-INFRINGEMENT
+ * AND DATA ACCURACY. NIST NEITHER REPRESENTS NOR WARRANTS THAT THE
+ * OPERATION OF THE SOFTWARE WILL BE UNINTERRUPTED OR ERROR-FREE, OR THAT
+ * ANY DEFECTS WILL BE CORRECTED. NIST DOES NOT WARRANT OR MAKE ANY
+ * REPRESENTATIONS REGARDING THE USE OF THE SOFTWARE OR THE RESULTS THEREOF,
+ * INCLUDING BUT NOT LIMITED TO THE CORRECTNESS, ACCURACY, RELIABILITY,
+ * OR USEFULNESS OF THE SOFTWARE.
+ *
+ * You are solely responsible for determining the appropriateness of using and
+ * distributing the software and you assume all risks associated with its use,
+ * including but not limited to the risks and costs of program errors,
+ * compliance with applicable laws, damage to or loss of data, programs or
+ * equipment, and the unavailability or interruption of operation. This
+ * software is not intended to be used in any situation where a failure could
+ * cause risk of injury or damage to property. The software developed by NIST
+ * employees is not subject to copyright protection within the United States.
+ *
+ * Author: Evan Black <evan.black@nist.gov>
+ */
+
+#include "shared-events.h"
+#include "binary/binary-format.h"
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <utility>
+
+namespace parser {
+
+std::shared_ptr<const SharedEvents> SharedEvents::open(const std::string &path) {
+  auto shared = std::make_shared<SharedEvents>();
+  if (!shared->file.open(path.c_str()) || shared->file.size() < sizeof(Header))
+    return {};
+
+  Header header{};
+  std::memcpy(&header, shared->file.data(), sizeof(header));
+  if (std::memcmp(header.magic, magic, sizeof(magic)) != 0 || header.version != version ||
+      header.byteOrder != binary::byteOrderMark || header.eventSize != sizeof(SceneEvent) ||
+      header.eventAlignment != alignof(SceneEvent) ||
+      shared->file.size() != sizeof(Header) + header.count * sizeof(SceneEvent))
+    return {};
+
+  // The mapping is page aligned, & the header keeps the events aligned
+  shared->events = reinterpret_cast<const SceneEvent *>(shared->file.data() + sizeof(Header));
+  shared->count = static_cast<std::size_t>(header.count);
+  return shared;
+}
+
+std::string SharedEvents::path(std::string snapshot, std::optional<double> compaction) {
+  if (const auto extension = snapshot.rfind(".nszb"); extension != std::string::npos)
+    snapshot.erase(extension);
+
+  // Compacted events differ for each tolerance
+  if (compaction) {
+    char tolerance[32];
+    std::snprintf(tolerance, sizeof(tolerance), ".c%g", compaction.value());
+    snapshot += tolerance;
+  }
+
+  return snapshot + ".nsse";
+}
+
+const SceneEvent *SharedEvents::data() const {
+  return events;
+}
+
+std::size_t SharedEvents::size() const {
+  return count;
+}
+
+std::size_t SharedEvents::bytes() const {
+  return count * sizeof(SceneEvent);
+}
+
+SharedEventsWriter::SharedEventsWriter(std::string path) : path(std::move(path)) {
+  // Unique, so viewers writing the same events at once do not write into the same file
+  char suffix[24];
+  std::snprintf(suffix, sizeof(suffix), ".%08x.tmp", static_cast<unsigned int>(std::random_device{}()));
+  temporary = this->path + suffix;
+
+  file = std::fopen(temporary.c_str(), "wb");
+  if (!file) {
+    std::cerr << "Failed to create shared events: " << temporary << '\n';
+    return;
+  }
+
+  // Written again with the count once finished
+  const SharedEvents::Header header{};
+  if (std::fwrite(&header, sizeof(header), 1u, file) != 1u)
+    abandon();
+}
+
+SharedEventsWriter::~SharedEventsWriter() {
+  abandon();
+}
+
+void SharedEventsWriter::abandon() {
+  if (!file)
+    return;
+
+  std::fclose(file);
+  file = nullptr;
+  std::remove(temporary.c_str());
+}
+
+void SharedEventsWriter::append(const std::vector<SceneEvent> &events) {
+  if (!file || events.empty())
+    return;
+
+  if (std::fwrite(events.data(), sizeof(SceneEvent), events.size(), file) != events.size()) {
+    std::cerr << "Failed writing shared events: " << temporary << '\n';
+    abandon();
+    return;
+  }
+
+  count += events.size();
+}
+
+bool SharedEventsWriter::finish() {
+  if (!file)
+    return false;
+
+  SharedEvents::Header header{};
+  std::memcpy(header.magic, SharedEvents::magic, sizeof(header.magic));
+  header.version = SharedEvents::version;
+  header.byteOrder = binary::byteOrderMark;
+  header.eventSize = sizeof(SceneEvent);
+  header.eventAlignment = alignof(SceneEvent);
+  header.count = count;
+
+  if (std::fseek(file, 0L, SEEK_SET) != 0 || std::fwrite(&header, sizeof(header), 1u, file) != 1u ||
+      std::fclose(file) != 0) {
+    file = nullptr;
+    std::remove(temporary.c_str());
+    std::cerr << "Failed writing shared events: " << temporary << '\n';
+    return false;
+  }
+  file = nullptr;
+
+  // Replacing an existing file fails on Windows
+  std::remove(path.c_str());
+  if (std::rename(temporary.c_str(), path.c_str()) != 0) {
+    std::cerr << "Failed to move shared events into place: " << path << '\n';
+    std::remove(temporary.c_str());
+    return false;
+  }
+
+  return true;
+}
+
+} // namespace parser
@@ -0,0 +1,167 @@
+/*
+ * NIST-developed software is provided by NIST as a public service. You may use,
+ * copy and distribute copies of the software in any medium, provided that you
+ * keep intact this entire notice. You may improve,modify and create derivative
+ * works of the software or any portion of the software, and you may copy and
+ * distribute such modifications or works. Modified works should carry a notice
+ * stating that you changed the software and should note the date and nature of
+ * any such change. Please explicitly acknowledge the National Institute of
+ * Standards and Technology as the source of the software.
+ *
+ * NIST-developed software is expressly provided "AS IS." NIST MAKES NO
+ * WARRANTY OF ANY KIND, EXPRESS, IMPLIED, IN FACT OR ARISING BY OPERATION OF
+ * LAW, INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTY OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, NON-INFRINGEMENT
+ * AND DATA ACCURACY. NIST NEITHER REPRESENTS NOR WARRANTS THAT THE
+ * OPERATION OF THE SOFTWARE WILL BE UNINTERRUPTED OR ERROR-FREE, OR THAT
+ * ANY DEFECTS WILL BE CORRECTED. NIST DOES NOT WARRANT OR MAKE ANY
+ * REPRESENTATIONS REGARDING THE USE OF THE SOFTWARE OR THE RESULTS THEREOF,
+ * INCLUDING BUT NOT LIMITED TO THE CORRECTNESS, ACCURACY, RELIABILITY,
+ * OR USEFULNESS OF THE SOFTWARE.
+ *
+ * You are solely responsible for determining the appropriateness of using and
+ * distributing the software and you assume all risks associated with its use,
+ * including but not limited to the risks and costs of program errors,
+ * compliance with applicable laws, damage to or loss of data, programs or
+ * equipment, and the unavailability or interruption of operation. This
+ * software is not intended to be used in any situation where a failure could
+ * cause risk of injury or damage to property. The software developed by NIST
+ * employees is not subject to copyright protection within the United States.
+ *
+ * Author: Evan Black <evan.black@nist.gov>
+ */
+
+#pragma once
+
+#include "binary/MappedFile.h"
+#include "model.h"
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace parser {
+
+/**
+ * The scene events of a scenario, in a file mapped read-only,
+ * so several viewers of the same scenario on one machine share a single copy of them.
+ *
+ * The file holds a `SharedEvents::Header`, immediately followed by the events,
+ * as they are laid out in memory. Events refer to Nodes & Decorations by ID, never by pointer,
+ * so they are valid in any process of the same build, wherever the file is mapped.
+ * Files written by a build with another layout of `SceneEvent` are rejected.
+ *
+ * Written by the first viewer to load the scenario, see `SharedEventsWriter`,
+ * and never changed once in place
+ */
+class SharedEvents {
+public:
+  struct Header {
+    char magic[4];
+    uint16_t version;
+    uint16_t byteOrder;
+    uint32_t eventSize;
+    uint32_t eventAlignment;
+    uint64_t count;
+  };
+  static_assert(sizeof(Header) == 24u, "Header must be packed into 24 bytes");
+  static_assert(alignof(SceneEvent) <= 8u, "Events directly follow the header");
+
+  /**
+   * Identifies a shared events file
+   */
+  static constexpr char magic[4] = {'N', 'S', 'S', 'E'};
+  static constexpr uint16_t version = 1u;
+
+private:
+  binary::MappedFile file;
+  const SceneEvent *events = nullptr;
+  std::size_t count = 0u;
+
+public:
+  /**
+   * Map the events written to `path`
+   *
+   * @param path
+   * A file written by `SharedEventsWriter`
+   *
+   * @return
+   * The events, or null if the file does not exist, is incomplete,
+   * or was written by a build with another event layout
+   */
+  [[nodiscard]] static std::shared_ptr<const SharedEvents> open(const std::string &path);
+
+  /**
+   * @param snapshot
+   * The path of the scenario's snapshot, see `ParseCache::snapshotPath()`,
+   * in the directory the events are shared in
+   *
+   * @param compaction
+   * The tolerance the events were compacted with, see `FileParser::setCompaction()`
+   *
+   * @return
+   * The path of the shared events for the scenario, parsed with `compaction`
+   */
+  [[nodiscard]] static std::string path(std::string snapshot, std::optional<double> compaction);
+
+  [[nodiscard]] const SceneEvent *data() const;
+  [[nodiscard]] std::size_t size() const;
+
+  /**
+   * @return
+   * The bytes of events mapped
+   */
+  [[nodiscard]] std::size_t bytes() const;
+};
+
+/**
+ * Writes the scene events of a scenario as they are parsed, for `SharedEvents`.
+ *
+ * The events are written under a temporary name, then renamed once complete,
+ * so a partial file is never mapped. Several viewers may write the same file at once,
+ * the last to finish replaces the others
+ */
+class SharedEventsWriter {
+  std::string path;
+  std::string temporary;
+  std::FILE *file = nullptr;
+  uint64_t count = 0u;
+
+  /**
+   * Close & remove the temporary file
+   */
+  void abandon();
+
+public:
+  /**
+   * Start writing the events to `path`, see `SharedEvents::path()`.
+   * Nothing is written if the file cannot be created
+   */
+  explicit SharedEventsWriter(std::string path);
+  SharedEventsWriter(const SharedEventsWriter &other) = delete;
+
+  /**
+   * Removes the events written, unless `finish()` was called
+   */
+  ~SharedEventsWriter();
+
+  SharedEventsWriter &operator=(const SharedEventsWriter &other) = delete;
+
+  /**
+   * Add events after those written so far
+   */
+  void append(const std::vector<SceneEvent> &events);
+
+  /**
+   * Move the events written into place
+   *
+   * @return
+   * True if every event was written, and the file was moved into place
+   */
+  bool finish();
+};
+
+} // namespace parser
@@ -0,0 +1,237 @@
+/*
+ * NIST-developed software is provided by NIST as a public service. You may use,
+ * copy and distribute copies of the software in any medium, provided that you
+ * keep intact this entire notice. You may improve,modify and create derivative
+ * works of the software or any portion of the software, and you may copy and
+ * distribute such modifications or works. Modified works should carry a notice
+ * stating that you changed the software and should note the date and nature of
+ * any such change. Please explicitly acknowledge the National Institute of
+ * Standards and Technology as the source of the software.
+ *
+ * NIST-developed software is expressly provided "AS IS." NIST MAKES NO
+ * WARRANTY OF ANY KIND, EXPRESS, IMPLIED, IN FACT OR ARISING BY OPERATION OF
+ * LAW, INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTY OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, NON-INFRINGEMENT
+ * AND DATA ACCURACY. NIST NEITHER REPRESENTS NOR WARRANTS THAT THE
+ * OPERATION OF THE SOFTWARE WILL BE UNINTERRUPTED OR ERROR-FREE, OR THAT
+ * ANY DEFECTS WILL BE CORRECTED. NIST DOES NOT WARRANT OR MAKE ANY
+ * REPRESENTATIONS REGARDING THE USE OF THE SOFTWARE OR THE RESULTS THEREOF,
+ * INCLUDING BUT NOT LIMITED TO THE CORRECTNESS, ACCURACY, RELIABILITY,
+ * OR USEFULNESS OF THE SOFTWARE.
+ *
+ * You are solely responsible for determining the appropriateness of using and
+ * distributing the software and you assume all risks associated with its use,
+ * including but not limited to the risks and costs of program errors,
+ * compliance with applicable laws, damage to or loss of data, programs or
+ * equipment, and the unavailability or interruption of operation. This
+ * software is not intended to be used in any situation where a failure could
+ * cause risk of injury or damage to property. The software developed by NIST
+ * employees is not subject to copyright protection within the United States.
+ *
+ * Author: Evan Black <evan.black@nist.gov>
+ */
+
+#include "task-pool.h"
+#include "trace.h"
+#include <algorithm>
+#include <utility>
+
+namespace {
+
+/**
+ * The pool the calling thread works for, if any
+ */
+thread_local const parser::TaskPool *currentPool = nullptr;
+
+/**
+ * The index of the calling thread in `currentPool`
+ */
+thread_local std::size_t currentIndex = 0u;
+
+} // namespace
+
+namespace parser {
+
+void CancellationToken::cancel() {
+  *flag = true;
+}
+
+bool CancellationToken::cancelled() const {
+  return *flag;
+}
+
+bool TaskPool::Task::run() {
+  if (claimed.exchange(true))
+    return false;
+
+  if (!token.cancelled())
+    work();
+  // Release anything the task holds, since the handle may be kept around
+  work = nullptr;
+
+  {
+    std::lock_guard lock{mutex};
+    done = true;
+  }
+  finished.notify_all();
+  return true;
+}
+
+TaskPool::Handle::Handle(std::shared_ptr<Task> task) : task(std::move(task)) {
+}
+
+void TaskPool::Handle::wait() {
+  if (!task || task->run())
+    return;
+
+  std::unique_lock lock{task->mutex};
+  task->finished.wait(lock, [this]() {
+    return task->done;
+  });
+}
+
+bool TaskPool::Handle::done() const {
+  if (!task)
+    return true;
+
+  std::lock_guard lock{task->mutex};
+  return task->done;
+}
+
+TaskPool::TaskPool(unsigned int threadCount) {
+  if (threadCount == 0u)
+    threadCount = std::max(1u, std::thread::hardware_concurrency());
+
+  workers.reserve(threadCount);
+  for (auto i = 0u; i < threadCount; i++)
+    workers.emplace_back(std::make_unique<Worker>());
+
+  // Only once every queue exists, since workers steal from each other
+  threads.reserve(threadCount);
+  for (std::size_t i = 0u; i < threadCount; i++)
+    threads.emplace_back(&TaskPool::work, this, i);
+}
+
+TaskPool::~TaskPool() {
+  {
+    std::lock_guard lock{sleepMutex};
+    stopping = true;
+  }
+  taskAdded.notify_all();
+
+  for (auto &thread : threads)
+    thread.join();
+}
+
+TaskPool &TaskPool::shared() {
+  static TaskPool pool{std::max(2u, std::thread::hardware_concurrency())};
+  return pool;
+}
+
+unsigned int TaskPool::size() const {
+  return static_cast<unsigned int>(workers.size());
+}
+
+std::size_t TaskPool::currentWorker() const {
+  return currentPool == this ? currentIndex : workers.size();
+}
+
+std::shared_ptr<TaskPool::Task> TaskPool::take(std::size_t worker) {
+  const auto count = workers.size();
+  for (std::size_t priority = 0u; priority < priorityCount; priority++) {
+    for (std::size_t offset = 0u; offset < count; offset++) {
+      auto &victim = *workers[(worker + offset) % count];
+      std::lock_guard lock{victim.mutex};
+      auto &queue = victim.queues[priority];
+      if (queue.empty())
+        continue;
+
+      // The newest of our own tasks is likely still in cache,
+      // the oldest of another worker's is likely the largest
+      std::shared_ptr<Task> task;
+      if (offset == 0u) {
+        task = std::move(queue.back());
+        queue.pop_back();
+      } else {
+        task = std::move(queue.front());
+        queue.pop_front();
+      }
+
+      std::lock_guard sleepLock{sleepMutex};
+      queued--;
+      return task;
+    }
+  }
+
+  return nullptr;
+}
+
+void TaskPool::work(std::size_t worker) {
+  currentPool = this;
+  currentIndex = worker;
+  trace::setThreadName("Task pool");
+
+  while (true) {
+    // Tasks run by a waiting thread are still queued, and are skipped here
+    if (const auto task = take(worker)) {
+      task->run();
+      continue;
+    }
+
+    std::unique_lock lock{sleepMutex};
+    taskAdded.wait(lock, [this]() {
+      return stopping || queued > 0u;
+    });
+
+    if (stopping && queued == 0u)
+      return;
+  }
+}
+
+TaskPool::Handle TaskPool::submit(std::function<void()> work, TaskPool::Priority priority, CancellationToken token) {
+  auto task = std::make_shared<Task>();
+  task->work = std::move(work);
+  task->token = std::move(token);
+
+  // Tasks from a worker stay with it, unless another worker is idle
+  auto worker = currentWorker();
+  if (worker == workers.size())
+    worker = nextWorker++ % workers.size();
+
+  {
+    auto &target = *workers[worker];
+    std::lock_guard lock{target.mutex};
+    target.queues[static_cast<std::size_t>(priority)].push_back(task);
+
+    std::lock_guard sleepLock{sleepMutex};
+    queued++;
+  }
+  taskAdded.notify_one();
+
+  return Handle{std::move(task)};
+}
+
+void TaskPool::parallelFor(std::size_t count, unsigned int maxThreads, TaskPool::Priority priority,
+                           const std::function<void(std::size_t)> &body) {
+  if (maxThreads == 0u)
+    maxThreads = size();
+
+  // Indices vary in cost, so each thread takes the next index as it finishes one
+  std::atomic<std::size_t> next{0u};
+  const auto run = [&next, count, &body]() {
+    for (auto i = next++; i < count; i = next++)
+      body(i);
+  };
+
+  const auto helpers = std::min<std::size_t>(maxThreads, count);
+  std::vector<Handle> handles;
+  handles.reserve(helpers);
+  for (std::size_t i = 1u; i < helpers; i++)
+    handles.emplace_back(submit(run, priority));
+
+  run();
+  for (auto &handle : handles)
+    handle.wait();
+}
+
+} // namespace parser
@@ -0,0 +1,241 @@
+/*
+ * NIST-developed software is provided by NIST as a public service. You may use,
+ * copy and distribute copies of the software in any medium, provided that you
+ * keep intact this entire notice. You may improve,modify and create derivative
+ * works of the software or any portion of the software, and you may copy and
+ * distribute such modifications or works. Modified works should carry a notice
+ * stating that you changed the software and should note the date and nature of
+ * any such change. Please explicitly acknowledge the National Institute of
+ * Standards and Technology as the source of the software.
+ *
+ * NIST-developed software is expressly provided "AS IS." NIST MAKES NO
+ * WARRANTY OF ANY KIND, EXPRESS, IMPLIED, IN FACT OR ARISING BY OPERATION OF
+ * LAW, INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTY OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, NON-INFRINGEMENT
+ * AND DATA ACCURACY. NIST NEITHER REPRESENTS NOR WARRANTS THAT THE
+ * OPERATION OF THE SOFTWARE WILL BE UNINTERRUPTED OR ERROR-FREE, OR THAT
+ * ANY DEFECTS WILL BE CORRECTED. NIST DOES NOT WARRANT OR MAKE ANY
+ * REPRESENTATIONS REGARDING THE USE OF THE SOFTWARE OR THE RESULTS THEREOF,
+ * INCLUDING BUT NOT LIMITED TO THE CORRECTNESS, ACCURACY, RELIABILITY,
+ * OR USEFULNESS OF THE SOFTWARE.
+ *
+ * You are solely responsible for determining the appropriateness of using and
+ * distributing the software and you assume all risks associated with its use,
+ * including but not limited to the risks and costs of program errors,
+ * compliance with applicable laws, damage to or loss of data, programs or
+ * equipment, and the unavailability or interruption of operation. This
+ * software is not intended to be used in any situation where a failure could
+ * cause risk of injury or damage to property. The software developed by NIST
+ * employees is not subject to copyright protection within the United States.
+ *
+ * Author: Evan Black <evan.black@nist.gov>
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace parser {
+
+/**
+ * Shared between a job & whoever may stop it.
+ * Copies refer to the same flag
+ */
+class CancellationToken {
+  std::shared_ptr<std::atomic<bool>> flag{std::make_shared<std::atomic<bool>>(false)};
+
+public:
+  /**
+   * Ask every task holding this token to stop.
+   * Tasks which have not started are skipped, running ones should check `cancelled()`
+   */
+  void cancel();
+
+  [[nodiscard]] bool cancelled() const;
+};
+
+/**
+ * One set of worker threads for every background job in the process,
+ * so parallel parts of the application don't each start threads of their own.
+ *
+ * Each worker keeps a queue per priority. Tasks submitted from a worker go to its own queue,
+ * others are spread between the workers. A worker runs the newest task in its own queue,
+ * or the oldest task of another worker, always taking the most urgent priority available.
+ * Tasks are never interrupted, so an urgent task waits for a worker to finish its current task,
+ * but never behind queued tasks of a lower priority.
+ *
+ * Waiting on a task which has not started runs it on the waiting thread,
+ * so tasks may wait on the tasks they submit without tying up the pool
+ */
+class TaskPool {
+public:
+  enum class Priority : int {
+    /**
+     * Work the user is waiting on, e.g. a search or a seek
+     */
+    Interactive,
+    Normal,
+
+    /**
+     * Work which may finish whenever, e.g. indexing or prefetching
+     */
+    Background
+  };
+  static constexpr std::size_t priorityCount = 3u;
+
+private:
+  struct Task {
+    std::function<void()> work;
+    CancellationToken token;
+
+    /**
+     * Set by whichever thread runs the task first
+     */
+    std::atomic<bool> claimed{false};
+    std::mutex mutex;
+    std::condition_variable finished;
+    bool done{false};
+
+    /**
+     * Run the task, unless another thread already has, or it was cancelled
+     *
+     * @return
+     * True if this thread ran, or skipped, the task
+     */
+    bool run();
+  };
+
+  struct Worker {
+    std::mutex mutex;
+    std::array<std::deque<std::shared_ptr<Task>>, priorityCount> queues;
+  };
+
+  std::vector<std::unique_ptr<Worker>> workers;
+  std::vector<std::thread> threads;
+
+  std::mutex sleepMutex;
+  std::condition_variable taskAdded;
+
+  /**
+   * Tasks in every queue. Guarded by `sleepMutex`
+   */
+  std::size_t queued{0u};
+  bool stopping{false};
+
+  /**
+   * The worker queue the next task from outside the pool goes to
+   */
+  std::atomic<std::size_t> nextWorker{0u};
+
+  /**
+   * @return
+   * The index of the calling thread in `workers`, or `workers.size()` if it's not one of them
+   */
+  [[nodiscard]] std::size_t currentWorker() const;
+
+  /**
+   * Take the most urgent task for `worker`, from its own queue first
+   *
+   * @return
+   * The task, or null if every queue is empty
+   */
+  std::shared_ptr<Task> take(std::size_t worker);
+
+  void work(std::size_t worker);
+
+public:
+  /**
+   * A task submitted to the pool. Empty handles are already done
+   */
+  class Handle {
+    std::shared_ptr<Task> task;
+
+  public:
+    Handle() = default;
+    explicit Handle(std::shared_ptr<Task> task);
+
+    /**
+     * Wait for the task to finish.
+     * If no thread has started it yet, it's run on this thread instead
+     */
+    void wait();
+
+    [[nodiscard]] bool done() const;
+  };
+
+  /**
+   * @param threadCount
+   * The number of workers, 0 for one per core
+   */
+  explicit TaskPool(unsigned int threadCount = 0u);
+  TaskPool(const TaskPool &) = delete;
+  TaskPool &operator=(const TaskPool &) = delete;
+
+  /**
+   * Finishes the queued tasks, then stops the workers
+   */
+  ~TaskPool();
+
+  /**
+   * @return
+   * The pool shared by the whole process, with one worker per core.
+   * Always at least two, since a followed file holds a worker until stopped.
+   * Started on first use
+   */
+  [[nodiscard]] static TaskPool &shared();
+
+  /**
+   * @return
+   * The number of workers
+   */
+  [[nodiscard]] unsigned int size() const;
+
+  /**
+   * Queue `work` to run on a worker
+   *
+   * @param work
+   * The task. Long running tasks should check `token` every so often
+   *
+   * @param priority
+   * How urgently the task should run, compared to the others queued
+   *
+   * @param token
+   * Skips the task if it is cancelled before the task starts
+   *
+   * @return
+   * A handle to wait on the task with
+   */
+  Handle submit(std::function<void()> work, Priority priority = Priority::Normal,
+                CancellationToken token = CancellationToken{});
+
+  /**
+   * Run `body` for each index in [0, count), with the calling thread helping,
+   * and wait for every index to finish
+   *
+   * @param count
+   * The number of indices
+   *
+   * @param maxThreads
+   * The most threads to spread the indices over, including the calling thread.
+   * 0 for as many as the pool has
+   *
+   * @param priority
+   * The priority of the tasks helping the calling thread
+   *
+   * @param body
+   * Called once for each index, from any thread
+   */
+  void parallelFor(std::size_t count, unsigned int maxThreads, Priority priority,
+                   const std::function<void(std::size_t)> &body);
+};
+
+} // namespace parser
@@ -0,0 +1,340 @@
+/*
+ * NIST-developed software is provided by NIST as a public service. You may use,
+ * copy and distribute copies of the software in any medium, provided that you
+ * keep intact this entire notice. You may improve,modify and create derivative
+ * works of the software or any portion of the software, and you may copy and
+ * distribute such modifications or works. Modified works should carry a notice
+ * stating that you changed the software and should note the date and nature of
+ * any such change. Please explicitly acknowledge the National Institute of
+ * Standards and Technology as the source of the software.
+ *
+ * NIST-developed software is expressly provided "AS IS." NIST MAKES NO
+ * WARRANTY OF ANY KIND, EXPRESS, IMPLIED, IN FACT OR ARISING BY OPERATION OF
+ * LAW, INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTY OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, NON-INFRINGEMENT
+ * AND DATA ACCURACY. NIST NEITHER REPRESENTS NOR WARRANTS THAT THE
+ * OPERATION OF THE SOFTWARE WILL BE UNINTERRUPTED OR ERROR-FREE, OR THAT
+ * ANY DEFECTS WILL BE CORRECTED. NIST DOES NOT WARRANT OR MAKE ANY
+ * REPRESENTATIONS REGARDING THE USE OF THE SOFTWARE OR THE RESULTS THEREOF,
+ * INCLUDING BUT NOT LIMITED TO THE CORRECTNESS, ACCURACY, RELIABILITY,
+ * OR USEFULNESS OF THE SOFTWARE.
+ *
+ * You are solely responsible for determining the appropriateness of using and
+ * distributing the software and you assume all risks associated with its use,
+ * including but not limited to the risks and costs of program errors,
+ * compliance with applicable laws, damage to or loss of data, programs or
+ * equipment, and the unavailability or interruption of operation. This
+ * software is not intended to be used in any situation where a failure could
+ * cause risk of injury or damage to property. The software developed by NIST
+ * employees is not subject to copyright protection within the United States.
+ *
+ * Author: Evan Black <evan.black@nist.gov>
+ */
+#include "binary/BinaryWriter.h"
+#include "file-parser.h"
+#include "json-writer.h"
+#include "parse-filter.h"
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <iostream>
+#include <mutex>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+/**
+ * Parse a comma separated list of IDs, in ascending order
+ *
+ * @param list
+ * The list from the command line (e.g. '1,2,5')
+ *
+ * @param ids
+ * Filled with the IDs
+ *
+ * @return
+ * False if an element is not a number
+ */
+bool parseIds(const std::string &list, std::vector<unsigned int> &ids) {
+  std::stringstream elements{list};
+  std::string element;
+  while (std::getline(elements, element, ',')) {
+    char *end = nullptr;
+    const auto id = std::strtoul(element.c_str(), &end, 10);
+    if (element.empty() || *end != '\0')
+      return false;
+    ids.emplace_back(static_cast<unsigned int>(id));
+  }
+
+  std::sort(ids.begin(), ids.end());
+  return true;
+}
+
+/**
+ * Parse a time in nanoseconds
+ *
+ * @return
+ * False if `value` is not a number
+ */
+bool parseTime(const std::string &value, std::optional<parser::nanoseconds> &time) {
+  char *end = nullptr;
+  time = std::strtoll(value.c_str(), &end, 10);
+  return !value.empty() && *end == '\0';
+}
+
+/**
+ * Hands batches of events from the parsing thread to the writing thread.
+ * Holds at most `capacity` batches, so a slow writer
+ * holds up the parser, rather than buffering the whole file
+ */
+class BatchQueue {
+  static constexpr std::size_t capacity = 4u;
+
+  std::mutex mutex;
+  std::condition_variable notFull;
+  std::condition_variable notEmpty;
+  std::deque<parser::EventBatch> batches;
+  bool closed = false;
+
+public:
+  /**
+   * Add a batch, waiting for room if the queue is full
+   */
+  void push(parser::EventBatch &&batch) {
+    std::unique_lock lock{mutex};
+    notFull.wait(lock, [this]() {
+      return batches.size() < capacity;
+    });
+    batches.emplace_back(std::move(batch));
+    notEmpty.notify_one();
+  }
+
+  /**
+   * Take the oldest batch, waiting for one if the queue is empty
+   *
+   * @return
+   * An unset optional once the queue is closed & empty
+   */
+  std::optional<parser::EventBatch> pop() {
+    std::unique_lock lock{mutex};
+    notEmpty.wait(lock, [this]() {
+      return !batches.empty() || closed;
+    });
+    if (batches.empty())
+      return {};
+
+    auto batch = std::move(batches.front());
+    batches.pop_front();
+    notFull.notify_one();
+    return batch;
+  }
+
+  /**
+   * Signal no more batches will be pushed
+   */
+  void close() {
+    std::scoped_lock lock{mutex};
+    closed = true;
+    notEmpty.notify_all();
+  }
+};
+
+/**
+ * Write `input` to `output` as JSON, writing each batch of events
+ * on a separate thread while the next one is parsed
+ *
+ * @return
+ * False if either file failed
+ */
+bool convertToJson(parser::FileParser &fileParser, const char *input, const char *output) {
+  parser::JsonWriter writer;
+  if (writer.open(output))
+    return false;
+
+  BatchQueue queue;
+  std::size_t eventCount = 0u;
+  std::thread writeThread{[&writer, &queue, &eventCount]() {
+    while (auto batch = queue.pop()) {
+      writer.writeEvents(batch->sceneEvents, batch->chartEvents, batch->logEvents);
+      eventCount += batch->sceneEvents.size() + batch->chartEvents.size() + batch->logEvents.size();
+    }
+  }};
+
+  // Called before any batch is pushed, so the writing thread is still waiting
+  fileParser.setProgressive(
+      [&writer, &fileParser]() {
+        writer.writeSections(fileParser);
+      },
+      [&queue](parser::EventBatch &&batch) {
+        queue.push(std::move(batch));
+      });
+
+  const auto parseError = fileParser.parse(input);
+  queue.close();
+  writeThread.join();
+
+  // Close the file even if parsing failed, so the partial output may be removed
+  const auto writeError = writer.finish();
+  if (parseError) {
+    std::cerr << "Failed to parse " << input << " at offset " << parseError->offset << ": " << parseError->message
+              << '\n';
+    std::remove(output);
+    return false;
+  }
+
+  if (writeError) {
+    std::cerr << "Failed to write " << output << ": " << writeError->message << '\n';
+    std::remove(output);
+    return false;
+  }
+
+  std::clog << eventCount << " events\n";
+  return true;
+}
+
+/**
+ * @return
+ * True if `path` ends with `extension`
+ */
+bool endsWith(const std::string &path, const std::string &extension) {
+  return path.size() >= extension.size() && path.compare(path.size() - extension.size(), extension.size(), extension) == 0;
+}
+
+void printUsage(const char *program) {
+  std::cerr << "Usage: " << program << " [options] <input> <output.nszb|output.json>\n"
+            << "The input may be any scenario the application opens.\n"
+            << "JSON output is written while the input is parsed, binary output once it is parsed whole\n"
+            << "Options, to keep only part of the scenario:\n"
+            << "  --begin <ns>         Drop events before this time, folding the Node & Decoration state into it\n"
+            << "  --end <ns>           Drop events after this time\n"
+            << "  --nodes <ids>        Only keep these Nodes, e.g. 1,2,5\n"
+            << "  --series <ids>       Only keep these series\n"
+            << "  --streams <ids>      Only keep these log streams\n"
+            << "  --drop <types>       Drop every event of these types, e.g. node-orientation,stream-append\n"
+            << "Other options:\n"
+            << "  --compact <units>    Drop moves within this distance of their Node's simplified path\n"
+            << "  --threads <n>        Threads to parse large JSON files with, 0 for one per hardware thread\n";
+}
+
+} // namespace
+
+/**
+ * One-shot converter from a scenario file
+ * to the binary scenario format, or back to JSON.
+ *
+ * Usage: netsimulyzer-convert [options] <input> <output.nszb|output.json>
+ */
+int main(int argc, char *argv[]) {
+  parser::ParseFilter filter;
+  std::optional<double> compaction;
+  std::optional<unsigned int> threads;
+  std::vector<const char *> paths;
+
+  for (auto i = 1; i < argc; i++) {
+    const std::string argument{argv[i]};
+    if (argument.compare(0u, 2u, "--") != 0) {
+      paths.emplace_back(argv[i]);
+      continue;
+    }
+
+    if (i + 1 == argc) {
+      std::cerr << "Missing value for " << argument << '\n';
+      printUsage(argv[0]);
+      return 1;
+    }
+    const std::string value{argv[++i]};
+
+    auto valid = true;
+    if (argument == "--begin")
+      valid = parseTime(value, filter.begin);
+    else if (argument == "--end")
+      valid = parseTime(value, filter.end);
+    else if (argument == "--nodes")
+      valid = parseIds(value, filter.nodes);
+    else if (argument == "--series")
+      valid = parseIds(value, filter.series);
+    else if (argument == "--streams")
+      valid = parseIds(value, filter.streams);
+    else if (argument == "--drop") {
+      std::stringstream types{value};
+      std::string type;
+      while (valid && std::getline(types, type, ','))
+        valid = filter.drop(type);
+    } else if (argument == "--compact") {
+      char *end = nullptr;
+      compaction = std::strtod(value.c_str(), &end);
+      valid = !value.empty() && *end == '\0' && *compaction >= 0.0;
+    } else if (argument == "--threads") {
+      char *end = nullptr;
+      threads = static_cast<unsigned int>(std::strtoul(value.c_str(), &end, 10));
+      valid = !value.empty() && *end == '\0';
+    } else {
+      std::cerr << "Unknown option: " << argument << '\n';
+      printUsage(argv[0]);
+      return 1;
+    }
+
+    if (!valid) {
+      std::cerr << "Invalid value for " << argument << ": " << value << '\n';
+      return 1;
+    }
+  }
+
+  if (paths.size() != 2u) {
+    printUsage(argv[0]);
+    return 1;
+  }
+
+  const auto input = paths[0];
+  const auto output = paths[1];
+
+  parser::FileParser fileParser;
+  fileParser.setFilter(filter);
+  fileParser.setCompaction(compaction);
+  if (threads)
+    fileParser.setParseThreads(*threads);
+
+  if (endsWith(output, ".json")) {
+    const auto start = std::chrono::steady_clock::now();
+    if (!convertToJson(fileParser, input, output))
+      return 1;
+
+    std::clog << "Converted " << input << " to " << output << " in "
+              << std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count()
+              << "ms\n";
+    if (compaction)
+      std::clog << "Compacted " << fileParser.getCompactedEvents() << " scene events\n";
+    return 0;
+  }
+
+  const auto parseStart = std::chrono::steady_clock::now();
+  if (const auto error = fileParser.parse(input)) {
+    std::cerr << "Failed to parse " << input << " at offset " << error->offset << ": " << error->message << '\n';
+    return 1;
+  }
+  const auto parseEnd = std::chrono::steady_clock::now();
+
+  if (const auto error = parser::binary::BinaryWriter{fileParser}.write(output)) {
+    std::cerr << "Failed to write " << output << ": " << error->message << '\n';
+    return 1;
+  }
+  const auto writeEnd = std::chrono::steady_clock::now();
+
+  using std::chrono::duration_cast;
+  using std::chrono::milliseconds;
+  std::clog << "Parsed " << input << " in " << duration_cast<milliseconds>(parseEnd - parseStart).count() << "ms\n"
+            << "Wrote " << output << " in " << duration_cast<milliseconds>(writeEnd - parseEnd).count() << "ms\n"
+            << fileParser.getSceneEvents().size() << " scene events, " << fileParser.getChartsEvents().size()
+            << " chart events, " << fileParser.getLogEvents().size() << " log events\n";
+  if (compaction)
+    std::clog << "Compacted " << fileParser.getCompactedEvents() << " scene events\n";
+
+  return 0;
+}
@@ -0,0 +1,96 @@
+/*
+ * NIST-developed software is provided by NIST as a public service. You may use,
+ * copy and distribute copies of the software in any medium, provided that you
+ * keep intact this entire notice. You may improve,modify and create derivative
+ * works of the software or any portion of the software, and you may copy and
+ * distribute such modifications or works. Modified works should carry a notice
+ * stating that you changed the software and should note the date and nature of
+ * any such change. Please explicitly acknowledge the National Institute of
+ * Standards and Technology as the source of the software.
+ *
+ * NIST-developed software is expressly provided "AS IS." NIST MAKES NO
+ * WARRANTY OF ANY KIND, EXPRESS, IMPLIED, IN FACT OR ARISING BY OPERATION OF
+ * LAW, INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTY OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, NON-INFRINGEMENT
+ * AND DATA ACCURACY. NIST NEITHER REPRESENTS NOR WARRANTS THAT THE
+ * OPERATION OF THE SOFTWARE WILL BE UNINTERRUPTED OR ERROR-FREE, OR THAT
+ * ANY DEFECTS WILL BE CORRECTED. NIST DOES NOT WARRANT OR MAKE ANY
+ * REPRESENTATIONS REGARDING THE USE OF THE SOFTWARE OR THE RESULTS THEREOF,
+ * INCLUDING BUT NOT LIMITED TO THE CORRECTNESS, ACCURACY, RELIABILITY,
+ * OR USEFULNESS OF THE SOFTWARE.
+ *
+ * You are solely responsible for determining the appropriateness of using and
+ * distributing the software and you assume all risks associated with its use,
+ * including but not limited to the risks and costs of program errors,
+ * compliance with applicable laws, damage to or loss of data, programs or
+ * equipment, and the unavailability or interruption of operation. This
+ * software is not intended to be used in any situation where a failure could
+ * cause risk of injury or damage to property. The software developed by NIST
+ * employees is not subject to copyright protection within the United States.
+ *
+ * Author: Evan Black <evan.black@nist.gov>
+ */
+
+#include "arrow-export.h"
+#include "file-parser.h"
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+/**
+ * Headless export of the events of a scenario, as Arrow IPC files.
+ *
+ * Parses a scenario once, then writes one file per kind of event into `directory`,
+ * see `parser::exportEvents()`, for analysis with e.g. pyarrow, pandas or polars
+ * without parsing the JSON again. No Qt is needed.
+ *
+ * Usage: netsimulyzer-export <scenario> <directory> [--batch <rows>]
+ */
+int main(int argc, char *argv[]) {
+  auto usage = [argv]() {
+    std::cerr << "Usage: " << argv[0] << " <scenario> <directory> [--batch <rows>]\n";
+    return 1;
+  };
+  if (argc < 3)
+    return usage();
+
+  const auto input = argv[1];
+  const auto directory = argv[2];
+  std::size_t batchRows = 65536u;
+
+  for (auto i = 3; i < argc; i++) {
+    const auto hasValue = i + 1 < argc;
+    if (std::strcmp(argv[i], "--batch") == 0 && hasValue)
+      batchRows = std::strtoull(argv[++i], nullptr, 10);
+    else
+      return usage();
+  }
+  if (batchRows == 0u)
+    return usage();
+
+  const auto start = std::chrono::steady_clock::now();
+  parser::FileParser fileParser;
+  if (const auto error = fileParser.parse(input)) {
+    std::cerr << "Failed to parse " << input << " at offset " << error->offset << ": " << error->message << '\n';
+    return 1;
+  }
+  const auto parsed = std::chrono::steady_clock::now();
+
+  auto failed = false;
+  for (const auto &file : parser::exportEvents(fileParser, directory, batchRows)) {
+    if (file.written) {
+      std::cout << file.path << ": " << file.rows << " rows\n";
+    } else {
+      std::cerr << "Failed to write " << file.path << '\n';
+      failed = true;
+    }
+  }
+
+  using std::chrono::duration_cast;
+  using std::chrono::milliseconds;
+  const auto end = std::chrono::steady_clock::now();
+  std::cout << "Parsed in " << duration_cast<milliseconds>(parsed - start).count() << "ms, exported in "
+            << duration_cast<milliseconds>(end - parsed).count() << "ms\n";
+  return failed ? 1 : 0;
+}
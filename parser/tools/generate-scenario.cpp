@@ -0,0 +1,729 @@
+/*
+ * NIST-developed software is provided by NIST as a public service. You may use,
+ * copy and distribute copies of the software in any medium, provided that you
+ * keep intact this entire notice. You may improve,modify and create derivative
+ * works of the software or any portion of the software, and you may copy and
+ * distribute such modifications or works. Modified works should carry a notice
+ * stating that you changed the software and should note the date and nature of
+ * any such change. Please explicitly acknowledge the National Institute of
+ * Standards and Technology as the source of the software.
+ *
+ * NIST-developed software is expressly provided "AS IS." NIST MAKES NO
+ * WARRANTY OF ANY KIND, EXPRESS, IMPLIED, IN FACT OR ARISING BY OPERATION OF
+ * LAW, INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTY OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, NON-INFRINGEMENT
+ * AND DATA ACCURACY. NIST NEITHER REPRESENTS NOR WARRANTS THAT THE
+ * OPERATION OF THE SOFTWARE WILL BE UNINTERRUPTED OR ERROR-FREE, OR THAT
+ * ANY DEFECTS WILL BE CORRECTED. NIST DOES NOT WARRANT OR MAKE ANY
+ * REPRESENTATIONS REGARDING THE USE OF THE SOFTWARE OR THE RESULTS THEREOF,
+ * INCLUDING BUT NOT LIMITED TO THE CORRECTNESS, ACCURACY, RELIABILITY,
+ * OR USEFULNESS OF THE SOFTWARE.
+ *
+ * You are solely responsible for determining the appropriateness of using and
+ * distributing the software and you assume all risks associated with its use,
+ * including but not limited to the risks and costs of program errors,
+ * compliance with applicable laws, damage to or loss of data, programs or
+ * equipment, and the unavailability or interruption of operation. This
+ * software is not intended to be used in any situation where a failure could
+ * cause risk of injury or damage to property. The software developed by NIST
+ * employees is not subject to copyright protection within the United States.
+ *
+ * Author: Evan Black <evan.black@nist.gov>
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <rapidjson/stringbuffer.h>
+#include <rapidjson/writer.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * Synthetic scenario generator, for scale testing the parser & the application.
+ *
+ * Writes a scenario with the requested number of nodes, buildings, areas, links, series & log streams,
+ * then `duration` seconds of events at the requested rates. The events are produced a second of
+ * simulation time at a time, by `threads` workers, & written in order as each second is finished,
+ * so the file is streamed rather than held in memory.
+ *
+ * Each second is seeded from `seed` & its index alone, and node positions are a function of time,
+ * so the output is the same for any number of threads.
+ *
+ * Usage: netsimulyzer-generate <output> [--nodes n] [--buildings n] [--areas n] [--links n] [--series n]
+ *        [--streams n] [--duration seconds] [--position-rate hz] [--transmit-rate hz] [--series-rate hz]
+ *        [--log-rate hz] [--threads n] [--seed n]
+ *
+ * Rates are per node, series, or stream, per second of simulation time
+ */
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+using JsonOut = rapidjson::Writer<rapidjson::StringBuffer>;
+
+constexpr long long nsPerSecond = 1'000'000'000LL;
+
+/**
+ * Side of the square the nodes, buildings & areas are placed in, in meters
+ */
+constexpr double worldSize = 1000.0;
+
+struct Options {
+  unsigned long nodes = 1000ul;
+  unsigned long buildings = 20ul;
+  unsigned long areas = 10ul;
+  unsigned long links = 500ul;
+  unsigned long series = 10ul;
+  unsigned long streams = 5ul;
+  unsigned long duration = 600ul;
+  double positionRate = 10.0;
+  double transmitRate = 1.0;
+  double seriesRate = 10.0;
+  double logRate = 1.0;
+  unsigned int threads = std::max(1u, std::thread::hardware_concurrency());
+  unsigned long seed = 1ul;
+};
+
+/**
+ * A node circles its own point, so its position may be found
+ * at any time without walking through the earlier events
+ */
+struct Orbit {
+  double x;
+  double y;
+  double radius;
+
+  /**
+   * Radians per second, negative for clockwise
+   */
+  double speed;
+  double phase;
+};
+
+/**
+ * An event to write, before it is formatted
+ */
+struct PendingEvent {
+  enum class Kind { Position, Transmit, Series, Log };
+
+  long long time;
+  Kind kind;
+  unsigned int id;
+};
+
+void writeKey(JsonOut &writer, const char *key) {
+  writer.Key(key);
+}
+
+void writeColor(JsonOut &writer, const char *key, unsigned int red, unsigned int green, unsigned int blue) {
+  writeKey(writer, key);
+  writer.StartObject();
+  writeKey(writer, "red");
+  writer.Uint(red);
+  writeKey(writer, "green");
+  writer.Uint(green);
+  writeKey(writer, "blue");
+  writer.Uint(blue);
+  writer.EndObject();
+}
+
+void writeXYZ(JsonOut &writer, const char *key, double x, double y, double z) {
+  writeKey(writer, key);
+  writer.StartObject();
+  writeKey(writer, "x");
+  writer.Double(x);
+  writeKey(writer, "y");
+  writer.Double(y);
+  writeKey(writer, "z");
+  writer.Double(z);
+  writer.EndObject();
+}
+
+void writeAxis(JsonOut &writer, const char *key, const char *name, double max) {
+  writeKey(writer, key);
+  writer.StartObject();
+  writeKey(writer, "name");
+  writer.String(name);
+  writeKey(writer, "scale");
+  writer.String("linear");
+  writeKey(writer, "bound-mode");
+  writer.String("highest value");
+  writeKey(writer, "min");
+  writer.Double(0.0);
+  writeKey(writer, "max");
+  writer.Double(max);
+  writer.EndObject();
+}
+
+void startEvent(JsonOut &writer, const char *type, long long time) {
+  writer.StartObject();
+  writeKey(writer, "type");
+  writer.String(type);
+  writeKey(writer, "nanoseconds");
+  writer.Int64(time);
+}
+
+std::vector<Orbit> makeOrbits(const Options &options) {
+  std::mt19937_64 random{options.seed};
+  std::uniform_real_distribution<double> coordinate{0.0, worldSize};
+  std::uniform_real_distribution<double> radius{5.0, 50.0};
+  std::uniform_real_distribution<double> speed{-0.5, 0.5};
+  std::uniform_real_distribution<double> phase{0.0, 6.283185307179586};
+
+  std::vector<Orbit> orbits;
+  orbits.reserve(options.nodes);
+  for (auto i = 0ul; i < options.nodes; i++)
+    orbits.push_back({coordinate(random), coordinate(random), radius(random), speed(random), phase(random)});
+
+  return orbits;
+}
+
+/**
+ * Write the configuration & every section other than 'events', then open the 'events' section
+ */
+void writeSections(rapidjson::StringBuffer &buffer, const Options &options, const std::vector<Orbit> &orbits) {
+  std::mt19937_64 random{options.seed ^ 0x5EC7105ull};
+  std::uniform_real_distribution<double> coordinate{0.0, worldSize};
+  std::uniform_real_distribution<double> extent{10.0, 60.0};
+  std::uniform_int_distribution<unsigned int> channel{0u, 255u};
+  std::uniform_int_distribution<unsigned int> smallCount{1u, 8u};
+
+  JsonOut writer{buffer};
+  writer.StartObject();
+
+  writeKey(writer, "configuration");
+  writer.StartObject();
+  writeKey(writer, "module-version");
+  writer.StartObject();
+  writeKey(writer, "major");
+  writer.Int(1);
+  writeKey(writer, "minor");
+  writer.Int(0);
+  writeKey(writer, "patch");
+  writer.Int(7);
+  writeKey(writer, "suffix");
+  writer.String("generated");
+  writer.EndObject();
+  writeKey(writer, "max-time");
+  writer.Int64(static_cast<long long>(options.duration) * nsPerSecond);
+  writeKey(writer, "time-step");
+  writer.StartObject();
+  writeKey(writer, "increment");
+  writer.Int64(1'000'000LL);
+  writeKey(writer, "granularity");
+  writer.String("milliseconds");
+  writer.EndObject();
+  writer.EndObject();
+
+  writeKey(writer, "nodes");
+  writer.StartArray();
+  for (auto i = 0u; i < orbits.size(); i++) {
+    const auto &orbit = orbits[i];
+    const auto name = "Node " + std::to_string(i);
+
+    writer.StartObject();
+    writeKey(writer, "type");
+    writer.String("node");
+    writeKey(writer, "id");
+    writer.Uint(i);
+    writeKey(writer, "name");
+    writer.String(name.c_str(), static_cast<rapidjson::SizeType>(name.size()));
+    writeKey(writer, "label-enabled");
+    writer.Bool(true);
+    writeKey(writer, "model");
+    writer.String("models/smartphone.obj");
+    writeXYZ(writer, "scale", 1.0, 1.0, 1.0);
+    writeKey(writer, "target-scale");
+    writer.StartObject();
+    writeKey(writer, "keep-ratio");
+    writer.Bool(true);
+    writeKey(writer, "height");
+    writer.Double(2.0);
+    writer.EndObject();
+    writeXYZ(writer, "orientation", 0.0, 0.0, 0.0);
+    writeKey(writer, "visible");
+    writer.Bool(true);
+    writeXYZ(writer, "position", orbit.x + orbit.radius * std::cos(orbit.phase),
+             orbit.y + orbit.radius * std::sin(orbit.phase), 0.0);
+    writeXYZ(writer, "offset", 0.0, 0.0, 0.0);
+    writeKey(writer, "trail-enabled");
+    writer.Bool(false);
+    writeColor(writer, "trail-color", channel(random), channel(random), channel(random));
+    writer.EndObject();
+  }
+  writer.EndArray();
+
+  writeKey(writer, "buildings");
+  writer.StartArray();
+  for (auto i = 0u; i < options.buildings; i++) {
+    const auto x = coordinate(random);
+    const auto y = coordinate(random);
+    const auto floors = smallCount(random);
+
+    writer.StartObject();
+    writeKey(writer, "type");
+    writer.String("building");
+    writeKey(writer, "id");
+    writer.Uint(i);
+    writeColor(writer, "color", 204u, 204u, 204u);
+    writeKey(writer, "visible");
+    writer.Bool(true);
+    writeKey(writer, "floors");
+    writer.Uint(floors);
+    writeKey(writer, "rooms");
+    writer.StartObject();
+    writeKey(writer, "x");
+    writer.Uint(smallCount(random));
+    writeKey(writer, "y");
+    writer.Uint(smallCount(random));
+    writer.EndObject();
+
+    writeKey(writer, "bounds");
+    writer.StartObject();
+    const std::pair<double, double> bounds[]{
+        {x, x + extent(random)}, {y, y + extent(random)}, {0.0, 3.0 * static_cast<double>(floors)}};
+    const char *axes[]{"x", "y", "z"};
+    for (auto axis = 0u; axis < 3u; axis++) {
+      writeKey(writer, axes[axis]);
+      writer.StartObject();
+      writeKey(writer, "min");
+      writer.Double(bounds[axis].first);
+      writeKey(writer, "max");
+      writer.Double(bounds[axis].second);
+      writer.EndObject();
+    }
+    writer.EndObject();
+    writer.EndObject();
+  }
+  writer.EndArray();
+
+  writeKey(writer, "decorations");
+  writer.StartArray();
+  writer.EndArray();
+
+  writeKey(writer, "areas");
+  writer.StartArray();
+  for (auto i = 0u; i < options.areas; i++) {
+    const auto x = coordinate(random);
+    const auto y = coordinate(random);
+    const auto width = 2.0 * extent(random);
+    const auto depth = 2.0 * extent(random);
+    const auto name = "Area " + std::to_string(i);
+
+    writer.StartObject();
+    writeKey(writer, "type");
+    writer.String("rectangular-area");
+    writeKey(writer, "id");
+    writer.Uint(i);
+    writeKey(writer, "name");
+    writer.String(name.c_str(), static_cast<rapidjson::SizeType>(name.size()));
+    writeKey(writer, "height");
+    writer.Double(0.1);
+    writeKey(writer, "points");
+    writer.StartArray();
+    const std::pair<double, double> corners[]{{x, y}, {x + width, y}, {x + width, y + depth}, {x, y + depth}};
+    for (const auto &[cornerX, cornerY] : corners) {
+      writer.StartObject();
+      writeKey(writer, "x");
+      writer.Double(cornerX);
+      writeKey(writer, "y");
+      writer.Double(cornerY);
+      writer.EndObject();
+    }
+    writer.EndArray();
+    writeKey(writer, "fill-mode");
+    writer.String("solid");
+    writeColor(writer, "fill-color", channel(random), channel(random), channel(random));
+    writeKey(writer, "border-mode");
+    writer.String("solid");
+    writeColor(writer, "border-color", 0u, 0u, 0u);
+    writer.EndObject();
+  }
+  writer.EndArray();
+
+  writeKey(writer, "links");
+  writer.StartArray();
+  // Links need two distinct nodes
+  if (options.nodes > 1ul) {
+    std::uniform_int_distribution<unsigned long> node{0ul, options.nodes - 1ul};
+    for (auto i = 0ul; i < options.links; i++) {
+      const auto first = node(random);
+      auto second = node(random);
+      if (second == first)
+        second = (first + 1ul) % options.nodes;
+
+      writer.StartObject();
+      writeKey(writer, "type");
+      writer.String("point-to-point");
+      writeKey(writer, "node-ids");
+      writer.StartArray();
+      writer.Uint64(first);
+      writer.Uint64(second);
+      writer.EndArray();
+      writer.EndObject();
+    }
+  }
+  writer.EndArray();
+
+  writeKey(writer, "series");
+  writer.StartArray();
+  for (auto i = 0u; i < options.series; i++) {
+    const auto name = "Series " + std::to_string(i);
+
+    writer.StartObject();
+    writeKey(writer, "type");
+    writer.String("xy-series");
+    writeKey(writer, "id");
+    writer.Uint(i);
+    writeKey(writer, "name");
+    writer.String(name.c_str(), static_cast<rapidjson::SizeType>(name.size()));
+    writeKey(writer, "legend");
+    writer.String(name.c_str(), static_cast<rapidjson::SizeType>(name.size()));
+    writeKey(writer, "visible");
+    writer.Bool(true);
+    writeKey(writer, "color");
+    writer.StartObject();
+    writeKey(writer, "red");
+    writer.Uint(channel(random));
+    writeKey(writer, "green");
+    writer.Uint(channel(random));
+    writeKey(writer, "blue");
+    writer.Uint(channel(random));
+    writeKey(writer, "alpha");
+    writer.Uint(255u);
+    writer.EndObject();
+    writeKey(writer, "connection");
+    writer.String("line");
+    writeKey(writer, "labels");
+    writer.String("hidden");
+    writeAxis(writer, "x-axis", "Time (s)", static_cast<double>(options.duration));
+    writeAxis(writer, "y-axis", "Value", 100.0);
+    writer.EndObject();
+  }
+  writer.EndArray();
+
+  writeKey(writer, "streams");
+  writer.StartArray();
+  for (auto i = 0u; i < options.streams; i++) {
+    const auto name = "Stream " + std::to_string(i);
+
+    writer.StartObject();
+    writeKey(writer, "type");
+    writer.String("stream");
+    writeKey(writer, "id");
+    writer.Uint(i);
+    writeKey(writer, "name");
+    writer.String(name.c_str(), static_cast<rapidjson::SizeType>(name.size()));
+    writeKey(writer, "visible");
+    writer.Bool(true);
+    writer.EndObject();
+  }
+  writer.EndArray();
+
+  // The writer must see a complete document, so 'events' is opened by hand
+  buffer.Put(',');
+  for (const auto c : std::string{R"("events":[)"})
+    buffer.Put(c);
+}
+
+/**
+ * Add `rate` events per second for each of `count` ids, over the second starting at `start`.
+ * The fractional part of `rate` becomes the chance of one more event
+ */
+void schedule(std::vector<PendingEvent> &events, std::mt19937_64 &random, PendingEvent::Kind kind,
+              unsigned long count, double rate, long long start) {
+  const auto whole = static_cast<unsigned long>(rate);
+  std::bernoulli_distribution extra{rate - static_cast<double>(whole)};
+  std::uniform_int_distribution<long long> offset{0LL, nsPerSecond - 1LL};
+
+  for (auto id = 0ul; id < count; id++) {
+    const auto total = whole + (extra(random) ? 1ul : 0ul);
+    for (auto i = 0ul; i < total; i++)
+      events.push_back({start + offset(random), kind, static_cast<unsigned int>(id)});
+  }
+}
+
+/**
+ * Produce & format the events for the second of simulation time `window`.
+ * Every event is preceded by a comma, the caller drops the very first one
+ */
+std::string generateWindow(unsigned long window, const Options &options, const std::vector<Orbit> &orbits) {
+  std::seed_seq seed{options.seed, window};
+  std::mt19937_64 random{seed};
+  std::uniform_int_distribution<unsigned int> channel{0u, 255u};
+  std::normal_distribution<double> noise{0.0, 5.0};
+  const auto start = static_cast<long long>(window) * nsPerSecond;
+
+  std::vector<PendingEvent> events;
+  schedule(events, random, PendingEvent::Kind::Position, options.nodes, options.positionRate, start);
+  schedule(events, random, PendingEvent::Kind::Transmit, options.nodes, options.transmitRate, start);
+  schedule(events, random, PendingEvent::Kind::Series, options.series, options.seriesRate, start);
+  schedule(events, random, PendingEvent::Kind::Log, options.streams, options.logRate, start);
+  std::stable_sort(events.begin(), events.end(), [](const PendingEvent &left, const PendingEvent &right) {
+    return left.time < right.time;
+  });
+
+  rapidjson::StringBuffer buffer;
+  JsonOut writer{buffer};
+  std::string message;
+  for (const auto &event : events) {
+    buffer.Put(',');
+    writer.Reset(buffer);
+
+    const auto seconds = static_cast<double>(event.time) / static_cast<double>(nsPerSecond);
+    switch (event.kind) {
+    case PendingEvent::Kind::Position: {
+      const auto &orbit = orbits[event.id];
+      const auto angle = orbit.phase + orbit.speed * seconds;
+      startEvent(writer, "node-position", event.time);
+      writeKey(writer, "id");
+      writer.Uint(event.id);
+      writeKey(writer, "x");
+      writer.Double(orbit.x + orbit.radius * std::cos(angle));
+      writeKey(writer, "y");
+      writer.Double(orbit.y + orbit.radius * std::sin(angle));
+      writeKey(writer, "z");
+      writer.Double(0.0);
+    } break;
+    case PendingEvent::Kind::Transmit:
+      startEvent(writer, "node-transmit", event.time);
+      writeKey(writer, "id");
+      writer.Uint(event.id);
+      writeKey(writer, "duration");
+      writer.Int64(100'000'000LL);
+      writeKey(writer, "target-size");
+      writer.Double(20.0);
+      writeColor(writer, "color", channel(random), channel(random), channel(random));
+      break;
+    case PendingEvent::Kind::Series:
+      startEvent(writer, "xy-series-append", event.time);
+      writeKey(writer, "series-id");
+      writer.Uint(event.id);
+      writeKey(writer, "x");
+      writer.Double(seconds);
+      writeKey(writer, "y");
+      writer.Double(50.0 + 40.0 * std::sin(seconds / (10.0 + event.id)) + noise(random));
+      break;
+    case PendingEvent::Kind::Log:
+      message = "t=" + std::to_string(seconds) + "s: synthetic message from stream " + std::to_string(event.id) +
+                '\n';
+      startEvent(writer, "stream-append", event.time);
+      writeKey(writer, "stream-id");
+      writer.Uint(event.id);
+      writeKey(writer, "data");
+      writer.String(message.c_str(), static_cast<rapidjson::SizeType>(message.size()));
+      break;
+    }
+    writer.EndObject();
+  }
+
+  return {buffer.GetString(), buffer.GetSize()};
+}
+
+/**
+ * Hands out windows to the workers & collects them, so they may be written in order.
+ * At most `limit` windows are generated ahead of the one being written, which bounds the memory used
+ */
+class WindowQueue {
+  std::mutex mutex;
+  std::condition_variable finished;
+  std::condition_variable space;
+  std::map<unsigned long, std::string> done;
+  unsigned long next = 0ul;
+  unsigned long written = 0ul;
+  unsigned long windows;
+  unsigned long limit;
+
+public:
+  WindowQueue(unsigned long windows, unsigned long limit) : windows(windows), limit(limit) {
+  }
+
+  /**
+   * Claim the next window to generate
+   *
+   * @return
+   * False once every window has been claimed
+   */
+  bool claim(unsigned long &window) {
+    std::unique_lock lock{mutex};
+    space.wait(lock, [this] {
+      return next >= windows || next < written + limit;
+    });
+    if (next >= windows)
+      return false;
+
+    window = next++;
+    return true;
+  }
+
+  void complete(unsigned long window, std::string text) {
+    {
+      std::lock_guard lock{mutex};
+      done.emplace(window, std::move(text));
+    }
+    finished.notify_all();
+  }
+
+  /**
+   * Wait for the next window in order & take it
+   */
+  std::string take() {
+    std::unique_lock lock{mutex};
+    finished.wait(lock, [this] {
+      return done.count(written) > 0u;
+    });
+
+    auto node = done.extract(written++);
+    lock.unlock();
+    space.notify_all();
+    return std::move(node.mapped());
+  }
+};
+
+bool parseOptions(int argc, char *argv[], Options &options) {
+  for (auto i = 2; i < argc; i += 2) {
+    if (i + 1 >= argc)
+      return false;
+
+    const auto key = argv[i];
+    const auto value = argv[i + 1];
+    if (std::strcmp(key, "--nodes") == 0)
+      options.nodes = std::strtoul(value, nullptr, 10);
+    else if (std::strcmp(key, "--buildings") == 0)
+      options.buildings = std::strtoul(value, nullptr, 10);
+    else if (std::strcmp(key, "--areas") == 0)
+      options.areas = std::strtoul(value, nullptr, 10);
+    else if (std::strcmp(key, "--links") == 0)
+      options.links = std::strtoul(value, nullptr, 10);
+    else if (std::strcmp(key, "--series") == 0)
+      options.series = std::strtoul(value, nullptr, 10);
+    else if (std::strcmp(key, "--streams") == 0)
+      options.streams = std::strtoul(value, nullptr, 10);
+    else if (std::strcmp(key, "--duration") == 0)
+      options.duration = std::strtoul(value, nullptr, 10);
+    else if (std::strcmp(key, "--position-rate") == 0)
+      options.positionRate = std::max(0.0, std::strtod(value, nullptr));
+    else if (std::strcmp(key, "--transmit-rate") == 0)
+      options.transmitRate = std::max(0.0, std::strtod(value, nullptr));
+    else if (std::strcmp(key, "--series-rate") == 0)
+      options.seriesRate = std::max(0.0, std::strtod(value, nullptr));
+    else if (std::strcmp(key, "--log-rate") == 0)
+      options.logRate = std::max(0.0, std::strtod(value, nullptr));
+    else if (std::strcmp(key, "--threads") == 0)
+      options.threads = std::max(1u, static_cast<unsigned int>(std::strtoul(value, nullptr, 10)));
+    else if (std::strcmp(key, "--seed") == 0)
+      options.seed = std::strtoul(value, nullptr, 10);
+    else {
+      std::cerr << "Unknown option: " << key << '\n';
+      return false;
+    }
+  }
+
+  return true;
+}
+
+void printUsage(std::ostream &out, const char *program) {
+  out << "Usage: " << program
+      << " <output> [--nodes n] [--buildings n] [--areas n] [--links n] [--series n] [--streams n]"
+         " [--duration seconds] [--position-rate hz] [--transmit-rate hz] [--series-rate hz]"
+         " [--log-rate hz] [--threads n] [--seed n]\n";
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  for (auto i = 1; i < argc; i++) {
+    if (std::strcmp(argv[i], "-h") == 0 || std::strcmp(argv[i], "--help") == 0) {
+      printUsage(std::cout, argv[0]);
+      return 0;
+    }
+  }
+
+  // An option in place of the output would otherwise be created as a file
+  if (argc > 1 && argv[1][0] == '-') {
+    std::cerr << "The output must come first, and may not start with '-': " << argv[1] << '\n';
+    printUsage(std::cerr, argv[0]);
+    return 1;
+  }
+
+  Options options;
+  if (argc < 2 || !parseOptions(argc, argv, options)) {
+    printUsage(std::cerr, argv[0]);
+    return 1;
+  }
+
+  const auto output = argv[1];
+  std::unique_ptr<FILE, decltype(&std::fclose)> file{std::fopen(output, "wb"), std::fclose};
+  if (!file) {
+    std::cerr << "Failed to open " << output << '\n';
+    return 1;
+  }
+
+  const auto start = Clock::now();
+  const auto orbits = makeOrbits(options);
+  auto failed = false;
+  std::size_t written = 0u;
+  const auto write = [&file, &failed, &written](const char *data, std::size_t size) {
+    if (size > 0u && std::fwrite(data, size, 1u, file.get()) != 1u)
+      failed = true;
+    written += size;
+  };
+
+  rapidjson::StringBuffer sections;
+  writeSections(sections, options, orbits);
+  write(sections.GetString(), sections.GetSize());
+
+  WindowQueue queue{options.duration, 2ul * options.threads};
+  std::vector<std::thread> workers;
+  for (auto i = 0u; i < options.threads; i++) {
+    workers.emplace_back([&queue, &options, &orbits] {
+      unsigned long window;
+      while (queue.claim(window))
+        queue.complete(window, generateWindow(window, options, orbits));
+    });
+  }
+
+  auto first = true;
+  for (auto window = 0ul; window < options.duration; window++) {
+    const auto text = queue.take();
+    if (text.empty())
+      continue;
+
+    // Drop the leading comma of the first event written
+    const auto skip = first ? 1u : 0u;
+    write(text.data() + skip, text.size() - skip);
+    first = false;
+
+    if ((window + 1ul) % 60ul == 0ul)
+      std::cout << "generated " << window + 1ul << '/' << options.duration << " s, "
+                << static_cast<double>(written) / 1'000'000.0 << " MB\n";
+  }
+
+  for (auto &worker : workers)
+    worker.join();
+
+  write("]}\n", 3u);
+  if (std::fclose(file.release()) != 0 || failed) {
+    std::cerr << "Failed writing " << output << '\n';
+    return 1;
+  }
+
+  const auto time = std::chrono::duration<double>(Clock::now() - start).count();
+  std::cout << std::fixed << std::setprecision(3);
+  std::cout << "scenario: " << output << ", " << static_cast<double>(written) / 1'000'000.0 << " MB in " << time
+            << " s, " << static_cast<double>(written) / 1'000'000.0 / time << " MB/s\n";
+
+  return 0;
+}
@@ -0,0 +1,174 @@
+/*
+ * NIST-developed software is provided by NIST as a public service. You may use,
+ * copy and distribute copies of the software in any medium, provided that you
+ * keep intact this entire notice. You may improve,modify and create derivative
+ * works of the software or any portion of the software, and you may copy and
+ * distribute such modifications or works. Modified works should carry a notice
+ * stating that you changed the software and should note the date and nature of
+ * any such change. Please explicitly acknowledge the National Institute of
+ * Standards and Technology as the source of the software.
+ *
+ * NIST-developed software is expressly provided "AS IS." NIST MAKES NO
+ * WARRANTY OF ANY KIND, EXPRESS, IMPLIED, IN FACT OR ARISING BY OPERATION OF
+ * LAW, INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTY OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, NON-INFRINGEMENT
+ * AND DATA ACCURACY. NIST NEITHER REPRESENTS NOR WARRANTS THAT THE
+ * OPERATION OF THE SOFTWARE WILL BE UNINTERRUPTED OR ERROR-FREE, OR THAT
+ * ANY DEFECTS WILL BE CORRECTED. NIST DOES NOT WARRANT OR MAKE ANY
+ * REPRESENTATIONS REGARDING THE USE OF THE SOFTWARE OR THE RESULTS THEREOF,
+ * INCLUDING BUT NOT LIMITED TO THE CORRECTNESS, ACCURACY, RELIABILITY,
+ * OR USEFULNESS OF THE SOFTWARE.
+ *
+ * You are solely responsible for determining the appropriateness of using and
+ * distributing the software and you assume all risks associated with its use,
+ * including but not limited to the risks and costs of program errors,
+ * compliance with applicable laws, damage to or loss of data, programs or
+ * equipment, and the unavailability or interruption of operation. This
+ * software is not intended to be used in any situation where a failure could
+ * cause risk of injury or damage to property. The software developed by NIST
+ * employees is not subject to copyright protection within the United States.
+ *
+ * Author: Evan Black <evan.black@nist.gov>
+ */
+
+#include "file-parser.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+
+/**
+ * Headless event parsing benchmark.
+ *
+ * Writes a scenario of mostly 'node-position' events to `output`, shaped like the ns-3 module's output,
+ * then parses it with & without the flat event scanner (`FileParser::setFastEvents()`),
+ * and with the scanner & in-situ parsing (`FileParser::setInSitu()`), reporting the throughput of each.
+ * One event in 20 is a 'node-color' event, which the scanner leaves to RapidJSON,
+ * so the fallback is measured as well.
+ * Last, the scenario is parsed into a sink which only counts the events (see `parser::ParseSink`),
+ * so nothing is kept.
+ *
+ * Usage: netsimulyzer-parse-bench <output> [events]
+ */
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+/**
+ * Counts the scene events passed to it, and keeps nothing
+ */
+class CountingSink : public parser::ParseSink {
+public:
+  std::size_t sceneEvents{0u};
+
+  void addSceneEvent(parser::SceneEvent &&) override {
+    sceneEvents++;
+  }
+};
+
+/**
+ * Write the scenario
+ *
+ * @return
+ * The size of the file in bytes, 0 if it could not be written
+ */
+std::size_t writeScenario(const char *path, unsigned long events) {
+  std::ofstream file{path, std::ios::binary};
+  if (!file)
+    return 0u;
+
+  // Fixed seed, so runs are comparable
+  std::mt19937 random{1u};
+  std::uniform_real_distribution<double> coordinate{-500.0, 500.0};
+  std::uniform_int_distribution<unsigned int> node{0u, 999u};
+  std::uniform_int_distribution<unsigned int> channel{0u, 255u};
+
+  file << R"({"configuration":{"module-version":{"major":1,"minor":0,"patch":7},)"
+       << R"("time-step":{"increment":1000000,"granularity":"ns"}},"nodes":[],"events":[)";
+  file << std::setprecision(17);
+
+  for (auto i = 0ul; i < events; i++) {
+    if (i > 0ul)
+      file << ",\n";
+
+    const auto time = static_cast<long long>(i) * 1000LL;
+    if (i % 20ul == 19ul) {
+      file << R"({"type":"node-color","nanoseconds":)" << time << R"(,"id":)" << node(random)
+           << R"(,"color-type":"base","color":{"red":)" << channel(random) << R"(,"green":)" << channel(random)
+           << R"(,"blue":)" << channel(random) << "}}";
+    } else {
+      file << R"({"type":"node-position","nanoseconds":)" << time << R"(,"id":)" << node(random)
+           << R"(,"x":)" << coordinate(random) << R"(,"y":)" << coordinate(random) << R"(,"z":)"
+           << coordinate(random) << '}';
+    }
+  }
+
+  file << "]}\n";
+  if (!file)
+    return 0u;
+
+  return static_cast<std::size_t>(file.tellp());
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  if (argc != 2 && argc != 3) {
+    std::cerr << "Usage: " << argv[0] << " <output> [events]\n";
+    return 1;
+  }
+
+  const auto output = argv[1];
+  const auto events = argc == 3 ? std::strtoul(argv[2], nullptr, 10) : 5'000'000ul;
+
+  const auto fileSize = writeScenario(output, events);
+  if (fileSize == 0u) {
+    std::cerr << "Failed to write " << output << '\n';
+    return 1;
+  }
+
+  std::cout << std::fixed << std::setprecision(3);
+  std::cout << "scenario: " << output << ", " << static_cast<double>(fileSize) / 1'000'000.0 << " MB, " << events
+            << " events\n";
+
+  struct Mode {
+    const char *name;
+    bool fast;
+    bool inSitu;
+  };
+
+  for (const auto &mode : {Mode{"rapidjson: ", false, false}, Mode{"scanner:   ", true, false},
+                           Mode{"in situ:   ", true, true}}) {
+    parser::FileParser fileParser;
+    fileParser.setFastEvents(mode.fast);
+    fileParser.setInSitu(mode.inSitu);
+
+    const auto start = Clock::now();
+    if (const auto error = fileParser.parse(output)) {
+      std::cerr << "Failed to parse " << output << " at offset " << error->offset << ": " << error->message << '\n';
+      return 1;
+    }
+    const auto time = std::chrono::duration<double>(Clock::now() - start).count();
+
+    std::cout << mode.name << time << " s, "
+              << static_cast<double>(fileSize) / 1'000'000'000.0 / time << " GB/s, "
+              << fileParser.getSceneEvents().size() << " scene events\n";
+  }
+
+  parser::FileParser fileParser;
+  CountingSink sink;
+  const auto start = Clock::now();
+  if (const auto error = fileParser.parse(output, sink)) {
+    std::cerr << "Failed to parse " << output << " at offset " << error->offset << ": " << error->message << '\n';
+    return 1;
+  }
+  const auto time = std::chrono::duration<double>(Clock::now() - start).count();
+  std::cout << "streamed:  " << time << " s, " << static_cast<double>(fileSize) / 1'000'000'000.0 / time
+            << " GB/s, " << sink.sceneEvents << " scene events\n";
+
+  return 0;
+}
@@ -0,0 +1,446 @@
+/*
+ * NIST-developed software is provided by NIST as a public service. You may use,
+ * copy and distribute copies of the software in any medium, provided that you
+ * keep intact this entire notice. You may improve,modify and create derivative
+ * works of the software or any portion of the software, and you may copy and
+ * distribute such modifications or works. Modified works should carry a notice
+ * stating that you changed the software and should note the date and nature of
+ * any such change. Please explicitly acknowledge the National Institute of
+ * Standards and Technology as the source of the software.
+ *
+ * NIST-developed software is expressly provided "AS IS." NIST MAKES NO
+ * WARRANTY OF ANY KIND, EXPRESS, IMPLIED, IN FACT OR ARISING BY OPERATION OF
+ * LAW, INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTY OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, NON-INFRINGEMENT
+ * AND DATA ACCURACY. NIST NEITHER REPRESENTS NOR WARRANTS THAT THE
+ * OPERATION OF THE SOFTWARE WILL BE UNINTERRUPTED OR ERROR-FREE, OR THAT
+ * ANY DEFECTS WILL BE CORRECTED. NIST DOES NOT WARRANT OR MAKE ANY
+ * REPRESENTATIONS REGARDING THE USE OF THE SOFTWARE OR THE RESULTS THEREOF,
+ * INCLUDING BUT NOT LIMITED TO THE CORRECTNESS, ACCURACY, RELIABILITY,
+ * OR USEFULNESS OF THE SOFTWARE.
+ *
+ * You are solely responsible for determining the appropriateness of using and
+ * distributing the software and you assume all risks associated with its use,
+ * including but not limited to the risks and costs of program errors,
+ * compliance with applicable laws, damage to or loss of data, programs or
+ * equipment, and the unavailability or interruption of operation. This
+ * software is not intended to be used in any situation where a failure could
+ * cause risk of injury or damage to property. The software developed by NIST
+ * employees is not subject to copyright protection within the United States.
+ *
+ * Author: Evan Black <evan.black@nist.gov>
+ */
+
+#include "entity-streams.h"
+#include "file-parser.h"
+#include "packed-events.h"
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <optional>
+#include <random>
+#include <string_view>
+#include <type_traits>
+#include <variant>
+#include <vector>
+
+#ifdef _WIN32
+// clang-format off
+#include <windows.h>
+#include <psapi.h>
+// clang-format on
+#else
+#include <sys/resource.h>
+#endif
+
+/**
+ * Headless replay benchmark.
+ *
+ * Parses a scenario, then replays its scene events against a plain model of the Node & Decoration state,
+ * the same way `SceneWidget` steps through them: forwards with `EntityEventStreams`, backwards from the event
+ * each one replaced (`EntityEventStreams::previousOfKind()`), and seeking from periodic keyframes.
+ * No window, context, or Qt is needed, so it may run on machines without a display.
+ *
+ * With '--packed', the scene events are replayed from a `PackedSceneEvents` instead,
+ * reporting its size per event.
+ *
+ * Usage: netsimulyzer-bench [--packed] <scenario> [seeks]
+ */
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct NodeState {
+  parser::Ns3Coordinate position;
+  std::array<double, 3> orientation{0.0};
+  std::optional<parser::Ns3Color3> baseColor;
+  std::optional<parser::Ns3Color3> highlightColor;
+  bool isTransmitting{false};
+  parser::nanoseconds transmitStart{0LL};
+};
+
+struct DecorationState {
+  parser::Ns3Coordinate position;
+  std::array<double, 3> orientation{0.0};
+};
+
+/**
+ * The state of every Node & Decoration after `eventCount` events,
+ * by slot in `EntityEventStreams`
+ */
+struct Keyframe {
+  std::size_t eventCount{0u};
+  std::vector<NodeState> nodes;
+  std::vector<DecorationState> decorations;
+};
+
+template <class Events>
+class Replay {
+  const Events &events;
+  parser::EntityEventStreams streams;
+  std::vector<Keyframe> keyframes;
+  Keyframe current;
+
+  /**
+   * Matches `KeyframeIndex`
+   */
+  static constexpr std::size_t minimumInterval = 10'000u;
+
+  [[nodiscard]] const Keyframe &before(std::size_t eventCount) const {
+    const auto after = std::upper_bound(keyframes.begin(), keyframes.end(), eventCount,
+                                        [](std::size_t count, const Keyframe &keyframe) {
+                                          return count < keyframe.eventCount;
+                                        });
+    return *std::prev(after);
+  }
+
+  /**
+   * Apply the event at `current.eventCount`
+   */
+  void apply() {
+    const auto index = current.eventCount++;
+    const auto slot = streams.slot(index);
+    if (slot == parser::EntityEventStreams::noSlot)
+      return;
+
+    std::visit(
+        [this, slot](const auto &e) {
+          using T = std::decay_t<decltype(e)>;
+
+          if constexpr (std::is_same_v<T, parser::DecorationMoveEvent>) {
+            current.decorations[slot].position = e.targetPosition;
+          } else if constexpr (std::is_same_v<T, parser::DecorationOrientationChangeEvent>) {
+            current.decorations[slot].orientation = e.targetOrientation;
+          } else {
+            auto &node = current.nodes[slot];
+            if constexpr (std::is_same_v<T, parser::MoveEvent>)
+              node.position = e.targetPosition;
+            else if constexpr (std::is_same_v<T, parser::NodeOrientationChangeEvent>)
+              node.orientation = e.targetOrientation;
+            else if constexpr (std::is_same_v<T, parser::NodeColorChangeEvent>)
+              (e.type == parser::NodeColorChangeEvent::ColorType::Base ? node.baseColor : node.highlightColor) =
+                  e.targetColor;
+            else if constexpr (std::is_same_v<T, parser::TransmitEvent>) {
+              node.isTransmitting = true;
+              node.transmitStart = e.time;
+            } else if constexpr (std::is_same_v<T, parser::TransmitEndEvent>)
+              node.isTransmitting = false;
+          }
+
+          if constexpr (std::is_same_v<T, parser::DecorationMoveEvent> ||
+                        std::is_same_v<T, parser::DecorationOrientationChangeEvent>)
+            streams.getDecorationStream(slot).cursor++;
+          else
+            streams.getNodeStream(slot).cursor++;
+        },
+        events[index]);
+  }
+
+  /**
+   * Reverse the event before `current.eventCount`
+   */
+  void revert() {
+    const auto index = --current.eventCount;
+    const auto slot = streams.slot(index);
+    if (slot == parser::EntityEventStreams::noSlot)
+      return;
+
+    // As `SceneWidget::reverseEvent()`, the replaced value comes from the linked event, or the initial state
+    const auto previousIndex = streams.previousOfKind(index);
+    // A copy, since packed events are decoded by value
+    const auto previous = previousIndex == parser::EntityEventStreams::noEvent
+                              ? std::optional<parser::SceneEvent>{}
+                              : std::optional<parser::SceneEvent>{events[previousIndex]};
+    const auto &initial = keyframes.front();
+    std::visit(
+        [this, slot, &previous, &initial](const auto &e) {
+          using T = std::decay_t<decltype(e)>;
+
+          if constexpr (std::is_same_v<T, parser::DecorationMoveEvent> ||
+                        std::is_same_v<T, parser::DecorationOrientationChangeEvent>) {
+            auto &decoration = current.decorations[slot];
+            if constexpr (std::is_same_v<T, parser::DecorationMoveEvent>)
+              decoration.position =
+                  previous ? std::get<T>(*previous).targetPosition : initial.decorations[slot].position;
+            else
+              decoration.orientation =
+                  previous ? std::get<T>(*previous).targetOrientation : initial.decorations[slot].orientation;
+            streams.getDecorationStream(slot).cursor--;
+          } else {
+            auto &node = current.nodes[slot];
+
+            if constexpr (std::is_same_v<T, parser::MoveEvent>) {
+              node.position = previous ? std::get<T>(*previous).targetPosition : streams.getInitialPosition(slot);
+            } else if constexpr (std::is_same_v<T, parser::NodeOrientationChangeEvent>) {
+              node.orientation = previous ? std::get<T>(*previous).targetOrientation : initial.nodes[slot].orientation;
+            } else if constexpr (std::is_same_v<T, parser::NodeColorChangeEvent>) {
+              const auto &original = initial.nodes[slot];
+              if (e.type == parser::NodeColorChangeEvent::ColorType::Base)
+                node.baseColor = previous ? std::get<T>(*previous).targetColor : original.baseColor;
+              else
+                node.highlightColor = previous ? std::get<T>(*previous).targetColor : original.highlightColor;
+            } else {
+              if (!previous) {
+                node.isTransmitting = initial.nodes[slot].isTransmitting;
+                node.transmitStart = initial.nodes[slot].transmitStart;
+              } else if (const auto transmit = std::get_if<parser::TransmitEvent>(&previous.value())) {
+                node.isTransmitting = true;
+                node.transmitStart = transmit->time;
+              } else {
+                node.isTransmitting = false;
+              }
+            }
+            streams.getNodeStream(slot).cursor--;
+          }
+        },
+        events[index]);
+  }
+
+public:
+  Replay(const parser::FileParser &fileParser, const Events &events) : events(events) {
+    const auto &nodes = fileParser.getNodes();
+    const auto &decorations = fileParser.getDecorations();
+    streams.reset(nodes, decorations);
+
+    // Slots are given to the first Node/Decoration with each ID only
+    current.nodes.resize(streams.nodeCount());
+    for (const auto &node : nodes) {
+      const auto slot = streams.nodeSlot(node.id);
+      auto &state = current.nodes[slot];
+      state.position = node.position;
+      state.orientation = node.orientation;
+      state.baseColor = node.baseColor;
+      state.highlightColor = node.highlightColor;
+    }
+
+    current.decorations.resize(streams.decorationCount());
+    for (const auto &decoration : decorations) {
+      const auto slot = streams.decorationSlot(decoration.id);
+      current.decorations[slot].position = decoration.position;
+      current.decorations[slot].orientation = decoration.orientation;
+    }
+  }
+
+  /**
+   * Index every event & take the keyframes, as `SceneWidget::enqueueEvents()` does.
+   * Leaves the state at the start of the scenario
+   */
+  void index() {
+    const auto interval = std::max(minimumInterval, (current.nodes.size() + current.decorations.size()) * 4u);
+
+    keyframes.emplace_back(current);
+    const auto initial = current;
+    for (std::size_t i = 0; i < events.size(); i++) {
+      streams.add(events[i]);
+      apply();
+      if (current.eventCount % interval == 0u)
+        keyframes.emplace_back(current);
+    }
+
+    current = initial;
+    streams.seek(0u);
+  }
+
+  void forward() {
+    while (current.eventCount < events.size())
+      apply();
+  }
+
+  void rewind() {
+    while (current.eventCount > 0u)
+      revert();
+  }
+
+  void seek(std::size_t eventCount) {
+    current = before(eventCount);
+    streams.seek(current.eventCount);
+    while (current.eventCount < eventCount)
+      apply();
+  }
+
+  [[nodiscard]] std::size_t keyframeCount() const {
+    return keyframes.size();
+  }
+};
+
+/**
+ * @return
+ * The peak resident set size of this process in bytes, 0 if unknown
+ */
+std::size_t peakRss() {
+#ifdef _WIN32
+  PROCESS_MEMORY_COUNTERS counters;
+  if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+    return counters.PeakWorkingSetSize;
+  return 0u;
+#else
+  rusage usage{};
+  if (getrusage(RUSAGE_SELF, &usage) != 0)
+    return 0u;
+#ifdef __APPLE__
+  // Bytes on macOS
+  return static_cast<std::size_t>(usage.ru_maxrss);
+#else
+  // Kilobytes everywhere else
+  return static_cast<std::size_t>(usage.ru_maxrss) * 1024u;
+#endif
+#endif
+}
+
+double seconds(Clock::duration duration) {
+  return std::chrono::duration<double>(duration).count();
+}
+
+double microseconds(Clock::duration duration) {
+  return std::chrono::duration<double, std::micro>(duration).count();
+}
+
+/**
+ * Index, play forward, rewind, then seek through `events`, reporting the time of each
+ */
+template <class Events>
+void replayEvents(const parser::FileParser &fileParser, const Events &events, unsigned long seeks) {
+  Replay<Events> replay{fileParser, events};
+
+  const auto indexStart = Clock::now();
+  replay.index();
+  const auto indexTime = seconds(Clock::now() - indexStart);
+
+  const auto forwardStart = Clock::now();
+  replay.forward();
+  const auto forwardTime = seconds(Clock::now() - forwardStart);
+
+  const auto rewindStart = Clock::now();
+  replay.rewind();
+  const auto rewindTime = seconds(Clock::now() - rewindStart);
+
+  // Fixed seed, so runs are comparable
+  std::mt19937 random{1u};
+  std::uniform_int_distribution<std::size_t> target{0u, events.size()};
+  std::vector<double> latencies;
+  latencies.reserve(seeks);
+  for (auto i = 0ul; i < seeks; i++) {
+    const auto eventCount = target(random);
+    const auto seekStart = Clock::now();
+    replay.seek(eventCount);
+    latencies.emplace_back(microseconds(Clock::now() - seekStart));
+  }
+  std::sort(latencies.begin(), latencies.end());
+
+  auto percentile = [&latencies](double fraction) {
+    if (latencies.empty())
+      return 0.0;
+    const auto index = static_cast<std::size_t>(fraction * static_cast<double>(latencies.size() - 1u));
+    return latencies[index];
+  };
+
+  std::cout << "index: " << indexTime << " s, " << replay.keyframeCount() << " keyframes\n"
+            << "forward: " << forwardTime << " s, " << static_cast<double>(events.size()) / forwardTime
+            << " events/s\n"
+            << "rewind: " << rewindTime << " s, " << static_cast<double>(events.size()) / rewindTime << " events/s\n"
+            << "seek (" << latencies.size() << " random, us): p50 " << percentile(0.5) << ", p90 "
+            << percentile(0.9) << ", p99 " << percentile(0.99) << ", max " << percentile(1.0) << '\n';
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  const auto packed = argc > 1 && std::string_view{argv[1]} == "--packed";
+  if (packed) {
+    argc--;
+    argv++;
+  }
+
+  if (argc != 2 && argc != 3) {
+    std::cerr << "Usage: " << argv[0] << " [--packed] <scenario> [seeks]\n";
+    return 1;
+  }
+
+  const auto input = argv[1];
+  const auto seeks = argc == 3 ? std::strtoul(argv[2], nullptr, 10) : 1000ul;
+
+  std::ifstream file{input, std::ios::binary | std::ios::ate};
+  if (!file) {
+    std::cerr << "Failed to open " << input << '\n';
+    return 1;
+  }
+  const auto fileSize = static_cast<double>(file.tellg());
+  file.close();
+
+  parser::FileParser fileParser;
+  const auto parseStart = Clock::now();
+  if (const auto error = fileParser.parse(input)) {
+    std::cerr << "Failed to parse " << input << " at offset " << error->offset << ": " << error->message << '\n';
+    return 1;
+  }
+  const auto parseTime = seconds(Clock::now() - parseStart);
+
+  const auto &sceneEvents = fileParser.getSceneEvents();
+  const auto totalEvents =
+      sceneEvents.size() + fileParser.getChartsEvents().size() + fileParser.getLogEvents().size();
+
+  // Inline size only, heap storage owned by the events (e.g. log messages) is not counted
+  const auto eventBytes = sceneEvents.size() * sizeof(parser::SceneEvent) +
+                          fileParser.getChartsEvents().size() * sizeof(parser::ChartEvent) +
+                          fileParser.getLogEvents().size() * sizeof(parser::LogEvent);
+
+  std::cout << std::fixed << std::setprecision(3);
+  std::cout << "scenario: " << input << '\n'
+            << "file size: " << fileSize / 1'000'000.0 << " MB\n"
+            << "events: " << totalEvents << " (" << sceneEvents.size() << " scene)\n"
+            << "parse: " << parseTime << " s, " << fileSize / 1'000'000.0 / parseTime << " MB/s, "
+            << static_cast<double>(totalEvents) / parseTime << " events/s\n"
+            << "event size: scene " << sizeof(parser::SceneEvent) << " B, chart " << sizeof(parser::ChartEvent)
+            << " B, log " << sizeof(parser::LogEvent) << " B, "
+            << (totalEvents == 0u ? 0.0 : static_cast<double>(eventBytes) / static_cast<double>(totalEvents))
+            << " B/event, " << static_cast<double>(eventBytes) / 1'000'000.0 << " MB\n";
+
+  if (packed) {
+    const auto &config = fileParser.getConfiguration();
+    parser::PackedSceneEvents packedEvents{config.minLocation, config.maxLocation};
+    for (const auto &event : sceneEvents)
+      packedEvents.push_back(event);
+    packedEvents.shrink();
+
+    const auto &step = packedEvents.getStep();
+    std::cout << "packed: " << static_cast<double>(packedEvents.bytes()) / static_cast<double>(sceneEvents.size())
+              << " B/scene event, " << static_cast<double>(packedEvents.bytes()) / 1'000'000.0 << " MB, step "
+              << std::scientific << std::setprecision(2) << step.x << ", " << step.y << ", " << step.z << '\n'
+              << std::fixed << std::setprecision(3);
+
+    replayEvents(fileParser, packedEvents, seeks);
+  } else
+    replayEvents(fileParser, sceneEvents, seeks);
+
+  std::cout << "peak rss: " << static_cast<double>(peakRss()) / 1'000'000.0 << " MB\n";
+
+  return 0;
+}
@@ -0,0 +1,107 @@
+/*
+ * NIST-developed software is provided by NIST as a public service. You may use,
+ * copy and distribute copies of the software in any medium, provided that you
+ * keep intact this entire notice. You may improve,modify and create derivative
+ * works of the software or any portion of the software, and you may copy and
+ * distribute such modifications or works. Modified works should carry a notice
+ * stating that you changed the software and should note the date and nature of
+ * any such change. Please explicitly acknowledge the National Institute of
+ * Standards and Technology as the source of the software.
+ *
+ * NIST-developed software is expressly provided "AS IS." NIST MAKES NO
+ * WARRANTY OF ANY KIND, EXPRESS, IMPLIED, IN FACT OR ARISING BY OPERATION OF
+ * LAW, INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTY OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, NON-INFRINGEMENT
+ * AND DATA ACCURACY. NIST NEITHER REPRESENTS NOR WARRANTS THAT THE
+ * OPERATION OF THE SOFTWARE WILL BE UNINTERRUPTED OR ERROR-FREE, OR THAT
+ * ANY DEFECTS WILL BE CORRECTED. NIST DOES NOT WARRANT OR MAKE ANY
+ * REPRESENTATIONS REGARDING THE USE OF THE SOFTWARE OR THE RESULTS THEREOF,
+ * INCLUDING BUT NOT LIMITED TO THE CORRECTNESS, ACCURACY, RELIABILITY,
+ * OR USEFULNESS OF THE SOFTWARE.
+ *
+ * You are solely responsible for determining the appropriateness of using and
+ * distributing the software and you assume all risks associated with its use,
+ * including but not limited to the risks and costs of program errors,
+ * compliance with applicable laws, damage to or loss of data, programs or
+ * equipment, and the unavailability or interruption of operation. This
+ * software is not intended to be used in any situation where a failure could
+ * cause risk of injury or damage to property. The software developed by NIST
+ * employees is not subject to copyright protection within the United States.
+ *
+ * Author: Evan Black <evan.black@nist.gov>
+ */
+
+#include "file-parser.h"
+#include "series-stats.h"
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <limits>
+
+/**
+ * Headless series statistics & export.
+ *
+ * Parses a scenario, then writes the count, min, max, mean & percentiles
+ * of every XY & category value series, computed in parallel across series,
+ * or every point of every series, as CSV. No Qt is needed.
+ *
+ * Times are in seconds, from `from` up to & including `to`, every point by default.
+ *
+ * Usage: netsimulyzer-series <scenario> [--points] [--from <seconds>] [--to <seconds>] [--output <file.csv>]
+ */
+int main(int argc, char *argv[]) {
+  auto usage = [argv]() {
+    std::cerr << "Usage: " << argv[0]
+              << " <scenario> [--points] [--from <seconds>] [--to <seconds>] [--output <file.csv>]\n";
+    return 1;
+  };
+  if (argc < 2)
+    return usage();
+
+  const auto input = argv[1];
+  auto points = false;
+  auto from = std::numeric_limits<parser::nanoseconds>::lowest();
+  auto to = std::numeric_limits<parser::nanoseconds>::max();
+  const char *output = nullptr;
+
+  for (auto i = 2; i < argc; i++) {
+    const auto hasValue = i + 1 < argc;
+    if (std::strcmp(argv[i], "--points") == 0)
+      points = true;
+    else if (std::strcmp(argv[i], "--from") == 0 && hasValue)
+      from = static_cast<parser::nanoseconds>(std::strtod(argv[++i], nullptr) * 1'000'000'000.0);
+    else if (std::strcmp(argv[i], "--to") == 0 && hasValue)
+      to = static_cast<parser::nanoseconds>(std::strtod(argv[++i], nullptr) * 1'000'000'000.0);
+    else if (std::strcmp(argv[i], "--output") == 0 && hasValue)
+      output = argv[++i];
+    else
+      return usage();
+  }
+
+  parser::FileParser fileParser;
+  if (const auto error = fileParser.parse(input)) {
+    std::cerr << "Failed to parse " << input << " at offset " << error->offset << ": " << error->message << '\n';
+    return 1;
+  }
+
+  const auto series =
+      parser::collectSeries(fileParser.getXYSeries(), fileParser.getCategoryValueSeries(), fileParser.getChartsEvents());
+
+  std::ofstream file;
+  if (output) {
+    file.open(output);
+    if (!file) {
+      std::cerr << "Failed to open " << output << '\n';
+      return 1;
+    }
+  }
+  auto &out = output ? static_cast<std::ostream &>(file) : std::cout;
+
+  if (points)
+    parser::writePointsCsv(out, series, from, to);
+  else
+    parser::writeStatisticsCsv(out, parser::computeStatistics(series, from, to));
+
+  return out ? 0 : 1;
+}
@@ -0,0 +1,190 @@
+/*
+ * NIST-developed software is provided by NIST as a public service. You may use,
+ * copy and distribute copies of the software in any medium, provided that you
+ * keep intact this entire notice. You may improve,modify and create derivative
+ * works of the software or any portion of the software, and you may copy and
+ * distribute such modifications or works. Modified works should carry a notice
+ * stating that you changed the software and should note the date and nature of
+ * any such change. Please explicitly acknowledge the National Institute of
+ * Standards and Technology as the source of the software.
+ *
+ * NIST-developed software is expressly provided "AS IS." NIST MAKES NO
+ * WARRANTY OF ANY KIND, EXPRESS, IMPLIED, IN FACT OR ARISING BY OPERATION OF
+ * LAW, INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTY OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, NON-INFRINGEMENT
+ * AND DATA ACCURACY. NIST NEITHER REPRESENTS NOR WARRANTS THAT THE
+ * OPERATION OF THE SOFTWARE WILL BE UNINTERRUPTED OR ERROR-FREE, OR THAT
+ * ANY DEFECTS WILL BE CORRECTED. NIST DOES NOT WARRANT OR MAKE ANY
+ * REPRESENTATIONS REGARDING THE USE OF THE SOFTWARE OR THE RESULTS THEREOF,
+ * INCLUDING BUT NOT LIMITED TO THE CORRECTNESS, ACCURACY, RELIABILITY,
+ * OR USEFULNESS OF THE SOFTWARE.
+ *
+ * You are solely responsible for determining the appropriateness of using and
+ * distributing the software and you assume all risks associated with its use,
+ * including but not limited to the risks and costs of program errors,
+ * compliance with applicable laws, damage to or loss of data, programs or
+ * equipment, and the unavailability or interruption of operation. This
+ * software is not intended to be used in any situation where a failure could
+ * cause risk of injury or damage to property. The software developed by NIST
+ * employees is not subject to copyright protection within the United States.
+ *
+ * Author: Evan Black <evan.black@nist.gov>
+ */
+
+#include "trace.h"
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace {
+
+using namespace parser::trace;
+
+/**
+ * Events past this many on one thread are dropped,
+ * so a trace left running does not grow without bound
+ */
+constexpr std::size_t maxThreadEvents = 4'000'000u;
+
+struct Span {
+  const char *name;
+  const char *category;
+  clock::time_point begin;
+  clock::time_point end;
+};
+
+/**
+ * The events recorded by one thread.
+ * Only that thread appends, but `stop()` may read from another,
+ * so access is still locked, though rarely contended
+ */
+struct ThreadEvents {
+  std::mutex mutex;
+  std::vector<Span> spans;
+  std::uint32_t id;
+  const char *name{nullptr};
+};
+
+/**
+ * Guards every member of `Trace`, other than the contents of `threads`
+ */
+std::mutex traceMutex;
+
+struct Trace {
+  std::string path;
+  clock::time_point origin;
+
+  /**
+   * Buffers are kept for the whole run, since a thread
+   * may end before the trace is written
+   */
+  std::vector<std::unique_ptr<ThreadEvents>> threads;
+};
+
+Trace &getTrace() {
+  static Trace trace;
+  return trace;
+}
+
+ThreadEvents &threadEvents() {
+  thread_local ThreadEvents *events = nullptr;
+  if (events)
+    return *events;
+
+  std::lock_guard lock{traceMutex};
+  auto &trace = getTrace();
+  trace.threads.emplace_back(std::make_unique<ThreadEvents>());
+  events = trace.threads.back().get();
+  events->id = static_cast<std::uint32_t>(trace.threads.size());
+  return *events;
+}
+
+double microseconds(clock::time_point time, clock::time_point origin) {
+  return std::chrono::duration<double, std::micro>(time - origin).count();
+}
+
+} // namespace
+
+namespace parser::trace {
+
+void start(const std::string &path) {
+  std::lock_guard lock{traceMutex};
+  auto &trace = getTrace();
+  trace.path = path;
+  trace.origin = clock::now();
+  for (auto &thread : trace.threads) {
+    std::lock_guard threadLock{thread->mutex};
+    thread->spans.clear();
+  }
+
+  active = true;
+}
+
+bool stop() {
+  if (!active.exchange(false))
+    return true;
+
+  std::lock_guard lock{traceMutex};
+  auto &trace = getTrace();
+
+  std::ofstream file{trace.path, std::ios::binary};
+  if (!file) {
+    std::cerr << "Failed to open trace file for writing: " << trace.path << '\n';
+    return false;
+  }
+
+  // Names & categories are literals from the source, so they need no escaping
+  file << std::fixed << std::setprecision(3);
+  file << R"({"displayTimeUnit":"ms","traceEvents":[)" << '\n';
+  file << R"({"ph":"M","pid":1,"tid":0,"name":"process_name","args":{"name":"NetSimulyzer"}})";
+  for (auto &thread : trace.threads) {
+    std::lock_guard threadLock{thread->mutex};
+    if (thread->name)
+      file << ",\n"
+           << R"({"ph":"M","pid":1,"tid":)" << thread->id << R"(,"name":"thread_name","args":{"name":")"
+           << thread->name << R"("}})";
+
+    for (const auto &span : thread->spans) {
+      file << ",\n"
+           << R"({"ph":"X","pid":1,"tid":)" << thread->id << R"(,"name":")" << span.name << R"(","cat":")"
+           << span.category << R"(","ts":)" << microseconds(span.begin, trace.origin)
+           << R"(,"dur":)" << microseconds(span.end, span.begin) << '}';
+    }
+    thread->spans.clear();
+  }
+  file << "\n]}\n";
+
+  if (!file) {
+    std::cerr << "Failed writing trace file: " << trace.path << '\n';
+    return false;
+  }
+
+  std::cout << "Trace written to " << trace.path << '\n';
+  return true;
+}
+
+void setThreadName(const char *name) {
+  // Threads are only given a buffer while tracing
+  if (!enabled())
+    return;
+
+  auto &events = threadEvents();
+  std::lock_guard lock{events.mutex};
+  events.name = name;
+}
+
+void complete(const char *name, const char *category, clock::time_point begin, clock::time_point end) {
+  if (!enabled())
+    return;
+
+  auto &events = threadEvents();
+  std::lock_guard lock{events.mutex};
+  if (events.spans.size() < maxThreadEvents)
+    events.spans.push_back({name, category, begin, end});
+}
+
+} // namespace parser::trace
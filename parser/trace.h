@@ -0,0 +1,132 @@
+/*
+ * NIST-developed software is provided by NIST as a public service. You may use,
+ * copy and distribute copies of the software in any medium, provided that you
+ * keep intact this entire notice. You may improve,modify and create derivative
+ * works of the software or any portion of the software, and you may copy and
+ * distribute such modifications or works. Modified works should carry a notice
+ * stating that you changed the software and should note the date and nature of
+ * any such change. Please explicitly acknowledge the National Institute of
+ * Standards and Technology as the source of the software.
+ *
+ * NIST-developed software is expressly provided "AS IS." NIST MAKES NO
+ * WARRANTY OF ANY KIND, EXPRESS, IMPLIED, IN FACT OR ARISING BY OPERATION OF
+ * LAW, INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTY OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, NON-INFRINGEMENT
+ * AND DATA ACCURACY. NIST NEITHER REPRESENTS NOR WARRANTS THAT THE
+ * OPERATION OF THE SOFTWARE WILL BE UNINTERRUPTED OR ERROR-FREE, OR THAT
+ * ANY DEFECTS WILL BE CORRECTED. NIST DOES NOT WARRANT OR MAKE ANY
+ * REPRESENTATIONS REGARDING THE USE OF THE SOFTWARE OR THE RESULTS THEREOF,
+ * INCLUDING BUT NOT LIMITED TO THE CORRECTNESS, ACCURACY, RELIABILITY,
+ * OR USEFULNESS OF THE SOFTWARE.
+ *
+ * You are solely responsible for determining the appropriateness of using and
+ * distributing the software and you assume all risks associated with its use,
+ * including but not limited to the risks and costs of program errors,
+ * compliance with applicable laws, damage to or loss of data, programs or
+ * equipment, and the unavailability or interruption of operation. This
+ * software is not intended to be used in any situation where a failure could
+ * cause risk of injury or damage to property. The software developed by NIST
+ * employees is not subject to copyright protection within the United States.
+ *
+ * Author: Evan Black <evan.black@nist.gov>
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <string>
+
+/**
+ * Scoped timeline events, written in the Chrome trace event format,
+ * which loads in `chrome://tracing` & the Perfetto UI.
+ *
+ * Tracing is off unless `start()` is called, and a disabled `Scope` only checks one flag,
+ * so scopes may be left in hot paths. Each thread records to its own buffer,
+ * and every buffer is written by `stop()`
+ */
+namespace parser::trace {
+
+using clock = std::chrono::steady_clock;
+
+/**
+ * Set between `start()` & `stop()`, see `enabled()`
+ */
+inline std::atomic<bool> active{false};
+
+[[nodiscard]] inline bool enabled() {
+  return active.load(std::memory_order_relaxed);
+}
+
+/**
+ * Begin recording events, to be written to `path` by `stop()`.
+ * Any previous recording is discarded
+ */
+void start(const std::string &path);
+
+/**
+ * Stop recording & write the events recorded since `start()`
+ *
+ * @return
+ * False if the trace could not be written, true otherwise, or if tracing was never started
+ */
+bool stop();
+
+/**
+ * Label the calling thread in the trace.
+ * Does nothing while tracing is off
+ *
+ * @param name
+ * The label. Must outlive the trace, e.g. a string literal
+ */
+void setThreadName(const char *name);
+
+/**
+ * Record a span which has already finished, on the calling thread.
+ * Does nothing while tracing is off
+ *
+ * @param name
+ * The name of the span. Must outlive the trace, e.g. a string literal
+ *
+ * @param category
+ * The category of the span, for filtering. Must outlive the trace
+ */
+void complete(const char *name, const char *category, clock::time_point begin, clock::time_point end);
+
+/**
+ * Records the span from its construction to its destruction
+ */
+class Scope {
+  const char *name;
+  const char *category;
+  clock::time_point begin;
+
+  /**
+   * If tracing was on when the scope began.
+   * Scopes begun before `start()` are not recorded
+   */
+  bool recording;
+
+public:
+  /**
+   * @param name
+   * The name of the span. Must outlive the trace, e.g. a string literal
+   *
+   * @param category
+   * The category of the span, for filtering. Must outlive the trace
+   */
+  Scope(const char *name, const char *category) : name(name), category(category), recording(enabled()) {
+    if (recording)
+      begin = clock::now();
+  }
+
+  ~Scope() {
+    if (recording)
+      complete(name, category, begin, clock::now());
+  }
+
+  Scope(const Scope &) = delete;
+  Scope &operator=(const Scope &) = delete;
+};
+
+} // namespace parser::trace
@@ -0,0 +1,182 @@
+/*
+ * NIST-developed software is provided by NIST as a public service. You may use,
+ * copy and distribute copies of the software in any medium, provided that you
+ * keep intact this entire notice. You may improve,modify and create derivative
+ * works of the software or any portion of the software, and you may copy and
+ * distribute such modifications or works. Modified works should carry a notice
+ * stating that you changed the software and should note the date and nature of
+ * any such change. Please explicitly acknowledge the National Institute of
+ * Standards and Technology as the source of the software.
+ *
+ * NIST-developed software is expressly provided "AS IS." NIST MAKES NO
+ * WARRANTY OF ANY KIND, EXPRESS, IMPLIED, IN FACT OR ARISING BY OPERATION OF
+ * LAW, INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTY OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, NON-INFRINGEMENT
+ * AND DATA ACCURACY. NIST NEITHER REPRESENTS NOR WARRANTS THAT THE
+ * OPERATION OF THE SOFTWARE WILL BE UNINTERRUPTED OR ERROR-FREE, OR THAT
+ * ANY DEFECTS WILL BE CORRECTED. NIST DOES NOT WARRANT OR MAKE ANY
+ * REPRESENTATIONS REGARDING THE USE OF THE SOFTWARE OR THE RESULTS THEREOF,
+ * INCLUDING BUT NOT LIMITED TO THE CORRECTNESS, ACCURACY, RELIABILITY,
+ * OR USEFULNESS OF THE SOFTWARE.
+ *
+ * You are solely responsible for determining the appropriateness of using and
+ * distributing the software and you assume all risks associated with its use,
+ * including but not limited to the risks and costs of program errors,
+ * compliance with applicable laws, damage to or loss of data, programs or
+ * equipment, and the unavailability or interruption of operation. This
+ * software is not intended to be used in any situation where a failure could
+ * cause risk of injury or damage to property. The software developed by NIST
+ * employees is not subject to copyright protection within the United States.
+ *
+ * Author: Evan Black <evan.black@nist.gov>
+ */
+
+
+#include "traffic-stats.h"
+#include <algorithm>
+#include <cmath>
+#include <type_traits>
+#include <utility>
+#include <variant>
+
+namespace parser {
+
+const TrafficStatistics::Column &TrafficStatistics::column(std::uint32_t slot) const {
+  if (slot == allNodes)
+    return total;
+  return nodes[slot];
+}
+
+std::size_t TrafficStatistics::countAt(const std::vector<nanoseconds> &times, nanoseconds time) {
+  return static_cast<std::size_t>(std::upper_bound(times.begin(), times.end(), time) - times.begin());
+}
+
+void TrafficStatistics::reset(std::vector<Ns3Coordinate> initialPositions) {
+  clear();
+  positions = std::move(initialPositions);
+  nodes.resize(positions.size());
+}
+
+void TrafficStatistics::clear() {
+  nodes.clear();
+  positions.clear();
+  total = {};
+  latest = 0LL;
+}
+
+void TrafficStatistics::add(std::uint32_t slot, const SceneEvent &event) {
+  latest = std::max(latest, std::visit(
+                                [](const auto &e) {
+                                  return e.time;
+                                },
+                                event));
+
+  if (slot >= nodes.size())
+    return;
+
+  std::visit(
+      [this, slot](const auto &e) {
+        using T = std::decay_t<decltype(e)>;
+
+        if constexpr (std::is_same_v<T, TransmitEvent>) {
+          nodes[slot].transmitTimes.emplace_back(e.time);
+          total.transmitTimes.emplace_back(e.time);
+        } else if constexpr (std::is_same_v<T, MoveEvent>) {
+          auto &position = positions[slot];
+          const auto dx = e.targetPosition.x - position.x;
+          const auto dy = e.targetPosition.y - position.y;
+          const auto dz = e.targetPosition.z - position.z;
+          const auto moved = std::sqrt(dx * dx + dy * dy + dz * dz);
+          position = e.targetPosition;
+
+          auto &node = nodes[slot];
+          node.moveTimes.emplace_back(e.time);
+          node.distances.emplace_back((node.distances.empty() ? 0.0 : node.distances.back()) + moved);
+          total.moveTimes.emplace_back(e.time);
+          total.distances.emplace_back((total.distances.empty() ? 0.0 : total.distances.back()) + moved);
+        }
+      },
+      event);
+}
+
+std::size_t TrafficStatistics::transmissions(std::uint32_t slot, nanoseconds time) const {
+  return countAt(column(slot).transmitTimes, time);
+}
+
+double TrafficStatistics::transmissionRate(std::uint32_t slot, nanoseconds time, nanoseconds window) const {
+  const auto &times = column(slot).transmitTimes;
+  const auto count = countAt(times, time) - countAt(times, time - window);
+  return static_cast<double>(count) / (static_cast<double>(window) / 1'000'000'000.0);
+}
+
+double TrafficStatistics::distance(std::uint32_t slot, nanoseconds time) const {
+  const auto &source = column(slot);
+  const auto moves = countAt(source.moveTimes, time);
+  if (moves == 0u)
+    return 0.0;
+  return source.distances[moves - 1u];
+}
+
+TrafficStatistics::Busiest TrafficStatistics::busiest(nanoseconds time, nanoseconds window) const {
+  Busiest result;
+  for (std::uint32_t slot = 0u; slot < nodes.size(); slot++) {
+    const auto &times = nodes[slot].transmitTimes;
+    auto count = countAt(times, time);
+    if (window > 0LL)
+      count -= countAt(times, time - window);
+
+    if (count > result.transmissions)
+      result = {slot, count};
+  }
+
+  return result;
+}
+
+std::vector<XYPoint> TrafficStatistics::rateSeries(std::uint32_t slot, nanoseconds to, nanoseconds step,
+                                                   nanoseconds window) const {
+  std::vector<XYPoint> points;
+  if (step <= 0LL || to < step)
+    return points;
+
+  points.reserve(static_cast<std::size_t>(to / step));
+  for (auto time = step; time <= to; time += step)
+    points.push_back({static_cast<double>(time) / 1'000'000'000.0, transmissionRate(slot, time, window)});
+
+  return points;
+}
+
+std::vector<XYPoint> TrafficStatistics::distanceSeries(std::uint32_t slot) const {
+  const auto &source = column(slot);
+
+  std::vector<XYPoint> points;
+  points.reserve(source.moveTimes.size());
+  for (std::size_t i = 0u; i < source.moveTimes.size(); i++)
+    points.push_back({static_cast<double>(source.moveTimes[i]) / 1'000'000'000.0, source.distances[i]});
+
+  return points;
+}
+
+nanoseconds TrafficStatistics::lastTime() const {
+  return latest;
+}
+
+std::size_t TrafficStatistics::nodeCount() const {
+  return nodes.size();
+}
+
+std::size_t TrafficStatistics::memoryUsage() const {
+  auto bytes = positions.capacity() * sizeof(Ns3Coordinate) + nodes.capacity() * sizeof(Column);
+
+  auto columnBytes = [](const Column &c) {
+    return (c.transmitTimes.capacity() + c.moveTimes.capacity()) * sizeof(nanoseconds) +
+           c.distances.capacity() * sizeof(double);
+  };
+
+  bytes += columnBytes(total);
+  for (const auto &node : nodes)
+    bytes += columnBytes(node);
+
+  return bytes;
+}
+
+} // namespace parser
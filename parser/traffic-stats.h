@@ -0,0 +1,222 @@
+/*
+ * NIST-developed software is provided by NIST as a public service. You may use,
+ * copy and distribute copies of the software in any medium, provided that you
+ * keep intact this entire notice. You may improve,modify and create derivative
+ * works of the software or any portion of the software, and you may copy and
+ * distribute such modifications or works. Modified works should carry a notice
+ * stating that you changed the software and should note the date and nature of
+ * any such change. Please explicitly acknowledge the National Institute of
+ * Standards and Technology as the source of the software.
+ *
+ * NIST-developed software is expressly provided "AS IS." NIST MAKES NO
+ * WARRANTY OF ANY KIND, EXPRESS, IMPLIED, IN FACT OR ARISING BY OPERATION OF
+ * LAW, INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTY OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, NON-INFRINGEMENT
+ * AND DATA ACCURACY. NIST NEITHER REPRESENTS NOR WARRANTS THAT THE
+ * OPERATION OF THE SOFTWARE WILL BE UNINTERRUPTED OR ERROR-FREE, OR THAT
+ * ANY DEFECTS WILL BE CORRECTED. NIST DOES NOT WARRANT OR MAKE ANY
+ * REPRESENTATIONS REGARDING THE USE OF THE SOFTWARE OR THE RESULTS THEREOF,
+ * INCLUDING BUT NOT LIMITED TO THE CORRECTNESS, ACCURACY, RELIABILITY,
+ * OR USEFULNESS OF THE SOFTWARE.
+ *
+ * You are solely responsible for determining the appropriateness of using and
+ * distributing the software and you assume all risks associated with its use,
+ * including but not limited to the risks and costs of program errors,
+ * compliance with applicable laws, damage to or loss of data, programs or
+ * equipment, and the unavailability or interruption of operation. This
+ * software is not intended to be used in any situation where a failure could
+ * cause risk of injury or damage to property. The software developed by NIST
+ * employees is not subject to copyright protection within the United States.
+ *
+ * Author: Evan Black <evan.black@nist.gov>
+ */
+
+#pragma once
+
+#include "model.h"
+#include "xy-points.h"
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace parser {
+
+/**
+ * Running totals of the traffic & motion of each Node, and of every Node together,
+ * kept as prefix sums over time as the scene events are added.
+ *
+ * The count of transmissions at any time is the position of that time in the transmission times,
+ * & the distance moved is the running sum at the last move before it,
+ * so any value at any time, or over any window of time, is a binary search away.
+ * Distances are measured between waypoints, as the Node is not interpolated here
+ */
+class TrafficStatistics {
+public:
+  /**
+   * Slot for the totals of every Node together
+   */
+  static constexpr std::uint32_t allNodes = std::numeric_limits<std::uint32_t>::max();
+
+  /**
+   * The window rates are averaged over by default, one second
+   */
+  static constexpr nanoseconds defaultWindow = 1'000'000'000LL;
+
+  /**
+   * The Node with the most transmissions in a window, see `busiest()`
+   */
+  struct Busiest {
+    /**
+     * The slot of the Node, or `allNodes` if no Node transmitted
+     */
+    std::uint32_t slot{allNodes};
+    std::size_t transmissions{0u};
+  };
+
+private:
+  struct Column {
+    /**
+     * The time of every transmission, in order.
+     * The transmissions up to a time are the position of that time in here
+     */
+    std::vector<nanoseconds> transmitTimes;
+
+    /**
+     * The time of every move, in order
+     */
+    std::vector<nanoseconds> moveTimes;
+
+    /**
+     * The distance moved, once each of `moveTimes` is applied
+     */
+    std::vector<double> distances;
+  };
+
+  /**
+   * The columns of each Node, by slot
+   */
+  std::vector<Column> nodes;
+
+  /**
+   * The latest position of each Node, by slot
+   */
+  std::vector<Ns3Coordinate> positions;
+
+  /**
+   * The columns of every Node together
+   */
+  Column total;
+
+  /**
+   * The time of the latest event counted
+   */
+  nanoseconds latest{0LL};
+
+  [[nodiscard]] const Column &column(std::uint32_t slot) const;
+
+  /**
+   * @return
+   * The number of `times` at or before `time`
+   */
+  [[nodiscard]] static std::size_t countAt(const std::vector<nanoseconds> &times, nanoseconds time);
+
+public:
+  /**
+   * Remove every total, and start each Node at its initial position
+   *
+   * @param initialPositions
+   * The position of each Node before any events, by slot
+   */
+  void reset(std::vector<Ns3Coordinate> initialPositions);
+  void clear();
+
+  /**
+   * Count the next scene event. Should be called with every event, in order
+   *
+   * @param slot
+   * The slot of the Node for `event`, see `EntityEventStreams::slot()`.
+   * Events of Decorations & unknown Nodes are ignored
+   *
+   * @param event
+   * The event to count
+   */
+  void add(std::uint32_t slot, const SceneEvent &event);
+
+  /**
+   * @param slot
+   * The slot of a Node, or `allNodes`
+   *
+   * @return
+   * The number of transmissions started at or before `time`
+   */
+  [[nodiscard]] std::size_t transmissions(std::uint32_t slot, nanoseconds time) const;
+
+  /**
+   * @param slot
+   * The slot of a Node, or `allNodes`
+   *
+   * @param time
+   * The end of the window, included
+   *
+   * @param window
+   * The length of the window, must be positive
+   *
+   * @return
+   * The transmissions per second started in (`time` - `window`, `time`]
+   */
+  [[nodiscard]] double transmissionRate(std::uint32_t slot, nanoseconds time,
+                                        nanoseconds window = defaultWindow) const;
+
+  /**
+   * @param slot
+   * The slot of a Node, or `allNodes`
+   *
+   * @return
+   * The straight line distance between the waypoints reached at or before `time`, in ns-3 units
+   */
+  [[nodiscard]] double distance(std::uint32_t slot, nanoseconds time) const;
+
+  /**
+   * Find the Node with the most transmissions in a window.
+   * Searches the column of each Node, so is linear in the number of Nodes
+   *
+   * @param time
+   * The end of the window, included
+   *
+   * @param window
+   * The length of the window, or 0 to count from the start of the scenario
+   */
+  [[nodiscard]] Busiest busiest(nanoseconds time, nanoseconds window = defaultWindow) const;
+
+  /**
+   * Sample `transmissionRate()` every `step`, from `step` until `to`
+   *
+   * @return
+   * A point per sample, with the time in seconds as X
+   */
+  [[nodiscard]] std::vector<XYPoint> rateSeries(std::uint32_t slot, nanoseconds to, nanoseconds step,
+                                                nanoseconds window = defaultWindow) const;
+
+  /**
+   * @return
+   * A point per move, with the time in seconds as X & the distance moved so far as Y
+   */
+  [[nodiscard]] std::vector<XYPoint> distanceSeries(std::uint32_t slot) const;
+
+  /**
+   * @return
+   * The time of the latest event counted, or 0 if there are none
+   */
+  [[nodiscard]] nanoseconds lastTime() const;
+
+  [[nodiscard]] std::size_t nodeCount() const;
+
+  /**
+   * @return
+   * The bytes held by the columns
+   */
+  [[nodiscard]] std::size_t memoryUsage() const;
+};
+
+} // namespace parser
@@ -0,0 +1,135 @@
+/*
+ * NIST-developed software is provided by NIST as a public service. You may use,
+ * copy and distribute copies of the software in any medium, provided that you
+ * keep intact this entire notice. You may improve,modify and create derivative
+ * works of the software or any portion of the software, and you may copy and
+ * distribute such modifications or works. Modified works should carry a notice
+ * stating that you changed the software and should note the date and nature of
+ * any such change. Please explicitly acknowledge the National Institute of
+ * Standards and Technology as the source of the software.
+ *
+ * NIST-developed software is expressly provided "AS IS." NIST MAKES NO
+ * WARRANTY OF ANY KIND, EXPRESS, IMPLIED, IN FACT OR ARISING BY OPERATION OF
+ * LAW, INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTY OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, NON-INFRINGEMENT
+ * AND DATA ACCURACY. NIST NEITHER REPRESENTS NOR WARRANTS THAT THE
+ * OPERATION OF THE SOFTWARE WILL BE UNINTERRUPTED OR ERROR-FREE, OR THAT
+ * ANY DEFECTS WILL BE CORRECTED. NIST DOES NOT WARRANT OR MAKE ANY
+ * REPRESENTATIONS REGARDING THE USE OF THE SOFTWARE OR THE RESULTS THEREOF,
+ * INCLUDING BUT NOT LIMITED TO THE CORRECTNESS, ACCURACY, RELIABILITY,
+ * OR USEFULNESS OF THE SOFTWARE.
+ *
+ * You are solely responsible for determining the appropriateness of using and
+ * distributing the software and you assume all risks associated with its use,
+ * including but not limited to the risks and costs of program errors,
+ * compliance with applicable laws, damage to or loss of data, programs or
+ * equipment, and the unavailability or interruption of operation. This
+ * software is not intended to be used in any situation where a failure could
+ * cause risk of injury or damage to property. The software developed by NIST
+ * employees is not subject to copyright protection within the United States.
+ *
+ * Author: Evan Black <evan.black@nist.gov>
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+
+namespace parser {
+
+/**
+ * Convenience struct for packaging points.
+ * Does not correspond to anything in the ns-3 module
+ */
+struct XYPoint {
+  double x;
+  double y;
+};
+
+/**
+ * A run of points in a block shared with other runs, see `XYPointArena`.
+ * Copies share the block, rather than copying the points
+ */
+class XYPointSpan {
+  std::shared_ptr<const XYPoint[]> block;
+  std::size_t first{0u};
+  std::size_t count{0u};
+
+public:
+  XYPointSpan() = default;
+
+  /**
+   * @param block
+   * The block holding the points
+   *
+   * @param first
+   * The index of the first point in `block`
+   *
+   * @param count
+   * The number of points from `first` on
+   */
+  XYPointSpan(std::shared_ptr<const XYPoint[]> block, std::size_t first, std::size_t count);
+
+  [[nodiscard]] const XYPoint *data() const {
+    return block.get() + first;
+  }
+
+  [[nodiscard]] const XYPoint *begin() const {
+    return data();
+  }
+
+  [[nodiscard]] const XYPoint *end() const {
+    return data() + count;
+  }
+
+  [[nodiscard]] std::size_t size() const {
+    return count;
+  }
+
+  [[nodiscard]] bool empty() const {
+    return count == 0u;
+  }
+
+  const XYPoint &operator[](std::size_t index) const {
+    return data()[index];
+  }
+};
+
+/**
+ * Copies runs of points into large blocks, so each run is not an allocation of its own.
+ *
+ * A block is never resized, so a span handed out stays valid,
+ * and may be read on another thread while later runs are written to the rest of the block.
+ * A block is freed once the arena & every span in it are gone
+ */
+class XYPointArena {
+  std::shared_ptr<XYPoint[]> block;
+
+  /**
+   * Points written to `block` so far
+   */
+  std::size_t used{0u};
+
+public:
+  /**
+   * Points per block. Runs longer than this take a block of their own
+   */
+  static constexpr std::size_t blockSize = 16384u;
+
+  /**
+   * Copy `count` points into the arena
+   *
+   * @param points
+   * The points to copy
+   *
+   * @param count
+   * The number of points at `points`
+   *
+   * @return
+   * The copied points
+   */
+  [[nodiscard]] XYPointSpan add(const XYPoint *points, std::size_t count);
+};
+
+} // namespace parser
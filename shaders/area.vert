@@ -1,10 +0,0 @@
-#version 330
-
-layout (location = 0) in vec3 in_position;
-
-uniform mat4 view;
-uniform mat4 projection;
-
-void main() {
-    gl_Position = projection * view * vec4(in_position, 1.0);
-}
@@ -1,9 +1,9 @@
 #version 330
 
-uniform vec3 color;
-
 out vec4 final_color;
 
+uniform vec3 color;
+
 void main() {
-    final_color = vec4(color, 1.0f);
+    final_color = vec4(color, 1.0);
 }
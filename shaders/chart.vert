@@ -0,0 +1,14 @@
+#version 330
+
+layout (location = 0) in vec2 in_position;
+
+// The origin of the line less the lowest corner of the view,
+// so the positions are relative to the view
+uniform vec2 offset;
+
+// 2 over the size of the view
+uniform vec2 scale;
+
+void main() {
+    gl_Position = vec4((in_position + offset) * scale - 1.0, 0.0, 1.0);
+}
@@ -1,23 +1,28 @@
 #version 330 core
 
-layout (location = 0) in vec4 vertex; // <vec2 pos, vec2 tex>
+layout (location = 0) in vec2 vertex;
+layout (location = 1) in vec2 texture_coordinate;
+layout (location = 2) in uint label;
 out vec2 TexCoords;
 
-uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
-
+// xyz: world position of each label, w: 1 to show the label, 0 to hide it
+uniform samplerBuffer anchors;
+uniform float scale;
 
 void main() {
-    mat4 mvp = projection * view * model;
-    float d = sqrt(mvp[0][0] * mvp[0][0] + mvp[1][0] * mvp[1][0] + mvp[2][0]* mvp[2][0]);
-
-
-    mvp[0] = vec4(1, 1, 1, mvp[0][3]);
-    mvp[1] = vec4(1, 1, 1, mvp[1][3]);
-    mvp[2] = vec4(1, 1, 1, mvp[2][3]);
-
-
-    gl_Position = projection * view * model * vec4(vertex.xy, 0.0, 1.0);
-    TexCoords = vertex.zw;
+    vec4 anchor = texelFetch(anchors, int(label));
+    if (anchor.w == 0.0) {
+        // Outside the clip volume, so the whole triangle is dropped
+        gl_Position = vec4(2.0, 2.0, 2.0, 1.0);
+        TexCoords = texture_coordinate;
+        return;
+    }
+
+    // Face the camera, the rows of the view rotation are the camera's axes
+    vec3 right = vec3(view[0][0], view[1][0], view[2][0]);
+    vec3 up = vec3(view[0][1], view[1][1], view[2][1]);
+
+    vec3 position = anchor.xyz + (right * vertex.x + up * vertex.y) * scale;
+    gl_Position = projection * view * vec4(position, 1.0);
+    TexCoords = texture_coordinate;
 }
@@ -1,11 +1,26 @@
 #version 330 core
 
 layout (location = 0) in vec2 vertex;
+layout (location = 2) in uint label;
 
-uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
+// xyz: world position of each label, w: 1 to show the label, 0 to hide it
+uniform samplerBuffer anchors;
+uniform float scale;
 
 void main() {
-    gl_Position = projection * view * model * vec4(vertex.xy, 0.0, 1.0);
+    vec4 anchor = texelFetch(anchors, int(label));
+    if (anchor.w == 0.0) {
+        // Outside the clip volume, so the whole triangle is dropped
+        gl_Position = vec4(2.0, 2.0, 2.0, 1.0);
+        return;
+    }
+
+    // Face the camera, the rows of the view rotation are the camera's axes
+    vec3 right = vec3(view[0][0], view[1][0], view[2][0]);
+    vec3 up = vec3(view[0][1], view[1][1], view[2][1]);
+    vec3 back = vec3(view[0][2], view[1][2], view[2][2]);
+
+    // Slightly behind the glyphs
+    vec3 position = anchor.xyz + (right * vertex.x + up * vertex.y - back * 0.01) * scale;
+    gl_Position = projection * view * vec4(position, 1.0);
 }
@@ -0,0 +1,14 @@
+// Per-frame state shared by every program, matches `Renderer::FrameUniforms`
+// Inserted after the `#version` line of each shader by `Renderer::initShader()`
+layout (std140) uniform Frame {
+    mat4 view;
+    mat4 projection;
+    vec3 eye_position;
+    // Simulation time in milliseconds, for `Renderer::NodeData` motion
+    float motion_time;
+
+    vec3 directional_light_color;
+    float directional_light_ambient_intensity;
+    vec3 directional_light_direction;
+    float directional_light_diffuse_intensity;
+};
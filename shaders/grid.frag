@@ -5,17 +5,26 @@ in vec3 fragment_position;
 out vec4 final_color;
 
 uniform float intensity;
-uniform vec3 eye_position;
 uniform float discard_distance;
+uniform float step_size;
 
 void main() {
+    // Distance to the nearest line, in pixels, so the lines stay about one pixel wide
+    // and fade out smoothly, rather than alias.
+    // Before any discard, since the derivatives need every fragment
+    vec2 coordinate = fragment_position.xz / step_size;
+    vec2 pixels = abs(fract(coordinate - 0.5) - 0.5) / fwidth(coordinate);
+    float coverage = 1.0 - min(min(pixels.x, pixels.y), 1.0);
+
     float eye_fragment_distance = abs(distance(eye_position, fragment_position));
-    if (eye_fragment_distance > discard_distance) {
+    if (eye_fragment_distance > discard_distance || coverage <= 0.0) {
         discard;
     }
 
     // Should never exceed 1, as those fragments are discarded
     float attenuation = eye_fragment_distance/discard_distance;
-    float color = clamp(intensity - attenuation, 0, 1);
+    float color = clamp(intensity - attenuation, 0, 1) * coverage;
+
+    // Blended additively, so scaling the color fades the line
     final_color = vec4(color, color, color, 1.0f);
 }
@@ -4,11 +4,17 @@ layout (location = 0) in vec2 in_position;
 
 out vec3 fragment_position;
 
-uniform mat4 view;
-uniform mat4 projection;
 uniform float height;
+uniform float square_size;
+uniform float discard_distance;
 
 void main() {
-    fragment_position = vec3(in_position[0], height, in_position[1]);
+    // Only cover the part of the grid which may be drawn,
+    // everything further than `discard_distance` is discarded anyway
+    vec2 low = max(vec2(-square_size), eye_position.xz - discard_distance);
+    vec2 high = max(low, min(vec2(square_size), eye_position.xz + discard_distance));
+    vec2 corner = mix(low, high, in_position * 0.5 + 0.5);
+
+    fragment_position = vec3(corner.x, height, corner.y);
     gl_Position = projection * view * vec4(fragment_position, 1.0);
 }
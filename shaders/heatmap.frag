@@ -0,0 +1,28 @@
+#version 330
+
+in vec2 texture_coordinate;
+
+out vec4 final_color;
+
+uniform sampler2D density;
+
+// The density shown at the top of the ramp
+uniform float saturation;
+
+// Blue for sparse, through cyan, green, & yellow, to red for dense
+vec3 ramp(float value) {
+    const vec3 colors[5] = vec3[](vec3(0.0, 0.0, 1.0), vec3(0.0, 1.0, 1.0), vec3(0.0, 1.0, 0.0),
+                                  vec3(1.0, 1.0, 0.0), vec3(1.0, 0.0, 0.0));
+    float scaled = value * 4.0;
+    int index = min(int(scaled), 3);
+    return mix(colors[index], colors[index + 1], scaled - float(index));
+}
+
+void main() {
+    float value = clamp(texture(density, texture_coordinate).r / saturation, 0.0, 1.0);
+    if (value <= 0.01)
+        discard;
+
+    // Fade in, so the edge of each splat does not show
+    final_color = vec4(ramp(value), 0.7 * smoothstep(0.0, 0.15, value));
+}
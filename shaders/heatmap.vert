@@ -0,0 +1,17 @@
+#version 330
+
+out vec2 texture_coordinate;
+
+// The corners of the ground covered by the heatmap
+uniform vec2 low;
+uniform vec2 high;
+uniform float height;
+
+void main() {
+    // A strip of 4 vertices, with no vertex attributes
+    vec2 corner = vec2(gl_VertexID & 1, gl_VertexID >> 1);
+    texture_coordinate = corner;
+
+    vec2 ground = mix(low, high, corner);
+    gl_Position = projection * view * vec4(ground.x, height, ground.y, 1.0);
+}
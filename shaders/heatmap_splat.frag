@@ -0,0 +1,15 @@
+#version 330
+
+flat in float weight;
+
+out float density;
+
+void main() {
+    // Falls off smoothly to nothing at the edge of the point
+    float radius = length(gl_PointCoord * 2.0 - 1.0);
+    if (radius >= 1.0 || weight <= 0.0)
+        discard;
+
+    float falloff = 1.0 - radius * radius;
+    density = weight * falloff * falloff; // Blended additively
+}
@@ -0,0 +1,56 @@
+#version 330
+
+// Only read for transmissions, see `Mesh::TransmissionInstance`.
+// Nodes are read from `node_data` by `gl_VertexID`
+layout (location = 0) in vec3 in_center;
+layout (location = 1) in float in_start_time;
+layout (location = 2) in float in_duration;
+
+flat out float weight;
+
+// 8 texels per slot, see `model.vert`
+uniform samplerBuffer node_data;
+
+uniform bool transmissions = false;
+
+// Simulation time, in milliseconds since the upload of the transmissions
+uniform float time;
+
+// The corners of the ground covered by the heatmap
+uniform vec2 low;
+uniform vec2 high;
+
+// Diameter of each splat, in texels
+uniform float splat_size;
+
+// The density at the center of each splat
+uniform float splat_weight;
+
+// Along the straight line to the Node's next waypoint, see `NodeStore::Motion`
+vec3 motion_offset(int base) {
+    vec4 span = texelFetch(node_data, base + 6);
+    if (span.z <= span.y)
+        return vec3(0.0);
+
+    float progress = clamp((motion_time - span.y) / (span.z - span.y), 0.0, 1.0);
+    return texelFetch(node_data, base + 7).xyz * progress;
+}
+
+void main() {
+    vec3 position;
+    weight = splat_weight;
+    if (transmissions) {
+        position = in_center;
+        if (time < in_start_time || time > in_start_time + in_duration)
+            weight = 0.0;
+    } else {
+        // The translation column of the model matrix
+        int base = gl_VertexID * 8;
+        position = texelFetch(node_data, base + 3).xyz + motion_offset(base);
+    }
+
+    // Straight down onto the ground
+    vec2 ground = (position.xz - low) / (high - low);
+    gl_Position = vec4(ground * 2.0 - 1.0, 0.0, 1.0);
+    gl_PointSize = splat_size;
+}
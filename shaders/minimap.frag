@@ -0,0 +1,13 @@
+#version 330
+
+flat in vec4 color;
+
+out vec4 final_color;
+
+void main() {
+    // Round dots, rather than squares
+    if (length(gl_PointCoord * 2.0 - 1.0) >= 1.0)
+        discard;
+
+    final_color = vec4(color.rgb, 1.0);
+}
@@ -0,0 +1,47 @@
+#version 330
+
+flat out vec4 color;
+
+// 8 texels per slot, see `model.vert`
+uniform samplerBuffer node_data;
+
+// The corners of the ground covered by the minimap
+uniform vec2 low;
+uniform vec2 high;
+
+uniform bool has_selected_object = false;
+uniform uint selected_object = 0u;
+
+// Diameter of each dot, in texels
+uniform float dot_size;
+
+// Along the straight line to the Node's next waypoint, see `NodeStore::Motion`
+vec3 motion_offset(int base) {
+    vec4 span = texelFetch(node_data, base + 6);
+    if (span.z <= span.y)
+        return vec3(0.0);
+
+    float progress = clamp((motion_time - span.y) / (span.z - span.y), 0.0, 1.0);
+    return texelFetch(node_data, base + 7).xyz * progress;
+}
+
+void main() {
+    // One point per slot, read by `gl_VertexID`
+    int base = gl_VertexID * 8;
+    vec3 position = texelFetch(node_data, base + 3).xyz + motion_offset(base);
+
+    // The base color of the Node, if it has one
+    color = texelFetch(node_data, base + 4);
+    if (color.a == 0.0)
+        color = vec4(0.1, 0.1, 0.1, 1.0);
+
+    gl_PointSize = dot_size;
+    if (has_selected_object && uint(texelFetch(node_data, base + 6).x) == selected_object) {
+        color = vec4(1.0, 0.2, 0.2, 1.0);
+        gl_PointSize = dot_size * 2.0;
+    }
+
+    // Straight down, with -Z at the top, matching the top down view of the static content
+    vec2 ground = vec2(position.x - low.x, high.y - position.z) / (high - low);
+    gl_Position = vec4(ground * 2.0 - 1.0, 0.0, 1.0);
+}
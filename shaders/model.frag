@@ -3,11 +3,13 @@
 in vec2 texture_coordinates;
 in vec3 normal;
 in vec3 fragment_position;
+flat in vec4 instance_color;
+flat in float instance_selected;
 
 out vec4 final_color;
 
-const uint maxPointLights = 5u;
-const uint maxSpotLights = 5u;
+// Matches `LightClusters`
+const uvec3 cluster_grid = uvec3(16u, 9u, 24u);
 
 struct Light {
     vec3 color;
@@ -15,42 +17,27 @@ struct Light {
     float diffuse_intensity;
 };
 
-struct DirectionalLight {
-    Light base;
-    vec3 direction;
-};
-
-struct PointLight {
-    Light base;
-    vec3 position;
-    float constant;
-    float linear;
-    float exponent;
-};
-
-struct SpotLight {
-    PointLight pointLight;
-    vec3 direction;
-    float edge;
-};
-
 struct Material {
     float specular_intensity;
     float shininess;
 };
 
-uniform uint pointLightCount = 0u;
-uniform uint spotLightCount = 0u;
+// `PointLight`s, as 3 texels each: the position & range, the color & intensity, then the direction & edge
+uniform samplerBuffer lights;
+uniform uint light_count = 0u;
 
-uniform DirectionalLight directional_light;
-uniform PointLight pointLights[maxPointLights];
-uniform SpotLight spotLights[maxSpotLights];
+// Two texels per cluster, the first of its lights in the buffer & their count, then the lights of each cluster
+uniform usamplerBuffer light_clusters;
+uniform float cluster_near;
+uniform float cluster_far;
 
 uniform bool useTexture;
 uniform bool useLighting;
 uniform sampler2D texture_sampler;
+// Used in place of `texture_sampler` when the texture was packed into an array
+uniform sampler2DArray texture_array_sampler;
+uniform int texture_layer = -1;
 uniform Material material;
-uniform vec3 eye_position;
 
 uniform vec3 material_color;
 
@@ -80,70 +67,80 @@ vec4 lightByDirection(Light base, vec3 direction) {
 }
 
 vec4 calculateDirectionalLight() {
-    return lightByDirection(directional_light.base, directional_light.direction);
+    // The directional light comes from the `Frame` block
+    Light base = Light(directional_light_color, directional_light_ambient_intensity,
+                       directional_light_diffuse_intensity);
+    return lightByDirection(base, directional_light_direction);
 }
 
-vec4 calculatePointLight(PointLight light) {
-    vec3 direction = fragment_position - light.position;
+vec4 calculatePointLight(uint index) {
+    vec4 position_range = texelFetch(lights, int(index * 3u));
+    vec4 color_intensity = texelFetch(lights, int(index * 3u + 1u));
+    vec4 direction_edge = texelFetch(lights, int(index * 3u + 2u));
+
+    vec3 direction = fragment_position - position_range.xyz;
     float distance = length(direction);
+    if (distance >= position_range.w)
+        return vec4(0.0);
     direction = normalize(direction);
 
-    vec4 color = lightByDirection(light.base, direction);
-
-    // ax^2 + bx + c
-    float attenuation = light.exponent * distance * distance + light.linear * distance + light.constant;
-
-    return color / attenuation;
-}
-
-vec4 calculateSpotLight(SpotLight light) {
-    vec3 rayDirection = normalize(fragment_position - light.pointLight.position);
-
-    // Angle between the fragment and the light's direction
-    float factor = dot(rayDirection, light.direction);
-    if (factor > light.edge) {
-        vec4 color = calculatePointLight(light.pointLight);
+    // Angle between the fragment and the way a spot light points
+    float scale = 1.0;
+    if (direction_edge.w > -1.0) {
+        float factor = dot(direction, direction_edge.xyz);
+        if (factor <= direction_edge.w)
+            return vec4(0.0);
 
-        // Scale the output color 0 to 1.0
         // softens the edges of the spotlight
-        float scale =  1.0f - (1.0f - factor) * (1.0f/(1.0f - light.edge));
-
-        return color * scale;
+        scale = 1.0 - (1.0 - factor) * (1.0 / (1.0 - direction_edge.w));
     }
 
-    return vec4(0.0f, 0.0f, 0.0f, 0.0f);
+    // Fades to nothing at the range, so lights past it may be left out of a cluster
+    float fade = clamp(1.0 - pow(distance / position_range.w, 4.0), 0.0, 1.0);
+    float attenuation = fade * fade / (1.0 + distance * distance);
+
+    Light base = Light(color_intensity.rgb, 0.0, color_intensity.a);
+    return lightByDirection(base, direction) * attenuation * scale;
 }
 
 vec4 calculatePointLights() {
-    vec4 total = vec4(0, 0, 0, 0);
-
-    for (uint i = 0u; i < pointLightCount; i++) {
-        total += calculatePointLight(pointLights[i]);
-    }
+    vec4 total = vec4(0.0);
+    if (light_count == 0u)
+        return total;
 
-    return total;
-}
+    vec4 view_position = view * vec4(fragment_position, 1.0);
+    vec4 clip_position = projection * view_position;
+    vec2 screen = clip_position.xy / clip_position.w * 0.5 + 0.5;
+    float depth = max(-view_position.z, cluster_near);
 
-vec4 calculateSpotLights() {
-    vec4 total = vec4(0, 0, 0, 0);
+    vec3 cell = vec3(screen * vec2(cluster_grid.xy),
+                     log(depth / cluster_near) / log(cluster_far / cluster_near) * float(cluster_grid.z));
+    uvec3 clamped = uvec3(clamp(ivec3(floor(cell)), ivec3(0), ivec3(cluster_grid) - 1));
+    uint cluster = (clamped.z * cluster_grid.y + clamped.y) * cluster_grid.x + clamped.x;
 
-    for (uint i = 0u; i < spotLightCount; i++) {
-        total += calculateSpotLight(spotLights[i]);
-    }
+    uint first = texelFetch(light_clusters, int(cluster * 2u)).r;
+    uint count = texelFetch(light_clusters, int(cluster * 2u + 1u)).r;
+    for (uint i = 0u; i < count; i++)
+        total += calculatePointLight(texelFetch(light_clusters, int(first + i)).r);
 
     return total;
 }
 
 void main()
 {
+    // Instances may replace the material color
+    vec3 base_color = instance_color.a > 0.0 ? instance_color.rgb : material_color;
+
     // Choose Material color or Texture for the base
-    final_color = mix(vec4(material_color, 1.0), texture(texture_sampler, texture_coordinates), int(useTexture));
+    vec4 texture_color = texture_layer < 0 ? texture(texture_sampler, texture_coordinates)
+                                           : texture(texture_array_sampler, vec3(texture_coordinates, texture_layer));
+    final_color = mix(vec4(base_color, 1.0), texture_color, int(useTexture));
 
     if (useLighting)
-        final_color *= calculateDirectionalLight() + calculatePointLights() + calculateSpotLights();
+        final_color *= calculateDirectionalLight() + calculatePointLights();
     
     // Significantly decrease colors aside from green in selected items
-    if (is_selected) {
+    if (is_selected || instance_selected > 0.5) {
         final_color *= vec4(0.5, 1.5, 0.5, 1.0);
         if (final_color.g < 0.1)
             final_color.g += 0.25;
@@ -4,22 +4,74 @@ layout (location = 0) in vec3 in_position;
 layout (location = 1) in vec3 in_normal;
 layout (location = 2) in vec2 in_texture;
 
+// Per-instance slot in `node_data`, only read when `instanced` is set
+layout (location = 3) in uint in_instance_slot;
+
+// Where the mesh is placed in its model, for meshes referenced by several nodes.
+// The identity otherwise
+layout (location = 4) in mat4 in_reference;
+
 out vec2 texture_coordinates;
 out vec3 normal;
 out vec3 fragment_position;
 
+// Color replacing `material_color`, used if the alpha is above 0
+flat out vec4 instance_color;
+flat out float instance_selected;
+
 uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
+
+uniform bool instanced = false;
+
+// 8 texels per slot: 4 model matrix columns, base color, highlight color,
+// the object ID with the motion start & end times, then the motion offset
+uniform samplerBuffer node_data;
+
+uniform bool has_selected_object = false;
+uniform uint selected_object = 0u;
+
+// 0: Unclassified, 1: Base, 2: Highlight
+uniform uint material_type = 0u;
+
+// Along the straight line to the Node's next waypoint, see `NodeStore::Motion`
+vec3 motion_offset(int base) {
+    vec4 span = texelFetch(node_data, base + 6);
+    if (span.z <= span.y)
+        return vec3(0.0);
+
+    float progress = clamp((motion_time - span.y) / (span.z - span.y), 0.0, 1.0);
+    return texelFetch(node_data, base + 7).xyz * progress;
+}
 
 void main()
 {
-    gl_Position = projection * view * model * vec4(in_position, 1.0);
+    int base = int(in_instance_slot) * 8;
+    mat4 final_model = model;
+    if (instanced) {
+        final_model = mat4(texelFetch(node_data, base), texelFetch(node_data, base + 1), texelFetch(node_data, base + 2),
+                           texelFetch(node_data, base + 3));
+        final_model[3].xyz += motion_offset(base);
+    }
+    final_model = final_model * in_reference;
+
+    gl_Position = projection * view * final_model * vec4(in_position, 1.0);
     texture_coordinates = in_texture;
 
     // Only nessary if we allow non-uniform scaling
-    mat3 Nonuniform_scale_model = mat3(transpose(inverse(model)));
+    mat3 Nonuniform_scale_model = mat3(transpose(inverse(final_model)));
 
     normal = Nonuniform_scale_model * in_normal;
-    fragment_position = (model * vec4(in_position, 1.0)).xyz;
+    fragment_position = (final_model * vec4(in_position, 1.0)).xyz;
+
+    instance_color = vec4(0.0);
+    instance_selected = 0.0;
+    if (instanced) {
+        if (material_type == 1u)
+            instance_color = texelFetch(node_data, base + 4);
+        else if (material_type == 2u)
+            instance_color = texelFetch(node_data, base + 5);
+
+        uint object_id = uint(texelFetch(node_data, base + 6).x);
+        instance_selected = has_selected_object && object_id == selected_object ? 1.0 : 0.0;
+    }
 }
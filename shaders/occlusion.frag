@@ -0,0 +1,8 @@
+#version 330
+
+out vec4 final_color;
+
+void main() {
+    // Only counted by the query, the color is never written
+    final_color = vec4(1.0f);
+}
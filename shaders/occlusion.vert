@@ -0,0 +1,13 @@
+#version 330
+
+// The bounds tested, see `OcclusionQueries::Test`
+uniform vec3 box_min;
+uniform vec3 box_max;
+
+void main() {
+    // A corner of the unit cube, drawn as one 14 vertex triangle strip without any vertex attributes
+    int bit = 1 << gl_VertexID;
+    vec3 corner = vec3((0x287a & bit) != 0, (0x02af & bit) != 0, (0x31e3 & bit) != 0);
+
+    gl_Position = projection * view * vec4(mix(box_min, box_max, corner), 1.0);
+}
@@ -2,6 +2,9 @@
 
 uniform uint object_type;
 uniform uint object_id;
+uniform bool instanced = false;
+
+flat in uint instance_object_id;
 
 out uvec3 picking_fragment;
 
@@ -10,5 +13,5 @@ void main() {
     // in the texture, since by default, OpenGL will, clear to 0
     // so, we need some way to tell an object was rendered at this
     // fragment
-    picking_fragment = uvec3(1.0, object_type, object_id);
+    picking_fragment = uvec3(1.0, object_type, instanced ? instance_object_id : object_id);
 }
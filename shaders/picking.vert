@@ -2,10 +2,43 @@
 
 layout (location = 0) in vec3 in_position;
 
+// Per-instance slot in `node_data`, only read when `instanced` is set
+layout (location = 3) in uint in_instance_slot;
+
+// Where the mesh is placed in its model, for meshes referenced by several nodes.
+// The identity otherwise
+layout (location = 4) in mat4 in_reference;
+
+flat out uint instance_object_id;
+
 uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
+
+uniform bool instanced = false;
+
+// 8 texels per slot: 4 model matrix columns, base color, highlight color,
+// the object ID with the motion start & end times, then the motion offset
+uniform samplerBuffer node_data;
+
+// Matches `model.vert`
+vec3 motion_offset(int base) {
+    vec4 span = texelFetch(node_data, base + 6);
+    if (span.z <= span.y)
+        return vec3(0.0);
+
+    float progress = clamp((motion_time - span.y) / (span.z - span.y), 0.0, 1.0);
+    return texelFetch(node_data, base + 7).xyz * progress;
+}
 
 void main() {
-    gl_Position = projection * view * model * vec4(in_position, 1.0);
-}
\ No newline at end of file
+    int base = int(in_instance_slot) * 8;
+    mat4 final_model = model;
+    instance_object_id = 0u;
+    if (instanced) {
+        final_model = mat4(texelFetch(node_data, base), texelFetch(node_data, base + 1), texelFetch(node_data, base + 2),
+                           texelFetch(node_data, base + 3));
+        final_model[3].xyz += motion_offset(base);
+        instance_object_id = uint(texelFetch(node_data, base + 6).x);
+    }
+    final_model = final_model * in_reference;
+    gl_Position = projection * view * final_model * vec4(in_position, 1.0);
+}
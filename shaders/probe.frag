@@ -0,0 +1,22 @@
+#version 330
+
+in vec2 texture_coordinate;
+
+out vec4 final_color;
+
+// Which of the layers drawn by the probe this is, so each is shaded differently
+uniform int layer;
+
+// Roughly the per-pixel work of a lit, textured model fragment
+void main() {
+    vec3 normal = normalize(vec3(texture_coordinate * 2.0 - 1.0, 1.0));
+    vec3 color = vec3(0.0);
+    for (int i = 0; i < 4; i++) {
+        float angle = float(layer * 4 + i) * 0.7;
+        vec3 light = normalize(vec3(cos(angle), sin(angle), 0.5));
+        vec3 half_vector = normalize(light + vec3(0.0, 0.0, 1.0));
+        color += max(dot(normal, light), 0.0) * vec3(0.2) + pow(max(dot(normal, half_vector), 0.0), 32.0) * vec3(0.05);
+    }
+
+    final_color = vec4(color, 0.5);
+}
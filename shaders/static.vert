@@ -0,0 +1,15 @@
+#version 330
+
+layout (location = 0) in vec3 in_position;
+layout (location = 1) in vec3 in_color;
+
+out vec3 color;
+
+// Replaces the color of every vertex, for outlines
+uniform bool use_override_color = false;
+uniform vec3 override_color;
+
+void main() {
+    gl_Position = projection * view * vec4(in_position, 1.0);
+    color = use_override_color ? override_color : in_color;
+}
@@ -0,0 +1,18 @@
+#version 330
+
+in float time;
+
+uniform vec3 color;
+// The oldest time still in the trail, in milliseconds
+uniform float window_start;
+
+out vec4 final_color;
+
+void main() {
+    // Clip the lines at either end of the trail to where the Node was at the window's start,
+    // & where it is now
+    if (time < window_start || time > motion_time)
+        discard;
+
+    final_color = vec4(color, 1.0f); // Our blending method discards alpha
+}
@@ -0,0 +1,12 @@
+#version 330
+
+layout (location = 0) in vec3 in_position;
+// The time the Node reaches this point, see `TrajectoryBuffer::Vertex`
+layout (location = 1) in float in_time;
+
+out float time;
+
+void main() {
+    time = in_time;
+    gl_Position = projection * view * vec4(in_position, 1.0);
+}
@@ -0,0 +1,24 @@
+#version 330
+
+layout (location = 0) in vec3 in_position;
+
+// Per-instance attributes, see `Mesh::TransmissionInstance`
+layout (location = 3) in vec3 in_center;
+layout (location = 4) in float in_start_time;
+layout (location = 5) in float in_duration;
+layout (location = 6) in float in_target_size;
+layout (location = 7) in vec3 in_color;
+
+flat out vec3 color;
+
+// Simulation time, in milliseconds since the upload of the instances
+uniform float time;
+
+void main() {
+    // Grow from nothing to the target size over the transmission
+    float progress = clamp((time - in_start_time) / max(in_duration, 0.000001), 0.0, 1.0);
+    float radius = progress * in_target_size;
+
+    gl_Position = projection * view * vec4(in_center + in_position * radius, 1.0);
+    color = in_color;
+}
@@ -0,0 +1,11 @@
+#version 330
+
+in vec2 texture_coordinate;
+
+out vec4 final_color;
+
+uniform sampler2D scene;
+
+void main() {
+    final_color = texture(scene, texture_coordinate);
+}
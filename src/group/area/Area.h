@@ -33,35 +33,21 @@
 
 #pragma once
 
-#include <glm/vec3.hpp>
 #include <model.h>
 
 namespace netsimulyzer {
 
+/**
+ * An Area in the scene.
+ * Its geometry is kept by `StaticGeometry`
+ */
 class Area {
-public:
-  struct RenderInfo {
-    bool renderBorder = true;
-    unsigned int borderVao = 0u;
-    unsigned int borderVbo = 0u;
-    unsigned int borderVbo_size = 0u;
-    glm::vec3 borderColor;
-
-    bool renderFill = true;
-    unsigned int fillVao = 0u;
-    unsigned int fillVbo = 0u;
-    unsigned int fillVbo_size = 0u;
-    glm::vec3 fillColor;
-  };
-
-private:
-  RenderInfo renderInfo;
   parser::Area model;
 
 public:
-  Area(RenderInfo renderInfo, parser::Area model);
+  explicit Area(parser::Area model);
 
-  [[nodiscard]] const RenderInfo &getRenderInfo() const;
+  [[nodiscard]] const parser::Area &getModel() const;
 };
 
 } // namespace netsimulyzer
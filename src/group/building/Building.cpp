@@ -35,20 +35,12 @@
 
 namespace netsimulyzer {
 
-Building::Building(const Building::RenderInfo &renderInfo, const parser::Building &model)
-    : renderInfo(renderInfo), color(toRenderColor(model.color)), model(model) {
-}
-
-const Building::RenderInfo &Building::getRenderInfo() const {
-  return renderInfo;
+Building::Building(const parser::Building &model) : color(toRenderColor(model.color)), model(model) {
 }
 
 const glm::vec3 &Building::getColor() const {
   return color;
 }
-void Building::setColor(const glm::vec3 &value) {
-  color = value;
-}
 
 bool Building::visible() const {
   return model.visible;
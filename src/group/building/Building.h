@@ -33,40 +33,23 @@
 
 #pragma once
 
-#include "../../render/shader/Shader.h"
-#include <QOpenGLFunctions_4_5_Core>
-#include <array>
 #include <glm/glm.hpp>
 #include <model.h>
 
 namespace netsimulyzer {
 
+/**
+ * A Building in the scene.
+ * Its geometry is kept by `StaticGeometry`
+ */
 class Building {
-public:
-  struct RenderInfo {
-    unsigned int vao = 0u;
-    unsigned int vbo = 0u;
-    unsigned int ibo = 0u;
-    unsigned int ibo_size = 0u;
-
-    unsigned int lineVao = 0u;
-    unsigned int lineVbo = 0u;
-    unsigned int lineIbo = 0u;
-    unsigned int lineIboSize = 0u;
-  };
-
-private:
-  RenderInfo renderInfo;
   glm::vec3 color;
   parser::Building model;
 
 public:
-  Building(const Building::RenderInfo &renderInfo, const parser::Building &model);
-
-  [[nodiscard]] const Building::RenderInfo &getRenderInfo() const;
+  explicit Building(const parser::Building &model);
 
   [[nodiscard]] const glm::vec3 &getColor() const;
-  void setColor(const glm::vec3 &value);
   [[nodiscard]] bool visible() const;
 };
 
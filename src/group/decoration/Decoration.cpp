@@ -37,7 +37,7 @@
 
 namespace netsimulyzer {
 
-Decoration::Decoration(const Model &model, const parser::Decoration &ns3Model) : model(model), ns3Model(ns3Model) {
+Decoration::Decoration(const Model &model, const parser::Decoration &ns3Model) : model(model) {
   this->model.setPosition(toRenderCoordinate(ns3Model.position));
   this->model.setRotate(ns3Model.orientation[0], ns3Model.orientation[2], -ns3Model.orientation[1]);
 
@@ -64,32 +64,29 @@ const Model &Decoration::getModel() const {
   return model;
 }
 
-undo::DecorationMoveEvent Decoration::handle(const parser::DecorationMoveEvent &e) {
-  undo::DecorationMoveEvent undo;
-  undo.position = model.getPosition();
-  undo.event = e;
+void Decoration::setModelBounds(const Model::ModelBounds &bounds) {
+  model.setBounds(bounds);
+}
 
+void Decoration::handle(const parser::DecorationMoveEvent &e) {
   this->model.setPosition(toRenderCoordinate(e.targetPosition));
-
-  return undo;
 }
 
-undo::DecorationOrientationChangeEvent Decoration::handle(const parser::DecorationOrientationChangeEvent &e) {
-  undo::DecorationOrientationChangeEvent undo;
-  undo.orientation = model.getRotate();
-  undo.event = e;
-
+void Decoration::handle(const parser::DecorationOrientationChangeEvent &e) {
   this->model.setRotate(e.targetOrientation[0], e.targetOrientation[2], -e.targetOrientation[1]);
-
-  return undo;
 }
 
 void Decoration::handle(const undo::DecorationMoveEvent &e) {
-  model.setPosition(e.position);
+  model.setPosition(toRenderCoordinate(e.position));
 }
 
 void Decoration::handle(const undo::DecorationOrientationChangeEvent &e) {
-  model.setRotate(e.orientation[0], e.orientation[2], e.orientation[1]);
+  model.setRotate(e.rotation[0], e.rotation[1], e.rotation[2]);
+}
+
+void Decoration::restore(const State &state) {
+  model.setPosition(toRenderCoordinate(state.position));
+  model.setRotate(state.rotation[0], state.rotation[1], state.rotation[2]);
 }
 
 } // namespace netsimulyzer
@@ -35,22 +35,60 @@
 
 #include "../../render/model/Model.h"
 #include "../../util/undo-events.h"
+#include <array>
 #include <model.h>
 
 namespace netsimulyzer {
 
 class Decoration {
   Model model;
-  parser::Decoration ns3Model;
 
 public:
+  /**
+   * The parts of a Decoration changed by events.
+   * Used to restore a Decoration to an earlier/later point in time
+   * without applying each event in between
+   */
+  struct State {
+    /**
+     * Position in ns-3 coordinates
+     */
+    parser::Ns3Coordinate position;
+
+    /**
+     * Rotation as passed to `Model::setRotate()`
+     */
+    std::array<float, 3> rotation{0.0f};
+  };
+
+  /**
+   * @param ns3Model
+   * The description of the Decoration from the scenario.
+   * Only read during construction, events change the Decoration from there
+   */
   Decoration(const Model &model, const parser::Decoration &ns3Model);
   [[nodiscard]] const Model &getModel() const;
-  undo::DecorationMoveEvent handle(const parser::DecorationMoveEvent &e);
-  undo::DecorationOrientationChangeEvent handle(const parser::DecorationOrientationChangeEvent &e);
+
+  /**
+   * Give the model the bounds of the model swapped in by `ModelCache::poll()`
+   *
+   * @param bounds
+   * The bounds of the loaded model
+   */
+  void setModelBounds(const Model::ModelBounds &bounds);
+  void handle(const parser::DecorationMoveEvent &e);
+  void handle(const parser::DecorationOrientationChangeEvent &e);
 
   void handle(const undo::DecorationMoveEvent &e);
   void handle(const undo::DecorationOrientationChangeEvent &e);
+
+  /**
+   * Move the Decoration to the state in `state`
+   *
+   * @param state
+   * The state to restore
+   */
+  void restore(const State &state);
 };
 
 } // namespace netsimulyzer
@@ -0,0 +1,94 @@
+/*
+ * NIST-developed software is provided by NIST as a public service. You may use,
+ * copy and distribute copies of the software in any medium, provided that you
+ * keep intact this entire notice. You may improve,modify and create derivative
+ * works of the software or any portion of the software, and you may copy and
+ * distribute such modifications or works. Modified works should carry a notice
+ * stating that you changed the software and should note the date and nature of
+ * any such change. Please explicitly acknowledge the National Institute of
+ * Standards and Technology as the source of the software.
+ *
+ * NIST-developed software is expressly provided "AS IS." NIST MAKES NO
+ * WARRANTY OF ANY KIND, EXPRESS, IMPLIED, IN FACT OR ARISING BY OPERATION OF
+ * LAW, INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTY OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, NON-INFRINGEMENT
+ * AND DATA ACCURACY. NIST NEITHER REPRESENTS NOR WARRANTS THAT THE
+ * OPERATION OF THE SOFTWARE WILL BE UNINTERRUPTED OR ERROR-FREE, OR THAT
+ * ANY DEFECTS WILL BE CORRECTED. NIST DOES NOT WARRANT OR MAKE ANY
+ * REPRESENTATIONS REGARDING THE USE OF THE SOFTWARE OR THE RESULTS THEREOF,
+ * INCLUDING BUT NOT LIMITED TO THE CORRECTNESS, ACCURACY, RELIABILITY,
+ * OR USEFULNESS OF THE SOFTWARE.
+ *
+ * You are solely responsible for determining the appropriateness of using and
+ * distributing the software and you assume all risks associated with its use,
+ * including but not limited to the risks and costs of program errors,
+ * compliance with applicable laws, damage to or loss of data, programs or
+ * equipment, and the unavailability or interruption of operation. This
+ * software is not intended to be used in any situation where a failure could
+ * cause risk of injury or damage to property. The software developed by NIST
+ * employees is not subject to copyright protection within the United States.
+ *
+ * Author: Evan Black <evan.black@nist.gov>
+ */
+
+
+#include "WiredLinkBatch.h"
+#include "src/render/render-stats.h"
+#include "src/render/renderer/GlState.h"
+#include "src/render/renderer/UploadRing.h"
+#include <algorithm>
+
+namespace netsimulyzer {
+
+std::vector<WiredLinkBatch::Endpoint> WiredLinkBatch::layout(const std::vector<parser::WiredLink> &links) {
+  std::vector<Endpoint> endpoints;
+
+  for (const auto &link : links) {
+    // Drawn as `GL_LINES`, so a lone last Node would pair with the next link.
+    // A link drawn on its own skipped it too
+    const auto count = link.nodes.size() - link.nodes.size() % 2u;
+    for (std::size_t i = 0u; i < count; i++)
+      endpoints.push_back({link.nodes[i], static_cast<std::uint32_t>(endpoints.size())});
+  }
+
+  return endpoints;
+}
+
+WiredLinkBatch::WiredLinkBatch(const RenderInfo &renderInfo)
+    : renderInfo(renderInfo), vertices(static_cast<std::size_t>(renderInfo.size), glm::vec3{0.0f}) {
+  initializeOpenGLFunctions();
+}
+
+void WiredLinkBatch::set(std::uint32_t vertex, const glm::vec3 &position) {
+  vertices[vertex] = position;
+
+  if (dirtyBegin >= dirtyEnd) {
+    dirtyBegin = vertex;
+    dirtyEnd = vertex + 1u;
+    return;
+  }
+
+  dirtyBegin = std::min(dirtyBegin, static_cast<std::size_t>(vertex));
+  dirtyEnd = std::max(dirtyEnd, static_cast<std::size_t>(vertex) + 1u);
+}
+
+void WiredLinkBatch::upload() {
+  if (dirtyBegin >= dirtyEnd)
+    return;
+
+  uploadRing.write(renderInfo.vbo, sizeof(glm::vec3) * dirtyBegin, &vertices[dirtyBegin],
+                   sizeof(glm::vec3) * (dirtyEnd - dirtyBegin));
+  dirtyBegin = 0u;
+  dirtyEnd = 0u;
+}
+
+void WiredLinkBatch::render() {
+  if (renderInfo.size == 0)
+    return;
+
+  glState.bindVertexArray(renderInfo.vao);
+  glDrawArrays(GL_LINES, 0, renderInfo.size);
+  stats::frameCounters.drawCalls++;
+}
+
+} // namespace netsimulyzer
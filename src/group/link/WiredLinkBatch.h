@@ -0,0 +1,127 @@
+/*
+ * NIST-developed software is provided by NIST as a public service. You may use,
+ * copy and distribute copies of the software in any medium, provided that you
+ * keep intact this entire notice. You may improve,modify and create derivative
+ * works of the software or any portion of the software, and you may copy and
+ * distribute such modifications or works. Modified works should carry a notice
+ * stating that you changed the software and should note the date and nature of
+ * any such change. Please explicitly acknowledge the National Institute of
+ * Standards and Technology as the source of the software.
+ *
+ * NIST-developed software is expressly provided "AS IS." NIST MAKES NO
+ * WARRANTY OF ANY KIND, EXPRESS, IMPLIED, IN FACT OR ARISING BY OPERATION OF
+ * LAW, INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTY OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, NON-INFRINGEMENT
+ * AND DATA ACCURACY. NIST NEITHER REPRESENTS NOR WARRANTS THAT THE
+ * OPERATION OF THE SOFTWARE WILL BE UNINTERRUPTED OR ERROR-FREE, OR THAT
+ * ANY DEFECTS WILL BE CORRECTED. NIST DOES NOT WARRANT OR MAKE ANY
+ * REPRESENTATIONS REGARDING THE USE OF THE SOFTWARE OR THE RESULTS THEREOF,
+ * INCLUDING BUT NOT LIMITED TO THE CORRECTNESS, ACCURACY, RELIABILITY,
+ * OR USEFULNESS OF THE SOFTWARE.
+ *
+ * You are solely responsible for determining the appropriateness of using and
+ * distributing the software and you assume all risks associated with its use,
+ * including but not limited to the risks and costs of program errors,
+ * compliance with applicable laws, damage to or loss of data, programs or
+ * equipment, and the unavailability or interruption of operation. This
+ * software is not intended to be used in any situation where a failure could
+ * cause risk of injury or damage to property. The software developed by NIST
+ * employees is not subject to copyright protection within the United States.
+ *
+ * Author: Evan Black <evan.black@nist.gov>
+ */
+
+
+#pragma once
+
+#include <QOpenGLFunctions_3_3_Core>
+#include <cstddef>
+#include <cstdint>
+#include <glm/vec3.hpp>
+#include <model.h>
+#include <vector>
+
+namespace netsimulyzer {
+
+/**
+ * Every wired link in the scenario, packed into one vertex buffer
+ * so they may be drawn together. Moved ends are collected,
+ * then staged once per frame with `upload()`
+ */
+class WiredLinkBatch : protected QOpenGLFunctions_3_3_Core {
+public:
+  struct RenderInfo {
+    unsigned int vao = 0u;
+    unsigned int vbo = 0u;
+    int size = 0;
+  };
+
+  /**
+   * A vertex in the batch, and the Node it follows
+   */
+  struct Endpoint {
+    unsigned int nodeId;
+    std::uint32_t vertex;
+  };
+
+private:
+  RenderInfo renderInfo;
+
+  /**
+   * Application side copy of the vertex buffer
+   */
+  std::vector<glm::vec3> vertices;
+
+  /**
+   * The vertices changed since the last upload, as [begin, end).
+   * Empty when `begin` is not before `end`
+   */
+  std::size_t dirtyBegin{0u};
+  std::size_t dirtyEnd{0u};
+
+public:
+  /**
+   * Lay out the vertices for `links`.
+   * The buffer from `Renderer::allocateWiredLinks()` should hold one vertex per endpoint
+   *
+   * @param links
+   * The links to lay out
+   *
+   * @return
+   * One endpoint per vertex, for the Nodes to keep
+   */
+  [[nodiscard]] static std::vector<Endpoint> layout(const std::vector<parser::WiredLink> &links);
+
+  /**
+   * @param renderInfo
+   * The buffer from `Renderer::allocateWiredLinks()`, owned by the `Renderer`
+   */
+  explicit WiredLinkBatch(const RenderInfo &renderInfo);
+  WiredLinkBatch(const WiredLinkBatch &) = delete;
+  WiredLinkBatch &operator=(const WiredLinkBatch &) = delete;
+
+  /**
+   * Move one end of a link. Staged by the next `upload()`
+   *
+   * @param vertex
+   * The vertex from `Endpoint::vertex`
+   *
+   * @param position
+   * The new position, in render coordinates
+   */
+  void set(std::uint32_t vertex, const glm::vec3 &position);
+
+  /**
+   * Stage the moved ends in `uploadRing`, as one write.
+   * Flush it before the next `render()`
+   */
+  void upload();
+
+  /**
+   * Draw every link in one call.
+   * Requires a bound shader
+   */
+  void render();
+};
+
+} // namespace netsimulyzer
@@ -40,11 +40,10 @@
 
 namespace netsimulyzer {
 
-Node::Node(const Model &model, parser::Node ns3Node, TrailBuffer &&trailBuffer,
+Node::Node(const Model &model, const parser::Node &ns3Node, TrailBuffer &&trailBuffer,
            const FontManager::FontBannerRenderInfo &bannerRenderInfo)
-    : model(model), ns3Node(std::move(ns3Node)),
-      offset(toRenderCoordinate(this->ns3Node.offset)), trailBuffer{std::move(trailBuffer)}, bannerRenderInfo{
-                                                                                                 bannerRenderInfo} {
+    : model(model), ns3Node(ns3Node), ns3Position(ns3Node.position), offset(toRenderCoordinate(ns3Node.offset)),
+      trailBuffer{std::move(trailBuffer)}, bannerRenderInfo{bannerRenderInfo} {
   this->model.setPosition(toRenderCoordinate(ns3Node.position) + offset);
   this->model.setRotate(ns3Node.orientation[0], ns3Node.orientation[2], ns3Node.orientation[1]);
 
@@ -80,10 +79,18 @@ const Model &Node::getModel() const {
   return model;
 }
 
+void Node::setModelBounds(const Model::ModelBounds &bounds) {
+  model.setBounds(bounds);
+}
+
 const parser::Node &Node::getNs3Model() const {
   return ns3Node;
 }
 
+const parser::Ns3Coordinate &Node::getNs3Position() const {
+  return ns3Position;
+}
+
 bool Node::visible() const {
   return ns3Node.visible;
 }
@@ -106,122 +113,119 @@ const Node::TransmitInfo &Node::getTransmitInfo() const {
   return transmitInfo;
 }
 
-void Node::addWiredLink(WiredLink *link) {
-  wiredLinks.emplace_back(link);
-  link->notifyNodeMoved(ns3Node.id, getCenter());
+void Node::addWiredLink(WiredLinkBatch *batch, std::uint32_t vertex) {
+  wiredLinks = batch;
+  wiredLinkVertices.emplace_back(vertex);
+  batch->set(vertex, getCenter());
 }
 
-undo::MoveEvent Node::handle(const parser::MoveEvent &e) {
-  undo::MoveEvent undo;
-  undo.position = model.getPosition();
-  undo.ns3Position = ns3Node.position;
-  undo.event = e;
+bool Node::hasWiredLinks() const {
+  return !wiredLinkVertices.empty();
+}
 
+void Node::handle(const parser::MoveEvent &e) {
   if (trailBuffer.empty()) {
     const auto currentPosition = model.getPosition();
     trailBuffer.append(currentPosition.x, currentPosition.y, currentPosition.z);
   }
 
-  ns3Node.position = e.targetPosition;
-  const auto target = toRenderCoordinate(e.targetPosition) + offset;
+  ns3Position = e.targetPosition;
+  const auto target = renderPosition(e.targetPosition);
   model.setPosition(target);
   trailBuffer.append(target.x, target.y, target.z);
 
-  for (auto link : wiredLinks) {
-    link->notifyNodeMoved(ns3Node.id, getCenter());
+  for (const auto vertex : wiredLinkVertices) {
+    wiredLinks->set(vertex, getCenter());
   }
-
-  return undo;
 }
 
-undo::NodeOrientationChangeEvent Node::handle(const parser::NodeOrientationChangeEvent &e) {
-  undo::NodeOrientationChangeEvent undo;
-  undo.orientation = model.getRotate();
-  undo.event = e;
-
+void Node::handle(const parser::NodeOrientationChangeEvent &e) {
   this->model.setRotate(e.targetOrientation[0], e.targetOrientation[2], -e.targetOrientation[1]);
-
-  return undo;
 }
 
-undo::NodeColorChangeEvent Node::handle(const parser::NodeColorChangeEvent &e) {
-  undo::NodeColorChangeEvent undo;
-  undo.event = e;
-
+void Node::handle(const parser::NodeColorChangeEvent &e) {
   if (e.type == parser::NodeColorChangeEvent::ColorType::Base) {
-    undo.originalColor = model.getBaseColor();
-
     if (!e.targetColor.has_value())
       model.unsetBaseColor();
     else
       model.setBaseColor(toRenderColor(e.targetColor.value()));
 
   } else { // Highlight
-    undo.originalColor = model.getHighlightColor();
-
     if (!e.targetColor.has_value())
       model.unsetHighlightColor();
     else
       model.setHighlightColor(toRenderColor(e.targetColor.value()));
   }
-
-  return undo;
 }
 
 void Node::handle(const undo::MoveEvent &e) {
-  model.setPosition(e.position);
-  ns3Node.position = e.ns3Position;
+  ns3Position = e.position;
+  model.setPosition(renderPosition(e.position));
 
   trailBuffer.pop();
 
-  for (auto link : wiredLinks) {
-    link->notifyNodeMoved(ns3Node.id, getCenter());
+  for (const auto vertex : wiredLinkVertices) {
+    wiredLinks->set(vertex, getCenter());
   }
 }
 
-undo::TransmitEvent Node::handle(const parser::TransmitEvent &e) {
+void Node::handle(const parser::TransmitEvent &e) {
   transmitInfo.isTransmitting = true;
   transmitInfo.startTime = e.time;
   transmitInfo.targetSize = e.targetSize;
   transmitInfo.duration = e.duration;
   transmitInfo.color = toRenderColor(e.color);
-
-  undo::TransmitEvent undo;
-  undo.stopTime = transmitInfo.startTime + transmitInfo.duration;
-  undo.event = e;
-  return undo;
 }
 
-undo::TransmitEndEvent Node::handle(const parser::TransmitEndEvent &e) {
+void Node::handle(const parser::TransmitEndEvent &) {
   transmitInfo.isTransmitting = false;
-
-  undo::TransmitEndEvent undo;
-  undo.event = e;
-
-  return undo;
 }
 
 void Node::handle(const undo::NodeOrientationChangeEvent &e) {
-  model.setRotate(e.orientation[0], e.orientation[2], e.orientation[1]);
+  model.setRotate(e.rotation[0], e.rotation[1], e.rotation[2]);
 }
 
 void Node::handle(const undo::NodeColorChangeEvent &e) {
-  if (e.event.type == parser::NodeColorChangeEvent::ColorType::Base) {
+  if (e.type == parser::NodeColorChangeEvent::ColorType::Base) {
     if (e.originalColor.has_value())
-      model.setBaseColor(e.originalColor.value());
+      model.setBaseColor(toRenderColor(e.originalColor.value()));
     else
       model.unsetBaseColor();
   } else { // Highlight
     if (e.originalColor.has_value())
-      model.setHighlightColor(e.originalColor.value());
+      model.setHighlightColor(toRenderColor(e.originalColor.value()));
     else
       model.unsetHighlightColor();
   }
 }
+glm::vec3 Node::renderPosition(const parser::Ns3Coordinate &position) const {
+  return toRenderCoordinate(position) + offset;
+}
+
 const TrailBuffer &Node::getTrailBuffer() const {
   return trailBuffer;
 }
 
+void Node::allocateTrail(TrailPool &pool) {
+  trailBuffer.allocate(pool);
+}
+
+void Node::releaseTrail() {
+  trailBuffer.release();
+}
+
+void Node::appendTrail(const glm::vec3 &point) {
+  trailBuffer.append(point.x, point.y, point.z);
+}
+
+void Node::clearTrail() {
+  trailBuffer.clear();
+}
+
+void Node::flushTrail() {
+  trailBuffer.flush();
+}
+
 const glm::vec3 &Node::getTrailColor() const {
   return trailColor;
 }
@@ -231,14 +235,42 @@ const FontManager::FontBannerRenderInfo &Node::getBannerRenderInfo() const {
 }
 
 void Node::handle(const undo::TransmitEvent &e) {
-  transmitInfo.startTime = e.event.time;
-  transmitInfo.duration = e.event.duration;
+  transmitInfo.isTransmitting = e.isTransmitting;
+
+  // Ending a transmission leaves its details in place
+  if (!e.isTransmitting)
+    return;
+
+  transmitInfo.startTime = e.startTime;
+  transmitInfo.targetSize = e.targetSize;
+  transmitInfo.duration = e.duration;
+  transmitInfo.color = e.color;
 }
 
-void Node::handle(const undo::TransmitEndEvent &e) {
-  const auto &startEvent = e.event.startEvent;
-  transmitInfo.startTime = startEvent.time;
-  transmitInfo.duration = startEvent.duration;
+void Node::restore(const State &state) {
+  ns3Position = state.position;
+  model.setPosition(toRenderCoordinate(state.position) + offset);
+  model.setRotate(state.rotation[0], state.rotation[1], state.rotation[2]);
+
+  if (state.baseColor)
+    model.setBaseColor(toRenderColor(state.baseColor.value()));
+  else
+    model.unsetBaseColor();
+
+  if (state.highlightColor)
+    model.setHighlightColor(toRenderColor(state.highlightColor.value()));
+  else
+    model.unsetHighlightColor();
+
+  transmitInfo = state.transmitInfo;
+
+  // The points before `state` are not known,
+  // so start the trail over
+  trailBuffer.clear();
+
+  for (const auto vertex : wiredLinkVertices) {
+    wiredLinks->set(vertex, getCenter());
+  }
 }
 
 } // namespace netsimulyzer
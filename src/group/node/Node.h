@@ -35,10 +35,12 @@
 
 #include "../../render/model/Model.h"
 #include "../../util/undo-events.h"
-#include "src/group/link/WiredLink.h"
+#include "src/group/link/WiredLinkBatch.h"
 #include "src/group/node/TrailBuffer.h"
 #include "src/render/font/FontManager.h"
 #include <QOpenGLFunctions_3_3_Core>
+#include <array>
+#include <cstdint>
 #include <glm/glm.hpp>
 #include <model.h>
 #include <optional>
@@ -50,47 +52,163 @@ class Node {
 public:
   struct TransmitInfo {
     bool isTransmitting{false};
-    parser::nanoseconds startTime;
+    parser::nanoseconds startTime{0LL};
     double targetSize{2.0};
-    parser::nanoseconds duration;
-    glm::vec3 color;
+    parser::nanoseconds duration{0LL};
+    glm::vec3 color{0.0f};
+  };
+
+  /**
+   * The parts of a Node changed by events.
+   * Used to restore a Node to an earlier/later point in time
+   * without applying each event in between
+   */
+  struct State {
+    /**
+     * Position in ns-3 coordinates
+     */
+    parser::Ns3Coordinate position;
+
+    /**
+     * Rotation as passed to `Model::setRotate()`
+     */
+    std::array<float, 3> rotation{0.0f};
+
+    std::optional<parser::Ns3Color3> baseColor;
+    std::optional<parser::Ns3Color3> highlightColor;
+    TransmitInfo transmitInfo;
   };
 
 private:
   Model model;
-  parser::Node ns3Node;
+
+  /**
+   * The description of the Node from the scenario,
+   * held in the `parser::StaticModels` shared by the scene & widgets
+   */
+  const parser::Node &ns3Node;
+
+  /**
+   * The current position, in ns-3 coordinates.
+   * Starts at the position in `ns3Node`
+   */
+  parser::Ns3Coordinate ns3Position;
   glm::vec3 offset;
   TrailBuffer trailBuffer;
   glm::vec3 trailColor;
-  std::vector<WiredLink *> wiredLinks;
+  WiredLinkBatch *wiredLinks{nullptr};
+
+  /**
+   * The vertices in `wiredLinks` at this Node
+   */
+  std::vector<std::uint32_t> wiredLinkVertices;
   TransmitInfo transmitInfo;
   FontManager::FontBannerRenderInfo bannerRenderInfo;
 
 public:
-  Node(const Model &model, parser::Node ns3Node, TrailBuffer &&trailBuffer, const FontManager::FontBannerRenderInfo &bannerRenderInfo);
+  /**
+   * @param ns3Node
+   * The description of the Node. Must outlive the Node
+   */
+  Node(const Model &model, const parser::Node &ns3Node, TrailBuffer &&trailBuffer,
+       const FontManager::FontBannerRenderInfo &bannerRenderInfo);
   [[nodiscard]] const Model &getModel() const;
+
+  /**
+   * Give the model the bounds of the model swapped in by `ModelCache::poll()`
+   *
+   * @param bounds
+   * The bounds of the loaded model
+   */
+  void setModelBounds(const Model::ModelBounds &bounds);
   [[nodiscard]] const parser::Node &getNs3Model() const;
+
+  /**
+   * @return
+   * The current position of the Node, in ns-3 coordinates
+   */
+  [[nodiscard]] const parser::Ns3Coordinate &getNs3Position() const;
   [[nodiscard]] bool visible() const;
   [[nodiscard]] glm::vec3 getCenter() const;
   [[nodiscard]] glm::vec3 getTop() const;
+
+  /**
+   * Where a `MoveEvent` to `position` would place the model
+   *
+   * @param position
+   * The ns-3 position to convert
+   *
+   * @return
+   * The position, in render coordinates
+   */
+  [[nodiscard]] glm::vec3 renderPosition(const parser::Ns3Coordinate &position) const;
   [[nodiscard]] const TransmitInfo &getTransmitInfo() const;
   [[nodiscard]] const TrailBuffer &getTrailBuffer() const;
+
+  /**
+   * Take storage for the motion trail from `pool`, starting it empty.
+   * Moves are only recorded on the trail once it is allocated.
+   * Requires a current context
+   *
+   * @param pool
+   * The pool to take the storage from
+   */
+  void allocateTrail(TrailPool &pool);
+
+  /**
+   * Give the trail's storage back, dropping its points
+   */
+  void releaseTrail();
+
+  /**
+   * Add a point to the end of the trail, without moving the Node.
+   * For rebuilding an allocated trail from earlier moves
+   *
+   * @param point
+   * The point to add, in render coordinates
+   */
+  void appendTrail(const glm::vec3 &point);
+
+  /**
+   * Remove every point from the trail, keeping its storage
+   */
+  void clearTrail();
+
+  /**
+   * Upload the trail points added by moves since the last flush.
+   * Requires a current context
+   */
+  void flushTrail();
   [[nodiscard]] const glm::vec3 &getTrailColor() const;
   [[nodiscard]] const FontManager::FontBannerRenderInfo &getBannerRenderInfo() const;
 
-  void addWiredLink(WiredLink *link);
+  void addWiredLink(WiredLinkBatch *batch, std::uint32_t vertex);
 
-  undo::MoveEvent handle(const parser::MoveEvent &e);
-  undo::TransmitEvent handle(const parser::TransmitEvent &e);
-  undo::TransmitEndEvent handle(const parser::TransmitEndEvent &e);
-  undo::NodeOrientationChangeEvent handle(const parser::NodeOrientationChangeEvent &e);
-  undo::NodeColorChangeEvent handle(const parser::NodeColorChangeEvent &e);
+  /**
+   * @return
+   * True if any wired link is drawn to this Node, so it follows the Node's moves
+   */
+  [[nodiscard]] bool hasWiredLinks() const;
+
+  void handle(const parser::MoveEvent &e);
+  void handle(const parser::TransmitEvent &e);
+  void handle(const parser::TransmitEndEvent &e);
+  void handle(const parser::NodeOrientationChangeEvent &e);
+  void handle(const parser::NodeColorChangeEvent &e);
 
   void handle(const undo::MoveEvent &e);
   void handle(const undo::TransmitEvent &e);
-  void handle(const undo::TransmitEndEvent &e);
   void handle(const undo::NodeOrientationChangeEvent &e);
   void handle(const undo::NodeColorChangeEvent &e);
+
+  /**
+   * Move the node to the state in `state`.
+   * The motion trail is restarted from the new position
+   *
+   * @param state
+   * The state to restore
+   */
+  void restore(const State &state);
 };
 
 } // namespace netsimulyzer
@@ -0,0 +1,179 @@
+/*
+ * NIST-developed software is provided by NIST as a public service. You may use,
+ * copy and distribute copies of the software in any medium, provided that you
+ * keep intact this entire notice. You may improve,modify and create derivative
+ * works of the software or any portion of the software, and you may copy and
+ * distribute such modifications or works. Modified works should carry a notice
+ * stating that you changed the software and should note the date and nature of
+ * any such change. Please explicitly acknowledge the National Institute of
+ * Standards and Technology as the source of the software.
+ *
+ * NIST-developed software is expressly provided "AS IS." NIST MAKES NO
+ * WARRANTY OF ANY KIND, EXPRESS, IMPLIED, IN FACT OR ARISING BY OPERATION OF
+ * LAW, INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTY OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, NON-INFRINGEMENT
+ * AND DATA ACCURACY. NIST NEITHER REPRESENTS NOR WARRANTS THAT THE
+ * OPERATION OF THE SOFTWARE WILL BE UNINTERRUPTED OR ERROR-FREE, OR THAT
+ * ANY DEFECTS WILL BE CORRECTED. NIST DOES NOT WARRANT OR MAKE ANY
+ * REPRESENTATIONS REGARDING THE USE OF THE SOFTWARE OR THE RESULTS THEREOF,
+ * INCLUDING BUT NOT LIMITED TO THE CORRECTNESS, ACCURACY, RELIABILITY,
+ * OR USEFULNESS OF THE SOFTWARE.
+ *
+ * You are solely responsible for determining the appropriateness of using and
+ * distributing the software and you assume all risks associated with its use,
+ * including but not limited to the risks and costs of program errors,
+ * compliance with applicable laws, damage to or loss of data, programs or
+ * equipment, and the unavailability or interruption of operation. This
+ * software is not intended to be used in any situation where a failure could
+ * cause risk of injury or damage to property. The software developed by NIST
+ * employees is not subject to copyright protection within the United States.
+ *
+ * Author: Evan Black <evan.black@nist.gov>
+ */
+
+
+#include "NodeStore.h"
+#include <algorithm>
+#include <utility>
+
+namespace netsimulyzer {
+
+void NodeStore::clear() {
+  ids.clear();
+  modelIds.clear();
+  modelMatrices.clear();
+  positions.clear();
+  bounds.clear();
+  baseColors.clear();
+  highlightColors.clear();
+  motions.clear();
+  flags.clear();
+  nodes.clear();
+  dirty.clear();
+  isDirty.clear();
+}
+
+void NodeStore::markDirty(std::size_t index) {
+  if (isDirty[index])
+    return;
+
+  isDirty[index] = true;
+  dirty.emplace_back(static_cast<std::uint32_t>(index));
+}
+
+std::size_t NodeStore::add(Node &node) {
+  const auto &ns3Node = node.getNs3Model();
+  const auto &model = node.getModel();
+
+  ids.emplace_back(ns3Node.id);
+  modelIds.emplace_back(model.getModelId());
+  modelMatrices.emplace_back(model.getModelMatrix());
+  positions.emplace_back(model.getPosition());
+  bounds.emplace_back(model.getBounds());
+  baseColors.emplace_back(model.getBaseColor());
+  highlightColors.emplace_back(model.getHighlightColor());
+  motions.emplace_back();
+
+  std::uint8_t nodeFlags = 0u;
+  if (node.visible())
+    nodeFlags |= Flags::Visible;
+  if (ns3Node.trailEnabled)
+    nodeFlags |= Flags::TrailEnabled;
+  if (ns3Node.labelEnabled)
+    nodeFlags |= Flags::LabelEnabled;
+  flags.emplace_back(nodeFlags);
+
+  nodes.emplace_back(&node);
+  isDirty.emplace_back(false);
+  markDirty(nodes.size() - 1u);
+  return nodes.size() - 1u;
+}
+
+void NodeStore::update(std::size_t index) {
+  // Only the model is changed by events, or by a model finishing its load
+  const auto &model = nodes[index]->getModel();
+
+  modelMatrices[index] = model.getModelMatrix();
+  bounds[index] = model.getBounds();
+  positions[index] = model.getPosition();
+  baseColors[index] = model.getBaseColor();
+  highlightColors[index] = model.getHighlightColor();
+  markDirty(index);
+}
+
+void NodeStore::updateAll() {
+  for (std::size_t i = 0u; i < nodes.size(); i++)
+    update(i);
+}
+
+void NodeStore::setMotion(std::size_t index, const Motion &motion) {
+  motions[index] = motion;
+  markDirty(index);
+}
+
+std::vector<std::uint32_t> NodeStore::takeDirty() {
+  for (const auto index : dirty)
+    isDirty[index] = false;
+  return std::exchange(dirty, {});
+}
+
+std::size_t NodeStore::size() const {
+  return nodes.size();
+}
+
+unsigned int NodeStore::getId(std::size_t index) const {
+  return ids[index];
+}
+
+model_id NodeStore::getModelId(std::size_t index) const {
+  return modelIds[index];
+}
+
+const glm::mat4 &NodeStore::getModelMatrix(std::size_t index) const {
+  return modelMatrices[index];
+}
+
+const glm::vec3 &NodeStore::getPosition(std::size_t index) const {
+  return positions[index];
+}
+
+const Model::ModelBounds &NodeStore::getBounds(std::size_t index) const {
+  return bounds[index];
+}
+
+const std::optional<glm::vec3> &NodeStore::getBaseColor(std::size_t index) const {
+  return baseColors[index];
+}
+
+const std::optional<glm::vec3> &NodeStore::getHighlightColor(std::size_t index) const {
+  return highlightColors[index];
+}
+
+const NodeStore::Motion &NodeStore::getMotion(std::size_t index) const {
+  return motions[index];
+}
+
+glm::vec3 NodeStore::motionOffset(std::size_t index, parser::nanoseconds time) const {
+  const auto &motion = motions[index];
+  if (motion.end <= motion.start || time <= motion.start)
+    return glm::vec3{0.0f};
+
+  // Matches the vertex shader, which clamps at the waypoint
+  const auto progress = std::min(1.0, static_cast<double>(time - motion.start) /
+                                          static_cast<double>(motion.end - motion.start));
+  return motion.offset * static_cast<float>(progress);
+}
+
+bool NodeStore::has(std::size_t index, std::uint8_t flag) const {
+  return (flags[index] & flag) == flag;
+}
+
+Node &NodeStore::getNode(std::size_t index) {
+  return *nodes[index];
+}
+
+const Node &NodeStore::getNode(std::size_t index) const {
+  return *nodes[index];
+}
+
+} // namespace netsimulyzer
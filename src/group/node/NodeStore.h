@@ -0,0 +1,202 @@
+/*
+ * NIST-developed software is provided by NIST as a public service. You may use,
+ * copy and distribute copies of the software in any medium, provided that you
+ * keep intact this entire notice. You may improve,modify and create derivative
+ * works of the software or any portion of the software, and you may copy and
+ * distribute such modifications or works. Modified works should carry a notice
+ * stating that you changed the software and should note the date and nature of
+ * any such change. Please explicitly acknowledge the National Institute of
+ * Standards and Technology as the source of the software.
+ *
+ * NIST-developed software is expressly provided "AS IS." NIST MAKES NO
+ * WARRANTY OF ANY KIND, EXPRESS, IMPLIED, IN FACT OR ARISING BY OPERATION OF
+ * LAW, INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTY OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, NON-INFRINGEMENT
+ * AND DATA ACCURACY. NIST NEITHER REPRESENTS NOR WARRANTS THAT THE
+ * OPERATION OF THE SOFTWARE WILL BE UNINTERRUPTED OR ERROR-FREE, OR THAT
+ * ANY DEFECTS WILL BE CORRECTED. NIST DOES NOT WARRANT OR MAKE ANY
+ * REPRESENTATIONS REGARDING THE USE OF THE SOFTWARE OR THE RESULTS THEREOF,
+ * INCLUDING BUT NOT LIMITED TO THE CORRECTNESS, ACCURACY, RELIABILITY,
+ * OR USEFULNESS OF THE SOFTWARE.
+ *
+ * You are solely responsible for determining the appropriateness of using and
+ * distributing the software and you assume all risks associated with its use,
+ * including but not limited to the risks and costs of program errors,
+ * compliance with applicable laws, damage to or loss of data, programs or
+ * equipment, and the unavailability or interruption of operation. This
+ * software is not intended to be used in any situation where a failure could
+ * cause risk of injury or damage to property. The software developed by NIST
+ * employees is not subject to copyright protection within the United States.
+ *
+ * Author: Evan Black <evan.black@nist.gov>
+ */
+
+
+#pragma once
+
+#include "src/group/node/Node.h"
+#include "src/render/model/Model.h"
+#include <cstddef>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <optional>
+#include <vector>
+
+namespace netsimulyzer {
+
+/**
+ * The state of each Node the render passes read,
+ * stored in contiguous arrays so the passes
+ * may walk every Node in order, rather than the `Node`s themselves.
+ *
+ * Nodes are stored by index, while the `Node`s
+ * remain the owners of everything else (trails, banners, links, etc.)
+ */
+class NodeStore {
+public:
+  enum Flags : std::uint8_t { Visible = 1u << 0u, TrailEnabled = 1u << 1u, LabelEnabled = 1u << 2u };
+
+  /**
+   * Straight line movement from the Node's position to its next waypoint,
+   * applied by the vertex shader from the time of the frame.
+   * A Node with `end <= start` does not move
+   */
+  struct Motion {
+    /**
+     * Distance to the next waypoint, in render coordinates
+     */
+    glm::vec3 offset{0.0f};
+    parser::nanoseconds start{0LL};
+    parser::nanoseconds end{0LL};
+  };
+
+private:
+  std::vector<unsigned int> ids;
+  std::vector<model_id> modelIds;
+  std::vector<glm::mat4> modelMatrices;
+
+  /**
+   * Position of the model, in render coordinates
+   */
+  std::vector<glm::vec3> positions;
+
+  /**
+   * Bounds of each model, before the model matrix is applied
+   */
+  std::vector<Model::ModelBounds> bounds;
+
+  std::vector<std::optional<glm::vec3>> baseColors;
+  std::vector<std::optional<glm::vec3>> highlightColors;
+  std::vector<Motion> motions;
+
+  /**
+   * `Flags` for each Node
+   */
+  std::vector<std::uint8_t> flags;
+
+  /**
+   * The Node at each index, for the rest of its state.
+   * Must outlive the store, or the next `clear()`
+   */
+  std::vector<Node *> nodes;
+
+  /**
+   * Indices changed since the last `takeDirty()`.
+   * Each index appears once, in the order it was changed
+   */
+  std::vector<std::uint32_t> dirty;
+
+  /**
+   * If each index is already in `dirty`
+   */
+  std::vector<bool> isDirty;
+
+  void markDirty(std::size_t index);
+
+public:
+  /**
+   * Remove every Node
+   */
+  void clear();
+
+  /**
+   * Add `node` to the end of the store
+   *
+   * @param node
+   * The Node to add, must outlive the store
+   *
+   * @return
+   * The index of `node`
+   */
+  std::size_t add(Node &node);
+
+  /**
+   * Copy the state of the Node at `index` back into the store.
+   * Should be called after every change to that Node
+   *
+   * @param index
+   * The index returned by `add()`
+   */
+  void update(std::size_t index);
+
+  /**
+   * Update every Node in the store
+   */
+  void updateAll();
+
+  /**
+   * Set how the Node at `index` moves toward its next waypoint
+   *
+   * @param index
+   * The index returned by `add()`
+   *
+   * @param motion
+   * The new movement, a default `Motion` to stay in place
+   */
+  void setMotion(std::size_t index, const Motion &motion);
+
+  /**
+   * Take the indices added or updated since the last call,
+   * so only those need to be copied elsewhere
+   *
+   * @return
+   * The changed indices, in the order they were changed
+   */
+  [[nodiscard]] std::vector<std::uint32_t> takeDirty();
+
+  [[nodiscard]] std::size_t size() const;
+
+  [[nodiscard]] unsigned int getId(std::size_t index) const;
+  [[nodiscard]] model_id getModelId(std::size_t index) const;
+  [[nodiscard]] const glm::mat4 &getModelMatrix(std::size_t index) const;
+  [[nodiscard]] const glm::vec3 &getPosition(std::size_t index) const;
+  [[nodiscard]] const Model::ModelBounds &getBounds(std::size_t index) const;
+  [[nodiscard]] const std::optional<glm::vec3> &getBaseColor(std::size_t index) const;
+  [[nodiscard]] const std::optional<glm::vec3> &getHighlightColor(std::size_t index) const;
+  [[nodiscard]] const Motion &getMotion(std::size_t index) const;
+
+  /**
+   * How far the Node at `index` has moved from its position along its `Motion`
+   *
+   * @param index
+   * The index returned by `add()`
+   *
+   * @param time
+   * The simulation time to find the offset at
+   *
+   * @return
+   * The offset, in render coordinates
+   */
+  [[nodiscard]] glm::vec3 motionOffset(std::size_t index, parser::nanoseconds time) const;
+
+  /**
+   * @return
+   * True if the Node at `index` has every flag in `flag`
+   */
+  [[nodiscard]] bool has(std::size_t index, std::uint8_t flag) const;
+
+  [[nodiscard]] Node &getNode(std::size_t index);
+  [[nodiscard]] const Node &getNode(std::size_t index) const;
+};
+
+} // namespace netsimulyzer
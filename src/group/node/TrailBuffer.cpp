@@ -33,78 +33,136 @@
 
 #include "TrailBuffer.h"
 #include <algorithm>
+#include <array>
 #include <utility>
 
 namespace netsimulyzer {
 
-TrailBuffer::TrailBuffer(QOpenGLFunctions_3_3_Core *openGl, unsigned int vao, unsigned int vbo, int initialSize,
-                         int vertexSize) noexcept
-    : openGl{openGl}, vao{vao}, vbo{vbo}, bufferSize{initialSize}, vertexSize{vertexSize}, buffer(bufferSize) {
+TrailBuffer::TrailBuffer(int size) noexcept : bufferSize{size} {
 }
 
 TrailBuffer::TrailBuffer(TrailBuffer &&other) noexcept
-    : openGl{other.openGl}, vao{other.vao}, vbo{other.vbo}, bufferSize{other.bufferSize},
-      vertexSize{other.vertexSize}, index{other.index}, _empty{other._empty}, buffer{std::move(other.buffer)} {
-  // Clear these, so the `other` deconstructor doesn't delete our moved buffers
-  other.vao = 0u;
-  other.vbo = 0u;
+    : pool{other.pool}, slot{other.slot}, bufferSize{other.bufferSize}, start{other.start}, count{other.count},
+      points{std::move(other.points)}, firstUnflushed{other.firstUnflushed}, unflushed{other.unflushed} {
+  // Clear these, so the `other` deconstructor doesn't release our slot
+  other.pool = nullptr;
+  other.slot = -1;
 }
 
 TrailBuffer::~TrailBuffer() {
-  openGl->glDeleteBuffers(1, &vbo);
-  openGl->glDeleteVertexArrays(1, &vao);
+  release();
 }
 
-void TrailBuffer::bind() const {
-  openGl->glBindVertexArray(vao);
-  openGl->glBindBuffer(GL_ARRAY_BUFFER, vbo);
+void TrailBuffer::allocate(TrailPool &trailPool) {
+  release();
+  pool = &trailPool;
+  slot = trailPool.acquire();
+  points.resize(static_cast<std::size_t>(bufferSize) + 1u);
+}
+
+void TrailBuffer::release() {
+  if (pool)
+    pool->release(slot);
+
+  pool = nullptr;
+  slot = -1;
+  points = std::vector<TrailVertex>{};
+  clear();
+}
+
+bool TrailBuffer::allocated() const noexcept {
+  return pool != nullptr;
 }
 
 void TrailBuffer::render() const {
-  if (empty())
+  // The trail is drawn up to, but not including, the newest point
+  const auto drawn = count - 1;
+  if (!pool || drawn < 1)
     return;
 
-  bind();
-  openGl->glDrawArrays(GL_LINE_STRIP, 0, index);
+  const auto firstLength = std::min(drawn, bufferSize - start);
+  if (firstLength == drawn) {
+    pool->draw(slot, &start, &drawn, 1);
+  } else {
+    // Wrapped around the end. The first range ends on the copy of the first vertex,
+    // where the second range starts, so the two join up
+    const std::array<int, 2> firsts{start, 0};
+    const std::array<int, 2> counts{firstLength + 1, drawn - firstLength};
+    pool->draw(slot, firsts.data(), counts.data(), static_cast<int>(firsts.size()));
+  }
 }
 
 void TrailBuffer::append(float x, float y, float z) {
-  if (index == bufferSize - 1) {
-    std::rotate(buffer.begin(), buffer.begin() + 1, buffer.end());
+  if (!pool)
+    return;
 
-    buffer[index].x = x;
-    buffer[index].y = y;
-    buffer[index].z = z;
+  const auto position = (start + count) % bufferSize;
 
-  } else {
-    if (_empty)
-      _empty = false;
-    else
-      index++;
-
-    buffer[index].x = x;
-    buffer[index].y = y;
-    buffer[index].z = z;
-  }
+  // Once full, the new point replaces the oldest
+  if (count < bufferSize)
+    count++;
+  else
+    start = (start + 1) % bufferSize;
 
-  openGl->glBindVertexArray(vao);
-  openGl->glBindBuffer(GL_ARRAY_BUFFER, vbo);
-  openGl->glBufferSubData(GL_ARRAY_BUFFER, 0, vertexSize * (index + 1), buffer.data());
+  const TrailVertex vertex{x, y, z};
+  points[position] = vertex;
+  if (position == 0)
+    points[bufferSize] = vertex;
+
+  // Appends are always to the position after the last,
+  // so the unflushed points are one run in the ring
+  if (unflushed == 0)
+    firstUnflushed = position;
+  unflushed = std::min(unflushed + 1, bufferSize);
 }
 
-void TrailBuffer::pop() {
-  if (_empty)
+void TrailBuffer::flush() {
+  if (!pool || unflushed == 0)
     return;
 
-  index--;
-  if (index == -1) {
-    _empty = true;
-    index = 0;
+  if (unflushed == bufferSize) {
+    pool->upload(slot, 0, bufferSize + 1, points.data());
+    unflushed = 0;
+    return;
   }
+
+  const auto end = firstUnflushed + unflushed;
+  const auto firstLength = std::min(end, bufferSize) - firstUnflushed;
+  pool->upload(slot, firstUnflushed, firstLength, &points[firstUnflushed]);
+
+  // Wrapped around the end
+  if (end > bufferSize)
+    pool->upload(slot, 0, end - bufferSize, points.data());
+
+  // Keep the copy of the first vertex in step
+  if (firstUnflushed == 0 || end > bufferSize)
+    pool->upload(slot, bufferSize, 1, &points[bufferSize]);
+
+  unflushed = 0;
+}
+
+void TrailBuffer::pop() {
+  if (count > 0)
+    count--;
+
+  // The next append writes the popped position again.
+  // A full ring is uploaded whole either way
+  if (unflushed > 0 && unflushed < bufferSize)
+    unflushed--;
+}
+
+void TrailBuffer::clear() {
+  start = 0;
+  count = 0;
+  unflushed = 0;
 }
 
 bool TrailBuffer::empty() const noexcept {
-  return _empty;
+  return count == 0;
+}
+
+bool TrailBuffer::full() const noexcept {
+  return bufferSize > 0 && count == bufferSize;
 }
 
 } // namespace netsimulyzer
@@ -33,8 +33,7 @@
 
 #pragma once
 
-#include "src/render/shader/Shader.h"
-#include <QOpenGLFunctions_3_3_Core>
+#include "TrailPool.h"
 #include <vector>
 
 namespace netsimulyzer {
@@ -43,57 +42,107 @@ namespace netsimulyzer {
  * Class that stores the list of locations
  * a Node has visited. Once full, the oldest
  * points 'fall off' the front,
- * first in first out style
+ * first in first out style.
+ *
+ * The points are kept in a ring, in a slot of a `TrailPool` on the GPU.
+ * The slot & the copy of the points are only taken by `allocate()`,
+ * until then moves are not recorded.
+ * Appends are staged in `points`, and uploaded by `flush()`,
+ * so a burst of moves costs one upload per trail, not one per point
  */
 class TrailBuffer {
-  // Make sure there is no padding is in this struct
-#pragma pack(push, 4)
-  struct TrailVertex {
-    float x;
-    float y;
-    float z;
-  };
-#pragma pack(pop)
-
-  QOpenGLFunctions_3_3_Core *openGl;
-  unsigned int vao{0u};
-  unsigned int vbo{0u};
+  using TrailVertex = TrailPool::Vertex;
+
+  /**
+   * The pool holding the slot, or null if the trail is not allocated
+   */
+  TrailPool *pool{nullptr};
+  int slot{-1};
 
   /**
-   * Total size of the internal buffer
-   * in elements
+   * The most points the trail holds.
+   * The slot has one more vertex, a copy of the first,
+   * so a trail which wraps around the end stays one line
    */
   int bufferSize{0};
 
   /**
-   * Size of each vertex in bytes
+   * The position of the oldest point in the buffer
+   */
+  int start{0};
+
+  /**
+   * The number of points in the buffer
    */
-  const int vertexSize;
+  int count{0};
 
   /**
-   * The current position in the buffer
+   * A copy of the slot, including the copy of the first vertex.
+   * Empty until allocated
    */
-  int index{0};
+  std::vector<TrailVertex> points;
 
   /**
-   * FLag indicating that no points are in the buffer
+   * The position of the first point appended since the last `flush()`
    */
-  bool _empty{true};
+  int firstUnflushed{0};
 
   /**
-   * Application side buffer containing the appended points
+   * The number of points appended since the last `flush()`.
+   * At most `bufferSize`, when the whole ring must be uploaded
    */
-  std::vector<TrailVertex> buffer;
+  int unflushed{0};
 
 public:
-  explicit TrailBuffer(QOpenGLFunctions_3_3_Core *openGl, unsigned int vao, unsigned int vbo, int initialSize,
-                       int vertexSize) noexcept;
+  /**
+   * @param size
+   * The most points the trail holds
+   */
+  explicit TrailBuffer(int size) noexcept;
   TrailBuffer(TrailBuffer &&other) noexcept;
   ~TrailBuffer();
-  void bind() const;
+
+  /**
+   * Take a slot from `trailPool`, with an empty trail.
+   * Requires a current context
+   *
+   * @param trailPool
+   * The pool to take the slot from. Must outlive the trail,
+   * or `release()` must be called before the pool is reset
+   */
+  void allocate(TrailPool &trailPool);
+
+  /**
+   * Give the slot back & drop the points
+   */
+  void release();
+  [[nodiscard]] bool allocated() const noexcept;
+
   void render() const;
+
+  /**
+   * Add a point, replacing the oldest once full.
+   * Ignored unless allocated
+   */
   void append(float x, float y, float z);
   void pop();
+
+  /**
+   * Upload the points appended since the last flush.
+   * Call before `render()`
+   */
+  void flush();
+
+  /**
+   * Remove every point from the trail
+   */
+  void clear();
   [[nodiscard]] bool empty() const noexcept;
+
+  /**
+   * @return
+   * True once appending replaces the oldest point
+   */
+  [[nodiscard]] bool full() const noexcept;
 };
 } // namespace netsimulyzer
@@ -0,0 +1,160 @@
+/*
+ * NIST-developed software is provided by NIST as a public service. You may use,
+ * copy and distribute copies of the software in any medium, provided that you
+ * keep intact this entire notice. You may improve,modify and create derivative
+ * works of the software or any portion of the software, and you may copy and
+ * distribute such modifications or works. Modified works should carry a notice
+ * stating that you changed the software and should note the date and nature of
+ * any such change. Please explicitly acknowledge the National Institute of
+ * Standards and Technology as the source of the software.
+ *
+ * NIST-developed software is expressly provided "AS IS." NIST MAKES NO
+ * WARRANTY OF ANY KIND, EXPRESS, IMPLIED, IN FACT OR ARISING BY OPERATION OF
+ * LAW, INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTY OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, NON-INFRINGEMENT
+ * AND DATA ACCURACY. NIST NEITHER REPRESENTS NOR WARRANTS THAT THE
+ * OPERATION OF THE SOFTWARE WILL BE UNINTERRUPTED OR ERROR-FREE, OR THAT
+ * ANY DEFECTS WILL BE CORRECTED. NIST DOES NOT WARRANT OR MAKE ANY
+ * REPRESENTATIONS REGARDING THE USE OF THE SOFTWARE OR THE RESULTS THEREOF,
+ * INCLUDING BUT NOT LIMITED TO THE CORRECTNESS, ACCURACY, RELIABILITY,
+ * OR USEFULNESS OF THE SOFTWARE.
+ *
+ * You are solely responsible for determining the appropriateness of using and
+ * distributing the software and you assume all risks associated with its use,
+ * including but not limited to the risks and costs of program errors,
+ * compliance with applicable laws, damage to or loss of data, programs or
+ * equipment, and the unavailability or interruption of operation. This
+ * software is not intended to be used in any situation where a failure could
+ * cause risk of injury or damage to property. The software developed by NIST
+ * employees is not subject to copyright protection within the United States.
+ *
+ * Author: Evan Black <evan.black@nist.gov>
+ */
+
+#include "TrailPool.h"
+#include "src/render/render-stats.h"
+#include "src/render/renderer/GlState.h"
+#include "src/render/renderer/UploadRing.h"
+#include <algorithm>
+#include <array>
+#include <cassert>
+
+namespace netsimulyzer {
+
+void TrailPool::grow(int slots) {
+  // One extra vertex per slot, for the copy of the first vertex `TrailBuffer` keeps at the end
+  const auto slotBytes = static_cast<GLsizeiptr>(sizeof(Vertex)) * (trailLength + 1);
+
+  // Trails staged for the old buffer must reach it before it is copied
+  uploadRing.flush();
+
+  unsigned int resized;
+  openGl->glGenBuffers(1, &resized);
+  glState.bindBuffer(GL_COPY_WRITE_BUFFER, resized);
+  openGl->glBufferData(GL_COPY_WRITE_BUFFER, slotBytes * slots, nullptr, GL_DYNAMIC_DRAW);
+
+  if (vbo != 0u) {
+    glState.bindBuffer(GL_COPY_READ_BUFFER, vbo);
+    openGl->glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, slotBytes * capacity);
+    glState.deleteBuffer(vbo);
+  }
+  vbo = resized;
+  capacity = slots;
+
+  if (vao == 0u)
+    openGl->glGenVertexArrays(1, &vao);
+  glState.bindVertexArray(vao);
+  glState.bindBuffer(GL_ARRAY_BUFFER, vbo);
+
+  // Location
+  openGl->glVertexAttribPointer(0u, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), nullptr);
+  openGl->glEnableVertexAttribArray(0u);
+}
+
+void TrailPool::destroy() {
+  uploadRing.flush();
+  glState.deleteBuffer(vbo);
+  glState.deleteVertexArray(vao);
+  vbo = 0u;
+  vao = 0u;
+  capacity = 0;
+  slotCount = 0;
+  freeSlots.clear();
+}
+
+TrailPool::~TrailPool() {
+  destroy();
+}
+
+void TrailPool::init(QOpenGLFunctions_3_3_Core *functions) {
+  openGl = functions;
+}
+
+void TrailPool::reset(int length) {
+  assert(used() == 0 && "Trails must be released before the pool is reset");
+
+  // Slots of the same length are kept for the next scenario, rather than grown into again
+  if (length == trailLength) {
+    slotCount = 0;
+    freeSlots.clear();
+    return;
+  }
+
+  destroy();
+  trailLength = length;
+}
+
+int TrailPool::acquire() {
+  if (!freeSlots.empty()) {
+    const auto slot = freeSlots.back();
+    freeSlots.pop_back();
+    return slot;
+  }
+
+  if (slotCount == capacity)
+    grow(std::max(64, capacity * 2));
+  return slotCount++;
+}
+
+void TrailPool::release(int slot) {
+  freeSlots.emplace_back(slot);
+}
+
+int TrailPool::getTrailLength() const noexcept {
+  return trailLength;
+}
+
+int TrailPool::firstVertex(int slot) const noexcept {
+  return slot * (trailLength + 1);
+}
+
+int TrailPool::used() const noexcept {
+  return slotCount - static_cast<int>(freeSlots.size());
+}
+
+void TrailPool::upload(int slot, int first, int count, const Vertex *vertices) {
+  uploadRing.write(vbo, sizeof(Vertex) * static_cast<std::size_t>(firstVertex(slot) + first), vertices,
+                   sizeof(Vertex) * static_cast<std::size_t>(count));
+}
+
+void TrailPool::draw(int slot, const int *firsts, const int *counts, int strips) {
+  glState.bindVertexArray(vao);
+
+  const auto base = firstVertex(slot);
+  if (strips == 1) {
+    openGl->glDrawArrays(GL_LINE_STRIP, base + firsts[0], counts[0]);
+  } else {
+    std::array<GLint, 2> offsetFirsts{};
+    assert(strips <= static_cast<int>(offsetFirsts.size()));
+    for (auto i = 0; i < strips; i++)
+      offsetFirsts[static_cast<std::size_t>(i)] = base + firsts[i];
+    openGl->glMultiDrawArrays(GL_LINE_STRIP, offsetFirsts.data(), counts, strips);
+  }
+  stats::frameCounters.drawCalls++;
+}
+
+std::size_t TrailPool::getGpuBytes() const noexcept {
+  return sizeof(Vertex) * static_cast<std::size_t>(trailLength + 1) * static_cast<std::size_t>(capacity);
+}
+
+} // namespace netsimulyzer
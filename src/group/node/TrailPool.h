@@ -0,0 +1,186 @@
+/*
+ * NIST-developed software is provided by NIST as a public service. You may use,
+ * copy and distribute copies of the software in any medium, provided that you
+ * keep intact this entire notice. You may improve,modify and create derivative
+ * works of the software or any portion of the software, and you may copy and
+ * distribute such modifications or works. Modified works should carry a notice
+ * stating that you changed the software and should note the date and nature of
+ * any such change. Please explicitly acknowledge the National Institute of
+ * Standards and Technology as the source of the software.
+ *
+ * NIST-developed software is expressly provided "AS IS." NIST MAKES NO
+ * WARRANTY OF ANY KIND, EXPRESS, IMPLIED, IN FACT OR ARISING BY OPERATION OF
+ * LAW, INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTY OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, NON-INFRINGEMENT
+ * AND DATA ACCURACY. NIST NEITHER REPRESENTS NOR WARRANTS THAT THE
+ * OPERATION OF THE SOFTWARE WILL BE UNINTERRUPTED OR ERROR-FREE, OR THAT
+ * ANY DEFECTS WILL BE CORRECTED. NIST DOES NOT WARRANT OR MAKE ANY
+ * REPRESENTATIONS REGARDING THE USE OF THE SOFTWARE OR THE RESULTS THEREOF,
+ * INCLUDING BUT NOT LIMITED TO THE CORRECTNESS, ACCURACY, RELIABILITY,
+ * OR USEFULNESS OF THE SOFTWARE.
+ *
+ * You are solely responsible for determining the appropriateness of using and
+ * distributing the software and you assume all risks associated with its use,
+ * including but not limited to the risks and costs of program errors,
+ * compliance with applicable laws, damage to or loss of data, programs or
+ * equipment, and the unavailability or interruption of operation. This
+ * software is not intended to be used in any situation where a failure could
+ * cause risk of injury or damage to property. The software developed by NIST
+ * employees is not subject to copyright protection within the United States.
+ *
+ * Author: Evan Black <evan.black@nist.gov>
+ */
+
+#pragma once
+
+#include <QOpenGLFunctions_3_3_Core>
+#include <cstddef>
+#include <vector>
+
+namespace netsimulyzer {
+
+/**
+ * One GPU buffer shared by every motion trail, split into equal slots.
+ *
+ * Slots are handed out as trails are first drawn, see `TrailBuffer::allocate()`,
+ * and reused once released, so Nodes which never show a trail hold no GPU memory.
+ * The buffer doubles when it runs out of slots
+ */
+class TrailPool {
+public:
+  // Make sure there is no padding is in this struct
+#pragma pack(push, 4)
+  struct Vertex {
+    float x;
+    float y;
+    float z;
+  };
+#pragma pack(pop)
+
+private:
+  QOpenGLFunctions_3_3_Core *openGl{nullptr};
+  unsigned int vao{0u};
+  unsigned int vbo{0u};
+
+  /**
+   * The most points in each trail.
+   * Each slot has one more vertex, see `TrailBuffer`
+   */
+  int trailLength{0};
+
+  /**
+   * The number of slots the buffer has room for
+   */
+  int capacity{0};
+
+  /**
+   * The number of slots ever handed out, including released ones
+   */
+  int slotCount{0};
+
+  /**
+   * Released slots, reused before new ones
+   */
+  std::vector<int> freeSlots;
+
+  /**
+   * Resize the buffer to `slots`, keeping the trails already in it
+   */
+  void grow(int slots);
+  void destroy();
+
+public:
+  TrailPool() = default;
+  TrailPool(const TrailPool &other) = delete;
+  TrailPool &operator=(const TrailPool &other) = delete;
+  ~TrailPool();
+
+  /**
+   * Requires a current context
+   */
+  void init(QOpenGLFunctions_3_3_Core *functions);
+
+  /**
+   * Make every slot free. The buffer is kept if `length` is unchanged,
+   * otherwise it is freed, and later slots are sized for trails of `length` points.
+   * Every trail must be released first
+   *
+   * @param length
+   * The most points in each trail
+   */
+  void reset(int length);
+
+  /**
+   * Take a slot, growing the buffer if there are none left. Requires a current context
+   *
+   * @return
+   * The slot taken
+   */
+  [[nodiscard]] int acquire();
+
+  /**
+   * Return a slot to be reused. Its contents are left as-is
+   */
+  void release(int slot);
+
+  /**
+   * @return
+   * The most points in each trail
+   */
+  [[nodiscard]] int getTrailLength() const noexcept;
+
+  /**
+   * @return
+   * The index of the first vertex of `slot` in the buffer
+   */
+  [[nodiscard]] int firstVertex(int slot) const noexcept;
+
+  /**
+   * @return
+   * The number of slots in use
+   */
+  [[nodiscard]] int used() const noexcept;
+
+  /**
+   * Stage vertices for a slot in `uploadRing`.
+   * They reach the buffer once it is flushed
+   *
+   * @param slot
+   * The slot to write to
+   *
+   * @param first
+   * The first vertex within the slot to write
+   *
+   * @param count
+   * The number of vertices to write
+   *
+   * @param vertices
+   * The vertices to write
+   */
+  void upload(int slot, int first, int count, const Vertex *vertices);
+
+  /**
+   * Draw one or more line strips from within a slot
+   *
+   * @param slot
+   * The slot to draw from
+   *
+   * @param firsts
+   * The first vertex of each strip, within the slot
+   *
+   * @param counts
+   * The number of vertices in each strip
+   *
+   * @param strips
+   * The number of strips
+   */
+  void draw(int slot, const int *firsts, const int *counts, int strips);
+
+  /**
+   * @return
+   * The size of the buffer on the GPU, in bytes
+   */
+  [[nodiscard]] std::size_t getGpuBytes() const noexcept;
+};
+
+} // namespace netsimulyzer
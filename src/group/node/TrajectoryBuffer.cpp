@@ -0,0 +1,144 @@
+/*
+ * NIST-developed software is provided by NIST as a public service. You may use,
+ * copy and distribute copies of the software in any medium, provided that you
+ * keep intact this entire notice. You may improve,modify and create derivative
+ * works of the software or any portion of the software, and you may copy and
+ * distribute such modifications or works. Modified works should carry a notice
+ * stating that you changed the software and should note the date and nature of
+ * any such change. Please explicitly acknowledge the National Institute of
+ * Standards and Technology as the source of the software.
+ *
+ * NIST-developed software is expressly provided "AS IS." NIST MAKES NO
+ * WARRANTY OF ANY KIND, EXPRESS, IMPLIED, IN FACT OR ARISING BY OPERATION OF
+ * LAW, INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTY OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, NON-INFRINGEMENT
+ * AND DATA ACCURACY. NIST NEITHER REPRESENTS NOR WARRANTS THAT THE
+ * OPERATION OF THE SOFTWARE WILL BE UNINTERRUPTED OR ERROR-FREE, OR THAT
+ * ANY DEFECTS WILL BE CORRECTED. NIST DOES NOT WARRANT OR MAKE ANY
+ * REPRESENTATIONS REGARDING THE USE OF THE SOFTWARE OR THE RESULTS THEREOF,
+ * INCLUDING BUT NOT LIMITED TO THE CORRECTNESS, ACCURACY, RELIABILITY,
+ * OR USEFULNESS OF THE SOFTWARE.
+ *
+ * You are solely responsible for determining the appropriateness of using and
+ * distributing the software and you assume all risks associated with its use,
+ * including but not limited to the risks and costs of program errors,
+ * compliance with applicable laws, damage to or loss of data, programs or
+ * equipment, and the unavailability or interruption of operation. This
+ * software is not intended to be used in any situation where a failure could
+ * cause risk of injury or damage to property. The software developed by NIST
+ * employees is not subject to copyright protection within the United States.
+ *
+ * Author: Evan Black <evan.black@nist.gov>
+ */
+
+#include "TrajectoryBuffer.h"
+#include "src/render/render-stats.h"
+#include "src/render/renderer/GlState.h"
+#include <algorithm>
+#include <cstddef>
+
+namespace netsimulyzer {
+
+void TrajectoryBuffer::destroy() {
+  glState.deleteBuffer(vbo);
+  glState.deleteVertexArray(vao);
+  vbo = 0u;
+  vao = 0u;
+  capacity = 0u;
+}
+
+TrajectoryBuffer::~TrajectoryBuffer() {
+  destroy();
+}
+
+void TrajectoryBuffer::init(QOpenGLFunctions_3_3_Core *functions) {
+  openGl = functions;
+}
+
+void TrajectoryBuffer::reset(std::size_t nodes) {
+  trajectories.clear();
+  trajectories.resize(nodes);
+  firsts.assign(nodes, 0);
+  dirty = false;
+}
+
+void TrajectoryBuffer::append(std::uint32_t slot, const glm::vec3 &position, float time) {
+  trajectories[slot].push_back({position.x, position.y, position.z, time});
+  dirty = true;
+}
+
+void TrajectoryBuffer::upload() {
+  if (!dirty)
+    return;
+  dirty = false;
+
+  // Every trajectory moves along as the ones before it grow, so the buffer is written whole
+  std::vector<Vertex> vertices;
+  vertices.reserve(memoryUsage() / sizeof(Vertex));
+  for (std::size_t i = 0u; i < trajectories.size(); i++) {
+    firsts[i] = static_cast<int>(vertices.size());
+    vertices.insert(vertices.end(), trajectories[i].begin(), trajectories[i].end());
+  }
+
+  if (vao == 0u) {
+    openGl->glGenVertexArrays(1, &vao);
+    openGl->glGenBuffers(1, &vbo);
+    glState.bindVertexArray(vao);
+    glState.bindBuffer(GL_ARRAY_BUFFER, vbo);
+
+    // Location
+    openGl->glVertexAttribPointer(0u, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), nullptr);
+    openGl->glEnableVertexAttribArray(0u);
+
+    // Time
+    openGl->glVertexAttribPointer(1u, 1, GL_FLOAT, GL_FALSE, sizeof(Vertex),
+                                  reinterpret_cast<void *>(offsetof(Vertex, time)));
+    openGl->glEnableVertexAttribArray(1u);
+  }
+
+  glState.bindBuffer(GL_ARRAY_BUFFER, vbo);
+  if (vertices.size() > capacity) {
+    // Grown ahead of the points still loading, so not every batch of them reallocates the buffer
+    capacity = std::max(vertices.size(), capacity * 2u);
+    openGl->glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(sizeof(Vertex) * capacity), nullptr,
+                         GL_STATIC_DRAW);
+  }
+  openGl->glBufferSubData(GL_ARRAY_BUFFER, 0, static_cast<GLsizeiptr>(sizeof(Vertex) * vertices.size()),
+                          vertices.data());
+  stats::frameCounters.bufferUploads++;
+}
+
+void TrajectoryBuffer::draw(std::uint32_t slot, float from, float to, bool toNext) {
+  const auto &points = trajectories[slot];
+  const auto byTime = [](float time, const Vertex &vertex) {
+    return time < vertex.time;
+  };
+
+  // From the last point reached before the span, to the last point reached within it
+  const auto start = std::upper_bound(points.begin(), points.end(), from, byTime);
+  auto end = std::upper_bound(start, points.end(), to, byTime);
+  if (toNext && end != points.end())
+    ++end;
+
+  const auto first = start == points.begin() ? start : start - 1;
+  const auto count = static_cast<int>(end - first);
+  if (count < 2)
+    return;
+
+  glState.bindVertexArray(vao);
+  openGl->glDrawArrays(GL_LINE_STRIP, firsts[slot] + static_cast<int>(first - points.begin()), count);
+  stats::frameCounters.drawCalls++;
+}
+
+std::size_t TrajectoryBuffer::memoryUsage() const noexcept {
+  std::size_t bytes = 0u;
+  for (const auto &points : trajectories)
+    bytes += sizeof(Vertex) * points.size();
+  return bytes;
+}
+
+std::size_t TrajectoryBuffer::getGpuBytes() const noexcept {
+  return sizeof(Vertex) * capacity;
+}
+
+} // namespace netsimulyzer
@@ -0,0 +1,172 @@
+/*
+ * NIST-developed software is provided by NIST as a public service. You may use,
+ * copy and distribute copies of the software in any medium, provided that you
+ * keep intact this entire notice. You may improve,modify and create derivative
+ * works of the software or any portion of the software, and you may copy and
+ * distribute such modifications or works. Modified works should carry a notice
+ * stating that you changed the software and should note the date and nature of
+ * any such change. Please explicitly acknowledge the National Institute of
+ * Standards and Technology as the source of the software.
+ *
+ * NIST-developed software is expressly provided "AS IS." NIST MAKES NO
+ * WARRANTY OF ANY KIND, EXPRESS, IMPLIED, IN FACT OR ARISING BY OPERATION OF
+ * LAW, INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTY OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, NON-INFRINGEMENT
+ * AND DATA ACCURACY. NIST NEITHER REPRESENTS NOR WARRANTS THAT THE
+ * OPERATION OF THE SOFTWARE WILL BE UNINTERRUPTED OR ERROR-FREE, OR THAT
+ * ANY DEFECTS WILL BE CORRECTED. NIST DOES NOT WARRANT OR MAKE ANY
+ * REPRESENTATIONS REGARDING THE USE OF THE SOFTWARE OR THE RESULTS THEREOF,
+ * INCLUDING BUT NOT LIMITED TO THE CORRECTNESS, ACCURACY, RELIABILITY,
+ * OR USEFULNESS OF THE SOFTWARE.
+ *
+ * You are solely responsible for determining the appropriateness of using and
+ * distributing the software and you assume all risks associated with its use,
+ * including but not limited to the risks and costs of program errors,
+ * compliance with applicable laws, damage to or loss of data, programs or
+ * equipment, and the unavailability or interruption of operation. This
+ * software is not intended to be used in any situation where a failure could
+ * cause risk of injury or damage to property. The software developed by NIST
+ * employees is not subject to copyright protection within the United States.
+ *
+ * Author: Evan Black <evan.black@nist.gov>
+ */
+
+#pragma once
+
+#include <QOpenGLFunctions_3_3_Core>
+#include <cstddef>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <vector>
+
+namespace netsimulyzer {
+
+/**
+ * Every position each Node moves to over the whole scenario, with the time it arrives there,
+ * in one static GPU buffer. An alternative to `TrailBuffer`, where a trail is the last span of time,
+ * rather than the last number of points.
+ *
+ * Each Node's trajectory is contiguous in the buffer,
+ * so a trail is one range of it, found by time, see `draw()`.
+ * The trajectory shader clips the ends of the range to the window,
+ * so seeking & changing the window only changes what is drawn, not what is uploaded.
+ * Points are only uploaded as they are loaded
+ */
+class TrajectoryBuffer {
+public:
+  // Make sure there is no padding is in this struct
+#pragma pack(push, 4)
+  struct Vertex {
+    float x;
+    float y;
+    float z;
+
+    /**
+     * The simulation time the Node reaches this point, in milliseconds,
+     * matching `motion_time` in the shaders
+     */
+    float time;
+  };
+#pragma pack(pop)
+
+private:
+  QOpenGLFunctions_3_3_Core *openGl{nullptr};
+  unsigned int vao{0u};
+  unsigned int vbo{0u};
+
+  /**
+   * The points of each Node, by slot, in time order
+   */
+  std::vector<std::vector<Vertex>> trajectories;
+
+  /**
+   * The first vertex in the buffer of each Node, by slot, as of the last `upload()`
+   */
+  std::vector<int> firsts;
+
+  /**
+   * The number of vertices the buffer has room for
+   */
+  std::size_t capacity{0u};
+
+  /**
+   * Set when points were added since the last `upload()`
+   */
+  bool dirty{false};
+
+  void destroy();
+
+public:
+  TrajectoryBuffer() = default;
+  TrajectoryBuffer(const TrajectoryBuffer &other) = delete;
+  TrajectoryBuffer &operator=(const TrajectoryBuffer &other) = delete;
+  ~TrajectoryBuffer();
+
+  /**
+   * Requires a current context
+   */
+  void init(QOpenGLFunctions_3_3_Core *functions);
+
+  /**
+   * Drop every point, keeping the buffer for the next scenario
+   *
+   * @param nodes
+   * The number of Node slots
+   */
+  void reset(std::size_t nodes);
+
+  /**
+   * Add the next point of a Node.
+   * Points of one Node must be added in time order
+   *
+   * @param slot
+   * The slot of the Node
+   *
+   * @param position
+   * The point, in render coordinates
+   *
+   * @param time
+   * The time the Node reaches `position`, in milliseconds
+   */
+  void append(std::uint32_t slot, const glm::vec3 &position, float time);
+
+  /**
+   * Upload every trajectory, if points were added since the last upload.
+   * Requires a current context
+   */
+  void upload();
+
+  /**
+   * Draw the part of a Node's trajectory between two times.
+   * The points just outside of the span are drawn as well,
+   * for the shader to clip the lines to them
+   *
+   * @param slot
+   * The slot of the Node
+   *
+   * @param from
+   * The start of the span, in milliseconds
+   *
+   * @param to
+   * The end of the span, in milliseconds
+   *
+   * @param toNext
+   * True to draw the line to the point after `to` as well,
+   * for Nodes moving towards it, rather than waiting at the last point to jump
+   */
+  void draw(std::uint32_t slot, float from, float to, bool toNext);
+
+  /**
+   * @return
+   * The size of the points kept in memory, in bytes
+   */
+  [[nodiscard]] std::size_t memoryUsage() const noexcept;
+
+  /**
+   * @return
+   * The size of the buffer on the GPU, in bytes
+   */
+  [[nodiscard]] std::size_t getGpuBytes() const noexcept;
+};
+
+} // namespace netsimulyzer
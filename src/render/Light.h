@@ -33,7 +33,6 @@
 
 #pragma once
 #include <glm/glm.hpp>
-#include <string>
 
 namespace netsimulyzer {
 
@@ -44,40 +43,33 @@ struct DirectionalLight {
   glm::vec3 direction{0.0f, -1.0f, 0.0f};
 };
 
-struct SpotLight {
-  glm::vec3 color{1.0f};
-  float ambientIntensity = 1.0f;
-  float diffuseIntensity = 0.0f;
-
+/**
+ * A light at a point, lighting what is within its range,
+ * or only what is within its cone, for a spot light.
+ * Laid out as three `vec4`s, the way `Renderer::uploadLights()` uploads it
+ */
+struct PointLight {
   glm::vec3 position{0.0f};
-  glm::vec3 direction{0.0f};
 
-  float constant = 1.0f;
-  float linear = 0.0f;
-  float exponent = 0.0f;
+  /**
+   * The distance at which the light fades to nothing
+   */
+  float range = 10.0f;
 
-  float edge = 0.0f;
-  float processedEdge{std::cos(glm::radians(edge))};
-
-  std::size_t index = SpotLight::count++;
-  std::string prefix = "spotLights[" + std::to_string(index) + "].";
-  static std::size_t count;
-};
-
-struct PointLight {
   glm::vec3 color{1.0f};
-  float ambientIntensity = 1.0f;
-  float diffuseIntensity = 0.0f;
+  float intensity = 1.0f;
 
-  glm::vec3 position{0.0f};
-
-  float constant = 1.0f;
-  float linear = 0.0f;
-  float exponent = 0.0f;
+  /**
+   * The way a spot light points
+   */
+  glm::vec3 direction{0.0f, -1.0f, 0.0f};
 
-  std::size_t index = PointLight::count++;
-  std::string prefix = "pointLights[" + std::to_string(index) + "].";
-  static std::size_t count;
+  /**
+   * The cosine of the angle from `direction` to the edge of a spot light's cone.
+   * -1 to light every way
+   */
+  float edge = -1.0f;
 };
+static_assert(sizeof(PointLight) == 3u * sizeof(glm::vec4), "PointLight must be three texels");
 
 } // namespace netsimulyzer
@@ -33,6 +33,7 @@
 
 #include "Camera.h"
 #include "src/settings/SettingsManager.h"
+#include <algorithm>
 #include <cmath>
 
 namespace netsimulyzer {
@@ -199,6 +200,12 @@ void Camera::mouse_move(float delta_x, float delta_y) {
   update();
 }
 
+bool Camera::isMoving() const {
+  return active.front_back != active_directions::direction::none ||
+         active.left_right != active_directions::side::none ||
+         active.upDown != active_directions::verticalDirection::none || active.turn != active_directions::side::none;
+}
+
 Camera::move_state Camera::getMobility() const {
   return mobility;
 }
@@ -227,6 +234,20 @@ void Camera::resetRotation() {
   update();
 }
 
+void Camera::setRotation(float yawDegrees, float pitchDegrees) {
+  yaw = yawDegrees;
+  pitch = std::clamp(pitchDegrees, -89.0f, 89.0f);
+  update();
+}
+
+float Camera::getYaw() const {
+  return yaw;
+}
+
+float Camera::getPitch() const {
+  return pitch;
+}
+
 int Camera::getKeyForward() const {
   return keyForward;
 }
@@ -136,12 +136,42 @@ public:
   void setMobility(move_state state);
 
   void move(float delta_time);
+
+  /**
+   * @return
+   * True while a movement or turn key is held,
+   * so `move()` would change the view
+   */
+  [[nodiscard]] bool isMoving() const;
   void mouse_move(float delta_x, float delta_y);
 
   [[nodiscard]] glm::vec3 get_position() const;
   void setPosition(const glm::vec3 &value);
 
   void resetRotation();
+
+  /**
+   * Point the camera in a direction, with the same limits as `mouse_move()`
+   *
+   * @param yawDegrees
+   * The turn around the Y axis. -90 looks down -Z
+   *
+   * @param pitchDegrees
+   * The turn up or down, clamped to [-89, 89]
+   */
+  void setRotation(float yawDegrees, float pitchDegrees);
+
+  /**
+   * @return
+   * The turn around the Y axis, in degrees, see `setRotation()`
+   */
+  [[nodiscard]] float getYaw() const;
+
+  /**
+   * @return
+   * The turn up or down, in degrees, see `setRotation()`
+   */
+  [[nodiscard]] float getPitch() const;
 };
 
 } // namespace netsimulyzer
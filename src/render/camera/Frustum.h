@@ -0,0 +1,91 @@
+/*
+ * NIST-developed software is provided by NIST as a public service. You may use,
+ * copy and distribute copies of the software in any medium, provided that you
+ * keep intact this entire notice. You may improve,modify and create derivative
+ * works of the software or any portion of the software, and you may copy and
+ * distribute such modifications or works. Modified works should carry a notice
+ * stating that you changed the software and should note the date and nature of
+ * any such change. Please explicitly acknowledge the National Institute of
+ * Standards and Technology as the source of the software.
+ *
+ * NIST-developed software is expressly provided "AS IS." NIST MAKES NO
+ * WARRANTY OF ANY KIND, EXPRESS, IMPLIED, IN FACT OR ARISING BY OPERATION OF
+ * LAW, INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTY OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, NON-INFRINGEMENT
+ * AND DATA ACCURACY. NIST NEITHER REPRESENTS NOR WARRANTS THAT THE
+ * OPERATION OF THE SOFTWARE WILL BE UNINTERRUPTED OR ERROR-FREE, OR THAT
+ * ANY DEFECTS WILL BE CORRECTED. NIST DOES NOT WARRANT OR MAKE ANY
+ * REPRESENTATIONS REGARDING THE USE OF THE SOFTWARE OR THE RESULTS THEREOF,
+ * INCLUDING BUT NOT LIMITED TO THE CORRECTNESS, ACCURACY, RELIABILITY,
+ * OR USEFULNESS OF THE SOFTWARE.
+ *
+ * You are solely responsible for determining the appropriateness of using and
+ * distributing the software and you assume all risks associated with its use,
+ * including but not limited to the risks and costs of program errors,
+ * compliance with applicable laws, damage to or loss of data, programs or
+ * equipment, and the unavailability or interruption of operation. This
+ * software is not intended to be used in any situation where a failure could
+ * cause risk of injury or damage to property. The software developed by NIST
+ * employees is not subject to copyright protection within the United States.
+ *
+ * Author: Evan Black <evan.black@nist.gov>
+ */
+
+
+#pragma once
+
+#include <array>
+#include <glm/glm.hpp>
+
+namespace netsimulyzer {
+
+/**
+ * The volume visible to a camera, as six planes
+ * facing into the volume
+ */
+class Frustum {
+public:
+  enum class Containment { Outside, Intersects, Inside };
+
+private:
+  /**
+   * Left, right, bottom, top, near, far.
+   * Each as a normal in xyz, and the distance in w
+   */
+  std::array<glm::vec4, 6> planes;
+
+public:
+  /**
+   * Extract the planes from a combined matrix
+   *
+   * @param projectionView
+   * The projection matrix multiplied by the view matrix
+   */
+  explicit Frustum(const glm::mat4 &projectionView);
+
+  /**
+   * Test how much of an axis aligned box is in the frustum.
+   * Conservative, boxes near the corners may intersect without
+   * actually being in view
+   *
+   * @param min
+   * The minimum corner of the box, in render coordinates
+   *
+   * @param max
+   * The maximum corner of the box, in render coordinates
+   */
+  [[nodiscard]] Containment contains(const glm::vec3 &min, const glm::vec3 &max) const;
+
+  /**
+   * Test if any of an axis aligned box may be in the frustum
+   *
+   * @param min
+   * The minimum corner of the box, in render coordinates
+   *
+   * @param max
+   * The maximum corner of the box, in render coordinates
+   */
+  [[nodiscard]] bool intersects(const glm::vec3 &min, const glm::vec3 &max) const;
+};
+
+} // namespace netsimulyzer
@@ -33,7 +33,9 @@
 
 #include "FontManager.h"
 #include "src/render/font/undefined-medium-font.h"
+#include "src/render/renderer/GlState.h"
 #include <algorithm>
+#include <cstddef>
 #include <iostream>
 
 namespace netsimulyzer {
@@ -46,6 +48,8 @@ FontManager::FontManager(TextureCache &textureCache) // NOLINT(cppcoreguidelines
 
 FontManager::~FontManager() {
   reset();
+  glState.deleteBuffer(vbo);
+  glState.deleteVertexArray(vao);
 }
 
 void FontManager::init(const std::string &atlasFilePath) {
@@ -61,35 +65,64 @@ void FontManager::init(const std::string &atlasFilePath) {
 
   atlasWidth = static_cast<float>(t.width);
   atlasHeight = static_cast<float>(t.height);
-}
-
-void FontManager::reset() {
-  for (const auto &font : createdFontMeshes) {
-    gl.glDeleteBuffers(1, &font.glyphVbo);
-    gl.glDeleteBuffers(1, &font.backgroundVbo);
 
-    gl.glDeleteVertexArrays(1, &font.glyphVao);
-    gl.glDeleteVertexArrays(1, &font.backgroundVao);
+  // The coordinates in the character are in pixels,
+  // so divide by the atlas size to get them in
+  // texture coordinates
+  const auto &unknown = undefined_medium::fontGlyphs.at(0);
+  for (auto i = 0u; i < glyphQuads.size(); i++) {
+    const auto found = undefined_medium::fontGlyphs.find(static_cast<char>(i));
+    const auto &ch = found == undefined_medium::fontGlyphs.end() ? unknown : found->second;
+
+    auto &quad = glyphQuads[i];
+    quad.offset = glm::vec2{ch.offset} * scale;
+    quad.size = glm::vec2{ch.size} * scale;
+    quad.low = {ch.x / atlasWidth, ch.y / atlasHeight};
+    quad.high = {(ch.x + ch.size.x) / atlasWidth, (ch.y + ch.size.y) / atlasHeight};
   }
 
-  createdFontMeshes.clear();
+  gl.glGenVertexArrays(1, &vao);
+  gl.glGenBuffers(1, &vbo);
+
+  glState.bindVertexArray(vao);
+  glState.bindBuffer(GL_ARRAY_BUFFER, vbo);
+
+  // Location
+  gl.glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(LabelVertex),
+                           reinterpret_cast<void *>(offsetof(LabelVertex, position)));
+  gl.glEnableVertexAttribArray(0);
+
+  // Texture
+  gl.glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(LabelVertex),
+                           reinterpret_cast<void *>(offsetof(LabelVertex, textureCoordinate)));
+  gl.glEnableVertexAttribArray(1);
+
+  // Label, for the anchor
+  gl.glVertexAttribIPointer(2, 1, GL_UNSIGNED_INT, sizeof(LabelVertex),
+                            reinterpret_cast<void *>(offsetof(LabelVertex, label)));
+  gl.glEnableVertexAttribArray(2);
+
+  glState.bindVertexArray(0u);
+}
+
+void FontManager::reset() {
+  // Keep the buffers, they're refilled by the next labels
+  backgroundVertices.clear();
+  glyphVertices.clear();
+  labels = 0u;
+  changed = true;
 }
 
 FontManager::FontBannerRenderInfo FontManager::allocate(std::string_view text) {
-  textureCache.use(atlasTexture);
   FontBannerRenderInfo renderInfo; // NOLINT(cppcoreguidelines-pro-type-member-init)
 
+  renderInfo.label = labels++;
   renderInfo.size = static_cast<int>(text.size());
-  renderInfo.glyphVboSize = renderInfo.size * 6; // 3 Vertices per triangle, 2 triangles per glyph
-  renderInfo.backgroundVboSize = 3 * 2;          // 3 Vertices per triangle, 2 triangles in the rectangle
+  changed = true;
 
-  // ----- Glyphs -----
-  // Fixed scale factor for the font + background
-  // smaller, since we render the font for the
-  // texture at a large size, so it looks okay
-  // even if it gets big
-  float scale = 0.50f;
+  const auto label = static_cast<unsigned int>(renderInfo.label);
 
+  // ----- Glyphs -----
   // All ASCII characters use the same advance value,
   // so we can use one value to produce an estimate for the
   // whole string
@@ -97,21 +130,9 @@ FontManager::FontBannerRenderInfo FontManager::allocate(std::string_view text) {
   const auto estimatedAdvance = 32.0f * scale;
   const auto startX = -1.0f * (estimatedAdvance * text.size()) / 2.0f;
 
-  gl.glGenVertexArrays(1, &renderInfo.glyphVao);
-  gl.glGenBuffers(1, &renderInfo.glyphVbo);
-
-  gl.glBindVertexArray(renderInfo.glyphVao);
-  gl.glBindBuffer(GL_ARRAY_BUFFER, renderInfo.glyphVbo);
-
-  gl.glBufferData(GL_ARRAY_BUFFER, sizeof(float) * 6 * 4 * text.size(), nullptr, GL_STATIC_DRAW);
-
-  // Location
-  gl.glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(float), nullptr);
-  gl.glEnableVertexAttribArray(0);
-
   // Loop through each character in the string,
-  // calculate the size, offsets, etc. for each glyph
-  // then, add the mesh for the glyph to `renderInfo.glyphVbo`
+  // place the precomputed quad for its glyph,
+  // then, add the mesh for the glyph to `glyphVertices`
   float maxX = 0.0f; // Max X/Y for the borders of the background
   float maxY = 0.0f;
   float minY = 0.0f;
@@ -120,86 +141,57 @@ FontManager::FontBannerRenderInfo FontManager::allocate(std::string_view text) {
   // Starting with `startX`, since we want to start
   // Halfway to the left, to center the text
   float x = startX;
-  float y = 0.0f;
-  // Index of the glyph
-  auto i = 0;
-  for (const auto &c : text) {
-    // use `at()` since there's no const `[]`
-    const auto &ch = undefined_medium::fontGlyphs.at(c);
-
-    // Starting position of the character
-    const float positionX = x + ch.offset.x * scale;
-    const float positionY = y + ch.offset.y * scale;
-
-    float characterWidth = ch.size.x * scale;
-    float characterHeight = ch.size.y * scale;
-
-    maxX = std::max(maxX, positionX + characterWidth);
-    maxY = std::max(maxY, positionY + characterHeight);
-    minY = std::min(minY, positionY);
-
-    // texture coordinates of the character
-    // on the atlas.
-    // The coordinates in the character are in pixels,
-    // so divide by the `atlasWidth` to get them in
-    // texture coordinates
-    const auto lowX = ch.x / atlasWidth;
-    const auto lowY = ch.y / atlasHeight;
-    const auto highX = (ch.x + ch.size.x) / atlasWidth;
-    const auto highY = (ch.y + ch.size.y) / atlasHeight;
+  glyphVertices.reserve(glyphVertices.size() + text.size() * 6u);
+  for (const auto c : text) {
+    const auto &quad = glyphQuads[static_cast<unsigned char>(c)];
+
+    // Corners of the character
+    const auto low = glm::vec2{x, 0.0f} + quad.offset;
+    const auto high = low + quad.size;
+
+    maxX = std::max(maxX, high.x);
+    maxY = std::max(maxY, high.y);
+    minY = std::min(minY, low.y);
 
     // clang-format off
-    float vertices[6][4] ={
-         {positionX,                  positionY + characterHeight,   lowX, lowY},
-         {positionX,                  positionY,                     lowX, highY},
-         {positionX + characterWidth, positionY,                     highX, highY},
-
-         {positionX,                  positionY + characterHeight,  lowX, lowY},
-         {positionX + characterWidth, positionY,                    highX, highY},
-         {positionX + characterWidth, positionY + characterHeight,  highX, lowY}
-        };
+    glyphVertices.insert(glyphVertices.end(), {
+         {{low.x,  high.y}, {quad.low.x,  quad.low.y},  label},
+         {{low.x,  low.y},  {quad.low.x,  quad.high.y}, label},
+         {{high.x, low.y},  {quad.high.x, quad.high.y}, label},
+
+         {{low.x,  high.y}, {quad.low.x,  quad.low.y},  label},
+         {{high.x, low.y},  {quad.high.x, quad.high.y}, label},
+         {{high.x, high.y}, {quad.high.x, quad.low.y},  label}
+        });
     // clang-format on
     x += estimatedAdvance;
-
-    gl.glBufferSubData(GL_ARRAY_BUFFER, sizeof(vertices) * i, sizeof(vertices), vertices);
-    i++;
   }
 
   // ----- Background -----
   // The background is one quad, rendered in black/grey
   // behind the glyphs
-  gl.glGenVertexArrays(1, &renderInfo.backgroundVao);
-  gl.glGenBuffers(1, &renderInfo.backgroundVbo);
-  gl.glBindVertexArray(renderInfo.backgroundVao);
-  gl.glBindBuffer(GL_ARRAY_BUFFER, renderInfo.backgroundVbo);
 
   // Grab the offset for the last character,
   // so we may get the correct right border for the background
-  const auto endOffset = undefined_medium::fontGlyphs.at(*(text.end() - 1)).offset.x * scale;
+  const auto endOffset = text.empty() ? 0.0f : glyphQuads[static_cast<unsigned char>(text.back())].offset.x;
 
   // Add/Subtract `estimatedAdvance` to give some extra
   // overhang to the background
+  renderInfo.min = {startX - estimatedAdvance, minY};
+  renderInfo.max = {maxX + endOffset + estimatedAdvance, maxY};
+
   // clang-format off
-  float bgVertices[6][2] = {
-      {startX           - estimatedAdvance, maxY},
-      {startX           - estimatedAdvance, minY},
-      {maxX + endOffset + estimatedAdvance, minY},
-
-      {startX           - estimatedAdvance, maxY},
-      {maxX + endOffset + estimatedAdvance, minY},
-      {maxX + endOffset + estimatedAdvance, maxY},
-  };
+  backgroundVertices.insert(backgroundVertices.end(), {
+      {{renderInfo.min.x, renderInfo.max.y}, {}, label},
+      {{renderInfo.min.x, renderInfo.min.y}, {}, label},
+      {{renderInfo.max.x, renderInfo.min.y}, {}, label},
+
+      {{renderInfo.min.x, renderInfo.max.y}, {}, label},
+      {{renderInfo.max.x, renderInfo.min.y}, {}, label},
+      {{renderInfo.max.x, renderInfo.max.y}, {}, label},
+  });
   // clang-format on
 
-  gl.glBufferData(GL_ARRAY_BUFFER, sizeof(float) * 6 * 2 * 6, bgVertices, GL_STATIC_DRAW);
-
-  // Location
-  gl.glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), nullptr);
-  gl.glEnableVertexAttribArray(0);
-
-  gl.glBindBuffer(GL_ARRAY_BUFFER, 0);
-  gl.glBindVertexArray(0);
-
   return renderInfo;
 }
 
@@ -207,4 +199,41 @@ texture_id FontManager::getAtlasTexture() const {
   return atlasTexture;
 }
 
+std::size_t FontManager::labelCount() const {
+  return labels;
+}
+
+void FontManager::bind() {
+  glState.bindVertexArray(vao);
+  if (!changed)
+    return;
+
+  glState.bindBuffer(GL_ARRAY_BUFFER, vbo);
+  const auto backgroundSize = static_cast<GLsizeiptr>(sizeof(LabelVertex) * backgroundVertices.size());
+  const auto glyphSize = static_cast<GLsizeiptr>(sizeof(LabelVertex) * glyphVertices.size());
+
+  // Only reallocated to grow, with room to spare for labels added later
+  if (const auto needed = backgroundVertices.size() + glyphVertices.size(); needed > bufferCapacity) {
+    bufferCapacity = std::max(needed, bufferCapacity * 2u);
+    gl.glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(sizeof(LabelVertex) * bufferCapacity), nullptr,
+                    GL_STATIC_DRAW);
+  }
+  gl.glBufferSubData(GL_ARRAY_BUFFER, 0, backgroundSize, backgroundVertices.data());
+  gl.glBufferSubData(GL_ARRAY_BUFFER, backgroundSize, glyphSize, glyphVertices.data());
+
+  changed = false;
+}
+
+int FontManager::backgroundVertexCount() const {
+  return static_cast<int>(backgroundVertices.size());
+}
+
+int FontManager::glyphVertexCount() const {
+  return static_cast<int>(glyphVertices.size());
+}
+
+std::size_t FontManager::getGpuBytes() const {
+  return bufferCapacity * sizeof(LabelVertex);
+}
+
 } // namespace netsimulyzer
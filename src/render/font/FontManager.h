@@ -35,17 +35,26 @@
 
 #include "src/render/texture/TextureCache.h"
 #include <QOpenGLFunctions_3_3_Core>
+#include <array>
+#include <cstddef>
+#include <glm/glm.hpp>
 #include <string>
+#include <vector>
 
 namespace netsimulyzer {
 
+/**
+ * Builds the banners for every label in one shared vertex buffer,
+ * so they may all be rendered together
+ */
 class FontManager {
 public:
   struct FontBannerRenderInfo {
-    unsigned int glyphVao;
-    unsigned int glyphVbo;
-    unsigned int backgroundVao;
-    unsigned int backgroundVbo;
+    /**
+     * The index of the label, which selects its anchor
+     * when rendering. See `Renderer::addLabel()`
+     */
+    std::size_t label;
 
     /**
      * Size of the string to render (in characters)
@@ -53,23 +62,85 @@ public:
     int size;
 
     /**
-     * Number of vertices of the VBO holding the glyphs
+     * The corners of the background, relative to the anchor, before scaling
+     */
+    glm::vec2 min;
+    glm::vec2 max;
+  };
+
+  /**
+   * A vertex of a glyph or a background banner,
+   * relative to the label's anchor, before billboarding
+   */
+  struct LabelVertex {
+    glm::vec2 position;
+
+    /**
+     * Coordinates on the atlas texture, unused for the backgrounds
      */
-    int glyphVboSize;
+    glm::vec2 textureCoordinate{0.0f};
 
     /**
-     * Number of vertices of the VBO holding the background banner
+     * The `FontBannerRenderInfo::label` this vertex belongs to
      */
-    int backgroundVboSize;
+    unsigned int label;
   };
 
 private:
+  /**
+   * Fixed scale factor for the font + background
+   * smaller, since we render the font for the
+   * texture at a large size, so it looks okay
+   * even if it gets big
+   */
+  static constexpr float scale = 0.50f;
+
+  /**
+   * A glyph's quad, scaled by `scale`, relative to where the glyph is placed
+   */
+  struct GlyphQuad {
+    glm::vec2 offset;
+    glm::vec2 size;
+
+    /**
+     * Corners of the glyph on the atlas, in texture coordinates
+     */
+    glm::vec2 low;
+    glm::vec2 high;
+  };
+
+  /**
+   * The quad of every character, by its unsigned value, built by `init()`.
+   * Characters without a glyph use the glyph for 0
+   */
+  std::array<GlyphQuad, 256u> glyphQuads{};
+
   TextureCache &textureCache;
   texture_id atlasTexture;
   float atlasWidth;
   float atlasHeight;
   QOpenGLFunctions_3_3_Core gl;
-  std::vector<FontBannerRenderInfo> createdFontMeshes;
+
+  /**
+   * The backgrounds for every label, followed by the glyphs, in one buffer
+   */
+  unsigned int vao{0u};
+  unsigned int vbo{0u};
+
+  std::vector<LabelVertex> backgroundVertices;
+  std::vector<LabelVertex> glyphVertices;
+  std::size_t labels{0u};
+
+  /**
+   * The number of vertices `vbo` has room for. Only grows,
+   * so the labels of the next scenario are uploaded without reallocating it
+   */
+  std::size_t bufferCapacity{0u};
+
+  /**
+   * Set when a label has been allocated since the last upload
+   */
+  bool changed{false};
 
 public:
   explicit FontManager(TextureCache &textureCache);
@@ -79,7 +150,46 @@ public:
 
   [[nodiscard]] texture_id getAtlasTexture() const;
 
+  /**
+   * Build the banner for a label
+   *
+   * @param text
+   * The text of the label
+   *
+   * @return
+   * Information used to place the label when rendering
+   */
   FontBannerRenderInfo allocate(std::string_view text);
+
+  /**
+   * @return
+   * The number of labels allocated since the last `reset()`
+   */
+  [[nodiscard]] std::size_t labelCount() const;
+
+  /**
+   * Bind the VAO with every label, uploading any new labels first.
+   * Backgrounds start at vertex 0, glyphs at `backgroundVertexCount()`
+   */
+  void bind();
+
+  /**
+   * @return
+   * The number of background vertices for every label
+   */
+  [[nodiscard]] int backgroundVertexCount() const;
+
+  /**
+   * @return
+   * The number of glyph vertices for every label
+   */
+  [[nodiscard]] int glyphVertexCount() const;
+
+  /**
+   * @return
+   * The bytes of the buffer holding every label's vertices, see `bind()`
+   */
+  [[nodiscard]] std::size_t getGpuBytes() const;
 };
 
 } // namespace netsimulyzer
@@ -0,0 +1,139 @@
+/*
+ * NIST-developed software is provided by NIST as a public service. You may use,
+ * copy and distribute copies of the software in any medium, provided that you
+ * keep intact this entire notice. You may improve,modify and create derivative
+ * works of the software or any portion of the software, and you may copy and
+ * distribute such modifications or works. Modified works should carry a notice
+ * stating that you changed the software and should note the date and nature of
+ * any such change. Please explicitly acknowledge the National Institute of
+ * Standards and Technology as the source of the software.
+ *
+ * NIST-developed software is expressly provided "AS IS." NIST MAKES NO
+ * WARRANTY OF ANY KIND, EXPRESS, IMPLIED, IN FACT OR ARISING BY OPERATION OF
+ * LAW, INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTY OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, NON-INFRINGEMENT
+ * AND DATA ACCURACY. NIST NEITHER REPRESENTS NOR WARRANTS THAT THE
+ * OPERATION OF THE SOFTWARE WILL BE UNINTERRUPTED OR ERROR-FREE, OR THAT
+ * ANY DEFECTS WILL BE CORRECTED. NIST DOES NOT WARRANT OR MAKE ANY
+ * REPRESENTATIONS REGARDING THE USE OF THE SOFTWARE OR THE RESULTS THEREOF,
+ * INCLUDING BUT NOT LIMITED TO THE CORRECTNESS, ACCURACY, RELIABILITY,
+ * OR USEFULNESS OF THE SOFTWARE.
+ *
+ * You are solely responsible for determining the appropriateness of using and
+ * distributing the software and you assume all risks associated with its use,
+ * including but not limited to the risks and costs of program errors,
+ * compliance with applicable laws, damage to or loss of data, programs or
+ * equipment, and the unavailability or interruption of operation. This
+ * software is not intended to be used in any situation where a failure could
+ * cause risk of injury or damage to property. The software developed by NIST
+ * employees is not subject to copyright protection within the United States.
+ *
+ * Author: Evan Black <evan.black@nist.gov>
+ */
+
+#include "ExportFramebuffer.h"
+#include <cstring>
+
+namespace netsimulyzer {
+
+ExportFramebuffer::ExportFramebuffer(QOpenGLFunctions_3_3_Core &openGl, int width, int height)
+    : openGl(openGl), width(width), height(height) {
+  openGl.glGenFramebuffers(1, &fbo);
+  openGl.glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+
+  // Renderbuffers, since the frames are only ever read back
+  openGl.glGenRenderbuffers(1, &colorBuffer);
+  openGl.glBindRenderbuffer(GL_RENDERBUFFER, colorBuffer);
+  openGl.glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+  openGl.glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, colorBuffer);
+
+  openGl.glGenRenderbuffers(1, &depthBuffer);
+  openGl.glBindRenderbuffer(GL_RENDERBUFFER, depthBuffer);
+  openGl.glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width, height);
+  openGl.glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, depthBuffer);
+  openGl.glBindRenderbuffer(GL_RENDERBUFFER, 0u);
+
+  const auto frameSize = static_cast<GLsizeiptr>(width) * height * 4;
+  openGl.glGenBuffers(static_cast<GLsizei>(ringSize), pixelBuffers.data());
+  for (const auto buffer : pixelBuffers) {
+    openGl.glBindBuffer(GL_PIXEL_PACK_BUFFER, buffer);
+    openGl.glBufferData(GL_PIXEL_PACK_BUFFER, frameSize, nullptr, GL_STREAM_READ);
+  }
+
+  // Leave the pack buffer unbound, otherwise other reads would land in it
+  openGl.glBindBuffer(GL_PIXEL_PACK_BUFFER, 0u);
+}
+
+ExportFramebuffer::~ExportFramebuffer() {
+  openGl.glDeleteBuffers(static_cast<GLsizei>(ringSize), pixelBuffers.data());
+  openGl.glDeleteRenderbuffers(1, &colorBuffer);
+  openGl.glDeleteRenderbuffers(1, &depthBuffer);
+  openGl.glDeleteFramebuffers(1, &fbo);
+}
+
+void ExportFramebuffer::bind() const {
+  openGl.glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+}
+
+void ExportFramebuffer::unbind(unsigned int defaultFbo) const {
+  openGl.glBindFramebuffer(GL_FRAMEBUFFER, defaultFbo);
+}
+
+QImage ExportFramebuffer::map(std::size_t index) {
+  QImage image{width, height, QImage::Format_RGBA8888};
+
+  openGl.glBindBuffer(GL_PIXEL_PACK_BUFFER, pixelBuffers[index]);
+  const auto pixels = openGl.glMapBuffer(GL_PIXEL_PACK_BUFFER, GL_READ_ONLY);
+  if (pixels)
+    std::memcpy(image.bits(), pixels, static_cast<std::size_t>(image.sizeInBytes()));
+  else
+    image.fill(Qt::black);
+
+  openGl.glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+  openGl.glBindBuffer(GL_PIXEL_PACK_BUFFER, 0u);
+  pending[index] = false;
+
+  return image;
+}
+
+std::optional<QImage> ExportFramebuffer::read() {
+  openGl.glBindFramebuffer(GL_READ_FRAMEBUFFER, fbo);
+  openGl.glReadBuffer(GL_COLOR_ATTACHMENT0);
+
+  // Goes to the pixel buffer, so this returns without waiting on the frame
+  openGl.glBindBuffer(GL_PIXEL_PACK_BUFFER, pixelBuffers[next]);
+  openGl.glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+  openGl.glBindBuffer(GL_PIXEL_PACK_BUFFER, 0u);
+  pending[next] = true;
+
+  // The slot after this frame is the oldest,
+  // and has had `ringSize - 1` frames to finish
+  next = (next + 1u) % ringSize;
+  if (!pending[next])
+    return {};
+
+  return map(next);
+}
+
+std::vector<QImage> ExportFramebuffer::finish() {
+  std::vector<QImage> frames;
+
+  // `next` is the oldest frame, whether or not the ring is full
+  for (auto i = 0u; i < ringSize; i++) {
+    const auto index = (next + i) % ringSize;
+    if (pending[index])
+      frames.emplace_back(map(index));
+  }
+
+  return frames;
+}
+
+int ExportFramebuffer::getWidth() const {
+  return width;
+}
+
+int ExportFramebuffer::getHeight() const {
+  return height;
+}
+
+} // namespace netsimulyzer
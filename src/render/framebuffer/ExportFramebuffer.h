@@ -0,0 +1,120 @@
+/*
+ * NIST-developed software is provided by NIST as a public service. You may use,
+ * copy and distribute copies of the software in any medium, provided that you
+ * keep intact this entire notice. You may improve,modify and create derivative
+ * works of the software or any portion of the software, and you may copy and
+ * distribute such modifications or works. Modified works should carry a notice
+ * stating that you changed the software and should note the date and nature of
+ * any such change. Please explicitly acknowledge the National Institute of
+ * Standards and Technology as the source of the software.
+ *
+ * NIST-developed software is expressly provided "AS IS." NIST MAKES NO
+ * WARRANTY OF ANY KIND, EXPRESS, IMPLIED, IN FACT OR ARISING BY OPERATION OF
+ * LAW, INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTY OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, NON-INFRINGEMENT
+ * AND DATA ACCURACY. NIST NEITHER REPRESENTS NOR WARRANTS THAT THE
+ * OPERATION OF THE SOFTWARE WILL BE UNINTERRUPTED OR ERROR-FREE, OR THAT
+ * ANY DEFECTS WILL BE CORRECTED. NIST DOES NOT WARRANT OR MAKE ANY
+ * REPRESENTATIONS REGARDING THE USE OF THE SOFTWARE OR THE RESULTS THEREOF,
+ * INCLUDING BUT NOT LIMITED TO THE CORRECTNESS, ACCURACY, RELIABILITY,
+ * OR USEFULNESS OF THE SOFTWARE.
+ *
+ * You are solely responsible for determining the appropriateness of using and
+ * distributing the software and you assume all risks associated with its use,
+ * including but not limited to the risks and costs of program errors,
+ * compliance with applicable laws, damage to or loss of data, programs or
+ * equipment, and the unavailability or interruption of operation. This
+ * software is not intended to be used in any situation where a failure could
+ * cause risk of injury or damage to property. The software developed by NIST
+ * employees is not subject to copyright protection within the United States.
+ *
+ * Author: Evan Black <evan.black@nist.gov>
+ */
+
+#pragma once
+#include <QImage>
+#include <QOpenGLFunctions_3_3_Core>
+#include <array>
+#include <cstddef>
+#include <optional>
+#include <vector>
+
+namespace netsimulyzer {
+
+/**
+ * Offscreen target for exported frames.
+ * Frames are read back through a ring of pixel buffer objects,
+ * so a frame is only mapped once the ones after it have been queued,
+ * and the read never waits on the frame just drawn
+ */
+class ExportFramebuffer {
+  /**
+   * The number of frames in flight before the oldest is mapped
+   */
+  static constexpr std::size_t ringSize = 3u;
+
+  QOpenGLFunctions_3_3_Core &openGl;
+  int width;
+  int height;
+  unsigned int fbo{0u};
+  unsigned int colorBuffer{0u};
+  unsigned int depthBuffer{0u};
+
+  /**
+   * Pixel buffers each frame is read into
+   */
+  std::array<unsigned int, ringSize> pixelBuffers{};
+
+  /**
+   * Which of `pixelBuffers` hold a frame that has not been mapped yet
+   */
+  std::array<bool, ringSize> pending{};
+
+  /**
+   * Index in `pixelBuffers` the next frame is read into
+   */
+  std::size_t next{0u};
+
+  /**
+   * Copy the frame in `pixelBuffers[index]` out of the buffer
+   *
+   * @return
+   * The frame, upside down, since OpenGL starts from the bottom left
+   */
+  [[nodiscard]] QImage map(std::size_t index);
+
+public:
+  ExportFramebuffer(QOpenGLFunctions_3_3_Core &openGl, int width, int height);
+  ~ExportFramebuffer();
+
+  // Disallow copying
+  ExportFramebuffer(const ExportFramebuffer &) = delete;
+  ExportFramebuffer &operator=(const ExportFramebuffer &) = delete;
+
+  void bind() const;
+  void unbind(unsigned int defaultFbo) const;
+
+  /**
+   * Queue a read of the frame just drawn
+   *
+   * @return
+   * The oldest frame still in flight, once the ring is full.
+   * Unset otherwise.
+   * The frame is upside down, see `QImage::mirrored()`
+   */
+  [[nodiscard]] std::optional<QImage> read();
+
+  /**
+   * Map every frame still in flight
+   *
+   * @return
+   * The frames, oldest first.
+   * Each is upside down, see `QImage::mirrored()`
+   */
+  [[nodiscard]] std::vector<QImage> finish();
+
+  [[nodiscard]] int getWidth() const;
+  [[nodiscard]] int getHeight() const;
+};
+
+} // namespace netsimulyzer
@@ -0,0 +1,98 @@
+/*
+ * NIST-developed software is provided by NIST as a public service. You may use,
+ * copy and distribute copies of the software in any medium, provided that you
+ * keep intact this entire notice. You may improve,modify and create derivative
+ * works of the software or any portion of the software, and you may copy and
+ * distribute such modifications or works. Modified works should carry a notice
+ * stating that you changed the software and should note the date and nature of
+ * any such change. Please explicitly acknowledge the National Institute of
+ * Standards and Technology as the source of the software.
+ *
+ * NIST-developed software is expressly provided "AS IS." NIST MAKES NO
+ * WARRANTY OF ANY KIND, EXPRESS, IMPLIED, IN FACT OR ARISING BY OPERATION OF
+ * LAW, INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTY OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, NON-INFRINGEMENT
+ * AND DATA ACCURACY. NIST NEITHER REPRESENTS NOR WARRANTS THAT THE
+ * OPERATION OF THE SOFTWARE WILL BE UNINTERRUPTED OR ERROR-FREE, OR THAT
+ * ANY DEFECTS WILL BE CORRECTED. NIST DOES NOT WARRANT OR MAKE ANY
+ * REPRESENTATIONS REGARDING THE USE OF THE SOFTWARE OR THE RESULTS THEREOF,
+ * INCLUDING BUT NOT LIMITED TO THE CORRECTNESS, ACCURACY, RELIABILITY,
+ * OR USEFULNESS OF THE SOFTWARE.
+ *
+ * You are solely responsible for determining the appropriateness of using and
+ * distributing the software and you assume all risks associated with its use,
+ * including but not limited to the risks and costs of program errors,
+ * compliance with applicable laws, damage to or loss of data, programs or
+ * equipment, and the unavailability or interruption of operation. This
+ * software is not intended to be used in any situation where a failure could
+ * cause risk of injury or damage to property. The software developed by NIST
+ * employees is not subject to copyright protection within the United States.
+ *
+ * Author: Evan Black <evan.black@nist.gov>
+ */
+
+#include "MinimapFramebuffer.h"
+#include "../renderer/GlState.h"
+
+namespace netsimulyzer {
+
+unsigned int MinimapFramebuffer::makeTexture() {
+  unsigned int texture{0u};
+  openGl.glGenTextures(1, &texture);
+  glState.bindTexture(0u, GL_TEXTURE_2D, texture);
+  openGl.glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, size, size, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+  openGl.glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+  openGl.glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+  openGl.glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+  openGl.glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+  return texture;
+}
+
+MinimapFramebuffer::MinimapFramebuffer(QOpenGLFunctions_3_3_Core &openGl, int size) : openGl(openGl), size(size) {
+  staticTexture = makeTexture();
+  openGl.glGenFramebuffers(1, &staticFbo);
+  openGl.glBindFramebuffer(GL_FRAMEBUFFER, staticFbo);
+  openGl.glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, staticTexture, 0);
+
+  // Only the static content is depth tested, the dots are drawn over it
+  openGl.glGenRenderbuffers(1, &depthBuffer);
+  openGl.glBindRenderbuffer(GL_RENDERBUFFER, depthBuffer);
+  openGl.glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, size, size);
+  openGl.glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, depthBuffer);
+  openGl.glBindRenderbuffer(GL_RENDERBUFFER, 0u);
+
+  mapTexture = makeTexture();
+  openGl.glGenFramebuffers(1, &mapFbo);
+  openGl.glBindFramebuffer(GL_FRAMEBUFFER, mapFbo);
+  openGl.glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, mapTexture, 0);
+}
+
+MinimapFramebuffer::~MinimapFramebuffer() {
+  glState.deleteTexture(staticTexture);
+  glState.deleteTexture(mapTexture);
+  openGl.glDeleteRenderbuffers(1, &depthBuffer);
+  openGl.glDeleteFramebuffers(1, &staticFbo);
+  openGl.glDeleteFramebuffers(1, &mapFbo);
+}
+
+void MinimapFramebuffer::bindStatic() const {
+  openGl.glBindFramebuffer(GL_FRAMEBUFFER, staticFbo);
+}
+
+void MinimapFramebuffer::bindMap() const {
+  openGl.glBindFramebuffer(GL_FRAMEBUFFER, mapFbo);
+}
+
+unsigned int MinimapFramebuffer::getStatic() const {
+  return staticTexture;
+}
+
+unsigned int MinimapFramebuffer::getMap() const {
+  return mapTexture;
+}
+
+int MinimapFramebuffer::getSize() const {
+  return size;
+}
+
+} // namespace netsimulyzer
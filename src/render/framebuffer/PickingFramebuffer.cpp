@@ -32,6 +32,7 @@
  */
 
 #include "PickingFramebuffer.h"
+#include "../renderer/GlState.h"
 #include <QOpenGLFunctions_3_3_Core>
 namespace netsimulyzer {
 
@@ -40,14 +41,14 @@ void PickingFramebuffer::generate(int width, int height) {
   bind(GL_FRAMEBUFFER);
 
   openGl.glGenTextures(1, &idTexture);
-  openGl.glBindTexture(GL_TEXTURE_2D, idTexture);
+  glState.bindTexture(0u, GL_TEXTURE_2D, idTexture);
   openGl.glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB32UI, width, height, 0, GL_RGB_INTEGER, GL_UNSIGNED_INT, nullptr);
   openGl.glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
   openGl.glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
   openGl.glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, idTexture, 0);
 
   openGl.glGenTextures(1, &depthTexture);
-  openGl.glBindTexture(GL_TEXTURE_2D, depthTexture);
+  glState.bindTexture(0u, GL_TEXTURE_2D, depthTexture);
   openGl.glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT, width, height, 0, GL_DEPTH_COMPONENT, GL_FLOAT, nullptr);
   openGl.glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, depthTexture, 0);
 }
@@ -56,11 +57,19 @@ void PickingFramebuffer::generate(int width, int height) {
 PickingFramebuffer::PickingFramebuffer(QOpenGLFunctions_3_3_Core &openGl, int width, int height)
     : openGl(openGl) { // NOLINT(cppcoreguidelines-pro-type-member-init)
   generate(width, height);
+
+  openGl.glGenBuffers(1, &pixelBuffer);
+  openGl.glBindBuffer(GL_PIXEL_PACK_BUFFER, pixelBuffer);
+  openGl.glBufferData(GL_PIXEL_PACK_BUFFER, sizeof(PixelInfo), nullptr, GL_STREAM_READ);
+  openGl.glBindBuffer(GL_PIXEL_PACK_BUFFER, 0u);
 }
 
 PickingFramebuffer::~PickingFramebuffer() {
-  openGl.glDeleteTextures(1, &idTexture);
-  openGl.glDeleteTextures(1, &depthTexture);
+  if (readFence)
+    openGl.glDeleteSync(readFence);
+  openGl.glDeleteBuffers(1, &pixelBuffer);
+  glState.deleteTexture(idTexture);
+  glState.deleteTexture(depthTexture);
   openGl.glDeleteFramebuffers(1, &fbo);
 }
 
@@ -72,21 +81,49 @@ void PickingFramebuffer::unbind(GLenum mode, unsigned int defaultFbo) const {
   openGl.glBindFramebuffer(mode, defaultFbo);
 }
 
-PickingFramebuffer::PixelInfo PickingFramebuffer::read(int x, int y) const {
+void PickingFramebuffer::readAsync(int x, int y) {
   bind(GL_READ_FRAMEBUFFER);
   openGl.glReadBuffer(GL_COLOR_ATTACHMENT0);
 
-  PixelInfo pixelInfo; // NOLINT(cppcoreguidelines-pro-type-member-init)
-  openGl.glReadPixels(x, y, 1, 1, GL_RGB_INTEGER, GL_UNSIGNED_INT, &pixelInfo);
+  // Into the pixel buffer, so this returns without waiting on the picking pass
+  openGl.glBindBuffer(GL_PIXEL_PACK_BUFFER, pixelBuffer);
+  openGl.glReadPixels(x, y, 1, 1, GL_RGB_INTEGER, GL_UNSIGNED_INT, nullptr);
+  openGl.glBindBuffer(GL_PIXEL_PACK_BUFFER, 0u);
+
+  if (readFence)
+    openGl.glDeleteSync(readFence);
+  readFence = openGl.glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+
+std::optional<PickingFramebuffer::PixelInfo> PickingFramebuffer::poll() {
+  if (!readFence)
+    return {};
+
+  // A timeout of 0 only checks the fence.
+  // Flush so the fence is sure to be signalled eventually
+  const auto status = openGl.glClientWaitSync(readFence, GL_SYNC_FLUSH_COMMANDS_BIT, 0u);
+  if (status == GL_TIMEOUT_EXPIRED)
+    return {};
+
+  openGl.glDeleteSync(readFence);
+  readFence = nullptr;
+  if (status == GL_WAIT_FAILED)
+    return {};
+
+  PixelInfo pixelInfo{0u, 0u, 0u};
+  openGl.glBindBuffer(GL_PIXEL_PACK_BUFFER, pixelBuffer);
+  const auto mapped = openGl.glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, sizeof(PixelInfo), GL_MAP_READ_BIT);
+  if (mapped) {
+    pixelInfo = *static_cast<const PixelInfo *>(mapped);
+    openGl.glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+  }
+  openGl.glBindBuffer(GL_PIXEL_PACK_BUFFER, 0u);
 
   return pixelInfo;
 }
 
-void PickingFramebuffer::resize(int width, int height) {
-  openGl.glDeleteTextures(1, &idTexture);
-  openGl.glDeleteTextures(1, &depthTexture);
-  openGl.glDeleteFramebuffers(1, &fbo);
-  generate(width, height);
+bool PickingFramebuffer::isPending() const {
+  return readFence != nullptr;
 }
 
 } // namespace netsimulyzer
@@ -32,6 +32,7 @@
  */
 #pragma once
 #include <QOpenGLFunctions_3_3_Core>
+#include <optional>
 
 namespace netsimulyzer {
 
@@ -41,6 +42,17 @@ class PickingFramebuffer {
   unsigned int idTexture;
   unsigned int depthTexture;
 
+  /**
+   * Target of `readAsync()`, holds one `PixelInfo`
+   */
+  unsigned int pixelBuffer;
+
+  /**
+   * Signalled once the read into `pixelBuffer` is done.
+   * Only set while a read is in flight
+   */
+  GLsync readFence{nullptr};
+
   void generate(int width, int height);
 
 public:
@@ -60,13 +72,37 @@ public:
   void bind(GLenum mode) const;
   void unbind(GLenum mode, unsigned int defaultFbo) const;
 
-  [[nodiscard]] PixelInfo read(int x, int y) const;
+  /**
+   * Queue a read of one pixel, without waiting for it.
+   * Replaces any read still in flight.
+   * See `poll()` for the result
+   *
+   * @param x
+   * The X coordinate of the pixel, from the left
+   *
+   * @param y
+   * The Y coordinate of the pixel, from the bottom
+   */
+  void readAsync(int x, int y);
+
+  /**
+   * Check on the read from `readAsync()`, without waiting for it
+   *
+   * @return
+   * The pixel, once the read is done.
+   * Unset while it is in flight, or if no read was queued
+   */
+  [[nodiscard]] std::optional<PixelInfo> poll();
+
+  /**
+   * @return
+   * True while a read from `readAsync()` has not been returned by `poll()`
+   */
+  [[nodiscard]] bool isPending() const;
 
   inline unsigned int getIds() {
     return idTexture;
   }
-
-  void resize(int width, int height);
 };
 
 } // namespace netsimulyzer
@@ -0,0 +1,132 @@
+/*
+ * NIST-developed software is provided by NIST as a public service. You may use,
+ * copy and distribute copies of the software in any medium, provided that you
+ * keep intact this entire notice. You may improve,modify and create derivative
+ * works of the software or any portion of the software, and you may copy and
+ * distribute such modifications or works. Modified works should carry a notice
+ * stating that you changed the software and should note the date and nature of
+ * any such change. Please explicitly acknowledge the National Institute of
+ * Standards and Technology as the source of the software.
+ *
+ * NIST-developed software is expressly provided "AS IS." NIST MAKES NO
+ * WARRANTY OF ANY KIND, EXPRESS, IMPLIED, IN FACT OR ARISING BY OPERATION OF
+ * LAW, INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTY OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, NON-INFRINGEMENT
+ * AND DATA ACCURACY. NIST NEITHER REPRESENTS NOR WARRANTS THAT THE
+ * OPERATION OF THE SOFTWARE WILL BE UNINTERRUPTED OR ERROR-FREE, OR THAT
+ * ANY DEFECTS WILL BE CORRECTED. NIST DOES NOT WARRANT OR MAKE ANY
+ * REPRESENTATIONS REGARDING THE USE OF THE SOFTWARE OR THE RESULTS THEREOF,
+ * INCLUDING BUT NOT LIMITED TO THE CORRECTNESS, ACCURACY, RELIABILITY,
+ * OR USEFULNESS OF THE SOFTWARE.
+ *
+ * You are solely responsible for determining the appropriateness of using and
+ * distributing the software and you assume all risks associated with its use,
+ * including but not limited to the risks and costs of program errors,
+ * compliance with applicable laws, damage to or loss of data, programs or
+ * equipment, and the unavailability or interruption of operation. This
+ * software is not intended to be used in any situation where a failure could
+ * cause risk of injury or damage to property. The software developed by NIST
+ * employees is not subject to copyright protection within the United States.
+ *
+ * Author: Evan Black <evan.black@nist.gov>
+ */
+
+#include "SceneFramebuffer.h"
+#include "../renderer/GlState.h"
+
+namespace netsimulyzer {
+
+void SceneFramebuffer::generate() {
+  openGl.glGenTextures(1, &colorTexture);
+  glState.bindTexture(0u, GL_TEXTURE_2D, colorTexture);
+  openGl.glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+
+  // Linear, so the upscale is filtered
+  openGl.glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+  openGl.glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+  openGl.glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+  openGl.glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+  openGl.glGenFramebuffers(1, &fbo);
+  openGl.glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+
+  if (samples > 0) {
+    openGl.glGenRenderbuffers(1, &colorBuffer);
+    openGl.glBindRenderbuffer(GL_RENDERBUFFER, colorBuffer);
+    openGl.glRenderbufferStorageMultisample(GL_RENDERBUFFER, samples, GL_RGBA8, width, height);
+    openGl.glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, colorBuffer);
+  } else
+    openGl.glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, colorTexture, 0);
+
+  openGl.glGenRenderbuffers(1, &depthBuffer);
+  openGl.glBindRenderbuffer(GL_RENDERBUFFER, depthBuffer);
+  openGl.glRenderbufferStorageMultisample(GL_RENDERBUFFER, samples, GL_DEPTH24_STENCIL8, width, height);
+  openGl.glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, depthBuffer);
+  openGl.glBindRenderbuffer(GL_RENDERBUFFER, 0u);
+
+  if (samples > 0) {
+    openGl.glGenFramebuffers(1, &resolveFbo);
+    openGl.glBindFramebuffer(GL_FRAMEBUFFER, resolveFbo);
+    openGl.glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, colorTexture, 0);
+  }
+}
+
+void SceneFramebuffer::destroy() {
+  glState.deleteTexture(colorTexture);
+  openGl.glDeleteRenderbuffers(1, &colorBuffer);
+  openGl.glDeleteRenderbuffers(1, &depthBuffer);
+  openGl.glDeleteFramebuffers(1, &fbo);
+  openGl.glDeleteFramebuffers(1, &resolveFbo);
+
+  colorTexture = 0u;
+  colorBuffer = 0u;
+  depthBuffer = 0u;
+  fbo = 0u;
+  resolveFbo = 0u;
+}
+
+SceneFramebuffer::SceneFramebuffer(QOpenGLFunctions_3_3_Core &openGl, int width, int height, int samples)
+    : openGl(openGl), samples(samples), width(width), height(height) {
+  generate();
+}
+
+SceneFramebuffer::~SceneFramebuffer() {
+  destroy();
+}
+
+void SceneFramebuffer::bind() const {
+  openGl.glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+}
+
+void SceneFramebuffer::resolve() const {
+  if (samples < 1)
+    return;
+
+  openGl.glBindFramebuffer(GL_READ_FRAMEBUFFER, fbo);
+  openGl.glBindFramebuffer(GL_DRAW_FRAMEBUFFER, resolveFbo);
+  openGl.glBlitFramebuffer(0, 0, width, height, 0, 0, width, height, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+}
+
+unsigned int SceneFramebuffer::getColor() const {
+  return colorTexture;
+}
+
+void SceneFramebuffer::resize(int width, int height) {
+  if (width == this->width && height == this->height)
+    return;
+
+  this->width = width;
+  this->height = height;
+  destroy();
+  generate();
+}
+
+int SceneFramebuffer::getWidth() const {
+  return width;
+}
+
+int SceneFramebuffer::getHeight() const {
+  return height;
+}
+
+} // namespace netsimulyzer
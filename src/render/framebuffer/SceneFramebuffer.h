@@ -0,0 +1,93 @@
+/*
+ * NIST-developed software is provided by NIST as a public service. You may use,
+ * copy and distribute copies of the software in any medium, provided that you
+ * keep intact this entire notice. You may improve,modify and create derivative
+ * works of the software or any portion of the software, and you may copy and
+ * distribute such modifications or works. Modified works should carry a notice
+ * stating that you changed the software and should note the date and nature of
+ * any such change. Please explicitly acknowledge the National Institute of
+ * Standards and Technology as the source of the software.
+ *
+ * NIST-developed software is expressly provided "AS IS." NIST MAKES NO
+ * WARRANTY OF ANY KIND, EXPRESS, IMPLIED, IN FACT OR ARISING BY OPERATION OF
+ * LAW, INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTY OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, NON-INFRINGEMENT
+ * AND DATA ACCURACY. NIST NEITHER REPRESENTS NOR WARRANTS THAT THE
+ * OPERATION OF THE SOFTWARE WILL BE UNINTERRUPTED OR ERROR-FREE, OR THAT
+ * ANY DEFECTS WILL BE CORRECTED. NIST DOES NOT WARRANT OR MAKE ANY
+ * REPRESENTATIONS REGARDING THE USE OF THE SOFTWARE OR THE RESULTS THEREOF,
+ * INCLUDING BUT NOT LIMITED TO THE CORRECTNESS, ACCURACY, RELIABILITY,
+ * OR USEFULNESS OF THE SOFTWARE.
+ *
+ * You are solely responsible for determining the appropriateness of using and
+ * distributing the software and you assume all risks associated with its use,
+ * including but not limited to the risks and costs of program errors,
+ * compliance with applicable laws, damage to or loss of data, programs or
+ * equipment, and the unavailability or interruption of operation. This
+ * software is not intended to be used in any situation where a failure could
+ * cause risk of injury or damage to property. The software developed by NIST
+ * employees is not subject to copyright protection within the United States.
+ *
+ * Author: Evan Black <evan.black@nist.gov>
+ */
+
+#pragma once
+#include <QOpenGLFunctions_3_3_Core>
+
+namespace netsimulyzer {
+
+/**
+ * Offscreen target for the main scene, so it may be drawn
+ * at a lower resolution than the widget and upscaled.
+ * Multisampled to match the widget, then resolved into a texture
+ */
+class SceneFramebuffer {
+  QOpenGLFunctions_3_3_Core &openGl;
+  int samples;
+  int width;
+  int height;
+
+  /**
+   * Drawn into. Multisampled when `samples` is above 0
+   */
+  unsigned int fbo{0u};
+  unsigned int colorBuffer{0u};
+  unsigned int depthBuffer{0u};
+
+  /**
+   * `colorTexture` is attached here when multisampled, or to `fbo` otherwise
+   */
+  unsigned int resolveFbo{0u};
+  unsigned int colorTexture{0u};
+
+  void generate();
+  void destroy();
+
+public:
+  SceneFramebuffer(QOpenGLFunctions_3_3_Core &openGl, int width, int height, int samples);
+  ~SceneFramebuffer();
+
+  // Disallow copying
+  SceneFramebuffer(const SceneFramebuffer &) = delete;
+  SceneFramebuffer &operator=(const SceneFramebuffer &) = delete;
+
+  void bind() const;
+
+  /**
+   * Resolve the samples drawn into `getColor()`.
+   * Leaves `resolveFbo` bound, so rebind the target afterwards
+   */
+  void resolve() const;
+
+  /**
+   * @return
+   * The texture with the scene, after `resolve()`
+   */
+  [[nodiscard]] unsigned int getColor() const;
+
+  void resize(int width, int height);
+  [[nodiscard]] int getWidth() const;
+  [[nodiscard]] int getHeight() const;
+};
+
+} // namespace netsimulyzer
@@ -0,0 +1,233 @@
+/*
+ * NIST-developed software is provided by NIST as a public service. You may use,
+ * copy and distribute copies of the software in any medium, provided that you
+ * keep intact this entire notice. You may improve,modify and create derivative
+ * works of the software or any portion of the software, and you may copy and
+ * distribute such modifications or works. Modified works should carry a notice
+ * stating that you changed the software and should note the date and nature of
+ * any such change. Please explicitly acknowledge the National Institute of
+ * Standards and Technology as the source of the software.
+ *
+ * NIST-developed software is expressly provided "AS IS." NIST MAKES NO
+ * WARRANTY OF ANY KIND, EXPRESS, IMPLIED, IN FACT OR ARISING BY OPERATION OF
+ * LAW, INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTY OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, NON-INFRINGEMENT
+ * AND DATA ACCURACY. NIST NEITHER REPRESENTS NOR WARRANTS THAT THE
+ * OPERATION OF THE SOFTWARE WILL BE UNINTERRUPTED OR ERROR-FREE, OR THAT
+ * ANY DEFECTS WILL BE CORRECTED. NIST DOES NOT WARRANT OR MAKE ANY
+ * REPRESENTATIONS REGARDING THE USE OF THE SOFTWARE OR THE RESULTS THEREOF,
+ * INCLUDING BUT NOT LIMITED TO THE CORRECTNESS, ACCURACY, RELIABILITY,
+ * OR USEFULNESS OF THE SOFTWARE.
+ *
+ * You are solely responsible for determining the appropriateness of using and
+ * distributing the software and you assume all risks associated with its use,
+ * including but not limited to the risks and costs of program errors,
+ * compliance with applicable laws, damage to or loss of data, programs or
+ * equipment, and the unavailability or interruption of operation. This
+ * software is not intended to be used in any situation where a failure could
+ * cause risk of injury or damage to property. The software developed by NIST
+ * employees is not subject to copyright protection within the United States.
+ *
+ * Author: Evan Black <evan.black@nist.gov>
+ */
+
+
+#include "BoundingVolumeHierarchy.h"
+#include <algorithm>
+#include <utility>
+
+namespace netsimulyzer {
+
+void BoundingVolumeHierarchy::Box::expand(const BoundingVolumeHierarchy::Box &other) {
+  min = glm::min(min, other.min);
+  max = glm::max(max, other.max);
+}
+
+glm::vec3 BoundingVolumeHierarchy::Box::center() const {
+  return (min + max) * 0.5f;
+}
+
+BoundingVolumeHierarchy::Box BoundingVolumeHierarchy::Box::transformed(const glm::mat4 &matrix) const {
+  Box box;
+  for (auto corner = 0u; corner < 8u; corner++) {
+    const glm::vec4 point{corner & 1u ? max.x : min.x, corner & 2u ? max.y : min.y, corner & 4u ? max.z : min.z,
+                          1.0f};
+    const auto transformedPoint = glm::vec3{matrix * point};
+    box.min = glm::min(box.min, transformedPoint);
+    box.max = glm::max(box.max, transformedPoint);
+  }
+
+  return box;
+}
+
+std::optional<float> BoundingVolumeHierarchy::Box::intersect(const glm::vec3 &origin,
+                                                             const glm::vec3 &inverseDirection) const {
+  // Slab test, an infinite `inverseDirection` for a 0 direction
+  // gives the right result unless the origin is on a slab
+  const auto t1 = (min - origin) * inverseDirection;
+  const auto t2 = (max - origin) * inverseDirection;
+  const auto nearest = glm::min(t1, t2);
+  const auto farthest = glm::max(t1, t2);
+
+  const auto enter = std::max({nearest.x, nearest.y, nearest.z, 0.0f});
+  const auto exit = std::min({farthest.x, farthest.y, farthest.z});
+
+  if (enter > exit)
+    return {};
+  return enter;
+}
+
+void BoundingVolumeHierarchy::build(std::uint32_t index, std::uint32_t begin, std::uint32_t end) {
+  Box box;
+  Box centers;
+  for (auto i = begin; i < end; i++) {
+    box.expand(bounds[items[i]]);
+    const auto center = bounds[items[i]].center();
+    centers.expand({center, center});
+  }
+  tree[index].box = box;
+
+  if (end - begin <= leafSize) {
+    tree[index].first = begin;
+    tree[index].count = end - begin;
+    for (auto i = begin; i < end; i++)
+      leaves[items[i]] = index;
+    return;
+  }
+
+  // Split at the median of the longest axis of the centers
+  const auto extent = centers.max - centers.min;
+  auto axis = 0;
+  if (extent.y > extent[axis])
+    axis = 1;
+  if (extent.z > extent[axis])
+    axis = 2;
+
+  const auto middle = begin + (end - begin) / 2u;
+  std::nth_element(items.begin() + begin, items.begin() + middle, items.begin() + end,
+                   [this, axis](std::uint32_t left, std::uint32_t right) {
+                     return bounds[left].center()[axis] < bounds[right].center()[axis];
+                   });
+
+  // Children are allocated next to each other, so only the left is stored
+  const auto left = static_cast<std::uint32_t>(tree.size());
+  tree.emplace_back().parent = index;
+  tree.emplace_back().parent = index;
+  tree[index].first = left;
+
+  build(left, begin, middle);
+  build(left + 1u, middle, end);
+}
+
+void BoundingVolumeHierarchy::addAll(std::uint32_t index, std::vector<std::uint32_t> &visible) const {
+  const auto &node = tree[index];
+  if (node.count > 0u) {
+    visible.insert(visible.end(), items.begin() + node.first, items.begin() + node.first + node.count);
+    return;
+  }
+
+  addAll(node.first, visible);
+  addAll(node.first + 1u, visible);
+}
+
+void BoundingVolumeHierarchy::clear() {
+  tree.clear();
+  items.clear();
+  bounds.clear();
+  leaves.clear();
+  moved.clear();
+  isMoved.clear();
+}
+
+void BoundingVolumeHierarchy::build(std::vector<Box> itemBounds) {
+  clear();
+
+  bounds = std::move(itemBounds);
+  const auto count = static_cast<std::uint32_t>(bounds.size());
+  items.reserve(count);
+  for (auto i = 0u; i < count; i++)
+    items.emplace_back(i);
+
+  leaves.resize(count);
+  isMoved.resize(count);
+
+  if (count > 0u) {
+    tree.reserve(count / leafSize * 2u + 1u);
+    tree.emplace_back();
+    build(0u, 0u, count);
+  }
+}
+
+std::size_t BoundingVolumeHierarchy::size() const {
+  return bounds.size();
+}
+
+void BoundingVolumeHierarchy::update(std::size_t index, const Box &box) {
+  if (index >= bounds.size())
+    return;
+
+  bounds[index] = box;
+  if (isMoved[index])
+    return;
+
+  isMoved[index] = true;
+  moved.emplace_back(static_cast<std::uint32_t>(index));
+}
+
+void BoundingVolumeHierarchy::refit() {
+  for (const auto index : moved) {
+    isMoved[index] = false;
+
+    // Rebuild each box up to the root from its contents
+    auto leaf = leaves[index];
+    auto &leafNode = tree[leaf];
+    leafNode.box = {};
+    for (auto i = leafNode.first; i < leafNode.first + leafNode.count; i++)
+      leafNode.box.expand(bounds[items[i]]);
+
+    for (auto parent = leafNode.parent; parent != noParent; parent = tree[parent].parent) {
+      auto &node = tree[parent];
+      node.box = tree[node.first].box;
+      node.box.expand(tree[node.first + 1u].box);
+    }
+  }
+
+  moved.clear();
+}
+
+void BoundingVolumeHierarchy::cull(const Frustum &frustum, std::vector<std::uint32_t> &visible) const {
+  visible.clear();
+  if (tree.empty())
+    return;
+
+  std::vector<std::uint32_t> stack{0u};
+  while (!stack.empty()) {
+    const auto index = stack.back();
+    const auto &node = tree[index];
+    stack.pop_back();
+
+    const auto containment = frustum.contains(node.box.min, node.box.max);
+    if (containment == Frustum::Containment::Outside)
+      continue;
+
+    // Everything below is in view, so skip the rest of the tests
+    if (containment == Frustum::Containment::Inside) {
+      addAll(index, visible);
+      continue;
+    }
+
+    if (node.count == 0u) {
+      stack.emplace_back(node.first);
+      stack.emplace_back(node.first + 1u);
+      continue;
+    }
+
+    for (auto i = node.first; i < node.first + node.count; i++) {
+      const auto item = items[i];
+      if (frustum.intersects(bounds[item].min, bounds[item].max))
+        visible.emplace_back(item);
+    }
+  }
+}
+
+} // namespace netsimulyzer
@@ -0,0 +1,262 @@
+/*
+ * NIST-developed software is provided by NIST as a public service. You may use,
+ * copy and distribute copies of the software in any medium, provided that you
+ * keep intact this entire notice. You may improve,modify and create derivative
+ * works of the software or any portion of the software, and you may copy and
+ * distribute such modifications or works. Modified works should carry a notice
+ * stating that you changed the software and should note the date and nature of
+ * any such change. Please explicitly acknowledge the National Institute of
+ * Standards and Technology as the source of the software.
+ *
+ * NIST-developed software is expressly provided "AS IS." NIST MAKES NO
+ * WARRANTY OF ANY KIND, EXPRESS, IMPLIED, IN FACT OR ARISING BY OPERATION OF
+ * LAW, INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTY OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, NON-INFRINGEMENT
+ * AND DATA ACCURACY. NIST NEITHER REPRESENTS NOR WARRANTS THAT THE
+ * OPERATION OF THE SOFTWARE WILL BE UNINTERRUPTED OR ERROR-FREE, OR THAT
+ * ANY DEFECTS WILL BE CORRECTED. NIST DOES NOT WARRANT OR MAKE ANY
+ * REPRESENTATIONS REGARDING THE USE OF THE SOFTWARE OR THE RESULTS THEREOF,
+ * INCLUDING BUT NOT LIMITED TO THE CORRECTNESS, ACCURACY, RELIABILITY,
+ * OR USEFULNESS OF THE SOFTWARE.
+ *
+ * You are solely responsible for determining the appropriateness of using and
+ * distributing the software and you assume all risks associated with its use,
+ * including but not limited to the risks and costs of program errors,
+ * compliance with applicable laws, damage to or loss of data, programs or
+ * equipment, and the unavailability or interruption of operation. This
+ * software is not intended to be used in any situation where a failure could
+ * cause risk of injury or damage to property. The software developed by NIST
+ * employees is not subject to copyright protection within the United States.
+ *
+ * Author: Evan Black <evan.black@nist.gov>
+ */
+
+
+#pragma once
+
+#include "src/render/camera/Frustum.h"
+#include <cstddef>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <limits>
+#include <optional>
+#include <vector>
+
+namespace netsimulyzer {
+
+/**
+ * Bounding volume hierarchy over the world space bounds of a set of items,
+ * for picking with a ray & culling against the view frustum on the CPU.
+ *
+ * Items are referenced by index, which is up to the owner to map back.
+ * Moved items are refit, rather than rebuilding the hierarchy
+ */
+class BoundingVolumeHierarchy {
+public:
+  struct Box {
+    glm::vec3 min{std::numeric_limits<float>::max()};
+    glm::vec3 max{std::numeric_limits<float>::lowest()};
+
+    void expand(const Box &other);
+    [[nodiscard]] glm::vec3 center() const;
+
+    /**
+     * The axis aligned box around this one, after it is transformed
+     *
+     * @param matrix
+     * The transformation to apply, usually a model matrix
+     */
+    [[nodiscard]] Box transformed(const glm::mat4 &matrix) const;
+
+    /**
+     * Find where a ray enters the box
+     *
+     * @param origin
+     * The start of the ray
+     *
+     * @param inverseDirection
+     * 1 / the direction of the ray, for each axis
+     *
+     * @return
+     * The distance along the ray to the box,
+     * 0 if `origin` is inside the box, unset if the ray misses
+     */
+    [[nodiscard]] std::optional<float> intersect(const glm::vec3 &origin, const glm::vec3 &inverseDirection) const;
+  };
+
+private:
+  /**
+   * The most items in a leaf
+   */
+  static constexpr std::uint32_t leafSize = 4u;
+
+  /**
+   * Marks the root's parent
+   */
+  static constexpr std::uint32_t noParent = std::numeric_limits<std::uint32_t>::max();
+
+  struct TreeNode {
+    Box box;
+    std::uint32_t parent{noParent};
+
+    /**
+     * For leaves, the index in `items` of the first item.
+     * Otherwise, the index of the left child, the right child follows it
+     */
+    std::uint32_t first{0u};
+
+    /**
+     * The number of items in a leaf, 0 for inner nodes
+     */
+    std::uint32_t count{0u};
+  };
+
+  std::vector<TreeNode> tree;
+
+  /**
+   * Item indices, grouped by leaf
+   */
+  std::vector<std::uint32_t> items;
+
+  /**
+   * World space bounds of each item
+   */
+  std::vector<Box> bounds;
+
+  /**
+   * The leaf containing each item
+   */
+  std::vector<std::uint32_t> leaves;
+
+  /**
+   * Items moved since the last refit, without duplicates
+   */
+  std::vector<std::uint32_t> moved;
+  std::vector<bool> isMoved;
+
+  /**
+   * Fill in `tree[index]` & its subtree from `items` in [`begin`, `end`)
+   */
+  void build(std::uint32_t index, std::uint32_t begin, std::uint32_t end);
+
+  /**
+   * Add every item under `tree[index]` to `visible`, without testing them
+   */
+  void addAll(std::uint32_t index, std::vector<std::uint32_t> &visible) const;
+
+public:
+  /**
+   * Remove every item
+   */
+  void clear();
+
+  /**
+   * Build the hierarchy over a new set of items
+   *
+   * @param itemBounds
+   * The world space bounds of each item, in item index order
+   */
+  void build(std::vector<Box> itemBounds);
+
+  /**
+   * @return
+   * The number of items in the hierarchy
+   */
+  [[nodiscard]] std::size_t size() const;
+
+  /**
+   * Change the bounds of an item. Ancestors
+   * are not updated until the next `refit()`
+   *
+   * @param index
+   * The index of the item to update
+   *
+   * @param box
+   * The new world space bounds of the item
+   */
+  void update(std::size_t index, const Box &box);
+
+  /**
+   * Update the ancestors of every item changed by `update()`
+   * since the last refit
+   */
+  void refit();
+
+  /**
+   * Find the closest accepted item hit by a ray.
+   * Call `refit()` first
+   *
+   * @param origin
+   * The start of the ray, in render coordinates
+   *
+   * @param direction
+   * The direction of the ray
+   *
+   * @param accept
+   * Called with the index of each item hit,
+   * returns false to ignore that item
+   *
+   * @return
+   * The index of the closest item hit, unset if none were
+   */
+  template <class Accept>
+  [[nodiscard]] std::optional<std::size_t> pick(const glm::vec3 &origin, const glm::vec3 &direction,
+                                                Accept accept) const;
+
+  /**
+   * Find every item which may be in view.
+   * Call `refit()` first
+   *
+   * @param frustum
+   * The volume to test the items against
+   *
+   * @param visible
+   * Cleared, then filled with the index of each item in view,
+   * in no particular order
+   */
+  void cull(const Frustum &frustum, std::vector<std::uint32_t> &visible) const;
+};
+
+template <class Accept>
+std::optional<std::size_t> BoundingVolumeHierarchy::pick(const glm::vec3 &origin, const glm::vec3 &direction,
+                                                         Accept accept) const {
+  if (tree.empty())
+    return {};
+
+  const auto inverseDirection = 1.0f / direction;
+
+  std::optional<std::size_t> closest;
+  auto closestDistance = std::numeric_limits<float>::max();
+
+  std::vector<std::uint32_t> stack{0u};
+  while (!stack.empty()) {
+    const auto &node = tree[stack.back()];
+    stack.pop_back();
+
+    const auto distance = node.box.intersect(origin, inverseDirection);
+    if (!distance || distance.value() > closestDistance)
+      continue;
+
+    if (node.count == 0u) {
+      stack.emplace_back(node.first);
+      stack.emplace_back(node.first + 1u);
+      continue;
+    }
+
+    for (auto i = node.first; i < node.first + node.count; i++) {
+      const auto item = items[i];
+      if (!accept(static_cast<std::size_t>(item)))
+        continue;
+
+      const auto hit = bounds[item].intersect(origin, inverseDirection);
+      if (hit && hit.value() < closestDistance) {
+        closestDistance = hit.value();
+        closest = item;
+      }
+    }
+  }
+
+  return closest;
+}
+
+} // namespace netsimulyzer
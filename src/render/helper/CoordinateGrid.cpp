@@ -42,9 +42,9 @@ const CoordinateGrid::RenderInfo &CoordinateGrid::getRenderInfo() const {
   return renderInfo;
 }
 
-void CoordinateGrid::resized(std::size_t size, float squareSize) {
-  renderInfo.size = size;
+void CoordinateGrid::resized(float squareSize, float stepSize) {
   renderInfo.squareSize = squareSize;
+  renderInfo.stepSize = stepSize;
 }
 
 float CoordinateGrid::getHeight() const {
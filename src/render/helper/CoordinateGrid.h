@@ -33,13 +33,14 @@
 
 #pragma once
 
-#include <cstddef>
 #include <glm/vec2.hpp>
 
 namespace netsimulyzer {
 
 /**
- * Resizeable square grid aligned with the X axis
+ * Resizeable square grid aligned with the X axis.
+ * Drawn as a single quad, the lines are found in the fragment shader,
+ * so resizing or changing the step never uploads anything
  */
 class CoordinateGrid {
 public:
@@ -50,14 +51,22 @@ public:
   struct RenderInfo {
     unsigned int vao = 0u;
     unsigned int vbo = 0u;
-    std::size_t size = 0u;
+
+    /**
+     * Half the width of the grid
+     */
     float squareSize = 0.0f;
+
+    /**
+     * The distance between lines
+     */
+    float stepSize = 1.0f;
   };
 
   explicit CoordinateGrid(const CoordinateGrid::RenderInfo &renderInfo);
 
   [[nodiscard]] const RenderInfo &getRenderInfo() const;
-  void resized(std::size_t size, float squareSize);
+  void resized(float squareSize, float stepSize);
 
   [[nodiscard]] float getHeight() const;
   void setHeight(float value);
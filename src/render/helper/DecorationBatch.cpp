@@ -0,0 +1,104 @@
+/*
+ * NIST-developed software is provided by NIST as a public service. You may use,
+ * copy and distribute copies of the software in any medium, provided that you
+ * keep intact this entire notice. You may improve,modify and create derivative
+ * works of the software or any portion of the software, and you may copy and
+ * distribute such modifications or works. Modified works should carry a notice
+ * stating that you changed the software and should note the date and nature of
+ * any such change. Please explicitly acknowledge the National Institute of
+ * Standards and Technology as the source of the software.
+ *
+ * NIST-developed software is expressly provided "AS IS." NIST MAKES NO
+ * WARRANTY OF ANY KIND, EXPRESS, IMPLIED, IN FACT OR ARISING BY OPERATION OF
+ * LAW, INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTY OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, NON-INFRINGEMENT
+ * AND DATA ACCURACY. NIST NEITHER REPRESENTS NOR WARRANTS THAT THE
+ * OPERATION OF THE SOFTWARE WILL BE UNINTERRUPTED OR ERROR-FREE, OR THAT
+ * ANY DEFECTS WILL BE CORRECTED. NIST DOES NOT WARRANT OR MAKE ANY
+ * REPRESENTATIONS REGARDING THE USE OF THE SOFTWARE OR THE RESULTS THEREOF,
+ * INCLUDING BUT NOT LIMITED TO THE CORRECTNESS, ACCURACY, RELIABILITY,
+ * OR USEFULNESS OF THE SOFTWARE.
+ *
+ * You are solely responsible for determining the appropriateness of using and
+ * distributing the software and you assume all risks associated with its use,
+ * including but not limited to the risks and costs of program errors,
+ * compliance with applicable laws, damage to or loss of data, programs or
+ * equipment, and the unavailability or interruption of operation. This
+ * software is not intended to be used in any situation where a failure could
+ * cause risk of injury or damage to property. The software developed by NIST
+ * employees is not subject to copyright protection within the United States.
+ *
+ * Author: Evan Black <evan.black@nist.gov>
+ */
+
+#include "DecorationBatch.h"
+#include "../model/ModelCache.h"
+
+namespace netsimulyzer {
+
+DecorationBatch::DecorationBatch() {
+  initializeOpenGLFunctions();
+}
+
+void DecorationBatch::add(const Model &model, const BoundingVolumeHierarchy::Box &bounds) {
+  auto [entry, added] = groupIndex.try_emplace(model.getModelId(), groups.size());
+  if (added)
+    groups.emplace_back().model = model.getModelId();
+
+  auto &group = groups[entry->second];
+  group.decorations.emplace_back(model.getModelMatrix());
+  group.bounds.expand(bounds);
+}
+
+void DecorationBatch::build(ModelCache &models) {
+  placements.clear();
+
+  const auto bake = [this](Group &group, const Mesh &mesh) {
+    auto &range = group.meshes.emplace_back();
+    range.first = placements.size();
+
+    const auto &references = mesh.getReferences();
+    for (const auto &decoration : group.decorations) {
+      if (references.empty()) {
+        placements.emplace_back(decoration);
+        continue;
+      }
+
+      for (const auto &reference : references)
+        placements.emplace_back(decoration * reference);
+    }
+    range.count = static_cast<int>(placements.size() - range.first);
+  };
+
+  for (auto &group : groups) {
+    group.meshes.clear();
+    auto &renderInfo = models.get(group.model);
+    for (const auto &mesh : renderInfo.getMeshes())
+      bake(group, mesh);
+    for (const auto &mesh : renderInfo.getTransparentMeshes())
+      bake(group, mesh);
+  }
+}
+
+bool DecorationBatch::empty() const {
+  return groups.empty();
+}
+
+const std::vector<DecorationBatch::Group> &DecorationBatch::getGroups() const {
+  return groups;
+}
+
+const std::vector<glm::mat4> &DecorationBatch::getPlacements() const {
+  return placements;
+}
+
+void DecorationBatch::uploaded(unsigned int value) {
+  vbo = value;
+  placements = {};
+}
+
+unsigned int DecorationBatch::getVbo() const {
+  return vbo;
+}
+
+} // namespace netsimulyzer
@@ -0,0 +1,150 @@
+/*
+ * NIST-developed software is provided by NIST as a public service. You may use,
+ * copy and distribute copies of the software in any medium, provided that you
+ * keep intact this entire notice. You may improve,modify and create derivative
+ * works of the software or any portion of the software, and you may copy and
+ * distribute such modifications or works. Modified works should carry a notice
+ * stating that you changed the software and should note the date and nature of
+ * any such change. Please explicitly acknowledge the National Institute of
+ * Standards and Technology as the source of the software.
+ *
+ * NIST-developed software is expressly provided "AS IS." NIST MAKES NO
+ * WARRANTY OF ANY KIND, EXPRESS, IMPLIED, IN FACT OR ARISING BY OPERATION OF
+ * LAW, INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTY OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, NON-INFRINGEMENT
+ * AND DATA ACCURACY. NIST NEITHER REPRESENTS NOR WARRANTS THAT THE
+ * OPERATION OF THE SOFTWARE WILL BE UNINTERRUPTED OR ERROR-FREE, OR THAT
+ * ANY DEFECTS WILL BE CORRECTED. NIST DOES NOT WARRANT OR MAKE ANY
+ * REPRESENTATIONS REGARDING THE USE OF THE SOFTWARE OR THE RESULTS THEREOF,
+ * INCLUDING BUT NOT LIMITED TO THE CORRECTNESS, ACCURACY, RELIABILITY,
+ * OR USEFULNESS OF THE SOFTWARE.
+ *
+ * You are solely responsible for determining the appropriateness of using and
+ * distributing the software and you assume all risks associated with its use,
+ * including but not limited to the risks and costs of program errors,
+ * compliance with applicable laws, damage to or loss of data, programs or
+ * equipment, and the unavailability or interruption of operation. This
+ * software is not intended to be used in any situation where a failure could
+ * cause risk of injury or damage to property. The software developed by NIST
+ * employees is not subject to copyright protection within the United States.
+ *
+ * Author: Evan Black <evan.black@nist.gov>
+ */
+
+#pragma once
+
+#include "../model/Model.h"
+#include "BoundingVolumeHierarchy.h"
+#include <QOpenGLFunctions_3_3_Core>
+#include <cstddef>
+#include <glm/glm.hpp>
+#include <unordered_map>
+#include <vector>
+
+namespace netsimulyzer {
+
+class ModelCache;
+
+/**
+ * Decorations which never move, baked into one buffer of placements.
+ *
+ * Decorations are grouped by model. The placement of each mesh in every Decoration of a group,
+ * including the mesh's own references, is written to the buffer once,
+ * so each mesh of a group is drawn for every one of its Decorations in one instanced draw,
+ * rather than once per Decoration
+ */
+class DecorationBatch : protected QOpenGLFunctions_3_3_Core {
+public:
+  /**
+   * The placements of one mesh in the buffer
+   */
+  struct Range {
+    std::size_t first{0u};
+    int count{0};
+  };
+
+  /**
+   * The Decorations sharing one model
+   */
+  struct Group {
+    model_id model{0u};
+
+    /**
+     * The model matrix of each Decoration
+     */
+    std::vector<glm::mat4> decorations;
+
+    /**
+     * The placements of each mesh of the model, the opaque meshes then the transparent ones.
+     * Set by `build()`
+     */
+    std::vector<Range> meshes;
+
+    /**
+     * Covers every Decoration in the group, in world space
+     */
+    BoundingVolumeHierarchy::Box bounds;
+  };
+
+private:
+  std::vector<Group> groups;
+
+  /**
+   * Index in `groups` of each model
+   */
+  std::unordered_map<model_id, std::size_t> groupIndex;
+
+  /**
+   * Application side placements, cleared once uploaded by `Renderer::allocate()`
+   */
+  std::vector<glm::mat4> placements;
+
+  unsigned int vbo{0u};
+
+public:
+  DecorationBatch();
+  DecorationBatch(const DecorationBatch &) = delete;
+  DecorationBatch &operator=(const DecorationBatch &) = delete;
+
+  /**
+   * Add a Decoration to the group of its model
+   *
+   * @param model
+   * The model of the Decoration, placed where the Decoration stays
+   *
+   * @param bounds
+   * The world space bounds of the Decoration
+   */
+  void add(const Model &model, const BoundingVolumeHierarchy::Box &bounds);
+
+  /**
+   * Bake the placement of every mesh of every group, to be uploaded.
+   * The meshes of each model are read from `models`, so call again if any of them change
+   *
+   * @param models
+   * The cache holding the model of each group
+   */
+  void build(ModelCache &models);
+
+  [[nodiscard]] bool empty() const;
+
+  [[nodiscard]] const std::vector<Group> &getGroups() const;
+
+  [[nodiscard]] const std::vector<glm::mat4> &getPlacements() const;
+
+  /**
+   * Use the uploaded buffer, and clear the application side copy
+   *
+   * @param value
+   * The buffer with the placements from `getPlacements()`, owned by the `Renderer`
+   */
+  void uploaded(unsigned int value);
+
+  /**
+   * @return
+   * The buffer of placements read by `Mesh::renderPlaced()`
+   */
+  [[nodiscard]] unsigned int getVbo() const;
+};
+
+} // namespace netsimulyzer
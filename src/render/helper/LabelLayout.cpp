@@ -0,0 +1,91 @@
+/*
+ * NIST-developed software is provided by NIST as a public service. You may use,
+ * copy and distribute copies of the software in any medium, provided that you
+ * keep intact this entire notice. You may improve,modify and create derivative
+ * works of the software or any portion of the software, and you may copy and
+ * distribute such modifications or works. Modified works should carry a notice
+ * stating that you changed the software and should note the date and nature of
+ * any such change. Please explicitly acknowledge the National Institute of
+ * Standards and Technology as the source of the software.
+ *
+ * NIST-developed software is expressly provided "AS IS." NIST MAKES NO
+ * WARRANTY OF ANY KIND, EXPRESS, IMPLIED, IN FACT OR ARISING BY OPERATION OF
+ * LAW, INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTY OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, NON-INFRINGEMENT
+ * AND DATA ACCURACY. NIST NEITHER REPRESENTS NOR WARRANTS THAT THE
+ * OPERATION OF THE SOFTWARE WILL BE UNINTERRUPTED OR ERROR-FREE, OR THAT
+ * ANY DEFECTS WILL BE CORRECTED. NIST DOES NOT WARRANT OR MAKE ANY
+ * REPRESENTATIONS REGARDING THE USE OF THE SOFTWARE OR THE RESULTS THEREOF,
+ * INCLUDING BUT NOT LIMITED TO THE CORRECTNESS, ACCURACY, RELIABILITY,
+ * OR USEFULNESS OF THE SOFTWARE.
+ *
+ * You are solely responsible for determining the appropriateness of using and
+ * distributing the software and you assume all risks associated with its use,
+ * including but not limited to the risks and costs of program errors,
+ * compliance with applicable laws, damage to or loss of data, programs or
+ * equipment, and the unavailability or interruption of operation. This
+ * software is not intended to be used in any situation where a failure could
+ * cause risk of injury or damage to property. The software developed by NIST
+ * employees is not subject to copyright protection within the United States.
+ *
+ * Author: Evan Black <evan.black@nist.gov>
+ */
+
+#include "LabelLayout.h"
+#include <algorithm>
+#include <cmath>
+
+namespace netsimulyzer {
+
+void LabelLayout::begin(const glm::mat4 &view, const glm::mat4 &projection, const glm::vec2 &viewport,
+                        float labelScale) {
+  viewProjection = projection * view;
+  pixelsPerUnit = glm::vec2{projection[0][0], projection[1][1]} * viewport * 0.5f;
+  viewportSize = viewport;
+  scale = labelScale;
+
+  columns = static_cast<int>(std::ceil(viewport.x / cellPixels));
+  rows = static_cast<int>(std::ceil(viewport.y / cellPixels));
+  occupied.assign(static_cast<std::size_t>(std::max(0, columns * rows)), 0u);
+}
+
+bool LabelLayout::place(const glm::vec3 &anchor, const glm::vec2 &min, const glm::vec2 &max) {
+  const auto clip = viewProjection * glm::vec4{anchor, 1.0f};
+
+  // Behind the camera
+  if (clip.w <= 0.0f)
+    return false;
+
+  // Labels face the camera, so their size only depends on the distance
+  const glm::vec2 center = (glm::vec2{clip} / clip.w + 1.0f) * 0.5f * viewportSize;
+  const auto unitPixels = pixelsPerUnit * scale / clip.w;
+  const auto low = center + min * unitPixels;
+  const auto high = center + max * unitPixels;
+
+  if (high.y - low.y < minPixels)
+    return false;
+
+  if (high.x < 0.0f || high.y < 0.0f || low.x >= viewportSize.x || low.y >= viewportSize.y)
+    return false;
+
+  // Only the part on screen may cover another label
+  const auto firstColumn = std::max(0, static_cast<int>(low.x) / cellPixels);
+  const auto lastColumn = std::min(columns - 1, static_cast<int>(high.x) / cellPixels);
+  const auto firstRow = std::max(0, static_cast<int>(low.y) / cellPixels);
+  const auto lastRow = std::min(rows - 1, static_cast<int>(high.y) / cellPixels);
+
+  for (auto row = firstRow; row <= lastRow; row++) {
+    for (auto column = firstColumn; column <= lastColumn; column++) {
+      if (occupied[static_cast<std::size_t>(row * columns + column)])
+        return false;
+    }
+  }
+
+  for (auto row = firstRow; row <= lastRow; row++) {
+    std::fill_n(occupied.begin() + row * columns + firstColumn, lastColumn - firstColumn + 1, 1u);
+  }
+
+  return true;
+}
+
+} // namespace netsimulyzer
@@ -0,0 +1,116 @@
+/*
+ * NIST-developed software is provided by NIST as a public service. You may use,
+ * copy and distribute copies of the software in any medium, provided that you
+ * keep intact this entire notice. You may improve,modify and create derivative
+ * works of the software or any portion of the software, and you may copy and
+ * distribute such modifications or works. Modified works should carry a notice
+ * stating that you changed the software and should note the date and nature of
+ * any such change. Please explicitly acknowledge the National Institute of
+ * Standards and Technology as the source of the software.
+ *
+ * NIST-developed software is expressly provided "AS IS." NIST MAKES NO
+ * WARRANTY OF ANY KIND, EXPRESS, IMPLIED, IN FACT OR ARISING BY OPERATION OF
+ * LAW, INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTY OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, NON-INFRINGEMENT
+ * AND DATA ACCURACY. NIST NEITHER REPRESENTS NOR WARRANTS THAT THE
+ * OPERATION OF THE SOFTWARE WILL BE UNINTERRUPTED OR ERROR-FREE, OR THAT
+ * ANY DEFECTS WILL BE CORRECTED. NIST DOES NOT WARRANT OR MAKE ANY
+ * REPRESENTATIONS REGARDING THE USE OF THE SOFTWARE OR THE RESULTS THEREOF,
+ * INCLUDING BUT NOT LIMITED TO THE CORRECTNESS, ACCURACY, RELIABILITY,
+ * OR USEFULNESS OF THE SOFTWARE.
+ *
+ * You are solely responsible for determining the appropriateness of using and
+ * distributing the software and you assume all risks associated with its use,
+ * including but not limited to the risks and costs of program errors,
+ * compliance with applicable laws, damage to or loss of data, programs or
+ * equipment, and the unavailability or interruption of operation. This
+ * software is not intended to be used in any situation where a failure could
+ * cause risk of injury or damage to property. The software developed by NIST
+ * employees is not subject to copyright protection within the United States.
+ *
+ * Author: Evan Black <evan.black@nist.gov>
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <vector>
+
+namespace netsimulyzer {
+
+/**
+ * Picks which labels to draw this frame, so labels are not drawn
+ * off screen, too small to read, or on top of each other.
+ *
+ * Each label is projected to the screen & marked in a grid of small cells.
+ * A label which covers an already marked cell is dropped,
+ * so place labels in order of priority
+ */
+class LabelLayout {
+  /**
+   * The width & height of each cell, in pixels.
+   * Labels closer than this may be dropped
+   */
+  static constexpr int cellPixels = 8;
+
+  /**
+   * Labels shorter than this, in pixels, are too small to read
+   */
+  static constexpr float minPixels = 4.0f;
+
+  glm::mat4 viewProjection{1.0f};
+
+  /**
+   * Pixels per unit along each axis of the screen, 1 unit from the camera
+   */
+  glm::vec2 pixelsPerUnit{1.0f};
+
+  glm::vec2 viewportSize{1.0f};
+  float scale{1.0f};
+  int columns{0};
+  int rows{0};
+
+  /**
+   * Set for each cell covered by a placed label
+   */
+  std::vector<std::uint8_t> occupied;
+
+public:
+  /**
+   * Clear every placed label, for a new frame
+   *
+   * @param view
+   * The view matrix of the camera
+   *
+   * @param projection
+   * The projection matrix of the camera
+   *
+   * @param viewport
+   * The size of the viewport, in pixels
+   *
+   * @param labelScale
+   * The scale the labels are drawn with, see `Renderer::renderLabels()`
+   */
+  void begin(const glm::mat4 &view, const glm::mat4 &projection, const glm::vec2 &viewport, float labelScale);
+
+  /**
+   * Try to place a label
+   *
+   * @param anchor
+   * The point the label is drawn at
+   *
+   * @param min
+   * The lower left corner of the label, relative to `anchor`, before scaling
+   *
+   * @param max
+   * The upper right corner of the label, relative to `anchor`, before scaling
+   *
+   * @return
+   * True if the label should be drawn,
+   * false if it is off screen, too small, or covered by a placed label
+   */
+  [[nodiscard]] bool place(const glm::vec3 &anchor, const glm::vec2 &min, const glm::vec2 &max);
+};
+
+} // namespace netsimulyzer
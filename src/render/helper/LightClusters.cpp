@@ -0,0 +1,153 @@
+/*
+ * NIST-developed software is provided by NIST as a public service. You may use,
+ * copy and distribute copies of the software in any medium, provided that you
+ * keep intact this entire notice. You may improve,modify and create derivative
+ * works of the software or any portion of the software, and you may copy and
+ * distribute such modifications or works. Modified works should carry a notice
+ * stating that you changed the software and should note the date and nature of
+ * any such change. Please explicitly acknowledge the National Institute of
+ * Standards and Technology as the source of the software.
+ *
+ * NIST-developed software is expressly provided "AS IS." NIST MAKES NO
+ * WARRANTY OF ANY KIND, EXPRESS, IMPLIED, IN FACT OR ARISING BY OPERATION OF
+ * LAW, INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTY OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, NON-INFRINGEMENT
+ * AND DATA ACCURACY. NIST NEITHER REPRESENTS NOR WARRANTS THAT THE
+ * OPERATION OF THE SOFTWARE WILL BE UNINTERRUPTED OR ERROR-FREE, OR THAT
+ * ANY DEFECTS WILL BE CORRECTED. NIST DOES NOT WARRANT OR MAKE ANY
+ * REPRESENTATIONS REGARDING THE USE OF THE SOFTWARE OR THE RESULTS THEREOF,
+ * INCLUDING BUT NOT LIMITED TO THE CORRECTNESS, ACCURACY, RELIABILITY,
+ * OR USEFULNESS OF THE SOFTWARE.
+ *
+ * You are solely responsible for determining the appropriateness of using and
+ * distributing the software and you assume all risks associated with its use,
+ * including but not limited to the risks and costs of program errors,
+ * compliance with applicable laws, damage to or loss of data, programs or
+ * equipment, and the unavailability or interruption of operation. This
+ * software is not intended to be used in any situation where a failure could
+ * cause risk of injury or damage to property. The software developed by NIST
+ * employees is not subject to copyright protection within the United States.
+ *
+ * Author: Evan Black <evan.black@nist.gov>
+ */
+
+#include "LightClusters.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <tuple>
+#include <utility>
+
+namespace netsimulyzer {
+
+unsigned int LightClusters::slice(float depth) const {
+  const auto position = std::log(depth / near) / std::log(far / near) * static_cast<float>(slices);
+  return static_cast<unsigned int>(std::clamp(position, 0.0f, static_cast<float>(slices - 1u)));
+}
+
+LightClusters::LightClusters() {
+  table.assign(2u * clusterCount, 0u);
+}
+
+void LightClusters::bin(const std::vector<PointLight> &lights, const glm::mat4 &view, const glm::mat4 &projection) {
+  table.assign(2u * clusterCount, 0u);
+  spans.clear();
+
+  // Only perspective projections divide by the depth
+  if (projection[2][3] == 0.0f || lights.empty())
+    return;
+
+  // The planes of `glm::perspective()`
+  near = projection[3][2] / (projection[2][2] - 1.0f);
+  far = projection[3][2] / (projection[2][2] + 1.0f);
+
+  // A range of normalized device coordinates to the columns or rows covering it
+  auto cells = [](float low, float high, unsigned int count) {
+    const auto scale = static_cast<float>(count) * 0.5f;
+    const auto last = static_cast<float>(count - 1u);
+    return std::make_pair(static_cast<unsigned int>(std::clamp(std::floor((low + 1.0f) * scale), 0.0f, last)),
+                          static_cast<unsigned int>(std::clamp(std::floor((high + 1.0f) * scale), 0.0f, last)));
+  };
+
+  for (std::uint32_t i = 0u; i < lights.size(); i++) {
+    const auto &light = lights[i];
+    const auto center = glm::vec3{view * glm::vec4{light.position, 1.0f}};
+    const auto depth = -center.z;
+    const auto radius = light.range;
+    if (depth + radius < near || depth - radius > far)
+      continue;
+
+    Span span{i, {0u, 0u, slice(std::max(depth - radius, near))}, {columns - 1u, rows - 1u, slice(depth + radius)}};
+
+    // Across the near plane the sphere may cover any part of the screen.
+    // Otherwise, its box projects within the extremes of its nearest & furthest sides
+    if (depth - radius > near) {
+      std::array<float, 4> x{};
+      std::array<float, 4> y{};
+      for (std::size_t corner = 0u; corner < 4u; corner++) {
+        const auto side = corner % 2u == 0u ? -radius : radius;
+        const auto distance = corner < 2u ? depth - radius : depth + radius;
+        x[corner] = projection[0][0] * (center.x + side) / distance;
+        y[corner] = projection[1][1] * (center.y + side) / distance;
+      }
+
+      const auto [lowX, highX] = std::minmax_element(x.begin(), x.end());
+      const auto [lowY, highY] = std::minmax_element(y.begin(), y.end());
+      if (*highX < -1.0f || *lowX > 1.0f || *highY < -1.0f || *lowY > 1.0f)
+        continue;
+
+      std::tie(span.min.x, span.max.x) = cells(*lowX, *highX, columns);
+      std::tie(span.min.y, span.max.y) = cells(*lowY, *highY, rows);
+    }
+
+    spans.emplace_back(span);
+  }
+
+  auto cluster = [](unsigned int column, unsigned int row, unsigned int depthSlice) {
+    return (depthSlice * rows + row) * columns + column;
+  };
+
+  // Count the lights of each cluster, then place each cluster's lights after the last
+  for (const auto &span : spans) {
+    for (auto z = span.min.z; z <= span.max.z; z++) {
+      for (auto y = span.min.y; y <= span.max.y; y++) {
+        for (auto x = span.min.x; x <= span.max.x; x++)
+          table[2u * cluster(x, y, z) + 1u]++;
+      }
+    }
+  }
+
+  std::uint32_t next = 2u * clusterCount;
+  for (unsigned int i = 0u; i < clusterCount; i++) {
+    table[2u * i] = next;
+    next += table[2u * i + 1u];
+    // Counted up again as the lights are placed
+    table[2u * i + 1u] = 0u;
+  }
+  table.resize(next);
+
+  for (const auto &span : spans) {
+    for (auto z = span.min.z; z <= span.max.z; z++) {
+      for (auto y = span.min.y; y <= span.max.y; y++) {
+        for (auto x = span.min.x; x <= span.max.x; x++) {
+          const auto index = cluster(x, y, z);
+          table[table[2u * index] + table[2u * index + 1u]++] = span.light;
+        }
+      }
+    }
+  }
+}
+
+const std::vector<std::uint32_t> &LightClusters::getTable() const {
+  return table;
+}
+
+float LightClusters::getNear() const {
+  return near;
+}
+
+float LightClusters::getFar() const {
+  return far;
+}
+
+} // namespace netsimulyzer
@@ -0,0 +1,123 @@
+/*
+ * NIST-developed software is provided by NIST as a public service. You may use,
+ * copy and distribute copies of the software in any medium, provided that you
+ * keep intact this entire notice. You may improve,modify and create derivative
+ * works of the software or any portion of the software, and you may copy and
+ * distribute such modifications or works. Modified works should carry a notice
+ * stating that you changed the software and should note the date and nature of
+ * any such change. Please explicitly acknowledge the National Institute of
+ * Standards and Technology as the source of the software.
+ *
+ * NIST-developed software is expressly provided "AS IS." NIST MAKES NO
+ * WARRANTY OF ANY KIND, EXPRESS, IMPLIED, IN FACT OR ARISING BY OPERATION OF
+ * LAW, INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTY OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, NON-INFRINGEMENT
+ * AND DATA ACCURACY. NIST NEITHER REPRESENTS NOR WARRANTS THAT THE
+ * OPERATION OF THE SOFTWARE WILL BE UNINTERRUPTED OR ERROR-FREE, OR THAT
+ * ANY DEFECTS WILL BE CORRECTED. NIST DOES NOT WARRANT OR MAKE ANY
+ * REPRESENTATIONS REGARDING THE USE OF THE SOFTWARE OR THE RESULTS THEREOF,
+ * INCLUDING BUT NOT LIMITED TO THE CORRECTNESS, ACCURACY, RELIABILITY,
+ * OR USEFULNESS OF THE SOFTWARE.
+ *
+ * You are solely responsible for determining the appropriateness of using and
+ * distributing the software and you assume all risks associated with its use,
+ * including but not limited to the risks and costs of program errors,
+ * compliance with applicable laws, damage to or loss of data, programs or
+ * equipment, and the unavailability or interruption of operation. This
+ * software is not intended to be used in any situation where a failure could
+ * cause risk of injury or damage to property. The software developed by NIST
+ * employees is not subject to copyright protection within the United States.
+ *
+ * Author: Evan Black <evan.black@nist.gov>
+ */
+
+#pragma once
+
+#include "../Light.h"
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <vector>
+
+namespace netsimulyzer {
+
+/**
+ * Bins lights into clusters of the view frustum, so each fragment only evaluates
+ * the lights which may reach it, rather than every light in the scene.
+ *
+ * The frustum is split into `columns` by `rows` tiles on screen,
+ * and into `slices` in depth, spaced exponentially between the near & far planes,
+ * so clusters far away are about as deep as they are wide.
+ * Each light is added to every cluster its sphere may touch
+ */
+class LightClusters {
+public:
+  static constexpr unsigned int columns = 16u;
+  static constexpr unsigned int rows = 9u;
+  static constexpr unsigned int slices = 24u;
+  static constexpr unsigned int clusterCount = columns * rows * slices;
+
+private:
+  /**
+   * Two entries per cluster, the index in `table` of its first light & its number of lights,
+   * followed by the lights of every cluster
+   */
+  std::vector<std::uint32_t> table;
+
+  /**
+   * The range of clusters of each light binned, see `bin()`
+   */
+  struct Span {
+    std::uint32_t light;
+    glm::uvec3 min;
+    glm::uvec3 max;
+  };
+  std::vector<Span> spans;
+
+  float near{0.1f};
+  float far{1000.0f};
+
+  /**
+   * @return
+   * The slice holding a view space depth between `near` & `far`
+   */
+  [[nodiscard]] unsigned int slice(float depth) const;
+
+public:
+  LightClusters();
+
+  /**
+   * Bin every light for one view. Orthographic projections have no clusters,
+   * so every cluster is left empty
+   *
+   * @param lights
+   * The lights, in world space
+   *
+   * @param view
+   * The view matrix of the camera
+   *
+   * @param projection
+   * The projection of the camera
+   */
+  void bin(const std::vector<PointLight> &lights, const glm::mat4 &view, const glm::mat4 &projection);
+
+  /**
+   * @return
+   * The lights of each cluster, laid out as `model.frag` reads them.
+   * Holds at least an entry for each cluster, even without lights
+   */
+  [[nodiscard]] const std::vector<std::uint32_t> &getTable() const;
+
+  /**
+   * @return
+   * The view space depth of the first slice
+   */
+  [[nodiscard]] float getNear() const;
+
+  /**
+   * @return
+   * The view space depth of the end of the last slice
+   */
+  [[nodiscard]] float getFar() const;
+};
+
+} // namespace netsimulyzer
@@ -0,0 +1,218 @@
+/*
+ * NIST-developed software is provided by NIST as a public service. You may use,
+ * copy and distribute copies of the software in any medium, provided that you
+ * keep intact this entire notice. You may improve,modify and create derivative
+ * works of the software or any portion of the software, and you may copy and
+ * distribute such modifications or works. Modified works should carry a notice
+ * stating that you changed the software and should note the date and nature of
+ * any such change. Please explicitly acknowledge the National Institute of
+ * Standards and Technology as the source of the software.
+ *
+ * NIST-developed software is expressly provided "AS IS." NIST MAKES NO
+ * WARRANTY OF ANY KIND, EXPRESS, IMPLIED, IN FACT OR ARISING BY OPERATION OF
+ * LAW, INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTY OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, NON-INFRINGEMENT
+ * AND DATA ACCURACY. NIST NEITHER REPRESENTS NOR WARRANTS THAT THE
+ * OPERATION OF THE SOFTWARE WILL BE UNINTERRUPTED OR ERROR-FREE, OR THAT
+ * ANY DEFECTS WILL BE CORRECTED. NIST DOES NOT WARRANT OR MAKE ANY
+ * REPRESENTATIONS REGARDING THE USE OF THE SOFTWARE OR THE RESULTS THEREOF,
+ * INCLUDING BUT NOT LIMITED TO THE CORRECTNESS, ACCURACY, RELIABILITY,
+ * OR USEFULNESS OF THE SOFTWARE.
+ *
+ * You are solely responsible for determining the appropriateness of using and
+ * distributing the software and you assume all risks associated with its use,
+ * including but not limited to the risks and costs of program errors,
+ * compliance with applicable laws, damage to or loss of data, programs or
+ * equipment, and the unavailability or interruption of operation. This
+ * software is not intended to be used in any situation where a failure could
+ * cause risk of injury or damage to property. The software developed by NIST
+ * employees is not subject to copyright protection within the United States.
+ *
+ * Author: Evan Black <evan.black@nist.gov>
+ */
+
+#include "NodeGrid.h"
+#include <algorithm>
+#include <cmath>
+
+namespace netsimulyzer {
+
+std::uint64_t NodeGrid::key(std::int32_t x, std::int32_t z, int level) {
+  constexpr std::uint64_t mask = (1ULL << 28u) - 1ULL;
+  return (static_cast<std::uint64_t>(level) << 56u) | ((static_cast<std::uint64_t>(x) & mask) << 28u) |
+         (static_cast<std::uint64_t>(z) & mask);
+}
+
+std::int32_t NodeGrid::keyX(std::uint64_t key) {
+  // Sign extend the 28 bit coordinate
+  return static_cast<std::int32_t>(static_cast<std::uint32_t>(key >> 28u) << 4u) >> 4;
+}
+
+std::int32_t NodeGrid::keyZ(std::uint64_t key) {
+  return static_cast<std::int32_t>(static_cast<std::uint32_t>(key) << 4u) >> 4;
+}
+
+std::int32_t NodeGrid::cellCoordinate(float position) const {
+  return static_cast<std::int32_t>(std::floor(position / cellSize));
+}
+
+void NodeGrid::leave(std::size_t index) {
+  const auto cellKey = nodeCells[index];
+  auto &cell = cells[cellKey];
+
+  // Swap the last member into this one's place
+  const auto memberIndex = memberIndices[index];
+  const auto last = cell.members.back();
+  cell.members[memberIndex] = last;
+  memberIndices[last] = memberIndex;
+  cell.members.pop_back();
+
+  if (cell.members.empty())
+    cells.erase(cellKey);
+  else
+    cell.sum -= positions[index];
+
+  nodeCells[index] = noCell;
+}
+
+void NodeGrid::clear() {
+  cells.clear();
+  nodeCells.clear();
+  memberIndices.clear();
+  positions.clear();
+  merged.clear();
+  bottom = std::numeric_limits<float>::max();
+  top = std::numeric_limits<float>::lowest();
+}
+
+void NodeGrid::setBounds(const glm::vec3 &min, const glm::vec3 &max) {
+  clear();
+
+  // Too small & a cell per Node, too large & one cell for all of them.
+  // The corners may be flipped by the conversion to render coordinates
+  const auto longest = std::max(std::abs(max.x - min.x), std::abs(max.z - min.z));
+  cellSize = std::max(1.0f, longest / cellsPerSide);
+}
+
+void NodeGrid::update(std::size_t index, const glm::vec3 &position) {
+  if (index >= nodeCells.size()) {
+    nodeCells.resize(index + 1u, noCell);
+    memberIndices.resize(index + 1u, 0u);
+    positions.resize(index + 1u);
+  }
+
+  bottom = std::min(bottom, position.y);
+  top = std::max(top, position.y);
+
+  const auto cellKey = key(cellCoordinate(position.x), cellCoordinate(position.z));
+  if (nodeCells[index] == cellKey) {
+    cells[cellKey].sum += position - positions[index];
+    positions[index] = position;
+    return;
+  }
+
+  if (nodeCells[index] != noCell)
+    leave(index);
+
+  auto &cell = cells[cellKey];
+  memberIndices[index] = static_cast<std::uint32_t>(cell.members.size());
+  cell.members.emplace_back(static_cast<std::uint32_t>(index));
+  cell.sum += position;
+  nodeCells[index] = cellKey;
+  positions[index] = position;
+}
+
+void NodeGrid::within(const glm::vec3 &center, float radius, std::vector<std::uint32_t> &found) const {
+  const auto minX = cellCoordinate(center.x - radius);
+  const auto maxX = cellCoordinate(center.x + radius);
+  const auto minZ = cellCoordinate(center.z - radius);
+  const auto maxZ = cellCoordinate(center.z + radius);
+  const auto radiusSquared = radius * radius;
+
+  const auto search = [this, &center, radiusSquared, &found](const Cell &cell) {
+    for (const auto member : cell.members) {
+      const auto offset = positions[member] - center;
+      if (glm::dot(offset, offset) <= radiusSquared)
+        found.emplace_back(member);
+    }
+  };
+
+  // Look up each cell in range, unless there are fewer occupied cells than that
+  const auto range = static_cast<std::size_t>(maxX - minX + 1) * static_cast<std::size_t>(maxZ - minZ + 1);
+  if (range > cells.size()) {
+    for (const auto &[cellKey, cell] : cells) {
+      const auto x = keyX(cellKey);
+      const auto z = keyZ(cellKey);
+      if (x >= minX && x <= maxX && z >= minZ && z <= maxZ)
+        search(cell);
+    }
+    return;
+  }
+
+  for (auto x = minX; x <= maxX; x++) {
+    for (auto z = minZ; z <= maxZ; z++) {
+      if (const auto cell = cells.find(key(x, z)); cell != cells.end())
+        search(cell->second);
+    }
+  }
+}
+
+void NodeGrid::visible(const Frustum &frustum, std::vector<std::uint32_t> &found) const {
+  for (const auto &[cellKey, cell] : cells) {
+    const glm::vec3 min{static_cast<float>(keyX(cellKey)) * cellSize, bottom,
+                        static_cast<float>(keyZ(cellKey)) * cellSize};
+    const glm::vec3 max{min.x + cellSize, top, min.z + cellSize};
+
+    switch (frustum.contains(min, max)) {
+    case Frustum::Containment::Outside:
+      break;
+    case Frustum::Containment::Inside:
+      found.insert(found.end(), cell.members.begin(), cell.members.end());
+      break;
+    case Frustum::Containment::Intersects:
+      for (const auto member : cell.members) {
+        if (frustum.intersects(positions[member], positions[member]))
+          found.emplace_back(member);
+      }
+      break;
+    }
+  }
+}
+
+void NodeGrid::collapse(const glm::vec3 &eye, float pixelsPerUnit, float minPixels, std::vector<Cluster> &clusters) {
+  merged.clear();
+  clusters.clear();
+
+  for (auto &[cellKey, cell] : cells) {
+    const auto count = cell.members.size();
+    const auto center = cell.sum / static_cast<float>(count);
+    const auto distance = std::max(glm::distance(center, eye), 0.001f);
+    const auto pixels = cellSize * pixelsPerUnit / distance;
+
+    cell.collapsed = pixels < minPixels;
+    if (!cell.collapsed)
+      continue;
+
+    // Each level doubles the width of the merged cell on screen
+    const auto level = std::min(maxLevel, static_cast<int>(std::ceil(std::log2(minPixels / pixels))));
+    auto &cluster = merged[key(keyX(cellKey) >> level, keyZ(cellKey) >> level, level)];
+    cluster.center += cell.sum;
+    cluster.count += count;
+  }
+
+  clusters.reserve(merged.size());
+  for (auto &[mergedKey, cluster] : merged) {
+    cluster.center /= static_cast<float>(cluster.count);
+    clusters.emplace_back(cluster);
+  }
+}
+
+bool NodeGrid::isCollapsed(std::size_t index) const {
+  if (index >= nodeCells.size() || nodeCells[index] == noCell)
+    return false;
+
+  const auto cell = cells.find(nodeCells[index]);
+  return cell != cells.end() && cell->second.collapsed;
+}
+
+} // namespace netsimulyzer
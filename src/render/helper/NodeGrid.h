@@ -0,0 +1,237 @@
+/*
+ * NIST-developed software is provided by NIST as a public service. You may use,
+ * copy and distribute copies of the software in any medium, provided that you
+ * keep intact this entire notice. You may improve,modify and create derivative
+ * works of the software or any portion of the software, and you may copy and
+ * distribute such modifications or works. Modified works should carry a notice
+ * stating that you changed the software and should note the date and nature of
+ * any such change. Please explicitly acknowledge the National Institute of
+ * Standards and Technology as the source of the software.
+ *
+ * NIST-developed software is expressly provided "AS IS." NIST MAKES NO
+ * WARRANTY OF ANY KIND, EXPRESS, IMPLIED, IN FACT OR ARISING BY OPERATION OF
+ * LAW, INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTY OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, NON-INFRINGEMENT
+ * AND DATA ACCURACY. NIST NEITHER REPRESENTS NOR WARRANTS THAT THE
+ * OPERATION OF THE SOFTWARE WILL BE UNINTERRUPTED OR ERROR-FREE, OR THAT
+ * ANY DEFECTS WILL BE CORRECTED. NIST DOES NOT WARRANT OR MAKE ANY
+ * REPRESENTATIONS REGARDING THE USE OF THE SOFTWARE OR THE RESULTS THEREOF,
+ * INCLUDING BUT NOT LIMITED TO THE CORRECTNESS, ACCURACY, RELIABILITY,
+ * OR USEFULNESS OF THE SOFTWARE.
+ *
+ * You are solely responsible for determining the appropriateness of using and
+ * distributing the software and you assume all risks associated with its use,
+ * including but not limited to the risks and costs of program errors,
+ * compliance with applicable laws, damage to or loss of data, programs or
+ * equipment, and the unavailability or interruption of operation. This
+ * software is not intended to be used in any situation where a failure could
+ * cause risk of injury or damage to property. The software developed by NIST
+ * employees is not subject to copyright protection within the United States.
+ *
+ * Author: Evan Black <evan.black@nist.gov>
+ */
+
+#pragma once
+
+#include "src/render/camera/Frustum.h"
+#include <cstddef>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <limits>
+#include <unordered_map>
+#include <vector>
+
+namespace netsimulyzer {
+
+/**
+ * Uniform grid over the ground plane, indexing Nodes by their position.
+ * Shared by anything which needs the Nodes near a point or in view,
+ * and used to collapse far away Nodes into cluster markers.
+ *
+ * Nodes are referenced by index, which is up to the owner to map back.
+ * A moved Node only leaves its old cell & joins its new one,
+ * and the coarser levels used for clusters are merged from the occupied cells when collapsing,
+ * so nothing is rebuilt as Nodes move
+ */
+class NodeGrid {
+public:
+  struct Cluster {
+    /**
+     * The average position of the Nodes in the cluster
+     */
+    glm::vec3 center{0.0f};
+    std::size_t count{0u};
+  };
+
+private:
+  /**
+   * The most times cells are merged with their neighbours,
+   * so a cluster covers at most `2^maxLevel` cells on each side
+   */
+  static constexpr int maxLevel = 10;
+
+  /**
+   * Cells along the longest side of the scenario, see `setBounds()`
+   */
+  static constexpr float cellsPerSide = 64.0f;
+
+  /**
+   * Marks a Node which is not in the grid
+   */
+  static constexpr std::uint64_t noCell = std::numeric_limits<std::uint64_t>::max();
+
+  struct Cell {
+    /**
+     * The Nodes in the cell, in no particular order
+     */
+    std::vector<std::uint32_t> members;
+
+    /**
+     * The sum of the positions of the Nodes in the cell
+     */
+    glm::vec3 sum{0.0f};
+
+    /**
+     * Set by `collapse()` when the cell is drawn as part of a cluster
+     */
+    bool collapsed{false};
+  };
+
+  /**
+   * The width of a cell on the finest level
+   */
+  float cellSize{10.0f};
+
+  /**
+   * The lowest & highest any Node has been, for the height of each cell in `visible()`
+   */
+  float bottom{std::numeric_limits<float>::max()};
+  float top{std::numeric_limits<float>::lowest()};
+
+  /**
+   * Occupied cells, keyed by `key()`
+   */
+  std::unordered_map<std::uint64_t, Cell> cells;
+
+  /**
+   * The cell of each Node, `noCell` if it is not in the grid
+   */
+  std::vector<std::uint64_t> nodeCells;
+
+  /**
+   * Where each Node is in its cell's `members`, so it may be removed without a search
+   */
+  std::vector<std::uint32_t> memberIndices;
+
+  /**
+   * The position each Node was last updated with
+   */
+  std::vector<glm::vec3> positions;
+
+  /**
+   * Reused between calls to `collapse()`, keyed by the level & the cell on that level
+   */
+  std::unordered_map<std::uint64_t, Cluster> merged;
+
+  /**
+   * Pack cell coordinates into a key, 28 bits each & the level in the top bits
+   */
+  [[nodiscard]] static std::uint64_t key(std::int32_t x, std::int32_t z, int level = 0);
+  [[nodiscard]] static std::int32_t keyX(std::uint64_t key);
+  [[nodiscard]] static std::int32_t keyZ(std::uint64_t key);
+
+  /**
+   * The cell containing `position` on the finest level
+   */
+  [[nodiscard]] std::int32_t cellCoordinate(float position) const;
+
+  /**
+   * Remove a Node from its cell, erasing the cell once empty
+   */
+  void leave(std::size_t index);
+
+public:
+  /**
+   * Remove every Node
+   */
+  void clear();
+
+  /**
+   * Size the cells for a scenario, so its longest side is about `cellsPerSide` cells.
+   * Removes every Node, so add them again after
+   *
+   * @param min
+   * The minimum corner of the scenario, in render coordinates
+   *
+   * @param max
+   * The maximum corner of the scenario, in render coordinates
+   */
+  void setBounds(const glm::vec3 &min, const glm::vec3 &max);
+
+  /**
+   * Add a Node to the grid, or move it if it is already in the grid
+   *
+   * @param index
+   * The index of the Node
+   *
+   * @param position
+   * The position of the Node, in render coordinates
+   */
+  void update(std::size_t index, const glm::vec3 &position);
+
+  /**
+   * Find the Nodes within a distance of a point
+   *
+   * @param center
+   * The point to search around, in render coordinates
+   *
+   * @param radius
+   * The furthest a Node may be from `center`
+   *
+   * @param found
+   * The index of each Node found is appended here
+   */
+  void within(const glm::vec3 &center, float radius, std::vector<std::uint32_t> &found) const;
+
+  /**
+   * Find the Nodes whose position is in view
+   *
+   * @param frustum
+   * The view to test against
+   *
+   * @param found
+   * The index of each Node found is appended here
+   */
+  void visible(const Frustum &frustum, std::vector<std::uint32_t> &found) const;
+
+  /**
+   * Decide which cells are far enough away to be drawn as clusters.
+   * Cells which look smaller than `minPixels` are merged with their neighbours,
+   * level by level, until the merged cell is at least that large on screen
+   *
+   * @param eye
+   * The position of the camera
+   *
+   * @param pixelsPerUnit
+   * The height in pixels of something 1 unit tall, 1 unit from the camera
+   *
+   * @param minPixels
+   * The smallest a cell may look before it is collapsed
+   *
+   * @param clusters
+   * Filled with the clusters to draw, replacing its contents
+   */
+  void collapse(const glm::vec3 &eye, float pixelsPerUnit, float minPixels, std::vector<Cluster> &clusters);
+
+  /**
+   * @param index
+   * The index of the Node to check
+   *
+   * @return
+   * True if the Node is drawn as part of a cluster from the last `collapse()`,
+   * so should not be drawn itself
+   */
+  [[nodiscard]] bool isCollapsed(std::size_t index) const;
+};
+
+} // namespace netsimulyzer
@@ -31,59 +31,74 @@
  * Author: Evan Black <evan.black@nist.gov>
  */
 
-#include "WiredLink.h"
-#include <glm/gtc/type_ptr.hpp>
-#include <utility>
+#include "OcclusionQueries.h"
 
-WiredLink::WiredLink(const WiredLink::RenderInfo &renderInfo, parser::WiredLink model)
-    : renderInfo(renderInfo), model(std::move(model)) {
-  initializeOpenGLFunctions();
+namespace netsimulyzer {
+
+void OcclusionQueries::destroy() {
+  for (auto &query : queries) {
+    if (query.id != 0u)
+      glDeleteQueries(1, &query.id);
+  }
+  queries.clear();
 }
 
-WiredLink::~WiredLink() {
-  glDeleteBuffers(1, &renderInfo.vbo);
-  glDeleteVertexArrays(1, &renderInfo.vao);
+OcclusionQueries::~OcclusionQueries() {
+  if (initialized)
+    destroy();
 }
 
-void WiredLink::notifyNodeMoved(unsigned int nodeId, glm::vec3 position) {
-  std::size_t nodeIndex = 0u;
-  for (auto i = 0u; i < model.nodes.size(); i++) {
-    if (model.nodes[i] == nodeId)
-      nodeIndex = i;
-  }
+void OcclusionQueries::init() {
+  initializeOpenGLFunctions();
+  initialized = true;
+}
 
-  glBindBuffer(GL_ARRAY_BUFFER, renderInfo.vbo);
-  glBufferSubData(GL_ARRAY_BUFFER, sizeof(float) * 3 * nodeIndex, sizeof(float) * 3,
-                  reinterpret_cast<void *>(glm::value_ptr(position)));
+void OcclusionQueries::reset(std::size_t slots) {
+  // Queries are made as Nodes are first tested, so a scenario which never tests any makes none
+  destroy();
+  queries.resize(slots);
 }
 
-WiredLink::WiredLink(WiredLink &&other) noexcept {
-  renderInfo = other.renderInfo;
-  model = other.model;
+void OcclusionQueries::collect() {
+  frame++;
 
-  // Clear the other RenderInfo so the destructor
-  // doesn't delete the OpenGL buffers
-  other.renderInfo.vao = 0;
-  other.renderInfo.vbo = 0;
-  other.renderInfo.size = 0;
+  for (auto &query : queries) {
+    if (!query.pending)
+      continue;
 
-  initializeOpenGLFunctions();
+    GLint available = GL_FALSE;
+    glGetQueryObjectiv(query.id, GL_QUERY_RESULT_AVAILABLE, &available);
+    if (!available)
+      continue;
+
+    GLuint passed = GL_FALSE;
+    glGetQueryObjectuiv(query.id, GL_QUERY_RESULT, &passed);
+    query.hidden = passed == GL_FALSE;
+    query.pending = false;
+  }
+}
+
+bool OcclusionQueries::hidden(std::uint32_t slot) const {
+  const auto &query = queries[slot];
+  return !query.pending && query.hidden && frame - query.issued <= maxLatency;
 }
 
-WiredLink &WiredLink::operator=(WiredLink &&other) noexcept {
-  renderInfo = other.renderInfo;
-  model = other.model;
+bool OcclusionQueries::begin(std::uint32_t slot) {
+  auto &query = queries[slot];
+  if (query.pending)
+    return false;
 
-  // Clear the other RenderInfo so the destructor
-  // doesn't delete the OpenGL buffers
-  other.renderInfo.vao = 0;
-  other.renderInfo.vbo = 0;
-  other.renderInfo.size = 0;
+  if (query.id == 0u)
+    glGenQueries(1, &query.id);
 
-  initializeOpenGLFunctions();
-  return *this;
+  glBeginQuery(GL_ANY_SAMPLES_PASSED, query.id);
+  query.issued = frame;
+  query.pending = true;
+  return true;
 }
 
-const WiredLink::RenderInfo &WiredLink::getRenderInfo() const {
-  return renderInfo;
+void OcclusionQueries::end() {
+  glEndQuery(GL_ANY_SAMPLES_PASSED);
 }
+
+} // namespace netsimulyzer
@@ -0,0 +1,130 @@
+/*
+ * NIST-developed software is provided by NIST as a public service. You may use,
+ * copy and distribute copies of the software in any medium, provided that you
+ * keep intact this entire notice. You may improve,modify and create derivative
+ * works of the software or any portion of the software, and you may copy and
+ * distribute such modifications or works. Modified works should carry a notice
+ * stating that you changed the software and should note the date and nature of
+ * any such change. Please explicitly acknowledge the National Institute of
+ * Standards and Technology as the source of the software.
+ *
+ * NIST-developed software is expressly provided "AS IS." NIST MAKES NO
+ * WARRANTY OF ANY KIND, EXPRESS, IMPLIED, IN FACT OR ARISING BY OPERATION OF
+ * LAW, INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTY OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, NON-INFRINGEMENT
+ * AND DATA ACCURACY. NIST NEITHER REPRESENTS NOR WARRANTS THAT THE
+ * OPERATION OF THE SOFTWARE WILL BE UNINTERRUPTED OR ERROR-FREE, OR THAT
+ * ANY DEFECTS WILL BE CORRECTED. NIST DOES NOT WARRANT OR MAKE ANY
+ * REPRESENTATIONS REGARDING THE USE OF THE SOFTWARE OR THE RESULTS THEREOF,
+ * INCLUDING BUT NOT LIMITED TO THE CORRECTNESS, ACCURACY, RELIABILITY,
+ * OR USEFULNESS OF THE SOFTWARE.
+ *
+ * You are solely responsible for determining the appropriateness of using and
+ * distributing the software and you assume all risks associated with its use,
+ * including but not limited to the risks and costs of program errors,
+ * compliance with applicable laws, damage to or loss of data, programs or
+ * equipment, and the unavailability or interruption of operation. This
+ * software is not intended to be used in any situation where a failure could
+ * cause risk of injury or damage to property. The software developed by NIST
+ * employees is not subject to copyright protection within the United States.
+ *
+ * Author: Evan Black <evan.black@nist.gov>
+ */
+
+#pragma once
+
+#include <QOpenGLFunctions_3_3_Core>
+#include <cstddef>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <vector>
+
+namespace netsimulyzer {
+
+/**
+ * One occlusion query per Node, testing its bounds against the depth of the opaque Buildings.
+ *
+ * A query is read the frame after it is issued, or later if its result is not ready,
+ * rather than waiting on the GPU. So a Node found hidden is skipped for a frame,
+ * then tested again, and a Node coming into view is drawn a frame late at most.
+ * Nodes without a recent result are never hidden
+ */
+class OcclusionQueries : protected QOpenGLFunctions_3_3_Core {
+public:
+  /**
+   * The bounds of one Node to test
+   */
+  struct Test {
+    std::uint32_t slot;
+    glm::vec3 min;
+    glm::vec3 max;
+  };
+
+private:
+  /**
+   * The most frames since a query was issued for its result to still hide a Node
+   */
+  static constexpr std::uint64_t maxLatency = 3u;
+
+  struct Query {
+    unsigned int id{0u};
+    std::uint64_t issued{0u};
+    bool pending{false};
+    bool hidden{false};
+  };
+
+  bool initialized{false};
+  std::vector<Query> queries;
+
+  /**
+   * Counts the calls to `collect()`, starting at 1,
+   * so no query is recent before it is issued
+   */
+  std::uint64_t frame{1u};
+
+  void destroy();
+
+public:
+  OcclusionQueries() = default;
+  OcclusionQueries(const OcclusionQueries &other) = delete;
+  OcclusionQueries &operator=(const OcclusionQueries &other) = delete;
+  ~OcclusionQueries();
+
+  /**
+   * Requires a current context
+   */
+  void init();
+
+  /**
+   * Set the number of Node slots, with no results for any of them.
+   * Requires a current context
+   */
+  void reset(std::size_t slots);
+
+  /**
+   * Read the results which are ready, without waiting for the others.
+   * Call once per frame, before `hidden()`
+   */
+  void collect();
+
+  /**
+   * @return
+   * True if the last recent query for the Node found none of its bounds in front of the Buildings
+   */
+  [[nodiscard]] bool hidden(std::uint32_t slot) const;
+
+  /**
+   * Start a query for a Node. The bounds drawn until `end()` are tested
+   *
+   * @return
+   * False if the Node's last query has no result yet, in which case nothing is started
+   */
+  [[nodiscard]] bool begin(std::uint32_t slot);
+
+  /**
+   * End the query started by `begin()`
+   */
+  void end();
+};
+
+} // namespace netsimulyzer
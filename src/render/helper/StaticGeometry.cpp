@@ -0,0 +1,404 @@
+/*
+ * NIST-developed software is provided by NIST as a public service. You may use,
+ * copy and distribute copies of the software in any medium, provided that you
+ * keep intact this entire notice. You may improve,modify and create derivative
+ * works of the software or any portion of the software, and you may copy and
+ * distribute such modifications or works. Modified works should carry a notice
+ * stating that you changed the software and should note the date and nature of
+ * any such change. Please explicitly acknowledge the National Institute of
+ * Standards and Technology as the source of the software.
+ *
+ * NIST-developed software is expressly provided "AS IS." NIST MAKES NO
+ * WARRANTY OF ANY KIND, EXPRESS, IMPLIED, IN FACT OR ARISING BY OPERATION OF
+ * LAW, INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTY OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, NON-INFRINGEMENT
+ * AND DATA ACCURACY. NIST NEITHER REPRESENTS NOR WARRANTS THAT THE
+ * OPERATION OF THE SOFTWARE WILL BE UNINTERRUPTED OR ERROR-FREE, OR THAT
+ * ANY DEFECTS WILL BE CORRECTED. NIST DOES NOT WARRANT OR MAKE ANY
+ * REPRESENTATIONS REGARDING THE USE OF THE SOFTWARE OR THE RESULTS THEREOF,
+ * INCLUDING BUT NOT LIMITED TO THE CORRECTNESS, ACCURACY, RELIABILITY,
+ * OR USEFULNESS OF THE SOFTWARE.
+ *
+ * You are solely responsible for determining the appropriateness of using and
+ * distributing the software and you assume all risks associated with its use,
+ * including but not limited to the risks and costs of program errors,
+ * compliance with applicable laws, damage to or loss of data, programs or
+ * equipment, and the unavailability or interruption of operation. This
+ * software is not intended to be used in any situation where a failure could
+ * cause risk of injury or damage to property. The software developed by NIST
+ * employees is not subject to copyright protection within the United States.
+ *
+ * Author: Evan Black <evan.black@nist.gov>
+ */
+
+
+#include "StaticGeometry.h"
+#include "../../conversion.h"
+#include <algorithm>
+#include <cmath>
+#include <glm/glm.hpp>
+#include <initializer_list>
+#include <task-pool.h>
+#include <trace.h>
+#include <utility>
+
+namespace netsimulyzer {
+
+StaticGeometry::StaticGeometry() {
+  initializeOpenGLFunctions();
+}
+
+StaticGeometry::ItemSize StaticGeometry::measure(const parser::Building &building) {
+  // Every loop in `write()` adds a quad after its first step
+  const auto quads = static_cast<std::size_t>(std::max(0, building.floors - 1) + std::max(0, building.roomsX - 1) +
+                                              std::max(0, building.roomsY - 1));
+
+  ItemSize size;
+  // The box, the quads, then the outline
+  size.vertices = 8u + 4u * quads + 8u;
+  size.indices[static_cast<std::size_t>(Pass::Buildings)] = 36u + 6u * quads;
+  size.indices[static_cast<std::size_t>(Pass::BuildingOutlines)] = 24u;
+  return size;
+}
+
+StaticGeometry::ItemSize StaticGeometry::measure(const parser::Area &area) {
+  using DrawMode = parser::Area::DrawMode;
+  const auto points = area.points.size();
+
+  ItemSize size;
+  auto &indices = size.indices[static_cast<std::size_t>(Pass::Areas)];
+  if (area.fillMode == DrawMode::Solid && points >= 3u) {
+    size.vertices += points;
+    indices += 3u * (points - 2u);
+  }
+
+  // 14 points, as a strip of 12 triangles
+  if (area.borderMode == DrawMode::Solid && points >= 4u) {
+    size.vertices += 14u;
+    indices += 3u * 12u;
+  }
+
+  return size;
+}
+
+void StaticGeometry::write(const parser::Building &building, Cursor cursor) {
+  const auto min = toRenderCoordinate(building.min);
+  const auto max = toRenderCoordinate(building.max);
+  const auto color = toRenderColor(building.color);
+
+  auto vertex = [&cursor, &color](float x, float y, float z) {
+    *cursor.vertex++ = {{x, y, z}, color};
+    cursor.next++;
+  };
+
+  // A quad of the last 4 vertices, in the order 0, 1, 2, 3, 0, 2
+  auto &buildingIndices = cursor.index[static_cast<std::size_t>(Pass::Buildings)];
+  auto quad = [&cursor, &buildingIndices]() {
+    const auto first = cursor.next - 4u;
+    for (const auto index : {0u, 1u, 2u, 3u, 0u, 2u})
+      *buildingIndices++ = first + index;
+  };
+
+  auto base = cursor.next;
+
+  vertex(min.x, min.y, min.z); // 0
+  vertex(max.x, min.y, min.z); // 1
+  vertex(max.x, min.y, max.z); // 2
+  vertex(min.x, min.y, max.z); // 3
+  vertex(min.x, max.y, min.z); // 4
+  vertex(max.x, max.y, min.z); // 5
+  vertex(max.x, max.y, max.z); // 6
+  vertex(min.x, max.y, max.z); // 7
+
+  // clang-format off
+  for (const auto index : {
+      0u, 1u, 2u,
+      3u, 0u, 2u,
+      1u, 5u, 6u,
+      2u, 1u, 6u,
+      4u, 5u, 6u,
+      7u, 4u, 6u,
+      0u, 4u, 7u,
+      3u, 0u, 7u,
+      0u, 1u, 5u,
+      4u, 0u, 5u,
+      3u, 2u, 6u,
+      7u, 3u, 6u}) {
+    *buildingIndices++ = base + index;
+  }
+  // clang-format on
+
+  // Floors
+  //   All floors are exactly the same height
+  //   abs() just in case our coordinates are negative
+  const auto floorHeight = (std::abs(max.y) - std::abs(min.y)) / static_cast<float>(building.floors);
+  for (auto currentFloor = 1; currentFloor < building.floors; currentFloor++) {
+    const auto currentHeight = floorHeight * currentFloor + min.y;
+
+    vertex(min.x, currentHeight, min.z);
+    vertex(max.x, currentHeight, min.z);
+    vertex(max.x, currentHeight, max.z);
+    vertex(min.x, currentHeight, max.z);
+    quad();
+  }
+
+  // Walls
+  // X
+
+  // Find the size of each room
+  const auto roomLengthX = (max.x - min.x) / static_cast<float>(building.roomsX);
+  for (auto currentRoom = 1; currentRoom < building.roomsX; currentRoom++) {
+    const auto currentWallPosition = roomLengthX * currentRoom + min.x;
+
+    vertex(currentWallPosition, min.y, min.z);
+    vertex(currentWallPosition, max.y, min.z);
+    vertex(currentWallPosition, max.y, max.z);
+    vertex(currentWallPosition, min.y, max.z);
+    quad();
+  }
+
+  // Y (Z in OpenGl coordinates)
+  const auto roomLengthY = (max.z - min.z) / static_cast<float>(building.roomsY);
+  for (auto currentRoom = 1; currentRoom < building.roomsY; currentRoom++) {
+    const auto currentWallPosition = roomLengthY * currentRoom + min.z;
+
+    vertex(min.x, min.y, currentWallPosition);
+    vertex(max.x, min.y, currentWallPosition);
+    vertex(max.x, max.y, currentWallPosition);
+    vertex(min.x, max.y, currentWallPosition);
+    quad();
+  }
+
+  // Border Lines
+
+  // add a very slight offset
+  // so lines do not directly
+  // intersect the walls
+  const float offset = 0.01f;
+
+  auto &outlineIndices = cursor.index[static_cast<std::size_t>(Pass::BuildingOutlines)];
+  base = cursor.next;
+
+  // The outline color is chosen when rendering
+  vertex(min.x - offset, min.y - offset, min.z - offset); // 0
+  vertex(max.x + offset, min.y - offset, min.z - offset); // 1
+  vertex(max.x + offset, min.y - offset, max.z + offset); // 2
+  vertex(min.x - offset, min.y - offset, max.z + offset); // 3
+  vertex(min.x - offset, max.y + offset, min.z - offset); // 4
+  vertex(max.x + offset, max.y + offset, min.z - offset); // 5
+  vertex(max.x + offset, max.y + offset, max.z + offset); // 6
+  vertex(min.x - offset, max.y + offset, max.z + offset); // 7
+
+  // clang-format off
+  for (const auto index : {
+      0u, 1u, // Bottom
+      1u, 2u,
+      2u, 3u,
+      3u, 0u,
+      4u, 5u, // Top
+      5u, 6u,
+      6u, 7u,
+      7u, 4u,
+      0u, 4u, // Sides
+      1u, 5u,
+      2u, 6u,
+      3u, 7u}) {
+    *outlineIndices++ = base + index;
+  }
+  // clang-format on
+}
+
+void StaticGeometry::write(const parser::Area &area, Cursor cursor) {
+  // Convert to OpenGl coordinates
+  // for easier reading later
+  std::vector<glm::vec3> convertedPoints;
+  convertedPoints.reserve(area.points.size());
+  for (const auto &point : area.points)
+    convertedPoints.emplace_back(toRenderCoordinate(point));
+
+  auto &areaIndices = cursor.index[static_cast<std::size_t>(Pass::Areas)];
+
+  using DrawMode = parser::Area::DrawMode;
+
+  // Fill, as the triangles of a fan
+  if (area.fillMode == DrawMode::Solid && convertedPoints.size() >= 3u) {
+    const auto color = toRenderColor(area.fillColor);
+    const auto base = cursor.next;
+    for (const auto &point : convertedPoints)
+      *cursor.vertex++ = {point, color};
+    cursor.next += static_cast<unsigned int>(convertedPoints.size());
+
+    for (auto i = 1u; i + 1u < convertedPoints.size(); i++) {
+      *areaIndices++ = base;
+      *areaIndices++ = base + i;
+      *areaIndices++ = base + i + 1u;
+    }
+  }
+
+  // Border, as the triangles of a strip
+  if (area.borderMode == DrawMode::Solid && convertedPoints.size() >= 4u) {
+    const auto borderWidth = 0.5f; // TODO: Make configurable?
+    const auto color = toRenderColor(area.borderColor);
+    const auto base = cursor.next;
+
+    // TODO: Filled Corners?
+    const std::array<glm::vec3, 14> borderPoints{
+        // Top Left
+        convertedPoints[0],                                      // 0
+        convertedPoints[0] - glm::vec3{borderWidth, 0.0f, 0.0f}, // 1
+
+        // Bottom Left
+        convertedPoints[1],                                      // 2
+        convertedPoints[1] - glm::vec3{borderWidth, 0.0f, 0.0f}, // 3
+        convertedPoints[1] + glm::vec3{0.0f, 0.0f, borderWidth}, // 4
+
+        // Bottom Right
+        convertedPoints[2],                                      // 5
+        convertedPoints[2] + glm::vec3{0.0f, 0.0f, borderWidth}, // 6
+        convertedPoints[2] + glm::vec3{borderWidth, 0.0f, 0.0f}, // 7
+
+        // Top Right
+        convertedPoints[3],                                      // 8
+        convertedPoints[3] + glm::vec3{borderWidth, 0.0f, 0.0f}, // 9
+        convertedPoints[3] - glm::vec3{0.0f, 0.0f, borderWidth}, // 10
+
+        // Top Left (Again)
+        convertedPoints[0],                                      // 11 (same as 0)
+        convertedPoints[0] - glm::vec3{0.0f, 0.0f, borderWidth}, // 12
+        convertedPoints[0] - glm::vec3{borderWidth, 0.0f, 0.0f}, // 13 (same as 1)
+    };
+
+    for (const auto &point : borderPoints)
+      *cursor.vertex++ = {point, color};
+    cursor.next += static_cast<unsigned int>(borderPoints.size());
+
+    for (auto i = 0u; i + 2u < borderPoints.size(); i++) {
+      *areaIndices++ = base + i;
+      *areaIndices++ = base + i + 1u;
+      *areaIndices++ = base + i + 2u;
+    }
+  }
+}
+
+void StaticGeometry::build(const std::vector<parser::Area> &areas, const std::vector<parser::Building> &buildings) {
+  parser::trace::Scope trace{"StaticGeometry::build", "load"};
+
+  // Where each item starts, Areas first, then Buildings
+  struct Offsets {
+    std::size_t vertex;
+    std::array<std::size_t, passCount> index;
+  };
+  std::vector<Offsets> offsets;
+  offsets.reserve(areas.size() + buildings.size());
+
+  std::size_t vertexCount = 0u;
+  std::array<std::size_t, passCount> indexCount{};
+  for (auto &passRanges : ranges)
+    passRanges.clear();
+
+  auto place = [&offsets, &vertexCount, &indexCount, this](const ItemSize &size, std::initializer_list<Pass> passes) {
+    offsets.push_back({vertexCount, indexCount});
+    for (const auto pass : passes) {
+      const auto p = static_cast<std::size_t>(pass);
+      ranges[p].push_back({indexCount[p], static_cast<int>(size.indices[p])});
+    }
+
+    vertexCount += size.vertices;
+    for (std::size_t p = 0u; p < passCount; p++)
+      indexCount[p] += size.indices[p];
+  };
+
+  for (const auto &area : areas)
+    place(measure(area), {Pass::Areas});
+  for (const auto &building : buildings)
+    place(measure(building), {Pass::Buildings, Pass::BuildingOutlines});
+
+  vertices.resize(vertexCount);
+  for (std::size_t p = 0u; p < passCount; p++)
+    indices[p].resize(indexCount[p]);
+
+  // Each item only writes to its own ranges, so any number may be written at once
+  auto writeItem = [this, &areas, &buildings, &offsets](std::size_t item) {
+    const auto &offset = offsets[item];
+    Cursor cursor{vertices.data() + offset.vertex, static_cast<unsigned int>(offset.vertex), {}};
+    for (std::size_t p = 0u; p < passCount; p++)
+      cursor.index[p] = indices[p].data() + offset.index[p];
+
+    if (item < areas.size())
+      write(areas[item], cursor);
+    else
+      write(buildings[item - areas.size()], cursor);
+  };
+
+  // Items are cheap, so they are handed out in blocks
+  constexpr std::size_t blockSize = 64u;
+  const auto blocks = (offsets.size() + blockSize - 1u) / blockSize;
+  const auto writeBlock = [&writeItem, &offsets](std::size_t block) {
+    const auto end = std::min(offsets.size(), (block + 1u) * blockSize);
+    for (auto item = block * blockSize; item < end; item++)
+      writeItem(item);
+  };
+
+  if (blocks > 1u) {
+    parser::TaskPool::shared().parallelFor(blocks, 0u, parser::TaskPool::Priority::Interactive, writeBlock);
+  } else {
+    for (std::size_t block = 0u; block < blocks; block++)
+      writeBlock(block);
+  }
+}
+
+std::size_t StaticGeometry::gpuBytes(const std::vector<parser::Area> &areas,
+                                     const std::vector<parser::Building> &buildings) {
+  auto add = [](std::size_t bytes, const ItemSize &size) {
+    bytes += sizeof(Vertex) * size.vertices;
+    for (const auto indexCount : size.indices)
+      bytes += sizeof(unsigned int) * indexCount;
+    return bytes;
+  };
+
+  std::size_t bytes = 0u;
+  for (const auto &area : areas)
+    bytes = add(bytes, measure(area));
+  for (const auto &building : buildings)
+    bytes = add(bytes, measure(building));
+
+  return bytes;
+}
+
+const StaticGeometry::RenderInfo &StaticGeometry::getRenderInfo() const {
+  return renderInfo;
+}
+
+const std::vector<StaticGeometry::Vertex> &StaticGeometry::getVertices() const {
+  return vertices;
+}
+
+std::vector<unsigned int> StaticGeometry::mergedIndices() const {
+  std::vector<unsigned int> merged;
+  for (const auto &passIndices : indices)
+    merged.insert(merged.end(), passIndices.begin(), passIndices.end());
+
+  return merged;
+}
+
+void StaticGeometry::uploaded(const RenderInfo &value) {
+  renderInfo = value;
+
+  // Ranges now start from the beginning of the merged indices
+  std::size_t passStart = 0u;
+  for (std::size_t pass = 0u; pass < passCount; pass++) {
+    for (auto &range : ranges[pass])
+      range.first += passStart;
+
+    passStart += indices[pass].size();
+    indices[pass] = {};
+  }
+
+  vertices = {};
+}
+
+const std::vector<StaticGeometry::Range> &StaticGeometry::getRanges(Pass pass) const {
+  return ranges[static_cast<std::size_t>(pass)];
+}
+
+} // namespace netsimulyzer
@@ -0,0 +1,178 @@
+/*
+ * NIST-developed software is provided by NIST as a public service. You may use,
+ * copy and distribute copies of the software in any medium, provided that you
+ * keep intact this entire notice. You may improve,modify and create derivative
+ * works of the software or any portion of the software, and you may copy and
+ * distribute such modifications or works. Modified works should carry a notice
+ * stating that you changed the software and should note the date and nature of
+ * any such change. Please explicitly acknowledge the National Institute of
+ * Standards and Technology as the source of the software.
+ *
+ * NIST-developed software is expressly provided "AS IS." NIST MAKES NO
+ * WARRANTY OF ANY KIND, EXPRESS, IMPLIED, IN FACT OR ARISING BY OPERATION OF
+ * LAW, INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTY OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, NON-INFRINGEMENT
+ * AND DATA ACCURACY. NIST NEITHER REPRESENTS NOR WARRANTS THAT THE
+ * OPERATION OF THE SOFTWARE WILL BE UNINTERRUPTED OR ERROR-FREE, OR THAT
+ * ANY DEFECTS WILL BE CORRECTED. NIST DOES NOT WARRANT OR MAKE ANY
+ * REPRESENTATIONS REGARDING THE USE OF THE SOFTWARE OR THE RESULTS THEREOF,
+ * INCLUDING BUT NOT LIMITED TO THE CORRECTNESS, ACCURACY, RELIABILITY,
+ * OR USEFULNESS OF THE SOFTWARE.
+ *
+ * You are solely responsible for determining the appropriateness of using and
+ * distributing the software and you assume all risks associated with its use,
+ * including but not limited to the risks and costs of program errors,
+ * compliance with applicable laws, damage to or loss of data, programs or
+ * equipment, and the unavailability or interruption of operation. This
+ * software is not intended to be used in any situation where a failure could
+ * cause risk of injury or damage to property. The software developed by NIST
+ * employees is not subject to copyright protection within the United States.
+ *
+ * Author: Evan Black <evan.black@nist.gov>
+ */
+
+
+#pragma once
+
+#include <QOpenGLFunctions_3_3_Core>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <glm/vec3.hpp>
+#include <model.h>
+#include <vector>
+
+namespace netsimulyzer {
+
+/**
+ * The geometry of every Building & Area, merged into one vertex & index buffer.
+ * Each item is a range of indices in its pass,
+ * so any set of items is drawn with one call per pass
+ */
+class StaticGeometry : protected QOpenGLFunctions_3_3_Core {
+public:
+  struct Vertex {
+    glm::vec3 position;
+    glm::vec3 color;
+  };
+
+  enum class Pass { Buildings, BuildingOutlines, Areas };
+  static constexpr std::size_t passCount = 3u;
+
+  /**
+   * The indices of one item in a pass
+   */
+  struct Range {
+    /**
+     * The first index, from the start of the index buffer
+     */
+    std::size_t first{0u};
+    int count{0};
+  };
+
+  struct RenderInfo {
+    unsigned int vao = 0u;
+    unsigned int vbo = 0u;
+    unsigned int ibo = 0u;
+  };
+
+private:
+  RenderInfo renderInfo;
+
+  /**
+   * Application side buffers, cleared once uploaded by `Renderer::allocate()`
+   */
+  std::vector<Vertex> vertices;
+  std::array<std::vector<unsigned int>, passCount> indices;
+
+  /**
+   * The range of each item, by pass. Relative to the pass until uploaded
+   */
+  std::array<std::vector<Range>, passCount> ranges;
+
+  /**
+   * The number of vertices & indices of one item, known before it is written
+   */
+  struct ItemSize {
+    std::size_t vertices{0u};
+    std::array<std::size_t, passCount> indices{};
+  };
+
+  /**
+   * Where the next vertex & index of an item are written, see `write()`
+   */
+  struct Cursor {
+    Vertex *vertex;
+
+    /**
+     * The index of `vertex` in `vertices`
+     */
+    unsigned int next;
+
+    std::array<unsigned int *, passCount> index;
+  };
+
+  [[nodiscard]] static ItemSize measure(const parser::Building &building);
+  [[nodiscard]] static ItemSize measure(const parser::Area &area);
+
+  /**
+   * Write the walls, floors & outline of a Building,
+   * exactly `measure(building)` vertices & indices from `cursor`
+   */
+  static void write(const parser::Building &building, Cursor cursor);
+
+  /**
+   * Write the fill & border of an Area,
+   * exactly `measure(area)` vertices & indices from `cursor`
+   */
+  static void write(const parser::Area &area, Cursor cursor);
+
+public:
+  StaticGeometry();
+  StaticGeometry(const StaticGeometry &) = delete;
+  StaticGeometry &operator=(const StaticGeometry &) = delete;
+
+  /**
+   * Build the geometry of every Area & Building, replacing anything built before.
+   * Each item is sized first, so the buffers are allocated once,
+   * and large sets of items are written on the `parser::TaskPool`, each straight into place.
+   *
+   * Items match the indices in `areas` & `buildings`.
+   * Buildings are items in both the `Buildings` & `BuildingOutlines` passes
+   *
+   * @param areas
+   * The Areas, each an item in the `Areas` pass
+   *
+   * @param buildings
+   * The Buildings
+   */
+  void build(const std::vector<parser::Area> &areas, const std::vector<parser::Building> &buildings);
+
+  /**
+   * @return
+   * The GPU memory, in bytes, the geometry of these items takes once built & uploaded
+   */
+  [[nodiscard]] static std::size_t gpuBytes(const std::vector<parser::Area> &areas,
+                                            const std::vector<parser::Building> &buildings);
+
+  [[nodiscard]] const RenderInfo &getRenderInfo() const;
+
+  [[nodiscard]] const std::vector<Vertex> &getVertices() const;
+
+  /**
+   * Every pass, one after the other, as they should be uploaded
+   */
+  [[nodiscard]] std::vector<unsigned int> mergedIndices() const;
+
+  /**
+   * Use the uploaded buffers, and clear the application side copies
+   *
+   * @param value
+   * The uploaded buffers, owned by the `Renderer`
+   */
+  void uploaded(const RenderInfo &value);
+
+  [[nodiscard]] const std::vector<Range> &getRanges(Pass pass) const;
+};
+
+} // namespace netsimulyzer
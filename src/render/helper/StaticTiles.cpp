@@ -0,0 +1,311 @@
+/*
+ * NIST-developed software is provided by NIST as a public service. You may use,
+ * copy and distribute copies of the software in any medium, provided that you
+ * keep intact this entire notice. You may improve,modify and create derivative
+ * works of the software or any portion of the software, and you may copy and
+ * distribute such modifications or works. Modified works should carry a notice
+ * stating that you changed the software and should note the date and nature of
+ * any such change. Please explicitly acknowledge the National Institute of
+ * Standards and Technology as the source of the software.
+ *
+ * NIST-developed software is expressly provided "AS IS." NIST MAKES NO
+ * WARRANTY OF ANY KIND, EXPRESS, IMPLIED, IN FACT OR ARISING BY OPERATION OF
+ * LAW, INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTY OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, NON-INFRINGEMENT
+ * AND DATA ACCURACY. NIST NEITHER REPRESENTS NOR WARRANTS THAT THE
+ * OPERATION OF THE SOFTWARE WILL BE UNINTERRUPTED OR ERROR-FREE, OR THAT
+ * ANY DEFECTS WILL BE CORRECTED. NIST DOES NOT WARRANT OR MAKE ANY
+ * REPRESENTATIONS REGARDING THE USE OF THE SOFTWARE OR THE RESULTS THEREOF,
+ * INCLUDING BUT NOT LIMITED TO THE CORRECTNESS, ACCURACY, RELIABILITY,
+ * OR USEFULNESS OF THE SOFTWARE.
+ *
+ * You are solely responsible for determining the appropriateness of using and
+ * distributing the software and you assume all risks associated with its use,
+ * including but not limited to the risks and costs of program errors,
+ * compliance with applicable laws, damage to or loss of data, programs or
+ * equipment, and the unavailability or interruption of operation. This
+ * software is not intended to be used in any situation where a failure could
+ * cause risk of injury or damage to property. The software developed by NIST
+ * employees is not subject to copyright protection within the United States.
+ *
+ * Author: Evan Black <evan.black@nist.gov>
+ */
+
+#include "StaticTiles.h"
+#include "../../conversion.h"
+#include "../renderer/Renderer.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <optional>
+#include <trace.h>
+#include <unordered_map>
+
+namespace netsimulyzer {
+
+float StaticTiles::distance(const Tile &tile, const glm::vec3 &eye) {
+  const glm::vec2 ground{eye.x, eye.z};
+  const auto nearest = glm::clamp(ground, glm::vec2{tile.min.x, tile.min.z}, glm::vec2{tile.max.x, tile.max.z});
+  return glm::distance(ground, nearest);
+}
+
+void StaticTiles::load(std::uint32_t tile, Renderer &renderer) {
+  auto &value = tiles[tile];
+  value.geometry = std::make_unique<StaticGeometry>();
+  value.geometry->build(value.areas, value.buildings);
+  renderer.allocateTile(*value.geometry);
+  loadedBytes += value.bytes;
+}
+
+void StaticTiles::unload(std::uint32_t tile, Renderer &renderer) {
+  auto &value = tiles[tile];
+  renderer.releaseTile(*value.geometry);
+  value.geometry.reset();
+  value.visible.clear();
+  loadedBytes -= value.bytes;
+}
+
+StaticTiles::StaticTiles(float streamDistance, std::size_t budget) : streamDistance(streamDistance), budget(budget) {
+}
+
+void StaticTiles::partition(const std::vector<parser::Area> &areas, const std::vector<parser::Building> &buildings) {
+  parser::trace::Scope trace{"StaticTiles::partition", "load"};
+
+  // Cells of the ns-3 ground plane, keyed by their column & row
+  const auto tileSize = std::max(1.0f, streamDistance / 4.0f);
+  std::unordered_map<std::uint64_t, std::uint32_t> cells;
+  auto tileAt = [this, &cells, tileSize](float x, float y) {
+    const auto column = static_cast<std::int32_t>(std::floor(x / tileSize));
+    const auto row = static_cast<std::int32_t>(std::floor(y / tileSize));
+    const auto key = (std::uint64_t{static_cast<std::uint32_t>(column)} << 32u) | static_cast<std::uint32_t>(row);
+
+    const auto [cell, added] = cells.try_emplace(key, static_cast<std::uint32_t>(tiles.size()));
+    if (added) {
+      auto &tile = tiles.emplace_back();
+      tile.min = glm::vec3{std::numeric_limits<float>::max()};
+      tile.max = glm::vec3{std::numeric_limits<float>::lowest()};
+    }
+    return cell->second;
+  };
+
+  // The axes may flip during the conversion, so min/max may swap as well
+  auto grow = [this](std::uint32_t tile, const parser::Ns3Coordinate &a, const parser::Ns3Coordinate &b) {
+    const auto first = toRenderCoordinate(a);
+    const auto second = toRenderCoordinate(b);
+    tiles[tile].min = glm::min(tiles[tile].min, glm::min(first, second));
+    tiles[tile].max = glm::max(tiles[tile].max, glm::max(first, second));
+  };
+
+  for (const auto &area : areas) {
+    // Draws nothing, so belongs nowhere
+    if (area.points.empty())
+      continue;
+
+    auto low = area.points.front();
+    auto high = area.points.front();
+    for (const auto &point : area.points) {
+      low = {std::min(low.x, point.x), std::min(low.y, point.y), std::min(low.z, point.z)};
+      high = {std::max(high.x, point.x), std::max(high.y, point.y), std::max(high.z, point.z)};
+    }
+
+    const auto tile = tileAt((low.x + high.x) * 0.5f, (low.y + high.y) * 0.5f);
+    tiles[tile].areas.emplace_back(area);
+    grow(tile, low, high);
+  }
+
+  buildingItems.clear();
+  buildingItems.reserve(buildings.size());
+  for (const auto &building : buildings) {
+    const auto tile = tileAt((building.min.x + building.max.x) * 0.5f, (building.min.y + building.max.y) * 0.5f);
+    buildingItems.emplace_back(tile, static_cast<std::uint32_t>(tiles[tile].buildings.size()));
+    tiles[tile].buildings.emplace_back(building);
+    grow(tile, building.min, building.max);
+  }
+
+  // One box a tile, over the ground its Buildings cover, as tall as they are on average,
+  // in their average color
+  std::vector<parser::Building> boxes(tiles.size());
+  for (std::size_t i = 0u; i < tiles.size(); i++) {
+    auto &tile = tiles[i];
+    tile.bytes = StaticGeometry::gpuBytes(tile.areas, tile.buildings);
+    if (tile.buildings.empty())
+      continue;
+
+    auto &box = boxes[i];
+    box.floors = 1u;
+    box.roomsX = 1u;
+    box.roomsY = 1u;
+    box.min = {std::numeric_limits<float>::max(), std::numeric_limits<float>::max(),
+               std::numeric_limits<float>::max()};
+    box.max = {std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest(), 0.0f};
+
+    glm::vec3 color{0.0f};
+    for (const auto &building : tile.buildings) {
+      box.min.x = std::min({box.min.x, building.min.x, building.max.x});
+      box.min.y = std::min({box.min.y, building.min.y, building.max.y});
+      box.min.z = std::min({box.min.z, building.min.z, building.max.z});
+      box.max.x = std::max({box.max.x, building.min.x, building.max.x});
+      box.max.y = std::max({box.max.y, building.min.y, building.max.y});
+      box.max.z += std::max(building.min.z, building.max.z);
+      color += glm::vec3(building.color.red, building.color.green, building.color.blue);
+    }
+
+    const auto count = static_cast<float>(tile.buildings.size());
+    box.max.z /= count;
+    color /= count;
+    box.color = {static_cast<std::uint8_t>(color.r), static_cast<std::uint8_t>(color.g),
+                 static_cast<std::uint8_t>(color.b)};
+  }
+
+  coarse = std::make_unique<StaticGeometry>();
+  coarse->build({}, boxes);
+
+  isCoarseVisible.assign(tiles.size(), false);
+  absent.clear();
+  for (std::uint32_t i = 0u; i < tiles.size(); i++) {
+    if (!tiles[i].buildings.empty())
+      absent.emplace_back(i);
+  }
+}
+
+void StaticTiles::stream(const glm::vec3 &eye, Renderer &renderer) {
+  // Tiles are unloaded a little further out than they are loaded,
+  // so moving back & forth across the edge does not load the same tile over & over
+  const auto unloadDistance = streamDistance * 1.25f;
+
+  auto changed = false;
+  candidates.clear();
+  for (std::uint32_t i = 0u; i < tiles.size(); i++) {
+    const auto tileDistance = distance(tiles[i], eye);
+    if (tiles[i].geometry && tileDistance > unloadDistance) {
+      unload(i, renderer);
+      changed = true;
+    } else if (!tiles[i].geometry && tileDistance <= streamDistance)
+      candidates.emplace_back(tileDistance, i);
+  }
+
+  std::sort(candidates.begin(), candidates.end());
+  if (candidates.size() > loadsPerFrame)
+    candidates.resize(loadsPerFrame);
+
+  auto fits = [this](const Tile &tile) {
+    return budget == 0u || loadedBytes + tile.bytes <= budget;
+  };
+
+  for (const auto &[tileDistance, i] : candidates) {
+    // Make room by unloading the furthest tiles, so long as they are further than this one
+    while (!fits(tiles[i])) {
+      std::optional<std::uint32_t> furthest;
+      auto furthestDistance = tileDistance;
+      for (std::uint32_t j = 0u; j < tiles.size(); j++) {
+        if (!tiles[j].geometry)
+          continue;
+
+        const auto loadedDistance = distance(tiles[j], eye);
+        if (loadedDistance > furthestDistance) {
+          furthest = j;
+          furthestDistance = loadedDistance;
+        }
+      }
+
+      if (!furthest)
+        break;
+      unload(furthest.value(), renderer);
+      changed = true;
+    }
+
+    // The rest are further still, so would not fit either
+    if (!fits(tiles[i]))
+      break;
+
+    load(i, renderer);
+    changed = true;
+  }
+
+  if (!changed)
+    return;
+
+  absent.clear();
+  for (std::uint32_t i = 0u; i < tiles.size(); i++) {
+    if (!tiles[i].geometry && !tiles[i].buildings.empty())
+      absent.emplace_back(i);
+  }
+}
+
+void StaticTiles::select(const std::vector<std::uint32_t> &visibleBuildings) {
+  for (auto &tile : tiles)
+    tile.visible.clear();
+  for (const auto tile : visibleCoarse)
+    isCoarseVisible[tile] = false;
+  visibleCoarse.clear();
+
+  // Items were added to each tile in the order of the scenario's Buildings,
+  // so sorted indices stay sorted within each tile
+  for (const auto building : visibleBuildings) {
+    const auto [tile, item] = buildingItems[building];
+    if (tiles[tile].geometry) {
+      tiles[tile].visible.emplace_back(item);
+    } else if (!isCoarseVisible[tile]) {
+      isCoarseVisible[tile] = true;
+      visibleCoarse.emplace_back(tile);
+    }
+  }
+
+  // Neighbouring boxes are merged into one range when drawn
+  std::sort(visibleCoarse.begin(), visibleCoarse.end());
+}
+
+void StaticTiles::clear(Renderer &renderer) {
+  for (std::uint32_t i = 0u; i < tiles.size(); i++) {
+    if (tiles[i].geometry)
+      unload(i, renderer);
+  }
+
+  tiles.clear();
+  buildingItems.clear();
+  coarse.reset();
+  visibleCoarse.clear();
+  isCoarseVisible.clear();
+  absent.clear();
+}
+
+const std::vector<StaticTiles::Tile> &StaticTiles::getTiles() const {
+  return tiles;
+}
+
+StaticGeometry &StaticTiles::getCoarse() {
+  return *coarse;
+}
+
+const StaticGeometry &StaticTiles::getCoarse() const {
+  return *coarse;
+}
+
+const std::vector<std::uint32_t> &StaticTiles::getVisibleCoarse() const {
+  return visibleCoarse;
+}
+
+const std::vector<std::uint32_t> &StaticTiles::getAbsent() const {
+  return absent;
+}
+
+std::size_t StaticTiles::getGpuBytes() const {
+  return loadedBytes;
+}
+
+std::size_t StaticTiles::memoryUsage() const {
+  auto bytes = sizeof(Tile) * tiles.capacity() +
+               sizeof(decltype(buildingItems)::value_type) * buildingItems.capacity() +
+               sizeof(std::uint32_t) * (visibleCoarse.capacity() + absent.capacity());
+
+  for (const auto &tile : tiles) {
+    bytes += sizeof(parser::Area) * tile.areas.capacity() + sizeof(parser::Building) * tile.buildings.capacity() +
+             sizeof(std::uint32_t) * tile.visible.capacity();
+    for (const auto &area : tile.areas)
+      bytes += sizeof(parser::Ns3Coordinate) * area.points.capacity() + area.name.capacity();
+  }
+
+  return bytes;
+}
+
+} // namespace netsimulyzer
@@ -0,0 +1,234 @@
+/*
+ * NIST-developed software is provided by NIST as a public service. You may use,
+ * copy and distribute copies of the software in any medium, provided that you
+ * keep intact this entire notice. You may improve,modify and create derivative
+ * works of the software or any portion of the software, and you may copy and
+ * distribute such modifications or works. Modified works should carry a notice
+ * stating that you changed the software and should note the date and nature of
+ * any such change. Please explicitly acknowledge the National Institute of
+ * Standards and Technology as the source of the software.
+ *
+ * NIST-developed software is expressly provided "AS IS." NIST MAKES NO
+ * WARRANTY OF ANY KIND, EXPRESS, IMPLIED, IN FACT OR ARISING BY OPERATION OF
+ * LAW, INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTY OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, NON-INFRINGEMENT
+ * AND DATA ACCURACY. NIST NEITHER REPRESENTS NOR WARRANTS THAT THE
+ * OPERATION OF THE SOFTWARE WILL BE UNINTERRUPTED OR ERROR-FREE, OR THAT
+ * ANY DEFECTS WILL BE CORRECTED. NIST DOES NOT WARRANT OR MAKE ANY
+ * REPRESENTATIONS REGARDING THE USE OF THE SOFTWARE OR THE RESULTS THEREOF,
+ * INCLUDING BUT NOT LIMITED TO THE CORRECTNESS, ACCURACY, RELIABILITY,
+ * OR USEFULNESS OF THE SOFTWARE.
+ *
+ * You are solely responsible for determining the appropriateness of using and
+ * distributing the software and you assume all risks associated with its use,
+ * including but not limited to the risks and costs of program errors,
+ * compliance with applicable laws, damage to or loss of data, programs or
+ * equipment, and the unavailability or interruption of operation. This
+ * software is not intended to be used in any situation where a failure could
+ * cause risk of injury or damage to property. The software developed by NIST
+ * employees is not subject to copyright protection within the United States.
+ *
+ * Author: Evan Black <evan.black@nist.gov>
+ */
+
+#pragma once
+
+#include "StaticGeometry.h"
+#include <cstddef>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <memory>
+#include <model.h>
+#include <utility>
+#include <vector>
+
+namespace netsimulyzer {
+
+class Renderer;
+
+/**
+ * The Buildings & Areas of a very large scenario, split into square tiles on the ground.
+ *
+ * Only the tiles near the camera are kept on the GPU, each as a `StaticGeometry` of its own.
+ * Tiles are built & uploaded, through `uploadRing`, as the camera nears them, nearest first,
+ * and dropped once it moves away, or to make room for nearer ones within the budget.
+ * Every other tile is drawn as one coarse box covering its Buildings,
+ * so the GPU memory used follows the view, rather than the size of the map
+ */
+class StaticTiles {
+public:
+  struct Tile {
+    /**
+     * Covers every item of the tile, in render coordinates
+     */
+    glm::vec3 min{0.0f};
+    glm::vec3 max{0.0f};
+
+    /**
+     * The items of the tile, kept to build `geometry` again each time the tile is loaded
+     */
+    std::vector<parser::Area> areas;
+    std::vector<parser::Building> buildings;
+
+    /**
+     * The geometry of the items, set while the tile is loaded
+     */
+    std::unique_ptr<StaticGeometry> geometry;
+
+    /**
+     * The GPU memory of `geometry`, in bytes
+     */
+    std::size_t bytes{0u};
+
+    /**
+     * The items of `buildings` in view, see `select()`
+     */
+    std::vector<std::uint32_t> visible;
+  };
+
+private:
+  std::vector<Tile> tiles;
+
+  /**
+   * The tile, & the item in that tile, of each Building of the scenario
+   */
+  std::vector<std::pair<std::uint32_t, std::uint32_t>> buildingItems;
+
+  /**
+   * One box for each tile, as an item of the `Buildings` pass
+   */
+  std::unique_ptr<StaticGeometry> coarse;
+
+  /**
+   * Tiles not loaded, with Buildings in view, see `select()`
+   */
+  std::vector<std::uint32_t> visibleCoarse;
+
+  /**
+   * Whether each tile is in `visibleCoarse`
+   */
+  std::vector<bool> isCoarseVisible;
+
+  /**
+   * Every tile with Buildings which is not loaded
+   */
+  std::vector<std::uint32_t> absent;
+
+  /**
+   * Tiles nearer than this to the camera, on the ground, are loaded
+   */
+  float streamDistance;
+
+  /**
+   * The most bytes of tiles loaded at once
+   */
+  std::size_t budget;
+  std::size_t loadedBytes{0u};
+
+  /**
+   * At most this many tiles are loaded per frame,
+   * so a jump of the camera is spread over a few frames, rather than stalling one
+   */
+  static constexpr std::size_t loadsPerFrame = 4u;
+
+  /**
+   * The tiles to load this frame, with their distance to the camera, nearest first
+   */
+  std::vector<std::pair<float, std::uint32_t>> candidates;
+
+  /**
+   * @return
+   * The distance on the ground from `eye` to the nearest point of `tile`
+   */
+  [[nodiscard]] static float distance(const Tile &tile, const glm::vec3 &eye);
+
+  void load(std::uint32_t tile, Renderer &renderer);
+  void unload(std::uint32_t tile, Renderer &renderer);
+
+public:
+  /**
+   * @param streamDistance
+   * The distance, in meters on the ground, from the camera to load tiles within.
+   * Tiles are a quarter of this wide
+   *
+   * @param budget
+   * The most bytes of tiles to keep loaded at once
+   */
+  StaticTiles(float streamDistance, std::size_t budget);
+  StaticTiles(const StaticTiles &) = delete;
+  StaticTiles &operator=(const StaticTiles &) = delete;
+
+  /**
+   * Split the Areas & Buildings into tiles, by the center of each,
+   * and build the coarse box of every tile. Nothing is loaded until `stream()`.
+   *
+   * The coarse boxes must be uploaded with `Renderer::allocate(StaticGeometry &)` before drawing
+   *
+   * @param areas
+   * Every Area of the scenario
+   *
+   * @param buildings
+   * Every Building of the scenario
+   */
+  void partition(const std::vector<parser::Area> &areas, const std::vector<parser::Building> &buildings);
+
+  /**
+   * Load the tiles near `eye`, and unload the far ones.
+   * Requires the scene's context, and `uploadRing` flushed before the loaded tiles are drawn
+   *
+   * @param eye
+   * The position of the camera
+   *
+   * @param renderer
+   * Uploads & frees the geometry of the tiles
+   */
+  void stream(const glm::vec3 &eye, Renderer &renderer);
+
+  /**
+   * Sort the Buildings in view into the tiles holding them,
+   * or into `getVisibleCoarse()` for those in tiles not loaded
+   *
+   * @param visibleBuildings
+   * The indices of the Buildings in view, in the order they were partitioned
+   */
+  void select(const std::vector<std::uint32_t> &visibleBuildings);
+
+  /**
+   * Unload every tile. Requires the scene's context
+   *
+   * @param renderer
+   * The renderer the tiles were loaded with
+   */
+  void clear(Renderer &renderer);
+
+  [[nodiscard]] const std::vector<Tile> &getTiles() const;
+
+  [[nodiscard]] StaticGeometry &getCoarse();
+  [[nodiscard]] const StaticGeometry &getCoarse() const;
+
+  /**
+   * @return
+   * Items of `getCoarse()` to draw for the Buildings in view, see `select()`
+   */
+  [[nodiscard]] const std::vector<std::uint32_t> &getVisibleCoarse() const;
+
+  /**
+   * @return
+   * Items of `getCoarse()` for every tile with Buildings which is not loaded
+   */
+  [[nodiscard]] const std::vector<std::uint32_t> &getAbsent() const;
+
+  /**
+   * @return
+   * The bytes of the tiles loaded now
+   */
+  [[nodiscard]] std::size_t getGpuBytes() const;
+
+  /**
+   * @return
+   * The bytes of the items kept to load the tiles
+   */
+  [[nodiscard]] std::size_t memoryUsage() const;
+};
+
+} // namespace netsimulyzer
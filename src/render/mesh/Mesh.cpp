@@ -33,7 +33,12 @@
 
 #include "Mesh.h"
 #include "Vertex.h"
+#include "../render-stats.h"
+#include "../renderer/GlState.h"
 #include <algorithm>
+#include <cstddef>
+#include <glm/gtc/type_ptr.hpp>
+#include <limits>
 
 namespace netsimulyzer {
 
@@ -42,6 +47,11 @@ void Mesh::move(Mesh &&other) noexcept {
   renderInfo = other.renderInfo;
   material = other.material;
   bounds = other.bounds;
+  references = std::move(other.references);
+  arena = other.arena;
+  slice = other.slice;
+  firstReference = other.firstReference;
+  gpuBytes = other.gpuBytes;
 
   // Clear the other one
   // so it doesn't delete the mesh
@@ -49,6 +59,7 @@ void Mesh::move(Mesh &&other) noexcept {
   other.renderInfo.vbo = 0u;
   other.renderInfo.ibo = 0u;
   other.renderInfo.indexCount = 0u;
+  other.arena = nullptr;
 }
 
 const Material &Mesh::getMaterial() const {
@@ -59,10 +70,7 @@ void Mesh::setMaterial(const Material &value) {
   material = value;
 }
 
-Mesh::Mesh(const Vertex vertices[], unsigned int indices[], unsigned int vertexCount, int indexCount) {
-  initializeOpenGLFunctions();
-  renderInfo.indexCount = indexCount;
-
+void Mesh::updateBounds(const Vertex vertices[], std::size_t vertexCount) {
   if (vertexCount > 0u) {
     const auto &v = vertices[0];
     bounds.min = {v.position[0], v.position[1], v.position[2]};
@@ -80,16 +88,48 @@ Mesh::Mesh(const Vertex vertices[], unsigned int indices[], unsigned int vertexC
     bounds.max.z = std::max(bounds.max.z, position[2]);
     bounds.min.z = std::min(bounds.min.z, position[2]);
   }
+}
+
+void Mesh::updateReferenceBounds() {
+  if (references.empty())
+    return;
+
+  const auto local = bounds;
+  bounds.min = glm::vec3{std::numeric_limits<float>::max()};
+  bounds.max = glm::vec3{std::numeric_limits<float>::lowest()};
+
+  for (const auto &transform : references) {
+    for (auto corner = 0u; corner < 8u; corner++) {
+      const glm::vec3 point{corner & 1u ? local.max.x : local.min.x, corner & 2u ? local.max.y : local.min.y,
+                            corner & 4u ? local.max.z : local.min.z};
+      const auto placed = glm::vec3{transform * glm::vec4{point, 1.0f}};
+      bounds.min = glm::min(bounds.min, placed);
+      bounds.max = glm::max(bounds.max, placed);
+    }
+  }
+}
+
+const void *Mesh::indexOffset() const {
+  const auto indexSize = renderInfo.indexType == GL_UNSIGNED_SHORT ? sizeof(GLushort) : sizeof(GLuint);
+  return reinterpret_cast<const void *>(indexSize * renderInfo.firstIndex);
+}
+
+Mesh::Mesh(const Vertex vertices[], unsigned int indices[], unsigned int vertexCount, int indexCount) {
+  initializeOpenGLFunctions();
+  renderInfo.indexCount = indexCount;
+  updateBounds(vertices, vertexCount);
+  gpuBytes = sizeof(Vertex) * vertexCount + sizeof(unsigned int) * static_cast<std::size_t>(indexCount);
 
   glGenVertexArrays(1, &renderInfo.vao);
-  glBindVertexArray(renderInfo.vao);
+  glState.bindVertexArray(renderInfo.vao);
 
+  // Kept by the VAO, so it's not bound again to draw
   glGenBuffers(1, &renderInfo.ibo);
   glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, renderInfo.ibo);
   glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(unsigned int) * renderInfo.indexCount, indices, GL_STATIC_DRAW);
 
   glGenBuffers(1, &renderInfo.vbo);
-  glBindBuffer(GL_ARRAY_BUFFER, renderInfo.vbo);
+  glState.bindBuffer(GL_ARRAY_BUFFER, renderInfo.vbo);
   glBufferData(GL_ARRAY_BUFFER, sizeof(Vertex) * vertexCount, vertices, GL_STATIC_DRAW);
 
   // Location
@@ -106,7 +146,33 @@ Mesh::Mesh(const Vertex vertices[], unsigned int indices[], unsigned int vertexC
                         reinterpret_cast<void *>(offsetof(Vertex, textureCoordinate)));
   glEnableVertexAttribArray(2u);
 
-  glBindVertexArray(0u);
+  glState.bindVertexArray(0u);
+}
+
+Mesh::Mesh(MeshArena &arena, const std::vector<Vertex> &vertices, const std::vector<unsigned int> &indices,
+           std::vector<glm::mat4> references, const std::optional<MeshBounds> &knownBounds)
+    : references(std::move(references)) {
+  initializeOpenGLFunctions();
+  if (knownBounds)
+    bounds = knownBounds.value();
+  else
+    updateBounds(vertices.data(), vertices.size());
+  this->arena = &arena;
+
+  if (!this->references.empty()) {
+    firstReference = arena.addReferences(this->references);
+    updateReferenceBounds();
+  }
+
+  slice = arena.add(vertices, indices);
+  const auto indexSize = slice.indexType == GL_UNSIGNED_SHORT ? sizeof(GLushort) : sizeof(GLuint);
+  gpuBytes = sizeof(CompactVertex) * vertices.size() + indexSize * indices.size() +
+             sizeof(glm::mat4) * this->references.size();
+  renderInfo.vao = arena.getVao();
+  renderInfo.indexCount = slice.indexCount;
+  renderInfo.baseVertex = slice.baseVertex;
+  renderInfo.firstIndex = slice.firstIndex;
+  renderInfo.indexType = slice.indexType;
 }
 
 const Mesh::MeshRenderInfo &Mesh::getRenderInfo() const {
@@ -117,22 +183,155 @@ const Mesh::MeshBounds &Mesh::getBounds() const {
   return bounds;
 }
 
+std::size_t Mesh::getGpuBytes() const {
+  return gpuBytes;
+}
+
+bool Mesh::hasReferences() const {
+  return !references.empty();
+}
+
+const std::vector<glm::mat4> &Mesh::getReferences() const {
+  return references;
+}
+
+void Mesh::bindReferences(unsigned int vbo, std::size_t first) {
+  glState.bindBuffer(GL_ARRAY_BUFFER, vbo);
+
+  for (auto column = 0u; column < 4u; column++) {
+    const auto offset = sizeof(glm::mat4) * first + sizeof(glm::vec4) * column;
+    glVertexAttribPointer(referenceLocation + column, 4, GL_FLOAT, GL_FALSE, sizeof(glm::mat4),
+                          reinterpret_cast<void *>(offset));
+    glEnableVertexAttribArray(referenceLocation + column);
+    glVertexAttribDivisor(referenceLocation + column, 1u);
+  }
+}
+
+void Mesh::unbindReferences() {
+  for (auto column = 0u; column < 4u; column++)
+    glDisableVertexAttribArray(referenceLocation + column);
+
+  // The constant value is undefined after a draw reading the attribute from a buffer
+  setReference(glm::mat4{1.0f});
+}
+
+void Mesh::setReference(const glm::mat4 &transform) {
+  for (auto column = 0u; column < 4u; column++)
+    glVertexAttrib4fv(referenceLocation + column, glm::value_ptr(transform[static_cast<glm::length_t>(column)]));
+}
+
 void Mesh::render() {
-  glBindVertexArray(renderInfo.vao);
-  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, renderInfo.ibo);
-  glDrawElements(GL_TRIANGLES, renderInfo.indexCount, GL_UNSIGNED_INT, nullptr);
-  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
-  glBindVertexArray(0);
+  glState.bindVertexArray(renderInfo.vao);
+  if (references.empty()) {
+    glDrawElementsBaseVertex(GL_TRIANGLES, renderInfo.indexCount, renderInfo.indexType, indexOffset(),
+                             renderInfo.baseVertex);
+  } else {
+    // One instance per reference
+    bindReferences(arena->getReferenceVbo(), firstReference);
+    glDrawElementsInstancedBaseVertex(GL_TRIANGLES, renderInfo.indexCount, renderInfo.indexType, indexOffset(),
+                                      static_cast<GLsizei>(references.size()), renderInfo.baseVertex);
+    unbindReferences();
+  }
+  stats::frameCounters.drawCalls++;
+}
+
+void Mesh::renderInstanced(unsigned int instanceVbo, std::size_t first, int count) {
+  bindInstances(instanceVbo, first);
+  if (references.empty()) {
+    glDrawElementsInstancedBaseVertex(GL_TRIANGLES, renderInfo.indexCount, renderInfo.indexType, indexOffset(), count,
+                                      renderInfo.baseVertex);
+    stats::frameCounters.drawCalls++;
+  } else {
+    // The instances are already the Nodes, so each reference is a draw of its own
+    for (const auto &transform : references) {
+      setReference(transform);
+      glDrawElementsInstancedBaseVertex(GL_TRIANGLES, renderInfo.indexCount, renderInfo.indexType, indexOffset(),
+                                        count, renderInfo.baseVertex);
+      stats::frameCounters.drawCalls++;
+    }
+    setReference(glm::mat4{1.0f});
+  }
+  unbindInstances();
+}
+
+void Mesh::renderPlaced(unsigned int placementVbo, std::size_t first, int count) {
+  glState.bindVertexArray(renderInfo.vao);
+  bindReferences(placementVbo, first);
+  glDrawElementsInstancedBaseVertex(GL_TRIANGLES, renderInfo.indexCount, renderInfo.indexType, indexOffset(), count,
+                                    renderInfo.baseVertex);
+  stats::frameCounters.drawCalls++;
+  unbindReferences();
+}
+
+void Mesh::bindInstances(unsigned int instanceVbo, std::size_t first) {
+  glState.bindVertexArray(renderInfo.vao);
+  glState.bindBuffer(GL_ARRAY_BUFFER, instanceVbo);
+
+  glVertexAttribIPointer(3u, 1, GL_UNSIGNED_INT, sizeof(Instance),
+                         reinterpret_cast<void *>(first * sizeof(Instance)));
+  glEnableVertexAttribArray(3u);
+  glVertexAttribDivisor(3u, 1u);
+}
+
+void Mesh::unbindInstances() {
+  // The same VAO is used for single draws, which only read the per-vertex attributes
+  glDisableVertexAttribArray(3u);
+}
+
+void Mesh::renderTransmissions(unsigned int instanceVbo, int count) {
+  glState.bindVertexArray(renderInfo.vao);
+  glState.bindBuffer(GL_ARRAY_BUFFER, instanceVbo);
+
+  auto attribute = [](std::size_t offset) {
+    return reinterpret_cast<void *>(offset);
+  };
+
+  glVertexAttribPointer(3u, 3, GL_FLOAT, GL_FALSE, sizeof(TransmissionInstance),
+                        attribute(offsetof(TransmissionInstance, center)));
+  glVertexAttribPointer(4u, 1, GL_FLOAT, GL_FALSE, sizeof(TransmissionInstance),
+                        attribute(offsetof(TransmissionInstance, startTime)));
+  glVertexAttribPointer(5u, 1, GL_FLOAT, GL_FALSE, sizeof(TransmissionInstance),
+                        attribute(offsetof(TransmissionInstance, duration)));
+  glVertexAttribPointer(6u, 1, GL_FLOAT, GL_FALSE, sizeof(TransmissionInstance),
+                        attribute(offsetof(TransmissionInstance, targetSize)));
+  glVertexAttribPointer(7u, 3, GL_FLOAT, GL_FALSE, sizeof(TransmissionInstance),
+                        attribute(offsetof(TransmissionInstance, color)));
+
+  for (auto location = 3u; location <= 7u; location++) {
+    glEnableVertexAttribArray(location);
+    glVertexAttribDivisor(location, 1u);
+  }
+
+  glDrawElementsInstancedBaseVertex(GL_TRIANGLES, renderInfo.indexCount, renderInfo.indexType, indexOffset(), count,
+                                    renderInfo.baseVertex);
+  stats::frameCounters.drawCalls++;
+
+  for (auto location = 3u; location <= 7u; location++)
+    glDisableVertexAttribArray(location);
+
+  // Shares locations with the references
+  setReference(glm::mat4{1.0f});
 }
 
 Mesh::~Mesh() {
-  glDeleteBuffers(1, &renderInfo.ibo);
+  // Meshes in an arena own none of their buffers, but give their space back
+  if (arena) {
+    arena->release(slice);
+    if (!references.empty())
+      arena->releaseReferences(firstReference, references.size());
+    return;
+  }
+
+  if (renderInfo.vbo == 0u)
+    return;
+
+  glState.deleteBuffer(renderInfo.ibo);
   renderInfo.ibo = 0;
 
-  glDeleteBuffers(1, &renderInfo.vbo);
+  glState.deleteBuffer(renderInfo.vbo);
   renderInfo.vbo = 0;
 
-  glDeleteVertexArrays(1, &renderInfo.vao);
+  glState.deleteVertexArray(renderInfo.vao);
   renderInfo.vao = 0;
 
   renderInfo.indexCount = 0;
@@ -34,10 +34,15 @@
 #pragma once
 
 #include "../material/material.h"
+#include "MeshArena.h"
 #include "Vertex.h"
 #include <QOpenGLFunctions_3_3_Core>
+#include <cstddef>
+#include <cstdint>
 #include <glm/glm.hpp>
+#include <optional>
 #include <utility>
+#include <vector>
 
 namespace netsimulyzer {
 
@@ -45,9 +50,27 @@ class Mesh : protected QOpenGLFunctions_3_3_Core {
 public:
   struct MeshRenderInfo {
     unsigned int vao = 0u;
+
+    /**
+     * 0 for meshes in a `MeshArena`, which owns the buffers
+     */
     unsigned int vbo = 0u;
     unsigned int ibo = 0u;
     int indexCount = 0;
+
+    /**
+     * Where the mesh starts in its buffers.
+     * Only set for meshes in a `MeshArena`.
+     * `firstIndex` is counted in indices of `indexType`
+     */
+    int baseVertex = 0;
+    std::size_t firstIndex = 0u;
+
+    /**
+     * `GL_UNSIGNED_SHORT` for small meshes in a `MeshArena`,
+     * `GL_UNSIGNED_INT` otherwise
+     */
+    unsigned int indexType = GL_UNSIGNED_INT;
   };
 
   struct MeshBounds {
@@ -55,16 +78,129 @@ public:
     glm::vec3 max{0.0f};
   };
 
+  /**
+   * The per-instance attribute read by `renderInstanced()`.
+   * The slot of the instance's Node in the node data texture,
+   * which holds the rest of its attributes
+   */
+  using Instance = std::uint32_t;
+
+  /**
+   * The first of the 4 attribute locations with the placement of each reference
+   * to a mesh, one column each. Constant at the identity for meshes referenced once
+   */
+  static constexpr unsigned int referenceLocation = 4u;
+
+  /**
+   * Per-instance attributes read by `renderTransmissions()`.
+   * Matches the instance inputs of the transmission shader
+   */
+  struct TransmissionInstance {
+    glm::vec3 center{0.0f};
+
+    /**
+     * Start of the transmission, in milliseconds
+     * since the instances were uploaded
+     */
+    float startTime{0.0f};
+
+    /**
+     * Length of the transmission, in milliseconds
+     */
+    float duration{0.0f};
+
+    /**
+     * The radius of the sphere once the transmission ends
+     */
+    float targetSize{0.0f};
+
+    glm::vec3 color{0.0f};
+  };
+
 private:
   MeshRenderInfo renderInfo;
   MeshBounds bounds;
   Material material;
 
+  /**
+   * Where each reference to the mesh places it,
+   * empty if it is only drawn once, where its vertices are
+   */
+  std::vector<glm::mat4> references;
+
+  /**
+   * The arena holding the mesh, and `references` from `firstReference` on.
+   * Unset for meshes with buffers of their own
+   */
+  MeshArena *arena{nullptr};
+  MeshArena::Slice slice;
+  std::size_t firstReference{0u};
+
+  /**
+   * The size of the mesh on the GPU
+   */
+  std::size_t gpuBytes{0u};
+
   void move(Mesh &&other) noexcept;
+  void updateBounds(const Vertex vertices[], std::size_t vertexCount);
+
+  /**
+   * Grow the bounds to cover the mesh in every one of `references`
+   */
+  void updateReferenceBounds();
+
+  /**
+   * Read the `references` attribute from `vbo`, one transform per instance.
+   * Undone by `unbindReferences()`
+   *
+   * @param vbo
+   * Buffer filled with transforms
+   *
+   * @param first
+   * The index of the transform read by the first instance
+   */
+  void bindReferences(unsigned int vbo, std::size_t first);
+
+  /**
+   * Stop reading the `references` attribute, after `bindReferences()`
+   */
+  void unbindReferences();
+
+  /**
+   * Set the constant value of the `references` attribute, used while it's not read from a buffer
+   */
+  void setReference(const glm::mat4 &transform);
+
+  /**
+   * @return
+   * The offset of the first index of this mesh, for the draw calls
+   */
+  [[nodiscard]] const void *indexOffset() const;
 
 public:
   Mesh(const Vertex vertices[], unsigned int indices[], unsigned int vertexCount, int indexCount);
 
+  /**
+   * Place a mesh in `arena`, rather than in buffers of its own
+   *
+   * @param arena
+   * The arena to copy the mesh into. Must outlive the mesh
+   *
+   * @param vertices
+   * The vertices of the mesh
+   *
+   * @param indices
+   * The indices of the mesh, relative to its first vertex
+   *
+   * @param references
+   * Where the mesh is placed by each reference to it, empty to draw it once, where its vertices are
+   *
+   * @param knownBounds
+   * The bounds of `vertices`, if already measured. Otherwise they are measured here
+   */
+  Mesh(MeshArena &arena, const std::vector<Vertex> &vertices, const std::vector<unsigned int> &indices,
+       std::vector<glm::mat4> references = {}, const std::optional<MeshBounds> &knownBounds = {});
+
   // Allow Moves
   Mesh(Mesh &&other) noexcept {
     move(std::forward<Mesh &&>(other));
@@ -86,8 +222,93 @@ public:
 
   [[nodiscard]] const MeshBounds &getBounds() const;
 
+  /**
+   * @return
+   * The bytes of vertices, indices & references the mesh uses on the GPU
+   */
+  [[nodiscard]] std::size_t getGpuBytes() const;
+
+  /**
+   * @return
+   * True if the mesh is drawn at more than one placement,
+   * in which case it may not be part of an indirect draw
+   */
+  [[nodiscard]] bool hasReferences() const;
+
+  /**
+   * @return
+   * Where each reference to the mesh places it,
+   * empty if it is only drawn once
+   */
+  [[nodiscard]] const std::vector<glm::mat4> &getReferences() const;
+
+  /**
+   * Draw the mesh, once for each reference to it, in one draw
+   */
   void render();
 
+  /**
+   * Draw `count` instances of this mesh,
+   * with the attributes of each from `instanceVbo`.
+   * Meshes with references take one draw per reference
+   *
+   * @param instanceVbo
+   * Buffer filled with `Instance`s
+   *
+   * @param first
+   * The index of the first `Instance` in `instanceVbo` to draw
+   *
+   * @param count
+   * The number of instances to draw
+   */
+  void renderInstanced(unsigned int instanceVbo, std::size_t first, int count);
+
+  /**
+   * Draw `count` copies of this mesh in one draw,
+   * each placed by a transform from `placementVbo`, in place of the references.
+   * The placements should already include the references, see `DecorationBatch`
+   *
+   * @param placementVbo
+   * Buffer filled with transforms
+   *
+   * @param first
+   * The index of the first transform in `placementVbo` to draw
+   *
+   * @param count
+   * The number of copies to draw
+   */
+  void renderPlaced(unsigned int placementVbo, std::size_t first, int count);
+
+  /**
+   * Bind the VAO of this mesh, with the `Instance` attribute read from `instanceVbo`.
+   * Undone by `unbindInstances()`
+   *
+   * @param instanceVbo
+   * Buffer filled with `Instance`s
+   *
+   * @param first
+   * The index of the `Instance` read by the first instance of a draw,
+   * before any base instance
+   */
+  void bindInstances(unsigned int instanceVbo, std::size_t first);
+
+  /**
+   * Stop reading the `Instance` attribute, after `bindInstances()`
+   */
+  void unbindInstances();
+
+  /**
+   * Draw one instance of this mesh for each transmission in `instanceVbo`,
+   * scaled by the transmission shader
+   *
+   * @param instanceVbo
+   * Buffer filled with `TransmissionInstance`s
+   *
+   * @param count
+   * The number of instances to draw
+   */
+  void renderTransmissions(unsigned int instanceVbo, int count);
+
   ~Mesh() override;
 };
 
@@ -0,0 +1,304 @@
+/*
+ * NIST-developed software is provided by NIST as a public service. You may use,
+ * copy and distribute copies of the software in any medium, provided that you
+ * keep intact this entire notice. You may improve,modify and create derivative
+ * works of the software or any portion of the software, and you may copy and
+ * distribute such modifications or works. Modified works should carry a notice
+ * stating that you changed the software and should note the date and nature of
+ * any such change. Please explicitly acknowledge the National Institute of
+ * Standards and Technology as the source of the software.
+ *
+ * NIST-developed software is expressly provided "AS IS." NIST MAKES NO
+ * WARRANTY OF ANY KIND, EXPRESS, IMPLIED, IN FACT OR ARISING BY OPERATION OF
+ * LAW, INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTY OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, NON-INFRINGEMENT
+ * AND DATA ACCURACY. NIST NEITHER REPRESENTS NOR WARRANTS THAT THE
+ * OPERATION OF THE SOFTWARE WILL BE UNINTERRUPTED OR ERROR-FREE, OR THAT
+ * ANY DEFECTS WILL BE CORRECTED. NIST DOES NOT WARRANT OR MAKE ANY
+ * REPRESENTATIONS REGARDING THE USE OF THE SOFTWARE OR THE RESULTS THEREOF,
+ * INCLUDING BUT NOT LIMITED TO THE CORRECTNESS, ACCURACY, RELIABILITY,
+ * OR USEFULNESS OF THE SOFTWARE.
+ *
+ * You are solely responsible for determining the appropriateness of using and
+ * distributing the software and you assume all risks associated with its use,
+ * including but not limited to the risks and costs of program errors,
+ * compliance with applicable laws, damage to or loss of data, programs or
+ * equipment, and the unavailability or interruption of operation. This
+ * software is not intended to be used in any situation where a failure could
+ * cause risk of injury or damage to property. The software developed by NIST
+ * employees is not subject to copyright protection within the United States.
+ *
+ * Author: Evan Black <evan.black@nist.gov>
+ */
+
+
+#include "MeshArena.h"
+#include "../render-stats.h"
+#include "../renderer/GlState.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <glm/gtc/packing.hpp>
+#include <iterator>
+
+namespace netsimulyzer {
+
+/**
+ * Pack `v` for the arena's vertex buffer
+ */
+static CompactVertex compact(const Vertex &v) {
+  CompactVertex packed; // NOLINT(cppcoreguidelines-pro-type-member-init)
+  packed.position = v.position;
+  packed.normal = glm::packSnorm3x10_1x2(glm::vec4{v.normal[0], v.normal[1], v.normal[2], 0.0f});
+  packed.textureCoordinate = {glm::packHalf1x16(v.textureCoordinate[0]), glm::packHalf1x16(v.textureCoordinate[1])};
+  return packed;
+}
+
+std::optional<std::size_t> MeshArena::FreeList::take(std::size_t size, std::size_t alignment) {
+  for (auto it = ranges.begin(); it != ranges.end(); it++) {
+    const auto offset = (it->offset + alignment - 1u) & ~(alignment - 1u);
+    const auto end = it->offset + it->size;
+    if (offset + size > end)
+      continue;
+
+    // Keep what's left on either side of the space taken
+    const Range before{it->offset, offset - it->offset};
+    const Range after{offset + size, end - offset - size};
+    it = ranges.erase(it);
+    if (after.size > 0u)
+      it = ranges.insert(it, after);
+    if (before.size > 0u)
+      ranges.insert(it, before);
+
+    return offset;
+  }
+
+  return {};
+}
+
+void MeshArena::FreeList::release(std::size_t offset, std::size_t size) {
+  if (size == 0u)
+    return;
+
+  auto next = std::lower_bound(ranges.begin(), ranges.end(), offset, [](const Range &range, std::size_t value) {
+    return range.offset < value;
+  });
+  next = ranges.insert(next, {offset, size});
+
+  // Merge with the following range, then the one before
+  if (const auto after = next + 1; after != ranges.end() && next->offset + next->size == after->offset) {
+    next->size += after->size;
+    next = ranges.erase(after) - 1;
+  }
+  if (next != ranges.begin()) {
+    const auto before = next - 1;
+    if (before->offset + before->size == next->offset) {
+      before->size += next->size;
+      ranges.erase(next);
+    }
+  }
+}
+
+void MeshArena::FreeList::clear() {
+  ranges.clear();
+}
+
+MeshArena::~MeshArena() {
+  glState.deleteBuffer(referenceVbo);
+  glState.deleteBuffer(ibo);
+  glState.deleteBuffer(vbo);
+  glState.deleteVertexArray(vao);
+}
+
+void MeshArena::init() {
+  initializeOpenGLFunctions();
+
+  glGenVertexArrays(1, &vao);
+  glGenBuffers(1, &vbo);
+  glGenBuffers(1, &ibo);
+
+  vertexCapacity = initialVertices;
+  glState.bindBuffer(GL_ARRAY_BUFFER, vbo);
+  glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(sizeof(CompactVertex) * vertexCapacity), nullptr,
+               GL_STATIC_DRAW);
+
+  indexCapacity = initialIndexBytes;
+  glState.bindVertexArray(vao);
+  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ibo);
+  glBufferData(GL_ELEMENT_ARRAY_BUFFER, static_cast<GLsizeiptr>(indexCapacity), nullptr, GL_STATIC_DRAW);
+
+  setAttributes();
+
+  glGenBuffers(1, &referenceVbo);
+  referenceCapacity = initialReferences;
+  glState.bindBuffer(GL_ARRAY_BUFFER, referenceVbo);
+  glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(sizeof(glm::mat4) * referenceCapacity), nullptr,
+               GL_STATIC_DRAW);
+}
+
+void MeshArena::setAttributes() {
+  glState.bindVertexArray(vao);
+  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ibo);
+  glState.bindBuffer(GL_ARRAY_BUFFER, vbo);
+
+  // Location
+  glVertexAttribPointer(0u, 3, GL_FLOAT, GL_FALSE, sizeof(CompactVertex),
+                        reinterpret_cast<void *>(offsetof(CompactVertex, position)));
+  glEnableVertexAttribArray(0u);
+
+  // Normal, the packed type always has 4 components, the shader ignores the last
+  glVertexAttribPointer(1u, 4, GL_INT_2_10_10_10_REV, GL_TRUE, sizeof(CompactVertex),
+                        reinterpret_cast<void *>(offsetof(CompactVertex, normal)));
+  glEnableVertexAttribArray(1u);
+
+  // Texture
+  glVertexAttribPointer(2u, 2, GL_HALF_FLOAT, GL_FALSE, sizeof(CompactVertex),
+                        reinterpret_cast<void *>(offsetof(CompactVertex, textureCoordinate)));
+  glEnableVertexAttribArray(2u);
+
+  glState.bindVertexArray(0u);
+}
+
+void MeshArena::grow(unsigned int &buffer, std::size_t used, std::size_t size) {
+  unsigned int larger;
+  glGenBuffers(1, &larger);
+
+  // The copy targets are only for copies, so they're not tracked by `glState`
+  glBindBuffer(GL_COPY_WRITE_BUFFER, larger);
+  glBufferData(GL_COPY_WRITE_BUFFER, static_cast<GLsizeiptr>(size), nullptr, GL_STATIC_DRAW);
+
+  if (used > 0u) {
+    glBindBuffer(GL_COPY_READ_BUFFER, buffer);
+    glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, static_cast<GLsizeiptr>(used));
+    stats::frameCounters.bufferUploads++;
+  }
+
+  glState.deleteBuffer(buffer);
+  buffer = larger;
+}
+
+MeshArena::Slice MeshArena::add(const std::vector<Vertex> &vertices, const std::vector<unsigned int> &indices) {
+  // Indices are relative to the base vertex, so only the size of this mesh matters
+  const auto shortIndices = vertices.size() < shortIndexLimit;
+  const auto indexSize = shortIndices ? sizeof(std::uint16_t) : sizeof(std::uint32_t);
+
+  // Reuse released space, otherwise append to the buffers.
+  // Keep every mesh aligned for either size of index
+  const auto reusedVertex = vertices.empty() ? std::nullopt : freeVertices.take(vertices.size(), 1u);
+  const auto reusedByte = indices.empty() ? std::nullopt : freeIndexBytes.take(indexSize * indices.size(), 4u);
+
+  const auto firstVertex = reusedVertex.value_or(vertexCount);
+  const auto firstByte = reusedByte.value_or((indexBytes + 3u) & ~std::size_t{3u});
+  const auto neededVertices = reusedVertex ? vertexCount : vertexCount + vertices.size();
+  const auto neededIndexBytes = reusedByte ? indexBytes : firstByte + indexSize * indices.size();
+
+  if (neededVertices > vertexCapacity || neededIndexBytes > indexCapacity) {
+    if (neededVertices > vertexCapacity) {
+      const auto capacity = std::max(vertexCapacity * 2u, neededVertices);
+      grow(vbo, sizeof(CompactVertex) * vertexCount, sizeof(CompactVertex) * capacity);
+      vertexCapacity = capacity;
+    }
+
+    if (neededIndexBytes > indexCapacity) {
+      const auto capacity = std::max(indexCapacity * 2u, neededIndexBytes);
+      grow(ibo, indexBytes, capacity);
+      indexCapacity = capacity;
+    }
+
+    // Same VAO, so meshes already added keep drawing from it
+    setAttributes();
+  }
+
+  Slice slice;
+  slice.baseVertex = static_cast<int>(firstVertex);
+  slice.vertexCount = static_cast<int>(vertices.size());
+  slice.firstIndex = firstByte / indexSize;
+  slice.indexCount = static_cast<int>(indices.size());
+  slice.indexType = shortIndices ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+
+  std::vector<CompactVertex> packed;
+  packed.reserve(vertices.size());
+  std::transform(vertices.begin(), vertices.end(), std::back_inserter(packed), compact);
+
+  glState.bindBuffer(GL_ARRAY_BUFFER, vbo);
+  glBufferSubData(GL_ARRAY_BUFFER, static_cast<GLintptr>(sizeof(CompactVertex) * firstVertex),
+                  static_cast<GLsizeiptr>(sizeof(CompactVertex) * packed.size()), packed.data());
+
+  glState.bindVertexArray(vao);
+  if (shortIndices) {
+    const std::vector<std::uint16_t> shortened{indices.begin(), indices.end()};
+    glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, static_cast<GLintptr>(firstByte),
+                    static_cast<GLsizeiptr>(indexSize * shortened.size()), shortened.data());
+  } else {
+    glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, static_cast<GLintptr>(firstByte),
+                    static_cast<GLsizeiptr>(indexSize * indices.size()), indices.data());
+  }
+  stats::frameCounters.bufferUploads++;
+
+  // Keep later element buffer binds from landing in the arena
+  glState.bindVertexArray(0u);
+
+  vertexCount = neededVertices;
+  indexBytes = neededIndexBytes;
+  usedBytes += sizeof(CompactVertex) * vertices.size() + indexSize * indices.size();
+  return slice;
+}
+
+void MeshArena::release(const Slice &slice) {
+  const auto indexSize = slice.indexType == GL_UNSIGNED_SHORT ? sizeof(std::uint16_t) : sizeof(std::uint32_t);
+  const auto vertices = static_cast<std::size_t>(slice.vertexCount);
+  const auto bytes = indexSize * static_cast<std::size_t>(slice.indexCount);
+
+  freeVertices.release(static_cast<std::size_t>(slice.baseVertex), vertices);
+  freeIndexBytes.release(indexSize * slice.firstIndex, bytes);
+  usedBytes -= sizeof(CompactVertex) * vertices + bytes;
+}
+
+void MeshArena::releaseReferences(std::size_t first, std::size_t count) {
+  freeReferences.release(first, count);
+  usedBytes -= sizeof(glm::mat4) * count;
+}
+
+std::size_t MeshArena::getUsedBytes() const {
+  return usedBytes;
+}
+
+std::size_t MeshArena::addReferences(const std::vector<glm::mat4> &references) {
+  const auto reused = freeReferences.take(references.size(), 1u);
+  const auto first = reused.value_or(referenceCount);
+  const auto needed = reused ? referenceCount : referenceCount + references.size();
+  if (needed > referenceCapacity) {
+    const auto capacity = std::max(referenceCapacity * 2u, needed);
+    grow(referenceVbo, sizeof(glm::mat4) * referenceCount, sizeof(glm::mat4) * capacity);
+    referenceCapacity = capacity;
+  }
+
+  glState.bindBuffer(GL_ARRAY_BUFFER, referenceVbo);
+  glBufferSubData(GL_ARRAY_BUFFER, static_cast<GLintptr>(sizeof(glm::mat4) * first),
+                  static_cast<GLsizeiptr>(sizeof(glm::mat4) * references.size()), references.data());
+  stats::frameCounters.bufferUploads++;
+
+  referenceCount = needed;
+  usedBytes += sizeof(glm::mat4) * references.size();
+  return first;
+}
+
+void MeshArena::clear() {
+  vertexCount = 0u;
+  indexBytes = 0u;
+  referenceCount = 0u;
+  usedBytes = 0u;
+  freeVertices.clear();
+  freeIndexBytes.clear();
+  freeReferences.clear();
+}
+
+unsigned int MeshArena::getVao() const {
+  return vao;
+}
+
+unsigned int MeshArena::getReferenceVbo() const {
+  return referenceVbo;
+}
+
+} // namespace netsimulyzer
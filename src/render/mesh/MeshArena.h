@@ -0,0 +1,257 @@
+/*
+ * NIST-developed software is provided by NIST as a public service. You may use,
+ * copy and distribute copies of the software in any medium, provided that you
+ * keep intact this entire notice. You may improve,modify and create derivative
+ * works of the software or any portion of the software, and you may copy and
+ * distribute such modifications or works. Modified works should carry a notice
+ * stating that you changed the software and should note the date and nature of
+ * any such change. Please explicitly acknowledge the National Institute of
+ * Standards and Technology as the source of the software.
+ *
+ * NIST-developed software is expressly provided "AS IS." NIST MAKES NO
+ * WARRANTY OF ANY KIND, EXPRESS, IMPLIED, IN FACT OR ARISING BY OPERATION OF
+ * LAW, INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTY OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, NON-INFRINGEMENT
+ * AND DATA ACCURACY. NIST NEITHER REPRESENTS NOR WARRANTS THAT THE
+ * OPERATION OF THE SOFTWARE WILL BE UNINTERRUPTED OR ERROR-FREE, OR THAT
+ * ANY DEFECTS WILL BE CORRECTED. NIST DOES NOT WARRANT OR MAKE ANY
+ * REPRESENTATIONS REGARDING THE USE OF THE SOFTWARE OR THE RESULTS THEREOF,
+ * INCLUDING BUT NOT LIMITED TO THE CORRECTNESS, ACCURACY, RELIABILITY,
+ * OR USEFULNESS OF THE SOFTWARE.
+ *
+ * You are solely responsible for determining the appropriateness of using and
+ * distributing the software and you assume all risks associated with its use,
+ * including but not limited to the risks and costs of program errors,
+ * compliance with applicable laws, damage to or loss of data, programs or
+ * equipment, and the unavailability or interruption of operation. This
+ * software is not intended to be used in any situation where a failure could
+ * cause risk of injury or damage to property. The software developed by NIST
+ * employees is not subject to copyright protection within the United States.
+ *
+ * Author: Evan Black <evan.black@nist.gov>
+ */
+
+
+#pragma once
+
+#include "Vertex.h"
+#include <QOpenGLFunctions_3_3_Core>
+#include <cstddef>
+#include <glm/glm.hpp>
+#include <optional>
+#include <vector>
+
+namespace netsimulyzer {
+
+/**
+ * One vertex & index buffer shared by many meshes, behind one VAO.
+ * Meshes are drawn with a base vertex & an offset into the index buffer,
+ * so draws of different meshes need no rebinding,
+ * and may be merged into one indirect draw.
+ *
+ * Vertices are stored as `CompactVertex`es,
+ * and meshes with few enough vertices use 16 bit indices.
+ *
+ * The placements of meshes referenced several times in a model
+ * are kept in a separate buffer, read as a per-instance attribute.
+ *
+ * Space released by meshes is reused by later meshes that fit in it
+ */
+class MeshArena : protected QOpenGLFunctions_3_3_Core {
+public:
+  /**
+   * Where a mesh was placed in the arena
+   */
+  struct Slice {
+    /**
+     * Added to each index of the mesh, its first vertex in the arena
+     */
+    int baseVertex{0};
+    int vertexCount{0};
+
+    /**
+     * The first index of the mesh in the index buffer,
+     * counted in indices of `indexType`
+     */
+    std::size_t firstIndex{0u};
+    int indexCount{0};
+
+    /**
+     * `GL_UNSIGNED_SHORT` or `GL_UNSIGNED_INT`
+     */
+    unsigned int indexType{GL_UNSIGNED_INT};
+  };
+
+private:
+  /**
+   * The released parts of one buffer, sorted by offset,
+   * with neighbouring ranges merged
+   */
+  class FreeList {
+    struct Range {
+      std::size_t offset;
+      std::size_t size;
+    };
+
+    std::vector<Range> ranges;
+
+  public:
+    /**
+     * Take `size` units from the first range with room for them
+     *
+     * @param size
+     * The units to take, non-zero
+     *
+     * @param alignment
+     * What the offset must be a multiple of, a power of two
+     *
+     * @return
+     * The offset of the space taken, unset if no range has room
+     */
+    std::optional<std::size_t> take(std::size_t size, std::size_t alignment);
+
+    void release(std::size_t offset, std::size_t size);
+    void clear();
+  };
+
+  FreeList freeVertices;
+  FreeList freeIndexBytes;
+  FreeList freeReferences;
+
+  /**
+   * Bytes of every buffer holding a mesh still in the arena
+   */
+  std::size_t usedBytes{0u};
+
+  /**
+   * Space for this many vertices & bytes of indices is allocated up front
+   */
+  static constexpr std::size_t initialVertices = 1u << 16u;
+  static constexpr std::size_t initialIndexBytes = 1u << 20u;
+  static constexpr std::size_t initialReferences = 1u << 8u;
+
+  /**
+   * Meshes with fewer vertices than this use 16 bit indices
+   */
+  static constexpr std::size_t shortIndexLimit = 1u << 16u;
+
+  unsigned int vao{0u};
+  unsigned int vbo{0u};
+  unsigned int ibo{0u};
+  std::size_t vertexCapacity{0u};
+  std::size_t vertexCount{0u};
+
+  /**
+   * In bytes, since the index buffer holds both 16 & 32 bit indices
+   */
+  std::size_t indexCapacity{0u};
+  std::size_t indexBytes{0u};
+
+  /**
+   * `glm::mat4`s, see `addReferences()`
+   */
+  unsigned int referenceVbo{0u};
+  std::size_t referenceCapacity{0u};
+  std::size_t referenceCount{0u};
+
+  /**
+   * Replace `buffer` with a larger one, keeping the first `used` bytes
+   *
+   * @param buffer
+   * The buffer to replace. Set to the new buffer
+   *
+   * @param used
+   * The size, in bytes, of the contents to keep
+   *
+   * @param size
+   * The size, in bytes, of the new buffer
+   */
+  void grow(unsigned int &buffer, std::size_t used, std::size_t size);
+
+  /**
+   * Point the VAO at `vbo` & `ibo`
+   */
+  void setAttributes();
+
+public:
+  ~MeshArena() override;
+
+  /**
+   * Allocate the buffers. Must be called with the scene's context current
+   */
+  void init();
+
+  /**
+   * Copy a mesh into the arena, growing the buffers if needed
+   *
+   * @param vertices
+   * The vertices of the mesh, packed into `CompactVertex`es
+   *
+   * @param indices
+   * The indices of the mesh, relative to its first vertex
+   *
+   * @return
+   * Where the mesh was placed
+   */
+  Slice add(const std::vector<Vertex> &vertices, const std::vector<unsigned int> &indices);
+
+  /**
+   * Copy the placements of a mesh into the arena, growing the buffer if needed
+   *
+   * @param references
+   * A transform for each reference to the mesh
+   *
+   * @return
+   * The index of the first transform in the buffer from `getReferenceVbo()`
+   */
+  std::size_t addReferences(const std::vector<glm::mat4> &references);
+
+  /**
+   * Return the space of a mesh to the arena, for later meshes to use.
+   * The mesh must no longer be drawn
+   *
+   * @param slice
+   * Where the mesh was placed by `add()`
+   */
+  void release(const Slice &slice);
+
+  /**
+   * Return the space of transforms from `addReferences()` to the arena
+   *
+   * @param first
+   * The index returned by `addReferences()`
+   *
+   * @param count
+   * The number of transforms added
+   */
+  void releaseReferences(std::size_t first, std::size_t count);
+
+  /**
+   * @return
+   * The bytes used by meshes still in the arena.
+   * The buffers are never shrunk, so they may be larger than this
+   */
+  [[nodiscard]] std::size_t getUsedBytes() const;
+
+  /**
+   * Forget every mesh, keeping the buffers for the next ones.
+   * The meshes added so far must no longer be drawn
+   */
+  void clear();
+
+  /**
+   * @return
+   * The VAO drawing every mesh in the arena.
+   * Stays the same when the arena grows
+   */
+  [[nodiscard]] unsigned int getVao() const;
+
+  /**
+   * @return
+   * The buffer with every transform from `addReferences()`.
+   * Replaced when the arena grows
+   */
+  [[nodiscard]] unsigned int getReferenceVbo() const;
+};
+
+} // namespace netsimulyzer
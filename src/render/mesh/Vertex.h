@@ -33,6 +33,7 @@
 
 #pragma once
 #include <array>
+#include <cstdint>
 
 namespace netsimulyzer {
 
@@ -42,4 +43,15 @@ struct Vertex {
   std::array<float, 2> textureCoordinate{0.0f, 0.0f};
 };
 
+/**
+ * A `Vertex` packed to 20 bytes, rather than 32, as stored in a `MeshArena`.
+ * The normal is signed & normalized, in the `GL_INT_2_10_10_10_REV` layout,
+ * and the texture coordinate is a pair of half floats
+ */
+struct CompactVertex {
+  std::array<float, 3> position;
+  std::uint32_t normal{0u};
+  std::array<std::uint16_t, 2> textureCoordinate{0u, 0u};
+};
+
 } // namespace netsimulyzer
@@ -0,0 +1,316 @@
+/*
+ * NIST-developed software is provided by NIST as a public service. You may use,
+ * copy and distribute copies of the software in any medium, provided that you
+ * keep intact this entire notice. You may improve,modify and create derivative
+ * works of the software or any portion of the software, and you may copy and
+ * distribute such modifications or works. Modified works should carry a notice
+ * stating that you changed the software and should note the date and nature of
+ * any such change. Please explicitly acknowledge the National Institute of
+ * Standards and Technology as the source of the software.
+ *
+ * NIST-developed software is expressly provided "AS IS." NIST MAKES NO
+ * WARRANTY OF ANY KIND, EXPRESS, IMPLIED, IN FACT OR ARISING BY OPERATION OF
+ * LAW, INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTY OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, NON-INFRINGEMENT
+ * AND DATA ACCURACY. NIST NEITHER REPRESENTS NOR WARRANTS THAT THE
+ * OPERATION OF THE SOFTWARE WILL BE UNINTERRUPTED OR ERROR-FREE, OR THAT
+ * ANY DEFECTS WILL BE CORRECTED. NIST DOES NOT WARRANT OR MAKE ANY
+ * REPRESENTATIONS REGARDING THE USE OF THE SOFTWARE OR THE RESULTS THEREOF,
+ * INCLUDING BUT NOT LIMITED TO THE CORRECTNESS, ACCURACY, RELIABILITY,
+ * OR USEFULNESS OF THE SOFTWARE.
+ *
+ * You are solely responsible for determining the appropriateness of using and
+ * distributing the software and you assume all risks associated with its use,
+ * including but not limited to the risks and costs of program errors,
+ * compliance with applicable laws, damage to or loss of data, programs or
+ * equipment, and the unavailability or interruption of operation. This
+ * software is not intended to be used in any situation where a failure could
+ * cause risk of injury or damage to property. The software developed by NIST
+ * employees is not subject to copyright protection within the United States.
+ *
+ * Author: Evan Black <evan.black@nist.gov>
+ */
+
+#include "optimize.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <limits>
+
+namespace netsimulyzer {
+
+namespace {
+
+/**
+ * The size of the cache simulated by `optimizeVertexCache()`
+ */
+constexpr std::size_t cacheSize = 32u;
+
+/**
+ * The size of the FIFO cache `optimizeOverdraw()` splits runs with,
+ * near the smallest hardware caches, so runs only break where every GPU would miss
+ */
+constexpr std::size_t fifoSize = 16u;
+
+constexpr float cacheDecayPower = 1.5f;
+constexpr float lastTriangleScore = 0.75f;
+constexpr float valenceBoostScale = 2.0f;
+constexpr float valenceBoostPower = 0.5f;
+
+/**
+ * @param cachePosition
+ * The position of the vertex in the simulated cache, or -1 if it is not in it
+ *
+ * @param remaining
+ * The number of triangles using the vertex which are not emitted yet
+ */
+float vertexScore(int cachePosition, unsigned int remaining) {
+  if (remaining == 0u)
+    return -1.0f;
+
+  auto score = 0.0f;
+  if (cachePosition >= 0) {
+    // The last triangle's vertices score the same, so it's not favoured by winding
+    if (cachePosition < 3)
+      score = lastTriangleScore;
+    else
+      score = std::pow(1.0f - static_cast<float>(cachePosition - 3) / static_cast<float>(cacheSize - 3u),
+                       cacheDecayPower);
+  }
+
+  // Vertices with few triangles left are finished off before they leave the cache
+  return score + valenceBoostScale * std::pow(static_cast<float>(remaining), -valenceBoostPower);
+}
+
+} // namespace
+
+void optimizeVertexCache(std::vector<unsigned int> &indices, std::size_t vertexCount) {
+  const auto triangleCount = indices.size() / 3u;
+  if (triangleCount < 2u)
+    return;
+
+  // The triangles of each vertex, packed by vertex.
+  // Emitted triangles are swapped to the end of each vertex's range
+  std::vector<unsigned int> remaining(vertexCount, 0u);
+  for (const auto index : indices)
+    remaining[index]++;
+
+  std::vector<std::size_t> offsets(vertexCount + 1u, 0u);
+  for (std::size_t v = 0u; v < vertexCount; v++)
+    offsets[v + 1u] = offsets[v] + remaining[v];
+
+  std::vector<unsigned int> adjacency(indices.size());
+  {
+    auto fill = offsets;
+    for (std::size_t t = 0u; t < triangleCount; t++) {
+      for (auto corner = 0u; corner < 3u; corner++)
+        adjacency[fill[indices[t * 3u + corner]]++] = static_cast<unsigned int>(t);
+    }
+  }
+
+  std::vector<int> cachePositions(vertexCount, -1);
+  std::vector<float> vertexScores(vertexCount);
+  for (std::size_t v = 0u; v < vertexCount; v++)
+    vertexScores[v] = vertexScore(-1, remaining[v]);
+
+  auto triangleScore = [&indices, &vertexScores](std::size_t t) {
+    return vertexScores[indices[t * 3u]] + vertexScores[indices[t * 3u + 1u]] + vertexScores[indices[t * 3u + 2u]];
+  };
+
+  std::vector<bool> emitted(triangleCount, false);
+  auto best = std::size_t{0u};
+  for (std::size_t t = 1u; t < triangleCount; t++) {
+    if (triangleScore(t) > triangleScore(best))
+      best = t;
+  }
+
+  // Room for the 3 vertices pushed in, before the ones past the end fall out
+  std::array<unsigned int, cacheSize + 3u> cache{};
+  std::size_t cacheCount = 0u;
+
+  std::vector<unsigned int> result;
+  result.reserve(indices.size());
+
+  // Where to look for a triangle once none near the cache are left, only ever moves forward
+  std::size_t cursor = 0u;
+
+  for (std::size_t count = 0u; count < triangleCount; count++) {
+    const std::array<unsigned int, 3> triangle{indices[best * 3u], indices[best * 3u + 1u], indices[best * 3u + 2u]};
+    result.insert(result.end(), triangle.begin(), triangle.end());
+    emitted[best] = true;
+
+    // Take the triangle off of each of its vertices
+    for (const auto v : triangle) {
+      const auto begin = adjacency.begin() + static_cast<std::ptrdiff_t>(offsets[v]);
+      const auto end = begin + remaining[v];
+      std::iter_swap(std::find(begin, end, static_cast<unsigned int>(best)), end - 1);
+      remaining[v]--;
+    }
+
+    // The triangle's vertices go to the front, and the rest keep their order behind them
+    std::array<unsigned int, cacheSize + 3u> next{};
+    std::size_t nextCount = 0u;
+    for (const auto v : triangle)
+      next[nextCount++] = v;
+    for (std::size_t i = 0u; i < cacheCount; i++) {
+      const auto v = cache[i];
+      if (v != triangle[0] && v != triangle[1] && v != triangle[2])
+        next[nextCount++] = v;
+    }
+
+    for (std::size_t i = 0u; i < nextCount; i++) {
+      const auto v = next[i];
+      cachePositions[v] = i < cacheSize ? static_cast<int>(i) : -1;
+      vertexScores[v] = vertexScore(cachePositions[v], remaining[v]);
+    }
+
+    // Only the triangles around the cache changed score
+    auto bestScore = -1.0f;
+    best = triangleCount;
+    for (std::size_t i = 0u; i < nextCount; i++) {
+      const auto v = next[i];
+      for (auto a = offsets[v]; a < offsets[v] + remaining[v]; a++) {
+        const auto t = adjacency[a];
+        const auto score = triangleScore(t);
+        if (score > bestScore) {
+          bestScore = score;
+          best = t;
+        }
+      }
+    }
+
+    cacheCount = std::min(nextCount, cacheSize);
+    cache = next;
+
+    // Nothing left near the cache, start over at the next triangle not emitted
+    if (best == triangleCount) {
+      while (cursor < triangleCount && emitted[cursor])
+        cursor++;
+      best = cursor;
+    }
+  }
+
+  indices = std::move(result);
+}
+
+void optimizeOverdraw(const std::vector<Vertex> &vertices, std::vector<unsigned int> &indices) {
+  const auto triangleCount = indices.size() / 3u;
+  if (triangleCount < 2u)
+    return;
+
+  auto position = [&vertices](unsigned int index) {
+    const auto &p = vertices[index].position;
+    return glm::vec3{p[0], p[1], p[2]};
+  };
+
+  // Split where a triangle misses the cache on every vertex, where the cache order started over anyway
+  std::vector<std::size_t> runStarts{0u};
+  {
+    std::vector<std::uint32_t> insertedAt(vertices.size(), 0u);
+    std::uint32_t time = fifoSize + 1u;
+    for (std::size_t t = 0u; t < triangleCount; t++) {
+      auto misses = 0u;
+      for (auto corner = 0u; corner < 3u; corner++) {
+        const auto v = indices[t * 3u + corner];
+        if (time - insertedAt[v] > fifoSize) {
+          insertedAt[v] = time++;
+          misses++;
+        }
+      }
+
+      if (misses == 3u && t > 0u)
+        runStarts.emplace_back(t);
+    }
+  }
+  if (runStarts.size() < 2u)
+    return;
+  runStarts.emplace_back(triangleCount);
+
+  struct Run {
+    std::size_t first;
+    std::size_t last;
+    float key;
+  };
+
+  auto meshCenter = glm::vec3{0.0f};
+  auto meshArea = 0.0f;
+  std::vector<Run> runs;
+  std::vector<std::pair<glm::vec3, glm::vec3>> runCenterNormals;
+  runs.reserve(runStarts.size() - 1u);
+  runCenterNormals.reserve(runStarts.size() - 1u);
+
+  for (std::size_t r = 0u; r + 1u < runStarts.size(); r++) {
+    auto center = glm::vec3{0.0f};
+    auto normal = glm::vec3{0.0f};
+    auto area = 0.0f;
+    for (auto t = runStarts[r]; t < runStarts[r + 1u]; t++) {
+      const auto a = position(indices[t * 3u]);
+      const auto b = position(indices[t * 3u + 1u]);
+      const auto c = position(indices[t * 3u + 2u]);
+
+      // Twice the area, weighted the same everywhere
+      const auto cross = glm::cross(b - a, c - a);
+      const auto triangleArea = glm::length(cross);
+      center += (a + b + c) * (triangleArea / 3.0f);
+      normal += cross;
+      area += triangleArea;
+    }
+
+    meshCenter += center;
+    meshArea += area;
+    runs.push_back({runStarts[r], runStarts[r + 1u], 0.0f});
+    runCenterNormals.emplace_back(area > 0.0f ? center / area : center, normal);
+  }
+
+  if (meshArea <= 0.0f)
+    return;
+  meshCenter /= meshArea;
+
+  for (std::size_t r = 0u; r < runs.size(); r++) {
+    const auto &[center, normal] = runCenterNormals[r];
+    const auto length = glm::length(normal);
+    runs[r].key = length > 0.0f ? glm::dot(center - meshCenter, normal / length) : 0.0f;
+  }
+
+  // Furthest out & facing out first
+  std::stable_sort(runs.begin(), runs.end(), [](const Run &left, const Run &right) {
+    return left.key > right.key;
+  });
+
+  std::vector<unsigned int> result;
+  result.reserve(indices.size());
+  for (const auto &run : runs) {
+    result.insert(result.end(), indices.begin() + static_cast<std::ptrdiff_t>(run.first * 3u),
+                  indices.begin() + static_cast<std::ptrdiff_t>(run.last * 3u));
+  }
+
+  indices = std::move(result);
+}
+
+void optimizeVertexFetch(std::vector<Vertex> &vertices, std::vector<unsigned int> &indices) {
+  constexpr auto unused = std::numeric_limits<unsigned int>::max();
+  std::vector<unsigned int> remap(vertices.size(), unused);
+  std::vector<Vertex> result;
+  result.reserve(vertices.size());
+
+  for (auto &index : indices) {
+    auto &mapped = remap[index];
+    if (mapped == unused) {
+      mapped = static_cast<unsigned int>(result.size());
+      result.emplace_back(vertices[index]);
+    }
+    index = mapped;
+  }
+
+  vertices = std::move(result);
+}
+
+void optimizeMesh(std::vector<Vertex> &vertices, std::vector<unsigned int> &indices) {
+  optimizeVertexCache(indices, vertices.size());
+  optimizeOverdraw(vertices, indices);
+  optimizeVertexFetch(vertices, indices);
+}
+
+} // namespace netsimulyzer
@@ -0,0 +1,92 @@
+/*
+ * NIST-developed software is provided by NIST as a public service. You may use,
+ * copy and distribute copies of the software in any medium, provided that you
+ * keep intact this entire notice. You may improve,modify and create derivative
+ * works of the software or any portion of the software, and you may copy and
+ * distribute such modifications or works. Modified works should carry a notice
+ * stating that you changed the software and should note the date and nature of
+ * any such change. Please explicitly acknowledge the National Institute of
+ * Standards and Technology as the source of the software.
+ *
+ * NIST-developed software is expressly provided "AS IS." NIST MAKES NO
+ * WARRANTY OF ANY KIND, EXPRESS, IMPLIED, IN FACT OR ARISING BY OPERATION OF
+ * LAW, INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTY OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, NON-INFRINGEMENT
+ * AND DATA ACCURACY. NIST NEITHER REPRESENTS NOR WARRANTS THAT THE
+ * OPERATION OF THE SOFTWARE WILL BE UNINTERRUPTED OR ERROR-FREE, OR THAT
+ * ANY DEFECTS WILL BE CORRECTED. NIST DOES NOT WARRANT OR MAKE ANY
+ * REPRESENTATIONS REGARDING THE USE OF THE SOFTWARE OR THE RESULTS THEREOF,
+ * INCLUDING BUT NOT LIMITED TO THE CORRECTNESS, ACCURACY, RELIABILITY,
+ * OR USEFULNESS OF THE SOFTWARE.
+ *
+ * You are solely responsible for determining the appropriateness of using and
+ * distributing the software and you assume all risks associated with its use,
+ * including but not limited to the risks and costs of program errors,
+ * compliance with applicable laws, damage to or loss of data, programs or
+ * equipment, and the unavailability or interruption of operation. This
+ * software is not intended to be used in any situation where a failure could
+ * cause risk of injury or damage to property. The software developed by NIST
+ * employees is not subject to copyright protection within the United States.
+ *
+ * Author: Evan Black <evan.black@nist.gov>
+ */
+
+#pragma once
+
+#include "Vertex.h"
+#include <cstddef>
+#include <vector>
+
+namespace netsimulyzer {
+
+/**
+ * Reorder the triangles of a mesh so each one reuses as many of the vertices
+ * of the triangles just before it as possible, which the GPU keeps transformed in its post-transform cache.
+ * Uses Tom Forsyth's linear-speed vertex cache optimization
+ *
+ * @param indices
+ * Triangle list indices, reordered in place
+ *
+ * @param vertexCount
+ * The number of vertices `indices` refer to
+ */
+void optimizeVertexCache(std::vector<unsigned int> &indices, std::size_t vertexCount);
+
+/**
+ * Reorder runs of triangles so those facing out from the middle of the mesh are drawn first,
+ * and hide those behind them before they are shaded.
+ * Runs are split where the cache order already starts over, so the reuse from `optimizeVertexCache()` is kept
+ *
+ * @param vertices
+ * The vertices of the mesh
+ *
+ * @param indices
+ * Triangle list indices into `vertices`, in cache order, reordered in place
+ */
+void optimizeOverdraw(const std::vector<Vertex> &vertices, std::vector<unsigned int> &indices);
+
+/**
+ * Reorder the vertices of a mesh into the order the indices first use them,
+ * so the GPU reads the vertex buffer front to back.
+ * Vertices no index uses are dropped
+ *
+ * @param vertices
+ * The vertices of the mesh, reordered in place
+ *
+ * @param indices
+ * The indices into `vertices`, updated to the new order
+ */
+void optimizeVertexFetch(std::vector<Vertex> &vertices, std::vector<unsigned int> &indices);
+
+/**
+ * Run `optimizeVertexCache()`, `optimizeOverdraw()`, then `optimizeVertexFetch()` on a triangle mesh
+ *
+ * @param vertices
+ * The vertices of the mesh, reordered in place
+ *
+ * @param indices
+ * Triangle list indices into `vertices`, reordered in place
+ */
+void optimizeMesh(std::vector<Vertex> &vertices, std::vector<unsigned int> &indices);
+
+} // namespace netsimulyzer
@@ -0,0 +1,136 @@
+/*
+ * NIST-developed software is provided by NIST as a public service. You may use,
+ * copy and distribute copies of the software in any medium, provided that you
+ * keep intact this entire notice. You may improve,modify and create derivative
+ * works of the software or any portion of the software, and you may copy and
+ * distribute such modifications or works. Modified works should carry a notice
+ * stating that you changed the software and should note the date and nature of
+ * any such change. Please explicitly acknowledge the National Institute of
+ * Standards and Technology as the source of the software.
+ *
+ * NIST-developed software is expressly provided "AS IS." NIST MAKES NO
+ * WARRANTY OF ANY KIND, EXPRESS, IMPLIED, IN FACT OR ARISING BY OPERATION OF
+ * LAW, INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTY OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, NON-INFRINGEMENT
+ * AND DATA ACCURACY. NIST NEITHER REPRESENTS NOR WARRANTS THAT THE
+ * OPERATION OF THE SOFTWARE WILL BE UNINTERRUPTED OR ERROR-FREE, OR THAT
+ * ANY DEFECTS WILL BE CORRECTED. NIST DOES NOT WARRANT OR MAKE ANY
+ * REPRESENTATIONS REGARDING THE USE OF THE SOFTWARE OR THE RESULTS THEREOF,
+ * INCLUDING BUT NOT LIMITED TO THE CORRECTNESS, ACCURACY, RELIABILITY,
+ * OR USEFULNESS OF THE SOFTWARE.
+ *
+ * You are solely responsible for determining the appropriateness of using and
+ * distributing the software and you assume all risks associated with its use,
+ * including but not limited to the risks and costs of program errors,
+ * compliance with applicable laws, damage to or loss of data, programs or
+ * equipment, and the unavailability or interruption of operation. This
+ * software is not intended to be used in any situation where a failure could
+ * cause risk of injury or damage to property. The software developed by NIST
+ * employees is not subject to copyright protection within the United States.
+ *
+ * Author: Evan Black <evan.black@nist.gov>
+ */
+
+
+#include "simplify.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+
+namespace netsimulyzer {
+
+SimplifiedMesh simplify(const std::vector<Vertex> &vertices, const std::vector<unsigned int> &indices,
+                        const glm::vec3 &origin, float cellSize) {
+  struct Cluster {
+    glm::vec3 position{0.0f};
+    glm::vec3 normal{0.0f};
+    glm::vec2 textureCoordinate{0.0f};
+    unsigned int count{0u};
+  };
+
+  // 21 bits per axis, wrapping for grids larger than that
+  auto cellKey = [&origin, cellSize](const Vertex &v) {
+    const glm::vec3 position{v.position[0], v.position[1], v.position[2]};
+    const auto cell = glm::floor((position - origin) / cellSize);
+    constexpr std::uint64_t mask = (1u << 21u) - 1u;
+
+    return (static_cast<std::uint64_t>(static_cast<std::int64_t>(cell.x)) & mask) |
+           (static_cast<std::uint64_t>(static_cast<std::int64_t>(cell.y)) & mask) << 21u |
+           (static_cast<std::uint64_t>(static_cast<std::int64_t>(cell.z)) & mask) << 42u;
+  };
+
+  std::unordered_map<std::uint64_t, unsigned int> cellClusters;
+  std::vector<Cluster> clusters;
+  std::vector<unsigned int> vertexClusters;
+  vertexClusters.reserve(vertices.size());
+
+  for (const auto &v : vertices) {
+    const auto [found, inserted] = cellClusters.try_emplace(cellKey(v), static_cast<unsigned int>(clusters.size()));
+    if (inserted)
+      clusters.emplace_back();
+
+    auto &cluster = clusters[found->second];
+    cluster.position += glm::vec3{v.position[0], v.position[1], v.position[2]};
+    cluster.normal += glm::vec3{v.normal[0], v.normal[1], v.normal[2]};
+    cluster.textureCoordinate += glm::vec2{v.textureCoordinate[0], v.textureCoordinate[1]};
+    cluster.count++;
+
+    vertexClusters.emplace_back(found->second);
+  }
+
+  // Keep the triangles which still span three clusters, once each
+  std::vector<std::array<unsigned int, 3>> triangles;
+  triangles.reserve(indices.size() / 3u);
+  for (std::size_t i = 0u; i + 2u < indices.size(); i += 3u) {
+    const std::array<unsigned int, 3> triangle{vertexClusters[indices[i]], vertexClusters[indices[i + 1u]],
+                                               vertexClusters[indices[i + 2u]]};
+    if (triangle[0] == triangle[1] || triangle[1] == triangle[2] || triangle[0] == triangle[2])
+      continue;
+
+    // Rotate the smallest index first, so the winding is kept when comparing
+    const auto smallest = std::min_element(triangle.begin(), triangle.end()) - triangle.begin();
+    triangles.push_back({triangle[smallest], triangle[(smallest + 1) % 3], triangle[(smallest + 2) % 3]});
+  }
+  std::sort(triangles.begin(), triangles.end());
+  triangles.erase(std::unique(triangles.begin(), triangles.end()), triangles.end());
+
+  // Only emit the clusters still used by a triangle
+  SimplifiedMesh result;
+  std::vector<unsigned int> remap(clusters.size(), 0u);
+  std::vector<bool> used(clusters.size(), false);
+  for (const auto &triangle : triangles) {
+    for (const auto cluster : triangle)
+      used[cluster] = true;
+  }
+
+  for (std::size_t i = 0u; i < clusters.size(); i++) {
+    if (!used[i])
+      continue;
+
+    const auto &cluster = clusters[i];
+    const auto count = static_cast<float>(cluster.count);
+    const auto position = cluster.position / count;
+    const auto length = glm::length(cluster.normal);
+    const auto normal = length > 0.0f ? cluster.normal / length : cluster.normal;
+    const auto textureCoordinate = cluster.textureCoordinate / count;
+
+    remap[i] = static_cast<unsigned int>(result.vertices.size());
+    auto &v = result.vertices.emplace_back();
+    v.position = {position.x, position.y, position.z};
+    v.normal = {normal.x, normal.y, normal.z};
+    v.textureCoordinate = {textureCoordinate.x, textureCoordinate.y};
+  }
+
+  result.indices.reserve(triangles.size() * 3u);
+  for (const auto &triangle : triangles) {
+    for (const auto cluster : triangle)
+      result.indices.emplace_back(remap[cluster]);
+  }
+
+  return result;
+}
+
+} // namespace netsimulyzer
@@ -0,0 +1,74 @@
+/*
+ * NIST-developed software is provided by NIST as a public service. You may use,
+ * copy and distribute copies of the software in any medium, provided that you
+ * keep intact this entire notice. You may improve,modify and create derivative
+ * works of the software or any portion of the software, and you may copy and
+ * distribute such modifications or works. Modified works should carry a notice
+ * stating that you changed the software and should note the date and nature of
+ * any such change. Please explicitly acknowledge the National Institute of
+ * Standards and Technology as the source of the software.
+ *
+ * NIST-developed software is expressly provided "AS IS." NIST MAKES NO
+ * WARRANTY OF ANY KIND, EXPRESS, IMPLIED, IN FACT OR ARISING BY OPERATION OF
+ * LAW, INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTY OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, NON-INFRINGEMENT
+ * AND DATA ACCURACY. NIST NEITHER REPRESENTS NOR WARRANTS THAT THE
+ * OPERATION OF THE SOFTWARE WILL BE UNINTERRUPTED OR ERROR-FREE, OR THAT
+ * ANY DEFECTS WILL BE CORRECTED. NIST DOES NOT WARRANT OR MAKE ANY
+ * REPRESENTATIONS REGARDING THE USE OF THE SOFTWARE OR THE RESULTS THEREOF,
+ * INCLUDING BUT NOT LIMITED TO THE CORRECTNESS, ACCURACY, RELIABILITY,
+ * OR USEFULNESS OF THE SOFTWARE.
+ *
+ * You are solely responsible for determining the appropriateness of using and
+ * distributing the software and you assume all risks associated with its use,
+ * including but not limited to the risks and costs of program errors,
+ * compliance with applicable laws, damage to or loss of data, programs or
+ * equipment, and the unavailability or interruption of operation. This
+ * software is not intended to be used in any situation where a failure could
+ * cause risk of injury or damage to property. The software developed by NIST
+ * employees is not subject to copyright protection within the United States.
+ *
+ * Author: Evan Black <evan.black@nist.gov>
+ */
+
+
+#pragma once
+
+#include "Vertex.h"
+#include <glm/glm.hpp>
+#include <vector>
+
+namespace netsimulyzer {
+
+struct SimplifiedMesh {
+  std::vector<Vertex> vertices;
+  std::vector<unsigned int> indices;
+};
+
+/**
+ * Reduce a triangle mesh by clustering its vertices on a uniform grid.
+ * Every vertex in a cell is merged into one, with the average of their attributes,
+ * and triangles which collapse are dropped.
+ *
+ * Meshes sharing an `origin` & `cellSize` are clustered on the same grid,
+ * so their seams stay closed
+ *
+ * @param vertices
+ * The vertices of the mesh to simplify
+ *
+ * @param indices
+ * Triangle list indices into `vertices`
+ *
+ * @param origin
+ * The minimum corner of the grid
+ *
+ * @param cellSize
+ * The length of each side of a grid cell, larger sizes simplify more
+ *
+ * @return
+ * The simplified mesh, which may have no triangles
+ */
+[[nodiscard]] SimplifiedMesh simplify(const std::vector<Vertex> &vertices, const std::vector<unsigned int> &indices,
+                                      const glm::vec3 &origin, float cellSize);
+
+} // namespace netsimulyzer
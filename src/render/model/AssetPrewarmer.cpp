@@ -0,0 +1,130 @@
+/*
+ * NIST-developed software is provided by NIST as a public service. You may use,
+ * copy and distribute copies of the software in any medium, provided that you
+ * keep intact this entire notice. You may improve,modify and create derivative
+ * works of the software or any portion of the software, and you may copy and
+ * distribute such modifications or works. Modified works should carry a notice
+ * stating that you changed the software and should note the date and nature of
+ * any such change. Please explicitly acknowledge the National Institute of
+ * Standards and Technology as the source of the software.
+ *
+ * NIST-developed software is expressly provided "AS IS." NIST MAKES NO
+ * WARRANTY OF ANY KIND, EXPRESS, IMPLIED, IN FACT OR ARISING BY OPERATION OF
+ * LAW, INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTY OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, NON-INFRINGEMENT
+ * AND DATA ACCURACY. NIST NEITHER REPRESENTS NOR WARRANTS THAT THE
+ * OPERATION OF THE SOFTWARE WILL BE UNINTERRUPTED OR ERROR-FREE, OR THAT
+ * ANY DEFECTS WILL BE CORRECTED. NIST DOES NOT WARRANT OR MAKE ANY
+ * REPRESENTATIONS REGARDING THE USE OF THE SOFTWARE OR THE RESULTS THEREOF,
+ * INCLUDING BUT NOT LIMITED TO THE CORRECTNESS, ACCURACY, RELIABILITY,
+ * OR USEFULNESS OF THE SOFTWARE.
+ *
+ * You are solely responsible for determining the appropriateness of using and
+ * distributing the software and you assume all risks associated with its use,
+ * including but not limited to the risks and costs of program errors,
+ * compliance with applicable laws, damage to or loss of data, programs or
+ * equipment, and the unavailability or interruption of operation. This
+ * software is not intended to be used in any situation where a failure could
+ * cause risk of injury or damage to property. The software developed by NIST
+ * employees is not subject to copyright protection within the United States.
+ *
+ * Author: Evan Black <evan.black@nist.gov>
+ */
+
+#include "AssetPrewarmer.h"
+#include "src/settings/SettingsManager.h"
+#include <QFile>
+#include <QFileInfo>
+#include <QSet>
+#include <vector>
+#include <trace.h>
+
+namespace netsimulyzer {
+
+QStringList AssetPrewarmer::merge(const QStringList &recent, const QStringList &older, int limit) {
+  QStringList merged;
+  QSet<QString> seen;
+
+  for (const auto *list : {&recent, &older}) {
+    for (const auto &path : *list) {
+      if (merged.size() >= limit)
+        return merged;
+      if (seen.contains(path))
+        continue;
+
+      seen.insert(path);
+      merged.append(path);
+    }
+  }
+
+  return merged;
+}
+
+AssetPrewarmer::~AssetPrewarmer() {
+  cancel();
+}
+
+void AssetPrewarmer::remember(const std::vector<std::string> &models, const std::vector<QString> &textures) {
+  if (models.empty() && textures.empty())
+    return;
+
+  QStringList recentModels;
+  for (const auto &path : models)
+    recentModels.append(QString::fromStdString(path));
+
+  QStringList recentTextures;
+  for (const auto &path : textures)
+    recentTextures.append(path);
+
+  SettingsManager settings;
+  using Key = SettingsManager::Key;
+  settings.set(Key::ResourceRecentModels,
+               merge(recentModels, settings.get<QStringList>(Key::ResourceRecentModels).value(), maxModels));
+  settings.set(Key::ResourceRecentTextures,
+               merge(recentTextures, settings.get<QStringList>(Key::ResourceRecentTextures).value(), maxTextures));
+}
+
+std::size_t AssetPrewarmer::start(ModelCache &models) {
+  // Anything queued by an earlier call is superseded
+  cancel();
+  cancelled = parser::CancellationToken{};
+
+  SettingsManager settings;
+  std::size_t queued = 0u;
+
+  for (const auto &path : settings.get<QStringList>(SettingsManager::Key::ResourceRecentModels).value()) {
+    if (!QFileInfo::exists(path))
+      continue;
+
+    models.prewarm(path.toStdString(), cancelled);
+    queued++;
+  }
+
+  for (const auto &path : settings.get<QStringList>(SettingsManager::Key::ResourceRecentTextures).value()) {
+    if (!QFileInfo::exists(path))
+      continue;
+
+    // Only read, the decoded image is not kept anywhere to reuse
+    parser::TaskPool::shared().submit(
+        [path, token = cancelled]() {
+          parser::trace::Scope trace{"AssetPrewarmer::readTexture", "load"};
+          QFile file{path};
+          if (!file.open(QIODevice::ReadOnly))
+            return;
+
+          std::vector<char> buffer(256u * 1024u);
+          while (!token.cancelled() && file.read(buffer.data(), static_cast<qint64>(buffer.size())) > 0) {
+          }
+        },
+        parser::TaskPool::Priority::Background, cancelled);
+    queued++;
+  }
+
+  return queued;
+}
+
+void AssetPrewarmer::cancel() {
+  cancelled.cancel();
+}
+
+} // namespace netsimulyzer
@@ -0,0 +1,110 @@
+/*
+ * NIST-developed software is provided by NIST as a public service. You may use,
+ * copy and distribute copies of the software in any medium, provided that you
+ * keep intact this entire notice. You may improve,modify and create derivative
+ * works of the software or any portion of the software, and you may copy and
+ * distribute such modifications or works. Modified works should carry a notice
+ * stating that you changed the software and should note the date and nature of
+ * any such change. Please explicitly acknowledge the National Institute of
+ * Standards and Technology as the source of the software.
+ *
+ * NIST-developed software is expressly provided "AS IS." NIST MAKES NO
+ * WARRANTY OF ANY KIND, EXPRESS, IMPLIED, IN FACT OR ARISING BY OPERATION OF
+ * LAW, INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTY OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, NON-INFRINGEMENT
+ * AND DATA ACCURACY. NIST NEITHER REPRESENTS NOR WARRANTS THAT THE
+ * OPERATION OF THE SOFTWARE WILL BE UNINTERRUPTED OR ERROR-FREE, OR THAT
+ * ANY DEFECTS WILL BE CORRECTED. NIST DOES NOT WARRANT OR MAKE ANY
+ * REPRESENTATIONS REGARDING THE USE OF THE SOFTWARE OR THE RESULTS THEREOF,
+ * INCLUDING BUT NOT LIMITED TO THE CORRECTNESS, ACCURACY, RELIABILITY,
+ * OR USEFULNESS OF THE SOFTWARE.
+ *
+ * You are solely responsible for determining the appropriateness of using and
+ * distributing the software and you assume all risks associated with its use,
+ * including but not limited to the risks and costs of program errors,
+ * compliance with applicable laws, damage to or loss of data, programs or
+ * equipment, and the unavailability or interruption of operation. This
+ * software is not intended to be used in any situation where a failure could
+ * cause risk of injury or damage to property. The software developed by NIST
+ * employees is not subject to copyright protection within the United States.
+ *
+ * Author: Evan Black <evan.black@nist.gov>
+ */
+
+#pragma once
+
+#include "ModelCache.h"
+#include <QString>
+#include <QStringList>
+#include <cstddef>
+#include <string>
+#include <task-pool.h>
+#include <vector>
+
+namespace netsimulyzer {
+
+/**
+ * Remembers the models & textures of recently opened scenarios,
+ * and warms them in the background once the application is idle.
+ * Models are built into the disk cache, see `ModelImporter::prewarm()`,
+ * and texture images are read through, so the OS keeps them in its file cache.
+ *
+ * The lists are kept in the settings, most recent first
+ */
+class AssetPrewarmer {
+public:
+  /**
+   * The most models & textures remembered
+   */
+  static constexpr int maxModels = 256;
+  static constexpr int maxTextures = 1024;
+
+private:
+  /**
+   * Skips the warming tasks which have not started
+   */
+  parser::CancellationToken cancelled;
+
+  /**
+   * @return
+   * `recent`, then the entries of `older` not in it, up to `limit` entries
+   */
+  [[nodiscard]] static QStringList merge(const QStringList &recent, const QStringList &older, int limit);
+
+public:
+  AssetPrewarmer() = default;
+  AssetPrewarmer(const AssetPrewarmer &) = delete;
+  AssetPrewarmer &operator=(const AssetPrewarmer &) = delete;
+  ~AssetPrewarmer();
+
+  /**
+   * Put the assets of a scenario ahead of the ones remembered before
+   *
+   * @param models
+   * The absolute path of each model the scenario loaded
+   *
+   * @param textures
+   * The path of each texture image the scenario loaded
+   */
+  static void remember(const std::vector<std::string> &models, const std::vector<QString> &textures);
+
+  /**
+   * Queue the remembered assets on the task pool, at background priority.
+   * Assets which no longer exist are skipped
+   *
+   * @param models
+   * The cache to build the models with
+   *
+   * @return
+   * The number of assets queued
+   */
+  std::size_t start(ModelCache &models);
+
+  /**
+   * Skip every queued asset which has not started,
+   * e.g. so they do not compete with loading a scenario
+   */
+  void cancel();
+};
+
+} // namespace netsimulyzer
@@ -40,12 +40,16 @@
 
 namespace netsimulyzer {
 
-void Model::rebuildScaleMatrix() {
+const glm::mat4 &Model::getScaleMatrix() const {
+  if (!scaleMatrixDirty)
+    return scaleMatrix;
+
+  scaleMatrixDirty = false;
   scaleMatrix = glm::mat4{1.0f};
 
   if (!targetHeightScale && !targetWidthScale && !targetDepthScale) {
     scaleMatrix = glm::scale(scaleMatrix, scale);
-    return;
+    return scaleMatrix;
   }
 
   if (keepRatio) {
@@ -59,6 +63,7 @@ void Model::rebuildScaleMatrix() {
   }
 
   scaleMatrix = glm::scale(scaleMatrix, scale);
+  return scaleMatrix;
 }
 
 Model::Model(const Model::ModelLoadInfo &info) : Model(info.id, info.min, info.max) {
@@ -67,28 +72,32 @@ Model::Model(const Model::ModelLoadInfo &info) : Model(info.id, info.min, info.m
 Model::Model(model_id modelId, const glm::vec3 &min, const glm::vec3 &max) : modelId(modelId), min(min), max(max) {
 }
 
-void Model::rebuildModelMatrix() {
+void Model::rebuildModelMatrix() const {
+  modelMatrixDirty = false;
+
+  if (rotateMatrixDirty) {
+    rotateMatrixDirty = false;
+    rotateMatrix = glm::mat4{1.0f};
+    rotateMatrix = glm::rotate(rotateMatrix, glm::radians(rotate[0]), {1, 0, 0});
+    rotateMatrix = glm::rotate(rotateMatrix, glm::radians(rotate[1]), {0, 1, 0});
+    rotateMatrix = glm::rotate(rotateMatrix, glm::radians(rotate[2]), {0, 0, 1});
+  }
+
   modelMatrix = glm::mat4{1.0f};
   modelMatrix = glm::translate(modelMatrix, position);
-
-  glm::mat4 rotateMatrix{1.0f};
-  rotateMatrix = glm::rotate(rotateMatrix, glm::radians(rotate[0]), {1, 0, 0});
-  rotateMatrix = glm::rotate(rotateMatrix, glm::radians(rotate[1]), {0, 1, 0});
-  rotateMatrix = glm::rotate(rotateMatrix, glm::radians(rotate[2]), {0, 0, 1});
   modelMatrix *= rotateMatrix;
-
-  modelMatrix *= scaleMatrix;
+  modelMatrix *= getScaleMatrix();
 }
 
 void Model::setPosition(const glm::vec3 &value) {
   position = value;
-  rebuildModelMatrix();
+  modelMatrixDirty = true;
 }
 
 void Model::setKeepRatio(bool value) {
   keepRatio = value;
-  rebuildScaleMatrix();
-  rebuildModelMatrix();
+  scaleMatrixDirty = true;
+  modelMatrixDirty = true;
 }
 
 bool Model::getKeepRatio() const {
@@ -97,8 +106,8 @@ bool Model::getKeepRatio() const {
 
 void Model::setTargetHeightScale(float value) {
   targetHeightScale = value;
-  rebuildScaleMatrix();
-  rebuildModelMatrix();
+  scaleMatrixDirty = true;
+  modelMatrixDirty = true;
 }
 
 std::optional<float> Model::getTargetHeightScale() const {
@@ -107,8 +116,8 @@ std::optional<float> Model::getTargetHeightScale() const {
 
 void Model::setTargetWidthScale(float value) {
   targetWidthScale = value;
-  rebuildScaleMatrix();
-  rebuildModelMatrix();
+  scaleMatrixDirty = true;
+  modelMatrixDirty = true;
 }
 
 std::optional<float> Model::getTargetWidthScale() const {
@@ -117,8 +126,8 @@ std::optional<float> Model::getTargetWidthScale() const {
 
 void Model::setTargetDepthScale(float value) {
   targetDepthScale = value;
-  rebuildScaleMatrix();
-  rebuildModelMatrix();
+  scaleMatrixDirty = true;
+  modelMatrixDirty = true;
 }
 
 std::optional<float> Model::getTargetDepthScale() const {
@@ -127,11 +136,13 @@ std::optional<float> Model::getTargetDepthScale() const {
 
 void Model::setScale(glm::vec3 value) {
   scale = value;
-  rebuildScaleMatrix();
-  rebuildModelMatrix();
+  scaleMatrixDirty = true;
+  modelMatrixDirty = true;
 }
 
 const glm::mat4 &Model::getModelMatrix() const {
+  if (modelMatrixDirty)
+    rebuildModelMatrix();
   return modelMatrix;
 }
 
@@ -145,6 +156,7 @@ glm::vec3 Model::getCenter() const {
   // [0 y 0 0]
   // [0 0 z 0]
   // [0 0 0 1]
+  const auto &scaleMatrix = getScaleMatrix();
   const auto xScale = scaleMatrix[0].x;
   const auto yScale = scaleMatrix[1].y;
   const auto zScale = scaleMatrix[2].z;
@@ -164,6 +176,7 @@ glm::vec3 Model::getTop() const {
   // [0 y 0 0]
   // [0 0 z 0]
   // [0 0 0 1]
+  const auto &scaleMatrix = getScaleMatrix();
   const auto xScale = scaleMatrix[0].x;
   const auto yScale = scaleMatrix[1].y;
   const auto zScale = scaleMatrix[2].z;
@@ -184,7 +197,8 @@ void Model::setRotate(float x, float y, float z) {
   rotate[0] = x;
   rotate[1] = y;
   rotate[2] = z;
-  rebuildModelMatrix();
+  rotateMatrixDirty = true;
+  modelMatrixDirty = true;
 }
 
 std::array<float, 3> Model::getRotate() const {
@@ -199,6 +213,24 @@ Model::ModelBounds Model::getBounds() const {
   return {min, max};
 }
 
+void Model::setBounds(const ModelBounds &value) {
+  const auto oldExtent = glm::abs(max - min);
+  const auto newExtent = glm::abs(value.max - value.min);
+
+  auto rescale = [](std::optional<float> &target, float oldSize, float newSize) {
+    if (target && newSize > 0.0f)
+      target = target.value() * oldSize / newSize;
+  };
+  rescale(targetWidthScale, oldExtent.x, newExtent.x);
+  rescale(targetHeightScale, oldExtent.y, newExtent.y);
+  rescale(targetDepthScale, oldExtent.z, newExtent.z);
+
+  min = value.min;
+  max = value.max;
+  scaleMatrixDirty = true;
+  modelMatrixDirty = true;
+}
+
 void Model::setBaseColor(const glm::vec3 &value) {
   baseColor.emplace(value);
 }
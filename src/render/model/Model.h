@@ -61,8 +61,8 @@ public:
 
 private:
   const model_id modelId;
-  const glm::vec3 min;
-  const glm::vec3 max;
+  glm::vec3 min;
+  glm::vec3 max;
 
   glm::vec3 position{0.0f};
   bool keepRatio{true};
@@ -76,9 +76,12 @@ private:
 
   /**
    * Final model matrix built from the
-   * `position` `rotation` `targetHeightScale` & `scale`
+   * `position` `rotation` `targetHeightScale` & `scale`.
+   *
+   * Rebuilt on the next read after any of them change,
+   * so a model changed several times between reads is only rebuilt once
    */
-  glm::mat4 modelMatrix{1.0f};
+  mutable glm::mat4 modelMatrix{1.0f};
 
   /**
    * Matrix built from the 'scale' attributes,
@@ -87,9 +90,26 @@ private:
    *
    * Applied to the `modelMatrix`
    */
-  glm::mat4 scaleMatrix{1.0};
+  mutable glm::mat4 scaleMatrix{1.0};
+
+  /**
+   * Matrix built from `rotate`, kept so moves do not rebuild it.
+   *
+   * Applied to the `modelMatrix`
+   */
+  mutable glm::mat4 rotateMatrix{1.0f};
 
-  void rebuildScaleMatrix();
+  mutable bool modelMatrixDirty{false};
+  mutable bool scaleMatrixDirty{false};
+  mutable bool rotateMatrixDirty{false};
+
+  /**
+   * @return
+   * `scaleMatrix`, rebuilt first if the scale attributes changed
+   */
+  [[nodiscard]] const glm::mat4 &getScaleMatrix() const;
+
+  void rebuildModelMatrix() const;
 
 public:
   Model(const ModelLoadInfo &info);
@@ -125,6 +145,15 @@ public:
 
   [[nodiscard]] ModelBounds getBounds() const;
 
+  /**
+   * Replace the bounds of the model, once a model loaded in the background is swapped in.
+   * Target scales are adjusted, so the model keeps the size they were set for
+   *
+   * @param value
+   * The bounds of the loaded model
+   */
+  void setBounds(const ModelBounds &value);
+
   void setBaseColor(const glm::vec3 &value);
   void unsetBaseColor();
   [[nodiscard]] const std::optional<glm::vec3> &getBaseColor() const;
@@ -132,8 +161,6 @@ public:
   void setHighlightColor(const glm::vec3 &value);
   void unsetHighlightColor();
   [[nodiscard]] const std::optional<glm::vec3> &getHighlightColor() const;
-
-  void rebuildModelMatrix();
 };
 
 } // namespace netsimulyzer
@@ -34,13 +34,13 @@
 #include "ModelCache.h"
 #include "../shader/Shader.h"
 #include <QDebug>
-#include <QFileInfo>
+#include <QDir>
+#include <QStandardPaths>
 #include <algorithm>
-#include <assimp/Importer.hpp>
-#include <assimp/postprocess.h>
-#include <assimp/scene.h>
-#include <cstring>
+#include <chrono>
+#include <cstdlib>
 #include <iostream>
+#include <trace.h>
 #include <unordered_map>
 #include <utility>
 
@@ -66,59 +66,54 @@ void ModelRenderInfo::updateBounds() {
   }
 }
 
-void ModelRenderInfo::loadNode(aiNode const *node, aiScene const *scene) {
-  for (auto i = 0u; i < node->mNumMeshes; i++) {
-    loadMesh(scene->mMeshes[node->mMeshes[i]], scene);
-  }
+void ModelRenderInfo::addMesh(const ModelImport::SourceMesh &source, std::vector<Mesh> &opaque,
+                              std::vector<Mesh> &transparent) {
+  const auto &material = materials[source.material];
+  auto &target = material.opacity < 1.0f ? transparent : opaque;
 
-  for (auto i = 0u; i < node->mNumChildren; i++) {
-    loadNode(node->mChildren[i], scene);
-  }
+  std::optional<Mesh::MeshBounds> bounds;
+  if (source.bounds)
+    bounds = Mesh::MeshBounds{source.bounds->first, source.bounds->second};
+
+  target.emplace_back(*arena, source.vertices, source.indices, source.references, bounds).setMaterial(material);
 }
 
-void ModelRenderInfo::loadMesh(aiMesh const *m, aiScene const *) {
-  std::vector<Vertex> vertices;
-  vertices.reserve(m->mNumVertices);
+std::vector<Mesh> &ModelRenderInfo::meshesAt(std::size_t level) {
+  if (level == 0u || levels.empty())
+    return meshes;
 
-  std::vector<unsigned int> indices;
+  return levels[std::min(level, levels.size()) - 1u].meshes;
+}
 
-  for (auto i = 0u; i < m->mNumVertices; i++) {
-    Vertex v;
-    v.position = {m->mVertices[i].x, m->mVertices[i].y, m->mVertices[i].z};
+std::vector<Mesh> &ModelRenderInfo::transparentMeshesAt(std::size_t level) {
+  if (level == 0u || levels.empty())
+    return transparentMeshes;
 
-    // if we have at least one texture
-    if (m->mTextureCoords[0])
-      v.textureCoordinate = {m->mTextureCoords[0][i].x, m->mTextureCoords[0][i].y};
-    else
-      v.textureCoordinate = {0.0f, 0.0f};
+  return levels[std::min(level, levels.size()) - 1u].transparentMeshes;
+}
 
-    // Normals should point away
-    v.normal = {-m->mNormals[i].x, -m->mNormals[i].y, -m->mNormals[i].z};
+ModelRenderInfo::ModelRenderInfo(const ModelImport &model, TextureCache &textureCache, MeshArena &arena)
+    : textureCache(textureCache), arena(&arena) {
+  initializeOpenGLFunctions();
 
-    vertices.emplace_back(v);
+  // Textures are the only part of the materials left to load
+  const auto fallbackTexture = textureCache.getFallbackTexture();
+  materials.reserve(model.materials.size());
+  for (const auto &source : model.materials) {
+    auto &material = materials.emplace_back(source.material);
+    if (source.texture)
+      material.textureId = source.texture->empty() ? fallbackTexture : textureCache.load(source.texture.value());
   }
 
-  for (auto i = 0u; i < m->mNumFaces; i++) {
-    const auto &face = m->mFaces[i];
+  for (const auto &source : model.meshes)
+    addMesh(source, meshes, transparentMeshes);
 
-    for (auto j = 0u; j < face.mNumIndices; j++) {
-      indices.emplace_back(face.mIndices[j]);
-    }
+  for (const auto &levelSources : model.levels) {
+    auto &level = levels.emplace_back();
+    for (const auto &source : levelSources)
+      addMesh(source, level.meshes, level.transparentMeshes);
   }
 
-  const auto &material = materials[m->mMaterialIndex];
-  if (material.opacity < 1.0f)
-    transparentMeshes.emplace_back(vertices.data(), indices.data(), vertices.size(), indices.size())
-        .setMaterial(material);
-  else
-    meshes.emplace_back(vertices.data(), indices.data(), vertices.size(), indices.size()).setMaterial(material);
-}
-
-ModelRenderInfo::ModelRenderInfo(aiScene const *scene, TextureCache &textureCache) : textureCache(textureCache) {
-  initializeOpenGLFunctions();
-  loadMaterials(scene);
-  loadNode(scene->mRootNode, scene);
-
   updateBounds();
 }
 
@@ -133,57 +128,6 @@ ModelRenderInfo::~ModelRenderInfo() {
   clear();
 }
 
-void ModelRenderInfo::loadMaterials(aiScene const *scene) {
-  using MaterialType = Material::MaterialType;
-  auto fallbackTexture = textureCache.getFallbackTexture();
-
-  for (auto i = 0u; i < scene->mNumMaterials; i++) {
-    auto const *material = scene->mMaterials[i];
-    Material m;
-
-    material->Get(AI_MATKEY_OPACITY, m.opacity);
-
-    aiString name;
-    material->Get(AI_MATKEY_NAME, name);
-
-    // Check for configurable materials
-    if (std::strcmp(name.data, "netsimulyzer.base") == 0) {
-      m.materialType = MaterialType::Base;
-    } else if (std::strcmp(name.data, "netsimulyzer.highlight") == 0)
-      m.materialType = MaterialType::Highlight;
-    else
-      m.materialType = MaterialType::Unclassified;
-
-    if (material->GetTextureCount(aiTextureType_DIFFUSE)) {
-      aiString path;
-
-      if (material->GetTexture(aiTextureType_DIFFUSE, 0, &path) == AI_SUCCESS) {
-        std::string pathCppString{path.data};
-        // Strips back to the last '\' character (i.e. 'C:\Users\Evan\projects' -> 'projects')
-        auto filepath = pathCppString.substr(pathCppString.rfind('\\') + 1);
-        m.textureId = textureCache.load(filepath);
-      } else {
-        m.textureId = fallbackTexture;
-      }
-    } else {
-      aiColor3D color;
-
-      // Diffuse diffuse & transparent color are separate for some reason...
-      if (m.opacity < 1.0f)
-        material->Get(AI_MATKEY_COLOR_TRANSPARENT, color);
-      else
-        material->Get(AI_MATKEY_COLOR_DIFFUSE, color);
-
-      m.color = {color.r, color.g, color.b};
-    }
-
-    material->Get(AI_MATKEY_SHININESS, m.shininess);                  // Errors Ignored
-    material->Get(AI_MATKEY_SHININESS_STRENGTH, m.specularIntensity); // Errors Ignored
-
-    materials.emplace_back(m);
-  }
-}
-
 const ModelRenderInfo::ModelRenderBounds &ModelRenderInfo::getBounds() const {
   return bounds;
 }
@@ -192,28 +136,38 @@ bool ModelRenderInfo::hasTransparentMeshes() const {
   return !transparentMeshes.empty();
 }
 
-void ModelRenderInfo::render(Shader &s, const Model &model) {
+std::size_t ModelRenderInfo::levelCount() const {
+  return levels.size() + 1u;
+}
+
+void ModelRenderInfo::render(Shader &s, const MaterialUniforms &uniforms, const Model &model) {
+  render(s, uniforms, model.getBaseColor(), model.getHighlightColor());
+}
+
+void ModelRenderInfo::render(Shader &s, const MaterialUniforms &uniforms, const std::optional<glm::vec3> &baseColor,
+                             const std::optional<glm::vec3> &highlightColor) {
   for (auto &m : meshes) {
     // Operator [] for unordered map is not const...
     const auto &material = m.getMaterial();
 
-    s.uniform("useTexture", material.textureId.has_value());
+    s.uniform(uniforms.useTexture, material.textureId.has_value());
     if (material.textureId) {
       textureCache.use(*material.textureId);
+      s.uniform(uniforms.textureLayer, textureCache.get(*material.textureId).layer);
     } else if (material.color) {
       const auto &color = material.color.value();
 
       switch (material.materialType) {
       case Material::MaterialType::Base:
-        s.uniform("material_color", model.getBaseColor().value_or(color));
+        s.uniform(uniforms.materialColor, baseColor.value_or(color));
         break;
       case Material::MaterialType::Highlight:
-        s.uniform("material_color", model.getHighlightColor().value_or(color));
+        s.uniform(uniforms.materialColor, highlightColor.value_or(color));
         break;
       case Material::MaterialType::Unclassified:
         [[fallthrough]];
       default:
-        s.uniform("material_color", color);
+        s.uniform(uniforms.materialColor, color);
         break;
       }
     }
@@ -225,40 +179,37 @@ void ModelRenderInfo::render(Shader &s, const Model &model) {
   }
 }
 
-void ModelRenderInfo::renderTransparent(Shader &s, const Model &model) {
-  for (auto &m : transparentMeshes) {
-    const auto &material = m.getMaterial();
-
-    s.uniform("useTexture", material.textureId.has_value());
-    if (material.textureId) {
-      textureCache.use(*material.textureId);
-    } else if (material.color) {
-      const auto &color = material.color.value();
+void ModelRenderInfo::clear() {
+  meshes.clear();
+  transparentMeshes.clear();
+  levels.clear();
+}
 
-      switch (material.materialType) {
-      case Material::MaterialType::Base:
-        s.uniform("material_color", model.getBaseColor().value_or(color));
-        break;
-      case Material::MaterialType::Highlight:
-        s.uniform("material_color", model.getHighlightColor().value_or(color));
-        break;
-      case Material::MaterialType::Unclassified:
-        [[fallthrough]];
-      default:
-        s.uniform("material_color", color);
-        break;
-      }
-    }
+std::size_t ModelRenderInfo::getGpuBytes() const {
+  std::size_t bytes = 0u;
+  auto add = [&bytes](const std::vector<Mesh> &levelMeshes) {
+    for (const auto &mesh : levelMeshes)
+      bytes += mesh.getGpuBytes();
+  };
+
+  add(meshes);
+  add(transparentMeshes);
+  for (const auto &level : levels) {
+    add(level.meshes);
+    add(level.transparentMeshes);
+  }
 
-    //    s.set_uniform_vector_1f("material.specularIntensity", material.specular_intensity);
-    //    s.set_uniform_vector_1f("material.shininess", material.shininess);
+  return bytes;
+}
 
-    m.render();
+std::vector<texture_id> ModelRenderInfo::getTextures() const {
+  std::vector<texture_id> result;
+  for (const auto &material : materials) {
+    if (material.textureId)
+      result.emplace_back(material.textureId.value());
   }
-}
 
-void ModelRenderInfo::clear() {
-  meshes.clear();
+  return result;
 }
 
 std::vector<Mesh> &ModelRenderInfo::getMeshes() {
@@ -272,6 +223,11 @@ std::vector<Mesh> &ModelRenderInfo::getTransparentMeshes() {
 ModelCache::ModelCache(TextureCache &textureCache) : textureCache(textureCache) {
 }
 
+ModelCache::~ModelCache() {
+  // The meshes give their space back to `arena`, so they must go first
+  models.clear();
+}
+
 void ModelCache::setBasePath(std::string value) {
   basePath = std::move(value);
 
@@ -281,28 +237,118 @@ void ModelCache::setBasePath(std::string value) {
 
 void ModelCache::init(std::string_view fallbackModelPath) {
   initializeOpenGLFunctions();
+  arena.init();
+
+  // Built models are kept between runs, so repeat loads skip Assimp
+  const auto cacheLocation = QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
+  if (!cacheLocation.isEmpty())
+    importer.setCacheDirectory(QDir{cacheLocation}.filePath("models"));
 
   _fallbackModelPath = fallbackModelPath;
-  fallbackModel = load(_fallbackModelPath).id;
+  fallbackModel = load(_fallbackModelPath, true).id;
+}
+
+void ModelCache::prefetch(const std::string &path) {
+  const auto absolutePath = basePath + path;
+  if (indexMap.find(absolutePath) == indexMap.end())
+    importer.request(absolutePath);
 }
 
-Model::ModelLoadInfo ModelCache::load(const std::string &path) {
-  return loadAbsolute(basePath + path);
+void ModelCache::prewarm(const std::string &path, const parser::CancellationToken &token) {
+  importer.prewarm(path, token);
 }
 
-Model::ModelLoadInfo ModelCache::loadAbsolute(const std::string &path) {
+std::vector<std::string> ModelCache::getLoadedPaths() const {
+  std::vector<std::string> paths;
+  for (const auto &[path, id] : indexMap) {
+    if (id != fallbackModel)
+      paths.emplace_back(path);
+  }
+
+  return paths;
+}
+
+Model::ModelLoadInfo ModelCache::load(const std::string &path, bool wait) {
+  return loadAbsolute(basePath + path, wait);
+}
+
+Model::ModelLoadInfo ModelCache::loadAbsolute(const std::string &path, bool wait) {
+  parser::trace::Scope trace{"ModelCache::load", "load"};
   auto existing = indexMap.find(path);
   if (existing != indexMap.end()) {
     const auto &bounds = get(existing->second).getBounds();
     return {existing->second, bounds.min, bounds.max};
   }
 
-  Assimp::Importer importer;
-  const auto *const scene =
-      importer.ReadFile(path.c_str(), aiProcess_Triangulate | aiProcess_FlipUVs | aiProcess_GenSmoothNormals |
-                                          aiProcess_JoinIdenticalVertices);
-  if (!scene) {
-    std::cerr << "Model (" << path << ") failed to load: " << importer.GetErrorString() << '\n';
+  // Usually already built by a `prefetch()`, otherwise this waits for it
+  const auto waitStart = std::chrono::steady_clock::now();
+  const auto model = wait ? importer.take(path) : importer.tryTake(path);
+  importWait += std::chrono::steady_clock::now() - waitStart;
+  if (!model) {
+    // Drawn as the fallback until `poll()` finds the import finished
+    const auto id = addSlot(path, slots[fallbackModel]);
+    pending.emplace(id, path);
+
+    const auto &bounds = get(fallbackModel).getBounds();
+    return {id, bounds.min, bounds.max};
+  }
+
+  const auto index = upload(path, *model);
+  if (!index) {
+    const auto &bounds = get(fallbackModel).getBounds();
+    return {fallbackModel, bounds.min, bounds.max};
+  }
+
+  const auto id = addSlot(path, index.value());
+  const auto &bounds = models[index.value()].getBounds();
+  return {id, bounds.min, bounds.max};
+}
+
+Model::ModelLoadInfo ModelCache::refresh(const std::string &path) {
+  parser::trace::Scope trace{"ModelCache::refresh", "load"};
+  auto existing = indexMap.find(path);
+  if (existing == indexMap.end() || existing->second == fallbackModel)
+    return loadAbsolute(path);
+
+  const auto id = existing->second;
+  // Whatever is waiting on the old version is superseded by this import
+  pending.erase(id);
+
+  const auto waitStart = std::chrono::steady_clock::now();
+  const auto model = importer.take(path);
+  importWait += std::chrono::steady_clock::now() - waitStart;
+
+  const auto index = model ? upload(path, *model) : std::nullopt;
+  if (!index) {
+    // Keep drawing the last version that did import
+    const auto &bounds = get(id).getBounds();
+    return {id, bounds.min, bounds.max};
+  }
+
+  if (slots[id] != slots[fallbackModel])
+    models[slots[id]].clear();
+
+  slots[id] = index.value();
+  evicted[id] = false;
+  lastUsed[id] = frame;
+
+  const auto &bounds = models[index.value()].getBounds();
+  return {id, bounds.min, bounds.max};
+}
+
+model_id ModelCache::addSlot(const std::string &path, std::size_t index) {
+  const auto id = slots.size();
+  slots.emplace_back(index);
+  paths.emplace_back(path);
+  evicted.emplace_back(false);
+  lastUsed.emplace_back(frame);
+  indexMap.emplace(path, id);
+  return id;
+}
+
+std::optional<std::size_t> ModelCache::upload(const std::string &path, const ModelImport &model) {
+  if (model.error) {
+    std::cerr << "Model (" << path << ") failed to load: " << model.error.value() << '\n';
 
     // Make sure we have a fallback model
     if (models.empty()) {
@@ -310,19 +356,96 @@ Model::ModelLoadInfo ModelCache::loadAbsolute(const std::string &path) {
       std::abort();
     }
 
-    const auto &bounds = get(fallbackModel).getBounds();
-    return {fallbackModel, bounds.min, bounds.max};
+    return {};
   }
 
-  const auto &newModel = models.emplace_back(scene, textureCache);
-  indexMap.emplace(path, models.size() - 1);
+  const auto start = std::chrono::steady_clock::now();
+  models.emplace_back(model, textureCache, arena);
+  uploadTime += std::chrono::steady_clock::now() - start;
+  return models.size() - 1u;
+}
+
+std::vector<model_id> ModelCache::poll() {
+  frame++;
 
-  const auto bounds = newModel.getBounds();
-  return {models.size() - 1, bounds.min, bounds.max};
+  std::vector<model_id> loaded;
+  for (auto it = pending.begin(); it != pending.end() && loaded.size() < uploadsPerPoll;) {
+    const auto &[id, path] = *it;
+    const auto model = importer.tryTake(path);
+    if (!model) {
+      it++;
+      continue;
+    }
+
+    // Failed models keep drawing as the fallback, with the bounds they were given
+    if (const auto index = upload(path, *model); index) {
+      slots[id] = index.value();
+      loaded.emplace_back(id);
+    }
+    it = pending.erase(it);
+  }
+
+  return loaded;
+}
+
+bool ModelCache::loading() const {
+  return !pending.empty();
 }
 
 ModelRenderInfo &ModelCache::get(model_id index) {
-  return models[index];
+  if (evicted[index])
+    reload(index);
+
+  lastUsed[index] = frame;
+  return models[slots[index]];
+}
+
+void ModelCache::reload(model_id id) {
+  evicted[id] = false;
+  pending.emplace(id, paths[id]);
+  importer.request(paths[id]);
+}
+
+std::size_t ModelCache::getGpuBytes() const {
+  return arena.getUsedBytes();
+}
+
+std::chrono::steady_clock::duration ModelCache::getImportWait() const {
+  return importWait;
+}
+
+std::chrono::steady_clock::duration ModelCache::getUploadTime() const {
+  return uploadTime;
+}
+
+std::size_t ModelCache::evict(const std::unordered_set<model_id> &live, std::size_t bytes) {
+  // Only models with meshes of their own, which aren't about to be swapped
+  std::vector<model_id> candidates;
+  for (model_id id = 0u; id < slots.size(); id++) {
+    if (id != fallbackModel && slots[id] != slots[fallbackModel] && !evicted[id] && live.count(id) == 0u &&
+        pending.count(id) == 0u)
+      candidates.emplace_back(id);
+  }
+
+  std::sort(candidates.begin(), candidates.end(), [this](model_id left, model_id right) {
+    return lastUsed[left] < lastUsed[right];
+  });
+
+  std::size_t released = 0u;
+  for (const auto id : candidates) {
+    if (released >= bytes)
+      break;
+
+    // The entry in `models` stays, empty, since there's no move assignment to fill the gap
+    auto &model = models[slots[id]];
+    released += model.getGpuBytes();
+    model.clear();
+
+    slots[id] = slots[fallbackModel];
+    evicted[id] = true;
+  }
+
+  return released;
 }
 
 model_id ModelCache::getFallbackModelId() const {
@@ -331,13 +454,19 @@ model_id ModelCache::getFallbackModelId() const {
 
 void ModelCache::reset() {
   models.clear();
+  slots.clear();
+  pending.clear();
+  paths.clear();
+  evicted.clear();
+  lastUsed.clear();
   indexMap.clear();
+  arena.clear();
 
   // Use a total clear instead of erasing a range
   // since we'd need a move implementation for that.
 
   // Reload the fallback model
-  fallbackModel = load(_fallbackModelPath).id;
+  fallbackModel = load(_fallbackModelPath, true).id;
 }
 
 } // namespace netsimulyzer
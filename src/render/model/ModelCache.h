@@ -33,16 +33,22 @@
 
 #pragma once
 #include "../mesh/Mesh.h"
+#include "../mesh/MeshArena.h"
+#include "../mesh/Vertex.h"
 #include "../shader/Shader.h"
 #include "../texture/TextureCache.h"
 #include "../texture/texture.h"
 #include "Model.h"
+#include "ModelImporter.h"
 #include <QOpenGLFunctions_3_3_Core>
-#include <assimp/Importer.hpp>
-#include <assimp/scene.h>
+#include <chrono>
+#include <cstddef>
 #include <glm/glm.hpp>
+#include <optional>
+#include <cstdint>
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 
@@ -55,28 +61,77 @@ public:
     glm::vec3 max{0.0f};
   };
 
+  /**
+   * Locations of the material uniforms in the shader given to the render functions.
+   * Resolved once with `Shader::location()`, so meshes are drawn without name lookups
+   */
+  struct MaterialUniforms {
+    int useTexture{-1};
+    int textureLayer{-1};
+    int materialColor{-1};
+    int materialType{-1};
+  };
+
+  /**
+   * The most levels of detail a model may have,
+   * including the full detail meshes
+   */
+  static constexpr std::size_t maxLevels = ModelImporter::maxLevels;
+
 private:
+  struct LevelOfDetail {
+    std::vector<Mesh> meshes;
+    std::vector<Mesh> transparentMeshes;
+  };
+
   std::vector<Mesh> meshes;
   std::vector<Mesh> transparentMeshes;
+
+  /**
+   * Reduced detail versions of `meshes` & `transparentMeshes`,
+   * from level 1 on
+   */
+  std::vector<LevelOfDetail> levels;
   TextureCache &textureCache;
+
+  /**
+   * Where the loaded meshes are placed
+   */
+  MeshArena *arena{nullptr};
   std::vector<Material> materials;
   ModelRenderBounds bounds;
 
   void updateBounds();
 
-  void loadNode(aiNode const *node, aiScene const *scene);
-  void loadMesh(aiMesh const *m, aiScene const *scene);
-  void loadMaterials(aiScene const *scene);
+  /**
+   * Upload `source` into either `opaque` or `transparent`, depending on its material
+   */
+  void addMesh(const ModelImport::SourceMesh &source, std::vector<Mesh> &opaque, std::vector<Mesh> &transparent);
 
 public:
   ~ModelRenderInfo() override;
-  ModelRenderInfo(aiScene const *scene, TextureCache &textureCache);
+
+  /**
+   * Upload an imported model, and its levels of detail.
+   * Requires a current context
+   *
+   * @param model
+   * The model built by `ModelImporter`
+   *
+   * @param textureCache
+   * The cache to load the model's textures into
+   *
+   * @param arena
+   * Where to place the meshes
+   */
+  ModelRenderInfo(const ModelImport &model, TextureCache &textureCache, MeshArena &arena);
   ModelRenderInfo(std::vector<Mesh> meshes, TextureCache &textureCache);
 
   // Allow Moves
   ModelRenderInfo(ModelRenderInfo &&other) noexcept
       : meshes(std::move(other.meshes)), transparentMeshes(std::move(other.transparentMeshes)),
-        textureCache(other.textureCache), materials(std::move(other.materials)) {
+        levels(std::move(other.levels)), textureCache(other.textureCache), arena(other.arena),
+        materials(std::move(other.materials)) {
     bounds = other.bounds;
   };
 
@@ -90,8 +145,64 @@ public:
   [[nodiscard]] const ModelRenderBounds &getBounds() const;
   [[nodiscard]] bool hasTransparentMeshes() const;
 
-  void render(Shader &s, const Model &model);
-  void renderTransparent(Shader &s, const Model &model);
+  /**
+   * @return
+   * The number of levels of detail, including the full detail meshes.
+   * Always at least 1
+   */
+  [[nodiscard]] std::size_t levelCount() const;
+
+  void render(Shader &s, const MaterialUniforms &uniforms, const Model &model);
+
+  /**
+   * Render the opaque meshes, with colors from outside a `Model`
+   *
+   * @param s
+   * The shader to set the material uniforms on
+   *
+   * @param uniforms
+   * The locations of the material uniforms in `s`
+   *
+   * @param baseColor
+   * The color for base materials, unset for the material's own color
+   *
+   * @param highlightColor
+   * The color for highlight materials, unset for the material's own color
+   */
+  void render(Shader &s, const MaterialUniforms &uniforms, const std::optional<glm::vec3> &baseColor,
+              const std::optional<glm::vec3> &highlightColor);
+
+  /**
+   * @param level
+   * The level of detail, 0 for full detail.
+   * Clamped to the least detailed level
+   *
+   * @return
+   * The opaque meshes at `level`
+   */
+  [[nodiscard]] std::vector<Mesh> &meshesAt(std::size_t level);
+
+  /**
+   * @param level
+   * The level of detail, 0 for full detail.
+   * Clamped to the least detailed level
+   *
+   * @return
+   * The transparent meshes at `level`
+   */
+  [[nodiscard]] std::vector<Mesh> &transparentMeshesAt(std::size_t level);
+
+  /**
+   * @return
+   * The bytes used on the GPU by the meshes of every level
+   */
+  [[nodiscard]] std::size_t getGpuBytes() const;
+
+  /**
+   * @return
+   * The textures used by the model's materials
+   */
+  [[nodiscard]] std::vector<texture_id> getTextures() const;
   std::vector<Mesh> &getMeshes();
   std::vector<Mesh> &getTransparentMeshes();
   void clear();
@@ -101,18 +212,217 @@ class ModelCache : protected QOpenGLFunctions_3_3_Core {
   std::unordered_map<std::string, std::size_t> indexMap;
   std::vector<ModelRenderInfo> models;
   TextureCache &textureCache;
+
+  /**
+   * The index in `models` drawn for each `model_id`.
+   * Models still importing are drawn as the fallback model, until `poll()` swaps them in
+   */
+  std::vector<std::size_t> slots;
+
+  /**
+   * Models returned by `load()` before their import finished, with their paths
+   */
+  std::unordered_map<model_id, std::string> pending;
+
+  /**
+   * The absolute path of each `model_id`
+   */
+  std::vector<std::string> paths;
+
+  /**
+   * Set for models released by `evict()`, which are imported again the next time they're used
+   */
+  std::vector<bool> evicted;
+
+  /**
+   * The value of `frame` when each `model_id` was last used
+   */
+  std::vector<std::uint64_t> lastUsed;
+
+  /**
+   * Counted by `poll()`
+   */
+  std::uint64_t frame{0u};
+
+  /**
+   * Time spent waiting on `importer` for models it had not built yet
+   */
+  std::chrono::steady_clock::duration importWait{};
+
+  /**
+   * Time spent in `upload()`
+   */
+  std::chrono::steady_clock::duration uploadTime{};
+
+  /**
+   * Start importing an evicted model again, drawing it as the fallback until it's swapped in
+   */
+  void reload(model_id id);
+
+  /**
+   * Give a new ID to the model at `index` in `models`
+   *
+   * @return
+   * The new ID
+   */
+  model_id addSlot(const std::string &path, std::size_t index);
+
+  /**
+   * Most models uploaded by one call to `poll()`
+   */
+  static constexpr std::size_t uploadsPerPoll = 4u;
+
+  /**
+   * Holds the meshes of every model
+   */
+  MeshArena arena;
+
+  /**
+   * Builds models off the thread with the context,
+   * before they are uploaded by `loadAbsolute()`
+   */
+  ModelImporter importer;
   std::string basePath;
   std::string _fallbackModelPath;
   model_id fallbackModel = 0u;
 
+  /**
+   * Upload an import as a new entry in `models`
+   *
+   * @return
+   * The index of the model in `models`, or unset if the import failed
+   */
+  std::optional<std::size_t> upload(const std::string &path, const ModelImport &model);
+
 public:
   explicit ModelCache(TextureCache &textureCache);
-  ~ModelCache() override = default;
+  ~ModelCache() override;
 
   void setBasePath(std::string value);
   void init(std::string_view fallbackModelPath);
-  Model::ModelLoadInfo load(const std::string &path);
-  Model::ModelLoadInfo loadAbsolute(const std::string &path);
+
+  /**
+   * Start building the model at `path` in the background,
+   * so a later `load()` of it only has to upload it.
+   * Does not require a current context
+   *
+   * @param path
+   * The path to the model, relative to the base path
+   */
+  void prefetch(const std::string &path);
+
+  /**
+   * See `ModelImporter::prewarm()`
+   *
+   * @param path
+   * The absolute path to the model
+   *
+   * @param token
+   * Skips the build if cancelled before it starts
+   */
+  void prewarm(const std::string &path, const parser::CancellationToken &token);
+
+  /**
+   * @return
+   * The absolute path of every model loaded or being imported, other than the fallback
+   */
+  [[nodiscard]] std::vector<std::string> getLoadedPaths() const;
+
+  /**
+   * Load the model at `path`, relative to the base path.
+   *
+   * Unless `wait` is set, a model which is still importing is returned right away,
+   * with the bounds of the fallback model. It is drawn as the fallback model
+   * until `poll()` swaps it in
+   *
+   * @param path
+   * The path to the model, relative to the base path
+   *
+   * @param wait
+   * Wait for the import, so the real model & bounds are returned
+   *
+   * @return
+   * The ID & bounds of the model
+   */
+  Model::ModelLoadInfo load(const std::string &path, bool wait = false);
+
+  /**
+   * Load the model at `path`, see `load()`
+   *
+   * @param path
+   * The absolute path to the model
+   *
+   * @param wait
+   * Wait for the import, so the real model & bounds are returned
+   *
+   * @return
+   * The ID & bounds of the model
+   */
+  Model::ModelLoadInfo loadAbsolute(const std::string &path, bool wait = true);
+
+  /**
+   * Import the model at `path` again, replacing the meshes of its ID in place,
+   * so everything already using the ID draws the new version.
+   * Models not loaded yet are loaded as with `loadAbsolute()`.
+   * Only this model is imported, the rest of the cache is untouched
+   *
+   * @param path
+   * The absolute path to the model
+   *
+   * @return
+   * The ID & bounds of the model. If the new version fails to import,
+   * the old version is kept, and its bounds returned
+   */
+  Model::ModelLoadInfo refresh(const std::string &path);
+
+  /**
+   * Upload the models returned early by `load()` which have finished importing,
+   * a few at a time. Call once a frame
+   *
+   * @return
+   * The IDs of the models swapped in, which now have their real bounds.
+   * Models which failed to import stay the fallback model, and are not included
+   */
+  std::vector<model_id> poll();
+
+  /**
+   * @return
+   * True if any model returned by `load()` is still drawn as the fallback model
+   */
+  [[nodiscard]] bool loading() const;
+
+  /**
+   * @return
+   * The bytes used on the GPU by the meshes of every model
+   */
+  [[nodiscard]] std::size_t getGpuBytes() const;
+
+  /**
+   * @return
+   * The total time `load()` has waited on models still being imported
+   */
+  [[nodiscard]] std::chrono::steady_clock::duration getImportWait() const;
+
+  /**
+   * @return
+   * The total time spent uploading imported models, including their meshes
+   */
+  [[nodiscard]] std::chrono::steady_clock::duration getUploadTime() const;
+
+  /**
+   * Release the meshes of models no longer used, least recently used first.
+   * Evicted models keep their IDs, and are imported again when next used
+   *
+   * @param live
+   * The models still in use, which are kept
+   *
+   * @param bytes
+   * Stop once this many bytes are released
+   *
+   * @return
+   * The bytes released
+   */
+  std::size_t evict(const std::unordered_set<model_id> &live, std::size_t bytes);
 
   ModelRenderInfo &get(model_id index);
   [[nodiscard]] model_id getFallbackModelId() const;
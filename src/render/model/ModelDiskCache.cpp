@@ -0,0 +1,301 @@
+/*
+ * NIST-developed software is provided by NIST as a public service. You may use,
+ * copy and distribute copies of the software in any medium, provided that you
+ * keep intact this entire notice. You may improve,modify and create derivative
+ * works of the software or any portion of the software, and you may copy and
+ * distribute such modifications or works. Modified works should carry a notice
+ * stating that you changed the software and should note the date and nature of
+ * any such change. Please explicitly acknowledge the National Institute of
+ * Standards and Technology as the source of the software.
+ *
+ * NIST-developed software is expressly provided "AS IS." NIST MAKES NO
+ * WARRANTY OF ANY KIND, EXPRESS, IMPLIED, IN FACT OR ARISING BY OPERATION OF
+ * LAW, INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTY OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, NON-INFRINGEMENT
+ * AND DATA ACCURACY. NIST NEITHER REPRESENTS NOR WARRANTS THAT THE
+ * OPERATION OF THE SOFTWARE WILL BE UNINTERRUPTED OR ERROR-FREE, OR THAT
+ * ANY DEFECTS WILL BE CORRECTED. NIST DOES NOT WARRANT OR MAKE ANY
+ * REPRESENTATIONS REGARDING THE USE OF THE SOFTWARE OR THE RESULTS THEREOF,
+ * INCLUDING BUT NOT LIMITED TO THE CORRECTNESS, ACCURACY, RELIABILITY,
+ * OR USEFULNESS OF THE SOFTWARE.
+ *
+ * You are solely responsible for determining the appropriateness of using and
+ * distributing the software and you assume all risks associated with its use,
+ * including but not limited to the risks and costs of program errors,
+ * compliance with applicable laws, damage to or loss of data, programs or
+ * equipment, and the unavailability or interruption of operation. This
+ * software is not intended to be used in any situation where a failure could
+ * cause risk of injury or damage to property. The software developed by NIST
+ * employees is not subject to copyright protection within the United States.
+ *
+ * Author: Evan Black <evan.black@nist.gov>
+ */
+
+#include "ModelDiskCache.h"
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QSaveFile>
+#include <array>
+#include <cstddef>
+#include <cstring>
+#include <glm/glm.hpp>
+#include <iostream>
+#include <type_traits>
+#include <utility>
+
+namespace netsimulyzer {
+
+namespace {
+
+// Entries are stored in native byte order, they're never shared between machines
+constexpr std::array<char, 4> magic{'N', 'S', 'M', 'C'};
+
+class EntryWriter {
+  QByteArray bytes;
+
+public:
+  template <class T>
+  void write(const T &value) {
+    static_assert(std::is_trivially_copyable_v<T>);
+    bytes.append(reinterpret_cast<const char *>(&value), sizeof(T));
+  }
+
+  template <class T>
+  void writeArray(const std::vector<T> &values) {
+    static_assert(std::is_trivially_copyable_v<T>);
+    write(static_cast<std::uint64_t>(values.size()));
+    bytes.append(reinterpret_cast<const char *>(values.data()), static_cast<int>(sizeof(T) * values.size()));
+  }
+
+  void writeString(const QByteArray &value) {
+    write(static_cast<std::uint64_t>(value.size()));
+    bytes.append(value);
+  }
+
+  [[nodiscard]] const QByteArray &getBytes() const {
+    return bytes;
+  }
+};
+
+/**
+ * Reads an entry, checking every read against the end of the entry.
+ * Once a read fails, every later read fails
+ */
+class EntryReader {
+  const unsigned char *position;
+  const unsigned char *end;
+  bool failed{false};
+
+public:
+  EntryReader(const unsigned char *data, qint64 size) : position(data), end(data + size) {
+  }
+
+  template <class T>
+  bool read(T &value) {
+    static_assert(std::is_trivially_copyable_v<T>);
+    if (failed || static_cast<std::size_t>(end - position) < sizeof(T)) {
+      failed = true;
+      return false;
+    }
+
+    std::memcpy(&value, position, sizeof(T));
+    position += sizeof(T);
+    return true;
+  }
+
+  template <class T>
+  bool readArray(std::vector<T> &values) {
+    static_assert(std::is_trivially_copyable_v<T>);
+    std::uint64_t count;
+    if (!read(count) || count > static_cast<std::uint64_t>(end - position) / sizeof(T)) {
+      failed = true;
+      return false;
+    }
+
+    values.resize(count);
+    std::memcpy(values.data(), position, sizeof(T) * count);
+    position += sizeof(T) * count;
+    return true;
+  }
+
+  bool readString(QByteArray &value) {
+    std::uint64_t size;
+    if (!read(size) || size > static_cast<std::uint64_t>(end - position)) {
+      failed = true;
+      return false;
+    }
+
+    value = QByteArray{reinterpret_cast<const char *>(position), static_cast<int>(size)};
+    position += size;
+    return true;
+  }
+
+  [[nodiscard]] bool ok() const {
+    return !failed;
+  }
+};
+
+void writeMeshes(EntryWriter &writer, const std::vector<ModelImport::SourceMesh> &meshes) {
+  writer.write(static_cast<std::uint64_t>(meshes.size()));
+  for (const auto &mesh : meshes) {
+    writer.write(static_cast<std::uint64_t>(mesh.material));
+    writer.writeArray(mesh.vertices);
+    writer.writeArray(mesh.indices);
+    writer.writeArray(mesh.references);
+  }
+}
+
+bool readMeshes(EntryReader &reader, std::size_t materialCount, std::vector<ModelImport::SourceMesh> &meshes) {
+  std::uint64_t count;
+  if (!reader.read(count))
+    return false;
+
+  for (std::uint64_t i = 0u; i < count && reader.ok(); i++) {
+    auto &mesh = meshes.emplace_back();
+    std::uint64_t material;
+    if (!reader.read(material) || material >= materialCount)
+      return false;
+
+    mesh.material = static_cast<std::size_t>(material);
+    reader.readArray(mesh.vertices);
+    reader.readArray(mesh.indices);
+    reader.readArray(mesh.references);
+  }
+
+  return reader.ok();
+}
+
+} // namespace
+
+ModelDiskCache::ModelDiskCache(QString directory) : directory(std::move(directory)) {
+}
+
+QByteArray ModelDiskCache::key(const std::vector<QFileInfo> &sources) {
+  QByteArray result;
+  for (const auto &source : sources) {
+    result.append(source.absoluteFilePath().toUtf8());
+    result.append('|');
+    result.append(QByteArray::number(source.size()));
+    result.append('|');
+    result.append(QByteArray::number(source.lastModified().toMSecsSinceEpoch()));
+    result.append('\n');
+  }
+  return result;
+}
+
+QString ModelDiskCache::entryPath(const QByteArray &key) const {
+  const auto hash = QCryptographicHash::hash(key, QCryptographicHash::Sha1).toHex();
+  return QDir{directory}.filePath(QString::fromLatin1(hash) + ".mesh");
+}
+
+std::optional<ModelImport> ModelDiskCache::read(const std::vector<QFileInfo> &sources) const {
+  const auto entryKey = key(sources);
+  QFile file{entryPath(entryKey)};
+  if (!file.open(QIODevice::ReadOnly))
+    return {};
+
+  // Mapped, so the entry is read straight into the model
+  const auto size = file.size();
+  const auto *data = file.map(0, size);
+  if (!data)
+    return {};
+
+  EntryReader reader{data, size};
+
+  std::array<char, 4> fileMagic{};
+  std::uint32_t fileVersion;
+  QByteArray fileKey;
+  if (!reader.read(fileMagic) || fileMagic != magic || !reader.read(fileVersion) || fileVersion != version ||
+      !reader.readString(fileKey) || fileKey != entryKey)
+    return {};
+
+  ModelImport model;
+
+  std::uint64_t materialCount;
+  reader.read(materialCount);
+  for (std::uint64_t i = 0u; i < materialCount && reader.ok(); i++) {
+    auto &source = model.materials.emplace_back();
+    auto &material = source.material;
+
+    std::uint32_t type;
+    std::uint8_t hasColor;
+    glm::vec3 color;
+    std::uint8_t hasTexture;
+    reader.read(material.specularIntensity);
+    reader.read(material.shininess);
+    reader.read(material.opacity);
+    reader.read(type);
+    reader.read(hasColor);
+    reader.read(color);
+    reader.read(hasTexture);
+
+    if (type > static_cast<std::uint32_t>(Material::MaterialType::Highlight))
+      return {};
+    material.materialType = static_cast<Material::MaterialType>(type);
+    if (hasColor)
+      material.color = color;
+
+    if (hasTexture) {
+      QByteArray texture;
+      reader.readString(texture);
+      source.texture = texture.toStdString();
+    }
+  }
+
+  if (!reader.ok() || !readMeshes(reader, model.materials.size(), model.meshes))
+    return {};
+
+  std::uint64_t levelCount;
+  if (!reader.read(levelCount) || levelCount >= ModelImporter::maxLevels)
+    return {};
+
+  for (std::uint64_t i = 0u; i < levelCount; i++) {
+    if (!readMeshes(reader, model.materials.size(), model.levels.emplace_back()))
+      return {};
+  }
+
+  return model;
+}
+
+void ModelDiskCache::write(const std::vector<QFileInfo> &sources, const ModelImport &model) const {
+  const auto entryKey = key(sources);
+
+  EntryWriter writer;
+  writer.write(magic);
+  writer.write(version);
+  writer.writeString(entryKey);
+
+  writer.write(static_cast<std::uint64_t>(model.materials.size()));
+  for (const auto &source : model.materials) {
+    const auto &material = source.material;
+    writer.write(material.specularIntensity);
+    writer.write(material.shininess);
+    writer.write(material.opacity);
+    writer.write(static_cast<std::uint32_t>(material.materialType));
+    writer.write(static_cast<std::uint8_t>(material.color.has_value()));
+    writer.write(material.color.value_or(glm::vec3{0.0f}));
+    writer.write(static_cast<std::uint8_t>(source.texture.has_value()));
+    if (source.texture)
+      writer.writeString(QByteArray::fromStdString(source.texture.value()));
+  }
+
+  writeMeshes(writer, model.meshes);
+  writer.write(static_cast<std::uint64_t>(model.levels.size()));
+  for (const auto &level : model.levels)
+    writeMeshes(writer, level);
+
+  if (!QDir{}.mkpath(directory)) {
+    std::cerr << "Failed creating the model cache at: " << directory.toStdString() << '\n';
+    return;
+  }
+
+  // Written to a temporary file, then renamed, so a partial entry is never read
+  QSaveFile file{entryPath(entryKey)};
+  if (!file.open(QIODevice::WriteOnly) || file.write(writer.getBytes()) != writer.getBytes().size() ||
+      !file.commit())
+    std::cerr << "Failed writing model cache entry: " << file.fileName().toStdString() << '\n';
+}
+
+} // namespace netsimulyzer
@@ -0,0 +1,96 @@
+/*
+ * NIST-developed software is provided by NIST as a public service. You may use,
+ * copy and distribute copies of the software in any medium, provided that you
+ * keep intact this entire notice. You may improve,modify and create derivative
+ * works of the software or any portion of the software, and you may copy and
+ * distribute such modifications or works. Modified works should carry a notice
+ * stating that you changed the software and should note the date and nature of
+ * any such change. Please explicitly acknowledge the National Institute of
+ * Standards and Technology as the source of the software.
+ *
+ * NIST-developed software is expressly provided "AS IS." NIST MAKES NO
+ * WARRANTY OF ANY KIND, EXPRESS, IMPLIED, IN FACT OR ARISING BY OPERATION OF
+ * LAW, INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTY OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, NON-INFRINGEMENT
+ * AND DATA ACCURACY. NIST NEITHER REPRESENTS NOR WARRANTS THAT THE
+ * OPERATION OF THE SOFTWARE WILL BE UNINTERRUPTED OR ERROR-FREE, OR THAT
+ * ANY DEFECTS WILL BE CORRECTED. NIST DOES NOT WARRANT OR MAKE ANY
+ * REPRESENTATIONS REGARDING THE USE OF THE SOFTWARE OR THE RESULTS THEREOF,
+ * INCLUDING BUT NOT LIMITED TO THE CORRECTNESS, ACCURACY, RELIABILITY,
+ * OR USEFULNESS OF THE SOFTWARE.
+ *
+ * You are solely responsible for determining the appropriateness of using and
+ * distributing the software and you assume all risks associated with its use,
+ * including but not limited to the risks and costs of program errors,
+ * compliance with applicable laws, damage to or loss of data, programs or
+ * equipment, and the unavailability or interruption of operation. This
+ * software is not intended to be used in any situation where a failure could
+ * cause risk of injury or damage to property. The software developed by NIST
+ * employees is not subject to copyright protection within the United States.
+ *
+ * Author: Evan Black <evan.black@nist.gov>
+ */
+
+#pragma once
+
+#include "ModelImporter.h"
+#include <QByteArray>
+#include <QFileInfo>
+#include <QString>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+namespace netsimulyzer {
+
+/**
+ * Built models stored on disk, so later loads of the same files skip Assimp.
+ *
+ * Each entry is keyed by the path, size & modification time of every file the model was built from,
+ * so editing any of them builds the model again.
+ * Reentrant, entries may be read & written from several threads at once
+ */
+class ModelDiskCache {
+  /**
+   * Bump whenever the layout of an entry, `Vertex`, or `Material` changes,
+   * or meshes are built differently
+   */
+  static constexpr std::uint32_t version = 3u;
+
+  QString directory;
+
+  [[nodiscard]] static QByteArray key(const std::vector<QFileInfo> &sources);
+  [[nodiscard]] QString entryPath(const QByteArray &key) const;
+
+public:
+  /**
+   * @param directory
+   * Where the entries are kept. Created with the first entry
+   */
+  explicit ModelDiskCache(QString directory);
+
+  /**
+   * Read a model built from `sources`
+   *
+   * @param sources
+   * The files the model is built from
+   *
+   * @return
+   * The model, unset if there's no entry, or it's out of date/unreadable
+   */
+  [[nodiscard]] std::optional<ModelImport> read(const std::vector<QFileInfo> &sources) const;
+
+  /**
+   * Store `model`, replacing any existing entry for `sources`.
+   * Failures are reported, but otherwise ignored
+   *
+   * @param sources
+   * The files `model` was built from
+   *
+   * @param model
+   * The model to store, without an `error`
+   */
+  void write(const std::vector<QFileInfo> &sources, const ModelImport &model) const;
+};
+
+} // namespace netsimulyzer
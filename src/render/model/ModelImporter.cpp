@@ -0,0 +1,480 @@
+/*
+ * NIST-developed software is provided by NIST as a public service. You may use,
+ * copy and distribute copies of the software in any medium, provided that you
+ * keep intact this entire notice. You may improve,modify and create derivative
+ * works of the software or any portion of the software, and you may copy and
+ * distribute such modifications or works. Modified works should carry a notice
+ * stating that you changed the software and should note the date and nature of
+ * any such change. Please explicitly acknowledge the National Institute of
+ * Standards and Technology as the source of the software.
+ *
+ * NIST-developed software is expressly provided "AS IS." NIST MAKES NO
+ * WARRANTY OF ANY KIND, EXPRESS, IMPLIED, IN FACT OR ARISING BY OPERATION OF
+ * LAW, INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTY OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, NON-INFRINGEMENT
+ * AND DATA ACCURACY. NIST NEITHER REPRESENTS NOR WARRANTS THAT THE
+ * OPERATION OF THE SOFTWARE WILL BE UNINTERRUPTED OR ERROR-FREE, OR THAT
+ * ANY DEFECTS WILL BE CORRECTED. NIST DOES NOT WARRANT OR MAKE ANY
+ * REPRESENTATIONS REGARDING THE USE OF THE SOFTWARE OR THE RESULTS THEREOF,
+ * INCLUDING BUT NOT LIMITED TO THE CORRECTNESS, ACCURACY, RELIABILITY,
+ * OR USEFULNESS OF THE SOFTWARE.
+ *
+ * You are solely responsible for determining the appropriateness of using and
+ * distributing the software and you assume all risks associated with its use,
+ * including but not limited to the risks and costs of program errors,
+ * compliance with applicable laws, damage to or loss of data, programs or
+ * equipment, and the unavailability or interruption of operation. This
+ * software is not intended to be used in any situation where a failure could
+ * cause risk of injury or damage to property. The software developed by NIST
+ * employees is not subject to copyright protection within the United States.
+ *
+ * Author: Evan Black <evan.black@nist.gov>
+ */
+
+#include "ModelImporter.h"
+#include "../mesh/optimize.h"
+#include "../mesh/simplify.h"
+#include "ModelDiskCache.h"
+#include <QDir>
+#include <QFileInfo>
+#include <algorithm>
+#include <array>
+#include <assimp/Importer.hpp>
+#include <assimp/postprocess.h>
+#include <assimp/scene.h>
+#include <chrono>
+#include <cstring>
+#include <glm/glm.hpp>
+#include <iostream>
+#include <limits>
+#include <trace.h>
+#include <unordered_map>
+#include <utility>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define NETSIMULYZER_SSE2
+#include <xmmintrin.h>
+#endif
+
+namespace netsimulyzer {
+
+namespace {
+
+/**
+ * Models with fewer triangles than this are not simplified
+ */
+constexpr std::size_t minimumSimplifyTriangles = 2000u;
+
+constexpr auto importFlags =
+    aiProcess_Triangulate | aiProcess_FlipUVs | aiProcess_GenSmoothNormals | aiProcess_JoinIdenticalVertices;
+
+/**
+ * The running lowest & highest corners of a set of positions,
+ * compared a whole position at a time where SSE is available
+ */
+class BoundsAccumulator {
+#ifdef NETSIMULYZER_SSE2
+  __m128 min = _mm_set1_ps(std::numeric_limits<float>::max());
+  __m128 max = _mm_set1_ps(std::numeric_limits<float>::lowest());
+#else
+  glm::vec3 min{std::numeric_limits<float>::max()};
+  glm::vec3 max{std::numeric_limits<float>::lowest()};
+#endif
+
+public:
+  void add(float x, float y, float z) {
+#ifdef NETSIMULYZER_SSE2
+    const auto position = _mm_setr_ps(x, y, z, 0.0f);
+    min = _mm_min_ps(min, position);
+    max = _mm_max_ps(max, position);
+#else
+    const glm::vec3 position{x, y, z};
+    min = glm::min(min, position);
+    max = glm::max(max, position);
+#endif
+  }
+
+  [[nodiscard]] std::pair<glm::vec3, glm::vec3> get() const {
+#ifdef NETSIMULYZER_SSE2
+    alignas(16) std::array<float, 4> lowest{};
+    alignas(16) std::array<float, 4> highest{};
+    _mm_store_ps(lowest.data(), min);
+    _mm_store_ps(highest.data(), max);
+    return {{lowest[0], lowest[1], lowest[2]}, {highest[0], highest[1], highest[2]}};
+#else
+    return {min, max};
+#endif
+  }
+};
+
+ModelImport::SourceMesh &loadMesh(aiMesh const *m, std::size_t materialOffset,
+                                  std::vector<ModelImport::SourceMesh> &sources) {
+  auto &source = sources.emplace_back();
+  source.material = materialOffset + m->mMaterialIndex;
+
+  // Every vertex is written in place, in one pass measuring the bounds along the way
+  auto &vertices = source.vertices;
+  vertices.resize(m->mNumVertices);
+
+  const auto *const positions = m->mVertices;
+  const auto *const normals = m->mNormals;
+  // if we have at least one texture
+  const auto *const textureCoordinates = m->mTextureCoords[0];
+
+  BoundsAccumulator bounds;
+  for (auto i = 0u; i < m->mNumVertices; i++) {
+    auto &v = vertices[i];
+    const auto &position = positions[i];
+    v.position = {position.x, position.y, position.z};
+    bounds.add(position.x, position.y, position.z);
+
+    // Normals should point away
+    v.normal = {-normals[i].x, -normals[i].y, -normals[i].z};
+
+    if (textureCoordinates)
+      v.textureCoordinate = {textureCoordinates[i].x, textureCoordinates[i].y};
+  }
+  if (m->mNumVertices > 0u)
+    source.bounds = bounds.get();
+
+  auto &indices = source.indices;
+  if (m->mPrimitiveTypes == aiPrimitiveType_TRIANGLE) {
+    // Triangulated, so the size is known up front
+    indices.resize(static_cast<std::size_t>(m->mNumFaces) * 3u);
+    auto *index = indices.data();
+    for (auto i = 0u; i < m->mNumFaces; i++) {
+      const auto *const faceIndices = m->mFaces[i].mIndices;
+      *index++ = faceIndices[0];
+      *index++ = faceIndices[1];
+      *index++ = faceIndices[2];
+    }
+
+    // Assimp joined the identical vertices already
+    optimizeMesh(vertices, indices);
+  } else {
+    // Points & lines mixed in, still at most 3 indices a face
+    indices.reserve(static_cast<std::size_t>(m->mNumFaces) * 3u);
+    for (auto i = 0u; i < m->mNumFaces; i++) {
+      const auto &face = m->mFaces[i];
+      indices.insert(indices.end(), face.mIndices, face.mIndices + face.mNumIndices);
+    }
+  }
+
+  return source;
+}
+
+glm::mat4 toGlm(const aiMatrix4x4 &m) {
+  // Assimp matrices are row major
+  return glm::transpose(glm::mat4{m.a1, m.a2, m.a3, m.a4, m.b1, m.b2, m.b3, m.b4, m.c1, m.c2, m.c3, m.c4, m.d1, m.d2,
+                                  m.d3, m.d4});
+}
+
+/**
+ * The placements of each mesh referenced by a scene, in the order the meshes are first found
+ */
+struct SceneReferences {
+  std::vector<std::pair<unsigned int, std::vector<glm::mat4>>> meshes;
+
+  /**
+   * Index in `meshes` of each mesh in the scene
+   */
+  std::unordered_map<unsigned int, std::size_t> index;
+};
+
+void collectReferences(aiNode const *node, const glm::mat4 &parent, SceneReferences &references) {
+  const auto transform = parent * toGlm(node->mTransformation);
+
+  for (auto i = 0u; i < node->mNumMeshes; i++) {
+    const auto mesh = node->mMeshes[i];
+    const auto [existing, inserted] = references.index.try_emplace(mesh, references.meshes.size());
+    if (inserted)
+      references.meshes.emplace_back(mesh, std::vector<glm::mat4>{});
+
+    references.meshes[existing->second].second.emplace_back(transform);
+  }
+
+  for (auto i = 0u; i < node->mNumChildren; i++) {
+    collectReferences(node->mChildren[i], transform, references);
+  }
+}
+
+/**
+ * Move the vertices of a mesh referenced once to where its node places it
+ */
+void place(ModelImport::SourceMesh &source, const glm::mat4 &transform) {
+  if (transform == glm::mat4{1.0f})
+    return;
+
+  const auto normalTransform = glm::transpose(glm::inverse(glm::mat3{transform}));
+  BoundsAccumulator bounds;
+  for (auto &v : source.vertices) {
+    const auto position = transform * glm::vec4{v.position[0], v.position[1], v.position[2], 1.0f};
+    v.position = {position.x, position.y, position.z};
+    bounds.add(position.x, position.y, position.z);
+
+    auto normal = normalTransform * glm::vec3{v.normal[0], v.normal[1], v.normal[2]};
+    if (glm::dot(normal, normal) > 0.0f)
+      normal = glm::normalize(normal);
+    v.normal = {normal.x, normal.y, normal.z};
+  }
+  if (!source.vertices.empty())
+    source.bounds = bounds.get();
+}
+
+/**
+ * Load each mesh of `scene` once, however many nodes reference it
+ */
+void loadScene(aiScene const *scene, std::size_t materialOffset, std::vector<ModelImport::SourceMesh> &sources) {
+  SceneReferences references;
+  collectReferences(scene->mRootNode, glm::mat4{1.0f}, references);
+
+  for (auto &[mesh, transforms] : references.meshes) {
+    auto &source = loadMesh(scene->mMeshes[mesh], materialOffset, sources);
+    if (transforms.size() == 1u)
+      place(source, transforms.front());
+    else
+      source.references = std::move(transforms);
+  }
+}
+
+void loadMaterials(aiScene const *scene, std::vector<ModelImport::SourceMaterial> &materials) {
+  using MaterialType = Material::MaterialType;
+
+  for (auto i = 0u; i < scene->mNumMaterials; i++) {
+    auto const *material = scene->mMaterials[i];
+    auto &source = materials.emplace_back();
+    auto &m = source.material;
+
+    material->Get(AI_MATKEY_OPACITY, m.opacity);
+
+    aiString name;
+    material->Get(AI_MATKEY_NAME, name);
+
+    // Check for configurable materials
+    if (std::strcmp(name.data, "netsimulyzer.base") == 0) {
+      m.materialType = MaterialType::Base;
+    } else if (std::strcmp(name.data, "netsimulyzer.highlight") == 0)
+      m.materialType = MaterialType::Highlight;
+    else
+      m.materialType = MaterialType::Unclassified;
+
+    if (material->GetTextureCount(aiTextureType_DIFFUSE)) {
+      aiString path;
+
+      if (material->GetTexture(aiTextureType_DIFFUSE, 0, &path) == AI_SUCCESS) {
+        std::string pathCppString{path.data};
+        // Strips back to the last '\' character (i.e. 'C:\Users\Evan\projects' -> 'projects')
+        source.texture = pathCppString.substr(pathCppString.rfind('\\') + 1);
+      } else {
+        source.texture = std::string{};
+      }
+    } else {
+      aiColor3D color;
+
+      // Diffuse diffuse & transparent color are separate for some reason...
+      if (m.opacity < 1.0f)
+        material->Get(AI_MATKEY_COLOR_TRANSPARENT, color);
+      else
+        material->Get(AI_MATKEY_COLOR_DIFFUSE, color);
+
+      m.color = {color.r, color.g, color.b};
+    }
+
+    material->Get(AI_MATKEY_SHININESS, m.shininess);                  // Errors Ignored
+    material->Get(AI_MATKEY_SHININESS_STRENGTH, m.specularIntensity); // Errors Ignored
+  }
+}
+
+/**
+ * Fill the levels of `model` by simplifying its full detail meshes, if it is detailed enough
+ */
+void generateLevels(ModelImport &model) {
+  std::size_t triangles = 0u;
+  for (const auto &source : model.meshes) {
+    // Points & lines are not simplified
+    if (source.indices.size() % 3u != 0u)
+      return;
+    triangles += source.indices.size() / 3u;
+  }
+
+  if (triangles < minimumSimplifyTriangles)
+    return;
+
+  // The bounds of the model are only taken from the opaque meshes
+  std::optional<std::pair<glm::vec3, glm::vec3>> bounds;
+  for (const auto &source : model.meshes) {
+    if (model.materials[source.material].material.opacity < 1.0f || !source.bounds)
+      continue;
+
+    if (!bounds)
+      bounds = source.bounds;
+    bounds->first = glm::min(bounds->first, source.bounds->first);
+    bounds->second = glm::max(bounds->second, source.bounds->second);
+  }
+
+  if (!bounds)
+    return;
+
+  // Cells for each level, as a fraction of the longest side of the model
+  constexpr std::array<float, ModelImporter::maxLevels - 1u> cellFractions{1.0f / 48.0f, 1.0f / 16.0f};
+
+  const auto extent = bounds->second - bounds->first;
+  const auto longestSide = std::max({extent.x, extent.y, extent.z});
+  if (longestSide <= 0.0f)
+    return;
+
+  for (const auto fraction : cellFractions) {
+    std::vector<ModelImport::SourceMesh> simplified;
+    std::size_t simplifiedTriangles = 0u;
+    for (const auto &source : model.meshes) {
+      auto result = simplify(source.vertices, source.indices, bounds->first, longestSide * fraction);
+      optimizeMesh(result.vertices, result.indices);
+      simplifiedTriangles += result.indices.size() / 3u;
+      if (!result.indices.empty())
+        simplified.push_back(
+            {std::move(result.vertices), std::move(result.indices), source.material, source.references});
+    }
+
+    // Not worth another level if it barely saves anything
+    if (simplifiedTriangles == 0u || simplifiedTriangles * 4u > triangles * 3u)
+      return;
+
+    model.levels.emplace_back(std::move(simplified));
+    triangles = simplifiedTriangles;
+  }
+}
+
+} // namespace
+
+ModelImport ModelImporter::importModel(const std::string &path, const ModelDiskCache *cache) {
+  parser::trace::Scope trace{"ModelImporter::importModel", "load"};
+
+  // Simplified versions may be provided next to the model
+  // e.g. 'ue.obj' -> 'ue.lod1.obj', then 'ue.lod2.obj'
+  // Otherwise, they are generated
+  const QFileInfo modelInfo{QString::fromStdString(path)};
+  std::vector<QFileInfo> sources{modelInfo};
+  for (auto level = 1u; level < maxLevels; level++) {
+    const QFileInfo levelInfo{modelInfo.dir(), QString{"%1.lod%2.%3"}
+                                                   .arg(modelInfo.completeBaseName())
+                                                   .arg(level)
+                                                   .arg(modelInfo.suffix())};
+    if (!levelInfo.exists())
+      break;
+
+    sources.emplace_back(levelInfo);
+  }
+
+  if (cache) {
+    if (auto cached = cache->read(sources); cached)
+      return std::move(cached.value());
+  }
+
+  ModelImport model;
+
+  Assimp::Importer importer;
+  const auto *const scene = importer.ReadFile(path.c_str(), importFlags);
+  if (!scene) {
+    model.error = importer.GetErrorString();
+    return model;
+  }
+
+  loadMaterials(scene, model.materials);
+  loadScene(scene, 0u, model.meshes);
+
+  for (std::size_t i = 1u; i < sources.size(); i++) {
+    const auto levelPath = sources[i].filePath().toStdString();
+
+    Assimp::Importer levelImporter;
+    const auto *const levelScene = levelImporter.ReadFile(levelPath, importFlags);
+    if (!levelScene) {
+      std::cerr << "Model level of detail (" << levelPath << ") failed to load: " << levelImporter.GetErrorString()
+                << '\n';
+      break;
+    }
+
+    // Each level brings its own materials
+    const auto materialOffset = model.materials.size();
+    loadMaterials(levelScene, model.materials);
+    loadScene(levelScene, materialOffset, model.levels.emplace_back());
+  }
+
+  if (model.levels.empty())
+    generateLevels(model);
+
+  if (cache)
+    cache->write(sources, model);
+
+  return model;
+}
+
+ModelImporter::~ModelImporter() {
+  cancelled.cancel();
+}
+
+void ModelImporter::request(const std::string &path) {
+  std::lock_guard lock{mutex};
+  if (imports.find(path) != imports.end())
+    return;
+
+  auto promise = std::make_shared<std::promise<std::shared_ptr<ModelImport>>>();
+  auto &import = imports[path];
+  import.result = promise->get_future().share();
+  import.task = parser::TaskPool::shared().submit(
+      [promise, path, cache = diskCache]() {
+        promise->set_value(std::make_shared<ModelImport>(importModel(path, cache.get())));
+      },
+      parser::TaskPool::Priority::Normal, cancelled);
+}
+
+void ModelImporter::prewarm(const std::string &path, const parser::CancellationToken &token) {
+  std::shared_ptr<const ModelDiskCache> cache;
+  {
+    std::lock_guard lock{mutex};
+    cache = diskCache;
+  }
+  if (!cache)
+    return;
+
+  parser::TaskPool::shared().submit(
+      [path, cache]() {
+        static_cast<void>(importModel(path, cache.get()));
+      },
+      parser::TaskPool::Priority::Background, token);
+}
+
+void ModelImporter::setCacheDirectory(const std::optional<QString> &directory) {
+  std::lock_guard lock{mutex};
+  diskCache = directory ? std::make_shared<const ModelDiskCache>(directory.value()) : nullptr;
+}
+
+std::shared_ptr<ModelImport> ModelImporter::take(const std::string &path) {
+  request(path);
+
+  Import import;
+  {
+    std::lock_guard lock{mutex};
+    auto existing = imports.find(path);
+    import = std::move(existing->second);
+    imports.erase(existing);
+  }
+
+  // Rather than waiting behind the rest of the pool
+  import.task.wait();
+  return import.result.get();
+}
+
+std::shared_ptr<ModelImport> ModelImporter::tryTake(const std::string &path) {
+  request(path);
+
+  std::lock_guard lock{mutex};
+  auto existing = imports.find(path);
+  if (existing->second.result.wait_for(std::chrono::seconds{0}) != std::future_status::ready)
+    return nullptr;
+
+  auto import = existing->second.result.get();
+  imports.erase(existing);
+  return import;
+}
+
+} // namespace netsimulyzer
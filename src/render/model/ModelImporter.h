@@ -0,0 +1,232 @@
+/*
+ * NIST-developed software is provided by NIST as a public service. You may use,
+ * copy and distribute copies of the software in any medium, provided that you
+ * keep intact this entire notice. You may improve,modify and create derivative
+ * works of the software or any portion of the software, and you may copy and
+ * distribute such modifications or works. Modified works should carry a notice
+ * stating that you changed the software and should note the date and nature of
+ * any such change. Please explicitly acknowledge the National Institute of
+ * Standards and Technology as the source of the software.
+ *
+ * NIST-developed software is expressly provided "AS IS." NIST MAKES NO
+ * WARRANTY OF ANY KIND, EXPRESS, IMPLIED, IN FACT OR ARISING BY OPERATION OF
+ * LAW, INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTY OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, NON-INFRINGEMENT
+ * AND DATA ACCURACY. NIST NEITHER REPRESENTS NOR WARRANTS THAT THE
+ * OPERATION OF THE SOFTWARE WILL BE UNINTERRUPTED OR ERROR-FREE, OR THAT
+ * ANY DEFECTS WILL BE CORRECTED. NIST DOES NOT WARRANT OR MAKE ANY
+ * REPRESENTATIONS REGARDING THE USE OF THE SOFTWARE OR THE RESULTS THEREOF,
+ * INCLUDING BUT NOT LIMITED TO THE CORRECTNESS, ACCURACY, RELIABILITY,
+ * OR USEFULNESS OF THE SOFTWARE.
+ *
+ * You are solely responsible for determining the appropriateness of using and
+ * distributing the software and you assume all risks associated with its use,
+ * including but not limited to the risks and costs of program errors,
+ * compliance with applicable laws, damage to or loss of data, programs or
+ * equipment, and the unavailability or interruption of operation. This
+ * software is not intended to be used in any situation where a failure could
+ * cause risk of injury or damage to property. The software developed by NIST
+ * employees is not subject to copyright protection within the United States.
+ *
+ * Author: Evan Black <evan.black@nist.gov>
+ */
+
+#pragma once
+
+#include "../material/material.h"
+#include "../mesh/Vertex.h"
+#include <QString>
+#include <cstddef>
+#include <future>
+#include <glm/glm.hpp>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <task-pool.h>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace netsimulyzer {
+
+/**
+ * A model as read from disk, with everything but the GL objects built.
+ * Safe to build off the thread with the context
+ */
+struct ModelImport {
+  /**
+   * A mesh as loaded, before it is uploaded
+   */
+  struct SourceMesh {
+    std::vector<Vertex> vertices;
+    std::vector<unsigned int> indices;
+    std::size_t material;
+
+    /**
+     * The placement of each node referencing the mesh, when there is more than one.
+     * Empty if the mesh is referenced once, in which case `vertices` are already placed
+     */
+    std::vector<glm::mat4> references;
+
+    /**
+     * The lowest & highest corners of `vertices`, if they were found while the mesh was built.
+     * Unset for meshes read back from the disk cache & simplified meshes, which are measured when uploaded
+     */
+    std::optional<std::pair<glm::vec3, glm::vec3>> bounds;
+  };
+
+  struct SourceMaterial {
+    /**
+     * The material, without its `textureId`,
+     * since textures are loaded with the context
+     */
+    Material material;
+
+    /**
+     * The diffuse texture to load for the material, if it has one.
+     * Empty if the model names a texture that could not be read,
+     * so the fallback texture is used
+     */
+    std::optional<std::string> texture;
+  };
+
+  /**
+   * Set if the model failed to load, in which case everything else is empty
+   */
+  std::optional<std::string> error;
+
+  std::vector<SourceMaterial> materials;
+
+  /**
+   * The full detail meshes
+   */
+  std::vector<SourceMesh> meshes;
+
+  /**
+   * Reduced detail versions of `meshes`, from level 1 on
+   */
+  std::vector<std::vector<SourceMesh>> levels;
+};
+
+/**
+ * Imports models through Assimp on the shared `parser::TaskPool`,
+ * so several models load at once without blocking the thread with the context.
+ *
+ * Each path is imported once, until its result is taken
+ */
+class ModelDiskCache;
+
+class ModelImporter {
+  struct Import {
+    std::shared_future<std::shared_ptr<ModelImport>> result;
+
+    /**
+     * Run on the waiting thread by `take()`, if no worker has started it
+     */
+    parser::TaskPool::Handle task;
+  };
+
+  std::mutex mutex;
+
+  /**
+   * Every import not taken yet, by path
+   */
+  std::unordered_map<std::string, Import> imports;
+
+  /**
+   * Skips the imports which have not started once the importer is destroyed.
+   * Running imports only hold their own state, so they finish on their own
+   */
+  parser::CancellationToken cancelled;
+
+  /**
+   * Where built models are stored between runs, if anywhere
+   */
+  std::shared_ptr<const ModelDiskCache> diskCache;
+
+public:
+  /**
+   * The most levels of detail a model may have,
+   * including the full detail meshes
+   */
+  static constexpr std::size_t maxLevels = 3u;
+
+  /**
+   * Read the model at `path`, and build its meshes & levels of detail
+   *
+   * @param path
+   * The absolute path to the model
+   *
+   * @param cache
+   * Checked for the model before it is read, then updated with it.
+   * May be null
+   *
+   * @return
+   * The built model, or one with `error` set
+   */
+  [[nodiscard]] static ModelImport importModel(const std::string &path, const ModelDiskCache *cache);
+
+  ModelImporter() = default;
+  ModelImporter(const ModelImporter &) = delete;
+  ModelImporter &operator=(const ModelImporter &) = delete;
+  ~ModelImporter();
+
+  /**
+   * Keep built models in `directory`, so later runs skip Assimp.
+   * Only affects requests made after the call
+   *
+   * @param directory
+   * Where to keep the models, unset to stop keeping them
+   */
+  void setCacheDirectory(const std::optional<QString> &directory);
+
+  /**
+   * Start importing the model at `path` in the background.
+   * Does nothing if it is already requested
+   *
+   * @param path
+   * The absolute path to the model
+   */
+  void request(const std::string &path);
+
+  /**
+   * Build the model at `path` into the disk cache at background priority, without keeping it,
+   * so a later import only reads the cache entry. Reading an entry which is already up to date
+   * leaves it in the OS file cache. Does nothing without a cache directory
+   *
+   * @param path
+   * The absolute path to the model
+   *
+   * @param token
+   * Skips the build if cancelled before it starts
+   */
+  void prewarm(const std::string &path, const parser::CancellationToken &token);
+
+  /**
+   * Wait for the import of `path`, and take it from the importer.
+   * Requests the import first, if it has not been already
+   *
+   * @param path
+   * The absolute path to the model
+   *
+   * @return
+   * The built model, or one with `error` set
+   */
+  [[nodiscard]] std::shared_ptr<ModelImport> take(const std::string &path);
+
+  /**
+   * Take the import of `path` from the importer, if it is finished.
+   * Requests the import first, if it has not been already
+   *
+   * @param path
+   * The absolute path to the model
+   *
+   * @return
+   * The built model, or one with `error` set.
+   * Null if the import is still running
+   */
+  [[nodiscard]] std::shared_ptr<ModelImport> tryTake(const std::string &path);
+};
+
+} // namespace netsimulyzer
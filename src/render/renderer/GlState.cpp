@@ -0,0 +1,213 @@
+/*
+ * NIST-developed software is provided by NIST as a public service. You may use,
+ * copy and distribute copies of the software in any medium, provided that you
+ * keep intact this entire notice. You may improve,modify and create derivative
+ * works of the software or any portion of the software, and you may copy and
+ * distribute such modifications or works. Modified works should carry a notice
+ * stating that you changed the software and should note the date and nature of
+ * any such change. Please explicitly acknowledge the National Institute of
+ * Standards and Technology as the source of the software.
+ *
+ * NIST-developed software is expressly provided "AS IS." NIST MAKES NO
+ * WARRANTY OF ANY KIND, EXPRESS, IMPLIED, IN FACT OR ARISING BY OPERATION OF
+ * LAW, INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTY OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, NON-INFRINGEMENT
+ * AND DATA ACCURACY. NIST NEITHER REPRESENTS NOR WARRANTS THAT THE
+ * OPERATION OF THE SOFTWARE WILL BE UNINTERRUPTED OR ERROR-FREE, OR THAT
+ * ANY DEFECTS WILL BE CORRECTED. NIST DOES NOT WARRANT OR MAKE ANY
+ * REPRESENTATIONS REGARDING THE USE OF THE SOFTWARE OR THE RESULTS THEREOF,
+ * INCLUDING BUT NOT LIMITED TO THE CORRECTNESS, ACCURACY, RELIABILITY,
+ * OR USEFULNESS OF THE SOFTWARE.
+ *
+ * You are solely responsible for determining the appropriateness of using and
+ * distributing the software and you assume all risks associated with its use,
+ * including but not limited to the risks and costs of program errors,
+ * compliance with applicable laws, damage to or loss of data, programs or
+ * equipment, and the unavailability or interruption of operation. This
+ * software is not intended to be used in any situation where a failure could
+ * cause risk of injury or damage to property. The software developed by NIST
+ * employees is not subject to copyright protection within the United States.
+ *
+ * Author: Evan Black <evan.black@nist.gov>
+ */
+
+
+#include "GlState.h"
+#include "../render-stats.h"
+
+namespace netsimulyzer {
+
+bool GlState::count(bool changed) {
+  if (changed)
+    stats::frameCounters.stateChanges++;
+  else
+    stats::frameCounters.elidedStateChanges++;
+
+  return changed;
+}
+
+GlState::GlState() {
+  invalidate();
+}
+
+void GlState::init() {
+  initializeOpenGLFunctions();
+  invalidate();
+}
+
+void GlState::invalidate() {
+  program = unknown;
+  vertexArray = unknown;
+  buffers.fill(unknown);
+  activeUnit = unknown;
+  for (auto &unit : textures)
+    unit.fill(unknown);
+  enabled.fill({});
+  blendFactors.reset();
+  blendMode = unknown;
+  depthWrite.reset();
+}
+
+void GlState::useProgram(unsigned int value) {
+  if (!count(program != value))
+    return;
+
+  glUseProgram(value);
+  program = value;
+}
+
+void GlState::bindVertexArray(unsigned int value) {
+  if (!count(vertexArray != value))
+    return;
+
+  glBindVertexArray(value);
+  vertexArray = value;
+}
+
+void GlState::bindBuffer(unsigned int target, unsigned int value) {
+  const auto index = indexOf(bufferTargets, target);
+  if (!index) {
+    glBindBuffer(target, value);
+    return;
+  }
+
+  if (!count(buffers[*index] != value))
+    return;
+
+  glBindBuffer(target, value);
+  buffers[*index] = value;
+}
+
+void GlState::activeTexture(unsigned int unit) {
+  if (!count(activeUnit != unit))
+    return;
+
+  glActiveTexture(GL_TEXTURE0 + unit);
+  activeUnit = unit;
+}
+
+void GlState::bindTexture(unsigned int unit, unsigned int target, unsigned int value) {
+  // Always switched, so following texture calls apply to `unit`
+  activeTexture(unit);
+
+  const auto index = indexOf(textureTargets, target);
+  if (unit >= textureUnits || !index) {
+    glBindTexture(target, value);
+    return;
+  }
+
+  auto &bound = textures[unit][*index];
+  if (!count(bound != value))
+    return;
+
+  glBindTexture(target, value);
+  bound = value;
+}
+
+void GlState::setEnabled(unsigned int capability, bool value) {
+  const auto index = indexOf(capabilities, capability);
+  if (index) {
+    if (!count(enabled[*index] != value))
+      return;
+    enabled[*index] = value;
+  }
+
+  if (value)
+    glEnable(capability);
+  else
+    glDisable(capability);
+}
+
+void GlState::enable(unsigned int capability) {
+  setEnabled(capability, true);
+}
+
+void GlState::disable(unsigned int capability) {
+  setEnabled(capability, false);
+}
+
+void GlState::blendFunc(unsigned int source, unsigned int destination) {
+  const auto factors = std::make_pair(source, destination);
+  if (!count(blendFactors != factors))
+    return;
+
+  glBlendFunc(source, destination);
+  blendFactors = factors;
+}
+
+void GlState::blendEquation(unsigned int mode) {
+  if (!count(blendMode != mode))
+    return;
+
+  glBlendEquation(mode);
+  blendMode = mode;
+}
+
+void GlState::depthMask(bool value) {
+  if (!count(depthWrite != value))
+    return;
+
+  glDepthMask(value ? GL_TRUE : GL_FALSE);
+  depthWrite = value;
+}
+
+void GlState::deleteProgram(unsigned int value) {
+  glDeleteProgram(value);
+
+  // A deleted program stays in use until another is, so the next use must be issued
+  if (value != 0u && program == value)
+    program = unknown;
+}
+
+void GlState::deleteVertexArray(unsigned int value) {
+  glDeleteVertexArrays(1, &value);
+
+  if (value != 0u && vertexArray == value)
+    vertexArray = 0u;
+}
+
+void GlState::deleteBuffer(unsigned int value) {
+  glDeleteBuffers(1, &value);
+  if (value == 0u)
+    return;
+
+  for (auto &buffer : buffers) {
+    if (buffer == value)
+      buffer = 0u;
+  }
+}
+
+void GlState::deleteTexture(unsigned int value) {
+  glDeleteTextures(1, &value);
+  if (value == 0u)
+    return;
+
+  for (auto &unit : textures) {
+    for (auto &texture : unit) {
+      if (texture == value)
+        texture = 0u;
+    }
+  }
+}
+
+} // namespace netsimulyzer
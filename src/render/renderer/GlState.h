@@ -0,0 +1,169 @@
+/*
+ * NIST-developed software is provided by NIST as a public service. You may use,
+ * copy and distribute copies of the software in any medium, provided that you
+ * keep intact this entire notice. You may improve,modify and create derivative
+ * works of the software or any portion of the software, and you may copy and
+ * distribute such modifications or works. Modified works should carry a notice
+ * stating that you changed the software and should note the date and nature of
+ * any such change. Please explicitly acknowledge the National Institute of
+ * Standards and Technology as the source of the software.
+ *
+ * NIST-developed software is expressly provided "AS IS." NIST MAKES NO
+ * WARRANTY OF ANY KIND, EXPRESS, IMPLIED, IN FACT OR ARISING BY OPERATION OF
+ * LAW, INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTY OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, NON-INFRINGEMENT
+ * AND DATA ACCURACY. NIST NEITHER REPRESENTS NOR WARRANTS THAT THE
+ * OPERATION OF THE SOFTWARE WILL BE UNINTERRUPTED OR ERROR-FREE, OR THAT
+ * ANY DEFECTS WILL BE CORRECTED. NIST DOES NOT WARRANT OR MAKE ANY
+ * REPRESENTATIONS REGARDING THE USE OF THE SOFTWARE OR THE RESULTS THEREOF,
+ * INCLUDING BUT NOT LIMITED TO THE CORRECTNESS, ACCURACY, RELIABILITY,
+ * OR USEFULNESS OF THE SOFTWARE.
+ *
+ * You are solely responsible for determining the appropriateness of using and
+ * distributing the software and you assume all risks associated with its use,
+ * including but not limited to the risks and costs of program errors,
+ * compliance with applicable laws, damage to or loss of data, programs or
+ * equipment, and the unavailability or interruption of operation. This
+ * software is not intended to be used in any situation where a failure could
+ * cause risk of injury or damage to property. The software developed by NIST
+ * employees is not subject to copyright protection within the United States.
+ *
+ * Author: Evan Black <evan.black@nist.gov>
+ */
+
+
+#pragma once
+
+#include <QOpenGLFunctions_3_3_Core>
+#include <array>
+#include <cstddef>
+#include <limits>
+#include <optional>
+#include <utility>
+
+namespace netsimulyzer {
+
+/**
+ * Remembers the GL state set through it, and skips calls that would not change it.
+ * Everything drawing with the scene's context should bind through this,
+ * or call `invalidate()` after changing the state itself.
+ *
+ * `GL_ELEMENT_ARRAY_BUFFER` is not tracked, it belongs to the bound VAO.
+ * Bind it directly, after binding its VAO here
+ */
+class GlState : protected QOpenGLFunctions_3_3_Core {
+public:
+  /**
+   * Texture units with tracked bindings. Binds on higher units are always issued
+   */
+  static constexpr std::size_t textureUnits = 4u;
+
+private:
+  /**
+   * Marks a binding we know nothing about, so the next bind is always issued
+   */
+  static constexpr unsigned int unknown = std::numeric_limits<unsigned int>::max();
+
+  /**
+   * The buffer targets with tracked bindings
+   */
+  static constexpr std::array<unsigned int, 3> bufferTargets{GL_ARRAY_BUFFER, GL_UNIFORM_BUFFER, GL_TEXTURE_BUFFER};
+
+  /**
+   * The texture targets with tracked bindings, for each unit
+   */
+  static constexpr std::array<unsigned int, 4> textureTargets{GL_TEXTURE_2D, GL_TEXTURE_CUBE_MAP, GL_TEXTURE_BUFFER,
+                                                              GL_TEXTURE_2D_ARRAY};
+
+  /**
+   * The capabilities with tracked `glEnable()`/`glDisable()` state
+   */
+  static constexpr std::array<unsigned int, 6> capabilities{GL_BLEND,        GL_DEPTH_TEST,   GL_LINE_SMOOTH,
+                                                            GL_SCISSOR_TEST, GL_STENCIL_TEST, GL_CULL_FACE};
+
+  unsigned int program{unknown};
+  unsigned int vertexArray{unknown};
+  std::array<unsigned int, bufferTargets.size()> buffers{};
+  unsigned int activeUnit{unknown};
+  std::array<std::array<unsigned int, textureTargets.size()>, textureUnits> textures{};
+  std::array<std::optional<bool>, capabilities.size()> enabled{};
+  std::optional<std::pair<unsigned int, unsigned int>> blendFactors;
+  unsigned int blendMode{unknown};
+  std::optional<bool> depthWrite;
+
+  /**
+   * Count a call, as elided when `changed` is false
+   *
+   * @param changed
+   * If the call will be issued
+   *
+   * @return
+   * `changed`
+   */
+  static bool count(bool changed);
+
+  template <std::size_t N>
+  static std::optional<std::size_t> indexOf(const std::array<unsigned int, N> &values, unsigned int value) {
+    for (std::size_t i = 0u; i < N; i++) {
+      if (values[i] == value)
+        return i;
+    }
+    return {};
+  }
+
+  void activeTexture(unsigned int unit);
+  void setEnabled(unsigned int capability, bool value);
+
+public:
+  GlState();
+
+  /**
+   * Load the GL functions. Must be called with the scene's context current
+   */
+  void init();
+
+  /**
+   * Forget all remembered state, so the next change of each is issued.
+   * Call after anything outside of this class changes the state, e.g. `QPainter`
+   */
+  void invalidate();
+
+  void useProgram(unsigned int value);
+  void bindVertexArray(unsigned int value);
+  void bindBuffer(unsigned int target, unsigned int value);
+
+  /**
+   * Bind a texture to a texture unit, switching the active unit if needed.
+   * The active unit is left at `unit`
+   *
+   * @param unit
+   * The index of the unit, `0` for `GL_TEXTURE0`
+   *
+   * @param target
+   * Where to bind the texture on the unit, e.g. `GL_TEXTURE_2D`
+   *
+   * @param value
+   * The texture to bind
+   */
+  void bindTexture(unsigned int unit, unsigned int target, unsigned int value);
+
+  void enable(unsigned int capability);
+  void disable(unsigned int capability);
+  void blendFunc(unsigned int source, unsigned int destination);
+  void blendEquation(unsigned int mode);
+  void depthMask(bool value);
+
+  // Deleting a bound object unbinds it, and its name may be reused.
+  // Delete through these, so the old binding is not remembered
+  void deleteProgram(unsigned int value);
+  void deleteVertexArray(unsigned int value);
+  void deleteBuffer(unsigned int value);
+  void deleteTexture(unsigned int value);
+};
+
+/**
+ * State of the scene's context. Only touched from the thread with that context
+ */
+inline GlState glState;
+
+} // namespace netsimulyzer
@@ -0,0 +1,94 @@
+/*
+ * NIST-developed software is provided by NIST as a public service. You may use,
+ * copy and distribute copies of the software in any medium, provided that you
+ * keep intact this entire notice. You may improve,modify and create derivative
+ * works of the software or any portion of the software, and you may copy and
+ * distribute such modifications or works. Modified works should carry a notice
+ * stating that you changed the software and should note the date and nature of
+ * any such change. Please explicitly acknowledge the National Institute of
+ * Standards and Technology as the source of the software.
+ *
+ * NIST-developed software is expressly provided "AS IS." NIST MAKES NO
+ * WARRANTY OF ANY KIND, EXPRESS, IMPLIED, IN FACT OR ARISING BY OPERATION OF
+ * LAW, INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTY OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, NON-INFRINGEMENT
+ * AND DATA ACCURACY. NIST NEITHER REPRESENTS NOR WARRANTS THAT THE
+ * OPERATION OF THE SOFTWARE WILL BE UNINTERRUPTED OR ERROR-FREE, OR THAT
+ * ANY DEFECTS WILL BE CORRECTED. NIST DOES NOT WARRANT OR MAKE ANY
+ * REPRESENTATIONS REGARDING THE USE OF THE SOFTWARE OR THE RESULTS THEREOF,
+ * INCLUDING BUT NOT LIMITED TO THE CORRECTNESS, ACCURACY, RELIABILITY,
+ * OR USEFULNESS OF THE SOFTWARE.
+ *
+ * You are solely responsible for determining the appropriateness of using and
+ * distributing the software and you assume all risks associated with its use,
+ * including but not limited to the risks and costs of program errors,
+ * compliance with applicable laws, damage to or loss of data, programs or
+ * equipment, and the unavailability or interruption of operation. This
+ * software is not intended to be used in any situation where a failure could
+ * cause risk of injury or damage to property. The software developed by NIST
+ * employees is not subject to copyright protection within the United States.
+ *
+ * Author: Evan Black <evan.black@nist.gov>
+ */
+
+
+#include "RenderQueue.h"
+#include <algorithm>
+#include <cstring>
+
+namespace netsimulyzer {
+
+/**
+ * Clamp `value` to fit in `bits` bits
+ */
+static std::uint64_t field(std::uint64_t value, unsigned int bits) {
+  return std::min(value, (std::uint64_t{1u} << bits) - 1u);
+}
+
+std::uint64_t RenderQueue::key(RenderQueue::Pass pass, RenderQueue::Program program,
+                               std::optional<std::size_t> texture, std::size_t model, float depth) {
+  // The bits of a non-negative float sort in the same order as its value,
+  // so the top bits are a depth of reduced precision
+  std::uint32_t depthBitsValue;
+  depth = std::max(depth, 0.0f);
+  std::memcpy(&depthBitsValue, &depth, sizeof(depthBitsValue));
+  const auto quantizedDepth = std::uint64_t{depthBitsValue} >> (31u - depthBits);
+
+  // Untextured draws sort first
+  const auto textureValue = texture ? static_cast<std::uint64_t>(texture.value()) + 1u : 0u;
+
+  auto result = field(static_cast<std::uint64_t>(pass), passBits);
+  result = (result << programBits) | field(static_cast<std::uint64_t>(program), programBits);
+  result = (result << textureBits) | field(textureValue, textureBits);
+  result = (result << modelBits) | field(model, modelBits);
+  result = (result << depthBits) | field(quantizedDepth, depthBits);
+  return result;
+}
+
+RenderQueue::Pass RenderQueue::passOf(std::uint64_t key) {
+  return static_cast<Pass>(key >> (64u - passBits));
+}
+
+void RenderQueue::submit(const RenderQueue::Item &item) {
+  items.emplace_back(item);
+}
+
+void RenderQueue::sort() {
+  std::sort(items.begin(), items.end(), [](const Item &left, const Item &right) {
+    return left.key < right.key;
+  });
+}
+
+void RenderQueue::clear() {
+  items.clear();
+}
+
+const std::vector<RenderQueue::Item> &RenderQueue::getItems() const {
+  return items;
+}
+
+bool RenderQueue::empty() const {
+  return items.empty();
+}
+
+} // namespace netsimulyzer
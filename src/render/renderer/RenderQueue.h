@@ -0,0 +1,172 @@
+/*
+ * NIST-developed software is provided by NIST as a public service. You may use,
+ * copy and distribute copies of the software in any medium, provided that you
+ * keep intact this entire notice. You may improve,modify and create derivative
+ * works of the software or any portion of the software, and you may copy and
+ * distribute such modifications or works. Modified works should carry a notice
+ * stating that you changed the software and should note the date and nature of
+ * any such change. Please explicitly acknowledge the National Institute of
+ * Standards and Technology as the source of the software.
+ *
+ * NIST-developed software is expressly provided "AS IS." NIST MAKES NO
+ * WARRANTY OF ANY KIND, EXPRESS, IMPLIED, IN FACT OR ARISING BY OPERATION OF
+ * LAW, INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTY OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, NON-INFRINGEMENT
+ * AND DATA ACCURACY. NIST NEITHER REPRESENTS NOR WARRANTS THAT THE
+ * OPERATION OF THE SOFTWARE WILL BE UNINTERRUPTED OR ERROR-FREE, OR THAT
+ * ANY DEFECTS WILL BE CORRECTED. NIST DOES NOT WARRANT OR MAKE ANY
+ * REPRESENTATIONS REGARDING THE USE OF THE SOFTWARE OR THE RESULTS THEREOF,
+ * INCLUDING BUT NOT LIMITED TO THE CORRECTNESS, ACCURACY, RELIABILITY,
+ * OR USEFULNESS OF THE SOFTWARE.
+ *
+ * You are solely responsible for determining the appropriateness of using and
+ * distributing the software and you assume all risks associated with its use,
+ * including but not limited to the risks and costs of program errors,
+ * compliance with applicable laws, damage to or loss of data, programs or
+ * equipment, and the unavailability or interruption of operation. This
+ * software is not intended to be used in any situation where a failure could
+ * cause risk of injury or damage to property. The software developed by NIST
+ * employees is not subject to copyright protection within the United States.
+ *
+ * Author: Evan Black <evan.black@nist.gov>
+ */
+
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <optional>
+#include <vector>
+
+namespace netsimulyzer {
+
+class Mesh;
+
+/**
+ * Mesh draws collected over a frame, then sorted so draws
+ * sharing a program, texture & model are issued together.
+ * State changes then scale with the number of materials,
+ * rather than the number of objects
+ */
+class RenderQueue {
+public:
+  /**
+   * Most significant part of the sort key. Passes are drawn in this order
+   */
+  enum class Pass : std::uint64_t { Opaque, Transparent };
+
+  /**
+   * The variant of the model shader used by a draw
+   */
+  enum class Program : std::uint64_t { Model, ModelInstanced };
+
+  struct Item {
+    /**
+     * Built by `key()`
+     */
+    std::uint64_t key{0u};
+    Mesh *mesh{nullptr};
+
+    /**
+     * The texture to bind, unset for `color` instead
+     */
+    std::optional<std::size_t> texture;
+
+    /**
+     * The value for `material_color`, unset to leave it alone
+     */
+    std::optional<glm::vec3> color;
+
+    /**
+     * The value for `material_type`, only read by instanced draws
+     */
+    unsigned int materialType{0u};
+
+    /**
+     * Only used by uninstanced draws
+     */
+    glm::mat4 model{1.0f};
+    bool useLighting{true};
+
+    /**
+     * The range of instances to draw from the instance buffer.
+     * A `count` of 0 is an uninstanced draw
+     */
+    std::size_t first{0u};
+    int count{0};
+
+    /**
+     * A buffer of placements to draw the mesh at, see `Mesh::renderPlaced()`.
+     * 0 to draw with `model` instead
+     */
+    unsigned int placements{0u};
+    std::size_t firstPlacement{0u};
+    int placementCount{0};
+  };
+
+private:
+  // Sizes of each field of the key, in bits, from the most significant
+  static constexpr unsigned int passBits = 2u;
+  static constexpr unsigned int programBits = 4u;
+  static constexpr unsigned int textureBits = 18u;
+  static constexpr unsigned int modelBits = 20u;
+  static constexpr unsigned int depthBits = 20u;
+  static_assert(passBits + programBits + textureBits + modelBits + depthBits == 64u);
+
+  std::vector<Item> items;
+
+public:
+  /**
+   * Build a sort key.
+   * Fields wider than their part of the key are clamped
+   *
+   * @param pass
+   * The pass the draw belongs to
+   *
+   * @param program
+   * The shader variant drawing the item
+   *
+   * @param texture
+   * The texture used by the draw, unset for none
+   *
+   * @param model
+   * The model the mesh belongs to
+   *
+   * @param depth
+   * The distance from the camera, non-negative.
+   * Nearer draws sort first
+   *
+   * @return
+   * A key sorting in the order above
+   */
+  [[nodiscard]] static std::uint64_t key(Pass pass, Program program, std::optional<std::size_t> texture,
+                                         std::size_t model, float depth);
+
+  /**
+   * @param key
+   * A key from `key()`
+   *
+   * @return
+   * The pass `key` was built with
+   */
+  [[nodiscard]] static Pass passOf(std::uint64_t key);
+
+  void submit(const Item &item);
+
+  /**
+   * Order the submitted items by their keys
+   */
+  void sort();
+
+  /**
+   * Remove every item, keeping the allocation for the next frame
+   */
+  void clear();
+
+  [[nodiscard]] const std::vector<Item> &getItems() const;
+  [[nodiscard]] bool empty() const;
+};
+
+} // namespace netsimulyzer
@@ -32,20 +32,99 @@
  */
 
 #include "Renderer.h"
-#include "../../conversion.h"
+#include "../../util/common-times.h"
 #include "../material/material.h"
+#include "../render-stats.h"
+#include "GlState.h"
+#include "UploadRing.h"
 #include <QFile>
 #include <QMessageBox>
+#include <QOpenGLContext>
 #include <QString>
 #include <QTextStream>
+#include <algorithm>
 #include <array>
 #include <cassert>
 #include <glm/glm.hpp>
 #include <glm/gtc/type_ptr.hpp>
+#include <utility>
 #include <vector>
 
 namespace netsimulyzer {
 
+/**
+ * Convert a span of simulation time to the milliseconds used by the transmission & Node shaders
+ */
+static float toMilliseconds(parser::nanoseconds time) {
+  return static_cast<float>(static_cast<double>(time) / static_cast<double>(MILLISECOND));
+}
+
+/**
+ * The color a mesh with `material` is drawn in, unset for textured meshes
+ */
+static std::optional<glm::vec3> materialColor(const Material &material, const std::optional<glm::vec3> &baseColor,
+                                              const std::optional<glm::vec3> &highlightColor) {
+  if (material.textureId || !material.color)
+    return {};
+
+  const auto &color = material.color.value();
+  switch (material.materialType) {
+  case Material::MaterialType::Base:
+    return baseColor.value_or(color);
+  case Material::MaterialType::Highlight:
+    return highlightColor.value_or(color);
+  case Material::MaterialType::Unclassified:
+    [[fallthrough]];
+  default:
+    return color;
+  }
+}
+
+/**
+ * The value of `material_type` in the model shader,
+ * which picks the instance color to use
+ */
+static unsigned int materialType(const Material &material) {
+  switch (material.materialType) {
+  case Material::MaterialType::Base:
+    return 1u;
+  case Material::MaterialType::Highlight:
+    return 2u;
+  case Material::MaterialType::Unclassified:
+    [[fallthrough]];
+  default:
+    return 0u;
+  }
+}
+
+/**
+ * Find the end of the run of items starting at `begin` which may be drawn by one indirect draw.
+ * Only instanced arena meshes drawn once per Node, sharing every uniform & the index type may be in the same run
+ *
+ * @return
+ * One past the last item in the run, `begin + 1` for items drawn on their own
+ */
+static std::size_t indirectRunEnd(const std::vector<RenderQueue::Item> &items, std::size_t begin) {
+  const auto &first = items[begin];
+  auto end = begin + 1;
+
+  // Meshes without a buffer of their own live in the arena
+  if (first.count < 1 || first.mesh->getRenderInfo().vbo != 0u || first.mesh->hasReferences())
+    return end;
+
+  for (; end < items.size(); end++) {
+    const auto &item = items[end];
+    if (item.count < 1 || item.mesh->getRenderInfo().vbo != 0u || item.mesh->hasReferences() ||
+        item.mesh->getRenderInfo().indexType != first.mesh->getRenderInfo().indexType ||
+        RenderQueue::passOf(item.key) != RenderQueue::passOf(first.key) || item.texture != first.texture ||
+        item.color != first.color || item.materialType != first.materialType ||
+        item.useLighting != first.useLighting)
+      break;
+  }
+
+  return end;
+}
+
 void Renderer::initShader(Shader &s, const QString &vertexPath, const QString &fragmentPath) {
   QFile vertexFile{vertexPath};
   if (!vertexFile.open(QFile::ReadOnly | QFile::Text)) {
@@ -61,352 +140,365 @@ void Renderer::initShader(Shader &s, const QString &vertexPath, const QString &f
   }
   auto fragmentSrc = QTextStream{&fragmentFile}.readAll().toStdString();
 
-  s.init(vertexSrc, fragmentSrc);
+  QFile frameFile{":/shader/shaders/frame.glsl"};
+  if (!frameFile.open(QFile::ReadOnly | QFile::Text)) {
+    QMessageBox::critical(nullptr, "Failed to open shader file", "Failed to open shader file frame.glsl");
+    std::abort();
+  }
+  const auto frameSrc = QTextStream{&frameFile}.readAll().toStdString();
+
+  // The block must follow the `#version` line, which is always the first
+  const auto insertFrame = [&frameSrc](std::string &src) {
+    const auto versionEnd = src.find('\n');
+    src.insert(versionEnd == std::string::npos ? src.size() : versionEnd + 1u, frameSrc);
+  };
+  insertFrame(vertexSrc);
+  insertFrame(fragmentSrc);
+
+  // Finished in `init()`, once every program is started
+  s.start(vertexSrc, fragmentSrc);
+}
+
+void Renderer::uploadFrameUniforms() {
+  glState.bindBuffer(GL_UNIFORM_BUFFER, frameUbo);
+  glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(FrameUniforms), &frameUniforms);
+  stats::frameCounters.bufferUploads++;
 }
 
 Renderer::Renderer(ModelCache &modelCache, TextureCache &textureCache, FontManager &fontManager)
     : modelCache(modelCache), textureCache(textureCache), fontManager(fontManager) {
 }
 
+std::size_t Renderer::levelOfDetail(const ModelRenderInfo &renderInfo, const glm::mat4 &modelMatrix) const {
+  if (renderInfo.levelCount() == 1u)
+    return 0u;
+
+  const auto &bounds = renderInfo.getBounds();
+  const auto center = glm::vec3{modelMatrix * glm::vec4{(bounds.min + bounds.max) * 0.5f, 1.0f}};
+  const auto radius = glm::length(glm::mat3{modelMatrix} * ((bounds.max - bounds.min) * 0.5f));
+  const auto distance = glm::distance(center, eyePosition);
+
+  // Inside the model, or close enough to always need full detail
+  if (distance <= radius)
+    return 0u;
+
+  const auto screenHeight = radius * projectionScale / distance;
+  for (std::size_t level = 0u; level < levelScreenHeights.size(); level++) {
+    if (screenHeight >= levelScreenHeights[level])
+      return level;
+  }
+
+  return std::min(levelScreenHeights.size(), renderInfo.levelCount() - 1u);
+}
+
 void Renderer::init() {
   initializeOpenGLFunctions();
 
-  initShader(areaShader, ":shader/shaders/area.vert", ":shader/shaders/area.frag");
-  initShader(buildingShader, ":shader/shaders/building.vert", ":shader/shaders/building.frag");
+  // Meshes referenced once are drawn where their vertices are,
+  // see `Mesh::referenceLocation`
+  for (auto column = 0u; column < 4u; column++) {
+    glm::vec4 identity{0.0f};
+    identity[static_cast<glm::length_t>(column)] = 1.0f;
+    glVertexAttrib4f(Mesh::referenceLocation + column, identity.x, identity.y, identity.z, identity.w);
+  }
 
-  initShader(gridShader, ":shader/shaders/grid.vert", ":shader/shaders/grid.frag");
-  gridShader.uniform("discard_distance", 250.0f);
-  gridShader.uniform("height", -0.001f);
+  auto context = QOpenGLContext::currentContext();
+
+  // Let the driver use as many threads as it likes to compile the programs below
+  constexpr std::array<std::pair<const char *, const char *>, 2u> parallelCompile{
+      {{"GL_KHR_parallel_shader_compile", "glMaxShaderCompilerThreadsKHR"},
+       {"GL_ARB_parallel_shader_compile", "glMaxShaderCompilerThreadsARB"}}};
+  for (const auto &[extension, function] : parallelCompile) {
+    using MaxThreads = void(QOPENGLF_APIENTRYP)(GLuint);
+    const auto maxThreads =
+        context->hasExtension(extension) ? reinterpret_cast<MaxThreads>(context->getProcAddress(function)) : nullptr;
+    if (maxThreads) {
+      maxThreads(0xFFFFFFFFu);
+      break;
+    }
+  }
 
+  initShader(staticShader, ":shader/shaders/static.vert", ":shader/shaders/static.frag");
+  initShader(buildingShader, ":shader/shaders/building.vert", ":shader/shaders/building.frag");
+  initShader(gridShader, ":shader/shaders/grid.vert", ":shader/shaders/grid.frag");
   initShader(modelShader, ":shader/shaders/model.vert", ":shader/shaders/model.frag");
   initShader(skyBoxShader, ":shader/shaders/skybox.vert", ":shader/shaders/skybox.frag");
   initShader(pickingShader, ":/shader/shaders/picking.vert", ":/shader/shaders/picking.frag");
   initShader(fontShader, ":/shader/shaders/font.vert", ":/shader/shaders/font.frag");
   initShader(fontBackgroundShader, ":/shader/shaders/font_bg.vert", ":/shader/shaders/font_bg.frag");
-}
+  initShader(transmissionShader, ":/shader/shaders/transmission.vert", ":/shader/shaders/transmission.frag");
+  initShader(upscaleShader, ":/shader/shaders/upscale.vert", ":/shader/shaders/upscale.frag");
+  initShader(heatmapSplatShader, ":/shader/shaders/heatmap_splat.vert", ":/shader/shaders/heatmap_splat.frag");
+  initShader(heatmapShader, ":/shader/shaders/heatmap.vert", ":/shader/shaders/heatmap.frag");
+  initShader(minimapShader, ":/shader/shaders/minimap.vert", ":/shader/shaders/minimap.frag");
+  initShader(trajectoryShader, ":/shader/shaders/trajectory.vert", ":/shader/shaders/trajectory.frag");
+  initShader(occlusionShader, ":/shader/shaders/occlusion.vert", ":/shader/shaders/occlusion.frag");
+  initShader(probeShader, ":/shader/shaders/upscale.vert", ":/shader/shaders/probe.frag");
+
+  for (auto shader : {&staticShader, &buildingShader, &gridShader, &modelShader, &skyBoxShader, &pickingShader,
+                      &fontShader, &fontBackgroundShader, &transmissionShader, &upscaleShader, &heatmapSplatShader,
+                      &heatmapShader, &minimapShader, &trajectoryShader, &occlusionShader, &probeShader}) {
+    shader->finish();
+    shader->bindBlock("Frame", frameBinding);
+  }
 
-void Renderer::setPerspective(const glm::mat4 &perspective) {
-  areaShader.uniform("projection", perspective);
-  buildingShader.uniform("projection", perspective);
-  gridShader.uniform("projection", perspective);
-  modelShader.uniform("projection", perspective);
-  skyBoxShader.uniform("projection", perspective);
-  pickingShader.uniform("projection", perspective);
-  fontShader.uniform("projection", perspective);
-  fontBackgroundShader.uniform("projection", perspective);
+  gridShader.uniform("discard_distance", 250.0f);
+  gridShader.uniform("height", -0.001f);
+  upscaleShader.uniform("scene", 0);
+  glGenVertexArrays(1, &emptyVao);
+
+  // Label anchors are read from texture unit 1, the atlas stays on 0
+  fontShader.uniform("anchors", 1);
+  fontBackgroundShader.uniform("anchors", 1);
+
+  // Node data is read from texture unit 2
+  modelShader.uniform("node_data", 2);
+  pickingShader.uniform("node_data", 2);
+  heatmapSplatShader.uniform("node_data", 2);
+  minimapShader.uniform("node_data", 2);
+  heatmapShader.uniform("density", 0);
+
+  // Packed model textures are read from texture unit 3
+  modelShader.uniform("texture_array_sampler", 3);
+
+  // The lights & their clusters are read from texture units 4 & 5
+  modelShader.uniform("lights", 4);
+  modelShader.uniform("light_clusters", 5);
+
+  modelUniforms.model = modelShader.location("model");
+  modelUniforms.isSelected = modelShader.location("is_selected");
+  modelUniforms.selectedObject = modelShader.location("selected_object");
+  modelUniforms.hasSelectedObject = modelShader.location("has_selected_object");
+  modelUniforms.useLighting = modelShader.location("useLighting");
+  modelUniforms.instanced = modelShader.location("instanced");
+  modelUniforms.material.useTexture = modelShader.location("useTexture");
+  modelUniforms.material.textureLayer = modelShader.location("texture_layer");
+  modelUniforms.material.materialColor = modelShader.location("material_color");
+  modelUniforms.material.materialType = modelShader.location("material_type");
+
+  glGenBuffers(1, &frameUbo);
+  glState.bindBuffer(GL_UNIFORM_BUFFER, frameUbo);
+  glBufferData(GL_UNIFORM_BUFFER, sizeof(FrameUniforms), &frameUniforms, GL_DYNAMIC_DRAW);
+  glBindBufferBase(GL_UNIFORM_BUFFER, frameBinding, frameUbo);
+
+  glGenBuffers(1, &nodeDataVbo);
+  glState.bindBuffer(GL_TEXTURE_BUFFER, nodeDataVbo);
+  glBufferData(GL_TEXTURE_BUFFER, sizeof(NodeData), nullptr, GL_DYNAMIC_DRAW);
+  nodeDataCapacity = 1u;
+
+  glGenTextures(1, &nodeDataTexture);
+  glState.bindTexture(2u, GL_TEXTURE_BUFFER, nodeDataTexture);
+  glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, nodeDataVbo);
+
+  // Without any lights until the first `uploadLights()`
+  const auto &emptyClusters = lightClusters.getTable();
+  glGenBuffers(1, &lightVbo);
+  glState.bindBuffer(GL_TEXTURE_BUFFER, lightVbo);
+  glBufferData(GL_TEXTURE_BUFFER, sizeof(PointLight), nullptr, GL_STREAM_DRAW);
+  glGenBuffers(1, &clusterVbo);
+  glState.bindBuffer(GL_TEXTURE_BUFFER, clusterVbo);
+  glBufferData(GL_TEXTURE_BUFFER, static_cast<GLsizeiptr>(sizeof(std::uint32_t) * emptyClusters.size()),
+               emptyClusters.data(), GL_STREAM_DRAW);
+
+  glGenTextures(1, &lightTexture);
+  glState.bindTexture(4u, GL_TEXTURE_BUFFER, lightTexture);
+  glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, lightVbo);
+  glGenTextures(1, &clusterTexture);
+  glState.bindTexture(5u, GL_TEXTURE_BUFFER, clusterTexture);
+  glTexBuffer(GL_TEXTURE_BUFFER, GL_R32UI, clusterVbo);
+
+  glGenBuffers(1, &nodeInstanceVbo);
+  glGenBuffers(1, &transmissionInstanceVbo);
+
+  // Only the center & the span of each transmission, as points
+  glGenVertexArrays(1, &heatmapVao);
+  glState.bindVertexArray(heatmapVao);
+  glState.bindBuffer(GL_ARRAY_BUFFER, transmissionInstanceVbo);
+  glEnableVertexAttribArray(0);
+  glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Mesh::TransmissionInstance),
+                        reinterpret_cast<void *>(offsetof(Mesh::TransmissionInstance, center)));
+  glEnableVertexAttribArray(1);
+  glVertexAttribPointer(1, 1, GL_FLOAT, GL_FALSE, sizeof(Mesh::TransmissionInstance),
+                        reinterpret_cast<void *>(offsetof(Mesh::TransmissionInstance, startTime)));
+  glEnableVertexAttribArray(2);
+  glVertexAttribPointer(2, 1, GL_FLOAT, GL_FALSE, sizeof(Mesh::TransmissionInstance),
+                        reinterpret_cast<void *>(offsetof(Mesh::TransmissionInstance, duration)));
+  glState.bindVertexArray(0u);
+
+  glGenBuffers(1, &labelAnchorVbo);
+  glState.bindBuffer(GL_TEXTURE_BUFFER, labelAnchorVbo);
+  glBufferData(GL_TEXTURE_BUFFER, sizeof(glm::vec4), nullptr, GL_STREAM_DRAW);
+
+  glGenTextures(1, &labelAnchorTexture);
+  glState.bindTexture(1u, GL_TEXTURE_BUFFER, labelAnchorTexture);
+  glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, labelAnchorVbo);
+
+  // The context is only guaranteed to be 3.3, so the indirect path is optional
+  if (context->format().version() >= qMakePair(4, 3)) {
+    indirectGl = context->versionFunctions<QOpenGLFunctions_4_3_Core>();
+    if (indirectGl && indirectGl->initializeOpenGLFunctions()) {
+      backend = Backend::Indirect43;
+      glGenBuffers(1, &indirectBuffer);
+    } else
+      indirectGl = nullptr;
+  }
 }
 
-void Renderer::setPointLightCount(unsigned int count) {
-  if (count > maxPointLights)
-    assert(!"Point light count set higher than defined max");
-  modelShader.uniform("pointLightCount", count);
+Renderer::Backend Renderer::getBackend() const {
+  return backend;
 }
 
-void Renderer::setSpotLightCount(unsigned int count) {
-  if (count > maxSpotLights)
-    assert(!"Spot light count set higher than defined max");
-  modelShader.uniform("spotLightCount", count);
+std::size_t Renderer::getGpuBytes() const {
+  return sizeof(FrameUniforms) + nodeDataCapacity * sizeof(NodeData) + nodeInstances.size() * sizeof(Mesh::Instance) +
+         transmissionInstances.size() * sizeof(Mesh::TransmissionInstance) + labelAnchors.size() * sizeof(glm::vec4) +
+         indirectCommands.size() * sizeof(DrawCommand) + staticVertices.capacity + staticIndices.capacity +
+         wiredLinkVertices.capacity + decorationPlacements.capacity;
 }
 
-TrailBuffer Renderer::allocateTrailBuffer(QOpenGLFunctions_3_3_Core *openGl, int size) {
-  const auto vertexSize = sizeof(float) * 3;
-
-  // Vao
-  unsigned int vao;
-  openGl->glGenVertexArrays(1, &vao);
-  openGl->glBindVertexArray(vao);
-
-  // Vbo
-  unsigned int vbo;
-  openGl->glGenBuffers(1, &vbo);
-  openGl->glBindBuffer(GL_ARRAY_BUFFER, vbo);
-  openGl->glBufferData(GL_ARRAY_BUFFER, vertexSize * size, nullptr, GL_DYNAMIC_DRAW);
-
-  // Location
-  openGl->glVertexAttribPointer(0u, 3, GL_FLOAT, GL_FALSE, sizeof(float) * 3, nullptr);
-  openGl->glEnableVertexAttribArray(0u);
-
-  TrailBuffer buffer{openGl, vao, vbo, size, vertexSize};
-  return buffer;
+void Renderer::upload(RetainedBuffer &buffer, unsigned int target, std::size_t bytes, const void *data,
+                      unsigned int usage) {
+  if (buffer.name == 0u)
+    glGenBuffers(1, &buffer.name);
+
+  if (target == GL_ELEMENT_ARRAY_BUFFER)
+    glBindBuffer(target, buffer.name);
+  else
+    glState.bindBuffer(target, buffer.name);
+
+  // A quarter spare, so a slightly larger scenario still fits next time
+  if (bytes > buffer.capacity)
+    buffer.capacity = bytes + bytes / 4u;
+
+  // Orphan the old contents, the last frame may still be reading them
+  glBufferData(target, static_cast<GLsizeiptr>(buffer.capacity), nullptr, usage);
+  if (data != nullptr && bytes > 0u)
+    glBufferSubData(target, 0, static_cast<GLsizeiptr>(bytes), data);
+  stats::frameCounters.bufferUploads++;
 }
 
-Building::RenderInfo Renderer::allocate(const parser::Building &building) {
-  Building::RenderInfo info;
-
-  auto min = toRenderCoordinate(building.min);
-  auto max = toRenderCoordinate(building.max);
-
-  // clang-format off
-  std::vector<float> vertices{
-      min.x, min.y, min.z, // 0
-      max.x, min.y, min.z, // 1
-      max.x, min.y, max.z, // 2
-      min.x, min.y, max.z, // 3
-      min.x, max.y, min.z, // 4
-      max.x, max.y, min.z, // 5
-      max.x, max.y, max.z, // 6
-      min.x, max.y, max.z  // 7
-  };
-  std::vector<unsigned int> indices{
-      0u, 1u, 2u,
-      3u, 0u, 2u,
-      1u, 5u, 6u,
-      2u, 1u, 6u,
-      4u, 5u, 6u,
-      7u, 4u, 6u,
-      0u, 4u, 7u,
-      3u, 0u, 7u,
-      0u, 1u, 5u,
-      4u, 0u, 5u,
-      3u, 2u, 6u,
-      7u, 3u, 6u
-  };
-  // clang-format on
-
-  auto last_index = 7u;
-
-  glGenVertexArrays(1, &info.vao);
-  glBindVertexArray(info.vao);
-
-  // Floors
-  //   All floors are exactly the same height
-  //   abs() just in case our coordinates are negative
-  const auto floor_height = (std::abs(max.y) - std::abs(min.y)) / static_cast<float>(building.floors);
-  for (auto currentFloor = 1; currentFloor < building.floors; currentFloor++) {
-    const auto currentHeight = floor_height * currentFloor + min.y;
-
-    vertices.insert(vertices.end(), {min.x, currentHeight, min.z});
-    vertices.insert(vertices.end(), {max.x, currentHeight, min.z});
-    vertices.insert(vertices.end(), {max.x, currentHeight, max.z});
-    vertices.insert(vertices.end(), {min.x, currentHeight, max.z});
-
-    // 0, 1, 2, 3, 0, 2
-    indices.insert(indices.end(),
-                   {last_index + 1, last_index + 2, last_index + 3, last_index + 4, last_index + 1, last_index + 3});
-    last_index += 4;
-  }
-
-  // Walls
-  // X
-
-  // Find the size of each room
-  auto roomLengthX = (max.x - min.x) / static_cast<float>(building.roomsX);
-
-  for (auto currentRoom = 1; currentRoom < building.roomsX; currentRoom++) {
-    auto currentWallPosition = roomLengthX * currentRoom + min.x;
-
-    vertices.insert(vertices.end(), {currentWallPosition, min.y, min.z});
-    vertices.insert(vertices.end(), {currentWallPosition, max.y, min.z});
-    vertices.insert(vertices.end(), {currentWallPosition, max.y, max.z});
-    vertices.insert(vertices.end(), {currentWallPosition, min.y, max.z});
+void Renderer::setPerspective(const glm::mat4 &perspective) {
+  projectionScale = perspective[1][1];
+  frameUniforms.projection = perspective;
+  uploadFrameUniforms();
+}
 
-    // 0, 1, 2, 3, 0, 2
-    indices.insert(indices.end(),
-                   {last_index + 1, last_index + 2, last_index + 3, last_index + 4, last_index + 1, last_index + 3});
-    last_index += 4;
-  }
+void Renderer::uploadLights(const std::vector<PointLight> &lights) {
+  lightClusters.bin(lights, frameUniforms.view, frameUniforms.projection);
+  const auto &table = lightClusters.getTable();
+
+  // Orphan the previous contents, rather than waiting on draws still using them.
+  // Never empty, so the texture always has a store
+  glState.bindBuffer(GL_TEXTURE_BUFFER, lightVbo);
+  glBufferData(GL_TEXTURE_BUFFER, static_cast<GLsizeiptr>(sizeof(PointLight) * std::max<std::size_t>(1u, lights.size())),
+               nullptr, GL_STREAM_DRAW);
+  if (!lights.empty())
+    glBufferSubData(GL_TEXTURE_BUFFER, 0, static_cast<GLsizeiptr>(sizeof(PointLight) * lights.size()), lights.data());
+
+  glState.bindBuffer(GL_TEXTURE_BUFFER, clusterVbo);
+  glBufferData(GL_TEXTURE_BUFFER, static_cast<GLsizeiptr>(sizeof(std::uint32_t) * table.size()), table.data(),
+               GL_STREAM_DRAW);
+  stats::frameCounters.bufferUploads += 2u;
+
+  glState.bindTexture(4u, GL_TEXTURE_BUFFER, lightTexture);
+  glState.bindTexture(5u, GL_TEXTURE_BUFFER, clusterTexture);
+
+  modelShader.uniform("light_count", static_cast<unsigned int>(lights.size()));
+  modelShader.uniform("cluster_near", lightClusters.getNear());
+  modelShader.uniform("cluster_far", lightClusters.getFar());
+}
 
-  // Y (Z in OpenGl coordinates)
-  auto roomLengthY = (max.z - min.z) / static_cast<float>(building.roomsY);
+void Renderer::allocate(StaticGeometry &geometry) {
+  const auto &vertices = geometry.getVertices();
+  const auto indices = geometry.mergedIndices();
 
-  for (auto currentRoom = 1; currentRoom < building.roomsY; currentRoom++) {
-    auto currentWallPosition = roomLengthY * currentRoom + min.z;
+  // The layout only points at the retained buffers, so is set once
+  const auto created = staticGeometryVao == 0u;
+  if (created)
+    glGenVertexArrays(1, &staticGeometryVao);
+  glState.bindVertexArray(staticGeometryVao);
 
-    vertices.insert(vertices.end(), {min.x, min.y, currentWallPosition});
-    vertices.insert(vertices.end(), {max.x, min.y, currentWallPosition});
-    vertices.insert(vertices.end(), {max.x, max.y, currentWallPosition});
-    vertices.insert(vertices.end(), {min.x, max.y, currentWallPosition});
+  upload(staticIndices, GL_ELEMENT_ARRAY_BUFFER, sizeof(unsigned int) * indices.size(), indices.data(),
+         GL_STATIC_DRAW);
+  upload(staticVertices, GL_ARRAY_BUFFER, sizeof(StaticGeometry::Vertex) * vertices.size(), vertices.data(),
+         GL_STATIC_DRAW);
 
-    // 0, 1, 2, 3, 0, 2
-    indices.insert(indices.end(),
-                   {last_index + 1, last_index + 2, last_index + 3, last_index + 4, last_index + 1, last_index + 3});
-    last_index += 4;
-  }
+  if (created)
+    setStaticAttributes();
 
-  info.ibo_size = indices.size();
+  glState.bindVertexArray(0u);
+  geometry.uploaded({staticGeometryVao, staticVertices.name, staticIndices.name});
+}
 
-  glGenBuffers(1, &info.ibo);
-  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, info.ibo);
-  glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(unsigned int) * indices.size(), indices.data(), GL_STATIC_DRAW);
+void Renderer::allocateTile(StaticGeometry &geometry) {
+  const auto &vertices = geometry.getVertices();
+  const auto indices = geometry.mergedIndices();
+  const auto vertexBytes = sizeof(StaticGeometry::Vertex) * vertices.size();
+  const auto indexBytes = sizeof(unsigned int) * indices.size();
 
+  StaticGeometry::RenderInfo info;
+  glGenVertexArrays(1, &info.vao);
   glGenBuffers(1, &info.vbo);
-  glBindBuffer(GL_ARRAY_BUFFER, info.vbo);
-  glBufferData(GL_ARRAY_BUFFER, sizeof(float) * vertices.size(), vertices.data(), GL_STATIC_DRAW);
-
-  // Location
-  glVertexAttribPointer(0u, 3, GL_FLOAT, GL_FALSE, sizeof(float) * 3, nullptr);
-  glEnableVertexAttribArray(0u);
-
-  // Border Lines
-
-  // add a very slight offset
-  // so lines do not directly
-  // intersect the walls
-  const float offset = 0.01f;
-
-  // clang-format off
-  const std::array<float, 24> borderVertices {
-      min.x - offset, min.y - offset, min.z - offset, // 0
-      max.x + offset, min.y - offset, min.z - offset, // 1
-      max.x + offset, min.y - offset, max.z + offset, // 2
-      min.x - offset, min.y - offset, max.z + offset, // 3
-      min.x - offset, max.y + offset, min.z - offset, // 4
-      max.x + offset, max.y + offset, min.z - offset, // 5
-      max.x + offset, max.y + offset, max.z + offset, // 6
-      min.x - offset, max.y + offset, max.z + offset  // 7
-  };
-  const std::array<unsigned int, 24> lineIndices {
-      0u, 1u, // Bottom
-      1u, 2u,
-      2u, 3u,
-      3u, 0u,
-      4u, 5u, // Top
-      5u, 6u,
-      6u, 7u,
-      7u, 4u,
-      0u, 4u, // Sides
-      1u, 5u,
-      2u, 6u,
-      3u, 7u,
-  };
-  // clang-format on
-
-  glGenVertexArrays(1, &info.lineVao);
-  glBindVertexArray(info.lineVao);
-
-  info.lineIboSize = lineIndices.size();
+  glGenBuffers(1, &info.ibo);
+  glState.bindVertexArray(info.vao);
 
-  glGenBuffers(1, &info.lineIbo);
-  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, info.lineIbo);
-  glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(unsigned int) * lineIndices.size(), lineIndices.data(), GL_STATIC_DRAW);
+  // Only sized here, the contents are copied from the staging buffers once `uploadRing` is flushed
+  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, info.ibo);
+  glBufferData(GL_ELEMENT_ARRAY_BUFFER, static_cast<GLsizeiptr>(indexBytes), nullptr, GL_STATIC_DRAW);
+  glState.bindBuffer(GL_ARRAY_BUFFER, info.vbo);
+  glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(vertexBytes), nullptr, GL_STATIC_DRAW);
+  setStaticAttributes();
+  glState.bindVertexArray(0u);
+
+  uploadRing.write(info.ibo, 0u, indices.data(), indexBytes);
+  uploadRing.write(info.vbo, 0u, vertices.data(), vertexBytes);
+  geometry.uploaded(info);
+}
 
-  glGenBuffers(1, &info.lineVbo);
-  glBindBuffer(GL_ARRAY_BUFFER, info.lineVbo);
-  glBufferData(GL_ARRAY_BUFFER, sizeof(float) * borderVertices.size(), borderVertices.data(), GL_STATIC_DRAW);
+void Renderer::releaseTile(StaticGeometry &geometry) {
+  const auto &info = geometry.getRenderInfo();
+  glState.deleteVertexArray(info.vao);
+  glState.deleteBuffer(info.vbo);
+  glState.deleteBuffer(info.ibo);
+}
 
+void Renderer::setStaticAttributes() {
   // Location
-  glVertexAttribPointer(0u, 3, GL_FLOAT, GL_FALSE, sizeof(float) * 3, nullptr);
+  glVertexAttribPointer(0u, 3, GL_FLOAT, GL_FALSE, sizeof(StaticGeometry::Vertex),
+                        reinterpret_cast<void *>(offsetof(StaticGeometry::Vertex, position)));
   glEnableVertexAttribArray(0u);
 
-  return info;
+  // Color
+  glVertexAttribPointer(1u, 3, GL_FLOAT, GL_FALSE, sizeof(StaticGeometry::Vertex),
+                        reinterpret_cast<void *>(offsetof(StaticGeometry::Vertex, color)));
+  glEnableVertexAttribArray(1u);
 }
 
-Area::RenderInfo Renderer::allocate(const parser::Area &area) {
-  Area::RenderInfo info;
-
-  // Convert to OpenGl coordinates
-  // for easier reading later
-  // Also handle the fill
-  std::vector<glm::vec3> convertedPoints;
-  convertedPoints.reserve(area.points.size());
-  for (const auto &point : area.points) {
-    auto converted = toRenderCoordinate(point);
-    convertedPoints.emplace_back(converted);
-
-    // Handle the fill vertexes
-    // since we're already looping through all the points
-  }
-
-  using DrawMode = parser::Area::DrawMode;
-
-  // Fill
-  info.renderFill = area.fillMode == DrawMode::Solid;
-  if (info.renderFill) {
-    std::vector<float> fillVertices;
-    fillVertices.reserve(area.points.size() * 3uL);
-
-    for (const auto &point : convertedPoints) {
-      // It's easiest to pass a flat array of floats
-      // with only one vertex attribute
-      // (Location in this case)
-      fillVertices.insert(fillVertices.end(), {point.x, point.y, point.z});
-    }
-
-    glGenVertexArrays(1, &info.fillVao);
-    glBindVertexArray(info.fillVao);
-
-    // Size is in number of three component vertices
-    // not raw number of floats
-    // so the ns-3 or converted point count would work
-    info.fillVbo_size = area.points.size();
-
-    glGenBuffers(1, &info.fillVbo);
-    glBindBuffer(GL_ARRAY_BUFFER, info.fillVbo);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(float) * fillVertices.size(), fillVertices.data(), GL_STATIC_DRAW);
-
-    // Location Attribute
-    glVertexAttribPointer(0u, 3, GL_FLOAT, GL_FALSE, sizeof(float) * 3, nullptr);
-    glEnableVertexAttribArray(0u);
-  }
-
-  // Border
-  info.renderBorder = area.borderMode == DrawMode::Solid;
-  if (info.renderBorder) {
-    const auto borderWidth = 0.5f; // TODO: Make configurable?
-
-    // TODO: Filled Corners?
-    float borderPoints[] = {
-        // Top Left
-        convertedPoints[0].x, convertedPoints[0].y, convertedPoints[0].z,               // 0
-        convertedPoints[0].x - borderWidth, convertedPoints[0].y, convertedPoints[0].z, // 1
-
-        // Bottom Left
-        convertedPoints[1].x, convertedPoints[1].y, convertedPoints[1].z,               // 2
-        convertedPoints[1].x - borderWidth, convertedPoints[1].y, convertedPoints[1].z, // 3
-        convertedPoints[1].x, convertedPoints[1].y, convertedPoints[1].z + borderWidth, // 4
-
-        // Bottom Right
-        convertedPoints[2].x, convertedPoints[2].y, convertedPoints[2].z,               // 5
-        convertedPoints[2].x, convertedPoints[2].y, convertedPoints[2].z + borderWidth, // 6
-        convertedPoints[2].x + borderWidth, convertedPoints[2].y, convertedPoints[2].z, // 7
-
-        // Top Right
-        convertedPoints[3].x, convertedPoints[3].y, convertedPoints[3].z,               // 8
-        convertedPoints[3].x + borderWidth, convertedPoints[3].y, convertedPoints[3].z, // 9
-        convertedPoints[3].x, convertedPoints[3].y, convertedPoints[3].z - borderWidth, // 10
-
-        // Top Left (Again)
-        convertedPoints[0].x, convertedPoints[0].y, convertedPoints[0].z,               // 11 (same as 0)
-        convertedPoints[0].x, convertedPoints[0].y, convertedPoints[0].z - borderWidth, // 12
-        convertedPoints[0].x - borderWidth, convertedPoints[0].y, convertedPoints[0].z, // 13 (same as 1)
-    };
-
-    info.borderVbo_size = 14u;
-    info.borderColor = toRenderColor(area.borderColor);
+void Renderer::allocate(DecorationBatch &batch) {
+  const auto &placements = batch.getPlacements();
+  upload(decorationPlacements, GL_ARRAY_BUFFER, sizeof(glm::mat4) * placements.size(), placements.data(),
+         GL_STATIC_DRAW);
+  batch.uploaded(decorationPlacements.name);
+}
 
-    glGenVertexArrays(1, &info.borderVao);
-    glBindVertexArray(info.borderVao);
+WiredLinkBatch::RenderInfo Renderer::allocateWiredLinks(std::size_t vertexCount) {
+  const auto created = wiredLinkVao == 0u;
+  if (created)
+    glGenVertexArrays(1, &wiredLinkVao);
+  glState.bindVertexArray(wiredLinkVao);
 
-    glGenBuffers(1, &info.borderVbo);
-    glBindBuffer(GL_ARRAY_BUFFER, info.borderVbo);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(borderPoints), borderPoints, GL_STATIC_DRAW);
+  // Location data is set when the links are added to each node
+  upload(wiredLinkVertices, GL_ARRAY_BUFFER, sizeof(float) * 3u * vertexCount, nullptr, GL_DYNAMIC_DRAW);
 
+  if (created) {
     // Location
     glVertexAttribPointer(0u, 3, GL_FLOAT, GL_FALSE, sizeof(float) * 3, nullptr);
     glEnableVertexAttribArray(0u);
   }
 
-  return info;
-}
-
-WiredLink::RenderInfo Renderer::allocate(const parser::WiredLink &link) {
-  WiredLink::RenderInfo info;
-
-  info.size = static_cast<int>(link.nodes.size());
-
-  glGenVertexArrays(1, &info.vao);
-  glBindVertexArray(info.vao);
-
-  glGenBuffers(1, &info.vbo);
-  glBindBuffer(GL_ARRAY_BUFFER, info.vbo);
-
-  // Location data is set when this link is added to each node
-  glBufferData(GL_ARRAY_BUFFER, sizeof(float) * 3 * link.nodes.size(), nullptr, GL_DYNAMIC_DRAW);
-
-  // Location
-  glVertexAttribPointer(0u, 3, GL_FLOAT, GL_FALSE, sizeof(float) * 3, nullptr);
-  glEnableVertexAttribArray(0u);
-
+  WiredLinkBatch::RenderInfo info;
+  info.vao = wiredLinkVao;
+  info.vbo = wiredLinkVertices.name;
+  info.size = static_cast<int>(vertexCount);
   return info;
 }
 
@@ -441,239 +533,429 @@ void Renderer::resize(Floor &f, float size) {
 
   const auto &renderInfo = f.getMesh().getRenderInfo();
 
-  glBindBuffer(GL_ARRAY_BUFFER, renderInfo.vbo);
+  glState.bindBuffer(GL_ARRAY_BUFFER, renderInfo.vbo);
   glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(floorVertices), reinterpret_cast<const void *>(floorVertices));
 }
 
 CoordinateGrid::RenderInfo Renderer::allocateCoordinateGrid(float size, int stepSize) {
   using CVertex = CoordinateGrid::Vertex;
-  // Make sure this isn't negative
-  size = std::abs(size);
-  // Align grid to integer coordinates
-  size = std::floor(size);
-
-  // Allocate points
-  std::vector<CoordinateGrid::Vertex> gridVertices;
-  gridVertices.reserve(size * 4uL);
 
-  for (auto i = -size; i <= size; i += static_cast<float>(stepSize)) { // NOLINT(cert-flp30-c)
-    // Vertical Line
-    gridVertices.emplace_back(CVertex{{i, size}});
-    gridVertices.emplace_back(CVertex{{i, -size}});
+  // Corners of a unit square, scaled in the shader
+  const std::array<CVertex, 4> corners{CVertex{{-1.0f, -1.0f}}, CVertex{{1.0f, -1.0f}}, CVertex{{-1.0f, 1.0f}},
+                                       CVertex{{1.0f, 1.0f}}};
 
-    // Horizontal Line
-    gridVertices.emplace_back(CVertex{{-size, i}});
-    gridVertices.emplace_back(CVertex{{size, i}});
-  }
-
-  // Setup VAO & VBO
-  // No IBO, since no points are repeated
   CoordinateGrid::RenderInfo renderInfo;
 
   glGenVertexArrays(1, &renderInfo.vao);
-  glBindVertexArray(renderInfo.vao);
+  glState.bindVertexArray(renderInfo.vao);
 
   glGenBuffers(1, &renderInfo.vbo);
-  glBindBuffer(GL_ARRAY_BUFFER, renderInfo.vbo);
-  glBufferData(GL_ARRAY_BUFFER, sizeof(CVertex) * gridVertices.size(), gridVertices.data(), GL_STATIC_DRAW);
+  glState.bindBuffer(GL_ARRAY_BUFFER, renderInfo.vbo);
+  glBufferData(GL_ARRAY_BUFFER, sizeof(CVertex) * corners.size(), corners.data(), GL_STATIC_DRAW);
 
   // Location
   glVertexAttribPointer(0u, 2, GL_FLOAT, GL_FALSE, sizeof(CVertex),
                         reinterpret_cast<void *>(offsetof(CVertex, position)));
   glEnableVertexAttribArray(0u);
 
-  glBindVertexArray(0u);
+  glState.bindVertexArray(0u);
 
-  renderInfo.size = gridVertices.size();
-  renderInfo.squareSize = size;
+  // Make sure this isn't negative
+  // Align grid to integer coordinates
+  renderInfo.squareSize = std::floor(std::abs(size));
+  renderInfo.stepSize = static_cast<float>(std::max(stepSize, 1));
   return renderInfo;
 }
 
 void Renderer::resize(CoordinateGrid &grid, float size, int stepSize) {
-  using CVertex = CoordinateGrid::Vertex;
-  const auto &renderInfo = grid.getRenderInfo();
+  // Only the uniforms change, so there's nothing to upload
+  grid.resized(std::floor(std::abs(size)), static_cast<float>(std::max(stepSize, 1)));
+}
 
-  // Regenerate the grid using the same steps as allocation
-  size = std::abs(size);
-  size = std::floor(size);
+void Renderer::startTransparentDark() {
+  glState.blendFunc(GL_ZERO, GL_SRC_COLOR);
+  glState.blendEquation(GL_FUNC_ADD);
 
-  std::vector<CoordinateGrid::Vertex> gridVertices;
-  gridVertices.reserve(size * 4uL);
+  glState.depthMask(false);
+  glState.enable(GL_BLEND);
+}
 
-  for (auto i = -size; i <= size; i += static_cast<float>(stepSize)) { // NOLINT(cert-flp30-c)
-    // Vertical Line
-    gridVertices.emplace_back(CVertex{{i, size}});
-    gridVertices.emplace_back(CVertex{{i, -size}});
+void Renderer::startTransparentLight() {
+  glState.blendFunc(GL_ONE, GL_ONE);
+  glState.blendEquation(GL_FUNC_ADD);
 
-    // Horizontal Line
-    gridVertices.emplace_back(CVertex{{-size, i}});
-    gridVertices.emplace_back(CVertex{{size, i}});
-  }
+  glState.depthMask(false);
+  glState.enable(GL_BLEND);
+}
 
-  glBindBuffer(GL_ARRAY_BUFFER, renderInfo.vbo);
-  glBufferData(GL_ARRAY_BUFFER, sizeof(CVertex) * gridVertices.size(), gridVertices.data(), GL_STATIC_DRAW);
+void Renderer::endTransparent() {
+  glState.disable(GL_BLEND);
+  glState.depthMask(true);
+}
 
-  // Notify the grid of the resize
-  grid.resized(gridVertices.size(), size);
+void Renderer::use(const Camera &cam) {
+  use(cam.view_matrix(), cam.get_position());
 }
 
-void Renderer::startTransparentDark() {
-  glBlendFunc(GL_ZERO, GL_SRC_COLOR);
-  glBlendEquation(GL_FUNC_ADD);
+void Renderer::use(const glm::mat4 &view, const glm::vec3 &eye) {
+  eyePosition = eye;
+
+  // The sky box drops the translation itself, so it stays around the camera
+  frameUniforms.view = view;
+  frameUniforms.eyePosition = eye;
+  uploadFrameUniforms();
 
-  glDepthMask(GL_FALSE);
-  glEnable(GL_BLEND);
+  // Another context user may have taken the binding point.
+  // This also binds the generic `GL_UNIFORM_BUFFER` point, which `uploadFrameUniforms()` already did
+  glBindBufferBase(GL_UNIFORM_BUFFER, frameBinding, frameUbo);
 }
 
-void Renderer::startTransparentLight() {
-  glBlendFunc(GL_ONE, GL_ONE);
-  glBlendEquation(GL_FUNC_ADD);
+void Renderer::setMotionTime(parser::nanoseconds time) {
+  motionTime = time;
+  frameUniforms.motionTime = toMilliseconds(time);
+}
 
-  glDepthMask(GL_FALSE);
-  glEnable(GL_BLEND);
+void Renderer::render(const DirectionalLight &light) {
+  frameUniforms.directionalLightColor = light.color;
+  frameUniforms.directionalLightAmbientIntensity = light.ambientIntensity;
+  frameUniforms.directionalLightDiffuseIntensity = light.diffuseIntensity;
+  frameUniforms.directionalLightDirection = light.direction;
+  uploadFrameUniforms();
 }
 
-void Renderer::endTransparent() {
-  glDisable(GL_BLEND);
-  glDepthMask(GL_TRUE);
+void Renderer::render(const StaticGeometry &geometry, StaticGeometry::Pass pass,
+                      const std::vector<std::uint32_t> &items, const std::optional<glm::vec3> &color) {
+  const auto &ranges = geometry.getRanges(pass);
+
+  // Neighboring items are next to each other in the index buffer,
+  // so merge their ranges
+  multiDrawCounts.clear();
+  multiDrawOffsets.clear();
+  std::size_t end = 0u;
+  for (const auto item : items) {
+    const auto &range = ranges[item];
+    if (range.count == 0)
+      continue;
+
+    if (!multiDrawCounts.empty() && range.first == end) {
+      multiDrawCounts.back() += range.count;
+    } else {
+      multiDrawCounts.emplace_back(range.count);
+      multiDrawOffsets.emplace_back(reinterpret_cast<const void *>(sizeof(unsigned int) * range.first));
+    }
+    end = range.first + static_cast<std::size_t>(range.count);
+  }
+
+  if (multiDrawCounts.empty())
+    return;
+
+  staticShader.uniform("use_override_color", color.has_value());
+  if (color)
+    staticShader.uniform("override_color", color.value());
+
+  glState.bindVertexArray(geometry.getRenderInfo().vao);
+  const auto mode = pass == StaticGeometry::Pass::BuildingOutlines ? GL_LINES : GL_TRIANGLES;
+  if (mode == GL_LINES)
+    glState.disable(GL_LINE_SMOOTH);
+  glMultiDrawElements(mode, multiDrawCounts.data(), GL_UNSIGNED_INT, multiDrawOffsets.data(),
+                      static_cast<GLsizei>(multiDrawCounts.size()));
+  stats::frameCounters.drawCalls++;
 }
 
-void Renderer::use(const Camera &cam) {
-  areaShader.uniform("view", cam.view_matrix());
+void Renderer::render(const StaticGeometry &geometry, StaticGeometry::Pass pass) {
+  const auto &ranges = geometry.getRanges(pass);
+  if (ranges.empty())
+    return;
+
+  // Every item in a pass is one range
+  const auto first = ranges.front().first;
+  const auto count = ranges.back().first + static_cast<std::size_t>(ranges.back().count) - first;
+  if (count == 0u)
+    return;
+
+  staticShader.uniform("use_override_color", false);
+  glState.bindVertexArray(geometry.getRenderInfo().vao);
+  const auto mode = pass == StaticGeometry::Pass::BuildingOutlines ? GL_LINES : GL_TRIANGLES;
+  if (mode == GL_LINES)
+    glState.disable(GL_LINE_SMOOTH);
+  glDrawElements(mode, static_cast<GLsizei>(count), GL_UNSIGNED_INT,
+                 reinterpret_cast<const void *>(sizeof(unsigned int) * first));
+  stats::frameCounters.drawCalls++;
+}
 
-  modelShader.uniform("view", cam.view_matrix());
-  modelShader.uniform("eye_position", cam.get_position());
+void Renderer::render(const StaticTiles &tiles, StaticGeometry::Pass pass, bool culled,
+                      const std::optional<glm::vec3> &color) {
+  for (const auto &tile : tiles.getTiles()) {
+    if (!tile.geometry)
+      continue;
 
-  buildingShader.uniform("view", cam.view_matrix());
+    if (culled)
+      render(*tile.geometry, pass, tile.visible, color);
+    else
+      render(*tile.geometry, pass);
+  }
 
-  gridShader.uniform("view", cam.view_matrix());
-  gridShader.uniform("eye_position", cam.get_position());
+  // The boxes have no outlines, & the Areas of far tiles are left out
+  if (pass != StaticGeometry::Pass::Buildings)
+    return;
+
+  if (culled)
+    render(tiles.getCoarse(), pass, tiles.getVisibleCoarse(), color);
+  else
+    render(tiles.getCoarse(), pass, tiles.getAbsent());
+}
 
-  // Drop the translation so we cannot move out of the sky box
-  auto noTranslationView = cam.view_matrix();
-  noTranslationView[3] = {0.0f, 0.0f, 0.0f, 1.0f};
-  skyBoxShader.uniform("view", noTranslationView);
+void Renderer::render(OcclusionQueries &queries, const std::vector<OcclusionQueries::Test> &tests) {
+  occlusionShader.bind();
+  glState.bindVertexArray(emptyVao);
+  glState.enable(GL_DEPTH_TEST);
+  glState.depthMask(false);
+  glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
 
-  pickingShader.uniform("view", cam.view_matrix());
+  for (const auto &test : tests) {
+    if (!queries.begin(test.slot))
+      continue;
 
-  // Convert to 3x3 since that's the rotation section of the model matrix (the top left 3x3)
-  // then invert that.
-  cameraRotateInverse = glm::inverse(glm::mat3x3(cam.view_matrix()));
+    occlusionShader.uniform("box_min", test.min);
+    occlusionShader.uniform("box_max", test.max);
+    glDrawArrays(GL_TRIANGLE_STRIP, 0, 14);
+    queries.end();
+    stats::frameCounters.drawCalls++;
+  }
 
-  fontShader.uniform("view", cam.view_matrix());
-  fontBackgroundShader.uniform("view", cam.view_matrix());
+  glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+  glState.depthMask(true);
 }
 
-void Renderer::render(const DirectionalLight &light) {
-  modelShader.uniform("directional_light.base.color", light.color);
-  modelShader.uniform("directional_light.base.ambient_intensity", light.ambientIntensity);
-  modelShader.uniform("directional_light.base.diffuse_intensity", light.diffuseIntensity);
+void Renderer::renderTrail(const TrailBuffer &buffer, const glm::vec3 &color) {
+  // Only lines are smoothed, so it's left on for the next trail
+  glState.enable(GL_LINE_SMOOTH);
 
-  modelShader.uniform("directional_light.direction", light.direction);
+  buildingShader.bind();
+  buildingShader.uniform("color", color);
+  buffer.render();
 }
 
-void Renderer::render(const PointLight &light) {
-  modelShader.uniform(light.prefix + "base.color", light.color);
-  modelShader.uniform(light.prefix + "base.ambient_intensity", light.ambientIntensity);
-  modelShader.uniform(light.prefix + "base.diffuse_intensity", light.diffuseIntensity);
+void Renderer::renderTrajectory(TrajectoryBuffer &buffer, std::uint32_t slot, const glm::vec3 &color,
+                                parser::nanoseconds window, bool interpolated) {
+  glState.enable(GL_LINE_SMOOTH);
 
-  modelShader.uniform(light.prefix + "position", light.position);
+  const auto windowStart = toMilliseconds(motionTime - window);
+  trajectoryShader.bind();
+  trajectoryShader.uniform("color", color);
+  trajectoryShader.uniform("window_start", windowStart);
+  buffer.draw(slot, windowStart, frameUniforms.motionTime, interpolated);
+}
 
-  modelShader.uniform(light.prefix + "constant", light.constant);
-  modelShader.uniform(light.prefix + "linear", light.linear);
-  modelShader.uniform(light.prefix + "exponent", light.exponent);
+void Renderer::render(const Node &node, bool isSelected, LightingMode lightingMode) {
+  const auto &m = node.getModel();
+
+  modelShader.bind();
+  modelShader.uniform(modelUniforms.isSelected, isSelected);
+  modelShader.uniform(modelUniforms.model, m.getModelMatrix());
+  modelShader.uniform(modelUniforms.useLighting, lightingMode == LightingMode::LightingEnabled);
+  modelCache.get(m.getModelId()).render(modelShader, modelUniforms.material, m);
+
+  modelShader.uniform(modelUniforms.isSelected, false);
 }
 
-void Renderer::render(const SpotLight &light) {
-  modelShader.uniform(light.prefix + "pointLight.base.color", light.color);
-  modelShader.uniform(light.prefix + "pointLight.base.ambient_intensity", light.ambientIntensity);
-  modelShader.uniform(light.prefix + "pointLight.base.diffuse_intensity", light.diffuseIntensity);
+void Renderer::uploadNodeData(NodeStore &nodes) {
+  static_assert(sizeof(NodeData) % sizeof(glm::vec4) == 0u, "NodeData must be a whole number of texels");
+
+  // Changed slots this close together are uploaded as one run,
+  // rather than issuing an upload for each
+  constexpr std::size_t mergeGap = 8u;
+
+  auto dirty = nodes.takeDirty();
+  nodeData.resize(nodes.size());
+  for (const auto i : dirty) {
+    auto &data = nodeData[i];
+    data.model = nodes.getModelMatrix(i);
 
-  modelShader.uniform(light.prefix + "pointLight.position", light.position);
-  modelShader.uniform(light.prefix + "direction", light.direction);
+    const auto &baseColor = nodes.getBaseColor(i);
+    data.baseColor = baseColor ? glm::vec4{baseColor.value(), 1.0f} : glm::vec4{0.0f};
+    const auto &highlightColor = nodes.getHighlightColor(i);
+    data.highlightColor = highlightColor ? glm::vec4{highlightColor.value(), 1.0f} : glm::vec4{0.0f};
 
-  modelShader.uniform(light.prefix + "pointLight.constant", light.constant);
-  modelShader.uniform(light.prefix + "pointLight.linear", light.linear);
-  modelShader.uniform(light.prefix + "pointLight.exponent", light.exponent);
+    data.objectId = static_cast<float>(nodes.getId(i));
+
+    const auto &motion = nodes.getMotion(i);
+    data.motionStart = toMilliseconds(motion.start);
+    data.motionEnd = toMilliseconds(motion.end);
+    data.motionOffset = glm::vec4{motion.offset, 0.0f};
+  }
+
+  glState.bindBuffer(GL_TEXTURE_BUFFER, nodeDataVbo);
+  glState.bindTexture(2u, GL_TEXTURE_BUFFER, nodeDataTexture);
+
+  if (nodeData.size() > nodeDataCapacity) {
+    // Every slot is new to the buffer, so there's nothing to keep
+    nodeDataCapacity = std::max(nodeData.size(), nodeDataCapacity * 2u);
+    glBufferData(GL_TEXTURE_BUFFER, static_cast<GLsizeiptr>(sizeof(NodeData) * nodeDataCapacity), nullptr,
+                 GL_DYNAMIC_DRAW);
+    glBufferSubData(GL_TEXTURE_BUFFER, 0, static_cast<GLsizeiptr>(sizeof(NodeData) * nodeData.size()),
+                    nodeData.data());
+    stats::frameCounters.bufferUploads++;
+    return;
+  }
 
-  modelShader.uniform(light.prefix + "edge", light.processedEdge);
+  // Staged in order, so neighbouring runs share a copy
+  std::sort(dirty.begin(), dirty.end());
+  for (std::size_t i = 0u; i < dirty.size();) {
+    const std::size_t first = dirty[i];
+    std::size_t last = first;
+    for (i++; i < dirty.size() && dirty[i] - last <= mergeGap; i++)
+      last = dirty[i];
+
+    uploadRing.write(nodeDataVbo, sizeof(NodeData) * first, &nodeData[first], sizeof(NodeData) * (last - first + 1u));
+  }
+}
+
+std::optional<std::size_t> Renderer::sortTexture(const Material &material) {
+  if (!material.textureId)
+    return {};
+
+  return textureCache.get(*material.textureId).id;
 }
 
-void Renderer::render(const std::vector<Area> &areas) {
-  areaShader.bind();
+void Renderer::uploadNodeInstances(const NodeStore &nodes, const std::vector<std::uint32_t> &indices) {
+  // Clear, rather than remove, the groups to keep their allocations
+  for (auto &[model, groups] : nodeInstanceGroups) {
+    for (auto &group : groups)
+      group.clear();
+  }
+
+  for (const auto i : indices) {
+    const auto modelId = nodes.getModelId(i);
+    const auto level = levelOfDetail(modelCache.get(modelId), nodes.getModelMatrix(i));
+    nodeInstanceGroups[modelId][level].emplace_back(i);
+  }
+
+  nodeInstances.clear();
+  nodeInstanceRanges.clear();
+  for (const auto &[model, groups] : nodeInstanceGroups) {
+    for (std::size_t level = 0u; level < groups.size(); level++) {
+      const auto &group = groups[level];
+      if (group.empty())
+        continue;
 
-  for (const auto &area : areas) {
-    const auto &renderInfo = area.getRenderInfo();
-    if (renderInfo.renderFill) {
-      areaShader.uniform("color", renderInfo.fillColor);
-      glBindVertexArray(renderInfo.fillVao);
-      glDrawArrays(GL_TRIANGLE_FAN, 0, renderInfo.fillVbo_size);
+      nodeInstanceRanges.push_back({model, level, nodeInstances.size(), static_cast<int>(group.size())});
+      nodeInstances.insert(nodeInstances.end(), group.begin(), group.end());
     }
+  }
+
+  glState.bindBuffer(GL_ARRAY_BUFFER, nodeInstanceVbo);
+  // Orphan the previous contents, rather than waiting on draws still using them
+  glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(sizeof(Mesh::Instance) * nodeInstances.size()),
+               nodeInstances.data(), GL_STREAM_DRAW);
+  stats::frameCounters.bufferUploads++;
+}
 
-    if (renderInfo.renderBorder) {
-      areaShader.uniform("color", renderInfo.borderColor);
-      glBindVertexArray(renderInfo.borderVao);
-      glDrawArrays(GL_TRIANGLE_STRIP, 0, renderInfo.borderVbo_size);
+void Renderer::render(const NodeStore &nodes, const std::vector<std::uint32_t> &indices,
+                      std::optional<unsigned int> selectedNode) {
+  uploadNodeInstances(nodes, indices);
+
+  // Compared with the ID of each instance, so a selection change doesn't touch the node data
+  modelShader.bind();
+  modelShader.uniform(modelUniforms.hasSelectedObject, selectedNode.has_value());
+  modelShader.uniform(modelUniforms.selectedObject, selectedNode.value_or(0u));
+
+  for (const auto &range : nodeInstanceRanges) {
+    for (auto &mesh : modelCache.get(range.model).meshesAt(range.level)) {
+      const auto &material = mesh.getMaterial();
+
+      RenderQueue::Item item;
+      // Each range covers Nodes all over the scene, so there's no one depth for it
+      item.key = RenderQueue::key(RenderQueue::Pass::Opaque, RenderQueue::Program::ModelInstanced,
+                                  sortTexture(material), range.model, 0.0f);
+      item.mesh = &mesh;
+      item.texture = material.textureId;
+      // The instance colors are chosen by the shader, from the material type
+      item.color = materialColor(material, {}, {});
+      item.materialType = materialType(material);
+      item.first = range.first;
+      item.count = range.count;
+      renderQueue.submit(item);
     }
   }
 }
 
-void Renderer::render(const std::vector<Building> &buildings) {
-  buildingShader.bind();
-  for (const auto &building : buildings) {
-    if (!building.visible())
-      continue;
-    const auto &renderInfo = building.getRenderInfo();
-    buildingShader.uniform("color", building.getColor());
+void Renderer::queue(RenderQueue::Pass pass, model_id model, std::vector<Mesh> &meshes, const glm::mat4 &modelMatrix,
+                     const std::optional<glm::vec3> &baseColor, const std::optional<glm::vec3> &highlightColor,
+                     bool useLighting) {
+  const auto depth = glm::distance(glm::vec3{modelMatrix[3]}, eyePosition);
 
-    glBindVertexArray(renderInfo.vao);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, renderInfo.ibo);
-    glDrawElements(GL_TRIANGLES, renderInfo.ibo_size, GL_UNSIGNED_INT, nullptr);
+  for (auto &mesh : meshes) {
+    const auto &material = mesh.getMaterial();
+
+    RenderQueue::Item item;
+    item.key = RenderQueue::key(pass, RenderQueue::Program::Model, sortTexture(material), model, depth);
+    item.mesh = &mesh;
+    item.texture = material.textureId;
+    item.color = materialColor(material, baseColor, highlightColor);
+    item.model = modelMatrix;
+    item.useLighting = useLighting;
+    renderQueue.submit(item);
   }
 }
 
-void Renderer::renderOutlines(const std::vector<Building> &buildings, const glm::vec3 &color) {
-  buildingShader.bind();
-  for (const auto &building : buildings) {
-    if (!building.visible())
+void Renderer::queue(RenderQueue::Pass pass, const DecorationBatch &batch, const std::vector<std::uint32_t> &groups,
+                     bool transparent) {
+  for (const auto index : groups) {
+    const auto &group = batch.getGroups()[index];
+    auto &renderInfo = modelCache.get(group.model);
+    auto &opaque = renderInfo.getMeshes();
+    auto &meshes = transparent ? renderInfo.getTransparentMeshes() : opaque;
+
+    // Baked against other meshes, rebuilt next frame
+    if (group.meshes.size() != opaque.size() + renderInfo.getTransparentMeshes().size())
       continue;
-    const auto &renderInfo = building.getRenderInfo();
 
-    glBindVertexArray(renderInfo.lineVao);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, renderInfo.lineIbo);
-    buildingShader.uniform("color", color);
-    glDrawElements(GL_LINES, renderInfo.lineIboSize, GL_UNSIGNED_INT, nullptr);
+    const auto offset = transparent ? opaque.size() : 0u;
+    for (std::size_t i = 0u; i < meshes.size(); i++) {
+      auto &mesh = meshes[i];
+      const auto &material = mesh.getMaterial();
+      const auto &range = group.meshes[offset + i];
+
+      // Placed in world space, so there's no one depth to sort by
+      RenderQueue::Item item;
+      item.key = RenderQueue::key(pass, RenderQueue::Program::Model, sortTexture(material), group.model, 0.0f);
+      item.mesh = &mesh;
+      item.texture = material.textureId;
+      item.color = materialColor(material, {}, {});
+      item.placements = batch.getVbo();
+      item.firstPlacement = range.first;
+      item.placementCount = range.count;
+      renderQueue.submit(item);
+    }
   }
 }
 
-void Renderer::renderTrail(const TrailBuffer &buffer, const glm::vec3 &color) {
-  glEnable(GL_LINE_SMOOTH);
-
-  buildingShader.bind();
-  buildingShader.uniform("color", color);
-  buffer.render();
+void Renderer::render(const DecorationBatch &batch, const std::vector<std::uint32_t> &groups) {
+  queue(RenderQueue::Pass::Opaque, batch, groups, false);
+}
 
-  glDisable(GL_LINE_SMOOTH);
+void Renderer::renderTransparent(const DecorationBatch &batch, const std::vector<std::uint32_t> &groups) {
+  queue(RenderQueue::Pass::Transparent, batch, groups, true);
 }
 
-void Renderer::render(const Node &node, bool isSelected, LightingMode lightingMode) {
-  const auto &m = node.getModel();
+void Renderer::renderTransparent(const NodeStore &nodes, std::size_t index) {
+  const auto modelId = nodes.getModelId(index);
+  auto &renderInfo = modelCache.get(modelId);
 
-  modelShader.bind();
-  modelShader.uniform("is_selected", isSelected);
-  modelShader.uniform("model", m.getModelMatrix());
-  modelShader.uniform("useLighting", lightingMode == LightingMode::LightingEnabled);
-  modelCache.get(m.getModelId()).render(modelShader, m);
+  if (!renderInfo.hasTransparentMeshes())
+    return;
 
-  modelShader.uniform("is_selected", false);
+  // Drawn with the matrix, rather than from `node_data`, so move it here
+  auto modelMatrix = nodes.getModelMatrix(index);
+  modelMatrix[3] += glm::vec4{nodes.motionOffset(index, motionTime), 0.0f};
+  queue(RenderQueue::Pass::Transparent, modelId, renderInfo.transparentMeshesAt(levelOfDetail(renderInfo, modelMatrix)),
+        modelMatrix, nodes.getBaseColor(index), nodes.getHighlightColor(index), true);
 }
 
 void Renderer::render(const Model &m, LightingMode lightingMode) {
-  modelShader.bind();
-  modelShader.uniform("is_selected", false);
-  modelShader.uniform("model", m.getModelMatrix());
-  modelShader.uniform("useLighting", lightingMode == LightingMode::LightingEnabled);
-  modelCache.get(m.getModelId()).render(modelShader, m);
+  queue(RenderQueue::Pass::Opaque, m.getModelId(), modelCache.get(m.getModelId()).getMeshes(), m.getModelMatrix(),
+        m.getBaseColor(), m.getHighlightColor(), lightingMode == LightingMode::LightingEnabled);
 }
 
 void Renderer::renderTransparent(const Model &m, LightingMode lightingMode) {
@@ -682,72 +964,387 @@ void Renderer::renderTransparent(const Model &m, LightingMode lightingMode) {
   if (!renderInfo.hasTransparentMeshes())
     return;
 
+  queue(RenderQueue::Pass::Transparent, m.getModelId(), renderInfo.getTransparentMeshes(), m.getModelMatrix(),
+        m.getBaseColor(), m.getHighlightColor(), lightingMode == LightingMode::LightingEnabled);
+}
+
+void Renderer::flush() {
+  if (renderQueue.empty())
+    return;
+
+  renderQueue.sort();
+  const auto &items = renderQueue.getItems();
+
+  // Build every indirect command up front, so they're uploaded once
+  indirectCommands.clear();
+  if (indirectGl) {
+    for (std::size_t i = 0u; i < items.size();) {
+      const auto end = indirectRunEnd(items, i);
+      if (end - i > 1u) {
+        for (; i < end; i++) {
+          const auto &renderInfo = items[i].mesh->getRenderInfo();
+          indirectCommands.push_back({static_cast<unsigned int>(renderInfo.indexCount),
+                                      static_cast<unsigned int>(items[i].count),
+                                      static_cast<unsigned int>(renderInfo.firstIndex), renderInfo.baseVertex,
+                                      static_cast<unsigned int>(items[i].first)});
+        }
+      }
+      i = end;
+    }
+
+    if (!indirectCommands.empty()) {
+      glBindBuffer(GL_DRAW_INDIRECT_BUFFER, indirectBuffer);
+      glBufferData(GL_DRAW_INDIRECT_BUFFER, static_cast<GLsizeiptr>(indirectCommands.size() * sizeof(DrawCommand)),
+                   indirectCommands.data(), GL_STREAM_DRAW);
+      stats::frameCounters.bufferUploads++;
+    }
+  }
+
   modelShader.bind();
-  modelShader.uniform("model", m.getModelMatrix());
-  modelShader.uniform("useLighting", lightingMode == LightingMode::LightingEnabled);
-  modelShader.uniform("is_selected", false);
-  renderInfo.renderTransparent(modelShader, m);
+  modelShader.uniform(modelUniforms.isSelected, false);
+
+  // What's already set on `modelShader`, so only changes are set.
+  // Unset until the first item sets them
+  std::optional<RenderQueue::Pass> pass;
+  std::optional<bool> instanced;
+  std::optional<bool> useTexture;
+  std::optional<int> textureLayer;
+  std::optional<glm::vec3> color;
+  std::optional<unsigned int> type;
+  std::optional<bool> useLighting;
+
+  auto apply = [&](const RenderQueue::Item &item) {
+    const auto itemPass = RenderQueue::passOf(item.key);
+    if (itemPass != pass) {
+      if (itemPass == RenderQueue::Pass::Opaque)
+        endTransparent();
+      else
+        startTransparentDark();
+      pass = itemPass;
+    }
+
+    const auto itemInstanced = item.count > 0;
+    if (itemInstanced != instanced) {
+      modelShader.uniform(modelUniforms.instanced, itemInstanced);
+      instanced = itemInstanced;
+    }
+
+    if (item.texture.has_value() != useTexture) {
+      modelShader.uniform(modelUniforms.material.useTexture, item.texture.has_value());
+      useTexture = item.texture.has_value();
+    }
+
+    if (item.texture) {
+      textureCache.use(item.texture.value());
+
+      const auto layer = textureCache.get(item.texture.value()).layer;
+      if (layer != textureLayer) {
+        modelShader.uniform(modelUniforms.material.textureLayer, layer);
+        textureLayer = layer;
+      }
+    } else if (item.color && item.color != color) {
+      modelShader.uniform(modelUniforms.material.materialColor, item.color.value());
+      color = item.color;
+    }
+
+    if (item.useLighting != useLighting) {
+      modelShader.uniform(modelUniforms.useLighting, item.useLighting);
+      useLighting = item.useLighting;
+    }
+
+    if (itemInstanced && item.materialType != type) {
+      modelShader.uniform(modelUniforms.material.materialType, item.materialType);
+      type = item.materialType;
+    }
+  };
+
+  // Index of the next unused command in `indirectCommands`
+  std::size_t command = 0u;
+  for (std::size_t i = 0u; i < items.size();) {
+    const auto &item = items[i];
+    apply(item);
+
+    const auto end = indirectGl ? indirectRunEnd(items, i) : i + 1u;
+    if (end - i > 1u) {
+      // The base instance of each command picks its instances, so bind from the start of the buffer
+      const auto runLength = static_cast<GLsizei>(end - i);
+      item.mesh->bindInstances(nodeInstanceVbo, 0u);
+      indirectGl->glMultiDrawElementsIndirect(GL_TRIANGLES, item.mesh->getRenderInfo().indexType,
+                                              reinterpret_cast<const void *>(command * sizeof(DrawCommand)),
+                                              runLength, 0);
+      stats::frameCounters.drawCalls++;
+      item.mesh->unbindInstances();
+      command += runLength;
+    } else if (item.count > 0)
+      item.mesh->renderInstanced(nodeInstanceVbo, item.first, item.count);
+    else if (item.placements != 0u) {
+      // The placements are already in world space
+      modelShader.uniform(modelUniforms.model, glm::mat4{1.0f});
+      item.mesh->renderPlaced(item.placements, item.firstPlacement, item.placementCount);
+    } else {
+      modelShader.uniform(modelUniforms.model, item.model);
+      item.mesh->render();
+    }
+
+    i = end;
+  }
+
+  modelShader.uniform(modelUniforms.instanced, false);
+  renderQueue.clear();
+}
+
+void Renderer::uploadTransmissions(const NodeStore &nodes, const std::vector<std::uint32_t> &indices,
+                                   parser::nanoseconds time) {
+  transmissionEpoch = time;
+
+  transmissionInstances.clear();
+  for (const auto i : indices) {
+    const auto &transmit = nodes.getNode(i).getTransmitInfo();
+
+    auto &instance = transmissionInstances.emplace_back();
+    instance.center = nodes.getPosition(i);
+    instance.startTime = toMilliseconds(transmit.startTime - transmissionEpoch);
+    instance.duration = toMilliseconds(transmit.duration);
+    instance.targetSize = static_cast<float>(transmit.targetSize);
+    instance.color = transmit.color;
+  }
+  transmissionCount = static_cast<int>(transmissionInstances.size());
+
+  glState.bindBuffer(GL_ARRAY_BUFFER, transmissionInstanceVbo);
+  glBufferData(GL_ARRAY_BUFFER,
+               static_cast<GLsizeiptr>(sizeof(Mesh::TransmissionInstance) * transmissionInstances.size()),
+               transmissionInstances.data(), GL_DYNAMIC_DRAW);
+  stats::frameCounters.bufferUploads++;
+}
+
+void Renderer::renderTransmissions(const Model &sphere, parser::nanoseconds time) {
+  if (transmissionCount == 0)
+    return;
+
+  transmissionShader.uniform("time", toMilliseconds(time - transmissionEpoch));
+
+  for (auto &mesh : modelCache.get(sphere.getModelId()).getMeshes())
+    mesh.renderTransmissions(transmissionInstanceVbo, transmissionCount);
 }
 
 void Renderer::render(Floor &f) {
   modelShader.bind();
-  modelShader.uniform("model", f.getModelMatrix());
-  modelShader.uniform("useTexture", false);
-  modelShader.uniform("material_color", f.getMesh().getMaterial().color.value());
-  modelShader.uniform("is_selected", false);
+  modelShader.uniform(modelUniforms.model, f.getModelMatrix());
+  modelShader.uniform(modelUniforms.material.useTexture, false);
+  modelShader.uniform(modelUniforms.material.materialColor, f.getMesh().getMaterial().color.value());
+  modelShader.uniform(modelUniforms.isSelected, false);
   f.render();
 }
 
+void Renderer::accumulateHeatmap(const HeatmapFramebuffer &heatmap, std::size_t nodeCount, const glm::vec2 &low,
+                                 const glm::vec2 &high, parser::nanoseconds time) {
+  // Splats reach this far around each Node, in world units
+  constexpr auto splatRadius = 8.0f;
+
+  // Transmissions count for more than a Node, so activity stands out
+  constexpr auto transmissionWeight = 4.0f;
+
+  GLint previousFbo = 0;
+  glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &previousFbo);
+  std::array<GLint, 4> previousViewport{};
+  glGetIntegerv(GL_VIEWPORT, previousViewport.data());
+
+  heatmap.bind(GL_DRAW_FRAMEBUFFER);
+  glViewport(0, 0, heatmap.getSize(), heatmap.getSize());
+
+  // The split view scissors each half, which would cut the heatmap
+  const auto scissor = glIsEnabled(GL_SCISSOR_TEST);
+  glState.disable(GL_SCISSOR_TEST);
+  glState.disable(GL_DEPTH_TEST);
+  glState.enable(GL_PROGRAM_POINT_SIZE);
+
+  glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+  glClear(GL_COLOR_BUFFER_BIT);
+  startTransparentLight();
+
+  const auto texelsPerUnit = static_cast<float>(heatmap.getSize()) / std::max(high.x - low.x, high.y - low.y);
+  heatmapSplatShader.bind();
+  heatmapSplatShader.uniform("low", low);
+  heatmapSplatShader.uniform("high", high);
+  heatmapSplatShader.uniform("splat_size", std::max(2.0f, splatRadius * 2.0f * texelsPerUnit));
+
+  if (nodeCount > 0u) {
+    heatmapSplatShader.uniform("transmissions", false);
+    heatmapSplatShader.uniform("splat_weight", 1.0f);
+    glState.bindTexture(2u, GL_TEXTURE_BUFFER, nodeDataTexture);
+    glState.bindVertexArray(emptyVao);
+    glDrawArrays(GL_POINTS, 0, static_cast<GLsizei>(nodeCount));
+    stats::frameCounters.drawCalls++;
+  }
+
+  if (transmissionCount > 0) {
+    heatmapSplatShader.uniform("transmissions", true);
+    heatmapSplatShader.uniform("splat_weight", transmissionWeight);
+    heatmapSplatShader.uniform("time", toMilliseconds(time - transmissionEpoch));
+    glState.bindVertexArray(heatmapVao);
+    glDrawArrays(GL_POINTS, 0, transmissionCount);
+    stats::frameCounters.drawCalls++;
+  }
+
+  endTransparent();
+  glState.disable(GL_PROGRAM_POINT_SIZE);
+  glState.enable(GL_DEPTH_TEST);
+  if (scissor)
+    glState.enable(GL_SCISSOR_TEST);
+
+  glBindFramebuffer(GL_DRAW_FRAMEBUFFER, static_cast<GLuint>(previousFbo));
+  glViewport(previousViewport[0], previousViewport[1], previousViewport[2], previousViewport[3]);
+}
+
+void Renderer::renderHeatmap(const HeatmapFramebuffer &heatmap, const glm::vec2 &low, const glm::vec2 &high,
+                             float height) {
+  // Nodes stacked this deep, or fewer with transmissions, show the top of the ramp
+  constexpr auto saturation = 8.0f;
+
+  glState.blendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+  glState.blendEquation(GL_FUNC_ADD);
+  glState.depthMask(false);
+  glState.enable(GL_BLEND);
+
+  heatmapShader.bind();
+  heatmapShader.uniform("low", low);
+  heatmapShader.uniform("high", high);
+  heatmapShader.uniform("height", height);
+  heatmapShader.uniform("saturation", saturation);
+  glState.bindTexture(0u, GL_TEXTURE_2D, heatmap.getDensity());
+  glState.bindVertexArray(emptyVao);
+  glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+  stats::frameCounters.drawCalls++;
+
+  endTransparent();
+}
+
+void Renderer::updateMinimap(const MinimapFramebuffer &minimap, std::size_t nodeCount, const glm::vec2 &low,
+                             const glm::vec2 &high, const std::optional<unsigned int> &selectedNode) {
+  // Dots are this wide on the minimap's texture, however large the scenario is
+  constexpr auto dotSize = 4.0f;
+
+  GLint previousFbo = 0;
+  glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &previousFbo);
+  std::array<GLint, 4> previousViewport{};
+  glGetIntegerv(GL_VIEWPORT, previousViewport.data());
+
+  minimap.bindMap();
+  glViewport(0, 0, minimap.getSize(), minimap.getSize());
+
+  const auto scissor = glIsEnabled(GL_SCISSOR_TEST);
+  glState.disable(GL_SCISSOR_TEST);
+  glState.disable(GL_BLEND);
+  glState.disable(GL_DEPTH_TEST);
+
+  // The static content, copied as is
+  upscaleShader.bind();
+  glState.bindTexture(0u, GL_TEXTURE_2D, minimap.getStatic());
+  glState.bindVertexArray(emptyVao);
+  glDrawArrays(GL_TRIANGLES, 0, 3);
+  stats::frameCounters.drawCalls++;
+
+  if (nodeCount > 0u) {
+    glState.enable(GL_PROGRAM_POINT_SIZE);
+    minimapShader.bind();
+    minimapShader.uniform("low", low);
+    minimapShader.uniform("high", high);
+    minimapShader.uniform("dot_size", dotSize);
+    minimapShader.uniform("has_selected_object", selectedNode.has_value());
+    if (selectedNode)
+      minimapShader.uniform("selected_object", selectedNode.value());
+
+    glState.bindTexture(2u, GL_TEXTURE_BUFFER, nodeDataTexture);
+    glDrawArrays(GL_POINTS, 0, static_cast<GLsizei>(nodeCount));
+    stats::frameCounters.drawCalls++;
+    glState.disable(GL_PROGRAM_POINT_SIZE);
+  }
+
+  glState.enable(GL_DEPTH_TEST);
+  if (scissor)
+    glState.enable(GL_SCISSOR_TEST);
+
+  glBindFramebuffer(GL_DRAW_FRAMEBUFFER, static_cast<GLuint>(previousFbo));
+  glViewport(previousViewport[0], previousViewport[1], previousViewport[2], previousViewport[3]);
+}
+
+void Renderer::renderMinimap(const MinimapFramebuffer &minimap) {
+  glState.disable(GL_BLEND);
+  glState.disable(GL_DEPTH_TEST);
+
+  upscaleShader.bind();
+  glState.bindTexture(0u, GL_TEXTURE_2D, minimap.getMap());
+  glState.bindVertexArray(emptyVao);
+  glDrawArrays(GL_TRIANGLES, 0, 3);
+  stats::frameCounters.drawCalls++;
+
+  glState.enable(GL_DEPTH_TEST);
+}
+
+void Renderer::upscale(const SceneFramebuffer &scene) {
+  glState.disable(GL_BLEND);
+  glState.disable(GL_DEPTH_TEST);
+
+  upscaleShader.bind();
+  glState.bindTexture(0u, GL_TEXTURE_2D, scene.getColor());
+  glState.bindVertexArray(emptyVao);
+  glDrawArrays(GL_TRIANGLES, 0, 3);
+  stats::frameCounters.drawCalls++;
+
+  glState.enable(GL_DEPTH_TEST);
+}
+
+void Renderer::renderProbe(int layers) {
+  glState.enable(GL_BLEND);
+  glState.blendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+  glState.disable(GL_DEPTH_TEST);
+
+  probeShader.bind();
+  glState.bindVertexArray(emptyVao);
+  for (auto i = 0; i < layers; i++) {
+    probeShader.uniform("layer", i);
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+    stats::frameCounters.drawCalls++;
+  }
+
+  glState.disable(GL_BLEND);
+  glState.enable(GL_DEPTH_TEST);
+}
+
 void Renderer::render(SkyBox &skyBox) {
-  glDepthMask(GL_FALSE);
+  glState.depthMask(false);
   skyBoxShader.bind();
 
   textureCache.useCubeMap(skyBox.getTextureId());
   skyBox.getMesh().render();
-  glDepthMask(GL_TRUE);
+  glState.depthMask(true);
 }
 
 void Renderer::render(CoordinateGrid &coordinateGrid) {
   const auto &renderInfo = coordinateGrid.getRenderInfo();
-  glEnable(GL_LINE_SMOOTH);
-  glBlendFunc(GL_ONE, GL_ONE);
-  glBlendEquation(GL_FUNC_ADD);
-
-  glDepthMask(GL_FALSE);
-  glEnable(GL_BLEND);
+  startTransparentLight();
 
   gridShader.bind();
 
   // TODO: Make configurable
   gridShader.uniform("intensity", 0.3f);
+  gridShader.uniform("square_size", renderInfo.squareSize);
+  gridShader.uniform("step_size", renderInfo.stepSize);
 
-  glBindVertexArray(renderInfo.vao);
-  glBindBuffer(GL_ARRAY_BUFFER, renderInfo.vbo);
-  glDrawArrays(GL_LINES, 0, renderInfo.size);
+  glState.bindVertexArray(renderInfo.vao);
+  glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+  stats::frameCounters.drawCalls++;
 
-  glBindVertexArray(0);
-  glBindBuffer(GL_ARRAY_BUFFER, 0);
-
-  glDisable(GL_LINE_SMOOTH);
-  glDisable(GL_BLEND);
-  glDepthMask(GL_TRUE);
+  endTransparent();
 }
 
-void Renderer::render(const std::vector<WiredLink> &wiredLinks) {
-  glEnable(GL_LINE_SMOOTH);
+void Renderer::render(WiredLinkBatch &wiredLinks) {
+  glState.enable(GL_LINE_SMOOTH);
 
   buildingShader.bind();
   // TODO: Make configurable
   buildingShader.uniform("color", {0.0f, 0.0f, 0.0f});
-
-  for (const auto &wiredLink : wiredLinks) {
-    const auto &renderInfo = wiredLink.getRenderInfo();
-    glBindVertexArray(renderInfo.vao);
-    glBindBuffer(GL_ARRAY_BUFFER, renderInfo.vbo);
-    glDrawArrays(GL_LINES, 0, renderInfo.size);
-  }
-
-  glDisable(GL_LINE_SMOOTH);
+  wiredLinks.render();
 }
 
 void Renderer::renderPickingNode(unsigned int nodeId, const Model &m) {
@@ -768,34 +1365,66 @@ void Renderer::renderPickingNode(unsigned int nodeId, const Model &m) {
   }
 }
 
-void Renderer::renderFont(const FontManager::FontBannerRenderInfo &info, const glm::vec3 &location, float scale) {
-  // TODO: Maybe make this configurable?
-  const glm::vec3 offset{0.0f, 2.0f, 0.0f};
+void Renderer::renderPickingNodes(const NodeStore &nodes, const std::vector<std::uint32_t> &indices) {
+  uploadNodeInstances(nodes, indices);
+
+  pickingShader.bind();
+  pickingShader.uniform("instanced", true);
+  pickingShader.uniform("object_type", 1u);
+
+  for (const auto &range : nodeInstanceRanges) {
+    auto &model = modelCache.get(range.model);
+
+    for (auto &mesh : model.getMeshes())
+      mesh.renderInstanced(nodeInstanceVbo, range.first, range.count);
+    for (auto &mesh : model.getTransparentMeshes())
+      mesh.renderInstanced(nodeInstanceVbo, range.first, range.count);
+  }
+
+  pickingShader.uniform("instanced", false);
+}
 
-  auto modelMatrix = glm::translate(glm::identity<glm::mat4>(), location + offset);
-  modelMatrix = glm::scale(modelMatrix, glm::vec3{scale});
-  modelMatrix *= cameraRotateInverse;
+void Renderer::addLabel(const FontManager::FontBannerRenderInfo &info, const glm::vec3 &location) {
+  if (labelAnchors.size() < fontManager.labelCount())
+    labelAnchors.resize(fontManager.labelCount(), glm::vec4{0.0f});
 
-  // ----- Background -----
+  labelAnchors[info.label] = glm::vec4{location + labelOffset, 1.0f};
+  labelsAdded = true;
+}
+
+void Renderer::renderLabels(float scale) {
+  if (!labelsAdded)
+    return;
+
+  labelAnchors.resize(fontManager.labelCount(), glm::vec4{0.0f});
+  glState.bindBuffer(GL_TEXTURE_BUFFER, labelAnchorVbo);
+  glBufferData(GL_TEXTURE_BUFFER, static_cast<GLsizeiptr>(sizeof(glm::vec4) * labelAnchors.size()),
+               labelAnchors.data(), GL_STREAM_DRAW);
+  stats::frameCounters.bufferUploads++;
+
+  glState.bindTexture(1u, GL_TEXTURE_BUFFER, labelAnchorTexture);
+
+  fontManager.bind();
+
+  // ----- Backgrounds -----
   startTransparentDark();
   fontBackgroundShader.bind();
-  fontBackgroundShader.uniform("model", glm::translate(modelMatrix, {0.0, 0.0, -0.01f}));
-
-  glBindVertexArray(info.backgroundVao);
-  glBindBuffer(GL_ARRAY_BUFFER, info.backgroundVbo);
-  glDrawArrays(GL_TRIANGLES, 0, info.backgroundVboSize);
+  fontBackgroundShader.uniform("scale", scale);
+  glDrawArrays(GL_TRIANGLES, 0, fontManager.backgroundVertexCount());
+  stats::frameCounters.drawCalls++;
 
   // ----- Glyphs -----
   startTransparentLight();
-
   textureCache.use(fontManager.getAtlasTexture());
 
   fontShader.bind();
-  fontShader.uniform("model", modelMatrix);
+  fontShader.uniform("scale", scale);
+  glDrawArrays(GL_TRIANGLES, fontManager.backgroundVertexCount(), fontManager.glyphVertexCount());
+  stats::frameCounters.drawCalls++;
 
-  glBindVertexArray(info.glyphVao);
-  glBindBuffer(GL_ARRAY_BUFFER, info.glyphVbo);
-  glDrawArrays(GL_TRIANGLES, 0, info.glyphVboSize);
+  // Hide every label until it's added again
+  std::fill(labelAnchors.begin(), labelAnchors.end(), glm::vec4{0.0f});
+  labelsAdded = false;
 }
 
 } // namespace netsimulyzer
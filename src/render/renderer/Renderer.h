@@ -32,8 +32,6 @@
  */
 
 #pragma once
-#include "../../group/area/Area.h"
-#include "../../group/building/Building.h"
 #include "../Light.h"
 #include "../camera/Camera.h"
 #include "../helper/Floor.h"
@@ -42,36 +40,91 @@
 #include "../model/ModelCache.h"
 #include "../shader/Shader.h"
 #include "../texture/TextureCache.h"
-#include "src/group/link/WiredLink.h"
+#include "RenderQueue.h"
+#include "src/group/link/WiredLinkBatch.h"
 #include "src/group/node/Node.h"
+#include "src/group/node/NodeStore.h"
 #include "src/group/node/TrailBuffer.h"
+#include "src/group/node/TrajectoryBuffer.h"
 #include "src/render/font/FontManager.h"
 #include "src/render/font/character.h"
+#include "src/render/framebuffer/HeatmapFramebuffer.h"
+#include "src/render/framebuffer/MinimapFramebuffer.h"
+#include "src/render/framebuffer/SceneFramebuffer.h"
 #include "src/render/helper/CoordinateGrid.h"
+#include "src/render/helper/DecorationBatch.h"
+#include "src/render/helper/LightClusters.h"
+#include "src/render/helper/OcclusionQueries.h"
 #include "src/render/helper/SkyBox.h"
+#include "src/render/helper/StaticGeometry.h"
+#include "src/render/helper/StaticTiles.h"
 #include <QOpenGLFunctions_3_3_Core>
+#include <QOpenGLFunctions_4_3_Core>
+#include <array>
+#include <cstddef>
+#include <cstdint>
 #include <glm/glm.hpp>
+#include <optional>
 #include <sstream>
+#include <unordered_map>
 #include <vector>
 
 namespace netsimulyzer {
 
 class Renderer : protected QOpenGLFunctions_3_3_Core {
+public:
+  /**
+   * How the model draws of `flush()` are issued
+   */
+  enum class Backend {
+    /**
+     * One draw call per queued item
+     */
+    Core33,
+
+    /**
+     * Runs of instanced items sharing the same state are
+     * drawn with one `glMultiDrawElementsIndirect()` call.
+     * Requires OpenGL 4.3
+     */
+    Indirect43
+  };
+
+private:
   ModelCache &modelCache;
   TextureCache &textureCache;
   FontManager &fontManager;
 
   /**
-   * Camera view matrix with the
-   * rotation inverted.
-   *
-   * Apply this to a model matrix
-   * to have it always facing the
-   * camera
+   * The contents of the `Frame` uniform block, see `shaders/frame.glsl`.
+   * Laid out by std140 rules, so each vec3 is padded out by the float after it
+   */
+  struct FrameUniforms {
+    glm::mat4 view{1.0f};
+    glm::mat4 projection{1.0f};
+    glm::vec3 eyePosition{0.0f};
+
+    /**
+     * The simulation time in milliseconds, for the motion of Nodes.
+     * See `setMotionTime()`
+     */
+    float motionTime{0.0f};
+
+    glm::vec3 directionalLightColor{1.0f};
+    float directionalLightAmbientIntensity{0.0f};
+    glm::vec3 directionalLightDirection{0.0f, -1.0f, 0.0f};
+    float directionalLightDiffuseIntensity{0.0f};
+  };
+  static_assert(sizeof(FrameUniforms) == 176u, "FrameUniforms must match the std140 layout of the Frame block");
+
+  /**
+   * The binding point of `frameUbo`, shared by every shader
    */
-  glm::mat4 cameraRotateInverse;
+  static constexpr unsigned int frameBinding = 0u;
+
+  FrameUniforms frameUniforms;
+  unsigned int frameUbo{0u};
 
-  Shader areaShader;
   Shader buildingShader;
   Shader gridShader;
   Shader modelShader;
@@ -79,25 +132,449 @@ class Renderer : protected QOpenGLFunctions_3_3_Core {
   Shader pickingShader;
   Shader fontShader;
   Shader fontBackgroundShader;
+  Shader transmissionShader;
+  Shader staticShader;
+  Shader upscaleShader;
+  Shader heatmapSplatShader;
+  Shader heatmapShader;
+  Shader minimapShader;
+  Shader trajectoryShader;
+  Shader occlusionShader;
+  Shader probeShader;
+
+  /**
+   * Reads the centers of `transmissionInstanceVbo` for the transmission splats of `accumulateHeatmap()`
+   */
+  unsigned int heatmapVao{0u};
+
+  /**
+   * Bound for the full screen triangle of `upscale()`,
+   * & the boxes of the occlusion queries, which have no vertex attributes
+   */
+  unsigned int emptyVao{0u};
+
+  /**
+   * Arguments for `glMultiDrawElements()`, kept between frames to reuse the allocations
+   */
+  std::vector<GLsizei> multiDrawCounts;
+  std::vector<const void *> multiDrawOffsets;
+
+  /**
+   * Locations of the per-draw uniforms in `modelShader`,
+   * resolved once in `init()`
+   */
+  struct ModelUniforms {
+    int model{-1};
+    int isSelected{-1};
+    int selectedObject{-1};
+    int hasSelectedObject{-1};
+    int useLighting{-1};
+    int instanced{-1};
+    ModelRenderInfo::MaterialUniforms material;
+  } modelUniforms;
+
+  /**
+   * Model draws submitted this frame, drawn by `flush()`
+   */
+  RenderQueue renderQueue;
+
+  /**
+   * Layout of the commands read by `glMultiDrawElementsIndirect()`
+   */
+  struct DrawCommand {
+    unsigned int count;
+    unsigned int instanceCount;
+    unsigned int firstIndex;
+    int baseVertex;
+    unsigned int baseInstance;
+  };
+
+  Backend backend{Backend::Core33};
+
+  /**
+   * Only set for `Backend::Indirect43`
+   */
+  QOpenGLFunctions_4_3_Core *indirectGl{nullptr};
+
+  /**
+   * The `DrawCommand`s of a `flush()`, in `GL_DRAW_INDIRECT_BUFFER`
+   */
+  unsigned int indirectBuffer{0u};
+
+  /**
+   * The contents of `indirectBuffer`.
+   * Kept between flushes to reuse the allocation
+   */
+  std::vector<DrawCommand> indirectCommands;
+
+  /**
+   * The attributes of one Node in `nodeDataTexture`, as 7 RGBA32F texels.
+   * Matches the reads of the model & picking shaders
+   */
+  struct NodeData {
+    glm::mat4 model{1.0f};
+
+    /**
+     * Colors for base/highlight materials.
+     * An alpha of 0 uses the material's own color
+     */
+    glm::vec4 baseColor{0.0f};
+    glm::vec4 highlightColor{0.0f};
+
+    /**
+     * The ID written to the picking framebuffer,
+     * and compared against the selected Node.
+     * Stored as a float, rather than its bits, since small IDs would be denormals.
+     * Exact up to 2^24
+     */
+    float objectId{0.0f};
+
+    /**
+     * The span of `NodeStore::Motion`, in milliseconds
+     */
+    float motionStart{0.0f};
+    float motionEnd{0.0f};
+    float padding{0.0f};
+
+    /**
+     * `NodeStore::Motion::offset`, the W is unused
+     */
+    glm::vec4 motionOffset{0.0f};
+  };
+
+  /**
+   * One `NodeData` per slot of the `NodeStore`,
+   * only rewritten where the store changed
+   */
+  unsigned int nodeDataVbo{0u};
+  unsigned int nodeDataTexture{0u};
+
+  /**
+   * The number of `NodeData`s `nodeDataVbo` has room for
+   */
+  std::size_t nodeDataCapacity{0u};
+
+  /**
+   * The contents of `nodeDataVbo`
+   */
+  std::vector<NodeData> nodeData;
+
+  /**
+   * Every light from `uploadLights()`, as 3 RGBA32F texels each,
+   * and the lights of each cluster, as R32UI texels
+   */
+  unsigned int lightVbo{0u};
+  unsigned int lightTexture{0u};
+  unsigned int clusterVbo{0u};
+  unsigned int clusterTexture{0u};
+  LightClusters lightClusters;
+
+  /**
+   * The slot of every visible Node, grouped by model
+   */
+  unsigned int nodeInstanceVbo{0u};
+
+  /**
+   * Slots for each model, by level of detail, rebuilt by `uploadNodeInstances()`.
+   * Kept between frames to reuse the allocations
+   */
+  std::unordered_map<model_id, std::array<std::vector<Mesh::Instance>, ModelRenderInfo::maxLevels>>
+      nodeInstanceGroups;
+
+  struct InstanceRange {
+    model_id model;
+    std::size_t level;
+    std::size_t first;
+    int count;
+  };
+
+  /**
+   * The instances in `nodeInstanceVbo` for each model
+   */
+  std::vector<InstanceRange> nodeInstanceRanges;
+
+  /**
+   * The contents of `nodeInstanceVbo`
+   */
+  std::vector<Mesh::Instance> nodeInstances;
+
+  /**
+   * One `Mesh::TransmissionInstance` per transmission from the last `uploadTransmissions()`
+   */
+  unsigned int transmissionInstanceVbo{0u};
+  int transmissionCount{0};
+
+  /**
+   * The simulation time the instance times in `transmissionInstanceVbo` are relative to.
+   * Keeps them small enough for floats
+   */
+  parser::nanoseconds transmissionEpoch{0LL};
+
+  /**
+   * The time from the last `setMotionTime()`
+   */
+  parser::nanoseconds motionTime{0LL};
+
+  /**
+   * The contents of `transmissionInstanceVbo`
+   */
+  std::vector<Mesh::TransmissionInstance> transmissionInstances;
+
+  /**
+   * Position of each label this frame, by `FontBannerRenderInfo::label`.
+   * A w of 0 hides the label
+   */
+  std::vector<glm::vec4> labelAnchors;
+
+  /**
+   * Set once a label is added, until the labels are rendered
+   */
+  bool labelsAdded{false};
+
+  /**
+   * Holds `labelAnchors` for the font shaders, read through `labelAnchorTexture`
+   */
+  unsigned int labelAnchorVbo{0u};
+  unsigned int labelAnchorTexture{0u};
+
+  /**
+   * A buffer kept for the life of the renderer, rather than for one scenario.
+   * Only reallocated to grow, so loading a scenario of about the same size again
+   * writes into the memory the last one used
+   */
+  struct RetainedBuffer {
+    unsigned int name{0u};
+
+    /**
+     * The size of the buffer, in bytes
+     */
+    std::size_t capacity{0u};
+  };
+
+  /**
+   * The vertices & indices of every Building & Area, see `allocate(StaticGeometry &)`
+   */
+  RetainedBuffer staticVertices;
+  RetainedBuffer staticIndices;
+  unsigned int staticGeometryVao{0u};
 
+  /**
+   * Point the bound VAO at the bound `StaticGeometry::Vertex` buffer
+   */
+  void setStaticAttributes();
+
+  /**
+   * The endpoints of every wired link, see `allocateWiredLinks()`
+   */
+  RetainedBuffer wiredLinkVertices;
+  unsigned int wiredLinkVao{0u};
+
+  /**
+   * The placements of the batched Decorations, see `allocate(DecorationBatch &)`
+   */
+  RetainedBuffer decorationPlacements;
+
+  /**
+   * The minimum height on screen, as a fraction of the screen height,
+   * for each level of detail but the last
+   */
+  static constexpr std::array<float, ModelRenderInfo::maxLevels - 1u> levelScreenHeights{0.1f, 0.03f};
+
+  /**
+   * The camera position from the last `use()`
+   */
+  glm::vec3 eyePosition{0.0f};
+
+  /**
+   * The vertical scale of the projection from the last `setPerspective()`.
+   * 1 / tan(fov / 2)
+   */
+  float projectionScale{1.0f};
+
+  /**
+   * Read a program's sources & start building it, see `Shader::start()`
+   */
   void initShader(Shader &s, const QString &vertexPath, const QString &fragmentPath);
 
+  /**
+   * Upload `frameUniforms` to `frameUbo`
+   */
+  void uploadFrameUniforms();
+
+  /**
+   * Replace the contents of a retained buffer, growing it if `bytes` do not fit.
+   * The old contents are orphaned rather than waited on, keeping the same buffer.
+   * `GL_ELEMENT_ARRAY_BUFFER` is bound to the current VAO
+   *
+   * @param buffer
+   * The buffer to fill, created on first use
+   *
+   * @param target
+   * The target to bind `buffer` to
+   *
+   * @param bytes
+   * The size of `data`
+   *
+   * @param data
+   * The new contents, or null to leave them undefined
+   *
+   * @param usage
+   * The usage hint for the buffer
+   */
+  void upload(RetainedBuffer &buffer, unsigned int target, std::size_t bytes, const void *data, unsigned int usage);
+
+  /**
+   * Choose the level of detail for a model, from its size on screen
+   *
+   * @param renderInfo
+   * The model to choose the level for
+   *
+   * @param modelMatrix
+   * The transformation of the model
+   *
+   * @return
+   * The level of detail to render, 0 for full detail
+   */
+  [[nodiscard]] std::size_t levelOfDetail(const ModelRenderInfo &renderInfo, const glm::mat4 &modelMatrix) const;
+
+  /**
+   * Group the Nodes by model, and upload their slots
+   * to `nodeInstanceVbo`
+   *
+   * @param nodes
+   * The store with the Nodes to upload
+   *
+   * @param indices
+   * The indices in `nodes` of the Nodes to upload
+   */
+  void uploadNodeInstances(const NodeStore &nodes, const std::vector<std::uint32_t> &indices);
+
+  /**
+   * The texture part of the sort key for a mesh with `material`.
+   * Uses the GL name, rather than the texture ID,
+   * so meshes with textures packed in the same array sort together
+   *
+   * @return
+   * The GL name of the material's texture, unset for untextured materials
+   */
+  [[nodiscard]] std::optional<std::size_t> sortTexture(const Material &material);
+
+  /**
+   * Submit one uninstanced draw per mesh to `renderQueue`
+   *
+   * @param pass
+   * The pass to draw the meshes in
+   *
+   * @param model
+   * The model the meshes belong to
+   *
+   * @param meshes
+   * The meshes to draw
+   *
+   * @param modelMatrix
+   * The transformation of the model
+   *
+   * @param baseColor
+   * The color for base materials, unset for the material's own color
+   *
+   * @param highlightColor
+   * The color for highlight materials, unset for the material's own color
+   *
+   * @param useLighting
+   * If the meshes are lit
+   */
+  void queue(RenderQueue::Pass pass, model_id model, std::vector<Mesh> &meshes, const glm::mat4 &modelMatrix,
+             const std::optional<glm::vec3> &baseColor, const std::optional<glm::vec3> &highlightColor,
+             bool useLighting);
+
+  /**
+   * Queue the meshes of `batch` from `offset` on, in `pass`, for each group at `groups`
+   *
+   * @param pass
+   * The pass the meshes are drawn in
+   *
+   * @param transparent
+   * If the transparent meshes are queued, rather than the opaque ones
+   */
+  void queue(RenderQueue::Pass pass, const DecorationBatch &batch, const std::vector<std::uint32_t> &groups,
+             bool transparent);
+
 public:
   enum class LightingMode { LightingEnabled, LightingDisabled };
-  const unsigned int maxPointLights = 5u;
-  const unsigned int maxSpotLights = 5u;
 
   Renderer(ModelCache &modelCache, TextureCache &textureCache, FontManager &fontManager);
   void init();
+
+  /**
+   * @return
+   * The backend chosen by `init()`
+   */
+  [[nodiscard]] Backend getBackend() const;
+
+  /**
+   * @return
+   * The bytes of the per-frame buffers the renderer holds on the GPU:
+   * Node data, instances, transmissions, label anchors, & draw commands,
+   * along with the retained scenario buffers.
+   * Meshes, textures, & trails are counted by their owners
+   */
+  [[nodiscard]] std::size_t getGpuBytes() const;
+
   void setPerspective(const glm::mat4 &perspective);
 
-  void setPointLightCount(unsigned int count);
-  void setSpotLightCount(unsigned int count);
+  /**
+   * Upload the lights of the scene, and bin them into the clusters of the current view,
+   * for the models drawn next. Call after `use()` each time the view changes
+   *
+   * @param lights
+   * Every point & spot light, in world space
+   */
+  void uploadLights(const std::vector<PointLight> &lights);
+
+  /**
+   * Upload the Buildings & Areas added to `geometry`.
+   * The buffers are the renderer's, reused by the next geometry, so only one may be drawn at a time
+   *
+   * @param geometry
+   * The geometry to upload
+   */
+  void allocate(StaticGeometry &geometry);
+
+  /**
+   * Upload one tile of a `StaticTiles` into buffers of its own, staged in `uploadRing`,
+   * which must be flushed before the tile is drawn
+   *
+   * @param geometry
+   * The tile to upload
+   */
+  void allocateTile(StaticGeometry &geometry);
+
+  /**
+   * Free the buffers of a tile from `allocateTile()`.
+   * The tile must no longer be drawn
+   *
+   * @param geometry
+   * The tile to free
+   */
+  void releaseTile(StaticGeometry &geometry);
+
+  /**
+   * Upload the placements baked by `DecorationBatch::build()`.
+   * The buffer is the renderer's, reused by the next batch
+   *
+   * @param batch
+   * The batch to upload
+   */
+  void allocate(DecorationBatch &batch);
 
-  TrailBuffer allocateTrailBuffer(QOpenGLFunctions_3_3_Core *openGl, int size);
-  Building::RenderInfo allocate(const parser::Building &building);
-  Area::RenderInfo allocate(const parser::Area &area);
-  WiredLink::RenderInfo allocate(const parser::WiredLink &link);
+  /**
+   * Size the buffer for every wired link.
+   * The buffer is the renderer's, reused by the next batch
+   *
+   * @param vertexCount
+   * The number of endpoints from `WiredLinkBatch::layout()`
+   */
+  WiredLinkBatch::RenderInfo allocateWiredLinks(std::size_t vertexCount);
   Mesh allocateFloor(float size);
   void resize(Floor &f, float size);
   CoordinateGrid::RenderInfo allocateCoordinateGrid(float size, int stepSize);
@@ -109,22 +586,347 @@ public:
 
   void renderPickingNode(unsigned int nodeId, const Model &m);
 
+  /**
+   * Copy the Nodes changed since the last call into the node data texture,
+   * read by the instanced Node draws.
+   * Changes are staged in `uploadRing`, which must be flushed before those draws each frame
+   *
+   * @param nodes
+   * The store to copy from. Its changes are taken
+   */
+  void uploadNodeData(NodeStore &nodes);
+
+  /**
+   * Render Nodes to the picking framebuffer,
+   * one instanced draw per mesh of each model
+   *
+   * @param nodes
+   * The store with the Nodes to render
+   *
+   * @param indices
+   * The indices in `nodes` of the Nodes to render
+   */
+  void renderPickingNodes(const NodeStore &nodes, const std::vector<std::uint32_t> &indices);
+
   void use(const Camera &cam);
+
+  /**
+   * Use a view which is not from a `Camera`, such as the top down view of the minimap
+   *
+   * @param view
+   * The view matrix
+   *
+   * @param eye
+   * The position the view is from
+   */
+  void use(const glm::mat4 &view, const glm::vec3 &eye);
+
+  /**
+   * Set the time Nodes are moved to along their `NodeStore::Motion`.
+   * Uploaded with the next `use()`
+   *
+   * @param time
+   * The current simulation time
+   */
+  void setMotionTime(parser::nanoseconds time);
   void render(const DirectionalLight &light);
-  void render(const PointLight &light);
-  void render(const SpotLight &light);
-  void render(const std::vector<Area> &areas);
-  void render(const std::vector<Building> &buildings);
-  void renderOutlines(const std::vector<Building> &buildings, const glm::vec3 &color);
+
+  /**
+   * Render some of the items in one pass of `geometry`,
+   * in one draw
+   *
+   * @param geometry
+   * The merged geometry to render from
+   *
+   * @param pass
+   * The pass the items are in
+   *
+   * @param items
+   * The items to render, sorted
+   *
+   * @param color
+   * A color for every vertex, unset for the color of each item
+   */
+  void render(const StaticGeometry &geometry, StaticGeometry::Pass pass, const std::vector<std::uint32_t> &items,
+              const std::optional<glm::vec3> &color = {});
+
+  /**
+   * Render every item in one pass of `geometry`
+   *
+   * @param geometry
+   * The merged geometry to render from
+   *
+   * @param pass
+   * The pass to render
+   */
+  void render(const StaticGeometry &geometry, StaticGeometry::Pass pass);
+
+  /**
+   * Render one pass of every loaded tile,
+   * and the coarse boxes of the tiles which are not, for the `Buildings` pass
+   *
+   * @param tiles
+   * The tiles to render
+   *
+   * @param pass
+   * The pass to render
+   *
+   * @param culled
+   * Only render the Buildings sorted into the tiles by `StaticTiles::select()`,
+   * otherwise every item of each tile
+   *
+   * @param color
+   * A color for every vertex, unset for the color of each item.
+   * Only used when `culled`
+   */
+  void render(const StaticTiles &tiles, StaticGeometry::Pass pass, bool culled,
+              const std::optional<glm::vec3> &color = {});
+  /**
+   * Issue an occlusion query for each test, against the depth drawn so far.
+   * Nothing is written to the color or depth buffers
+   *
+   * @param queries
+   * The queries to issue. Tests whose last query has no result yet are skipped
+   *
+   * @param tests
+   * The bounds to test
+   */
+  void render(OcclusionQueries &queries, const std::vector<OcclusionQueries::Test> &tests);
   void renderTrail(const TrailBuffer &buffer, const glm::vec3 &color);
+
+  /**
+   * Render the trail of one Node from its trajectory,
+   * from `window` before the time of the last `setMotionTime()`, up to it
+   *
+   * @param buffer
+   * The trajectories of every Node, uploaded
+   *
+   * @param slot
+   * The slot of the Node
+   *
+   * @param color
+   * The color of the trail
+   *
+   * @param window
+   * The span of time the trail covers
+   *
+   * @param interpolated
+   * True if Nodes move between their points, rather than jumping to each
+   */
+  void renderTrajectory(TrajectoryBuffer &buffer, std::uint32_t slot, const glm::vec3 &color,
+                        parser::nanoseconds window, bool interpolated);
   void render(const Node &node, bool isSelected, LightingMode lightingMode = LightingMode::LightingEnabled);
+
+  /**
+   * Queue the opaque meshes of Nodes,
+   * one instanced draw per mesh of each model.
+   * Drawn by the next `flush()`
+   *
+   * @param nodes
+   * The store with the Nodes to render
+   *
+   * @param indices
+   * The indices in `nodes` of the Nodes to render
+   *
+   * @param selectedNode
+   * The ID of the selected Node, if there is one
+   */
+  void render(const NodeStore &nodes, const std::vector<std::uint32_t> &indices,
+              std::optional<unsigned int> selectedNode);
+
+  /**
+   * Queue the transparent meshes of the Node at `index` in `nodes`.
+   * Drawn by the next `flush()`
+   *
+   * @param nodes
+   * The store with the Node to render
+   *
+   * @param index
+   * The index of the Node in `nodes`
+   */
+  void renderTransparent(const NodeStore &nodes, std::size_t index);
+
+  /**
+   * Queue the opaque meshes of the groups of `batch` at `groups`,
+   * each mesh drawn at every placement in one draw, by the next `flush()`
+   *
+   * @param batch
+   * The uploaded batch
+   *
+   * @param groups
+   * The indices of the visible groups in `batch`
+   */
+  void render(const DecorationBatch &batch, const std::vector<std::uint32_t> &groups);
+
+  /**
+   * Queue the transparent meshes of the groups of `batch` at `groups`,
+   * the same as `render()`
+   */
+  void renderTransparent(const DecorationBatch &batch, const std::vector<std::uint32_t> &groups);
+
+  // Queue the opaque or transparent meshes of `m`, drawn by the next `flush()`
   void render(const Model &m, LightingMode lightingMode = LightingMode::LightingEnabled);
   void renderTransparent(const Model &m, LightingMode lightingMode = LightingMode::LightingEnabled);
+
+  /**
+   * Sort, then draw, everything queued since the last flush.
+   * Opaque draws come before transparent ones, which are drawn in the dark transparent mode.
+   * The state of the last pass is left set
+   */
+  void flush();
+
+  /**
+   * Replace the transmissions drawn by `renderTransmissions()`.
+   * Only needed when a transmission starts, ends, or leaves the view,
+   * the spheres grow on their own
+   *
+   * @param nodes
+   * The store with the transmitting Nodes
+   *
+   * @param indices
+   * The indices in `nodes` of the Nodes with a transmission to draw
+   *
+   * @param time
+   * The current simulation time
+   */
+  void uploadTransmissions(const NodeStore &nodes, const std::vector<std::uint32_t> &indices,
+                           parser::nanoseconds time);
+
+  /**
+   * Draw a sphere for each transmission from the last `uploadTransmissions()`,
+   * in one instanced draw per mesh of `sphere`
+   *
+   * @param sphere
+   * The model drawn for each transmission
+   *
+   * @param time
+   * The current simulation time, which sets the size of each sphere
+   */
+  void renderTransmissions(const Model &sphere, parser::nanoseconds time);
   void render(Floor &f);
   void render(SkyBox &skyBox);
   void render(CoordinateGrid &coordinateGrid);
-  void render(const std::vector<WiredLink> &wiredLinks);
-  void renderFont(const FontManager::FontBannerRenderInfo &info, const glm::vec3 &location, float scale);
+  void render(WiredLinkBatch &wiredLinks);
+
+  /**
+   * How far above its location a label is drawn
+   */
+  // TODO: Maybe make this configurable?
+  static constexpr glm::vec3 labelOffset{0.0f, 2.0f, 0.0f};
+
+  /**
+   * Show a label this frame. Labels are drawn together by `renderLabels()`
+   *
+   * @param info
+   * The label to show
+   *
+   * @param location
+   * The point the label hovers over
+   */
+  void addLabel(const FontManager::FontBannerRenderInfo &info, const glm::vec3 &location);
+
+  /**
+   * Render every label added since the last call,
+   * the backgrounds in one draw, then the glyphs in another.
+   * Ends in the light transparent mode
+   *
+   * @param scale
+   * The size of the labels
+   */
+  void renderLabels(float scale);
+
+  /**
+   * Rebuild the density of `heatmap` from the Nodes in the last `uploadNodeData()`
+   * & the transmissions from the last `uploadTransmissions()`.
+   * Each is drawn as one additive point, so the cost only depends on the number of Nodes.
+   * Restores the bound framebuffer & viewport after
+   *
+   * @param heatmap
+   * The target to accumulate into, cleared first
+   *
+   * @param nodeCount
+   * The number of Nodes in the `NodeStore`
+   *
+   * @param low
+   * The minimum X & Z of the ground covered by the heatmap
+   *
+   * @param high
+   * The maximum X & Z of the ground covered by the heatmap
+   *
+   * @param time
+   * The current simulation time, transmissions not active at this time are skipped
+   */
+  void accumulateHeatmap(const HeatmapFramebuffer &heatmap, std::size_t nodeCount, const glm::vec2 &low,
+                         const glm::vec2 &high, parser::nanoseconds time);
+
+  /**
+   * Draw the density from `accumulateHeatmap()` over the ground, as a color ramp.
+   * Blended over the opaque scene, so draw after it
+   *
+   * @param heatmap
+   * The accumulated density
+   *
+   * @param low
+   * The minimum X & Z passed to `accumulateHeatmap()`
+   *
+   * @param high
+   * The maximum X & Z passed to `accumulateHeatmap()`
+   *
+   * @param height
+   * The height of the ground
+   */
+  void renderHeatmap(const HeatmapFramebuffer &heatmap, const glm::vec2 &low, const glm::vec2 &high, float height);
+
+  /**
+   * Redraw the map of `minimap` from its static content,
+   * with a dot over it for each Node in the last `uploadNodeData()`, in one point draw.
+   * Restores the bound framebuffer & viewport after
+   *
+   * @param minimap
+   * The target to redraw, with its static content already drawn
+   *
+   * @param nodeCount
+   * The number of Nodes in the `NodeStore`
+   *
+   * @param low
+   * The minimum X & Z of the ground covered by the minimap
+   *
+   * @param high
+   * The maximum X & Z of the ground covered by the minimap
+   *
+   * @param selectedNode
+   * The ID of the Node to mark, if any
+   */
+  void updateMinimap(const MinimapFramebuffer &minimap, std::size_t nodeCount, const glm::vec2 &low,
+                     const glm::vec2 &high, const std::optional<unsigned int> &selectedNode);
+
+  /**
+   * Draw the map from `updateMinimap()` over the whole viewport of the bound framebuffer.
+   * Leaves depth testing enabled & blending disabled
+   *
+   * @param minimap
+   * The minimap to draw
+   */
+  void renderMinimap(const MinimapFramebuffer &minimap);
+
+  /**
+   * Draw the resolved scene over the whole viewport of the bound framebuffer,
+   * scaled with linear filtering. Leaves depth testing enabled & blending disabled
+   *
+   * @param scene
+   * The target the scene was drawn to, after `SceneFramebuffer::resolve()`
+   */
+  void upscale(const SceneFramebuffer &scene);
+
+  /**
+   * Draw the synthetic workload of `PerformanceProbe`:
+   * `layers` blended, full screen triangles over the viewport of the bound framebuffer.
+   * Leaves depth testing enabled & blending disabled
+   *
+   * @param layers
+   * The number of times each pixel is shaded
+   */
+  void renderProbe(int layers);
 };
 
 } // namespace netsimulyzer
@@ -0,0 +1,229 @@
+/*
+ * NIST-developed software is provided by NIST as a public service. You may use,
+ * copy and distribute copies of the software in any medium, provided that you
+ * keep intact this entire notice. You may improve,modify and create derivative
+ * works of the software or any portion of the software, and you may copy and
+ * distribute such modifications or works. Modified works should carry a notice
+ * stating that you changed the software and should note the date and nature of
+ * any such change. Please explicitly acknowledge the National Institute of
+ * Standards and Technology as the source of the software.
+ *
+ * NIST-developed software is expressly provided "AS IS." NIST MAKES NO
+ * WARRANTY OF ANY KIND, EXPRESS, IMPLIED, IN FACT OR ARISING BY OPERATION OF
+ * LAW, INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTY OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, NON-INFRINGEMENT
+ * AND DATA ACCURACY. NIST NEITHER REPRESENTS NOR WARRANTS THAT THE
+ * OPERATION OF THE SOFTWARE WILL BE UNINTERRUPTED OR ERROR-FREE, OR THAT
+ * ANY DEFECTS WILL BE CORRECTED. NIST DOES NOT WARRANT OR MAKE ANY
+ * REPRESENTATIONS REGARDING THE USE OF THE SOFTWARE OR THE RESULTS THEREOF,
+ * INCLUDING BUT NOT LIMITED TO THE CORRECTNESS, ACCURACY, RELIABILITY,
+ * OR USEFULNESS OF THE SOFTWARE.
+ *
+ * You are solely responsible for determining the appropriateness of using and
+ * distributing the software and you assume all risks associated with its use,
+ * including but not limited to the risks and costs of program errors,
+ * compliance with applicable laws, damage to or loss of data, programs or
+ * equipment, and the unavailability or interruption of operation. This
+ * software is not intended to be used in any situation where a failure could
+ * cause risk of injury or damage to property. The software developed by NIST
+ * employees is not subject to copyright protection within the United States.
+ *
+ * Author: Evan Black <evan.black@nist.gov>
+ */
+
+#include "UploadRing.h"
+#include "GlState.h"
+#include "src/render/render-stats.h"
+#include <QOpenGLContext>
+#include <algorithm>
+#include <cstring>
+
+namespace netsimulyzer {
+
+void UploadRing::allocate(Segment &segment, std::size_t capacity) {
+  release(segment);
+  glGenBuffers(1, &segment.buffer);
+  glState.bindBuffer(GL_COPY_READ_BUFFER, segment.buffer);
+  segment.capacity = capacity;
+
+  if (!bufferStorage) {
+    glBufferData(GL_COPY_READ_BUFFER, static_cast<GLsizeiptr>(capacity), nullptr, GL_STREAM_DRAW);
+    return;
+  }
+
+  // Coherent, so the copies see what was written before them without a flush
+  constexpr GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+  bufferStorage(GL_COPY_READ_BUFFER, static_cast<GLsizeiptr>(capacity), nullptr, flags);
+  const auto mapped = glMapBufferRange(GL_COPY_READ_BUFFER, 0, static_cast<GLsizeiptr>(capacity), flags);
+  segment.mapped = static_cast<char *>(mapped);
+}
+
+void UploadRing::release(Segment &segment) {
+  if (segment.fence) {
+    glDeleteSync(segment.fence);
+    segment.fence = nullptr;
+  }
+
+  // Deleting a buffer unmaps it
+  glState.deleteBuffer(segment.buffer);
+  segment.buffer = 0u;
+  segment.capacity = 0u;
+  segment.mapped = nullptr;
+}
+
+char *UploadRing::reserve(std::size_t bytes) {
+  auto &segment = ring[current];
+  if (head + bytes > segment.capacity)
+    return nullptr;
+
+  // A persistent mapping is never replaced, see `allocate()`
+  if (!segment.mapped && bufferStorage)
+    return nullptr;
+
+  if (!segment.mapped) {
+    // The fence on this segment has passed, so nothing past `head` is still being read
+    glState.bindBuffer(GL_COPY_READ_BUFFER, segment.buffer);
+    const auto mapped = glMapBufferRange(GL_COPY_READ_BUFFER, static_cast<GLintptr>(head),
+                                         static_cast<GLsizeiptr>(segment.capacity - head),
+                                         GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+    if (!mapped)
+      return nullptr;
+
+    segment.mapped = static_cast<char *>(mapped);
+    mappedFrom = head;
+  }
+
+  return segment.mapped + (head - mappedFrom);
+}
+
+void UploadRing::init() {
+  initializeOpenGLFunctions();
+
+  const auto context = QOpenGLContext::currentContext();
+  if (context->format().version() >= qMakePair(4, 4) ||
+      context->hasExtension(QByteArrayLiteral("GL_ARB_buffer_storage")))
+    bufferStorage = reinterpret_cast<BufferStorage>(context->getProcAddress("glBufferStorage"));
+
+  for (auto &segment : ring)
+    allocate(segment, minimumCapacity);
+
+  // A persistent mapping may still fail, so use ordinary ones for every segment
+  if (bufferStorage &&
+      std::any_of(ring.begin(), ring.end(), [](const Segment &segment) { return segment.mapped == nullptr; })) {
+    bufferStorage = nullptr;
+    for (auto &segment : ring)
+      allocate(segment, minimumCapacity);
+  }
+
+  current = 0u;
+  head = 0u;
+  mappedFrom = 0u;
+  written = 0u;
+  pending.clear();
+}
+
+void UploadRing::destroy() {
+  for (auto &segment : ring)
+    release(segment);
+  pending.clear();
+  head = 0u;
+}
+
+void UploadRing::write(unsigned int buffer, std::size_t offset, const void *data, std::size_t bytes) {
+  if (bytes == 0u)
+    return;
+  written += bytes;
+
+  const auto staged = reserve(bytes);
+  if (!staged) {
+    // Past the end of this frame's segment, so written directly.
+    // The staged writes go first, they may overlap this one
+    flush();
+    glState.bindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+    glBufferSubData(GL_COPY_WRITE_BUFFER, static_cast<GLintptr>(offset), static_cast<GLsizeiptr>(bytes), data);
+    stats::frameCounters.bufferUploads++;
+    return;
+  }
+
+  std::memcpy(staged, data, bytes);
+
+  if (!pending.empty()) {
+    auto &last = pending.back();
+    if (last.buffer == buffer && last.source + last.bytes == head && last.destination + last.bytes == offset) {
+      last.bytes += bytes;
+      head += bytes;
+      return;
+    }
+  }
+
+  pending.push_back({buffer, head, offset, bytes});
+  head += bytes;
+}
+
+void UploadRing::flush() {
+  if (pending.empty())
+    return;
+
+  auto &segment = ring[current];
+  glState.bindBuffer(GL_COPY_READ_BUFFER, segment.buffer);
+  if (!bufferStorage) {
+    glUnmapBuffer(GL_COPY_READ_BUFFER);
+    segment.mapped = nullptr;
+  }
+
+  for (const auto &copy : pending) {
+    glState.bindBuffer(GL_COPY_WRITE_BUFFER, copy.buffer);
+    glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, static_cast<GLintptr>(copy.source),
+                        static_cast<GLintptr>(copy.destination), static_cast<GLsizeiptr>(copy.bytes));
+    stats::frameCounters.bufferUploads++;
+  }
+  pending.clear();
+}
+
+void UploadRing::endFrame() {
+  flush();
+
+  if (head > 0u) {
+    auto &segment = ring[current];
+    segment.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+  }
+
+  current = (current + 1u) % segments;
+  head = 0u;
+  mappedFrom = 0u;
+
+  // Room for the most written in the last frame, with a quarter spare
+  const auto wanted = std::clamp(written + written / 4u, minimumCapacity, maximumCapacity);
+  written = 0u;
+
+  auto &next = ring[current];
+  if (next.fence) {
+    // Two frames on, so this rarely waits
+    constexpr GLuint64 timeout = 1'000'000'000u;
+    const auto status = glClientWaitSync(next.fence, GL_SYNC_FLUSH_COMMANDS_BIT, timeout);
+    glDeleteSync(next.fence);
+    next.fence = nullptr;
+
+    // Never written to while it may still be read, a new buffer takes its place instead
+    if (status == GL_TIMEOUT_EXPIRED || status == GL_WAIT_FAILED) {
+      allocate(next, std::max(wanted, next.capacity));
+      return;
+    }
+  }
+
+  if (wanted > next.capacity)
+    allocate(next, wanted);
+}
+
+bool UploadRing::isPersistent() const noexcept {
+  return bufferStorage != nullptr;
+}
+
+std::size_t UploadRing::getGpuBytes() const noexcept {
+  std::size_t bytes = 0u;
+  for (const auto &segment : ring)
+    bytes += segment.capacity;
+  return bytes;
+}
+
+} // namespace netsimulyzer
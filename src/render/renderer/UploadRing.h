@@ -0,0 +1,207 @@
+/*
+ * NIST-developed software is provided by NIST as a public service. You may use,
+ * copy and distribute copies of the software in any medium, provided that you
+ * keep intact this entire notice. You may improve,modify and create derivative
+ * works of the software or any portion of the software, and you may copy and
+ * distribute such modifications or works. Modified works should carry a notice
+ * stating that you changed the software and should note the date and nature of
+ * any such change. Please explicitly acknowledge the National Institute of
+ * Standards and Technology as the source of the software.
+ *
+ * NIST-developed software is expressly provided "AS IS." NIST MAKES NO
+ * WARRANTY OF ANY KIND, EXPRESS, IMPLIED, IN FACT OR ARISING BY OPERATION OF
+ * LAW, INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTY OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, NON-INFRINGEMENT
+ * AND DATA ACCURACY. NIST NEITHER REPRESENTS NOR WARRANTS THAT THE
+ * OPERATION OF THE SOFTWARE WILL BE UNINTERRUPTED OR ERROR-FREE, OR THAT
+ * ANY DEFECTS WILL BE CORRECTED. NIST DOES NOT WARRANT OR MAKE ANY
+ * REPRESENTATIONS REGARDING THE USE OF THE SOFTWARE OR THE RESULTS THEREOF,
+ * INCLUDING BUT NOT LIMITED TO THE CORRECTNESS, ACCURACY, RELIABILITY,
+ * OR USEFULNESS OF THE SOFTWARE.
+ *
+ * You are solely responsible for determining the appropriateness of using and
+ * distributing the software and you assume all risks associated with its use,
+ * including but not limited to the risks and costs of program errors,
+ * compliance with applicable laws, damage to or loss of data, programs or
+ * equipment, and the unavailability or interruption of operation. This
+ * software is not intended to be used in any situation where a failure could
+ * cause risk of injury or damage to property. The software developed by NIST
+ * employees is not subject to copyright protection within the United States.
+ *
+ * Author: Evan Black <evan.black@nist.gov>
+ */
+
+#pragma once
+
+#include <QOpenGLFunctions_3_3_Core>
+#include <array>
+#include <cstddef>
+#include <vector>
+
+namespace netsimulyzer {
+
+/**
+ * Staging memory for the buffers rewritten every frame: Node data, motion trails & wired links.
+ *
+ * Writes are copied into one of three staging buffers, then `flush()` issues a
+ * `glCopyBufferSubData()` per run of writes, rather than a `glBufferSubData()` per write.
+ * Where `glBufferStorage()` is available (GL 4.4, or `GL_ARB_buffer_storage`) the staging buffers
+ * stay mapped for their whole life, otherwise the unwritten part is mapped unsynchronized when needed.
+ * Each staging buffer is fenced at the end of its frame, & is waited on before it is reused
+ * two frames later, which the GPU has nearly always finished by then.
+ *
+ * Only use this with the scene's context, like `GlState`
+ */
+class UploadRing : protected QOpenGLFunctions_3_3_Core {
+public:
+  static constexpr std::size_t segments = 3u;
+
+private:
+  /**
+   * The smallest & largest size of a staging buffer.
+   * Each grows to the most written in a frame, writes past the largest are issued directly
+   */
+  static constexpr std::size_t minimumCapacity = 1024u * 1024u;
+  static constexpr std::size_t maximumCapacity = 64u * 1024u * 1024u;
+
+  using BufferStorage = void(QOPENGLF_APIENTRYP)(GLenum, GLsizeiptr, const void *, GLbitfield);
+
+  struct Segment {
+    unsigned int buffer{0u};
+    std::size_t capacity{0u};
+
+    /**
+     * The mapping of the staging buffer.
+     * Without `bufferStorage`, only set between the first write after a flush & the next flush,
+     * and starts at `mappedFrom` rather than the beginning of the buffer
+     */
+    char *mapped{nullptr};
+
+    /**
+     * Signalled once the copies from this segment are done.
+     * Unset if it has not been written to since it was last waited on
+     */
+    GLsync fence{nullptr};
+  };
+
+  struct Copy {
+    unsigned int buffer;
+    std::size_t source;
+    std::size_t destination;
+    std::size_t bytes;
+  };
+
+  /**
+   * Null unless persistent mappings are available
+   */
+  BufferStorage bufferStorage{nullptr};
+
+  std::array<Segment, segments> ring;
+
+  /**
+   * The segment written to this frame
+   */
+  std::size_t current{0u};
+
+  /**
+   * The next free byte in the current segment
+   */
+  std::size_t head{0u};
+
+  /**
+   * Where the mapping of the current segment starts, see `Segment::mapped`
+   */
+  std::size_t mappedFrom{0u};
+
+  /**
+   * Bytes written this frame, including those which did not fit.
+   * Sizes the segment used next
+   */
+  std::size_t written{0u};
+
+  /**
+   * Copies out of the current segment, not yet issued
+   */
+  std::vector<Copy> pending;
+
+  /**
+   * Replace the staging buffer of `segment` with one of `capacity` bytes
+   */
+  void allocate(Segment &segment, std::size_t capacity);
+  void release(Segment &segment);
+
+  /**
+   * Make room for `bytes` at `head` of the current segment
+   *
+   * @return
+   * Where to write them, null if they don't fit
+   */
+  [[nodiscard]] char *reserve(std::size_t bytes);
+
+public:
+  UploadRing() = default;
+  UploadRing(const UploadRing &other) = delete;
+  UploadRing &operator=(const UploadRing &other) = delete;
+
+  /**
+   * Load the GL functions & allocate the staging buffers.
+   * Must be called with the scene's context current
+   */
+  void init();
+
+  /**
+   * Free the staging buffers. Requires the scene's context
+   */
+  void destroy();
+
+  /**
+   * Stage a write into a buffer. Nothing reaches `buffer` until `flush()`.
+   * Writes which continue the last one in both the staging & the destination buffer
+   * share its copy
+   *
+   * @param buffer
+   * The buffer to write to. Must not be deleted or reallocated
+   * until the write is flushed
+   *
+   * @param offset
+   * Where in `buffer` to write, in bytes
+   *
+   * @param data
+   * The data to write. Copied before this returns
+   *
+   * @param bytes
+   * The size of `data`
+   */
+  void write(unsigned int buffer, std::size_t offset, const void *data, std::size_t bytes);
+
+  /**
+   * Issue the copies of every staged write.
+   * Call before drawing from the written buffers, or reallocating them
+   */
+  void flush();
+
+  /**
+   * Flush, fence the current segment, & move on to the next.
+   * Call once each frame is drawn
+   */
+  void endFrame();
+
+  /**
+   * @return
+   * If the staging buffers are mapped persistently
+   */
+  [[nodiscard]] bool isPersistent() const noexcept;
+
+  /**
+   * @return
+   * The size of every staging buffer, in bytes
+   */
+  [[nodiscard]] std::size_t getGpuBytes() const noexcept;
+};
+
+/**
+ * Staging for the scene's context. Only touched from the thread with that context
+ */
+inline UploadRing uploadRing;
+
+} // namespace netsimulyzer
@@ -32,8 +32,60 @@
  */
 
 #include "Shader.h"
+#include "../renderer/GlState.h"
+#include <QByteArray>
+#include <QCryptographicHash>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QOpenGLFunctions>
+#include <QOpenGLContext>
+#include <QOpenGLExtraFunctions>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <cstring>
 #include <glm/gtc/type_ptr.hpp>
 
+namespace {
+
+/**
+ * Where linked programs are kept between runs, see `Shader::saveBinary()`.
+ * One directory per driver, named by its vendor, renderer, & version strings,
+ * since programs are only valid for the driver which built them.
+ *
+ * Directories left by other drivers (i.e. before an update) are removed on first use,
+ * so the cache does not grow with each driver installed
+ *
+ * @return
+ * The directory for the current context's driver
+ */
+QString shaderCacheDirectory() {
+  static const auto directory = []() {
+    const auto gl = QOpenGLContext::currentContext()->functions();
+    QCryptographicHash hash{QCryptographicHash::Sha1};
+    for (const auto name : {GL_VENDOR, GL_RENDERER, GL_VERSION})
+      hash.addData(reinterpret_cast<const char *>(gl->glGetString(name)));
+    const auto driver = QString::fromLatin1(hash.result().toHex());
+
+    QDir base{QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/shaders"};
+    for (const auto &entry : base.entryInfoList(QDir::Dirs | QDir::Files | QDir::NoDotAndDotDot)) {
+      if (entry.fileName() == driver)
+        continue;
+
+      if (entry.isDir())
+        QDir{entry.filePath()}.removeRecursively();
+      else
+        QFile::remove(entry.filePath());
+    }
+
+    return base.filePath(driver);
+  }();
+
+  return directory;
+}
+
+} // namespace
+
 void log_uniform(int location, std::string_view name) {
 #ifndef NDEBUG
   if (location == -1)
@@ -48,11 +100,71 @@ namespace netsimulyzer {
 unsigned int Shader::compile(unsigned int type, const char *src) {
   const auto id = glCreateShader(type);
   glShaderSource(id, 1, &src, nullptr);
+
+  // Checked in `finish()`, so the driver need not finish now
   glCompileShader(id);
+  return id;
+}
+
+Shader::~Shader() {
+  glState.deleteProgram(glId);
+}
+
+void Shader::init(const std::string &vertex, const std::string &fragment) {
+  start(vertex, fragment);
+  finish();
+}
+
+void Shader::start(const std::string &vertex, const std::string &fragment) {
+  initializeOpenGLFunctions();
+  glId = glCreateProgram();
+
+  const auto context = QOpenGLContext::currentContext();
+  const auto hasBinaries = context->hasExtension(QByteArrayLiteral("GL_ARB_get_program_binary")) ||
+                           context->format().version() >= qMakePair(4, 1);
+
+  // Some drivers (i.e. older Mesa) support the functions, but no formats to save with them
+  int binaryFormats = 0;
+  if (hasBinaries)
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &binaryFormats);
 
-  int result;
-  glGetShaderiv(id, GL_COMPILE_STATUS, &result);
-  if (!result) {
+  if (binaryFormats > 0) {
+    // The driver is part of the directory, see `shaderCacheDirectory()`
+    QCryptographicHash hash{QCryptographicHash::Sha1};
+    hash.addData(vertex.c_str(), static_cast<int>(vertex.size()));
+    hash.addData(fragment.c_str(), static_cast<int>(fragment.size()));
+    binaryName = QString::fromLatin1(hash.result().toHex());
+
+    if (loadBinary())
+      return;
+
+    // Otherwise the driver may never keep the binary
+    context->extraFunctions()->glProgramParameteri(glId, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+  }
+
+  vertexId = compile(GL_VERTEX_SHADER, vertex.c_str());
+  fragmentId = compile(GL_FRAGMENT_SHADER, fragment.c_str());
+
+  glAttachShader(glId, vertexId);
+  glAttachShader(glId, fragmentId);
+  glLinkProgram(glId);
+}
+
+void Shader::finish() {
+  // Loaded from the binary cache
+  if (vertexId == 0u)
+    return;
+
+  // The first status query waits for the driver
+  auto compiled = true;
+  for (const auto id : {vertexId, fragmentId}) {
+    int result;
+    glGetShaderiv(id, GL_COMPILE_STATUS, &result);
+    if (result)
+      continue;
+
+    int type;
+    glGetShaderiv(id, GL_SHADER_TYPE, &type);
     int length;
     glGetShaderiv(id, GL_INFO_LOG_LENGTH, &length);
     auto message = reinterpret_cast<char *>(alloca(length));
@@ -61,48 +173,77 @@ unsigned int Shader::compile(unsigned int type, const char *src) {
     std::cerr << "Error, failed to compile shader type: " << (type == GL_VERTEX_SHADER ? "vertex" : "fragment") << '\n'
               << "----- MESSAGE -----\n"
               << message << '\n';
-
-    glDeleteShader(id);
-    return 0;
+    compiled = false;
   }
 
-  return id;
-}
-
-unsigned int Shader::createProgram(const std::string &vertex, const std::string &fragment) {
-  const auto program_id = glCreateProgram();
-  const auto vertex_shader = compile(GL_VERTEX_SHADER, vertex.c_str());
-  const auto fragment_shader = compile(GL_FRAGMENT_SHADER, fragment.c_str());
-
-  glAttachShader(program_id, vertex_shader);
-  glAttachShader(program_id, fragment_shader);
-  glLinkProgram(program_id);
-  glValidateProgram(program_id);
-
-  int is_valid;
-  glGetProgramiv(program_id, GL_VALIDATE_STATUS, &is_valid);
-  if (!is_valid) {
+  int linked;
+  glGetProgramiv(glId, GL_LINK_STATUS, &linked);
+  if (compiled && !linked) {
     int length;
-    glGetProgramiv(program_id, GL_INFO_LOG_LENGTH, &length);
+    glGetProgramiv(glId, GL_INFO_LOG_LENGTH, &length);
     auto message = reinterpret_cast<char *>(alloca(length));
 
-    glGetProgramInfoLog(program_id, length, nullptr, message);
+    glGetProgramInfoLog(glId, length, nullptr, message);
     std::cerr << "msg:\n" << message;
-
-    glDeleteShader(vertex_shader);
-    glDeleteShader(fragment_shader);
   }
 
-  return program_id;
+  // The program keeps what it needs once linked
+  glDetachShader(glId, vertexId);
+  glDetachShader(glId, fragmentId);
+  glDeleteShader(vertexId);
+  glDeleteShader(fragmentId);
+  vertexId = 0u;
+  fragmentId = 0u;
+
+  if (compiled && linked && !binaryName.isEmpty())
+    saveBinary();
 }
 
-Shader::~Shader() {
-  glDeleteProgram(glId);
+bool Shader::loadBinary() {
+  QFile file{shaderCacheDirectory() + '/' + binaryName};
+  if (!file.open(QFile::ReadOnly))
+    return false;
+
+  const auto contents = file.readAll();
+  GLenum format;
+  if (static_cast<std::size_t>(contents.size()) <= sizeof(format))
+    return false;
+  std::memcpy(&format, contents.constData(), sizeof(format));
+
+  QOpenGLContext::currentContext()->extraFunctions()->glProgramBinary(
+      glId, format, contents.constData() + sizeof(format), contents.size() - static_cast<int>(sizeof(format)));
+
+  // Rejected when the driver changed in a way the name does not catch, so build it again
+  int linked;
+  glGetProgramiv(glId, GL_LINK_STATUS, &linked);
+  if (linked)
+    return true;
+
+  glState.deleteProgram(glId);
+  glId = glCreateProgram();
+  return false;
 }
 
-void Shader::init(const std::string &vertex, const std::string &fragment) {
-  initializeOpenGLFunctions();
-  glId = createProgram(vertex, fragment);
+void Shader::saveBinary() {
+  int length = 0;
+  glGetProgramiv(glId, GL_PROGRAM_BINARY_LENGTH, &length);
+  if (length <= 0)
+    return;
+
+  QByteArray contents{static_cast<int>(sizeof(GLenum)) + length, Qt::Uninitialized};
+  GLenum format;
+  QOpenGLContext::currentContext()->extraFunctions()->glGetProgramBinary(glId, length, nullptr, &format,
+                                                                         contents.data() + sizeof(format));
+  std::memcpy(contents.data(), &format, sizeof(format));
+
+  const auto directory = shaderCacheDirectory();
+  if (!QDir{}.mkpath(directory))
+    return;
+
+  // Another copy of the application may be reading the old one
+  QSaveFile file{directory + '/' + binaryName};
+  if (file.open(QFile::WriteOnly) && file.write(contents) == contents.size())
+    file.commit();
 }
 
 void Shader::uniform(const std::string &name, const glm::vec3 &value) {
@@ -216,12 +357,61 @@ void Shader::uniform(const std::string &name, bool value) {
   glUniform1i(location, static_cast<int>(value));
 }
 
+int Shader::location(const std::string &name) {
+  auto cached_location = uniform_cache.find(name);
+  if (cached_location != uniform_cache.end())
+    return cached_location->second;
+
+  auto location = glGetUniformLocation(glId, name.c_str());
+  log_uniform(location, name);
+  uniform_cache.emplace(name, location);
+  return location;
+}
+
+void Shader::uniform(int location, const glm::vec3 &value) {
+  bind();
+  glUniform3f(location, value.x, value.y, value.z);
+}
+
+void Shader::uniform(int location, float value) {
+  bind();
+  glUniform1f(location, value);
+}
+
+void Shader::uniform(int location, const glm::mat4 &value) {
+  bind();
+  glUniformMatrix4fv(location, 1, GL_FALSE, glm::value_ptr(value));
+}
+
+void Shader::uniform(int location, int value) {
+  bind();
+  glUniform1i(location, value);
+}
+
+void Shader::uniform(int location, unsigned int value) {
+  bind();
+  glUniform1ui(location, value);
+}
+
+void Shader::uniform(int location, bool value) {
+  bind();
+  glUniform1i(location, static_cast<int>(value));
+}
+
+void Shader::bindBlock(const std::string &name, unsigned int binding) {
+  const auto index = glGetUniformBlockIndex(glId, name.c_str());
+  if (index == GL_INVALID_INDEX)
+    return;
+
+  glUniformBlockBinding(glId, index, binding);
+}
+
 void Shader::bind() {
-  glUseProgram(glId);
+  glState.useProgram(glId);
 }
 
 void Shader::unbind() {
-  glUseProgram(0u);
+  glState.useProgram(0u);
 }
 
 } // namespace netsimulyzer
@@ -33,6 +33,7 @@
 
 #pragma once
 #include <QOpenGLFunctions_3_3_Core>
+#include <QString>
 #include <cstdio>
 #include <fstream>
 #include <glm/glm.hpp>
@@ -46,13 +47,64 @@ class Shader : protected QOpenGLFunctions_3_3_Core {
   std::unordered_map<std::string, int> uniform_cache;
   unsigned int glId = 0u;
 
+  /**
+   * Shaders compiling for `glId`, between `start()` & `finish()`.
+   * 0 once finished, or if the program was loaded from the binary cache
+   */
+  unsigned int vertexId = 0u;
+  unsigned int fragmentId = 0u;
+
+  /**
+   * Name of the program's file in the binary cache, from a hash of its sources.
+   * Empty if the driver cannot save programs
+   */
+  QString binaryName;
+
   unsigned int compile(unsigned int type, const char *src);
-  unsigned int createProgram(const std::string &vertex, const std::string &fragment);
+
+  /**
+   * Load the program from the binary cache
+   *
+   * @return
+   * True if the cached program was loaded & linked
+   */
+  bool loadBinary();
+
+  /**
+   * Save the linked program to the binary cache, for the next start
+   */
+  void saveBinary();
 
 public:
   ~Shader() override;
+
+  /**
+   * Build the program at once, see `start()` & `finish()`
+   */
   void init(const std::string &vertex, const std::string &fragment);
 
+  /**
+   * Begin building the program, without waiting for the result.
+   * Start every program before finishing any,
+   * so a driver which compiles in the background
+   * (i.e. with `GL_KHR_parallel_shader_compile`) may build them at the same time.
+   *
+   * Programs built before, by the same driver, are loaded from the binary cache instead
+   *
+   * @param vertex
+   * The source of the vertex shader
+   *
+   * @param fragment
+   * The source of the fragment shader
+   */
+  void start(const std::string &vertex, const std::string &fragment);
+
+  /**
+   * Wait for the program from `start()`, report any errors, and save it to the binary cache.
+   * Must be called before the program is used
+   */
+  void finish();
+
   void uniform(const std::string &name, const glm::vec3 &value);
   void uniform(const std::string &name, const glm::vec2 &value);
   void uniform(const std::string &name, float value);
@@ -62,6 +114,38 @@ public:
   void uniform(const std::string &name, unsigned int value);
   void uniform(const std::string &name, bool value);
 
+  /**
+   * Find the location of a uniform once,
+   * for the `uniform()` overloads taking a location
+   *
+   * @param name
+   * The name of the uniform in the shader
+   *
+   * @return
+   * The location of the uniform, -1 if the shader does not use it
+   */
+  [[nodiscard]] int location(const std::string &name);
+
+  // Set uniforms by a location from `location()`, without the name lookup
+  void uniform(int location, const glm::vec3 &value);
+  void uniform(int location, float value);
+  void uniform(int location, const glm::mat4 &value);
+  void uniform(int location, int value);
+  void uniform(int location, unsigned int value);
+  void uniform(int location, bool value);
+
+  /**
+   * Attach a uniform block to a uniform buffer binding point.
+   * Blocks unused by the shader are ignored
+   *
+   * @param name
+   * The name of the block in the shader
+   *
+   * @param binding
+   * The binding point (index) of the `GL_UNIFORM_BUFFER` to read the block from
+   */
+  void bindBlock(const std::string &name, unsigned int binding);
+
   void bind();
   void unbind();
 };
@@ -0,0 +1,522 @@
+/*
+ * NIST-developed software is provided by NIST as a public service. You may use,
+ * copy and distribute copies of the software in any medium, provided that you
+ * keep intact this entire notice. You may improve,modify and create derivative
+ * works of the software or any portion of the software, and you may copy and
+ * distribute such modifications or works. Modified works should carry a notice
+ * stating that you changed the software and should note the date and nature of
+ * any such change. Please explicitly acknowledge the National Institute of
+ * Standards and Technology as the source of the software.
+ *
+ * NIST-developed software is expressly provided "AS IS." NIST MAKES NO
+ * WARRANTY OF ANY KIND, EXPRESS, IMPLIED, IN FACT OR ARISING BY OPERATION OF
+ * LAW, INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTY OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, NON-INFRINGEMENT
+ * AND DATA ACCURACY. NIST NEITHER REPRESENTS NOR WARRANTS THAT THE
+ * OPERATION OF THE SOFTWARE WILL BE UNINTERRUPTED OR ERROR-FREE, OR THAT
+ * ANY DEFECTS WILL BE CORRECTED. NIST DOES NOT WARRANT OR MAKE ANY
+ * REPRESENTATIONS REGARDING THE USE OF THE SOFTWARE OR THE RESULTS THEREOF,
+ * INCLUDING BUT NOT LIMITED TO THE CORRECTNESS, ACCURACY, RELIABILITY,
+ * OR USEFULNESS OF THE SOFTWARE.
+ *
+ * You are solely responsible for determining the appropriateness of using and
+ * distributing the software and you assume all risks associated with its use,
+ * including but not limited to the risks and costs of program errors,
+ * compliance with applicable laws, damage to or loss of data, programs or
+ * equipment, and the unavailability or interruption of operation. This
+ * software is not intended to be used in any situation where a failure could
+ * cause risk of injury or damage to property. The software developed by NIST
+ * employees is not subject to copyright protection within the United States.
+ *
+ * Author: Evan Black <evan.black@nist.gov>
+ */
+
+#include "CompressedImage.h"
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+
+namespace netsimulyzer {
+
+namespace {
+
+// '«KTX 11»\r\n\x1A\n'
+constexpr std::array<unsigned char, 12> ktxIdentifier{0xABu, 0x4Bu, 0x54u, 0x58u, 0x20u, 0x31u,
+                                                      0x31u, 0xBBu, 0x0Du, 0x0Au, 0x1Au, 0x0Au};
+constexpr std::uint32_t ktxEndianness = 0x04030201u;
+
+constexpr unsigned int glRgb = 0x1907u;
+constexpr unsigned int glRgba = 0x1908u;
+
+struct KtxHeader {
+  std::uint32_t endianness;
+  std::uint32_t glType;
+  std::uint32_t glTypeSize;
+  std::uint32_t glFormat;
+  std::uint32_t glInternalFormat;
+  std::uint32_t glBaseInternalFormat;
+  std::uint32_t pixelWidth;
+  std::uint32_t pixelHeight;
+  std::uint32_t pixelDepth;
+  std::uint32_t numberOfArrayElements;
+  std::uint32_t numberOfFaces;
+  std::uint32_t numberOfMipmapLevels;
+  std::uint32_t bytesOfKeyValueData;
+};
+
+struct DdsPixelFormat {
+  std::uint32_t size;
+  std::uint32_t flags;
+  std::uint32_t fourCC;
+  std::uint32_t rgbBitCount;
+  std::array<std::uint32_t, 4> masks;
+};
+
+struct DdsHeader {
+  std::uint32_t size;
+  std::uint32_t flags;
+  std::uint32_t height;
+  std::uint32_t width;
+  std::uint32_t pitchOrLinearSize;
+  std::uint32_t depth;
+  std::uint32_t mipMapCount;
+  std::array<std::uint32_t, 11> reserved1;
+  DdsPixelFormat pixelFormat;
+  std::uint32_t caps;
+  std::uint32_t caps2;
+  std::uint32_t caps3;
+  std::uint32_t caps4;
+  std::uint32_t reserved2;
+};
+
+struct DdsHeaderDx10 {
+  std::uint32_t dxgiFormat;
+  std::uint32_t resourceDimension;
+  std::uint32_t miscFlag;
+  std::uint32_t arraySize;
+  std::uint32_t miscFlags2;
+};
+
+static_assert(sizeof(DdsHeader) == 124u, "DDS header must match the file layout");
+
+constexpr std::uint32_t fourCC(const char (&code)[5]) {
+  return static_cast<std::uint32_t>(code[0]) | static_cast<std::uint32_t>(code[1]) << 8u |
+         static_cast<std::uint32_t>(code[2]) << 16u | static_cast<std::uint32_t>(code[3]) << 24u;
+}
+
+/**
+ * Size of one 4x4 block of `internalFormat`, 0 if the format isn't known
+ */
+int blockBytes(unsigned int internalFormat) {
+  using namespace compressed_format;
+  switch (internalFormat) {
+  case rgbDxt1:
+  case rgbaDxt1:
+  case redRgtc1:
+  case rgb8Etc2:
+    return 8;
+  case rgbaDxt3:
+  case rgbaDxt5:
+  case rgRgtc2:
+  case rgbaBptc:
+  case rgba8Etc2Eac:
+    return 16;
+  default:
+    return 0;
+  }
+}
+
+int levelBytes(unsigned int internalFormat, int width, int height) {
+  return blockBytes(internalFormat) * ((width + 3) / 4) * ((height + 3) / 4);
+}
+
+/**
+ * Reads fixed size values from the front of a file's contents
+ */
+class Reader {
+  const QByteArray &bytes;
+  int offset{0};
+
+public:
+  explicit Reader(const QByteArray &bytes) : bytes(bytes) {
+  }
+
+  template <class T>
+  bool read(T &value) {
+    if (bytes.size() - offset < static_cast<int>(sizeof(T)))
+      return false;
+
+    std::memcpy(&value, bytes.constData() + offset, sizeof(T));
+    offset += static_cast<int>(sizeof(T));
+    return true;
+  }
+
+  bool read(int size, QByteArray &value) {
+    if (size < 0 || bytes.size() - offset < size)
+      return false;
+
+    value = bytes.mid(offset, size);
+    offset += size;
+    return true;
+  }
+
+  bool skip(int size) {
+    if (size < 0 || bytes.size() - offset < size)
+      return false;
+
+    offset += size;
+    return true;
+  }
+};
+
+std::optional<CompressedImage> readKtx(const QByteArray &bytes) {
+  Reader reader{bytes};
+
+  std::array<unsigned char, 12> identifier{};
+  KtxHeader header{};
+  if (!reader.read(identifier) || identifier != ktxIdentifier || !reader.read(header) ||
+      header.endianness != ktxEndianness)
+    return {};
+
+  // Only compressed 2D textures
+  if (header.glType != 0u || header.pixelDepth > 1u || header.numberOfArrayElements > 0u ||
+      header.numberOfFaces != 1u || blockBytes(header.glInternalFormat) == 0)
+    return {};
+
+  const auto maxDimension = static_cast<std::uint32_t>(std::numeric_limits<int>::max());
+  if (header.pixelWidth == 0u || header.pixelHeight == 0u || header.pixelWidth > maxDimension ||
+      header.pixelHeight > maxDimension || header.bytesOfKeyValueData > maxDimension)
+    return {};
+
+  if (!reader.skip(static_cast<int>(header.bytesOfKeyValueData)))
+    return {};
+
+  CompressedImage image;
+  image.internalFormat = header.glInternalFormat;
+
+  auto width = static_cast<int>(header.pixelWidth);
+  auto height = static_cast<int>(header.pixelHeight);
+  const auto levels = std::max(1u, header.numberOfMipmapLevels);
+  for (auto i = 0u; i < levels; i++) {
+    std::uint32_t imageSize;
+    const auto expectedSize = levelBytes(image.internalFormat, width, height);
+    if (!reader.read(imageSize) || imageSize != static_cast<std::uint32_t>(expectedSize))
+      return {};
+
+    auto &level = image.levels.emplace_back();
+    level.width = width;
+    level.height = height;
+    if (!reader.read(static_cast<int>(imageSize), level.data))
+      return {};
+
+    // Levels are padded to 4 bytes, which every block size already is
+    width = std::max(1, width / 2);
+    height = std::max(1, height / 2);
+  }
+
+  return image;
+}
+
+std::optional<CompressedImage> readDds(const QByteArray &bytes) {
+  using namespace compressed_format;
+  Reader reader{bytes};
+
+  std::uint32_t magic;
+  DdsHeader header{};
+  if (!reader.read(magic) || magic != fourCC("DDS ") || !reader.read(header) || header.size != sizeof(DdsHeader))
+    return {};
+
+  // Cube maps & volumes are not read
+  constexpr std::uint32_t cubeMapOrVolume = 0x200u | 0x200000u;
+  constexpr std::uint32_t fourCCFlag = 0x4u;
+  if ((header.caps2 & cubeMapOrVolume) != 0u || (header.pixelFormat.flags & fourCCFlag) == 0u)
+    return {};
+
+  CompressedImage image;
+  switch (header.pixelFormat.fourCC) {
+  case fourCC("DXT1"):
+    image.internalFormat = rgbaDxt1;
+    break;
+  case fourCC("DXT3"):
+    image.internalFormat = rgbaDxt3;
+    break;
+  case fourCC("DXT5"):
+    image.internalFormat = rgbaDxt5;
+    break;
+  case fourCC("ATI1"):
+  case fourCC("BC4U"):
+    image.internalFormat = redRgtc1;
+    break;
+  case fourCC("ATI2"):
+  case fourCC("BC5U"):
+    image.internalFormat = rgRgtc2;
+    break;
+  case fourCC("DX10"): {
+    DdsHeaderDx10 extended{};
+    // Only a single 2D texture
+    if (!reader.read(extended) || extended.resourceDimension != 3u || extended.arraySize > 1u)
+      return {};
+
+    switch (extended.dxgiFormat) {
+    case 71u: // BC1_UNORM
+      image.internalFormat = rgbaDxt1;
+      break;
+    case 74u: // BC2_UNORM
+      image.internalFormat = rgbaDxt3;
+      break;
+    case 77u: // BC3_UNORM
+      image.internalFormat = rgbaDxt5;
+      break;
+    case 80u: // BC4_UNORM
+      image.internalFormat = redRgtc1;
+      break;
+    case 83u: // BC5_UNORM
+      image.internalFormat = rgRgtc2;
+      break;
+    case 98u: // BC7_UNORM
+      image.internalFormat = rgbaBptc;
+      break;
+    default:
+      return {};
+    }
+    break;
+  }
+  default:
+    return {};
+  }
+
+  const auto maxDimension = static_cast<std::uint32_t>(std::numeric_limits<int>::max());
+  if (header.width == 0u || header.height == 0u || header.width > maxDimension || header.height > maxDimension)
+    return {};
+
+  auto width = static_cast<int>(header.width);
+  auto height = static_cast<int>(header.height);
+  const auto levels = std::max(1u, header.mipMapCount);
+  for (auto i = 0u; i < levels; i++) {
+    auto &level = image.levels.emplace_back();
+    level.width = width;
+    level.height = height;
+    if (!reader.read(levelBytes(image.internalFormat, width, height), level.data))
+      return {};
+
+    width = std::max(1, width / 2);
+    height = std::max(1, height / 2);
+  }
+
+  return image;
+}
+
+std::uint16_t toRgb565(const std::array<int, 3> &color) {
+  return static_cast<std::uint16_t>(((color[0] * 31 + 127) / 255) << 11 | ((color[1] * 63 + 127) / 255) << 5 |
+                                    ((color[2] * 31 + 127) / 255));
+}
+
+std::array<int, 3> fromRgb565(std::uint16_t color) {
+  const auto r = (color >> 11u) & 0x1Fu;
+  const auto g = (color >> 5u) & 0x3Fu;
+  const auto b = color & 0x1Fu;
+  return {static_cast<int>(r << 3u | r >> 2u), static_cast<int>(g << 2u | g >> 4u),
+          static_cast<int>(b << 3u | b >> 2u)};
+}
+
+/**
+ * Append the BC1 color block for one 4x4 block of RGBA texels,
+ * always in the 4 color mode, so it may also be used by BC3.
+ * The endpoints are the corners of the block's bounding box
+ */
+void compressColorBlock(const std::array<std::array<int, 4>, 16> &texels, QByteArray &output) {
+  std::array<int, 3> low{255, 255, 255};
+  std::array<int, 3> high{0, 0, 0};
+  for (const auto &texel : texels) {
+    for (auto c = 0u; c < 3u; c++) {
+      low[c] = std::min(low[c], texel[c]);
+      high[c] = std::max(high[c], texel[c]);
+    }
+  }
+
+  auto color0 = toRgb565(high);
+  auto color1 = toRgb565(low);
+  // The 4 color mode requires color0 > color1
+  if (color0 < color1)
+    std::swap(color0, color1);
+
+  std::uint32_t indices = 0u;
+  if (color0 != color1) {
+    const auto end0 = fromRgb565(color0);
+    const auto end1 = fromRgb565(color1);
+    std::array<std::array<int, 3>, 4> palette{end0, end1};
+    for (auto c = 0u; c < 3u; c++) {
+      palette[2][c] = (2 * end0[c] + end1[c]) / 3;
+      palette[3][c] = (end0[c] + 2 * end1[c]) / 3;
+    }
+
+    for (auto i = 0u; i < texels.size(); i++) {
+      auto best = 0u;
+      auto bestDistance = std::numeric_limits<int>::max();
+      for (auto p = 0u; p < palette.size(); p++) {
+        auto distance = 0;
+        for (auto c = 0u; c < 3u; c++)
+          distance += (texels[i][c] - palette[p][c]) * (texels[i][c] - palette[p][c]);
+
+        if (distance < bestDistance) {
+          bestDistance = distance;
+          best = p;
+        }
+      }
+      indices |= best << (2u * i);
+    }
+  }
+
+  const std::array<std::uint16_t, 2> endpoints{color0, color1};
+  output.append(reinterpret_cast<const char *>(endpoints.data()), sizeof(endpoints));
+  output.append(reinterpret_cast<const char *>(&indices), sizeof(indices));
+}
+
+/**
+ * Append the BC3 alpha block for one 4x4 block of RGBA texels, in the 8 alpha mode
+ */
+void compressAlphaBlock(const std::array<std::array<int, 4>, 16> &texels, QByteArray &output) {
+  auto alpha0 = 0;
+  auto alpha1 = 255;
+  for (const auto &texel : texels) {
+    alpha0 = std::max(alpha0, texel[3]);
+    alpha1 = std::min(alpha1, texel[3]);
+  }
+
+  std::uint64_t indices = 0u;
+  if (alpha0 != alpha1) {
+    std::array<int, 8> palette{alpha0, alpha1};
+    for (auto i = 1; i < 7; i++)
+      palette[static_cast<std::size_t>(i + 1)] = ((7 - i) * alpha0 + i * alpha1) / 7;
+
+    for (auto i = 0u; i < texels.size(); i++) {
+      std::uint64_t best = 0u;
+      auto bestDistance = std::numeric_limits<int>::max();
+      for (auto p = 0u; p < palette.size(); p++) {
+        const auto distance = std::abs(texels[i][3] - palette[p]);
+        if (distance < bestDistance) {
+          bestDistance = distance;
+          best = p;
+        }
+      }
+      indices |= best << (3u * i);
+    }
+  }
+
+  output.append(static_cast<char>(alpha0));
+  output.append(static_cast<char>(alpha1));
+  // 48 bits of indices, little endian
+  for (auto i = 0u; i < 6u; i++)
+    output.append(static_cast<char>((indices >> (8u * i)) & 0xFFu));
+}
+
+CompressedImage::Level compressLevel(const QImage &image, bool withAlpha) {
+  CompressedImage::Level level;
+  level.width = image.width();
+  level.height = image.height();
+
+  std::array<std::array<int, 4>, 16> texels{};
+  for (auto blockY = 0; blockY < image.height(); blockY += 4) {
+    for (auto blockX = 0; blockX < image.width(); blockX += 4) {
+      // Blocks past the edge repeat the last row/column
+      for (auto y = 0; y < 4; y++) {
+        const auto *row = image.constScanLine(std::min(blockY + y, image.height() - 1));
+        for (auto x = 0; x < 4; x++) {
+          const auto *texel = row + 4 * std::min(blockX + x, image.width() - 1);
+          texels[static_cast<std::size_t>(y * 4 + x)] = {texel[0], texel[1], texel[2], texel[3]};
+        }
+      }
+
+      if (withAlpha)
+        compressAlphaBlock(texels, level.data);
+      compressColorBlock(texels, level.data);
+    }
+  }
+
+  return level;
+}
+
+} // namespace
+
+bool isCompressedImage(const QString &path) {
+  const auto suffix = QFileInfo{path}.suffix().toLower();
+  return suffix == "ktx" || suffix == "dds";
+}
+
+std::optional<CompressedImage> readCompressedImage(const QString &path) {
+  QFile file{path};
+  if (!file.open(QIODevice::ReadOnly))
+    return {};
+
+  const auto bytes = file.readAll();
+  if (QFileInfo{path}.suffix().toLower() == "ktx")
+    return readKtx(bytes);
+
+  return readDds(bytes);
+}
+
+CompressedImage compressImage(const QImage &image) {
+  // Byte order R, G, B, A on every platform
+  auto level = image.convertToFormat(QImage::Format_RGBA8888);
+  const auto withAlpha = level.hasAlphaChannel() && [&level]() {
+    for (auto y = 0; y < level.height(); y++) {
+      const auto *row = level.constScanLine(y);
+      for (auto x = 0; x < level.width(); x++) {
+        if (row[4 * x + 3] != 255u)
+          return true;
+      }
+    }
+    return false;
+  }();
+
+  CompressedImage result;
+  result.internalFormat = withAlpha ? compressed_format::rgbaDxt5 : compressed_format::rgbDxt1;
+
+  while (true) {
+    result.levels.emplace_back(compressLevel(level, withAlpha));
+    if (level.width() == 1 && level.height() == 1)
+      break;
+
+    level = level.scaled(std::max(1, level.width() / 2), std::max(1, level.height() / 2), Qt::IgnoreAspectRatio,
+                         Qt::SmoothTransformation);
+  }
+
+  return result;
+}
+
+bool writeKtx(const QString &path, const CompressedImage &image) {
+  if (image.levels.empty())
+    return false;
+
+  KtxHeader header{};
+  header.endianness = ktxEndianness;
+  header.glTypeSize = 1u;
+  header.glInternalFormat = image.internalFormat;
+  header.glBaseInternalFormat = image.internalFormat == compressed_format::rgbDxt1 ? glRgb : glRgba;
+  header.pixelWidth = static_cast<std::uint32_t>(image.levels.front().width);
+  header.pixelHeight = static_cast<std::uint32_t>(image.levels.front().height);
+  header.numberOfFaces = 1u;
+  header.numberOfMipmapLevels = static_cast<std::uint32_t>(image.levels.size());
+
+  QSaveFile file{path};
+  if (!file.open(QIODevice::WriteOnly))
+    return false;
+
+  file.write(reinterpret_cast<const char *>(ktxIdentifier.data()), ktxIdentifier.size());
+  file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+  for (const auto &level : image.levels) {
+    const auto imageSize = static_cast<std::uint32_t>(level.data.size());
+    file.write(reinterpret_cast<const char *>(&imageSize), sizeof(imageSize));
+    file.write(level.data);
+  }
+
+  return file.commit();
+}
+
+} // namespace netsimulyzer
@@ -0,0 +1,135 @@
+/*
+ * NIST-developed software is provided by NIST as a public service. You may use,
+ * copy and distribute copies of the software in any medium, provided that you
+ * keep intact this entire notice. You may improve,modify and create derivative
+ * works of the software or any portion of the software, and you may copy and
+ * distribute such modifications or works. Modified works should carry a notice
+ * stating that you changed the software and should note the date and nature of
+ * any such change. Please explicitly acknowledge the National Institute of
+ * Standards and Technology as the source of the software.
+ *
+ * NIST-developed software is expressly provided "AS IS." NIST MAKES NO
+ * WARRANTY OF ANY KIND, EXPRESS, IMPLIED, IN FACT OR ARISING BY OPERATION OF
+ * LAW, INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTY OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, NON-INFRINGEMENT
+ * AND DATA ACCURACY. NIST NEITHER REPRESENTS NOR WARRANTS THAT THE
+ * OPERATION OF THE SOFTWARE WILL BE UNINTERRUPTED OR ERROR-FREE, OR THAT
+ * ANY DEFECTS WILL BE CORRECTED. NIST DOES NOT WARRANT OR MAKE ANY
+ * REPRESENTATIONS REGARDING THE USE OF THE SOFTWARE OR THE RESULTS THEREOF,
+ * INCLUDING BUT NOT LIMITED TO THE CORRECTNESS, ACCURACY, RELIABILITY,
+ * OR USEFULNESS OF THE SOFTWARE.
+ *
+ * You are solely responsible for determining the appropriateness of using and
+ * distributing the software and you assume all risks associated with its use,
+ * including but not limited to the risks and costs of program errors,
+ * compliance with applicable laws, damage to or loss of data, programs or
+ * equipment, and the unavailability or interruption of operation. This
+ * software is not intended to be used in any situation where a failure could
+ * cause risk of injury or damage to property. The software developed by NIST
+ * employees is not subject to copyright protection within the United States.
+ *
+ * Author: Evan Black <evan.black@nist.gov>
+ */
+
+#pragma once
+
+#include <QByteArray>
+#include <QImage>
+#include <QString>
+#include <optional>
+#include <vector>
+
+namespace netsimulyzer {
+
+/**
+ * A texture already in a GPU compressed format, with its mipmaps,
+ * as read from a KTX or DDS container.
+ *
+ * Rows are stored top first, the same as a `QImage`,
+ * so compressed & uncompressed textures are sampled the same way
+ */
+struct CompressedImage {
+  struct Level {
+    int width{0};
+    int height{0};
+
+    /**
+     * The compressed blocks, as given to `glCompressedTexImage2D()`
+     */
+    QByteArray data;
+  };
+
+  /**
+   * The GL internal format of every level, e.g. `GL_COMPRESSED_RGBA_S3TC_DXT5_EXT`
+   */
+  unsigned int internalFormat{0u};
+
+  /**
+   * From full size down, at least one
+   */
+  std::vector<Level> levels;
+};
+
+/**
+ * GL formats not in the 3.3 core headers.
+ * The S3TC & BPTC formats come from extensions, and ETC2 is core from 4.3
+ */
+namespace compressed_format {
+constexpr unsigned int rgbDxt1 = 0x83F0u;
+constexpr unsigned int rgbaDxt1 = 0x83F1u;
+constexpr unsigned int rgbaDxt3 = 0x83F2u;
+constexpr unsigned int rgbaDxt5 = 0x83F3u;
+constexpr unsigned int redRgtc1 = 0x8DBBu;
+constexpr unsigned int rgRgtc2 = 0x8DBDu;
+constexpr unsigned int rgbaBptc = 0x8E8Cu;
+constexpr unsigned int rgb8Etc2 = 0x9274u;
+constexpr unsigned int rgba8Etc2Eac = 0x9278u;
+} // namespace compressed_format
+
+/**
+ * @param path
+ * The file to check
+ *
+ * @return
+ * True if `path` names a container read by `readCompressedImage()`, by its extension
+ */
+[[nodiscard]] bool isCompressedImage(const QString &path);
+
+/**
+ * Read a KTX (version 1) or DDS file.
+ * Only 2D textures, without arrays or cube maps, are read
+ *
+ * @param path
+ * The file to read, chosen by its extension
+ *
+ * @return
+ * The texture, unset if the file could not be read, or has an unsupported format
+ */
+[[nodiscard]] std::optional<CompressedImage> readCompressedImage(const QString &path);
+
+/**
+ * Compress `image` & its mipmaps, as BC1 if it's opaque, or BC3 otherwise
+ *
+ * @param image
+ * The image to compress, in any format
+ *
+ * @return
+ * The compressed image, with a full mipmap chain
+ */
+[[nodiscard]] CompressedImage compressImage(const QImage &image);
+
+/**
+ * Write `image` as a KTX (version 1) file
+ *
+ * @param path
+ * Where to write the file
+ *
+ * @param image
+ * The image to write
+ *
+ * @return
+ * True if the file was written
+ */
+bool writeKtx(const QString &path, const CompressedImage &image);
+
+} // namespace netsimulyzer
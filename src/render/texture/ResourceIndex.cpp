@@ -0,0 +1,184 @@
+/*
+ * NIST-developed software is provided by NIST as a public service. You may use,
+ * copy and distribute copies of the software in any medium, provided that you
+ * keep intact this entire notice. You may improve,modify and create derivative
+ * works of the software or any portion of the software, and you may copy and
+ * distribute such modifications or works. Modified works should carry a notice
+ * stating that you changed the software and should note the date and nature of
+ * any such change. Please explicitly acknowledge the National Institute of
+ * Standards and Technology as the source of the software.
+ *
+ * NIST-developed software is expressly provided "AS IS." NIST MAKES NO
+ * WARRANTY OF ANY KIND, EXPRESS, IMPLIED, IN FACT OR ARISING BY OPERATION OF
+ * LAW, INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTY OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, NON-INFRINGEMENT
+ * AND DATA ACCURACY. NIST NEITHER REPRESENTS NOR WARRANTS THAT THE
+ * OPERATION OF THE SOFTWARE WILL BE UNINTERRUPTED OR ERROR-FREE, OR THAT
+ * ANY DEFECTS WILL BE CORRECTED. NIST DOES NOT WARRANT OR MAKE ANY
+ * REPRESENTATIONS REGARDING THE USE OF THE SOFTWARE OR THE RESULTS THEREOF,
+ * INCLUDING BUT NOT LIMITED TO THE CORRECTNESS, ACCURACY, RELIABILITY,
+ * OR USEFULNESS OF THE SOFTWARE.
+ *
+ * You are solely responsible for determining the appropriateness of using and
+ * distributing the software and you assume all risks associated with its use,
+ * including but not limited to the risks and costs of program errors,
+ * compliance with applicable laws, damage to or loss of data, programs or
+ * equipment, and the unavailability or interruption of operation. This
+ * software is not intended to be used in any situation where a failure could
+ * cause risk of injury or damage to property. The software developed by NIST
+ * employees is not subject to copyright protection within the United States.
+ *
+ * Author: Evan Black <evan.black@nist.gov>
+ */
+
+#include "ResourceIndex.h"
+#include <QCryptographicHash>
+#include <QFile>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QTextStream>
+#include <iostream>
+
+namespace netsimulyzer {
+
+ResourceIndex::ResourceIndex() {
+  // Anything may have moved, so the whole index is rebuilt on the next lookup
+  QObject::connect(&watcher, &QFileSystemWatcher::directoryChanged, [this](const QString &) {
+    files.clear();
+    fresh = false;
+  });
+}
+
+void ResourceIndex::build() {
+  files.clear();
+  directories.clear();
+
+  scan(root.canonicalPath(), 1u);
+  fresh = true;
+
+  watch();
+  write();
+}
+
+void ResourceIndex::scan(const QString &directory, unsigned int depth) {
+  if (depth > maxDepth)
+    return;
+
+  directories.append(directory);
+
+  // Same walk as a search: this directory's files first, then each subdirectory
+  QDir base{directory};
+  base.setFilter(QDir::Files | QDir::Readable);
+  for (const auto &file : base.entryInfoList())
+    files.try_emplace(file.fileName().toLower().toStdString(), file.canonicalFilePath());
+
+  base.setFilter(QDir::Dirs | QDir::Readable | QDir::NoDotAndDotDot);
+  for (const auto &subDirectory : base.entryInfoList())
+    scan(subDirectory.canonicalFilePath(), depth + 1u);
+}
+
+void ResourceIndex::watch() {
+  if (!watcher.directories().isEmpty())
+    watcher.removePaths(watcher.directories());
+
+  if (!directories.isEmpty())
+    watcher.addPaths(directories);
+}
+
+QString ResourceIndex::storedPath() const {
+  const auto cacheLocation = QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
+  if (cacheLocation.isEmpty())
+    return {};
+
+  const auto hash = QCryptographicHash::hash(root.canonicalPath().toUtf8(), QCryptographicHash::Sha1).toHex();
+  return QDir{cacheLocation}.filePath(QString{"resources-%1.index"}.arg(QString::fromLatin1(hash)));
+}
+
+bool ResourceIndex::read() {
+  const auto path = storedPath();
+  if (path.isEmpty())
+    return false;
+
+  QFile file{path};
+  if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
+    return false;
+
+  // First line is the indexed directory,
+  // followed by 'D <directory>' & 'F <name> <path>' lines, separated by tabs
+  QTextStream stream{&file};
+  stream.setCodec("UTF-8");
+  if (stream.readLine() != root.canonicalPath())
+    return false;
+
+  while (!stream.atEnd()) {
+    const auto fields = stream.readLine().split('\t');
+    if (fields.size() == 2 && fields[0] == "D")
+      directories.append(fields[1]);
+    else if (fields.size() == 3 && fields[0] == "F")
+      files.try_emplace(fields[1].toStdString(), fields[2]);
+    else {
+      files.clear();
+      directories.clear();
+      return false;
+    }
+  }
+
+  return true;
+}
+
+void ResourceIndex::write() const {
+  const auto path = storedPath();
+  if (path.isEmpty() || !QDir{}.mkpath(QFileInfo{path}.path()))
+    return;
+
+  QSaveFile file{path};
+  if (!file.open(QIODevice::WriteOnly | QIODevice::Text))
+    return;
+
+  QTextStream stream{&file};
+  stream.setCodec("UTF-8");
+  stream << root.canonicalPath() << '\n';
+  for (const auto &directory : directories)
+    stream << "D\t" << directory << '\n';
+  for (const auto &[name, filePath] : files)
+    stream << "F\t" << QString::fromStdString(name) << '\t' << filePath << '\n';
+  stream.flush();
+
+  if (!file.commit())
+    std::cerr << "Failed writing resource index: " << path.toStdString() << '\n';
+}
+
+void ResourceIndex::setRoot(const QDir &value) {
+  root = value;
+  files.clear();
+  directories.clear();
+  fresh = false;
+
+  // An index from the last run is trusted until a lookup proves it wrong
+  if (read())
+    watch();
+  else
+    build();
+}
+
+std::optional<QFileInfo> ResourceIndex::find(const QString &fileName) {
+  const auto key = fileName.toLower().toStdString();
+  auto lookup = [this, &key]() -> std::optional<QFileInfo> {
+    const auto existing = files.find(key);
+    if (existing == files.end())
+      return {};
+
+    QFileInfo file{existing->second};
+    if (!file.exists())
+      return {};
+    return file;
+  };
+
+  if (auto result = lookup(); result || fresh)
+    return result;
+
+  build();
+  return lookup();
+}
+
+} // namespace netsimulyzer
@@ -0,0 +1,108 @@
+/*
+ * NIST-developed software is provided by NIST as a public service. You may use,
+ * copy and distribute copies of the software in any medium, provided that you
+ * keep intact this entire notice. You may improve,modify and create derivative
+ * works of the software or any portion of the software, and you may copy and
+ * distribute such modifications or works. Modified works should carry a notice
+ * stating that you changed the software and should note the date and nature of
+ * any such change. Please explicitly acknowledge the National Institute of
+ * Standards and Technology as the source of the software.
+ *
+ * NIST-developed software is expressly provided "AS IS." NIST MAKES NO
+ * WARRANTY OF ANY KIND, EXPRESS, IMPLIED, IN FACT OR ARISING BY OPERATION OF
+ * LAW, INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTY OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, NON-INFRINGEMENT
+ * AND DATA ACCURACY. NIST NEITHER REPRESENTS NOR WARRANTS THAT THE
+ * OPERATION OF THE SOFTWARE WILL BE UNINTERRUPTED OR ERROR-FREE, OR THAT
+ * ANY DEFECTS WILL BE CORRECTED. NIST DOES NOT WARRANT OR MAKE ANY
+ * REPRESENTATIONS REGARDING THE USE OF THE SOFTWARE OR THE RESULTS THEREOF,
+ * INCLUDING BUT NOT LIMITED TO THE CORRECTNESS, ACCURACY, RELIABILITY,
+ * OR USEFULNESS OF THE SOFTWARE.
+ *
+ * You are solely responsible for determining the appropriateness of using and
+ * distributing the software and you assume all risks associated with its use,
+ * including but not limited to the risks and costs of program errors,
+ * compliance with applicable laws, damage to or loss of data, programs or
+ * equipment, and the unavailability or interruption of operation. This
+ * software is not intended to be used in any situation where a failure could
+ * cause risk of injury or damage to property. The software developed by NIST
+ * employees is not subject to copyright protection within the United States.
+ *
+ * Author: Evan Black <evan.black@nist.gov>
+ */
+
+#pragma once
+
+#include <QDir>
+#include <QFileInfo>
+#include <QFileSystemWatcher>
+#include <QString>
+#include <optional>
+#include <string>
+#include <unordered_map>
+
+namespace netsimulyzer {
+
+/**
+ * Every file under a directory, by file name,
+ * so a file may be found without walking the directory.
+ *
+ * The index is kept between runs, and rebuilt once a watched directory changes,
+ * or when the kept index turns out to be out of date
+ */
+class ResourceIndex {
+  /**
+   * How many directories deep to index, starting at 1 for `root`
+   */
+  static constexpr unsigned int maxDepth = 25u;
+
+  QDir root;
+
+  /**
+   * The first file with each name, by lowercase name.
+   * 'First' is in the order the directories are walked: a directory's own files, then each subdirectory
+   */
+  std::unordered_map<std::string, QString> files;
+
+  /**
+   * Every indexed directory, watched for changes
+   */
+  QStringList directories;
+  QFileSystemWatcher watcher;
+
+  /**
+   * Set once the index was built by walking `root` this run,
+   * rather than read from disk or left over from before a change
+   */
+  bool fresh{false};
+
+  void build();
+  void scan(const QString &directory, unsigned int depth);
+  void watch();
+
+  [[nodiscard]] QString storedPath() const;
+  bool read();
+  void write() const;
+
+public:
+  ResourceIndex();
+
+  /**
+   * Index `value`, reading the index from the last run if there is one
+   */
+  void setRoot(const QDir &value);
+
+  /**
+   * Find a file by name anywhere under the root.
+   * Names are not case sensitive
+   *
+   * @param fileName
+   * The name of the file, without any directories
+   *
+   * @return
+   * The first file with that name, unset if there is none
+   */
+  [[nodiscard]] std::optional<QFileInfo> find(const QString &fileName);
+};
+
+} // namespace netsimulyzer
@@ -32,59 +32,54 @@
  */
 
 #include "TextureCache.h"
+#include "../renderer/GlState.h"
+#include "CompressedImage.h"
 #include <QColor>
 #include <QDebug>
 #include <QDir>
 #include <QImage>
 #include <QString>
 #include <Qt>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
 #include <iostream>
+#include <map>
+#include <trace.h>
+#include <tuple>
 #include <utility>
 
-namespace {
-std::optional<QFileInfo> findTexture(const QDir &base, const QString &fileName, unsigned int max = 25u) {
-  // Cut us off after `max` levels
-  if (max == 0u)
-    return {};
-
-  QDir searchFile{base};
-  searchFile.setFilter(QDir::Files | QDir::Readable);
-  searchFile.setNameFilters({fileName});
-
-  auto fileResults = searchFile.entryInfoList();
-  if (fileResults.count() > 0)
-    return {fileResults[0]};
-
-  QDir subDirectories{base};
-  subDirectories.setFilter(QDir::Dirs | QDir::Readable | QDir::NoDotAndDotDot);
-  // no name filter
+namespace netsimulyzer {
 
-  auto directoryResults = subDirectories.entryInfoList();
-  for (const auto &subDirectory : directoryResults) {
-    auto result = findTexture({subDirectory.canonicalFilePath()}, fileName, max - 1);
-    if (result)
-      return result;
-  }
+/**
+ * The size on the GPU of an uncompressed 4 byte per pixel texture
+ */
+static std::size_t imageBytes(int width, int height, bool mipmaps) {
+  const auto base = static_cast<std::size_t>(width) * static_cast<std::size_t>(height) * 4u;
 
-  return {};
+  // The whole chain of mipmaps adds a third
+  return mipmaps ? base + base / 3u : base;
 }
 
-} // namespace
-
-namespace netsimulyzer {
-
 void TextureCache::setResourceDirectory(const QDir &value) {
-  resourceDirectory = value;
+  resourceIndex.setRoot(value);
 }
 
 TextureCache::~TextureCache() {
   clear();
+  glState.deleteBuffer(uploadPbo);
 }
 
 bool TextureCache::init() {
   if (!initializeOpenGLFunctions())
     return false;
 
+  int compressedFormatCount = 0;
+  glGetIntegerv(GL_NUM_COMPRESSED_TEXTURE_FORMATS, &compressedFormatCount);
+  compressedFormats.resize(static_cast<std::size_t>(compressedFormatCount));
+  if (compressedFormatCount > 0)
+    glGetIntegerv(GL_COMPRESSED_TEXTURE_FORMATS, compressedFormats.data());
+
   // Generate a fallback texture
   QImage fallback{64, 64, QImage::Format::Format_ARGB32};
   fallback.fill(Qt::GlobalColor::magenta);
@@ -92,9 +87,10 @@ bool TextureCache::init() {
   Texture t;
   t.width = fallback.width();
   t.height = fallback.height();
+  t.gpuBytes = imageBytes(t.width, t.height, true);
 
   glGenTextures(1, &t.id);
-  glBindTexture(GL_TEXTURE_2D, t.id);
+  glState.bindTexture(0u, GL_TEXTURE_2D, t.id);
 
   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
@@ -105,16 +101,17 @@ bool TextureCache::init() {
 
   glGenerateMipmap(GL_TEXTURE_2D);
 
-  glBindTexture(GL_TEXTURE_2D, 0u);
-
   textures.emplace_back(t);
   fallbackTexture = textures.size() - 1;
   indexMap.emplace("fallback", fallbackTexture);
 
+  glGenBuffers(1, &uploadPbo);
+
   return true;
 }
 
 texture_id TextureCache::load(const std::string &filename) {
+  parser::trace::Scope trace{"TextureCache::load", "load"};
 
   // If we've already loaded the texture, use that ID
   auto existing = indexMap.find(filename);
@@ -122,60 +119,174 @@ texture_id TextureCache::load(const std::string &filename) {
     return existing->second;
   }
 
-  auto result = findTexture(resourceDirectory, QString::fromStdString(filename));
+  const auto name = QString::fromStdString(filename);
+
+  // Prefer a compressed version of an image, e.g. from `netsimulyzer-texconvert`
+  if (!isCompressedImage(name)) {
+    const auto baseName = QFileInfo{name}.completeBaseName();
+    for (const auto &suffix : {".ktx", ".dds"}) {
+      const auto compressedFile = resourceIndex.find(baseName + suffix);
+      if (!compressedFile)
+        continue;
+
+      if (const auto compressed = loadCompressed(compressedFile.value()); compressed) {
+        indexMap.emplace(filename, compressed.value());
+        return compressed.value();
+      }
+    }
+  }
+
+  auto result = resourceIndex.find(name);
   if (!result)
     return fallbackTexture;
 
-  QImage image{result->canonicalFilePath()};
-  if (image.isNull())
-    return fallbackTexture;
+  if (isCompressedImage(result->fileName())) {
+    const auto compressed = loadCompressed(result.value());
+    if (!compressed)
+      return fallbackTexture;
 
-  unsigned int glFormat;
-  switch (image.format()) {
-  case QImage::Format::Format_RGB32:
-    glFormat = GL_RGB;
-    break;
-  case QImage::Format::Format_ARGB32:
-    glFormat = GL_RGBA;
-    break;
-  default:
-    qDebug() << "Unsupported format: " << image.format() << "\nAttempting conversion...";
-    image = image.convertToFormat(QImage::Format_ARGB32);
-    glFormat = GL_RGBA;
+    indexMap.emplace(filename, compressed.value());
+    return compressed.value();
+  }
 
-    if (image.isNull())
-      return fallbackTexture;
+  // Shares the fallback's GL texture until `stream()` uploads the image
+  auto placeholder = textures[fallbackTexture];
+  placeholder.gpuBytes = 0u;
+  textures.emplace_back(placeholder);
+  const auto newIndex = textures.size() - 1;
+  indexMap.emplace(filename, newIndex);
+
+  const auto path = result->canonicalFilePath();
+  sources.emplace(newIndex, path);
+  pending.emplace(newIndex, path);
+  decoder.request(newIndex, path);
+  return newIndex;
+}
+
+bool TextureCache::stream() {
+  frame++;
+
+  for (auto &image : decoder.takeDecoded())
+    uploads.emplace_back(std::move(image));
+
+  std::size_t uploaded = 0u;
+  while (!uploads.empty() && uploaded < uploadBudget) {
+    const auto image = std::move(uploads.front());
+    uploads.pop_front();
+
+    // Skip images requested before a `clear()`
+    const auto request = pending.find(image.texture);
+    if (request == pending.end() || request->second != image.path)
+      continue;
+    pending.erase(request);
+
+    // Unreadable images keep the fallback
+    if (image.image.isNull()) {
+      qDebug() << "Failed to read texture: " << image.path;
+      continue;
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    upload(image);
+    uploadTime += std::chrono::steady_clock::now() - start;
+    uploaded += static_cast<std::size_t>(image.image.sizeInBytes());
+  }
+
+  return !pending.empty();
+}
+
+void TextureCache::upload(const TextureDecoder::Decoded &image) {
+  const auto size = static_cast<GLsizeiptr>(image.image.sizeInBytes());
+
+  // QImage rows are 4 byte aligned, so the 4 byte formats from the decoder are tightly packed
+  glState.bindBuffer(GL_PIXEL_UNPACK_BUFFER, uploadPbo);
+  // Orphan the last image's storage, rather than waiting for its transfer to finish
+  glBufferData(GL_PIXEL_UNPACK_BUFFER, size, nullptr, GL_STREAM_DRAW);
+  auto mapped = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+  if (!mapped) {
+    glState.bindBuffer(GL_PIXEL_UNPACK_BUFFER, 0u);
+    return;
   }
+  std::memcpy(mapped, image.image.constBits(), static_cast<std::size_t>(size));
+  // The contents are undefined if the buffer was lost while mapped, so read from client memory instead
+  const auto unmapped = glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+  if (!unmapped)
+    glState.bindBuffer(GL_PIXEL_UNPACK_BUFFER, 0u);
 
   Texture t;
-  t.height = image.height();
-  t.width = image.width();
+  t.height = image.image.height();
+  t.width = image.image.width();
+  t.gpuBytes = imageBytes(t.width, t.height, true);
 
   glGenTextures(1, &t.id);
-  glBindTexture(GL_TEXTURE_2D, t.id);
+  glState.bindTexture(0u, GL_TEXTURE_2D, t.id);
 
   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
 
-  // QImage keeps BGRA format, event without an alpha channel
-  glTexImage2D(GL_TEXTURE_2D, 0, glFormat, t.width, t.height, 0, GL_BGRA, GL_UNSIGNED_BYTE, image.constBits());
+  // QImage keeps BGRA format, event without an alpha channel.
+  // A null pointer reads from the start of `uploadPbo`
+  glTexImage2D(GL_TEXTURE_2D, 0, static_cast<GLint>(image.glFormat), t.width, t.height, 0, GL_BGRA,
+               GL_UNSIGNED_BYTE, unmapped ? nullptr : image.image.constBits());
+
+  // Leave the unpack buffer unbound, since every other upload reads from client memory
+  glState.bindBuffer(GL_PIXEL_UNPACK_BUFFER, 0u);
 
   glGenerateMipmap(GL_TEXTURE_2D);
 
-  glBindTexture(GL_TEXTURE_2D, 0u);
+  textures[image.texture] = t;
+  packCandidates.emplace_back(image.texture, image.glFormat);
+}
+
+std::optional<texture_id> TextureCache::loadCompressed(const QFileInfo &file) {
+  const auto image = readCompressedImage(file.canonicalFilePath());
+  if (!image) {
+    std::cerr << "Unreadable compressed texture: " << file.canonicalFilePath().toStdString() << '\n';
+    return {};
+  }
+
+  if (std::find(compressedFormats.begin(), compressedFormats.end(), static_cast<int>(image->internalFormat)) ==
+      compressedFormats.end()) {
+    std::cerr << "Compressed texture format 0x" << std::hex << image->internalFormat << std::dec
+              << " not supported by this context: " << file.canonicalFilePath().toStdString() << '\n';
+    return {};
+  }
+
+  const auto &levels = image->levels;
+
+  Texture t;
+  t.width = levels.front().width;
+  t.height = levels.front().height;
+  for (const auto &level : levels)
+    t.gpuBytes += static_cast<std::size_t>(level.data.size());
+
+  const auto start = std::chrono::steady_clock::now();
+  glGenTextures(1, &t.id);
+  glState.bindTexture(0u, GL_TEXTURE_2D, t.id);
+
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+  // Mipmaps can't be generated for compressed textures, so only the ones in the file are used
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, levels.size() > 1u ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, static_cast<GLint>(levels.size() - 1u));
+
+  for (std::size_t i = 0u; i < levels.size(); i++) {
+    glCompressedTexImage2D(GL_TEXTURE_2D, static_cast<GLint>(i), image->internalFormat, levels[i].width,
+                           levels[i].height, 0, levels[i].data.size(), levels[i].data.constData());
+  }
+  uploadTime += std::chrono::steady_clock::now() - start;
 
   textures.emplace_back(t);
-  const auto newIndex = textures.size() - 1;
-  indexMap.emplace(result->canonicalFilePath().toStdString(), newIndex);
-  return newIndex;
+  return textures.size() - 1u;
 }
 
 unsigned int TextureCache::load(const CubeMap &cubeMap) {
   unsigned int id;
   glGenTextures(1, &id);
-  glBindTexture(GL_TEXTURE_CUBE_MAP, id);
+  glState.bindTexture(0u, GL_TEXTURE_CUBE_MAP, id);
 
   glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X, 0, GL_RGB, cubeMap.right.width(), cubeMap.right.height(), 0, GL_BGRA,
                GL_UNSIGNED_BYTE, cubeMap.right.constBits());
@@ -228,7 +339,7 @@ texture_id TextureCache::loadInternal(const std::string &path, GLint filter, GLi
   t.width = image.width();
 
   glGenTextures(1, &t.id);
-  glBindTexture(GL_TEXTURE_2D, t.id);
+  glState.bindTexture(0u, GL_TEXTURE_2D, t.id);
 
   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, repeat);
   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, repeat);
@@ -240,8 +351,7 @@ texture_id TextureCache::loadInternal(const std::string &path, GLint filter, GLi
 
   glGenerateMipmap(GL_TEXTURE_2D);
 
-  glBindTexture(GL_TEXTURE_2D, 0u);
-
+  t.gpuBytes = imageBytes(t.width, t.height, true);
   textures.emplace_back(t);
   return textures.size() - 1u;
 }
@@ -251,23 +361,158 @@ const Texture &TextureCache::get(texture_id index) {
 }
 
 void TextureCache::clear() {
-  for (const auto &t : textures) {
-    glDeleteTextures(1, &t.id);
+  for (std::size_t i = 0u; i < textures.size(); i++) {
+    // Arrays are shared, so they're deleted once below.
+    // Pending & evicted textures share the fallback's texture
+    const auto &t = textures[i];
+    if (t.layer < 0 && pending.find(i) == pending.end() && evicted.find(i) == evicted.end())
+      glState.deleteTexture(t.id);
   }
 
+  for (const auto array : textureArrays)
+    glState.deleteTexture(array);
+
   textures.clear();
   indexMap.clear();
+  packCandidates.clear();
+  textureArrays.clear();
+  pending.clear();
+  uploads.clear();
+  sources.clear();
+  evicted.clear();
+  lastUsed.clear();
+}
+
+std::vector<QString> TextureCache::getSourcePaths() const {
+  std::vector<QString> paths;
+  paths.reserve(sources.size());
+  for (const auto &[id, path] : sources)
+    paths.emplace_back(path);
+
+  return paths;
+}
+
+std::size_t TextureCache::getGpuBytes() const {
+  std::size_t bytes = 0u;
+  for (const auto &t : textures)
+    bytes += t.gpuBytes;
+
+  return bytes;
+}
+
+std::chrono::steady_clock::duration TextureCache::getUploadTime() const {
+  return uploadTime;
+}
+
+std::size_t TextureCache::evict(const std::unordered_set<texture_id> &live, std::size_t bytes) {
+  lastUsed.resize(textures.size(), 0u);
+
+  std::vector<texture_id> candidates;
+  for (const auto &[index, path] : sources) {
+    if (textures[index].layer < 0 && live.count(index) == 0u && pending.count(index) == 0u &&
+        evicted.count(index) == 0u)
+      candidates.emplace_back(index);
+  }
+
+  std::sort(candidates.begin(), candidates.end(), [this](texture_id left, texture_id right) {
+    return lastUsed[left] < lastUsed[right];
+  });
+
+  std::size_t released = 0u;
+  for (const auto index : candidates) {
+    if (released >= bytes)
+      break;
+
+    auto &t = textures[index];
+    released += t.gpuBytes;
+    glState.deleteTexture(t.id);
+
+    t = textures[fallbackTexture];
+    t.gpuBytes = 0u;
+    evicted.emplace(index);
+  }
+
+  // Evicted textures are only the fallback now, so there's nothing to pack
+  packCandidates.erase(std::remove_if(packCandidates.begin(), packCandidates.end(),
+                                      [this](const auto &candidate) {
+                                        return evicted.count(candidate.first) > 0u;
+                                      }),
+                       packCandidates.end());
+
+  return released;
+}
+
+void TextureCache::pack() {
+  // Candidates by size & format, in load order
+  std::map<std::tuple<int, int, unsigned int>, std::vector<texture_id>> groups;
+  for (const auto &[index, format] : packCandidates) {
+    const auto &t = textures[index];
+    groups[{t.width, t.height, format}].emplace_back(index);
+  }
+  packCandidates.clear();
+
+  std::vector<unsigned char> pixels;
+  for (const auto &[shape, group] : groups) {
+    // A single texture saves no binds
+    if (group.size() < 2u)
+      continue;
+
+    const auto [width, height, format] = shape;
+    const auto layers = static_cast<int>(group.size());
+
+    unsigned int array;
+    glGenTextures(1, &array);
+    glState.bindTexture(3u, GL_TEXTURE_2D_ARRAY, array);
+
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, static_cast<GLint>(format), width, height, layers, 0, GL_BGRA,
+                 GL_UNSIGNED_BYTE, nullptr);
+
+    // Read back through the CPU, rather than a framebuffer, since RGB textures aren't always renderable
+    pixels.resize(static_cast<std::size_t>(width) * static_cast<std::size_t>(height) * 4u);
+    for (auto layer = 0; layer < layers; layer++) {
+      auto &t = textures[group[static_cast<std::size_t>(layer)]];
+
+      glState.bindTexture(0u, GL_TEXTURE_2D, t.id);
+      glGetTexImage(GL_TEXTURE_2D, 0, GL_BGRA, GL_UNSIGNED_BYTE, pixels.data());
+      glState.bindTexture(3u, GL_TEXTURE_2D_ARRAY, array);
+      glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, layer, width, height, 1, GL_BGRA, GL_UNSIGNED_BYTE,
+                      pixels.data());
+
+      glState.deleteTexture(t.id);
+      t.id = array;
+      t.layer = layer;
+    }
+
+    glGenerateMipmap(GL_TEXTURE_2D_ARRAY);
+    textureArrays.emplace_back(array);
+  }
 }
 
 void TextureCache::use(texture_id index) {
+  if (!evicted.empty() && evicted.erase(index) > 0u) {
+    // Drawn with the fallback until it's uploaded again
+    const auto &path = sources.at(index);
+    pending.emplace(index, path);
+    decoder.request(index, path);
+  }
+
+  if (index >= lastUsed.size())
+    lastUsed.resize(textures.size(), 0u);
+  lastUsed[index] = frame;
+
   const auto &t = textures[index];
-  glActiveTexture(GL_TEXTURE0);
-  glBindTexture(GL_TEXTURE_2D, t.id);
+  if (t.layer >= 0)
+    glState.bindTexture(3u, GL_TEXTURE_2D_ARRAY, t.id);
+  else
+    glState.bindTexture(0u, GL_TEXTURE_2D, t.id);
 }
 
 void TextureCache::useCubeMap(unsigned int id) {
-  glActiveTexture(GL_TEXTURE0);
-  glBindTexture(GL_TEXTURE_CUBE_MAP, id);
+  glState.bindTexture(0u, GL_TEXTURE_CUBE_MAP, id);
 }
 
 texture_id TextureCache::getFallbackTexture() const {
@@ -33,15 +33,21 @@
 
 #pragma once
 
+#include "ResourceIndex.h"
+#include "TextureDecoder.h"
 #include "texture.h"
 #include <QDir>
 #include <QImage>
 #include <QOpenGLFunctions_3_3_Core>
 #include <array>
+#include <chrono>
 #include <cstddef>
+#include <deque>
 #include <optional>
 #include <string>
+#include <cstdint>
 #include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 namespace netsimulyzer {
@@ -55,7 +61,97 @@ class TextureCache : protected QOpenGLFunctions_3_3_Core {
   std::unordered_map<std::string, std::size_t> indexMap;
   std::vector<Texture> textures;
   texture_id fallbackTexture;
-  QDir resourceDirectory;
+
+  /**
+   * Where textures are searched for, by file name
+   */
+  ResourceIndex resourceIndex;
+
+  /**
+   * The compressed formats the context may upload, from `GL_COMPRESSED_TEXTURE_FORMATS`
+   */
+  std::vector<int> compressedFormats;
+
+  /**
+   * Upload a KTX/DDS texture, with the mipmaps it brings
+   *
+   * @param file
+   * The container to read
+   *
+   * @return
+   * The new texture, unset if the file could not be read,
+   * or the context can't upload its format
+   */
+  std::optional<texture_id> loadCompressed(const QFileInfo &file);
+
+  /**
+   * Model textures which may be packed by `pack()`, with their internal formats
+   */
+  std::vector<std::pair<texture_id, unsigned int>> packCandidates;
+
+  /**
+   * Every array made by `pack()`, shared by the textures packed into it
+   */
+  std::vector<unsigned int> textureArrays;
+
+  /**
+   * Most bytes of images uploaded by one call to `stream()`.
+   * At least one image is always uploaded
+   */
+  static constexpr std::size_t uploadBudget = 16u * 1024u * 1024u;
+
+  /**
+   * Reads images for `load()` off the thread with the context
+   */
+  TextureDecoder decoder;
+
+  /**
+   * Textures drawn with the fallback until their image is uploaded, with the path of that image
+   */
+  std::unordered_map<texture_id, QString> pending;
+
+  /**
+   * The image of each texture read by `decoder`, so the texture may be read again after `evict()`
+   */
+  std::unordered_map<texture_id, QString> sources;
+
+  /**
+   * Textures released by `evict()`, read again the next time they're used
+   */
+  std::unordered_set<texture_id> evicted;
+
+  /**
+   * The value of `frame` when each texture was last used, by ID
+   */
+  std::vector<std::uint64_t> lastUsed;
+
+  /**
+   * Counted by `stream()`
+   */
+  std::uint64_t frame{0u};
+
+  /**
+   * Time spent uploading images, both streamed & compressed
+   */
+  std::chrono::steady_clock::duration uploadTime{};
+
+  /**
+   * Images read by `decoder`, but not uploaded yet
+   */
+  std::deque<TextureDecoder::Decoded> uploads;
+
+  /**
+   * Staging buffer for `stream()`, so uploads don't block on the copy from client memory
+   */
+  unsigned int uploadPbo{0u};
+
+  /**
+   * Upload one image read by `decoder` through `uploadPbo`, replacing the fallback for its texture
+   *
+   * @param image
+   * The image to upload, not null
+   */
+  void upload(const TextureDecoder::Decoded &image);
 
 public:
   struct CubeMap {
@@ -72,6 +168,19 @@ public:
   bool init();
 
   void setResourceDirectory(const QDir &value);
+
+  /**
+   * Find & load a model texture.
+   * Images are read in the background, and the fallback texture is used
+   * in their place until `stream()` uploads them.
+   * Compressed textures are loaded immediately
+   *
+   * @param filename
+   * The name of the texture, searched for in the resource directory
+   *
+   * @return
+   * The ID of the texture, or the fallback texture if it could not be found
+   */
   texture_id load(const std::string &filename);
   unsigned int load(const CubeMap &cubeMap);
   texture_id loadInternal(const std::string &path, GLint filter = GL_LINEAR, GLint repeat = GL_REPEAT);
@@ -85,6 +194,66 @@ public:
 
   void clear();
 
+  /**
+   * Upload the images `load()` has finished reading,
+   * up to `uploadBudget` bytes of them. Call once a frame
+   *
+   * @return
+   * True if any textures are still waiting on their image
+   */
+  bool stream();
+
+  /**
+   * @return
+   * The path of every image decoded for a model texture
+   */
+  [[nodiscard]] std::vector<QString> getSourcePaths() const;
+
+  /**
+   * @return
+   * The bytes used on the GPU by every texture, including their mipmaps
+   */
+  [[nodiscard]] std::size_t getGpuBytes() const;
+
+  /**
+   * @return
+   * The total time spent uploading textures, including generating their mipmaps
+   */
+  [[nodiscard]] std::chrono::steady_clock::duration getUploadTime() const;
+
+  /**
+   * Release model textures no longer used, least recently used first.
+   * Evicted textures keep their IDs, and are read again when next used.
+   * Compressed & packed textures are never evicted
+   *
+   * @param live
+   * The textures still in use, which are kept
+   *
+   * @param bytes
+   * Stop once this many bytes are released
+   *
+   * @return
+   * The bytes released
+   */
+  std::size_t evict(const std::unordered_set<texture_id> &live, std::size_t bytes);
+
+  /**
+   * Move the model textures loaded since the last call into `GL_TEXTURE_2D_ARRAY`s,
+   * one per size & format shared by more than one texture.
+   * Packed textures keep their IDs, but are bound as layers of their array,
+   * so meshes with different textures may be drawn without rebinding.
+   *
+   * Compressed textures are never packed
+   */
+  void pack();
+
+  /**
+   * Bind a texture. Textures are bound to unit 0,
+   * and packed textures to unit 3, as their arrays
+   *
+   * @param index
+   * The texture to bind
+   */
   void use(texture_id index);
 
   // TODO: Track the same way as normal textures
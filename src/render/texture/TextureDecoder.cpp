@@ -0,0 +1,83 @@
+/*
+ * NIST-developed software is provided by NIST as a public service. You may use,
+ * copy and distribute copies of the software in any medium, provided that you
+ * keep intact this entire notice. You may improve,modify and create derivative
+ * works of the software or any portion of the software, and you may copy and
+ * distribute such modifications or works. Modified works should carry a notice
+ * stating that you changed the software and should note the date and nature of
+ * any such change. Please explicitly acknowledge the National Institute of
+ * Standards and Technology as the source of the software.
+ *
+ * NIST-developed software is expressly provided "AS IS." NIST MAKES NO
+ * WARRANTY OF ANY KIND, EXPRESS, IMPLIED, IN FACT OR ARISING BY OPERATION OF
+ * LAW, INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTY OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, NON-INFRINGEMENT
+ * AND DATA ACCURACY. NIST NEITHER REPRESENTS NOR WARRANTS THAT THE
+ * OPERATION OF THE SOFTWARE WILL BE UNINTERRUPTED OR ERROR-FREE, OR THAT
+ * ANY DEFECTS WILL BE CORRECTED. NIST DOES NOT WARRANT OR MAKE ANY
+ * REPRESENTATIONS REGARDING THE USE OF THE SOFTWARE OR THE RESULTS THEREOF,
+ * INCLUDING BUT NOT LIMITED TO THE CORRECTNESS, ACCURACY, RELIABILITY,
+ * OR USEFULNESS OF THE SOFTWARE.
+ *
+ * You are solely responsible for determining the appropriateness of using and
+ * distributing the software and you assume all risks associated with its use,
+ * including but not limited to the risks and costs of program errors,
+ * compliance with applicable laws, damage to or loss of data, programs or
+ * equipment, and the unavailability or interruption of operation. This
+ * software is not intended to be used in any situation where a failure could
+ * cause risk of injury or damage to property. The software developed by NIST
+ * employees is not subject to copyright protection within the United States.
+ *
+ * Author: Evan Black <evan.black@nist.gov>
+ */
+
+#include "TextureDecoder.h"
+#include <QDebug>
+#include <QOpenGLFunctions_3_3_Core>
+#include <utility>
+
+namespace netsimulyzer {
+
+TextureDecoder::Decoded TextureDecoder::decode(std::size_t texture, const QString &path) {
+  Decoded result{texture, path, QImage{path}, GL_RGBA};
+  if (result.image.isNull())
+    return result;
+
+  switch (result.image.format()) {
+  case QImage::Format::Format_RGB32:
+    result.glFormat = GL_RGB;
+    break;
+  case QImage::Format::Format_ARGB32:
+    result.glFormat = GL_RGBA;
+    break;
+  default:
+    qDebug() << "Unsupported format: " << result.image.format() << "\nAttempting conversion...";
+    result.image = result.image.convertToFormat(QImage::Format_ARGB32);
+    result.glFormat = GL_RGBA;
+  }
+
+  return result;
+}
+
+TextureDecoder::~TextureDecoder() {
+  cancelled.cancel();
+}
+
+void TextureDecoder::request(std::size_t texture, const QString &path) {
+  // Drawn with the fallback until decoded, so anything more urgent goes first
+  parser::TaskPool::shared().submit(
+      [results = results, texture, path]() {
+        auto result = decode(texture, path);
+
+        std::lock_guard lock{results->mutex};
+        results->decoded.emplace_back(std::move(result));
+      },
+      parser::TaskPool::Priority::Background, cancelled);
+}
+
+std::vector<TextureDecoder::Decoded> TextureDecoder::takeDecoded() {
+  std::lock_guard lock{results->mutex};
+  return std::exchange(results->decoded, {});
+}
+
+} // namespace netsimulyzer
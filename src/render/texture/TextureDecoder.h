@@ -0,0 +1,135 @@
+/*
+ * NIST-developed software is provided by NIST as a public service. You may use,
+ * copy and distribute copies of the software in any medium, provided that you
+ * keep intact this entire notice. You may improve,modify and create derivative
+ * works of the software or any portion of the software, and you may copy and
+ * distribute such modifications or works. Modified works should carry a notice
+ * stating that you changed the software and should note the date and nature of
+ * any such change. Please explicitly acknowledge the National Institute of
+ * Standards and Technology as the source of the software.
+ *
+ * NIST-developed software is expressly provided "AS IS." NIST MAKES NO
+ * WARRANTY OF ANY KIND, EXPRESS, IMPLIED, IN FACT OR ARISING BY OPERATION OF
+ * LAW, INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTY OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, NON-INFRINGEMENT
+ * AND DATA ACCURACY. NIST NEITHER REPRESENTS NOR WARRANTS THAT THE
+ * OPERATION OF THE SOFTWARE WILL BE UNINTERRUPTED OR ERROR-FREE, OR THAT
+ * ANY DEFECTS WILL BE CORRECTED. NIST DOES NOT WARRANT OR MAKE ANY
+ * REPRESENTATIONS REGARDING THE USE OF THE SOFTWARE OR THE RESULTS THEREOF,
+ * INCLUDING BUT NOT LIMITED TO THE CORRECTNESS, ACCURACY, RELIABILITY,
+ * OR USEFULNESS OF THE SOFTWARE.
+ *
+ * You are solely responsible for determining the appropriateness of using and
+ * distributing the software and you assume all risks associated with its use,
+ * including but not limited to the risks and costs of program errors,
+ * compliance with applicable laws, damage to or loss of data, programs or
+ * equipment, and the unavailability or interruption of operation. This
+ * software is not intended to be used in any situation where a failure could
+ * cause risk of injury or damage to property. The software developed by NIST
+ * employees is not subject to copyright protection within the United States.
+ *
+ * Author: Evan Black <evan.black@nist.gov>
+ */
+
+#pragma once
+
+#include <QImage>
+#include <QString>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <task-pool.h>
+#include <vector>
+
+namespace netsimulyzer {
+
+/**
+ * Reads images on the shared `parser::TaskPool`, so large textures
+ * don't hold up the thread with the context.
+ *
+ * Decoded images are collected with `takeDecoded()`, in the order they finish
+ */
+class TextureDecoder {
+public:
+  struct Decoded {
+    /**
+     * The texture the image was requested for
+     */
+    std::size_t texture;
+
+    /**
+     * The path the image was read from
+     */
+    QString path;
+
+    /**
+     * The image, in a format with 4 bytes per pixel (BGRA in memory).
+     * Null if the file could not be read
+     */
+    QImage image;
+
+    /**
+     * The internal format to upload `image` as
+     */
+    unsigned int glFormat;
+  };
+
+private:
+  /**
+   * Shared with the running tasks, so they may finish after the decoder is destroyed
+   */
+  struct Results {
+    std::mutex mutex;
+
+    /**
+     * Images not taken yet
+     */
+    std::vector<Decoded> decoded;
+  };
+
+  std::shared_ptr<Results> results{std::make_shared<Results>()};
+
+  /**
+   * Skips the requests which have not started once the decoder is destroyed
+   */
+  parser::CancellationToken cancelled;
+
+public:
+  /**
+   * Read the image at `path`, converting it into a format which may be uploaded directly
+   *
+   * @param texture
+   * Copied to the result
+   *
+   * @param path
+   * The absolute path to the image
+   *
+   * @return
+   * The image, with a null `image` if the file could not be read
+   */
+  [[nodiscard]] static Decoded decode(std::size_t texture, const QString &path);
+
+  TextureDecoder() = default;
+  TextureDecoder(const TextureDecoder &) = delete;
+  TextureDecoder &operator=(const TextureDecoder &) = delete;
+  ~TextureDecoder();
+
+  /**
+   * Start reading the image at `path` in the background
+   *
+   * @param texture
+   * The texture the image is for, returned with the image
+   *
+   * @param path
+   * The absolute path to the image
+   */
+  void request(std::size_t texture, const QString &path);
+
+  /**
+   * @return
+   * Every image decoded since the last call
+   */
+  [[nodiscard]] std::vector<Decoded> takeDecoded();
+};
+
+} // namespace netsimulyzer
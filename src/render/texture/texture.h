@@ -32,6 +32,7 @@
  */
 
 #pragma once
+#include <cstddef>
 #include <string>
 
 namespace netsimulyzer {
@@ -40,6 +41,18 @@ struct Texture {
   unsigned int id = 0u;
   int width = 0;
   int height = 0;
+
+  /**
+   * When 0 or above, `id` is a `GL_TEXTURE_2D_ARRAY`,
+   * and this texture is that layer of it
+   */
+  int layer = -1;
+
+  /**
+   * The size of the texture on the GPU, including its mipmaps.
+   * 0 for textures sharing the fallback's
+   */
+  std::size_t gpuBytes = 0u;
   std::string location;
 };
 
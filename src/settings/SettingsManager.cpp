@@ -5,6 +5,42 @@
 #include <QMessageBox>
 #include <QTextStream>
 #include <iostream>
+#include <mutex>
+#include <vector>
+
+namespace {
+
+/**
+ * Values shared by every `SettingsManager`, indexed by `SettingsManager::Key`.
+ * Locked, since the settings are also read from the loading thread
+ */
+struct SettingsCache {
+  std::mutex mutex;
+  std::vector<QVariant> values;
+
+  /**
+   * If the value at the same index was read from the backing store
+   */
+  std::vector<bool> loaded;
+
+  /**
+   * Size the cache on first use, to the number of keys
+   */
+  void reserve(std::size_t keys) {
+    if (!values.empty())
+      return;
+
+    values.resize(keys);
+    loaded.resize(keys, false);
+  }
+};
+
+SettingsCache &settingsCache() {
+  static SettingsCache cache;
+  return cache;
+}
+
+} // namespace
 
 namespace netsimulyzer {
 
@@ -122,8 +158,51 @@ const SettingsManager::SettingValue &SettingsManager::getQtKey(SettingsManager::
   return iterator->second;
 }
 
+QVariant SettingsManager::value(SettingsManager::Key key, const QVariant &defaultValue) const {
+  auto &cache = settingsCache();
+  const auto index = static_cast<std::size_t>(key);
+
+  std::lock_guard lock{cache.mutex};
+  // Every key has an entry in `qtKeyMap`
+  cache.reserve(qtKeyMap.size());
+
+  if (!cache.loaded[index]) {
+    cache.values[index] = qtSettings.value(getQtKey(key).key);
+    cache.loaded[index] = true;
+  }
+
+  const auto &stored = cache.values[index];
+  return stored.isValid() ? stored : defaultValue;
+}
+
+void SettingsManager::store(SettingsManager::Key key, const QVariant &newValue) {
+  const auto &settingKey = getQtKey(key);
+  auto &cache = settingsCache();
+  const auto index = static_cast<std::size_t>(key);
+
+  {
+    std::lock_guard lock{cache.mutex};
+    cache.reserve(qtKeyMap.size());
+
+    cache.values[index] = newValue;
+    cache.loaded[index] = true;
+  }
+
+  if (newValue.isValid())
+    qtSettings.setValue(settingKey.key, newValue);
+  else
+    qtSettings.remove(settingKey.key);
+
+  emit notifier().changed(static_cast<int>(key));
+}
+
+SettingsNotifier &SettingsManager::notifier() {
+  static SettingsNotifier instance;
+  return instance;
+}
+
 bool SettingsManager::isDefined(SettingsManager::Key key) const {
-  return qtSettings.contains(getQtKey(key).key);
+  return value(key).isValid();
 }
 
 void SettingsManager::setDefault(SettingsManager::Key key) {
@@ -134,11 +213,11 @@ void SettingsManager::setDefault(SettingsManager::Key key) {
     std::abort();
   }
 
-  qtSettings.setValue(settingKey.key, settingKey.defaultValue);
+  store(key, settingKey.defaultValue);
 }
 
 void SettingsManager::clear(SettingsManager::Key key) {
-  qtSettings.remove(getQtKey(key).key);
+  store(key, {});
 }
 
 void SettingsManager::sync() {
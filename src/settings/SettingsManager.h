@@ -1,8 +1,10 @@
 #pragma once
 
 #include "parser/model.h"
+#include <QObject>
 #include <QSettings>
 #include <QString>
+#include <QStringList>
 #include <Qt>
 #include <iostream>
 #include <optional>
@@ -13,7 +15,29 @@
 namespace netsimulyzer {
 
 /**
- * Manager that wraps the QSettings Class
+ * Signals changes to the settings, made through any `SettingsManager`
+ *
+ * @see SettingsManager::notifier()
+ */
+class SettingsNotifier : public QObject {
+  Q_OBJECT
+
+signals:
+  /**
+   * Emitted after a setting is set, defaulted, or cleared
+   *
+   * @param key
+   * The `SettingsManager::Key` changed, as an int.
+   * Convert back with a `static_cast`
+   */
+  void changed(int key);
+};
+
+/**
+ * Manager that wraps the QSettings Class.
+ *
+ * Values are cached in memory, shared between every instance,
+ * so reading a setting does not touch the backing store after its first read
  */
 class SettingsManager {
 public:
@@ -24,6 +48,9 @@ public:
     SettingsVersion,
     LastLoadPath,
     ResourcePath,
+    ResourcePrewarm,
+    ResourceRecentModels,
+    ResourceRecentTextures,
     MoveSpeed,
     KeyboardTurnSpeed,
     MouseTurnSpeed,
@@ -41,18 +68,58 @@ public:
     SceneKeyPlay,
     MainWindowState,
     NumberSamples,
+    ParserCache,
+    ParserCacheDirectory,
+    ParserCompactEvents,
+    ParserCompactionTolerance,
+    ParserPreparseBudget,
+    PlaybackEventBudget,
+    PlaybackInterpolateMotion,
+    PlaybackMemoryBudget,
+    PlaybackParallelEvents,
+    PlaybackSharedEvents,
+    PlaybackSharedEventsDirectory,
+    PlaybackSkipIdle,
+    PlaybackStepsPerSecond,
     PlaybackTimeStepPreference,
     PlaybackTimeStepUnit,
+    RenderAdaptiveQuality,
+    RenderAdaptiveScale,
     RenderBuildingMode,
     RenderBuildingOutlines,
+    RenderClusters,
+    RenderCpuPicking,
+    RenderDynamicResolution,
+    RenderFrameCap,
+    RenderGpuMemoryBudget,
     RenderGrid,
     RenderGridStep,
+    RenderHeatmap,
     RenderLabelScale,
+    RenderMinimap,
+    RenderMinimapRate,
     RenderMotionTrails,
     RenderMotionTrailLength,
+    RenderMotionTrailWindow,
     RenderLabels,
+    RenderOcclusionCulling,
+    RenderPackTextures,
+    RenderPerformanceProbe,
     RenderSkybox,
+    RenderSplitView,
+    RenderStaticPagingItems,
+    RenderStaticStreamDistance,
+    RenderStaticTileBudget,
+    RenderSwapInterval,
+    RenderTargetFrameTime,
     ChartDropdownSortOrder,
+    ChartMaxPoints,
+    ChartMaxPointLabels,
+    ChartRefreshRate,
+    DetailRefreshRate,
+    TimeDisplayRate,
+    UiUpdateRate,
+    WindowLightweight,
     WindowTheme
   };
 
@@ -159,6 +226,9 @@ private:
       {Key::SettingsVersion, {"application/version", {}}},
       {Key::LastLoadPath, {"application/lastLoadPath", {}}},
       {Key::ResourcePath, {"resources/resourcePath", {}}},
+      {Key::ResourcePrewarm, {"resources/prewarm", true}}, // Warm the assets of recent scenarios after startup
+      {Key::ResourceRecentModels, {"resources/recentModels", QStringList{}}}, // Most recent first
+      {Key::ResourceRecentTextures, {"resources/recentTextures", QStringList{}}},
       {Key::MoveSpeed, {"camera/moveSpeed", 0.02f}},
       {Key::KeyboardTurnSpeed, {"camera/keyboardTurnSpeed", 0.1f}},
       {Key::MouseTurnSpeed, {"camera/mouseTurnSpeed", 0.5f}},
@@ -175,19 +245,59 @@ private:
       {Key::CameraKeyDown, {"camera/keyDown", Qt::Key_X}},
       {Key::SceneKeyPlay, {"scene/keyPlay", Qt::Key_P}},
       {Key::MainWindowState, {"mainWindow/state", {}}},
+      {Key::ParserCache, {"parser/cache", false}}, // Keep a binary snapshot of each JSON scenario loaded
+      {Key::ParserCacheDirectory, {"parser/cacheDirectory", ""}}, // Empty to keep snapshots next to the scenario
+      {Key::ParserCompactEvents, {"parser/compactEvents", false}},
+      {Key::ParserCompactionTolerance, {"parser/compactionTolerance", 0.01}}, // ns-3 units (m) a move may drift
+      {Key::ParserPreparseBudget, {"parser/preparseBudget", 1024}}, // MiB a scenario parsed ahead may hold, 0 for none
+      {Key::PlaybackEventBudget, {"playback/eventBudget", 8}}, // ms per frame applying events, 0 for no limit
+      {Key::PlaybackInterpolateMotion, {"playback/interpolateMotion", false}},
+      {Key::PlaybackMemoryBudget, {"playback/memoryBudget", 0}}, // MiB of scene events kept in memory, 0 for no limit
+      {Key::PlaybackParallelEvents, {"playback/parallelEvents", true}},
+      {Key::PlaybackSharedEvents, {"playback/sharedEvents", false}}, // Map scene events shared with other viewers
+      {Key::PlaybackSharedEventsDirectory, {"playback/sharedEventsDirectory", ""}}, // Empty for shared memory
+      {Key::PlaybackSkipIdle, {"playback/skipIdle", false}},
+      {Key::PlaybackStepsPerSecond, {"playback/stepsPerSecond", 60}}, // Steps of the time step per wall second
       {Key::PlaybackTimeStepPreference, {"playback/timeStepPreference", 10'000'000LL}}, // 10ms in nanoseconds
       {Key::PlaybackTimeStepUnit, {"playback/timeStepUnit", "milliseconds"}},
       {Key::NumberSamples, {"renderer/numberSamples", 2}},
+      {Key::RenderAdaptiveQuality, {"renderer/adaptiveQuality", false}},
+      {Key::RenderAdaptiveScale, {"renderer/adaptiveScale", 1.0f}}, // Render scale while moving, 1 for full resolution
       {Key::RenderBuildingMode, {"renderer/buildingRenderMode", "transparent"}},
       {Key::RenderBuildingOutlines, {"renderer/showBuildingOutlines", true}},
       {Key::RenderLabelScale, {"renderer/labelScale", 0.1f}},
+      {Key::RenderCpuPicking, {"renderer/cpuPicking", false}},
+      {Key::RenderDynamicResolution, {"renderer/dynamicResolution", false}},
+      {Key::RenderFrameCap, {"renderer/frameCap", 0}}, // Most frames per second, 0 for the display's refresh rate
       {Key::RenderGrid, {"renderer/showGrid", true}},
+      {Key::RenderGpuMemoryBudget, {"renderer/gpuMemoryBudget", 0}}, // MiB of models & textures, 0 for no limit
       {Key::RenderGridStep, {"renderer/gridStepSize", 1}},
       {Key::RenderSkybox, {"renderer/enableSkybox", true}},
+      {Key::RenderSplitView, {"renderer/splitView", false}},
+      {Key::RenderStaticPagingItems, {"renderer/staticPagingItems", 100000}}, // Page Buildings & Areas past this many
+      {Key::RenderStaticStreamDistance, {"renderer/staticStreamDistance", 1000}}, // m from the camera tiles are kept
+      {Key::RenderStaticTileBudget, {"renderer/staticTileBudget", 256}}, // MiB of paged Buildings & Areas
+      {Key::RenderSwapInterval, {"renderer/swapInterval", 1}}, // Display refreshes per frame, 0 to not wait for one
+      {Key::RenderClusters, {"renderer/clusters", false}},
+      {Key::RenderHeatmap, {"renderer/heatmap", false}},
+      {Key::RenderMinimap, {"renderer/minimap", false}},
+      {Key::RenderMinimapRate, {"renderer/minimapRate", 4}}, // Minimap refreshes per second
+      {Key::RenderTargetFrameTime, {"renderer/targetFrameTime", 16.0f}}, // GPU milliseconds per frame
       {Key::RenderLabels, {"renderer/showLabels", "enabledOnly"}},
+      {Key::RenderPackTextures, {"renderer/packTextures", false}},
+      {Key::RenderPerformanceProbe, {"renderer/performanceProbe", true}}, // Pick the graphics settings on first start
+      {Key::RenderOcclusionCulling, {"renderer/occlusionCulling", false}}, // Skip Nodes behind opaque Buildings
       {Key::RenderMotionTrails, {"renderer/showMotionTrails", "enabledOnly"}},
       {Key::RenderMotionTrailLength, {"renderer/motionTrailLength", 100}},
+      {Key::RenderMotionTrailWindow, {"renderer/motionTrailWindow", 0}}, // ms of motion per trail, 0 to use the length
       {Key::ChartDropdownSortOrder, {"chart/dropdownSortOrder", "type"}},
+      {Key::ChartMaxPoints, {"chart/maxPoints", 4000}}, // Per XY series, see `DecimatedSeries`
+      {Key::ChartMaxPointLabels, {"chart/maxPointLabels", 100}}, // Per XY series, see `ChartManager::XYSeriesTie`
+      {Key::ChartRefreshRate, {"chart/refreshRate", 12}}, // Most chart updates per second, 0 for no limit
+      {Key::DetailRefreshRate, {"detail/refreshRate", 10}}, // Most updates per second of the details, 0 for no limit
+      {Key::TimeDisplayRate, {"window/timeDisplayRate", 15}}, // Most updates per second of the shown time, 0 for no limit
+      {Key::UiUpdateRate, {"window/uiUpdateRate", 30}}, // Most log & detail updates per second, 0 for no limit
+      {Key::WindowLightweight, {"window/lightweight", false}}, // Create the charts, log, & Node docks once opened
       {Key::WindowTheme, {"window/theme", "dark"}}};
 
   /**
@@ -209,7 +319,39 @@ private:
    */
   QSettings qtSettings;
 
+  /**
+   * Read a value through the cache shared by every `SettingsManager`.
+   * The backing store is only read the first time a key is requested
+   *
+   * @param key
+   * The key to read
+   *
+   * @param defaultValue
+   * Returned if `key` is not in the backing store
+   *
+   * @return
+   * The stored value, or `defaultValue`
+   */
+  [[nodiscard]] QVariant value(Key key, const QVariant &defaultValue = {}) const;
+
+  /**
+   * Update the cache & the backing store, then announce the change through `notifier()`.
+   * `QSettings` writes the backing store to disk later, from the event loop
+   *
+   * @param key
+   * The key to store `newValue` under
+   *
+   * @param newValue
+   * The value to store. An invalid `QVariant` removes the key
+   */
+  void store(Key key, const QVariant &newValue);
+
 public:
+  /**
+   * Announces every change made through any `SettingsManager`, see `SettingsNotifier::changed()`
+   */
+  [[nodiscard]] static SettingsNotifier &notifier();
+
   /**
    * Checks if a key was previously defined in the settings file.
    *
@@ -253,7 +395,7 @@ public:
   template <class T>
   [[nodiscard]] std::optional<T> get(Key key, RetrieveMode mode = RetrieveMode::AllowDefault) const {
     const auto &settingKey = getQtKey(key);
-    const auto qtSetting = qtSettings.value(settingKey.key, settingKey.defaultValue);
+    const auto qtSetting = value(key, settingKey.defaultValue);
 
     if (qtSetting.isValid() && !qtSetting.isNull() && qtSetting.template canConvert<T>())
       return {qtSetting.template value<T>()};
@@ -281,8 +423,7 @@ public:
    */
   template <class T>
   void set(SettingsManager::Key key, const T &value) {
-    const auto &settingKey = getQtKey(key);
-    qtSettings.setValue(settingKey.key, value);
+    store(key, value);
   }
 
   /**
@@ -356,7 +497,7 @@ public:
 template <>
 [[nodiscard]] inline std::optional<std::string> SettingsManager::get(Key key, RetrieveMode mode) const {
   const auto &settingKey = getQtKey(key);
-  const auto qtSetting = qtSettings.value(settingKey.key, settingKey.defaultValue);
+  const auto qtSetting = value(key, settingKey.defaultValue);
 
   if (qtSetting.isValid() && qtSetting.template canConvert<QString>())
     return {qtSetting.toString().toStdString()};
@@ -369,8 +510,7 @@ template <>
 
 template <>
 inline void SettingsManager::set(SettingsManager::Key key, const std::string &value) {
-  const auto &settingKey = getQtKey(key);
-  qtSettings.setValue(settingKey.key, QString::fromStdString(value));
+  store(key, QString::fromStdString(value));
 }
 
 template <>
@@ -453,7 +593,7 @@ template <>
 [[nodiscard]] inline std::optional<SettingsManager::BuildingRenderMode> SettingsManager::get(Key key,
                                                                                              RetrieveMode mode) const {
   const auto &settingKey = getQtKey(key);
-  const auto qtSetting = qtSettings.value(settingKey.key);
+  const auto qtSetting = value(key);
 
   QString stringMode;
 
@@ -481,7 +621,7 @@ template <>
 template <>
 [[nodiscard]] inline std::optional<SettingsManager::LabelRenderMode> SettingsManager::get(Key key, RetrieveMode mode) const {
   const auto &settingKey = getQtKey(key);
-  const auto qtSetting = qtSettings.value(settingKey.key);
+  const auto qtSetting = value(key);
 
   QString stringMode;
 
@@ -512,7 +652,7 @@ template <>
 [[nodiscard]] inline std::optional<SettingsManager::MotionTrailRenderMode>
 SettingsManager::get(Key key, RetrieveMode mode) const {
   const auto &settingKey = getQtKey(key);
-  const auto qtSetting = qtSettings.value(settingKey.key);
+  const auto qtSetting = value(key);
 
   QString stringMode;
 
@@ -542,7 +682,7 @@ SettingsManager::get(Key key, RetrieveMode mode) const {
 template <>
 [[nodiscard]] inline std::optional<SettingsManager::TimeUnit> SettingsManager::get(Key key, RetrieveMode mode) const {
   const auto &settingKey = getQtKey(key);
-  const auto qtSetting = qtSettings.value(settingKey.key);
+  const auto qtSetting = value(key);
 
   QString stringMode;
   if (qtSetting.isValid() && !qtSetting.isNull() && qtSetting.template canConvert<QString>())
@@ -572,7 +712,7 @@ template <>
 [[nodiscard]] inline std::optional<SettingsManager::ChartDropdownSortOrder>
 SettingsManager::get(Key key, RetrieveMode mode) const {
   const auto &settingKey = getQtKey(key);
-  const auto qtSetting = qtSettings.value(settingKey.key);
+  const auto qtSetting = value(key);
 
   QString stringMode;
 
@@ -605,7 +745,7 @@ template <>
 [[nodiscard]] inline std::optional<SettingsManager::WindowTheme>
 SettingsManager::get(Key key, RetrieveMode mode) const {
   const auto &settingKey = getQtKey(key);
-  const auto qtSetting = qtSettings.value(settingKey.key);
+  const auto qtSetting = value(key);
 
   QString stringMode;
 
@@ -634,14 +774,12 @@ SettingsManager::get(Key key, RetrieveMode mode) const {
 
 template <>
 inline void SettingsManager::set(SettingsManager::Key key, const SettingsManager::BuildingRenderMode &value) {
-  const auto &settingKey = getQtKey(key);
-
   switch (value) {
   case SettingsManager::BuildingRenderMode::Transparent:
-    qtSettings.setValue(settingKey.key, "transparent");
+    store(key, "transparent");
     break;
   case SettingsManager::BuildingRenderMode::Opaque:
-    qtSettings.setValue(settingKey.key, "opaque");
+    store(key, "opaque");
     break;
   default:
     std::cerr << "Unrecognised 'BuildingRenderMode': " << static_cast<int>(value) << " value not saved!\n";
@@ -650,17 +788,15 @@ inline void SettingsManager::set(SettingsManager::Key key, const SettingsManager
 
 template <>
 inline void SettingsManager::set(SettingsManager::Key key, const SettingsManager::LabelRenderMode &value) {
-  const auto &settingKey = getQtKey(key);
-
   switch (value) {
   case SettingsManager::LabelRenderMode::Always:
-    qtSettings.setValue(settingKey.key, "always");
+    store(key, "always");
     break;
   case SettingsManager::LabelRenderMode::EnabledOnly:
-    qtSettings.setValue(settingKey.key, "enabledOnly");
+    store(key, "enabledOnly");
     break;
   case SettingsManager::LabelRenderMode::Never:
-    qtSettings.setValue(settingKey.key, "never");
+    store(key, "never");
     break;
   default:
     std::cerr << "Unrecognised 'LabelRenderMode': " << static_cast<int>(value) << " value not saved!\n";
@@ -669,20 +805,18 @@ inline void SettingsManager::set(SettingsManager::Key key, const SettingsManager
 
 template <>
 inline void SettingsManager::set(SettingsManager::Key key, const SettingsManager::ChartDropdownSortOrder &value) {
-  const auto &settingKey = getQtKey(key);
-
   switch (value) {
   case SettingsManager::ChartDropdownSortOrder::Alphabetical:
-    qtSettings.setValue(settingKey.key, "alphabetical");
+    store(key, "alphabetical");
     break;
   case SettingsManager::ChartDropdownSortOrder::Type:
-    qtSettings.setValue(settingKey.key, "type");
+    store(key, "type");
     break;
   case SettingsManager::ChartDropdownSortOrder::Id:
-    qtSettings.setValue(settingKey.key, "id");
+    store(key, "id");
     break;
   case SettingsManager::ChartDropdownSortOrder::None:
-    qtSettings.setValue(settingKey.key, "none");
+    store(key, "none");
     break;
   default:
     std::cerr << "Unrecognised 'ChartDropdownSortOrder': " << static_cast<int>(value) << " value not saved!\n";
@@ -691,17 +825,15 @@ inline void SettingsManager::set(SettingsManager::Key key, const SettingsManager
 
 template <>
 inline void SettingsManager::set(SettingsManager::Key key, const SettingsManager::MotionTrailRenderMode &value) {
-  const auto &settingKey = getQtKey(key);
-
   switch (value) {
   case SettingsManager::MotionTrailRenderMode::Always:
-    qtSettings.setValue(settingKey.key, "always");
+    store(key, "always");
     break;
   case SettingsManager::MotionTrailRenderMode::EnabledOnly:
-    qtSettings.setValue(settingKey.key, "enabledOnly");
+    store(key, "enabledOnly");
     break;
   case SettingsManager::MotionTrailRenderMode::Never:
-    qtSettings.setValue(settingKey.key, "never");
+    store(key, "never");
     break;
   default:
     std::cerr << "Unrecognised 'MotionTrailRenderMode': " << static_cast<int>(value) << " value not saved!\n";
@@ -710,17 +842,15 @@ inline void SettingsManager::set(SettingsManager::Key key, const SettingsManager
 
 template <>
 inline void SettingsManager::set(SettingsManager::Key key, const SettingsManager::TimeUnit &value) {
-  const auto &settingKey = getQtKey(key);
-
   switch (value) {
   case SettingsManager::TimeUnit::Milliseconds:
-    qtSettings.setValue(settingKey.key, "milliseconds");
+    store(key, "milliseconds");
     break;
   case SettingsManager::TimeUnit::Microseconds:
-    qtSettings.setValue(settingKey.key, "microseconds");
+    store(key, "microseconds");
     break;
   case SettingsManager::TimeUnit::Nanoseconds:
-    qtSettings.setValue(settingKey.key, "nanoseconds");
+    store(key, "nanoseconds");
     break;
   default:
     std::cerr << "Unrecognised 'TimeUnit': " << static_cast<int>(value) << " value not saved!\n";
@@ -729,17 +859,15 @@ inline void SettingsManager::set(SettingsManager::Key key, const SettingsManager
 
 template <>
 inline void SettingsManager::set(SettingsManager::Key key, const SettingsManager::WindowTheme &value) {
-  const auto &settingKey = getQtKey(key);
-
   switch (value) {
   case WindowTheme::Dark:
-    qtSettings.setValue(settingKey.key, "dark");
+    store(key, "dark");
     break;
   case WindowTheme::Light:
-    qtSettings.setValue(settingKey.key, "light");
+    store(key, "light");
     break;
   case WindowTheme::Native:
-    qtSettings.setValue(settingKey.key, "native");
+    store(key, "native");
     break;
   default:
     std::cerr << "Unrecognised 'WindowTheme': " << static_cast<int>(value) << " value not saved!\n";
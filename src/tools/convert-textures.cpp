@@ -0,0 +1,97 @@
+/*
+ * NIST-developed software is provided by NIST as a public service. You may use,
+ * copy and distribute copies of the software in any medium, provided that you
+ * keep intact this entire notice. You may improve,modify and create derivative
+ * works of the software or any portion of the software, and you may copy and
+ * distribute such modifications or works. Modified works should carry a notice
+ * stating that you changed the software and should note the date and nature of
+ * any such change. Please explicitly acknowledge the National Institute of
+ * Standards and Technology as the source of the software.
+ *
+ * NIST-developed software is expressly provided "AS IS." NIST MAKES NO
+ * WARRANTY OF ANY KIND, EXPRESS, IMPLIED, IN FACT OR ARISING BY OPERATION OF
+ * LAW, INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTY OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, NON-INFRINGEMENT
+ * AND DATA ACCURACY. NIST NEITHER REPRESENTS NOR WARRANTS THAT THE
+ * OPERATION OF THE SOFTWARE WILL BE UNINTERRUPTED OR ERROR-FREE, OR THAT
+ * ANY DEFECTS WILL BE CORRECTED. NIST DOES NOT WARRANT OR MAKE ANY
+ * REPRESENTATIONS REGARDING THE USE OF THE SOFTWARE OR THE RESULTS THEREOF,
+ * INCLUDING BUT NOT LIMITED TO THE CORRECTNESS, ACCURACY, RELIABILITY,
+ * OR USEFULNESS OF THE SOFTWARE.
+ *
+ * You are solely responsible for determining the appropriateness of using and
+ * distributing the software and you assume all risks associated with its use,
+ * including but not limited to the risks and costs of program errors,
+ * compliance with applicable laws, damage to or loss of data, programs or
+ * equipment, and the unavailability or interruption of operation. This
+ * software is not intended to be used in any situation where a failure could
+ * cause risk of injury or damage to property. The software developed by NIST
+ * employees is not subject to copyright protection within the United States.
+ *
+ * Author: Evan Black <evan.black@nist.gov>
+ */
+
+#include "src/render/texture/CompressedImage.h"
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QDir>
+#include <QDirIterator>
+#include <QFileInfo>
+#include <QImage>
+#include <iostream>
+
+/**
+ * Compresses every image under a resource directory into a KTX file next to it,
+ * with a full mipmap chain. `TextureCache` loads the KTX file in place of the image.
+ *
+ * Images are BC1 if they're opaque, BC3 otherwise.
+ * Images older than their KTX file are skipped.
+ *
+ * Usage: netsimulyzer-texconvert <resource directory>
+ */
+int main(int argc, char *argv[]) {
+  // Required for the image format plugins
+  QCoreApplication application{argc, argv};
+
+  if (argc != 2) {
+    std::cerr << "Usage: " << argv[0] << " <resource directory>\n";
+    return 1;
+  }
+
+  unsigned int converted = 0u;
+  unsigned int skipped = 0u;
+  unsigned int failed = 0u;
+
+  QDirIterator iterator{QString::fromLocal8Bit(argv[1]),
+                        {"*.png", "*.jpg", "*.jpeg", "*.bmp", "*.tga"},
+                        QDir::Files | QDir::Readable,
+                        QDirIterator::Subdirectories};
+  while (iterator.hasNext()) {
+    const QFileInfo source{iterator.next()};
+    const QFileInfo target{source.dir(), source.completeBaseName() + ".ktx"};
+
+    if (target.exists() && target.lastModified() >= source.lastModified()) {
+      skipped++;
+      continue;
+    }
+
+    const QImage image{source.filePath()};
+    if (image.isNull()) {
+      std::cerr << "Failed to read " << source.filePath().toStdString() << '\n';
+      failed++;
+      continue;
+    }
+
+    if (!netsimulyzer::writeKtx(target.filePath(), netsimulyzer::compressImage(image))) {
+      std::cerr << "Failed to write " << target.filePath().toStdString() << '\n';
+      failed++;
+      continue;
+    }
+
+    std::clog << "Wrote " << target.filePath().toStdString() << '\n';
+    converted++;
+  }
+
+  std::clog << converted << " converted, " << skipped << " up to date, " << failed << " failed\n";
+  return failed > 0u ? 1 : 0;
+}
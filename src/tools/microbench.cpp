@@ -0,0 +1,513 @@
+/*
+ * NIST-developed software is provided by NIST as a public service. You may use,
+ * copy and distribute copies of the software in any medium, provided that you
+ * keep intact this entire notice. You may improve,modify and create derivative
+ * works of the software or any portion of the software, and you may copy and
+ * distribute such modifications or works. Modified works should carry a notice
+ * stating that you changed the software and should note the date and nature of
+ * any such change. Please explicitly acknowledge the National Institute of
+ * Standards and Technology as the source of the software.
+ *
+ * NIST-developed software is expressly provided "AS IS." NIST MAKES NO
+ * WARRANTY OF ANY KIND, EXPRESS, IMPLIED, IN FACT OR ARISING BY OPERATION OF
+ * LAW, INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTY OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, NON-INFRINGEMENT
+ * AND DATA ACCURACY. NIST NEITHER REPRESENTS NOR WARRANTS THAT THE
+ * OPERATION OF THE SOFTWARE WILL BE UNINTERRUPTED OR ERROR-FREE, OR THAT
+ * ANY DEFECTS WILL BE CORRECTED. NIST DOES NOT WARRANT OR MAKE ANY
+ * REPRESENTATIONS REGARDING THE USE OF THE SOFTWARE OR THE RESULTS THEREOF,
+ * INCLUDING BUT NOT LIMITED TO THE CORRECTNESS, ACCURACY, RELIABILITY,
+ * OR USEFULNESS OF THE SOFTWARE.
+ *
+ * You are solely responsible for determining the appropriateness of using and
+ * distributing the software and you assume all risks associated with its use,
+ * including but not limited to the risks and costs of program errors,
+ * compliance with applicable laws, damage to or loss of data, programs or
+ * equipment, and the unavailability or interruption of operation. This
+ * software is not intended to be used in any situation where a failure could
+ * cause risk of injury or damage to property. The software developed by NIST
+ * employees is not subject to copyright protection within the United States.
+ *
+ * Author: Evan Black <evan.black@nist.gov>
+ */
+
+#include "src/group/link/WiredLinkBatch.h"
+#include "src/group/node/Node.h"
+#include "src/group/node/TrailBuffer.h"
+#include "src/group/node/TrailPool.h"
+#include "src/render/font/FontManager.h"
+#include "src/render/model/Model.h"
+#include "src/render/renderer/GlState.h"
+#include "src/render/texture/TextureCache.h"
+#include "src/util/undo-events.h"
+#include "src/window/chart/ChartManager.h"
+#include "src/window/log/ScenarioLogWidget.h"
+#include <QApplication>
+#include <QDir>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QOffscreenSurface>
+#include <QOpenGLContext>
+#include <QOpenGLFunctions_3_3_Core>
+#include <QSettings>
+#include <QSurfaceFormat>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <entity-streams.h>
+#include <file-parser.h>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <model.h>
+#include <project.h>
+#include <random>
+#include <string>
+#include <vector>
+
+/**
+ * Micro-benchmarks of the per-event & per-frame hot paths,
+ * for tracking regressions from release to release.
+ *
+ * Each case is run several times, and the median & fastest time per operation
+ * are written as JSON to `output`, or the standard output without one.
+ * Cases which need OpenGL run against an offscreen 3.3 core context,
+ * and are skipped if one cannot be created.
+ *
+ * `filter` runs only the cases whose names contain it.
+ *
+ * Usage: netsimulyzer-microbench [output] [filter]
+ */
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+/**
+ * Each case is timed this many times
+ */
+constexpr int samples = 7;
+
+/**
+ * Times one sample of `operations` operations.
+ * Only the time the sample measures itself counts, so setup may be excluded
+ */
+using Sample = std::function<Clock::duration()>;
+
+struct Case {
+  std::string name;
+  long long operations;
+  Sample sample;
+};
+
+QJsonObject run(const Case &benchmark) {
+  std::vector<double> perOperation;
+  for (auto i = 0; i < samples; i++) {
+    const auto time = std::chrono::duration<double, std::nano>(benchmark.sample()).count();
+    perOperation.emplace_back(time / static_cast<double>(benchmark.operations));
+  }
+  std::sort(perOperation.begin(), perOperation.end());
+
+  QJsonObject result;
+  result["name"] = QString::fromStdString(benchmark.name);
+  result["operations"] = static_cast<double>(benchmark.operations);
+  result["samples"] = samples;
+  result["median-ns"] = perOperation[perOperation.size() / 2u];
+  result["min-ns"] = perOperation.front();
+  return result;
+}
+
+template <class Body>
+Clock::duration timed(Body body) {
+  const auto start = Clock::now();
+  body();
+  return Clock::now() - start;
+}
+
+// ----- Parsing -----
+
+/**
+ * Every section an event may refer to, so none are rejected
+ */
+constexpr auto parseSections =
+    R"({"configuration":{"module-version":{"major":1,"minor":0,"patch":7,"suffix":""}},)"
+    R"("nodes":[{"id":0,"name":"n","model":"m","scale":{"x":1,"y":1,"z":1},"orientation":{"x":0,"y":0,"z":0},)"
+    R"("visible":true,"position":{"x":0,"y":0,"z":0}}],)"
+    R"("decorations":[{"id":0,"model":"m","position":{"x":0,"y":0,"z":0},"orientation":{"x":0,"y":0,"z":0},)"
+    R"("scale":{"x":1,"y":1,"z":1}}],)"
+    R"("series":[{"type":"xy-series","id":0,"name":"s","legend":"s","visible":true,)"
+    R"("color":{"red":0,"green":0,"blue":0},"connection":"line","labels":"hidden",)"
+    R"("x-axis":{"name":"x","scale":"linear","bound-mode":"fixed","min":0,"max":1},)"
+    R"("y-axis":{"name":"y","scale":"linear","bound-mode":"fixed","min":0,"max":1}},)"
+    R"({"type":"category-value-series","id":1,"name":"c","legend":"c","visible":true,)"
+    R"("color":{"red":0,"green":0,"blue":0},"auto-update":false,)"
+    R"("x-axis":{"name":"x","scale":"linear","bound-mode":"fixed","min":0,"max":1},)"
+    R"("y-axis":{"name":"y","values":[{"id":0,"value":"a"}]}}],)"
+    R"("streams":[{"id":0,"name":"l","visible":true}],"events":[)";
+
+/**
+ * One event of each type read by `JsonHandler`, without its time
+ */
+const std::pair<const char *, const char *> parseCases[]{
+    {"node-position", R"("type":"node-position","id":0,"x":1.5,"y":-20.25,"z":3.0)"},
+    {"node-orientation", R"("type":"node-orientation","id":0,"x":90.0,"y":0.0,"z":45.0)"},
+    {"node-color", R"("type":"node-color","id":0,"color-type":"base","color":{"red":10,"green":20,"blue":30})"},
+    {"node-transmit",
+     R"("type":"node-transmit","id":0,"duration":1000000,"target-size":2.0,"color":{"red":1,"green":2,"blue":3})"},
+    {"decoration-position", R"("type":"decoration-position","id":0,"x":1.5,"y":-20.25,"z":3.0)"},
+    {"xy-series-append", R"("type":"xy-series-append","series-id":0,"x":12.5,"y":0.125)"},
+    {"category-series-append", R"("type":"category-series-append","series-id":1,"category":0,"value":4.5)"},
+    {"stream-append", R"("type":"stream-append","stream-id":0,"data":"Packet received from 10.1.1.2\n")"}};
+
+std::vector<Case> parseBenchmarks(const std::string &directory) {
+  constexpr auto events = 200'000LL;
+  std::vector<Case> cases;
+
+  for (const auto &[type, body] : parseCases) {
+    const auto path = directory + "/netsimulyzer-microbench-" + type + ".json";
+    {
+      std::ofstream file{path, std::ios::binary};
+      file << parseSections;
+      for (auto i = 0LL; i < events; i++)
+        file << (i > 0LL ? ",\n" : "") << R"({"nanoseconds":)" << i * 1000LL << ',' << body << '}';
+      file << "]}\n";
+    }
+
+    cases.push_back({std::string{"parse/"} + type, events, [path] {
+                       parser::FileParser fileParser;
+                       return timed([&fileParser, &path] {
+                         if (fileParser.parse(path.c_str())) {
+                           std::cerr << "Failed to parse " << path << '\n';
+                           std::abort();
+                         }
+                       });
+                     }});
+  }
+
+  return cases;
+}
+
+// ----- Scene -----
+
+/**
+ * Nodes with the same state as the `SceneWidget`'s,
+ * and the move events between them, indexed the same way
+ */
+struct SceneFixture {
+  std::vector<parser::Node> models;
+  std::vector<netsimulyzer::Node> nodes;
+  std::vector<parser::SceneEvent> events;
+  parser::EntityEventStreams streams;
+
+  SceneFixture(unsigned int nodeCount, std::size_t eventCount) {
+    std::mt19937 random{1u};
+    std::uniform_real_distribution<double> coordinate{-500.0, 500.0};
+    std::uniform_int_distribution<unsigned int> node{0u, nodeCount - 1u};
+
+    for (auto i = 0u; i < nodeCount; i++) {
+      parser::Node model;
+      model.id = i;
+      model.position = {coordinate(random), coordinate(random), 0.0};
+      models.emplace_back(model);
+    }
+
+    // Nodes keep a reference to their model, so `models` is not grown after this
+    const netsimulyzer::Model model{0u, glm::vec3{-1.0f}, glm::vec3{1.0f}};
+    nodes.reserve(nodeCount);
+    for (const auto &ns3Node : models)
+      nodes.emplace_back(model, ns3Node, netsimulyzer::TrailBuffer{0},
+                         netsimulyzer::FontManager::FontBannerRenderInfo{});
+
+    streams.reset(models, {});
+    for (std::size_t i = 0u; i < eventCount; i++) {
+      parser::MoveEvent move;
+      move.time = static_cast<parser::nanoseconds>(i) * 1000LL;
+      move.nodeId = node(random);
+      move.targetPosition = {coordinate(random), coordinate(random), coordinate(random)};
+      events.emplace_back(move);
+      streams.add(events.back());
+    }
+  }
+
+  /**
+   * Apply every event, the way `SceneWidget::handleEvents()` does
+   */
+  void dispatch() {
+    for (std::size_t i = 0u; i < events.size(); i++) {
+      const auto slot = streams.slot(i);
+      std::visit(
+          [this, slot](const auto &e) {
+            using T = std::decay_t<decltype(e)>;
+            if constexpr (std::is_same_v<T, parser::MoveEvent>)
+              nodes[slot].handle(e);
+          },
+          events[i]);
+    }
+  }
+
+  /**
+   * Reverse every event, the way `SceneWidget::handleUndoEvents()` does
+   */
+  void undo() {
+    for (auto i = events.size(); i > 0u; i--) {
+      const auto index = i - 1u;
+      const auto slot = streams.slot(index);
+      const auto previous = streams.previousOfKind(index);
+      const auto position = previous == parser::EntityEventStreams::noEvent
+                                ? streams.getInitialPosition(slot)
+                                : std::get<parser::MoveEvent>(events[previous]).targetPosition;
+      nodes[slot].handle(netsimulyzer::undo::MoveEvent{position});
+    }
+  }
+};
+
+std::vector<Case> sceneBenchmarks() {
+  constexpr auto events = 1'000'000LL;
+  auto fixture = std::make_shared<SceneFixture>(1000u, static_cast<std::size_t>(events));
+
+  return {{"scene/dispatch", events,
+           [fixture] {
+             return timed([&fixture] {
+               fixture->dispatch();
+             });
+           }},
+          {"scene/undo", events, [fixture] {
+             // Undo from the end, so dispatch first, untimed
+             fixture->dispatch();
+             return timed([&fixture] {
+               fixture->undo();
+             });
+           }}};
+}
+
+std::vector<Case> modelBenchmarks() {
+  constexpr auto operations = 1'000'000LL;
+  auto model = std::make_shared<netsimulyzer::Model>(0u, glm::vec3{-1.0f}, glm::vec3{1.0f});
+  model->setRotate(10.0f, 20.0f, 30.0f);
+  model->setScale(glm::vec3{2.0f});
+
+  return {{"model/rebuild-matrix", operations, [model] {
+             return timed([&model] {
+               for (auto i = 0LL; i < operations; i++) {
+                 model->setPosition(glm::vec3{static_cast<float>(i % 1000LL), 0.0f, 0.0f});
+                 // Rebuilt on read
+                 static_cast<void>(model->getModelMatrix());
+               }
+             });
+           }}};
+}
+
+// ----- Charts & logs -----
+
+std::vector<Case> chartBenchmarks() {
+  constexpr auto points = 500'000LL;
+
+  return {{"chart/xy-append", points, [] {
+             auto models = std::make_shared<parser::StaticModels>();
+             parser::XYSeries series;
+             series.id = 0u;
+             series.name = "Series";
+             models->xySeries.emplace_back(series);
+
+             netsimulyzer::ChartManager charts{nullptr};
+             charts.addSeries(models);
+
+             std::vector<parser::ChartEvent> events;
+             events.reserve(static_cast<std::size_t>(points));
+             for (auto i = 0LL; i < points; i++)
+               events.emplace_back(parser::XYSeriesAddValue{i * 1000LL, 0u, {static_cast<double>(i), 0.5}});
+             charts.enqueueEvents(std::move(events));
+
+             return timed([&charts] {
+               charts.timeChanged(points * 1000LL, 1LL);
+             });
+           }}};
+}
+
+std::vector<Case> logBenchmarks() {
+  constexpr auto lines = 200'000LL;
+
+  return {{"log/append", lines, [] {
+             parser::LogStream stream;
+             stream.id = 0u;
+             stream.name = "Log";
+
+             netsimulyzer::ScenarioLogWidget log;
+             log.addStream(stream);
+
+             std::vector<parser::LogEvent> events;
+             events.reserve(static_cast<std::size_t>(lines));
+             for (auto i = 0LL; i < lines; i++)
+               events.emplace_back(
+                   parser::StreamAppendEvent{i * 1000LL, 0u, "Packet " + std::to_string(i) + " received\n"});
+             log.enqueueEvents(std::move(events));
+
+             return timed([&log] {
+               log.timeChanged(lines * 1000LL, 1LL);
+             });
+           }}};
+}
+
+// ----- OpenGL -----
+
+/**
+ * State shared by the cases needing a context.
+ * Must be destroyed while the context is current
+ */
+struct GlFixture {
+  QOpenGLFunctions_3_3_Core functions;
+  netsimulyzer::TextureCache textures;
+  netsimulyzer::FontManager fontManager{textures};
+  netsimulyzer::TrailPool trailPool;
+  std::unique_ptr<SceneFixture> scene;
+  std::unique_ptr<netsimulyzer::WiredLinkBatch> links;
+};
+
+std::vector<Case> glBenchmarks(GlFixture &gl) {
+  constexpr auto appends = 1'000'000LL;
+  constexpr auto labels = 100'000LL;
+  constexpr auto moves = 1'000'000LL;
+  constexpr auto trailLength = 100;
+
+  gl.functions.initializeOpenGLFunctions();
+  netsimulyzer::glState.init();
+  gl.trailPool.init(&gl.functions);
+  gl.trailPool.reset(trailLength);
+  if (!gl.textures.init()) {
+    std::cerr << "Failed Initializing Texture Cache\n";
+    std::abort();
+  }
+  gl.fontManager.init(":/texture/resources/textures/undefined-medium.png");
+
+  // Every Node with two links, so each move updates two vertices
+  gl.scene = std::make_unique<SceneFixture>(1000u, static_cast<std::size_t>(moves));
+  std::vector<parser::WiredLink> wiredLinks;
+  for (auto i = 0u; i < gl.scene->models.size(); i++) {
+    parser::WiredLink link;
+    link.nodes = {i, static_cast<unsigned int>((i + 1u) % gl.scene->models.size())};
+    wiredLinks.emplace_back(link);
+  }
+  const auto endpoints = netsimulyzer::WiredLinkBatch::layout(wiredLinks);
+  gl.links = std::make_unique<netsimulyzer::WiredLinkBatch>(
+      netsimulyzer::WiredLinkBatch::RenderInfo{0u, 0u, static_cast<int>(endpoints.size())});
+  for (const auto &endpoint : endpoints)
+    gl.scene->nodes[gl.scene->streams.nodeSlot(endpoint.nodeId)].addWiredLink(gl.links.get(), endpoint.vertex);
+
+  return {{"trail/append", appends,
+           [&gl] {
+             netsimulyzer::TrailBuffer trail{trailLength};
+             trail.allocate(gl.trailPool);
+             const auto time = timed([&trail] {
+               for (auto i = 0LL; i < appends; i++) {
+                 trail.append(static_cast<float>(i), 0.0f, 1.0f);
+                 // Flushed once a frame, after a few moves
+                 if (i % 16LL == 15LL)
+                   trail.flush();
+               }
+             });
+             trail.release();
+             return time;
+           }},
+          {"links/node-moved", moves,
+           [&gl] {
+             return timed([&gl] {
+               gl.scene->dispatch();
+             });
+           }},
+          {"font/allocate", labels, [&gl] {
+             std::vector<std::string> names;
+             for (auto i = 0LL; i < labels; i++)
+               names.emplace_back("Node " + std::to_string(i));
+
+             gl.fontManager.reset();
+             return timed([&gl, &names] {
+               for (const auto &name : names)
+                 gl.fontManager.allocate(name);
+             });
+           }}};
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  // Matches the application, so its settings are read
+  QCoreApplication::setOrganizationName("NIST");
+  QCoreApplication::setOrganizationDomain("nist.gov");
+  QCoreApplication::setApplicationName(NETSIMULYZER_APPLICATION_NAME);
+  QSettings::setDefaultFormat(QSettings::Format::IniFormat);
+
+  QSurfaceFormat format;
+  format.setVersion(3, 3);
+  format.setProfile(QSurfaceFormat::CoreProfile);
+  QSurfaceFormat::setDefaultFormat(format);
+
+  // The chart & log widgets require an application
+  QApplication application{argc, argv};
+
+  if (argc > 3) {
+    std::cerr << "Usage: " << argv[0] << " [output] [filter]\n";
+    return 1;
+  }
+  const std::string filter = argc == 3 ? argv[2] : "";
+
+  std::vector<Case> cases;
+  const auto add = [&cases](std::vector<Case> &&more) {
+    std::move(more.begin(), more.end(), std::back_inserter(cases));
+  };
+  add(parseBenchmarks(QDir::tempPath().toStdString()));
+  add(sceneBenchmarks());
+  add(modelBenchmarks());
+  add(chartBenchmarks());
+  add(logBenchmarks());
+
+  QOffscreenSurface surface;
+  surface.create();
+  QOpenGLContext context;
+  std::unique_ptr<GlFixture> gl;
+  const auto hasContext = context.create() && context.makeCurrent(&surface);
+  if (hasContext) {
+    gl = std::make_unique<GlFixture>();
+    add(glBenchmarks(*gl));
+  } else
+    std::cerr << "Failed to create an offscreen OpenGL 3.3 context, skipping the OpenGL cases\n";
+
+  QJsonArray results;
+  for (const auto &benchmark : cases) {
+    if (benchmark.name.find(filter) == std::string::npos)
+      continue;
+
+    std::cerr << benchmark.name << "...\n";
+    results.append(run(benchmark));
+  }
+
+  // GL objects are released with the context current
+  gl.reset();
+  if (hasContext)
+    context.doneCurrent();
+
+  for (const auto &[type, body] : parseCases)
+    std::remove((QDir::tempPath().toStdString() + "/netsimulyzer-microbench-" + type + ".json").c_str());
+
+  QJsonObject report;
+  report["version"] = NETSIMULYZER_VERSION;
+  report["opengl"] = hasContext;
+  report["cases"] = results;
+  const auto json = QJsonDocument{report}.toJson();
+
+  if (argc < 2) {
+    std::cout << json.toStdString();
+    return 0;
+  }
+
+  std::ofstream output{argv[1], std::ios::binary};
+  output << json.toStdString();
+  if (!output) {
+    std::cerr << "Failed to write " << argv[1] << '\n';
+    return 1;
+  }
+
+  return 0;
+}
@@ -0,0 +1,374 @@
+/*
+ * NIST-developed software is provided by NIST as a public service. You may use,
+ * copy and distribute copies of the software in any medium, provided that you
+ * keep intact this entire notice. You may improve,modify and create derivative
+ * works of the software or any portion of the software, and you may copy and
+ * distribute such modifications or works. Modified works should carry a notice
+ * stating that you changed the software and should note the date and nature of
+ * any such change. Please explicitly acknowledge the National Institute of
+ * Standards and Technology as the source of the software.
+ *
+ * NIST-developed software is expressly provided "AS IS." NIST MAKES NO
+ * WARRANTY OF ANY KIND, EXPRESS, IMPLIED, IN FACT OR ARISING BY OPERATION OF
+ * LAW, INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTY OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, NON-INFRINGEMENT
+ * AND DATA ACCURACY. NIST NEITHER REPRESENTS NOR WARRANTS THAT THE
+ * OPERATION OF THE SOFTWARE WILL BE UNINTERRUPTED OR ERROR-FREE, OR THAT
+ * ANY DEFECTS WILL BE CORRECTED. NIST DOES NOT WARRANT OR MAKE ANY
+ * REPRESENTATIONS REGARDING THE USE OF THE SOFTWARE OR THE RESULTS THEREOF,
+ * INCLUDING BUT NOT LIMITED TO THE CORRECTNESS, ACCURACY, RELIABILITY,
+ * OR USEFULNESS OF THE SOFTWARE.
+ *
+ * You are solely responsible for determining the appropriateness of using and
+ * distributing the software and you assume all risks associated with its use,
+ * including but not limited to the risks and costs of program errors,
+ * compliance with applicable laws, damage to or loss of data, programs or
+ * equipment, and the unavailability or interruption of operation. This
+ * software is not intended to be used in any situation where a failure could
+ * cause risk of injury or damage to property. The software developed by NIST
+ * employees is not subject to copyright protection within the United States.
+ *
+ * Author: Evan Black <evan.black@nist.gov>
+ */
+
+#include <QApplication>
+#include <QByteArray>
+#include <QImage>
+#include <QKeyEvent>
+#include <QMetaObject>
+#include <QMouseEvent>
+#include <QPainter>
+#include <QString>
+#include <QWidget>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <netdb.h>
+#include <optional>
+#include <string>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <thread>
+#include <unistd.h>
+
+namespace {
+
+/**
+ * Connect to a view served with `--serve`
+ *
+ * @param address
+ * 'unix:' followed by the path of a Unix socket,
+ * or a TCP port, optionally preceded by 'tcp:' and a host, and a colon
+ *
+ * @return
+ * The connected socket, or an unset optional, after printing why
+ */
+std::optional<int> connectTo(const std::string &address) {
+  const std::string unixPrefix{"unix:"};
+  if (address.compare(0u, unixPrefix.size(), unixPrefix) == 0) {
+    sockaddr_un remote{};
+    remote.sun_family = AF_UNIX;
+
+    const auto path = address.substr(unixPrefix.size());
+    if (path.empty() || path.size() >= sizeof(remote.sun_path)) {
+      std::cerr << "Invalid Unix socket path: " << path << '\n';
+      return {};
+    }
+    std::memcpy(remote.sun_path, path.c_str(), path.size() + 1u);
+
+    const auto connection = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (connection == -1 || ::connect(connection, reinterpret_cast<sockaddr *>(&remote), sizeof(remote)) == -1) {
+      std::cerr << "Failed to connect to " << path << ": " << std::strerror(errno) << '\n';
+      if (connection != -1)
+        ::close(connection);
+      return {};
+    }
+    return connection;
+  }
+
+  auto rest = address;
+  const std::string tcpPrefix{"tcp:"};
+  if (rest.compare(0u, tcpPrefix.size(), tcpPrefix) == 0)
+    rest.erase(0u, tcpPrefix.size());
+
+  std::string host{"localhost"};
+  auto port = rest;
+  if (const auto colon = rest.rfind(':'); colon != std::string::npos) {
+    host = rest.substr(0u, colon);
+    port = rest.substr(colon + 1u);
+  }
+
+  addrinfo hints{};
+  hints.ai_family = AF_UNSPEC;
+  hints.ai_socktype = SOCK_STREAM;
+
+  addrinfo *found = nullptr;
+  if (const auto status = ::getaddrinfo(host.c_str(), port.c_str(), &hints, &found); status != 0) {
+    std::cerr << "Failed to resolve " << address << ": " << ::gai_strerror(status) << '\n';
+    return {};
+  }
+
+  auto connection = -1;
+  for (auto candidate = found; candidate; candidate = candidate->ai_next) {
+    connection = ::socket(candidate->ai_family, candidate->ai_socktype, candidate->ai_protocol);
+    if (connection == -1)
+      continue;
+
+    if (::connect(connection, candidate->ai_addr, candidate->ai_addrlen) == 0)
+      break;
+
+    ::close(connection);
+    connection = -1;
+  }
+  ::freeaddrinfo(found);
+
+  if (connection == -1) {
+    std::cerr << "Failed to connect to " << address << '\n';
+    return {};
+  }
+  return connection;
+}
+
+/**
+ * Shows the frames of a served view, and sends back the input to move it
+ */
+class RemoteView : public QWidget {
+  int connection;
+  std::thread reader;
+  std::atomic<bool> stopRequested{false};
+
+  /**
+   * The latest frame, and the view it was drawn from
+   */
+  QImage frame;
+  qint64 time{0};
+  float x{0.0f};
+  float y{0.0f};
+  float z{0.0f};
+  float yaw{-90.0f};
+  float pitch{0.0f};
+  bool playing = false;
+
+  /**
+   * Where the last mouse drag was, while one is held
+   */
+  std::optional<QPoint> dragFrom;
+
+  /**
+   * Distance moved per key press
+   */
+  static constexpr float moveStep = 1.0f;
+
+  /**
+   * Degrees turned per pixel dragged
+   */
+  static constexpr float turnSpeed = 0.2f;
+
+  void send(const QString &command) {
+    const auto line = (command + '\n').toUtf8();
+    auto data = line.constData();
+    auto size = static_cast<std::size_t>(line.size());
+    while (size > 0u) {
+      const auto sent = ::send(connection, data, size, MSG_NOSIGNAL);
+      if (sent <= 0)
+        return;
+      data += sent;
+      size -= static_cast<std::size_t>(sent);
+    }
+  }
+
+  void sendCamera() {
+    send(QString{"camera %1 %2 %3 %4 %5"}.arg(x).arg(y).arg(z).arg(yaw).arg(pitch));
+  }
+
+  /**
+   * Read frames until the connection closes. Runs on `reader`
+   */
+  void read() {
+    QByteArray received;
+    std::array<char, 64 * 1024> buffer{};
+
+    while (!stopRequested) {
+      const auto count = ::recv(connection, buffer.data(), buffer.size(), 0);
+      if (count == -1 && errno == EINTR)
+        continue;
+      if (count <= 0)
+        break;
+      received.append(buffer.data(), static_cast<int>(count));
+
+      // Every complete frame, keeping only the last
+      while (true) {
+        const auto end = received.indexOf('\n');
+        if (end == -1)
+          break;
+
+        const auto parts = QString::fromUtf8(received.left(end)).split(' ');
+        if (parts.size() != 10 || parts.front() != "frame") {
+          std::cerr << "Unexpected header from the server\n";
+          QMetaObject::invokeMethod(
+              this,
+              [this]() {
+                close();
+              },
+              Qt::QueuedConnection);
+          return;
+        }
+
+        const auto size = parts[9].toInt();
+        if (received.size() < end + 1 + size)
+          break;
+
+        auto image = QImage::fromData(received.mid(end + 1, size), "JPG");
+        received.remove(0, end + 1 + size);
+
+        QMetaObject::invokeMethod(
+            this,
+            [this, image = std::move(image), parts]() {
+              frame = image;
+              time = parts[1].toLongLong();
+              x = parts[4].toFloat();
+              y = parts[5].toFloat();
+              z = parts[6].toFloat();
+              yaw = parts[7].toFloat();
+              pitch = parts[8].toFloat();
+              setWindowTitle(QString{"Remote View - %1s"}.arg(static_cast<double>(time) / 1'000'000'000.0, 0, 'f', 3));
+              update();
+            },
+            Qt::QueuedConnection);
+      }
+    }
+
+    QMetaObject::invokeMethod(
+        this,
+        [this]() {
+          close();
+        },
+        Qt::QueuedConnection);
+  }
+
+protected:
+  void paintEvent(QPaintEvent *) override {
+    QPainter painter{this};
+    painter.fillRect(rect(), Qt::black);
+    if (!frame.isNull())
+      painter.drawImage(rect(), frame);
+  }
+
+  void resizeEvent(QResizeEvent *) override {
+    const auto ratio = devicePixelRatioF();
+    send(QString{"size %1 %2"}.arg(static_cast<int>(width() * ratio)).arg(static_cast<int>(height() * ratio)));
+  }
+
+  void keyPressEvent(QKeyEvent *event) override {
+    // Same as `Camera::update_vectors()`
+    const auto yawRadians = yaw * static_cast<float>(M_PI) / 180.0f;
+    const auto pitchRadians = pitch * static_cast<float>(M_PI) / 180.0f;
+    const auto frontX = std::cos(yawRadians) * std::cos(pitchRadians);
+    const auto frontY = std::sin(pitchRadians);
+    const auto frontZ = std::sin(yawRadians) * std::cos(pitchRadians);
+
+    // The cross of the front & world up, flattened
+    const auto rightX = -std::sin(yawRadians);
+    const auto rightZ = std::cos(yawRadians);
+
+    switch (event->key()) {
+    case Qt::Key_W:
+      x += frontX * moveStep;
+      y += frontY * moveStep;
+      z += frontZ * moveStep;
+      break;
+    case Qt::Key_S:
+      x -= frontX * moveStep;
+      y -= frontY * moveStep;
+      z -= frontZ * moveStep;
+      break;
+    case Qt::Key_D:
+      x += rightX * moveStep;
+      z += rightZ * moveStep;
+      break;
+    case Qt::Key_A:
+      x -= rightX * moveStep;
+      z -= rightZ * moveStep;
+      break;
+    case Qt::Key_Space:
+      playing = !playing;
+      send(playing ? "play" : "pause");
+      return;
+    default:
+      QWidget::keyPressEvent(event);
+      return;
+    }
+
+    sendCamera();
+  }
+
+  void mousePressEvent(QMouseEvent *event) override {
+    dragFrom = event->pos();
+  }
+
+  void mouseReleaseEvent(QMouseEvent *) override {
+    dragFrom.reset();
+  }
+
+  void mouseMoveEvent(QMouseEvent *event) override {
+    if (!dragFrom)
+      return;
+
+    const auto delta = event->pos() - dragFrom.value();
+    dragFrom = event->pos();
+
+    yaw += static_cast<float>(delta.x()) * turnSpeed;
+    pitch = std::clamp(pitch - static_cast<float>(delta.y()) * turnSpeed, -89.0f, 89.0f);
+    sendCamera();
+  }
+
+public:
+  explicit RemoteView(int connection) : connection(connection) {
+    setFocusPolicy(Qt::StrongFocus);
+    resize(1280, 720);
+    reader = std::thread{&RemoteView::read, this};
+  }
+
+  RemoteView(const RemoteView &) = delete;
+  RemoteView &operator=(const RemoteView &) = delete;
+
+  ~RemoteView() override {
+    stopRequested = true;
+
+    // Wakes `reader` from `recv()`
+    ::shutdown(connection, SHUT_RDWR);
+    reader.join();
+    ::close(connection);
+  }
+};
+
+} // namespace
+
+/**
+ * Shows a view served by the application started with `--serve <address>`, see `RenderServer`.
+ * Only the frames are sent, so the scenario stays on the serving machine.
+ *
+ * WASD moves the camera, dragging with the mouse turns it, and space plays or pauses.
+ *
+ * Usage: netsimulyzer-remote <address>
+ */
+int main(int argc, char *argv[]) {
+  QApplication application{argc, argv};
+
+  if (argc != 2) {
+    std::cerr << "Usage: " << argv[0] << " <address>\n";
+    return 1;
+  }
+
+  const auto connection = connectTo(argv[1]);
+  if (!connection)
+    return 1;
+
+  RemoteView view{connection.value()};
+  view.show();
+  return QApplication::exec();
+}
@@ -0,0 +1,186 @@
+/*
+ * NIST-developed software is provided by NIST as a public service. You may use,
+ * copy and distribute copies of the software in any medium, provided that you
+ * keep intact this entire notice. You may improve,modify and create derivative
+ * works of the software or any portion of the software, and you may copy and
+ * distribute such modifications or works. Modified works should carry a notice
+ * stating that you changed the software and should note the date and nature of
+ * any such change. Please explicitly acknowledge the National Institute of
+ * Standards and Technology as the source of the software.
+ *
+ * NIST-developed software is expressly provided "AS IS." NIST MAKES NO
+ * WARRANTY OF ANY KIND, EXPRESS, IMPLIED, IN FACT OR ARISING BY OPERATION OF
+ * LAW, INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTY OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, NON-INFRINGEMENT
+ * AND DATA ACCURACY. NIST NEITHER REPRESENTS NOR WARRANTS THAT THE
+ * OPERATION OF THE SOFTWARE WILL BE UNINTERRUPTED OR ERROR-FREE, OR THAT
+ * ANY DEFECTS WILL BE CORRECTED. NIST DOES NOT WARRANT OR MAKE ANY
+ * REPRESENTATIONS REGARDING THE USE OF THE SOFTWARE OR THE RESULTS THEREOF,
+ * INCLUDING BUT NOT LIMITED TO THE CORRECTNESS, ACCURACY, RELIABILITY,
+ * OR USEFULNESS OF THE SOFTWARE.
+ *
+ * You are solely responsible for determining the appropriateness of using and
+ * distributing the software and you assume all risks associated with its use,
+ * including but not limited to the risks and costs of program errors,
+ * compliance with applicable laws, damage to or loss of data, programs or
+ * equipment, and the unavailability or interruption of operation. This
+ * software is not intended to be used in any situation where a failure could
+ * cause risk of injury or damage to property. The software developed by NIST
+ * employees is not subject to copyright protection within the United States.
+ *
+ * Author: Evan Black <evan.black@nist.gov>
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <iomanip>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace netsimulyzer {
+
+/**
+ * The time spent on each phase of loading a scenario,
+ * to find which part of a load is slow for a given file.
+ *
+ * Phases on the GUI thread are measured where they run.
+ * The parser runs alongside them on the loader thread, and waits while the sections are added,
+ * so the phases overlap the parse time rather than adding up to the total
+ */
+class LoadReport {
+public:
+  using duration = std::chrono::steady_clock::duration;
+
+  struct Phase {
+    std::string name;
+    duration time;
+  };
+
+private:
+  std::vector<Phase> phases;
+
+  /**
+   * The size of the scenario file, 0 if it was not read from a file
+   */
+  std::size_t bytes{0u};
+  std::size_t events{0u};
+
+  /**
+   * The time taken by the parser, which the rates are based on
+   */
+  duration parseTime{};
+
+  /**
+   * From the start of the load until every event was added
+   */
+  duration totalTime{};
+
+public:
+  /**
+   * Add to the time of a phase, adding the phase if it's not in the report yet
+   *
+   * @param name
+   * The phase, e.g. "Chart series"
+   *
+   * @param time
+   * The time to add to the phase
+   */
+  void add(const std::string &name, duration time) {
+    for (auto &phase : phases) {
+      if (phase.name == name) {
+        phase.time += time;
+        return;
+      }
+    }
+    phases.push_back({name, time});
+  }
+
+  void setBytes(std::size_t value) {
+    bytes = value;
+  }
+
+  void addEvents(std::size_t count) {
+    events += count;
+  }
+
+  void setParseTime(duration value) {
+    parseTime = value;
+  }
+
+  void setTotalTime(duration value) {
+    totalTime = value;
+  }
+
+  [[nodiscard]] const std::vector<Phase> &getPhases() const {
+    return phases;
+  }
+
+  [[nodiscard]] std::size_t getEvents() const {
+    return events;
+  }
+
+  /**
+   * @return
+   * The events parsed per second, 0 if the parse took no time
+   */
+  [[nodiscard]] double eventsPerSecond() const {
+    const auto seconds = std::chrono::duration<double>{parseTime}.count();
+    return seconds > 0.0 ? static_cast<double>(events) / seconds : 0.0;
+  }
+
+  /**
+   * @return
+   * The bytes of the file parsed per second, 0 if the parse took no time
+   */
+  [[nodiscard]] double bytesPerSecond() const {
+    const auto seconds = std::chrono::duration<double>{parseTime}.count();
+    return seconds > 0.0 ? static_cast<double>(bytes) / seconds : 0.0;
+  }
+
+  void clear() {
+    phases.clear();
+    bytes = 0u;
+    events = 0u;
+    parseTime = {};
+    totalTime = {};
+  }
+
+  /**
+   * @return
+   * `time` in milliseconds, with one decimal place
+   */
+  [[nodiscard]] static std::string formatTime(duration time) {
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(1) << std::chrono::duration<double, std::milli>{time}.count() << "ms";
+    return out.str();
+  }
+
+  /**
+   * @return
+   * The totals & rates on one line, for the status bar
+   */
+  [[nodiscard]] std::string summary() const {
+    std::ostringstream out;
+    out << formatTime(totalTime) << " total, " << events << " events at " << std::fixed << std::setprecision(0)
+        << eventsPerSecond() << " events/s";
+    if (bytes > 0u)
+      out << ", " << std::setprecision(1) << bytesPerSecond() / (1024.0 * 1024.0) << " MiB/s";
+    return out.str();
+  }
+
+  /**
+   * Write a line per phase, then the summary
+   */
+  void write(std::ostream &out) const {
+    out << "Parse: " << formatTime(parseTime) << '\n';
+    for (const auto &phase : phases)
+      out << phase.name << ": " << formatTime(phase.time) << '\n';
+    out << summary() << '\n';
+  }
+};
+
+} // namespace netsimulyzer
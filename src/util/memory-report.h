@@ -0,0 +1,166 @@
+/*
+ * NIST-developed software is provided by NIST as a public service. You may use,
+ * copy and distribute copies of the software in any medium, provided that you
+ * keep intact this entire notice. You may improve,modify and create derivative
+ * works of the software or any portion of the software, and you may copy and
+ * distribute such modifications or works. Modified works should carry a notice
+ * stating that you changed the software and should note the date and nature of
+ * any such change. Please explicitly acknowledge the National Institute of
+ * Standards and Technology as the source of the software.
+ *
+ * NIST-developed software is expressly provided "AS IS." NIST MAKES NO
+ * WARRANTY OF ANY KIND, EXPRESS, IMPLIED, IN FACT OR ARISING BY OPERATION OF
+ * LAW, INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTY OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, NON-INFRINGEMENT
+ * AND DATA ACCURACY. NIST NEITHER REPRESENTS NOR WARRANTS THAT THE
+ * OPERATION OF THE SOFTWARE WILL BE UNINTERRUPTED OR ERROR-FREE, OR THAT
+ * ANY DEFECTS WILL BE CORRECTED. NIST DOES NOT WARRANT OR MAKE ANY
+ * REPRESENTATIONS REGARDING THE USE OF THE SOFTWARE OR THE RESULTS THEREOF,
+ * INCLUDING BUT NOT LIMITED TO THE CORRECTNESS, ACCURACY, RELIABILITY,
+ * OR USEFULNESS OF THE SOFTWARE.
+ *
+ * You are solely responsible for determining the appropriateness of using and
+ * distributing the software and you assume all risks associated with its use,
+ * including but not limited to the risks and costs of program errors,
+ * compliance with applicable laws, damage to or loss of data, programs or
+ * equipment, and the unavailability or interruption of operation. This
+ * software is not intended to be used in any situation where a failure could
+ * cause risk of injury or damage to property. The software developed by NIST
+ * employees is not subject to copyright protection within the United States.
+ *
+ * Author: Evan Black <evan.black@nist.gov>
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <deque>
+#include <iomanip>
+#include <iterator>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace netsimulyzer {
+
+/**
+ * The bytes held by each part of the application,
+ * to find what is responsible for the memory used by large scenarios.
+ *
+ * Parts count the containers they hold, so the totals are estimates.
+ * Allocator overhead, & memory held inside Qt or the driver, are not counted
+ */
+class MemoryReport {
+public:
+  enum class Kind { Host, Gpu, Disk };
+
+  struct Entry {
+    /**
+     * The part of the application holding the memory, e.g. "Scene"
+     */
+    std::string subsystem;
+
+    /**
+     * What the memory is used for, within `subsystem`
+     */
+    std::string name;
+    Kind kind;
+    std::size_t bytes;
+  };
+
+private:
+  std::vector<Entry> entries;
+
+public:
+  void add(std::string subsystem, std::string name, std::size_t bytes, Kind kind = Kind::Host) {
+    entries.push_back({std::move(subsystem), std::move(name), kind, bytes});
+  }
+
+  [[nodiscard]] const std::vector<Entry> &getEntries() const {
+    return entries;
+  }
+
+  [[nodiscard]] std::size_t total(Kind kind) const {
+    std::size_t sum = 0u;
+    for (const auto &entry : entries) {
+      if (entry.kind == kind)
+        sum += entry.bytes;
+    }
+    return sum;
+  }
+
+  /**
+   * @return
+   * The text marking entries of `kind`, empty for host memory
+   */
+  [[nodiscard]] static const char *suffix(Kind kind) {
+    switch (kind) {
+    case Kind::Gpu:
+      return " (GPU)";
+    case Kind::Disk:
+      return " (disk)";
+    default:
+      return "";
+    }
+  }
+
+  /**
+   * @param bytes
+   * The size to show
+   *
+   * @return
+   * `bytes` in the largest unit it has at least one of, e.g. "1.50 MiB"
+   */
+  [[nodiscard]] static std::string formatBytes(std::size_t bytes) {
+    constexpr const char *units[]{"B", "KiB", "MiB", "GiB", "TiB"};
+
+    auto value = static_cast<double>(bytes);
+    std::size_t unit = 0u;
+    while (value >= 1024.0 && unit + 1u < std::size(units)) {
+      value /= 1024.0;
+      unit++;
+    }
+
+    std::ostringstream out;
+    if (unit == 0u)
+      out << bytes << ' ' << units[unit];
+    else
+      out << std::fixed << std::setprecision(2) << value << ' ' << units[unit];
+    return out.str();
+  }
+
+  /**
+   * Write a line per entry, then the totals
+   */
+  void write(std::ostream &out) const {
+    for (const auto &entry : entries) {
+      out << entry.subsystem << " / " << entry.name << suffix(entry.kind) << ": " << formatBytes(entry.bytes) << '\n';
+    }
+    out << "Total: " << formatBytes(total(Kind::Host)) << ", GPU: " << formatBytes(total(Kind::Gpu))
+        << ", Disk: " << formatBytes(total(Kind::Disk)) << '\n';
+  }
+};
+
+/**
+ * @return
+ * The bytes allocated for the elements of `values`,
+ * not counting memory the elements own themselves
+ */
+template <typename T>
+[[nodiscard]] std::size_t containerBytes(const std::vector<T> &values) {
+  return values.capacity() * sizeof(T);
+}
+
+/**
+ * @return
+ * The bytes used by the elements of `values`,
+ * not counting memory the elements own themselves
+ */
+template <typename T>
+[[nodiscard]] std::size_t containerBytes(const std::deque<T> &values) {
+  return values.size() * sizeof(T);
+}
+
+} // namespace netsimulyzer
@@ -0,0 +1,181 @@
+/*
+ * NIST-developed software is provided by NIST as a public service. You may use,
+ * copy and distribute copies of the software in any medium, provided that you
+ * keep intact this entire notice. You may improve,modify and create derivative
+ * works of the software or any portion of the software, and you may copy and
+ * distribute such modifications or works. Modified works should carry a notice
+ * stating that you changed the software and should note the date and nature of
+ * any such change. Please explicitly acknowledge the National Institute of
+ * Standards and Technology as the source of the software.
+ *
+ * NIST-developed software is expressly provided "AS IS." NIST MAKES NO
+ * WARRANTY OF ANY KIND, EXPRESS, IMPLIED, IN FACT OR ARISING BY OPERATION OF
+ * LAW, INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTY OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, NON-INFRINGEMENT
+ * AND DATA ACCURACY. NIST NEITHER REPRESENTS NOR WARRANTS THAT THE
+ * OPERATION OF THE SOFTWARE WILL BE UNINTERRUPTED OR ERROR-FREE, OR THAT
+ * ANY DEFECTS WILL BE CORRECTED. NIST DOES NOT WARRANT OR MAKE ANY
+ * REPRESENTATIONS REGARDING THE USE OF THE SOFTWARE OR THE RESULTS THEREOF,
+ * INCLUDING BUT NOT LIMITED TO THE CORRECTNESS, ACCURACY, RELIABILITY,
+ * OR USEFULNESS OF THE SOFTWARE.
+ *
+ * You are solely responsible for determining the appropriateness of using and
+ * distributing the software and you assume all risks associated with its use,
+ * including but not limited to the risks and costs of program errors,
+ * compliance with applicable laws, damage to or loss of data, programs or
+ * equipment, and the unavailability or interruption of operation. This
+ * software is not intended to be used in any situation where a failure could
+ * cause risk of injury or damage to property. The software developed by NIST
+ * employees is not subject to copyright protection within the United States.
+ *
+ * Author: Evan Black <evan.black@nist.gov>
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace netsimulyzer {
+
+/**
+ * Counters & gauges describing the health of a running viewer,
+ * written for a metrics scraper (see `MetricsServer`), or as a log line.
+ *
+ * Samples with the same name should be added together, each with its own labels
+ */
+class MetricsReport {
+public:
+  enum class Type { Counter, Gauge };
+
+  using Labels = std::vector<std::pair<std::string, std::string>>;
+
+  struct Sample {
+    /**
+     * Without the 'netsimulyzer_' prefix, e.g. "frames_total"
+     */
+    std::string name;
+    std::string help;
+    Type type;
+    Labels labels;
+    double value;
+  };
+
+private:
+  std::vector<Sample> samples;
+
+  /**
+   * Escape `text` for a quoted string in either format
+   */
+  static void writeQuoted(std::ostream &out, const std::string &text) {
+    out << '"';
+    for (const auto c : text) {
+      if (c == '"' || c == '\\')
+        out << '\\' << c;
+      else if (c == '\n')
+        out << "\\n";
+      else
+        out << c;
+    }
+    out << '"';
+  }
+
+  static void writeValue(std::ostream &out, double value) {
+    const auto precision = out.precision(15);
+    out << value;
+    out.precision(precision);
+  }
+
+public:
+  void add(std::string name, std::string help, Type type, double value, Labels labels = {}) {
+    samples.push_back({std::move(name), std::move(help), type, std::move(labels), value});
+  }
+
+  [[nodiscard]] const std::vector<Sample> &getSamples() const {
+    return samples;
+  }
+
+  /**
+   * Write every sample in the Prometheus text exposition format,
+   * with the help & type once per name
+   */
+  void writePrometheus(std::ostream &out) const {
+    const std::string *previous = nullptr;
+    for (const auto &sample : samples) {
+      if (!previous || *previous != sample.name) {
+        out << "# HELP netsimulyzer_" << sample.name << ' ' << sample.help << '\n';
+        out << "# TYPE netsimulyzer_" << sample.name << ' ' << (sample.type == Type::Counter ? "counter" : "gauge")
+            << '\n';
+        previous = &sample.name;
+      }
+
+      out << "netsimulyzer_" << sample.name;
+      if (!sample.labels.empty()) {
+        out << '{';
+        for (std::size_t i = 0u; i < sample.labels.size(); i++) {
+          if (i > 0u)
+            out << ',';
+          out << sample.labels[i].first << '=';
+          writeQuoted(out, sample.labels[i].second);
+        }
+        out << '}';
+      }
+      out << ' ';
+      writeValue(out, sample.value);
+      out << '\n';
+    }
+  }
+
+  /**
+   * Write every sample as one line of JSON, after `timestamp`.
+   * Samples without labels are written as `"name": value`,
+   * those with labels as an array of objects holding the labels & the value
+   *
+   * @param timestamp
+   * Milliseconds since the Unix epoch
+   */
+  void writeJson(std::ostream &out, long long timestamp) const {
+    out << "{\"timestamp\":" << timestamp;
+    for (std::size_t i = 0u; i < samples.size(); i++) {
+      const auto &sample = samples[i];
+      const auto first = i == 0u || samples[i - 1u].name != sample.name;
+      const auto last = i + 1u == samples.size() || samples[i + 1u].name != sample.name;
+
+      if (sample.labels.empty()) {
+        out << ',';
+        writeQuoted(out, sample.name);
+        out << ':';
+        writeValue(out, sample.value);
+        continue;
+      }
+
+      if (first) {
+        out << ',';
+        writeQuoted(out, sample.name);
+        out << ":[";
+      } else {
+        out << ',';
+      }
+
+      out << '{';
+      for (const auto &[label, value] : sample.labels) {
+        writeQuoted(out, label);
+        out << ':';
+        writeQuoted(out, value);
+        out << ',';
+      }
+      out << "\"value\":";
+      writeValue(out, sample.value);
+      out << '}';
+
+      if (last)
+        out << ']';
+    }
+    out << "}\n";
+  }
+};
+
+} // namespace netsimulyzer
@@ -0,0 +1,126 @@
+/*
+ * NIST-developed software is provided by NIST as a public service. You may use,
+ * copy and distribute copies of the software in any medium, provided that you
+ * keep intact this entire notice. You may improve,modify and create derivative
+ * works of the software or any portion of the software, and you may copy and
+ * distribute such modifications or works. Modified works should carry a notice
+ * stating that you changed the software and should note the date and nature of
+ * any such change. Please explicitly acknowledge the National Institute of
+ * Standards and Technology as the source of the software.
+ *
+ * NIST-developed software is expressly provided "AS IS." NIST MAKES NO
+ * WARRANTY OF ANY KIND, EXPRESS, IMPLIED, IN FACT OR ARISING BY OPERATION OF
+ * LAW, INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTY OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, NON-INFRINGEMENT
+ * AND DATA ACCURACY. NIST NEITHER REPRESENTS NOR WARRANTS THAT THE
+ * OPERATION OF THE SOFTWARE WILL BE UNINTERRUPTED OR ERROR-FREE, OR THAT
+ * ANY DEFECTS WILL BE CORRECTED. NIST DOES NOT WARRANT OR MAKE ANY
+ * REPRESENTATIONS REGARDING THE USE OF THE SOFTWARE OR THE RESULTS THEREOF,
+ * INCLUDING BUT NOT LIMITED TO THE CORRECTNESS, ACCURACY, RELIABILITY,
+ * OR USEFULNESS OF THE SOFTWARE.
+ *
+ * You are solely responsible for determining the appropriateness of using and
+ * distributing the software and you assume all risks associated with its use,
+ * including but not limited to the risks and costs of program errors,
+ * compliance with applicable laws, damage to or loss of data, programs or
+ * equipment, and the unavailability or interruption of operation. This
+ * software is not intended to be used in any situation where a failure could
+ * cause risk of injury or damage to property. The software developed by NIST
+ * employees is not subject to copyright protection within the United States.
+ *
+ * Author: Evan Black <evan.black@nist.gov>
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace netsimulyzer {
+
+/**
+ * A bounded, lock-free queue, for passing values from exactly one producer thread
+ * to exactly one consumer thread.
+ *
+ * Pushing to a full queue fails, rather than waiting,
+ * so the producer decides how to wait, see `LoadWorker`
+ *
+ * @tparam T
+ * The type of the queued values. Must be default constructible & move assignable.
+ * Taken values are replaced with a default constructed one, releasing their memory
+ */
+template <class T>
+class SpscQueue {
+  std::vector<T> slots;
+
+  /**
+   * The number of values ever taken. Only written by the consumer
+   */
+  alignas(64) std::atomic<std::size_t> head{0u};
+
+  /**
+   * The number of values ever pushed. Only written by the producer
+   */
+  alignas(64) std::atomic<std::size_t> tail{0u};
+
+public:
+  /**
+   * @param capacity
+   * The most values waiting in the queue at once. Must not be 0
+   */
+  explicit SpscQueue(std::size_t capacity) : slots(capacity) {
+  }
+
+  /**
+   * Queue a value. Only call from the producer thread
+   *
+   * @param value
+   * The value to queue. Only moved from if it was queued
+   *
+   * @return
+   * True if `value` was queued, false if the queue was full
+   */
+  bool tryPush(T &value) {
+    const auto position = tail.load(std::memory_order_relaxed);
+    if (position - head.load(std::memory_order_acquire) == slots.size())
+      return false;
+
+    slots[position % slots.size()] = std::move(value);
+    tail.store(position + 1u, std::memory_order_release);
+    return true;
+  }
+
+  /**
+   * Take the oldest value. Only call from the consumer thread
+   *
+   * @param value
+   * Set to the value taken, if any
+   *
+   * @return
+   * True if a value was taken, false if the queue was empty
+   */
+  bool tryPop(T &value) {
+    const auto position = head.load(std::memory_order_relaxed);
+    if (position == tail.load(std::memory_order_acquire))
+      return false;
+
+    auto &slot = slots[position % slots.size()];
+    value = std::move(slot);
+    slot = T{};
+    head.store(position + 1u, std::memory_order_release);
+    return true;
+  }
+
+  /**
+   * The number of values waiting. Safe to call from any thread,
+   * though the queue may change as soon as it returns
+   */
+  [[nodiscard]] std::size_t size() const {
+    const auto taken = head.load(std::memory_order_acquire);
+    return tail.load(std::memory_order_acquire) - taken;
+  }
+};
+
+} // namespace netsimulyzer
@@ -33,13 +33,20 @@
 
 #pragma once
 
-#include <QPointF>
-#include <QVector>
 #include <array>
+#include <cstddef>
 #include <glm/vec3.hpp>
 #include <model.h>
+#include <optional>
 #include <variant>
 
+/**
+ * The changes needed to reverse an applied event.
+ *
+ * These are derived from the events before the one being reversed
+ * (see `SceneWidget::reverseEvent()`) when rewinding, rather than
+ * recorded as each event is applied, so they never copy the event itself
+ */
 namespace netsimulyzer::undo {
 
 /**
@@ -47,32 +54,29 @@ namespace netsimulyzer::undo {
  */
 struct MoveEvent {
   /**
-   * The point the Node was at before `event`
-   * was applied.
-   */
-  glm::vec3 position;
-
-  /**
-   * Position stored in the ns-3 model
+   * The position of the Node before the event, in ns-3 coordinates
    */
-  parser::Ns3Coordinate ns3Position;
-
-  /**
-   * The event which generated this undo event
-   */
-  parser::MoveEvent event;
+  parser::Ns3Coordinate position;
 };
 
 /**
  * An event which undoes a `parser::TransmitEvent`
+ * or a `parser::TransmitEndEvent`
  */
 struct TransmitEvent {
-  parser::nanoseconds stopTime;
-  parser::TransmitEvent event;
-};
+  /**
+   * If the Node was transmitting before the event.
+   * The rest of the members are only used if this is set
+   */
+  bool isTransmitting{false};
+  parser::nanoseconds startTime{0LL};
+  double targetSize{2.0};
+  parser::nanoseconds duration{0LL};
 
-struct TransmitEndEvent {
-  parser::TransmitEndEvent event;
+  /**
+   * Color of the transmission, already converted for rendering
+   */
+  glm::vec3 color{0.0f};
 };
 
 /**
@@ -80,15 +84,9 @@ struct TransmitEndEvent {
  */
 struct DecorationMoveEvent {
   /**
-   * The point the Node was at before `event`
-   * was applied.
-   */
-  glm::vec3 position;
-
-  /**
-   * The event which generated this undo event
+   * The position of the Decoration before the event, in ns-3 coordinates
    */
-  parser::DecorationMoveEvent event;
+  parser::Ns3Coordinate position;
 };
 
 /**
@@ -96,17 +94,9 @@ struct DecorationMoveEvent {
  */
 struct NodeOrientationChangeEvent {
   /**
-   * The original orientation of the Node before `event` was applied
-   *
-   * Note: each axis is rotated independently (the x rotation is applied, then y, then z)
-   * rather than combining all three and then rotating.
-   */
-  std::array<float, 3> orientation{0.0};
-
-  /**
-   * The event which generated this undo event
+   * The rotation of the Node before the event, as passed to `Model::setRotate()`
    */
-  parser::NodeOrientationChangeEvent event;
+  std::array<float, 3> rotation{0.0f};
 };
 
 /**
@@ -114,96 +104,48 @@ struct NodeOrientationChangeEvent {
  */
 struct DecorationOrientationChangeEvent {
   /**
-   * The original orientation of the Decoration before `event` was applied
-   *
-   * Note: each axis is rotated independently (the x rotation is applied, then y, then z)
-   * rather than combining all three and then rotating.
-   */
-  std::array<float, 3> orientation{0.0};
-
-  /**
-   * The event which generated this undo event
+   * The rotation of the Decoration before the event, as passed to `Model::setRotate()`
    */
-  parser::DecorationOrientationChangeEvent event;
+  std::array<float, 3> rotation{0.0f};
 };
 
 struct NodeColorChangeEvent {
   /**
-   * The original color before `event` was applied.
-   * If no color was specified before, then this optional
-   * is also unset set.
-   */
-  std::optional<glm::vec3> originalColor;
-
-  /**
-   * The event which generated this undo event
-   */
-  parser::NodeColorChangeEvent event;
-};
-
-/**
- * An event which undoes a `parser::XYSeriesAddValue`
- */
-struct XYSeriesAddValue {
-  /**
-   * The event which generated this undo event
-   */
-  parser::XYSeriesAddValue event;
-};
-
-struct XYSeriesAddValues {
-  /**
-   * The event which generated this undo event
-   */
-  parser::XYSeriesAddValues event;
-};
-
-struct XYSeriesClear {
-  /**
-   * The event which generated this undo event
+   * The color changed by the event
    */
-  parser::XYSeriesClear event;
+  parser::NodeColorChangeEvent::ColorType type{parser::NodeColorChangeEvent::ColorType::Base};
 
   /**
-   * The list of points on the chart before it was cleared
+   * The original color before the event was applied.
+   * If no color was specified before, then this optional
+   * is also unset
    */
-  QVector<QPointF> points;
+  std::optional<parser::Ns3Color3> originalColor;
 };
 
 /**
- * An event which undoes a `parser::CategorySeriesAddValue`
+ * The end of the log before a `parser::StreamAppendEvent`.
+ * The log is append only, so truncating it back to this undoes the event,
+ * and every event after it, at once
  */
-struct CategorySeriesAddValue {
-  /**
-   * The event which generated this undo event
-   */
-  parser::CategorySeriesAddValue event;
-};
-
 struct StreamAppendEvent {
   /**
-   * Number of characters to erase from the unified log
-   * Includes the size of the prompt for every newline
+   * Number of lines in the log before the event
    */
-  int unifiedLogEraseCount{0};
+  std::size_t lineCount{0u};
 
   /**
-   * Original ID of the last writer to the unified log
+   * Length, in bytes, of the last line in the log before the event
    */
-  unsigned int lastUnifiedWriter{0u};
+  std::size_t lastLineLength{0u};
 
   /**
-   * The event which generated this undo event
+   * If the last line in the log before the event did not end with a newline
    */
-  parser::StreamAppendEvent event;
+  bool lastLineOpen{false};
 };
 
-using SceneUndoEvent =
-    std::variant<MoveEvent, TransmitEvent, TransmitEndEvent, DecorationMoveEvent, NodeOrientationChangeEvent,
-                 NodeColorChangeEvent, DecorationOrientationChangeEvent, XYSeriesAddValue, StreamAppendEvent>;
-
-using ChartUndoEvent = std::variant<XYSeriesAddValue, XYSeriesAddValues, XYSeriesClear, CategorySeriesAddValue>;
-
-using LogUndoEvent = std::variant<StreamAppendEvent>;
+using SceneUndoEvent = std::variant<MoveEvent, TransmitEvent, DecorationMoveEvent, NodeOrientationChangeEvent,
+                                    NodeColorChangeEvent, DecorationOrientationChangeEvent>;
 
 } // namespace netsimulyzer::undo
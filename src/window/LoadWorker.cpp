@@ -1,27 +1,306 @@
 #include "LoadWorker.h"
+#include "../settings/SettingsManager.h"
+#include <QDir>
 #include <QElapsedTimer>
+#include <QFileInfo>
+#include <chrono>
+#include <optional>
+#include <parse-cache.h>
+#include <thread>
+#include <trace.h>
+#include <utility>
 
 namespace netsimulyzer {
 
-void LoadWorker::load(const QString &fileName) {
-  QElapsedTimer timer;
+LoadWorker::LoadWorker() {
+  makeProgressive(*parser);
+
+  // Models of a scenario parsed ahead are found too, so they are imported before it is loaded
+  for (auto target : {&first, &second}) {
+    target->setModelFound([this](const std::string &path) {
+      emit modelFound(QString::fromStdString(path));
+    });
+  }
+}
 
-  parser.reset();
+void LoadWorker::makeProgressive(parser::FileParser &target) {
+  target.setProgressive(
+      [this]() {
+        emit sectionsLoaded(currentLoad);
+      },
+      [this](parser::EventBatch &&batch) {
+        deliver(std::move(batch));
+      });
+}
 
-  timer.start();
-  auto parseError = parser.parse(fileName.toStdString().c_str());
-  auto elapsed = static_cast<unsigned long long>(timer.elapsed());
+void LoadWorker::deliver(parser::EventBatch &&batch) {
+  // Index before the batch is queued, so every log event the widgets hold is searchable
+  logIndex.add(batch.logEvents);
+  density.add(batch);
+
+  // Mapped from another viewer, so the copy parsed here is not kept
+  if (sharedEvents)
+    batch.sceneEvents.clear();
+  else if (sharedWriter)
+    sharedWriter->append(batch.sceneEvents);
+
+  // Wait for the window to catch up, holding back the parser
+  Batch tagged{currentLoad, std::move(batch)};
+  while (!batches.tryPush(tagged)) {
+    if (abandoned || cancellation.cancelled())
+      return;
+    std::this_thread::sleep_for(std::chrono::milliseconds{1});
+  }
+  emit eventsLoaded(currentLoad);
+}
+
+void LoadWorker::applySettings(parser::FileParser &target) {
+  // Read on every load, so a changed preference applies to the next file
+  SettingsManager settings;
+  if (settings.get<bool>(SettingsManager::Key::ParserCompactEvents).value())
+    target.setCompaction(settings.get<double>(SettingsManager::Key::ParserCompactionTolerance).value());
+  else
+    target.setCompaction(std::nullopt);
+
+  if (settings.get<bool>(SettingsManager::Key::ParserCache).value())
+    target.setCache(settings.get<QString>(SettingsManager::Key::ParserCacheDirectory).value().toStdString());
+  else
+    target.setCache(std::nullopt);
+}
+
+bool LoadWorker::prepare(unsigned int id, const parser::CancellationToken &token) {
+  stopRequested = false;
+  // After the stop is cleared, so a cancel in between is not lost
+  if (token.cancelled())
+    return false;
+
+  currentLoad = id;
+  cancellation = token;
+  parser->setCancellation(token);
+  parser->reset();
+  logIndex.clear();
+  density.clear();
+  applySettings(*parser);
+
+  sharedWriter.reset();
+  std::lock_guard lock{sharing};
+  sharedEvents.reset();
+  return true;
+}
+
+void LoadWorker::shareEvents(const QString &fileName) {
+  SettingsManager settings;
+  if (!settings.get<bool>(SettingsManager::Key::PlaybackSharedEvents).value() || !QFileInfo{fileName}.isFile())
+    return;
+
+  // Shared memory where there is some, so the events are never written to disk
+  auto directory = settings.get<QString>(SettingsManager::Key::PlaybackSharedEventsDirectory).value();
+  if (directory.isEmpty())
+    directory = QDir{"/dev/shm"}.exists() ? "/dev/shm" : QDir::tempPath();
+
+  // Keyed just as the parse cache is, so an edited scenario is not shared with its old events
+  const auto snapshot = parser::ParseCache{directory.toStdString()}.snapshotPath(fileName.toStdString().c_str());
+  if (!snapshot)
+    return;
+
+  std::optional<double> compaction;
+  if (settings.get<bool>(SettingsManager::Key::ParserCompactEvents).value())
+    compaction = settings.get<double>(SettingsManager::Key::ParserCompactionTolerance).value();
+
+  sharedPath = parser::SharedEvents::path(snapshot.value(), compaction);
+  if (auto mapped = parser::SharedEvents::open(sharedPath)) {
+    std::lock_guard lock{sharing};
+    sharedEvents = std::move(mapped);
+    return;
+  }
+  sharedWriter.emplace(sharedPath);
+}
+
+void LoadWorker::finish(const QString &fileName, const std::optional<parser::ParseError> &parseError,
+                        unsigned long long milliseconds) {
+  // Dropped here, rather than by the next load, so a cancelled scenario does not linger in memory
+  if (cancellation.cancelled()) {
+    parser::trace::Scope trace{"LoadWorker::discard", "load"};
+    parser->reset();
+    logIndex.clear();
+    density.clear();
+    sharedWriter.reset();
+    return;
+  }
 
   if (parseError) {
-    emit error(QString::fromStdString(parseError.value().message), parseError.value().offset);
+    sharedWriter.reset();
+    emit error(currentLoad, QString::fromStdString(parseError.value().message), parseError.value().offset);
     return;
   }
 
-  emit fileLoaded(fileName, elapsed);
+  // Only mapped once complete, so the events loaded are not replaced part way through
+  if (sharedWriter) {
+    auto mapped = sharedWriter->finish() ? parser::SharedEvents::open(sharedPath) : nullptr;
+    sharedWriter.reset();
+    std::lock_guard lock{sharing};
+    sharedEvents = std::move(mapped);
+  }
+
+  emit fileLoaded(currentLoad, fileName, milliseconds);
+}
+
+void LoadWorker::load(const QString &fileName, unsigned int id, const parser::CancellationToken &token) {
+  std::lock_guard lock{running};
+  parser::trace::Scope trace{"LoadWorker::load", "load"};
+  if (!prepare(id, token))
+    return;
+
+  shareEvents(fileName);
+  QElapsedTimer timer;
+  timer.start();
+  if (takePreparsed(fileName)) {
+    finish(fileName, {}, static_cast<unsigned long long>(timer.elapsed()));
+    return;
+  }
+
+  auto parseError = parser->parse(fileName.toStdString().c_str());
+  finish(fileName, parseError, static_cast<unsigned long long>(timer.elapsed()));
+}
+
+bool LoadWorker::takePreparsed(const QString &fileName) {
+  std::lock_guard lock{preparing};
+  const auto taken = std::exchange(preparsed, std::nullopt);
+  preparsedBytes = 0u;
+  if (!taken || taken->fileName != fileName || QFileInfo{fileName}.lastModified() != taken->modified) {
+    // Only one scenario is held ahead, so it is not kept for later
+    ahead->reset();
+    return false;
+  }
+
+  parser::trace::Scope trace{"LoadWorker::takePreparsed", "load"};
+  // The previous scenario was dropped by `prepare()`
+  std::swap(parser, ahead);
+  parser->setCancellation(cancellation);
+  makeProgressive(*parser);
+
+  // Delivered just as the parser would, in one batch
+  emit sectionsLoaded(currentLoad);
+  deliver({parser->takeSceneEvents(), parser->takeChartsEvents(), parser->takeLogEvents(),
+           parser->getConfiguration().endTime, 1.0, std::chrono::steady_clock::now()});
+  return true;
+}
+
+void LoadWorker::dropPreparsed() {
+  std::lock_guard lock{preparing};
+  preparsed.reset();
+  preparsedBytes = 0u;
+  ahead->reset();
+}
+
+void LoadWorker::preparse(const QString &fileName, std::size_t budget, const parser::CancellationToken &token) {
+  std::lock_guard lock{preparing};
+  parser::trace::Scope trace{"LoadWorker::preparse", "load"};
+  preparsed.reset();
+  preparsedBytes = 0u;
+  ahead->reset();
+
+  const QFileInfo file{fileName};
+  if (token.cancelled() || !file.isFile() || static_cast<std::size_t>(file.size()) > budget) {
+    emit preparseFinished(fileName, false);
+    return;
+  }
+
+  ahead->setCancellation(token);
+  ahead->setProgressive({}, {});
+  applySettings(*ahead);
+  const auto modified = file.lastModified();
+  const auto parseError = ahead->parse(fileName.toStdString().c_str());
+
+  std::size_t bytes = 0u;
+  for (const auto &usage : ahead->memoryUsage())
+    bytes += usage.bytes;
+
+  if (parseError || token.cancelled() || bytes > budget) {
+    // A file which fails to parse is parsed again when it is loaded, so the error is reported then
+    ahead->reset();
+    emit preparseFinished(fileName, false);
+    return;
+  }
+
+  preparsed = Preparsed{fileName, modified};
+  preparsedBytes = bytes;
+  emit preparseFinished(fileName, true);
+}
+
+void LoadWorker::follow(const QString &fileName, unsigned int id, const parser::CancellationToken &token) {
+  std::lock_guard lock{running};
+  if (!prepare(id, token))
+    return;
+
+  dropPreparsed();
+  QElapsedTimer timer;
+  timer.start();
+  auto parseError = parser->follow(fileName.toStdString().c_str(), stopRequested);
+  finish(fileName, parseError, static_cast<unsigned long long>(timer.elapsed()));
+}
+
+void LoadWorker::listen(const QString &address, unsigned int id, const parser::CancellationToken &token) {
+  std::lock_guard lock{running};
+  if (!prepare(id, token))
+    return;
+
+  dropPreparsed();
+  QElapsedTimer timer;
+  timer.start();
+  auto parseError = parser->listen(address.toStdString().c_str(), stopRequested);
+  finish(address, parseError, static_cast<unsigned long long>(timer.elapsed()));
+}
+
+void LoadWorker::stopFollowing() {
+  stopRequested = true;
+}
+
+void LoadWorker::abandon() {
+  abandoned = true;
+  stopRequested = true;
+}
+
+void LoadWorker::cancel(parser::CancellationToken token) {
+  token.cancel();
+  // Only after the token, see `prepare()`
+  stopRequested = true;
 }
 
 parser::FileParser &LoadWorker::getParser() {
-  return parser;
+  return *parser;
+}
+
+const parser::LogIndex &LoadWorker::getLogIndex() const {
+  return logIndex;
+}
+
+const parser::EventDensity &LoadWorker::getEventDensity() const {
+  return density;
+}
+
+std::size_t LoadWorker::getPreparsedBytes() const {
+  return preparsedBytes;
+}
+
+std::shared_ptr<const parser::SharedEvents> LoadWorker::getSharedEvents() const {
+  std::lock_guard lock{sharing};
+  return sharedEvents;
+}
+
+std::size_t LoadWorker::getQueuedBatches() const {
+  return batches.size();
+}
+
+std::vector<parser::EventBatch> LoadWorker::takeEventBatches(unsigned int id) {
+  std::vector<parser::EventBatch> taken;
+  Batch batch;
+  while (batches.tryPop(batch)) {
+    if (batch.load == id)
+      taken.emplace_back(std::move(batch.events));
+  }
+
+  return taken;
 }
 
 } // namespace netsimulyzer
@@ -1,21 +1,365 @@
 #pragma once
 
+#include "../util/spsc-queue.h"
+#include <QDateTime>
 #include <QObject>
+#include <QString>
+#include <atomic>
+#include <cstddef>
+#include <event-density.h>
 #include <file-parser.h>
+#include <log-index.h>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <shared-events.h>
+#include <string>
+#include <task-pool.h>
+#include <vector>
 
 namespace netsimulyzer {
 
 class LoadWorker : public QObject {
   Q_OBJECT
-  parser::FileParser parser;
+  parser::FileParser first;
+  parser::FileParser second;
+
+  /**
+   * The parser of the scenario loaded, or being loaded
+   */
+  parser::FileParser *parser{&first};
+
+  /**
+   * The parser of the scenario parsed ahead, see `preparse()`.
+   * Swapped with `parser` when that scenario is loaded
+   */
+  parser::FileParser *ahead{&second};
+
+  /**
+   * A scenario parsed completely by `preparse()`, but not loaded yet
+   */
+  struct Preparsed {
+    QString fileName;
+
+    /**
+     * When the file was last modified as it was parsed,
+     * so a file written since is parsed again
+     */
+    QDateTime modified;
+  };
+
+  /**
+   * Held while a scenario is parsed ahead, or taken by a load.
+   * Guards `ahead` & `preparsed`
+   */
+  std::mutex preparing;
+  std::optional<Preparsed> preparsed;
+
+  /**
+   * The memory held by the scenario parsed ahead, 0 if there is none.
+   * See `getPreparsedBytes()`
+   */
+  std::atomic<std::size_t> preparsedBytes{0u};
+
+  /**
+   * A batch of events, with the load it came from
+   */
+  struct Batch {
+    unsigned int load{0u};
+    parser::EventBatch events;
+  };
+
+  /**
+   * Batches of events delivered by the parser,
+   * which have not been taken with `takeEventBatches()` yet.
+   *
+   * When the queue is full, the parser waits for batches to be taken,
+   * so a scenario is never loaded faster than the window takes it,
+   * and a streaming simulation is held back, see `listen()`
+   */
+  SpscQueue<Batch> batches{64u};
+
+  /**
+   * Held for the whole of a load, so a superseded load
+   * finishes with the parser before the next one begins
+   */
+  std::mutex running;
+
+  /**
+   * The load in progress, and its cancellation.
+   * Only used while `running` is held
+   */
+  unsigned int currentLoad{0u};
+  parser::CancellationToken cancellation;
+
+  /**
+   * Held while the shared events are replaced, or taken by `getSharedEvents()`.
+   * Guards `sharedEvents`
+   */
+  mutable std::mutex sharing;
+
+  /**
+   * The scene events of the scenario loaded, mapped from those written by another viewer,
+   * or by this one. Null if they are not shared
+   */
+  std::shared_ptr<const parser::SharedEvents> sharedEvents;
+
+  /**
+   * Writes the scene events as they are parsed, when no other viewer has shared them yet.
+   * Only used while `running` is held
+   */
+  std::optional<parser::SharedEventsWriter> sharedWriter;
+  std::string sharedPath;
+
+  /**
+   * Map the scene events of `fileName` if another viewer has shared them,
+   * or start sharing them as they are parsed. Does nothing unless enabled in the preferences
+   */
+  void shareEvents(const QString &fileName);
+
+  /**
+   * Index of the log events, built on the loading thread as each batch is parsed
+   */
+  parser::LogIndex logIndex;
+
+  /**
+   * Events per stretch of time, counted on the loading thread as each batch is parsed
+   */
+  parser::EventDensity density;
+
+  /**
+   * Set to stop following a file, see `stopFollowing()`
+   */
+  std::atomic<bool> stopRequested{false};
+
+  /**
+   * Set once batches will no longer be taken, see `abandon()`
+   */
+  std::atomic<bool> abandoned{false};
+
+  /**
+   * Begin a load, once the previous one has finished.
+   * Clears anything from the previous file, and applies the parser preferences
+   *
+   * @return
+   * False if the load was cancelled before it began
+   */
+  bool prepare(unsigned int id, const parser::CancellationToken &token);
+
+  /**
+   * Report the result of a load or follow.
+   * Nothing is reported for a cancelled load, and its partial scenario is dropped
+   *
+   * @param fileName
+   * The file loaded
+   *
+   * @param parseError
+   * The error from the parser, if any
+   *
+   * @param milliseconds
+   * The time taken to load the file
+   */
+  void finish(const QString &fileName, const std::optional<parser::ParseError> &parseError,
+              unsigned long long milliseconds);
+
+  /**
+   * Apply the compaction & cache preferences to `target`
+   */
+  static void applySettings(parser::FileParser &target);
+
+  /**
+   * Deliver the sections & events of `target` to the window as they are parsed
+   */
+  void makeProgressive(parser::FileParser &target);
+
+  /**
+   * Index, count, & queue one batch of events for the window.
+   * Waits while the queue is full
+   */
+  void deliver(parser::EventBatch &&batch);
+
+  /**
+   * Load the scenario parsed ahead, if it is `fileName`, and unchanged since.
+   * Otherwise the scenario parsed ahead is dropped
+   *
+   * @return
+   * True if the scenario parsed ahead was loaded
+   */
+  bool takePreparsed(const QString &fileName);
+
+  /**
+   * Drop the scenario parsed ahead, for a file which is followed or listened to instead
+   */
+  void dropPreparsed();
 
 public:
+  LoadWorker();
   [[nodiscard]] parser::FileParser &getParser();
-public slots:
-  void load(const QString &fileName);
+
+  /**
+   * @return
+   * The index of the log events loaded so far.
+   * Safe to search from any thread
+   */
+  [[nodiscard]] const parser::LogIndex &getLogIndex() const;
+
+  /**
+   * @return
+   * The density of the events loaded so far.
+   * Safe to snapshot from any thread
+   */
+  [[nodiscard]] const parser::EventDensity &getEventDensity() const;
+
+  /**
+   * @return
+   * The memory held by the scenario parsed ahead, see `preparse()`.
+   * 0 if there is none. Safe to call from any thread
+   */
+  [[nodiscard]] std::size_t getPreparsedBytes() const;
+
+  /**
+   * @return
+   * The batches of events waiting for `takeEventBatches()`.
+   * Safe to call from any thread
+   */
+  [[nodiscard]] std::size_t getQueuedBatches() const;
+
+  /**
+   * @return
+   * The scene events of the scenario loaded, shared with other viewers.
+   * Null if they are not shared, or not completely written yet.
+   * When set before the events are loaded, the batches delivered hold no scene events.
+   * Safe to call from any thread
+   */
+  [[nodiscard]] std::shared_ptr<const parser::SharedEvents> getSharedEvents() const;
+
+  /**
+   * Take every batch of events parsed since the last call.
+   * Only call from one thread
+   *
+   * @param id
+   * The load to take the batches of. Batches from any other load are dropped
+   *
+   * @return
+   * The batches, in file order
+   */
+  [[nodiscard]] std::vector<parser::EventBatch> takeEventBatches(unsigned int id);
+
+  /**
+   * Stop following the file given to `follow()`.
+   * The events loaded so far are kept.
+   * Safe to call from any thread
+   */
+  void stopFollowing();
+
+  /**
+   * Stop any load, dropping the batches which no longer fit,
+   * since `takeEventBatches()` will not be called again.
+   * For when the window is closed. Safe to call from any thread
+   */
+  void abandon();
+
+  /**
+   * Stop the load holding `token`, without reporting it,
+   * whether it is parsing, following, or listening.
+   * A superseding load may be started immediately, and waits for this one to stop.
+   * Safe to call from any thread
+   *
+   * @param token
+   * The token given to `load()`, `follow()`, or `listen()`
+   */
+  void cancel(parser::CancellationToken token);
+
+  /**
+   * Load a whole scenario. Call from a worker thread,
+   * any signals are emitted from it.
+   * If the scenario was parsed ahead by `preparse()`, it is not parsed again
+   *
+   * @param fileName
+   * The scenario to load
+   *
+   * @param id
+   * Identifies this load in the signals emitted for it
+   *
+   * @param token
+   * Stops the load, see `cancel()`
+   */
+  void load(const QString &fileName, unsigned int id, const parser::CancellationToken &token);
+
+  /**
+   * Parse a scenario completely, without loading it, so a later `load()` of it
+   * only hands the parsed scenario to the window. Any scenario parsed ahead before is dropped.
+   * Call from a worker thread, may run alongside a load
+   *
+   * @param fileName
+   * The scenario to parse
+   *
+   * @param budget
+   * The most memory, in bytes, the parsed scenario may hold.
+   * Scenarios over it, or files larger than it, are not kept
+   *
+   * @param token
+   * Stops the parse. The scenario is dropped
+   */
+  void preparse(const QString &fileName, std::size_t budget, const parser::CancellationToken &token);
+
+  /**
+   * Load a scenario which is still being written,
+   * loading the events appended to it in batches,
+   * until it is complete, or `stopFollowing()` is called.
+   * See `load()` for the other parameters
+   *
+   * @param fileName
+   * The scenario to follow
+   */
+  void follow(const QString &fileName, unsigned int id, const parser::CancellationToken &token);
+
+  /**
+   * Listen for a simulation streaming its scenario, see `parser::IngestSocket`,
+   * loading its events in batches as they arrive,
+   * until it is complete, or `stopFollowing()` is called.
+   * See `load()` for the other parameters
+   *
+   * @param address
+   * Where to listen, see `parser::IngestSocket::listen()`
+   */
+  void listen(const QString &address, unsigned int id, const parser::CancellationToken &token);
 signals:
-  void fileLoaded(const QString &fileName, unsigned long long milliseconds);
-  void error(const QString &message, unsigned long long offset);
+  /**
+   * Emitted once every section other than 'events' is loaded.
+   * The parser may be read until the connected slot returns,
+   * so this should be connected with `Qt::BlockingQueuedConnection`
+   *
+   * @param id
+   * The load the sections are from. Signals from a superseded load
+   * may still arrive after the next one begins, and should be ignored
+   */
+  void sectionsLoaded(unsigned int id);
+
+  /**
+   * Emitted after each batch of events is loaded.
+   * See `takeEventBatches()`
+   */
+  void eventsLoaded(unsigned int id);
+
+  /**
+   * Emitted with the path of each Node & Decoration model as it is parsed,
+   * before `sectionsLoaded()`. The same path may be emitted more than once
+   */
+  void modelFound(const QString &path);
+
+  /**
+   * Emitted once `preparse()` finishes
+   *
+   * @param fileName
+   * The scenario parsed
+   *
+   * @param kept
+   * False if the scenario was over the budget, failed to parse, or the parse was cancelled
+   */
+  void preparseFinished(const QString &fileName, bool kept);
+  void fileLoaded(unsigned int id, const QString &fileName, unsigned long long milliseconds);
+  void error(unsigned int id, const QString &message, unsigned long long offset);
 };
 
 } // namespace netsimulyzer
@@ -35,17 +35,36 @@
 #include "LoadWorker.h"
 #include "about/AboutDialog.h"
 #include "src/conversion.h"
+#include "src/util/metrics-report.h"
 #include "src/window/util/file-operations.h"
 #include <QAction>
+#include <QApplication>
 #include <QDockWidget>
 #include <QFileDialog>
+#include <QFileInfo>
+#include <QInputDialog>
+#include <QLineEdit>
 #include <QMessageBox>
 #include <QObject>
+#include <QStringList>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
 #include <cstdlib>
 #include <iostream>
+#include <iterator>
+#include <memory>
+#include <sstream>
+#include <string>
 #include <parser/file-parser.h>
 #include <parser/model.h>
+#include <parser/parse-cache.h>
+#include <parser/parse-filter.h>
+#include <parser/scene-hash.h>
+#include <parser/trace.h>
 #include <project.h>
+#include <utility>
 
 namespace {
 /**
@@ -70,32 +89,108 @@ MainWindow::MainWindow() : QMainWindow() {
   setWindowTitle(NETSIMULYZER_APPLICATION_NAME);
   setCentralWidget(&scene);
 
-  // Remember to add show/hide actions & adjust titles below
-  ui.nodesDock->setWidget(&nodeWidget);
-  ui.nodeDetailsDock->setWidget(&detailWidget);
-  ui.logDock->setWidget(&logWidget);
+  // Remember to add show/hide actions & adjust titles below.
+  // The Nodes, details, & log docks are given their widgets by `ensureNodeList()`, etc.
   ui.playbackDock->setWidget(&playbackWidget);
+  ui.memoryDock->setWidget(&memoryWidget);
 
   // Remove extra ampersands on macOS
   removeAmpersandDockWidget(*ui.nodesDock);
   removeAmpersandDockWidget(*ui.nodeDetailsDock);
   removeAmpersandDockWidget(*ui.logDock);
   removeAmpersandDockWidget(*ui.playbackDock);
+  removeAmpersandDockWidget(*ui.memoryDock);
 
+  if (!lightweight) {
+    ensureNodeList();
+    ensureDetails();
+    ensureLog();
+    ensureCharts();
+  }
+
+  // Hidden unless it was left open
+  ui.memoryDock->hide();
   auto state = settings.get<QByteArray>(SettingsManager::Key::MainWindowState);
   if (state)
     restoreState(*state, stateVersion);
 
-  loadWorker.moveToThread(&loadThread);
-  QObject::connect(this, &MainWindow::startLoading, &loadWorker, &LoadWorker::load);
-  QObject::connect(&loadWorker, &LoadWorker::fileLoaded, this, &MainWindow::finishLoading);
-  QObject::connect(&loadWorker, &LoadWorker::error, this, &MainWindow::errorLoading);
-  loadThread.start();
+  if (lightweight) {
+    // Created the first time their docks are shown, or their menus are used
+    QObject::connect(ui.nodesDock, &QDockWidget::visibilityChanged, this, [this](bool visible) {
+      if (visible)
+        ensureNodeList();
+    });
+    QObject::connect(ui.nodeDetailsDock, &QDockWidget::visibilityChanged, this, [this](bool visible) {
+      if (visible)
+        ensureDetails();
+    });
+    QObject::connect(ui.logDock, &QDockWidget::visibilityChanged, this, [this](bool visible) {
+      if (visible)
+        ensureLog();
+    });
+  }
+
+  // The worker stays on this thread, so its signals are queued from the pool
+  QObject::connect(this, &MainWindow::startLoading, [this](const QString &fileName) {
+    // A scenario still being parsed ahead is finished, rather than parsed again.
+    // If it has not started, it is run by the load itself
+    parser::TaskPool::Handle ahead;
+    if (fileName == preparsedFile) {
+      ahead = std::exchange(preparseTask, {});
+      preparsedFile.clear();
+    }
+
+    submitLoad([this, fileName, id = currentLoad, token = loadToken, ahead]() mutable {
+      ahead.wait();
+      loadWorker.load(fileName, id, token);
+    });
+  });
+  QObject::connect(this, &MainWindow::startFollowing, [this](const QString &fileName) {
+    submitLoad([this, fileName, id = currentLoad, token = loadToken]() {
+      loadWorker.follow(fileName, id, token);
+    });
+  });
+  QObject::connect(this, &MainWindow::startListening, [this](const QString &address) {
+    submitLoad([this, address, id = currentLoad, token = loadToken]() {
+      loadWorker.listen(address, id, token);
+    });
+  });
+
+  // Signals from a superseded or cancelled load may still be queued, and are dropped.
+  // The parser waits for the sections to be added, so they may be read from the parser directly
+  QObject::connect(
+      &loadWorker, &LoadWorker::sectionsLoaded, this,
+      [this](unsigned int id) {
+        if (id == currentLoad)
+          loadSections();
+      },
+      Qt::BlockingQueuedConnection);
+  QObject::connect(&loadWorker, &LoadWorker::eventsLoaded, this, [this](unsigned int id) {
+    if (id == currentLoad)
+      loadEvents();
+  });
+  // Models are built in the background while the rest of the file is parsed
+  QObject::connect(&loadWorker, &LoadWorker::modelFound, &scene, &SceneWidget::prefetchModel);
+  QObject::connect(&loadWorker, &LoadWorker::preparseFinished, this, [this](const QString &fileName, bool kept) {
+    if (kept && !loading)
+      ui.statusbar->showMessage("Parsed the next scenario in the playlist: " + fileName, 10000);
+  });
+  QObject::connect(&loadWorker, &LoadWorker::fileLoaded, this,
+                   [this](unsigned int id, const QString &fileName, unsigned long long milliseconds) {
+                     if (id == currentLoad)
+                       finishLoading(fileName, milliseconds);
+                   });
+  QObject::connect(&loadWorker, &LoadWorker::error, this,
+                   [this](unsigned int id, const QString &message, unsigned long long offset) {
+                     if (id == currentLoad)
+                       errorLoading(message, offset);
+                   });
 
   ui.menuWindow->addAction(ui.nodesDock->toggleViewAction());
   ui.menuWindow->addAction(ui.logDock->toggleViewAction());
   ui.menuWindow->addAction(ui.playbackDock->toggleViewAction());
   ui.menuWindow->addAction(ui.nodeDetailsDock->toggleViewAction());
+  ui.menuWindow->addAction(ui.memoryDock->toggleViewAction());
 
   // For somewhat permanent messages (a message with no timeout)
   // We need to use a widget in the status bar.
@@ -103,13 +198,99 @@ MainWindow::MainWindow() : QMainWindow() {
   // should we choose to do so
   ui.statusbar->insertWidget(0, &statusLabel);
 
-  QObject::connect(&scene, &SceneWidget::timeChanged, this, &MainWindow::timeChanged);
-  QObject::connect(&scene, &SceneWidget::timeChanged, &charts, &ChartManager::timeChanged);
-  QObject::connect(&scene, &SceneWidget::timeChanged, &logWidget, &ScenarioLogWidget::timeChanged);
+  // The scene follows every change of the time, the charts, log & text showing it are held back,
+  // see `forwardTime()` & `timeChanged()`
+  QObject::connect(&scene, &SceneWidget::timeChanged,
+                   [this](parser::nanoseconds time, parser::nanoseconds /* increment */) {
+                     forwardTime(time);
+                   });
   QObject::connect(&scene, &SceneWidget::timeChanged,
                    [this](parser::nanoseconds time, parser::nanoseconds /* increment */) {
                      playbackWidget.setTime(time);
                    });
+  QObject::connect(&scene, &SceneWidget::timeChanged, this, &MainWindow::timeChanged);
+
+  timeDisplayTimer.setSingleShot(true);
+  const auto setTimeDisplayRate = [this]() {
+    // 0 shows every change
+    const auto rate = settings.get<int>(SettingsManager::Key::TimeDisplayRate).value();
+    timeDisplayTimer.setInterval(rate > 0 ? std::max(1, 1000 / rate) : 0);
+  };
+  setTimeDisplayRate();
+  QObject::connect(&SettingsManager::notifier(), &SettingsNotifier::changed, this, [setTimeDisplayRate](int key) {
+    if (static_cast<SettingsManager::Key>(key) == SettingsManager::Key::TimeDisplayRate)
+      setTimeDisplayRate();
+  });
+
+  uiUpdateTimer.setSingleShot(true);
+  const auto setUiUpdateRate = [this]() {
+    // 0 applies every change
+    const auto rate = settings.get<int>(SettingsManager::Key::UiUpdateRate).value();
+    uiUpdateTimer.setInterval(rate > 0 ? std::max(1, 1000 / rate) : 0);
+  };
+  setUiUpdateRate();
+  QObject::connect(&SettingsManager::notifier(), &SettingsNotifier::changed, this, [setUiUpdateRate](int key) {
+    if (static_cast<SettingsManager::Key>(key) == SettingsManager::Key::UiUpdateRate)
+      setUiUpdateRate();
+  });
+
+  chartUpdateTimer.setSingleShot(true);
+  const auto setChartRefreshRate = [this]() {
+    // 0 applies every change
+    const auto rate = settings.get<int>(SettingsManager::Key::ChartRefreshRate).value();
+    chartUpdateTimer.setInterval(rate > 0 ? std::max(1, 1000 / rate) : 0);
+  };
+  setChartRefreshRate();
+  QObject::connect(&SettingsManager::notifier(), &SettingsNotifier::changed, this, [setChartRefreshRate](int key) {
+    if (static_cast<SettingsManager::Key>(key) == SettingsManager::Key::ChartRefreshRate)
+      setChartRefreshRate();
+  });
+
+  QObject::connect(&chartUpdateTimer, &QTimer::timeout, [this]() {
+    if (!chartUpdatePending)
+      return;
+
+    // Hold back the next change for another interval
+    chartUpdatePending = false;
+    updateCharts();
+    chartUpdateTimer.start();
+  });
+  QObject::connect(&scene, &SceneWidget::paused, this, &MainWindow::flushCharts);
+  QObject::connect(&scene, &SceneWidget::seeked, this, &MainWindow::flushCharts);
+
+  QObject::connect(&uiUpdateTimer, &QTimer::timeout, [this]() {
+    if (!uiUpdatePending)
+      return;
+
+    // Hold back the next change for another interval
+    uiUpdatePending = false;
+    updateUi();
+    uiUpdateTimer.start();
+  });
+
+  QObject::connect(&timeDisplayTimer, &QTimer::timeout, [this]() {
+    if (!timeDisplayPending)
+      return;
+
+    // Hold back the next change for another interval
+    timeDisplayPending = false;
+    showTime();
+    timeDisplayTimer.start();
+  });
+
+  // Refreshed live, including during playback,
+  // but only collected while someone is looking at it
+  memoryTimer.setInterval(1000);
+  QObject::connect(&memoryTimer, &QTimer::timeout, this, &MainWindow::reportMemory);
+  metricsTimer.setInterval(1000);
+  QObject::connect(&metricsTimer, &QTimer::timeout, this, &MainWindow::collectMetrics);
+  QObject::connect(ui.memoryDock, &QDockWidget::visibilityChanged, [this](bool visible) {
+    if (visible) {
+      reportMemory();
+      memoryTimer.start();
+    } else if (memoryPrintInterval == 0)
+      memoryTimer.stop();
+  });
 
   QObject::connect(ui.actionPlayPause, &QAction::triggered, [this]() {
     if (playbackWidget.isPlaying()) {
@@ -128,25 +309,62 @@ MainWindow::MainWindow() : QMainWindow() {
   QObject::connect(&playbackWidget, &PlaybackWidget::timeStepChanged, &scene, &SceneWidget::setTimeStep);
 
   QObject::connect(&playbackWidget, &PlaybackWidget::timeSet, &scene, &SceneWidget::setTime);
+  QObject::connect(&playbackWidget, &PlaybackWidget::timePreviewed, &scene, &SceneWidget::previewTime);
 
   QObject::connect(&scene, &SceneWidget::paused, &playbackWidget, &PlaybackWidget::setPaused);
-  QObject::connect(&scene, &SceneWidget::playing, &playbackWidget, &PlaybackWidget::setPlaying);
+  QObject::connect(&scene, &SceneWidget::playbackBehind, &playbackWidget, &PlaybackWidget::setBehind);
+  QObject::connect(&scene, &SceneWidget::idleSkipped, &playbackWidget, &PlaybackWidget::showSkipped);
 
-  QObject::connect(&nodeWidget, &NodeWidget::nodeSelected, &scene, &SceneWidget::focusNode);
+  // Skipping idle time stops at the next chart value or log message too
+  scene.setIdleLookup([this]() -> std::optional<parser::nanoseconds> {
+    const auto chart = charts ? charts->nextEventTime() : std::nullopt;
+    const auto log = logWidget ? logWidget->nextEventTime() : std::nullopt;
+    if (chart && log)
+      return std::min(chart.value(), log.value());
 
-  QObject::connect(&nodeWidget, &NodeWidget::nodeSelected, [this](uint32_t id) {
-    detailWidget.describe(scene.getNode(id));
-    scene.setSelectedNode(id);
+    return chart ? chart : log;
   });
+  QObject::connect(&scene, &SceneWidget::playing, &playbackWidget, &PlaybackWidget::setPlaying);
 
   QObject::connect(&scene, &SceneWidget::nodeSelected, [this](unsigned int nodeID) {
-    detailWidget.describe(scene.getNode(nodeID));
+    describeNode(nodeID);
     // Scene already has the selected Node ID set
   });
 
-  QObject::connect(&scene, &SceneWidget::selectedItemUpdated, &detailWidget, &DetailWidget::describedItemUpdated);
-
   QObject::connect(ui.actionLoad, &QAction::triggered, this, &MainWindow::load);
+  QObject::connect(ui.actionOpenSession, &QAction::triggered, this, &MainWindow::openSession);
+  QObject::connect(ui.actionSaveSession, &QAction::triggered, this, &MainWindow::saveSession);
+  QObject::connect(ui.actionCompare, &QAction::triggered, this, &MainWindow::compare);
+  QObject::connect(ui.actionReload, &QAction::triggered, this, &MainWindow::reload);
+  QObject::connect(ui.actionLoadPlaylist, &QAction::triggered, this, &MainWindow::loadPlaylist);
+  QObject::connect(ui.actionNextInPlaylist, &QAction::triggered, this, &MainWindow::nextInPlaylist);
+  QObject::connect(ui.actionFollow, &QAction::triggered, this, &MainWindow::follow);
+  QObject::connect(ui.actionListen, &QAction::triggered, this, &MainWindow::listen);
+  QObject::connect(ui.actionStopFollowing, &QAction::triggered, [this]() {
+    loadWorker.stopFollowing();
+  });
+  QObject::connect(ui.actionCancelLoading, &QAction::triggered, this, &MainWindow::cancelLoading);
+  QObject::connect(ui.actionServe, &QAction::triggered, this, &MainWindow::serveView);
+  QObject::connect(ui.actionStopServing, &QAction::triggered, [this]() {
+    scene.stopServing();
+    ui.actionStopServing->setEnabled(false);
+    ui.statusbar->showMessage("Stopped serving the view", 10000);
+  });
+  QObject::connect(&scene, &SceneWidget::clientConnected, [this]() {
+    ui.statusbar->showMessage("Remote client connected", 10000);
+  });
+  QObject::connect(&scene, &SceneWidget::clientDisconnected, [this]() {
+    ui.statusbar->showMessage("Remote client disconnected", 10000);
+  });
+  QObject::connect(&scene, &SceneWidget::wallLeaderConnected, []() {
+    std::clog << "Video wall leader connected\n";
+  });
+  QObject::connect(&scene, &SceneWidget::wallLeaderDisconnected, []() {
+    std::clog << "Video wall leader disconnected\n";
+  });
+  QObject::connect(&scene, &SceneWidget::wallNodeLost, [this](const QString &address) {
+    ui.statusbar->showMessage("Lost the video wall node at: " + address, 10000);
+  });
 
   QObject::connect(ui.actionPreviewModel, &QAction::triggered, [this]() {
     scene.previewModel(getModelFile(this));
@@ -207,7 +425,8 @@ MainWindow::MainWindow() : QMainWindow() {
   });
 
   QObject::connect(&settingsDialog, &SettingsDialog::chartSortOrderChanged, [this](int value) {
-    charts.setSortOrder(SettingsManager::ChartDropdownSortOrderFromInt(value));
+    if (charts)
+      charts->setSortOrder(SettingsManager::ChartDropdownSortOrderFromInt(value));
   });
 
   QObject::connect(&settingsDialog, &SettingsDialog::renderSkyboxChanged, [this](bool enable) {
@@ -237,9 +456,213 @@ MainWindow::MainWindow() : QMainWindow() {
   });
 
   QObject::connect(&settingsDialog, &SettingsDialog::resourcePathChanged, &scene, &SceneWidget::setResourcePath);
+  QObject::connect(&settingsDialog, &SettingsDialog::performanceProbeRequested, &scene,
+                   &SceneWidget::probePerformance);
+
+  QObject::connect(&scene, &SceneWidget::performancePresetApplied, [this](const QString &description) {
+    using Key = SettingsManager::Key;
+    // The actions apply their settings to the scene when toggled
+    ui.actionDynamicResolution->setChecked(settings.get<bool>(Key::RenderDynamicResolution).value());
+    ui.actionAdaptiveQuality->setChecked(settings.get<bool>(Key::RenderAdaptiveQuality).value());
+
+    scene.setAdaptiveScale(settings.get<float>(Key::RenderAdaptiveScale).value());
+    scene.setSkyboxRenderState(settings.get<bool>(Key::RenderSkybox).value());
+    scene.setBuildingRenderOutlines(settings.get<bool>(Key::RenderBuildingOutlines).value());
+    scene.setRenderLabels(settings.get<SettingsManager::LabelRenderMode>(Key::RenderLabels).value());
+    settingsDialog.loadSettings();
+
+    // Samples & trail lengths are only read at startup
+    const auto message = "Graphics preset " + description + ". Some settings take effect after a restart";
+    if (settingsDialog.isVisible())
+      QMessageBox::information(&settingsDialog, "Performance Preset", message);
+    else
+      ui.statusbar->showMessage(message, 10000);
+  });
 
   QObject::connect(ui.actionResetCameraPosition, &QAction::triggered, &scene, &SceneWidget::resetCamera);
 
+  ui.actionCpuPicking->setChecked(settings.get<bool>(SettingsManager::Key::RenderCpuPicking).value());
+  QObject::connect(ui.actionCpuPicking, &QAction::toggled, [this](bool enable) {
+    settings.set(SettingsManager::Key::RenderCpuPicking, enable);
+    scene.setCpuPicking(enable);
+  });
+
+  ui.actionDynamicResolution->setChecked(
+      settings.get<bool>(SettingsManager::Key::RenderDynamicResolution).value());
+  QObject::connect(ui.actionDynamicResolution, &QAction::toggled, [this](bool enable) {
+    settings.set(SettingsManager::Key::RenderDynamicResolution, enable);
+    scene.setDynamicResolution(enable);
+  });
+
+  ui.actionAdaptiveQuality->setChecked(settings.get<bool>(SettingsManager::Key::RenderAdaptiveQuality).value());
+  QObject::connect(ui.actionAdaptiveQuality, &QAction::toggled, [this](bool enable) {
+    settings.set(SettingsManager::Key::RenderAdaptiveQuality, enable);
+    scene.setAdaptiveQuality(enable);
+  });
+
+  ui.actionInterpolateMotion->setChecked(settings.get<bool>(SettingsManager::Key::PlaybackInterpolateMotion).value());
+  QObject::connect(ui.actionInterpolateMotion, &QAction::toggled, [this](bool enable) {
+    settings.set(SettingsManager::Key::PlaybackInterpolateMotion, enable);
+    scene.setInterpolateMotion(enable);
+  });
+
+  ui.actionSkipIdle->setChecked(settings.get<bool>(SettingsManager::Key::PlaybackSkipIdle).value());
+  QObject::connect(ui.actionSkipIdle, &QAction::toggled, [this](bool enable) {
+    settings.set(SettingsManager::Key::PlaybackSkipIdle, enable);
+    scene.setSkipIdle(enable);
+  });
+
+  QObject::connect(ui.actionReversePlayback, &QAction::toggled, &scene, &SceneWidget::setReverse);
+
+  ui.actionSplitView->setChecked(settings.get<bool>(SettingsManager::Key::RenderSplitView).value());
+  QObject::connect(ui.actionSplitView, &QAction::toggled, [this](bool enable) {
+    settings.set(SettingsManager::Key::RenderSplitView, enable);
+    scene.setSplitView(enable);
+  });
+
+  ui.actionClusterNodes->setChecked(settings.get<bool>(SettingsManager::Key::RenderClusters).value());
+  QObject::connect(ui.actionClusterNodes, &QAction::toggled, [this](bool enable) {
+    settings.set(SettingsManager::Key::RenderClusters, enable);
+    scene.setRenderClusters(enable);
+  });
+
+  ui.actionHeatmap->setChecked(settings.get<bool>(SettingsManager::Key::RenderHeatmap).value());
+  QObject::connect(ui.actionHeatmap, &QAction::toggled, [this](bool enable) {
+    settings.set(SettingsManager::Key::RenderHeatmap, enable);
+    scene.setRenderHeatmap(enable);
+  });
+
+  ui.actionMinimap->setChecked(settings.get<bool>(SettingsManager::Key::RenderMinimap).value());
+  QObject::connect(ui.actionMinimap, &QAction::toggled, [this](bool enable) {
+    settings.set(SettingsManager::Key::RenderMinimap, enable);
+    scene.setRenderMinimap(enable);
+  });
+
+  QObject::connect(ui.actionShowProfiler, &QAction::toggled, &scene, &SceneWidget::setProfilerEnabled);
+
+  QObject::connect(ui.actionExportProfile, &QAction::triggered, [this]() {
+    const auto fileName = QFileDialog::getSaveFileName(this, "Export Frame Profile", "", "CSV Files (*.csv)");
+    if (fileName.isEmpty())
+      return;
+
+    if (!scene.exportProfile(fileName))
+      QMessageBox::critical(this, "Export Failed", "Failed to write the frame profile to: " + fileName);
+  });
+
+  QObject::connect(ui.actionExportFrames, &QAction::triggered, [this]() {
+    if (scene.isExporting()) {
+      scene.stopExport();
+      return;
+    }
+
+    const auto directory = QFileDialog::getExistingDirectory(this, "Export Frames To");
+    if (directory.isEmpty())
+      return;
+
+    const QStringList sizes{"1280x720", "1920x1080", "2560x1440", "3840x2160"};
+    bool accepted = false;
+    const auto size = QInputDialog::getItem(this, "Export Frames", "Frame size:", sizes, 1, false, &accepted);
+    if (!accepted)
+      return;
+
+    const auto dimensions = size.split('x');
+    ui.actionExportFrames->setText("Stop &Export");
+    scene.startExport(directory, dimensions[0].toInt(), dimensions[1].toInt());
+  });
+
+  QObject::connect(ui.actionRecordCameraPath, &QAction::toggled, [this](bool checked) {
+    if (checked) {
+      scene.startRecordingPath();
+      return;
+    }
+
+    const auto path = scene.stopRecordingPath();
+    if (path.empty())
+      return;
+
+    const auto fileName = QFileDialog::getSaveFileName(this, "Save Camera Path", "", "CSV Files (*.csv)");
+    if (fileName.isEmpty())
+      return;
+
+    if (!path.save(fileName))
+      QMessageBox::critical(this, "Save Failed", "Failed to write the camera path to: " + fileName);
+  });
+
+  QObject::connect(ui.actionReplayCameraPath, &QAction::triggered, [this]() {
+    if (scene.isReplaying())
+      return;
+
+    const auto fileName = QFileDialog::getOpenFileName(this, "Replay Camera Path", "", "CSV Files (*.csv)");
+    if (fileName.isEmpty())
+      return;
+
+    auto path = CameraPath::read(fileName);
+    if (!path) {
+      QMessageBox::critical(this, "Replay Failed", "Failed to read a camera path from: " + fileName);
+      return;
+    }
+
+    bool accepted = false;
+    const auto frames = QInputDialog::getInt(this, "Replay Camera Path", "Frames to draw:", 300, 1,
+                                             static_cast<int>(FrameProfiler::maxTimedFrames), 1, &accepted);
+    if (!accepted)
+      return;
+
+    scene.startReplay(std::move(path.value()), static_cast<std::size_t>(frames));
+  });
+
+  QObject::connect(&scene, &SceneWidget::replayFinished, [this](const FrameProfiler::FrameTimes &times) {
+    const auto format = [](const FrameProfiler::Percentiles &percentiles) {
+      return QString{"p50: %1 ms, p95: %2 ms, p99: %3 ms"}
+          .arg(percentiles.p50, 0, 'f', 3)
+          .arg(percentiles.p95, 0, 'f', 3)
+          .arg(percentiles.p99, 0, 'f', 3);
+    };
+
+    auto text = QString{"Frames: %1\nCPU %2\n"}.arg(times.frames).arg(format(times.cpu));
+    if (times.gpu)
+      text += "GPU " + format(times.gpu.value());
+    else
+      text += "GPU timings unavailable";
+
+    std::clog << "Camera path replay\n" << text.toStdString() << '\n';
+    QMessageBox::information(this, "Replay Finished", text);
+  });
+
+  QObject::connect(ui.actionLoadReport, &QAction::triggered, [this]() {
+    std::ostringstream text;
+    loadReport.write(text);
+    QMessageBox::information(this, "Load Report", QString::fromStdString(text.str()));
+  });
+
+  QObject::connect(&scene, &SceneWidget::exportFinished, [this](const QString &directory, unsigned long long frames) {
+    if (headless) {
+      std::clog << "Exported " << frames - exportFailures << " of " << frames
+                << " frames to: " << directory.toStdString() << '\n';
+      QApplication::exit(exportFailures > 0u ? 1 : 0);
+      return;
+    }
+
+    ui.actionExportFrames->setText("&Export Frames...");
+    ui.statusbar->showMessage(QString{"Exported %1 frames to: %2"}.arg(frames).arg(directory), 10000);
+  });
+
+  QObject::connect(&scene, &SceneWidget::exportFailed, [this](const QString &fileName) {
+    if (headless) {
+      std::cerr << "Failed to write frame: " << fileName.toStdString() << '\n';
+      exportFailures++;
+      return;
+    }
+
+    ui.statusbar->showMessage("Failed to write frame: " + fileName, 10000);
+  });
+
+  QObject::connect(&scene, &SceneWidget::captureFinished, [](const QString &directory, int shots, int failures) {
+    std::clog << "Captured " << shots - failures << " of " << shots << " shots to: " << directory.toStdString()
+              << '\n';
+    QApplication::exit(failures > 0 ? 1 : 0);
+  });
+
   QObject::connect(ui.actionAbout, &QAction::triggered, [this]() {
     scene.pause();
     AboutDialog dialog{this};
@@ -247,44 +670,478 @@ MainWindow::MainWindow() : QMainWindow() {
   });
 
   QObject::connect(ui.actionAddChart, &QAction::triggered, [this]() {
-    charts.spawnWidget(this);
+    ensureCharts().spawnWidget(this);
   });
 
-  QObject::connect(ui.actionRemovCharts, &QAction::triggered, &charts, &ChartManager::clearWidgets);
+  QObject::connect(ui.actionRemovCharts, &QAction::triggered, [this]() {
+    if (charts)
+      charts->clearWidgets();
+  });
+  QObject::connect(ui.actionChartTraffic, &QAction::triggered, this, &MainWindow::chartTraffic);
 }
 
 MainWindow::~MainWindow() {
-  loadThread.quit();
-  // Make sure the thread has time to close before trying to destroy it
-  loadThread.wait();
+  // A followed file may never be finished,
+  // and batches are no longer taken
+  loadWorker.abandon();
+  loadWorker.cancel(loadToken);
+  preparseToken.cancel();
+  // Make sure every load, including superseded ones still stopping,
+  // has finished before the worker is destroyed
+  for (auto &task : loadTasks)
+    task.wait();
 }
 
 void MainWindow::timeChanged(parser::nanoseconds time, parser::nanoseconds /* increment */) {
-  statusLabel.setText(toDisplayTime(time, SettingsManager::TimeUnit::Nanoseconds));
+  pendingTime = time;
+  if (timeDisplayTimer.isActive()) {
+    timeDisplayPending = true;
+    return;
+  }
+
+  showTime();
+  if (timeDisplayTimer.interval() > 0)
+    timeDisplayTimer.start();
 }
 
-void MainWindow::load() {
-  auto fileName = getScenarioFile(this);
+void MainWindow::forwardTime(parser::nanoseconds time) {
+  forwardChartTime(time);
 
-  if (fileName.isEmpty())
+  pendingUiTime = time;
+  if (uiUpdateTimer.isActive()) {
+    uiUpdatePending = true;
     return;
-  if (loading) {
-    ui.statusbar->showMessage("Already loading scenario!", 10000);
+  }
+
+  updateUi();
+  if (uiUpdateTimer.interval() > 0)
+    uiUpdateTimer.start();
+}
+
+void MainWindow::updateUi() {
+  // The widgets only look at the direction of the change
+  const auto increment = pendingUiTime - uiTime;
+  uiTime = pendingUiTime;
+  if (logWidget)
+    logWidget->timeChanged(uiTime, increment);
+  if (detailWidget)
+    detailWidget->timeChanged(uiTime);
+}
+
+void MainWindow::forwardChartTime(parser::nanoseconds time) {
+  pendingChartTime = time;
+  if (chartUpdateTimer.isActive()) {
+    chartUpdatePending = true;
     return;
   }
+
+  updateCharts();
+  if (chartUpdateTimer.interval() > 0)
+    chartUpdateTimer.start();
+}
+
+void MainWindow::updateCharts() {
+  // The charts only look at the direction of the change
+  const auto increment = pendingChartTime - chartTime;
+  chartTime = pendingChartTime;
+  if (charts)
+    charts->timeChanged(chartTime, increment);
+}
+
+void MainWindow::flushCharts() {
+  chartUpdateTimer.stop();
+  if (!chartUpdatePending)
+    return;
+
+  chartUpdatePending = false;
+  updateCharts();
+}
+
+void MainWindow::resetUiTime() {
+  uiUpdateTimer.stop();
+  uiUpdatePending = false;
+  uiTime = 0LL;
+  pendingUiTime = 0LL;
+
+  chartUpdateTimer.stop();
+  chartUpdatePending = false;
+  chartTime = 0LL;
+  pendingChartTime = 0LL;
+}
+
+void MainWindow::setMemoryReportInterval(int seconds) {
+  memoryPrintInterval = std::max(0, seconds);
+  memoryPrintCountdown = 0;
+
+  if (memoryPrintInterval > 0)
+    memoryTimer.start();
+  else if (!ui.memoryDock->isVisible())
+    memoryTimer.stop();
+}
+
+void MainWindow::reportMemory() {
+  const auto print = memoryPrintInterval > 0 && --memoryPrintCountdown <= 0;
+  if (!print && !ui.memoryDock->isVisible())
+    return;
+
+  const auto report = collectMemory();
+  if (ui.memoryDock->isVisible())
+    memoryWidget.setReport(report);
+
+  if (print) {
+    memoryPrintCountdown = memoryPrintInterval;
+    report.write(std::cout);
+    std::cout << std::flush;
+  }
+}
+
+MemoryReport MainWindow::collectMemory() {
+  MemoryReport report;
+  // The parser is written by the pool until the file is loaded, or a cancelled load is dropped
+  const auto parserIdle = std::all_of(loadTasks.begin(), loadTasks.end(), [](const parser::TaskPool::Handle &task) {
+    return task.done();
+  });
+  if (!loading && parserIdle) {
+    for (const auto &usage : loadWorker.getParser().memoryUsage())
+      report.add("Parser", usage.name, usage.bytes);
+  }
+  if (const auto preparsed = loadWorker.getPreparsedBytes(); preparsed > 0u)
+    report.add("Parser", "Parsed ahead", preparsed);
+  scene.reportMemory(report);
+  // Until they are created, only the events held for them
+  if (charts)
+    charts->reportMemory(report);
+  else
+    report.add("Charts", "Events", containerBytes(pendingChartEvents));
+  if (logWidget)
+    logWidget->reportMemory(report);
+  else
+    report.add("Log", "Events", containerBytes(pendingLogEvents));
+
+  return report;
+}
+
+std::optional<QString> MainWindow::serveMetrics(const QString &address) {
+  if (auto error = metricsServer.listen(address))
+    return error;
+
+  // Published before the first request may arrive
+  collectMetrics();
+  metricsTimer.start();
+  return {};
+}
+
+void MainWindow::setMetricsLogInterval(int seconds) {
+  metricsPrintInterval = std::max(0, seconds);
+  metricsPrintCountdown = metricsPrintInterval;
+
+  if (metricsPrintInterval > 0)
+    metricsTimer.start();
+  else if (!metricsServer.isListening())
+    metricsTimer.stop();
+}
+
+void MainWindow::collectMetrics() {
+  using Type = MetricsReport::Type;
+  MetricsReport report;
+
+  // Rates over the time since the last collection
+  const auto counters = scene.takeFrameCounters();
+  const auto seconds = metricsInterval.isValid() ? static_cast<double>(metricsInterval.nsecsElapsed()) / 1e9 : 0.0;
+  metricsInterval.start();
+  const auto perSecond = [seconds](std::uint64_t count) {
+    return seconds > 0.0 ? static_cast<double>(count) / seconds : 0.0;
+  };
+  const auto toSeconds = [](std::chrono::nanoseconds time) {
+    return std::chrono::duration<double>{time}.count();
+  };
+
+  report.add("frames_total", "Frames drawn", Type::Counter, static_cast<double>(counters.frames));
+  report.add("frame_seconds_total", "CPU time spent drawing frames", Type::Counter, toSeconds(counters.frameTime));
+  report.add("frame_seconds_max", "The longest frame since the last collection", Type::Gauge,
+             toSeconds(counters.longestFrame));
+  report.add("frames_per_second", "Frames drawn per second since the last collection", Type::Gauge,
+             perSecond(counters.frames - lastFrameCounters.frames));
+  report.add("events_applied_total", "Scene events applied, or undone by seeking backwards", Type::Counter,
+             static_cast<double>(counters.eventsApplied));
+  report.add("events_applied_per_second", "Scene events applied per second since the last collection",
+             Type::Gauge, perSecond(counters.eventsApplied - lastFrameCounters.eventsApplied));
+  lastFrameCounters = counters;
+
+  report.add("loading", "1 while a scenario is loading, followed, or streamed", Type::Gauge, loading ? 1.0 : 0.0);
+  report.add("load_progress", "The fraction of the scenario loaded, from 0 to 1", Type::Gauge, loadProgress);
+  report.add("ingest_queued_batches", "Batches of events parsed, but not yet added", Type::Gauge,
+             static_cast<double>(loadWorker.getQueuedBatches()));
+  report.add("ingest_latency_seconds", "From the latest batch streamed being parsed, until it was added",
+             Type::Gauge, streaming ? std::chrono::duration<double>{ingestLatency}.count() : 0.0);
+
+  for (const auto &entry : collectMemory().getEntries()) {
+    std::string kind{"host"};
+    if (entry.kind == MemoryReport::Kind::Gpu)
+      kind = "gpu";
+    else if (entry.kind == MemoryReport::Kind::Disk)
+      kind = "disk";
+
+    report.add("memory_bytes", "Memory held by each part of the viewer, see the Memory dock", Type::Gauge,
+               static_cast<double>(entry.bytes),
+               {{"subsystem", entry.subsystem}, {"name", entry.name}, {"kind", std::move(kind)}});
+  }
+
+  if (metricsServer.isListening()) {
+    std::ostringstream text;
+    report.writePrometheus(text);
+    metricsServer.publish(text.str());
+  }
+
+  if (metricsPrintInterval > 0 && --metricsPrintCountdown <= 0) {
+    metricsPrintCountdown = metricsPrintInterval;
+    const auto now = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch());
+    report.writeJson(std::cout, static_cast<long long>(now.count()));
+    std::cout << std::flush;
+  }
+}
+
+void MainWindow::showTime() {
+  statusLabel.setText(toDisplayTime(pendingTime, SettingsManager::TimeUnit::Nanoseconds));
+  playbackWidget.showTime();
+}
+
+void MainWindow::submitLoad(std::function<void()> work) {
+  loadTasks.erase(std::remove_if(loadTasks.begin(), loadTasks.end(),
+                                 [](const parser::TaskPool::Handle &task) {
+                                   return task.done();
+                                 }),
+                  loadTasks.end());
+
+  loadTasks.emplace_back(
+      parser::TaskPool::shared().submit(std::move(work), parser::TaskPool::Priority::Normal, loadToken));
+}
+
+void MainWindow::beginLoading(const QString &source, bool reload) {
+  // Superseded immediately, the worker drops its partial scenario on the pool,
+  // then begins this load
+  if (loading)
+    loadWorker.cancel(loadToken);
+  loadToken = {};
+  currentLoad++;
+
+  // Only one scenario is held ahead, so it is only kept for a load of that scenario
+  if (source != preparsedFile)
+    cancelPreparse();
+
   loading = true;
-  ui.actionLoad->setEnabled(false);
-  statusLabel.setText("Loading scenario: " + fileName);
-  scene.reset();
-  nodeWidget.reset();
-  detailWidget.reset();
+  streaming = false;
+  pendingSession.reset();
+  ui.actionCancelLoading->setEnabled(true);
+  ui.actionStopFollowing->setEnabled(false);
+  ui.actionLoadReport->setEnabled(false);
+  statusLabel.setText("Loading scenario: " + source);
+  dropScenario(reload);
+  loadProgress = 0.0;
+  ingestLatency = {};
+
+  loadReport.clear();
+  loadStartTimes = scene.getLoadTimes();
+  loadTimer.start();
+}
+
+void MainWindow::cancelLoading() {
+  if (!loading)
+    return;
+
+  loadWorker.cancel(loadToken);
+  currentLoad++;
+  pendingSession.reset();
+  dropScenario();
+  endLoading();
+  statusLabel.setText("Loading cancelled");
+}
+
+void MainWindow::endLoading() {
+  loading = false;
+  streaming = false;
+  ui.actionCancelLoading->setEnabled(false);
+  ui.actionStopFollowing->setEnabled(false);
+}
+
+void MainWindow::dropScenario(bool keepScene) {
+  // Batches from the previous load are never added
+  (void)loadWorker.takeEventBatches(currentLoad);
+
+  timeDisplayTimer.stop();
+  timeDisplayPending = false;
+  resetUiTime();
+  scenarioFile.clear();
+  ui.actionSaveSession->setEnabled(false);
+  ui.actionCompare->setEnabled(false);
+  ui.actionReload->setEnabled(false);
+  reloadingScene = keepScene;
+  if (keepScene) {
+    // Still shown while the scenario is parsed again
+    scene.pause();
+  } else {
+    scene.reset();
+    sceneHash.reset();
+  }
+  if (nodeWidget)
+    nodeWidget->reset();
+  if (detailWidget)
+    detailWidget->reset();
+  describedNode.reset();
   playbackWidget.reset();
-  charts.reset();
+  if (charts)
+    charts->reset();
+  if (logWidget)
+    logWidget->reset();
+
+  staticModels.reset();
+  pendingLogStreams = {};
+  pendingLogEvents = {};
+  pendingChartEvents = {};
+}
+
+void MainWindow::load() {
+  auto fileName = getScenarioFile(this);
+  if (fileName.isEmpty())
+    return;
+
+  beginLoading(fileName);
   emit startLoading(fileName);
 }
 
-void MainWindow::finishLoading(const QString &fileName, unsigned long long milliseconds) {
-  auto parser = loadWorker.getParser();
+void MainWindow::loadPlaylist() {
+  auto fileNames = getScenarioFiles(this);
+  if (fileNames.isEmpty())
+    return;
+
+  playlist = std::move(fileNames);
+  playlistIndex = -1;
+  nextInPlaylist();
+}
+
+void MainWindow::nextInPlaylist() {
+  if (playlistIndex + 1 >= playlist.size())
+    return;
+
+  playlistIndex++;
+  ui.actionNextInPlaylist->setEnabled(playlistIndex + 1 < playlist.size());
+
+  const auto fileName = playlist[playlistIndex];
+  beginLoading(fileName);
+  statusLabel.setText("Loading scenario " + QString::number(playlistIndex + 1) + " of " +
+                      QString::number(playlist.size()) + ": " + fileName);
+  emit startLoading(fileName);
+}
+
+void MainWindow::preparseNext() {
+  if (playlistIndex < 0 || playlistIndex + 1 >= playlist.size() || scenarioFile != playlist[playlistIndex])
+    return;
+
+  const auto budget = settings.get<int>(SettingsManager::Key::ParserPreparseBudget).value();
+  const auto &next = playlist[playlistIndex + 1];
+  if (budget <= 0 || next == preparsedFile)
+    return;
+
+  cancelPreparse();
+  preparseToken = {};
+  preparsedFile = next;
+
+  // In the background, so the scenario being viewed is never held back by it
+  preparseTask = parser::TaskPool::shared().submit(
+      [this, next, token = preparseToken, bytes = static_cast<std::size_t>(budget) * 1024u * 1024u]() {
+        loadWorker.preparse(next, bytes, token);
+      },
+      parser::TaskPool::Priority::Background, preparseToken);
+  // So the window waits for it when closed
+  loadTasks.emplace_back(preparseTask);
+}
+
+void MainWindow::cancelPreparse() {
+  preparseToken.cancel();
+  preparseTask = {};
+  preparsedFile.clear();
+}
+
+void MainWindow::follow() {
+  auto fileName = getScenarioFile(this);
+  if (fileName.isEmpty())
+    return;
+
+  beginLoading(fileName);
+
+  statusLabel.setText("Following scenario: " + fileName);
+  ui.actionStopFollowing->setEnabled(true);
+  emit startFollowing(fileName);
+}
+
+void MainWindow::listen() {
+  auto accepted = false;
+  auto address = QInputDialog::getText(this, "Listen for Simulation",
+                                       "Address ('unix:/path/to/socket', or '[tcp:][host:]port'):",
+                                       QLineEdit::Normal, listenAddress, &accepted);
+  if (!accepted || address.isEmpty())
+    return;
+
+  beginLoading(address);
+  listenAddress = address;
+  streaming = true;
+  statusLabel.setText("Waiting for simulation on: " + address);
+  ui.actionStopFollowing->setEnabled(true);
+  emit startListening(address);
+}
+
+std::optional<QString> MainWindow::serve(const QString &address) {
+  if (auto error = scene.serve(address))
+    return error;
+
+  serveAddress = address;
+  ui.actionStopServing->setEnabled(true);
+  ui.statusbar->showMessage("Serving the view on: " + address, 10000);
+  return {};
+}
+
+std::optional<QString> MainWindow::leadWall(const QStringList &nodes) {
+  if (auto error = scene.leadWall(nodes))
+    return error;
+
+  ui.statusbar->showMessage("Leading a video wall of " + QString::number(nodes.size()) + " nodes", 10000);
+  return {};
+}
+
+std::optional<QString> MainWindow::joinWall(const QString &address, const WallTile &tile, const QString &scenario) {
+  if (auto error = scene.joinWall(address))
+    return error;
+  scene.setWallTile(tile);
+
+  // The tile is one part of a larger picture, so nothing else is drawn over it
+  ui.menubar->hide();
+  ui.statusbar->hide();
+  playbackWidget.hide();
+  for (auto dock : findChildren<QDockWidget *>())
+    dock->hide();
+
+  if (!scenario.isEmpty()) {
+    beginLoading(scenario);
+    emit startLoading(scenario);
+  }
+  return {};
+}
+
+void MainWindow::serveView() {
+  auto accepted = false;
+  auto address =
+      QInputDialog::getText(this, "Serve View", "Address ('unix:/path/to/socket', or '[tcp:][host:]port'):",
+                            QLineEdit::Normal, serveAddress, &accepted);
+  if (!accepted || address.isEmpty())
+    return;
+
+  if (const auto error = serve(address))
+    QMessageBox::critical(this, "Serve Failed", error.value());
+}
+
+void MainWindow::loadSections() {
+  const auto &parser = loadWorker.getParser();
   const auto &config = parser.getConfiguration();
   scene.setConfiguration(config);
 
@@ -320,50 +1177,556 @@ void MainWindow::finishLoading(const QString &fileName, unsigned long long milli
 
   playbackWidget.setTimeStep(timeStep, granularity);
 
-  // Nodes, Buildings, Decorations
-  const auto &nodes = parser.getNodes();
-  scene.add(parser.getAreas(), parser.getBuildings(), parser.getDecorations(), parser.getLinks(), parser.getNodes());
+  // Copied once, and shared by each widget below, including those created later
+  staticModels = parser.shareStaticModels();
+
+  using clock = std::chrono::steady_clock;
 
-  for (const auto &node : nodes) {
-    nodeWidget.addNode(node);
+  // Nodes, Buildings, Decorations
+  auto start = clock::now();
+  const auto hash = parser::hashScene(parser);
+  if (reloadingScene && sceneHash == hash) {
+    // Only the events changed, they replace the old ones as they are loaded
+    scene.resetEvents();
+  } else {
+    if (reloadingScene)
+      scene.reset();
+    scene.add(parser.getAreas(), parser.getBuildings(), staticModels, parser.getLinks());
+  }
+  sceneHash = hash;
+  reloadingScene = false;
+  loadReport.add("Scene setup", clock::now() - start);
+
+  if (nodeWidget) {
+    start = clock::now();
+    nodeWidget->setNodes(staticModels);
+    loadReport.add("Node list", clock::now() - start);
   }
 
   // Charts
-  charts.addSeries(parser.getXYSeries(), parser.getSeriesCollections(), parser.getCategoryValueSeries());
+  if (charts) {
+    start = clock::now();
+    charts->addSeries(staticModels);
+    loadReport.add("Chart series", clock::now() - start);
+  }
 
   // Log Streams
-  logWidget.reset();
-  const auto &logStreams = parser.getLogStreams();
-  for (const auto &logStream : logStreams) {
-    logWidget.addStream(logStream);
+  if (logWidget) {
+    start = clock::now();
+    logWidget->reset();
+    const auto &logStreams = parser.getLogStreams();
+    for (const auto &logStream : logStreams) {
+      logWidget->addStream(logStream);
+    }
+    loadReport.add("Log streams", clock::now() - start);
+  } else {
+    pendingLogStreams = parser.getLogStreams();
+  }
+
+  // Mapped from another viewer, so the batches which follow hold no scene events
+  if (const auto shared = loadWorker.getSharedEvents())
+    scene.attachEvents(shared);
+
+  // Nothing may be played back until the first batch of events arrives
+  scene.setLoadedTime(0LL);
+  playbackWidget.setLoadProgress(0.0, 0LL);
+  playbackWidget.enableControls();
+  statusLabel.setText("Loading events");
+}
+
+void MainWindow::loadEvents() {
+  parser::trace::Scope trace{"MainWindow::loadEvents", "load"};
+  auto batches = loadWorker.takeEventBatches(currentLoad);
+  if (batches.empty())
+    return;
+
+  // Events are moved through, so only the widgets hold a copy
+  const auto start = std::chrono::steady_clock::now();
+  for (auto &batch : batches) {
+    loadReport.addEvents(batch.sceneEvents.size() + batch.chartEvents.size() + batch.logEvents.size());
+    scene.enqueueEvents(std::move(batch.sceneEvents));
+
+    // Held as parsed until the charts or log are opened
+    if (charts)
+      charts->enqueueEvents(std::move(batch.chartEvents));
+    else
+      pendingChartEvents.insert(pendingChartEvents.end(), std::make_move_iterator(batch.chartEvents.begin()),
+                                std::make_move_iterator(batch.chartEvents.end()));
+    if (logWidget)
+      logWidget->enqueueEvents(std::move(batch.logEvents));
+    else
+      pendingLogEvents.insert(pendingLogEvents.end(), std::make_move_iterator(batch.logEvents.begin()),
+                              std::make_move_iterator(batch.logEvents.end()));
   }
+  loadReport.add("Event enqueue", std::chrono::steady_clock::now() - start);
+
+  const auto &latest = batches.back();
+  scene.setLoadedTime(latest.parsedTime);
+  playbackWidget.setLoadProgress(latest.progress, latest.parsedTime);
+  loadProgress = latest.progress;
+  playbackWidget.setEventDensity(loadWorker.getEventDensity().snapshot());
+
+  if (streaming) {
+    ingestLatency = std::chrono::steady_clock::now() - latest.delivered;
+    const auto latency = std::chrono::duration_cast<std::chrono::milliseconds>(ingestLatency);
+    statusLabel.setText("Streaming: " + toDisplayTime(latest.parsedTime, SettingsManager::TimeUnit::Nanoseconds) +
+                        " received, " + QString::number(latency.count()) + "ms latency");
+  }
+}
 
-  // Events
-  const auto &sceneEvents = parser.getSceneEvents();
-  scene.enqueueEvents(sceneEvents);
+void MainWindow::finishLoading(const QString &fileName, unsigned long long milliseconds) {
+  // Pick up any batches not handled yet
+  loadEvents();
 
-  const auto &chartEvents = parser.getChartsEvents();
-  charts.enqueueEvents(chartEvents);
+  // Written by this viewer, so the copy parsed here is replaced by the mapping other viewers use
+  if (const auto shared = loadWorker.getSharedEvents())
+    scene.attachEvents(shared);
 
-  const auto &logEvents = parser.getLogEvents();
-  logWidget.enqueueEvents(logEvents);
+  // The end time & bounds now account for every event
+  const auto &config = loadWorker.getParser().getConfiguration();
+  scene.setConfiguration(config);
+  scene.setLoadedTime({});
+  playbackWidget.setMaxTime(config.endTime);
+  playbackWidget.clearLoadProgress();
+  loadProgress = 1.0;
+
+  // Models & textures which finish after this point are not counted
+  const auto loadTimes = scene.getLoadTimes();
+  loadReport.add("Model import (waiting)", loadTimes.modelImport - loadStartTimes.modelImport);
+  loadReport.add("Model upload", loadTimes.modelUpload - loadStartTimes.modelUpload);
+  loadReport.add("Texture upload", loadTimes.textureUpload - loadStartTimes.textureUpload);
+  loadReport.setParseTime(std::chrono::milliseconds{milliseconds});
+  loadReport.setTotalTime(std::chrono::nanoseconds{loadTimer.nsecsElapsed()});
+  if (const QFileInfo file{fileName}; file.isFile())
+    loadReport.setBytes(static_cast<std::size_t>(file.size()));
 
   std::clog << "Scenario loaded in " << milliseconds << "ms\n";
-  ui.statusbar->showMessage("Successfully loaded scenario: " + fileName + " in " + QString::number(milliseconds) + "ms",
+  if (const auto compacted = loadWorker.getParser().getCompactedEvents(); compacted > 0)
+    std::clog << "Compacted " << compacted << " redundant events\n";
+  if (const auto reordered = loadWorker.getParser().getReorderedEvents(); reordered > 0)
+    std::clog << "Sorted " << reordered << " out of order events\n";
+  loadReport.write(std::clog);
+  ui.statusbar->showMessage("Successfully loaded scenario: " + fileName + " in " + QString::number(milliseconds) +
+                                "ms (" + QString::fromStdString(loadReport.summary()) + ")",
                             10000);
+  ui.actionLoadReport->setEnabled(true);
+
+  // Streamed scenarios cannot be loaded again
+  if (!streaming && QFileInfo{fileName}.isFile()) {
+    scenarioFile = fileName;
+    ui.actionSaveSession->setEnabled(true);
+    ui.actionCompare->setEnabled(true);
+    ui.actionReload->setEnabled(true);
+  }
 
-  playbackWidget.enableControls();
   statusLabel.setText("Ready");
-  loading = false;
-  ui.actionLoad->setEnabled(true);
+  endLoading();
+  preparseNext();
+
+  if (pendingSession) {
+    restoreSession(pendingSession.value());
+    pendingSession.reset();
+  }
+
+  if (pendingCommand) {
+    // Cleared first, as the command may load again
+    auto command = std::move(pendingCommand);
+    pendingCommand = nullptr;
+    command();
+  }
 }
 
 void MainWindow::errorLoading(const QString &message, unsigned long long offset) {
+  if (headless) {
+    std::cerr << "Failed to load the scenario: " << message.toStdString() << " at: " << offset << " characters\n";
+    QApplication::exit(1);
+    return;
+  }
+
   QMessageBox::critical(this, "Parsing Error", message + " at: " + QString::number(offset) + " characters");
 
+  // Drop anything loaded before the error
+  pendingSession.reset();
+  dropScenario();
+
   statusLabel.setText("Error loading scenario");
-  loading = false;
-  ui.actionLoad->setEnabled(true);
+  endLoading();
+}
+
+void MainWindow::saveSession() {
+  if (scenarioFile.isEmpty() || loading)
+    return;
+
+  const auto fileName = QFileDialog::getSaveFileName(this, "Save Session", "", "Session Files (*.session.json)");
+  if (fileName.isEmpty())
+    return;
+
+  if (!captureSession(true).save(fileName))
+    QMessageBox::critical(this, "Save Failed", "Failed to write the session to: " + fileName);
+}
+
+Session MainWindow::captureSession(bool withKeyframe) {
+  Session session;
+  session.scenario = scenarioFile;
+  if (settings.get<bool>(SettingsManager::Key::ParserCache).value()) {
+    const parser::ParseCache cache{
+        settings.get<QString>(SettingsManager::Key::ParserCacheDirectory).value().toStdString()};
+    const auto snapshot = cache.snapshotPath(scenarioFile.toStdString().c_str());
+    if (snapshot && parser::ParseCache::exists(snapshot.value()))
+      session.snapshot = QString::fromStdString(snapshot.value());
+  }
+
+  session.time = pendingTime;
+  const auto &camera = scene.getCamera();
+  session.cameraPosition = camera.get_position();
+  session.cameraYaw = camera.getYaw();
+  session.cameraPitch = camera.getPitch();
+  if (charts)
+    session.charts = charts->getOpenSeries();
+  if (logWidget) {
+    session.logStream = logWidget->getCurrentStream();
+    session.shownLogStreams = logWidget->getShownStreams();
+  }
+  if (withKeyframe) {
+    if (auto keyframe = scene.captureKeyframe())
+      session.keyframe = std::move(keyframe.value());
+  }
+
+  return session;
+}
+
+void MainWindow::reload() {
+  if (scenarioFile.isEmpty() || loading)
+    return;
+
+  // The keyframe is of the old events, so the time is sought again instead
+  auto session = captureSession(false);
+  const auto source = scenarioFile;
+
+  beginLoading(source, true);
+  pendingSession = std::move(session);
+  statusLabel.setText("Reloading scenario: " + source);
+  emit startLoading(source);
+}
+
+void MainWindow::openSession() {
+  const auto fileName = QFileDialog::getOpenFileName(this, "Open Session", "", "Session Files (*.session.json)");
+  if (fileName.isEmpty())
+    return;
+
+  auto session = Session::read(fileName);
+  if (!session) {
+    QMessageBox::critical(this, "Open Failed", "Failed to read a session from: " + fileName);
+    return;
+  }
+
+  // The snapshot holds the whole scenario, so it stands in for a scenario which was moved or removed
+  auto source = session->scenario;
+  if (!QFileInfo{source}.isFile() && session->snapshot && QFileInfo{session->snapshot.value()}.isFile())
+    source = session->snapshot.value();
+
+  if (!QFileInfo{source}.isFile()) {
+    QMessageBox::critical(this, "Open Failed", "The scenario of the session was not found: " + session->scenario);
+    return;
+  }
+
+  beginLoading(source);
+  pendingSession = std::move(session);
+  emit startLoading(source);
+}
+
+void MainWindow::capture(const QString &scenario, const ShotList &shots, const QString &directory,
+                         const QSize &size) {
+  runHeadless(scenario, [this, shots, directory, size]() {
+    scene.startCapture(shots, directory, size.width(), size.height());
+  });
+}
+
+void MainWindow::exportFrames(const QString &scenario, const QString &directory, const QSize &size,
+                              unsigned long long firstFrame, std::optional<unsigned long long> frames) {
+  runHeadless(scenario, [this, directory, size, firstFrame, frames]() {
+    scene.startExport(directory, size.width(), size.height(), firstFrame, frames);
+  });
+}
+
+void MainWindow::exportInParallel(const QString &scenario, const QString &directory, const QSize &size, int jobs) {
+  // Loaded here only to count the frames. With the parse cache on,
+  // this also leaves a cache entry behind for each job to load from
+  runHeadless(scenario, [this, scenario, directory, size, jobs]() {
+    startExportJobs(scenario, directory, size, jobs);
+  });
+}
+
+void MainWindow::runHeadless(const QString &scenario, std::function<void()> command) {
+  headless = true;
+  beginLoading(scenario);
+  pendingCommand = std::move(command);
+  emit startLoading(scenario);
+}
+
+void MainWindow::startExportJobs(const QString &scenario, const QString &directory, const QSize &size, int jobs) {
+  const auto totalFrames = scene.exportFrameCount();
+  const auto jobCount = std::clamp(static_cast<unsigned long long>(jobs), 1ULL, totalFrames);
+  const auto framesPerJob = totalFrames / jobCount;
+  const auto remainder = totalFrames % jobCount;
+
+  // The scene is not needed by this process any more
+  dropScenario();
+
+  std::clog << "Exporting " << totalFrames << " frames with " << jobCount << " jobs\n";
+
+  auto firstFrame = 0ULL;
+  for (auto i = 0ULL; i < jobCount; i++) {
+    // Spread the remainder across the first jobs
+    const auto frames = framesPerJob + (i < remainder ? 1ULL : 0ULL);
+
+    auto job = new QProcess{this};
+    job->setProcessChannelMode(QProcess::ForwardedChannels);
+    job->setArguments({"--export", directory, "--export-size", QString{"%1x%2"}.arg(size.width()).arg(size.height()),
+                       "--export-frames", QString{"%1:%2"}.arg(firstFrame).arg(frames), scenario});
+    job->setProgram(QCoreApplication::applicationFilePath());
+
+    QObject::connect(job, qOverload<int, QProcess::ExitStatus>(&QProcess::finished),
+                     [this, firstFrame, frames](int exitCode, QProcess::ExitStatus status) {
+                       finishedExportJobs++;
+                       if (status != QProcess::NormalExit || exitCode != 0) {
+                         failedExportJobs++;
+                         std::cerr << "Failed to export frames " << firstFrame << " to " << firstFrame + frames - 1u
+                                   << '\n';
+                       }
+
+                       if (finishedExportJobs == static_cast<int>(exportJobs.size()))
+                         QApplication::exit(failedExportJobs > 0 ? 1 : 0);
+                     });
+    QObject::connect(job, &QProcess::errorOccurred, [this, job](QProcess::ProcessError error) {
+      // Processes which never start never finish either
+      if (error != QProcess::FailedToStart)
+        return;
+
+      std::cerr << "Failed to start export job: " << job->errorString().toStdString() << '\n';
+      finishedExportJobs++;
+      failedExportJobs++;
+      if (finishedExportJobs == static_cast<int>(exportJobs.size()))
+        QApplication::exit(1);
+    });
+
+    exportJobs.emplace_back(job);
+    firstFrame += frames;
+  }
+
+  // Started once all are tracked, so the last to finish is always seen as the last
+  for (auto job : exportJobs)
+    job->start();
+}
+
+void MainWindow::restoreSession(const Session &session) {
+  auto &camera = scene.getCamera();
+  camera.setPosition(session.cameraPosition);
+  camera.setRotation(session.cameraYaw, session.cameraPitch);
+
+  // An empty list still closes the open charts
+  if (charts || !session.charts.empty())
+    ensureCharts().openCharts(this, session.charts);
+  if (logWidget)
+    logWidget->showStreams(session.logStream, session.shownLogStreams);
+  scene.restoreSession(session.time, session.keyframe);
+  ui.statusbar->showMessage(
+      "Restored session at: " + toDisplayTime(session.time, SettingsManager::TimeUnit::Nanoseconds), 10000);
+}
+
+void MainWindow::compare() {
+  if (scenarioFile.isEmpty() || loading)
+    return;
+
+  const auto fileName = getScenarioFile(this);
+  if (fileName.isEmpty())
+    return;
+
+  statusLabel.setText("Loading comparison: " + fileName);
+  submitLoad([this, fileName, id = currentLoad, token = loadToken]() {
+    parser::trace::Scope trace{"MainWindow::compare", "load"};
+
+    // The scene of the loaded scenario is shared, so only the chart events are kept
+    parser::ParseFilter filter;
+    for (const auto type : {"node-position", "node-orientation", "node-color", "node-transmit", "decoration-position",
+                            "decoration-orientation", "stream-append"})
+      filter.drop(type);
+
+    auto comparison = std::make_shared<parser::FileParser>();
+    comparison->setCancellation(token);
+    comparison->setFilter(std::move(filter));
+    auto parseError = comparison->parse(fileName.toStdString().c_str());
+
+    QMetaObject::invokeMethod(
+        this,
+        [this, id, fileName, comparison, parseError = std::move(parseError)]() {
+          // Superseded by another load
+          if (id == currentLoad)
+            addComparison(fileName, *comparison, parseError);
+        },
+        Qt::QueuedConnection);
+  });
+}
+
+void MainWindow::addComparison(const QString &fileName, parser::FileParser &comparison,
+                               const std::optional<parser::ParseError> &parseError) {
+  statusLabel.setText("Ready");
+  if (parseError) {
+    QMessageBox::critical(this, "Comparison Failed",
+                          QString::fromStdString(parseError->message) +
+                              " at: " + QString::number(parseError->offset) + " characters");
+    return;
+  }
+
+  if (parser::hashScene(comparison) != parser::hashScene(loadWorker.getParser())) {
+    QMessageBox::critical(this, "Comparison Failed",
+                          "The Nodes, Buildings, & Decorations of " + fileName +
+                              " differ from those of the loaded scenario, so it cannot share its scene");
+    return;
+  }
+
+  parser::StaticModels models;
+  models.xySeries = comparison.getXYSeries();
+  models.categoryValueSeries = comparison.getCategoryValueSeries();
+  models.seriesCollections = comparison.getSeriesCollections();
+  ensureCharts().addComparison(models, comparison.takeChartsEvents(), QFileInfo{fileName}.completeBaseName());
+
+  ui.statusbar->showMessage("Comparing with: " + fileName, 10000);
+}
+
+void MainWindow::describeNode(unsigned int nodeId) {
+  describedNode = nodeId;
+  if (detailWidget)
+    detailWidget->describe(scene.getNode(nodeId), scene.getStreams().nodeSlot(nodeId));
+}
+
+ChartManager &MainWindow::ensureCharts() {
+  if (charts)
+    return *charts;
+
+  charts = std::make_unique<ChartManager>(this);
+  if (staticModels)
+    charts->addSeries(staticModels);
+  if (!pendingChartEvents.empty()) {
+    charts->enqueueEvents(std::move(pendingChartEvents));
+    pendingChartEvents = {};
+  }
+
+  // Forward from the start, so every event up to the time is applied
+  if (staticModels)
+    charts->timeChanged(chartTime, 1LL);
+  return *charts;
+}
+
+ScenarioLogWidget &MainWindow::ensureLog() {
+  if (logWidget)
+    return *logWidget;
+
+  logWidget = std::make_unique<ScenarioLogWidget>(this);
+  ui.logDock->setWidget(logWidget.get());
+  logWidget->setSearchIndex(loadWorker.getLogIndex());
+  QObject::connect(logWidget.get(), &ScenarioLogWidget::timeSelected, &scene, &SceneWidget::setTime);
+
+  for (const auto &logStream : pendingLogStreams)
+    logWidget->addStream(logStream);
+  pendingLogStreams = {};
+  if (!pendingLogEvents.empty()) {
+    logWidget->enqueueEvents(std::move(pendingLogEvents));
+    pendingLogEvents = {};
+  }
+
+  // Forward from the start, so every event up to the time is applied
+  if (staticModels)
+    logWidget->timeChanged(uiTime, 1LL);
+  return *logWidget;
+}
+
+NodeWidget &MainWindow::ensureNodeList() {
+  if (nodeWidget)
+    return *nodeWidget;
+
+  nodeWidget = std::make_unique<NodeWidget>(this);
+  ui.nodesDock->setWidget(nodeWidget.get());
+  QObject::connect(nodeWidget.get(), &NodeWidget::nodeSelected, &scene, &SceneWidget::focusNode);
+  QObject::connect(nodeWidget.get(), &NodeWidget::nodeSelected, [this](uint32_t id) {
+    describeNode(id);
+    scene.setSelectedNode(id);
+  });
+
+  if (staticModels)
+    nodeWidget->setNodes(staticModels);
+  return *nodeWidget;
+}
+
+DetailWidget &MainWindow::ensureDetails() {
+  if (detailWidget)
+    return *detailWidget;
+
+  detailWidget = std::make_unique<DetailWidget>(this);
+  ui.nodeDetailsDock->setWidget(detailWidget.get());
+  detailWidget->setTrafficStatistics(scene.getTrafficStatistics(), [this](std::uint32_t slot) {
+    const auto &model = scene.getNodeModel(slot);
+    return QString("%1 (%2)").arg(QString::fromStdString(model.name)).arg(model.id);
+  });
+  QObject::connect(&scene, &SceneWidget::selectedItemUpdated, detailWidget.get(),
+                   &DetailWidget::describedItemUpdated);
+
+  if (describedNode)
+    describeNode(describedNode.value());
+  detailWidget->timeChanged(uiTime);
+  return *detailWidget;
+}
+
+void MainWindow::chartTraffic() {
+  const auto &traffic = scene.getTrafficStatistics();
+  const auto end = traffic.lastTime();
+  if (end <= 0LL) {
+    ui.statusbar->showMessage("No scene events loaded to chart", 10000);
+    return;
+  }
+
+  // Windows of a second, but no more than a few thousand points
+  constexpr parser::nanoseconds second = 1'000'000'000LL;
+  constexpr parser::nanoseconds maxSamples = 4096LL;
+  const auto step = std::max(second, (end + maxSamples - 1LL) / maxSamples);
+
+  parser::StaticModels models;
+  std::vector<parser::ChartEvent> events;
+  const auto addSeries = [&models, &events](std::string name, parser::Ns3Color3 color, const char *yAxis,
+                                            const std::vector<parser::XYPoint> &points) {
+    auto &series = models.xySeries.emplace_back();
+    series.id = static_cast<unsigned int>(models.xySeries.size());
+    series.visible = true;
+    series.name = std::move(name);
+    series.legend = series.name;
+    series.labelMode = parser::XYSeries::LabelMode::Hidden;
+    series.color = color;
+    series.xAxis.name = parser::InternedString{"Time (s)"};
+    series.yAxis.name = parser::InternedString{yAxis};
+
+    for (const auto &point : points)
+      events.emplace_back(parser::XYSeriesAddValue{
+          static_cast<parser::nanoseconds>(std::llround(point.x * 1'000'000'000.0)), series.id, point});
+  };
+
+  using parser::TrafficStatistics;
+  addSeries("Transmissions per Second", {31u, 119u, 180u}, "Transmissions/s",
+            traffic.rateSeries(TrafficStatistics::allNodes, end, step, step));
+  addSeries("Distance Moved", {255u, 127u, 14u}, "Distance", traffic.distanceSeries(TrafficStatistics::allNodes));
+
+  if (describedNode) {
+    const auto slot = scene.getStreams().nodeSlot(*describedNode);
+    if (slot < traffic.nodeCount()) {
+      const auto &model = scene.getNodeModel(slot);
+      const auto suffix = " - " + model.name + " (" + std::to_string(model.id) + ")";
+      addSeries("Transmissions per Second" + suffix, {44u, 160u, 44u}, "Transmissions/s",
+                traffic.rateSeries(slot, end, step, step));
+      addSeries("Distance Moved" + suffix, {214u, 39u, 40u}, "Distance", traffic.distanceSeries(slot));
+    }
+  }
+
+  ensureCharts().addComparison(models, std::move(events), "Traffic");
+  ui.statusbar->showMessage("Added traffic series to the charts", 10000);
 }
 
 void MainWindow::closeEvent(QCloseEvent *event) {
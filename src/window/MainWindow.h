@@ -34,18 +34,32 @@
 #pragma once
 
 #include "../settings/SettingsManager.h"
+#include "../util/load-report.h"
 #include "LoadWorker.h"
+#include "MetricsServer.h"
+#include "Session.h"
 #include "chart/ChartManager.h"
 #include "log/ScenarioLogWidget.h"
+#include "memory/MemoryWidget.h"
 #include "node/NodeWidget.h"
 #include "playback/PlaybackWidget.h"
 #include "scene/SceneWidget.h"
 #include "settings/SettingsDialog.h"
 #include "src/window/detail/DetailWidget.h"
 #include "ui_MainWindow.h"
+#include <QElapsedTimer>
 #include <QLabel>
 #include <QMainWindow>
-#include <QThread>
+#include <QProcess>
+#include <QStringList>
+#include <QTimer>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <task-pool.h>
+#include <vector>
 
 namespace netsimulyzer {
 class MainWindow : public QMainWindow {
@@ -56,23 +70,182 @@ public:
   ~MainWindow() override;
 
 public slots:
+  /**
+   * Add the configuration, Nodes, Buildings, etc.
+   * from the scenario being loaded.
+   * Called while the parser waits, before the events are loaded
+   */
+  void loadSections();
+
+  /**
+   * Add the batches of events loaded so far,
+   * and allow playback up to the latest one
+   */
+  void loadEvents();
   void finishLoading(const QString &fileName, unsigned long long milliseconds);
   void errorLoading(const QString &message, unsigned long long offset);
 
+  /**
+   * Print the memory report to the standard output every `seconds`,
+   * alongside the Memory dock
+   *
+   * @param seconds
+   * The time between reports, 0 to stop printing them
+   */
+  void setMemoryReportInterval(int seconds);
+
+  /**
+   * Stream the view to a remote client, see `SceneWidget::serve()`
+   *
+   * @param address
+   * Where to listen, see `parser::IngestSocket::listen()`
+   *
+   * @return
+   * A description of the error, if the socket could not be opened,
+   * an unset optional otherwise
+   */
+  [[nodiscard]] std::optional<QString> serve(const QString &address);
+
+  /**
+   * Serve the frame times, event rates, load progress, memory, & queue depths
+   * to a metrics scraper over HTTP, see `MetricsServer`
+   *
+   * @param address
+   * Where to listen, see `parser::IngestSocket::listen()`
+   *
+   * @return
+   * A description of the error, if the socket could not be opened,
+   * an unset optional otherwise
+   */
+  [[nodiscard]] std::optional<QString> serveMetrics(const QString &address);
+
+  /**
+   * Lead a video wall, see `SceneWidget::leadWall()`
+   *
+   * @param nodes
+   * Where each render node listens, see `parser::IngestSocket::connect()`
+   *
+   * @return
+   * A description of the error, if any node could not be reached,
+   * an unset optional otherwise
+   */
+  [[nodiscard]] std::optional<QString> leadWall(const QStringList &nodes);
+
+  /**
+   * Render one tile of a video wall, see `SceneWidget::joinWall()`.
+   * Only the scene is shown, so call before the window is shown full screen
+   *
+   * @param address
+   * Where to listen for the leader, see `parser::IngestSocket::listen()`
+   *
+   * @param tile
+   * The part of the wall to draw
+   *
+   * @param scenario
+   * The scenario to load, the same one as the leader's. Empty to load one later
+   *
+   * @return
+   * A description of the error, if the socket could not be opened,
+   * an unset optional otherwise
+   */
+  [[nodiscard]] std::optional<QString> joinWall(const QString &address, const WallTile &tile, const QString &scenario);
+
+  /**
+   * Print the metrics served by `serveMetrics()` to the standard output
+   * as a line of JSON every `seconds`
+   *
+   * @param seconds
+   * The time between lines, 0 to stop printing them
+   */
+  void setMetricsLogInterval(int seconds);
+
+  /**
+   * Load `scenario` with no window shown, capture an image of each shot, then quit,
+   * see `SceneWidget::startCapture()`. Quits with 1 if the load or any image fails
+   *
+   * @param scenario
+   * The scenario file to load
+   *
+   * @param shots
+   * The times & views to capture
+   *
+   * @param directory
+   * The directory to write the images to
+   *
+   * @param size
+   * The size of each image, in pixels
+   */
+  void capture(const QString &scenario, const ShotList &shots, const QString &directory, const QSize &size);
+
+  /**
+   * Load `scenario`, then export a range of its frames without a window,
+   * see `SceneWidget::startExport()`. Quits with 1 if the load or any frame fails
+   *
+   * @param scenario
+   * The scenario file to load
+   *
+   * @param directory
+   * The directory to write the frames to
+   *
+   * @param size
+   * The size of each frame, in pixels
+   *
+   * @param firstFrame
+   * The number of the first frame to export
+   *
+   * @param frames
+   * The most frames to export, unset to export up to the end of the scenario
+   */
+  void exportFrames(const QString &scenario, const QString &directory, const QSize &size,
+                    unsigned long long firstFrame = 0u, std::optional<unsigned long long> frames = {});
+
+  /**
+   * Load `scenario`, then split the export of all of its frames into `jobs` contiguous ranges,
+   * each exported by its own copy of this application, see `exportFrames()`.
+   * Frames keep their numbers across ranges, so the ranges together form one sequence in `directory`.
+   * Quits once every range is done, with 1 if any failed
+   *
+   * @param scenario
+   * The scenario file to load
+   *
+   * @param directory
+   * The directory to write the frames to
+   *
+   * @param size
+   * The size of each frame, in pixels
+   *
+   * @param jobs
+   * The number of processes to export with
+   */
+  void exportInParallel(const QString &scenario, const QString &directory, const QSize &size, int jobs);
+
 signals:
   void startLoading(const QString &fileName);
+  void startFollowing(const QString &fileName);
+  void startListening(const QString &address);
 
 private:
   const int stateVersion = 4;
   SettingsManager settings;
   SettingsDialog settingsDialog{this};
 
-  ChartManager charts{this};
-  NodeWidget nodeWidget{this};
-  DetailWidget detailWidget{this};
-  ScenarioLogWidget logWidget{this};
+  /**
+   * Only create the charts, log, Node list, & details once they are first opened,
+   * for deployments which only show the scene. See `ensureCharts()`
+   */
+  bool lightweight = settings.get<bool>(SettingsManager::Key::WindowLightweight).value();
+
+  /**
+   * Created up front, or on first use with `lightweight`.
+   * Loaded scenarios are only given to those which exist
+   */
+  std::unique_ptr<ChartManager> charts;
+  std::unique_ptr<NodeWidget> nodeWidget;
+  std::unique_ptr<DetailWidget> detailWidget;
+  std::unique_ptr<ScenarioLogWidget> logWidget;
   SceneWidget scene{this};
   PlaybackWidget playbackWidget{this};
+  MemoryWidget memoryWidget{this};
   Ui::MainWindow ui{};
 
   /**
@@ -82,13 +255,524 @@ private:
    */
   QLabel statusLabel{"Load Scenario", this};
 
+  /**
+   * Running while updates to the shown time are held back, see `timeChanged()`
+   */
+  QTimer timeDisplayTimer;
+
+  /**
+   * The latest time from the scene, shown once `timeDisplayTimer` runs out
+   */
+  parser::nanoseconds pendingTime{0LL};
+
+  /**
+   * If the time changed while `timeDisplayTimer` was running
+   */
+  bool timeDisplayPending{false};
+
+  /**
+   * Running while the log & details are held back, see `forwardTime()`
+   */
+  QTimer uiUpdateTimer;
+
+  /**
+   * The time the log & details were last moved to
+   */
+  parser::nanoseconds uiTime{0LL};
+
+  /**
+   * The latest time from the scene, given to the log & details once `uiUpdateTimer` runs out
+   */
+  parser::nanoseconds pendingUiTime{0LL};
+
+  /**
+   * If the time changed while `uiUpdateTimer` was running
+   */
+  bool uiUpdatePending{false};
+
+  /**
+   * Running while the charts are held back, see `forwardChartTime()`
+   */
+  QTimer chartUpdateTimer;
+
+  /**
+   * The time the charts were last moved to
+   */
+  parser::nanoseconds chartTime{0LL};
+
+  /**
+   * The latest time from the scene, given to the charts once `chartUpdateTimer` runs out
+   */
+  parser::nanoseconds pendingChartTime{0LL};
+
+  /**
+   * If the time changed while `chartUpdateTimer` was running
+   */
+  bool chartUpdatePending{false};
+
+  /**
+   * Updates the Memory dock while it is shown, see `reportMemory()`
+   */
+  QTimer memoryTimer;
+
+  /**
+   * Refreshes of `memoryTimer` between printed reports, 0 to not print them
+   */
+  int memoryPrintInterval{0};
+
+  /**
+   * Refreshes of `memoryTimer` since the last printed report
+   */
+  int memoryPrintCountdown{0};
+
+  /**
+   * Collects the metrics every second, while they are served or printed, see `collectMetrics()`
+   */
+  QTimer metricsTimer;
+  MetricsServer metricsServer;
+
+  /**
+   * Collections between printed metrics, 0 to not print them
+   */
+  int metricsPrintInterval{0};
+  int metricsPrintCountdown{0};
+
+  /**
+   * The scene's counters at the last collection, & the time since, for the rates
+   */
+  SceneWidget::FrameCounters lastFrameCounters;
+  QElapsedTimer metricsInterval;
+
+  /**
+   * The fraction of the scenario loaded so far, from 0.0 to 1.0
+   */
+  double loadProgress{0.0};
+
+  /**
+   * From the latest batch streamed being parsed, until it was added
+   */
+  std::chrono::steady_clock::duration ingestLatency{};
+
   bool loading = false;
+
+  /**
+   * The address last listened on, see `listen()`
+   */
+  QString listenAddress{"localhost:9100"};
+
+  /**
+   * The address last served on, see `serveView()`
+   */
+  QString serveAddress{"localhost:9200"};
+
+  /**
+   * The Node shown in `detailWidget`, if any
+   */
+  std::optional<unsigned int> describedNode;
+
+  /**
+   * The static models of the loaded scenario, for the subsystems created after it was loaded
+   */
+  std::shared_ptr<const parser::StaticModels> staticModels;
+
+  /**
+   * The log streams & events loaded before `logWidget` was created, given to it once it is
+   */
+  std::vector<parser::LogStream> pendingLogStreams;
+  std::vector<parser::LogEvent> pendingLogEvents;
+
+  /**
+   * The chart events loaded before `charts` was created, given to it once it is
+   */
+  std::vector<parser::ChartEvent> pendingChartEvents;
+
+  /**
+   * If the scenario being loaded is streamed from a simulation,
+   * so the latency of each batch is shown
+   */
+  bool streaming = false;
+
+  /**
+   * The time spent on each phase of the latest load, see `finishLoading()`
+   */
+  LoadReport loadReport;
+
+  /**
+   * The scene's model & texture times when the load began,
+   * so only the time spent on this load is reported
+   */
+  SceneWidget::LoadTimes loadStartTimes;
+
+  /**
+   * Running from `beginLoading()` until every event is added
+   */
+  QElapsedTimer loadTimer;
   LoadWorker loadWorker;
-  QThread loadThread;
 
+  /**
+   * Loads, follows, & listens on the shared `parser::TaskPool`
+   * which may not have finished, including superseded ones still stopping
+   */
+  std::vector<parser::TaskPool::Handle> loadTasks;
+
+  /**
+   * Cancels the current load, see `LoadWorker::cancel()`.
+   * Replaced for each load
+   */
+  parser::CancellationToken loadToken;
+
+  /**
+   * Identifies the current load in the `LoadWorker`'s signals,
+   * so those from a superseded or cancelled load are ignored
+   */
+  unsigned int currentLoad{0u};
+
+  /**
+   * Scenarios stepped through in turn, see `loadPlaylist()`
+   */
+  QStringList playlist;
+
+  /**
+   * The entry of `playlist` loaded last, -1 while there is no playlist
+   */
+  int playlistIndex{-1};
+
+  /**
+   * The scenario being, or already, parsed ahead by the `LoadWorker`. Empty if none
+   */
+  QString preparsedFile;
+
+  /**
+   * The parse of `preparsedFile`, waited on by its load, so it is never parsed twice
+   */
+  parser::TaskPool::Handle preparseTask;
+
+  /**
+   * Cancels the parse of `preparsedFile`. Replaced for each one
+   */
+  parser::CancellationToken preparseToken;
+
+  /**
+   * The file of the scenario last loaded completely, saved with sessions.
+   * Empty while nothing is loaded, or the scenario was streamed
+   */
+  QString scenarioFile;
+
+  /**
+   * The session being opened, applied once its scenario finishes loading
+   */
+  std::optional<Session> pendingSession;
+
+  /**
+   * The command from the command line to run once its scenario finishes loading,
+   * see `runHeadless()`
+   */
+  std::function<void()> pendingCommand;
+
+  /**
+   * Set for a command from the command line, which quits once done, rather than showing errors
+   */
+  bool headless{false};
+
+  /**
+   * The processes rendering each range of a parallel export, see `exportInParallel()`
+   */
+  std::vector<QProcess *> exportJobs;
+
+  /**
+   * The number of `exportJobs` which have finished, & how many of them failed
+   */
+  int finishedExportJobs{0};
+  int failedExportJobs{0};
+
+  /**
+   * Frames a headless export failed to write
+   */
+  unsigned long long exportFailures{0u};
+
+  /**
+   * The hash of the scene in `scene`, see `parser::hashScene()`.
+   * Unset while no scene is loaded
+   */
+  std::optional<std::uint64_t> sceneHash;
+
+  /**
+   * Set while reloading, until the reloaded scene is known.
+   * The old scene is kept until then, and kept for good if the scene is unchanged, see `loadSections()`
+   */
+  bool reloadingScene{false};
+
+  /**
+   * Show the scene's current time in the status bar & playback widget.
+   *
+   * The scene may change the time every frame,
+   * so the text is only updated at `TimeDisplayRate`.
+   * The first change after a quiet period is shown immediately,
+   * the rest wait for the timer, and only the latest is shown
+   */
   void timeChanged(parser::nanoseconds time, parser::nanoseconds increment);
+
+  /**
+   * Update the time text from `pendingTime`
+   */
+  void showTime();
+
+  /**
+   * Move the charts, log & details to the scene's time.
+   *
+   * They share the GUI thread with the scene, so updating them every frame
+   * takes time from drawing it. Changes are held back to `UiUpdateRate`,
+   * the same way as `timeChanged()`, and only the latest is applied
+   */
+  void forwardTime(parser::nanoseconds time);
+
+  /**
+   * Apply `pendingUiTime` to the log & details
+   */
+  void updateUi();
+
+  /**
+   * Move the charts to the scene's time, held back to `ChartRefreshRate` like `forwardTime()`.
+   * Every change to a chart's series between two updates is drawn with one repaint
+   */
+  void forwardChartTime(parser::nanoseconds time);
+
+  /**
+   * Apply `pendingChartTime` to the charts
+   */
+  void updateCharts();
+
+  /**
+   * Apply any held back time to the charts at once, when playback pauses or seeks,
+   * so they never rest on an older time than the scene
+   */
+  void flushCharts();
+
+  /**
+   * Create `charts` if it does not exist yet, with the series & events loaded so far,
+   * moved to the current time
+   *
+   * @return
+   * The chart manager
+   */
+  ChartManager &ensureCharts();
+
+  /**
+   * Create `logWidget` if it does not exist yet, with the streams & events loaded so far,
+   * moved to the current time, and put it in its dock
+   *
+   * @return
+   * The log widget
+   */
+  ScenarioLogWidget &ensureLog();
+
+  /**
+   * Create `nodeWidget` if it does not exist yet, listing the loaded Nodes, and put it in its dock
+   *
+   * @return
+   * The Node list
+   */
+  NodeWidget &ensureNodeList();
+
+  /**
+   * Create `detailWidget` if it does not exist yet, describing `describedNode`, and put it in its dock
+   *
+   * @return
+   * The details widget
+   */
+  DetailWidget &ensureDetails();
+
+  /**
+   * Drop any held back time, for a new scenario
+   */
+  void resetUiTime();
+
+  /**
+   * Collect the memory held by the parser & each widget,
+   * show it in the Memory dock, & print it if requested
+   */
+  void reportMemory();
+
+  /**
+   * @return
+   * The memory held by the parser & each widget
+   */
+  [[nodiscard]] MemoryReport collectMemory();
+
+  /**
+   * Collect the metrics of the viewer, publish them to the `metricsServer`,
+   * & print them if requested
+   */
+  void collectMetrics();
   void load();
 
+  /**
+   * Load a scenario which is still being written,
+   * adding its events as they are written, until it is complete or stopped
+   */
+  void follow();
+
+  /**
+   * Listen for a simulation streaming its scenario,
+   * adding its events as they arrive, until it is complete or stopped
+   */
+  void listen();
+
+  /**
+   * Ask for an address, then stream the view to a client connecting to it, see `serve()`
+   */
+  void serveView();
+
+  /**
+   * Add series of the traffic totals of every Node, and of `describedNode`, to the charts,
+   * sampled from `SceneWidget::getTrafficStatistics()` up to the latest loaded event
+   */
+  void chartTraffic();
+
+  /**
+   * Show a Node in `detailWidget`
+   *
+   * @param nodeId
+   * The ID of the Node to show
+   */
+  void describeNode(unsigned int nodeId);
+
+  /**
+   * Clear the current scenario, and cancel any load in progress,
+   * which the new load supersedes
+   *
+   * @param source
+   * The file or address of the scenario to load
+   *
+   * @param reload
+   * If `source` is the scenario loaded now, so its scene may be kept, see `reload()`
+   */
+  void beginLoading(const QString &source, bool reload = false);
+
+  /**
+   * Run `work` on the shared pool, with the current `loadToken`
+   *
+   * @param work
+   * Calls the `LoadWorker`
+   */
+  void submitLoad(std::function<void()> work);
+
+  /**
+   * Stop the load in progress, and drop what was loaded so far
+   */
+  void cancelLoading();
+
+  /**
+   * Reset the loading state & actions once a load is over
+   */
+  void endLoading();
+
+  /**
+   * Remove the current scenario from every widget
+   *
+   * @param keepScene
+   * Leave the scene as it is, paused, see `reloadingScene`
+   */
+  void dropScenario(bool keepScene = false);
+
+  /**
+   * Select several scenarios, and load the first
+   */
+  void loadPlaylist();
+
+  /**
+   * Load the entry of the playlist after the current one
+   */
+  void nextInPlaylist();
+
+  /**
+   * Parse the next entry of the playlist in the background, within `ParserPreparseBudget`,
+   * if the current entry is the scenario loaded
+   */
+  void preparseNext();
+
+  /**
+   * Stop parsing ahead, the `LoadWorker` drops the scenario on its next load
+   */
+  void cancelPreparse();
+
+  /**
+   * Load the current scenario file again, returning to the same time, camera, charts, & log streams.
+   * If the Nodes, Buildings, Areas, Decorations, & links are unchanged,
+   * the scene is kept, and only its events are replaced
+   */
+  void reload();
+
+  /**
+   * @param withKeyframe
+   * If the state of the scene at the current time should be included,
+   * which is only valid for the same events
+   *
+   * @return
+   * The current time, camera, charts, & log streams, for `scenarioFile`
+   */
+  [[nodiscard]] Session captureSession(bool withKeyframe);
+
+  /**
+   * Load `scenario` for a command from the command line, which runs once it finishes loading.
+   * Errors are written to `std::cerr` & quit the application, rather than being shown
+   *
+   * @param scenario
+   * The scenario file to load
+   *
+   * @param command
+   * The command to run once `scenario` is loaded
+   */
+  void runHeadless(const QString &scenario, std::function<void()> command);
+
+  /**
+   * Start the processes of `exportInParallel()`, once its scenario is loaded
+   */
+  void startExportJobs(const QString &scenario, const QString &directory, const QSize &size, int jobs);
+
+  /**
+   * Prompt for a file, then save the time, camera, charts, log streams,
+   * & the state of the scene to it, see `Session`
+   */
+  void saveSession();
+
+  /**
+   * Prompt for a session, then load its scenario.
+   * The rest of the session is applied by `restoreSession()` once the load finishes
+   */
+  void openSession();
+
+  /**
+   * Move every widget to the state saved in `session`
+   *
+   * @param session
+   * A session for the scenario just loaded
+   */
+  void restoreSession(const Session &session);
+
+  /**
+   * Prompt for another run of the loaded scenario, then parse its chart events on the shared pool.
+   * Only the series & chart events of the run are kept, see `addComparison()`
+   */
+  void compare();
+
+  /**
+   * Chart the series of another run alongside the loaded scenario,
+   * if both runs share the same scene, see `parser::hashScene()`.
+   * The scene, models, & log of the loaded scenario are shared
+   *
+   * @param fileName
+   * The file of the other run
+   *
+   * @param comparison
+   * The parser holding the other run
+   *
+   * @param parseError
+   * The error from parsing the other run, if any
+   */
+  void addComparison(const QString &fileName, parser::FileParser &comparison,
+                     const std::optional<parser::ParseError> &parseError);
+
 protected:
   void closeEvent(QCloseEvent *event) override;
 };
@@ -0,0 +1,128 @@
+/*
+ * NIST-developed software is provided by NIST as a public service. You may use,
+ * copy and distribute copies of the software in any medium, provided that you
+ * keep intact this entire notice. You may improve,modify and create derivative
+ * works of the software or any portion of the software, and you may copy and
+ * distribute such modifications or works. Modified works should carry a notice
+ * stating that you changed the software and should note the date and nature of
+ * any such change. Please explicitly acknowledge the National Institute of
+ * Standards and Technology as the source of the software.
+ *
+ * NIST-developed software is expressly provided "AS IS." NIST MAKES NO
+ * WARRANTY OF ANY KIND, EXPRESS, IMPLIED, IN FACT OR ARISING BY OPERATION OF
+ * LAW, INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTY OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, NON-INFRINGEMENT
+ * AND DATA ACCURACY. NIST NEITHER REPRESENTS NOR WARRANTS THAT THE
+ * OPERATION OF THE SOFTWARE WILL BE UNINTERRUPTED OR ERROR-FREE, OR THAT
+ * ANY DEFECTS WILL BE CORRECTED. NIST DOES NOT WARRANT OR MAKE ANY
+ * REPRESENTATIONS REGARDING THE USE OF THE SOFTWARE OR THE RESULTS THEREOF,
+ * INCLUDING BUT NOT LIMITED TO THE CORRECTNESS, ACCURACY, RELIABILITY,
+ * OR USEFULNESS OF THE SOFTWARE.
+ *
+ * You are solely responsible for determining the appropriateness of using and
+ * distributing the software and you assume all risks associated with its use,
+ * including but not limited to the risks and costs of program errors,
+ * compliance with applicable laws, damage to or loss of data, programs or
+ * equipment, and the unavailability or interruption of operation. This
+ * software is not intended to be used in any situation where a failure could
+ * cause risk of injury or damage to property. The software developed by NIST
+ * employees is not subject to copyright protection within the United States.
+ *
+ * Author: Evan Black <evan.black@nist.gov>
+ */
+
+#include "MetricsServer.h"
+#include <array>
+#include <chrono>
+#include <iostream>
+#include <trace.h>
+#include <utility>
+
+namespace netsimulyzer {
+
+MetricsServer::~MetricsServer() {
+  stop();
+}
+
+std::optional<QString> MetricsServer::listen(const QString &address) {
+  stop();
+
+  socket.emplace();
+  if (const auto error = socket->listen(address.toStdString())) {
+    socket.reset();
+    return QString::fromStdString(error.value());
+  }
+
+  stopRequested = false;
+  server = parser::TaskPool::shared().submit([this, address = address.toStdString()]() {
+    serve(address);
+  });
+  return {};
+}
+
+void MetricsServer::stop() {
+  stopRequested = true;
+  server.wait();
+  socket.reset();
+}
+
+bool MetricsServer::isListening() const {
+  return socket.has_value();
+}
+
+void MetricsServer::publish(std::string text) {
+  std::lock_guard lock{metricsMutex};
+  metrics = std::move(text);
+}
+
+void MetricsServer::serve(const std::string &address) {
+  while (!stopRequested) {
+    if (!socket->accept(stopRequested))
+      return;
+
+    answer();
+
+    // The listener was closed once the client connected, and opening it again closes the connection
+    if (const auto error = socket->listen(address)) {
+      std::cerr << "Metrics server stopped: " << error.value() << '\n';
+      return;
+    }
+  }
+}
+
+void MetricsServer::answer() {
+  using namespace std::chrono_literals;
+  parser::trace::Scope trace{"MetricsServer::answer", "metrics"};
+
+  // Only the request line matters, the headers & any body are ignored
+  std::array<char, 1024u> buffer{};
+  std::string request;
+  while (!stopRequested && request.find('\n') == std::string::npos) {
+    const auto received = socket->read(buffer.data(), buffer.size(), 1000ms);
+    // Closed, or too slow to send a request line
+    if (!received || received.value() == 0u)
+      return;
+
+    request.append(buffer.data(), received.value());
+    if (request.size() > 8192u)
+      return;
+  }
+
+  const auto line = request.substr(0u, request.find_first_of("\r\n"));
+  std::string status{"200 OK"};
+  std::string body;
+  if (line.rfind("GET /metrics ", 0u) == 0u || line.rfind("GET / ", 0u) == 0u) {
+    std::lock_guard lock{metricsMutex};
+    body = metrics;
+  } else {
+    status = "404 Not Found";
+    body = "Not found, see /metrics\n";
+  }
+
+  const auto response = "HTTP/1.1 " + status +
+                        "\r\nContent-Type: text/plain; version=0.0.4; charset=utf-8\r\nContent-Length: " +
+                        std::to_string(body.size()) + "\r\nConnection: close\r\n\r\n" + body;
+  (void)socket->write(response.data(), response.size());
+}
+
+} // namespace netsimulyzer
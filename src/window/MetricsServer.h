@@ -0,0 +1,117 @@
+/*
+ * NIST-developed software is provided by NIST as a public service. You may use,
+ * copy and distribute copies of the software in any medium, provided that you
+ * keep intact this entire notice. You may improve,modify and create derivative
+ * works of the software or any portion of the software, and you may copy and
+ * distribute such modifications or works. Modified works should carry a notice
+ * stating that you changed the software and should note the date and nature of
+ * any such change. Please explicitly acknowledge the National Institute of
+ * Standards and Technology as the source of the software.
+ *
+ * NIST-developed software is expressly provided "AS IS." NIST MAKES NO
+ * WARRANTY OF ANY KIND, EXPRESS, IMPLIED, IN FACT OR ARISING BY OPERATION OF
+ * LAW, INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTY OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, NON-INFRINGEMENT
+ * AND DATA ACCURACY. NIST NEITHER REPRESENTS NOR WARRANTS THAT THE
+ * OPERATION OF THE SOFTWARE WILL BE UNINTERRUPTED OR ERROR-FREE, OR THAT
+ * ANY DEFECTS WILL BE CORRECTED. NIST DOES NOT WARRANT OR MAKE ANY
+ * REPRESENTATIONS REGARDING THE USE OF THE SOFTWARE OR THE RESULTS THEREOF,
+ * INCLUDING BUT NOT LIMITED TO THE CORRECTNESS, ACCURACY, RELIABILITY,
+ * OR USEFULNESS OF THE SOFTWARE.
+ *
+ * You are solely responsible for determining the appropriateness of using and
+ * distributing the software and you assume all risks associated with its use,
+ * including but not limited to the risks and costs of program errors,
+ * compliance with applicable laws, damage to or loss of data, programs or
+ * equipment, and the unavailability or interruption of operation. This
+ * software is not intended to be used in any situation where a failure could
+ * cause risk of injury or damage to property. The software developed by NIST
+ * employees is not subject to copyright protection within the United States.
+ *
+ * Author: Evan Black <evan.black@nist.gov>
+ */
+
+#pragma once
+
+#include <QString>
+#include <atomic>
+#include <ingest-socket.h>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <task-pool.h>
+
+namespace netsimulyzer {
+
+/**
+ * Answers HTTP requests for the latest metrics published by the window,
+ * so viewers may be watched by a Prometheus style scraper.
+ *
+ * `GET /metrics` (or `GET /`) is answered with the text given to `publish()`,
+ * anything else with a 404. One request is served per connection,
+ * which is closed once answered.
+ *
+ * Requests are served on the shared `parser::TaskPool`, and never wait on the window.
+ * Unavailable on Windows, see `parser::IngestSocket`
+ */
+class MetricsServer {
+  std::optional<parser::IngestSocket> socket;
+
+  /**
+   * Serves requests until `stopRequested`, see `serve()`
+   */
+  parser::TaskPool::Handle server;
+  std::atomic<bool> stopRequested{false};
+
+  /**
+   * Guards `metrics`, which is replaced by the window while requests are served
+   */
+  std::mutex metricsMutex;
+  std::string metrics;
+
+  /**
+   * Accept connections & answer their requests, until stopped. Runs on the pool
+   *
+   * @param address
+   * Where to listen, see `parser::IngestSocket::listen()`
+   */
+  void serve(const std::string &address);
+
+  /**
+   * Read the request line of one connection, and answer it
+   */
+  void answer();
+
+public:
+  MetricsServer() = default;
+  MetricsServer(const MetricsServer &other) = delete;
+  ~MetricsServer();
+
+  MetricsServer &operator=(const MetricsServer &other) = delete;
+
+  /**
+   * Start listening for requests, replacing any earlier server
+   *
+   * @param address
+   * Where to listen, see `parser::IngestSocket::listen()`
+   *
+   * @return
+   * A description of the error, if the socket could not be opened,
+   * an unset optional otherwise
+   */
+  [[nodiscard]] std::optional<QString> listen(const QString &address);
+
+  void stop();
+
+  [[nodiscard]] bool isListening() const;
+
+  /**
+   * Replace the metrics served
+   *
+   * @param text
+   * The metrics, in the Prometheus text format, see `MetricsReport::writePrometheus()`
+   */
+  void publish(std::string text);
+};
+
+} // namespace netsimulyzer
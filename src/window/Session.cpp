@@ -0,0 +1,223 @@
+/*
+ * NIST-developed software is provided by NIST as a public service. You may use,
+ * copy and distribute copies of the software in any medium, provided that you
+ * keep intact this entire notice. You may improve,modify and create derivative
+ * works of the software or any portion of the software, and you may copy and
+ * distribute such modifications or works. Modified works should carry a notice
+ * stating that you changed the software and should note the date and nature of
+ * any such change. Please explicitly acknowledge the National Institute of
+ * Standards and Technology as the source of the software.
+ *
+ * NIST-developed software is expressly provided "AS IS." NIST MAKES NO
+ * WARRANTY OF ANY KIND, EXPRESS, IMPLIED, IN FACT OR ARISING BY OPERATION OF
+ * LAW, INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTY OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, NON-INFRINGEMENT
+ * AND DATA ACCURACY. NIST NEITHER REPRESENTS NOR WARRANTS THAT THE
+ * OPERATION OF THE SOFTWARE WILL BE UNINTERRUPTED OR ERROR-FREE, OR THAT
+ * ANY DEFECTS WILL BE CORRECTED. NIST DOES NOT WARRANT OR MAKE ANY
+ * REPRESENTATIONS REGARDING THE USE OF THE SOFTWARE OR THE RESULTS THEREOF,
+ * INCLUDING BUT NOT LIMITED TO THE CORRECTNESS, ACCURACY, RELIABILITY,
+ * OR USEFULNESS OF THE SOFTWARE.
+ *
+ * You are solely responsible for determining the appropriateness of using and
+ * distributing the software and you assume all risks associated with its use,
+ * including but not limited to the risks and costs of program errors,
+ * compliance with applicable laws, damage to or loss of data, programs or
+ * equipment, and the unavailability or interruption of operation. This
+ * software is not intended to be used in any situation where a failure could
+ * cause risk of injury or damage to property. The software developed by NIST
+ * employees is not subject to copyright protection within the United States.
+ *
+ * Author: Evan Black <evan.black@nist.gov>
+ */
+
+#include "Session.h"
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonValue>
+#include <array>
+#include <cstdint>
+
+namespace {
+
+/**
+ * Written with each session, and checked when reading one
+ */
+const QString sessionFormat = "netsimulyzer-session";
+constexpr int sessionVersion = 1;
+
+// 64 bit values are kept as strings, a JSON number would only keep 53 bits
+QJsonValue toJson(long long value) {
+  return QString::number(value);
+}
+
+long long toLongLong(const QJsonValue &value) {
+  return value.toString().toLongLong();
+}
+
+QJsonArray toJson(float x, float y, float z) {
+  return {x, y, z};
+}
+
+QJsonValue toJson(const std::optional<parser::Ns3Color3> &color) {
+  if (!color)
+    return QJsonValue::Null;
+
+  return QJsonArray{color->red, color->green, color->blue};
+}
+
+std::optional<parser::Ns3Color3> toColor(const QJsonValue &value) {
+  if (!value.isArray())
+    return {};
+
+  const auto array = value.toArray();
+  return parser::Ns3Color3{static_cast<uint8_t>(array[0].toInt()), static_cast<uint8_t>(array[1].toInt()),
+                           static_cast<uint8_t>(array[2].toInt())};
+}
+
+std::array<float, 3> toFloats(const QJsonValue &value) {
+  const auto array = value.toArray();
+  return {static_cast<float>(array[0].toDouble()), static_cast<float>(array[1].toDouble()),
+          static_cast<float>(array[2].toDouble())};
+}
+
+QJsonArray toJson(const std::vector<unsigned int> &ids) {
+  QJsonArray array;
+  for (const auto id : ids)
+    array.append(static_cast<qint64>(id));
+  return array;
+}
+
+std::vector<unsigned int> toIds(const QJsonValue &value) {
+  std::vector<unsigned int> ids;
+  for (const auto id : value.toArray())
+    ids.emplace_back(static_cast<unsigned int>(id.toDouble()));
+  return ids;
+}
+
+} // namespace
+
+namespace netsimulyzer {
+
+bool Session::save(const QString &path) const {
+  QJsonArray nodes;
+  for (const auto &[id, state] : keyframe.nodes) {
+    QJsonObject node{{"id", static_cast<qint64>(id)},
+                     {"position", toJson(state.position.x, state.position.y, state.position.z)},
+                     {"rotation", toJson(state.rotation[0], state.rotation[1], state.rotation[2])},
+                     {"baseColor", toJson(state.baseColor)},
+                     {"highlightColor", toJson(state.highlightColor)}};
+
+    // The rest of the transmission is unused once it ends
+    const auto &transmit = state.transmitInfo;
+    if (transmit.isTransmitting) {
+      node["transmit"] = QJsonObject{{"startTime", toJson(transmit.startTime)},
+                                     {"targetSize", transmit.targetSize},
+                                     {"duration", toJson(transmit.duration)},
+                                     {"color", toJson(transmit.color.r, transmit.color.g, transmit.color.b)}};
+    }
+    nodes.append(node);
+  }
+
+  QJsonArray decorations;
+  for (const auto &[id, state] : keyframe.decorations) {
+    decorations.append(
+        QJsonObject{{"id", static_cast<qint64>(id)},
+                    {"position", toJson(state.position.x, state.position.y, state.position.z)},
+                    {"rotation", toJson(state.rotation[0], state.rotation[1], state.rotation[2])}});
+  }
+
+  const QJsonObject root{
+      {"format", sessionFormat},
+      {"version", sessionVersion},
+      {"scenario", scenario},
+      {"snapshot", snapshot ? QJsonValue{snapshot.value()} : QJsonValue::Null},
+      {"time", toJson(time)},
+      {"camera", QJsonObject{{"position", toJson(cameraPosition.x, cameraPosition.y, cameraPosition.z)},
+                             {"yaw", cameraYaw},
+                             {"pitch", cameraPitch}}},
+      {"charts", toJson(charts)},
+      {"log", QJsonObject{{"stream", static_cast<qint64>(logStream)}, {"shown", toJson(shownLogStreams)}}},
+      {"keyframe", QJsonObject{{"eventCount", toJson(static_cast<long long>(keyframe.eventCount))},
+                               {"nodes", nodes},
+                               {"decorations", decorations}}}};
+
+  QFile file{path};
+  if (!file.open(QFile::WriteOnly | QFile::Truncate))
+    return false;
+
+  file.write(QJsonDocument{root}.toJson(QJsonDocument::Compact));
+  return file.error() == QFile::NoError;
+}
+
+std::optional<Session> Session::read(const QString &path) {
+  QFile file{path};
+  if (!file.open(QFile::ReadOnly))
+    return {};
+
+  const auto document = QJsonDocument::fromJson(file.readAll());
+  const auto root = document.object();
+  if (root["format"].toString() != sessionFormat || root["version"].toInt() != sessionVersion)
+    return {};
+
+  Session session;
+  session.scenario = root["scenario"].toString();
+  if (root["snapshot"].isString())
+    session.snapshot = root["snapshot"].toString();
+  session.time = toLongLong(root["time"]);
+
+  const auto camera = root["camera"].toObject();
+  const auto position = toFloats(camera["position"]);
+  session.cameraPosition = {position[0], position[1], position[2]};
+  session.cameraYaw = static_cast<float>(camera["yaw"].toDouble(-90.0));
+  session.cameraPitch = static_cast<float>(camera["pitch"].toDouble());
+
+  session.charts = toIds(root["charts"]);
+
+  const auto log = root["log"].toObject();
+  session.logStream = static_cast<unsigned int>(log["stream"].toDouble());
+  session.shownLogStreams = toIds(log["shown"]);
+
+  const auto keyframe = root["keyframe"].toObject();
+  session.keyframe.eventCount = static_cast<std::size_t>(toLongLong(keyframe["eventCount"]));
+
+  for (const auto value : keyframe["nodes"].toArray()) {
+    const auto node = value.toObject();
+
+    Node::State state;
+    const auto nodePosition = toFloats(node["position"]);
+    state.position = {nodePosition[0], nodePosition[1], nodePosition[2]};
+    state.rotation = toFloats(node["rotation"]);
+    state.baseColor = toColor(node["baseColor"]);
+    state.highlightColor = toColor(node["highlightColor"]);
+
+    if (node["transmit"].isObject()) {
+      const auto transmit = node["transmit"].toObject();
+      const auto color = toFloats(transmit["color"]);
+      state.transmitInfo.isTransmitting = true;
+      state.transmitInfo.startTime = toLongLong(transmit["startTime"]);
+      state.transmitInfo.targetSize = transmit["targetSize"].toDouble();
+      state.transmitInfo.duration = toLongLong(transmit["duration"]);
+      state.transmitInfo.color = {color[0], color[1], color[2]};
+    }
+
+    session.keyframe.nodes.emplace_back(static_cast<unsigned int>(node["id"].toDouble()), state);
+  }
+
+  for (const auto value : keyframe["decorations"].toArray()) {
+    const auto decoration = value.toObject();
+
+    Decoration::State state;
+    const auto decorationPosition = toFloats(decoration["position"]);
+    state.position = {decorationPosition[0], decorationPosition[1], decorationPosition[2]};
+    state.rotation = toFloats(decoration["rotation"]);
+
+    session.keyframe.decorations.emplace_back(static_cast<unsigned int>(decoration["id"].toDouble()), state);
+  }
+
+  return session;
+}
+
+} // namespace netsimulyzer
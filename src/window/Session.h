@@ -0,0 +1,117 @@
+/*
+ * NIST-developed software is provided by NIST as a public service. You may use,
+ * copy and distribute copies of the software in any medium, provided that you
+ * keep intact this entire notice. You may improve,modify and create derivative
+ * works of the software or any portion of the software, and you may copy and
+ * distribute such modifications or works. Modified works should carry a notice
+ * stating that you changed the software and should note the date and nature of
+ * any such change. Please explicitly acknowledge the National Institute of
+ * Standards and Technology as the source of the software.
+ *
+ * NIST-developed software is expressly provided "AS IS." NIST MAKES NO
+ * WARRANTY OF ANY KIND, EXPRESS, IMPLIED, IN FACT OR ARISING BY OPERATION OF
+ * LAW, INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTY OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, NON-INFRINGEMENT
+ * AND DATA ACCURACY. NIST NEITHER REPRESENTS NOR WARRANTS THAT THE
+ * OPERATION OF THE SOFTWARE WILL BE UNINTERRUPTED OR ERROR-FREE, OR THAT
+ * ANY DEFECTS WILL BE CORRECTED. NIST DOES NOT WARRANT OR MAKE ANY
+ * REPRESENTATIONS REGARDING THE USE OF THE SOFTWARE OR THE RESULTS THEREOF,
+ * INCLUDING BUT NOT LIMITED TO THE CORRECTNESS, ACCURACY, RELIABILITY,
+ * OR USEFULNESS OF THE SOFTWARE.
+ *
+ * You are solely responsible for determining the appropriateness of using and
+ * distributing the software and you assume all risks associated with its use,
+ * including but not limited to the risks and costs of program errors,
+ * compliance with applicable laws, damage to or loss of data, programs or
+ * equipment, and the unavailability or interruption of operation. This
+ * software is not intended to be used in any situation where a failure could
+ * cause risk of injury or damage to property. The software developed by NIST
+ * employees is not subject to copyright protection within the United States.
+ *
+ * Author: Evan Black <evan.black@nist.gov>
+ */
+
+#pragma once
+
+#include "scene/KeyframeIndex.h"
+#include <QString>
+#include <glm/glm.hpp>
+#include <model.h>
+#include <optional>
+#include <vector>
+
+namespace netsimulyzer {
+
+/**
+ * Where the viewer was left in a scenario, so it may be picked up again later.
+ *
+ * Opening a session loads its scenario, through the parse cache when it has a snapshot,
+ * then restores the saved keyframe directly,
+ * rather than playing the scenario's events back up to `time`.
+ * Saved as JSON
+ */
+struct Session {
+  /**
+   * The scenario file the session was saved from
+   */
+  QString scenario;
+
+  /**
+   * The parse cache snapshot of `scenario`, see `parser::ParseCache`.
+   * Unset if the parse cache was off
+   */
+  std::optional<QString> snapshot;
+
+  /**
+   * The playback time
+   */
+  parser::nanoseconds time{0LL};
+
+  glm::vec3 cameraPosition{0.0f};
+  float cameraYaw{-90.0f};
+  float cameraPitch{0.0f};
+
+  /**
+   * The series selected in each open chart, see `ChartManager::getOpenSeries()`
+   */
+  std::vector<unsigned int> charts;
+
+  /**
+   * The stream chosen in the log, 0u for the unified log
+   */
+  unsigned int logStream{0u};
+
+  /**
+   * The streams shown in the unified log
+   */
+  std::vector<unsigned int> shownLogStreams;
+
+  /**
+   * The state of every Node & Decoration at `time`
+   */
+  KeyframeIndex::Keyframe keyframe;
+
+  /**
+   * Write the session to `path`
+   *
+   * @param path
+   * The file to write to, replaced if it exists
+   *
+   * @return
+   * True if the file was written, false otherwise
+   */
+  [[nodiscard]] bool save(const QString &path) const;
+
+  /**
+   * Read a session written by `save()`
+   *
+   * @param path
+   * The file to read
+   *
+   * @return
+   * The session, unset if the file could not be read, or is not a session
+   */
+  [[nodiscard]] static std::optional<Session> read(const QString &path);
+};
+
+} // namespace netsimulyzer
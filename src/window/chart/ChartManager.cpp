@@ -36,54 +36,186 @@
 #include <QDockWidget>
 #include <QGraphicsLayout>
 #include <QMainWindow>
-#include <QMessageBox>
 #include <QString>
 #include <QtCharts/QCategoryAxis>
 #include <QtCharts/QLogValueAxis>
-#include <QtCharts/QScatterSeries>
-#include <QtCharts/QSplineSeries>
 #include <algorithm>
 #include <cstdlib>
 #include <iostream>
+#include <iterator>
 #include <stdexcept>
+#include <trace.h>
 #include <utility>
 
-namespace {
-
-void updateRange(QtCharts::QAbstractAxis *axis, qreal value) {
-  // Amount to scale past the min/max
-  // so we don't cut off the actual point
-  const auto additionalScale = 0.05;
+namespace netsimulyzer {
 
-  qreal min;
-  qreal max;
-  if (const auto valueAxis = qobject_cast<QtCharts::QValueAxis *>(axis)) {
+ChartManager::GrowingAxis::GrowingAxis(QtCharts::QAbstractAxis *axis)
+    : valueAxis(qobject_cast<QtCharts::QValueAxis *>(axis)), logAxis(qobject_cast<QtCharts::QLogValueAxis *>(axis)) {
+  if (valueAxis) {
     min = valueAxis->min();
     max = valueAxis->max();
-  } else if (const auto logAxis = qobject_cast<QtCharts::QLogValueAxis *>(axis)) {
+  } else if (logAxis) {
     min = logAxis->min();
     max = logAxis->max();
   } else {
-    std::cerr << "Error: Unhandled axis type in updateRange()\n";
+    std::cerr << "Error: Unhandled axis type in GrowingAxis()\n";
+  }
+
+  initialMin = min;
+  initialMax = max;
+}
+
+void ChartManager::GrowingAxis::grow(qreal value) {
+  // Amount to scale past the min/max
+  // so we don't cut off the actual point
+  const auto additionalScale = 0.05;
+
+  if (value > max) {
+    max = value + value * additionalScale;
+    if (valueAxis)
+      valueAxis->setMax(max);
+    else if (logAxis)
+      logAxis->setMax(max);
+  } else if (value < min) {
+    min = value - value * additionalScale;
+    if (valueAxis)
+      valueAxis->setMin(min);
+    else if (logAxis)
+      logAxis->setMin(min);
+  }
+}
+
+void ChartManager::GrowingAxis::fit(std::optional<std::pair<qreal, qreal>> extent) {
+  // Same scale as `grow()`
+  const auto additionalScale = 0.05;
+
+  auto newMin = initialMin;
+  auto newMax = initialMax;
+  if (extent) {
+    const auto [low, high] = extent.value();
+    if (high > initialMax)
+      newMax = high + high * additionalScale;
+    if (low < initialMin)
+      newMin = low - low * additionalScale;
+  }
+
+  if (newMin == min && newMax == max)
+    return;
+
+  min = newMin;
+  max = newMax;
+  show(min, max);
+}
+
+void ChartManager::GrowingAxis::show(qreal low, qreal high) {
+  if (valueAxis)
+    valueAxis->setRange(low, high);
+  else if (logAxis)
+    logAxis->setRange(low, high);
+}
+
+void ChartManager::GrowingAxis::restore() {
+  show(min, max);
+}
+
+void ChartManager::CategoryValueTie::sync() {
+  const auto onSeries = qtSeries->count();
+  if (onSeries > synced)
+    qtSeries->removePoints(synced, onSeries - synced);
+
+  if (synced < values.size())
+    qtSeries->append(values.mid(synced));
+  synced = values.size();
+}
+
+void ChartManager::XYSeriesTie::show(int maxLabels) {
+  data.show(*qtSeries);
+  if (!labelSeries)
+    return;
+
+  const auto points = qtSeries->pointsVector();
+  if (points.size() <= maxLabels) {
+    labelSeries->replace(points);
+    return;
+  }
+  if (maxLabels < 3) {
+    labelSeries->clear();
     return;
   }
 
-  if (value > max)
-    axis->setMax(value + value * additionalScale);
-  else if (value < min)
-    axis->setMin(value - value * additionalScale);
+  // Room for the last point, which is always kept
+  const auto buckets = (maxLabels - 1) / 2;
+  const auto size = (points.size() + buckets - 1) / buckets;
+
+  QVector<QPointF> labelled;
+  labelled.reserve(maxLabels);
+  DecimatedSeries::summarize(points, 0, points.size(), size, labelled);
+  labelSeries->replace(labelled);
 }
 
-} // namespace
+void ChartManager::XYSeriesTie::hide() {
+  data.hide(*qtSeries);
+  if (labelSeries)
+    labelSeries->clear();
+}
 
-namespace netsimulyzer {
+template <class T>
+T *ChartManager::take(std::vector<T *> &pooled) {
+  if (pooled.empty())
+    return new T(this);
+
+  auto object = pooled.back();
+  pooled.pop_back();
+  return object;
+}
+
+void ChartManager::release(QtCharts::QXYSeries *series) {
+  series->clear();
+
+  // Splines are also line series, so they are checked first
+  if (auto spline = qobject_cast<QtCharts::QSplineSeries *>(series))
+    pool.splineSeries.emplace_back(spline);
+  else if (auto scatter = qobject_cast<QtCharts::QScatterSeries *>(series))
+    pool.scatterSeries.emplace_back(scatter);
+  else if (auto line = qobject_cast<QtCharts::QLineSeries *>(series))
+    pool.lineSeries.emplace_back(line);
+  else
+    series->deleteLater();
+}
+
+void ChartManager::release(QtCharts::QAbstractAxis *axis) {
+  if (auto category = qobject_cast<QtCharts::QCategoryAxis *>(axis)) {
+    for (const auto &label : category->categoriesLabels())
+      category->remove(label);
+    pool.categoryAxes.emplace_back(category);
+  } else if (auto value = qobject_cast<QtCharts::QValueAxis *>(axis)) {
+    pool.valueAxes.emplace_back(value);
+  } else if (auto log = qobject_cast<QtCharts::QLogValueAxis *>(axis)) {
+    pool.logAxes.emplace_back(log);
+  } else {
+    axis->deleteLater();
+  }
+}
+
+QtCharts::QAbstractAxis *ChartManager::takeAxis(const parser::ValueAxis &model) {
+  QtCharts::QAbstractAxis *axis;
+  if (model.scale == parser::ValueAxis::Scale::Linear)
+    axis = take(pool.valueAxes);
+  else
+    axis = take(pool.logAxes);
+
+  axis->setTitleText(QString::fromStdString(model.name));
+  axis->setRange(model.min, model.max);
+  return axis;
+}
 
 ChartManager::XYSeriesTie ChartManager::makeTie(const parser::XYSeries &model) {
   ChartManager::XYSeriesTie tie;
-  tie.model = model;
+  tie.model = &model;
+  tie.data = DecimatedSeries{maxPoints};
   switch (model.connection) {
   case parser::XYSeries::Connection::None: {
-    auto scatterSeries = new QtCharts::QScatterSeries(this);
+    auto scatterSeries = take(pool.scatterSeries);
 
     // Hide the borders of points, as they cover up other points
     scatterSeries->setBorderColor(QColor(Qt::transparent));
@@ -93,20 +225,26 @@ ChartManager::XYSeriesTie ChartManager::makeTie(const parser::XYSeries &model) {
     tie.qtSeries = scatterSeries;
   } break;
   case parser::XYSeries::Connection::Line:
-    tie.qtSeries = new QtCharts::QLineSeries(this);
+    tie.qtSeries = take(pool.lineSeries);
     break;
   case parser::XYSeries::Connection::Spline:
-    tie.qtSeries = new QtCharts::QSplineSeries(this);
+    tie.qtSeries = take(pool.splineSeries);
     break;
   }
 
-  switch (model.labelMode) {
-  case parser::XYSeries::LabelMode::Hidden:
-    tie.qtSeries->setPointLabelsVisible(false);
-    break;
-  case parser::XYSeries::LabelMode::Shown:
-    tie.qtSeries->setPointLabelsVisible(true);
-    break;
+  // Labels are drawn from `labelSeries` instead, so only a few are laid out
+  tie.qtSeries->setPointLabelsVisible(false);
+  if (model.labelMode == parser::XYSeries::LabelMode::Shown) {
+    tie.labelSeries = take(pool.scatterSeries);
+    tie.labelSeries->setColor(QColor(Qt::transparent));
+    tie.labelSeries->setBorderColor(QColor(Qt::transparent));
+    tie.labelSeries->setMarkerSize(1.0);
+    tie.labelSeries->setPointLabelsVisible(true);
+    tie.labelSeries->setName(QString::fromStdString(model.legend));
+#ifndef __APPLE__
+    // Labels are not drawn on OpenGL series, and pooled series may have been one
+    tie.labelSeries->setUseOpenGL(false);
+#endif
   }
 
   // It seems there's some difficulty with this setting on macOS,
@@ -121,70 +259,46 @@ ChartManager::XYSeriesTie ChartManager::makeTie(const parser::XYSeries &model) {
   tie.qtSeries->setColor(QColor::fromRgb(model.color.red, model.color.green, model.color.blue));
   tie.qtSeries->setName(QString::fromStdString(model.legend));
 
-  // X Axis
-  if (tie.model.xAxis.scale == parser::ValueAxis::Scale::Linear)
-    tie.xAxis = new QtCharts::QValueAxis(this);
-  else
-    tie.xAxis = new QtCharts::QLogValueAxis(this);
-
-  tie.xAxis->setTitleText(QString::fromStdString(model.xAxis.name));
-  tie.xAxis->setRange(model.xAxis.min, model.xAxis.max);
-
-  // Y Axis
-  if (tie.model.yAxis.scale == parser::ValueAxis::Scale::Linear)
-    tie.yAxis = new QtCharts::QValueAxis(this);
-  else
-    tie.yAxis = new QtCharts::QLogValueAxis(this);
-  tie.yAxis = new QtCharts::QValueAxis(this);
-  tie.yAxis->setTitleText(QString::fromStdString(model.yAxis.name));
-  tie.yAxis->setRange(model.yAxis.min, model.yAxis.max);
+  tie.xAxis = takeAxis(model.xAxis);
+  tie.yAxis = takeAxis(model.yAxis);
 
+  tie.xRange = GrowingAxis{tie.xAxis};
+  tie.yRange = GrowingAxis{tie.yAxis};
   return tie;
 }
 
 ChartManager::SeriesCollectionTie ChartManager::makeTie(const parser::SeriesCollection &model) {
   ChartManager::SeriesCollectionTie tie;
-  tie.model = model;
+  tie.model = &model;
 
-  // X Axis
-  if (tie.model.xAxis.scale == parser::ValueAxis::Scale::Linear)
-    tie.xAxis = new QtCharts::QValueAxis(this);
-  else
-    tie.xAxis = new QtCharts::QLogValueAxis(this);
-  tie.xAxis->setTitleText(QString::fromStdString(model.xAxis.name));
-  tie.xAxis->setRange(model.xAxis.min, model.xAxis.max);
-
-  // Y Axis
-  if (tie.model.yAxis.scale == parser::ValueAxis::Scale::Linear)
-    tie.yAxis = new QtCharts::QValueAxis(this);
-  else
-    tie.yAxis = new QtCharts::QLogValueAxis(this);
-  tie.yAxis = new QtCharts::QValueAxis(this);
-  tie.yAxis->setTitleText(QString::fromStdString(model.yAxis.name));
-  tie.yAxis->setRange(model.yAxis.min, model.yAxis.max);
+  tie.xAxis = takeAxis(model.xAxis);
+  tie.yAxis = takeAxis(model.yAxis);
 
+  tie.xRange = GrowingAxis{tie.xAxis};
+  tie.yRange = GrowingAxis{tie.yAxis};
   return tie;
 }
 
 ChartManager::CategoryValueTie ChartManager::makeTie(const parser::CategoryValueSeries &model) {
   CategoryValueTie tie;
-  tie.model = model;
-  tie.qtSeries = new QtCharts::QLineSeries(this);
+  tie.model = &model;
+  tie.qtSeries = take(pool.lineSeries);
 
+  tie.qtSeries->setPointLabelsVisible(false);
+#ifndef __APPLE__
+  // Pooled line series may have been used by an XY series
+  tie.qtSeries->setUseOpenGL(false);
+#endif
   tie.qtSeries->setColor(QColor::fromRgb(model.color.red, model.color.green, model.color.blue));
   tie.qtSeries->setName(QString::fromStdString(model.legend));
 
   // X Axis (values)
-  if (tie.model.xAxis.scale == parser::ValueAxis::Scale::Linear)
-    tie.xAxis = new QtCharts::QValueAxis(this);
-  else
-    tie.xAxis = new QtCharts::QLogValueAxis(this);
-  tie.xAxis->setTitleText(QString::fromStdString(model.xAxis.name));
-  tie.xAxis->setRange(model.xAxis.min, model.xAxis.max);
+  tie.xAxis = takeAxis(model.xAxis);
+  tie.xRange = GrowingAxis{tie.xAxis};
 
   // Y axis (categories)
-  auto yAxis = new QtCharts::QCategoryAxis(this);
-  const auto &categories = tie.model.yAxis.values;
+  auto yAxis = take(pool.categoryAxes);
+  const auto &categories = tie.model->yAxis.values;
 
   yAxis->setTitleText(QString::fromStdString(model.yAxis.name));
   // Just to be safe
@@ -208,10 +322,32 @@ ChartManager::CategoryValueTie ChartManager::makeTie(const parser::CategoryValue
 ChartManager::ChartManager(QWidget *parent) : QObject(parent) {
 }
 
+void ChartManager::reportMemory(MemoryReport &report) const {
+  std::size_t pointBytes = 0u;
+  std::size_t qtBytes = 0u;
+  for (const auto &tie : xyTies) {
+    pointBytes += tie.data.memoryUsage();
+    qtBytes += static_cast<std::size_t>(tie.qtSeries->count()) * sizeof(QPointF);
+    if (tie.labelSeries)
+      qtBytes += static_cast<std::size_t>(tie.labelSeries->count()) * sizeof(QPointF);
+  }
+  for (const auto &tie : categoryTies) {
+    pointBytes += static_cast<std::size_t>(tie.values.size()) * sizeof(QPointF);
+    qtBytes += static_cast<std::size_t>(tie.qtSeries->count()) * sizeof(QPointF);
+  }
+
+  report.add("Charts", "Events", containerBytes(events));
+  report.add("Charts", "Series points", pointBytes);
+  report.add("Charts", "Qt series points", qtBytes);
+}
+
 void ChartManager::reset() {
   dropdownElements.clear();
   events.clear();
-  undoEvents.clear();
+  nextEvent = 0u;
+  seriesCollections.clear();
+  autoUpdateQueue = {};
+  windows.clear();
 
   // Clear the child widgets first
   // since they may be holding on to series
@@ -219,21 +355,31 @@ void ChartManager::reset() {
     chartWidget->reset();
   }
 
-  for (auto &iterator : series) {
-    auto &value = iterator.second;
-    if (std::holds_alternative<XYSeriesTie>(value)) {
-      auto qtSeries = std::get<XYSeriesTie>(value).qtSeries;
-      qtSeries->setParent(nullptr);
-      qtSeries->deleteLater();
-    } else if (std::holds_alternative<CategoryValueTie>(value)) {
-      auto qtSeries = std::get<CategoryValueTie>(value).qtSeries;
-      qtSeries->setParent(nullptr);
-      qtSeries->deleteLater();
-    }
-    // No need to handle SeriesCollection since it has no pointers
+  // Kept for the next load, rather than deleted
+  for (auto &tie : xyTies) {
+    release(tie.qtSeries);
+    if (tie.labelSeries)
+      release(tie.labelSeries);
+    release(tie.xAxis);
+    release(tie.yAxis);
+  }
+  for (auto &tie : categoryTies) {
+    release(tie.qtSeries);
+    release(tie.xAxis);
+    release(tie.yAxis);
+  }
+  for (auto &tie : collectionTies) {
+    release(tie.xAxis);
+    release(tie.yAxis);
   }
 
-  series.clear();
+  xyTies.clear();
+  categoryTies.clear();
+  collectionTies.clear();
+  seriesSlots.clear();
+  pendingValues.clear();
+  staticModels.reset();
+  comparisonModels.clear();
 }
 
 void ChartManager::setChildrenSeries(const std::vector<DropdownValue> &values) {
@@ -242,21 +388,14 @@ void ChartManager::setChildrenSeries(const std::vector<DropdownValue> &values) {
   }
 }
 
-std::vector<unsigned int> ChartManager::inCollections(unsigned int id) {
-  std::vector<unsigned int> collections;
+const std::vector<unsigned int> &ChartManager::inCollections(unsigned int id) const {
+  static const std::vector<unsigned int> none;
 
-  for (const auto &[key, value] : series) {
-    // We're only concerned about collections
-    // so we can skip everything else
-    if (!std::holds_alternative<SeriesCollectionTie>(value))
-      continue;
+  const auto found = seriesCollections.find(id);
+  if (found == seriesCollections.end())
+    return none;
 
-    const auto &tieModel = std::get<SeriesCollectionTie>(value).model;
-    if (std::find(tieModel.series.begin(), tieModel.series.end(), id) != tieModel.series.end())
-      collections.emplace_back(tieModel.id);
-  }
-
-  return collections;
+  return found->second;
 }
 
 void ChartManager::clearSeries(const ChartWidget *except, unsigned int id) {
@@ -270,181 +409,290 @@ void ChartManager::clearSeries(const ChartWidget *except, unsigned int id) {
 }
 
 void ChartManager::timeAdvanced(parser::nanoseconds time) {
-  auto handleEvent = [time, this](auto &&e) {
-    // Strip off qualifiers, etc
-    // so T holds just the type
-    // so we can more easily match it
-    using T = std::decay_t<decltype(e)>;
-
-    if (e.time > time)
-      return false;
-
-    if constexpr (std::is_same_v<T, parser::XYSeriesAddValue>) {
-      const auto &s = std::get<XYSeriesTie>(series[e.seriesId]);
-      if (s.model.xAxis.boundMode == parser::ValueAxis::BoundMode::HighestValue) {
-        updateRange(s.xAxis, e.point.x);
-      }
-      if (s.model.yAxis.boundMode == parser::ValueAxis::BoundMode::HighestValue) {
-        updateRange(s.yAxis, e.point.y);
-      }
-      updateCollectionRanges(e.seriesId, e.point.x, e.point.y);
-      s.qtSeries->append(e.point.x, e.point.y);
-      undoEvents.emplace_back(undo::XYSeriesAddValue{e});
-      events.pop_front();
-      return true;
-    }
-
-    if constexpr (std::is_same_v<T, parser::XYSeriesAddValues>) {
-      const auto &s = std::get<XYSeriesTie>(series[e.seriesId]);
-
-      for (const auto &point : e.points) {
-        if (s.model.xAxis.boundMode == parser::ValueAxis::BoundMode::HighestValue) {
-          updateRange(s.xAxis, point.x);
-        }
-        if (s.model.yAxis.boundMode == parser::ValueAxis::BoundMode::HighestValue) {
-          updateRange(s.yAxis, point.y);
-        }
+  // The axes & Qt series are updated once all of the due events are handled
+  for (; nextEvent < events.size() && events[nextEvent].time <= time; nextEvent++) {
+    const auto &e = events[nextEvent];
+
+    // Not const since we change the lastUpdatedTime
+    auto &s = categoryTies[e.slot];
+    auto &points = pendingValues[e.slot];
+    if (points.values.isEmpty())
+      pendingCategories.emplace_back(e.slot);
+
+    s.lastUpdatedTime = time;
+    scheduleAutoUpdate(e.slot);
+    points.add(e.value, e.category);
+    points.values.append({e.value, static_cast<double>(e.category)});
+  }
+  seekXYSeries(time, true);
+  flushPending();
 
-        updateCollectionRanges(e.seriesId, point.x, point.y);
-        s.qtSeries->append(point.x, point.y);
-      }
+  autoUpdateDue(time);
+  followWindows();
+}
 
-      undoEvents.emplace_back(undo::XYSeriesAddValues{e});
-      events.pop_front();
-      return true;
-    }
+std::optional<parser::nanoseconds> ChartManager::nextEventTime() const {
+  std::optional<parser::nanoseconds> next;
+  const auto consider = [&next](parser::nanoseconds time) {
+    if (!next || time < next.value())
+      next = time;
+  };
 
-    if constexpr (std::is_same_v<T, parser::XYSeriesClear>) {
-      const auto &s = std::get<XYSeriesTie>(series[e.seriesId]);
-      auto points = s.qtSeries->pointsVector();
-      s.qtSeries->clear();
+  if (nextEvent < events.size())
+    consider(events[nextEvent].time);
 
-      undoEvents.emplace_back(undo::XYSeriesClear{e, std::move(points)});
-      events.pop_front();
-      return true;
-    }
+  // Entries made stale by a later value only end the search early
+  if (!autoUpdateQueue.empty())
+    consider(autoUpdateQueue.top().first);
 
-    if constexpr (std::is_same_v<T, parser::CategorySeriesAddValue>) {
-      // Not const since we change the lastUpdatedTime
-      auto &s = std::get<CategoryValueTie>(series[e.seriesId]);
-      if (s.model.xAxis.boundMode == parser::ValueAxis::BoundMode::HighestValue) {
-        updateRange(s.xAxis, e.value);
-      }
+  for (const auto &tie : xyTies) {
+    if (const auto time = tie.data.nextTime(); time)
+      consider(time.value());
+  }
 
-      // Y axis on category charts is a fixed size
+  return next;
+}
 
-      s.lastUpdatedTime = time;
-      s.qtSeries->append(e.value, e.category);
-      updateCollectionRanges(e.seriesId, e.value, e.category);
-      undoEvents.emplace_back(undo::CategorySeriesAddValue{e});
-      events.pop_front();
-      return true;
-    }
+void ChartManager::scheduleAutoUpdate(uint32_t slot) {
+  const auto &tie = categoryTies[slot];
+  if (tie.model->autoUpdate)
+    autoUpdateQueue.emplace(tie.lastUpdatedTime + tie.model->autoUpdateInterval, slot);
+}
 
-    // Unhandled event type
-    return false;
-  };
+void ChartManager::autoUpdateDue(parser::nanoseconds time) {
+  // Series are rescheduled after all of the due ones are handled,
+  // so a series is only updated once per call
+  std::vector<uint32_t> updated;
 
-  while (!events.empty() && std::visit(handleEvent, events.front())) {
-    // Intentionally Blank
-  }
+  while (!autoUpdateQueue.empty() && autoUpdateQueue.top().first <= time) {
+    const auto [due, slot] = autoUpdateQueue.top();
+    autoUpdateQueue.pop();
 
-  // Add "Fake Events" to keep the category value series moving
-  // TODO: Maybe move to parse time
-  for (auto &[key, s] : series) {
-    // Only CategoryValueSeries may have auto-appended values
-    if (!std::holds_alternative<CategoryValueTie>(s))
-      continue;
+    auto &value = categoryTies[slot];
 
-    auto &value = std::get<CategoryValueTie>(s);
-    if (!value.model.autoUpdate)
+    // A value was added since this entry was pushed, so there is a later one
+    if (due != value.lastUpdatedTime + value.model->autoUpdateInterval)
       continue;
 
-    const auto &points = value.qtSeries->pointsVector();
-    if (points.empty())
+    // Rescheduled once the series has a value
+    if (value.values.isEmpty())
       continue;
 
-    if (time - value.lastUpdatedTime < value.model.autoUpdateInterval)
-      continue;
-
-    const auto lastValue = points.last();
+    // Add "Fake Events" to keep the category value series moving
+    const auto lastValue = value.values.last();
     parser::CategorySeriesAddValue fakeEvent;
     fakeEvent.time = time;
-    fakeEvent.value = lastValue.x() + value.model.autoUpdateIncrement;
+    fakeEvent.value = lastValue.x() + value.model->autoUpdateIncrement;
     fakeEvent.category = static_cast<unsigned int>(lastValue.y());
-    fakeEvent.seriesId = key;
+    fakeEvent.seriesId = value.model->id;
 
-    if (value.model.xAxis.boundMode == parser::ValueAxis::BoundMode::HighestValue) {
-      updateRange(value.xAxis, fakeEvent.value);
+    if (value.model->xAxis.boundMode == parser::ValueAxis::BoundMode::HighestValue) {
+      value.xRange.grow(fakeEvent.value);
     }
 
     // Y axis on category charts is a fixed size
 
-    value.qtSeries->append(fakeEvent.value, fakeEvent.category);
+    value.values.append({fakeEvent.value, static_cast<double>(fakeEvent.category)});
+    if (value.viewers > 0)
+      value.sync();
     updateCollectionRanges(fakeEvent.seriesId, fakeEvent.value, fakeEvent.category);
-    undoEvents.emplace_back(undo::CategorySeriesAddValue{fakeEvent});
+    value.autoUpdateTimes.emplace_back(time);
 
     value.lastUpdatedTime = time;
+    updated.emplace_back(slot);
   }
+
+  for (const auto slot : updated)
+    scheduleAutoUpdate(slot);
 }
 
 void ChartManager::timeRewound(parser::nanoseconds time) {
-  auto handleUndoEvent = [time, this](auto &&e) -> bool {
-    // Strip off qualifiers, etc
-    // so T holds just the type
-    // so we can more easily match it
-    using T = std::decay_t<decltype(e)>;
+  // Make sure we don't undo an event
+  // before it was originally applied
+  for (; nextEvent > 0u && events[nextEvent - 1u].time >= time; nextEvent--) {
+    categoryTies[events[nextEvent - 1u].slot].values.removeLast();
+  }
 
-    // All events have a time
-    // Make sure we don't handle one
-    // Before it was originally applied
-    if (time > e.event.time)
-      return false;
+  // Values are only ever removed from the end of a series,
+  // and the auto-update values always come after the events at or before their time,
+  // so the order they are removed in does not matter
+  for (auto &value : categoryTies) {
+    while (!value.autoUpdateTimes.empty() && time <= value.autoUpdateTimes.back()) {
+      value.values.removeLast();
+      value.autoUpdateTimes.pop_back();
+    }
+    value.synced = std::min(value.synced, static_cast<int>(value.values.size()));
+    if (value.viewers > 0)
+      value.sync();
+  }
 
-    if constexpr (std::is_same_v<T, undo::XYSeriesAddValue>) {
-      auto &s = std::get<XYSeriesTie>(series[e.event.seriesId]);
+  seekXYSeries(time, false);
+  flushPending();
+  followWindows();
+}
 
-      s.qtSeries->remove(s.qtSeries->count() - 1);
+void ChartManager::PendingPoints::add(double x, double y) {
+  minX = std::min(minX, x);
+  maxX = std::max(maxX, x);
+  minY = std::min(minY, y);
+  maxY = std::max(maxY, y);
+}
 
-      events.emplace_front(e.event);
-      return true;
-    }
+void ChartManager::flushPending() {
+  using BoundMode = parser::ValueAxis::BoundMode;
 
-    if constexpr (std::is_same_v<T, undo::XYSeriesAddValues>) {
-      auto &s = std::get<XYSeriesTie>(series[e.event.seriesId]);
-      const auto count = e.event.points.size();
+  // Collections with a changed child, fit once after all of their children
+  std::unordered_set<uint32_t> collections;
 
-      s.qtSeries->removePoints(s.qtSeries->count() - count, count);
+  for (const auto slot : pendingXY) {
+    auto &xy = xyTies[slot];
 
-      events.emplace_front(e.event);
-      return true;
-    }
+    // XY axes are fit to the extent of the points up to now,
+    // so they shrink again on a rewind
+    const auto extent = xy.data.axisExtent();
+    if (xy.model->xAxis.boundMode == BoundMode::HighestValue)
+      xy.xRange.fit(extent ? std::optional{std::pair{extent->minX, extent->maxX}} : std::nullopt);
+    if (xy.model->yAxis.boundMode == BoundMode::HighestValue)
+      xy.yRange.fit(extent ? std::optional{std::pair{extent->minY, extent->maxY}} : std::nullopt);
+    if (xy.viewers > 0)
+      xy.show(maxLabels);
+
+    const auto &inCollection = inCollections(xy.model->id);
+    collections.insert(inCollection.begin(), inCollection.end());
+  }
 
-    if constexpr (std::is_same_v<T, undo::XYSeriesClear>) {
-      auto &s = std::get<XYSeriesTie>(series[e.event.seriesId]);
-      s.qtSeries->replace(e.points);
+  for (const auto slot : pendingCategories) {
+    auto &category = categoryTies[slot];
+    auto &points = pendingValues[slot];
 
-      events.emplace_front(e.event);
-      return true;
+    // Growing the range to the lowest & highest points
+    // matches growing it one point at a time
+    if (category.model->xAxis.boundMode == BoundMode::HighestValue) {
+      category.xRange.grow(points.minX);
+      category.xRange.grow(points.maxX);
     }
 
-    if constexpr (std::is_same_v<T, undo::CategorySeriesAddValue>) {
-      auto &s = std::get<CategoryValueTie>(series[e.event.seriesId]);
+    // Y axis on category charts is a fixed size
 
-      s.qtSeries->remove(s.qtSeries->count() - 1);
+    category.values.append(points.values);
+    if (category.viewers > 0)
+      category.sync();
+    points = {};
+  }
 
-      events.emplace_front(e.event);
-      return true;
+  for (const auto collectionId : collections) {
+    const auto collection = findCollection(collectionId);
+    if (!collection)
+      continue;
+
+    // Only XY series may belong to collections
+    std::optional<DecimatedSeries::Extent> extent;
+    for (const auto childId : collection->model->series) {
+      const auto child = findXYSeries(childId);
+      if (!child)
+        continue;
+
+      const auto childExtent = child->data.axisExtent();
+      if (!childExtent)
+        continue;
+      if (extent)
+        extent->add(childExtent.value());
+      else
+        extent = childExtent;
     }
 
-    return false;
+    if (collection->model->xAxis.boundMode == BoundMode::HighestValue)
+      collection->xRange.fit(extent ? std::optional{std::pair{extent->minX, extent->maxX}} : std::nullopt);
+    if (collection->model->yAxis.boundMode == BoundMode::HighestValue)
+      collection->yRange.fit(extent ? std::optional{std::pair{extent->minY, extent->maxY}} : std::nullopt);
+  }
+
+  pendingXY.clear();
+  pendingCategories.clear();
+}
+
+void ChartManager::followWindows() {
+  auto extent = [](const XYSeriesTie &tie, std::optional<std::pair<double, double>> &out) {
+    const auto value = tie.data.axisExtent();
+    if (!value)
+      return;
+
+    if (!out)
+      out = {value->minX, value->maxX};
+    else
+      out = {std::min(out->first, value->minX), std::max(out->second, value->maxX)};
   };
 
-  while (!undoEvents.empty() && std::visit(handleUndoEvent, undoEvents.back())) {
-    undoEvents.pop_back();
+  for (const auto seriesId : windows) {
+    std::optional<std::pair<double, double>> range;
+    GrowingAxis *axis = nullptr;
+
+    if (const auto xy = findXYSeries(seriesId)) {
+      extent(*xy, range);
+      axis = &xy->xRange;
+    } else if (const auto collection = findCollection(seriesId)) {
+      for (const auto id : collection->model->series) {
+        if (const auto child = findXYSeries(id))
+          extent(*child, range);
+      }
+      axis = &collection->xRange;
+    }
+
+    if (!axis || !range)
+      continue;
+
+    // Keep a single point off of the edge
+    auto [low, high] = range.value();
+    if (high <= low)
+      high = low + 1.0;
+    axis->show(low, high);
   }
 }
 
+void ChartManager::seekXYSeries(parser::nanoseconds time, bool inclusive) {
+  for (uint32_t slot = 0u; slot < xyTies.size(); slot++) {
+    auto &data = xyTies[slot].data;
+    const auto previousEnd = data.end();
+    const auto previousSize = data.size();
+    data.seek(time, inclusive);
+    if (data.end() == previousEnd && data.size() == previousSize)
+      continue;
+
+    // The axes are fit to the extent of the points, found from the index
+    pendingXY.emplace_back(slot);
+  }
+}
+
+void ChartManager::enqueueEvent(parser::ChartEvent &&event) {
+  // XY series events are kept in the columns of their series, rather than replayed
+  // The series of each event is looked up once, here, rather than each time it is applied
+  std::visit(
+      [this](const auto &e) {
+        using T = std::decay_t<decltype(e)>;
+
+        if constexpr (std::is_same_v<T, parser::CategorySeriesAddValue>) {
+          const auto slot = findSlot(e.seriesId, SeriesType::CategoryValue);
+          if (slot)
+            events.emplace_back(CategoryEvent{e.time, e.value, slot.value(), e.category});
+        } else {
+          const auto xy = findXYSeries(e.seriesId);
+          if (!xy)
+            return;
+
+          auto &data = xy->data;
+          if constexpr (std::is_same_v<T, parser::XYSeriesAddValue>) {
+            data.add(e.time, {e.point.x, e.point.y});
+          } else if constexpr (std::is_same_v<T, parser::XYSeriesAddValues>) {
+            for (const auto &point : e.points)
+              data.add(e.time, {point.x, point.y});
+          } else {
+            data.addClear(e.time);
+          }
+        }
+      },
+      event);
+}
+
 void ChartManager::spawnWidget(QMainWindow *parent) {
   auto newWidget = new ChartWidget{parent, *this, dropdownElements};
   parent->addDockWidget(Qt::RightDockWidgetArea, newWidget);
@@ -452,6 +700,23 @@ void ChartManager::spawnWidget(QMainWindow *parent) {
   chartWidgets.emplace_back(newWidget);
 }
 
+std::vector<unsigned int> ChartManager::getOpenSeries() const {
+  std::vector<unsigned int> seriesIds;
+  seriesIds.reserve(chartWidgets.size());
+  for (const auto widget : chartWidgets)
+    seriesIds.emplace_back(widget->getCurrentSeries());
+
+  return seriesIds;
+}
+
+void ChartManager::openCharts(QMainWindow *parent, const std::vector<unsigned int> &seriesIds) {
+  clearWidgets();
+  for (const auto seriesId : seriesIds) {
+    spawnWidget(parent);
+    chartWidgets.back()->selectSeries(seriesId);
+  }
+}
+
 void ChartManager::clearWidgets() {
   for (auto widget : chartWidgets) {
     widget->close();
@@ -467,33 +732,39 @@ void ChartManager::widgetClosed(ChartWidget *widget) {
 }
 
 void ChartManager::updateCollectionRanges(uint32_t seriesId, double x, double y) {
-  for (auto &iterator : series) {
-    // Only update collections
-    if (!std::holds_alternative<ChartManager::SeriesCollectionTie>(iterator.second))
+  for (const auto collectionId : inCollections(seriesId)) {
+    const auto collection = findCollection(collectionId);
+    if (!collection)
       continue;
 
-    auto &collection = std::get<ChartManager::SeriesCollectionTie>(iterator.second);
-
-    // Only update the collection's ranges if it actually contains the series
-    if (std::find(collection.model.series.begin(), collection.model.series.end(), seriesId) !=
-        collection.model.series.end()) {
-      if (collection.model.xAxis.boundMode == parser::ValueAxis::BoundMode::HighestValue)
-        updateRange(collection.xAxis, x);
-      if (collection.model.yAxis.boundMode == parser::ValueAxis::BoundMode::HighestValue)
-        updateRange(collection.yAxis, y);
-    }
+    if (collection->model->xAxis.boundMode == parser::ValueAxis::BoundMode::HighestValue)
+      collection->xRange.grow(x);
+    if (collection->model->yAxis.boundMode == parser::ValueAxis::BoundMode::HighestValue)
+      collection->yRange.grow(y);
   }
 }
 
-ChartManager::TieVariant &ChartManager::getSeries(uint32_t seriesId) {
-  const auto &seriesIterator = series.find(seriesId);
-  if (seriesIterator == series.end()) {
-    QMessageBox::critical(qobject_cast<QMainWindow *>(parent()), "Series not found",
-                          "The selected series was not found");
-    std::abort();
-  }
+std::optional<uint32_t> ChartManager::findSlot(uint32_t id, SeriesType type) const {
+  const auto found = seriesSlots.find(id);
+  if (found == seriesSlots.end() || found->second.type != type)
+    return {};
+
+  return found->second.index;
+}
+
+ChartManager::XYSeriesTie *ChartManager::findXYSeries(uint32_t seriesId) {
+  const auto slot = findSlot(seriesId, SeriesType::XY);
+  return slot ? &xyTies[slot.value()] : nullptr;
+}
 
-  return seriesIterator->second;
+ChartManager::CategoryValueTie *ChartManager::findCategorySeries(uint32_t seriesId) {
+  const auto slot = findSlot(seriesId, SeriesType::CategoryValue);
+  return slot ? &categoryTies[slot.value()] : nullptr;
+}
+
+ChartManager::SeriesCollectionTie *ChartManager::findCollection(uint32_t seriesId) {
+  const auto slot = findSlot(seriesId, SeriesType::Collection);
+  return slot ? &collectionTies[slot.value()] : nullptr;
 }
 
 void ChartManager::seriesSelected(const ChartWidget *widget, unsigned int selected) {
@@ -503,52 +774,187 @@ void ChartManager::seriesSelected(const ChartWidget *widget, unsigned int select
   clearSeries(widget, selected);
 
   // If a collection was selected, clear the child series
-  const auto &tie = series[selected];
-  if (std::holds_alternative<SeriesCollectionTie>(tie)) {
-    const auto &tieValue = std::get<SeriesCollectionTie>(tie);
-
-    for (const auto seriesId : tieValue.model.series)
+  if (const auto collection = findCollection(selected)) {
+    for (const auto seriesId : collection->model->series)
       clearSeries(widget, seriesId);
-  } else if (std::holds_alternative<XYSeriesTie>(tie)) {
+  } else if (findXYSeries(selected)) {
     // Clear all the collections this series belongs to as well
     // Only XYSeries may belong to collections
-    const auto &tieModel = std::get<XYSeriesTie>(tie).model;
-    const auto collections = inCollections(tieModel.id);
-    for (const auto id : collections)
+    for (const auto id : inCollections(selected))
       clearSeries(widget, id);
   }
 }
 
+void ChartManager::changeViewers(unsigned int id, int change) {
+  if (const auto collection = findCollection(id)) {
+    for (const auto seriesId : collection->model->series)
+      changeViewers(seriesId, change);
+  } else if (const auto xy = findXYSeries(id)) {
+    xy->viewers += change;
+    if (xy->viewers > 0)
+      xy->show(maxLabels);
+    else
+      xy->hide();
+  } else if (const auto category = findCategorySeries(id)) {
+    category->viewers += change;
+    if (category->viewers > 0) {
+      category->sync();
+    } else {
+      category->qtSeries->clear();
+      category->synced = 0;
+    }
+  }
+}
+
+void ChartManager::seriesShown(unsigned int seriesId) {
+  changeViewers(seriesId, 1);
+}
+
+void ChartManager::seriesHidden(unsigned int seriesId) {
+  changeViewers(seriesId, -1);
+}
+
+void ChartManager::setVisibleRange(unsigned int seriesId, std::optional<std::pair<double, double>> range) {
+  auto setRange = [this, range](XYSeriesTie &tie) {
+    tie.data.setVisibleRange(range);
+    if (tie.viewers > 0)
+      tie.show(maxLabels);
+  };
+
+  if (const auto xy = findXYSeries(seriesId)) {
+    setRange(*xy);
+  } else if (const auto collection = findCollection(seriesId)) {
+    for (const auto id : collection->model->series) {
+      if (const auto child = findXYSeries(id))
+        setRange(*child);
+    }
+  }
+  // Category value series are not decimated
+}
+
+void ChartManager::setWindow(unsigned int seriesId, std::optional<parser::nanoseconds> window) {
+  auto setSeriesWindow = [this, window](XYSeriesTie &tie) {
+    tie.data.setWindow(window);
+    if (tie.viewers > 0)
+      tie.show(maxLabels);
+  };
+
+  if (const auto xy = findXYSeries(seriesId)) {
+    setSeriesWindow(*xy);
+    if (!window)
+      xy->xRange.restore();
+  } else if (const auto collection = findCollection(seriesId)) {
+    for (const auto id : collection->model->series) {
+      if (const auto child = findXYSeries(id))
+        setSeriesWindow(*child);
+    }
+    if (!window)
+      collection->xRange.restore();
+  } else {
+    // Category value series have values, rather than times, on their X axis.
+    // Unknown IDs have nothing to window either
+    return;
+  }
+
+  if (window)
+    windows.insert(seriesId);
+  else
+    windows.erase(seriesId);
+  followWindows();
+}
+
 void ChartManager::timeChanged(parser::nanoseconds time, parser::nanoseconds increment) {
+  parser::trace::Scope trace{"ChartManager::timeChanged", "ui"};
+  currentTime = time;
   if (increment > 0LL)
     timeAdvanced(time);
   else
     timeRewound(time);
+
+  for (auto widget : chartWidgets)
+    widget->seriesUpdated();
+}
+
+parser::nanoseconds ChartManager::getCurrentTime() const {
+  return currentTime;
+}
+
+std::vector<parser::SeriesColumns> ChartManager::seriesColumns(unsigned int seriesId) const {
+  std::vector<parser::SeriesColumns> columns;
+  auto addXY = [&columns](const XYSeriesTie &tie) {
+    parser::SeriesColumns out{tie.model->id, tie.model->name, false, tie.data.dataTimes(), {}, {}};
+    const auto &points = tie.data.data();
+    out.x.reserve(points.size());
+    out.y.reserve(points.size());
+    for (const auto &point : points) {
+      out.x.emplace_back(point.x());
+      out.y.emplace_back(point.y());
+    }
+    columns.emplace_back(std::move(out));
+  };
+
+  if (const auto xy = findSlot(seriesId, SeriesType::XY)) {
+    addXY(xyTies[xy.value()]);
+  } else if (const auto collection = findSlot(seriesId, SeriesType::Collection)) {
+    for (const auto id : collectionTies[collection.value()].model->series) {
+      if (const auto child = findSlot(id, SeriesType::XY))
+        addXY(xyTies[child.value()]);
+    }
+  } else if (const auto category = findSlot(seriesId, SeriesType::CategoryValue)) {
+    const auto &model = *categoryTies[category.value()].model;
+    parser::SeriesColumns out{model.id, model.name, true, {}, {}, {}};
+    for (const auto &event : events) {
+      if (event.slot != category.value())
+        continue;
+
+      out.times.emplace_back(event.time);
+      out.x.emplace_back(event.value);
+      out.y.emplace_back(static_cast<double>(event.category));
+    }
+    columns.emplace_back(std::move(out));
+  }
+
+  return columns;
 }
 
 void ChartManager::enqueueEvents(const std::vector<parser::ChartEvent> &e) {
-  events.insert(events.end(), e.begin(), e.end());
+  for (auto event : e)
+    enqueueEvent(std::move(event));
+}
+
+void ChartManager::enqueueEvents(std::vector<parser::ChartEvent> &&e) {
+  for (auto &event : e)
+    enqueueEvent(std::move(event));
+  e.clear();
+}
+void ChartManager::addSeries(std::shared_ptr<const parser::StaticModels> models) {
+  staticModels = std::move(models);
+  addTies(*staticModels);
 }
-void ChartManager::addSeries(const std::vector<parser::XYSeries> &xySeries,
-                             const std::vector<parser::SeriesCollection> &collections,
-                             const std::vector<parser::CategoryValueSeries> &categoryValueSeries) {
 
-  for (const auto &collection : collections) {
-    series.emplace(collection.id, makeTie(collection));
+void ChartManager::addTies(const parser::StaticModels &models) {
+  for (const auto &collection : models.seriesCollections) {
+    seriesSlots.emplace(collection.id,
+                        SeriesSlot{SeriesType::Collection, static_cast<uint32_t>(collectionTies.size())});
+    collectionTies.emplace_back(makeTie(collection));
+    for (const auto seriesId : collection.series)
+      seriesCollections[seriesId].emplace_back(collection.id);
     dropdownElements.emplace_back(
         DropdownValue{QString::fromStdString(collection.name), SeriesType::Collection, collection.id});
   }
 
-  for (const auto &xy : xySeries) {
-    series.emplace(xy.id, makeTie(xy));
+  for (const auto &xy : models.xySeries) {
+    seriesSlots.emplace(xy.id, SeriesSlot{SeriesType::XY, static_cast<uint32_t>(xyTies.size())});
+    xyTies.emplace_back(makeTie(xy));
 
     if (xy.visible) {
       dropdownElements.emplace_back(DropdownValue{QString::fromStdString(xy.name), SeriesType::XY, xy.id});
     }
   }
 
-  for (const auto &category : categoryValueSeries) {
-    series.emplace(category.id, makeTie(category));
+  for (const auto &category : models.categoryValueSeries) {
+    seriesSlots.emplace(category.id, SeriesSlot{SeriesType::CategoryValue, static_cast<uint32_t>(categoryTies.size())});
+    categoryTies.emplace_back(makeTie(category));
 
     if (category.visible) {
       dropdownElements.emplace_back(
@@ -556,8 +962,66 @@ void ChartManager::addSeries(const std::vector<parser::XYSeries> &xySeries,
     }
   }
 
+  pendingValues.resize(categoryTies.size());
   setChildrenSeries(dropdownElements);
 }
+
+void ChartManager::addComparison(const parser::StaticModels &models, std::vector<parser::ChartEvent> &&e,
+                                 const QString &label) {
+  // Past every ID in use, including those of earlier comparisons
+  uint32_t offset = 1u;
+  for (const auto &[id, slot] : seriesSlots)
+    offset = std::max(offset, id + 1u);
+
+  const auto suffix = " [" + label.toStdString() + "]";
+  auto renamed = std::make_shared<parser::StaticModels>();
+  renamed->xySeries = models.xySeries;
+  renamed->categoryValueSeries = models.categoryValueSeries;
+  renamed->seriesCollections = models.seriesCollections;
+  for (auto &xy : renamed->xySeries) {
+    xy.id += offset;
+    xy.name += suffix;
+  }
+  for (auto &category : renamed->categoryValueSeries) {
+    category.id += offset;
+    category.name += suffix;
+  }
+  for (auto &collection : renamed->seriesCollections) {
+    collection.id += offset;
+    collection.name += suffix;
+    for (auto &seriesId : collection.series)
+      seriesId += offset;
+  }
+
+  addTies(*renamed);
+  comparisonModels.emplace_back(std::move(renamed));
+
+  // The category events must stay in time order, so the charts are emptied,
+  // the new events are merged in, then the charts are filled back up to the current time
+  const auto time = currentTime;
+  timeRewound(0LL);
+
+  const auto existing = static_cast<std::ptrdiff_t>(events.size());
+  for (auto &event : e) {
+    std::visit(
+        [offset](auto &value) {
+          value.seriesId += offset;
+        },
+        event);
+    enqueueEvent(std::move(event));
+  }
+  e.clear();
+
+  std::inplace_merge(events.begin(), events.begin() + existing, events.end(),
+                     [](const CategoryEvent &left, const CategoryEvent &right) {
+                       return left.time < right.time;
+                     });
+  timeAdvanced(time);
+
+  for (auto widget : chartWidgets)
+    widget->seriesUpdated();
+}
+
 void ChartManager::setSortOrder(SettingsManager::ChartDropdownSortOrder value) {
   sortOrder = value;
   for (const auto widget : chartWidgets) {
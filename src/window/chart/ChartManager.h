@@ -32,26 +32,42 @@
  */
 
 #pragma once
-#include "src/util/undo-events.h"
+#include "../../util/memory-report.h"
+#include "DecimatedSeries.h"
 #include <QComboBox>
 #include <QFrame>
 #include <QGraphicsItem>
 #include <QLayout>
+#include <QList>
 #include <QMainWindow>
 #include <QObject>
+#include <QPointF>
 #include <QString>
 #include <QtCharts/QAbstractAxis>
 #include <QtCharts/QCategoryAxis>
 #include <QtCharts/QChartView>
 #include <QtCharts/QLineSeries>
+#include <QtCharts/QLogValueAxis>
+#include <QtCharts/QScatterSeries>
+#include <QtCharts/QSplineSeries>
 #include <QtCharts/QValueAxis>
+#include <QVector>
+#include <cstddef>
 #include <cstdint>
 #include <deque>
+#include <functional>
+#include <limits>
+#include <memory>
 #include <model.h>
 #include <optional>
+#include <queue>
+#include <series-stats.h>
 #include <src/settings/SettingsManager.h>
 #include <unordered_map>
+#include <unordered_set>
+#include <utility>
 #include <variant>
+#include <vector>
 
 namespace netsimulyzer {
 
@@ -63,25 +79,176 @@ class ChartManager : public QObject {
 public:
   enum class SeriesType : int { XY, CategoryValue, Collection };
 
+  /**
+   * A value axis which grows to fit the values added to it.
+   * The typed axis & the range it has grown to are kept,
+   * so growing it needs no cast, nor a read from the axis.
+   *
+   * Zooming a chart does not change the range tracked here,
+   * so the zoom is only changed by values past all of the earlier ones
+   */
+  struct GrowingAxis {
+    QtCharts::QValueAxis *valueAxis{nullptr};
+    QtCharts::QLogValueAxis *logAxis{nullptr};
+    qreal min{0.0};
+    qreal max{0.0};
+
+    /**
+     * The range the axis was created with, which `fit()` never shrinks past
+     */
+    qreal initialMin{0.0};
+    qreal initialMax{0.0};
+
+    GrowingAxis() = default;
+
+    /**
+     * @param axis
+     * The axis to grow, with its initial range set.
+     * Must be a `QValueAxis` or `QLogValueAxis`
+     */
+    explicit GrowingAxis(QtCharts::QAbstractAxis *axis);
+
+    /**
+     * Extend the axis slightly past `value`, if it is outside the current range
+     *
+     * @param value
+     * The value to fit on the axis
+     */
+    void grow(qreal value);
+
+    /**
+     * Set the range to the one `grow()` would reach from the initial range
+     * with only the values in `extent`. Unlike `grow()`, this shrinks the axis
+     * after a rewind. The axis is left alone if the range did not change,
+     * so the zoom is kept
+     *
+     * @param extent
+     * The lowest & highest values to fit,
+     * or an empty optional for the initial range
+     */
+    void fit(std::optional<std::pair<qreal, qreal>> extent);
+
+    /**
+     * Show a range on the axis, without changing the range it has grown to.
+     * Values growing the axis past its range replace the shown range
+     *
+     * @param low
+     * The lowest value to show
+     *
+     * @param high
+     * The highest value to show
+     */
+    void show(qreal low, qreal high);
+
+    /**
+     * Show the range the axis has grown to again, after `show()`
+     */
+    void restore();
+  };
+
   struct SeriesCollectionTie {
-    parser::SeriesCollection model;
+    /**
+     * The description of the series, in `ChartManager::staticModels`
+     */
+    const parser::SeriesCollection *model{nullptr};
     QtCharts::QAbstractAxis *xAxis;
     QtCharts::QAbstractAxis *yAxis;
+    GrowingAxis xRange;
+    GrowingAxis yRange;
   };
 
   struct XYSeriesTie {
-    parser::XYSeries model;
+    /**
+     * The description of the series, in `ChartManager::staticModels`
+     */
+    const parser::XYSeries *model{nullptr};
+
+    /**
+     * Shows a decimated view of `data`, never more than `ChartManager::maxPoints`.
+     * Empty while no `ChartWidget` shows the series
+     */
     QtCharts::QXYSeries *qtSeries;
+
+    /**
+     * Carries the point labels, for series with them shown.
+     * QtCharts lays out a label for every point on a series,
+     * so this only holds a few of the points on `qtSeries`, see `show()`.
+     * Its markers are transparent, and it is left off the legend
+     */
+    QtCharts::QScatterSeries *labelSeries{nullptr};
+
     QtCharts::QAbstractAxis *xAxis;
     QtCharts::QAbstractAxis *yAxis;
+    GrowingAxis xRange;
+    GrowingAxis yRange;
+
+    /**
+     * Every point on the series, at full resolution
+     */
+    DecimatedSeries data;
+
+    /**
+     * The number of `ChartWidget`s showing the series
+     */
+    int viewers{0};
+
+    /**
+     * Update `qtSeries` to the current view of `data`, and `labelSeries` with it.
+     * Every point in view is labelled if there are at most `maxLabels`,
+     * otherwise only the lowest & highest of evenly sized buckets of them
+     *
+     * @param maxLabels
+     * The most points to label
+     */
+    void show(int maxLabels);
+
+    /**
+     * Empty `qtSeries` & `labelSeries`, while no `ChartWidget` shows them
+     */
+    void hide();
   };
 
   struct CategoryValueTie {
-    parser::CategoryValueSeries model;
+    /**
+     * The description of the series, in `ChartManager::staticModels`
+     */
+    const parser::CategoryValueSeries *model{nullptr};
+
+    /**
+     * Shows `values`. Empty while no `ChartWidget` shows the series
+     */
     QtCharts::QXYSeries *qtSeries;
     QtCharts::QAbstractAxis *xAxis;
     QtCharts::QCategoryAxis *yAxis;
+    GrowingAxis xRange;
     parser::nanoseconds lastUpdatedTime;
+
+    /**
+     * The times of the values appended to keep an `autoUpdate` series moving.
+     * These have no event, so they are removed by time when rewinding
+     */
+    std::vector<parser::nanoseconds> autoUpdateTimes;
+
+    /**
+     * Every value on the series, including the auto-update values
+     */
+    QList<QPointF> values;
+
+    /**
+     * The number of values from the start of `values` which are on `qtSeries`, as they are
+     */
+    int synced{0};
+
+    /**
+     * The number of `ChartWidget`s showing the series
+     */
+    int viewers{0};
+
+    /**
+     * Bring `qtSeries` up to date with `values`,
+     * sending only the values changed since the last call
+     */
+    void sync();
   };
 
   struct DropdownValue {
@@ -90,30 +257,269 @@ public:
     unsigned int id;
   };
 
-  using TieVariant = std::variant<SeriesCollectionTie, XYSeriesTie, CategoryValueTie>;
-
   const static unsigned int PlaceholderId{0u};
 
 private:
   SettingsManager settings;
-  std::deque<parser::ChartEvent> events;
-  std::deque<undo::ChartUndoEvent> undoEvents;
 
-  std::unordered_map<uint32_t, TieVariant> series;
+  /**
+   * Where the tie of a series or collection is kept, see `seriesSlots`
+   */
+  struct SeriesSlot {
+    SeriesType type;
+
+    /**
+     * Index into the ties of `type`
+     */
+    uint32_t index;
+  };
+
+  /**
+   * A category value, with its series resolved to a slot in `categoryTies`
+   * once, when it is enqueued
+   */
+  struct CategoryEvent {
+    parser::nanoseconds time;
+    double value;
+    uint32_t slot;
+    unsigned int category;
+  };
+
+  /**
+   * Every chart event, in time order, except for those of XY series,
+   * which are kept in the columns of their `DecimatedSeries`.
+   * That leaves only category values, so they are stored as that one type,
+   * and applied without matching the kind of each event.
+   * Events are not removed as they are applied, see `nextEvent`
+   */
+  std::deque<CategoryEvent> events;
+
+  /**
+   * Index in `events` of the first event which has not been applied
+   */
+  std::size_t nextEvent{0u};
+
+  /**
+   * The time from the last `timeChanged()`
+   */
+  parser::nanoseconds currentTime{0LL};
+
+  /**
+   * The ties of each kind, in the order they were added, addressed by slot.
+   * Deques, so the ties `ChartWidget`s point into stay put as comparisons are added
+   */
+  std::deque<XYSeriesTie> xyTies;
+  std::deque<CategoryValueTie> categoryTies;
+  std::deque<SeriesCollectionTie> collectionTies;
+
+  /**
+   * The slot of each series & collection, by ID. Built by `addTies()`
+   */
+  std::unordered_map<uint32_t, SeriesSlot> seriesSlots;
+
+  /**
+   * The time an `autoUpdate` series is next due an auto-update value, & its slot.
+   * Soonest first, so time advancing with no series due costs constant time.
+   *
+   * A series is pushed again each time one of its values is added,
+   * rather than moving its earlier entry, so entries which no longer match
+   * the series' `lastUpdatedTime` are skipped, see `autoUpdateDue()`
+   */
+  std::priority_queue<std::pair<parser::nanoseconds, uint32_t>, std::vector<std::pair<parser::nanoseconds, uint32_t>>,
+                      std::greater<>>
+      autoUpdateQueue;
+
+  /**
+   * The descriptions referenced by each tie
+   */
+  std::shared_ptr<const parser::StaticModels> staticModels;
+
+  /**
+   * The renamed series of each run added with `addComparison()`,
+   * referenced by their ties
+   */
+  std::vector<std::shared_ptr<const parser::StaticModels>> comparisonModels;
+
+  /**
+   * The IDs of the collections each series is in, by series ID.
+   * Built by `addSeries()`
+   */
+  std::unordered_map<uint32_t, std::vector<unsigned int>> seriesCollections;
+
+  /**
+   * The points added to a series during one `timeAdvanced()`/`timeRewound()` call
+   */
+  struct PendingPoints {
+    /**
+     * Values for a category value series, appended to its `values` all at once.
+     * XY series are sliced from their columns instead, see `seekXYSeries()`
+     */
+    QList<QPointF> values;
+
+    double minX{std::numeric_limits<double>::max()};
+    double maxX{std::numeric_limits<double>::lowest()};
+    double minY{std::numeric_limits<double>::max()};
+    double maxY{std::numeric_limits<double>::lowest()};
+
+    void add(double x, double y);
+  };
+
+  /**
+   * The values added to each category value series by the current `timeAdvanced()` call, by slot.
+   * Their Qt series & axes are updated once after all of the events, see `flushPending()`
+   */
+  std::vector<PendingPoints> pendingValues;
+
+  /**
+   * The slots in `pendingValues` with values added
+   */
+  std::vector<uint32_t> pendingCategories;
+
+  /**
+   * The slots of the XY series moved by the current `timeAdvanced()`/`timeRewound()` call
+   */
+  std::vector<uint32_t> pendingXY;
+
+  /**
+   * The IDs of the series & collections shown with a window, see `setWindow()`.
+   * Their X axes follow the points in the window, see `followWindows()`
+   */
+  std::unordered_set<uint32_t> windows;
+
+  /**
+   * The most points shown on each XY series
+   */
+  int maxPoints{settings.get<int>(SettingsManager::Key::ChartMaxPoints).value()};
+
+  /**
+   * The most point labels shown on each XY series
+   */
+  int maxLabels{settings.get<int>(SettingsManager::Key::ChartMaxPointLabels).value()};
   SettingsManager::ChartDropdownSortOrder sortOrder{
       settings.get<SettingsManager::ChartDropdownSortOrder>(SettingsManager::Key::ChartDropdownSortOrder).value()};
   std::vector<DropdownValue> dropdownElements;
   std::vector<ChartWidget *> chartWidgets;
 
+  /**
+   * Qt series & axes from earlier loads, by type, configured again for the next load,
+   * rather than built anew. Owned by the manager
+   */
+  struct ObjectPool {
+    std::vector<QtCharts::QScatterSeries *> scatterSeries;
+    std::vector<QtCharts::QLineSeries *> lineSeries;
+    std::vector<QtCharts::QSplineSeries *> splineSeries;
+    std::vector<QtCharts::QValueAxis *> valueAxes;
+    std::vector<QtCharts::QLogValueAxis *> logAxes;
+    std::vector<QtCharts::QCategoryAxis *> categoryAxes;
+  };
+  ObjectPool pool;
+
+  /**
+   * Take an object of type `T` from `pooled`, or build a new one if it is empty
+   */
+  template <class T>
+  T *take(std::vector<T *> &pooled);
+
+  /**
+   * Clear the points of `series`, and return it to `pool`.
+   * Must no longer be on a chart
+   */
+  void release(QtCharts::QXYSeries *series);
+
+  /**
+   * Clear the categories of `axis`, and return it to `pool`.
+   * Must no longer be on a chart
+   */
+  void release(QtCharts::QAbstractAxis *axis);
+
+  /**
+   * @return
+   * An axis for `model`, from `pool` if one is there, titled & ranged for it
+   */
+  QtCharts::QAbstractAxis *takeAxis(const parser::ValueAxis &model);
+
   XYSeriesTie makeTie(const parser::XYSeries &model);
   SeriesCollectionTie makeTie(const parser::SeriesCollection &model);
   CategoryValueTie makeTie(const parser::CategoryValueSeries &model);
   void updateCollectionRanges(uint32_t seriesId, double x, double y);
+
+  /**
+   * @param id
+   * The ID of a series or collection
+   *
+   * @param type
+   * The kind of tie expected
+   *
+   * @return
+   * The slot of the tie identified by `id`,
+   * or an empty optional if there is none of `type`
+   */
+  [[nodiscard]] std::optional<uint32_t> findSlot(uint32_t id, SeriesType type) const;
+
+  /**
+   * Schedule the next auto-update value of a category value series, from its `lastUpdatedTime`.
+   * Does nothing if it does not auto-update
+   *
+   * @param slot
+   * The slot in `categoryTies` of the series which had a value added
+   */
+  void scheduleAutoUpdate(uint32_t slot);
+
+  /**
+   * Append the auto-update values due by `time`
+   *
+   * @param time
+   * The current time
+   */
+  void autoUpdateDue(parser::nanoseconds time);
+
+  /**
+   * Add or remove a viewer of the XY or category value series identified by `id`,
+   * or of each series in the collection identified by `id`
+   *
+   * @param id
+   * The ID of the series or collection
+   *
+   * @param change
+   * 1 for a new viewer, -1 for one which has gone
+   */
+  void changeViewers(unsigned int id, int change);
+
+  /**
+   * Update the Qt series & axes of each series in `pendingCategories` & `pendingXY`, then clear them
+   */
+  void flushPending();
   void setChildrenSeries(const std::vector<DropdownValue> &values);
 
+  /**
+   * Fit the X axis of each series or collection in `windows`
+   * to the points in the window
+   */
+  void followWindows();
+
+  /**
+   * Put every XY series at `time`, from its columns, see `DecimatedSeries::seek()`
+   *
+   * @param time
+   * The current time
+   *
+   * @param inclusive
+   * True to include the points & clears at exactly `time`,
+   * as when time advances
+   */
+  void seekXYSeries(parser::nanoseconds time, bool inclusive);
+
+  /**
+   * Add an event to the columns of its XY series, or to `events`
+   *
+   * @param event
+   * The event to add
+   */
+  void enqueueEvent(parser::ChartEvent &&event);
+
   /**
    * Finds all the collections the series
-   * identified by `id` belongs to
+   * identified by `id` belongs to, from `seriesCollections`
    *
    * @param id
    * The ID of the series to search collections for
@@ -121,7 +527,7 @@ private:
    * @return
    * The IDs of all the collections `id` is in
    */
-  std::vector<unsigned int> inCollections(unsigned int id);
+  [[nodiscard]] const std::vector<unsigned int> &inCollections(unsigned int id) const;
 
   /**
    * Clear the series identified by `id` from
@@ -138,6 +544,14 @@ private:
   void timeAdvanced(parser::nanoseconds time);
   void timeRewound(parser::nanoseconds time);
 
+  /**
+   * Add a tie & dropdown entry for every series in `models`
+   *
+   * @param models
+   * Series descriptions which outlive their ties
+   */
+  void addTies(const parser::StaticModels &models);
+
 public:
   explicit ChartManager(QWidget *parent);
 
@@ -147,6 +561,41 @@ public:
   void reset();
   void spawnWidget(QMainWindow *parent);
 
+  /**
+   * @return
+   * The series selected in each open `ChartWidget`, in the order they were opened.
+   * `PlaceholderId` for a widget with no series selected
+   */
+  [[nodiscard]] std::vector<unsigned int> getOpenSeries() const;
+
+  /**
+   * Replace the open `ChartWidget`s with one for each of `seriesIds`
+   *
+   * @param parent
+   * The window to dock the widgets in
+   *
+   * @param seriesIds
+   * The series to select in each new widget, as from `getOpenSeries()`
+   */
+  void openCharts(QMainWindow *parent, const std::vector<unsigned int> &seriesIds);
+
+  /**
+   * Add the memory held by the chart events, the series' points,
+   * & the points currently on Qt series
+   *
+   * @param report
+   * The report to add to
+   */
+  void reportMemory(MemoryReport &report) const;
+
+  /**
+   * @return
+   * The time of the next change to any series after the current time,
+   * from an event, an XY series point or clear, or an auto-update.
+   * Unset if no series changes again
+   */
+  [[nodiscard]] std::optional<parser::nanoseconds> nextEventTime() const;
+
   /**
    * Remove all child `ChartWidget`s
    */
@@ -160,14 +609,121 @@ public:
    * The child widget that is closing
    */
   void widgetClosed(ChartWidget *widget);
-  void addSeries(const std::vector<parser::XYSeries> &xySeries,
-                 const std::vector<parser::SeriesCollection> &collections,
-                 const std::vector<parser::CategoryValueSeries> &categoryValueSeries);
-  TieVariant &getSeries(uint32_t seriesId);
+  /**
+   * Add every series in `models`
+   *
+   * @param models
+   * The models of the scenario, shared with the other widgets.
+   * Kept until `reset()`, the series reference their descriptions in it
+   */
+  void addSeries(std::shared_ptr<const parser::StaticModels> models);
+
+  /**
+   * Add the series of another run of the scenario, alongside those from `addSeries()`,
+   * so both runs may be charted at the same time.
+   * Each series is given a new ID past every existing one, and `label` after its name.
+   * The events are merged in with the existing ones,
+   * and the charts are brought back to the current time
+   *
+   * @param models
+   * The series of the other run. Only the series are kept
+   *
+   * @param e
+   * The chart events of the other run
+   *
+   * @param label
+   * Tells the series of the other run apart
+   */
+  void addComparison(const parser::StaticModels &models, std::vector<parser::ChartEvent> &&e, const QString &label);
+
+  /**
+   * @return
+   * The XY series identified by `seriesId`,
+   * or nullptr if `seriesId` is not an XY series
+   */
+  XYSeriesTie *findXYSeries(uint32_t seriesId);
+
+  /**
+   * @return
+   * The category value series identified by `seriesId`,
+   * or nullptr if `seriesId` is not a category value series
+   */
+  CategoryValueTie *findCategorySeries(uint32_t seriesId);
+
+  /**
+   * @return
+   * The collection identified by `seriesId`,
+   * or nullptr if `seriesId` is not a collection
+   */
+  SeriesCollectionTie *findCollection(uint32_t seriesId);
 
   void seriesSelected(const ChartWidget *widget, unsigned int selected);
+
+  /**
+   * Signals a widget is showing a series or collection.
+   * Puts the current points on its Qt series, which are kept up to date until it is hidden
+   *
+   * @param seriesId
+   * The ID of the series or collection now on screen
+   */
+  void seriesShown(unsigned int seriesId);
+
+  /**
+   * Signals a widget is no longer showing a series or collection.
+   * Once no widget shows it, its Qt series are emptied and no longer updated
+   *
+   * @param seriesId
+   * The ID of the series or collection no longer on screen
+   */
+  void seriesHidden(unsigned int seriesId);
+
+  /**
+   * Show only the points of a series within a range of X values,
+   * decimated from its full resolution points.
+   * For a collection, this applies to every XY series in it
+   *
+   * @param seriesId
+   * The ID of the XY series or collection
+   *
+   * @param range
+   * The lowest & highest visible X values,
+   * or an empty optional to show the whole series
+   */
+  void setVisibleRange(unsigned int seriesId, std::optional<std::pair<double, double>> range);
+
+  /**
+   * Show only the recent points of a series, newer than `window` before the current time,
+   * with an X axis which follows them.
+   * For a collection, this applies to every XY series in it
+   *
+   * @param seriesId
+   * The ID of the XY series or collection
+   *
+   * @param window
+   * The length of the window, or an empty optional to show every point again
+   */
+  void setWindow(unsigned int seriesId, std::optional<parser::nanoseconds> window);
   void timeChanged(parser::nanoseconds time, parser::nanoseconds increment);
+
+  /**
+   * @return
+   * The time the series are shown at
+   */
+  [[nodiscard]] parser::nanoseconds getCurrentTime() const;
+
+  /**
+   * Copy every point of a series into columns, for statistics & export.
+   * Auto-update values are left out, as they are only shown
+   *
+   * @param seriesId
+   * The ID of an XY series, category value series, or collection
+   *
+   * @return
+   * The columns of the series, or of each XY series in the collection
+   */
+  [[nodiscard]] std::vector<parser::SeriesColumns> seriesColumns(unsigned int seriesId) const;
   void enqueueEvents(const std::vector<parser::ChartEvent> &e);
+  void enqueueEvents(std::vector<parser::ChartEvent> &&e);
   void setSortOrder(SettingsManager::ChartDropdownSortOrder value);
 };
 
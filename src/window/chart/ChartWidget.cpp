@@ -32,14 +32,25 @@
  */
 
 #include "ChartWidget.h"
+#include <QCheckBox>
 #include <QConstOverload>
+#include <QDoubleSpinBox>
+#include <QFileDialog>
 #include <QGraphicsLayout>
+#include <QMenu>
+#include <QMessageBox>
 #include <QStandardItemModel>
 #include <QString>
 #include <QtCharts/QCategoryAxis>
+#include <QtCharts/QLegend>
+#include <QtCharts/QLegendMarker>
 #include <QtCharts/QLogValueAxis>
 #include <QtCharts/QScatterSeries>
 #include <QtCharts/QSplineSeries>
+#include <QtCharts/QValueAxis>
+#include <fstream>
+#include <optional>
+#include <src/util/common-times.h>
 #include <utility>
 
 namespace netsimulyzer {
@@ -57,44 +68,59 @@ void ChartWidget::seriesSelected(int index) {
     return;
   }
 
-  auto &s = manager.getSeries(selectedSeriesId);
+  const auto xy = manager.findXYSeries(selectedSeriesId);
+  const auto collection = manager.findCollection(selectedSeriesId);
+  const auto category = manager.findCategorySeries(selectedSeriesId);
+  if (!xy && !collection && !category) {
+    QMessageBox::critical(this, "Series not found", "The selected series was not found");
+    std::abort();
+  }
+
+  applyWindow();
+  if (useGpu) {
+    showOnGpu(selectedSeriesId);
+    return;
+  }
+
+  manager.seriesShown(selectedSeriesId);
 
-  if (std::holds_alternative<ChartManager::XYSeriesTie>(s))
-    showSeries(std::get<ChartManager::XYSeriesTie>(s));
-  else if (std::holds_alternative<ChartManager::SeriesCollectionTie>(s))
-    showSeries(std::get<ChartManager::SeriesCollectionTie>(s));
-  else if (std::holds_alternative<ChartManager::CategoryValueTie>(s))
-    showSeries(std::get<ChartManager::CategoryValueTie>(s));
+  if (xy)
+    showSeries(*xy);
+  else if (collection)
+    showSeries(*collection);
+  else
+    showSeries(*category);
 }
 
 void ChartWidget::showSeries(const ChartManager::XYSeriesTie &tie) {
-  const auto name = QString::fromStdString(tie.model.name);
+  const auto name = QString::fromStdString(tie.model->name);
   chart.setTitle(name);
   setWindowTitle(name);
 
   // Qt wants the series on the chart before the axes
   chart.addSeries(tie.qtSeries);
+  addLabels(tie);
 
   chart.addAxis(tie.xAxis, Qt::AlignBottom);
   chart.addAxis(tie.yAxis, Qt::AlignLeft);
 
   // The series may only be attached to an axis _after_ both have
   // been added to the chart...
-  tie.qtSeries->attachAxis(tie.xAxis);
-  tie.qtSeries->attachAxis(tie.yAxis);
+  for (auto chartSeries : chart.series()) {
+    chartSeries->attachAxis(tie.xAxis);
+    chartSeries->attachAxis(tie.yAxis);
+  }
 }
 
 void ChartWidget::showSeries(const ChartManager::SeriesCollectionTie &tie) {
-  const auto name = QString::fromStdString(tie.model.name);
+  const auto name = QString::fromStdString(tie.model->name);
   chart.setTitle(name);
   setWindowTitle(name);
 
-  for (auto seriesId : tie.model.series) {
-    const auto &seriesVariant = manager.getSeries(seriesId);
-
-    if (std::holds_alternative<ChartManager::XYSeriesTie>(seriesVariant)) {
-      const auto &xySeries = std::get<ChartManager::XYSeriesTie>(seriesVariant);
-      chart.addSeries(xySeries.qtSeries);
+  for (auto seriesId : tie.model->series) {
+    if (const auto xySeries = manager.findXYSeries(seriesId)) {
+      chart.addSeries(xySeries->qtSeries);
+      addLabels(*xySeries);
     }
   }
 
@@ -108,7 +134,7 @@ void ChartWidget::showSeries(const ChartManager::SeriesCollectionTie &tie) {
 }
 
 void ChartWidget::showSeries(const ChartManager::CategoryValueTie &tie) {
-  const auto name = QString::fromStdString(tie.model.name);
+  const auto name = QString::fromStdString(tie.model->name);
   chart.setTitle(name);
   setWindowTitle(name);
 
@@ -124,7 +150,115 @@ void ChartWidget::showSeries(const ChartManager::CategoryValueTie &tie) {
   tie.qtSeries->attachAxis(tie.yAxis);
 }
 
+void ChartWidget::addLabels(const ChartManager::XYSeriesTie &tie) {
+  if (!tie.labelSeries)
+    return;
+
+  chart.addSeries(tie.labelSeries);
+  for (auto marker : chart.legend()->markers(tie.labelSeries))
+    marker->setVisible(false);
+}
+
+void ChartWidget::showOnGpu(unsigned int seriesId) {
+  auto source = [](const QtCharts::QXYSeries *qtSeries) {
+    GpuChartView::Source value;
+    value.name = qtSeries->name();
+    value.color = qtSeries->color();
+    return value;
+  };
+  auto xySource = [&source](const ChartManager::XYSeriesTie &xy) {
+    auto value = source(xy.qtSeries);
+    value.scatter = xy.model->connection == parser::XYSeries::Connection::None;
+    value.xy = &xy.data;
+    return value;
+  };
+
+  QString name;
+  if (const auto xy = manager.findXYSeries(seriesId)) {
+    name = QString::fromStdString(xy->model->name);
+    gpuView.setLines(name, {xySource(*xy)}, xy->xAxis, xy->yAxis);
+  } else if (const auto collection = manager.findCollection(seriesId)) {
+    name = QString::fromStdString(collection->model->name);
+    std::vector<GpuChartView::Source> sources;
+    for (auto childId : collection->model->series) {
+      if (const auto child = manager.findXYSeries(childId))
+        sources.emplace_back(xySource(*child));
+    }
+    gpuView.setLines(name, sources, collection->xAxis, collection->yAxis);
+  } else if (const auto category = manager.findCategorySeries(seriesId)) {
+    name = QString::fromStdString(category->model->name);
+    auto value = source(category->qtSeries);
+    value.values = &category->values;
+    gpuView.setLines(name, {value}, category->xAxis, category->yAxis);
+  }
+
+  setWindowTitle(name);
+}
+
+void ChartWidget::applyWindow() {
+  if (currentSeries == ChartManager::PlaceholderId)
+    return;
+
+  const auto seconds = ui.doubleSpinBoxWindow->value();
+  std::optional<parser::nanoseconds> window;
+  if (seconds > 0.0)
+    window = static_cast<parser::nanoseconds>(seconds * static_cast<double>(SECOND));
+
+  manager.setWindow(currentSeries, window);
+}
+
+void ChartWidget::exportSeries(bool points) {
+  if (currentSeries == ChartManager::PlaceholderId) {
+    QMessageBox::information(this, "No series selected", "Select a series to export first");
+    return;
+  }
+
+  const auto fileName = QFileDialog::getSaveFileName(this, points ? "Export Series Points" : "Export Series Statistics",
+                                                     "", "CSV (*.csv)");
+  if (fileName.isEmpty())
+    return;
+
+  std::ofstream out{fileName.toStdString()};
+  if (!out) {
+    QMessageBox::critical(this, "Failed to export series", "Failed to open " + fileName);
+    return;
+  }
+
+  const auto columns = manager.seriesColumns(currentSeries);
+  const auto to = manager.getCurrentTime();
+  if (points)
+    parser::writePointsCsv(out, columns, 0LL, to);
+  else
+    parser::writeStatisticsCsv(out, parser::computeStatistics(columns, 0LL, to));
+
+  if (!out)
+    QMessageBox::critical(this, "Failed to export series", "Failed to write " + fileName);
+}
+
+void ChartWidget::setGpuView(bool enabled) {
+  const auto index = ui.comboBoxSeries->currentIndex();
+  clearChart();
+
+  useGpu = enabled;
+  ui.chartView->setVisible(!enabled);
+  gpuView.setVisible(enabled);
+  seriesSelected(index);
+}
+
 void ChartWidget::clearChart() {
+  gpuView.clear();
+
+  // Let the manager stop updating the Qt series (unused by `gpuView`),
+  // and since nothing else shares them, show all of them when next shown
+  if (currentSeries != ChartManager::PlaceholderId) {
+    if (!useGpu) {
+      manager.seriesHidden(currentSeries);
+      manager.setVisibleRange(currentSeries, std::nullopt);
+    }
+    manager.setWindow(currentSeries, std::nullopt);
+    currentSeries = ChartManager::PlaceholderId;
+  }
+
   // Remove old axes
   auto currentAxes = chart.axes();
 
@@ -152,6 +286,23 @@ void ChartWidget::clearChart() {
   chart.setTitle("");
 }
 
+void ChartWidget::updateVisibleRange() {
+  if (currentSeries == ChartManager::PlaceholderId)
+    return;
+
+  std::optional<std::pair<double, double>> range;
+  if (chart.isZoomed()) {
+    for (const auto axis : chart.axes(Qt::Horizontal)) {
+      if (const auto valueAxis = qobject_cast<QtCharts::QValueAxis *>(axis))
+        range = {valueAxis->min(), valueAxis->max()};
+      else if (const auto logAxis = qobject_cast<QtCharts::QLogValueAxis *>(axis))
+        range = {logAxis->min(), logAxis->max()};
+    }
+  }
+
+  manager.setVisibleRange(currentSeries, range);
+}
+
 void ChartWidget::closeEvent(QCloseEvent *event) {
   clearChart();
   manager.widgetClosed(this);
@@ -172,12 +323,27 @@ ChartWidget::ChartWidget(QWidget *parent, ChartManager &manager, std::vector<Cha
   chart.setBackgroundRoundness(0.0);
 
   ui.chartView->setChart(&chart);
+  ui.verticalLayout->addWidget(&gpuView);
+  gpuView.setVisible(false);
 
   sortDropdown();
   populateDropdown();
 
   QObject::connect(ui.comboBoxSeries, qOverload<int>(&QComboBox::currentIndexChanged), this,
                    &ChartWidget::seriesSelected);
+  QObject::connect(ui.chartView, &ControlsChartView::viewChanged, this, &ChartWidget::updateVisibleRange);
+  QObject::connect(ui.checkBoxGpu, &QCheckBox::toggled, this, &ChartWidget::setGpuView);
+
+  auto exportMenu = new QMenu{ui.toolButtonExport};
+  exportMenu->addAction("Series Statistics (CSV)...", [this]() {
+    exportSeries(false);
+  });
+  exportMenu->addAction("Series Points (CSV)...", [this]() {
+    exportSeries(true);
+  });
+  ui.toolButtonExport->setMenu(exportMenu);
+  QObject::connect(ui.doubleSpinBoxWindow, qOverload<double>(&QDoubleSpinBox::valueChanged), this,
+                   &ChartWidget::applyWindow);
 
   setFloating(false);
   setVisible(true);
@@ -302,6 +468,11 @@ void ChartWidget::setSortOrder(SettingsManager::ChartDropdownSortOrder value) {
   populateDropdown();
 }
 
+void ChartWidget::seriesUpdated() {
+  if (useGpu && currentSeries != ChartManager::PlaceholderId)
+    gpuView.update();
+}
+
 void ChartWidget::clearSelected() {
   clearChart();
   ui.comboBoxSeries->setCurrentIndex(0);
@@ -311,4 +482,10 @@ unsigned int ChartWidget::getCurrentSeries() const {
   return currentSeries;
 }
 
+void ChartWidget::selectSeries(unsigned int seriesId) {
+  const auto index = ui.comboBoxSeries->findData(seriesId);
+  if (index != -1)
+    ui.comboBoxSeries->setCurrentIndex(index);
+}
+
 } // namespace netsimulyzer
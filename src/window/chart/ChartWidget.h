@@ -34,6 +34,7 @@
 #pragma once
 
 #include "ChartManager.h"
+#include "GpuChartView.h"
 #include "ui_ChartWidget.h"
 #include <QDockWidget>
 #include <QString>
@@ -50,6 +51,12 @@ class ChartWidget : public QDockWidget {
   SettingsManager settings{};
   QtCharts::QChart chart;
   Ui::ChartWidget ui{};
+  GpuChartView gpuView{this};
+
+  /**
+   * True while series are drawn on `gpuView`, rather than the Qt chart
+   */
+  bool useGpu{false};
   unsigned int currentSeries{ChartManager::PlaceholderId};
   std::vector<ChartManager::DropdownValue> dropdownValues;
   SettingsManager::ChartDropdownSortOrder sortOrder =
@@ -60,11 +67,55 @@ class ChartWidget : public QDockWidget {
   void showSeries(const ChartManager::SeriesCollectionTie &tie);
   void showSeries(const ChartManager::CategoryValueTie &tie);
 
+  /**
+   * Add the series carrying the point labels of `tie` to the chart, if it has one,
+   * without an entry in the legend
+   */
+  void addLabels(const ChartManager::XYSeriesTie &tie);
+
+  /**
+   * Draw a series or collection on `gpuView`, straight from the manager's data
+   *
+   * @param seriesId
+   * The ID of the series or collection to draw
+   */
+  void showOnGpu(unsigned int seriesId);
+
+  /**
+   * Show only the recent points of the selected series,
+   * from the window set on `doubleSpinBoxWindow`, or every point if it is 0
+   */
+  void applyWindow();
+
+  /**
+   * Prompt for a file, then write the selected series to it as CSV,
+   * from time 0 up to the current time
+   *
+   * @param points
+   * True to write every point, false for the statistics of each series
+   */
+  void exportSeries(bool points);
+
+  /**
+   * Switch between drawing on the Qt chart & `gpuView`,
+   * showing the selected series again on the new one
+   *
+   * @param enabled
+   * True to draw on `gpuView`
+   */
+  void setGpuView(bool enabled);
+
   /**
    * Remove all axes & series from the chart
    */
   void clearChart();
 
+  /**
+   * Pass the visible range of the X axis to the manager while zoomed,
+   * so only the visible points are decimated
+   */
+  void updateVisibleRange();
+
 protected:
   void closeEvent(QCloseEvent *event) override;
 
@@ -77,6 +128,12 @@ public:
   void reset();
   void setSortOrder(SettingsManager::ChartDropdownSortOrder value);
 
+  /**
+   * Signals the manager has updated its series.
+   * The Qt chart follows its series, `gpuView` is redrawn here
+   */
+  void seriesUpdated();
+
   /**
    * Unselects the current series
    * & resets the chart
@@ -92,6 +149,15 @@ public:
    * or 0u in no series is selected
    */
   [[nodiscard]] unsigned int getCurrentSeries() const;
+
+  /**
+   * Select a series, as if it was chosen from the dropdown
+   *
+   * @param seriesId
+   * The ID of the series to show.
+   * Ignored if the dropdown does not have it
+   */
+  void selectSeries(unsigned int seriesId);
 };
 
 } // namespace netsimulyzer
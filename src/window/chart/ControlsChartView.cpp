@@ -89,8 +89,10 @@ void ControlsChartView::keyPressEvent(QKeyEvent *event) {
     break;
   default:
     QGraphicsView::keyPressEvent(event);
-    break;
+    return;
   }
+
+  emit viewChanged();
 }
 
 void ControlsChartView::mousePressEvent(QMouseEvent *event) {
@@ -115,6 +117,7 @@ void ControlsChartView::mouseMoveEvent(QMouseEvent *event) {
   // (e.g. moving the mouse down will move the chart up)
   chart()->scroll(delta.x(), -delta.y());
   lastMousePosition = event->pos();
+  emit viewChanged();
 }
 void ControlsChartView::mouseReleaseEvent(QMouseEvent *event) {
   QChartView::mouseReleaseEvent(event);
@@ -165,6 +168,7 @@ void ControlsChartView::wheelEvent(QWheelEvent *event) {
       chart()->zoom(1.0 / zoomFactor);
   }
 
+  emit viewChanged();
   QGraphicsView::wheelEvent(event);
 }
 
@@ -45,6 +45,8 @@
  * to zoom & move about the graph
  */
 class ControlsChartView : public QtCharts::QChartView {
+  Q_OBJECT
+
   /**
    * Flag that tracks if the left mouse button is down
    */
@@ -82,4 +84,10 @@ public:
    * The widget that contains this one
    */
   ControlsChartView(QWidget *parent);
+
+signals:
+  /**
+   * Emitted after the chart is zoomed or scrolled
+   */
+  void viewChanged();
 };
@@ -0,0 +1,437 @@
+/*
+ * NIST-developed software is provided by NIST as a public service. You may use,
+ * copy and distribute copies of the software in any medium, provided that you
+ * keep intact this entire notice. You may improve,modify and create derivative
+ * works of the software or any portion of the software, and you may copy and
+ * distribute such modifications or works. Modified works should carry a notice
+ * stating that you changed the software and should note the date and nature of
+ * any such change. Please explicitly acknowledge the National Institute of
+ * Standards and Technology as the source of the software.
+ *
+ * NIST-developed software is expressly provided "AS IS." NIST MAKES NO
+ * WARRANTY OF ANY KIND, EXPRESS, IMPLIED, IN FACT OR ARISING BY OPERATION OF
+ * LAW, INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTY OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, NON-INFRINGEMENT
+ * AND DATA ACCURACY. NIST NEITHER REPRESENTS NOR WARRANTS THAT THE
+ * OPERATION OF THE SOFTWARE WILL BE UNINTERRUPTED OR ERROR-FREE, OR THAT
+ * ANY DEFECTS WILL BE CORRECTED. NIST DOES NOT WARRANT OR MAKE ANY
+ * REPRESENTATIONS REGARDING THE USE OF THE SOFTWARE OR THE RESULTS THEREOF,
+ * INCLUDING BUT NOT LIMITED TO THE CORRECTNESS, ACCURACY, RELIABILITY,
+ * OR USEFULNESS OF THE SOFTWARE.
+ *
+ * You are solely responsible for determining the appropriateness of using and
+ * distributing the software and you assume all risks associated with its use,
+ * including but not limited to the risks and costs of program errors,
+ * compliance with applicable laws, damage to or loss of data, programs or
+ * equipment, and the unavailability or interruption of operation. This
+ * software is not intended to be used in any situation where a failure could
+ * cause risk of injury or damage to property. The software developed by NIST
+ * employees is not subject to copyright protection within the United States.
+ *
+ * Author: Evan Black <evan.black@nist.gov>
+ */
+
+#include "DecimatedSeries.h"
+#include <QList>
+#include <algorithm>
+#include <iterator>
+
+namespace {
+
+/**
+ * Append the lowest & highest of `points` from `first` up to `last` to `out`, in their original order
+ */
+void lowestHighest(const QVector<QPointF> &points, int first, int last, QVector<QPointF> &out) {
+  auto lowest = first;
+  auto highest = first;
+  for (auto i = first + 1; i < last; i++) {
+    if (points[i].y() < points[lowest].y())
+      lowest = i;
+    if (points[i].y() > points[highest].y())
+      highest = i;
+  }
+
+  out.push_back(points[std::min(lowest, highest)]);
+  out.push_back(points[std::max(lowest, highest)]);
+}
+
+} // namespace
+
+namespace netsimulyzer {
+
+DecimatedSeries::Extent::Extent(const QPointF &point)
+    : minX(point.x()), maxX(point.x()), minY(point.y()), maxY(point.y()) {
+}
+
+void DecimatedSeries::Extent::add(const Extent &other) {
+  minX = std::min(minX, other.minX);
+  maxX = std::max(maxX, other.maxX);
+  minY = std::min(minY, other.minY);
+  maxY = std::max(maxY, other.maxY);
+}
+
+void DecimatedSeries::summarize(const QVector<QPointF> &source, int begin, int end, int size,
+                                QVector<QPointF> &out) {
+  for (auto bucket = begin; bucket < end; bucket += size)
+    lowestHighest(source, bucket, std::min(bucket + size, end), out);
+
+  // Always end on the latest point, so the end of a line stays put
+  if (begin < end && out.back() != source[end - 1])
+    out.push_back(source[end - 1]);
+}
+
+int DecimatedSeries::maxBuckets() const {
+  // Leave room for the incomplete bucket at the end, and the last point
+  return (maxPoints - 3) / 2;
+}
+
+void DecimatedSeries::rebuild() {
+  buckets.clear();
+  bucketSize = 1;
+
+  const auto count = last - first;
+  if (count <= maxPoints)
+    return;
+
+  bucketSize = 2;
+  while (count / bucketSize > maxBuckets())
+    bucketSize *= 2;
+
+  for (auto bucket = first; bucket + bucketSize <= last; bucket += bucketSize)
+    lowestHighest(points, bucket, bucket + bucketSize, buckets);
+}
+
+void DecimatedSeries::extend() {
+  last++;
+
+  const auto count = last - first;
+  if (bucketSize == 1) {
+    if (count > maxPoints) {
+      rebuild();
+      shown = -1;
+    } else if (visibleX) {
+      shown = -1;
+    }
+    return;
+  }
+
+  shown = -1;
+  if (count % bucketSize != 0)
+    return;
+
+  lowestHighest(points, last - bucketSize, last, buckets);
+  if (static_cast<int>(buckets.size()) / 2 <= maxBuckets())
+    return;
+
+  // Merge each pair of buckets. The lowest & highest of both are among their summaries.
+  // A leftover bucket is dropped, its points are summarized with the incomplete bucket
+  QVector<QPointF> merged;
+  merged.reserve(buckets.size() / 2 + 2);
+  for (auto i = 0; i + 4 <= static_cast<int>(buckets.size()); i += 4)
+    lowestHighest(buckets, i, i + 4, merged);
+
+  buckets = std::move(merged);
+  bucketSize *= 2;
+}
+
+void DecimatedSeries::truncate(int end) {
+  last = end;
+
+  if (bucketSize == 1) {
+    if (visibleX)
+      shown = -1;
+    return;
+  }
+
+  const auto count = last - first;
+  if (count <= maxPoints) {
+    buckets.clear();
+    bucketSize = 1;
+  } else {
+    buckets.resize(std::min(static_cast<int>(buckets.size()), count / bucketSize * 2));
+  }
+  shown = -1;
+}
+
+QVector<QPointF> DecimatedSeries::view() const {
+  QVector<QPointF> out;
+
+  if (visibleX) {
+    const auto [low, high] = visibleX.value();
+    auto inRange = [low = low, high = high](const QPointF &point) {
+      return point.x() >= low && point.x() <= high;
+    };
+
+    // Keep the points just outside the range as well, so lines run off the edges of the chart
+    QVector<QPointF> unsortedVisible;
+    const QVector<QPointF> *visible = &points;
+    auto begin = first;
+    auto end = last;
+    if (sortedX) {
+      const auto firstPoint = points.begin() + first;
+      const auto lastPoint = points.begin() + last;
+      begin = static_cast<int>(std::lower_bound(firstPoint, lastPoint, low,
+                                                [](const QPointF &point, double x) {
+                                                  return point.x() < x;
+                                                }) -
+                               points.begin());
+      end = static_cast<int>(std::upper_bound(firstPoint, lastPoint, high,
+                                              [](double x, const QPointF &point) {
+                                                return x < point.x();
+                                              }) -
+                             points.begin());
+      begin = std::max(first, begin - 1);
+      end = std::min(last, end + 1);
+    } else {
+      for (auto i = first; i < last; i++) {
+        if (inRange(points[i]) || (i > first && inRange(points[i - 1])) || (i + 1 < last && inRange(points[i + 1])))
+          unsortedVisible.push_back(points[i]);
+      }
+      visible = &unsortedVisible;
+      begin = 0;
+      end = static_cast<int>(unsortedVisible.size());
+    }
+
+    const auto visibleCount = end - begin;
+    if (visibleCount <= maxPoints) {
+      out.reserve(visibleCount);
+      std::copy(visible->begin() + begin, visible->begin() + end, std::back_inserter(out));
+    } else {
+      const auto visibleBuckets = (maxPoints - 1) / 2;
+      summarize(*visible, begin, end, (visibleCount + visibleBuckets - 1) / visibleBuckets, out);
+    }
+    return out;
+  }
+
+  if (bucketSize == 1) {
+    out.reserve(last - first);
+    std::copy(points.begin() + first, points.begin() + last, std::back_inserter(out));
+    return out;
+  }
+
+  // The incomplete bucket at the end is summarized as it is
+  out = buckets;
+  summarize(points, first + static_cast<int>(buckets.size()) / 2 * bucketSize, last, bucketSize, out);
+  if (out.back() != points[last - 1])
+    out.push_back(points[last - 1]);
+  return out;
+}
+
+DecimatedSeries::DecimatedSeries(int maxPoints) : maxPoints(std::max(8, maxPoints)) {
+}
+
+void DecimatedSeries::add(parser::nanoseconds time, const QPointF &point) {
+  if (!points.empty() && point.x() < points.back().x())
+    sortedX = false;
+
+  times.emplace_back(time);
+  points.push_back(point);
+
+  const auto size = static_cast<int>(points.size());
+  if (size % extentBlock != 0)
+    return;
+
+  // A block was completed, which may complete a pair of blocks on each level above
+  Extent block{points[size - extentBlock]};
+  for (auto i = size - extentBlock + 1; i < size; i++)
+    block.add(Extent{points[i]});
+
+  if (extents.empty())
+    extents.emplace_back();
+  extents.front().emplace_back(block);
+
+  for (std::size_t level = 0u; extents[level].size() % 2u == 0u; level++) {
+    auto pair = extents[level][extents[level].size() - 2u];
+    pair.add(extents[level].back());
+
+    if (level + 1u == extents.size())
+      extents.emplace_back();
+    extents[level + 1u].emplace_back(pair);
+  }
+}
+
+void DecimatedSeries::addClear(parser::nanoseconds time) {
+  clears.emplace_back(time, static_cast<int>(points.size()));
+}
+
+void DecimatedSeries::seek(parser::nanoseconds time, bool inclusive) {
+  seekTime = time;
+  seekInclusive = inclusive;
+
+  const auto end = static_cast<int>((inclusive ? std::upper_bound(times.begin(), times.end(), time)
+                                               : std::lower_bound(times.begin(), times.end(), time)) -
+                                    times.begin());
+
+  // The series starts after the latest clear before `time`
+  const auto clear =
+      inclusive ? std::upper_bound(clears.begin(), clears.end(), time,
+                                   [](parser::nanoseconds value, const auto &c) {
+                                     return value < c.first;
+                                   })
+                : std::lower_bound(clears.begin(), clears.end(), time, [](const auto &c, parser::nanoseconds value) {
+                    return c.first < value;
+                  });
+  auto begin = clear == clears.begin() ? 0 : std::prev(clear)->second;
+
+  // Only the points newer than the window are shown
+  if (window) {
+    const auto windowStart = static_cast<int>(
+        std::upper_bound(times.begin(), times.end(), time - window.value()) - times.begin());
+    begin = std::min(std::max(begin, windowStart), end);
+  }
+
+  if (begin != first) {
+    first = begin;
+    last = end;
+    rebuild();
+    shown = -1;
+    return;
+  }
+
+  if (end < last)
+    truncate(end);
+  while (last < end)
+    extend();
+}
+
+void DecimatedSeries::setWindow(std::optional<parser::nanoseconds> value) {
+  if (window == value)
+    return;
+
+  window = value;
+  seek(seekTime, seekInclusive);
+}
+
+std::optional<DecimatedSeries::Extent> DecimatedSeries::extent(int begin, int end) const {
+  std::optional<Extent> out;
+  auto add = [&out](const Extent &value) {
+    if (out)
+      out->add(value);
+    else
+      out = value;
+  };
+  auto scan = [this, &add](int from, int to) {
+    for (auto i = from; i < to; i++)
+      add(Extent{points[i]});
+  };
+
+  auto firstBlock = (begin + extentBlock - 1) / extentBlock;
+  auto lastBlock = end / extentBlock;
+  if (firstBlock >= lastBlock) {
+    scan(begin, end);
+    return out;
+  }
+
+  // The points outside of complete blocks
+  scan(begin, firstBlock * extentBlock);
+  scan(lastBlock * extentBlock, end);
+
+  // Take the odd blocks off of each end, and the rest are covered by the level above
+  for (std::size_t level = 0u; firstBlock < lastBlock; level++) {
+    if (firstBlock & 1)
+      add(extents[level][firstBlock++]);
+    if (lastBlock & 1)
+      add(extents[level][--lastBlock]);
+
+    firstBlock /= 2;
+    lastBlock /= 2;
+  }
+
+  return out;
+}
+
+std::optional<DecimatedSeries::Extent> DecimatedSeries::axisExtent() const {
+  return extent(window ? first : 0, last);
+}
+
+void DecimatedSeries::setVisibleRange(std::optional<std::pair<double, double>> range) {
+  visibleX = range;
+  shown = -1;
+}
+
+void DecimatedSeries::show(QtCharts::QXYSeries &series) {
+  const auto count = last - first;
+  const auto incremental = !visibleX && bucketSize == 1;
+
+  if (shown >= 0 && incremental) {
+    if (shown > count) {
+      series.removePoints(count, shown - count);
+    } else if (shown < count) {
+      QList<QPointF> added;
+      added.reserve(count - shown);
+      for (auto i = first + shown; i < last; i++)
+        added.append(points[i]);
+      series.append(added);
+    }
+    shown = count;
+    return;
+  }
+
+  series.replace(view());
+  shown = incremental ? count : -1;
+}
+
+void DecimatedSeries::hide(QtCharts::QXYSeries &series) {
+  series.clear();
+  shown = 0;
+}
+
+const QVector<QPointF> &DecimatedSeries::data() const {
+  return points;
+}
+
+const std::vector<parser::nanoseconds> &DecimatedSeries::dataTimes() const {
+  return times;
+}
+
+int DecimatedSeries::begin() const {
+  return first;
+}
+
+int DecimatedSeries::end() const {
+  return last;
+}
+
+int DecimatedSeries::size() const {
+  return last - first;
+}
+
+std::optional<parser::nanoseconds> DecimatedSeries::nextTime() const {
+  std::optional<parser::nanoseconds> next;
+
+  // Those at exactly `seekTime` are still due after an exclusive seek
+  const auto point = seekInclusive ? std::upper_bound(times.begin(), times.end(), seekTime)
+                                   : std::lower_bound(times.begin(), times.end(), seekTime);
+  if (point != times.end())
+    next = *point;
+
+  const auto clear =
+      seekInclusive ? std::upper_bound(clears.begin(), clears.end(), seekTime,
+                                       [](parser::nanoseconds value, const auto &c) {
+                                         return value < c.first;
+                                       })
+                    : std::lower_bound(clears.begin(), clears.end(), seekTime,
+                                       [](const auto &c, parser::nanoseconds value) {
+                                         return c.first < value;
+                                       });
+  if (clear != clears.end() && (!next || clear->first < next.value()))
+    next = clear->first;
+
+  return next;
+}
+
+std::size_t DecimatedSeries::memoryUsage() const {
+  auto bytes = times.capacity() * sizeof(parser::nanoseconds) +
+               static_cast<std::size_t>(points.capacity()) * sizeof(QPointF) +
+               clears.capacity() * sizeof(decltype(clears)::value_type) +
+               extents.capacity() * sizeof(std::vector<Extent>);
+  for (const auto &level : extents)
+    bytes += level.capacity() * sizeof(Extent);
+  return bytes;
+}
+
+bool DecimatedSeries::isDecimated() const {
+  return bucketSize > 1;
+}
+
+} // namespace netsimulyzer
@@ -0,0 +1,373 @@
+/*
+ * NIST-developed software is provided by NIST as a public service. You may use,
+ * copy and distribute copies of the software in any medium, provided that you
+ * keep intact this entire notice. You may improve,modify and create derivative
+ * works of the software or any portion of the software, and you may copy and
+ * distribute such modifications or works. Modified works should carry a notice
+ * stating that you changed the software and should note the date and nature of
+ * any such change. Please explicitly acknowledge the National Institute of
+ * Standards and Technology as the source of the software.
+ *
+ * NIST-developed software is expressly provided "AS IS." NIST MAKES NO
+ * WARRANTY OF ANY KIND, EXPRESS, IMPLIED, IN FACT OR ARISING BY OPERATION OF
+ * LAW, INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTY OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, NON-INFRINGEMENT
+ * AND DATA ACCURACY. NIST NEITHER REPRESENTS NOR WARRANTS THAT THE
+ * OPERATION OF THE SOFTWARE WILL BE UNINTERRUPTED OR ERROR-FREE, OR THAT
+ * ANY DEFECTS WILL BE CORRECTED. NIST DOES NOT WARRANT OR MAKE ANY
+ * REPRESENTATIONS REGARDING THE USE OF THE SOFTWARE OR THE RESULTS THEREOF,
+ * INCLUDING BUT NOT LIMITED TO THE CORRECTNESS, ACCURACY, RELIABILITY,
+ * OR USEFULNESS OF THE SOFTWARE.
+ *
+ * You are solely responsible for determining the appropriateness of using and
+ * distributing the software and you assume all risks associated with its use,
+ * including but not limited to the risks and costs of program errors,
+ * compliance with applicable laws, damage to or loss of data, programs or
+ * equipment, and the unavailability or interruption of operation. This
+ * software is not intended to be used in any situation where a failure could
+ * cause risk of injury or damage to property. The software developed by NIST
+ * employees is not subject to copyright protection within the United States.
+ *
+ * Author: Evan Black <evan.black@nist.gov>
+ */
+
+#pragma once
+
+#include <QPointF>
+#include <QVector>
+#include <QtCharts/QXYSeries>
+#include <cstddef>
+#include <model.h>
+#include <optional>
+#include <utility>
+#include <vector>
+
+namespace netsimulyzer {
+
+/**
+ * Every point of an XY series, in time ordered columns built as the events are loaded,
+ * shown on its Qt series through a decimated view small enough for QtCharts to draw.
+ *
+ * The points on the series at a time are a slice of the columns:
+ * from the latest clear up to the last point added at that time,
+ * both found by binary search, so seeking any distance costs one slice.
+ *
+ * The view of the slice keeps the lowest & highest point
+ * of each bucket of `bucketSize` points, in their original order, so spikes are never dropped.
+ * Buckets double in size whenever there would be more than `maxPoints` in the view,
+ * so extending the slice costs constant amortized time per point, regardless of the size of the series.
+ *
+ * While zoomed in (see `setVisibleRange()`), the view is decimated
+ * from only the points in the visible range instead.
+ *
+ * With a window (see `setWindow()`), the slice starts at the first point
+ * newer than the window before the current time, found by binary search as well,
+ * so the series only ever shows the recent points, however long the run.
+ *
+ * The lowest & highest X & Y of every range of points is kept in a tree of blocks,
+ * built as points are added, so the extent of any slice is found in O(log n),
+ * see `extent()`
+ */
+class DecimatedSeries {
+public:
+  /**
+   * The lowest & highest values of a range of points
+   */
+  struct Extent {
+    double minX;
+    double maxX;
+    double minY;
+    double maxY;
+
+    explicit Extent(const QPointF &point);
+
+    /**
+     * Grow to include `other`
+     */
+    void add(const Extent &other);
+  };
+
+private:
+  /**
+   * The number of points summarized by each entry of the first level of `extents`
+   */
+  static constexpr int extentBlock = 32;
+
+  /**
+   * The time each point was added, never decreasing
+   */
+  std::vector<parser::nanoseconds> times;
+
+  /**
+   * Entry `i` of level `k` is the extent of the points from `i * extentBlock * 2^k`
+   * up to `(i + 1) * extentBlock * 2^k`. Only complete blocks have an entry
+   */
+  std::vector<std::vector<Extent>> extents;
+
+  /**
+   * Every point added to the series, parallel to `times`
+   */
+  QVector<QPointF> points;
+
+  /**
+   * The time of each clear of the series,
+   * and the index in `points` of the first point after it
+   */
+  std::vector<std::pair<parser::nanoseconds, int>> clears;
+
+  /**
+   * The index in `points` of the first point on the series
+   */
+  int first{0};
+
+  /**
+   * One past the index in `points` of the last point on the series
+   */
+  int last{0};
+
+  /**
+   * The most points to show on the Qt series
+   */
+  int maxPoints{4000};
+
+  /**
+   * The number of points summarized by each bucket.
+   * 1 while every point on the series fits in `maxPoints`
+   */
+  int bucketSize{1};
+
+  /**
+   * The lowest & highest point of each complete bucket from `first`, in the order they were added.
+   * Always 2 per bucket. Empty while `bucketSize` is 1
+   */
+  QVector<QPointF> buckets;
+
+  /**
+   * True while the X values of `points` never decrease,
+   * so the visible range may be found by binary search
+   */
+  bool sortedX{true};
+
+  /**
+   * How far back from the current time points are shown, if set
+   */
+  std::optional<parser::nanoseconds> window;
+
+  /**
+   * The arguments of the last `seek()`, to seek again when the window changes
+   */
+  parser::nanoseconds seekTime{0LL};
+  bool seekInclusive{true};
+
+  /**
+   * The range of X values shown, while zoomed in
+   */
+  std::optional<std::pair<double, double>> visibleX;
+
+  /**
+   * The number of points from `first` on the Qt series, as they are,
+   * or -1 if the Qt series must be replaced by the current view
+   */
+  int shown{0};
+
+  /**
+   * @return
+   * The most complete buckets to keep before doubling `bucketSize`
+   */
+  [[nodiscard]] int maxBuckets() const;
+
+  /**
+   * Build `buckets` from every point on the series, with the smallest bucket size which fits `maxPoints`
+   */
+  void rebuild();
+
+  /**
+   * Add the point at `last` to the series
+   */
+  void extend();
+
+  /**
+   * Remove points from the end of the series
+   *
+   * @param end
+   * One past the index in `points` of the new last point
+   */
+  void truncate(int end);
+
+  /**
+   * @return
+   * The points to show on the Qt series
+   */
+  [[nodiscard]] QVector<QPointF> view() const;
+
+public:
+  DecimatedSeries() = default;
+
+  /**
+   * @param maxPoints
+   * The most points to show on the Qt series
+   */
+  explicit DecimatedSeries(int maxPoints);
+
+  /**
+   * Summarize the buckets of `source` from `begin` up to `end`
+   *
+   * @param source
+   * The points to summarize
+   *
+   * @param begin
+   * The index of the first point
+   *
+   * @param end
+   * One past the index of the last point
+   *
+   * @param size
+   * The number of points in each bucket. The final bucket may be smaller
+   *
+   * @param out
+   * Where the lowest & highest point of each bucket are appended,
+   * followed by the point at `end - 1` if it is not already the final one
+   */
+  static void summarize(const QVector<QPointF> &source, int begin, int end, int size, QVector<QPointF> &out);
+
+  /**
+   * Add a point to the columns, without showing it.
+   * Points must be added in time order
+   *
+   * @param time
+   * The time the point is added to the series
+   *
+   * @param point
+   * The point to add
+   */
+  void add(parser::nanoseconds time, const QPointF &point);
+
+  /**
+   * Record a clear of the series, after the points added so far
+   *
+   * @param time
+   * The time the series is cleared
+   */
+  void addClear(parser::nanoseconds time);
+
+  /**
+   * Put the points on the series at `time`
+   *
+   * @param time
+   * The time to show the series at
+   *
+   * @param inclusive
+   * True to include the points & clears at exactly `time`
+   */
+  void seek(parser::nanoseconds time, bool inclusive);
+
+  /**
+   * Show only the points newer than `value` before the current time,
+   * or every point since the latest clear
+   *
+   * @param value
+   * The length of the window, or an empty optional for every point
+   */
+  void setWindow(std::optional<parser::nanoseconds> value);
+
+  /**
+   * The extent of a range of points in `data()`, in O(log n)
+   *
+   * @param begin
+   * The index of the first point
+   *
+   * @param end
+   * One past the index of the last point
+   *
+   * @return
+   * The lowest & highest values of the points, or an empty optional if there are none
+   */
+  [[nodiscard]] std::optional<Extent> extent(int begin, int end) const;
+
+  /**
+   * @return
+   * The extent of every point added up to the current time, even those cleared since,
+   * or of only the points in the window, with one
+   */
+  [[nodiscard]] std::optional<Extent> axisExtent() const;
+
+  /**
+   * Show only the points within a range of X values, or every point
+   *
+   * @param range
+   * The lowest & highest visible X values,
+   * or an empty optional to show the whole series
+   */
+  void setVisibleRange(std::optional<std::pair<double, double>> range);
+
+  /**
+   * Update `series` to show the current view of the points.
+   * While every point fits, only the changes since the last call are sent to `series`
+   *
+   * @param series
+   * The Qt series for these points
+   */
+  void show(QtCharts::QXYSeries &series);
+
+  /**
+   * Remove every point from `series`, while it is not on screen.
+   * The next `show()` puts the current view back
+   *
+   * @param series
+   * The Qt series for these points
+   */
+  void hide(QtCharts::QXYSeries &series);
+
+  /**
+   * @return
+   * Every point added to the columns, at full resolution
+   */
+  [[nodiscard]] const QVector<QPointF> &data() const;
+
+  /**
+   * @return
+   * The time each point in `data()` was added, never decreasing
+   */
+  [[nodiscard]] const std::vector<parser::nanoseconds> &dataTimes() const;
+
+  /**
+   * @return
+   * The index in `data()` of the first point on the series
+   */
+  [[nodiscard]] int begin() const;
+
+  /**
+   * @return
+   * One past the index in `data()` of the last point on the series.
+   * Points are never added before it, so the points from an earlier `end()`
+   * up to this one are the points added since
+   */
+  [[nodiscard]] int end() const;
+
+  /**
+   * @return
+   * The number of points on the series
+   */
+  [[nodiscard]] int size() const;
+
+  /**
+   * @return
+   * The time of the first point, or clear, after the last `seek()`.
+   * Unset if the series does not change after it
+   */
+  [[nodiscard]] std::optional<parser::nanoseconds> nextTime() const;
+
+  /**
+   * @return
+   * The bytes held by the columns & their extents
+   */
+  [[nodiscard]] std::size_t memoryUsage() const;
+
+  /**
+   * @return
+   * True if the Qt series shows fewer points than the series has
+   */
+  [[nodiscard]] bool isDecimated() const;
+};
+
+} // namespace netsimulyzer
@@ -0,0 +1,586 @@
+/*
+ * NIST-developed software is provided by NIST as a public service. You may use,
+ * copy and distribute copies of the software in any medium, provided that you
+ * keep intact this entire notice. You may improve,modify and create derivative
+ * works of the software or any portion of the software, and you may copy and
+ * distribute such modifications or works. Modified works should carry a notice
+ * stating that you changed the software and should note the date and nature of
+ * any such change. Please explicitly acknowledge the National Institute of
+ * Standards and Technology as the source of the software.
+ *
+ * NIST-developed software is expressly provided "AS IS." NIST MAKES NO
+ * WARRANTY OF ANY KIND, EXPRESS, IMPLIED, IN FACT OR ARISING BY OPERATION OF
+ * LAW, INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTY OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, NON-INFRINGEMENT
+ * AND DATA ACCURACY. NIST NEITHER REPRESENTS NOR WARRANTS THAT THE
+ * OPERATION OF THE SOFTWARE WILL BE UNINTERRUPTED OR ERROR-FREE, OR THAT
+ * ANY DEFECTS WILL BE CORRECTED. NIST DOES NOT WARRANT OR MAKE ANY
+ * REPRESENTATIONS REGARDING THE USE OF THE SOFTWARE OR THE RESULTS THEREOF,
+ * INCLUDING BUT NOT LIMITED TO THE CORRECTNESS, ACCURACY, RELIABILITY,
+ * OR USEFULNESS OF THE SOFTWARE.
+ *
+ * You are solely responsible for determining the appropriateness of using and
+ * distributing the software and you assume all risks associated with its use,
+ * including but not limited to the risks and costs of program errors,
+ * compliance with applicable laws, damage to or loss of data, programs or
+ * equipment, and the unavailability or interruption of operation. This
+ * software is not intended to be used in any situation where a failure could
+ * cause risk of injury or damage to property. The software developed by NIST
+ * employees is not subject to copyright protection within the United States.
+ *
+ * Author: Evan Black <evan.black@nist.gov>
+ */
+
+#include "GpuChartView.h"
+#include <QFile>
+#include <QKeyEvent>
+#include <QMessageBox>
+#include <QMouseEvent>
+#include <QPainter>
+#include <QTextStream>
+#include <QWheelEvent>
+#include <QtCharts/QCategoryAxis>
+#include <QtCharts/QLogValueAxis>
+#include <QtCharts/QValueAxis>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+#include <string>
+
+namespace {
+
+/**
+ * Append the lowest & highest of `count` points from `first` to `out`, in their original order
+ *
+ * @param point
+ * Gets the point at an index
+ */
+template <class PointAt>
+void lowestHighest(PointAt point, int first, int count, std::vector<QPointF> &out) {
+  auto lowest = first;
+  auto highest = first;
+  for (auto i = first + 1; i < first + count; i++) {
+    if (point(i).y() < point(lowest).y())
+      lowest = i;
+    if (point(i).y() > point(highest).y())
+      highest = i;
+  }
+
+  out.emplace_back(point(std::min(lowest, highest)));
+  out.emplace_back(point(std::max(lowest, highest)));
+}
+
+std::string readShader(const QString &path) {
+  QFile file{path};
+  if (!file.open(QFile::ReadOnly | QFile::Text)) {
+    QMessageBox::critical(nullptr, "Failed to open shader file", "Failed to open shader file " + path);
+    std::abort();
+  }
+  return QTextStream{&file}.readAll().toStdString();
+}
+
+} // namespace
+
+namespace netsimulyzer {
+
+double GpuChartView::toView(double value, const QtCharts::QAbstractAxis *axis) {
+  if (qobject_cast<const QtCharts::QLogValueAxis *>(axis))
+    return std::log10(std::max(value, std::numeric_limits<double>::min()));
+  return value;
+}
+
+double GpuChartView::fromView(double value, const QtCharts::QAbstractAxis *axis) {
+  if (qobject_cast<const QtCharts::QLogValueAxis *>(axis))
+    return std::pow(10.0, value);
+  return value;
+}
+
+QRectF GpuChartView::axesRange() const {
+  auto range = [](const QtCharts::QAbstractAxis *axis) -> std::pair<double, double> {
+    // Includes `QCategoryAxis`
+    if (const auto valueAxis = qobject_cast<const QtCharts::QValueAxis *>(axis))
+      return {valueAxis->min(), valueAxis->max()};
+    if (const auto logAxis = qobject_cast<const QtCharts::QLogValueAxis *>(axis))
+      return {toView(logAxis->min(), axis), toView(logAxis->max(), axis)};
+    return {0.0, 1.0};
+  };
+
+  const auto [minX, maxX] = range(xAxis);
+  const auto [minY, maxY] = range(yAxis);
+  return {minX, minY, std::max(maxX - minX, std::numeric_limits<double>::epsilon()),
+          std::max(maxY - minY, std::numeric_limits<double>::epsilon())};
+}
+
+QRectF GpuChartView::viewRange() const {
+  return zoomed.value_or(axesRange());
+}
+
+QRect GpuChartView::plotArea() const {
+  return {marginLeft, marginTop, std::max(1, width() - marginLeft - marginRight),
+          std::max(1, height() - marginTop - marginBottom)};
+}
+
+void GpuChartView::append(Buffer &buffer, const std::vector<float> &vertices) {
+  constexpr auto vertexSize = static_cast<int>(sizeof(float) * 2);
+  const auto added = static_cast<int>(vertices.size() / 2u);
+  if (added == 0)
+    return;
+
+  if (buffer.vao == 0u) {
+    glGenVertexArrays(1, &buffer.vao);
+    glBindVertexArray(buffer.vao);
+    glEnableVertexAttribArray(0);
+  }
+
+  if (buffer.count + added > buffer.capacity) {
+    const auto capacity = std::max({1024, buffer.capacity * 2, buffer.count + added});
+    unsigned int vbo;
+    glGenBuffers(1, &vbo);
+    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+    glBufferData(GL_ARRAY_BUFFER, capacity * vertexSize, nullptr, GL_DYNAMIC_DRAW);
+
+    // Keep what was uploaded, without a copy on our side
+    if (buffer.vbo != 0u) {
+      glBindBuffer(GL_COPY_READ_BUFFER, buffer.vbo);
+      glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_ARRAY_BUFFER, 0, 0, buffer.count * vertexSize);
+      glDeleteBuffers(1, &buffer.vbo);
+    }
+
+    buffer.vbo = vbo;
+    buffer.capacity = capacity;
+    glBindVertexArray(buffer.vao);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, vertexSize, nullptr);
+  }
+
+  glBindBuffer(GL_ARRAY_BUFFER, buffer.vbo);
+  glBufferSubData(GL_ARRAY_BUFFER, buffer.count * vertexSize, added * vertexSize, vertices.data());
+  buffer.count += added;
+}
+
+void GpuChartView::deleteBuffers(Line &line) {
+  for (auto &level : line.levels) {
+    if (level.vbo != 0u)
+      glDeleteBuffers(1, &level.vbo);
+    if (level.vao != 0u)
+      glDeleteVertexArrays(1, &level.vao);
+    level = {};
+  }
+}
+
+void GpuChartView::upload(Line &line) {
+  std::vector<float> vertices;
+  auto relative = [&line, &vertices](const QPointF &point) {
+    vertices.emplace_back(static_cast<float>(point.x() - line.origin->x()));
+    vertices.emplace_back(static_cast<float>(point.y() - line.origin->y()));
+  };
+  auto viewPoint = [this](const QPointF &point) {
+    return QPointF{toView(point.x(), xAxis), toView(point.y(), yAxis)};
+  };
+
+  if (line.source.values) {
+    const auto &values = *line.source.values;
+    if (values.isEmpty()) {
+      line.levels[0].count = 0;
+      return;
+    }
+    if (!line.origin)
+      line.origin = viewPoint(values.first());
+
+    // Small enough to send whole, which avoids tracking values removed & added again
+    for (const auto &value : values)
+      relative(viewPoint(value));
+    line.levels[0].count = 0;
+    append(line.levels[0], vertices);
+    return;
+  }
+
+  const auto &data = line.source.xy->data();
+  const auto size = static_cast<int>(data.size());
+  if (size == line.levels[0].count)
+    return;
+  if (!line.origin)
+    line.origin = viewPoint(data.front());
+
+  for (auto i = line.levels[0].count; i < size; i++)
+    relative(viewPoint(data[i]));
+  append(line.levels[0], vertices);
+
+  // Every new complete bucket of each level makes up the next
+  auto raw = [&data, &viewPoint](int i) {
+    return viewPoint(data[i]);
+  };
+  auto groupSize = bucketFactor;
+  auto available = size;
+  for (auto level = 1; level < maxLevels; level++) {
+    auto &out = line.levelPoints[level];
+    const auto existing = static_cast<int>(out.size());
+    const auto &previous = line.levelPoints[level - 1];
+
+    for (auto bucket = existing / 2; (bucket + 1) * groupSize <= available; bucket++) {
+      if (level == 1)
+        lowestHighest(raw, bucket * groupSize, groupSize, out);
+      else
+        lowestHighest([&previous](int i) { return previous[i]; }, bucket * groupSize, groupSize, out);
+    }
+
+    if (static_cast<int>(out.size()) == existing)
+      break;
+
+    vertices.clear();
+    for (auto i = existing; i < static_cast<int>(out.size()); i++)
+      relative(out[i]);
+    append(line.levels[level], vertices);
+
+    // Buckets after the first level hold 2 vertices each
+    groupSize = bucketFactor * 2;
+    available = static_cast<int>(out.size());
+  }
+}
+
+void GpuChartView::drawLine(const Line &line, int begin, int end, const QRectF &view, int width) {
+  if (!line.origin || end <= begin)
+    return;
+
+  glUniform2f(offsetLocation, static_cast<float>(line.origin->x() - view.x()),
+              static_cast<float>(line.origin->y() - view.y()));
+  glUniform2f(scaleLocation, static_cast<float>(2.0 / view.width()), static_cast<float>(2.0 / view.height()));
+  glUniform3f(colorLocation, line.source.color.redF(), line.source.color.greenF(), line.source.color.blueF());
+
+  const auto mode = line.source.scatter ? GL_POINTS : GL_LINE_STRIP;
+  auto draw = [this, mode](const Buffer &buffer, int first, int last) {
+    last = std::min(last, buffer.count);
+    if (last <= first)
+      return;
+    glBindVertexArray(buffer.vao);
+    glDrawArrays(mode, first, last - first);
+  };
+
+  // Only XY series have levels
+  auto level = 0;
+  auto bucket = 1;
+  if (line.source.xy) {
+    // Assume the points are spread evenly over X, it only picks the level
+    const auto &data = line.source.xy->data();
+    const auto span = toView(data[end - 1].x(), xAxis) - toView(data[begin].x(), xAxis);
+    const auto visible = span > 0.0 ? std::min(1.0, view.width() / span) : 1.0;
+    const auto perColumn = (end - begin) * visible / std::max(1, width);
+
+    while (level + 1 < maxLevels && line.levels[level + 1].count > 0 && bucket * bucketFactor <= perColumn) {
+      level++;
+      bucket *= bucketFactor;
+    }
+  }
+
+  const auto firstBucket = (begin + bucket - 1) / bucket;
+  const auto lastBucket = std::min(end / bucket, line.levels[level].count / 2);
+  if (level == 0 || firstBucket >= lastBucket) {
+    draw(line.levels[0], begin, end);
+    return;
+  }
+
+  // The points before the first & after the last complete bucket are drawn as they are,
+  // each overlapping the buckets by a point, so the strips join up
+  draw(line.levels[0], begin, std::min(end, firstBucket * bucket + 1));
+  draw(line.levels[level], firstBucket * 2, lastBucket * 2);
+  draw(line.levels[0], std::max(begin, lastBucket * bucket - 1), end);
+}
+
+void GpuChartView::paintOverlay(const QRectF &view) {
+  QPainter painter{this};
+  painter.setRenderHints(QPainter::Antialiasing | QPainter::TextAntialiasing);
+
+  const auto plot = plotArea();
+  const auto text = palette().color(QPalette::WindowText);
+  auto grid = text;
+  grid.setAlphaF(0.2);
+
+  painter.setPen(text);
+  painter.drawText(QRect{0, 0, width(), marginTop}, Qt::AlignCenter, title);
+  painter.drawRect(plot);
+
+  if (!xAxis || !yAxis)
+    return;
+
+  auto toPixelX = [&plot, &view](double x) {
+    return plot.left() + (x - view.x()) / view.width() * plot.width();
+  };
+  auto toPixelY = [&plot, &view](double y) {
+    return plot.top() + plot.height() - (y - view.y()) / view.height() * plot.height();
+  };
+  const auto metrics = painter.fontMetrics();
+  const auto lineHeight = metrics.height();
+
+  for (auto i = 0; i < tickCount; i++) {
+    const auto x = view.x() + view.width() * i / (tickCount - 1);
+    const auto pixel = toPixelX(x);
+    painter.setPen(grid);
+    painter.drawLine(QPointF{pixel, static_cast<double>(plot.top())}, QPointF{pixel, plot.top() + plot.height() + 4.0});
+
+    const auto label = QString::number(fromView(x, xAxis), 'g', 4);
+    painter.setPen(text);
+    painter.drawText(QRectF{pixel - 40.0, plot.top() + plot.height() + 4.0, 80.0, static_cast<double>(lineHeight)},
+                     Qt::AlignHCenter | Qt::AlignTop, label);
+  }
+
+  auto yTick = [&](double y, const QString &label) {
+    const auto pixel = toPixelY(y);
+    painter.setPen(grid);
+    painter.drawLine(QPointF{plot.left() - 4.0, pixel}, QPointF{static_cast<double>(plot.left() + plot.width()), pixel});
+    painter.setPen(text);
+    painter.drawText(QRectF{0.0, pixel - lineHeight / 2.0, plot.left() - 6.0, static_cast<double>(lineHeight)},
+                     Qt::AlignRight | Qt::AlignVCenter, label);
+  };
+
+  if (const auto categoryAxis = qobject_cast<const QtCharts::QCategoryAxis *>(yAxis)) {
+    // Labelled on the value of each category, as with `AxisLabelsPositionOnValue`
+    for (const auto &label : categoryAxis->categoriesLabels()) {
+      const auto y = categoryAxis->endValue(label);
+      if (y >= view.y() && y <= view.y() + view.height())
+        yTick(y, metrics.elidedText(label, Qt::ElideRight, plot.left() - 6));
+    }
+  } else {
+    for (auto i = 0; i < tickCount; i++) {
+      const auto y = view.y() + view.height() * i / (tickCount - 1);
+      yTick(y, QString::number(fromView(y, yAxis), 'g', 4));
+    }
+  }
+
+  // Axis titles
+  const auto xTitleTop = plot.top() + plot.height() + 4 + lineHeight;
+  painter.drawText(QRect{plot.left(), xTitleTop, plot.width(), lineHeight}, Qt::AlignCenter, xAxis->titleText());
+
+  painter.save();
+  painter.translate(0.0, plot.top() + plot.height() / 2.0);
+  painter.rotate(-90.0);
+  painter.drawText(QRect{-plot.height() / 2, 0, plot.height(), lineHeight}, Qt::AlignCenter, yAxis->titleText());
+  painter.restore();
+
+  // Legend, one row under the axis title
+  auto legendX = plot.left();
+  const auto legendTop = xTitleTop + lineHeight + 4;
+  for (const auto &line : lines) {
+    painter.fillRect(QRect{legendX, legendTop + 2, lineHeight - 4, lineHeight - 4}, line.source.color);
+    legendX += lineHeight;
+    painter.drawText(QPoint{legendX, legendTop + metrics.ascent()}, line.source.name);
+    legendX += metrics.horizontalAdvance(line.source.name) + lineHeight;
+  }
+}
+
+void GpuChartView::zoom(double horizontal, double vertical) {
+  const auto view = viewRange();
+  const auto center = view.center();
+  const auto width = view.width() / horizontal;
+  const auto height = view.height() / vertical;
+  zoomed = QRectF{center.x() - width / 2.0, center.y() - height / 2.0, width, height};
+  update();
+}
+
+void GpuChartView::scroll(double dx, double dy) {
+  const auto plot = plotArea();
+  auto view = viewRange();
+  view.translate(dx * view.width() / plot.width(), dy * view.height() / plot.height());
+  zoomed = view;
+  update();
+}
+
+void GpuChartView::initializeGL() {
+  initializeOpenGLFunctions();
+
+  const auto vertexSource = readShader(":/shader/shaders/chart.vert");
+  const auto fragmentSource = readShader(":/shader/shaders/chart.frag");
+
+  auto compile = [this](unsigned int type, const std::string &source) {
+    const auto id = glCreateShader(type);
+    const auto src = source.c_str();
+    glShaderSource(id, 1, &src, nullptr);
+    glCompileShader(id);
+
+    int result;
+    glGetShaderiv(id, GL_COMPILE_STATUS, &result);
+    if (!result) {
+      int length;
+      glGetShaderiv(id, GL_INFO_LOG_LENGTH, &length);
+      std::string message(static_cast<std::size_t>(std::max(length, 1)), '\0');
+      glGetShaderInfoLog(id, length, nullptr, message.data());
+      std::cerr << "Error, failed to compile chart shader\n"
+                << "----- MESSAGE -----\n"
+                << message << '\n';
+    }
+    return id;
+  };
+
+  const auto vertexShader = compile(GL_VERTEX_SHADER, vertexSource);
+  const auto fragmentShader = compile(GL_FRAGMENT_SHADER, fragmentSource);
+  program = glCreateProgram();
+  glAttachShader(program, vertexShader);
+  glAttachShader(program, fragmentShader);
+  glLinkProgram(program);
+  glDeleteShader(vertexShader);
+  glDeleteShader(fragmentShader);
+
+  offsetLocation = glGetUniformLocation(program, "offset");
+  scaleLocation = glGetUniformLocation(program, "scale");
+  colorLocation = glGetUniformLocation(program, "color");
+}
+
+void GpuChartView::paintGL() {
+  const auto background = palette().color(QPalette::Base);
+  glClearColor(background.redF(), background.greenF(), background.blueF(), 1.0f);
+  glClear(GL_COLOR_BUFFER_BIT);
+
+  const auto view = viewRange();
+  const auto plot = plotArea();
+  const auto ratio = devicePixelRatioF();
+
+  if (!lines.empty()) {
+    for (auto &line : lines)
+      upload(line);
+
+    // GL counts rows from the bottom
+    const auto x = static_cast<int>(plot.left() * ratio);
+    const auto y = static_cast<int>((height() - plot.top() - plot.height()) * ratio);
+    const auto w = static_cast<int>(plot.width() * ratio);
+    const auto h = static_cast<int>(plot.height() * ratio);
+    glViewport(x, y, w, h);
+    glScissor(x, y, w, h);
+    glEnable(GL_SCISSOR_TEST);
+    glUseProgram(program);
+    glPointSize(static_cast<float>(3.0 * ratio));
+
+    for (const auto &line : lines) {
+      if (line.source.xy)
+        drawLine(line, line.source.xy->begin(), line.source.xy->end(), view, w);
+      else
+        drawLine(line, 0, line.levels[0].count, view, w);
+    }
+
+    glDisable(GL_SCISSOR_TEST);
+    glBindVertexArray(0u);
+    glUseProgram(0u);
+  }
+
+  paintOverlay(view);
+}
+
+void GpuChartView::keyPressEvent(QKeyEvent *event) {
+  const auto ctrl = event->modifiers() & Qt::KeyboardModifier::ControlModifier;
+  const auto alt = event->modifiers() & Qt::KeyboardModifier::AltModifier;
+
+  switch (event->key()) {
+  case Qt::Key_Plus:
+    [[fallthrough]];
+  case Qt::Key_Equal: // Allow the + key next to Backspace to be used (without Shift)
+    zoom(alt ? 1.0 : zoomFactor, ctrl ? 1.0 : zoomFactor);
+    break;
+  case Qt::Key_Minus:
+    zoom(alt ? 1.0 : 1.0 / zoomFactor, ctrl ? 1.0 : 1.0 / zoomFactor);
+    break;
+  case Qt::Key_R:
+    zoomed.reset();
+    update();
+    break;
+  case Qt::Key_Left:
+    scroll(-scrollMagnitude, 0.0);
+    break;
+  case Qt::Key_Right:
+    scroll(scrollMagnitude, 0.0);
+    break;
+  case Qt::Key_Up:
+    scroll(0.0, scrollMagnitude);
+    break;
+  case Qt::Key_Down:
+    scroll(0.0, -scrollMagnitude);
+    break;
+  default:
+    QOpenGLWidget::keyPressEvent(event);
+    break;
+  }
+}
+
+void GpuChartView::mousePressEvent(QMouseEvent *event) {
+  // Only allow moves with Left Mouse
+  if (!(event->buttons() & Qt::LeftButton))
+    return;
+
+  mouseDown = true;
+  lastMousePosition = event->pos();
+}
+
+void GpuChartView::mouseMoveEvent(QMouseEvent *event) {
+  if (!mouseDown)
+    return;
+
+  // Invert delta Y, the view moves opposite the mouse
+  const auto delta = lastMousePosition - event->pos();
+  scroll(delta.x(), -delta.y());
+  lastMousePosition = event->pos();
+}
+
+void GpuChartView::mouseReleaseEvent(QMouseEvent *event) {
+  // If the event was fired but LeftMouse is still down
+  if (event->buttons() & Qt::LeftButton)
+    return;
+
+  mouseDown = false;
+}
+
+void GpuChartView::wheelEvent(QWheelEvent *event) {
+  const auto delta = event->angleDelta().y();
+  if (delta == 0) {
+    QOpenGLWidget::wheelEvent(event);
+    return;
+  }
+
+  const auto ctrl = event->modifiers() & Qt::KeyboardModifier::ControlModifier;
+  const auto alt = event->modifiers() & Qt::KeyboardModifier::AltModifier;
+  const auto factor = delta > 0 ? zoomFactor : 1.0 / zoomFactor;
+  zoom(alt ? 1.0 : factor, ctrl ? 1.0 : factor);
+}
+
+GpuChartView::GpuChartView(QWidget *parent) : QOpenGLWidget(parent) {
+  setFocusPolicy(Qt::StrongFocus);
+}
+
+GpuChartView::~GpuChartView() {
+  clear();
+  if (program != 0u) {
+    makeCurrent();
+    glDeleteProgram(program);
+    doneCurrent();
+  }
+}
+
+void GpuChartView::setLines(const QString &chartTitle, const std::vector<Source> &sources, QtCharts::QAbstractAxis *x,
+                            QtCharts::QAbstractAxis *y) {
+  clear();
+  title = chartTitle;
+  xAxis = x;
+  yAxis = y;
+
+  lines.reserve(sources.size());
+  for (const auto &source : sources)
+    lines.emplace_back(Line{source});
+
+  update();
+}
+
+void GpuChartView::clear() {
+  // Nothing was uploaded before the context was made
+  if (program != 0u) {
+    makeCurrent();
+    for (auto &line : lines)
+      deleteBuffers(line);
+    doneCurrent();
+  }
+
+  lines.clear();
+  title.clear();
+  xAxis = nullptr;
+  yAxis = nullptr;
+  zoomed.reset();
+  update();
+}
+
+} // namespace netsimulyzer
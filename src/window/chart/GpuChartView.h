@@ -0,0 +1,288 @@
+/*
+ * NIST-developed software is provided by NIST as a public service. You may use,
+ * copy and distribute copies of the software in any medium, provided that you
+ * keep intact this entire notice. You may improve,modify and create derivative
+ * works of the software or any portion of the software, and you may copy and
+ * distribute such modifications or works. Modified works should carry a notice
+ * stating that you changed the software and should note the date and nature of
+ * any such change. Please explicitly acknowledge the National Institute of
+ * Standards and Technology as the source of the software.
+ *
+ * NIST-developed software is expressly provided "AS IS." NIST MAKES NO
+ * WARRANTY OF ANY KIND, EXPRESS, IMPLIED, IN FACT OR ARISING BY OPERATION OF
+ * LAW, INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTY OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, NON-INFRINGEMENT
+ * AND DATA ACCURACY. NIST NEITHER REPRESENTS NOR WARRANTS THAT THE
+ * OPERATION OF THE SOFTWARE WILL BE UNINTERRUPTED OR ERROR-FREE, OR THAT
+ * ANY DEFECTS WILL BE CORRECTED. NIST DOES NOT WARRANT OR MAKE ANY
+ * REPRESENTATIONS REGARDING THE USE OF THE SOFTWARE OR THE RESULTS THEREOF,
+ * INCLUDING BUT NOT LIMITED TO THE CORRECTNESS, ACCURACY, RELIABILITY,
+ * OR USEFULNESS OF THE SOFTWARE.
+ *
+ * You are solely responsible for determining the appropriateness of using and
+ * distributing the software and you assume all risks associated with its use,
+ * including but not limited to the risks and costs of program errors,
+ * compliance with applicable laws, damage to or loss of data, programs or
+ * equipment, and the unavailability or interruption of operation. This
+ * software is not intended to be used in any situation where a failure could
+ * cause risk of injury or damage to property. The software developed by NIST
+ * employees is not subject to copyright protection within the United States.
+ *
+ * Author: Evan Black <evan.black@nist.gov>
+ */
+
+#pragma once
+
+#include "DecimatedSeries.h"
+#include <QColor>
+#include <QList>
+#include <QOpenGLFunctions_3_3_Core>
+#include <QOpenGLWidget>
+#include <QPoint>
+#include <QPointF>
+#include <QRect>
+#include <QRectF>
+#include <QString>
+#include <QtCharts/QAbstractAxis>
+#include <array>
+#include <optional>
+#include <vector>
+
+namespace netsimulyzer {
+
+/**
+ * Draws series straight from their columns with OpenGL,
+ * for series too large for QtCharts, even decimated.
+ *
+ * Every point of an XY series is uploaded once, as it is loaded,
+ * and the points on the series at the current time are drawn as a range of that buffer,
+ * so changing the time uploads nothing.
+ *
+ * Alongside the points, each series keeps levels of buckets of `bucketFactor`^level points,
+ * holding the lowest & highest point of each bucket, in their original order.
+ * Drawn as a line strip, these trace the envelope of the series through each bucket,
+ * so the level with around one bucket per pixel column draws the same image as every point,
+ * for a few vertices per column. Zooming & scrolling only change uniforms
+ */
+class GpuChartView : public QOpenGLWidget, protected QOpenGLFunctions_3_3_Core {
+  Q_OBJECT
+
+public:
+  /**
+   * A series to draw, which must outlive the lines on the view
+   */
+  struct Source {
+    QString name;
+    QColor color;
+
+    /**
+     * Draw the points unconnected
+     */
+    bool scatter{false};
+
+    /**
+     * The columns of an XY series, or null for `values`
+     */
+    const DecimatedSeries *xy{nullptr};
+
+    /**
+     * The values of a category value series, or null for `xy`.
+     * Uploaded whole whenever the view is drawn, as these have a value per state change
+     */
+    const QList<QPointF> *values{nullptr};
+  };
+
+private:
+  /**
+   * The number of buckets from one level merged into each bucket of the next
+   */
+  static constexpr int bucketFactor = 4;
+  static constexpr int maxLevels = 12;
+
+  /**
+   * Space around the plot for the title, axes, & legend, in pixels
+   */
+  static constexpr int marginLeft = 64;
+  static constexpr int marginRight = 16;
+  static constexpr int marginTop = 28;
+  static constexpr int marginBottom = 64;
+
+  /**
+   * The labelled ticks on each value axis
+   */
+  static constexpr int tickCount = 5;
+
+  /**
+   * The amount to scale the view when zooming
+   */
+  static constexpr double zoomFactor = 2.0;
+
+  /**
+   * The amount to move the view scrolling, in pixels
+   */
+  static constexpr double scrollMagnitude = 10.0;
+
+  /**
+   * One growable vertex buffer
+   */
+  struct Buffer {
+    unsigned int vao{0u};
+    unsigned int vbo{0u};
+
+    /**
+     * The number of vertices uploaded
+     */
+    int count{0};
+
+    /**
+     * The number of vertices the buffer holds before it is reallocated
+     */
+    int capacity{0};
+  };
+
+  struct Line {
+    Source source;
+
+    /**
+     * Every vertex is relative to this point, so the float positions
+     * keep their precision far from 0. Set from the first point
+     */
+    std::optional<QPointF> origin;
+
+    /**
+     * Level 0 holds every point, level `n` holds 2 vertices for each bucket of `bucketFactor`^n points
+     */
+    std::array<Buffer, maxLevels> levels{};
+
+    /**
+     * The vertices of each level after 0, for building the next level from.
+     * Level 0 is read from the source
+     */
+    std::array<std::vector<QPointF>, maxLevels> levelPoints{};
+  };
+
+  std::vector<Line> lines;
+  QString title;
+  QtCharts::QAbstractAxis *xAxis{nullptr};
+  QtCharts::QAbstractAxis *yAxis{nullptr};
+
+  /**
+   * The range shown, in view space (see `toView()`), while zoomed or scrolled.
+   * Follows the axes otherwise
+   */
+  std::optional<QRectF> zoomed;
+
+  unsigned int program{0u};
+  int offsetLocation{-1};
+  int scaleLocation{-1};
+  int colorLocation{-1};
+
+  bool mouseDown{false};
+  QPoint lastMousePosition;
+
+  /**
+   * Map a value to the space it is drawn in, its log for a log axis
+   */
+  [[nodiscard]] static double toView(double value, const QtCharts::QAbstractAxis *axis);
+  [[nodiscard]] static double fromView(double value, const QtCharts::QAbstractAxis *axis);
+
+  /**
+   * @return
+   * The range of the axes, in view space
+   */
+  [[nodiscard]] QRectF axesRange() const;
+
+  /**
+   * @return
+   * The range shown, in view space
+   */
+  [[nodiscard]] QRectF viewRange() const;
+
+  /**
+   * @return
+   * The area the series are drawn in, in widget pixels
+   */
+  [[nodiscard]] QRect plotArea() const;
+
+  /**
+   * Upload `vertices` to the end of `buffer`, growing it if needed
+   */
+  void append(Buffer &buffer, const std::vector<float> &vertices);
+  void deleteBuffers(Line &line);
+
+  /**
+   * Upload the points & buckets added to the source of `line` since the last call
+   */
+  void upload(Line &line);
+
+  /**
+   * Draw the points of `line` from `begin` up to `end`, from the coarsest level
+   * with at least one bucket per pixel column
+   */
+  void drawLine(const Line &line, int begin, int end, const QRectF &view, int width);
+
+  /**
+   * Draw the axes, title, & legend around the plot
+   */
+  void paintOverlay(const QRectF &view);
+
+  /**
+   * Zoom about the center of the view
+   *
+   * @param horizontal
+   * The factor to scale the width of the view by
+   *
+   * @param vertical
+   * The factor to scale the height of the view by
+   */
+  void zoom(double horizontal, double vertical);
+
+  /**
+   * Move the view
+   *
+   * @param dx
+   * Pixels to move right
+   *
+   * @param dy
+   * Pixels to move up
+   */
+  void scroll(double dx, double dy);
+
+protected:
+  void initializeGL() override;
+  void paintGL() override;
+  void keyPressEvent(QKeyEvent *event) override;
+  void mousePressEvent(QMouseEvent *event) override;
+  void mouseMoveEvent(QMouseEvent *event) override;
+  void mouseReleaseEvent(QMouseEvent *event) override;
+  void wheelEvent(QWheelEvent *event) override;
+
+public:
+  explicit GpuChartView(QWidget *parent);
+  ~GpuChartView() override;
+
+  /**
+   * Draw `sources` against a pair of axes, in place of anything drawn before
+   *
+   * @param chartTitle
+   * The title drawn above the plot
+   *
+   * @param sources
+   * The series to draw
+   *
+   * @param x
+   * The horizontal axis. The view follows its range until zoomed
+   *
+   * @param y
+   * The vertical axis. The view follows its range until zoomed
+   */
+  void setLines(const QString &chartTitle, const std::vector<Source> &sources, QtCharts::QAbstractAxis *x,
+                QtCharts::QAbstractAxis *y);
+
+  /**
+   * Remove every line & the axes
+   */
+  void clear();
+};
+
+} // namespace netsimulyzer
@@ -38,6 +38,7 @@
 #include <QStandardItem>
 #include <algorithm>
 #include <glm/vec3.hpp>
+#include <utility>
 
 namespace {
 QString ns3ToQString(const parser::Ns3Color3 &color) {
@@ -116,21 +117,63 @@ DetailWidget::DetailTreeModel::DetailTreeModel(QObject *parent) : QAbstractItemM
   positionOrientation.children.emplace_back(DisplayField::PositionOrientationX, &positionOrientation);
   positionOrientation.children.emplace_back(DisplayField::PositionOrientationY, &positionOrientation);
   positionOrientation.children.emplace_back(DisplayField::PositionOrientationZ, &positionOrientation);
+
+  auto &traffic = rootElement.children.emplace_back(DisplayField::Traffic, &rootElement, 3u);
+  traffic.children.emplace_back(DisplayField::TrafficTransmissions, &traffic);
+  traffic.children.emplace_back(DisplayField::TrafficRate, &traffic);
+  traffic.children.emplace_back(DisplayField::TrafficDistance, &traffic);
+
+  auto &scenario = rootElement.children.emplace_back(DisplayField::Scenario, &rootElement, 4u);
+  scenario.children.emplace_back(DisplayField::ScenarioTransmissions, &scenario);
+  scenario.children.emplace_back(DisplayField::ScenarioRate, &scenario);
+  scenario.children.emplace_back(DisplayField::ScenarioBusiest, &scenario);
+  scenario.children.emplace_back(DisplayField::ScenarioDistance, &scenario);
 }
 
-void DetailWidget::DetailTreeModel::describe(const Node &n) {
+void DetailWidget::DetailTreeModel::describe(const Node &n, std::uint32_t nodeSlot) {
   beginResetModel();
   node = &n;
+  slot = nodeSlot;
   endResetModel();
 }
 
 void DetailWidget::DetailTreeModel::reset() {
   node = nullptr;
+  slot = parser::TrafficStatistics::allNodes;
+  time = 0LL;
+}
+
+void DetailWidget::DetailTreeModel::setTrafficStatistics(const parser::TrafficStatistics &statistics,
+                                                          std::function<QString(std::uint32_t)> namer) {
+  traffic = &statistics;
+  nodeName = std::move(namer);
+}
+
+void DetailWidget::DetailTreeModel::setTime(parser::nanoseconds value) {
+  time = value;
+}
+
+void DetailWidget::DetailTreeModel::valuesChanged(const QModelIndex &parent) {
+  emit dataChanged(index(parent.row(), 1, parent.parent()), index(parent.row(), 1, parent.parent()),
+                   {Qt::DisplayRole, Qt::DecorationRole});
+
+  const auto count = rowCount(parent);
+  for (auto row = 0; row < count; row++)
+    valuesChanged(index(row, 0, parent));
 }
 
 void DetailWidget::DetailTreeModel::refresh() {
-  beginResetModel();
-  endResetModel();
+  if (node == nullptr)
+    return;
+
+  const auto count = static_cast<int>(rootElement.children.size());
+  for (auto row = 0; row < count; row++) {
+    // The name, ID, & model never change
+    if (rootElement.children[row].field == DisplayField::Name)
+      continue;
+
+    valuesChanged(index(row, 0, {}));
+  }
 }
 
 QVariant DetailWidget::DetailTreeModel::data(const QModelIndex &index, int role) const {
@@ -219,6 +262,21 @@ QVariant DetailWidget::DetailTreeModel::data(const QModelIndex &index, int role)
       return "Width";
     case DisplayField::SizeDepth:
       return "Depth";
+    case DisplayField::Traffic:
+      return "Traffic";
+    case DisplayField::TrafficTransmissions:
+    case DisplayField::ScenarioTransmissions:
+      return "Transmissions";
+    case DisplayField::TrafficRate:
+    case DisplayField::ScenarioRate:
+      return "Transmissions/s";
+    case DisplayField::TrafficDistance:
+    case DisplayField::ScenarioDistance:
+      return "Distance Moved";
+    case DisplayField::Scenario:
+      return "Scenario";
+    case DisplayField::ScenarioBusiest:
+      return "Busiest Node";
     default:
       return "!ERROR!";
     }
@@ -226,8 +284,8 @@ QVariant DetailWidget::DetailTreeModel::data(const QModelIndex &index, int role)
     if (node == nullptr)
       return "";
 
-    const auto ns3 = node->getNs3Model();
-    const auto netsim = node->getModel();
+    const auto &ns3 = node->getNs3Model();
+    const auto &netsim = node->getModel();
 
     switch (field) {
     case DisplayField::None:
@@ -260,13 +318,13 @@ QVariant DetailWidget::DetailTreeModel::data(const QModelIndex &index, int role)
     case DisplayField::Position:
       [[fallthrough]];
     case DisplayField::PositionSub:
-      return ns3ToQString(ns3.position);
+      return ns3ToQString(node->getNs3Position());
     case DisplayField::PositionSubX:
-      return QString::number(ns3.position.x);
+      return QString::number(node->getNs3Position().x);
     case DisplayField::PositionSubY:
-      return QString::number(ns3.position.y);
+      return QString::number(node->getNs3Position().y);
     case DisplayField::PositionSubZ:
-      return QString::number(ns3.position.z);
+      return QString::number(node->getNs3Position().z);
 
     // ----- Position Final -----
     case DisplayField::PositionRendered:
@@ -320,6 +378,21 @@ QVariant DetailWidget::DetailTreeModel::data(const QModelIndex &index, int role)
         return QString::number(ns3.depth.value());
       return "";
     }
+
+    // ----- Traffic -----
+    case DisplayField::Traffic:
+      [[fallthrough]];
+    case DisplayField::Scenario:
+      return "";
+    case DisplayField::TrafficTransmissions:
+    case DisplayField::TrafficRate:
+    case DisplayField::TrafficDistance:
+    case DisplayField::ScenarioTransmissions:
+    case DisplayField::ScenarioRate:
+    case DisplayField::ScenarioBusiest:
+      [[fallthrough]];
+    case DisplayField::ScenarioDistance:
+      return trafficValue(field);
     default:
       return "!ERROR!";
     }
@@ -329,6 +402,45 @@ QVariant DetailWidget::DetailTreeModel::data(const QModelIndex &index, int role)
   }
 }
 
+QVariant DetailWidget::DetailTreeModel::trafficValue(DisplayField field) const {
+  if (traffic == nullptr)
+    return "";
+
+  using parser::TrafficStatistics;
+  // Slots past the statistics belong to a scenario still being set up
+  const auto nodeSlot = slot < traffic->nodeCount() ? slot : TrafficStatistics::allNodes;
+  switch (field) {
+  case DisplayField::TrafficTransmissions:
+    if (nodeSlot == TrafficStatistics::allNodes)
+      return "";
+    return QString::number(traffic->transmissions(nodeSlot, time));
+  case DisplayField::TrafficRate:
+    if (nodeSlot == TrafficStatistics::allNodes)
+      return "";
+    return QString::number(traffic->transmissionRate(nodeSlot, time));
+  case DisplayField::TrafficDistance:
+    if (nodeSlot == TrafficStatistics::allNodes)
+      return "";
+    return QString::number(traffic->distance(nodeSlot, time));
+  case DisplayField::ScenarioTransmissions:
+    return QString::number(traffic->transmissions(TrafficStatistics::allNodes, time));
+  case DisplayField::ScenarioRate:
+    return QString::number(traffic->transmissionRate(TrafficStatistics::allNodes, time));
+  case DisplayField::ScenarioBusiest: {
+    // Over the last second, like the rates
+    const auto busiest = traffic->busiest(time);
+    if (busiest.slot == TrafficStatistics::allNodes)
+      return "None";
+    const auto name = nodeName ? nodeName(busiest.slot) : QString::number(busiest.slot);
+    return QString("%1 (%2/s)").arg(name).arg(busiest.transmissions);
+  }
+  case DisplayField::ScenarioDistance:
+    return QString::number(traffic->distance(TrafficStatistics::allNodes, time));
+  default:
+    return "";
+  }
+}
+
 QVariant DetailWidget::DetailTreeModel::headerData(int section, Qt::Orientation orientation, int role) const {
   if (orientation != Qt::Orientation::Horizontal || role != Qt::DisplayRole)
     return {};
@@ -418,21 +530,63 @@ void DetailWidget::restoreExpandedItems() {
 DetailWidget::DetailWidget(QWidget *parent) : QWidget(parent) {
   ui.setupUi(this);
   ui.treeView->setModel(&model);
+
+  refreshTimer.setSingleShot(true);
+  const auto setRefreshRate = [this]() {
+    // 0 refreshes on every change
+    const auto rate = settings.get<int>(SettingsManager::Key::DetailRefreshRate).value();
+    refreshTimer.setInterval(rate > 0 ? std::max(1, 1000 / rate) : 0);
+  };
+  setRefreshRate();
+  QObject::connect(&SettingsManager::notifier(), &SettingsNotifier::changed, this, [setRefreshRate](int key) {
+    if (static_cast<SettingsManager::Key>(key) == SettingsManager::Key::DetailRefreshRate)
+      setRefreshRate();
+  });
+
+  QObject::connect(&refreshTimer, &QTimer::timeout, [this]() {
+    if (!refreshPending)
+      return;
+
+    // Hold back the next change for another interval
+    refreshPending = false;
+    model.refresh();
+    refreshTimer.start();
+  });
 }
 
-void DetailWidget::describe(const Node &node) {
+void DetailWidget::describe(const Node &node, std::uint32_t slot) {
+  refreshTimer.stop();
+  refreshPending = false;
+
   saveExpandedItems();
-  model.describe(node);
+  model.describe(node, slot);
   restoreExpandedItems();
 }
 
+void DetailWidget::setTrafficStatistics(const parser::TrafficStatistics &statistics,
+                                        std::function<QString(std::uint32_t)> nodeName) {
+  model.setTrafficStatistics(statistics, std::move(nodeName));
+}
+
+void DetailWidget::timeChanged(parser::nanoseconds time) {
+  model.setTime(time);
+  describedItemUpdated();
+}
+
 void DetailWidget::describedItemUpdated() {
-  saveExpandedItems();
+  if (refreshTimer.isActive()) {
+    refreshPending = true;
+    return;
+  }
+
   model.refresh();
-  restoreExpandedItems();
+  if (refreshTimer.interval() > 0)
+    refreshTimer.start();
 }
 
 void DetailWidget::reset() {
+  refreshTimer.stop();
+  refreshPending = false;
   model.reset();
 }
 } // namespace netsimulyzer
@@ -33,12 +33,17 @@
 
 #pragma once
 #include "src/group/node/Node.h"
+#include "src/settings/SettingsManager.h"
 #include "ui_DetailWidget.h"
 #include <QAbstractItemModel>
 #include <QObject>
 #include <QPoint>
 #include <QString>
+#include <QTimer>
 #include <QWidget>
+#include <cstdint>
+#include <functional>
+#include <traffic-stats.h>
 #include <vector>
 
 namespace netsimulyzer {
@@ -77,7 +82,16 @@ class DetailWidget : public QWidget {
     SizeScale,
     SizeHeight,
     SizeWidth,
-    SizeDepth
+    SizeDepth,
+    Traffic,
+    TrafficTransmissions,
+    TrafficRate,
+    TrafficDistance,
+    Scenario,
+    ScenarioTransmissions,
+    ScenarioRate,
+    ScenarioBusiest,
+    ScenarioDistance
   };
 
   struct DetailTreeItem {
@@ -100,10 +114,52 @@ class DetailWidget : public QWidget {
     const Node *node{nullptr};
     DetailTreeItem rootElement{10u};
 
+    /**
+     * The totals the traffic rows are read from, unset until `setTrafficStatistics()`
+     */
+    const parser::TrafficStatistics *traffic{nullptr};
+
+    /**
+     * Names the Node in a slot of `traffic`
+     */
+    std::function<QString(std::uint32_t)> nodeName;
+
+    /**
+     * The slot of `node` in `traffic`
+     */
+    std::uint32_t slot{parser::TrafficStatistics::allNodes};
+
+    /**
+     * The time the traffic rows are shown for
+     */
+    parser::nanoseconds time{0LL};
+
+    /**
+     * Signal the value column of every row under `parent` changed
+     *
+     * @param parent
+     * The row to start from, included
+     */
+    void valuesChanged(const QModelIndex &parent);
+
+    /**
+     * @return
+     * The value of a Traffic or Scenario row at `time`
+     */
+    [[nodiscard]] QVariant trafficValue(DisplayField field) const;
+
   public:
     explicit DetailTreeModel(QObject *parent);
-    void describe(const Node &n);
+    void describe(const Node &n, std::uint32_t nodeSlot);
     void reset();
+    void setTrafficStatistics(const parser::TrafficStatistics &statistics,
+                              std::function<QString(std::uint32_t)> namer);
+    void setTime(parser::nanoseconds value);
+
+    /**
+     * Signal the values events may change were changed,
+     * without rebuilding the tree
+     */
     void refresh();
     [[nodiscard]] QModelIndexList getPersistentIndexList() const;
 
@@ -116,15 +172,58 @@ class DetailWidget : public QWidget {
   };
 
   Ui::DetailWidget ui{};
+  SettingsManager settings;
   DetailTreeModel model{this};
   std::vector<QModelIndex> oldExpandedItems;
 
+  /**
+   * Running while refreshes are held back, see `describedItemUpdated()`
+   */
+  QTimer refreshTimer;
+
+  /**
+   * If the described item changed while `refreshTimer` was running
+   */
+  bool refreshPending{false};
+
   void saveExpandedItems();
   void restoreExpandedItems();
 
 public:
   explicit DetailWidget(QWidget *parent = nullptr);
-  void describe(const Node &node);
+
+  /**
+   * @param node
+   * The Node to show
+   *
+   * @param slot
+   * The slot of `node` in the traffic statistics, see `setTrafficStatistics()`
+   */
+  void describe(const Node &node, std::uint32_t slot);
+
+  /**
+   * Show the totals of the described Node & of the whole scenario from `statistics`
+   *
+   * @param statistics
+   * The totals to show. Must outlive the widget
+   *
+   * @param nodeName
+   * Names the Node in a slot of `statistics`, for the busiest Node
+   */
+  void setTrafficStatistics(const parser::TrafficStatistics &statistics,
+                            std::function<QString(std::uint32_t)> nodeName);
+
+  /**
+   * Show the traffic totals at `time`.
+   * Held back like `describedItemUpdated()`
+   */
+  void timeChanged(parser::nanoseconds time);
+
+  /**
+   * Show the changes to the described item.
+   * Refreshes at most `SettingsManager::Key::DetailRefreshRate` times a second,
+   * a change within that time is shown once it passes
+   */
   void describedItemUpdated();
   void reset();
 };
@@ -0,0 +1,153 @@
+/*
+ * NIST-developed software is provided by NIST as a public service. You may use,
+ * copy and distribute copies of the software in any medium, provided that you
+ * keep intact this entire notice. You may improve,modify and create derivative
+ * works of the software or any portion of the software, and you may copy and
+ * distribute such modifications or works. Modified works should carry a notice
+ * stating that you changed the software and should note the date and nature of
+ * any such change. Please explicitly acknowledge the National Institute of
+ * Standards and Technology as the source of the software.
+ *
+ * NIST-developed software is expressly provided "AS IS." NIST MAKES NO
+ * WARRANTY OF ANY KIND, EXPRESS, IMPLIED, IN FACT OR ARISING BY OPERATION OF
+ * LAW, INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTY OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, NON-INFRINGEMENT
+ * AND DATA ACCURACY. NIST NEITHER REPRESENTS NOR WARRANTS THAT THE
+ * OPERATION OF THE SOFTWARE WILL BE UNINTERRUPTED OR ERROR-FREE, OR THAT
+ * ANY DEFECTS WILL BE CORRECTED. NIST DOES NOT WARRANT OR MAKE ANY
+ * REPRESENTATIONS REGARDING THE USE OF THE SOFTWARE OR THE RESULTS THEREOF,
+ * INCLUDING BUT NOT LIMITED TO THE CORRECTNESS, ACCURACY, RELIABILITY,
+ * OR USEFULNESS OF THE SOFTWARE.
+ *
+ * You are solely responsible for determining the appropriateness of using and
+ * distributing the software and you assume all risks associated with its use,
+ * including but not limited to the risks and costs of program errors,
+ * compliance with applicable laws, damage to or loss of data, programs or
+ * equipment, and the unavailability or interruption of operation. This
+ * software is not intended to be used in any situation where a failure could
+ * cause risk of injury or damage to property. The software developed by NIST
+ * employees is not subject to copyright protection within the United States.
+ *
+ * Author: Evan Black <evan.black@nist.gov>
+ */
+
+#include "CompressedText.h"
+#include <algorithm>
+#include <utility>
+
+namespace netsimulyzer {
+
+void CompressedText::settle() const {
+  // Blocks are submitted in order, so most finish in order as well
+  while (firstPending < blocks.size() && blocks[firstPending].task.done()) {
+    blocks[firstPending].raw.reset();
+    firstPending++;
+  }
+}
+
+std::string_view CompressedText::blockText(std::size_t index) const {
+  const auto &block = blocks[index];
+  if (block.raw)
+    return *block.raw;
+
+  const auto cached = std::find_if(cache.begin(), cache.end(), [index](const CachedBlock &entry) {
+    return entry.block == index;
+  });
+  if (cached != cache.end()) {
+    std::rotate(cache.begin(), cached, cached + 1);
+  } else {
+    if (cache.size() == cachedBlocks)
+      cache.pop_back();
+    cache.insert(cache.begin(), CachedBlock{index, qUncompress(*block.compressed)});
+  }
+
+  const auto &text = cache.front().text;
+  return {text.constData(), static_cast<std::size_t>(text.size())};
+}
+
+std::size_t CompressedText::size() const {
+  return tailStart + tail.size();
+}
+
+std::size_t CompressedText::append(std::string_view value) {
+  const auto offset = size();
+  tail.append(value);
+  if (tail.size() < blockSize)
+    return offset;
+
+  auto raw = std::make_shared<const std::string>(std::move(tail));
+  auto compressed = std::make_shared<QByteArray>();
+  auto task = parser::TaskPool::shared().submit(
+      [raw, compressed]() {
+        // Favours speed, log text compresses well regardless
+        *compressed = qCompress(reinterpret_cast<const uchar *>(raw->data()), static_cast<int>(raw->size()), 1);
+      },
+      parser::TaskPool::Priority::Background);
+
+  blocks.push_back({tailStart, raw->size(), std::move(raw), std::move(compressed), std::move(task)});
+  tailStart += blocks.back().size;
+  tail = std::string{};
+  tail.reserve(blockSize);
+
+  settle();
+  return offset;
+}
+
+std::string_view CompressedText::read(std::size_t offset, std::size_t length) const {
+  if (offset >= tailStart)
+    return std::string_view{tail}.substr(offset - tailStart, length);
+
+  settle();
+
+  // The block holding `offset`
+  const auto after = std::upper_bound(blocks.begin(), blocks.end(), offset, [](std::size_t value, const Block &block) {
+    return value < block.start;
+  });
+  auto index = static_cast<std::size_t>(after - blocks.begin()) - 1u;
+
+  const auto &first = blocks[index];
+  if (offset + length <= first.start + first.size)
+    return blockText(index).substr(offset - first.start, length);
+
+  // Lines continued across messages may cross into the next blocks
+  spanning.clear();
+  while (length > 0u) {
+    const auto blockStart = index < blocks.size() ? blocks[index].start : tailStart;
+    const auto text = index < blocks.size() ? blockText(index) : std::string_view{tail};
+    const auto part = text.substr(offset - blockStart, length);
+    spanning.append(part);
+    offset += part.size();
+    length -= part.size();
+    index++;
+  }
+
+  return spanning;
+}
+
+std::size_t CompressedText::memoryUsage() const {
+  settle();
+  auto bytes = tail.capacity() + spanning.capacity() + blocks.capacity() * sizeof(Block);
+  for (auto i = 0u; i < blocks.size(); i++) {
+    const auto &block = blocks[i];
+    if (block.raw)
+      bytes += block.raw->capacity();
+    if (i < firstPending)
+      bytes += static_cast<std::size_t>(block.compressed->capacity());
+  }
+  for (const auto &entry : cache)
+    bytes += static_cast<std::size_t>(entry.text.capacity());
+
+  return bytes;
+}
+
+void CompressedText::clear() {
+  // Running tasks hold their own text & output
+  blocks.clear();
+  firstPending = 0u;
+  tail.clear();
+  tailStart = 0u;
+  cache.clear();
+  spanning.clear();
+}
+
+} // namespace netsimulyzer
@@ -0,0 +1,177 @@
+/*
+ * NIST-developed software is provided by NIST as a public service. You may use,
+ * copy and distribute copies of the software in any medium, provided that you
+ * keep intact this entire notice. You may improve,modify and create derivative
+ * works of the software or any portion of the software, and you may copy and
+ * distribute such modifications or works. Modified works should carry a notice
+ * stating that you changed the software and should note the date and nature of
+ * any such change. Please explicitly acknowledge the National Institute of
+ * Standards and Technology as the source of the software.
+ *
+ * NIST-developed software is expressly provided "AS IS." NIST MAKES NO
+ * WARRANTY OF ANY KIND, EXPRESS, IMPLIED, IN FACT OR ARISING BY OPERATION OF
+ * LAW, INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTY OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, NON-INFRINGEMENT
+ * AND DATA ACCURACY. NIST NEITHER REPRESENTS NOR WARRANTS THAT THE
+ * OPERATION OF THE SOFTWARE WILL BE UNINTERRUPTED OR ERROR-FREE, OR THAT
+ * ANY DEFECTS WILL BE CORRECTED. NIST DOES NOT WARRANT OR MAKE ANY
+ * REPRESENTATIONS REGARDING THE USE OF THE SOFTWARE OR THE RESULTS THEREOF,
+ * INCLUDING BUT NOT LIMITED TO THE CORRECTNESS, ACCURACY, RELIABILITY,
+ * OR USEFULNESS OF THE SOFTWARE.
+ *
+ * You are solely responsible for determining the appropriateness of using and
+ * distributing the software and you assume all risks associated with its use,
+ * including but not limited to the risks and costs of program errors,
+ * compliance with applicable laws, damage to or loss of data, programs or
+ * equipment, and the unavailability or interruption of operation. This
+ * software is not intended to be used in any situation where a failure could
+ * cause risk of injury or damage to property. The software developed by NIST
+ * employees is not subject to copyright protection within the United States.
+ *
+ * Author: Evan Black <evan.black@nist.gov>
+ */
+
+#pragma once
+
+#include <QByteArray>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <task-pool.h>
+#include <vector>
+
+namespace netsimulyzer {
+
+/**
+ * Append-only text, addressed by byte offset, kept in blocks compressed on the task pool.
+ * The latest block is kept as is, until it fills. Blocks being compressed are read as is
+ * until they are done, and compressed blocks are decompressed as they are read,
+ * with the most recently read kept, so reading near the same place decompresses once.
+ * Not thread safe, reading changes the kept blocks
+ */
+class CompressedText {
+  /**
+   * A full block, compressed or being compressed
+   */
+  struct Block {
+    /**
+     * The offset of the first byte of the block
+     */
+    std::size_t start;
+    std::size_t size;
+
+    /**
+     * The text of the block, until `task` is seen to finish
+     */
+    std::shared_ptr<const std::string> raw;
+
+    /**
+     * Filled by `task`. Only read once it's done
+     */
+    std::shared_ptr<QByteArray> compressed;
+    parser::TaskPool::Handle task;
+  };
+
+  /**
+   * A decompressed block, see `cache`
+   */
+  struct CachedBlock {
+    std::size_t block;
+    QByteArray text;
+  };
+
+  /**
+   * Mutable, as the text of blocks which finished compressing is dropped as they are read
+   */
+  mutable std::vector<Block> blocks;
+
+  /**
+   * The index in `blocks` of the first which may still be compressing
+   */
+  mutable std::size_t firstPending{0u};
+
+  /**
+   * The text after the full blocks
+   */
+  std::string tail;
+
+  /**
+   * The offset of the first byte of `tail`
+   */
+  std::size_t tailStart{0u};
+
+  /**
+   * The most recently read blocks, most recent first
+   */
+  mutable std::vector<CachedBlock> cache;
+
+  /**
+   * Holds reads spanning several blocks
+   */
+  mutable std::string spanning;
+
+  /**
+   * Drop the text of the blocks which finished compressing
+   */
+  void settle() const;
+
+  /**
+   * @return
+   * The text of the block at `index`, decompressing it if needed
+   */
+  [[nodiscard]] std::string_view blockText(std::size_t index) const;
+
+public:
+  /**
+   * The size `tail` grows to before it is compressed
+   */
+  static constexpr std::size_t blockSize = 256u * 1024u;
+
+  /**
+   * The most decompressed blocks kept
+   */
+  static constexpr std::size_t cachedBlocks = 8u;
+
+  /**
+   * @return
+   * The number of bytes appended
+   */
+  [[nodiscard]] std::size_t size() const;
+
+  /**
+   * Add text to the end
+   *
+   * @param value
+   * The text to add
+   *
+   * @return
+   * The offset of the first byte of `value`
+   */
+  std::size_t append(std::string_view value);
+
+  /**
+   * @param offset
+   * The offset of the first byte to read
+   *
+   * @param length
+   * The number of bytes to read, which must all have been appended
+   *
+   * @return
+   * The text, valid until the next call to `read()` or `append()`
+   */
+  [[nodiscard]] std::string_view read(std::size_t offset, std::size_t length) const;
+
+  /**
+   * @return
+   * The bytes held by the compressed, pending, latest, & decompressed blocks
+   */
+  [[nodiscard]] std::size_t memoryUsage() const;
+
+  /**
+   * Remove all of the text
+   */
+  void clear();
+};
+
+} // namespace netsimulyzer
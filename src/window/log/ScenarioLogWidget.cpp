@@ -34,193 +34,595 @@
 #include "ScenarioLogWidget.h"
 #include "../../conversion.h"
 #include "ui_ScenarioLogWidget.h"
-#include <QColor>
+#include <QAction>
+#include <QApplication>
+#include <QClipboard>
+#include <QKeySequence>
+#include <QListWidgetItem>
+#include <QSignalBlocker>
 #include <QString>
+#include <QStringList>
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+#include <string_view>
+#include <trace.h>
 #include <variant>
 
 namespace netsimulyzer {
 
-ScenarioLogWidget::LogStreamPair::LogStreamPair(parser::LogStream model) : model(std::move(model)) {
-  data->setDocumentLayout(new QPlainTextDocumentLayout(data.get()));
-  if (this->model.color) {
-    const auto &color = *this->model.color;
-    textFormat.setForeground(QColor{color.red, color.green, color.blue, 255});
+bool ScenarioLogWidget::Filter::all() const {
+  return streams.empty() && !range;
+}
+
+bool ScenarioLogWidget::Filter::matches(unsigned int streamId, parser::nanoseconds time) const {
+  if (!streams.empty() && !std::binary_search(streams.begin(), streams.end(), streamId))
+    return false;
+
+  return !range || (time >= range->first && time <= range->second);
+}
+
+ScenarioLogWidget::LogModel::~LogModel() {
+  cancelFilter();
+}
+
+int ScenarioLogWidget::LogModel::lineCount() const {
+  if (filter.all())
+    return static_cast<int>(lines.size());
+
+  return static_cast<int>(rows.size());
+}
+
+const ScenarioLogWidget::LogModel::Line &ScenarioLogWidget::LogModel::lineAt(int row) const {
+  if (filter.all())
+    return lines[row];
+
+  return lines[rows[row]];
+}
+
+int ScenarioLogWidget::LogModel::rowCount(const QModelIndex &parent) const {
+  // Flat list, no children
+  if (parent.isValid())
+    return 0;
+
+  return shownRows;
+}
+
+QVariant ScenarioLogWidget::LogModel::data(const QModelIndex &index, int role) const {
+  if (!index.isValid() || index.row() >= shownRows)
+    return {};
+
+  const auto &line = lineAt(index.row());
+  const auto &stream = streams.at(line.streamId);
+
+  switch (role) {
+  case Qt::DisplayRole: {
+    const auto bytes = text.read(line.offset, line.length);
+    const auto value = QString::fromUtf8(bytes.data(), static_cast<int>(bytes.size()));
+
+    // Lines from every stream are marked with their stream's name
+    if (prompts)
+      return {'[' + stream.name + "]: " + value};
+    return {value};
+  }
+  case Qt::ForegroundRole:
+    if (stream.color)
+      return QVariant::fromValue(*stream.color);
+    return {};
+  case Qt::ToolTipRole:
+    return {toDisplayTime(line.time, SettingsManager::TimeUnit::Milliseconds)};
+  default:
+    return {};
+  }
+}
+
+void ScenarioLogWidget::LogModel::addStream(const parser::LogStream &stream) {
+  Stream value;
+  value.name = QString::fromStdString(stream.name);
+  if (stream.color) {
+    const auto &color = *stream.color;
+    value.color = QColor{color.red, color.green, color.blue, 255};
   }
 
-  name = QString::fromStdString(this->model.name);
+  streams.try_emplace(stream.id, value);
 }
 
-void ScenarioLogWidget::handleEvent(const parser::StreamAppendEvent &e) {
-  const auto &iter = streams.find(e.streamId);
-  if (iter == streams.end())
-    return;
+bool ScenarioLogWidget::LogModel::hasStream(unsigned int id) const {
+  return streams.find(id) != streams.end();
+}
 
+const QString &ScenarioLogWidget::LogModel::streamName(unsigned int id) const {
+  return streams.at(id).name;
+}
+
+undo::StreamAppendEvent ScenarioLogWidget::LogModel::mark() const {
   undo::StreamAppendEvent undo;
-  undo.event = e;
-  undo.lastUnifiedWriter = lastUnifiedWriter;
+  undo.lineCount = lines.size();
+  if (!lines.empty()) {
+    undo.lastLineLength = lines.back().length;
+    undo.lastLineOpen = lines.back().open;
+  }
+
+  return undo;
+}
 
-  auto &pair = iter->second;
-  auto value = QString::fromStdString(e.value);
-  pair.print(value);
+ScenarioLogWidget::Message ScenarioLogWidget::LogModel::store(const parser::StreamAppendEvent &e) {
+  Message message{e.time, e.streamId, text.size(), 0u};
 
-  undo.unifiedLogEraseCount = printToUnifiedLog(pair, value);
+  // Nothing from unknown streams is shown, so their values are dropped
+  if (hasStream(e.streamId)) {
+    text.append(e.value);
+    message.length = e.value.size();
+  }
 
-  undoEvents.emplace_back(undo);
+  return message;
+}
 
-  // Scroll the document to the bottom (where the cursor is now)
-  // after every append, keeping the newest info visible
-  // TODO: Should be a setting "autoscroll logs" maybe?
-  ui.plainTextLog->ensureCursorVisible();
+QString ScenarioLogWidget::LogModel::messageText(const Message &message) const {
+  const auto bytes = text.read(message.offset, message.length);
+  return QString::fromUtf8(bytes.data(), static_cast<int>(bytes.size()));
+}
+
+undo::StreamAppendEvent ScenarioLogWidget::LogModel::append(const Message &message) {
+  const auto undo = mark();
+
+  // Only search the text of this message for newlines
+  const auto value = text.read(message.offset, message.length);
+  auto position = std::size_t{0u};
+  while (true) {
+    const auto newline = value.find('\n', position);
+    const auto length = (newline == std::string_view::npos ? value.size() : newline) - position;
+
+    if (!lines.empty() && lines.back().open && lines.back().streamId == message.streamId) {
+      // Continue the line from the last value.
+      // Any messages stored between the two were empty, so the line is still one range
+      lines.back().length += length;
+    } else if (length > 0u || newline != std::string_view::npos) {
+      if (!filter.all() && filter.matches(message.streamId, message.time))
+        rows.emplace_back(lines.size());
+
+      std::lock_guard lock{linesMutex};
+      lines.push_back({message.offset + position, length, message.streamId, message.time, true});
+    }
+
+    if (newline == std::string_view::npos)
+      break;
+
+    lines.back().open = false;
+    position = newline + 1u;
+  }
+
+  return undo;
 }
 
-void ScenarioLogWidget::handleEvent(const undo::StreamAppendEvent &e) {
-  const auto &iter = streams.find(e.event.streamId);
-  if (iter == streams.end())
+void ScenarioLogWidget::LogModel::truncate(const undo::StreamAppendEvent &e) {
+  // Line numbers are in order, so the rows past the mark are at the back
+  rows.erase(std::lower_bound(rows.begin(), rows.end(), e.lineCount), rows.end());
+  {
+    std::lock_guard lock{linesMutex};
+    lines.resize(e.lineCount);
+  }
+
+  // The text is kept, as the messages are applied again when moving forward
+  if (lines.empty())
     return;
 
-  auto &pair = iter->second;
-  // TODO: Maybe check this cast?
-  pair.erase(static_cast<int>(e.event.value.size()));
+  auto &last = lines.back();
+  last.length = e.lastLineLength;
+  last.open = e.lastLineOpen;
+}
 
-  unifiedStreamCursor.movePosition(QTextCursor::MoveOperation::Left, QTextCursor::MoveMode::KeepAnchor,
-                                   e.unifiedLogEraseCount);
-  unifiedStreamCursor.removeSelectedText();
-  lastUnifiedWriter = e.lastUnifiedWriter;
+void ScenarioLogWidget::LogModel::cancelFilter() {
+  filterGeneration++;
+  worker.wait();
+}
+
+void ScenarioLogWidget::LogModel::setFilter(Filter newFilter, bool showPrompts) {
+  cancelFilter();
+
+  if (newFilter.all()) {
+    beginResetModel();
+    filter = std::move(newFilter);
+    prompts = showPrompts;
+    rows.clear();
+    shownRows = lineCount();
+    shownLastLength = shownRows > 0 ? lineAt(shownRows - 1).length : 0u;
+    endResetModel();
+    return;
+  }
 
-  events.emplace_front(e.event);
+  const auto generation = filterGeneration.load();
+  auto search = [this, generation, newFilter = std::move(newFilter), showPrompts]() {
+    // Large enough that locking is rare, small enough the log is not held up
+    const std::size_t chunkSize = 65536u;
+    std::vector<std::size_t> found;
+
+    std::size_t position = 0u;
+    while (true) {
+      if (filterGeneration != generation)
+        return;
+
+      std::lock_guard lock{linesMutex};
+
+      // Caught up to the log, later lines are filtered as they are written.
+      // Drop any lines rewound since they were filtered
+      if (position >= lines.size()) {
+        found.erase(std::lower_bound(found.begin(), found.end(), lines.size()), found.end());
+        position = lines.size();
+        break;
+      }
+
+      const auto end = std::min(position + chunkSize, lines.size());
+      for (; position < end; position++) {
+        if (newFilter.matches(lines[position].streamId, lines[position].time))
+          found.emplace_back(position);
+      }
+    }
+
+    QMetaObject::invokeMethod(
+        this,
+        [this, generation, newFilter, showPrompts, found = std::move(found), position]() mutable {
+          filterFinished(generation, std::move(newFilter), showPrompts, std::move(found), position);
+        },
+        Qt::QueuedConnection);
+  };
+  worker = parser::TaskPool::shared().submit(std::move(search), parser::TaskPool::Priority::Interactive);
 }
 
-int ScenarioLogWidget::printToUnifiedLog(LogStreamPair &pair, const QString &value) {
-  // File us down to single line prints
-  if (value.count('\n') > 1) {
-    auto lines = value.split('\n');
-    int accumulator = 0;
-    for (const auto &line : lines)
-      accumulator += printToUnifiedLog(pair, line + '\n');
+void ScenarioLogWidget::LogModel::filterFinished(unsigned int generation, Filter newFilter, bool showPrompts,
+                                                 std::vector<std::size_t> found, std::size_t end) {
+  // A newer filter was set since
+  if (generation != filterGeneration)
+    return;
 
-    return accumulator;
+  // Lines may have been removed, or written, since the worker finished.
+  // Replays make the same lines, so the rows before both are still correct
+  found.erase(std::lower_bound(found.begin(), found.end(), lines.size()), found.end());
+  for (auto i = std::min(end, lines.size()); i < lines.size(); i++) {
+    if (newFilter.matches(lines[i].streamId, lines[i].time))
+      found.emplace_back(i);
   }
 
-  int characterTotal = 0;
+  // The prompts change with the rows, so the view stays consistent
+  beginResetModel();
+  filter = std::move(newFilter);
+  prompts = showPrompts;
+  rows = std::move(found);
+  shownRows = lineCount();
+  shownLastLength = shownRows > 0 ? lineAt(shownRows - 1).length : 0u;
+  endResetModel();
+}
 
-  const auto id = pair.getModel().id;
-  const auto &format = pair.getFormat();
+bool ScenarioLogWidget::LogModel::publish() {
+  const auto count = lineCount();
+  auto removed = false;
 
-  if (id != lastUnifiedWriter && !unifiedStreamCursor.atBlockStart()) {
-    unifiedStreamCursor.insertText("\n", format);
-    characterTotal++;
+  if (count < shownRows) {
+    beginRemoveRows({}, count, shownRows - 1);
+    shownRows = count;
+    endRemoveRows();
+    removed = true;
   }
 
-  if (unifiedStreamCursor.atBlockStart()) {
-    const QString prompt = '[' + pair.getName() + "]: ";
-    unifiedStreamCursor.insertText(prompt, format);
-    characterTotal += prompt.size();
+  // The last row the view knows about may have been extended or shortened
+  if (shownRows > 0 && (removed || lineAt(shownRows - 1).length != shownLastLength)) {
+    const auto last = index(shownRows - 1);
+    emit dataChanged(last, last, {Qt::DisplayRole});
   }
 
-  unifiedStreamCursor.insertText(value);
-  characterTotal += value.size();
+  auto added = false;
+  if (count > shownRows) {
+    beginInsertRows({}, shownRows, count - 1);
+    shownRows = count;
+    endInsertRows();
+    added = true;
+  }
+
+  shownLastLength = shownRows > 0 ? lineAt(shownRows - 1).length : 0u;
+  return added;
+}
+
+std::size_t ScenarioLogWidget::LogModel::memoryUsage() const {
+  std::lock_guard lock{linesMutex};
+  return text.memoryUsage() + containerBytes(lines) + containerBytes(rows);
+}
 
-  lastUnifiedWriter = id;
+void ScenarioLogWidget::LogModel::reset() {
+  cancelFilter();
 
-  return characterTotal;
+  beginResetModel();
+  text.clear();
+  {
+    std::lock_guard lock{linesMutex};
+    lines.clear();
+  }
+  streams.clear();
+  filter = {};
+  prompts = true;
+  rows.clear();
+  shownRows = 0;
+  shownLastLength = 0u;
+  endResetModel();
 }
 
-void ScenarioLogWidget::streamSelected(unsigned int id) {
-  if (id == unifiedStreamId) {
-    ui.plainTextLog->setDocument(&unifiedStreamDocument);
+void ScenarioLogWidget::handleEvent(const Message &e) {
+  // Events for unknown streams are empty, but are still marked
+  undoEvents.emplace_back(model.append(e));
+}
 
-    // When changing the document, the cursor seems to get stuck
-    // at the top, so move it back to the end
-    ui.plainTextLog->moveCursor(QTextCursor::End);
+void ScenarioLogWidget::applyFilter() {
+  Filter filter;
+
+  const auto selected = ui.comboBoxLogName->currentData().toUInt();
+  const auto unified = selected == unifiedStreamId;
+  ui.toolButtonStreams->setEnabled(unified);
+
+  if (!unified) {
+    filter.streams.emplace_back(selected);
+  } else {
+    const auto actions = streamMenu.actions();
+    const auto allChecked = std::all_of(actions.begin(), actions.end(), [](const QAction *action) {
+      return action->isChecked();
+    });
+
+    if (!allChecked) {
+      for (const auto action : actions) {
+        if (action->isChecked())
+          filter.streams.emplace_back(action->data().toUInt());
+      }
+      std::sort(filter.streams.begin(), filter.streams.end());
+
+      // No stream uses the unified log's ID, so nothing matches
+      if (filter.streams.empty())
+        filter.streams.emplace_back(unifiedStreamId);
+    }
+  }
+
+  if (ui.checkBoxTimeRange->isChecked()) {
+    const auto toNanoseconds = [](double seconds) {
+      return static_cast<parser::nanoseconds>(std::llround(seconds * 1'000'000'000.0));
+    };
+    filter.range = {toNanoseconds(ui.doubleSpinBoxFrom->value()), toNanoseconds(ui.doubleSpinBoxTo->value())};
+  }
 
-    // Scroll the document to the bottom (where the cursor is now)
-    ui.plainTextLog->ensureCursorVisible();
+  model.setFilter(std::move(filter), unified);
+  search(true);
+}
+
+void ScenarioLogWidget::search(bool force) {
+  const auto query = ui.lineEditSearch->text().toStdString();
+  if (!searchIndex || query.empty()) {
+    ui.listSearchResults->clear();
+    ui.listSearchResults->hide();
+    searchMatches = 0u;
     return;
   }
 
-  const auto &iter = streams.find(id);
-  if (iter == streams.end())
+  // Only the events applied so far
+  auto found = searchIndex->find(query, static_cast<std::uint32_t>(nextEvent));
+
+  const auto selected = ui.comboBoxLogName->currentData().toUInt();
+  found.erase(std::remove_if(found.begin(), found.end(),
+                             [this, selected](std::uint32_t number) {
+                               const auto &e = events[number];
+                               return !model.hasStream(e.streamId) ||
+                                      (selected != unifiedStreamId && e.streamId != selected);
+                             }),
+              found.end());
+
+  if (!force && found.size() == searchMatches)
     return;
+  searchMatches = found.size();
 
-  ui.plainTextLog->setDocument(&iter->second.getData());
+  ui.listSearchResults->clear();
+  const auto first = std::max(0, static_cast<int>(found.size()) - maxSearchResults);
+  for (auto i = static_cast<std::size_t>(first); i < found.size(); i++) {
+    const auto &e = events[found[i]];
+    const auto text = toDisplayTime(e.time, SettingsManager::TimeUnit::Milliseconds) + " [" +
+                      model.streamName(e.streamId) + "]: " + model.messageText(e).simplified();
 
-  // When changing the document, the cursor seems to get stuck
-  // at the top, so move it back to the end
-  ui.plainTextLog->moveCursor(QTextCursor::End);
+    auto item = new QListWidgetItem{text, ui.listSearchResults};
+    item->setData(Qt::UserRole, static_cast<qlonglong>(e.time));
+  }
 
-  // Scroll the document to the bottom (where the cursor is now)
-  ui.plainTextLog->ensureCursorVisible();
+  ui.listSearchResults->show();
+  ui.listSearchResults->scrollToBottom();
 }
 
-void ScenarioLogWidget::timeAdvanced(parser::nanoseconds time) {
-  auto handle = [this, time](auto &&e) -> bool {
-    if (time < e.time)
-      return false;
+void ScenarioLogWidget::copySelection() {
+  auto selected = ui.listLog->selectionModel()->selectedIndexes();
+  std::sort(selected.begin(), selected.end(), [](const QModelIndex &left, const QModelIndex &right) {
+    return left.row() < right.row();
+  });
 
-    handleEvent(e);
-    events.pop_front();
-    return true;
-  };
+  QStringList text;
+  for (const auto &index : selected)
+    text.append(index.data().toString());
 
-  while (!events.empty() && std::visit(handle, events.front())) {
-    // Intentionally Blank
+  QApplication::clipboard()->setText(text.join('\n'));
+}
+
+void ScenarioLogWidget::timeAdvanced(parser::nanoseconds time) {
+  while (nextEvent < events.size() && events[nextEvent].time <= time) {
+    handleEvent(events[nextEvent]);
+    nextEvent++;
   }
 }
 
+std::optional<parser::nanoseconds> ScenarioLogWidget::nextEventTime() const {
+  if (nextEvent >= events.size())
+    return {};
+
+  return events[nextEvent].time;
+}
+
 void ScenarioLogWidget::timeRewound(parser::nanoseconds time) {
-  auto handleUndoEvent = [time, this](auto &&e) -> bool {
-    // All events have a time
-    // Make sure we don't handle one
-    // Before it was originally applied
-    if (time > e.event.time)
-      return false;
-
-    handleEvent(e);
-    return true;
-  };
+  // Events are in time order, so every event to undo is after
+  // the last one applied before `time`
+  const auto applied = events.begin() + static_cast<std::ptrdiff_t>(nextEvent);
+  const auto kept = std::partition_point(events.begin(), applied, [time](const Message &e) {
+    return time > e.time;
+  });
 
-  while (!undoEvents.empty() && std::visit(handleUndoEvent, undoEvents.back())) {
-    undoEvents.pop_back();
-  }
+  const auto target = static_cast<std::size_t>(std::distance(events.begin(), kept));
+  if (target == nextEvent)
+    return;
+
+  // Return the log to where it ended before the first undone event
+  model.truncate(undoEvents[target]);
+  undoEvents.resize(target);
+  nextEvent = target;
 }
 
 ScenarioLogWidget::ScenarioLogWidget(QWidget *parent) : QWidget(parent) {
   ui.setupUi(this);
-  unifiedStreamDocument.setDocumentLayout(new QPlainTextDocumentLayout(&unifiedStreamDocument));
+  ui.listLog->setModel(&model);
+
+  auto copyAction = new QAction{"Copy", ui.listLog};
+  copyAction->setShortcut(QKeySequence::Copy);
+  copyAction->setShortcutContext(Qt::WidgetShortcut);
+  ui.listLog->addAction(copyAction);
+  QObject::connect(copyAction, &QAction::triggered, this, &ScenarioLogWidget::copySelection);
+
+  ui.listSearchResults->hide();
 
   reset();
 
   QObject::connect(ui.comboBoxLogName, qOverload<int>(&QComboBox::currentIndexChanged), [this](int index) {
-    streamSelected(ui.comboBoxLogName->itemData(index).toUInt());
+    applyFilter();
+  });
+
+  ui.toolButtonStreams->setMenu(&streamMenu);
+
+  QObject::connect(ui.checkBoxTimeRange, &QCheckBox::toggled, [this](bool checked) {
+    ui.doubleSpinBoxFrom->setEnabled(checked);
+    ui.doubleSpinBoxTo->setEnabled(checked);
+    applyFilter();
+  });
+  QObject::connect(ui.doubleSpinBoxFrom, qOverload<double>(&QDoubleSpinBox::valueChanged), [this]() {
+    if (ui.checkBoxTimeRange->isChecked())
+      applyFilter();
+  });
+  QObject::connect(ui.doubleSpinBoxTo, qOverload<double>(&QDoubleSpinBox::valueChanged), [this]() {
+    if (ui.checkBoxTimeRange->isChecked())
+      applyFilter();
+  });
+
+  // Filters may finish in the background, keep the newest lines visible after
+  QObject::connect(&model, &QAbstractItemModel::modelReset, ui.listLog, &QListView::scrollToBottom);
+
+  QObject::connect(ui.lineEditSearch, &QLineEdit::textChanged, [this]() {
+    search(true);
+  });
+
+  QObject::connect(ui.listSearchResults, &QListWidget::itemClicked, [this](QListWidgetItem *item) {
+    emit timeSelected(item->data(Qt::UserRole).toLongLong());
   });
 }
 
 void ScenarioLogWidget::addStream(const parser::LogStream &stream) {
-  streams.try_emplace(stream.id, stream);
+  model.addStream(stream);
+
+  // Streams hidden from the dropdown still write to the unified log
+  auto action = streamMenu.addAction(QString::fromStdString(stream.name));
+  action->setCheckable(true);
+  action->setChecked(true);
+  action->setData(stream.id);
+  QObject::connect(action, &QAction::toggled, this, &ScenarioLogWidget::applyFilter);
 
   if (stream.visible)
     ui.comboBoxLogName->addItem(QString::fromStdString(stream.name), stream.id);
 }
 
 void ScenarioLogWidget::enqueueEvents(const std::vector<parser::LogEvent> &e) {
-  events.insert(events.end(), e.begin(), e.end());
+  // Only the value is copied, into the model's text
+  for (const auto &event : e) {
+    std::visit(
+        [this](const auto &value) {
+          events.emplace_back(model.store(value));
+        },
+        event);
+  }
+}
+
+void ScenarioLogWidget::enqueueEvents(std::vector<parser::LogEvent> &&e) {
+  enqueueEvents(static_cast<const std::vector<parser::LogEvent> &>(e));
+
+  // Free the values now they are stored
+  e.clear();
+  e.shrink_to_fit();
 }
 
 void ScenarioLogWidget::timeChanged(parser::nanoseconds time, parser::nanoseconds increment) {
+  parser::trace::Scope trace{"ScenarioLogWidget::timeChanged", "ui"};
+  const auto previousEvent = nextEvent;
   if (increment > 0LL)
     timeAdvanced(time);
   else
     timeRewound(time);
+
+  // Most ticks apply no log events, so there is nothing to show
+  if (nextEvent == previousEvent)
+    return;
+
+  // Scroll to the bottom after new lines, keeping the newest info visible
+  // TODO: Should be a setting "autoscroll logs" maybe?
+  if (model.publish())
+    ui.listLog->scrollToBottom();
+
+  // New matches may have been applied, or old ones undone
+  search(false);
+}
+
+void ScenarioLogWidget::setSearchIndex(const parser::LogIndex &index) {
+  searchIndex = &index;
+  search(true);
+}
+
+unsigned int ScenarioLogWidget::getCurrentStream() const {
+  return ui.comboBoxLogName->currentData().toUInt();
+}
+
+std::vector<unsigned int> ScenarioLogWidget::getShownStreams() const {
+  std::vector<unsigned int> shown;
+  for (const auto action : streamMenu.actions()) {
+    if (action->isChecked())
+      shown.emplace_back(action->data().toUInt());
+  }
+  return shown;
+}
+
+void ScenarioLogWidget::showStreams(unsigned int current, const std::vector<unsigned int> &shown) {
+  // Each change would filter the log again, so only filter once at the end
+  for (const auto action : streamMenu.actions()) {
+    const QSignalBlocker blocker{action};
+    action->setChecked(std::find(shown.begin(), shown.end(), action->data().toUInt()) != shown.end());
+  }
+
+  if (const auto index = ui.comboBoxLogName->findData(current); index != -1) {
+    const QSignalBlocker blocker{ui.comboBoxLogName};
+    ui.comboBoxLogName->setCurrentIndex(index);
+  }
+
+  applyFilter();
+}
+
+void ScenarioLogWidget::reportMemory(MemoryReport &report) const {
+  report.add("Log", "Events", containerBytes(events));
+  report.add("Log", "Undo events", containerBytes(undoEvents));
+  report.add("Log", "Text", model.memoryUsage());
 }
 
 void ScenarioLogWidget::reset() {
-  unifiedStreamDocument.clear();
-  ui.plainTextLog->setDocument(&unifiedStreamDocument);
+  streamMenu.clear();
   ui.comboBoxLogName->clear();
-  streams.clear();
+  ui.lineEditSearch->clear();
+  model.reset();
   ui.comboBoxLogName->addItem("Unified Log", unifiedStreamId);
   events.clear();
+  nextEvent = 0u;
   undoEvents.clear();
+  search(true);
 }
 
 } // namespace netsimulyzer
@@ -32,18 +32,27 @@
  */
 
 #pragma once
+#include "../../util/memory-report.h"
 #include "../../util/undo-events.h"
+#include "CompressedText.h"
 #include "ui_ScenarioLogWidget.h"
+#include <QAbstractListModel>
 #include <QColor>
+#include <QMenu>
+#include <QModelIndex>
 #include <QString>
-#include <QTextCharFormat>
-#include <QTextCursor>
-#include <QTextDocument>
+#include <QVariant>
 #include <QWidget>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
 #include <deque>
-#include <memory>
+#include <log-index.h>
 #include <model.h>
+#include <mutex>
 #include <optional>
+#include <string>
+#include <task-pool.h>
 #include <unordered_map>
 #include <utility>
 #include <vector>
@@ -52,66 +61,373 @@ namespace netsimulyzer {
 
 class ScenarioLogWidget : public QWidget {
   Q_OBJECT
-  Ui::ScenarioLogWidget ui{};
-  const unsigned int unifiedStreamId = 0u;
-  QTextDocument unifiedStreamDocument{this};
-  QTextCursor unifiedStreamCursor{&unifiedStreamDocument};
 
-  class LogStreamPair {
-    parser::LogStream model;
-    std::unique_ptr<QTextDocument> data = std::make_unique<QTextDocument>();
-    std::unique_ptr<QTextCursor> cursor = std::make_unique<QTextCursor>(data.get());
-    QTextCharFormat textFormat;
-    QString name;
+  /**
+   * A log event, with its value kept as a range of the text of the `LogModel`
+   */
+  struct Message {
+    parser::nanoseconds time;
+    unsigned int streamId;
 
-  public:
-    explicit LogStreamPair(parser::LogStream model);
+    /**
+     * Index of the first byte of the value in the text
+     */
+    std::size_t offset;
 
-    // No Copies
-    LogStreamPair(const LogStreamPair &other) = delete;
-    LogStreamPair &operator=(const LogStreamPair &other) = delete;
+    /**
+     * Length of the value in bytes.
+     * Always 0 for unknown streams
+     */
+    std::size_t length;
+  };
 
-    // Allow Moves
-    LogStreamPair(LogStreamPair &&other) noexcept = default;
-    LogStreamPair &operator=(LogStreamPair &&other) noexcept = default;
+  /**
+   * Which lines of the log to show
+   */
+  struct Filter {
+    /**
+     * The IDs of the streams to show, in ascending order.
+     * Empty for every stream
+     */
+    std::vector<unsigned int> streams;
 
-    ~LogStreamPair() = default;
+    /**
+     * The earliest & latest times of the lines to show,
+     * or an empty optional for any time
+     */
+    std::optional<std::pair<parser::nanoseconds, parser::nanoseconds>> range;
 
-    void print(const QString &value) const {
-      cursor->insertText(value, textFormat);
-    }
+    /**
+     * @return
+     * True if every line is shown
+     */
+    [[nodiscard]] bool all() const;
 
-    void erase(int characters) {
-      cursor->movePosition(QTextCursor::MoveOperation::Left, QTextCursor::MoveMode::KeepAnchor, characters);
-      cursor->removeSelectedText();
-    }
+    /**
+     * @param streamId
+     * The stream a line was written to
+     *
+     * @param time
+     * The time the line was started
+     *
+     * @return
+     * True if that line is shown
+     */
+    [[nodiscard]] bool matches(unsigned int streamId, parser::nanoseconds time) const;
+  };
 
-    [[nodiscard]] QTextDocument &getData() {
-      return *data;
+  /**
+   * Every line written to the logs, kept as ranges of one buffer
+   * and shown through a list view, which only lays out the visible rows.
+   *
+   * Changes are not shown until `publish()`, so seeking
+   * across many events updates the view once.
+   *
+   * The rows matching a filter are found on a worker thread, see `setFilter()`.
+   * The previous rows are shown until it finishes
+   */
+  class LogModel : public QAbstractListModel {
+    struct Stream {
+      QString name;
+      std::optional<QColor> color;
     };
 
-    [[nodiscard]] const parser::LogStream &getModel() {
-      return model;
+    /**
+     * A line of the log, as a range of `text`
+     */
+    struct Line {
+      /**
+       * Index of the first byte of the line in `text`
+       */
+      std::size_t offset;
+
+      /**
+       * Length of the line in bytes, without the newline
+       */
+      std::size_t length;
+
+      unsigned int streamId;
+      parser::nanoseconds time;
+
+      /**
+       * If the line was not ended by a newline yet.
+       * Only the last line may be extended,
+       * so a line from another stream ends it as well
+       */
+      bool open;
     };
 
-    [[nodiscard]] const QString &getName() const {
-      return name;
-    }
+    /**
+     * The value of every message, in UTF-8, in the order they were stored.
+     * Messages are applied in the same order, so a line spanning
+     * several messages is still one range of this.
+     * Compressed a block at a time, only the blocks of the rows drawn are decompressed
+     */
+    CompressedText text;
+    std::vector<Line> lines;
+
+    /**
+     * Guards changes to the size of `lines`, which the filter worker reads.
+     * The stream & time of a line never change, and replaying the same events
+     * makes the same lines, so the worker needs no lock for those
+     */
+    mutable std::mutex linesMutex;
+
+    std::unordered_map<unsigned int, Stream> streams;
+
+    /**
+     * The filter of the shown rows
+     */
+    Filter filter;
+
+    /**
+     * If lines are marked with the name of their stream
+     */
+    bool prompts{true};
+
+    /**
+     * The index in `lines` of each row matching `filter`, in order.
+     * Unused when the filter shows every line
+     */
+    std::vector<std::size_t> rows;
+
+    /**
+     * Finds the rows matching a new filter, see `setFilter()`
+     */
+    parser::TaskPool::Handle worker;
+
+    /**
+     * Incremented for each new filter. A worker stops once
+     * this no longer matches the value it started with
+     */
+    std::atomic<unsigned int> filterGeneration{0u};
+
+    /**
+     * The number of rows the view was last told about, see `publish()`
+     */
+    int shownRows{0};
+
+    /**
+     * The length of the last row when the view was last told about it,
+     * so it is only redrawn after a change
+     */
+    std::size_t shownLastLength{0u};
+
+    /**
+     * @return
+     * The number of lines in the shown stream(s), published or not
+     */
+    [[nodiscard]] int lineCount() const;
+
+    /**
+     * @param row
+     * A shown row
+     *
+     * @return
+     * The line on that row
+     */
+    [[nodiscard]] const Line &lineAt(int row) const;
+
+    /**
+     * Stop the worker, if it is running, dropping its rows
+     */
+    void cancelFilter();
+
+    /**
+     * Show the rows found by a worker
+     *
+     * @param generation
+     * The filter generation the worker started with
+     *
+     * @param newFilter
+     * The filter the worker applied
+     *
+     * @param showPrompts
+     * True to mark each line with the name of its stream
+     *
+     * @param found
+     * The index of each line matching `newFilter`, up to `end`
+     *
+     * @param end
+     * The number of lines the worker searched
+     */
+    void filterFinished(unsigned int generation, Filter newFilter, bool showPrompts, std::vector<std::size_t> found,
+                        std::size_t end);
+
+  public:
+    explicit LogModel(QObject *parent = {}) : QAbstractListModel(parent){};
+
+    // The worker refers to this model
+    LogModel(const LogModel &other) = delete;
+    LogModel &operator=(const LogModel &other) = delete;
+    ~LogModel() override;
+
+    [[nodiscard]] int rowCount(const QModelIndex &parent) const override;
+    [[nodiscard]] QVariant data(const QModelIndex &index, int role) const override;
+
+    void addStream(const parser::LogStream &stream);
+
+    /**
+     * @param id
+     * The ID of the stream to check for
+     *
+     * @return
+     * True if a stream with `id` was added
+     */
+    [[nodiscard]] bool hasStream(unsigned int id) const;
 
-    [[nodiscard]] const QTextCharFormat &getFormat() const {
-      return textFormat;
-    }
+    /**
+     * @param id
+     * The ID of an added stream
+     *
+     * @return
+     * The name of that stream
+     */
+    [[nodiscard]] const QString &streamName(unsigned int id) const;
+
+    /**
+     * Keep the value of an event, to be written with `append()` later.
+     * Messages must be appended in the order they are stored
+     *
+     * @param e
+     * The event to keep
+     *
+     * @return
+     * The event, with its value as a range of the stored text
+     */
+    Message store(const parser::StreamAppendEvent &e);
+
+    /**
+     * @param message
+     * A message from `store()`
+     *
+     * @return
+     * The value of the message
+     */
+    [[nodiscard]] QString messageText(const Message &message) const;
+
+    /**
+     * @return
+     * The current end of the log, which it may be truncated back to, see `truncate()`
+     */
+    [[nodiscard]] undo::StreamAppendEvent mark() const;
+
+    /**
+     * Write the value of a message to the end of the log
+     *
+     * @param message
+     * The next stored message
+     *
+     * @return
+     * The end of the log before the value, see `truncate()`
+     */
+    undo::StreamAppendEvent append(const Message &message);
+
+    /**
+     * Remove everything written after a mark, in O(log n)
+     *
+     * @param e
+     * The end of the log to return to, from `mark()` or `append()`
+     */
+    void truncate(const undo::StreamAppendEvent &e);
+
+    /**
+     * Show only the lines matching a filter.
+     * Showing every line applies at once, otherwise the matching lines
+     * are found on a worker thread, cancelling any earlier one
+     *
+     * @param newFilter
+     * The lines to show
+     *
+     * @param showPrompts
+     * True to mark each line with the name of its stream
+     */
+    void setFilter(Filter newFilter, bool showPrompts);
+
+    /**
+     * Tell the view about the lines written & removed since the last call
+     *
+     * @return
+     * True if rows were added
+     */
+    bool publish();
+
+    /**
+     * @return
+     * The bytes held by the text, lines, & rows of the log
+     */
+    [[nodiscard]] std::size_t memoryUsage() const;
+
+    /**
+     * Remove every stream, message & line
+     */
+    void reset();
   };
 
-  unsigned int lastUnifiedWriter = 0u;
-  std::unordered_map<unsigned int, LogStreamPair> streams;
-  std::deque<parser::LogEvent> events;
-  std::deque<undo::LogUndoEvent> undoEvents;
+  Ui::ScenarioLogWidget ui{};
+  const unsigned int unifiedStreamId = 0u;
+  LogModel model{this};
+
+  /**
+   * A checkable action for each stream, choosing the streams in the unified log
+   */
+  QMenu streamMenu{this};
+
+  /**
+   * The most search results listed, the latest are kept
+   */
+  const int maxSearchResults = 500;
+
+  /**
+   * Index of the words in `events`, or null if searching is unavailable
+   */
+  const parser::LogIndex *searchIndex{nullptr};
 
-  void handleEvent(const parser::StreamAppendEvent &e);
-  void handleEvent(const undo::StreamAppendEvent &e);
-  void streamSelected(unsigned int id);
-  int printToUnifiedLog(LogStreamPair &pair, const QString &value);
+  /**
+   * The number of events matching the search, listed or not.
+   * Matches only grow as events are applied,
+   * so the results are rebuilt only when this changes
+   */
+  std::size_t searchMatches{0u};
+
+  /**
+   * Every log event, in time order.
+   * Events are not removed as they are applied, see `nextEvent`
+   */
+  std::vector<Message> events;
+
+  /**
+   * Index in `events` of the first event which has not been applied
+   */
+  std::size_t nextEvent{0u};
+
+  /**
+   * The end of the log before each applied event, in order,
+   * including those for unknown streams, so they line up with `events`.
+   * Ends at `nextEvent`
+   */
+  std::deque<undo::StreamAppendEvent> undoEvents;
+
+  void handleEvent(const Message &e);
+  /**
+   * Filter the log to the chosen streams & time range
+   */
+  void applyFilter();
+
+  /**
+   * List the applied events from the selected stream matching the search,
+   * or hide the results if there is no search
+   *
+   * @param force
+   * Rebuild the results even if the number of matches did not change,
+   * for a changed search or stream
+   */
+  void search(bool force);
+
+  /**
+   * Copy the text of the selected rows to the clipboard
+   */
+  void copySelection();
 
   void timeAdvanced(parser::nanoseconds time);
   void timeRewound(parser::nanoseconds time);
@@ -121,8 +437,66 @@ public:
 
   void addStream(const parser::LogStream &stream);
   void enqueueEvents(const std::vector<parser::LogEvent> &e);
+  void enqueueEvents(std::vector<parser::LogEvent> &&e);
   void timeChanged(parser::nanoseconds time, parser::nanoseconds increment);
+
+  /**
+   * @return
+   * The time of the next message after the current time.
+   * Unset once every message is shown
+   */
+  [[nodiscard]] std::optional<parser::nanoseconds> nextEventTime() const;
+
+  /**
+   * Search the log with `index`, which must outlive this widget
+   *
+   * @param index
+   * The index of the events given to `enqueueEvents()`, in the same order
+   */
+  void setSearchIndex(const parser::LogIndex &index);
+
+  /**
+   * @return
+   * The ID of the stream chosen in the dropdown,
+   * 0u for the unified log
+   */
+  [[nodiscard]] unsigned int getCurrentStream() const;
+
+  /**
+   * @return
+   * The IDs of the streams shown in the unified log
+   */
+  [[nodiscard]] std::vector<unsigned int> getShownStreams() const;
+
+  /**
+   * Choose the streams to show, as from `getCurrentStream()` & `getShownStreams()`.
+   * Unknown streams are ignored
+   *
+   * @param current
+   * The stream to choose in the dropdown, 0u for the unified log
+   *
+   * @param shown
+   * The streams to show in the unified log
+   */
+  void showStreams(unsigned int current, const std::vector<unsigned int> &shown);
+
+  /**
+   * Add the memory held by the log events, the undo events, & the log text
+   *
+   * @param report
+   * The report to add to
+   */
+  void reportMemory(MemoryReport &report) const;
   void reset();
+
+signals:
+  /**
+   * Emitted when a search result is chosen
+   *
+   * @param time
+   * The time of the event found
+   */
+  void timeSelected(parser::nanoseconds time);
 };
 
 } // namespace netsimulyzer
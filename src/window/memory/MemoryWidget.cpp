@@ -0,0 +1,98 @@
+/*
+ * NIST-developed software is provided by NIST as a public service. You may use,
+ * copy and distribute copies of the software in any medium, provided that you
+ * keep intact this entire notice. You may improve,modify and create derivative
+ * works of the software or any portion of the software, and you may copy and
+ * distribute such modifications or works. Modified works should carry a notice
+ * stating that you changed the software and should note the date and nature of
+ * any such change. Please explicitly acknowledge the National Institute of
+ * Standards and Technology as the source of the software.
+ *
+ * NIST-developed software is expressly provided "AS IS." NIST MAKES NO
+ * WARRANTY OF ANY KIND, EXPRESS, IMPLIED, IN FACT OR ARISING BY OPERATION OF
+ * LAW, INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTY OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, NON-INFRINGEMENT
+ * AND DATA ACCURACY. NIST NEITHER REPRESENTS NOR WARRANTS THAT THE
+ * OPERATION OF THE SOFTWARE WILL BE UNINTERRUPTED OR ERROR-FREE, OR THAT
+ * ANY DEFECTS WILL BE CORRECTED. NIST DOES NOT WARRANT OR MAKE ANY
+ * REPRESENTATIONS REGARDING THE USE OF THE SOFTWARE OR THE RESULTS THEREOF,
+ * INCLUDING BUT NOT LIMITED TO THE CORRECTNESS, ACCURACY, RELIABILITY,
+ * OR USEFULNESS OF THE SOFTWARE.
+ *
+ * You are solely responsible for determining the appropriateness of using and
+ * distributing the software and you assume all risks associated with its use,
+ * including but not limited to the risks and costs of program errors,
+ * compliance with applicable laws, damage to or loss of data, programs or
+ * equipment, and the unavailability or interruption of operation. This
+ * software is not intended to be used in any situation where a failure could
+ * cause risk of injury or damage to property. The software developed by NIST
+ * employees is not subject to copyright protection within the United States.
+ *
+ * Author: Evan Black <evan.black@nist.gov>
+ */
+
+#include "MemoryWidget.h"
+#include <QHeaderView>
+#include <QString>
+#include <QStringList>
+#include <QTreeWidgetItem>
+#include <unordered_map>
+
+namespace netsimulyzer {
+
+MemoryWidget::MemoryWidget(QWidget *parent) : QWidget(parent) {
+  layout.setContentsMargins(0, 0, 0, 0);
+  layout.addWidget(&tree);
+
+  tree.setColumnCount(2);
+  tree.setHeaderLabels({"Name", "Size"});
+  tree.header()->setSectionResizeMode(0, QHeaderView::Stretch);
+  tree.header()->setStretchLastSection(false);
+  tree.setRootIsDecorated(true);
+}
+
+void MemoryWidget::setReport(const MemoryReport &report) {
+  using Kind = MemoryReport::Kind;
+
+  // Keep the subsystems the user expanded open between updates
+  std::unordered_map<std::string, bool> expanded;
+  for (auto i = 0; i < tree.topLevelItemCount(); i++) {
+    const auto item = tree.topLevelItem(i);
+    expanded[item->text(0).toStdString()] = item->isExpanded();
+  }
+
+  tree.setUpdatesEnabled(false);
+  tree.clear();
+
+  // Subsystems are listed in the order they were first reported
+  std::unordered_map<std::string, QTreeWidgetItem *> groups;
+  std::unordered_map<std::string, std::size_t> groupBytes;
+  for (const auto &entry : report.getEntries()) {
+    auto &group = groups[entry.subsystem];
+    if (!group) {
+      group = new QTreeWidgetItem{&tree, {QString::fromStdString(entry.subsystem)}};
+      const auto previous = expanded.find(entry.subsystem);
+      group->setExpanded(previous == expanded.end() || previous->second);
+    }
+
+    const auto name = QString::fromStdString(entry.name) + MemoryReport::suffix(entry.kind);
+    new QTreeWidgetItem{group, {name, QString::fromStdString(MemoryReport::formatBytes(entry.bytes))}};
+    // Memory only, the disk is listed separately
+    if (entry.kind != Kind::Disk)
+      groupBytes[entry.subsystem] += entry.bytes;
+  }
+
+  for (const auto &[subsystem, group] : groups)
+    group->setText(1, QString::fromStdString(MemoryReport::formatBytes(groupBytes[subsystem])));
+
+  new QTreeWidgetItem{&tree, {"Total", QString::fromStdString(MemoryReport::formatBytes(report.total(Kind::Host)))}};
+  new QTreeWidgetItem{&tree,
+                      {"Total (GPU)", QString::fromStdString(MemoryReport::formatBytes(report.total(Kind::Gpu)))}};
+  if (const auto disk = report.total(Kind::Disk); disk > 0u)
+    new QTreeWidgetItem{&tree, {"Total (disk)", QString::fromStdString(MemoryReport::formatBytes(disk))}};
+
+  tree.resizeColumnToContents(1);
+  tree.setUpdatesEnabled(true);
+}
+
+} // namespace netsimulyzer
@@ -33,29 +33,33 @@
 
 #pragma once
 
-#include <QOpenGLFunctions_3_3_Core>
-#include <glm/vec3.hpp>
-#include <model.h>
+#include "../../util/memory-report.h"
+#include <QTreeWidget>
+#include <QVBoxLayout>
+#include <QWidget>
 
-class WiredLink : protected QOpenGLFunctions_3_3_Core {
-public:
-  struct RenderInfo {
-    unsigned int vao = 0u;
-    unsigned int vbo = 0u;
-    int size = 0;
-  };
+namespace netsimulyzer {
+
+/**
+ * Lists the memory held by each part of the application,
+ * grouped by the part holding it, see `MemoryReport`
+ */
+class MemoryWidget : public QWidget {
+  Q_OBJECT
 
-private:
-  RenderInfo renderInfo;
-  parser::WiredLink model;
+  QVBoxLayout layout{this};
+  QTreeWidget tree{this};
 
 public:
-  WiredLink(const RenderInfo &renderInfo, parser::WiredLink model);
-  ~WiredLink() override;
-  WiredLink(const WiredLink &) = delete;
-  WiredLink(WiredLink &&other) noexcept;
-  WiredLink& operator=(WiredLink &&other) noexcept;
-
-  void notifyNodeMoved(unsigned int nodeId, glm::vec3 position);
-  [[nodiscard]] const RenderInfo &getRenderInfo() const;
+  explicit MemoryWidget(QWidget *parent = nullptr);
+
+  /**
+   * Replace the listed memory with the entries of `report`
+   *
+   * @param report
+   * The report to show
+   */
+  void setReport(const MemoryReport &report);
 };
+
+} // namespace netsimulyzer
@@ -36,12 +36,29 @@
 #include <QObject>
 #include <QStandardItemModel>
 #include <QString>
+#include <algorithm>
 #include <string>
+#include <string_view>
+#include <utility>
 
 namespace netsimulyzer {
 
+NodeWidget::NodeModel::~NodeModel() {
+  cancelFilter();
+}
+
+const parser::Node &NodeWidget::NodeModel::nodeAt(int row) const {
+  if (filter.empty())
+    return models->nodes[row];
+  return models->nodes[rows[row]];
+}
+
 int NodeWidget::NodeModel::rowCount(const QModelIndex &) const {
-  return static_cast<int>(nodes.size());
+  if (!models)
+    return 0;
+  if (filter.empty())
+    return static_cast<int>(models->nodes.size());
+  return static_cast<int>(rows.size());
 }
 
 int NodeWidget::NodeModel::columnCount(const QModelIndex &) const {
@@ -53,9 +70,9 @@ QVariant NodeWidget::NodeModel::data(const QModelIndex &index, int role) const {
   switch (role) {
   case Qt::UserRole:
     // Used for QTableView::doubleClicked signal for focusing on a Node
-    return {nodes[index.row()].id};
+    return {nodeAt(index.row()).id};
   case Qt::DisplayRole: {
-    const auto &node = nodes[index.row()];
+    const auto &node = nodeAt(index.row());
     switch (index.column()) {
     case 0:
       return {node.id};
@@ -90,10 +107,115 @@ QVariant NodeWidget::NodeModel::headerData(int section, Qt::Orientation orientat
     return {};
   }
 }
-void NodeWidget::NodeModel::append(const parser::Node &node) {
-  beginInsertRows({}, static_cast<int>(nodes.size()), static_cast<int>(nodes.size()));
-  nodes.emplace_back(node);
-  endInsertRows();
+void NodeWidget::NodeModel::setModels(std::shared_ptr<const parser::StaticModels> sharedModels) {
+  cancelFilter();
+
+  // Every Node is added at once, rather than a row at a time
+  beginResetModel();
+  models = std::move(sharedModels);
+  names.clear();
+  nameOffsets.clear();
+  filter.clear();
+  rows.clear();
+  endResetModel();
+}
+
+void NodeWidget::NodeModel::buildNameIndex() {
+  std::size_t size = 0u;
+  for (const auto &node : models->nodes)
+    size += node.name.size() + 1u;
+
+  names.reserve(size);
+  nameOffsets.reserve(models->nodes.size() + 1u);
+  for (const auto &node : models->nodes) {
+    nameOffsets.emplace_back(names.size());
+    auto name = QString::fromStdString(node.name).toLower();
+    // Keep each name on its own line, so no match spans two
+    name.replace('\n', ' ');
+    names += name.toStdString();
+    names += '\n';
+  }
+  nameOffsets.emplace_back(names.size());
+}
+
+void NodeWidget::NodeModel::cancelFilter() {
+  filterGeneration++;
+  worker.wait();
+}
+
+void NodeWidget::NodeModel::setFilter(const QString &text) {
+  cancelFilter();
+  if (!models)
+    return;
+
+  auto lowered = text.toLower();
+  lowered.remove('\n');
+  auto newFilter = lowered.toStdString();
+
+  if (newFilter.empty()) {
+    if (filter.empty())
+      return;
+
+    beginResetModel();
+    filter.clear();
+    rows.clear();
+    endResetModel();
+    return;
+  }
+
+  // Typing onto the end of the filter only matches Nodes the shorter one did
+  std::vector<std::size_t> candidates;
+  const auto narrowing = !filter.empty() && newFilter.compare(0u, filter.size(), filter) == 0;
+  if (narrowing)
+    candidates = rows;
+
+  const auto generation = filterGeneration.load();
+  auto search = [this, generation, narrowing, candidates = std::move(candidates),
+                 newFilter = std::move(newFilter), nodeModels = models]() {
+    // Only this worker reads the index, & the previous one was waited on
+    if (nameOffsets.empty())
+      buildNameIndex();
+
+    const auto idFilter = std::all_of(newFilter.begin(), newFilter.end(), [](char c) {
+      return c >= '0' && c <= '9';
+    });
+    const auto count = narrowing ? candidates.size() : nodeModels->nodes.size();
+    const std::string_view allNames{names};
+
+    std::vector<std::size_t> found;
+    for (std::size_t i = 0u; i < count; i++) {
+      // Check often enough that typing never waits on a stale filter
+      if (i % 4096u == 0u && filterGeneration != generation)
+        return;
+
+      const auto index = narrowing ? candidates[i] : i;
+      const auto name = allNames.substr(nameOffsets[index], nameOffsets[index + 1u] - nameOffsets[index] - 1u);
+      if (name.find(newFilter) != std::string_view::npos ||
+          (idFilter && std::to_string(nodeModels->nodes[index].id).compare(0u, newFilter.size(), newFilter) == 0))
+        found.emplace_back(index);
+    }
+
+    QMetaObject::invokeMethod(
+        this,
+        [this, generation, newFilter, found = std::move(found)]() mutable {
+          filterFinished(generation, std::move(newFilter), std::move(found));
+        },
+        Qt::QueuedConnection);
+  };
+  // Typing is waiting on the result, so it goes ahead of any background work
+  worker = parser::TaskPool::shared().submit(std::move(search), parser::TaskPool::Priority::Interactive);
+}
+
+void NodeWidget::NodeModel::filterFinished(unsigned int generation, std::string newFilter,
+                                           std::vector<std::size_t> found) {
+  // A newer filter, or scenario, was set since
+  if (generation != filterGeneration)
+    return;
+
+  beginResetModel();
+  filter = std::move(newFilter);
+  rows = std::move(found);
+  endResetModel();
 }
 
 Qt::ItemFlags NodeWidget::NodeModel::flags(const QModelIndex &index) const {
@@ -102,11 +224,16 @@ Qt::ItemFlags NodeWidget::NodeModel::flags(const QModelIndex &index) const {
 }
 
 void NodeWidget::NodeModel::reset() {
-  if (nodes.empty())
+  cancelFilter();
+  if (!models)
     return;
 
   beginResetModel();
-  nodes.clear();
+  models.reset();
+  names.clear();
+  nameOffsets.clear();
+  filter.clear();
+  rows.clear();
   endResetModel();
 }
 
@@ -117,6 +244,10 @@ NodeWidget::NodeWidget(QWidget *parent) : QWidget(parent) {
     emit nodeSelected(index.data(Qt::UserRole).toUInt());
   });
 
+  QObject::connect(ui->lineEditFilter, &QLineEdit::textChanged, [this](const QString &text) {
+    model.setFilter(text);
+  });
+
   proxyModel.setSourceModel(&model);
   ui->nodeTable->setModel(&proxyModel);
 
@@ -131,12 +262,15 @@ NodeWidget::~NodeWidget() {
   delete ui;
 }
 
-void NodeWidget::addNode(const parser::Node &node) {
-  model.append(node);
+void NodeWidget::setNodes(std::shared_ptr<const parser::StaticModels> models) {
+  model.setModels(std::move(models));
+  model.setFilter(ui->lineEditFilter->text());
 }
 
 void NodeWidget::reset() {
   model.reset();
+  // Only clears the text, the model has no filter once reset
+  ui->lineEditFilter->clear();
 }
 
 } // namespace netsimulyzer
\ No newline at end of file
@@ -38,8 +38,12 @@
 #include <QStandardItemModel>
 #include <QVariant>
 #include <QWidget>
+#include <atomic>
 #include <cstdint>
+#include <memory>
 #include <model.h>
+#include <string>
+#include <task-pool.h>
 #include <vector>
 
 namespace netsimulyzer {
@@ -48,17 +52,94 @@ class NodeWidget : public QWidget {
   Q_OBJECT
 
   /**
-   * Provides the data for the nodeTable
+   * Provides the data for the nodeTable.
+   *
+   * The rows matching a filter are found on a worker thread, see `setFilter()`.
+   * The previous rows are shown until it finishes
    */
   class NodeModel : public QAbstractTableModel {
     /**
-     * Each individual row in the table
+     * The Nodes in the table, by index.
+     * Unset while there is no scenario
      */
-    std::vector<parser::Node> nodes;
+    std::shared_ptr<const parser::StaticModels> models;
+
+    /**
+     * The lowercase name of every Node in `models`, each followed by a newline,
+     * so a filter is found with one search through the whole list.
+     * Built by the first filter worker, and only used by the workers after
+     */
+    std::string names;
+
+    /**
+     * The offset of each name in `names`, by index in `models`
+     */
+    std::vector<std::size_t> nameOffsets;
+
+    /**
+     * The filter of the shown rows, in lowercase.
+     * Empty to show every Node
+     */
+    std::string filter;
+
+    /**
+     * The index in `models` of each row matching `filter`, in order.
+     * Unused when there is no filter
+     */
+    std::vector<std::size_t> rows;
+
+    /**
+     * Finds the rows matching a new filter, see `setFilter()`
+     */
+    parser::TaskPool::Handle worker;
+
+    /**
+     * Incremented for each new filter. A worker stops once
+     * this no longer matches the value it started with
+     */
+    std::atomic<unsigned int> filterGeneration{0u};
+
+    /**
+     * @param row
+     * A shown row
+     *
+     * @return
+     * The Node on that row
+     */
+    [[nodiscard]] const parser::Node &nodeAt(int row) const;
+
+    /**
+     * Fill `names` & `nameOffsets` from `models`
+     */
+    void buildNameIndex();
+
+    /**
+     * Stop the worker, if it is running, dropping its rows
+     */
+    void cancelFilter();
+
+    /**
+     * Show the rows found by a worker
+     *
+     * @param generation
+     * The filter generation the worker started with
+     *
+     * @param newFilter
+     * The filter the worker applied
+     *
+     * @param found
+     * The index in `models` of each Node matching `newFilter`, in order
+     */
+    void filterFinished(unsigned int generation, std::string newFilter, std::vector<std::size_t> found);
 
   public:
     explicit NodeModel(QObject *parent = {}) : QAbstractTableModel(parent){};
 
+    // The worker refers to this model
+    NodeModel(const NodeModel &other) = delete;
+    NodeModel &operator=(const NodeModel &other) = delete;
+    ~NodeModel() override;
+
     [[nodiscard]] int rowCount(const QModelIndex &) const override;
     [[nodiscard]] int columnCount(const QModelIndex &) const override;
     [[nodiscard]] QVariant data(const QModelIndex &index, int role) const override;
@@ -66,12 +147,23 @@ class NodeWidget : public QWidget {
     [[nodiscard]] Qt::ItemFlags flags(const QModelIndex &index) const override;
 
     /**
-     * Add a Node to the table
+     * Show every Node in `sharedModels`, in place of the current rows
+     *
+     * @param sharedModels
+     * The models of the scenario, shared with the other widgets
+     */
+    void setModels(std::shared_ptr<const parser::StaticModels> sharedModels);
+
+    /**
+     * Show only the Nodes with `text` in their name, ignoring case,
+     * or with an ID starting with `text`.
+     *
+     * When `text` starts with the current filter, only the rows already shown are searched
      *
-     * @param node
-     * The Node to add to the table
+     * @param text
+     * The filter, empty to show every Node
      */
-    void append(const parser::Node &node);
+    void setFilter(const QString &text);
 
     /**
      * Clear all Nodes from the model
@@ -87,7 +179,13 @@ public:
   explicit NodeWidget(QWidget *parent = nullptr);
   ~NodeWidget() override;
 
-  void addNode(const parser::Node &node);
+  /**
+   * List the Nodes in `models`
+   *
+   * @param models
+   * The models of the scenario, shared with the other widgets
+   */
+  void setNodes(std::shared_ptr<const parser::StaticModels> models);
   void reset();
 
 signals:
@@ -40,6 +40,7 @@
 #include <QPushButton>
 #include <QString>
 #include <limits>
+#include <utility>
 
 namespace {
 
@@ -86,6 +87,7 @@ void PlaybackWidget::setGranularity(SettingsManager::TimeUnit unit) {
 }
 
 void PlaybackWidget::setTimeLabel(parser::nanoseconds time) {
+  shownTime = time;
   ui.labelTime->setText(toDisplayTime(time, currentUnit) + " / " + formattedMaxTime);
 }
 
@@ -104,11 +106,23 @@ PlaybackWidget::PlaybackWidget(QWidget *parent) : QWidget(parent) {
   // Pull the system fixed width font and use it for the numeric time
   ui.labelTime->setFont(QFontDatabase::systemFont(QFontDatabase::FixedFont));
 
+  // Only shown while a scenario is loading
+  ui.progressLoading->hide();
+
+  // Only shown while playback is falling behind
+  ui.labelBehind->hide();
+
+  // Only shown for a moment after idle time is skipped
+  ui.labelSkipped->hide();
+  skippedTimer.setSingleShot(true);
+  skippedTimer.setInterval(skippedDisplayTime);
+  QObject::connect(&skippedTimer, &QTimer::timeout, ui.labelSkipped, &QLabel::hide);
+
   QObject::connect(ui.buttonPlayPause, &QPushButton::pressed, [this]() {
     playing = !playing;
     if (playing) {
       // If we're at the end, restart from the beginning
-      if (currentTime == maxTime) {
+      if (currentTime == maxTime && !loadingScenario) {
         setTime(0LL);
         emit timeSet(0LL);
       }
@@ -122,6 +136,18 @@ PlaybackWidget::PlaybackWidget(QWidget *parent) : QWidget(parent) {
 
   QObject::connect(ui.timelineSlider, &QSlider::valueChanged, this, &PlaybackWidget::sliderMoved);
 
+  previewTimer.setSingleShot(true);
+  previewTimer.setInterval(previewInterval);
+  QObject::connect(&previewTimer, &QTimer::timeout, [this]() {
+    emit timePreviewed(currentTime);
+  });
+
+  // Finish the seek previewed during the drag
+  QObject::connect(ui.timelineSlider, &QSlider::sliderReleased, [this]() {
+    previewTimer.stop();
+    emit timeSet(currentTime);
+  });
+
   QObject::connect(ui.buttonPlaybackSpeed, &QPushButton::clicked, [this]() {
     timeStepDialog.show();
   });
@@ -159,8 +185,9 @@ PlaybackWidget::PlaybackWidget(QWidget *parent) : QWidget(parent) {
 void PlaybackWidget::setMaxTime(parser::nanoseconds value) {
   formattedMaxTime = toDisplayTime(value, currentUnit);
   maxTime = value;
-  setTimeLabel(0LL);
+  setTimeLabel(currentTime);
   jumpDialog.setMaxTime(maxTime);
+  ui.timelineSlider->setMaxTime(maxTime);
 
   // Roughly 2 secs
   if (maxTime <= std::numeric_limits<int>::max()) {
@@ -170,17 +197,28 @@ void PlaybackWidget::setMaxTime(parser::nanoseconds value) {
     timeSliderStep = static_cast<double>(maxTime) / std::numeric_limits<int>::max();
     ui.timelineSlider->setMaximum(std::numeric_limits<int>::max());
   }
-}
 
-void PlaybackWidget::setTime(parser::nanoseconds simulationTime) {
+  // The max time may grow while loading, so keep the slider at the current time
   ignoreMove = true;
+  ui.timelineSlider->setValue(static_cast<int>(currentTime / timeSliderStep));
+  ignoreMove = false;
+}
 
+void PlaybackWidget::setTime(parser::nanoseconds simulationTime) {
   if (simulationTime > maxTime)
     simulationTime = maxTime;
 
   currentTime = simulationTime;
-  ui.timelineSlider->setValue(static_cast<int>(simulationTime / timeSliderStep));
-  setTimeLabel(simulationTime);
+}
+
+void PlaybackWidget::showTime() {
+  // Leave the slider under the cursor while it is dragged
+  if (currentTime == shownTime || ui.timelineSlider->isSliderDown())
+    return;
+
+  ignoreMove = true;
+  ui.timelineSlider->setValue(static_cast<int>(currentTime / timeSliderStep));
+  setTimeLabel(currentTime);
   ignoreMove = false;
 }
 
@@ -200,7 +238,7 @@ void PlaybackWidget::sliderMoved(int value) {
   if (timeValue > maxTime)
     timeValue = maxTime;
 
-  if (timeValue == maxTime && !playing)
+  if (timeValue == maxTime && !playing && !loadingScenario)
     ui.buttonPlayPause->setIcon(resetIcon);
   else if (playing)
     ui.buttonPlayPause->setIcon(pauseIcon);
@@ -208,17 +246,31 @@ void PlaybackWidget::sliderMoved(int value) {
     ui.buttonPlayPause->setIcon(playIcon);
 
   setTime(timeValue);
+  setTimeLabel(timeValue);
+
+  if (ui.timelineSlider->isSliderDown()) {
+    if (!previewTimer.isActive())
+      previewTimer.start();
+    return;
+  }
+
   emit timeSet(timeValue);
 }
 
 void PlaybackWidget::reset() {
+  previewTimer.stop();
   ui.timelineSlider->setValue(0);
-  setMaxTime(0LL);
   currentTime = 0LL;
+  setMaxTime(0LL);
 
   ui.buttonPlayPause->setEnabled(false);
   ui.timelineSlider->setEnabled(false);
   ui.buttonJump->setEnabled(false);
+  clearLoadProgress();
+  setBehind(false);
+  skippedTimer.stop();
+  ui.labelSkipped->hide();
+  ui.timelineSlider->clearDensity();
 }
 
 void PlaybackWidget::enableControls() {
@@ -227,6 +279,35 @@ void PlaybackWidget::enableControls() {
   ui.buttonJump->setEnabled(true);
 }
 
+void PlaybackWidget::setLoadProgress(double progress, parser::nanoseconds loadedTime) {
+  if (loadedTime > maxTime)
+    setMaxTime(loadedTime);
+
+  loadingScenario = true;
+  ui.progressLoading->setValue(static_cast<int>(progress * 100.0));
+  ui.progressLoading->show();
+}
+
+void PlaybackWidget::setEventDensity(parser::EventDensity::Histogram density) {
+  ui.timelineSlider->setDensity(std::move(density));
+}
+
+void PlaybackWidget::clearLoadProgress() {
+  loadingScenario = false;
+  ui.progressLoading->hide();
+  ui.progressLoading->setValue(0);
+}
+
+void PlaybackWidget::setBehind(bool value) {
+  ui.labelBehind->setVisible(value);
+}
+
+void PlaybackWidget::showSkipped(parser::nanoseconds amount) {
+  ui.labelSkipped->setText("Skipped " + toDisplayTime(amount, currentUnit));
+  ui.labelSkipped->show();
+  skippedTimer.start();
+}
+
 bool PlaybackWidget::isPlaying() const {
   return playing;
 }
@@ -237,7 +318,7 @@ void PlaybackWidget::setPlaying() {
 }
 
 void PlaybackWidget::setPaused() {
-  if (currentTime == maxTime)
+  if (currentTime == maxTime && !loadingScenario)
     ui.buttonPlayPause->setIcon(resetIcon);
   else
     ui.buttonPlayPause->setIcon(playIcon);
@@ -39,7 +39,9 @@
 #include <QIcon>
 #include <QString>
 #include <QStyle>
+#include <QTimer>
 #include <QWidget>
+#include <parser/event-density.h>
 #include <parser/model.h>
 
 namespace netsimulyzer {
@@ -57,6 +59,13 @@ private:
       settings.get<SettingsManager::TimeUnit>(SettingsManager::Key::PlaybackTimeStepUnit).value();
   QString formattedMaxTime{"0.000"};
   bool playing{false};
+
+  /**
+   * Set while the scenario is still loading.
+   * The max time is not the end of the scenario yet,
+   * so reaching it does not restart playback
+   */
+  bool loadingScenario{false};
   const QIcon playIcon = style()->standardIcon(QStyle::SP_MediaPlay);
   const QIcon resetIcon = style()->standardIcon(QStyle::SP_MediaSkipBackward);
   const QIcon pauseIcon = style()->standardIcon(QStyle::SP_MediaPause);
@@ -70,6 +79,34 @@ private:
    */
   bool ignoreMove{false};
 
+  /**
+   * The time last shown on the slider & label,
+   * so `showTime()` may skip formatting it again
+   */
+  parser::nanoseconds shownTime{0LL};
+
+  /**
+   * Running while a drag of the timeline is being previewed.
+   * Moves during the drag are coalesced into one `timePreviewed()` per interval,
+   * and the seek is only finished with `timeSet()` once the slider is released
+   */
+  QTimer previewTimer;
+
+  /**
+   * Time between previews while dragging the timeline, in milliseconds
+   */
+  static constexpr int previewInterval = 40;
+
+  /**
+   * Hides `labelSkipped` once playback has gone on for a while past the last skip
+   */
+  QTimer skippedTimer;
+
+  /**
+   * How long `labelSkipped` is shown after a skip, in milliseconds
+   */
+  static constexpr int skippedDisplayTime = 2000;
+
   void updateButtonSpeed(parser::nanoseconds step, SettingsManager::TimeUnit unit);
   void setGranularity(SettingsManager::TimeUnit unit);
   void setTimeLabel(parser::nanoseconds time);
@@ -78,12 +115,65 @@ public:
   explicit PlaybackWidget(QWidget *parent = nullptr);
 
   void setMaxTime(parser::nanoseconds value);
+  /**
+   * Set the current time, without updating the slider or label.
+   * Cheap enough to call every frame
+   *
+   * @see showTime()
+   */
   void setTime(parser::nanoseconds simulationTime);
+
+  /**
+   * Move the slider & label to the current time,
+   * if it changed since they were last updated
+   */
+  void showTime();
   void setTimeStep(parser::nanoseconds value, SettingsManager::TimeUnit unit);
   void sliderMoved(int value);
   void reset();
   void enableControls();
 
+  /**
+   * Show the progress of a scenario which is still loading
+   *
+   * @param progress
+   * The fraction of the scenario loaded, from 0.0 to 1.0
+   *
+   * @param loadedTime
+   * The time of the latest loaded event.
+   * The max time is extended to this if it is past it
+   */
+  void setLoadProgress(double progress, parser::nanoseconds loadedTime);
+
+  /**
+   * Show how many events of each kind are in each stretch of the scenario, behind the timeline
+   *
+   * @param density
+   * The events counted so far
+   */
+  void setEventDensity(parser::EventDensity::Histogram density);
+
+  /**
+   * Hide the loading progress, once the scenario is completely loaded
+   */
+  void clearLoadProgress();
+
+  /**
+   * Show, or hide, that playback is falling behind wall time
+   *
+   * @param value
+   * True when playback is behind
+   */
+  void setBehind(bool value);
+
+  /**
+   * Briefly show that playback jumped over a stretch with no events
+   *
+   * @param amount
+   * The time jumped over
+   */
+  void showSkipped(parser::nanoseconds amount);
+
   [[nodiscard]] bool isPlaying() const;
   void setPlaying();
   void setPaused();
@@ -92,6 +182,15 @@ signals:
   void play();
   void pause();
   void timeSet(parser::nanoseconds time);
+
+  /**
+   * Emitted while the timeline is dragged, to show the scene at `time`
+   * without updating the charts & log
+   *
+   * @param time
+   * The time under the slider
+   */
+  void timePreviewed(parser::nanoseconds time);
   void timeStepChanged(parser::nanoseconds value, int unit);
 };
 
@@ -0,0 +1,117 @@
+/*
+ * NIST-developed software is provided by NIST as a public service. You may use,
+ * copy and distribute copies of the software in any medium, provided that you
+ * keep intact this entire notice. You may improve,modify and create derivative
+ * works of the software or any portion of the software, and you may copy and
+ * distribute such modifications or works. Modified works should carry a notice
+ * stating that you changed the software and should note the date and nature of
+ * any such change. Please explicitly acknowledge the National Institute of
+ * Standards and Technology as the source of the software.
+ *
+ * NIST-developed software is expressly provided "AS IS." NIST MAKES NO
+ * WARRANTY OF ANY KIND, EXPRESS, IMPLIED, IN FACT OR ARISING BY OPERATION OF
+ * LAW, INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTY OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, NON-INFRINGEMENT
+ * AND DATA ACCURACY. NIST NEITHER REPRESENTS NOR WARRANTS THAT THE
+ * OPERATION OF THE SOFTWARE WILL BE UNINTERRUPTED OR ERROR-FREE, OR THAT
+ * ANY DEFECTS WILL BE CORRECTED. NIST DOES NOT WARRANT OR MAKE ANY
+ * REPRESENTATIONS REGARDING THE USE OF THE SOFTWARE OR THE RESULTS THEREOF,
+ * INCLUDING BUT NOT LIMITED TO THE CORRECTNESS, ACCURACY, RELIABILITY,
+ * OR USEFULNESS OF THE SOFTWARE.
+ *
+ * You are solely responsible for determining the appropriateness of using and
+ * distributing the software and you assume all risks associated with its use,
+ * including but not limited to the risks and costs of program errors,
+ * compliance with applicable laws, damage to or loss of data, programs or
+ * equipment, and the unavailability or interruption of operation. This
+ * software is not intended to be used in any situation where a failure could
+ * cause risk of injury or damage to property. The software developed by NIST
+ * employees is not subject to copyright protection within the United States.
+ *
+ * Author: Evan Black <evan.black@nist.gov>
+ */
+
+#include "TimelineSlider.h"
+#include <QColor>
+#include <QPainter>
+#include <QRectF>
+#include <QStyle>
+#include <QStyleOptionSlider>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <utility>
+
+TimelineSlider::TimelineSlider(QWidget *parent) : QSlider(parent) {
+}
+
+void TimelineSlider::paintEvent(QPaintEvent *event) {
+  using parser::EventDensity;
+
+  const auto any = std::any_of(peaks.begin(), peaks.end(), [](std::uint32_t peak) {
+    return peak > 0u;
+  });
+
+  if (maxTime > 0LL && any) {
+    QStyleOptionSlider option;
+    initStyleOption(&option);
+    const auto groove = style()->subControlRect(QStyle::CC_Slider, &option, QStyle::SC_SliderGroove, this);
+    const auto handle = style()->subControlRect(QStyle::CC_Slider, &option, QStyle::SC_SliderHandle, this);
+
+    // The center of the handle stops half a handle short of each end of the groove
+    const auto left = groove.left() + handle.width() / 2.0;
+    const auto span = static_cast<double>(groove.width() - handle.width());
+    const auto rowHeight = static_cast<double>(height()) / EventDensity::KindCount;
+
+    // Moves, transmits, series appends, log lines
+    const std::array<QColor, EventDensity::KindCount> colors{QColor{40, 110, 230}, QColor{220, 50, 40},
+                                                             QColor{40, 170, 70}, QColor{230, 150, 20}};
+
+    QPainter painter{this};
+    for (std::size_t kind = 0u; kind < EventDensity::KindCount; kind++) {
+      if (peaks[kind] == 0u)
+        continue;
+
+      const auto top = rowHeight * static_cast<double>(kind);
+      for (std::size_t i = 0u; i < EventDensity::bucketCount; i++) {
+        const auto count = density.buckets[i][kind];
+        const auto start = density.bucketWidth * static_cast<parser::nanoseconds>(i);
+        if (start >= maxTime)
+          break;
+        if (count == 0u)
+          continue;
+
+        const auto end = std::min(start + density.bucketWidth, maxTime);
+        const auto x0 = left + span * static_cast<double>(start) / static_cast<double>(maxTime);
+        const auto x1 = left + span * static_cast<double>(end) / static_cast<double>(maxTime);
+
+        // Square root, so quiet stretches still show next to a busy one
+        auto color = colors[kind];
+        color.setAlphaF(0.15 + 0.65 * std::sqrt(static_cast<double>(count) / peaks[kind]));
+        painter.fillRect(QRectF{x0, top, std::max(1.0, x1 - x0), rowHeight}, color);
+      }
+    }
+  }
+
+  QSlider::paintEvent(event);
+}
+
+void TimelineSlider::setDensity(parser::EventDensity::Histogram value) {
+  density = std::move(value);
+
+  peaks = {};
+  for (const auto &bucket : density.buckets) {
+    for (std::size_t kind = 0u; kind < parser::EventDensity::KindCount; kind++)
+      peaks[kind] = std::max(peaks[kind], bucket[kind]);
+  }
+  update();
+}
+
+void TimelineSlider::clearDensity() {
+  setDensity({});
+}
+
+void TimelineSlider::setMaxTime(parser::nanoseconds value) {
+  maxTime = value;
+  update();
+}
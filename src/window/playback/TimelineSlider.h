@@ -0,0 +1,89 @@
+/*
+ * NIST-developed software is provided by NIST as a public service. You may use,
+ * copy and distribute copies of the software in any medium, provided that you
+ * keep intact this entire notice. You may improve,modify and create derivative
+ * works of the software or any portion of the software, and you may copy and
+ * distribute such modifications or works. Modified works should carry a notice
+ * stating that you changed the software and should note the date and nature of
+ * any such change. Please explicitly acknowledge the National Institute of
+ * Standards and Technology as the source of the software.
+ *
+ * NIST-developed software is expressly provided "AS IS." NIST MAKES NO
+ * WARRANTY OF ANY KIND, EXPRESS, IMPLIED, IN FACT OR ARISING BY OPERATION OF
+ * LAW, INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTY OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, NON-INFRINGEMENT
+ * AND DATA ACCURACY. NIST NEITHER REPRESENTS NOR WARRANTS THAT THE
+ * OPERATION OF THE SOFTWARE WILL BE UNINTERRUPTED OR ERROR-FREE, OR THAT
+ * ANY DEFECTS WILL BE CORRECTED. NIST DOES NOT WARRANT OR MAKE ANY
+ * REPRESENTATIONS REGARDING THE USE OF THE SOFTWARE OR THE RESULTS THEREOF,
+ * INCLUDING BUT NOT LIMITED TO THE CORRECTNESS, ACCURACY, RELIABILITY,
+ * OR USEFULNESS OF THE SOFTWARE.
+ *
+ * You are solely responsible for determining the appropriateness of using and
+ * distributing the software and you assume all risks associated with its use,
+ * including but not limited to the risks and costs of program errors,
+ * compliance with applicable laws, damage to or loss of data, programs or
+ * equipment, and the unavailability or interruption of operation. This
+ * software is not intended to be used in any situation where a failure could
+ * cause risk of injury or damage to property. The software developed by NIST
+ * employees is not subject to copyright protection within the United States.
+ *
+ * Author: Evan Black <evan.black@nist.gov>
+ */
+
+#pragma once
+
+#include <QPaintEvent>
+#include <QSlider>
+#include <QWidget>
+#include <event-density.h>
+
+// Outside of the visualizer namespace,
+// so it may be used from the Qt Creator designer
+
+/**
+ * Timeline slider showing how busy each stretch of the scenario is,
+ * as a strip for each kind of event behind the groove
+ */
+class TimelineSlider : public QSlider {
+  Q_OBJECT
+
+  parser::EventDensity::Histogram density;
+
+  /**
+   * The most events of each kind in one bucket of `density`
+   */
+  parser::EventDensity::Counts peaks{};
+
+  /**
+   * The time at the right end of the slider
+   */
+  parser::nanoseconds maxTime{0LL};
+
+protected:
+  void paintEvent(QPaintEvent *event) override;
+
+public:
+  explicit TimelineSlider(QWidget *parent = nullptr);
+
+  /**
+   * Show `value` behind the groove
+   *
+   * @param value
+   * The events counted so far
+   */
+  void setDensity(parser::EventDensity::Histogram value);
+
+  /**
+   * Remove the density strips
+   */
+  void clearDensity();
+
+  /**
+   * Set the time at the right end of the slider, so the strips line up with the handle
+   *
+   * @param value
+   * The maximum time of the slider
+   */
+  void setMaxTime(parser::nanoseconds value);
+};
@@ -0,0 +1,157 @@
+/*
+ * NIST-developed software is provided by NIST as a public service. You may use,
+ * copy and distribute copies of the software in any medium, provided that you
+ * keep intact this entire notice. You may improve,modify and create derivative
+ * works of the software or any portion of the software, and you may copy and
+ * distribute such modifications or works. Modified works should carry a notice
+ * stating that you changed the software and should note the date and nature of
+ * any such change. Please explicitly acknowledge the National Institute of
+ * Standards and Technology as the source of the software.
+ *
+ * NIST-developed software is expressly provided "AS IS." NIST MAKES NO
+ * WARRANTY OF ANY KIND, EXPRESS, IMPLIED, IN FACT OR ARISING BY OPERATION OF
+ * LAW, INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTY OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, NON-INFRINGEMENT
+ * AND DATA ACCURACY. NIST NEITHER REPRESENTS NOR WARRANTS THAT THE
+ * OPERATION OF THE SOFTWARE WILL BE UNINTERRUPTED OR ERROR-FREE, OR THAT
+ * ANY DEFECTS WILL BE CORRECTED. NIST DOES NOT WARRANT OR MAKE ANY
+ * REPRESENTATIONS REGARDING THE USE OF THE SOFTWARE OR THE RESULTS THEREOF,
+ * INCLUDING BUT NOT LIMITED TO THE CORRECTNESS, ACCURACY, RELIABILITY,
+ * OR USEFULNESS OF THE SOFTWARE.
+ *
+ * You are solely responsible for determining the appropriateness of using and
+ * distributing the software and you assume all risks associated with its use,
+ * including but not limited to the risks and costs of program errors,
+ * compliance with applicable laws, damage to or loss of data, programs or
+ * equipment, and the unavailability or interruption of operation. This
+ * software is not intended to be used in any situation where a failure could
+ * cause risk of injury or damage to property. The software developed by NIST
+ * employees is not subject to copyright protection within the United States.
+ *
+ * Author: Evan Black <evan.black@nist.gov>
+ */
+
+#include "CameraPath.h"
+#include <QFile>
+#include <QStringList>
+#include <QTextStream>
+#include <algorithm>
+#include <glm/common.hpp>
+#include <iterator>
+
+namespace {
+
+/**
+ * @return
+ * The simulation time `fraction` of the way from `from` to `to`,
+ * held at `from` unless playback was running
+ */
+parser::nanoseconds interpolateTime(const netsimulyzer::CameraPath::Sample &from,
+                                    const netsimulyzer::CameraPath::Sample &to, double fraction) {
+  if (!from.playing)
+    return from.simulationTime;
+
+  const auto span = static_cast<double>(to.simulationTime - from.simulationTime);
+  return from.simulationTime + static_cast<parser::nanoseconds>(span * fraction);
+}
+
+} // namespace
+
+namespace netsimulyzer {
+
+void CameraPath::add(const CameraPath::Sample &sample) {
+  if (!samples.empty() && sample.time < samples.back().time)
+    return;
+
+  samples.emplace_back(sample);
+}
+
+bool CameraPath::empty() const {
+  return samples.empty();
+}
+
+parser::nanoseconds CameraPath::duration() const {
+  if (samples.empty())
+    return 0LL;
+
+  return samples.back().time - samples.front().time;
+}
+
+CameraPath::Sample CameraPath::at(parser::nanoseconds time) const {
+  const auto target = samples.front().time + std::clamp(time, 0LL, duration());
+
+  // The first sample after `target`
+  const auto next = std::upper_bound(samples.begin(), samples.end(), target,
+                                     [](parser::nanoseconds value, const Sample &sample) {
+                                       return value < sample.time;
+                                     });
+  if (next == samples.begin())
+    return samples.front();
+  if (next == samples.end())
+    return samples.back();
+
+  const auto &from = *std::prev(next);
+  const auto &to = *next;
+  const auto fraction = static_cast<double>(target - from.time) / static_cast<double>(to.time - from.time);
+  const auto fractionF = static_cast<float>(fraction);
+
+  Sample sample;
+  sample.time = target;
+  sample.position = glm::mix(from.position, to.position, fractionF);
+  sample.yaw = glm::mix(from.yaw, to.yaw, fractionF);
+  sample.pitch = glm::mix(from.pitch, to.pitch, fractionF);
+  sample.simulationTime = interpolateTime(from, to, fraction);
+  sample.playing = from.playing;
+  return sample;
+}
+
+bool CameraPath::save(const QString &path) const {
+  QFile file{path};
+  if (!file.open(QFile::WriteOnly | QFile::Truncate | QFile::Text))
+    return false;
+
+  QTextStream out{&file};
+  out.setRealNumberPrecision(9);
+  out << "time_ns,x,y,z,yaw,pitch,simulation_time_ns,playing\n";
+  for (const auto &sample : samples) {
+    out << sample.time << ',' << sample.position.x << ',' << sample.position.y << ',' << sample.position.z << ','
+        << sample.yaw << ',' << sample.pitch << ',' << sample.simulationTime << ',' << (sample.playing ? 1 : 0)
+        << '\n';
+  }
+
+  out.flush();
+  return file.error() == QFile::NoError;
+}
+
+std::optional<CameraPath> CameraPath::read(const QString &path) {
+  QFile file{path};
+  if (!file.open(QFile::ReadOnly | QFile::Text))
+    return {};
+
+  QTextStream in{&file};
+  // Skip the header
+  in.readLine();
+
+  CameraPath cameraPath;
+  while (!in.atEnd()) {
+    const auto fields = in.readLine().split(',');
+    if (fields.size() != 8)
+      continue;
+
+    Sample sample;
+    sample.time = fields[0].toLongLong();
+    sample.position = {fields[1].toFloat(), fields[2].toFloat(), fields[3].toFloat()};
+    sample.yaw = fields[4].toFloat();
+    sample.pitch = fields[5].toFloat();
+    sample.simulationTime = fields[6].toLongLong();
+    sample.playing = fields[7].toInt() != 0;
+    cameraPath.add(sample);
+  }
+
+  if (cameraPath.empty())
+    return {};
+
+  return cameraPath;
+}
+
+} // namespace netsimulyzer
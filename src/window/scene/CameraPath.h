@@ -0,0 +1,124 @@
+/*
+ * NIST-developed software is provided by NIST as a public service. You may use,
+ * copy and distribute copies of the software in any medium, provided that you
+ * keep intact this entire notice. You may improve,modify and create derivative
+ * works of the software or any portion of the software, and you may copy and
+ * distribute such modifications or works. Modified works should carry a notice
+ * stating that you changed the software and should note the date and nature of
+ * any such change. Please explicitly acknowledge the National Institute of
+ * Standards and Technology as the source of the software.
+ *
+ * NIST-developed software is expressly provided "AS IS." NIST MAKES NO
+ * WARRANTY OF ANY KIND, EXPRESS, IMPLIED, IN FACT OR ARISING BY OPERATION OF
+ * LAW, INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTY OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, NON-INFRINGEMENT
+ * AND DATA ACCURACY. NIST NEITHER REPRESENTS NOR WARRANTS THAT THE
+ * OPERATION OF THE SOFTWARE WILL BE UNINTERRUPTED OR ERROR-FREE, OR THAT
+ * ANY DEFECTS WILL BE CORRECTED. NIST DOES NOT WARRANT OR MAKE ANY
+ * REPRESENTATIONS REGARDING THE USE OF THE SOFTWARE OR THE RESULTS THEREOF,
+ * INCLUDING BUT NOT LIMITED TO THE CORRECTNESS, ACCURACY, RELIABILITY,
+ * OR USEFULNESS OF THE SOFTWARE.
+ *
+ * You are solely responsible for determining the appropriateness of using and
+ * distributing the software and you assume all risks associated with its use,
+ * including but not limited to the risks and costs of program errors,
+ * compliance with applicable laws, damage to or loss of data, programs or
+ * equipment, and the unavailability or interruption of operation. This
+ * software is not intended to be used in any situation where a failure could
+ * cause risk of injury or damage to property. The software developed by NIST
+ * employees is not subject to copyright protection within the United States.
+ *
+ * Author: Evan Black <evan.black@nist.gov>
+ */
+
+#pragma once
+
+#include <QString>
+#include <glm/glm.hpp>
+#include <model.h>
+#include <optional>
+#include <vector>
+
+namespace netsimulyzer {
+
+/**
+ * A recorded flight of the camera, with the playback state at each point,
+ * so the same view of a scenario may be drawn again frame for frame.
+ * Saved as CSV, one sample per line
+ */
+class CameraPath {
+public:
+  struct Sample {
+    /**
+     * Wall time since the recording started
+     */
+    parser::nanoseconds time{0LL};
+    glm::vec3 position{0.0f};
+    float yaw{-90.0f};
+    float pitch{0.0f};
+    parser::nanoseconds simulationTime{0LL};
+
+    /**
+     * If playback was running, rather than paused
+     */
+    bool playing{false};
+  };
+
+private:
+  /**
+   * In `time` order
+   */
+  std::vector<Sample> samples;
+
+public:
+  /**
+   * Add a sample to the end of the path.
+   * Samples earlier than the last one are dropped
+   */
+  void add(const Sample &sample);
+
+  [[nodiscard]] bool empty() const;
+
+  /**
+   * @return
+   * The wall time from the first sample to the last
+   */
+  [[nodiscard]] parser::nanoseconds duration() const;
+
+  /**
+   * Find where the camera was at `time`.
+   * The view is interpolated between the samples around `time`,
+   * as is the simulation time while playing. While paused the simulation time holds
+   *
+   * @param time
+   * Wall time since the first sample, clamped to the path
+   *
+   * @return
+   * The view & playback state at `time`. Do not call on an empty path
+   */
+  [[nodiscard]] Sample at(parser::nanoseconds time) const;
+
+  /**
+   * Write the path to `path` as CSV
+   *
+   * @param path
+   * The file to write to, replaced if it exists
+   *
+   * @return
+   * True if the file was written, false otherwise
+   */
+  [[nodiscard]] bool save(const QString &path) const;
+
+  /**
+   * Read a path written by `save()`
+   *
+   * @param path
+   * The file to read
+   *
+   * @return
+   * The path, unset if the file could not be read, or has no samples
+   */
+  [[nodiscard]] static std::optional<CameraPath> read(const QString &path);
+};
+
+} // namespace netsimulyzer
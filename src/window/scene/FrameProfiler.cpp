@@ -0,0 +1,362 @@
+/*
+ * NIST-developed software is provided by NIST as a public service. You may use,
+ * copy and distribute copies of the software in any medium, provided that you
+ * keep intact this entire notice. You may improve,modify and create derivative
+ * works of the software or any portion of the software, and you may copy and
+ * distribute such modifications or works. Modified works should carry a notice
+ * stating that you changed the software and should note the date and nature of
+ * any such change. Please explicitly acknowledge the National Institute of
+ * Standards and Technology as the source of the software.
+ *
+ * NIST-developed software is expressly provided "AS IS." NIST MAKES NO
+ * WARRANTY OF ANY KIND, EXPRESS, IMPLIED, IN FACT OR ARISING BY OPERATION OF
+ * LAW, INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTY OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, NON-INFRINGEMENT
+ * AND DATA ACCURACY. NIST NEITHER REPRESENTS NOR WARRANTS THAT THE
+ * OPERATION OF THE SOFTWARE WILL BE UNINTERRUPTED OR ERROR-FREE, OR THAT
+ * ANY DEFECTS WILL BE CORRECTED. NIST DOES NOT WARRANT OR MAKE ANY
+ * REPRESENTATIONS REGARDING THE USE OF THE SOFTWARE OR THE RESULTS THEREOF,
+ * INCLUDING BUT NOT LIMITED TO THE CORRECTNESS, ACCURACY, RELIABILITY,
+ * OR USEFULNESS OF THE SOFTWARE.
+ *
+ * You are solely responsible for determining the appropriateness of using and
+ * distributing the software and you assume all risks associated with its use,
+ * including but not limited to the risks and costs of program errors,
+ * compliance with applicable laws, damage to or loss of data, programs or
+ * equipment, and the unavailability or interruption of operation. This
+ * software is not intended to be used in any situation where a failure could
+ * cause risk of injury or damage to property. The software developed by NIST
+ * employees is not subject to copyright protection within the United States.
+ *
+ * Author: Evan Black <evan.black@nist.gov>
+ */
+
+
+#include "FrameProfiler.h"
+#include "src/render/render-stats.h"
+#include <QFile>
+#include <QTextStream>
+#include <algorithm>
+#include <cmath>
+#include <trace.h>
+
+namespace {
+
+/**
+ * The name of each `FrameProfiler::Stage` in a trace
+ */
+constexpr const char *traceNames[]{"paintGL/events", "picking",        "paintGL/opaque",
+                                   "paintGL/transparent", "paintGL/labels", "qt"};
+
+} // namespace
+
+namespace netsimulyzer {
+
+bool FrameProfiler::hasGpuWork(FrameProfiler::Stage stage) {
+  return stage != Stage::Events && stage != Stage::Qt;
+}
+
+FrameProfiler::FrameQueries &FrameProfiler::queriesFor(std::uint64_t frame) {
+  return queries[frame % queryLatency];
+}
+
+void FrameProfiler::collect(FrameProfiler::FrameQueries &frameQueries) {
+  // Frames are numbered in order, so find the frame by its distance from the first
+  Frame *frame = nullptr;
+  if (!history.empty() && frameQueries.frame >= history.front().number &&
+      frameQueries.frame - history.front().number < history.size())
+    frame = &history[frameQueries.frame - history.front().number];
+
+  for (auto i = 0u; i < stageCount; i++) {
+    if (!frameQueries.issued[i])
+      continue;
+    frameQueries.issued[i] = false;
+
+    GLint available = GL_FALSE;
+    glGetQueryObjectiv(frameQueries.queries[i], GL_QUERY_RESULT_AVAILABLE, &available);
+
+    // Still not done, so drop it, rather than wait
+    if (!available || !frame)
+      continue;
+
+    GLuint64 nanoseconds = 0u;
+    glGetQueryObjectui64v(frameQueries.queries[i], GL_QUERY_RESULT, &nanoseconds);
+    frame->gpuMilliseconds[i] = static_cast<double>(nanoseconds) / 1'000'000.0;
+  }
+}
+
+void FrameProfiler::init() {
+  initializeOpenGLFunctions();
+
+  for (auto &frameQueries : queries)
+    glGenQueries(static_cast<GLsizei>(stageCount), frameQueries.queries.data());
+
+  initialized = true;
+}
+
+bool FrameProfiler::isEnabled() const {
+  return enabled;
+}
+
+void FrameProfiler::setEnabled(bool enable) {
+  if (enable && !enabled) {
+    history.clear();
+    lastFrameEnd.reset();
+    eventsApplied = 0u;
+    betweenFrames = {};
+    stats::frameCounters = {};
+  }
+
+  enabled = enable;
+}
+
+std::uint64_t FrameProfiler::getNextFrame() const {
+  return nextFrame;
+}
+
+FrameProfiler::Percentiles FrameProfiler::percentiles(std::vector<double> &values) {
+  Percentiles result;
+  if (values.empty())
+    return result;
+
+  std::sort(values.begin(), values.end());
+  const auto rank = [&values](double percentile) {
+    const auto index = static_cast<std::size_t>(std::ceil(percentile * static_cast<double>(values.size())));
+    return values[std::clamp<std::size_t>(index, 1u, values.size()) - 1u];
+  };
+
+  result.p50 = rank(0.50);
+  result.p95 = rank(0.95);
+  result.p99 = rank(0.99);
+  return result;
+}
+
+FrameProfiler::FrameTimes FrameProfiler::frameTimes(std::uint64_t first, std::size_t count) const {
+  const auto qtIndex = static_cast<std::size_t>(Stage::Qt);
+  std::vector<double> cpu;
+  std::vector<double> gpu;
+
+  for (const auto &frame : history) {
+    if (frame.number < first || frame.number - first >= count)
+      continue;
+
+    double cpuTime = 0.0;
+    double gpuTime = 0.0;
+    bool gpuTimed = false;
+    for (auto i = 0u; i < stageCount; i++) {
+      if (i == qtIndex)
+        continue;
+
+      cpuTime += frame.cpuMilliseconds[i];
+      if (frame.gpuMilliseconds[i]) {
+        gpuTime += frame.gpuMilliseconds[i].value();
+        gpuTimed = true;
+      }
+    }
+
+    cpu.emplace_back(cpuTime);
+    if (gpuTimed)
+      gpu.emplace_back(gpuTime);
+  }
+
+  FrameTimes times;
+  times.frames = cpu.size();
+  times.cpu = percentiles(cpu);
+  if (!gpu.empty())
+    times.gpu = percentiles(gpu);
+  return times;
+}
+
+void FrameProfiler::beginFrame() {
+  if (!enabled)
+    return;
+
+  const auto now = clock::now();
+
+  current = Frame{};
+  current.number = nextFrame++;
+  current.cpuMilliseconds = betweenFrames;
+  betweenFrames = {};
+  inFrame = true;
+
+  // Whatever happened between frames, Qt's event loop, other widgets, etc.
+  if (lastFrameEnd) {
+    const auto qtIndex = static_cast<std::size_t>(Stage::Qt);
+    current.cpuMilliseconds[qtIndex] += std::chrono::duration<double, std::milli>(now - lastFrameEnd.value()).count();
+  }
+
+  if (initialized) {
+    auto &frameQueries = queriesFor(current.number);
+    collect(frameQueries);
+    frameQueries.frame = current.number;
+  }
+}
+
+void FrameProfiler::endFrame() {
+  if (!enabled)
+    return;
+
+  current.drawCalls = stats::frameCounters.drawCalls;
+  current.bufferUploads = stats::frameCounters.bufferUploads;
+  current.stateChanges = stats::frameCounters.stateChanges;
+  current.elidedStateChanges = stats::frameCounters.elidedStateChanges;
+  current.eventsApplied = eventsApplied;
+  stats::frameCounters = {};
+  eventsApplied = 0u;
+
+  history.emplace_back(current);
+  if (history.size() > historySize)
+    history.pop_front();
+
+  lastFrameEnd = clock::now();
+  inFrame = false;
+}
+
+void FrameProfiler::begin(FrameProfiler::Stage stage) {
+  // Stages are traced whether or not the profiler is on
+  if (!enabled && !parser::trace::enabled())
+    return;
+
+  const auto index = static_cast<std::size_t>(stage);
+  if (enabled && initialized && inFrame && hasGpuWork(stage)) {
+    auto &frameQueries = queriesFor(current.number);
+    glBeginQuery(GL_TIME_ELAPSED, frameQueries.queries[index]);
+    frameQueries.issued[index] = true;
+  }
+
+  stageStart[index] = clock::now();
+}
+
+void FrameProfiler::end(FrameProfiler::Stage stage) {
+  if (!enabled && !parser::trace::enabled())
+    return;
+
+  const auto index = static_cast<std::size_t>(stage);
+  const auto now = clock::now();
+  parser::trace::complete(traceNames[index], "frame", stageStart[index], now);
+  if (!enabled)
+    return;
+
+  const auto elapsed = std::chrono::duration<double, std::milli>(now - stageStart[index]).count();
+  if (!inFrame) {
+    betweenFrames[index] += elapsed;
+    return;
+  }
+
+  current.cpuMilliseconds[index] += elapsed;
+  if (initialized && hasGpuWork(stage))
+    glEndQuery(GL_TIME_ELAPSED);
+}
+
+void FrameProfiler::countEvents(std::size_t count) {
+  if (enabled)
+    eventsApplied += count;
+}
+
+QStringList FrameProfiler::summary() const {
+  QStringList lines;
+  if (history.empty())
+    return lines;
+
+  const auto count = std::min(summaryFrames, history.size());
+  const auto first = history.end() - static_cast<std::ptrdiff_t>(count);
+
+  double frameTime = 0.0;
+  for (auto i = 0u; i < stageCount; i++) {
+    double cpu = 0.0;
+    double gpu = 0.0;
+    std::size_t gpuFrames = 0u;
+
+    for (auto frame = first; frame != history.end(); frame++) {
+      cpu += frame->cpuMilliseconds[i];
+      if (frame->gpuMilliseconds[i]) {
+        gpu += frame->gpuMilliseconds[i].value();
+        gpuFrames++;
+      }
+    }
+
+    cpu /= static_cast<double>(count);
+    frameTime += cpu;
+
+    auto line = QString{"%1 CPU: %2 ms"}.arg(stageName(static_cast<Stage>(i)), -12).arg(cpu, 0, 'f', 3);
+    if (gpuFrames > 0u)
+      line += QString{" GPU: %1 ms"}.arg(gpu / static_cast<double>(gpuFrames), 0, 'f', 3);
+    lines << line;
+  }
+
+  std::size_t drawCalls = 0u;
+  std::size_t bufferUploads = 0u;
+  std::size_t stateChanges = 0u;
+  std::size_t elidedStateChanges = 0u;
+  std::size_t events = 0u;
+  for (auto frame = first; frame != history.end(); frame++) {
+    drawCalls += frame->drawCalls;
+    bufferUploads += frame->bufferUploads;
+    stateChanges += frame->stateChanges;
+    elidedStateChanges += frame->elidedStateChanges;
+    events += frame->eventsApplied;
+  }
+
+  const auto frames = static_cast<double>(count);
+  lines << QString{"Frame: %1 ms (%2 FPS)"}.arg(frameTime, 0, 'f', 3).arg(frameTime > 0.0 ? 1000.0 / frameTime : 0.0,
+                                                                          0, 'f', 1);
+  lines << QString{"Draw calls: %1 Uploads: %2 Events: %3"}
+               .arg(static_cast<double>(drawCalls) / frames, 0, 'f', 1)
+               .arg(static_cast<double>(bufferUploads) / frames, 0, 'f', 1)
+               .arg(static_cast<double>(events) / frames, 0, 'f', 1);
+  lines << QString{"State changes: %1 Elided: %2"}
+               .arg(static_cast<double>(stateChanges) / frames, 0, 'f', 1)
+               .arg(static_cast<double>(elidedStateChanges) / frames, 0, 'f', 1);
+
+  return lines;
+}
+
+bool FrameProfiler::exportCsv(const QString &path) const {
+  QFile file{path};
+  if (!file.open(QFile::WriteOnly | QFile::Truncate | QFile::Text))
+    return false;
+
+  QTextStream out{&file};
+  out << "frame";
+  for (auto i = 0u; i < stageCount; i++) {
+    const auto name = stageName(static_cast<Stage>(i)).toLower();
+    out << ',' << name << "_cpu_ms," << name << "_gpu_ms";
+  }
+  out << ",draw_calls,buffer_uploads,state_changes,elided_state_changes,events_applied\n";
+
+  for (const auto &frame : history) {
+    out << frame.number;
+    for (auto i = 0u; i < stageCount; i++) {
+      out << ',' << frame.cpuMilliseconds[i] << ',';
+      // Leave missing GPU timings empty
+      if (frame.gpuMilliseconds[i])
+        out << frame.gpuMilliseconds[i].value();
+    }
+    out << ',' << frame.drawCalls << ',' << frame.bufferUploads << ',' << frame.stateChanges << ','
+        << frame.elidedStateChanges << ',' << frame.eventsApplied << '\n';
+  }
+
+  out.flush();
+  return file.error() == QFile::NoError;
+}
+
+QString FrameProfiler::stageName(FrameProfiler::Stage stage) {
+  switch (stage) {
+  case Stage::Events:
+    return "Events";
+  case Stage::Picking:
+    return "Picking";
+  case Stage::Opaque:
+    return "Opaque";
+  case Stage::Transparent:
+    return "Transparent";
+  case Stage::Labels:
+    return "Labels";
+  case Stage::Qt:
+    return "Qt";
+  }
+
+  return "Unknown";
+}
+
+} // namespace netsimulyzer
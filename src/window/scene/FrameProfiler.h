@@ -0,0 +1,242 @@
+/*
+ * NIST-developed software is provided by NIST as a public service. You may use,
+ * copy and distribute copies of the software in any medium, provided that you
+ * keep intact this entire notice. You may improve,modify and create derivative
+ * works of the software or any portion of the software, and you may copy and
+ * distribute such modifications or works. Modified works should carry a notice
+ * stating that you changed the software and should note the date and nature of
+ * any such change. Please explicitly acknowledge the National Institute of
+ * Standards and Technology as the source of the software.
+ *
+ * NIST-developed software is expressly provided "AS IS." NIST MAKES NO
+ * WARRANTY OF ANY KIND, EXPRESS, IMPLIED, IN FACT OR ARISING BY OPERATION OF
+ * LAW, INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTY OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, NON-INFRINGEMENT
+ * AND DATA ACCURACY. NIST NEITHER REPRESENTS NOR WARRANTS THAT THE
+ * OPERATION OF THE SOFTWARE WILL BE UNINTERRUPTED OR ERROR-FREE, OR THAT
+ * ANY DEFECTS WILL BE CORRECTED. NIST DOES NOT WARRANT OR MAKE ANY
+ * REPRESENTATIONS REGARDING THE USE OF THE SOFTWARE OR THE RESULTS THEREOF,
+ * INCLUDING BUT NOT LIMITED TO THE CORRECTNESS, ACCURACY, RELIABILITY,
+ * OR USEFULNESS OF THE SOFTWARE.
+ *
+ * You are solely responsible for determining the appropriateness of using and
+ * distributing the software and you assume all risks associated with its use,
+ * including but not limited to the risks and costs of program errors,
+ * compliance with applicable laws, damage to or loss of data, programs or
+ * equipment, and the unavailability or interruption of operation. This
+ * software is not intended to be used in any situation where a failure could
+ * cause risk of injury or damage to property. The software developed by NIST
+ * employees is not subject to copyright protection within the United States.
+ *
+ * Author: Evan Black <evan.black@nist.gov>
+ */
+
+
+#pragma once
+
+#include <QOpenGLFunctions_3_3_Core>
+#include <QString>
+#include <QStringList>
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <optional>
+#include <vector>
+
+namespace netsimulyzer {
+
+/**
+ * CPU & GPU timings for each stage of a frame,
+ * along with counters for the work done in that frame.
+ *
+ * GPU timings use `GL_TIME_ELAPSED` queries, which are read
+ * a few frames later, so the profiler never waits on the GPU
+ */
+class FrameProfiler : protected QOpenGLFunctions_3_3_Core {
+public:
+  /**
+   * Each stage should be timed at most once per frame,
+   * and stages may not overlap.
+   * Stages timed between frames (e.g. picking on a click),
+   * are counted with the next frame, and are not timed on the GPU
+   */
+  enum class Stage : int { Events, Picking, Opaque, Transparent, Labels, Qt };
+  static constexpr std::size_t stageCount = 6u;
+
+  struct Frame {
+    std::uint64_t number{0u};
+    std::array<double, stageCount> cpuMilliseconds{};
+
+    /**
+     * Unset until the query results are read,
+     * and for stages with no GL work
+     */
+    std::array<std::optional<double>, stageCount> gpuMilliseconds{};
+
+    std::size_t drawCalls{0u};
+    std::size_t bufferUploads{0u};
+    std::size_t stateChanges{0u};
+    std::size_t elidedStateChanges{0u};
+    std::size_t eventsApplied{0u};
+  };
+
+  struct Percentiles {
+    double p50{0.0};
+    double p95{0.0};
+    double p99{0.0};
+  };
+
+  /**
+   * The spread of frame times over a run of frames, see `frameTimes()`
+   */
+  struct FrameTimes {
+    std::size_t frames{0u};
+    Percentiles cpu;
+
+    /**
+     * Unset if no GPU timings were read for the frames
+     */
+    std::optional<Percentiles> gpu;
+  };
+
+private:
+  using clock = std::chrono::steady_clock;
+
+  /**
+   * The number of frames kept for the overlay & export.
+   * Roughly 10 seconds at 60 frames per second
+   */
+  static constexpr std::size_t historySize = 600u;
+
+  /**
+   * Frames averaged for the overlay
+   */
+  static constexpr std::size_t summaryFrames = 60u;
+
+  /**
+   * The number of frames of GPU queries in flight
+   */
+  static constexpr std::size_t queryLatency = 3u;
+
+  struct FrameQueries {
+    std::uint64_t frame{0u};
+    std::array<unsigned int, stageCount> queries{};
+    std::array<bool, stageCount> issued{};
+  };
+
+  bool enabled{false};
+  bool initialized{false};
+  bool inFrame{false};
+
+  std::deque<Frame> history;
+  Frame current;
+  std::uint64_t nextFrame{0u};
+  std::size_t eventsApplied{0u};
+
+  /**
+   * CPU time of the stages timed since the last frame ended
+   */
+  std::array<double, stageCount> betweenFrames{};
+
+  std::array<clock::time_point, stageCount> stageStart;
+  std::optional<clock::time_point> lastFrameEnd;
+  std::array<FrameQueries, queryLatency> queries;
+
+  [[nodiscard]] static bool hasGpuWork(Stage stage);
+
+  /**
+   * @return
+   * The nearest rank percentiles of `values`, which are sorted in place
+   */
+  [[nodiscard]] static Percentiles percentiles(std::vector<double> &values);
+  [[nodiscard]] FrameQueries &queriesFor(std::uint64_t frame);
+
+  /**
+   * Read the results for the frame which last used `frameQueries`
+   */
+  void collect(FrameQueries &frameQueries);
+
+public:
+  /**
+   * Create the GPU queries. Requires a current context
+   */
+  void init();
+
+  [[nodiscard]] bool isEnabled() const;
+
+  /**
+   * The most frames `frameTimes()` may cover.
+   * Only `historySize` frames are kept, and the GPU timings of the latest frames are not read yet
+   */
+  static constexpr std::size_t maxTimedFrames = historySize - queryLatency;
+
+  /**
+   * Frames which must begin after a frame, before its GPU timings are read
+   */
+  static constexpr std::size_t timingLatency = queryLatency;
+
+  /**
+   * @return
+   * The number the next frame will be given by `beginFrame()`
+   */
+  [[nodiscard]] std::uint64_t getNextFrame() const;
+
+  /**
+   * Find the spread of frame times over a run of frames still in the history.
+   * Time spent in Qt between frames is not counted, so only the work of drawing the frame is compared
+   *
+   * @param first
+   * The number of the first frame in the run
+   *
+   * @param count
+   * The frames in the run. Frames no longer, or not yet, in the history are skipped
+   *
+   * @return
+   * The percentiles of the CPU & GPU time of the frames
+   */
+  [[nodiscard]] FrameTimes frameTimes(std::uint64_t first, std::size_t count) const;
+
+  /**
+   * Turn profiling on/off. Enabling clears any previous history
+   */
+  void setEnabled(bool enable);
+
+  void beginFrame();
+  void endFrame();
+
+  void begin(Stage stage);
+  void end(Stage stage);
+
+  /**
+   * Count events applied, from inside or outside of a frame.
+   * Counted with the next frame to end
+   *
+   * @param count
+   * The number of events applied
+   */
+  void countEvents(std::size_t count);
+
+  /**
+   * @return
+   * A line per stage, with the average timings of the latest frames,
+   * followed by the counters
+   */
+  [[nodiscard]] QStringList summary() const;
+
+  /**
+   * Write every frame in the history to `path` as CSV
+   *
+   * @param path
+   * The file to write to, replaced if it exists
+   *
+   * @return
+   * True if the file was written, false otherwise
+   */
+  [[nodiscard]] bool exportCsv(const QString &path) const;
+
+  [[nodiscard]] static QString stageName(Stage stage);
+};
+
+} // namespace netsimulyzer
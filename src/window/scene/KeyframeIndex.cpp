@@ -0,0 +1,196 @@
+/*
+ * NIST-developed software is provided by NIST as a public service. You may use,
+ * copy and distribute copies of the software in any medium, provided that you
+ * keep intact this entire notice. You may improve,modify and create derivative
+ * works of the software or any portion of the software, and you may copy and
+ * distribute such modifications or works. Modified works should carry a notice
+ * stating that you changed the software and should note the date and nature of
+ * any such change. Please explicitly acknowledge the National Institute of
+ * Standards and Technology as the source of the software.
+ *
+ * NIST-developed software is expressly provided "AS IS." NIST MAKES NO
+ * WARRANTY OF ANY KIND, EXPRESS, IMPLIED, IN FACT OR ARISING BY OPERATION OF
+ * LAW, INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTY OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, NON-INFRINGEMENT
+ * AND DATA ACCURACY. NIST NEITHER REPRESENTS NOR WARRANTS THAT THE
+ * OPERATION OF THE SOFTWARE WILL BE UNINTERRUPTED OR ERROR-FREE, OR THAT
+ * ANY DEFECTS WILL BE CORRECTED. NIST DOES NOT WARRANT OR MAKE ANY
+ * REPRESENTATIONS REGARDING THE USE OF THE SOFTWARE OR THE RESULTS THEREOF,
+ * INCLUDING BUT NOT LIMITED TO THE CORRECTNESS, ACCURACY, RELIABILITY,
+ * OR USEFULNESS OF THE SOFTWARE.
+ *
+ * You are solely responsible for determining the appropriateness of using and
+ * distributing the software and you assume all risks associated with its use,
+ * including but not limited to the risks and costs of program errors,
+ * compliance with applicable laws, damage to or loss of data, programs or
+ * equipment, and the unavailability or interruption of operation. This
+ * software is not intended to be used in any situation where a failure could
+ * cause risk of injury or damage to property. The software developed by NIST
+ * employees is not subject to copyright protection within the United States.
+ *
+ * Author: Evan Black <evan.black@nist.gov>
+ */
+
+
+#include "KeyframeIndex.h"
+#include "src/conversion.h"
+#include <algorithm>
+#include <iterator>
+#include <type_traits>
+#include <variant>
+
+namespace netsimulyzer {
+
+void KeyframeIndex::reset(const std::vector<parser::Node> &nodes, const std::vector<parser::Decoration> &decorations) {
+  clear();
+
+  current.nodes.reserve(nodes.size());
+  for (const auto &node : nodes) {
+    Node::State state;
+    state.position = node.position;
+    // Matches the rotation set by the `Node` constructor
+    state.rotation = {static_cast<float>(node.orientation[0]), static_cast<float>(node.orientation[2]),
+                      static_cast<float>(node.orientation[1])};
+    state.baseColor = node.baseColor;
+    state.highlightColor = node.highlightColor;
+
+    // Only the first Node with an ID is added to the scene
+    if (nodeIndices.try_emplace(node.id, current.nodes.size()).second)
+      current.nodes.emplace_back(node.id, state);
+  }
+
+  current.decorations.reserve(decorations.size());
+  for (const auto &decoration : decorations) {
+    Decoration::State state;
+    state.position = decoration.position;
+    state.rotation = {static_cast<float>(decoration.orientation[0]), static_cast<float>(decoration.orientation[2]),
+                      static_cast<float>(-decoration.orientation[1])};
+
+    if (decorationIndices.try_emplace(decoration.id, current.decorations.size()).second)
+      current.decorations.emplace_back(decoration.id, state);
+  }
+
+  // Roughly, one Node/Decoration State per four events
+  interval = std::max(minimumInterval, (nodes.size() + decorations.size()) * 4u);
+  keyframes.emplace_back(current);
+}
+
+void KeyframeIndex::clear() {
+  keyframes.clear();
+  current = Keyframe{};
+  nodeIndices.clear();
+  decorationIndices.clear();
+  interval = minimumInterval;
+}
+
+void KeyframeIndex::apply(Keyframe &keyframe, const parser::SceneEvent &event) const {
+  std::visit(
+      [this, &keyframe](const auto &e) {
+        using T = std::decay_t<decltype(e)>;
+
+        if constexpr (std::is_same_v<T, parser::DecorationMoveEvent> ||
+                      std::is_same_v<T, parser::DecorationOrientationChangeEvent>) {
+          const auto index = decorationIndices.find(e.decorationId);
+          if (index == decorationIndices.end())
+            return;
+          auto &state = keyframe.decorations[index->second].second;
+
+          if constexpr (std::is_same_v<T, parser::DecorationMoveEvent>)
+            state.position = e.targetPosition;
+          else
+            state.rotation = {static_cast<float>(e.targetOrientation[0]), static_cast<float>(e.targetOrientation[2]),
+                              static_cast<float>(-e.targetOrientation[1])};
+        } else {
+          const auto index = nodeIndices.find(e.nodeId);
+          if (index == nodeIndices.end())
+            return;
+          auto &state = keyframe.nodes[index->second].second;
+
+          // Matches the changes made by each `Node::handle()`
+          if constexpr (std::is_same_v<T, parser::MoveEvent>) {
+            state.position = e.targetPosition;
+          } else if constexpr (std::is_same_v<T, parser::NodeOrientationChangeEvent>) {
+            state.rotation = {static_cast<float>(e.targetOrientation[0]), static_cast<float>(e.targetOrientation[2]),
+                              static_cast<float>(-e.targetOrientation[1])};
+          } else if constexpr (std::is_same_v<T, parser::NodeColorChangeEvent>) {
+            if (e.type == parser::NodeColorChangeEvent::ColorType::Base)
+              state.baseColor = e.targetColor;
+            else
+              state.highlightColor = e.targetColor;
+          } else if constexpr (std::is_same_v<T, parser::TransmitEvent>) {
+            state.transmitInfo.isTransmitting = true;
+            state.transmitInfo.startTime = e.time;
+            state.transmitInfo.targetSize = e.targetSize;
+            state.transmitInfo.duration = e.duration;
+            state.transmitInfo.color = toRenderColor(e.color);
+          } else if constexpr (std::is_same_v<T, parser::TransmitEndEvent>) {
+            state.transmitInfo.isTransmitting = false;
+          }
+        }
+      },
+      event);
+
+  keyframe.eventCount++;
+}
+
+void KeyframeIndex::add(const parser::SceneEvent &event) {
+  // Not tracking a scene yet
+  if (keyframes.empty())
+    return;
+
+  apply(current, event);
+  if (current.eventCount % interval == 0u)
+    keyframes.emplace_back(current);
+}
+
+const KeyframeIndex::Keyframe &KeyframeIndex::before(std::size_t eventCount) const {
+  auto after = std::upper_bound(keyframes.begin(), keyframes.end(), eventCount,
+                                [](std::size_t count, const Keyframe &keyframe) {
+                                  return count < keyframe.eventCount;
+                                });
+
+  // The first keyframe has no events applied, so `after` is never the first
+  return *std::prev(after);
+}
+
+KeyframeIndex::Keyframe KeyframeIndex::at(std::size_t eventCount, const PagedEvents &events) const {
+  auto keyframe = before(eventCount);
+  while (keyframe.eventCount < eventCount)
+    apply(keyframe, events[keyframe.eventCount]);
+
+  return keyframe;
+}
+
+bool KeyframeIndex::fits(const Keyframe &keyframe) const {
+  if (keyframe.eventCount > current.eventCount || keyframe.nodes.size() != current.nodes.size() ||
+      keyframe.decorations.size() != current.decorations.size())
+    return false;
+
+  const auto sameId = [](const auto &left, const auto &right) {
+    return left.first == right.first;
+  };
+  return std::equal(keyframe.nodes.begin(), keyframe.nodes.end(), current.nodes.begin(), sameId) &&
+         std::equal(keyframe.decorations.begin(), keyframe.decorations.end(), current.decorations.begin(), sameId);
+}
+
+std::size_t KeyframeIndex::getInterval() const {
+  return interval;
+}
+
+bool KeyframeIndex::empty() const {
+  return keyframes.empty();
+}
+
+std::size_t KeyframeIndex::memoryUsage() const {
+  const auto keyframeBytes = [](const Keyframe &keyframe) {
+    return keyframe.nodes.capacity() * sizeof(decltype(keyframe.nodes)::value_type) +
+           keyframe.decorations.capacity() * sizeof(decltype(keyframe.decorations)::value_type);
+  };
+
+  auto bytes = keyframes.capacity() * sizeof(Keyframe) + keyframeBytes(current);
+  for (const auto &keyframe : keyframes)
+    bytes += keyframeBytes(keyframe);
+  return bytes;
+}
+
+} // namespace netsimulyzer
@@ -0,0 +1,207 @@
+/*
+ * NIST-developed software is provided by NIST as a public service. You may use,
+ * copy and distribute copies of the software in any medium, provided that you
+ * keep intact this entire notice. You may improve,modify and create derivative
+ * works of the software or any portion of the software, and you may copy and
+ * distribute such modifications or works. Modified works should carry a notice
+ * stating that you changed the software and should note the date and nature of
+ * any such change. Please explicitly acknowledge the National Institute of
+ * Standards and Technology as the source of the software.
+ *
+ * NIST-developed software is expressly provided "AS IS." NIST MAKES NO
+ * WARRANTY OF ANY KIND, EXPRESS, IMPLIED, IN FACT OR ARISING BY OPERATION OF
+ * LAW, INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTY OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, NON-INFRINGEMENT
+ * AND DATA ACCURACY. NIST NEITHER REPRESENTS NOR WARRANTS THAT THE
+ * OPERATION OF THE SOFTWARE WILL BE UNINTERRUPTED OR ERROR-FREE, OR THAT
+ * ANY DEFECTS WILL BE CORRECTED. NIST DOES NOT WARRANT OR MAKE ANY
+ * REPRESENTATIONS REGARDING THE USE OF THE SOFTWARE OR THE RESULTS THEREOF,
+ * INCLUDING BUT NOT LIMITED TO THE CORRECTNESS, ACCURACY, RELIABILITY,
+ * OR USEFULNESS OF THE SOFTWARE.
+ *
+ * You are solely responsible for determining the appropriateness of using and
+ * distributing the software and you assume all risks associated with its use,
+ * including but not limited to the risks and costs of program errors,
+ * compliance with applicable laws, damage to or loss of data, programs or
+ * equipment, and the unavailability or interruption of operation. This
+ * software is not intended to be used in any situation where a failure could
+ * cause risk of injury or damage to property. The software developed by NIST
+ * employees is not subject to copyright protection within the United States.
+ *
+ * Author: Evan Black <evan.black@nist.gov>
+ */
+
+
+#pragma once
+
+#include "PagedEvents.h"
+#include "src/group/decoration/Decoration.h"
+#include "src/group/node/Node.h"
+#include <cstddef>
+#include <model.h>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace netsimulyzer {
+
+/**
+ * Periodic snapshots of every Node & Decoration,
+ * built as the scene events are added.
+ *
+ * Seeking restores the latest keyframe before the target,
+ * then only applies the events after that keyframe,
+ * rather than every event between the current time & the target
+ */
+class KeyframeIndex {
+public:
+  struct Keyframe {
+    /**
+     * The number of events applied to reach this keyframe.
+     * Also the index of the first event not applied
+     */
+    std::size_t eventCount{0u};
+
+    /**
+     * The state of each Node & Decoration.
+     * Built in the same order as `parser::EntityEventStreams::reset()`,
+     * so the index of each is also its slot
+     */
+    std::vector<std::pair<unsigned int, Node::State>> nodes;
+    std::vector<std::pair<unsigned int, Decoration::State>> decorations;
+  };
+
+private:
+  /**
+   * The fewest events between keyframes
+   */
+  static constexpr std::size_t minimumInterval = 10'000u;
+
+  /**
+   * The number of events between keyframes.
+   * Scaled with the number of Nodes & Decorations,
+   * so the keyframes stay small compared to the events
+   */
+  std::size_t interval{minimumInterval};
+
+  /**
+   * Keyframes, ordered by `eventCount`.
+   * The first is the state before any events
+   */
+  std::vector<Keyframe> keyframes;
+
+  /**
+   * The state after every event added so far
+   */
+  Keyframe current;
+
+  /**
+   * Index of each Node by ID in `current.nodes`
+   */
+  std::unordered_map<unsigned int, std::size_t> nodeIndices;
+
+  /**
+   * Index of each Decoration by ID in `current.decorations`
+   */
+  std::unordered_map<unsigned int, std::size_t> decorationIndices;
+
+  /**
+   * Apply one scene event to `keyframe`, the same as `add()` does to `current`
+   *
+   * @param keyframe
+   * The keyframe to change, with `eventCount` as the index of `event`
+   *
+   * @param event
+   * The next event after `keyframe`
+   */
+  void apply(Keyframe &keyframe, const parser::SceneEvent &event) const;
+
+public:
+  /**
+   * Clear every keyframe, and start over with the initial state
+   * of `nodes` & `decorations`
+   *
+   * @param nodes
+   * The Nodes in the scene
+   *
+   * @param decorations
+   * The Decorations in the scene
+   */
+  void reset(const std::vector<parser::Node> &nodes, const std::vector<parser::Decoration> &decorations);
+
+  /**
+   * Remove every keyframe, including the initial state
+   */
+  void clear();
+
+  /**
+   * Apply the next scene event. Should be called with every event, in order.
+   * Events for unknown Nodes/Decorations are counted, but otherwise ignored.
+   * Ignored entirely until `reset()` is called
+   *
+   * @param event
+   * The event to apply
+   */
+  void add(const parser::SceneEvent &event);
+
+  /**
+   * Find the latest keyframe with `eventCount` or fewer events applied.
+   * `empty()` should be checked first
+   *
+   * @param eventCount
+   * The number of events applied at the target
+   *
+   * @return
+   * The keyframe closest to, but not past `eventCount`
+   */
+  [[nodiscard]] const Keyframe &before(std::size_t eventCount) const;
+
+  /**
+   * Build the state after exactly `eventCount` events,
+   * from the keyframe before it. `empty()` should be checked first
+   *
+   * @param eventCount
+   * The number of events applied at the target.
+   * No more than the number of events added
+   *
+   * @param events
+   * Every event given to `add()`, in the same order
+   *
+   * @return
+   * A keyframe with `eventCount` events applied
+   */
+  [[nodiscard]] Keyframe at(std::size_t eventCount, const PagedEvents &events) const;
+
+  /**
+   * Check a keyframe built elsewhere, such as a saved session,
+   * still describes the scene given to `reset()`
+   *
+   * @param keyframe
+   * The keyframe to check
+   *
+   * @return
+   * True if `keyframe` has the same Nodes & Decorations, in the same order,
+   * and no more events applied than have been added
+   */
+  [[nodiscard]] bool fits(const Keyframe &keyframe) const;
+
+  /**
+   * @return
+   * The number of events between keyframes
+   */
+  [[nodiscard]] std::size_t getInterval() const;
+
+  /**
+   * @return
+   * True if there are no keyframes, not even the initial state
+   */
+  [[nodiscard]] bool empty() const;
+
+  /**
+   * @return
+   * The bytes held by every keyframe & the current state
+   */
+  [[nodiscard]] std::size_t memoryUsage() const;
+};
+
+} // namespace netsimulyzer
@@ -0,0 +1,246 @@
+/*
+ * NIST-developed software is provided by NIST as a public service. You may use,
+ * copy and distribute copies of the software in any medium, provided that you
+ * keep intact this entire notice. You may improve,modify and create derivative
+ * works of the software or any portion of the software, and you may copy and
+ * distribute such modifications or works. Modified works should carry a notice
+ * stating that you changed the software and should note the date and nature of
+ * any such change. Please explicitly acknowledge the National Institute of
+ * Standards and Technology as the source of the software.
+ *
+ * NIST-developed software is expressly provided "AS IS." NIST MAKES NO
+ * WARRANTY OF ANY KIND, EXPRESS, IMPLIED, IN FACT OR ARISING BY OPERATION OF
+ * LAW, INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTY OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, NON-INFRINGEMENT
+ * AND DATA ACCURACY. NIST NEITHER REPRESENTS NOR WARRANTS THAT THE
+ * OPERATION OF THE SOFTWARE WILL BE UNINTERRUPTED OR ERROR-FREE, OR THAT
+ * ANY DEFECTS WILL BE CORRECTED. NIST DOES NOT WARRANT OR MAKE ANY
+ * REPRESENTATIONS REGARDING THE USE OF THE SOFTWARE OR THE RESULTS THEREOF,
+ * INCLUDING BUT NOT LIMITED TO THE CORRECTNESS, ACCURACY, RELIABILITY,
+ * OR USEFULNESS OF THE SOFTWARE.
+ *
+ * You are solely responsible for determining the appropriateness of using and
+ * distributing the software and you assume all risks associated with its use,
+ * including but not limited to the risks and costs of program errors,
+ * compliance with applicable laws, damage to or loss of data, programs or
+ * equipment, and the unavailability or interruption of operation. This
+ * software is not intended to be used in any situation where a failure could
+ * cause risk of injury or damage to property. The software developed by NIST
+ * employees is not subject to copyright protection within the United States.
+ *
+ * Author: Evan Black <evan.black@nist.gov>
+ */
+
+#include "PagedEvents.h"
+#include <QDir>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <iterator>
+#include <optional>
+#include <variant>
+
+namespace netsimulyzer {
+
+std::vector<parser::SceneEvent> PagedEvents::read(qint64 offset) const {
+  std::vector<parser::SceneEvent> events(pageSize);
+
+  std::lock_guard lock{fileMutex};
+  if (!file->seek(offset) ||
+      file->read(reinterpret_cast<char *>(events.data()), pageBytes) != static_cast<qint64>(pageBytes)) {
+    std::cerr << "Failed reading spilled events: " << file->errorString().toStdString() << '\n';
+    std::abort();
+  }
+
+  return events;
+}
+
+void PagedEvents::write(Page &page) {
+  // Pages never change once full, so each is only written once
+  if (page.offset < 0) {
+    std::lock_guard lock{fileMutex};
+    if (!file) {
+      file = std::make_unique<QTemporaryFile>(QDir::tempPath() + "/netsimulyzer-events-XXXXXX");
+      if (!file->open()) {
+        std::cerr << "Failed opening a file to spill events to: " << file->errorString().toStdString() << '\n';
+        file.reset();
+        return;
+      }
+    }
+
+    if (!file->seek(spilledBytes) ||
+        file->write(reinterpret_cast<const char *>(page.events.data()), pageBytes) != static_cast<qint64>(pageBytes)) {
+      std::cerr << "Failed spilling events: " << file->errorString().toStdString() << '\n';
+      return;
+    }
+
+    page.offset = spilledBytes;
+    spilledBytes += static_cast<qint64>(pageBytes);
+  }
+
+  page.events = std::vector<parser::SceneEvent>{};
+  page.resident = false;
+  residentPages--;
+}
+
+PagedEvents::Page &PagedEvents::residentPage(std::size_t index) const {
+  auto &page = pages[index];
+  if (page.resident)
+    return page;
+
+  // Wait for a read started by `trim()`, rather than reading it twice
+  if (page.loading.valid())
+    page.events = page.loading.get();
+  else
+    page.events = read(page.offset);
+
+  page.resident = true;
+  residentPages++;
+  return page;
+}
+
+void PagedEvents::attach(std::shared_ptr<const parser::SharedEvents> events) {
+  clear();
+  count = events->size();
+  shared = std::move(events);
+}
+
+bool PagedEvents::isShared() const {
+  return static_cast<bool>(shared);
+}
+
+const parser::SceneEvent &PagedEvents::operator[](std::size_t index) const {
+  if (shared)
+    return shared->data()[index];
+
+  return residentPage(index / pageSize).events[index % pageSize];
+}
+
+std::size_t PagedEvents::size() const {
+  return count;
+}
+
+bool PagedEvents::empty() const {
+  return count == 0u;
+}
+
+bool PagedEvents::resident() const {
+  return residentPages == pages.size();
+}
+
+std::size_t PagedEvents::upperBound(parser::nanoseconds time) const {
+  const auto eventTime = [](parser::nanoseconds value, const parser::SceneEvent &event) {
+    return value < std::visit(
+                       [](const auto &e) {
+                         return e.time;
+                       },
+                       event);
+  };
+  if (shared) {
+    const auto found = std::upper_bound(shared->data(), shared->data() + count, time, eventTime);
+    return static_cast<std::size_t>(std::distance(shared->data(), found));
+  }
+
+  // The last page starting at, or before, `time`, the rest only have later events
+  const auto after = std::upper_bound(pages.begin(), pages.end(), time, [](parser::nanoseconds value, const Page &page) {
+    return value < page.firstTime;
+  });
+  if (after == pages.begin())
+    return 0u;
+
+  const auto index = static_cast<std::size_t>(std::distance(pages.begin(), after)) - 1u;
+  const auto &events = residentPage(index).events;
+  const auto found = std::upper_bound(events.begin(), events.end(), time, eventTime);
+
+  return index * pageSize + static_cast<std::size_t>(std::distance(events.begin(), found));
+}
+
+void PagedEvents::setBudget(std::size_t bytes) {
+  budget = bytes;
+}
+
+void PagedEvents::trim(std::size_t position, bool backwards) {
+  // Shared events are never held in pages
+  if (budget == 0u || pages.empty())
+    return;
+
+  const auto current = std::min(position / pageSize, pages.size() - 1u);
+
+  // Count the pages read back since the last call
+  for (std::size_t i = 0u; i < pages.size(); i++) {
+    auto &page = pages[i];
+    if (page.loading.valid() && page.loading.wait_for(std::chrono::seconds{0}) == std::future_status::ready)
+      residentPage(i);
+  }
+
+  // The last page is still being filled, & the pages around the playhead are in use
+  const auto hot = [this, current](std::size_t index) {
+    return index + 1u == pages.size() || (index + 1u >= current && index <= current + 1u);
+  };
+
+  // Furthest first, since those are the least likely to be needed soon
+  while (residentPages * pageBytes > budget) {
+    std::optional<std::size_t> furthest;
+    std::size_t furthestDistance = 0u;
+    for (std::size_t i = 0u; i < pages.size(); i++) {
+      if (!pages[i].resident || hot(i))
+        continue;
+
+      const auto distance = i > current ? i - current : current - i;
+      if (distance > furthestDistance) {
+        furthest = i;
+        furthestDistance = distance;
+      }
+    }
+
+    if (!furthest)
+      break;
+
+    auto &page = pages[furthest.value()];
+    write(page);
+    // Could not be written, keep everything else resident too
+    if (page.resident)
+      break;
+  }
+
+  // Read ahead, in the direction of playback
+  const auto next = backwards ? (current > 0u ? current - 1u : current) : std::min(current + 1u, pages.size() - 1u);
+  for (const auto index : {current, next}) {
+    auto &page = pages[index];
+    if (page.resident || page.loading.valid())
+      continue;
+
+    page.loading = std::async(std::launch::async, [this, offset = page.offset]() {
+      return read(offset);
+    });
+  }
+}
+
+void PagedEvents::clear() {
+  // Waits for any reads first, since they use the file
+  pages.clear();
+  residentPages = 0u;
+  count = 0u;
+
+  file.reset();
+  spilledBytes = 0;
+  shared.reset();
+}
+
+std::size_t PagedEvents::memoryUsage() const {
+  std::size_t bytes = 0u;
+  for (const auto &page : pages)
+    bytes += page.events.capacity() * sizeof(parser::SceneEvent);
+  return bytes;
+}
+
+std::size_t PagedEvents::getSpilledBytes() const {
+  return static_cast<std::size_t>(spilledBytes);
+}
+
+std::size_t PagedEvents::getSharedBytes() const {
+  return shared ? shared->bytes() : 0u;
+}
+
+} // namespace netsimulyzer
@@ -0,0 +1,263 @@
+/*
+ * NIST-developed software is provided by NIST as a public service. You may use,
+ * copy and distribute copies of the software in any medium, provided that you
+ * keep intact this entire notice. You may improve,modify and create derivative
+ * works of the software or any portion of the software, and you may copy and
+ * distribute such modifications or works. Modified works should carry a notice
+ * stating that you changed the software and should note the date and nature of
+ * any such change. Please explicitly acknowledge the National Institute of
+ * Standards and Technology as the source of the software.
+ *
+ * NIST-developed software is expressly provided "AS IS." NIST MAKES NO
+ * WARRANTY OF ANY KIND, EXPRESS, IMPLIED, IN FACT OR ARISING BY OPERATION OF
+ * LAW, INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTY OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, NON-INFRINGEMENT
+ * AND DATA ACCURACY. NIST NEITHER REPRESENTS NOR WARRANTS THAT THE
+ * OPERATION OF THE SOFTWARE WILL BE UNINTERRUPTED OR ERROR-FREE, OR THAT
+ * ANY DEFECTS WILL BE CORRECTED. NIST DOES NOT WARRANT OR MAKE ANY
+ * REPRESENTATIONS REGARDING THE USE OF THE SOFTWARE OR THE RESULTS THEREOF,
+ * INCLUDING BUT NOT LIMITED TO THE CORRECTNESS, ACCURACY, RELIABILITY,
+ * OR USEFULNESS OF THE SOFTWARE.
+ *
+ * You are solely responsible for determining the appropriateness of using and
+ * distributing the software and you assume all risks associated with its use,
+ * including but not limited to the risks and costs of program errors,
+ * compliance with applicable laws, damage to or loss of data, programs or
+ * equipment, and the unavailability or interruption of operation. This
+ * software is not intended to be used in any situation where a failure could
+ * cause risk of injury or damage to property. The software developed by NIST
+ * employees is not subject to copyright protection within the United States.
+ *
+ * Author: Evan Black <evan.black@nist.gov>
+ */
+
+#pragma once
+
+#include <QTemporaryFile>
+#include <cstddef>
+#include <future>
+#include <memory>
+#include <model.h>
+#include <mutex>
+#include <shared-events.h>
+#include <type_traits>
+#include <variant>
+#include <vector>
+
+namespace netsimulyzer {
+
+/**
+ * The scene events, in fixed size pages which may be written to a temporary file
+ * & released when memory is over budget.
+ *
+ * Full pages far from the playhead are spilled first, each written once,
+ * in one sequential write. Pages next to the playhead are read back in the background,
+ * ahead of playback in either direction, see `trim()`.
+ * Any other page is read when an event on it is first used again.
+ *
+ * Pages are only released by `trim()`,
+ * so a reference to an event stays valid until then.
+ *
+ * Alternatively, the events may be read from a `parser::SharedEvents` mapping, see `attach()`,
+ * in which case no page is held at all
+ */
+class PagedEvents {
+  static_assert(std::is_trivially_copyable_v<parser::SceneEvent>, "Pages are written to the file as raw bytes");
+
+public:
+  using value_type = parser::SceneEvent;
+
+  /**
+   * Events per page
+   */
+  static constexpr std::size_t pageSize = 32'768u;
+
+private:
+  static constexpr std::size_t pageBytes = pageSize * sizeof(parser::SceneEvent);
+
+  struct Page {
+    /**
+     * The events of the page, empty while spilled
+     */
+    std::vector<parser::SceneEvent> events;
+
+    /**
+     * The time of the first event, kept while spilled,
+     * so finding an event by time only reads one page
+     */
+    parser::nanoseconds firstTime{0LL};
+
+    /**
+     * Where the page was written in `file`, or -1 if it never was
+     */
+    qint64 offset{-1};
+
+    bool resident{true};
+
+    /**
+     * Reading the page back, see `trim()`
+     */
+    std::future<std::vector<parser::SceneEvent>> loading;
+  };
+
+  /**
+   * Every page written, removed with the store.
+   * Only opened once the first page is spilled
+   */
+  std::unique_ptr<QTemporaryFile> file;
+
+  /**
+   * Guards `file`, which is read by the background reads
+   */
+  mutable std::mutex fileMutex;
+
+  /**
+   * Spilled pages are read back by `operator[]`, which does not change the events
+   */
+  mutable std::vector<Page> pages;
+  mutable std::size_t residentPages{0u};
+
+  std::size_t count{0u};
+
+  /**
+   * Read instead of the pages once attached, see `attach()`
+   */
+  std::shared_ptr<const parser::SharedEvents> shared;
+
+  /**
+   * Bytes of events to keep in memory. 0 for no limit
+   */
+  std::size_t budget{0u};
+
+  /**
+   * Bytes written to `file`
+   */
+  qint64 spilledBytes{0};
+
+  std::vector<parser::SceneEvent> read(qint64 offset) const;
+  void write(Page &page);
+  Page &residentPage(std::size_t index) const;
+
+public:
+  PagedEvents() = default;
+  PagedEvents(const PagedEvents &other) = delete;
+  PagedEvents &operator=(const PagedEvents &other) = delete;
+
+  /**
+   * Add events to the end. Not after `attach()`
+   *
+   * @param first
+   * The first event to add
+   *
+   * @param last
+   * One past the last event to add
+   */
+  template <class Iterator>
+  void append(Iterator first, Iterator last) {
+    for (; first != last; ++first) {
+      if (count % pageSize == 0u) {
+        pages.emplace_back();
+        pages.back().events.reserve(pageSize);
+        pages.back().firstTime = std::visit(
+            [](const auto &e) {
+              return e.time;
+            },
+            *first);
+        residentPages++;
+      }
+
+      pages.back().events.emplace_back(*first);
+      count++;
+    }
+  }
+
+  /**
+   * Read the events from `events` instead, dropping any pages,
+   * so the events are shared with other viewers of the same scenario
+   *
+   * @param events
+   * The mapped events, kept until `clear()`
+   */
+  void attach(std::shared_ptr<const parser::SharedEvents> events);
+
+  /**
+   * @return
+   * True if the events are read from a `parser::SharedEvents`, see `attach()`
+   */
+  [[nodiscard]] bool isShared() const;
+
+  /**
+   * Get an event, reading its page back if it was spilled
+   *
+   * @param index
+   * The index of the event. Must be less than `size()`
+   */
+  [[nodiscard]] const parser::SceneEvent &operator[](std::size_t index) const;
+
+  [[nodiscard]] std::size_t size() const;
+  [[nodiscard]] bool empty() const;
+
+  /**
+   * @return
+   * True if no page is spilled, so `operator[]` changes nothing,
+   * and may be called from several threads at once
+   */
+  [[nodiscard]] bool resident() const;
+
+  /**
+   * @param time
+   * The time to search for
+   *
+   * @return
+   * The index of the first event after `time`, or `size()` if there is none
+   */
+  [[nodiscard]] std::size_t upperBound(parser::nanoseconds time) const;
+
+  /**
+   * Set the bytes of events to keep in memory, applied by the next `trim()`
+   *
+   * @param bytes
+   * The budget. 0 for no limit
+   */
+  void setBudget(std::size_t bytes);
+
+  /**
+   * Spill the pages furthest from `position` until the events are within budget,
+   * and start reading back the pages around `position` which were spilled.
+   * Invalidates references to events more than a page from `position`.
+   * Does nothing without a budget
+   *
+   * @param position
+   * The index of the next event to apply
+   *
+   * @param backwards
+   * True if playback is going backwards, so the page before `position` is read ahead,
+   * rather than the one after
+   */
+  void trim(std::size_t position, bool backwards);
+
+  /**
+   * Remove every event & the file
+   */
+  void clear();
+
+  /**
+   * @return
+   * The bytes of the events in memory
+   */
+  [[nodiscard]] std::size_t memoryUsage() const;
+
+  /**
+   * @return
+   * The bytes of the events written to the temporary file
+   */
+  [[nodiscard]] std::size_t getSpilledBytes() const;
+
+  /**
+   * @return
+   * The bytes of the events mapped from a `parser::SharedEvents`, see `attach()`
+   */
+  [[nodiscard]] std::size_t getSharedBytes() const;
+};
+
+} // namespace netsimulyzer
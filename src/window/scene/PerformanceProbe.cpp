@@ -0,0 +1,179 @@
+/*
+ * NIST-developed software is provided by NIST as a public service. You may use,
+ * copy and distribute copies of the software in any medium, provided that you
+ * keep intact this entire notice. You may improve,modify and create derivative
+ * works of the software or any portion of the software, and you may copy and
+ * distribute such modifications or works. Modified works should carry a notice
+ * stating that you changed the software and should note the date and nature of
+ * any such change. Please explicitly acknowledge the National Institute of
+ * Standards and Technology as the source of the software.
+ *
+ * NIST-developed software is expressly provided "AS IS." NIST MAKES NO
+ * WARRANTY OF ANY KIND, EXPRESS, IMPLIED, IN FACT OR ARISING BY OPERATION OF
+ * LAW, INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTY OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, NON-INFRINGEMENT
+ * AND DATA ACCURACY. NIST NEITHER REPRESENTS NOR WARRANTS THAT THE
+ * OPERATION OF THE SOFTWARE WILL BE UNINTERRUPTED OR ERROR-FREE, OR THAT
+ * ANY DEFECTS WILL BE CORRECTED. NIST DOES NOT WARRANT OR MAKE ANY
+ * REPRESENTATIONS REGARDING THE USE OF THE SOFTWARE OR THE RESULTS THEREOF,
+ * INCLUDING BUT NOT LIMITED TO THE CORRECTNESS, ACCURACY, RELIABILITY,
+ * OR USEFULNESS OF THE SOFTWARE.
+ *
+ * You are solely responsible for determining the appropriateness of using and
+ * distributing the software and you assume all risks associated with its use,
+ * including but not limited to the risks and costs of program errors,
+ * compliance with applicable laws, damage to or loss of data, programs or
+ * equipment, and the unavailability or interruption of operation. This
+ * software is not intended to be used in any situation where a failure could
+ * cause risk of injury or damage to property. The software developed by NIST
+ * employees is not subject to copyright protection within the United States.
+ *
+ * Author: Evan Black <evan.black@nist.gov>
+ */
+
+#include "PerformanceProbe.h"
+#include "src/render/framebuffer/SceneFramebuffer.h"
+#include <QByteArray>
+#include <algorithm>
+#include <array>
+#include <vector>
+
+namespace netsimulyzer {
+
+namespace {
+
+/**
+ * Every setting picked by `PerformanceProbe::apply()`
+ */
+constexpr std::array presetKeys{SettingsManager::Key::RenderDynamicResolution,
+                                SettingsManager::Key::RenderAdaptiveQuality,
+                                SettingsManager::Key::RenderAdaptiveScale,
+                                SettingsManager::Key::RenderSkybox,
+                                SettingsManager::Key::RenderBuildingOutlines,
+                                SettingsManager::Key::RenderLabels,
+                                SettingsManager::Key::RenderMotionTrailLength,
+                                SettingsManager::Key::NumberSamples};
+
+} // namespace
+
+bool PerformanceProbe::isSoftware(const QString &rendererName) {
+  for (const auto name : {"llvmpipe", "softpipe", "SwiftShader", "Software Rasterizer", "GDI Generic"}) {
+    if (rendererName.contains(QString{name}, Qt::CaseInsensitive))
+      return true;
+  }
+
+  return false;
+}
+
+PerformanceProbe::PerformanceProbe(QOpenGLFunctions_3_3_Core &openGl, Renderer &renderer)
+    : openGl(openGl), renderer(renderer) {
+}
+
+PerformanceProbe::Result PerformanceProbe::run(QOpenGLContext &context, int samples, unsigned int framebuffer) {
+  Result result;
+  result.software = isSoftware(QString{reinterpret_cast<const char *>(openGl.glGetString(GL_RENDERER))});
+  result.indirectDraws = renderer.getBackend() == Renderer::Backend::Indirect43;
+
+  std::array<GLint, 4> viewport{};
+  openGl.glGetIntegerv(GL_VIEWPORT, viewport.data());
+
+  SceneFramebuffer target{openGl, width, height, samples};
+  std::array<unsigned int, frames> queries{};
+  openGl.glGenQueries(frames, queries.data());
+
+  target.bind();
+  openGl.glViewport(0, 0, width, height);
+  for (const auto query : queries) {
+    openGl.glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    openGl.glBeginQuery(GL_TIME_ELAPSED, query);
+    renderer.renderProbe(layers);
+    openGl.glEndQuery(GL_TIME_ELAPSED);
+  }
+
+  // Only run once, so waiting on the results is fine
+  std::vector<double> times;
+  times.reserve(static_cast<std::size_t>(frames - warmupFrames));
+  for (auto i = warmupFrames; i < frames; i++) {
+    GLuint64 elapsed = 0u;
+    openGl.glGetQueryObjectui64v(queries[static_cast<std::size_t>(i)], GL_QUERY_RESULT, &elapsed);
+    times.emplace_back(static_cast<double>(elapsed) / 1'000'000.0);
+  }
+  openGl.glDeleteQueries(frames, queries.data());
+
+  std::nth_element(times.begin(), times.begin() + times.size() / 2u, times.end());
+  result.milliseconds = times[times.size() / 2u];
+
+  openGl.glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+  openGl.glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+
+  if (result.software || result.milliseconds > mediumMilliseconds)
+    result.tier = Tier::Low;
+  else if (result.milliseconds > highMilliseconds || !result.indirectDraws)
+    result.tier = Tier::Medium;
+  else
+    result.tier = Tier::High;
+
+  // Only reported, the renderer already falls back without each of them
+  for (const auto extension :
+       {"GL_ARB_buffer_storage", "GL_ARB_multi_draw_indirect", "GL_KHR_parallel_shader_compile"}) {
+    if (!context.hasExtension(QByteArray{extension}))
+      result.missingExtensions.append(QString{extension});
+  }
+
+  return result;
+}
+
+QString PerformanceProbe::apply(const Result &result, SettingsManager &settings) {
+  using Key = SettingsManager::Key;
+  settings.set(Key::RenderPerformanceProbe, false);
+
+  QString description;
+  switch (result.tier) {
+  case Tier::Low:
+    settings.set(Key::RenderDynamicResolution, true);
+    settings.set(Key::RenderAdaptiveQuality, true);
+    settings.set(Key::RenderAdaptiveScale, 0.5f);
+    settings.set(Key::RenderSkybox, false);
+    settings.set(Key::RenderBuildingOutlines, false);
+    settings.set(Key::RenderLabels, SettingsManager::LabelRenderMode::Never);
+    settings.set(Key::RenderMotionTrailLength, 25);
+    settings.set(Key::NumberSamples, 0);
+    description = "Low: scaled resolution, no skybox, outlines, labels, or anti-aliasing, & short trails";
+    break;
+  case Tier::Medium:
+    settings.set(Key::RenderDynamicResolution, true);
+    settings.set(Key::RenderAdaptiveQuality, true);
+    settings.set(Key::RenderAdaptiveScale, 0.75f);
+    settings.setDefault(Key::RenderSkybox);
+    settings.setDefault(Key::RenderBuildingOutlines);
+    settings.setDefault(Key::RenderLabels);
+    settings.set(Key::RenderMotionTrailLength, 50);
+    settings.setDefault(Key::NumberSamples);
+    description = "Medium: scaled resolution, & shorter trails";
+    break;
+  case Tier::High:
+    for (const auto key : presetKeys)
+      settings.setDefault(key);
+    description = "High: the default settings";
+    break;
+  }
+
+  settings.sync();
+  return description;
+}
+
+bool PerformanceProbe::isPending(const SettingsManager &settings) {
+  using Key = SettingsManager::Key;
+  if (settings.isDefined(Key::RenderPerformanceProbe))
+    return settings.get<bool>(Key::RenderPerformanceProbe).value();
+
+  // Older installs, which may already be tuned
+  for (const auto key : presetKeys) {
+    if (settings.isDefined(key))
+      return false;
+  }
+
+  return true;
+}
+
+} // namespace netsimulyzer
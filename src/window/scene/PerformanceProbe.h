@@ -0,0 +1,146 @@
+/*
+ * NIST-developed software is provided by NIST as a public service. You may use,
+ * copy and distribute copies of the software in any medium, provided that you
+ * keep intact this entire notice. You may improve,modify and create derivative
+ * works of the software or any portion of the software, and you may copy and
+ * distribute such modifications or works. Modified works should carry a notice
+ * stating that you changed the software and should note the date and nature of
+ * any such change. Please explicitly acknowledge the National Institute of
+ * Standards and Technology as the source of the software.
+ *
+ * NIST-developed software is expressly provided "AS IS." NIST MAKES NO
+ * WARRANTY OF ANY KIND, EXPRESS, IMPLIED, IN FACT OR ARISING BY OPERATION OF
+ * LAW, INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTY OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, NON-INFRINGEMENT
+ * AND DATA ACCURACY. NIST NEITHER REPRESENTS NOR WARRANTS THAT THE
+ * OPERATION OF THE SOFTWARE WILL BE UNINTERRUPTED OR ERROR-FREE, OR THAT
+ * ANY DEFECTS WILL BE CORRECTED. NIST DOES NOT WARRANT OR MAKE ANY
+ * REPRESENTATIONS REGARDING THE USE OF THE SOFTWARE OR THE RESULTS THEREOF,
+ * INCLUDING BUT NOT LIMITED TO THE CORRECTNESS, ACCURACY, RELIABILITY,
+ * OR USEFULNESS OF THE SOFTWARE.
+ *
+ * You are solely responsible for determining the appropriateness of using and
+ * distributing the software and you assume all risks associated with its use,
+ * including but not limited to the risks and costs of program errors,
+ * compliance with applicable laws, damage to or loss of data, programs or
+ * equipment, and the unavailability or interruption of operation. This
+ * software is not intended to be used in any situation where a failure could
+ * cause risk of injury or damage to property. The software developed by NIST
+ * employees is not subject to copyright protection within the United States.
+ *
+ * Author: Evan Black <evan.black@nist.gov>
+ */
+
+#pragma once
+
+#include "src/render/renderer/Renderer.h"
+#include "src/settings/SettingsManager.h"
+#include <QOpenGLContext>
+#include <QOpenGLFunctions_3_3_Core>
+#include <QString>
+#include <QStringList>
+
+namespace netsimulyzer {
+
+/**
+ * Times a short synthetic workload on the GPU, and picks the graphics settings from it,
+ * so a weak GPU does not start with the settings meant for a workstation.
+ *
+ * The workload shades a 1080p target several times over, at the widget's samples,
+ * which is where most of the scene's GPU time goes (see `ResolutionScaler`)
+ */
+class PerformanceProbe {
+public:
+  enum class Tier { Low, Medium, High };
+
+  struct Result {
+    /**
+     * The median GPU time of a probe frame
+     */
+    double milliseconds{0.0};
+
+    /**
+     * The driver draws on the CPU (i.e. llvmpipe), which is always `Tier::Low`
+     */
+    bool software{false};
+
+    /**
+     * Models may be drawn with `Renderer::Backend::Indirect43`,
+     * otherwise each Node costs a draw call on the CPU
+     */
+    bool indirectDraws{false};
+
+    /**
+     * Extensions the renderer makes use of, which the driver lacks
+     */
+    QStringList missingExtensions;
+
+    Tier tier{Tier::High};
+  };
+
+private:
+  QOpenGLFunctions_3_3_Core &openGl;
+  Renderer &renderer;
+
+  static constexpr int width = 1920;
+  static constexpr int height = 1080;
+
+  /**
+   * Full screen layers per probe frame, about the overdraw of a busy scene
+   */
+  static constexpr int layers = 8;
+
+  static constexpr int frames = 12;
+
+  /**
+   * Frames left out of the median, while the driver warms up
+   */
+  static constexpr int warmupFrames = 2;
+
+  /**
+   * The most time of a probe frame for `Tier::High` & `Tier::Medium`
+   */
+  static constexpr double highMilliseconds = 2.5;
+  static constexpr double mediumMilliseconds = 8.0;
+
+  /**
+   * Substrings of `GL_RENDERER` for drivers which rasterize on the CPU
+   */
+  [[nodiscard]] static bool isSoftware(const QString &rendererName);
+
+public:
+  PerformanceProbe(QOpenGLFunctions_3_3_Core &openGl, Renderer &renderer);
+
+  /**
+   * Draw & time the probe frames. Waits for the GPU to finish them.
+   * Requires a current context, and leaves `framebuffer` bound
+   *
+   * @param context
+   * The current context, for its renderer & extensions
+   *
+   * @param samples
+   * The samples of the widget's framebuffer
+   *
+   * @param framebuffer
+   * The framebuffer to rebind afterwards
+   */
+  [[nodiscard]] Result run(QOpenGLContext &context, int samples, unsigned int framebuffer);
+
+  /**
+   * Store the graphics settings for `result.tier`.
+   * `Tier::High` restores the defaults
+   *
+   * @return
+   * A short description of the preset, for the user
+   */
+  static QString apply(const Result &result, SettingsManager &settings);
+
+  /**
+   * @return
+   * True if the probe should run at startup: it has never run,
+   * and none of the settings it picks were changed by hand
+   */
+  [[nodiscard]] static bool isPending(const SettingsManager &settings);
+};
+
+} // namespace netsimulyzer
@@ -0,0 +1,186 @@
+/*
+ * NIST-developed software is provided by NIST as a public service. You may use,
+ * copy and distribute copies of the software in any medium, provided that you
+ * keep intact this entire notice. You may improve,modify and create derivative
+ * works of the software or any portion of the software, and you may copy and
+ * distribute such modifications or works. Modified works should carry a notice
+ * stating that you changed the software and should note the date and nature of
+ * any such change. Please explicitly acknowledge the National Institute of
+ * Standards and Technology as the source of the software.
+ *
+ * NIST-developed software is expressly provided "AS IS." NIST MAKES NO
+ * WARRANTY OF ANY KIND, EXPRESS, IMPLIED, IN FACT OR ARISING BY OPERATION OF
+ * LAW, INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTY OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, NON-INFRINGEMENT
+ * AND DATA ACCURACY. NIST NEITHER REPRESENTS NOR WARRANTS THAT THE
+ * OPERATION OF THE SOFTWARE WILL BE UNINTERRUPTED OR ERROR-FREE, OR THAT
+ * ANY DEFECTS WILL BE CORRECTED. NIST DOES NOT WARRANT OR MAKE ANY
+ * REPRESENTATIONS REGARDING THE USE OF THE SOFTWARE OR THE RESULTS THEREOF,
+ * INCLUDING BUT NOT LIMITED TO THE CORRECTNESS, ACCURACY, RELIABILITY,
+ * OR USEFULNESS OF THE SOFTWARE.
+ *
+ * You are solely responsible for determining the appropriateness of using and
+ * distributing the software and you assume all risks associated with its use,
+ * including but not limited to the risks and costs of program errors,
+ * compliance with applicable laws, damage to or loss of data, programs or
+ * equipment, and the unavailability or interruption of operation. This
+ * software is not intended to be used in any situation where a failure could
+ * cause risk of injury or damage to property. The software developed by NIST
+ * employees is not subject to copyright protection within the United States.
+ *
+ * Author: Evan Black <evan.black@nist.gov>
+ */
+
+#include "RenderServer.h"
+#include <QBuffer>
+#include <QByteArray>
+#include <QStringList>
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <trace.h>
+
+namespace netsimulyzer {
+
+RenderServer::~RenderServer() {
+  stop();
+}
+
+std::optional<QString> RenderServer::listen(const QString &address) {
+  stop();
+
+  {
+    std::lock_guard lock{socketMutex};
+    socket.emplace();
+    if (const auto error = socket->listen(address.toStdString())) {
+      socket.reset();
+      return QString::fromStdString(error.value());
+    }
+  }
+
+  stopRequested = false;
+  reader = parser::TaskPool::shared().submit([this, address = address.toStdString()]() {
+    serve(address);
+  });
+  return {};
+}
+
+void RenderServer::stop() {
+  stopRequested = true;
+  reader.wait();
+
+  std::lock_guard lock{socketMutex};
+  socket.reset();
+  if (connected.exchange(false))
+    emit clientDisconnected();
+}
+
+void RenderServer::serve(const std::string &address) {
+  using namespace std::chrono_literals;
+  std::array<char, 4096u> buffer{};
+  std::string lines;
+
+  while (!stopRequested) {
+    if (!socket->accept(stopRequested))
+      return;
+
+    connected = true;
+    emit clientConnected();
+
+    lines.clear();
+    while (!stopRequested) {
+      const auto received = socket->read(buffer.data(), buffer.size(), 250ms);
+      if (!received)
+        break;
+
+      lines.append(buffer.data(), received.value());
+      std::size_t start = 0u;
+      for (auto end = lines.find('\n'); end != std::string::npos; end = lines.find('\n', start)) {
+        handle(QString::fromUtf8(lines.data() + start, static_cast<int>(end - start)));
+        start = end + 1u;
+      }
+      lines.erase(0u, start);
+    }
+
+    if (stopRequested)
+      return;
+
+    connected = false;
+    emit clientDisconnected();
+
+    // The listener was closed once the client connected, so open it again for the next
+    std::lock_guard lock{socketMutex};
+    if (const auto error = socket->listen(address)) {
+      std::cerr << "Render server stopped: " << error.value() << '\n';
+      return;
+    }
+  }
+}
+
+void RenderServer::handle(const QString &line) {
+  const auto parts = line.simplified().split(' ');
+  const auto &command = parts.front();
+
+  if (command == "size" && parts.size() == 3) {
+    emit resizeRequested(std::clamp(parts[1].toInt(), 16, 4096), std::clamp(parts[2].toInt(), 16, 4096));
+  } else if (command == "camera" && parts.size() == 6) {
+    emit viewRequested(parts[1].toFloat(), parts[2].toFloat(), parts[3].toFloat(), parts[4].toFloat(),
+                       parts[5].toFloat());
+  } else if (command == "time" && parts.size() == 2) {
+    emit seekRequested(parts[1].toLongLong());
+  } else if (command == "play") {
+    emit playRequested();
+  } else if (command == "pause") {
+    emit pauseRequested();
+  } else if (command == "quality" && parts.size() == 2) {
+    quality = std::clamp(parts[1].toInt(), 1, 100);
+  }
+}
+
+bool RenderServer::isConnected() const {
+  return connected;
+}
+
+void RenderServer::queue() {
+  pending++;
+}
+
+int RenderServer::getPending() const {
+  return pending;
+}
+
+void RenderServer::send(const QImage &frame, qint64 time, QVector3D position, float yaw, float pitch) {
+  parser::trace::Scope trace{"RenderServer::send", "frame"};
+
+  if (connected) {
+    QByteArray encoded;
+    QBuffer buffer{&encoded};
+    buffer.open(QBuffer::WriteOnly);
+    frame.mirrored().save(&buffer, "JPG", quality);
+
+    const auto header = QString{"frame %1 %2 %3 %4 %5 %6 %7 %8 %9\n"}
+                            .arg(time)
+                            .arg(frame.width())
+                            .arg(frame.height())
+                            .arg(position.x())
+                            .arg(position.y())
+                            .arg(position.z())
+                            .arg(yaw)
+                            .arg(pitch)
+                            .arg(encoded.size())
+                            .toUtf8();
+
+    // Checked again, since `serve()` only touches the socket unlocked while no client is connected.
+    // A failed send means the client left, which the reader sees as well
+    std::lock_guard lock{socketMutex};
+    if (connected && socket && socket->write(header.constData(), static_cast<std::size_t>(header.size())))
+      (void)socket->write(encoded.constData(), static_cast<std::size_t>(encoded.size()));
+  }
+
+  pending--;
+  emit frameSent();
+}
+
+} // namespace netsimulyzer
@@ -0,0 +1,189 @@
+/*
+ * NIST-developed software is provided by NIST as a public service. You may use,
+ * copy and distribute copies of the software in any medium, provided that you
+ * keep intact this entire notice. You may improve,modify and create derivative
+ * works of the software or any portion of the software, and you may copy and
+ * distribute such modifications or works. Modified works should carry a notice
+ * stating that you changed the software and should note the date and nature of
+ * any such change. Please explicitly acknowledge the National Institute of
+ * Standards and Technology as the source of the software.
+ *
+ * NIST-developed software is expressly provided "AS IS." NIST MAKES NO
+ * WARRANTY OF ANY KIND, EXPRESS, IMPLIED, IN FACT OR ARISING BY OPERATION OF
+ * LAW, INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTY OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, NON-INFRINGEMENT
+ * AND DATA ACCURACY. NIST NEITHER REPRESENTS NOR WARRANTS THAT THE
+ * OPERATION OF THE SOFTWARE WILL BE UNINTERRUPTED OR ERROR-FREE, OR THAT
+ * ANY DEFECTS WILL BE CORRECTED. NIST DOES NOT WARRANT OR MAKE ANY
+ * REPRESENTATIONS REGARDING THE USE OF THE SOFTWARE OR THE RESULTS THEREOF,
+ * INCLUDING BUT NOT LIMITED TO THE CORRECTNESS, ACCURACY, RELIABILITY,
+ * OR USEFULNESS OF THE SOFTWARE.
+ *
+ * You are solely responsible for determining the appropriateness of using and
+ * distributing the software and you assume all risks associated with its use,
+ * including but not limited to the risks and costs of program errors,
+ * compliance with applicable laws, damage to or loss of data, programs or
+ * equipment, and the unavailability or interruption of operation. This
+ * software is not intended to be used in any situation where a failure could
+ * cause risk of injury or damage to property. The software developed by NIST
+ * employees is not subject to copyright protection within the United States.
+ *
+ * Author: Evan Black <evan.black@nist.gov>
+ */
+
+#pragma once
+
+#include <QImage>
+#include <QObject>
+#include <QString>
+#include <QVector3D>
+#include <atomic>
+#include <ingest-socket.h>
+#include <mutex>
+#include <optional>
+#include <task-pool.h>
+
+namespace netsimulyzer {
+
+/**
+ * Serves the scene's view to one remote client at a time, so a scenario held on a machine
+ * with a capable GPU may be watched from one without.
+ * Only frames cross the connection, never the scenario.
+ *
+ * Each frame is sent as a text header, then the frame as JPEG:
+ *
+ *   frame <simulation time in ns> <width> <height> <x> <y> <z> <yaw> <pitch> <size in bytes>\n<JPEG bytes>
+ *
+ * where the camera is given as it was drawn, so the client may move it from there.
+ *
+ * The client sends back one command per line:
+ *
+ *   size <width> <height>             the size of the frames to draw
+ *   camera <x> <y> <z> <yaw> <pitch>  move the view, see `Camera::setRotation()`
+ *   time <ns>                         seek to a simulation time
+ *   play / pause                      start or stop playback
+ *   quality <1-100>                   the JPEG quality of the frames
+ *
+ * Lives on the frame writer's thread, so encoding never holds up rendering.
+ * Commands are read on the shared `parser::TaskPool`, & a new client may connect once one leaves.
+ * Unavailable on Windows, see `parser::IngestSocket`
+ */
+class RenderServer : public QObject {
+  Q_OBJECT
+
+  /**
+   * Guards replacing the socket against `send()`
+   */
+  std::mutex socketMutex;
+  std::optional<parser::IngestSocket> socket;
+
+  /**
+   * Reads commands until `stopRequested`, see `serve()`
+   */
+  parser::TaskPool::Handle reader;
+  std::atomic<bool> stopRequested{false};
+  std::atomic<bool> connected{false};
+
+  /**
+   * Frames queued with `send()` that have not been sent yet
+   */
+  std::atomic<int> pending{0};
+
+  /**
+   * JPEG quality, from 1 to 100
+   */
+  std::atomic<int> quality{80};
+
+  /**
+   * Accept clients & read their commands, until stopped. Runs on the pool
+   *
+   * @param address
+   * Where to listen, see `parser::IngestSocket::listen()`
+   */
+  void serve(const std::string &address);
+
+  /**
+   * Emit the signal for one command line. Unknown commands are ignored
+   *
+   * @param line
+   * The command, without its line break
+   */
+  void handle(const QString &line);
+
+public:
+  ~RenderServer() override;
+
+  /**
+   * Start listening for a client, replacing any earlier server
+   *
+   * @param address
+   * Where to listen, see `parser::IngestSocket::listen()`
+   *
+   * @return
+   * A description of the error, if the socket could not be opened,
+   * an unset optional otherwise
+   */
+  [[nodiscard]] std::optional<QString> listen(const QString &address);
+
+  /**
+   * Disconnect the client, and stop listening
+   */
+  void stop();
+
+  /**
+   * @return
+   * True while a client is connected. Safe to call from any thread
+   */
+  [[nodiscard]] bool isConnected() const;
+
+  /**
+   * Count a frame about to be sent to `send()`.
+   * Call on the sending thread, before the frame is queued
+   */
+  void queue();
+
+  /**
+   * @return
+   * Frames queued that have not been sent yet.
+   * Safe to call from any thread
+   */
+  [[nodiscard]] int getPending() const;
+
+public slots:
+  /**
+   * Encode & send one frame to the client, if one is connected
+   *
+   * @param frame
+   * The frame, as read from OpenGL, so upside down
+   *
+   * @param time
+   * The simulation time of the frame
+   *
+   * @param position
+   * Where the camera was, see `Camera::get_position()`
+   *
+   * @param yaw
+   * The camera's yaw, in degrees
+   *
+   * @param pitch
+   * The camera's pitch, in degrees
+   */
+  void send(const QImage &frame, qint64 time, QVector3D position, float yaw, float pitch);
+
+signals:
+  void clientConnected();
+  void clientDisconnected();
+
+  /**
+   * Emitted after each frame from `send()` is done with
+   */
+  void frameSent();
+
+  void resizeRequested(int width, int height);
+  void viewRequested(float x, float y, float z, float yaw, float pitch);
+  void seekRequested(qint64 time);
+  void playRequested();
+  void pauseRequested();
+};
+
+} // namespace netsimulyzer
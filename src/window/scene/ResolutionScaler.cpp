@@ -0,0 +1,133 @@
+/*
+ * NIST-developed software is provided by NIST as a public service. You may use,
+ * copy and distribute copies of the software in any medium, provided that you
+ * keep intact this entire notice. You may improve,modify and create derivative
+ * works of the software or any portion of the software, and you may copy and
+ * distribute such modifications or works. Modified works should carry a notice
+ * stating that you changed the software and should note the date and nature of
+ * any such change. Please explicitly acknowledge the National Institute of
+ * Standards and Technology as the source of the software.
+ *
+ * NIST-developed software is expressly provided "AS IS." NIST MAKES NO
+ * WARRANTY OF ANY KIND, EXPRESS, IMPLIED, IN FACT OR ARISING BY OPERATION OF
+ * LAW, INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTY OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, NON-INFRINGEMENT
+ * AND DATA ACCURACY. NIST NEITHER REPRESENTS NOR WARRANTS THAT THE
+ * OPERATION OF THE SOFTWARE WILL BE UNINTERRUPTED OR ERROR-FREE, OR THAT
+ * ANY DEFECTS WILL BE CORRECTED. NIST DOES NOT WARRANT OR MAKE ANY
+ * REPRESENTATIONS REGARDING THE USE OF THE SOFTWARE OR THE RESULTS THEREOF,
+ * INCLUDING BUT NOT LIMITED TO THE CORRECTNESS, ACCURACY, RELIABILITY,
+ * OR USEFULNESS OF THE SOFTWARE.
+ *
+ * You are solely responsible for determining the appropriateness of using and
+ * distributing the software and you assume all risks associated with its use,
+ * including but not limited to the risks and costs of program errors,
+ * compliance with applicable laws, damage to or loss of data, programs or
+ * equipment, and the unavailability or interruption of operation. This
+ * software is not intended to be used in any situation where a failure could
+ * cause risk of injury or damage to property. The software developed by NIST
+ * employees is not subject to copyright protection within the United States.
+ *
+ * Author: Evan Black <evan.black@nist.gov>
+ */
+
+#include "ResolutionScaler.h"
+#include <algorithm>
+#include <cmath>
+
+namespace netsimulyzer {
+
+ResolutionScaler::ResolutionScaler(float targetMilliseconds) : targetMilliseconds(targetMilliseconds) {
+}
+
+void ResolutionScaler::init() {
+  initializeOpenGLFunctions();
+
+  for (auto &frameQueries : frames)
+    glGenQueries(static_cast<GLsizei>(frameQueries.queries.size()), frameQueries.queries.data());
+}
+
+void ResolutionScaler::setTarget(float milliseconds) {
+  targetMilliseconds = milliseconds;
+}
+
+void ResolutionScaler::begin() {
+  auto &frameQueries = frames[nextFrame % queryLatency];
+
+  // Never reuse queries which have not been read, that would wait on them
+  if (frameQueries.issued)
+    return;
+
+  glQueryCounter(frameQueries.queries[0], GL_TIMESTAMP);
+  current = &frameQueries;
+}
+
+void ResolutionScaler::end() {
+  nextFrame++;
+  if (!current)
+    return;
+
+  glQueryCounter(current->queries[1], GL_TIMESTAMP);
+  current->issued = true;
+  current = nullptr;
+}
+
+bool ResolutionScaler::update() {
+  for (auto &frameQueries : frames) {
+    if (!frameQueries.issued)
+      continue;
+
+    // The end is written last, so the start is done as well
+    GLint available = GL_FALSE;
+    glGetQueryObjectiv(frameQueries.queries[1], GL_QUERY_RESULT_AVAILABLE, &available);
+    if (!available)
+      continue;
+    frameQueries.issued = false;
+
+    GLuint64 start = 0u;
+    GLuint64 end = 0u;
+    glGetQueryObjectui64v(frameQueries.queries[0], GL_QUERY_RESULT, &start);
+    glGetQueryObjectui64v(frameQueries.queries[1], GL_QUERY_RESULT, &end);
+
+    if (skipFrames > 0) {
+      skipFrames--;
+      continue;
+    }
+
+    const auto milliseconds = static_cast<double>(end - start) / 1'000'000.0;
+    averageMilliseconds = averageMilliseconds ? averageMilliseconds.value() * (1.0 - smoothing) + milliseconds * smoothing
+                                              : milliseconds;
+  }
+
+  if (!averageMilliseconds || averageMilliseconds.value() <= 0.0)
+    return false;
+
+  // The time is roughly proportional to the pixels drawn, so the square of the scale
+  const auto ideal =
+      scale * static_cast<float>(std::sqrt(static_cast<double>(targetMilliseconds) / averageMilliseconds.value()));
+  auto next = std::clamp(std::round(ideal / scaleStep) * scaleStep, minScale, maxScale);
+
+  // Only grow when well under the target, so the scale doesn't bounce between two steps
+  if (next > scale && averageMilliseconds.value() > targetMilliseconds * 0.8)
+    next = scale;
+
+  if (std::abs(next - scale) < scaleStep * 0.5f)
+    return false;
+
+  scale = next;
+  averageMilliseconds.reset();
+  skipFrames = settleFrames;
+  return true;
+}
+
+void ResolutionScaler::reset() {
+  scale = maxScale;
+  averageMilliseconds.reset();
+  skipFrames = 0;
+}
+
+float ResolutionScaler::getScale() const {
+  return scale;
+}
+
+} // namespace netsimulyzer
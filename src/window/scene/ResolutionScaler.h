@@ -0,0 +1,136 @@
+/*
+ * NIST-developed software is provided by NIST as a public service. You may use,
+ * copy and distribute copies of the software in any medium, provided that you
+ * keep intact this entire notice. You may improve,modify and create derivative
+ * works of the software or any portion of the software, and you may copy and
+ * distribute such modifications or works. Modified works should carry a notice
+ * stating that you changed the software and should note the date and nature of
+ * any such change. Please explicitly acknowledge the National Institute of
+ * Standards and Technology as the source of the software.
+ *
+ * NIST-developed software is expressly provided "AS IS." NIST MAKES NO
+ * WARRANTY OF ANY KIND, EXPRESS, IMPLIED, IN FACT OR ARISING BY OPERATION OF
+ * LAW, INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTY OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, NON-INFRINGEMENT
+ * AND DATA ACCURACY. NIST NEITHER REPRESENTS NOR WARRANTS THAT THE
+ * OPERATION OF THE SOFTWARE WILL BE UNINTERRUPTED OR ERROR-FREE, OR THAT
+ * ANY DEFECTS WILL BE CORRECTED. NIST DOES NOT WARRANT OR MAKE ANY
+ * REPRESENTATIONS REGARDING THE USE OF THE SOFTWARE OR THE RESULTS THEREOF,
+ * INCLUDING BUT NOT LIMITED TO THE CORRECTNESS, ACCURACY, RELIABILITY,
+ * OR USEFULNESS OF THE SOFTWARE.
+ *
+ * You are solely responsible for determining the appropriateness of using and
+ * distributing the software and you assume all risks associated with its use,
+ * including but not limited to the risks and costs of program errors,
+ * compliance with applicable laws, damage to or loss of data, programs or
+ * equipment, and the unavailability or interruption of operation. This
+ * software is not intended to be used in any situation where a failure could
+ * cause risk of injury or damage to property. The software developed by NIST
+ * employees is not subject to copyright protection within the United States.
+ *
+ * Author: Evan Black <evan.black@nist.gov>
+ */
+
+#pragma once
+
+#include <QOpenGLFunctions_3_3_Core>
+#include <array>
+#include <cstddef>
+#include <optional>
+
+namespace netsimulyzer {
+
+/**
+ * Picks the resolution the scene is drawn at, from its measured GPU time,
+ * so frames stay near a target time.
+ *
+ * The scene is timed with a pair of `GL_TIMESTAMP` queries, rather than `GL_TIME_ELAPSED`,
+ * since those may not nest within the `FrameProfiler` stages.
+ * Results are read a few frames later, so the scaler never waits on the GPU
+ */
+class ResolutionScaler : protected QOpenGLFunctions_3_3_Core {
+  /**
+   * The number of frames of queries in flight
+   */
+  static constexpr std::size_t queryLatency = 3u;
+
+  static constexpr float minScale = 0.5f;
+  static constexpr float maxScale = 1.0f;
+
+  /**
+   * Scales are kept to multiples of this,
+   * so the target is not reallocated for tiny changes
+   */
+  static constexpr float scaleStep = 0.05f;
+
+  /**
+   * Weight of the newest time in `averageMilliseconds`
+   */
+  static constexpr double smoothing = 0.1;
+
+  /**
+   * Times read after a change in scale,
+   * which may still be at the old scale, so they are skipped
+   */
+  static constexpr int settleFrames = static_cast<int>(queryLatency) * 2;
+
+  struct FrameQueries {
+    std::array<unsigned int, 2> queries{};
+    bool issued{false};
+  };
+
+  std::array<FrameQueries, queryLatency> frames;
+  std::size_t nextFrame{0u};
+
+  /**
+   * Set between `begin()` & `end()`, if there's a set of queries free for the frame
+   */
+  FrameQueries *current{nullptr};
+
+  float targetMilliseconds;
+  std::optional<double> averageMilliseconds;
+  float scale{maxScale};
+  int skipFrames{0};
+
+public:
+  /**
+   * @param targetMilliseconds
+   * The GPU time per frame to aim for
+   */
+  explicit ResolutionScaler(float targetMilliseconds);
+
+  /**
+   * Create the queries. Requires a current context
+   */
+  void init();
+
+  void setTarget(float milliseconds);
+
+  /**
+   * Start timing the scene.
+   * Skipped if every set of queries is still in flight
+   */
+  void begin();
+  void end();
+
+  /**
+   * Read any finished times, and pick a new scale from them
+   *
+   * @return
+   * True if the scale changed
+   */
+  bool update();
+
+  /**
+   * Go back to full resolution, and forget the previous times
+   */
+  void reset();
+
+  /**
+   * @return
+   * The fraction of the full width & height to draw at
+   */
+  [[nodiscard]] float getScale() const;
+};
+
+} // namespace netsimulyzer
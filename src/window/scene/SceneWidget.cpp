@@ -35,29 +35,46 @@
 #include "../../render/camera/Camera.h"
 #include "../../render/mesh/Mesh.h"
 #include "../../render/mesh/Vertex.h"
+#include "../../render/renderer/GlState.h"
+#include "../../render/renderer/UploadRing.h"
 #include "src/conversion.h"
+#include "src/util/common-times.h"
 #include <QByteArray>
+#include <QColor>
+#include <QDir>
+#include <QFileInfo>
 #include <QFileDialog>
+#include <QFontDatabase>
+#include <QGuiApplication>
 #include <QKeyEvent>
 #include <QMenu>
 #include <QMessageBox>
 #include <QObject>
+#include <QOpenGLContext>
 #include <QOpenGLDebugMessage>
 #include <QOpenGLFunctions_3_3_Core>
+#include <QPainter>
 #include <QPixmap>
 #include <QSettings>
 #include <QTextStream>
 #include <Qt>
 #include <QtGui/QOpenGLFunctions>
 #include <algorithm>
+#include <array>
 #include <cmath>
+#include <cstdlib>
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 #include <ios>
 #include <iostream>
+#include <iterator>
 #include <model.h>
 #include <qopengl.h>
+#include <utility>
+#include <string>
+#include <task-pool.h>
+#include <trace.h>
 #include <vector>
 
 #ifndef NDEBUG
@@ -68,101 +85,917 @@ static void logGlDebugMessage(const QOpenGLDebugMessage &message) {
 
 namespace netsimulyzer {
 
-void SceneWidget::handleEvents() {
+void SceneWidget::handleEvents(bool budgeted) {
   // Flag to indicate the selected Node has been updated
   // Use a flag instead of emitting a signal from the
   // handler, just in case the Node is updated several times
   // this event period
   bool selectedNodeUpdated = false;
 
-  // Returns true after handling an event
-  // false otherwise
-  auto handleEvent = [this, &selectedNodeUpdated](auto &&arg) -> bool {
+  // Events at one time may take longer than a frame to apply,
+  // so only check the clock every few events
+  constexpr std::size_t budgetCheckInterval = 256u;
+  QElapsedTimer budgetTimer;
+  budgeted = budgeted && eventBudget > 0LL;
+  if (budgeted)
+    budgetTimer.start();
+
+  eventsPending = false;
+  const auto firstEvent = nextEvent;
+
+  // Many events due at once, e.g. after a seek or a large step, are spread over the task pool.
+  // In batches when budgeted, so the budget is still checked between them
+  constexpr std::size_t parallelThreshold = 4096u;
+  constexpr std::size_t parallelBatch = 65536u;
+  if (parallelEvents && parser::TaskPool::shared().size() > 1u) {
+    const auto due = events.upperBound(simulationTime);
+    while (due > nextEvent && due - nextEvent >= parallelThreshold) {
+      const auto end = budgeted ? std::min(due, nextEvent + parallelBatch) : due;
+      if (applyEventsParallel(end))
+        selectedNodeUpdated = true;
+
+      if (budgeted && budgetTimer.nsecsElapsed() > eventBudget) {
+        eventsPending = nextEvent < due;
+        break;
+      }
+    }
+  }
+
+  // Handle the run of events of the same kind as `first`, from `nextEvent` on,
+  // so the kind is matched once per run, rather than once per event.
+  // Returns true when the run ends at an event of another kind,
+  // false once no more events may be handled this frame
+  auto handleRun = [this, &selectedNodeUpdated, &budgetTimer, budgeted, firstEvent](const auto &first) -> bool {
     // Strip off qualifiers, etc
     // so T holds just the type
     // so we can more easily match it
-    using T = std::decay_t<decltype(arg)>;
+    using T = std::decay_t<decltype(first)>;
 
-    // All events have a time
-    // Make sure we don't handle one in the future
-    if (arg.time > simulationTime)
-      return false;
-
-    if constexpr (std::is_same_v<T, parser::MoveEvent> || std::is_same_v<T, parser::NodeOrientationChangeEvent> ||
-                  std::is_same_v<T, parser::NodeColorChangeEvent> || std::is_same_v<T, parser::TransmitEvent> ||
-                  std::is_same_v<T, parser::TransmitEndEvent>) {
-      auto node = nodes.find(arg.nodeId);
-      if (node == nodes.end())
+    for (; nextEvent < events.size(); nextEvent++) {
+      if (budgeted && (nextEvent - firstEvent) % budgetCheckInterval == budgetCheckInterval - 1u &&
+          budgetTimer.nsecsElapsed() > eventBudget) {
+        eventsPending = true;
         return false;
-      undoEvents.emplace_back(node->second.handle(arg));
+      }
 
-      if (selectedNode.has_value() && node->second.getNs3Model().id == selectedNode.value())
-        selectedNodeUpdated = true;
+      const auto arg = std::get_if<T>(&events[nextEvent]);
+      if (!arg)
+        return true;
 
-      return true;
-    } else if constexpr (std::is_same_v<T, parser::DecorationMoveEvent> ||
-                         std::is_same_v<T, parser::DecorationOrientationChangeEvent>) {
-      auto decoration = decorations.find(arg.decorationId);
-      if (decoration == decorations.end())
+      // All events have a time
+      // Make sure we don't handle one in the future
+      if (arg->time > simulationTime)
         return false;
-      undoEvents.emplace_back(decoration->second.handle(arg));
-      return true;
+
+      // Events for unknown items are skipped,
+      // so they match the keyframes
+      const auto slot = streams.slot(nextEvent);
+      if (slot == parser::EntityEventStreams::noSlot)
+        continue;
+
+      if constexpr (std::is_same_v<T, parser::MoveEvent> || std::is_same_v<T, parser::NodeOrientationChangeEvent> ||
+                    std::is_same_v<T, parser::NodeColorChangeEvent> || std::is_same_v<T, parser::TransmitEvent> ||
+                    std::is_same_v<T, parser::TransmitEndEvent>) {
+        if (isNodeDeferred(slot)) {
+          markStale(slot);
+          streams.getNodeStream(slot).cursor++;
+          continue;
+        }
+
+        auto &node = nodeStore.getNode(slot);
+        node.handle(*arg);
+        touchNode(slot);
+        streams.getNodeStream(slot).cursor++;
+
+        if (selectedNode.has_value() && node.getNs3Model().id == selectedNode.value())
+          selectedNodeUpdated = true;
+      } else if constexpr (std::is_same_v<T, parser::DecorationMoveEvent> ||
+                           std::is_same_v<T, parser::DecorationOrientationChangeEvent>) {
+        decorationSlots[slot]->handle(*arg);
+        touchDecoration(slot);
+        streams.getDecorationStream(slot).cursor++;
+      }
     }
+
+    return false;
   };
 
-  while (!events.empty() && std::visit(handleEvent, events.front())) {
-    events.pop_front();
+  while (!eventsPending && nextEvent < events.size() && std::visit(handleRun, events[nextEvent])) {
   }
+  updateTouched();
+  profiler.countEvents(nextEvent - firstEvent);
+  frameCounters.eventsApplied += nextEvent - firstEvent;
 
   if (selectedNodeUpdated)
     emit selectedItemUpdated();
 }
 
+bool SceneWidget::applyEventsParallel(std::size_t end) {
+  parser::trace::Scope trace{"SceneWidget::applyEventsParallel", "frame"};
+  auto &pool = parser::TaskPool::shared();
+  const std::size_t workers = pool.size();
+
+  eventPartitions.resize(workers + 1u);
+  for (auto &partition : eventPartitions) {
+    partition.events.clear();
+    partition.touchedNodes.clear();
+    partition.touchedDecorations.clear();
+    partition.staleNodes.clear();
+    partition.selectedNodeUpdated = false;
+  }
+
+  // Split by slot, so each Node & Decoration belongs to one partition.
+  // Events for unknown items are skipped, as they are one by one.
+  // This reads back any spilled page of the events first, which only one thread may do
+  auto &local = eventPartitions[workers];
+  for (auto i = nextEvent; i < end; i++) {
+    const auto slot = streams.slot(i);
+    if (slot == parser::EntityEventStreams::noSlot)
+      continue;
+
+    const auto isDecoration = std::holds_alternative<parser::DecorationMoveEvent>(events[i]) ||
+                              std::holds_alternative<parser::DecorationOrientationChangeEvent>(events[i]);
+    if (!isDecoration && nodeStore.getNode(slot).hasWiredLinks())
+      local.events.emplace_back(i);
+    else
+      eventPartitions[slot % workers].events.emplace_back(i);
+  }
+
+  const auto apply = [this](std::size_t index) {
+    auto &partition = eventPartitions[index];
+    std::uint32_t slot = parser::EntityEventStreams::noSlot;
+
+    const auto handle = [this, &partition, &slot](const auto &e) {
+      using T = std::decay_t<decltype(e)>;
+
+      if constexpr (std::is_same_v<T, parser::MoveEvent> || std::is_same_v<T, parser::NodeOrientationChangeEvent> ||
+                    std::is_same_v<T, parser::NodeColorChangeEvent> || std::is_same_v<T, parser::TransmitEvent> ||
+                    std::is_same_v<T, parser::TransmitEndEvent>) {
+        if (isNodeDeferred(slot)) {
+          partition.staleNodes.emplace_back(slot);
+          streams.getNodeStream(slot).cursor++;
+          return;
+        }
+
+        auto &node = nodeStore.getNode(slot);
+        node.handle(e);
+        partition.touchedNodes.emplace_back(slot);
+        streams.getNodeStream(slot).cursor++;
+
+        if (selectedNode.has_value() && node.getNs3Model().id == selectedNode.value())
+          partition.selectedNodeUpdated = true;
+      } else if constexpr (std::is_same_v<T, parser::DecorationMoveEvent> ||
+                           std::is_same_v<T, parser::DecorationOrientationChangeEvent>) {
+        decorationSlots[slot]->handle(e);
+        partition.touchedDecorations.emplace_back(slot);
+        streams.getDecorationStream(slot).cursor++;
+      }
+    };
+
+    for (const auto i : partition.events) {
+      slot = streams.slot(i);
+      std::visit(handle, events[i]);
+    }
+  };
+
+  pool.parallelFor(workers, 0u, parser::TaskPool::Priority::Interactive, apply);
+  apply(workers);
+
+  // The flags are packed bits, so only set from this thread
+  auto selectedNodeUpdated = false;
+  for (const auto &partition : eventPartitions) {
+    for (const auto slot : partition.touchedNodes)
+      touchNode(slot);
+    for (const auto slot : partition.touchedDecorations)
+      touchDecoration(slot);
+    for (const auto slot : partition.staleNodes)
+      markStale(slot);
+    selectedNodeUpdated = selectedNodeUpdated || partition.selectedNodeUpdated;
+  }
+
+  nextEvent = end;
+  return selectedNodeUpdated;
+}
+
 void SceneWidget::handleUndoEvents() {
+  // Slot of the Node/Decoration the event being reversed applies to
+  std::uint32_t slot = parser::EntityEventStreams::noSlot;
 
-  auto handleUndoEvent = [this](auto &&arg) -> bool {
+  auto handleUndoEvent = [this, &slot](auto &&arg) {
     // Strip off qualifiers, etc
     // so T holds just the type
     // so we can more easily match it
     using T = std::decay_t<decltype(arg)>;
 
+    if constexpr (std::is_same_v<T, undo::MoveEvent> || std::is_same_v<T, undo::NodeOrientationChangeEvent> ||
+                  std::is_same_v<T, undo::TransmitEvent> || std::is_same_v<T, undo::NodeColorChangeEvent>) {
+      if (isNodeDeferred(slot)) {
+        markStale(slot);
+        streams.getNodeStream(slot).cursor--;
+        return;
+      }
+
+      // Points which fell off the front of a full trail are not in it to return to
+      if constexpr (std::is_same_v<T, undo::MoveEvent>) {
+        if (nodeStore.getNode(slot).getTrailBuffer().full())
+          markTrailStale(slot);
+      }
+
+      nodeStore.getNode(slot).handle(arg);
+      touchNode(slot);
+      streams.getNodeStream(slot).cursor--;
+    } else if constexpr (std::is_same_v<T, undo::DecorationMoveEvent> ||
+                         std::is_same_v<T, undo::DecorationOrientationChangeEvent>) {
+      decorationSlots[slot]->handle(arg);
+      touchDecoration(slot);
+      streams.getDecorationStream(slot).cursor--;
+    }
+  };
+
+  const auto firstEvent = nextEvent;
+  while (nextEvent > 0u) {
+    const auto previous = nextEvent - 1u;
+
     // All events have a time
     // Make sure we don't handle one
     // Before it was originally applied
-    if (simulationTime > arg.event.time)
-      return false;
+    const auto time = std::visit(
+        [](const auto &e) {
+          return e.time;
+        },
+        events[previous]);
+    if (simulationTime > time)
+      break;
+
+    // Skipped events have nothing to reverse
+    slot = streams.slot(previous);
+    if (slot != parser::EntityEventStreams::noSlot)
+      std::visit(handleUndoEvent, reverseEvent(previous, slot));
+
+    nextEvent = previous;
+  }
+  updateTouched();
+  profiler.countEvents(firstEvent - nextEvent);
+  frameCounters.eventsApplied += firstEvent - nextEvent;
+}
 
-    if constexpr (std::is_same_v<T, undo::MoveEvent> || std::is_same_v<T, undo::NodeOrientationChangeEvent> ||
-                  std::is_same_v<T, undo::TransmitEvent> || std::is_same_v<T, undo::TransmitEndEvent> ||
-                  std::is_same_v<T, undo::NodeColorChangeEvent>) {
-      auto node = nodes.find(arg.event.nodeId);
-      if (node == nodes.end())
-        return false;
-      node->second.handle(arg);
+undo::SceneUndoEvent SceneWidget::reverseEvent(std::size_t index, std::uint32_t slot) {
+  // The event this one replaced was linked when the events were indexed,
+  // without one, the value comes from the state before any events
+  const auto previousIndex = streams.previousOfKind(index);
+  const auto previous = previousIndex == parser::EntityEventStreams::noEvent ? nullptr : &events[previousIndex];
+  const auto &initial = keyframes.before(0u);
+
+  return std::visit(
+      [this, slot, previous, &initial](const auto &e) -> undo::SceneUndoEvent {
+        using T = std::decay_t<decltype(e)>;
+
+        if constexpr (std::is_same_v<T, parser::MoveEvent>) {
+          if (!previous)
+            return undo::MoveEvent{streams.getInitialPosition(slot)};
+
+          return undo::MoveEvent{std::get<T>(*previous).targetPosition};
+        } else if constexpr (std::is_same_v<T, parser::NodeOrientationChangeEvent>) {
+          if (!previous)
+            return undo::NodeOrientationChangeEvent{initial.nodes[slot].second.rotation};
+
+          // Matches the rotation set by `Node::handle()`
+          const auto &orientation = std::get<T>(*previous).targetOrientation;
+          return undo::NodeOrientationChangeEvent{{static_cast<float>(orientation[0]),
+                                                   static_cast<float>(orientation[2]),
+                                                   static_cast<float>(-orientation[1])}};
+        } else if constexpr (std::is_same_v<T, parser::NodeColorChangeEvent>) {
+          undo::NodeColorChangeEvent undo;
+          undo.type = e.type;
+          if (previous)
+            undo.originalColor = std::get<T>(*previous).targetColor;
+          else if (e.type == parser::NodeColorChangeEvent::ColorType::Base)
+            undo.originalColor = initial.nodes[slot].second.baseColor;
+          else
+            undo.originalColor = initial.nodes[slot].second.highlightColor;
+          return undo;
+        } else if constexpr (std::is_same_v<T, parser::TransmitEvent> || std::is_same_v<T, parser::TransmitEndEvent>) {
+          // A previous end leaves the defaults, not transmitting
+          undo::TransmitEvent undo;
+          if (!previous) {
+            const auto &info = initial.nodes[slot].second.transmitInfo;
+            undo.isTransmitting = info.isTransmitting;
+            undo.startTime = info.startTime;
+            undo.targetSize = info.targetSize;
+            undo.duration = info.duration;
+            undo.color = info.color;
+          } else if (const auto transmit = std::get_if<parser::TransmitEvent>(previous)) {
+            undo.isTransmitting = true;
+            undo.startTime = transmit->time;
+            undo.targetSize = transmit->targetSize;
+            undo.duration = transmit->duration;
+            undo.color = toRenderColor(transmit->color);
+          }
+          return undo;
+        } else if constexpr (std::is_same_v<T, parser::DecorationMoveEvent>) {
+          if (!previous)
+            return undo::DecorationMoveEvent{initial.decorations[slot].second.position};
+
+          return undo::DecorationMoveEvent{std::get<T>(*previous).targetPosition};
+        } else if constexpr (std::is_same_v<T, parser::DecorationOrientationChangeEvent>) {
+          if (!previous)
+            return undo::DecorationOrientationChangeEvent{initial.decorations[slot].second.rotation};
+
+          // Matches the rotation set by `Decoration::handle()`
+          const auto &orientation = std::get<T>(*previous).targetOrientation;
+          return undo::DecorationOrientationChangeEvent{{static_cast<float>(orientation[0]),
+                                                         static_cast<float>(orientation[2]),
+                                                         static_cast<float>(-orientation[1])}};
+        }
+      },
+      events[index]);
+}
 
-      events.emplace_front(arg.event);
-      return true;
-    }
+void SceneWidget::touchNode(std::uint32_t slot) {
+  if (slot >= isNodeTouched.size())
+    isNodeTouched.resize(nodeStore.size());
+  if (isNodeTouched[slot])
+    return;
 
-    if constexpr (std::is_same_v<T, undo::DecorationMoveEvent> ||
-                  std::is_same_v<T, undo::DecorationOrientationChangeEvent>) {
-      auto decoration = decorations.find(arg.event.decorationId);
-      if (decoration == decorations.end())
-        return false;
-      decoration->second.handle(arg);
+  isNodeTouched[slot] = true;
+  touchedNodes.emplace_back(slot);
+}
 
-      events.emplace_front(arg.event);
-      return true;
-    }
+void SceneWidget::touchDecoration(std::uint32_t slot) {
+  if (slot >= isDecorationTouched.size())
+    isDecorationTouched.resize(decorationSlots.size());
+  if (isDecorationTouched[slot])
+    return;
+
+  isDecorationTouched[slot] = true;
+  touchedDecorations.emplace_back(slot);
+}
+
+void SceneWidget::updateTouched() {
+  for (const auto slot : touchedNodes) {
+    nodeStore.update(slot);
+    updateMotion(slot);
+    nodeBvh.update(slot, nodeBounds(slot));
+    // Hidden Nodes may be stale, & would only pad the counts of the clusters
+    if (nodeStore.has(slot, NodeStore::Visible))
+      nodeGrid.update(slot, glm::vec3{nodeStore.getModelMatrix(slot)[3]});
+    updateTransmitting(slot);
+    isNodeTouched[slot] = false;
+  }
+  touchedNodes.clear();
 
+  for (const auto slot : touchedDecorations) {
+    decorationBvh.update(slot, decorationBounds(slot));
+    isDecorationTouched[slot] = false;
+  }
+  touchedDecorations.clear();
+}
+
+bool SceneWidget::isNodeDeferred(std::uint32_t slot) const {
+  if (renderHeatmap || renderMinimap || nodeStore.has(slot, NodeStore::Visible))
+    return false;
+
+  // Nothing to rebuild the Node from
+  if (keyframes.empty())
     return false;
+
+  const auto &node = nodeStore.getNode(slot);
+  return !node.hasWiredLinks() && (!selectedNode || node.getNs3Model().id != selectedNode.value());
+}
+
+void SceneWidget::markStale(std::uint32_t slot) {
+  if (slot >= isNodeStale.size())
+    isNodeStale.resize(nodeStore.size());
+  isNodeStale[slot] = true;
+}
+
+void SceneWidget::catchUpNode(std::uint32_t slot) {
+  if (slot >= isNodeStale.size() || !isNodeStale[slot])
+    return;
+  isNodeStale[slot] = false;
+
+  const auto &keyframe = keyframes.before(nextEvent);
+  auto &node = nodeStore.getNode(slot);
+  node.restore(keyframe.nodes[slot].second);
+  markTrailStale(slot);
+
+  // The Node's events applied since the keyframe
+  const auto &stream = streams.getNodeStream(slot);
+  const auto applied = stream.events.begin() + static_cast<std::ptrdiff_t>(stream.cursor);
+  for (auto i = std::lower_bound(stream.events.begin(), applied, keyframe.eventCount); i != applied; ++i) {
+    std::visit(
+        [&node](const auto &e) {
+          using T = std::decay_t<decltype(e)>;
+
+          if constexpr (std::is_same_v<T, parser::MoveEvent> || std::is_same_v<T, parser::NodeOrientationChangeEvent> ||
+                        std::is_same_v<T, parser::NodeColorChangeEvent> || std::is_same_v<T, parser::TransmitEvent> ||
+                        std::is_same_v<T, parser::TransmitEndEvent>)
+            node.handle(e);
+        },
+        events[*i]);
+  }
+
+  touchNode(slot);
+}
+
+void SceneWidget::catchUpNodes() {
+  for (std::uint32_t slot = 0u; slot < isNodeStale.size(); slot++)
+    catchUpNode(slot);
+  updateTouched();
+}
+
+void SceneWidget::updateMotion(std::uint32_t slot) {
+  NodeStore::Motion motion;
+
+  const auto waypoints = interpolateMotion ? streams.waypoints(slot) : parser::EntityEventStreams::Waypoints{};
+  if (waypoints.next) {
+    const auto &next = std::get<parser::MoveEvent>(events[waypoints.next.value()]);
+    const auto &node = nodeStore.getNode(slot);
+
+    motion.offset = node.renderPosition(next.targetPosition) - node.getModel().getPosition();
+    motion.start = waypoints.previous ? std::get<parser::MoveEvent>(events[waypoints.previous.value()]).time : 0LL;
+    motion.end = next.time;
+  }
+
+  nodeStore.setMotion(slot, motion);
+}
+
+void SceneWidget::updateMotions() {
+  for (std::uint32_t i = 0u; i < nodeStore.size(); i++) {
+    updateMotion(i);
+    nodeBvh.update(i, nodeBounds(i));
+  }
+}
+
+void SceneWidget::allocateTrail(std::uint32_t slot) {
+  nodeStore.getNode(slot).allocateTrail(trailPool);
+  fillTrail(slot);
+}
+
+void SceneWidget::fillTrail(std::uint32_t slot) {
+  auto &node = nodeStore.getNode(slot);
+  node.clearTrail();
+
+  const auto &moves = streams.getNodeStream(slot).moves;
+  const auto applied = streams.appliedMoves(slot);
+  if (applied == 0u)
+    return;
+
+  // Enough moves to fill the trail, starting from where the Node was before the first of them
+  const auto first = applied - std::min(applied, static_cast<std::size_t>(trailPool.getTrailLength()));
+  node.appendTrail(node.renderPosition(first > 0u ? std::get<parser::MoveEvent>(events[moves[first - 1u]]).targetPosition
+                                                  : streams.getInitialPosition(slot)));
+  for (auto i = first; i < applied; i++)
+    node.appendTrail(node.renderPosition(std::get<parser::MoveEvent>(events[moves[i]]).targetPosition));
+}
+
+void SceneWidget::markTrailStale(std::uint32_t slot) {
+  if (!nodeStore.getNode(slot).getTrailBuffer().allocated())
+    return;
+
+  if (slot >= isTrailStale.size())
+    isTrailStale.resize(nodeStore.size());
+  if (isTrailStale[slot])
+    return;
+
+  isTrailStale[slot] = true;
+  staleTrails.emplace_back(slot);
+}
+
+void SceneWidget::rebuildStaleTrails() {
+  if (staleTrails.empty())
+    return;
+
+  parser::trace::Scope trace{"SceneWidget::rebuildStaleTrails", "frame"};
+  const auto fill = [this](std::size_t i) {
+    fillTrail(staleTrails[i]);
   };
 
-  while (!undoEvents.empty() && std::visit(handleUndoEvent, undoEvents.back())) {
-    undoEvents.pop_back();
+  // A spilled page is read back by the first read of it, which only one thread may do
+  constexpr std::size_t parallelTrails = 64u;
+  if (staleTrails.size() >= parallelTrails && events.resident()) {
+    parser::TaskPool::shared().parallelFor(staleTrails.size(), 0u, parser::TaskPool::Priority::Interactive, fill);
+  } else {
+    for (std::size_t i = 0u; i < staleTrails.size(); i++)
+      fill(i);
+  }
+
+  for (const auto slot : staleTrails)
+    isTrailStale[slot] = false;
+  staleTrails.clear();
+}
+
+void SceneWidget::flushTrails() {
+  using MotionTrailRenderMode = SettingsManager::MotionTrailRenderMode;
+  if (reducedQuality || (trailWindow > 0LL && renderMotionTrails != MotionTrailRenderMode::Never))
+    return;
+  if (renderMotionTrails == MotionTrailRenderMode::Never && trailPool.used() == 0)
+    return;
+
+  rebuildStaleTrails();
+  for (std::size_t i = 0u; i < nodeStore.size(); i++) {
+    auto &node = nodeStore.getNode(i);
+    const auto shown =
+        renderMotionTrails == MotionTrailRenderMode::Always ||
+        (renderMotionTrails != MotionTrailRenderMode::Never && nodeStore.has(i, NodeStore::TrailEnabled));
+
+    // Trails turned off give their storage back, & are rebuilt if turned on again
+    if (!shown) {
+      if (node.getTrailBuffer().allocated())
+        node.releaseTrail();
+      continue;
+    }
+
+    if (!nodeStore.has(i, NodeStore::Visible) || (renderClusters && nodeGrid.isCollapsed(i)))
+      continue;
+
+    if (!node.getTrailBuffer().allocated())
+      allocateTrail(static_cast<std::uint32_t>(i));
+
+    // Only trails which are drawn are uploaded
+    node.flushTrail();
   }
 }
 
+void SceneWidget::resetTrajectories() {
+  trajectories.reset(trailWindow > 0LL ? nodeStore.size() : 0u);
+  if (trailWindow == 0LL)
+    return;
+
+  for (std::uint32_t i = 0u; i < nodeStore.size(); i++)
+    trajectories.append(i, nodeStore.getNode(i).renderPosition(streams.getInitialPosition(i)), 0.0f);
+}
+
+void SceneWidget::extendTrajectory(std::uint32_t slot, const parser::SceneEvent &event) {
+  const auto move = std::get_if<parser::MoveEvent>(&event);
+  if (!move || slot == parser::EntityEventStreams::noSlot)
+    return;
+
+  const auto time = static_cast<double>(move->time) / static_cast<double>(MILLISECOND);
+  trajectories.append(slot, nodeStore.getNode(slot).renderPosition(move->targetPosition), static_cast<float>(time));
+}
+
+parser::nanoseconds SceneWidget::advancePlayback() {
+  motionLead = 0LL;
+  if (playMode != PlayMode::Play || previewOrigin || replayPath)
+    return 0LL;
+
+  const auto stepPeriod = 1'000'000'000LL / stepsPerSecond;
+  const auto elapsed = playbackTimer.nsecsElapsed();
+  auto due = elapsed / stepPeriod - playedSteps;
+
+  // Likely a stall (a modal dialog, or a long load), rather than a slow frame
+  const auto skipped = due > maxCatchUpSteps;
+  if (skipped) {
+    playedSteps += due - maxCatchUpSteps;
+    due = maxCatchUpSteps;
+  }
+  playedSteps += due;
+
+  // Hold the clock until the events already due are applied.
+  // The steps are still used up, so playback does not race to catch up afterwards
+  if (due > 0LL || eventsPending)
+    setBehind(eventsPending || skipped);
+  if (eventsPending)
+    return 0LL;
+
+  const auto previous = simulationTime;
+  simulationTime += (reverse ? -timeStep : timeStep) * due;
+  const auto jumped = due > 0LL && skipIdleTime();
+
+  // Wait for the rest of the scenario to load, rather than playing past it
+  if (loadedTime && simulationTime >= loadedTime.value()) {
+    simulationTime = loadedTime.value();
+    return simulationTime - previous;
+  }
+
+  // A jump lands on the event, rather than partway into the step after it
+  if (jumped)
+    return simulationTime - previous;
+
+  // In floating point, since a long time step by the step period may overflow
+  const auto intoStep = std::clamp(elapsed - playedSteps * stepPeriod, 0LL, stepPeriod);
+  motionLead = static_cast<parser::nanoseconds>(static_cast<double>(reverse ? -timeStep : timeStep) *
+                                                static_cast<double>(intoStep) / static_cast<double>(stepPeriod));
+  return simulationTime - previous;
+}
+
+bool SceneWidget::skipIdleTime() {
+  if (!skipIdle || reverse || !transmittingNodes.empty())
+    return false;
+
+  std::optional<parser::nanoseconds> next;
+  if (nextEvent < events.size()) {
+    next = std::visit(
+        [](const auto &e) {
+          return e.time;
+        },
+        events[nextEvent]);
+  }
+
+  if (idleLookup) {
+    const auto other = idleLookup();
+    if (other && (!next || other.value() < next.value()))
+      next = other;
+  }
+
+  // Also stops at the end of what has loaded so far, where more events may appear
+  if (loadedTime && (!next || loadedTime.value() < next.value()))
+    next = loadedTime;
+
+  if (!next || next.value() - simulationTime <= timeStep * stepsPerSecond)
+    return false;
+
+  const auto amount = next.value() - simulationTime;
+  simulationTime = next.value();
+  emit idleSkipped(amount);
+  return true;
+}
+
+void SceneWidget::setBehind(bool value) {
+  if (behind == value)
+    return;
+
+  behind = value;
+  emit playbackBehind(behind);
+}
+
+std::size_t SceneWidget::firstEventAfter(parser::nanoseconds time) const {
+  return events.upperBound(time);
+}
+
+void SceneWidget::seek() {
+  if (keyframes.empty()) {
+    if (firstEventAfter(simulationTime) >= nextEvent)
+      handleEvents();
+    else
+      handleUndoEvents();
+    return;
+  }
+
+  const auto target = firstEventAfter(simulationTime);
+  const auto &keyframe = keyframes.before(target);
+
+  // Forwards, and the keyframe would not skip any events
+  if (target >= nextEvent && keyframe.eventCount <= nextEvent) {
+    handleEvents();
+    return;
+  }
+
+  // Backwards, and close enough to reverse each event
+  if (target < nextEvent && nextEvent - target <= keyframes.getInterval()) {
+    handleUndoEvents();
+    return;
+  }
+
+  restore(keyframe);
+  handleEvents();
+}
+
+void SceneWidget::restore(const KeyframeIndex::Keyframe &keyframe) {
+  for (const auto &[id, state] : keyframe.nodes) {
+    auto node = nodes.find(id);
+    if (node != nodes.end())
+      node->second.restore(state);
+  }
+
+  for (const auto &[id, state] : keyframe.decorations) {
+    auto decoration = decorations.find(id);
+    if (decoration != decorations.end())
+      decoration->second.restore(state);
+  }
+
+  nodeStore.updateAll();
+  for (std::size_t i = 0u; i < nodeStore.size(); i++) {
+    updateMotion(static_cast<std::uint32_t>(i));
+    nodeBvh.update(i, nodeBounds(i));
+    updateTransmitting(static_cast<std::uint32_t>(i));
+    // Restoring starts the trail over, so fill it from the moves before the keyframe
+    markTrailStale(static_cast<std::uint32_t>(i));
+  }
+  updateNodeGrid();
+  for (std::size_t i = 0u; i < decorationSlots.size(); i++)
+    decorationBvh.update(i, decorationBounds(i));
+
+  nextEvent = keyframe.eventCount;
+  streams.seek(keyframe.eventCount);
+  isNodeStale.clear();
+
+  if (selectedNode)
+    emit selectedItemUpdated();
+}
+
+BoundingVolumeHierarchy::Box SceneWidget::nodeBounds(std::size_t index) const {
+  const auto &bounds = nodeStore.getBounds(index);
+  auto box = BoundingVolumeHierarchy::Box{bounds.min, bounds.max}.transformed(nodeStore.getModelMatrix(index));
+
+  const auto &motion = nodeStore.getMotion(index);
+  if (motion.end > motion.start)
+    box.expand({box.min + motion.offset, box.max + motion.offset});
+  return box;
+}
+
+BoundingVolumeHierarchy::Box SceneWidget::decorationBounds(std::size_t slot) const {
+  const auto &model = decorationSlots[slot]->getModel();
+  const auto bounds = model.getBounds();
+  return BoundingVolumeHierarchy::Box{bounds.min, bounds.max}.transformed(model.getModelMatrix());
+}
+
+void SceneWidget::updateStaticDecorations() {
+  for (std::size_t slot = 0u; slot < isDecorationStatic.size(); slot++) {
+    if (!isDecorationStatic[slot] || streams.getDecorationStream(slot).events.empty())
+      continue;
+
+    isDecorationStatic[slot] = false;
+    decorationBatchDirty = true;
+  }
+}
+
+void SceneWidget::rebuildDecorationBatch() {
+  decorationBatchDirty = false;
+  decorationBatch.reset();
+
+  auto batch = std::make_unique<DecorationBatch>();
+  for (std::size_t slot = 0u; slot < decorationSlots.size(); slot++) {
+    if (isDecorationStatic[slot])
+      batch->add(decorationSlots[slot]->getModel(), decorationBounds(slot));
+  }
+
+  if (batch->empty())
+    return;
+
+  batch->build(models);
+  renderer.allocate(*batch);
+  decorationBatch = std::move(batch);
+}
+
+void SceneWidget::cull(const Camera &view) {
+  const Frustum frustum{projection * view.view_matrix()};
+
+  nodeBvh.refit();
+  nodeBvh.cull(frustum, visibleNodes);
+  visibleNodes.erase(std::remove_if(visibleNodes.begin(), visibleNodes.end(),
+                                    [this](std::uint32_t index) {
+                                      return !nodeStore.has(index, NodeStore::Visible);
+                                    }),
+                     visibleNodes.end());
+
+  // Keep the draw order stable between frames
+  std::sort(visibleNodes.begin(), visibleNodes.end());
+
+  decorationBvh.refit();
+  decorationBvh.cull(frustum, visibleDecorations);
+  visibleDecorations.erase(std::remove_if(visibleDecorations.begin(), visibleDecorations.end(),
+                                          [this](std::uint32_t slot) {
+                                            return isDecorationStatic[slot];
+                                          }),
+                           visibleDecorations.end());
+  std::sort(visibleDecorations.begin(), visibleDecorations.end());
+
+  // Only whole groups are culled, so they stay one draw per mesh
+  visibleDecorationGroups.clear();
+  if (decorationBatch) {
+    const auto &groups = decorationBatch->getGroups();
+    for (std::size_t i = 0u; i < groups.size(); i++) {
+      if (frustum.intersects(groups[i].bounds.min, groups[i].bounds.max))
+        visibleDecorationGroups.emplace_back(static_cast<std::uint32_t>(i));
+    }
+  }
+
+  // Buildings do not move, so there is nothing to refit
+  buildingBvh.cull(frustum, visibleBuildings);
+  visibleBuildings.erase(std::remove_if(visibleBuildings.begin(), visibleBuildings.end(),
+                                        [this](std::uint32_t index) {
+                                          return !buildings[index].visible();
+                                        }),
+                         visibleBuildings.end());
+  std::sort(visibleBuildings.begin(), visibleBuildings.end());
+  if (staticTiles) {
+    staticTiles->stream(view.get_position(), renderer);
+    staticTiles->select(visibleBuildings);
+  }
+
+  // Transmissions grow past the bounds of their Node,
+  // so test each active one on its own
+  visibleTransmissions.clear();
+  for (const auto i : transmittingNodes) {
+    if (!nodeStore.has(i, NodeStore::Visible))
+      continue;
+
+    const auto &transmit = nodeStore.getNode(i).getTransmitInfo();
+    if (!transmit.isTransmitting || transmit.startTime > simulationTime ||
+        transmit.startTime + transmit.duration < simulationTime)
+      continue;
+
+    const auto &position = nodeStore.getPosition(i);
+    const glm::vec3 size{static_cast<float>(transmit.targetSize)};
+    if (frustum.intersects(position - size, position + size))
+      visibleTransmissions.emplace_back(i);
+  }
+
+  // The set has no order, sort so an unchanged set matches `uploadedTransmissions`
+  std::sort(visibleTransmissions.begin(), visibleTransmissions.end());
+}
+
+void SceneWidget::updateTransmitting(std::uint32_t index) {
+  if (nodeStore.getNode(index).getTransmitInfo().isTransmitting) {
+    // Also a move of a transmitting Node, which moves its sphere
+    transmittingNodes.insert(index);
+    transmissionsChanged = true;
+  } else if (transmittingNodes.erase(index) > 0u) {
+    transmissionsChanged = true;
+  }
+}
+
+void SceneWidget::pick(int x, int y) {
+  profiler.begin(FrameProfiler::Stage::Picking);
+
+  // Stretch the region around the click over the whole picking framebuffer,
+  // so its pixels match the widget's, whatever the widget's size
+  const auto pickProjection =
+      glm::pickMatrix(glm::vec2{x, y}, glm::vec2{pickRegion}, glm::ivec4{0, 0, mainViewWidth(), height()}) *
+      projection;
+
+  // Of the Nodes drawn this frame, only those in the region
+  nodeBvh.cull(Frustum{pickProjection * camera.view_matrix()}, pickCandidates);
+  pickCandidates.erase(std::remove_if(pickCandidates.begin(), pickCandidates.end(),
+                                      [this](std::uint32_t index) {
+                                        return !std::binary_search(visibleNodes.begin(), visibleNodes.end(), index);
+                                      }),
+                       pickCandidates.end());
+
+  std::array<GLint, 4> viewport{};
+  glGetIntegerv(GL_VIEWPORT, viewport.data());
+
+  pickingFbo->bind(GL_FRAMEBUFFER);
+  glViewport(0, 0, pickRegion, pickRegion);
+  glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+  glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+  renderer.setPerspective(pickProjection);
+  renderer.renderPickingNodes(nodeStore, pickCandidates);
+  renderer.setPerspective(projection);
+
+  // The clicked pixel is at the center of the region
+  pickingFbo->readAsync(pickRegion / 2, pickRegion / 2);
+  pickingFbo->unbind(GL_FRAMEBUFFER, defaultFramebufferObject());
+  glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+  profiler.end(FrameProfiler::Stage::Picking);
+}
+
+void SceneWidget::finishPick(const PickingFramebuffer::PixelInfo &pixel) {
+  if (pixel.object && pixel.type == 1u) {
+    emit nodeSelected(pixel.id);
+    selectedNode = pixel.id;
+    update();
+    return;
+  }
+
+  // The button may have been let go while the pick was read
+  if (QGuiApplication::mouseButtons() & Qt::LeftButton)
+    startMouseMove(pickedClick);
+}
+
+void SceneWidget::startMouseMove(const QPoint &position) {
+  if (!camera.mouseControlsEnabled())
+    return;
+
+  mousePressed = true;
+  setCursor(Qt::BlankCursor);
+
+  // Keep this position since we're about to move it
+  initialCursorPosition = position;
+
+  isInitialMove = true;
+  QCursor::setPos(mapToGlobal({width() / 2, height() / 2}));
+  camera.setMobility(Camera::move_state::mobile);
+}
+
+std::optional<unsigned int> SceneWidget::pickCpu(int x, int y) {
+  profiler.begin(FrameProfiler::Stage::Picking);
+
+  // Cast from the near plane through the far plane under the cursor
+  const auto inverse = glm::inverse(projection * camera.view_matrix());
+  const auto ndcX = 2.0f * static_cast<float>(x) / static_cast<float>(mainViewWidth()) - 1.0f;
+  const auto ndcY = 1.0f - 2.0f * static_cast<float>(y) / static_cast<float>(height());
+
+  auto nearPoint = inverse * glm::vec4{ndcX, ndcY, -1.0f, 1.0f};
+  auto farPoint = inverse * glm::vec4{ndcX, ndcY, 1.0f, 1.0f};
+  nearPoint /= nearPoint.w;
+  farPoint /= farPoint.w;
+
+  nodeBvh.refit();
+  const auto hit = nodeBvh.pick(glm::vec3{nearPoint}, glm::normalize(glm::vec3{farPoint - nearPoint}),
+                                [this](std::size_t index) {
+                                  return nodeStore.has(index, NodeStore::Visible);
+                                });
+  profiler.end(FrameProfiler::Stage::Picking);
+
+  if (!hit)
+    return {};
+  return nodeStore.getId(hit.value());
+}
+
 void SceneWidget::initializeGL() {
   if (!initializeOpenGLFunctions()) {
     std::cerr << "Failed OpenGL functions\n";
@@ -172,6 +1005,19 @@ void SceneWidget::initializeGL() {
   if (!openGl.initializeOpenGLFunctions())
     std::cerr << "Failed to initialize passable OpenGL functions!\n";
   std::cout << glGetString(GL_VERSION) << ' ' << openGl.glGetString(GL_VERSION) << '\n';
+  glState.init();
+  uploadRing.init();
+  trailPool.init(&openGl);
+  trajectories.init(&openGl);
+  occlusionQueries.init();
+
+  // Reported once the scene is ready to draw
+  QElapsedTimer phaseTimer;
+  phaseTimer.start();
+  std::string startupTimes;
+  const auto endPhase = [&phaseTimer, &startupTimes](const char *name) {
+    startupTimes += std::string{' '} + name + ' ' + std::to_string(phaseTimer.restart()) + "ms";
+  };
 
 #ifndef NDEBUG
   const auto hasKhrDebug = context()->hasExtension(QByteArrayLiteral("GL_KHR_debug"));
@@ -183,25 +1029,32 @@ void SceneWidget::initializeGL() {
     std::clog << "Failed to initialize OpenGL debug log\n";
 #endif
 
+  endPhase("context");
+
   if (!textures.init()) {
     std::cerr << "Failed Initializing Texture Cache\n";
     std::abort();
   }
+  endPhase("textures");
 
   models.init("models/fallback.obj");
+  endPhase("models");
   fontManager.init(":/texture/resources/textures/undefined-medium.png");
+  endPhase("font");
   renderer.init();
-
-  transmissionSphere = std::make_unique<Model>(models.load("models/transmission_sphere.obj"));
-
-  TextureCache::CubeMap cubeMap;
-  cubeMap.right = QImage{":/texture/resources/textures/skybox/right.png"};
-  cubeMap.left = QImage{":/texture/resources/textures/skybox/left.png"};
-  cubeMap.top = QImage{":/texture/resources/textures/skybox/top.png"};
-  cubeMap.bottom = QImage{":/texture/resources/textures/skybox/bottom.png"};
-  cubeMap.back = QImage{":/texture/resources/textures/skybox/back.png"};
-  cubeMap.front = QImage{":/texture/resources/textures/skybox/front.png"};
-  skyBox = std::make_unique<SkyBox>(textures.load(cubeMap));
+  endPhase("shaders");
+  std::cout << "Model draws: "
+            << (renderer.getBackend() == Renderer::Backend::Indirect43 ? "indirect (GL 4.3)" : "direct (GL 3.3)")
+            << '\n';
+  profiler.init();
+  resolutionScaler.init();
+
+  transmissionSphere = std::make_unique<Model>(models.load("models/transmission_sphere.obj", true));
+  clusterMarker = std::make_unique<Model>(models.load("models/transmission_sphere.obj", true));
+  clusterMarker->setBaseColor({0.15f, 0.45f, 0.85f});
+  const auto markerBounds = clusterMarker->getBounds();
+  clusterMarkerHeight = std::max(markerBounds.max.y - markerBounds.min.y, 0.001f);
+  endPhase("transmission");
 
   floor = std::make_unique<Floor>(renderer.allocateFloor(100.0f));
   floor->setPosition({0.0f, -0.5f, 0.0f});
@@ -210,6 +1063,9 @@ void SceneWidget::initializeGL() {
       renderer.allocateCoordinateGrid(100.0f, settings.get<int>(SettingsManager::Key::RenderGridStep).value()));
   coordinateGrid->setHeight(-0.1f);
 
+  // Straight down, with -Z at the top of the view
+  overviewCamera.setRotation(-90.0f, -89.0f);
+
   auto s = size();
   glViewport(0, 0, s.width(), s.height());
 
@@ -220,205 +1076,901 @@ void SceneWidget::initializeGL() {
   renderer.render(mainLight);
 
   glClearColor(1.0f, 1.0f, 1.0f, 1.0f);
-  glEnable(GL_DEPTH_TEST);
+  glState.enable(GL_DEPTH_TEST);
 
   updatePerspective();
 
   // picking FBO
-  pickingFbo = std::make_unique<PickingFramebuffer>(openGl, width(), height());
+  pickingFbo = std::make_unique<PickingFramebuffer>(openGl, pickRegion, pickRegion);
+  heatmapFbo = std::make_unique<HeatmapFramebuffer>(openGl, heatmapSize);
   pickingFbo->unbind(GL_FRAMEBUFFER, defaultFramebufferObject());
-
-  // Cheap hack to get Qt to repaint at a reasonable rate
-  // Seems to only work with the old connect syntax
-  QObject::connect(&timer, SIGNAL(timeout()), this, SLOT(update()));
-  timer.start(1000 / 60); // roughly 60 times per second
+  endPhase("scene");
+  std::cout << "Startup:" << startupTimes << '\n';
+
+  // Each frame asks for the next, see `scheduleFrame()`
+  timer.setSingleShot(true);
+  timer.setTimerType(Qt::PreciseTimer);
+  QObject::connect(&timer, &QTimer::timeout, this, [this]() {
+    update();
+  });
+  QObject::connect(this, &QOpenGLWidget::frameSwapped, this, &SceneWidget::scheduleFrame);
 
   frameTimer.start();
+  paceTimer.start();
+  updateTimer();
+
+  // Unless a scenario is opened first
+  if (settings.get<bool>(SettingsManager::Key::ResourcePrewarm).value()) {
+    prewarmTimer.setSingleShot(true);
+    QObject::connect(&prewarmTimer, &QTimer::timeout, this, [this]() {
+      const auto queued = prewarmer.start(models);
+      if (queued > 0u)
+        std::cout << "Prewarming " << queued << " recent assets\n";
+    });
+    prewarmTimer.start(prewarmDelay);
+  }
+
+  // Once the widget is shown, so the probe is not part of the startup times
+  if (PerformanceProbe::isPending(settings))
+    QTimer::singleShot(0, this, &SceneWidget::probePerformance);
+}
+
+void SceneWidget::updateNodeGrid() {
+  nodeGrid.clear();
+  for (std::size_t i = 0u; i < nodeStore.size(); i++) {
+    if (nodeStore.has(i, NodeStore::Visible))
+      nodeGrid.update(i, glm::vec3{nodeStore.getModelMatrix(i)[3]});
+  }
+}
+
+void SceneWidget::collapseClusters(const Camera &view) {
+  const auto pixelsPerUnit = projection[1][1] * static_cast<float>(height() * devicePixelRatioF()) * 0.5f;
+  nodeGrid.collapse(view.get_position(), pixelsPerUnit, clusterPixels, clusters);
+
+  // The selected Node is always drawn, so it may be followed
+  const auto selectedSlot =
+      selectedNode ? std::optional<std::size_t>{streams.nodeSlot(selectedNode.value())} : std::nullopt;
+  visibleNodes.erase(std::remove_if(visibleNodes.begin(), visibleNodes.end(),
+                                    [this, &selectedSlot](std::uint32_t index) {
+                                      return index != selectedSlot && nodeGrid.isCollapsed(index);
+                                    }),
+                     visibleNodes.end());
+}
+
+void SceneWidget::renderStatic(StaticGeometry::Pass pass, bool culled, const std::optional<glm::vec3> &color) {
+  if (staticTiles)
+    renderer.render(*staticTiles, pass, culled, color);
+  else if (staticGeometry && culled)
+    renderer.render(*staticGeometry, pass, visibleBuildings, color);
+  else if (staticGeometry)
+    renderer.render(*staticGeometry, pass);
+}
+
+void SceneWidget::gatherLights() {
+  sceneLights.clear();
+  for (const auto i : litNodes) {
+    if (!nodeStore.has(i, NodeStore::Visible))
+      continue;
+
+    const auto &light = nodeStore.getNode(i).getNs3Model().light.value();
+
+    // The model matrix is also scaled to the size of the model, so only its rotation turns the light
+    const auto &model = nodeStore.getModelMatrix(i);
+    const glm::mat3 rotation{glm::normalize(glm::vec3{model[0]}), glm::normalize(glm::vec3{model[1]}),
+                             glm::normalize(glm::vec3{model[2]})};
+
+    auto &value = sceneLights.emplace_back();
+    value.position = nodeStore.getPosition(i) + nodeStore.motionOffset(i, simulationTime + motionLead) +
+                     rotation * toRenderCoordinate(light.offset);
+    value.range = light.range;
+    value.color = toRenderColor(light.color);
+    value.intensity = light.intensity;
+
+    const auto direction = rotation * toRenderCoordinate(light.direction);
+    if (light.cone < 180.0f && glm::length(direction) > 0.0f) {
+      value.direction = glm::normalize(direction);
+      value.edge = std::cos(glm::radians(light.cone));
+    }
+  }
+}
+
+void SceneWidget::cullOccluded(const Camera &view) {
+  occlusionTests.clear();
+  if (!occlusionCulling || splitView || buildingRenderMode != SettingsManager::BuildingRenderMode::Opaque ||
+      visibleBuildings.empty())
+    return;
+
+  occlusionQueries.collect();
+
+  // The near plane may clip the front of a box the camera is this close to, so those are never tested
+  constexpr auto nearMargin = 0.5f;
+  const auto eye = view.get_position();
+  for (const auto i : visibleNodes) {
+    auto box = nodeBounds(i);
+
+    // A transmission may be seen over the Buildings when its Node is not
+    if (std::binary_search(visibleTransmissions.begin(), visibleTransmissions.end(), i)) {
+      const auto &position = nodeStore.getPosition(i);
+      const glm::vec3 size{static_cast<float>(nodeStore.getNode(i).getTransmitInfo().targetSize)};
+      box.expand({position - size, position + size});
+    }
+
+    if (glm::all(glm::greaterThan(eye, box.min - nearMargin)) && glm::all(glm::lessThan(eye, box.max + nearMargin)))
+      continue;
+
+    occlusionTests.push_back({i, box.min, box.max});
+  }
+
+  const auto hidden = [this](std::uint32_t slot) {
+    const auto tested = std::lower_bound(occlusionTests.begin(), occlusionTests.end(), slot,
+                                         [](const OcclusionQueries::Test &test, std::uint32_t value) {
+                                           return test.slot < value;
+                                         });
+    return tested != occlusionTests.end() && tested->slot == slot && occlusionQueries.hidden(slot);
+  };
+  visibleNodes.erase(std::remove_if(visibleNodes.begin(), visibleNodes.end(), hidden), visibleNodes.end());
+  visibleTransmissions.erase(std::remove_if(visibleTransmissions.begin(), visibleTransmissions.end(), hidden),
+                             visibleTransmissions.end());
+}
+
+void SceneWidget::loadSkyBox() {
+  TextureCache::CubeMap cubeMap;
+  cubeMap.right = QImage{":/texture/resources/textures/skybox/right.png"};
+  cubeMap.left = QImage{":/texture/resources/textures/skybox/left.png"};
+  cubeMap.top = QImage{":/texture/resources/textures/skybox/top.png"};
+  cubeMap.bottom = QImage{":/texture/resources/textures/skybox/bottom.png"};
+  cubeMap.back = QImage{":/texture/resources/textures/skybox/back.png"};
+  cubeMap.front = QImage{":/texture/resources/textures/skybox/front.png"};
+  skyBox = std::make_unique<SkyBox>(textures.load(cubeMap));
+}
+
+void SceneWidget::updateTimer() {
+  const auto animate = playMode == PlayMode::Play || camera.isMoving();
+
+  if (animate && !animating) {
+    // Don't count the idle time as camera movement
+    frameTimer.restart();
+    animating = true;
+    update();
+  } else if (!animate && animating) {
+    animating = false;
+    timer.stop();
+    // Draw where the camera stopped
+    update();
+  }
+}
+
+void SceneWidget::scheduleFrame() {
+  if (!animating)
+    return;
+
+  if (frameCap <= 0) {
+    update();
+    return;
+  }
+
+  const auto remaining = 1'000'000'000LL / frameCap - paceTimer.nsecsElapsed();
+  if (remaining <= 0LL)
+    update();
+  else
+    timer.start(static_cast<int>((remaining + 999'999LL) / 1'000'000LL));
 }
 
 void SceneWidget::paintGL() {
-  if (playMode == PlayMode::Play) {
-    if (timeStep > 0LL)
-      handleEvents();
+  parser::trace::Scope trace{"SceneWidget::paintGL", "frame"};
+  paceTimer.restart();
+  using Stage = FrameProfiler::Stage;
+  profiler.beginFrame();
+
+  // Qt may have used the context since the last frame
+  glState.invalidate();
+
+  // Each replayed frame is drawn at its own point along the path, however long the last one took
+  if (replayPath)
+    applyReplayFrame();
+
+  // Not until every tile shows the last frame, so the wall never tears between tiles
+  if (wallSync.isLeading())
+    wallSync.awaitNodes();
+
+  profiler.begin(Stage::Events);
+  // Every event up to the new time is applied at once, however many steps were due
+  const auto advanced = advancePlayback();
+  if (advanced > 0LL || eventsPending)
+    handleEvents(true);
+  else if (advanced < 0LL)
+    handleUndoEvents();
+
+  if (advanced != 0LL)
+    rewinding = advanced < 0LL;
+  events.trim(nextEvent, rewinding);
+  profiler.end(Stage::Events);
+
+  // Finish the events left over, even if playback pauses meanwhile
+  if (eventsPending)
+    update();
+
+  // Models & images are read in the background, so keep drawing until they're all uploaded
+  if (const auto loaded = models.poll(); !loaded.empty()) {
+    swapModels(loaded);
+    enforceMemoryBudget();
+  }
+  if (decorationBatchDirty)
+    rebuildDecorationBatch();
+  if (models.loading())
+    update();
+
+  if (textures.stream()) {
+    update();
+  } else if (packTexturesPending) {
+    textures.pack();
+    packTexturesPending = false;
+  }
+
+  // Picking is rendered on demand, see `pick()`
+
+  if (!replayPath)
+    camera.move(static_cast<float>(frameTimer.nsecsElapsed()) / 1'000'000.0f);
+
+  reducedQuality = adaptiveQuality && (camera.isMoving() || mousePressed || previewOrigin.has_value());
+  if (splitView)
+    renderSplitView();
+  else if (dynamicResolution || (reducedQuality && adaptiveScale < 1.0f))
+    renderScaledScene();
+  else
+    renderScene(camera);
+  frameTimer.restart();
+
+  // The motion may have stopped without asking for a frame, so ask for one to draw in full
+  if (reducedQuality) {
+    reducedQuality = false;
+    update();
+  }
+
+  // The pick from an earlier frame, if the read is done
+  if (pickingFbo->isPending()) {
+    if (const auto pixel = pickingFbo->poll())
+      finishPick(pixel.value());
     else
-      handleUndoEvents();
+      update();
   }
 
-  // Picking
-  pickingFbo->bind(GL_FRAMEBUFFER);
-  glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
-  glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+  // After the scene, so this frame's culling is used
+  if (queuedClick && !pickingFbo->isPending()) {
+    // OpenGL starts from the bottom left,
+    // Qt Starts at the top left,
+    // so adjust the Y coordinate accordingly
+    pickedClick = queuedClick.value();
+    queuedClick.reset();
+    pick(pickedClick.x(), height() - pickedClick.y());
+
+    // Check on the read next frame
+    update();
+  }
 
-  for (auto &[key, node] : nodes) {
-    if (!node.visible())
-      continue;
-    renderer.renderPickingNode(node.getNs3Model().id, node.getModel());
+  // Back to the whole widget, after picking used the main view
+  if (splitView)
+    glViewport(0, 0, static_cast<int>(width() * devicePixelRatioF()), static_cast<int>(height() * devicePixelRatioF()));
+
+  if (renderMinimap)
+    drawMinimap();
+
+  profiler.endFrame();
+  if (profiler.isEnabled())
+    paintProfiler();
+
+  const std::chrono::nanoseconds frameTime{paceTimer.nsecsElapsed()};
+  frameCounters.frames++;
+  frameCounters.frameTime += frameTime;
+  frameCounters.longestFrame = std::max(frameCounters.longestFrame, frameTime);
+
+  // Without the profiler's overlay, which is only drawn to this window
+  streamFrame();
+  uploadRing.endFrame();
+
+  if (wallSync.isLeading()) {
+    wallSync.broadcast({0u, simulationTime, camera.get_position(), camera.getYaw(), camera.getPitch(),
+                        camera.getFieldOfView()});
+  }
+
+  if (recordedPath) {
+    recordedPath->add({recordTimer.nsecsElapsed(), camera.get_position(), camera.getYaw(), camera.getPitch(),
+                       simulationTime, playMode == PlayMode::Play});
+  }
+  if (replayPath)
+    advanceReplay();
+
+  if (playMode == PlayMode::Paused)
+    return;
+
+  // Once per frame, after all of its steps, so the charts & log see the time drawn
+  if (advanced != 0LL)
+    emit timeChanged(simulationTime, advanced);
+
+  // The end may still move while loading, so keep playing
+  const auto step = reverse ? -timeStep : timeStep;
+  const auto pastEnd = step > 0LL && simulationTime >= config.endTime && !loadedTime;
+  const auto pastBeginning = step < 0LL && simulationTime < 0LL;
+  if ((pastEnd || pastBeginning) && playMode == PlayMode::Play) {
+    pause();
+
+    // Correct times so they match up with the end/beginning
+    // Useful if the increment does not match up with
+    // the end time
+    if (pastEnd)
+      setTime(config.endTime);
+    else
+      setTime(0LL);
   }
+}
 
+QSize SceneWidget::scaledSize() const {
+  const auto motionScale = reducedQuality ? adaptiveScale : 1.0f;
+  const auto scale = static_cast<double>(resolutionScaler.getScale() * motionScale) * devicePixelRatioF();
+  return {std::max(1, static_cast<int>(width() * scale)), std::max(1, static_cast<int>(height() * scale))};
+}
+
+void SceneWidget::renderScaledScene() {
+  // Set by Qt for the widget's framebuffer
+  std::array<GLint, 4> viewport{};
+  glGetIntegerv(GL_VIEWPORT, viewport.data());
+
+  const auto size = scaledSize();
+  if (!sceneFbo)
+    sceneFbo = std::make_unique<SceneFramebuffer>(openGl, size.width(), size.height(), format().samples());
+
+  // `adaptiveScale` comes & goes between frames
+  sceneFbo->resize(size.width(), size.height());
+
+  sceneFbo->bind();
+  glViewport(0, 0, sceneFbo->getWidth(), sceneFbo->getHeight());
+
+  // Only measured for `dynamicResolution`, which may draw this way without it
+  if (dynamicResolution)
+    resolutionScaler.begin();
+  renderScene(camera);
+  if (dynamicResolution)
+    resolutionScaler.end();
+
+  sceneFbo->resolve();
   glBindFramebuffer(GL_FRAMEBUFFER, defaultFramebufferObject());
-  // end Picking
+  glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+  renderer.upscale(*sceneFbo);
+
+  // Takes effect next frame
+  if (dynamicResolution && resolutionScaler.update()) {
+    const auto next = scaledSize();
+    sceneFbo->resize(next.width(), next.height());
+  }
+}
+
+void SceneWidget::renderSplitView() {
+  // Set by Qt for the widget's framebuffer
+  std::array<GLint, 4> viewport{};
+  glGetIntegerv(GL_VIEWPORT, viewport.data());
+  const auto half = viewport[2] / 2;
+
+  auto target = camera.get_position();
+  if (selectedNode) {
+    if (const auto iter = nodes.find(selectedNode.value()); iter != nodes.end())
+      target = iter->second.getCenter();
+  }
+  overviewCamera.setPosition({target.x, target.y + overviewHeight, target.z});
+
+  // `renderScene()` clears the whole framebuffer, so keep each view to its half
+  glState.enable(GL_SCISSOR_TEST);
+  glViewport(viewport[0] + half, viewport[1], viewport[2] - half, viewport[3]);
+  glScissor(viewport[0] + half, viewport[1], viewport[2] - half, viewport[3]);
+  renderScene(overviewCamera);
+
+  // The main view last, so this frame's culling is for `camera` when picking
+  glViewport(viewport[0], viewport[1], half, viewport[3]);
+  glScissor(viewport[0], viewport[1], half, viewport[3]);
+  renderScene(camera);
+  glState.disable(GL_SCISSOR_TEST);
+}
+
+int SceneWidget::mainViewWidth() const {
+  return splitView ? std::max(1, width() / 2) : width();
+}
+
+void SceneWidget::drawMinimap() {
+  if (!minimapFbo)
+    minimapFbo = std::make_unique<MinimapFramebuffer>(openGl, minimapSize);
+
+  if (minimapStale) {
+    drawMinimapStatic();
+    minimapStale = false;
+    minimapTimer.invalidate();
+  }
+
+  // From the Node data uploaded for this frame
+  if (!minimapTimer.isValid() || minimapTimer.elapsed() >= 1000 / minimapRate) {
+    renderer.updateMinimap(*minimapFbo, nodeStore.size(), minimapLow, minimapHigh, selectedNode);
+    minimapTimer.start();
+  }
+
+  std::array<GLint, 4> viewport{};
+  glGetIntegerv(GL_VIEWPORT, viewport.data());
+
+  // OpenGL starts from the bottom left, Qt from the top left
+  const auto area = minimapRect();
+  const auto ratio = devicePixelRatioF();
+  glViewport(static_cast<int>(area.x() * ratio), static_cast<int>((height() - area.y() - area.height()) * ratio),
+             static_cast<int>(area.width() * ratio), static_cast<int>(area.height() * ratio));
+  renderer.renderMinimap(*minimapFbo);
+  glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+}
+
+void SceneWidget::drawMinimapStatic() {
+  // Far enough above to see the tops of the Buildings
+  constexpr auto eyeHeight = 5000.0f;
+
+  GLint previousFbo = 0;
+  glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &previousFbo);
+  std::array<GLint, 4> viewport{};
+  glGetIntegerv(GL_VIEWPORT, viewport.data());
+
+  minimapFbo->bindStatic();
+  glViewport(0, 0, minimapFbo->getSize(), minimapFbo->getSize());
+  const auto scissor = glIsEnabled(GL_SCISSOR_TEST);
+  glState.disable(GL_SCISSOR_TEST);
+  glState.depthMask(true);
+  glClearColor(1.0f, 1.0f, 1.0f, 1.0f);
+  glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+  // Straight down, with -Z, the way the camera starts facing, at the top
+  const auto center = (minimapLow + minimapHigh) * 0.5f;
+  const auto half = (minimapHigh - minimapLow) * 0.5f;
+  const glm::vec3 eye{center.x, eyeHeight, center.y};
+  renderer.setPerspective(glm::ortho(-half.x, half.x, -half.y, half.y, 1.0f, eyeHeight * 2.0f));
+  renderer.use(glm::lookAt(eye, glm::vec3{center.x, 0.0f, center.y}, glm::vec3{0.0f, 0.0f, -1.0f}), eye);
+
+  renderer.render(*floor);
+  renderStatic(StaticGeometry::Pass::Areas, false);
+  renderStatic(StaticGeometry::Pass::Buildings, false);
 
-  camera.move(static_cast<float>(frameTimer.elapsed()));
+  renderer.setPerspective(projection);
   renderer.use(camera);
+  if (scissor)
+    glState.enable(GL_SCISSOR_TEST);
+  glBindFramebuffer(GL_DRAW_FRAMEBUFFER, static_cast<GLuint>(previousFbo));
+  glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+}
+
+QRect SceneWidget::minimapRect() const {
+  constexpr auto margin = 10;
+  const auto side = std::min(minimapDisplaySize, std::min(mainViewWidth(), height()) / 3);
+  return {mainViewWidth() - side - margin, height() - side - margin, side, side};
+}
+
+void SceneWidget::teleportCamera(const QPoint &position) {
+  const auto area = minimapRect();
+  const glm::vec2 along{static_cast<float>(position.x() - area.x()) / static_cast<float>(area.width()),
+                        static_cast<float>(position.y() - area.y()) / static_cast<float>(area.height())};
+
+  // The top of the minimap is the lowest Z
+  const auto ground = glm::mix(minimapLow, minimapHigh, along);
+  const auto elevation = camera.get_position().y;
+  camera.setPosition({ground.x, elevation, ground.y});
+  update();
+}
+
+void SceneWidget::renderScene(const Camera &view) {
+  using Stage = FrameProfiler::Stage;
+  profiler.begin(Stage::Opaque);
+  renderer.setMotionTime(simulationTime + motionLead);
+  renderer.use(view);
+  cull(view);
+  gatherLights();
+  renderer.uploadLights(sceneLights);
+  if (renderClusters)
+    collapseClusters(view);
+  cullOccluded(view);
 
   glClearColor(1.0f, 1.0f, 1.0f, 1.0f);
   glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-  if (renderSkybox)
+  if (renderSkybox) {
+    if (!skyBox)
+      loadSkyBox();
     renderer.render(*skyBox);
+  }
 
-  for (auto &[key, node] : nodes) {
-    if (!node.visible())
-      continue;
-    if (selectedNode.has_value())
-      renderer.render(node, key == selectedNode.value());
-    else
-      renderer.render(node, false);
+  // Every buffer rewritten this frame is staged, then copied at once, before anything draws from them
+  renderer.uploadNodeData(nodeStore);
+  flushTrails();
+  if (wiredLinks)
+    wiredLinks->upload();
+  uploadRing.flush();
+
+  // The spheres grow in the shader, so only upload them when the set changes
+  if (transmissionsChanged || visibleTransmissions != uploadedTransmissions) {
+    renderer.uploadTransmissions(nodeStore, visibleTransmissions, simulationTime);
+    uploadedTransmissions = visibleTransmissions;
+    transmissionsChanged = false;
+  }
+
+  if (renderHeatmap)
+    renderer.accumulateHeatmap(*heatmapFbo, nodeStore.size(), heatmapLow, heatmapHigh, simulationTime);
+
+  renderer.render(nodeStore, visibleNodes, selectedNode);
+
+  // Sized to look the same at any distance
+  const auto pixelsPerUnit = projection[1][1] * static_cast<float>(height() * devicePixelRatioF()) * 0.5f;
+  const auto markerSize = [&view, pixelsPerUnit](const NodeGrid::Cluster &cluster) {
+    const auto pixels = 6.0f + 3.0f * std::log2(static_cast<float>(cluster.count));
+    return pixels * glm::distance(cluster.center, view.get_position()) / pixelsPerUnit;
+  };
+  for (const auto &cluster : clusters) {
+    const auto size = markerSize(cluster);
+    clusterMarker->setPosition(cluster.center);
+    clusterMarker->setScale(glm::vec3{size / clusterMarkerHeight});
+    renderer.render(*clusterMarker);
+  }
+
+  using MotionTrailRenderMode = SettingsManager::MotionTrailRenderMode;
+  if (reducedQuality) {
+    // Trails are left as they are until the view is still
+  } else if (trailWindow > 0LL && renderMotionTrails != MotionTrailRenderMode::Never) {
+    // Only uploaded again while the scenario is still loading
+    trajectories.upload();
+    for (std::uint32_t i = 0u; i < nodeStore.size(); i++) {
+      if (renderMotionTrails != MotionTrailRenderMode::Always && !nodeStore.has(i, NodeStore::TrailEnabled))
+        continue;
+      if (!nodeStore.has(i, NodeStore::Visible) || (renderClusters && nodeGrid.isCollapsed(i)))
+        continue;
+
+      renderer.renderTrajectory(trajectories, i, nodeStore.getNode(i).getTrailColor(), trailWindow,
+                                interpolateMotion);
+    }
+  } else if (renderMotionTrails != MotionTrailRenderMode::Never || trailPool.used() > 0) {
+    // Only the trails shown are still allocated, see `flushTrails()`
+    for (std::size_t i = 0u; i < nodeStore.size(); i++) {
+      const auto &node = nodeStore.getNode(i);
+      if (!node.getTrailBuffer().allocated() || !nodeStore.has(i, NodeStore::Visible) ||
+          (renderClusters && nodeGrid.isCollapsed(i)))
+        continue;
 
-    using MotionTrailRenderMode = SettingsManager::MotionTrailRenderMode;
-    if (renderMotionTrails == MotionTrailRenderMode::Always ||
-        (renderMotionTrails == MotionTrailRenderMode::EnabledOnly && node.getNs3Model().trailEnabled))
       renderer.renderTrail(node.getTrailBuffer(), node.getTrailColor());
+    }
   }
 
-  for (auto &[key, decoration] : decorations) {
-    renderer.render(decoration.getModel());
+  for (const auto slot : visibleDecorations) {
+    renderer.render(decorationSlots[slot]->getModel());
   }
+  if (decorationBatch)
+    renderer.render(*decorationBatch, visibleDecorationGroups);
   renderer.render(*floor);
 
-  renderer.render(areas);
+  using Pass = StaticGeometry::Pass;
+  renderStatic(Pass::Areas, false);
 
   if (buildingRenderMode == SettingsManager::BuildingRenderMode::Opaque)
-    renderer.render(buildings);
+    renderStatic(Pass::Buildings, true);
   // else in the transparent section
 
-  if (renderBuildingOutlines) {
+  if (renderBuildingOutlines && !reducedQuality) {
     // Black outlines for opaque buildings
     // White for transparent
     if (buildingRenderMode == SettingsManager::BuildingRenderMode::Opaque)
-      renderer.renderOutlines(buildings, glm::vec3{0.0f, 0.0f, 0.0f});
+      renderStatic(Pass::BuildingOutlines, true, glm::vec3{0.0f, 0.0f, 0.0f});
     else
-      renderer.renderOutlines(buildings, glm::vec3{1.0f, 1.0f, 1.0f});
+      renderStatic(Pass::BuildingOutlines, true, glm::vec3{1.0f, 1.0f, 1.0f});
   }
 
-  renderer.render(wiredLinks);
+  // Against the Buildings, & whatever else was drawn, before the queued Nodes are
+  if (!occlusionTests.empty())
+    renderer.render(occlusionQueries, occlusionTests);
+
+  if (wiredLinks)
+    renderer.render(*wiredLinks);
+
+  // The queued Nodes & Decorations, sorted by material
+  renderer.flush();
 
   // Keep this next to `startTransparent()`
   // has it's own transparency implementation
   if (renderGrid)
     renderer.render(*coordinateGrid);
+
+  // Just above the floor, under everything else
+  if (renderHeatmap)
+    renderer.renderHeatmap(*heatmapFbo, heatmapLow, heatmapHigh, floor->getPosition().y + 0.01f);
+  profiler.end(Stage::Opaque);
+
+  // The transparent items & labels are left out while the view is in motion
+  if (reducedQuality)
+    return;
+
+  profiler.begin(Stage::Transparent);
   // Keep this after all opaque items
   renderer.startTransparentDark();
 
   // Other condition in opaque section
   if (buildingRenderMode == SettingsManager::BuildingRenderMode::Transparent)
-    renderer.render(buildings);
+    renderStatic(Pass::Buildings, true);
 
-  for (const auto &[_, node] : nodes) {
-    if (!node.visible())
-      continue;
+  for (const auto i : visibleNodes)
+    renderer.renderTransparent(nodeStore, i);
 
-    const auto &nodeModel = node.getModel();
-    renderer.renderTransparent(nodeModel);
-
-    // Name Banner
-    using LabelRenderMode = SettingsManager::LabelRenderMode;
-    if (renderLabels == LabelRenderMode::Always ||
-        (renderLabels == LabelRenderMode::EnabledOnly && node.getNs3Model().labelEnabled))
-      renderer.renderFont(node.getBannerRenderInfo(), node.getTop(), labelScale);
-    // `renderFont` ends with us in light transparent mode,
-    // so make sure we're back in dark mode, since other transparent
-    // items assume that mode
-    renderer.startTransparentDark();
-
-    const auto &transmit = node.getTransmitInfo();
-    if (transmit.isTransmitting && transmit.startTime <= simulationTime &&
-        transmit.startTime + transmit.duration >= simulationTime) {
-      const auto delta = static_cast<double>(simulationTime - transmit.startTime) /
-                         static_cast<double>(transmit.duration) * transmit.targetSize;
-      transmissionSphere->setPosition(nodeModel.getPosition());
-      transmissionSphere->setTargetHeightScale(static_cast<float>(delta));
-      transmissionSphere->setBaseColor(transmit.color);
-      renderer.render(*transmissionSphere, Renderer::LightingMode::LightingDisabled);
+  renderer.renderTransmissions(*transmissionSphere, simulationTime);
+
+  for (const auto slot : visibleDecorations) {
+    renderer.renderTransparent(decorationSlots[slot]->getModel());
+  }
+  if (decorationBatch)
+    renderer.renderTransparent(*decorationBatch, visibleDecorationGroups);
+  renderer.flush();
+  profiler.end(Stage::Transparent);
+
+  // Name Banners, after every other transparent item,
+  // since `renderLabels` ends in light transparent mode
+  profiler.begin(Stage::Labels);
+  std::array<GLint, 4> viewport{};
+  glGetIntegerv(GL_VIEWPORT, viewport.data());
+  labelLayout.begin(view.view_matrix(), projection,
+                    {static_cast<float>(viewport[2]), static_cast<float>(viewport[3])}, labelScale);
+
+  // Off screen, unreadable, & covered labels are never added
+  const auto placeLabel = [this](const FontManager::FontBannerRenderInfo &info, const glm::vec3 &location) {
+    if (labelLayout.place(location + Renderer::labelOffset, info.min, info.max))
+      renderer.addLabel(info, location);
+  };
+
+  using LabelRenderMode = SettingsManager::LabelRenderMode;
+  if (renderLabels != LabelRenderMode::Never) {
+    const auto selectedSlot =
+        selectedNode ? std::optional<std::uint32_t>{streams.nodeSlot(selectedNode.value())} : std::nullopt;
+    const auto eye = view.get_position();
+
+    labelCandidates.clear();
+    for (const auto i : visibleNodes) {
+      const auto enabled = nodeStore.has(i, NodeStore::LabelEnabled);
+      if (renderLabels != LabelRenderMode::Always && !enabled)
+        continue;
+
+      const auto offset = nodeStore.getNode(i).getTop() - eye;
+      const auto priority = i == selectedSlot ? 0 : (enabled ? 1 : 2);
+      labelCandidates.emplace_back(priority, glm::dot(offset, offset), i);
+    }
+    std::sort(labelCandidates.begin(), labelCandidates.end());
+
+    for (const auto &[priority, distance, i] : labelCandidates) {
+      const auto &node = nodeStore.getNode(i);
+      placeLabel(node.getBannerRenderInfo(), node.getTop() + nodeStore.motionOffset(i, simulationTime));
     }
   }
 
-  renderer.startTransparentDark();
-  for (auto &[key, decoration] : decorations) {
-    renderer.renderTransparent(decoration.getModel());
+  // Clusters of one Node have no count
+  for (const auto &cluster : clusters) {
+    if (cluster.count < 2u)
+      continue;
+
+    auto label = clusterLabels.find(cluster.count);
+    if (label == clusterLabels.end())
+      label = clusterLabels.emplace(cluster.count, fontManager.allocate(std::to_string(cluster.count))).first;
+    placeLabel(label->second, cluster.center + glm::vec3{0.0f, markerSize(cluster) * 0.5f, 0.0f});
   }
+
+  if (renderLabels != LabelRenderMode::Never || !clusters.empty())
+    renderer.renderLabels(labelScale);
   renderer.endTransparent();
-  frameTimer.restart();
+  profiler.end(Stage::Labels);
+}
 
-  if (playMode == PlayMode::Paused)
+void SceneWidget::exportFrame() {
+  // Let the writer catch up, rather than holding every frame in memory
+  if (frameWriter.getPending() >= maxPendingFrames)
     return;
 
-  simulationTime += timeStep;
-  emit timeChanged(simulationTime, timeStep);
+  // Wait for the events of this frame to load
+  if (loadedTime && simulationTime > loadedTime.value())
+    return;
 
-  const auto pastEnd = timeStep > 0LL && simulationTime >= config.endTime;
-  const auto pastBeginning = timeStep < 0LL && simulationTime < 0LL;
-  if ((pastEnd || pastBeginning) && playMode == PlayMode::Play) {
-    pause();
+  makeCurrent();
+  glState.invalidate();
+
+  exportFbo->bind();
+  glViewport(0, 0, exportFbo->getWidth(), exportFbo->getHeight());
+  renderer.setPerspective(glm::perspective(
+      glm::radians(camera.getFieldOfView()),
+      static_cast<float>(exportFbo->getWidth()) / static_cast<float>(exportFbo->getHeight()), 0.1f, 1000.0f));
+
+  renderScene(camera);
+  uploadRing.endFrame();
+  if (const auto frame = exportFbo->read())
+    queueFrame(frame.value());
+
+  // Back to what `paintGL()` expects
+  exportFbo->unbind(defaultFramebufferObject());
+  glViewport(0, 0, width(), height());
+  renderer.setPerspective(projection);
+  doneCurrent();
 
-    // Correct times so they match up with the end/beginning
-    // Useful if the increment does not match up with
-    // the end time
-    if (pastEnd)
-      setTime(config.endTime);
-    else
-      setTime(0LL);
+  if (exportFramesLeft)
+    exportFramesLeft.value()--;
+  if (simulationTime >= config.endTime || exportFramesLeft == 0u) {
+    stopExport();
+    return;
+  }
+
+  simulationTime = std::min(simulationTime + exportStep, config.endTime);
+  handleEvents();
+  emit timeChanged(simulationTime, exportStep);
+}
+
+void SceneWidget::queueFrame(const QImage &frame) {
+  const auto fileName = QDir{exportDirectory}.filePath(QString{"frame-%1.png"}.arg(exportedFrames, 6, 10, QChar{'0'}));
+
+  frameWriter.queue();
+  emit frameReady(frame, fileName);
+  exportedFrames++;
+}
+
+void SceneWidget::captureShot() {
+  while (!captureWrites.empty() && captureWrites.front().done())
+    captureWrites.pop_front();
+
+  // Let the encoders catch up, rather than holding every shot in memory
+  if (captureWrites.size() >= static_cast<std::size_t>(maxPendingFrames))
+    return;
+
+  const auto &shot = captureShots[nextShot];
+  if (shot.view) {
+    camera.setPosition(shot.view->position);
+    camera.setRotation(shot.view->yaw, shot.view->pitch);
+  }
+  setTime(std::min(shot.time, config.endTime));
+
+  makeCurrent();
+  glState.invalidate();
+
+  exportFbo->bind();
+  glViewport(0, 0, exportFbo->getWidth(), exportFbo->getHeight());
+  renderer.setPerspective(glm::perspective(
+      glm::radians(camera.getFieldOfView()),
+      static_cast<float>(exportFbo->getWidth()) / static_cast<float>(exportFbo->getHeight()), 0.1f, 1000.0f));
+
+  renderScene(camera);
+  uploadRing.endFrame();
+  captureFiles.emplace_back(QDir{captureDirectory}.filePath(QString{"shot-%1.png"}.arg(nextShot, 4, 10, QChar{'0'})));
+  if (const auto frame = exportFbo->read())
+    writeShot(frame.value());
+  nextShot++;
+
+  // Back to what `paintGL()` expects
+  exportFbo->unbind(defaultFramebufferObject());
+  glViewport(0, 0, width(), height());
+  renderer.setPerspective(projection);
+
+  const auto done = nextShot == captureShots.size();
+  if (done) {
+    captureTimer.stop();
+
+    // The last few shots are still in flight
+    for (const auto &frame : exportFbo->finish())
+      writeShot(frame);
+    exportFbo.reset();
+  }
+  doneCurrent();
+
+  if (!done)
+    return;
+
+  // Only the last few, waiting runs any which have not started here
+  for (auto &write : captureWrites)
+    write.wait();
+  captureWrites.clear();
+
+  const auto shots = static_cast<int>(captureShots.size());
+  captureShots.clear();
+  update();
+  emit captureFinished(captureDirectory, shots, captureFailures->load());
+}
+
+void SceneWidget::writeShot(const QImage &frame) {
+  auto fileName = captureFiles.front();
+  captureFiles.pop_front();
+
+  captureWrites.emplace_back(parser::TaskPool::shared().submit([frame, fileName, failures = captureFailures]() {
+    if (!frame.mirrored().save(fileName))
+      (*failures)++;
+  }));
+}
+
+void SceneWidget::streamFrame() {
+  if (!renderServer.isConnected()) {
+    streamFbo.reset();
+    return;
+  }
+
+  // One frame at a time, so the client always gets the latest view, rather than a backlog
+  if (renderServer.getPending() > 0) {
+    streamSkipped = true;
+    return;
   }
+
+  parser::trace::Scope trace{"SceneWidget::streamFrame", "frame"};
+  if (!streamFbo || streamFbo->getWidth() != streamSize.width() || streamFbo->getHeight() != streamSize.height())
+    streamFbo = std::make_unique<ExportFramebuffer>(openGl, streamSize.width(), streamSize.height());
+
+  glState.invalidate();
+  streamFbo->bind();
+  glViewport(0, 0, streamFbo->getWidth(), streamFbo->getHeight());
+  renderer.setPerspective(glm::perspective(
+      glm::radians(camera.getFieldOfView()),
+      static_cast<float>(streamFbo->getWidth()) / static_cast<float>(streamFbo->getHeight()), 0.1f, 1000.0f));
+
+  renderScene(camera);
+
+  // Read back at once, rather than through the ring like exports,
+  // since the last frame would otherwise wait on ones that may never be drawn
+  (void)streamFbo->read();
+  const auto frames = streamFbo->finish();
+
+  // Back to what `paintGL()` expects
+  streamFbo->unbind(defaultFramebufferObject());
+  glViewport(0, 0, static_cast<int>(width() * devicePixelRatioF()), static_cast<int>(height() * devicePixelRatioF()));
+  renderer.setPerspective(projection);
+
+  if (frames.empty())
+    return;
+
+  renderServer.queue();
+  const auto position = camera.get_position();
+  emit streamFrameReady(frames.back(), static_cast<qint64>(simulationTime), {position.x, position.y, position.z},
+                        camera.getYaw(), camera.getPitch());
 }
 
 void SceneWidget::resizeGL(int w, int h) {
   updatePerspective();
   glViewport(0, 0, w, h);
-  pickingFbo->resize(w, h);
+
+  if (sceneFbo) {
+    const auto size = scaledSize();
+    sceneFbo->resize(size.width(), size.height());
+  }
 }
 
 void SceneWidget::keyPressEvent(QKeyEvent *event) {
   QWidget::keyPressEvent(event);
   camera.handle_keypress(event->key());
+  updateTimer();
 }
 
 void SceneWidget::keyReleaseEvent(QKeyEvent *event) {
   QWidget::keyReleaseEvent(event);
   camera.handle_keyrelease(event->key());
+  updateTimer();
 }
 
 void SceneWidget::mousePressEvent(QMouseEvent *event) {
   QWidget::mousePressEvent(event);
 
-  makeCurrent();
-
-  // OpenGL starts from the bottom left,
-  // Qt Starts at the top left,
-  // so adjust the Y coordinate accordingly
-  const auto selected = pickingFbo->read(event->x(), height() - event->y());
-  pickingFbo->unbind(GL_READ_FRAMEBUFFER, defaultFramebufferObject());
-  doneCurrent();
-
-  if (selected.object && selected.type == 1u) {
-    emit nodeSelected(selected.id);
-    selectedNode = selected.id;
+  // Clicks on the minimap move the camera, rather than picking under it
+  if (renderMinimap && event->button() == Qt::LeftButton && minimapRect().contains(event->pos())) {
+    teleportCamera(event->pos());
     return;
   }
 
-  if (!camera.mouseControlsEnabled())
+  if (!cpuPicking) {
+    // Picked by the next frame, and selected once the read finishes,
+    // rather than waiting on the GPU here
+    queuedClick = event->pos();
+    update();
     return;
+  }
 
-  if (!(event->buttons() & Qt::LeftButton))
+  const auto selected = pickCpu(event->x(), event->y());
+  if (selected) {
+    emit nodeSelected(selected.value());
+    selectedNode = selected;
+    update();
     return;
+  }
 
-  mousePressed = true;
-  setCursor(Qt::BlankCursor);
-
-  // Keep this position since we're about to move it
-  initialCursorPosition = {event->x(), event->y()};
-
-  isInitialMove = true;
-  QCursor::setPos(mapToGlobal({width() / 2, height() / 2}));
-  camera.setMobility(Camera::move_state::mobile);
+  if (event->buttons() & Qt::LeftButton)
+    startMouseMove(event->pos());
 }
 
 void SceneWidget::mouseReleaseEvent(QMouseEvent *event) {
@@ -456,6 +2008,7 @@ void SceneWidget::mouseMoveEvent(QMouseEvent *event) {
   auto dy = lastCursorPosition.y() - event->y();
 
   camera.mouse_move(dx, dy);
+  update();
 
   lastCursorPosition = widgetCenter;
   QCursor::setPos(mapToGlobal(widgetCenter));
@@ -490,9 +2043,104 @@ SceneWidget::SceneWidget(QWidget *parent, const Qt::WindowFlags &f) : QOpenGLWid
   }
 
   setResourcePath(resourceDirSetting.value());
+
+  // MiB of events, 0 keeps every event in memory
+  events.setBudget(
+      static_cast<std::size_t>(std::max(0, settings.get<int>(SettingsManager::Key::PlaybackMemoryBudget).value())) *
+      1024u * 1024u);
+
+  exportTimer.setInterval(0);
+  QObject::connect(&exportTimer, &QTimer::timeout, this, &SceneWidget::exportFrame);
+  captureTimer.setInterval(0);
+  QObject::connect(&captureTimer, &QTimer::timeout, this, &SceneWidget::captureShot);
+
+  // Saves often touch the file more than once
+  previewRefreshTimer.setSingleShot(true);
+  previewRefreshTimer.setInterval(100);
+  QObject::connect(&previewRefreshTimer, &QTimer::timeout, this, &SceneWidget::refreshPreview);
+  QObject::connect(&previewWatcher, &QFileSystemWatcher::fileChanged, this, [this]() {
+    previewRefreshTimer.start();
+  });
+
+  // Trajectories are only kept with a window, so one may only be resized here, not turned on or off
+  QObject::connect(&SettingsManager::notifier(), &SettingsNotifier::changed, this, [this](int key) {
+    if (static_cast<SettingsManager::Key>(key) != SettingsManager::Key::RenderMotionTrailWindow || trailWindow == 0LL)
+      return;
+
+    const auto window = settings.get<int>(SettingsManager::Key::RenderMotionTrailWindow).value();
+    if (window > 0) {
+      trailWindow = window * MILLISECOND;
+      update();
+    }
+  });
+
+  frameWriter.moveToThread(&writerThread);
+  QObject::connect(this, &SceneWidget::frameReady, &frameWriter, &FrameWriter::write);
+  QObject::connect(&frameWriter, &FrameWriter::error, this, &SceneWidget::exportFailed);
+
+  renderServer.moveToThread(&writerThread);
+  QObject::connect(this, &SceneWidget::streamFrameReady, &renderServer, &RenderServer::send);
+  QObject::connect(&renderServer, &RenderServer::clientConnected, this, [this]() {
+    update();
+    emit clientConnected();
+  });
+  QObject::connect(&renderServer, &RenderServer::clientDisconnected, this, &SceneWidget::clientDisconnected);
+  QObject::connect(&renderServer, &RenderServer::frameSent, this, [this]() {
+    if (streamSkipped) {
+      streamSkipped = false;
+      update();
+    }
+  });
+  QObject::connect(&renderServer, &RenderServer::resizeRequested, this, [this](int width, int height) {
+    streamSize = {width, height};
+    update();
+  });
+  QObject::connect(&renderServer, &RenderServer::viewRequested, this,
+                   [this](float x, float y, float z, float yaw, float pitch) {
+                     camera.setPosition({x, y, z});
+                     camera.setRotation(yaw, pitch);
+                     update();
+                   });
+  QObject::connect(&renderServer, &RenderServer::seekRequested, this, [this](qint64 time) {
+    setTime(time);
+  });
+  QObject::connect(&renderServer, &RenderServer::playRequested, this, &SceneWidget::play);
+  QObject::connect(&renderServer, &RenderServer::pauseRequested, this, &SceneWidget::pause);
+  writerThread.start();
+
+  QObject::connect(&wallSync, &WallSync::frameReceived, this, &SceneWidget::applyWallFrame);
+  QObject::connect(&wallSync, &WallSync::leaderConnected, this, &SceneWidget::wallLeaderConnected);
+  QObject::connect(&wallSync, &WallSync::leaderDisconnected, this, &SceneWidget::wallLeaderDisconnected);
+  QObject::connect(&wallSync, &WallSync::nodeLost, this, &SceneWidget::wallNodeLost);
+
+  // Answered once shown, so the leader only moves on once every tile is on screen
+  QObject::connect(this, &QOpenGLWidget::frameSwapped, this, [this]() {
+    if (wallFrame)
+      wallSync.acknowledge(std::exchange(wallFrame, std::nullopt).value());
+  });
 }
 
 SceneWidget::~SceneWidget() {
+  stopExport();
+  rememberAssets();
+  prewarmer.cancel();
+
+  // Nothing should reach this widget while it's torn down
+  renderServer.disconnect();
+  renderServer.stop();
+  wallSync.disconnect();
+  wallSync.stop();
+  makeCurrent();
+  streamFbo.reset();
+  if (staticTiles)
+    staticTiles->clear(renderer);
+  uploadRing.destroy();
+  doneCurrent();
+
+  // Finish writing the frames already queued
+  writerThread.quit();
+  writerThread.wait();
+
 #ifndef NDEBUG
   // Silence the warning for trying to close a logger
   // without the right OpenGL context
@@ -515,38 +2163,294 @@ void SceneWidget::setConfiguration(parser::GlobalConfiguration configuration) {
     renderer.resize(*coordinateGrid, newSize + 50.0f, settings.get<int>(SettingsManager::Key::RenderGridStep).value());
   }
 
+  // The bounds may grow as the scenario loads, so size the grid again
+  nodeGrid.setBounds(toRenderCoordinate(config.minLocation), toRenderCoordinate(config.maxLocation));
+  updateNodeGrid();
+
+  // With some overrun, so splats at the edge are not cut off
+  const auto low = glm::min(toRenderCoordinate(config.minLocation), toRenderCoordinate(config.maxLocation));
+  const auto high = glm::max(toRenderCoordinate(config.minLocation), toRenderCoordinate(config.maxLocation));
+  heatmapLow = glm::vec2{low.x, low.z} - 10.0f;
+  heatmapHigh = glm::vec2{high.x, high.z} + 10.0f;
+
+  // Square, so the map is not stretched to fit its texture
+  const auto center = (heatmapLow + heatmapHigh) * 0.5f;
+  const auto extent = std::max(heatmapHigh.x - heatmapLow.x, heatmapHigh.y - heatmapLow.y) * 0.5f;
+  minimapLow = center - extent;
+  minimapHigh = center + extent;
+  minimapStale = true;
+  update();
+
   // time step handled by the MainWindow
 }
 
+void SceneWidget::reportMemory(MemoryReport &report) const {
+  report.add("Scene", "Events", events.memoryUsage());
+  report.add("Scene", "Events spilled to disk", events.getSpilledBytes(), MemoryReport::Kind::Disk);
+  report.add("Scene", "Events shared between viewers", events.getSharedBytes(), MemoryReport::Kind::Disk);
+  report.add("Scene", "Keyframes", keyframes.memoryUsage());
+  report.add("Scene", "Event streams", streams.memoryUsage());
+  report.add("Scene", "Traffic statistics", traffic.memoryUsage());
+  report.add("Scene", "Motion trajectories", trajectories.memoryUsage());
+  if (staticTiles)
+    report.add("Scene", "Static tiles", staticTiles->memoryUsage());
+
+  using Kind = MemoryReport::Kind;
+  report.add("Scene", "Renderer buffers", renderer.getGpuBytes(), Kind::Gpu);
+  report.add("Scene", "Meshes", models.getGpuBytes(), Kind::Gpu);
+  report.add("Scene", "Textures", textures.getGpuBytes(), Kind::Gpu);
+  report.add("Scene", "Labels", fontManager.getGpuBytes(), Kind::Gpu);
+  report.add("Scene", "Motion trails", trailPool.getGpuBytes(), Kind::Gpu);
+  report.add("Scene", "Motion trajectories", trajectories.getGpuBytes(), Kind::Gpu);
+  report.add("Scene", "Upload staging", uploadRing.getGpuBytes(), Kind::Gpu);
+  if (staticTiles)
+    report.add("Scene", "Static tiles", staticTiles->getGpuBytes(), Kind::Gpu);
+}
+
+SceneWidget::LoadTimes SceneWidget::getLoadTimes() const {
+  return {models.getImportWait(), models.getUploadTime(), textures.getUploadTime()};
+}
+
+SceneWidget::FrameCounters SceneWidget::takeFrameCounters() {
+  const auto counters = frameCounters;
+  frameCounters.longestFrame = {};
+  return counters;
+}
+
+void SceneWidget::rememberAssets() {
+  if (nodes.empty() && decorations.empty())
+    return;
+
+  AssetPrewarmer::remember(models.getLoadedPaths(), textures.getSourcePaths());
+}
+
 void SceneWidget::reset() {
+  stopExport();
+  stopPreview();
+
+  // The next scenario loads faster without the warming competing for the disk
+  rememberAssets();
+  prewarmTimer.stop();
+  prewarmer.cancel();
+
+  // The path was recorded against the old scenario
+  if (replayPath) {
+    replayPath.reset();
+    profiler.setEnabled(replayProfilerWasEnabled);
+  }
   areas.clear();
   buildings.clear();
+  staticGeometry.reset();
+  if (staticTiles) {
+    // `previewModel()` resets with the context already current
+    const auto wasCurrent = QOpenGLContext::currentContext() == context();
+    if (!wasCurrent)
+      makeCurrent();
+    staticTiles->clear(renderer);
+    if (!wasCurrent)
+      doneCurrent();
+    staticTiles.reset();
+  }
+  minimapStale = true;
   nodes.clear();
+  // After `nodes`, which reference it
+  staticModels.reset();
   decorations.clear();
-  wiredLinks.clear();
+  wiredLinks.reset();
   events.clear();
-  undoEvents.clear();
+  nextEvent = 0u;
+  eventsPending = false;
+  previewOrigin.reset();
+  setBehind(false);
+  keyframes.clear();
+  streams.clear();
+  traffic.clear();
+  nodeStore.clear();
+  nodeBvh.clear();
+  nodeGrid.clear();
+  clusters.clear();
+  // Built by `fontManager`, which is reset below
+  clusterLabels.clear();
+  decorationBvh.clear();
+  buildingBvh.clear();
+  visibleNodes.clear();
+  visibleDecorations.clear();
+  decorationBatch.reset();
+  isDecorationStatic.clear();
+  decorationBatchDirty = false;
+  visibleDecorationGroups.clear();
+  visibleBuildings.clear();
+  visibleTransmissions.clear();
+  transmittingNodes.clear();
+  litNodes.clear();
+  sceneLights.clear();
+  uploadedTransmissions.clear();
+  transmissionsChanged = true;
+  decorationSlots.clear();
+  touchedNodes.clear();
+  isNodeTouched.clear();
+  touchedDecorations.clear();
+  isDecorationTouched.clear();
+  isNodeStale.clear();
+  staleTrails.clear();
+  isTrailStale.clear();
+  trajectories.reset(0u);
   selectedNode.reset();
   fontManager.reset();
   simulationTime = 0.0;
+  loadedTime.reset();
+  update();
+}
+
+void SceneWidget::resetEvents() {
+  stopExport();
+  if (replayPath) {
+    replayPath.reset();
+    profiler.setEnabled(replayProfilerWasEnabled);
+  }
+
+  if (!keyframes.empty()) {
+    // Copied, `keyframes` is rebuilt below
+    const auto initial = keyframes.before(0u);
+    restore(initial);
+  }
+
+  events.clear();
+  nextEvent = 0u;
+  eventsPending = false;
+  previewOrigin.reset();
+  setBehind(false);
+
+  // The same models, so every Node & Decoration keeps its slot
+  keyframes.reset(staticModels->nodes, staticModels->decorations);
+  streams.reset(staticModels->nodes, staticModels->decorations);
+  resetTraffic();
+  resetTrajectories();
+
+  // Decorations are batched again until their first reloaded event
+  isDecorationStatic.assign(decorationSlots.size(), true);
+  decorationBatchDirty = true;
+
+  touchedNodes.clear();
+  isNodeTouched.clear();
+  touchedDecorations.clear();
+  isDecorationTouched.clear();
+  isNodeStale.clear();
+  simulationTime = 0LL;
+  loadedTime.reset();
+  update();
+}
+
+void SceneWidget::resetTraffic() {
+  std::vector<parser::Ns3Coordinate> initialPositions;
+  initialPositions.reserve(streams.nodeCount());
+  for (std::uint32_t slot = 0u; slot < streams.nodeCount(); slot++)
+    initialPositions.emplace_back(streams.getInitialPosition(slot));
+  traffic.reset(std::move(initialPositions));
+}
+
+void SceneWidget::swapModels(const std::vector<model_id> &loaded) {
+  for (const auto id : loaded) {
+    const auto &renderBounds = models.get(id).getBounds();
+    const Model::ModelBounds bounds{renderBounds.min, renderBounds.max};
+
+    for (std::size_t slot = 0u; slot < nodeStore.size(); slot++) {
+      if (nodeStore.getModelId(slot) != id)
+        continue;
+
+      nodeStore.getNode(slot).setModelBounds(bounds);
+      nodeStore.update(slot);
+      nodeBvh.update(slot, nodeBounds(slot));
+    }
+
+    for (std::size_t slot = 0u; slot < decorationSlots.size(); slot++) {
+      if (decorationSlots[slot]->getModel().getModelId() != id)
+        continue;
+
+      decorationSlots[slot]->setModelBounds(bounds);
+      decorationBvh.update(slot, decorationBounds(slot));
+      if (isDecorationStatic[slot])
+        decorationBatchDirty = true;
+    }
+  }
+
+  if (selectedNode)
+    emit selectedItemUpdated();
+}
+
+void SceneWidget::enforceMemoryBudget() {
+  if (gpuMemoryBudget == 0u)
+    return;
+
+  const auto used = models.getGpuBytes() + textures.getGpuBytes();
+  if (used <= gpuMemoryBudget)
+    return;
+
+  std::unordered_set<model_id> liveModels{models.getFallbackModelId()};
+  if (transmissionSphere)
+    liveModels.emplace(transmissionSphere->getModelId());
+  for (const auto &[id, node] : nodes)
+    liveModels.emplace(node.getModel().getModelId());
+  for (const auto &[id, decoration] : decorations)
+    liveModels.emplace(decoration.getModel().getModelId());
+
+  // Textures of evicted models are unused as well, so models go first
+  const auto excess = used - gpuMemoryBudget;
+  const auto released = models.evict(liveModels, excess);
+
+  std::unordered_set<texture_id> liveTextures;
+  for (const auto id : liveModels) {
+    for (const auto texture : models.get(id).getTextures())
+      liveTextures.emplace(texture);
+  }
+  textures.evict(liveTextures, released < excess ? excess - released : 0u);
+}
+
+void SceneWidget::prefetchModel(const QString &path) {
+  models.prefetch(path.toStdString());
 }
 
 void SceneWidget::add(const std::vector<parser::Area> &areaModels, const std::vector<parser::Building> &buildingModels,
-                      const std::vector<parser::Decoration> &decorationModels,
-                      const std::vector<parser::WiredLink> &links, const std::vector<parser::Node> &nodeModels) {
+                      std::shared_ptr<const parser::StaticModels> sharedModels,
+                      const std::vector<parser::WiredLink> &links) {
+  parser::trace::Scope trace{"SceneWidget::add", "load"};
+  staticModels = std::move(sharedModels);
+  const auto &decorationModels = staticModels->decorations;
+  const auto &nodeModels = staticModels->nodes;
+
+  // Build every model at once, so each load below only waits on the slowest
+  for (const auto &decoration : decorationModels)
+    models.prefetch(decoration.model);
+  for (const auto &node : nodeModels)
+    models.prefetch(node.model);
 
   // We need a current context for the initial construction of most models
   makeCurrent();
 
   areas.reserve(areaModels.size());
-  for (const auto &area : areaModels) {
-    areas.emplace_back(renderer.allocate(area), area);
-  }
+  for (const auto &area : areaModels)
+    areas.emplace_back(area);
 
   buildings.reserve(buildingModels.size());
-  for (const auto &building : buildingModels) {
-    buildings.emplace_back(renderer.allocate(building), building);
+  for (const auto &building : buildingModels)
+    buildings.emplace_back(building);
+
+  // Too many to keep on the GPU at once, so only those near the camera are
+  const auto pagingItems = settings.get<int>(SettingsManager::Key::RenderStaticPagingItems).value();
+  if (pagingItems > 0 && areaModels.size() + buildingModels.size() >= static_cast<std::size_t>(pagingItems)) {
+    const auto distance = settings.get<int>(SettingsManager::Key::RenderStaticStreamDistance).value();
+    const auto budget = settings.get<int>(SettingsManager::Key::RenderStaticTileBudget).value();
+    staticTiles = std::make_unique<StaticTiles>(static_cast<float>(std::max(1, distance)),
+                                                static_cast<std::size_t>(std::max(0, budget)) * 1024u * 1024u);
+    staticTiles->partition(areaModels, buildingModels);
+    renderer.allocate(staticTiles->getCoarse());
+  } else {
+    // Items in the geometry match the indices in `areas` & `buildings`
+    staticGeometry = std::make_unique<StaticGeometry>();
+    staticGeometry->build(areaModels, buildingModels);
+    renderer.allocate(*staticGeometry);
   }
+  minimapStale = true;
 
   decorations.reserve(decorationModels.size());
   for (const auto &decoration : decorationModels) {
@@ -554,63 +2458,116 @@ void SceneWidget::add(const std::vector<parser::Area> &areaModels, const std::ve
   }
 
   nodes.reserve(nodeModels.size());
-  const auto functions = context()->versionFunctions<QOpenGLFunctions_3_3_Core>();
+  // Trails take their storage once they are drawn, see `allocateTrail()`
   const auto trailLength = settings.get<int>(SettingsManager::Key::RenderMotionTrailLength).value();
+  trailPool.reset(trailLength);
   for (const auto &node : nodeModels) {
-    nodes.try_emplace(node.id, Model{models.load(node.model)}, node,
-                      renderer.allocateTrailBuffer(functions, trailLength), fontManager.allocate(node.name));
+    nodes.try_emplace(node.id, Model{models.load(node.model)}, node, TrailBuffer{trailLength},
+                      fontManager.allocate(node.name));
   }
 
-  wiredLinks.reserve(links.size());
+  // Ignore links with non-configured nodes
+  // should be picked up by the ns-3 module, but just in case
+  std::vector<parser::WiredLink> knownLinks;
+  knownLinks.reserve(links.size());
   for (const auto &link : links) {
-    auto &newLink = wiredLinks.emplace_back(renderer.allocate(link), link);
+    const auto unknown = std::find_if(link.nodes.begin(), link.nodes.end(), [this](unsigned int nodeId) {
+      return nodes.find(nodeId) == nodes.end();
+    });
 
-    // Flag to ignore links with non-configured nodes
-    // should be picked up by the ns-3 module, but just in case
-    bool ignoreLink = false;
-    for (const auto nodeId : link.nodes) {
-      const auto &node = nodes.find(nodeId);
+    if (unknown != link.nodes.end()) {
+      std::cerr << "A wired link references an unknown Node with ID: " << *unknown << " ignoring link\n";
+      continue;
+    }
 
-      if (node == nodes.end()) {
-        std::cerr << "A wired link references an unknown Node with ID: " << nodeId << " ignoring link\n";
-        ignoreLink = true;
-        continue;
-      }
+    knownLinks.emplace_back(link);
+  }
 
-      node->second.addWiredLink(&newLink);
-    }
+  const auto endpoints = WiredLinkBatch::layout(knownLinks);
+  wiredLinks = std::make_unique<WiredLinkBatch>(renderer.allocateWiredLinks(endpoints.size()));
+  for (const auto &endpoint : endpoints)
+    nodes.find(endpoint.nodeId)->second.addWiredLink(wiredLinks.get(), endpoint.vertex);
+
+  keyframes.reset(nodeModels, decorationModels);
 
-    if (ignoreLink)
-      wiredLinks.erase(wiredLinks.end() - 1);
+  streams.reset(nodeModels, decorationModels);
+  // Store the Nodes in slot order, so events may update the store by slot
+  std::vector<Node *> nodeSlots(streams.nodeCount());
+  for (auto &[id, node] : nodes)
+    nodeSlots[streams.nodeSlot(id)] = &node;
+  for (auto node : nodeSlots)
+    nodeStore.add(*node);
+
+  for (std::uint32_t i = 0u; i < nodeStore.size(); i++) {
+    if (nodeStore.getNode(i).getNs3Model().light)
+      litNodes.emplace_back(i);
+  }
+
+  resetTraffic();
+  trailWindow = settings.get<int>(SettingsManager::Key::RenderMotionTrailWindow).value() * MILLISECOND;
+  resetTrajectories();
+  occlusionQueries.reset(nodeStore.size());
+
+  decorationSlots.resize(streams.decorationCount());
+  for (auto &[id, decoration] : decorations)
+    decorationSlots[streams.decorationSlot(id)] = &decoration;
+
+  // Every Decoration is batched until its first event
+  isDecorationStatic.assign(decorationSlots.size(), true);
+  updateStaticDecorations();
+  decorationBatchDirty = true;
+
+  std::vector<BoundingVolumeHierarchy::Box> bounds;
+  bounds.reserve(nodeStore.size());
+  for (std::size_t i = 0u; i < nodeStore.size(); i++)
+    bounds.emplace_back(nodeBounds(i));
+  nodeBvh.build(std::move(bounds));
+  updateNodeGrid();
+
+  bounds.clear();
+  bounds.reserve(decorationSlots.size());
+  for (std::size_t i = 0u; i < decorationSlots.size(); i++)
+    bounds.emplace_back(decorationBounds(i));
+  decorationBvh.build(std::move(bounds));
+
+  bounds.clear();
+  bounds.reserve(buildingModels.size());
+  for (const auto &building : buildingModels) {
+    // The axes may flip during the conversion, so min/max may swap as well
+    const auto min = toRenderCoordinate(building.min);
+    const auto max = toRenderCoordinate(building.max);
+    bounds.push_back({glm::min(min, max), glm::max(min, max)});
   }
+  buildingBvh.build(std::move(bounds));
+
+  // Packed by `paintGL()`, once the scenario's textures are uploaded
+  packTexturesPending = settings.get<bool>(SettingsManager::Key::RenderPackTextures).value();
+  enforceMemoryBudget();
 
   doneCurrent();
+  update();
 }
 
 void SceneWidget::previewModel(const std::string &modelPath) {
   makeCurrent();
 
-  // Reset the model cache, since it's not out of the question
-  // that a model has changed since the last load
-  models.reset();
-
   // The scene should only have our previewed model in it
-  // so, remove everything else
+  // so, remove everything else. The model & texture caches are kept
   reset();
 
-  const Model previewedModel{models.loadAbsolute(modelPath)};
+  // Imported again, since it's not out of the question
+  // that the model has changed since the last load
+  const Model previewedModel{models.refresh(modelPath)};
 
   // If we get the fallback model ID, then the model failed to load
   // (Unless someone is trying to load the fallback model itself...)
   if (previewedModel.getModelId() == models.getFallbackModelId()) {
     QMessageBox::warning(this, "Failed to Load Model", "Failed to load the model. Check the console for more info");
-    models.reset();
-    reset();
     doneCurrent();
     return;
   }
 
-  decorations.try_emplace(0u, previewedModel, parser::Decoration{});
+  showPreview(previewedModel);
 
   // Put the camera slightly away from the loaded model
   // accounting for how large the model is
@@ -624,6 +2581,50 @@ void SceneWidget::previewModel(const std::string &modelPath) {
   camera.setPosition(position);
   camera.resetRotation();
   doneCurrent();
+
+  previewPath = modelPath;
+  previewWatcher.addPath(QString::fromStdString(modelPath));
+  update();
+}
+
+void SceneWidget::showPreview(const Model &model) {
+  decorations.clear();
+  auto &decoration = decorations.try_emplace(0u, model, parser::Decoration{}).first->second;
+
+  decorationSlots.assign(1u, &decoration);
+  isDecorationStatic.assign(1u, false);
+  visibleDecorations.clear();
+  decorationBvh.build({decorationBounds(0u)});
+}
+
+void SceneWidget::refreshPreview() {
+  if (!previewPath)
+    return;
+
+  const auto path = QString::fromStdString(*previewPath);
+  // Partway through a save, the next change refreshes it
+  if (!QFileInfo::exists(path))
+    return;
+
+  // Editors often save by replacing the file, which drops it from the watcher
+  if (!previewWatcher.files().contains(path))
+    previewWatcher.addPath(path);
+
+  makeCurrent();
+  const Model model{models.refresh(*previewPath)};
+  if (model.getModelId() != models.getFallbackModelId())
+    showPreview(model);
+  doneCurrent();
+  update();
+}
+
+void SceneWidget::stopPreview() {
+  previewRefreshTimer.stop();
+  previewPath.reset();
+
+  const auto watched = previewWatcher.files();
+  if (!watched.isEmpty())
+    previewWatcher.removePaths(watched);
 }
 
 void SceneWidget::focusNode(uint32_t nodeId) {
@@ -633,6 +2634,9 @@ void SceneWidget::focusNode(uint32_t nodeId) {
     return;
   }
 
+  catchUpNode(streams.nodeSlot(nodeId));
+  updateTouched();
+
   const auto &node = iter->second;
   const auto &ns3Model = node.getNs3Model();
 
@@ -649,6 +2653,7 @@ void SceneWidget::focusNode(uint32_t nodeId) {
 
   camera.setPosition(position);
   camera.resetRotation();
+  update();
 }
 
 const Node &SceneWidget::getNode(unsigned int nodeId) {
@@ -659,16 +2664,79 @@ const Node &SceneWidget::getNode(unsigned int nodeId) {
     std::abort();
   }
 
+  // A hidden Node is only brought up to date once it is asked for
+  catchUpNode(streams.nodeSlot(nodeId));
+  updateTouched();
+
   return iter->second;
 }
 
+std::optional<parser::Ns3Coordinate> SceneWidget::getNodePosition(unsigned int nodeId,
+                                                                   parser::nanoseconds time) const {
+  return streams.getNodePosition(nodeId, time, events);
+}
+
+void SceneWidget::indexEvents(const parser::SceneEvent *first, const parser::SceneEvent *last) {
+  auto index = events.size();
+  for (; first != last; ++first) {
+    const auto &event = *first;
+    keyframes.add(event);
+    streams.add(event);
+    const auto slot = streams.slot(index++);
+    traffic.add(slot, event);
+    if (trailWindow > 0LL)
+      extendTrajectory(slot, event);
+  }
+}
+
 void SceneWidget::enqueueEvents(const std::vector<parser::SceneEvent> &e) {
-  events.insert(events.end(), e.begin(), e.end());
+  indexEvents(e.data(), e.data() + e.size());
+  events.append(e.begin(), e.end());
+
+  // Decorations with their first events are drawn on their own from now on
+  updateStaticDecorations();
+
+  // Nodes waiting at their last loaded waypoint may have a next one now
+  if (interpolateMotion)
+    updateMotions();
+}
+
+void SceneWidget::enqueueEvents(std::vector<parser::SceneEvent> &&e) {
+  indexEvents(e.data(), e.data() + e.size());
+  events.append(e.begin(), e.end());
+  e.clear();
+
+  // Decorations with their first events are drawn on their own from now on
+  updateStaticDecorations();
+
+  // Nodes waiting at their last loaded waypoint may have a next one now
+  if (interpolateMotion)
+    updateMotions();
+}
+
+void SceneWidget::attachEvents(std::shared_ptr<const parser::SharedEvents> shared) {
+  if (events.isShared())
+    return;
+
+  if (events.empty()) {
+    parser::trace::Scope trace{"SceneWidget::attachEvents", "load"};
+    indexEvents(shared->data(), shared->data() + shared->size());
+  } else if (events.size() != shared->size()) {
+    return;
+  }
+
+  // Only references to events are invalidated, which are not held between frames
+  events.attach(std::move(shared));
+
+  updateStaticDecorations();
+  if (interpolateMotion)
+    updateMotions();
 }
 
 void SceneWidget::resetCamera() {
   camera.setPosition({0.0f, 0.0f, 0.0f});
   camera.resetRotation();
+  update();
 }
 
 Camera &SceneWidget::getCamera() {
@@ -676,8 +2744,24 @@ Camera &SceneWidget::getCamera() {
 }
 
 void SceneWidget::updatePerspective() {
-  renderer.setPerspective(glm::perspective(glm::radians(camera.getFieldOfView()),
-                                           static_cast<float>(width()) / static_cast<float>(height()), 0.1f, 1000.0f));
+  // Both halves of `splitView` are the same size, so they share a projection
+  const auto aspect = static_cast<float>(mainViewWidth()) / static_cast<float>(height());
+  if (wallTile) {
+    // This tile's part of the wall's frustum, which spans every tile at the field of view
+    const auto &tile = wallTile.value();
+    const auto nearPlane = 0.1f;
+    const auto top = nearPlane * std::tan(glm::radians(camera.getFieldOfView()) / 2.0f);
+    const auto right = top * aspect * static_cast<float>(tile.columns) / static_cast<float>(tile.rows);
+    const auto tileWidth = 2.0f * right / static_cast<float>(tile.columns);
+    const auto tileHeight = 2.0f * top / static_cast<float>(tile.rows);
+    const auto left = -right + tileWidth * static_cast<float>(tile.column);
+    const auto tileTop = top - tileHeight * static_cast<float>(tile.row);
+    projection = glm::frustum(left, left + tileWidth, tileTop - tileHeight, tileTop, nearPlane, 1000.0f);
+  } else {
+    projection = glm::perspective(glm::radians(camera.getFieldOfView()), aspect, 0.1f, 1000.0f);
+  }
+  renderer.setPerspective(projection);
+  update();
 }
 
 void SceneWidget::setResourcePath(const QString &value) {
@@ -687,70 +2771,493 @@ void SceneWidget::setResourcePath(const QString &value) {
 
 void SceneWidget::play() {
   playMode = PlayMode::Play;
+  playbackTimer.start();
+  playedSteps = 0LL;
+  updateTimer();
 
   emit playing();
 }
 
 void SceneWidget::pause() {
   playMode = PlayMode::Paused;
+  updateTimer();
+  setBehind(false);
 
   emit paused();
 }
 
 void SceneWidget::setTime(parser::nanoseconds value) {
-  const auto oldTime = simulationTime;
+  if (loadedTime && value > loadedTime.value())
+    value = loadedTime.value();
+
+  // The charts & log have not seen any previewed time
+  const auto oldTime = previewOrigin.value_or(simulationTime);
+  if (previewOrigin) {
+    previewOrigin.reset();
+
+    // Do not catch up on the steps missed while previewing
+    if (playMode == PlayMode::Play) {
+      playbackTimer.restart();
+      playedSteps = 0LL;
+    }
+  }
 
   simulationTime = value;
   const auto diff = simulationTime - oldTime;
 
-  if (diff > 0LL)
-    handleEvents();
-  else
-    handleUndoEvents();
+  seek();
+  update();
 
   emit timeChanged(simulationTime, diff);
+  emit seeked();
+}
+
+std::optional<KeyframeIndex::Keyframe> SceneWidget::captureKeyframe() const {
+  if (keyframes.empty())
+    return {};
+
+  return keyframes.at(nextEvent, events);
+}
+
+void SceneWidget::restoreSession(parser::nanoseconds time, const KeyframeIndex::Keyframe &keyframe) {
+  if (loadedTime && time > loadedTime.value())
+    time = loadedTime.value();
+
+  const auto oldTime = previewOrigin.value_or(simulationTime);
+  previewOrigin.reset();
+  simulationTime = time;
+
+  // A stale session, from a changed scenario, falls back to a normal seek
+  if (!keyframes.empty() && keyframes.fits(keyframe) && keyframe.eventCount <= firstEventAfter(time)) {
+    restore(keyframe);
+    handleEvents();
+  } else {
+    seek();
+  }
+  update();
+
+  emit timeChanged(simulationTime, simulationTime - oldTime);
+  emit seeked();
+}
+
+void SceneWidget::previewTime(parser::nanoseconds value) {
+  if (loadedTime && value > loadedTime.value())
+    value = loadedTime.value();
+
+  if (!previewOrigin)
+    previewOrigin = simulationTime;
+
+  simulationTime = value;
+  seek();
+  update();
 }
 
 void SceneWidget::setTimeStep(parser::nanoseconds value) {
   timeStep = value;
 }
 
+void SceneWidget::setLoadedTime(std::optional<parser::nanoseconds> value) {
+  loadedTime = value;
+
+  if (value && value.value() > config.endTime)
+    config.endTime = value.value();
+}
+
 QSize SceneWidget::sizeHint() const {
   return {640, 480};
 }
 
 void SceneWidget::setSkyboxRenderState(bool enable) {
   renderSkybox = enable;
+  update();
 }
 
 void SceneWidget::setBuildingRenderMode(SettingsManager::BuildingRenderMode mode) {
   buildingRenderMode = mode;
+  update();
 }
 
 void SceneWidget::setBuildingRenderOutlines(bool enable) {
   renderBuildingOutlines = enable;
+  update();
+}
+
+void SceneWidget::setCpuPicking(bool enable) {
+  cpuPicking = enable;
+}
+
+void SceneWidget::setDynamicResolution(bool enable) {
+  dynamicResolution = enable;
+  if (!enable) {
+    makeCurrent();
+    sceneFbo.reset();
+    doneCurrent();
+    resolutionScaler.reset();
+  }
+
+  update();
+}
+
+void SceneWidget::setSplitView(bool enable) {
+  splitView = enable;
+  updatePerspective();
+}
+
+void SceneWidget::setRenderClusters(bool enable) {
+  renderClusters = enable;
+  clusters.clear();
+  update();
+}
+
+void SceneWidget::setRenderHeatmap(bool enable) {
+  renderHeatmap = enable;
+
+  // Every Node is counted, hidden or not
+  if (renderHeatmap)
+    catchUpNodes();
+  update();
+}
+
+void SceneWidget::setRenderMinimap(bool enable) {
+  renderMinimap = enable;
+
+  // Every Node is shown, hidden or not
+  if (renderMinimap)
+    catchUpNodes();
+  update();
+}
+
+void SceneWidget::setAdaptiveQuality(bool enable) {
+  adaptiveQuality = enable;
+}
+
+void SceneWidget::setAdaptiveScale(float value) {
+  adaptiveScale = std::clamp(value, 0.25f, 1.0f);
+}
+
+void SceneWidget::probePerformance() {
+  makeCurrent();
+  PerformanceProbe probe{openGl, renderer};
+  const auto result = probe.run(*context(), format().samples(), defaultFramebufferObject());
+  doneCurrent();
+
+  std::cout << "Performance probe: " << result.milliseconds << "ms per frame";
+  if (result.software)
+    std::cout << ", software renderer";
+  if (!result.missingExtensions.empty())
+    std::cout << ", missing " << result.missingExtensions.join(", ").toStdString();
+  std::cout << '\n';
+
+  const auto description = PerformanceProbe::apply(result, settings);
+  emit performancePresetApplied(description);
+}
+
+void SceneWidget::setInterpolateMotion(bool enable) {
+  interpolateMotion = enable;
+  updateMotions();
+  update();
+}
+
+void SceneWidget::setSkipIdle(bool enable) {
+  skipIdle = enable;
+}
+
+void SceneWidget::setIdleLookup(std::function<std::optional<parser::nanoseconds>()> lookup) {
+  idleLookup = std::move(lookup);
+}
+
+void SceneWidget::setReverse(bool enable) {
+  reverse = enable;
+}
+
+void SceneWidget::setProfilerEnabled(bool enable) {
+  profiler.setEnabled(enable);
+  update();
+}
+
+bool SceneWidget::exportProfile(const QString &path) const {
+  return profiler.exportCsv(path);
+}
+
+void SceneWidget::startExport(const QString &directory, int width, int height, unsigned long long firstFrame,
+                              std::optional<unsigned long long> frames) {
+  if (exportFbo)
+    return;
+
+  pause();
+  exportDirectory = directory;
+
+  // Always forwards, even while set to rewind
+  exportStep = std::abs(timeStep);
+  exportFirstFrame = firstFrame;
+  exportedFrames = firstFrame;
+  exportFramesLeft = frames;
+
+  makeCurrent();
+  exportFbo = std::make_unique<ExportFramebuffer>(openGl, width, height);
+  exportFbo->unbind(defaultFramebufferObject());
+  doneCurrent();
+
+  // Seeks through the keyframes to a later first frame
+  const auto start = static_cast<parser::nanoseconds>(firstFrame) * exportStep;
+  setTime(std::min(start, config.endTime));
+  exportTimer.start();
+}
+
+unsigned long long SceneWidget::exportFrameCount() const {
+  const auto step = std::abs(timeStep);
+  if (step == 0LL)
+    return 1u;
+
+  // The last frame is held at the end, even if it is less than a step past the one before
+  const auto steps = config.endTime / step + (config.endTime % step != 0LL ? 1LL : 0LL);
+  return static_cast<unsigned long long>(steps) + 1u;
+}
+
+void SceneWidget::stopExport() {
+  // A capture shares `exportFbo`, & runs to its end
+  if (!exportFbo || !captureShots.empty())
+    return;
+
+  exportTimer.stop();
+
+  // The last few frames are still in flight
+  makeCurrent();
+  for (const auto &frame : exportFbo->finish())
+    queueFrame(frame);
+  exportFbo.reset();
+  doneCurrent();
+
+  update();
+  emit exportFinished(exportDirectory, exportedFrames - exportFirstFrame);
+}
+
+void SceneWidget::startCapture(const ShotList &shots, const QString &directory, int width, int height) {
+  if (exportFbo || shots.empty())
+    return;
+
+  pause();
+  captureShots = shots.getShots();
+  nextShot = 0u;
+  captureDirectory = directory;
+  captureFiles.clear();
+  captureFailures->store(0);
+
+  makeCurrent();
+  exportFbo = std::make_unique<ExportFramebuffer>(openGl, width, height);
+  exportFbo->unbind(defaultFramebufferObject());
+  doneCurrent();
+
+  captureTimer.start();
+}
+
+bool SceneWidget::isExporting() const {
+  return exportFbo != nullptr;
+}
+
+std::optional<QString> SceneWidget::serve(const QString &address) {
+  return renderServer.listen(address);
+}
+
+void SceneWidget::stopServing() {
+  renderServer.stop();
+  update();
+}
+
+void SceneWidget::setWallTile(std::optional<WallTile> tile) {
+  wallTile = tile;
+  updatePerspective();
+}
+
+std::optional<QString> SceneWidget::leadWall(const QStringList &nodes) {
+  wallFrame.reset();
+  auto error = wallSync.lead(nodes);
+  update();
+  return error;
+}
+
+std::optional<QString> SceneWidget::joinWall(const QString &address) {
+  wallFrame.reset();
+  if (auto error = wallSync.follow(address))
+    return error;
+
+  pause();
+  return {};
+}
+
+void SceneWidget::leaveWall() {
+  wallSync.stop();
+  wallFrame.reset();
+}
+
+void SceneWidget::applyWallFrame() {
+  const auto frame = wallSync.takeFrame();
+  if (!frame)
+    return;
+
+  camera.setPosition(frame->position);
+  camera.setRotation(frame->yaw, frame->pitch);
+  if (camera.getFieldOfView() != frame->fieldOfView) {
+    camera.setFieldOfView(frame->fieldOfView);
+    updatePerspective();
+  }
+
+  // A step forwards only applies the events since, see `seek()`
+  if (frame->time != simulationTime)
+    setTime(frame->time);
+
+  wallFrame = frame->number;
+  update();
+}
+
+void SceneWidget::startRecordingPath() {
+  recordedPath.emplace();
+  recordTimer.start();
+  update();
+}
+
+CameraPath SceneWidget::stopRecordingPath() {
+  if (!recordedPath)
+    return {};
+
+  auto path = std::move(recordedPath.value());
+  recordedPath.reset();
+  return path;
+}
+
+bool SceneWidget::isRecordingPath() const {
+  return recordedPath.has_value();
+}
+
+void SceneWidget::startReplay(CameraPath path, std::size_t frames) {
+  if (replayPath || exportFbo || path.empty())
+    return;
+
+  pause();
+  replayOrigin = {0LL, camera.get_position(), camera.getYaw(), camera.getPitch(), simulationTime, false};
+  replayFrames = std::clamp<std::size_t>(frames, 1u, FrameProfiler::maxTimedFrames);
+  replayFrame = 0u;
+
+  replayProfilerWasEnabled = profiler.isEnabled();
+  profiler.setEnabled(true);
+  replayFirstFrame = profiler.getNextFrame();
+
+  replayPath = std::move(path);
+  update();
+}
+
+bool SceneWidget::isReplaying() const {
+  return replayPath.has_value();
+}
+
+void SceneWidget::applyReplayFrame() {
+  // Frames after the path, drawn while the GPU timings are read, hold at its end
+  const auto frame = std::min(replayFrame, replayFrames - 1u);
+  const auto last = std::max<std::size_t>(replayFrames - 1u, 1u);
+  const auto time = replayPath->duration() * static_cast<parser::nanoseconds>(frame) /
+                    static_cast<parser::nanoseconds>(last);
+
+  const auto sample = replayPath->at(time);
+  camera.setPosition(sample.position);
+  camera.setRotation(sample.yaw, sample.pitch);
+  if (sample.simulationTime != simulationTime)
+    previewTime(sample.simulationTime);
+}
+
+void SceneWidget::advanceReplay() {
+  replayFrame++;
+  if (replayFrame < replayFrames + FrameProfiler::timingLatency) {
+    update();
+    return;
+  }
+
+  const auto times = profiler.frameTimes(replayFirstFrame, replayFrames);
+  replayPath.reset();
+  profiler.setEnabled(replayProfilerWasEnabled);
+
+  camera.setPosition(replayOrigin.position);
+  camera.setRotation(replayOrigin.yaw, replayOrigin.pitch);
+  setTime(replayOrigin.simulationTime);
+
+  emit replayFinished(times);
+}
+
+const PagedEvents &SceneWidget::getEvents() const {
+  return events;
+}
+
+const parser::EntityEventStreams &SceneWidget::getStreams() const {
+  return streams;
+}
+
+const parser::TrafficStatistics &SceneWidget::getTrafficStatistics() const {
+  return traffic;
+}
+
+const parser::Node &SceneWidget::getNodeModel(std::uint32_t slot) const {
+  return nodeStore.getNode(slot).getNs3Model();
+}
+
+void SceneWidget::paintProfiler() {
+  const auto lines = profiler.summary();
+  if (lines.isEmpty())
+    return;
+
+  // QPainter expects nothing of ours bound
+  glState.bindVertexArray(0u);
+  glState.useProgram(0u);
+
+  QPainter painter{this};
+  painter.setFont(QFontDatabase::systemFont(QFontDatabase::FixedFont));
+  const auto metrics = painter.fontMetrics();
+
+  int width = 0;
+  for (const auto &line : lines)
+    width = std::max(width, metrics.boundingRect(line).width());
+
+  const auto padding = 8;
+  painter.fillRect(padding, padding, width + padding * 2, metrics.height() * lines.size() + padding * 2,
+                   QColor{0, 0, 0, 160});
+
+  painter.setPen(Qt::white);
+  for (auto i = 0; i < lines.size(); i++)
+    painter.drawText(padding * 2, padding * 2 + metrics.height() * i + metrics.ascent(), lines[i]);
+  painter.end();
+
+  // QPainter leaves its own state behind, restore what the scene expects
+  glState.invalidate();
+  glState.enable(GL_DEPTH_TEST);
+  glState.depthMask(true);
+  glState.disable(GL_BLEND);
+  glState.disable(GL_SCISSOR_TEST);
+  glState.disable(GL_STENCIL_TEST);
 }
 
 void SceneWidget::setRenderGrid(bool enable) {
   renderGrid = enable;
+  update();
 }
 void SceneWidget::changeGridStepSize(int stepSize) {
   makeCurrent();
   // Keep the same square size, but change the grid step
   renderer.resize(*coordinateGrid, coordinateGrid->getRenderInfo().squareSize, stepSize);
   doneCurrent();
+  update();
 }
 
 void SceneWidget::setRenderTrails(SettingsManager::MotionTrailRenderMode value) {
   renderMotionTrails = value;
+  update();
 }
 
 void SceneWidget::setRenderLabels(SettingsManager::LabelRenderMode value) {
   renderLabels = value;
+  update();
 }
 
 void SceneWidget::setLabelScale(float value) {
   labelScale = value;
+  update();
 }
 
 void SceneWidget::setSelectedNode(unsigned int nodeId) {
@@ -760,10 +3267,16 @@ void SceneWidget::setSelectedNode(unsigned int nodeId) {
   }
 
   selectedNode = nodeId;
+
+  // Its events are applied from now on, see `isNodeDeferred()`
+  catchUpNode(streams.nodeSlot(nodeId));
+  updateTouched();
+  update();
 }
 
 void SceneWidget::clearSelectedNode() {
   selectedNode.reset();
+  update();
 }
 
 } // namespace netsimulyzer
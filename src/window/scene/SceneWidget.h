@@ -37,25 +37,54 @@
 #include "../../group/building/Building.h"
 #include "../../group/decoration/Decoration.h"
 #include "../../group/node/Node.h"
+#include "../../group/node/NodeStore.h"
+#include "../../group/node/TrailPool.h"
+#include "../../group/node/TrajectoryBuffer.h"
 #include "../../render/Light.h"
 #include "../../render/camera/Camera.h"
+#include "../../render/camera/Frustum.h"
 #include "../../render/helper/Floor.h"
 #include "../../render/mesh/Mesh.h"
+#include "../../render/model/AssetPrewarmer.h"
 #include "../../render/model/Model.h"
 #include "../../render/model/ModelCache.h"
 #include "../../render/renderer/Renderer.h"
 #include "../../render/shader/Shader.h"
 #include "../../render/texture/TextureCache.h"
 #include "../../settings/SettingsManager.h"
+#include "../../util/memory-report.h"
 #include "../../util/undo-events.h"
-#include "src/group/link/WiredLink.h"
+#include "CameraPath.h"
+#include "FrameProfiler.h"
+#include "FrameWriter.h"
+#include "PerformanceProbe.h"
+#include "ResolutionScaler.h"
+#include "ShotList.h"
+#include "KeyframeIndex.h"
+#include "PagedEvents.h"
+#include "RenderServer.h"
+#include "WallSync.h"
+#include "src/group/link/WiredLinkBatch.h"
 #include "src/render/font/FontManager.h"
+#include "src/render/framebuffer/ExportFramebuffer.h"
+#include "src/render/framebuffer/HeatmapFramebuffer.h"
+#include "src/render/framebuffer/MinimapFramebuffer.h"
 #include "src/render/framebuffer/PickingFramebuffer.h"
+#include "src/render/framebuffer/SceneFramebuffer.h"
+#include "src/render/helper/BoundingVolumeHierarchy.h"
 #include "src/render/helper/CoordinateGrid.h"
+#include "src/render/helper/LabelLayout.h"
+#include "src/render/helper/NodeGrid.h"
+#include "src/render/helper/OcclusionQueries.h"
 #include "src/render/helper/SkyBox.h"
+#include "src/render/helper/DecorationBatch.h"
+#include "src/render/helper/StaticGeometry.h"
+#include "src/render/helper/StaticTiles.h"
 #include <QApplication>
 #include <QElapsedTimer>
 #include <QFile>
+#include <QFileSystemWatcher>
+#include <QImage>
 #include <QKeyEvent>
 #include <QMainWindow>
 #include <QMouseEvent>
@@ -63,19 +92,61 @@
 #include <QOpenGLFunctions>
 #include <QOpenGLFunctions_3_3_Core>
 #include <QOpenGLWidget>
+#include <QPoint>
+#include <QRect>
+#include <QSize>
+#include <QString>
+#include <QThread>
 #include <QTimer>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
 #include <deque>
+#include <entity-streams.h>
+#include <functional>
 #include <glm/glm.hpp>
 #include <iostream>
 #include <memory>
 #include <model.h>
+#include <optional>
+#include <task-pool.h>
+#include <traffic-stats.h>
+#include <tuple>
 #include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 namespace netsimulyzer {
 
 class SceneWidget : public QOpenGLWidget, protected QOpenGLFunctions_3_3_Core {
   Q_OBJECT
+
+public:
+  /**
+   * Work done by the scene, since it was created.
+   * Counted for every frame, whether or not the profiler is on
+   */
+  struct FrameCounters {
+    std::uint64_t frames{0u};
+
+    /**
+     * Time spent drawing the frames, on the CPU
+     */
+    std::chrono::nanoseconds frameTime{};
+
+    /**
+     * The longest frame since the last call to `takeFrameCounters()`
+     */
+    std::chrono::nanoseconds longestFrame{};
+
+    /**
+     * Events applied, or undone by seeking backwards
+     */
+    std::uint64_t eventsApplied{0u};
+  };
+
+private:
   enum class PlayMode { Paused, Play };
 
   QOpenGLFunctions_3_3_Core openGl;
@@ -89,56 +160,1351 @@ class SceneWidget : public QOpenGLWidget, protected QOpenGLFunctions_3_3_Core {
   ModelCache models{textures};
   FontManager fontManager{textures};
   Renderer renderer{models, textures, fontManager};
+
+  /**
+   * Warms the assets of recent scenarios, see `prewarmTimer`
+   */
+  AssetPrewarmer prewarmer;
+
+  /**
+   * Starts `prewarmer` once startup has settled.
+   * Stopped by `reset()`, since a scenario is loading instead
+   */
+  QTimer prewarmTimer{this};
+
+  /**
+   * Milliseconds after `initializeGL()` before `prewarmTimer` fires
+   */
+  static constexpr int prewarmDelay = 3000;
+
+  /**
+   * Storage for the motion trails, only taken by Nodes whose trail is drawn
+   */
+  TrailPool trailPool;
+
+  /**
+   * Every move of each Node over the whole scenario, for trails of the last `trailWindow`
+   * rather than of the last points
+   */
+  TrajectoryBuffer trajectories;
+
+  /**
+   * The span of time each trail covers, from `SettingsManager::Key::RenderMotionTrailWindow`.
+   * Zero for trails of the last points, in `trailPool`. Only turned on or off by `add()`
+   */
+  parser::nanoseconds trailWindow{0LL};
+  /**
+   * Holds back the next frame with a `frameCap`, see `scheduleFrame()`
+   */
   QTimer timer{this};
+
+  /**
+   * Most frames per second while animating, 0 for every frame the display shows
+   */
+  int frameCap = std::max(0, settings.get<int>(SettingsManager::Key::RenderFrameCap).value());
+
+  /**
+   * Since the last frame started, for `frameCap`
+   */
+  QElapsedTimer paceTimer;
+
+  /**
+   * Set while playing, or while the camera moves, so each frame schedules the next,
+   * see `updateTimer()`
+   */
+  bool animating = false;
   QElapsedTimer frameTimer;
+
+  /**
+   * See `takeFrameCounters()`
+   */
+  FrameCounters frameCounters;
   SettingsManager::LabelRenderMode renderLabels =
       settings.get<SettingsManager::LabelRenderMode>(SettingsManager::Key::RenderLabels).value();
   float labelScale = settings.get<float>(SettingsManager::Key::RenderLabelScale).value();
   bool renderSkybox = settings.get<bool>(SettingsManager::Key::RenderSkybox).value();
   bool renderGrid = settings.get<bool>(SettingsManager::Key::RenderGrid).value();
+  bool cpuPicking = settings.get<bool>(SettingsManager::Key::RenderCpuPicking).value();
   bool renderBuildingOutlines = settings.get<bool>(SettingsManager::Key::RenderBuildingOutlines).value();
   SettingsManager::MotionTrailRenderMode renderMotionTrails =
       settings.get<SettingsManager::MotionTrailRenderMode>(SettingsManager::Key::RenderMotionTrails).value();
 
+  /**
+   * Holds only the region around a click, see `pick()`
+   */
   std::unique_ptr<PickingFramebuffer> pickingFbo;
 
+  /**
+   * The width & height of `pickingFbo`, in pixels of the widget
+   */
+  static constexpr int pickRegion = 8;
+
+  /**
+   * The Nodes drawn by `pick()`, reused between picks
+   */
+  std::vector<std::uint32_t> pickCandidates;
+
+  /**
+   * Draw the scene at a resolution picked by `resolutionScaler`,
+   * then upscale it to the widget
+   */
+  bool dynamicResolution = settings.get<bool>(SettingsManager::Key::RenderDynamicResolution).value();
+
+  /**
+   * Lower the quality of frames drawn while the view is in motion, see `reducedQuality`
+   */
+  bool adaptiveQuality = settings.get<bool>(SettingsManager::Key::RenderAdaptiveQuality).value();
+
+  /**
+   * The render scale of frames with `reducedQuality`, on top of `resolutionScaler`.
+   * 1 to keep the full resolution
+   */
+  float adaptiveScale = std::clamp(settings.get<float>(SettingsManager::Key::RenderAdaptiveScale).value(), 0.25f, 1.0f);
+
+  /**
+   * Set by `paintGL()` for a frame drawn while the camera moves, or the timeline is dragged, with `adaptiveQuality`.
+   * Labels, trails, Building outlines, & the transparent pass are left out of it.
+   * Always false outside of `paintGL()`, so exported frames are drawn in full
+   */
+  bool reducedQuality{false};
+
+  /**
+   * Draw `camera` on the left half of the widget,
+   * and `overviewCamera` on the right.
+   * Both views share this context, so every upload is shared as well
+   */
+  bool splitView = settings.get<bool>(SettingsManager::Key::RenderSplitView).value();
+
+  /**
+   * Looks down on the selected Node, or `camera` when there's none,
+   * from `overviewHeight` above it. Only drawn with `splitView`
+   */
+  Camera overviewCamera;
+
+  /**
+   * How far above its target `overviewCamera` is placed
+   */
+  static constexpr float overviewHeight = 50.0f;
+
+  /**
+   * Set by `add()` when model textures should be packed into arrays,
+   * which happens once every texture is uploaded
+   */
+  bool packTexturesPending{false};
+
+  /**
+   * Bytes of meshes & textures to keep on the GPU, before unused ones are evicted.
+   * 0 for no limit
+   */
+  std::size_t gpuMemoryBudget =
+      static_cast<std::size_t>(std::max(0, settings.get<int>(SettingsManager::Key::RenderGpuMemoryBudget).value())) *
+      1024u * 1024u;
+  ResolutionScaler resolutionScaler{settings.get<float>(SettingsManager::Key::RenderTargetFrameTime).value()};
+
+  /**
+   * Target of the scene with `dynamicResolution`, created on the first frame drawn with it.
+   * Picking draws its region at the widget's own resolution, so it stays exact at any scale
+   */
+  std::unique_ptr<SceneFramebuffer> sceneFbo;
+
   DirectionalLight mainLight;
+
+  /**
+   * Loaded on the first frame drawn with `renderSkybox`, see `loadSkyBox()`
+   */
   std::unique_ptr<SkyBox> skyBox;
   std::unique_ptr<Floor> floor;
   std::unique_ptr<CoordinateGrid> coordinateGrid;
   SettingsManager::BuildingRenderMode buildingRenderMode =
       settings.get<SettingsManager::BuildingRenderMode>(SettingsManager::Key::RenderBuildingMode).value();
+
+  /**
+   * Skip drawing the Nodes hidden behind opaque Buildings, see `cullOccluded()`
+   */
+  bool occlusionCulling = settings.get<bool>(SettingsManager::Key::RenderOcclusionCulling).value();
+  OcclusionQueries occlusionQueries;
+
+  /**
+   * The bounds of the Nodes to test against the Buildings this frame,
+   * issued once the Buildings are drawn. Sorted by slot
+   */
+  std::vector<OcclusionQueries::Test> occlusionTests;
   std::unique_ptr<Model> transmissionSphere;
 
+  /**
+   * Draw far away Nodes as cluster markers,
+   * rather than their models, labels, & trails
+   */
+  bool renderClusters = settings.get<bool>(SettingsManager::Key::RenderClusters).value();
+
+  /**
+   * The smallest a cell of `nodeGrid` may look, in pixels,
+   * before its Nodes are drawn as a cluster
+   */
+  static constexpr float clusterPixels = 16.0f;
+
+  /**
+   * Indexes the Nodes by position, updated as Nodes move.
+   * Sized from the bounds of the scenario in `setConfiguration()`
+   */
+  NodeGrid nodeGrid;
+
+  /**
+   * The clusters drawn this frame, from `nodeGrid`
+   */
+  std::vector<NodeGrid::Cluster> clusters;
+
+  /**
+   * Drawn once for each cluster, sized by the number of Nodes in it
+   */
+  std::unique_ptr<Model> clusterMarker;
+
+  /**
+   * The height of `clusterMarker` before scaling
+   */
+  float clusterMarkerHeight{1.0f};
+
+  /**
+   * The count shown above each cluster, by count.
+   * Only built for the counts seen, since labels are kept until the next `reset()`
+   */
+  std::unordered_map<std::size_t, FontManager::FontBannerRenderInfo> clusterLabels;
+
+  /**
+   * Draw the density of Nodes & transmissions over the ground
+   */
+  bool renderHeatmap = settings.get<bool>(SettingsManager::Key::RenderHeatmap).value();
+
+  /**
+   * The width & height of the density texture of `heatmapFbo`
+   */
+  static constexpr int heatmapSize = 256;
+
+  /**
+   * Accumulated each frame while `renderHeatmap` is set
+   */
+  std::unique_ptr<HeatmapFramebuffer> heatmapFbo;
+
+  /**
+   * The corners of the ground covered by the heatmap, X & Z.
+   * Set from the bounds of the scenario in `setConfiguration()`
+   */
+  glm::vec2 heatmapLow{-100.0f};
+  glm::vec2 heatmapHigh{100.0f};
+
+  /**
+   * Draw a top down map of the whole scenario in the corner of the main view
+   */
+  bool renderMinimap = settings.get<bool>(SettingsManager::Key::RenderMinimap).value();
+
+  /**
+   * How many times a second the Nodes on the minimap are redrawn
+   */
+  int minimapRate = std::max(1, settings.get<int>(SettingsManager::Key::RenderMinimapRate).value());
+
+  /**
+   * The width & height of the textures of `minimapFbo`
+   */
+  static constexpr int minimapSize = 512;
+
+  /**
+   * The largest the minimap is shown, in widget pixels.
+   * Smaller in small views, see `minimapRect()`
+   */
+  static constexpr int minimapDisplaySize = 240;
+
+  /**
+   * Made the first time the minimap is drawn
+   */
+  std::unique_ptr<MinimapFramebuffer> minimapFbo;
+
+  /**
+   * The corners of the ground covered by the minimap, X & Z.
+   * Square, around the bounds of the scenario from `setConfiguration()`
+   */
+  glm::vec2 minimapLow{-100.0f};
+  glm::vec2 minimapHigh{100.0f};
+
+  /**
+   * Set when the static content of the minimap must be drawn again,
+   * once the bounds or the Areas & Buildings change
+   */
+  bool minimapStale{true};
+
+  /**
+   * Started when the Nodes on the minimap were last redrawn
+   */
+  QElapsedTimer minimapTimer;
+
   parser::GlobalConfiguration config;
 
   /**
    * Amount of time to advance/rewind `simulationTime`
-   * per frame.
+   * per step of playback.
    */
   parser::nanoseconds timeStep =
       settings.get<parser::nanoseconds>(SettingsManager::Key::PlaybackTimeStepPreference).value();
 
+  /**
+   * Steps of `timeStep` played per second of wall time,
+   * so playback runs at `timeStep * stepsPerSecond` no matter how fast frames are drawn
+   */
+  int stepsPerSecond = std::max(1, settings.get<int>(SettingsManager::Key::PlaybackStepsPerSecond).value());
+
+  /**
+   * Wall time since playback started, see `advancePlayback()`
+   */
+  QElapsedTimer playbackTimer;
+
+  /**
+   * Steps played, or skipped, since `playbackTimer` started
+   */
+  long long playedSteps{0LL};
+
+  /**
+   * How far past `simulationTime` the frame is drawn, the part of the next step already elapsed.
+   * Interpolated moves are drawn at that time, so they glide between steps
+   * at any refresh rate, rather than jumping once per step. See `advancePlayback()`
+   */
+  parser::nanoseconds motionLead{0LL};
+
+  /**
+   * The most steps one frame may catch up on.
+   * Past this, playback skips ahead rather than replaying every missed step
+   */
+  static constexpr long long maxCatchUpSteps = 15LL;
+
+  /**
+   * The most time one frame spends applying events during playback, in nanoseconds.
+   * 0 for no limit
+   */
+  long long eventBudget = std::max(0, settings.get<int>(SettingsManager::Key::PlaybackEventBudget).value()) * 1'000'000LL;
+
+  /**
+   * If the last events handled were reversed, so `events` reads ahead backwards
+   */
+  bool rewinding{false};
+
+  /**
+   * Set when `handleEvents()` ran out of `eventBudget`
+   * before applying every event up to `simulationTime`.
+   * Playback holds the current time until the rest are applied
+   */
+  bool eventsPending{false};
+
+  /**
+   * Set while playback is behind wall time,
+   * from `eventsPending` or from skipping steps, see `playbackBehind()`
+   */
+  bool behind{false};
+
+  /**
+   * Move Nodes in a straight line between their `MoveEvent`s,
+   * rather than jumping at each one. See `updateMotion()`
+   */
+  bool interpolateMotion = settings.get<bool>(SettingsManager::Key::PlaybackInterpolateMotion).value();
+
+  /**
+   * Jump over stretches of playback where nothing changes,
+   * straight to the next event. See `skipIdleTime()`
+   */
+  bool skipIdle = settings.get<bool>(SettingsManager::Key::PlaybackSkipIdle).value();
+
+  /**
+   * Apply many due events at once across the task pool, see `applyEventsParallel()`
+   */
+  bool parallelEvents = settings.get<bool>(SettingsManager::Key::PlaybackParallelEvents).value();
+
+  /**
+   * Finds the next event after the current time of the other widgets following playback,
+   * so skipping idle time does not jump past their events. See `setIdleLookup()`
+   */
+  std::function<std::optional<parser::nanoseconds>()> idleLookup;
+
+  /**
+   * Play backwards, rewinding `timeStep` per step until the beginning
+   */
+  bool reverse{false};
+
   parser::nanoseconds simulationTime;
 
+  /**
+   * The time of the latest event loaded, while the scenario is still loading.
+   * Playback does not advance past this time.
+   * Unset once every event is loaded
+   */
+  std::optional<parser::nanoseconds> loadedTime;
+
+  /**
+   * The time last sent through `timeChanged()`, set while a seek is previewed.
+   * The charts & log are still at this time, see `previewTime()`
+   */
+  std::optional<parser::nanoseconds> previewOrigin;
+
   std::vector<Area> areas;
   std::vector<Building> buildings;
+
+  /**
+   * The geometry of `areas` & `buildings`, with an item for each by index
+   */
+  std::unique_ptr<StaticGeometry> staticGeometry;
+
+  /**
+   * Set instead of `staticGeometry` for scenarios with at least
+   * `RenderStaticPagingItems` Buildings & Areas, loaded around the camera by `cull()`
+   */
+  std::unique_ptr<StaticTiles> staticTiles;
+
+  /**
+   * The descriptions referenced by `nodes`, shared with the other widgets
+   */
+  std::shared_ptr<const parser::StaticModels> staticModels;
   std::unordered_map<unsigned int, Node> nodes;
   std::unordered_map<unsigned int, Decoration> decorations;
-  std::vector<WiredLink> wiredLinks;
+  std::unique_ptr<WiredLinkBatch> wiredLinks;
 
   std::optional<unsigned int> selectedNode;
 
   PlayMode playMode = PlayMode::Paused;
-  std::deque<parser::SceneEvent> events;
-  std::deque<undo::SceneUndoEvent> undoEvents;
 
-#ifndef NDEBUG
-  QOpenGLDebugLogger glLogger{this};
-#endif
+  /**
+   * Every scene event, in time order.
+   * Events are not removed as they are applied, see `nextEvent`.
+   * Pages far from `nextEvent` are spilled to disk over `PlaybackMemoryBudget`
+   */
+  PagedEvents events;
+
+  /**
+   * Index in `events` of the first event which has not been applied
+   */
+  std::size_t nextEvent{0u};
+
+  /**
+   * Snapshots of the scene, for seeking
+   */
+  KeyframeIndex keyframes;
+
+  /**
+   * The events for each Node & Decoration,
+   * and the slot each event applies to
+   */
+  parser::EntityEventStreams streams;
+
+  /**
+   * Transmission & distance totals of each Node, by slot in `streams`
+   */
+  parser::TrafficStatistics traffic;
+
+  /**
+   * The render state of `nodes`, by slot in `streams`.
+   * `nodes` never moves its elements, so the store remains valid until `reset()`
+   */
+  NodeStore nodeStore;
+
+  /**
+   * Bounds of the Nodes in `nodeStore`, by index in the store.
+   * For culling, and picking with `cpuPicking`
+   */
+  BoundingVolumeHierarchy nodeBvh;
+
+  /**
+   * Bounds of `decorations`, by slot in `streams`
+   */
+  BoundingVolumeHierarchy decorationBvh;
+
+  /**
+   * Bounds of `buildings`, by index
+   */
+  BoundingVolumeHierarchy buildingBvh;
+
+  /**
+   * Indices of the visible Nodes in `nodeStore` which may be in view this frame.
+   * Filled by `cull()`
+   */
+  std::vector<std::uint32_t> visibleNodes;
+
+  /**
+   * Decides which labels are drawn, so they do not overlap
+   */
+  LabelLayout labelLayout;
+
+  /**
+   * The Nodes which may show a label this frame, in the order they are placed by `labelLayout`.
+   * Priority first (selected, then explicitly enabled), then distance from the camera
+   */
+  std::vector<std::tuple<int, float, std::uint32_t>> labelCandidates;
+
+  /**
+   * Slots of the Decorations which may be in view this frame,
+   * other than the ones in `decorationBatch`. Filled by `cull()`
+   */
+  std::vector<std::uint32_t> visibleDecorations;
+
+  /**
+   * The Decorations without any events, drawn together.
+   * Unset if there are none
+   */
+  std::unique_ptr<DecorationBatch> decorationBatch;
+
+  /**
+   * Set for each Decoration without any events so far, by slot in `streams`
+   */
+  std::vector<bool> isDecorationStatic;
+
+  /**
+   * Set when `decorationBatch` no longer matches `isDecorationStatic`,
+   * or the models of its Decorations
+   */
+  bool decorationBatchDirty{false};
+
+  /**
+   * Indices of the groups in `decorationBatch` which may be in view this frame.
+   * Filled by `cull()`
+   */
+  std::vector<std::uint32_t> visibleDecorationGroups;
+
+  /**
+   * Indices of the `buildings` which may be in view this frame.
+   * Filled by `cull()`
+   */
+  std::vector<std::uint32_t> visibleBuildings;
+
+  /**
+   * Indices of the Nodes in `nodeStore` with a transmission in view this frame.
+   * Filled by `cull()`
+   */
+  std::vector<std::uint32_t> visibleTransmissions;
+
+  /**
+   * Indices of the Nodes in `nodeStore` marked as transmitting,
+   * kept by `updateTransmitting()` so `cull()` only checks these
+   */
+  std::unordered_set<std::uint32_t> transmittingNodes;
+
+  /**
+   * Indices of the Nodes in `nodeStore` carrying a `parser::NodeLight`
+   */
+  std::vector<std::uint32_t> litNodes;
+
+  /**
+   * The lights of `litNodes` this frame, see `gatherLights()`
+   */
+  std::vector<PointLight> sceneLights;
+
+  /**
+   * `visibleTransmissions` as of the last `Renderer::uploadTransmissions()`
+   */
+  std::vector<std::uint32_t> uploadedTransmissions;
+
+  /**
+   * Set when a transmitting Node changes, so the transmissions must be uploaded again
+   */
+  bool transmissionsChanged{true};
+
+  /**
+   * The projection last given to the `renderer`
+   */
+  glm::mat4 projection{1.0f};
+
+  /**
+   * `decorations` by slot in `streams`
+   */
+  std::vector<Decoration *> decorationSlots;
+
+  /**
+   * Slots of the Nodes changed by the events being handled.
+   * Their render state & bounds are updated once by `updateTouched()`,
+   * however many events touched them
+   */
+  std::vector<std::uint32_t> touchedNodes;
+
+  /**
+   * Set for each slot in `touchedNodes`, by slot
+   */
+  std::vector<bool> isNodeTouched;
+
+  /**
+   * Slots of the Decorations changed by the events being handled,
+   * see `touchedNodes`
+   */
+  std::vector<std::uint32_t> touchedDecorations;
+
+  /**
+   * Set for each slot in `touchedDecorations`, by slot
+   */
+  std::vector<bool> isDecorationTouched;
+
+  /**
+   * Slots of the Nodes whose trail must be filled again, see `markTrailStale()`
+   */
+  std::vector<std::uint32_t> staleTrails;
+
+  /**
+   * Set for each slot in `staleTrails`, by slot
+   */
+  std::vector<bool> isTrailStale;
+
+  /**
+   * Set for each Node whose events were skipped, by slot,
+   * until its state is rebuilt by `catchUpNode()`
+   */
+  std::vector<bool> isNodeStale;
+
+  /**
+   * The due events of one partition, and what applying them changed,
+   * kept apart from the other partitions until they are merged.
+   * See `applyEventsParallel()`
+   */
+  struct EventPartition {
+    std::vector<std::size_t> events;
+    std::vector<std::uint32_t> touchedNodes;
+    std::vector<std::uint32_t> touchedDecorations;
+    std::vector<std::uint32_t> staleNodes;
+    bool selectedNodeUpdated{false};
+  };
+
+  /**
+   * One per task pool worker, and one last for the events applied on this thread.
+   * Kept between calls for their allocations
+   */
+  std::vector<EventPartition> eventPartitions;
+
+#ifndef NDEBUG
+  QOpenGLDebugLogger glLogger{this};
+#endif
+
+  /**
+   * Apply the events up to `simulationTime`
+   *
+   * @param budgeted
+   * If set, stop once `eventBudget` is spent and set `eventsPending`,
+   * so the rest are applied over the following frames
+   */
+  void handleEvents(bool budgeted = false);
+
+  /**
+   * Add events to the keyframes, event streams, traffic, & trajectories,
+   * before they are added to `events`
+   *
+   * @param first
+   * The first event, which will be at `events.size()`
+   *
+   * @param last
+   * One past the last event
+   */
+  void indexEvents(const parser::SceneEvent *first, const parser::SceneEvent *last);
+
+  /**
+   * Apply the events from `nextEvent` to `end` across the task pool.
+   * Every event of a Node or Decoration is applied by the same thread, in order,
+   * so the result is the same as applying them one by one.
+   * Nodes with wired links move vertices shared with other Nodes, so their events are applied
+   * on this thread, after the others. The touched & stale slots are merged once every partition is done
+   *
+   * @param end
+   * One past the last event to apply. Every event before it must be due
+   *
+   * @return
+   * True if the selected Node was changed
+   */
+  bool applyEventsParallel(std::size_t end);
+
+  /**
+   * Reverse the applied events at, or after, `simulationTime`
+   */
+  void handleUndoEvents();
+
+  /**
+   * Find the changes which reverse an applied event.
+   * Derived from the event of the same kind it replaced for the same Node/Decoration
+   * (see `parser::EntityEventStreams::previousOfKind()`), or the initial state,
+   * so nothing is kept per applied event, and each reversal is constant time
+   *
+   * @param index
+   * The index in `events` of the event to reverse.
+   * Must be the last applied event in the stream for `slot`
+   *
+   * @param slot
+   * The slot of the Node/Decoration for the event
+   *
+   * @return
+   * The changes to pass to the Node/Decoration `handle()`
+   */
+  [[nodiscard]] undo::SceneUndoEvent reverseEvent(std::size_t index, std::uint32_t slot);
+
+  /**
+   * Mark a Node as changed by an event, for `updateTouched()`
+   *
+   * @param slot
+   * The slot of the Node in `streams`
+   */
+  void touchNode(std::uint32_t slot);
+
+  /**
+   * Mark a Decoration as changed by an event, for `updateTouched()`
+   *
+   * @param slot
+   * The slot of the Decoration in `streams`
+   */
+  void touchDecoration(std::uint32_t slot);
+
+  /**
+   * Update the render state, bounds & transmissions of every touched Node & Decoration,
+   * once the events for this frame are handled
+   */
+  void updateTouched();
+
+  /**
+   * If the events of a Node may be skipped, moving only its stream's cursor.
+   * A hidden Node is not drawn, so nothing reads its state until it is looked at.
+   * Never for the selected Node, a Node with wired links, which follow it,
+   * or while the heatmap or minimap, which show every Node, are drawn
+   *
+   * @param slot
+   * The slot of the Node in `streams`
+   */
+  [[nodiscard]] bool isNodeDeferred(std::uint32_t slot) const;
+
+  /**
+   * Mark a Node as having skipped events, see `isNodeDeferred()`
+   *
+   * @param slot
+   * The slot of the Node in `streams`
+   */
+  void markStale(std::uint32_t slot);
+
+  /**
+   * Rebuild the state of a Node whose events were skipped, from the keyframe before `nextEvent`
+   * & the Node's own events since, so it costs that Node's events rather than every event.
+   * Touches the Node, so call `updateTouched()` after
+   *
+   * @param slot
+   * The slot of the Node in `streams`
+   */
+  void catchUpNode(std::uint32_t slot);
+
+  /**
+   * `catchUpNode()` for every stale Node, then `updateTouched()`
+   */
+  void catchUpNodes();
+
+  /**
+   * Point a Node's motion at its next waypoint, with `interpolateMotion`.
+   * The Node moves from its last waypoint, or initial position, at that waypoint's time
+   *
+   * @param slot
+   * The slot of the Node in `nodeStore`
+   */
+  void updateMotion(std::uint32_t slot);
+
+  /**
+   * `updateMotion()` for every Node, along with its bounds
+   */
+  void updateMotions();
+
+  /**
+   * Start `traffic` over, with each Node at its initial position in `streams`
+   */
+  void resetTraffic();
+
+  /**
+   * Give a Node storage for its motion trail,
+   * and fill it from the Node's moves applied so far
+   *
+   * @param slot
+   * The slot of the Node in `nodeStore`
+   */
+  void allocateTrail(std::uint32_t slot);
+
+  /**
+   * Replace a Node's trail with the last of its moves applied so far, from its stream.
+   * Only touches the Node & reads the events, so trails may be filled on several threads
+   *
+   * @param slot
+   * The slot of the Node in `nodeStore`. Its trail must be allocated
+   */
+  void fillTrail(std::uint32_t slot);
+
+  /**
+   * Mark a Node's trail to be filled again, if it is allocated.
+   * Trails only grow forwards, so one is stale once its moves are undone, or its Node restored
+   *
+   * @param slot
+   * The slot of the Node in `nodeStore`
+   */
+  void markTrailStale(std::uint32_t slot);
+
+  /**
+   * `fillTrail()` for every stale trail, spread over the task pool when there are many.
+   * The trails are uploaded by `flushTrails()`
+   */
+  void rebuildStaleTrails();
+
+  /**
+   * Allocate the trails about to be drawn, release the ones turned off,
+   * & stage the new points of those drawn in `uploadRing`
+   */
+  void flushTrails();
+
+  /**
+   * Drop every trajectory, leaving each Node at its initial position.
+   * Only with a `trailWindow`
+   */
+  void resetTrajectories();
+
+  /**
+   * Add the point a Node moves to in `event` to its trajectory.
+   * Only with a `trailWindow`
+   *
+   * @param slot
+   * The slot for `event`, see `parser::EntityEventStreams::slot()`
+   *
+   * @param event
+   * The event just added. Ignored unless it moves a Node
+   */
+  void extendTrajectory(std::uint32_t slot, const parser::SceneEvent &event);
+
+  /**
+   * Move `simulationTime` by every step due since the last frame, according to `playbackTimer`.
+   * A slow frame catches up on the steps it missed, up to `maxCatchUpSteps`
+   *
+   * @return
+   * How far `simulationTime` moved, 0 when paused or no step is due yet
+   */
+  parser::nanoseconds advancePlayback();
+
+  /**
+   * Set `behind`, emitting `playbackBehind()` if it changed
+   */
+  void setBehind(bool value);
+
+  /**
+   * With `skipIdle`, move `simulationTime` forward to the next event,
+   * from the scene or `idleLookup`, if reaching it would otherwise take
+   * more than a second of playback. Emits `idleSkipped()` on a jump.
+   * Nothing is skipped while a transmission is being drawn
+   *
+   * @return
+   * True if `simulationTime` was moved
+   */
+  bool skipIdleTime();
+
+  /**
+   * Find the first event after `time`
+   *
+   * @param time
+   * The time to search for
+   *
+   * @return
+   * The index in `events` of the first event after `time`,
+   * or the size of `events` if there is none
+   */
+  [[nodiscard]] std::size_t firstEventAfter(parser::nanoseconds time) const;
+
+  /**
+   * Bring the scene to `simulationTime` from the closest keyframe,
+   * or by reversing events, if they are closer
+   */
+  void seek();
+
+  /**
+   * Set every Node & Decoration to their state in `keyframe`
+   *
+   * @param keyframe
+   * The keyframe to restore
+   */
+  void restore(const KeyframeIndex::Keyframe &keyframe);
+
+  /**
+   * The world space bounds of a Node in `nodeStore`,
+   * covering all of its motion to the next waypoint
+   *
+   * @param index
+   * The index of the Node in `nodeStore`
+   */
+  [[nodiscard]] BoundingVolumeHierarchy::Box nodeBounds(std::size_t index) const;
+
+  /**
+   * The world space bounds of a Decoration
+   *
+   * @param slot
+   * The slot of the Decoration in `streams`
+   */
+  [[nodiscard]] BoundingVolumeHierarchy::Box decorationBounds(std::size_t slot) const;
+
+  /**
+   * Clear `isDecorationStatic` for the Decorations with events,
+   * after more events are enqueued
+   */
+  void updateStaticDecorations();
+
+  /**
+   * Build & upload `decorationBatch` from the Decorations in `isDecorationStatic`.
+   * Requires a current context
+   */
+  void rebuildDecorationBatch();
+
+  /**
+   * Add or remove a Node from `transmittingNodes`,
+   * after an event or restore changed it
+   *
+   * @param index
+   * The index of the Node in `nodeStore`
+   */
+  void updateTransmitting(std::uint32_t index);
+
+  /**
+   * Find the Nodes, Decorations & Buildings in view of a camera,
+   * for this frame's passes. Requires `renderer.use()` to be called with the camera first
+   *
+   * @param view
+   * The camera to cull for
+   */
+  void cull(const Camera &view);
+
+  /**
+   * A click waiting for the next `paintGL()` to pick it
+   */
+  std::optional<QPoint> queuedClick;
+
+  /**
+   * The click `pickingFbo` is reading back
+   */
+  QPoint pickedClick;
+
+  /**
+   * Render the `pickRegion` pixels around a click into the picking framebuffer,
+   * at the widget's resolution, and queue a read of the clicked pixel.
+   * Only the Nodes drawn this frame which reach into the region are drawn.
+   * The read is finished by `finishPick()` on a later frame.
+   * Requires a current context
+   *
+   * @param x
+   * The X coordinate of the pixel, from the left
+   *
+   * @param y
+   * The Y coordinate of the pixel, from the bottom
+   */
+  void pick(int x, int y);
+
+  /**
+   * Select the object read back from the picking framebuffer.
+   * If there's nothing there, start moving the camera instead,
+   * if the button is still held
+   *
+   * @param pixel
+   * The pixel under `pickedClick`
+   */
+  void finishPick(const PickingFramebuffer::PixelInfo &pixel);
+
+  /**
+   * Give the Nodes & Decorations using models swapped in by `ModelCache::poll()`
+   * the real bounds of those models
+   *
+   * @param loaded
+   * The models swapped in
+   */
+  void swapModels(const std::vector<model_id> &loaded);
+
+  /**
+   * Evict the models & textures no Node or Decoration uses,
+   * if the caches hold more than `gpuMemoryBudget`
+   */
+  void enforceMemoryBudget();
+
+  /**
+   * Start moving the camera with the mouse, from a click at `position`
+   */
+  void startMouseMove(const QPoint &position);
+
+  /**
+   * Find the Node under the cursor by casting a ray against `nodeBvh`.
+   * Does not use the picking framebuffer
+   *
+   * @param x
+   * The X coordinate of the cursor, from the left
+   *
+   * @param y
+   * The Y coordinate of the cursor, from the top
+   *
+   * @return
+   * The ID of the closest Node under the cursor, unset if there is none
+   */
+  [[nodiscard]] std::optional<unsigned int> pickCpu(int x, int y);
+
+  /**
+   * Timings for each stage of `paintGL()`
+   */
+  FrameProfiler profiler;
+
+  /**
+   * Draw the profiler's summary over the scene
+   */
+  void paintProfiler();
+
+  /**
+   * @return
+   * The size of the widget's framebuffer, scaled by `resolutionScaler`,
+   * & by `adaptiveScale` with `reducedQuality`
+   */
+  [[nodiscard]] QSize scaledSize() const;
+
+  /**
+   * Draw the scene to `sceneFbo`, at a lower resolution if it is running slow,
+   * then upscale it to the widget's framebuffer
+   */
+  void renderScaledScene();
+
+  /**
+   * Draw the scene at `simulationTime` to the bound framebuffer.
+   * Does not handle events or move the camera
+   *
+   * @param view
+   * The camera to draw the scene from
+   */
+  void renderScene(const Camera &view);
+
+  /**
+   * Draw `overviewCamera` to the right half of the widget, then `camera` to the left.
+   * Leaves the viewport on the left half, so picking matches `camera`
+   */
+  void renderSplitView();
+
+  /**
+   * The width of the part of the widget `camera` is drawn to
+   */
+  [[nodiscard]] int mainViewWidth() const;
+
+  /**
+   * Draw the minimap over the corner of the main view,
+   * redrawing its static content if stale, & its Nodes at `minimapRate`
+   */
+  void drawMinimap();
+
+  /**
+   * Draw the floor, Areas, & Buildings, from straight above, into `minimapFbo`.
+   * Restores the bound framebuffer, viewport, & projection after
+   */
+  void drawMinimapStatic();
+
+  /**
+   * The area of the widget the minimap is drawn over, in the bottom right of the main view
+   */
+  [[nodiscard]] QRect minimapRect() const;
+
+  /**
+   * Move `camera` over the point of the ground shown at `position` on the minimap,
+   * keeping its height & rotation
+   *
+   * @param position
+   * The point in the widget, inside `minimapRect()`
+   */
+  void teleportCamera(const QPoint &position);
+
+  /**
+   * Target of `exportFrame()`, only set while exporting
+   */
+  std::unique_ptr<ExportFramebuffer> exportFbo;
+
+  /**
+   * Where the frames of the current export are written
+   */
+  QString exportDirectory;
+
+  /**
+   * Amount of simulation time between exported frames,
+   * `timeStep` as of `startExport()`
+   */
+  parser::nanoseconds exportStep{0LL};
+
+  /**
+   * The number of the first frame of the current export, see `startExport()`
+   */
+  unsigned long long exportFirstFrame{0u};
+
+  /**
+   * The number of the next frame of the current export sent to `frameWriter`
+   */
+  unsigned long long exportedFrames{0u};
+
+  /**
+   * Frames of the current export still to draw. Unset to draw up to the end of the scenario
+   */
+  std::optional<unsigned long long> exportFramesLeft;
+
+  /**
+   * Frames are held in memory until they are written,
+   * so stop rendering while this many are waiting
+   */
+  static constexpr int maxPendingFrames = 8;
+
+  /**
+   * Drives `exportFrame()` as often as the event loop allows
+   */
+  QTimer exportTimer{this};
+
+  /**
+   * The shots of the current capture, see `startCapture()`. Empty unless capturing
+   */
+  std::vector<ShotList::Shot> captureShots;
+
+  /**
+   * The index in `captureShots` of the next shot to draw
+   */
+  std::size_t nextShot{0u};
+
+  /**
+   * Where the shots of the current capture are written
+   */
+  QString captureDirectory;
+
+  /**
+   * The file of each shot drawn, but not read back from `exportFbo` yet, oldest first
+   */
+  std::deque<QString> captureFiles;
+
+  /**
+   * The shots being encoded on the task pool, oldest first
+   */
+  std::deque<parser::TaskPool::Handle> captureWrites;
+
+  /**
+   * The shots which could not be written. Shared with the encoding tasks
+   */
+  std::shared_ptr<std::atomic<int>> captureFailures{std::make_shared<std::atomic<int>>(0)};
+
+  /**
+   * Drives `captureShot()` as often as the event loop allows
+   */
+  QTimer captureTimer{this};
+
+  /**
+   * The absolute path of the model shown by `previewModel()`.
+   * Unset while a scenario is loaded
+   */
+  std::optional<std::string> previewPath;
+
+  /**
+   * Watches `previewPath`, so the preview follows edits to the model
+   */
+  QFileSystemWatcher previewWatcher{this};
+
+  /**
+   * Gathers the writes of one save into a single `refreshPreview()`
+   */
+  QTimer previewRefreshTimer{this};
+
+  /**
+   * Lives on `writerThread`, see `frameReady()`
+   */
+  FrameWriter frameWriter;
+
+  /**
+   * Also lives on `writerThread`, see `streamFrameReady()`
+   */
+  RenderServer renderServer;
+  QThread writerThread;
+
+  /**
+   * Leads, or follows, the other viewers of a video wall, see `leadWall()` & `joinWall()`
+   */
+  WallSync wallSync;
+
+  /**
+   * The frame from the wall's leader drawn last, answered once it is swapped to the screen
+   */
+  std::optional<std::uint64_t> wallFrame;
+
+  /**
+   * The part of the wall drawn, see `setWallTile()`
+   */
+  std::optional<WallTile> wallTile;
+
+  /**
+   * Draw the latest frame from the wall's leader, see `joinWall()`
+   */
+  void applyWallFrame();
+
+  /**
+   * Replace the scene's Decorations with a single one of `model`
+   */
+  void showPreview(const Model &model);
+
+  /**
+   * Import the previewed model again, after it changed on disk.
+   * Only that model is imported, the rest of the model cache is kept
+   */
+  void refreshPreview();
+
+  /**
+   * Stop watching the previewed model
+   */
+  void stopPreview();
+
+  /**
+   * Put the models & textures of the open scenario first
+   * among the ones warmed after the next startup.
+   * Does nothing without a scenario open
+   */
+  void rememberAssets();
+
+  /**
+   * Render & read back the frame at `simulationTime`, then step to the next.
+   * Ends the export once the end of the scenario is reached
+   */
+  void exportFrame();
+
+  /**
+   * Send a frame read back from `exportFbo` to `frameWriter`
+   */
+  void queueFrame(const QImage &frame);
+
+  /**
+   * Seek to the next shot of the capture, draw it, & read it back.
+   * Ends the capture after the last shot
+   */
+  void captureShot();
+
+  /**
+   * Encode a shot read back from `exportFbo` on the task pool,
+   * to the oldest file in `captureFiles`
+   */
+  void writeShot(const QImage &frame);
+
+  /**
+   * Target of `streamFrame()`, only set while a client is connected to `renderServer`
+   */
+  std::unique_ptr<ExportFramebuffer> streamFbo;
+
+  /**
+   * The size the client asked for, see `RenderServer`
+   */
+  QSize streamSize{1280, 720};
+
+  /**
+   * Set when a frame was not streamed, since the last one was still being sent,
+   * so another is drawn once it is
+   */
+  bool streamSkipped = false;
+
+  /**
+   * Draw `camera` once more, at the size the client asked for,
+   * & send it to `renderServer`. Does nothing without a client
+   */
+  void streamFrame();
+
+  /**
+   * Set while the camera is recorded, see `startRecordingPath()`
+   */
+  std::optional<CameraPath> recordedPath;
+
+  /**
+   * Wall time since `startRecordingPath()`
+   */
+  QElapsedTimer recordTimer;
+
+  /**
+   * The path being replayed, only set during a replay, see `startReplay()`
+   */
+  std::optional<CameraPath> replayPath;
+
+  /**
+   * Frames timed along `replayPath`
+   */
+  std::size_t replayFrames{0u};
+
+  /**
+   * Frames drawn since the replay started,
+   * including the frames drawn after the path while the GPU timings are read
+   */
+  std::size_t replayFrame{0u};
+
+  /**
+   * The profiler's number for the first frame of the replay
+   */
+  std::uint64_t replayFirstFrame{0u};
+
+  /**
+   * If the profiler was on before the replay turned it on
+   */
+  bool replayProfilerWasEnabled{false};
+
+  /**
+   * The view & time from before the replay, restored once it finishes
+   */
+  CameraPath::Sample replayOrigin;
+
+  /**
+   * Move the camera & time to where `replayPath` is at the current replay frame
+   */
+  void applyReplayFrame();
+
+  /**
+   * Count a drawn replay frame, and finish the replay after the last one
+   */
+  void advanceReplay();
+
+  /**
+   * Keep drawing frames only while playing, or while the camera moves.
+   * Otherwise frames are only drawn after a call to `update()`
+   */
+  void updateTimer();
+
+  /**
+   * Ask for the next frame once the last is swapped, so frames follow the display's refresh,
+   * and never queue up behind it. With a `frameCap`, wait out the rest of the frame's share of a second first
+   */
+  void scheduleFrame();
+
+  /**
+   * Rebuild `nodeGrid` from the position of every Node
+   */
+  void updateNodeGrid();
+
+  /**
+   * Pick the Nodes to collapse into `clusters` for this frame,
+   * & remove them from `visibleNodes`
+   *
+   * @param view
+   * The camera the frame is drawn from
+   */
+  void collapseClusters(const Camera &view);
+
+  /**
+   * Remove the Nodes the last queries found hidden behind the Buildings
+   * from `visibleNodes` & `visibleTransmissions`, and fill `occlusionTests` for this frame.
+   * Only with `occlusionCulling`, opaque Buildings, & a single view,
+   * since each Node has one query
+   *
+   * @param view
+   * The camera the frame is drawn from
+   */
+  void cullOccluded(const Camera &view);
+
+  /**
+   * Draw one pass of the Buildings & Areas, from `staticTiles` when they are paged
+   *
+   * @param pass
+   * The pass to draw
+   *
+   * @param culled
+   * Only draw the Buildings in `visibleBuildings`
+   *
+   * @param color
+   * A color for every vertex, unset for the color of each item. Only used when `culled`
+   */
+  void renderStatic(StaticGeometry::Pass pass, bool culled, const std::optional<glm::vec3> &color = {});
+
+  /**
+   * Fill `sceneLights` from the visible `litNodes`, where their models are drawn this frame
+   */
+  void gatherLights();
 
-  void handleEvents();
-  void handleUndoEvents();
+  /**
+   * Read the skybox images & upload them.
+   * Not done at startup, since the skybox may be disabled
+   */
+  void loadSkyBox();
 
 protected:
   void initializeGL() override;
@@ -156,13 +1522,73 @@ public:
   ~SceneWidget() override;
   void setConfiguration(parser::GlobalConfiguration configuration);
   void reset();
+
+  /**
+   * Drop every event, and return each Node & Decoration to its initial state,
+   * keeping the scene itself, its models & GPU buffers, for a reload of the same scene.
+   * Events for the reloaded scenario are then added with `enqueueEvents()`
+   */
+  void resetEvents();
+
+  /**
+   * Add the memory held by the scene's events & keyframes,
+   * and its buffers & textures on the GPU
+   *
+   * @param report
+   * The report to add to
+   */
+  void reportMemory(MemoryReport &report) const;
+
+  /**
+   * Time spent by the scene's caches, since they were created
+   */
+  struct LoadTimes {
+    /**
+     * Waiting for models which were not imported in the background yet
+     */
+    std::chrono::steady_clock::duration modelImport{};
+    std::chrono::steady_clock::duration modelUpload{};
+    std::chrono::steady_clock::duration textureUpload{};
+  };
+
+  /**
+   * @return
+   * The time spent on models & textures so far.
+   * One load is timed by the difference between two calls
+   */
+  [[nodiscard]] LoadTimes getLoadTimes() const;
+
+  /**
+   * @return
+   * The frames & events counted so far.
+   * An interval is measured by the difference between two calls,
+   * apart from the longest frame, which is restarted by each call
+   */
+  [[nodiscard]] FrameCounters takeFrameCounters();
+
+  /**
+   * Start building a model in the background,
+   * so adding a Node or Decoration with it only has to upload it
+   *
+   * @param path
+   * The model, as given by the scenario
+   */
+  void prefetchModel(const QString &path);
+
+  /**
+   * Add the static parts of a scenario to the scene
+   *
+   * @param sharedModels
+   * The Nodes & Decorations to add. Kept until `reset()`,
+   * the Nodes reference their descriptions in it
+   */
   void add(const std::vector<parser::Area> &areaModels, const std::vector<parser::Building> &buildingModels,
-           const std::vector<parser::Decoration> &decorationModels, const std::vector<parser::WiredLink> &links,
-           const std::vector<parser::Node> &nodeModels);
+           std::shared_ptr<const parser::StaticModels> sharedModels, const std::vector<parser::WiredLink> &links);
 
   /**
    * Load an individual model specified by `modelPath`
-   * as a `Decoration` in the center of the scene
+   * as a `Decoration` in the center of the scene.
+   * The model is imported again whenever its file changes
    *
    * @param modelPath
    * The absolute path to the model to load
@@ -192,7 +1618,38 @@ public:
    */
   const Node &getNode(unsigned int nodeId);
 
+  /**
+   * Find where a Node is at `time`, without moving the scene there.
+   * Only searches the events for that Node
+   *
+   * @param nodeId
+   * The ID of the Node to find
+   *
+   * @param time
+   * The time to find the Node at
+   *
+   * @return
+   * The position of the Node in ns-3 coordinates,
+   * unset if there is no Node with `nodeId`
+   */
+  [[nodiscard]] std::optional<parser::Ns3Coordinate> getNodePosition(unsigned int nodeId,
+                                                                     parser::nanoseconds time) const;
+
   void enqueueEvents(const std::vector<parser::SceneEvent> &e);
+  void enqueueEvents(std::vector<parser::SceneEvent> &&e);
+
+  /**
+   * Read the scene events from a mapping shared with other viewers of the scenario,
+   * rather than holding a copy of them, see `PagedEvents::attach()`.
+   *
+   * With no events yet, every event is indexed as if it were enqueued.
+   * Events already enqueued are only replaced if there are as many shared ones,
+   * as they were parsed from the same scenario
+   *
+   * @param shared
+   * The events of the scenario loaded
+   */
+  void attachEvents(std::shared_ptr<const parser::SharedEvents> shared);
   void resetCamera();
 
   /**
@@ -203,6 +1660,29 @@ public:
    */
   [[nodiscard]] Camera &getCamera();
 
+  /**
+   * Capture the state of every Node & Decoration at the current time,
+   * for a saved session
+   *
+   * @return
+   * The state after every applied event,
+   * unset if no scenario has been added
+   */
+  [[nodiscard]] std::optional<KeyframeIndex::Keyframe> captureKeyframe() const;
+
+  /**
+   * Jump to `time` from a saved session.
+   * `keyframe` is restored directly when it fits the loaded scenario,
+   * see `KeyframeIndex::fits()`, otherwise the scene seeks from its own keyframes
+   *
+   * @param time
+   * The time the session was saved at
+   *
+   * @param keyframe
+   * The state from `captureKeyframe()` when the session was saved
+   */
+  void restoreSession(parser::nanoseconds time, const KeyframeIndex::Keyframe &keyframe);
+
   /**
    * Update the projection matrix
    * for when the FOV or window size changes
@@ -222,7 +1702,28 @@ public:
    * The time increment, in milliseconds
    */
   void setTime(parser::nanoseconds value);
+
+  /**
+   * Show the scene at `value`, without announcing it through `timeChanged()`.
+   * Used while the timeline is dragged, so only the scene is seeked.
+   * Playback holds until `setTime()` finishes the seek
+   *
+   * @param value
+   * The time to show
+   */
+  void previewTime(parser::nanoseconds value);
   void setTimeStep(parser::nanoseconds value);
+
+  /**
+   * Limit playback to the events loaded so far,
+   * for scenarios which are still loading.
+   * Extends the end time if `value` is past it
+   *
+   * @param value
+   * The time of the latest loaded event.
+   * Unset once every event has been loaded
+   */
+  void setLoadedTime(std::optional<parser::nanoseconds> value);
   QSize sizeHint() const override;
 
   /**
@@ -295,11 +1796,380 @@ public:
   void setSelectedNode(unsigned int nodeId);
   void clearSelectedNode();
 
+  /**
+   * Pick Nodes with a ray against their bounds on the CPU,
+   * rather than from the picking framebuffer
+   *
+   * @param enable
+   * True to pick on the CPU, false to use the picking framebuffer
+   */
+  void setCpuPicking(bool enable);
+
+  /**
+   * Draw the scene at a lower resolution while frames take longer
+   * on the GPU than the `RenderTargetFrameTime` setting
+   *
+   * @param enable
+   * True to scale the resolution, false to always draw at full resolution
+   */
+  void setDynamicResolution(bool enable);
+
+  /**
+   * Show or hide the top down view beside the main one.
+   * The views draw at full resolution, even with dynamic resolution enabled
+   *
+   * @param enable
+   * True to split the widget between both views, false to only draw the main one
+   */
+  void setSplitView(bool enable);
+
+  /**
+   * Draw far away Nodes as cluster markers, with the number of Nodes in each.
+   * Close Nodes are still drawn as usual
+   *
+   * @param enable
+   * True to collapse far away Nodes, false to always draw every Node
+   */
+  void setRenderClusters(bool enable);
+
+  /**
+   * Draw the density of Nodes & active transmissions over the ground,
+   * from blue where there are few, to red where there are many
+   *
+   * @param enable
+   * True to draw the heatmap, false to hide it
+   */
+  void setRenderHeatmap(bool enable);
+
+  /**
+   * Show a top down map of the whole scenario, which moves the camera when clicked
+   *
+   * @param enable
+   * True to draw the minimap, false to hide it
+   */
+  void setRenderMinimap(bool enable);
+
+  /**
+   * Lower the quality of frames while the view is in motion,
+   * returning to full quality on the first still frame
+   *
+   * @param enable
+   * True to reduce the quality while moving
+   */
+  void setAdaptiveQuality(bool enable);
+
+  /**
+   * Set the render scale of frames drawn while the view is in motion, with adaptive quality
+   *
+   * @param value
+   * The fraction of the full resolution to draw at, 1 to keep the full resolution
+   */
+  void setAdaptiveScale(float value);
+
+  /**
+   * Time the GPU with a `PerformanceProbe`, and store the graphics settings picked from it.
+   * Emits `performancePresetApplied()` once stored, so they may be applied
+   */
+  void probePerformance();
+
+  /**
+   * Move Nodes smoothly between their positions, rather than jumping to each
+   *
+   * @param enable
+   * True to interpolate between `MoveEvent`s
+   */
+  void setInterpolateMotion(bool enable);
+
+  /**
+   * Play backwards towards the beginning, rather than forwards
+   *
+   * @param enable
+   * True to rewind `timeStep` per step of playback
+   */
+  void setReverse(bool enable);
+
+  /**
+   * Jump over stretches of playback with no events, rather than playing through them
+   *
+   * @param enable
+   * True to skip to the next event when none are due for more than a second
+   */
+  void setSkipIdle(bool enable);
+
+  /**
+   * Set the lookup of the next event after the current time
+   * of the other widgets following playback, considered when skipping idle time
+   *
+   * @param lookup
+   * Returns the earliest next event time, unset if there are none
+   */
+  void setIdleLookup(std::function<std::optional<parser::nanoseconds>()> lookup);
+
+  /**
+   * Show/hide the profiling overlay.
+   * Timings are only collected while it is shown
+   *
+   * @param enable
+   * True to show the overlay, false to hide it
+   */
+  void setProfilerEnabled(bool enable);
+
+  /**
+   * Write the timings of the latest frames to a CSV file
+   *
+   * @param path
+   * The file to write
+   *
+   * @return
+   * True if the file was written, false otherwise
+   */
+  [[nodiscard]] bool exportProfile(const QString &path) const;
+
+  /**
+   * Render every frame from the start of the scenario to a numbered sequence of PNG images.
+   * Frames are drawn offscreen, one playback time step apart, as fast as they can be written,
+   * rather than in real time. Playback is paused for the export
+   *
+   * @param directory
+   * The directory to write the frames to
+   *
+   * @param width
+   * The width of each frame, in pixels
+   *
+   * @param height
+   * The height of each frame, in pixels
+   *
+   * @param firstFrame
+   * The number of the first frame to render, which is drawn at `firstFrame` time steps,
+   * so a range of an export may be rendered on its own, see `exportFrameCount()`
+   *
+   * @param frames
+   * The most frames to render, unset to render up to the end of the scenario
+   */
+  void startExport(const QString &directory, int width, int height, unsigned long long firstFrame = 0u,
+                   std::optional<unsigned long long> frames = {});
+
+  /**
+   * @return
+   * The number of frames an export of the whole scenario renders, at the current time step
+   */
+  [[nodiscard]] unsigned long long exportFrameCount() const;
+
+  /**
+   * End the current export early.
+   * The frames already drawn are still written
+   */
+  void stopExport();
+
+  [[nodiscard]] bool isExporting() const;
+
+  /**
+   * Render an image of each shot, seeking between them through the keyframes,
+   * rather than applying every event in between. Shots are drawn offscreen & encoded on the task pool,
+   * so the window need not be shown. Playback is paused for the capture.
+   * The scenario must be fully loaded. Emits `captureFinished()` once every image is written
+   *
+   * @param shots
+   * The times & views to capture, written as `shot-0000.png` onwards, in order
+   *
+   * @param directory
+   * The directory to write the images to
+   *
+   * @param width
+   * The width of each image, in pixels
+   *
+   * @param height
+   * The height of each image, in pixels
+   */
+  void startCapture(const ShotList &shots, const QString &directory, int width, int height);
+
+  /**
+   * Stream the view to a remote client, see `RenderServer`.
+   * The client drives the camera & playback, as well as anyone at this window
+   *
+   * @param address
+   * Where to listen, see `parser::IngestSocket::listen()`
+   *
+   * @return
+   * A description of the error, if the socket could not be opened,
+   * an unset optional otherwise
+   */
+  [[nodiscard]] std::optional<QString> serve(const QString &address);
+
+  /**
+   * Disconnect the remote client, if any, and stop listening
+   */
+  void stopServing();
+
+  /**
+   * Draw only `tile` of the view, so the view spans a wall of viewers.
+   * The field of view is then that of the whole wall
+   *
+   * @param tile
+   * The tile to draw, unset to draw the whole view again
+   */
+  void setWallTile(std::optional<WallTile> tile);
+
+  /**
+   * Lead a video wall, sending each frame to its render nodes, see `WallSync`.
+   * Playback & the camera are driven from here, as usual
+   *
+   * @param nodes
+   * Where each node listens, see `parser::IngestSocket::connect()`
+   *
+   * @return
+   * A description of the error, if any node could not be reached,
+   * an unset optional otherwise
+   */
+  [[nodiscard]] std::optional<QString> leadWall(const QStringList &nodes);
+
+  /**
+   * Render one tile of a video wall, see `setWallTile()`, following the time & camera of its leader.
+   * Playback is paused, since the leader plays
+   *
+   * @param address
+   * Where to listen for the leader, see `parser::IngestSocket::listen()`
+   *
+   * @return
+   * A description of the error, if the socket could not be opened,
+   * an unset optional otherwise
+   */
+  [[nodiscard]] std::optional<QString> joinWall(const QString &address);
+
+  /**
+   * Stop leading, or following, a video wall
+   */
+  void leaveWall();
+
+  /**
+   * Start recording the camera, & the playback state, on each frame drawn
+   */
+  void startRecordingPath();
+
+  /**
+   * @return
+   * The path recorded since `startRecordingPath()`
+   */
+  CameraPath stopRecordingPath();
+
+  [[nodiscard]] bool isRecordingPath() const;
+
+  /**
+   * Draw `frames` frames spread evenly along `path`, with the profiler on,
+   * then restore the view & time. Playback is paused during the replay,
+   * so the same path draws the same frames every time.
+   * `replayFinished()` is emitted with the frame times
+   *
+   * @param path
+   * The path to follow
+   *
+   * @param frames
+   * The frames to draw, at most `FrameProfiler::maxTimedFrames`
+   */
+  void startReplay(CameraPath path, std::size_t frames);
+
+  [[nodiscard]] bool isReplaying() const;
+
+  /**
+   * Every scene event loaded so far, in time order.
+   * Use with `getStreams()` for range queries, e.g. `getStreams().nodeEvents(id, from, to, getEvents())`
+   */
+  [[nodiscard]] const PagedEvents &getEvents() const;
+
+  /**
+   * The events indexed by Node, Decoration, & type, see `parser::EntityEventStreams`
+   */
+  [[nodiscard]] const parser::EntityEventStreams &getStreams() const;
+
+  /**
+   * Transmission & distance totals at any time, by slot in `getStreams()`
+   */
+  [[nodiscard]] const parser::TrafficStatistics &getTrafficStatistics() const;
+
+  /**
+   * @param slot
+   * The slot of a Node in `getStreams()`
+   *
+   * @return
+   * The model the Node was loaded from, which events never change
+   */
+  [[nodiscard]] const parser::Node &getNodeModel(std::uint32_t slot) const;
+
 signals:
   void timeChanged(parser::nanoseconds simulationTime, parser::nanoseconds increment);
+
+  /**
+   * Emitted after the `timeChanged()` of a jump to a new time,
+   * rather than a step of playback
+   */
+  void seeked();
   void paused();
   void playing();
   void selectedItemUpdated();
   void nodeSelected(unsigned int nodeId);
+
+  /**
+   * Emitted when playback starts, or stops, falling behind wall time.
+   * Either the events due are taking more than a frame's budget to apply,
+   * or frames are too slow to catch up on every step
+   *
+   * @param value
+   * True when playback is behind
+   */
+  void playbackBehind(bool value);
+
+  /**
+   * Emitted when playback jumps over a stretch with no events, see `setSkipIdle()`
+   *
+   * @param amount
+   * The time jumped over
+   */
+  void idleSkipped(parser::nanoseconds amount);
+
+  /**
+   * Sends a frame to `frameWriter`, on its thread
+   */
+  void frameReady(const QImage &frame, const QString &fileName);
+
+  /**
+   * Sends a frame to `renderServer`, on its thread
+   */
+  void streamFrameReady(const QImage &frame, qint64 time, QVector3D position, float yaw, float pitch);
+
+  void clientConnected();
+  void clientDisconnected();
+  void wallLeaderConnected();
+  void wallLeaderDisconnected();
+  void wallNodeLost(const QString &address);
+
+  void exportFinished(const QString &directory, unsigned long long frames);
+  void exportFailed(const QString &fileName);
+
+  /**
+   * Emitted once every shot of a capture is written, or failed to be
+   *
+   * @param shots
+   * The number of shots in the capture
+   *
+   * @param failures
+   * The number of shots which could not be written
+   */
+  void captureFinished(const QString &directory, int shots, int failures);
+
+  /**
+   * Emitted once a replay started with `startReplay()` has drawn every frame
+   *
+   * @param times
+   * The spread of the CPU & GPU time of the replayed frames
+   */
+  void replayFinished(const FrameProfiler::FrameTimes &times);
+
+  /**
+   * Emitted once `probePerformance()` has stored the graphics settings for this machine
+   *
+   * @param description
+   * A short description of the picked preset, for the user
+   */
+  void performancePresetApplied(const QString &description);
 };
 } // namespace netsimulyzer
@@ -0,0 +1,86 @@
+/*
+ * NIST-developed software is provided by NIST as a public service. You may use,
+ * copy and distribute copies of the software in any medium, provided that you
+ * keep intact this entire notice. You may improve,modify and create derivative
+ * works of the software or any portion of the software, and you may copy and
+ * distribute such modifications or works. Modified works should carry a notice
+ * stating that you changed the software and should note the date and nature of
+ * any such change. Please explicitly acknowledge the National Institute of
+ * Standards and Technology as the source of the software.
+ *
+ * NIST-developed software is expressly provided "AS IS." NIST MAKES NO
+ * WARRANTY OF ANY KIND, EXPRESS, IMPLIED, IN FACT OR ARISING BY OPERATION OF
+ * LAW, INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTY OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, NON-INFRINGEMENT
+ * AND DATA ACCURACY. NIST NEITHER REPRESENTS NOR WARRANTS THAT THE
+ * OPERATION OF THE SOFTWARE WILL BE UNINTERRUPTED OR ERROR-FREE, OR THAT
+ * ANY DEFECTS WILL BE CORRECTED. NIST DOES NOT WARRANT OR MAKE ANY
+ * REPRESENTATIONS REGARDING THE USE OF THE SOFTWARE OR THE RESULTS THEREOF,
+ * INCLUDING BUT NOT LIMITED TO THE CORRECTNESS, ACCURACY, RELIABILITY,
+ * OR USEFULNESS OF THE SOFTWARE.
+ *
+ * You are solely responsible for determining the appropriateness of using and
+ * distributing the software and you assume all risks associated with its use,
+ * including but not limited to the risks and costs of program errors,
+ * compliance with applicable laws, damage to or loss of data, programs or
+ * equipment, and the unavailability or interruption of operation. This
+ * software is not intended to be used in any situation where a failure could
+ * cause risk of injury or damage to property. The software developed by NIST
+ * employees is not subject to copyright protection within the United States.
+ *
+ * Author: Evan Black <evan.black@nist.gov>
+ */
+
+#include "ShotList.h"
+#include "src/util/common-times.h"
+#include <QFile>
+#include <QStringList>
+#include <QTextStream>
+#include <cmath>
+
+namespace netsimulyzer {
+
+const std::vector<ShotList::Shot> &ShotList::getShots() const {
+  return shots;
+}
+
+bool ShotList::empty() const {
+  return shots.empty();
+}
+
+std::optional<ShotList> ShotList::read(const QString &path) {
+  QFile file{path};
+  if (!file.open(QFile::ReadOnly | QFile::Text))
+    return {};
+
+  QTextStream in{&file};
+  ShotList shotList;
+  while (!in.atEnd()) {
+    const auto fields = in.readLine().split(',');
+    if (fields.size() != 1 && fields.size() != 6)
+      continue;
+
+    auto valid = false;
+    const auto milliseconds = fields[0].trimmed().toDouble(&valid);
+    if (!valid || milliseconds < 0.0)
+      continue;
+
+    Shot shot;
+    shot.time = static_cast<parser::nanoseconds>(std::llround(milliseconds * static_cast<double>(MILLISECOND)));
+    if (fields.size() == 6) {
+      View view;
+      view.position = {fields[1].toFloat(), fields[2].toFloat(), fields[3].toFloat()};
+      view.yaw = fields[4].toFloat();
+      view.pitch = fields[5].toFloat();
+      shot.view = view;
+    }
+    shotList.shots.emplace_back(shot);
+  }
+
+  if (shotList.empty())
+    return {};
+
+  return shotList;
+}
+
+} // namespace netsimulyzer
@@ -0,0 +1,93 @@
+/*
+ * NIST-developed software is provided by NIST as a public service. You may use,
+ * copy and distribute copies of the software in any medium, provided that you
+ * keep intact this entire notice. You may improve,modify and create derivative
+ * works of the software or any portion of the software, and you may copy and
+ * distribute such modifications or works. Modified works should carry a notice
+ * stating that you changed the software and should note the date and nature of
+ * any such change. Please explicitly acknowledge the National Institute of
+ * Standards and Technology as the source of the software.
+ *
+ * NIST-developed software is expressly provided "AS IS." NIST MAKES NO
+ * WARRANTY OF ANY KIND, EXPRESS, IMPLIED, IN FACT OR ARISING BY OPERATION OF
+ * LAW, INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTY OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, NON-INFRINGEMENT
+ * AND DATA ACCURACY. NIST NEITHER REPRESENTS NOR WARRANTS THAT THE
+ * OPERATION OF THE SOFTWARE WILL BE UNINTERRUPTED OR ERROR-FREE, OR THAT
+ * ANY DEFECTS WILL BE CORRECTED. NIST DOES NOT WARRANT OR MAKE ANY
+ * REPRESENTATIONS REGARDING THE USE OF THE SOFTWARE OR THE RESULTS THEREOF,
+ * INCLUDING BUT NOT LIMITED TO THE CORRECTNESS, ACCURACY, RELIABILITY,
+ * OR USEFULNESS OF THE SOFTWARE.
+ *
+ * You are solely responsible for determining the appropriateness of using and
+ * distributing the software and you assume all risks associated with its use,
+ * including but not limited to the risks and costs of program errors,
+ * compliance with applicable laws, damage to or loss of data, programs or
+ * equipment, and the unavailability or interruption of operation. This
+ * software is not intended to be used in any situation where a failure could
+ * cause risk of injury or damage to property. The software developed by NIST
+ * employees is not subject to copyright protection within the United States.
+ *
+ * Author: Evan Black <evan.black@nist.gov>
+ */
+
+#pragma once
+
+#include <QString>
+#include <glm/glm.hpp>
+#include <model.h>
+#include <optional>
+#include <vector>
+
+namespace netsimulyzer {
+
+/**
+ * The times & views to capture a scenario at, see `SceneWidget::startCapture()`.
+ * Read from CSV, one shot per line, as `time_ms[,x,y,z,yaw,pitch]`.
+ * A line without a view keeps the view of the shot before it,
+ * or the default view of the scenario for the first shot.
+ * Lines which do not start with a time, like a header, are skipped
+ */
+class ShotList {
+public:
+  /**
+   * A camera position & rotation, as in `Camera`
+   */
+  struct View {
+    glm::vec3 position{0.0f};
+    float yaw{-90.0f};
+    float pitch{0.0f};
+  };
+
+  struct Shot {
+    parser::nanoseconds time{0LL};
+
+    /**
+     * Unset to keep the view of the shot before
+     */
+    std::optional<View> view;
+  };
+
+private:
+  /**
+   * In the order they were read
+   */
+  std::vector<Shot> shots;
+
+public:
+  [[nodiscard]] const std::vector<Shot> &getShots() const;
+  [[nodiscard]] bool empty() const;
+
+  /**
+   * Read a shot list
+   *
+   * @param path
+   * The CSV file to read
+   *
+   * @return
+   * The shots, unset if the file could not be read, or has no shots
+   */
+  [[nodiscard]] static std::optional<ShotList> read(const QString &path);
+};
+
+} // namespace netsimulyzer
@@ -0,0 +1,256 @@
+/*
+ * NIST-developed software is provided by NIST as a public service. You may use,
+ * copy and distribute copies of the software in any medium, provided that you
+ * keep intact this entire notice. You may improve,modify and create derivative
+ * works of the software or any portion of the software, and you may copy and
+ * distribute such modifications or works. Modified works should carry a notice
+ * stating that you changed the software and should note the date and nature of
+ * any such change. Please explicitly acknowledge the National Institute of
+ * Standards and Technology as the source of the software.
+ *
+ * NIST-developed software is expressly provided "AS IS." NIST MAKES NO
+ * WARRANTY OF ANY KIND, EXPRESS, IMPLIED, IN FACT OR ARISING BY OPERATION OF
+ * LAW, INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTY OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, NON-INFRINGEMENT
+ * AND DATA ACCURACY. NIST NEITHER REPRESENTS NOR WARRANTS THAT THE
+ * OPERATION OF THE SOFTWARE WILL BE UNINTERRUPTED OR ERROR-FREE, OR THAT
+ * ANY DEFECTS WILL BE CORRECTED. NIST DOES NOT WARRANT OR MAKE ANY
+ * REPRESENTATIONS REGARDING THE USE OF THE SOFTWARE OR THE RESULTS THEREOF,
+ * INCLUDING BUT NOT LIMITED TO THE CORRECTNESS, ACCURACY, RELIABILITY,
+ * OR USEFULNESS OF THE SOFTWARE.
+ *
+ * You are solely responsible for determining the appropriateness of using and
+ * distributing the software and you assume all risks associated with its use,
+ * including but not limited to the risks and costs of program errors,
+ * compliance with applicable laws, damage to or loss of data, programs or
+ * equipment, and the unavailability or interruption of operation. This
+ * software is not intended to be used in any situation where a failure could
+ * cause risk of injury or damage to property. The software developed by NIST
+ * employees is not subject to copyright protection within the United States.
+ *
+ * Author: Evan Black <evan.black@nist.gov>
+ */
+
+#include "WallSync.h"
+#include <QByteArray>
+#include <algorithm>
+#include <array>
+#include <iostream>
+#include <trace.h>
+#include <utility>
+
+namespace netsimulyzer {
+
+WallSync::~WallSync() {
+  stop();
+}
+
+std::optional<QString> WallSync::lead(const QStringList &addresses) {
+  stop();
+
+  for (const auto &address : addresses) {
+    auto &node = nodes.emplace_back();
+    node.address = address;
+    if (const auto error = node.socket.connect(address.toStdString())) {
+      nodes.clear();
+      return address + ": " + QString::fromStdString(error.value());
+    }
+  }
+
+  lastFrame = 0u;
+  return {};
+}
+
+bool WallSync::isLeading() const {
+  return !nodes.empty();
+}
+
+bool WallSync::readAnswers(Node &node, std::chrono::milliseconds timeout) {
+  std::array<char, 256u> buffer{};
+  const auto received = node.socket.read(buffer.data(), buffer.size(), timeout);
+  if (!received)
+    return false;
+
+  node.received.append(buffer.data(), received.value());
+  std::size_t start = 0u;
+  for (auto end = node.received.find('\n'); end != std::string::npos; end = node.received.find('\n', start)) {
+    const auto parts = QString::fromUtf8(node.received.data() + start, static_cast<int>(end - start)).split(' ');
+    if (parts.size() == 2 && parts.front() == "done")
+      node.shown = std::max<std::uint64_t>(node.shown, parts.back().toULongLong());
+    start = end + 1u;
+  }
+  node.received.erase(0u, start);
+  return true;
+}
+
+std::list<WallSync::Node>::iterator WallSync::drop(std::list<Node>::iterator node) {
+  const auto address = node->address;
+  std::clog << "Lost the video wall node at: " << address.toStdString() << '\n';
+  auto next = nodes.erase(node);
+  emit nodeLost(address);
+  return next;
+}
+
+void WallSync::awaitNodes() {
+  using clock = std::chrono::steady_clock;
+  parser::trace::Scope trace{"WallSync::awaitNodes", "frame"};
+  const auto deadline = clock::now() + frameTimeout;
+
+  for (auto node = nodes.begin(); node != nodes.end();) {
+    // Only what has arrived already, for a node which is catching up
+    auto open = node->behind ? readAnswers(*node, std::chrono::milliseconds{0}) : true;
+    while (open && !node->behind && node->shown < lastFrame) {
+      const auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - clock::now());
+      if (remaining.count() <= 0) {
+        node->behind = true;
+        break;
+      }
+      open = readAnswers(*node, remaining);
+    }
+
+    if (!open) {
+      node = drop(node);
+      continue;
+    }
+
+    if (node->shown >= lastFrame)
+      node->behind = false;
+    ++node;
+  }
+}
+
+void WallSync::broadcast(Frame frame) {
+  frame.number = ++lastFrame;
+  const auto line = QString{"frame %1 %2 %3 %4 %5 %6 %7 %8\n"}
+                        .arg(frame.number)
+                        .arg(frame.time)
+                        .arg(frame.position.x, 0, 'g', 9)
+                        .arg(frame.position.y, 0, 'g', 9)
+                        .arg(frame.position.z, 0, 'g', 9)
+                        .arg(frame.yaw, 0, 'g', 9)
+                        .arg(frame.pitch, 0, 'g', 9)
+                        .arg(frame.fieldOfView, 0, 'g', 9)
+                        .toUtf8();
+
+  for (auto node = nodes.begin(); node != nodes.end();) {
+    if (!node->socket.write(line.constData(), static_cast<std::size_t>(line.size())))
+      node = drop(node);
+    else
+      ++node;
+  }
+}
+
+std::optional<QString> WallSync::follow(const QString &address) {
+  stop();
+
+  {
+    std::lock_guard lock{socketMutex};
+    socket.emplace();
+    if (const auto error = socket->listen(address.toStdString())) {
+      socket.reset();
+      return QString::fromStdString(error.value());
+    }
+  }
+
+  stopRequested = false;
+  reader = parser::TaskPool::shared().submit([this, address = address.toStdString()]() {
+    serve(address);
+  });
+  return {};
+}
+
+void WallSync::serve(const std::string &address) {
+  using namespace std::chrono_literals;
+  std::array<char, 4096u> buffer{};
+  std::string lines;
+
+  while (!stopRequested) {
+    if (!socket->accept(stopRequested))
+      return;
+
+    connected = true;
+    emit leaderConnected();
+
+    lines.clear();
+    while (!stopRequested) {
+      const auto received = socket->read(buffer.data(), buffer.size(), 250ms);
+      if (!received)
+        break;
+
+      lines.append(buffer.data(), received.value());
+      std::size_t start = 0u;
+      for (auto end = lines.find('\n'); end != std::string::npos; end = lines.find('\n', start)) {
+        handle(QString::fromUtf8(lines.data() + start, static_cast<int>(end - start)));
+        start = end + 1u;
+      }
+      lines.erase(0u, start);
+    }
+
+    if (stopRequested)
+      return;
+
+    connected = false;
+    emit leaderDisconnected();
+
+    // The listener was closed once the leader connected, so open it again for the next
+    std::lock_guard lock{socketMutex};
+    if (const auto error = socket->listen(address)) {
+      std::cerr << "Video wall node stopped: " << error.value() << '\n';
+      return;
+    }
+  }
+}
+
+void WallSync::handle(const QString &line) {
+  const auto parts = line.simplified().split(' ');
+  if (parts.size() != 9 || parts.front() != "frame")
+    return;
+
+  Frame frame;
+  frame.number = parts[1].toULongLong();
+  frame.time = parts[2].toLongLong();
+  frame.position = {parts[3].toFloat(), parts[4].toFloat(), parts[5].toFloat()};
+  frame.yaw = parts[6].toFloat();
+  frame.pitch = parts[7].toFloat();
+  frame.fieldOfView = parts[8].toFloat();
+
+  std::unique_lock lock{frameMutex};
+  const auto waiting = latest.has_value();
+  latest = frame;
+  lock.unlock();
+
+  if (!waiting)
+    emit frameReceived();
+}
+
+std::optional<WallSync::Frame> WallSync::takeFrame() {
+  std::lock_guard lock{frameMutex};
+  return std::exchange(latest, std::nullopt);
+}
+
+void WallSync::acknowledge(std::uint64_t number) {
+  const auto line = QString{"done %1\n"}.arg(number).toUtf8();
+
+  // A failed write means the leader left, which the reader sees as well
+  std::lock_guard lock{socketMutex};
+  if (connected && socket)
+    (void)socket->write(line.constData(), static_cast<std::size_t>(line.size()));
+}
+
+void WallSync::stop() {
+  nodes.clear();
+
+  stopRequested = true;
+  reader.wait();
+
+  std::lock_guard lock{socketMutex};
+  socket.reset();
+  {
+    std::lock_guard frameLock{frameMutex};
+    latest.reset();
+  }
+  if (connected.exchange(false))
+    emit leaderDisconnected();
+}
+
+} // namespace netsimulyzer
@@ -0,0 +1,293 @@
+/*
+ * NIST-developed software is provided by NIST as a public service. You may use,
+ * copy and distribute copies of the software in any medium, provided that you
+ * keep intact this entire notice. You may improve,modify and create derivative
+ * works of the software or any portion of the software, and you may copy and
+ * distribute such modifications or works. Modified works should carry a notice
+ * stating that you changed the software and should note the date and nature of
+ * any such change. Please explicitly acknowledge the National Institute of
+ * Standards and Technology as the source of the software.
+ *
+ * NIST-developed software is expressly provided "AS IS." NIST MAKES NO
+ * WARRANTY OF ANY KIND, EXPRESS, IMPLIED, IN FACT OR ARISING BY OPERATION OF
+ * LAW, INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTY OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, NON-INFRINGEMENT
+ * AND DATA ACCURACY. NIST NEITHER REPRESENTS NOR WARRANTS THAT THE
+ * OPERATION OF THE SOFTWARE WILL BE UNINTERRUPTED OR ERROR-FREE, OR THAT
+ * ANY DEFECTS WILL BE CORRECTED. NIST DOES NOT WARRANT OR MAKE ANY
+ * REPRESENTATIONS REGARDING THE USE OF THE SOFTWARE OR THE RESULTS THEREOF,
+ * INCLUDING BUT NOT LIMITED TO THE CORRECTNESS, ACCURACY, RELIABILITY,
+ * OR USEFULNESS OF THE SOFTWARE.
+ *
+ * You are solely responsible for determining the appropriateness of using and
+ * distributing the software and you assume all risks associated with its use,
+ * including but not limited to the risks and costs of program errors,
+ * compliance with applicable laws, damage to or loss of data, programs or
+ * equipment, and the unavailability or interruption of operation. This
+ * software is not intended to be used in any situation where a failure could
+ * cause risk of injury or damage to property. The software developed by NIST
+ * employees is not subject to copyright protection within the United States.
+ *
+ * Author: Evan Black <evan.black@nist.gov>
+ */
+
+#pragma once
+
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <ingest-socket.h>
+#include <list>
+#include <model.h>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <task-pool.h>
+
+namespace netsimulyzer {
+
+/**
+ * The part of a video wall one viewer draws, see `SceneWidget::setWallTile()`.
+ * Every tile is assumed to be the same size
+ */
+struct WallTile {
+  int columns{1};
+  int rows{1};
+
+  /**
+   * Counted from the left
+   */
+  int column{0};
+
+  /**
+   * Counted from the top
+   */
+  int row{0};
+};
+
+/**
+ * Locks the frames of several viewers together, so each may draw one tile of a video wall.
+ *
+ * One viewer leads, driving playback & the camera as usual. After drawing each frame,
+ * it sends the frame to every render node, one line per frame:
+ *
+ *   frame <number> <simulation time in ns> <x> <y> <z> <yaw> <pitch> <field of view>\n
+ *
+ * Each node draws its own tile of that view, see `SceneWidget::setWallTile()`,
+ * and answers once the frame has been swapped to the screen:
+ *
+ *   done <number>\n
+ *
+ * The leader waits for every node to show a frame before drawing the next,
+ * so no tile is ever more than one frame from the others. A node which misses `frameTimeout`
+ * is not waited on again until it has caught up, so one slow node does not hold back the wall.
+ *
+ * Nodes listen, and the leader connects to each of them, so the nodes may be started first.
+ * A node reads frames on the shared `parser::TaskPool`, & the leader may connect again once it leaves.
+ * Unavailable on Windows, see `parser::IngestSocket`
+ */
+class WallSync : public QObject {
+  Q_OBJECT
+
+public:
+  /**
+   * The view of one frame, as drawn by the leader
+   */
+  struct Frame {
+    std::uint64_t number{0u};
+    parser::nanoseconds time{0LL};
+    glm::vec3 position{};
+    float yaw{0.0f};
+    float pitch{0.0f};
+
+    /**
+     * The vertical field of view of the whole wall, in degrees
+     */
+    float fieldOfView{45.0f};
+  };
+
+  /**
+   * The longest the leader waits for a node to show a frame
+   */
+  static constexpr std::chrono::milliseconds frameTimeout{100};
+
+private:
+  /**
+   * A render node, as seen by the leader
+   */
+  struct Node {
+    QString address;
+    parser::IngestSocket socket;
+
+    /**
+     * Bytes received after the last complete line
+     */
+    std::string received;
+
+    /**
+     * The last frame the node has shown
+     */
+    std::uint64_t shown{0u};
+
+    /**
+     * Set once the node misses a frame, until it shows the latest one
+     */
+    bool behind{false};
+  };
+
+  /**
+   * Connected to by `lead()`. Only used on the leader's thread
+   */
+  std::list<Node> nodes;
+
+  /**
+   * The number of the last frame sent by `broadcast()`
+   */
+  std::uint64_t lastFrame{0u};
+
+  /**
+   * The connection to the leader, see `follow()`.
+   * Guards replacing the socket against `acknowledge()`
+   */
+  std::mutex socketMutex;
+  std::optional<parser::IngestSocket> socket;
+
+  /**
+   * Reads frames until `stopRequested`, see `serve()`
+   */
+  parser::TaskPool::Handle reader;
+  std::atomic<bool> stopRequested{false};
+  std::atomic<bool> connected{false};
+
+  /**
+   * The latest frame from the leader, not taken by `takeFrame()` yet.
+   * Older frames are dropped, since only the latest is drawn
+   */
+  std::mutex frameMutex;
+  std::optional<Frame> latest;
+
+  /**
+   * Accept the leader & read its frames, until stopped. Runs on the pool
+   *
+   * @param address
+   * Where to listen, see `parser::IngestSocket::listen()`
+   */
+  void serve(const std::string &address);
+
+  /**
+   * Keep the frame from one line, & emit `frameReceived()` if none was waiting.
+   * Anything else is ignored
+   *
+   * @param line
+   * The frame, without its line break
+   */
+  void handle(const QString &line);
+
+  /**
+   * Read the answers `node` has sent
+   *
+   * @param timeout
+   * The longest to wait for any bytes
+   *
+   * @return
+   * False once the node has disconnected
+   */
+  bool readAnswers(Node &node, std::chrono::milliseconds timeout);
+
+  /**
+   * Disconnect from `node`, & emit `nodeLost()`
+   *
+   * @return
+   * The node after `node`
+   */
+  std::list<Node>::iterator drop(std::list<Node>::iterator node);
+
+public:
+  ~WallSync() override;
+
+  /**
+   * Lead the wall, connecting to each of its render nodes,
+   * replacing any earlier leading or following
+   *
+   * @param addresses
+   * Where each node listens, see `parser::IngestSocket::connect()`
+   *
+   * @return
+   * A description of the error, if any node could not be reached,
+   * an unset optional otherwise, in which case every node is connected
+   */
+  [[nodiscard]] std::optional<QString> lead(const QStringList &addresses);
+
+  /**
+   * @return
+   * True while at least one render node is connected to lead
+   */
+  [[nodiscard]] bool isLeading() const;
+
+  /**
+   * Wait for every node, which has not fallen behind, to show the last frame sent by `broadcast()`,
+   * for at most `frameTimeout`. Call from the leader's thread, before drawing the next frame
+   */
+  void awaitNodes();
+
+  /**
+   * Send a frame to every node. Call from the leader's thread, once the frame is drawn
+   *
+   * @param frame
+   * The frame to send. Its number is set here
+   */
+  void broadcast(Frame frame);
+
+  /**
+   * Listen for the leader, as a render node,
+   * replacing any earlier leading or following
+   *
+   * @param address
+   * Where to listen, see `parser::IngestSocket::listen()`
+   *
+   * @return
+   * A description of the error, if the socket could not be opened,
+   * an unset optional otherwise
+   */
+  [[nodiscard]] std::optional<QString> follow(const QString &address);
+
+  /**
+   * @return
+   * The latest frame from the leader, unset if there is none new since the last call.
+   * Safe to call from any thread
+   */
+  [[nodiscard]] std::optional<Frame> takeFrame();
+
+  /**
+   * Tell the leader a frame has been shown
+   *
+   * @param number
+   * The number of the frame, from `takeFrame()`
+   */
+  void acknowledge(std::uint64_t number);
+
+  /**
+   * Disconnect from every node, or from the leader & stop listening
+   */
+  void stop();
+
+signals:
+  void leaderConnected();
+  void leaderDisconnected();
+
+  /**
+   * Emitted from the reading thread when a frame arrives, & the last one was taken by `takeFrame()`
+   */
+  void frameReceived();
+
+  /**
+   * Emitted when a node disconnects, after which the wall continues without it
+   */
+  void nodeLost(const QString &address);
+};
+
+} // namespace netsimulyzer
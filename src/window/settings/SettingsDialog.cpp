@@ -166,6 +166,7 @@ SettingsDialog::SettingsDialog(QWidget *parent) : QDialog(parent) {
   QObject::connect(ui.buttonResetTrailLength, &QPushButton::clicked, this, &SettingsDialog::defaultTrailsLength);
   QObject::connect(ui.buttonResetShowLabels, &QPushButton::clicked, this, &SettingsDialog::defaultShowLabels);
   QObject::connect(ui.buttonResetLabelScale, &QPushButton::clicked, this, &SettingsDialog::defaultLabelScale);
+  QObject::connect(ui.buttonProbePerformance, &QPushButton::clicked, this, &SettingsDialog::performanceProbeRequested);
 
   QObject::connect(ui.buttonResetPlay, &QPushButton::clicked, ui.keyPlay, &SingleKeySequenceEdit::setDefault);
   QObject::connect(ui.buttonResetTimeStep, &QPushButton::clicked, this, &SettingsDialog::defaultTimeStep);
@@ -190,14 +190,15 @@ class SettingsDialog : public QDialog {
    */
   void selectResourcePath();
 
+public:
+  explicit SettingsDialog(QWidget *parent = nullptr);
+
   /**
-   * Load the saved settings into each input
+   * Load the saved settings into each input.
+   * Discards any unsaved changes
    */
   void loadSettings();
 
-public:
-  explicit SettingsDialog(QWidget *parent = nullptr);
-
   /**
    * Sets the time step spinner to `value`.
    * Does not trigger the `timeStepSet` signal
@@ -404,6 +405,12 @@ signals:
    * with a trailing slash.
    */
   void resourcePathChanged(const QString &dir);
+
+  /**
+   * Signal emitted when the user asks for the graphics settings to be picked
+   * from a probe of the GPU. The inputs should be reloaded once they are stored
+   */
+  void performanceProbeRequested();
 };
 
 } // namespace netsimulyzer
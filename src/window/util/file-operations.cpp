@@ -32,10 +32,89 @@
  */
 
 #include "file-operations.h"
+#include "src/conversion.h"
 #include "src/settings/SettingsManager.h"
+#include "src/util/memory-report.h"
+#include <QFile>
 #include <QFileDialog>
 #include <QFileInfo>
+#include <QGridLayout>
+#include <QLabel>
+#include <QLocale>
 #include <QString>
+#include <parser/section-index.h>
+
+namespace {
+
+/**
+ * Summarize the scenario at `path` from its section index,
+ * without parsing its events
+ *
+ * @param path
+ * The highlighted file in the open dialog
+ *
+ * @return
+ * The text for the preview, empty if `path` is not a plain JSON file
+ */
+QString describeScenario(const QString &path) {
+  const QFileInfo info{path};
+  if (!info.isFile() || !path.endsWith(".json", Qt::CaseInsensitive))
+    return {};
+
+  const auto index = parser::indexSections(QFile::encodeName(path).constData());
+  if (!index)
+    return "Not a scenario file";
+
+  QLocale locale;
+  auto text = info.fileName() + '\n' +
+              QString::fromStdString(netsimulyzer::MemoryReport::formatBytes(index->fileSize)) + "\n\n";
+
+  if (const auto &configuration = index->configuration) {
+    const auto &version = configuration->moduleVersion;
+    text += QString{"Module version: %1.%2.%3%4\n"}
+                .arg(version.major)
+                .arg(version.minor)
+                .arg(version.patch)
+                .arg(QString::fromStdString(version.suffix));
+    text += "End time: " +
+            netsimulyzer::toDisplayTime(configuration->endTime, netsimulyzer::SettingsManager::TimeUnit::Milliseconds) +
+            '\n';
+  } else
+    text += "No configuration\n";
+
+  for (const auto &section : index->sections) {
+    if (section.key == "configuration")
+      continue;
+
+    text += QString::fromStdString(section.key) + ": ";
+    if (section.key == "events")
+      text += (index->eventsCounted ? "" : "~") + locale.toString(static_cast<qulonglong>(index->estimatedEvents));
+    else
+      text += locale.toString(static_cast<qulonglong>(section.items));
+    text += '\n';
+  }
+
+  return text;
+}
+
+const char *const scenarioFilter = "Scenario Files (*.json *.json.gz *.json.zst *.nszb);;JSON Files (*.json);;"
+                                   "Compressed JSON Files (*.json.gz *.json.zst);;"
+                                   "Binary Scenario Files (*.nszb)";
+
+/**
+ * @return
+ * Either the directory of the last scenario loaded, or the current working directory
+ */
+QString scenarioDirectory(netsimulyzer::SettingsManager &settings) {
+  auto lastPath = settings.get<QString>(netsimulyzer::SettingsManager::Key::LastLoadPath,
+                                        netsimulyzer::SettingsManager::RetrieveMode::DisallowDefault);
+  if (lastPath && QFileInfo{lastPath.value()}.exists())
+    return lastPath.value();
+
+  return ".";
+}
+
+} // namespace
 
 namespace netsimulyzer {
 QString getExistingDirectory(const QString &caption, QWidget *parent) {
@@ -53,23 +132,35 @@ QString getExistingDirectory(const QString &caption, QWidget *parent) {
 QString getScenarioFile(QWidget *parent) {
 
   SettingsManager settings;
-  auto lastPath =
-      settings.get<QString>(SettingsManager::Key::LastLoadPath, SettingsManager::RetrieveMode::DisallowDefault);
+  const auto startingDirectory = scenarioDirectory(settings);
+  const QString filter{scenarioFilter};
 
-  // Use either the last loaded path, or the current working directory
-  QString startingDirectory = ".";
-  if (lastPath && QFileInfo{lastPath.value()}.exists())
-    startingDirectory = lastPath.value();
-
-  auto selected = QFileDialog::getOpenFileName(parent, "Open Scenario File", startingDirectory, "JSON Files (*.json)",
-                                               nullptr
 #ifdef __linux__
-                                               // Disable native dialogs on linux,
-                                               // as some distros have poor performance with them
-                                               ,
-                                               QFileDialog::DontUseNativeDialog
+  // Disable native dialogs on linux,
+  // as some distros have poor performance with them.
+  // The Qt dialog also lets us preview the highlighted scenario
+  QFileDialog dialog{parent, "Open Scenario File", startingDirectory, filter};
+  dialog.setOption(QFileDialog::DontUseNativeDialog);
+  dialog.setFileMode(QFileDialog::ExistingFile);
+
+  auto preview = new QLabel{&dialog};
+  preview->setAlignment(Qt::AlignTop | Qt::AlignLeft);
+  preview->setMinimumWidth(200);
+  preview->setTextInteractionFlags(Qt::TextSelectableByMouse);
+  if (auto layout = qobject_cast<QGridLayout *>(dialog.layout()))
+    layout->addWidget(preview, 0, layout->columnCount(), layout->rowCount(), 1);
+
+  // Only the section index is read, so even large scenarios preview immediately
+  QObject::connect(&dialog, &QFileDialog::currentChanged, preview, [preview](const QString &path) {
+    preview->setText(describeScenario(path));
+  });
+
+  QString selected;
+  if (dialog.exec() == QDialog::Accepted && !dialog.selectedFiles().isEmpty())
+    selected = dialog.selectedFiles().front();
+#else
+  auto selected = QFileDialog::getOpenFileName(parent, "Open Scenario File", startingDirectory, filter);
 #endif
-  );
 
   // Save the current path if a file was selected
   QFileInfo selectedFile{selected};
@@ -79,6 +170,17 @@ QString getScenarioFile(QWidget *parent) {
   return selected;
 }
 
+QStringList getScenarioFiles(QWidget *parent) {
+  SettingsManager settings;
+  const auto selected =
+      QFileDialog::getOpenFileNames(parent, "Open Scenario Files", scenarioDirectory(settings), scenarioFilter);
+
+  if (!selected.isEmpty())
+    settings.set(SettingsManager::Key::LastLoadPath, QFileInfo{selected.front()}.absolutePath());
+
+  return selected;
+}
+
 std::string getModelFile(QWidget *parent) {
   SettingsManager settings;
   auto lastPath =
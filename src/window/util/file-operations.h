@@ -34,6 +34,7 @@
 #pragma once
 
 #include <QString>
+#include <QStringList>
 #include <QWidget>
 
 namespace netsimulyzer {
@@ -65,6 +66,18 @@ QString getExistingDirectory(const QString &caption, QWidget *parent = nullptr);
  */
 QString getScenarioFile(QWidget *parent = nullptr);
 
+/**
+ * Select several scenario files at once, in the order they are listed in the dialog.
+ * See `getScenarioFile()`
+ *
+ * @param parent
+ * The parent to map the File dialog to
+ *
+ * @return
+ * The paths to the selected files. Empty if nothing was selected
+ */
+QStringList getScenarioFiles(QWidget *parent = nullptr);
+
 /**
  * Wrapper for the file dialog which selects a model file. Used to distinguish which platforms should
  * use native dialogs & applies filter rules.